@@ -0,0 +1,27 @@
+#version 410 core
+
+uniform sampler2D u_depth_tex;
+
+uniform ivec2 u_depth_size;
+uniform ivec2 u_tile_count;
+
+layout(location = 0) out float f_depth;
+
+void main() {
+	ivec2 tileIdx = ivec2(gl_FragCoord.xy);
+
+	// every texel partially covered by this tile counts towards it
+	ivec2 texMin = (tileIdx * u_depth_size) / u_tile_count;
+	ivec2 texMax = min(((tileIdx + 1) * u_depth_size + u_tile_count - 1) / u_tile_count, u_depth_size);
+
+	float maxDepth = 0.0;
+
+	for (int y = texMin.y; y < texMax.y; y++) {
+		for (int x = texMin.x; x < texMax.x; x++) {
+			maxDepth = max(maxDepth, texelFetch(u_depth_tex, ivec2(x, y), 0).r);
+		}
+	}
+
+	f_depth = maxDepth;
+}
+
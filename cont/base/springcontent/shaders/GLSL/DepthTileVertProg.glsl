@@ -0,0 +1,8 @@
+#version 410 core
+
+layout(location = 0) in vec2 a_vertex_xy;
+
+void main() {
+	gl_Position = vec4(a_vertex_xy, 0.0, 1.0);
+}
+
@@ -0,0 +1,17 @@
+#version 410 core
+
+uniform sampler2D atlasTex;
+
+in vec2 vTexCoord;
+in vec4 vBaseColor;
+
+layout(location = 0) out vec4 fragColor;
+
+
+void main() {
+	fragColor = texture(atlasTex, vTexCoord) * vBaseColor;
+
+	// same alpha-test as CProjectileDrawer::DrawParticlePass
+	if (fragColor.a <= 0.0)
+		discard;
+}
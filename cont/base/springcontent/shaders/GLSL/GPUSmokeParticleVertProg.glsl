@@ -0,0 +1,80 @@
+#version 410 core
+
+// see CGPUParticleDrawer::SmokeParticle
+layout(location = 0) in vec4 posFrameAttr;
+layout(location = 1) in vec4 speedAgeAttr;
+layout(location = 2) in vec4 sizeParamsAttr;
+layout(location = 3) in vec4 texCoordsAttr;
+
+uniform mat4 viewMat;
+uniform mat4 projMat;
+
+uniform vec3 camRight;
+uniform vec3 camUp;
+uniform vec3 windVec;
+
+// current (interpolated) sim-frame
+uniform float simFrame;
+
+out vec2 vTexCoord;
+out vec4 vBaseColor;
+
+// quad corners in CSmokeProjectile::Draw order
+const vec2 cornerOffsets[6] = vec2[6](
+	vec2(-1.0, -1.0),
+	vec2( 1.0, -1.0),
+	vec2( 1.0,  1.0),
+	vec2( 1.0,  1.0),
+	vec2(-1.0,  1.0),
+	vec2(-1.0, -1.0)
+);
+
+
+// closed form of CSmokeProjectile::Update's size recurrence after <n> frames;
+// while size stays below startSize it approaches startSize + 4 * expansion
+// geometrically, from then on it grows linearly
+float SmokeSize(float initSize, float startSize, float expansion, float n) {
+	float fixPoint = startSize + 4.0 * expansion;
+	float numGeomFrames = n;
+
+	if ((initSize + expansion) >= startSize) {
+		numGeomFrames = 0.0;
+	} else if (expansion > 0.0) {
+		numGeomFrames = ceil(log((5.0 * expansion) / (fixPoint - initSize)) / log(0.8));
+	}
+
+	numGeomFrames = min(n, numGeomFrames);
+
+	float geomSize = fixPoint + (initSize - fixPoint) * pow(0.8, numGeomFrames);
+	return (max(0.0, geomSize + (n - numGeomFrames) * expansion));
+}
+
+void main() {
+	float numFrames = max(0.0, simFrame - posFrameAttr.w);
+	float age = numFrames * speedAgeAttr.w;
+
+	if (age >= 1.0) {
+		// expired, emit a degenerate triangle
+		gl_Position = vec4(0.0, 0.0, 0.0, 1.0);
+		vTexCoord = vec2(0.0);
+		vBaseColor = vec4(0.0);
+		return;
+	}
+
+	vec2 corner = cornerOffsets[gl_VertexID % 6];
+
+	// wind displacement accumulates with age: sum(k * ageSpeed, k < n)
+	vec3 windOffset = windVec * (0.05 * speedAgeAttr.w * numFrames * (numFrames - 1.0) * 0.5);
+	vec3 particlePos = posFrameAttr.xyz + speedAgeAttr.xyz * numFrames + windOffset;
+
+	float size = SmokeSize(sizeParamsAttr.w, sizeParamsAttr.x, sizeParamsAttr.y, numFrames);
+	float alpha = 1.0 - age;
+
+	vec3 vertexPos = particlePos + (camRight * corner.x + camUp * corner.y) * size;
+
+	gl_Position = projMat * viewMat * vec4(vertexPos, 1.0);
+
+	vTexCoord = mix(texCoordsAttr.xy, texCoordsAttr.zw, corner * 0.5 + 0.5);
+	// premultiplied, same as the CPU particle colors
+	vBaseColor = vec4(vec3(sizeParamsAttr.z * alpha), alpha);
+}
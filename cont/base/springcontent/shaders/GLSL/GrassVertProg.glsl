@@ -1,6 +1,9 @@
 #version 410 core
 
-uniform mat4 turfMatrices[128];
+// three texels per turf: {rotation, position + draw-threshold, square-reference position}
+uniform samplerBuffer turfInstTex;
+uniform int turfInstOffset;
+
 uniform mat4 viewMatrix;
 uniform mat4 projMatrix;
 
@@ -14,6 +17,9 @@ uniform vec3 camPos;
 uniform vec3 camUp;
 uniform vec3 camRight;
 
+uniform vec3 cullCamPos;
+uniform float grassDrawDistSq;
+
 uniform float frame;
 uniform vec3 windSpeed;
 
@@ -84,8 +90,31 @@ void ApplyDetailBending(inout vec3 vPos, vec3 vNormal, float fDetailPhase, float
 
 
 void main() {
+	int turfTexel = turfInstOffset + gl_InstanceID * 3;
+
+	vec4 turfRot = texelFetch(turfInstTex, turfTexel + 0);
+	vec4 turfPos = texelFetch(turfInstTex, turfTexel + 1);
+	vec4 turfRef = texelFetch(turfInstTex, turfTexel + 2);
+
+	{
+		// density falls off with the squared distance of the turf's square
+		vec3 refDif = cullCamPos - turfRef.xyz;
+		float drawProb = min(1.0, grassDrawDistSq / max(dot(refDif, refDif), 1e-4));
+
+		if (drawProb < 0.001 || turfPos.w > drawProb) {
+			// place the whole turf outside the clip-volume
+			gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+			return;
+		}
+	}
+
 	// NB: technically need the inverse transpose, etc
-	mat4 turfMatrix = turfMatrices[gl_InstanceID];
+	mat4 turfMatrix = mat4(
+		vec4(turfRot.x, 0.0, turfRot.y, 0.0),
+		vec4(      0.0, 1.0,       0.0, 0.0),
+		vec4(turfRot.z, 0.0, turfRot.w, 0.0),
+		vec4(turfPos.xyz,               1.0)
+	);
 	mat3 nrmlMatrix = mat3(turfMatrix);
 
 	vec4 vertexPos = vec4(positionAttr, 1.0);
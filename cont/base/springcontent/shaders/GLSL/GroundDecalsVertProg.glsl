@@ -4,6 +4,12 @@ const float BASE_COLOR_MULT = 1.0 / 255.0;
 
 uniform sampler2D heightTex;
 
+#ifdef USE_DECAL_ALPHA_BUFFER
+// per-decal alphas indexed by the slot encoded in baseColorAttr.rg
+uniform samplerBuffer decalAlphaTex;
+uniform float decalAlphaSlots;
+#endif
+
 uniform mat4 viewMatrix;
 uniform mat4 projMatrix;
 uniform mat4 quadMatrix;
@@ -32,5 +38,11 @@ void main() {
 	texCoord0 = texCoordsAttr;
 	texCoord1 = vertexPosAttr.xz * invMapSize.xy;
 	baseColor = baseColorAttr * BASE_COLOR_MULT;
+
+	#ifdef USE_DECAL_ALPHA_BUFFER
+	if (decalAlphaSlots > 0.0) {
+		baseColor = vec4(1.0, 1.0, 1.0, texelFetch(decalAlphaTex, int(baseColorAttr.r) + int(baseColorAttr.g) * 256).r);
+	}
+	#endif
 }
 
@@ -8,6 +8,9 @@ const float DEGREES_TO_RADIANS = 3.141592653589793 / 180.0;
 uniform sampler2D diffuseTex;
 uniform sampler2D shadingTex;
 uniform samplerCube reflectTex;
+// packed copies of diffuseTex and shadingTex, used by instanced draws
+uniform sampler2DArray diffuseTexArray;
+uniform sampler2DArray shadingTexArray;
 #ifdef use_normalmapping
 uniform sampler2D normalMap;
 #endif
@@ -27,19 +30,33 @@ uniform float specularExponent;
 uniform float gammaExponent;
 
 uniform vec4 fogColor;
-// in opaque passes tc.a is always 1.0 [all objects], and alphaPass is 0.0
-// in alpha passes tc.a is either one of alphaValues.xyzw [for units] *or*
-// contains a distance fading factor [for features], and alphaPass is 1.0
-// texture alpha-masking is done in both passes
-uniform vec4 teamColor;
 uniform vec4 nanoColor;
 // uniform float alphaPass;
 
 uniform vec4 alphaTestCtrl;
 
+#ifdef USE_LIGHT_GRID
+// light-records in the same layout as fwdDynLights, binned per map-column (see GL::LightHandler)
+uniform samplerBuffer lightDataTex;
+// {offsets of each column's range of indices, light-indices}
+uniform usamplerBuffer lightGridTex;
+uniform vec2 lightGridScale;
+
+#define DYN_LIGHT_VEC(k) texelFetch(lightDataTex, (k))
+#else
 // fwdDynLights[i] := {pos, dir, diffuse, specular, ambient, {fov, radius, -, -}}
 uniform vec4 fwdDynLights[MAX_LIGHT_UNIFORM_VECS];
 
+#define DYN_LIGHT_VEC(k) fwdDynLights[(k)]
+#endif
+
+
+// in opaque passes tc.a is always 1.0 [all objects], and alphaPass is 0.0
+// in alpha passes tc.a is either one of alphaValues.xyzw [for units] *or*
+// contains a distance fading factor [for features], and alphaPass is 1.0
+// texture alpha-masking is done in both passes
+flat in vec4 objTeamColor;
+flat in vec2 objTexLayers;
 
 in vec4 worldPos;
 in vec3 cameraDir;
@@ -76,22 +93,33 @@ float GetShadowCoeff(float zBias) {
 vec3 DynamicLighting(vec3 wsNormal, vec3 camDir, vec3 diffuseColor, vec4 specularColor) {
 	vec3 light = vec3(0.0);
 
-	#if (NUM_DYNAMIC_MODEL_LIGHTS > 0)
+	#if defined(USE_LIGHT_GRID)
+	// only the lights binned into this fragment's grid-column
+	ivec2 gridTile = clamp(ivec2(worldPos.xz * lightGridScale), ivec2(0), ivec2(LIGHT_GRID_SIZE - 1));
+	int gridIndex = gridTile.y * LIGHT_GRID_SIZE + gridTile.x;
+	int gridBegin = int(texelFetch(lightGridTex, gridIndex    ).r);
+	int gridEnd   = int(texelFetch(lightGridTex, gridIndex + 1).r);
+
+	for (int k = gridBegin; k < gridEnd; k++) {
+		int j = int(texelFetch(lightGridTex, LIGHT_GRID_SIZE * LIGHT_GRID_SIZE + 1 + k).r) * 6;
+	#elif (NUM_DYNAMIC_MODEL_LIGHTS > 0)
 	for (int i = 0; i < NUM_DYNAMIC_MODEL_LIGHTS; i++) {
 		int j = i * 6;
+	#endif
 
-		vec4 wsLightPos = fwdDynLights[j + 0];
-		vec4 wsLightDir = fwdDynLights[j + 1];
+	#if defined(USE_LIGHT_GRID) || (NUM_DYNAMIC_MODEL_LIGHTS > 0)
+		vec4 wsLightPos = DYN_LIGHT_VEC(j + 0);
+		vec4 wsLightDir = DYN_LIGHT_VEC(j + 1);
 
-		vec4 lightDiffColor = fwdDynLights[j + 2];
-		vec4 lightSpecColor = fwdDynLights[j + 3];
-		vec4 lightAmbiColor = fwdDynLights[j + 4];
+		vec4 lightDiffColor = DYN_LIGHT_VEC(j + 2);
+		vec4 lightSpecColor = DYN_LIGHT_VEC(j + 3);
+		vec4 lightAmbiColor = DYN_LIGHT_VEC(j + 4);
 
 		vec3 wsLightVec = normalize(wsLightPos.xyz - worldPos.xyz);
 		vec3 wsHalfVec = normalize(camDir + wsLightVec);
 
-		float lightAngle    = fwdDynLights[j + 5].x; // fov
-		float lightRadius   = fwdDynLights[j + 5].y; // or const. atten.
+		float lightAngle    = DYN_LIGHT_VEC(j + 5).x; // fov
+		float lightRadius   = DYN_LIGHT_VEC(j + 5).y; // or const. atten.
 		float lightDistance = dot(wsLightVec, wsLightPos.xyz - worldPos.xyz);
 
 
@@ -100,9 +128,9 @@ vec3 DynamicLighting(vec3 wsNormal, vec3 camDir, vec3 diffuseColor, vec4 specula
 
 		#ifdef OGL_SPEC_ATTENUATION
 		// infinite falloff
-		float cLightAtten = fwdDynLights[j + 5].y;
-		float lLightAtten = fwdDynLights[j + 5].z;
-		float qLightAtten = fwdDynLights[j + 5].w;
+		float cLightAtten = DYN_LIGHT_VEC(j + 5).y;
+		float lLightAtten = DYN_LIGHT_VEC(j + 5).z;
+		float qLightAtten = DYN_LIGHT_VEC(j + 5).w;
 		float  lightAtten = cLightAtten + lLightAtten * lightDistance + qLightAtten * lightDistance * lightDistance;
 		float  lightConst = 1.0;
 
@@ -146,15 +174,24 @@ void main(void)
 
 	vec3 sunLightColor = max(dot(wsNormal, sunDir), 0.0) * sunDiffuse + sunAmbient;
 
-	vec4 diffuseColor = texture(diffuseTex, texCoord0);
-	vec4 shadingColor = texture(shadingTex, texCoord0);
+	vec4 diffuseColor;
+	vec4 shadingColor;
+
+	// uniform across each draw-call, so no divergence within a batch
+	if (objTexLayers.x >= 0.0) {
+		diffuseColor = texture(diffuseTexArray, vec3(texCoord0, objTexLayers.x));
+		shadingColor = texture(shadingTexArray, vec3(texCoord0, objTexLayers.y));
+	} else {
+		diffuseColor = texture(diffuseTex, texCoord0);
+		shadingColor = texture(shadingTex, texCoord0);
+	}
 
 	vec3 specularColor = sunSpecular * pow(max(0.001, dot(wsNormal, normalize(sunDir + cameraDir * -1.0))), specularExponent);
 	vec3  reflectColor = texture(reflectTex,  reflectDir).rgb;
 
 
 	float shadow = GetShadowCoeff(-0.00005);
-	float alpha = teamColor.a * shadingColor.a; // apply one-bit mask
+	float alpha = objTeamColor.a * shadingColor.a; // apply one-bit mask
 
 	#if (DEFERRED_MODE == 0)
 	float alphaTestGreater = float(alpha > alphaTestCtrl.x) * alphaTestCtrl.y;
@@ -175,7 +212,7 @@ void main(void)
 
 	#if (DEFERRED_MODE == 0)
 	fragColor     = diffuseColor;
-	fragColor.rgb = mix(fragColor.rgb, teamColor.rgb, fragColor.a); // teamcolor
+	fragColor.rgb = mix(fragColor.rgb, objTeamColor.rgb, fragColor.a); // teamcolor
 	fragColor.rgb = fragColor.rgb * reflectColor + specularColor;
 	#endif
 
@@ -185,10 +222,10 @@ void main(void)
 
 	#if (DEFERRED_MODE == 1)
 	fragData[GBUFFER_NORMTEX_IDX] = vec4((wsNormal + vec3(1.0, 1.0, 1.0)) * 0.5, 1.0);
-	fragData[GBUFFER_DIFFTEX_IDX] = vec4(mix(                 diffuseColor.rgb, teamColor.rgb, diffuseColor.a), alpha);
+	fragData[GBUFFER_DIFFTEX_IDX] = vec4(mix(                 diffuseColor.rgb, objTeamColor.rgb, diffuseColor.a), alpha);
 	fragData[GBUFFER_DIFFTEX_IDX] = vec4(mix(fragData[GBUFFER_DIFFTEX_IDX].rgb, nanoColor.rgb, nanoColor.a), alpha);
 	// do not premultiply reflection, leave it to the deferred lighting pass
-	// fragData[GBUFFER_DIFFTEX_IDX] = vec4(mix(diffuseColor.rgb, teamColor.rgb, diffuseColor.a) * reflectColor, alpha);
+	// fragData[GBUFFER_DIFFTEX_IDX] = vec4(mix(diffuseColor.rgb, objTeamColor.rgb, diffuseColor.a) * reflectColor, alpha);
 	// allows standard-lighting reconstruction by lazy LuaMaterials using us
 	fragData[GBUFFER_SPECTEX_IDX] = vec4(shadingColor.rgb, alpha);
 	fragData[GBUFFER_EMITTEX_IDX] = vec4(0.0, 0.0, 0.0, 0.0);
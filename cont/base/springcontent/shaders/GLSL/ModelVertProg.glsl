@@ -7,6 +7,8 @@ layout(location = 3) in vec3 tTangentAttr;
 layout(location = 4) in vec2 texCoor0Attr;
 layout(location = 5) in vec2 texCoor1Attr;
 layout(location = 6) in uint pieceIdxAttr;
+// per-instance record index of a flying piece-part
+layout(location = 7) in uint flyingPartAttr;
 
 
 // #define use_normalmapping
@@ -25,6 +27,22 @@ uniform vec4 waterClipPlane;
 uniform vec4 upperClipPlane;
 uniform vec4 lowerClipPlane;
 
+uniform vec4 teamColor;
+
+// per-instance {teamColor, texLayers, modelMatrix, pieceMatrices[]} texel blocks
+// x := texel-offset of the first block, y := block size (0 if disabled)
+uniform samplerBuffer instanceData;
+uniform ivec2 instanceParams;
+
+// per-part {pieceMatrix, speed + spawn-frame, rotation axis + speed, teamColor} records
+// x := 1 if enabled, y := interpolated sim-frame, z := gravity
+uniform samplerBuffer flyingPieceData;
+uniform vec3 flyingPieceParams;
+
+
+flat out vec4 objTeamColor;
+// layers into the diffuse- and shading-texture arrays, negative if unpacked
+flat out vec2 objTexLayers;
 
 out vec4 worldPos;
 out vec3 cameraDir;
@@ -46,11 +64,78 @@ mat4 mat4mix(mat4 a, mat4 b, float alpha) {
 	return (a * (1.0 - alpha) + b * alpha);
 }
 
+mat4 FetchInstanceMatrix(int texel) {
+	return (mat4(
+		texelFetch(instanceData, texel + 0),
+		texelFetch(instanceData, texel + 1),
+		texelFetch(instanceData, texel + 2),
+		texelFetch(instanceData, texel + 3)
+	));
+}
+
+mat4 FlyingPieceMatrix(int texel) {
+	// stateless ballistic motion, see FlyingPiece::GetDragFactors
+	const float airDrag = 0.995;
+	const float invAirDrag = 1.0 / (1.0 - airDrag);
+
+	vec4 speedFrame = texelFetch(flyingPieceData, texel + 4);
+	vec4 rotation = texelFetch(flyingPieceData, texel + 5);
+
+	float age = max(flyingPieceParams.y - speedFrame.w, 0.0);
+	float airDragPowOne = pow(airDrag, age + 1.0);
+	float airDragPowTwo = airDragPowOne * airDrag;
+	float speedDrag = (1.0 - airDragPowOne) * invAirDrag;
+	float gravityDrag = age * speedDrag - (age * (airDragPowTwo - airDragPowOne) - airDragPowOne + airDrag) * invAirDrag * invAirDrag;
+
+	float sr = sin(rotation.w * age);
+	float cr = cos(rotation.w * age);
+
+	mat4 m = mat4(
+		texelFetch(flyingPieceData, texel + 0),
+		texelFetch(flyingPieceData, texel + 1),
+		texelFetch(flyingPieceData, texel + 2),
+		texelFetch(flyingPieceData, texel + 3)
+	);
+
+	// spin the basis around the part's axis, see CMatrix44f::Rotate
+	for (int i = 0; i < 3; i++) {
+		vec3 va = rotation.xyz * dot(m[i].xyz, rotation.xyz);
+		vec3 vp = m[i].xyz - va;
+
+		m[i].xyz = va + vp * cr + cross(rotation.xyz, vp) * sr;
+	}
+
+	m[3].xyz += (speedFrame.xyz * speedDrag + vec3(0.0, flyingPieceParams.z * gravityDrag, 0.0));
+	return m;
+}
+
 void main(void)
 {
 	// mat4 pieceMatrix = mat4mix(mat4(1.0), pieceMatrices[pieceIdxAttr], pieceMatrices[0][3][3]);
 	mat4 pieceMatrix = pieceMatrices[pieceIdxAttr];
-	mat4 modelPieceMatrix = modelMatrix * pieceMatrix;
+	mat4 objectMatrix = modelMatrix;
+
+	objTeamColor = teamColor;
+	objTexLayers = vec2(-1.0);
+
+	if (instanceParams.y > 0) {
+		int instanceTexel = instanceParams.x + gl_InstanceID * instanceParams.y;
+
+		objTeamColor = texelFetch(instanceData, instanceTexel);
+		objTexLayers = texelFetch(instanceData, instanceTexel + 1).xy;
+		objectMatrix = FetchInstanceMatrix(instanceTexel + 2);
+		pieceMatrix = FetchInstanceMatrix(instanceTexel + 6 + int(pieceIdxAttr) * 4);
+	}
+
+	if (flyingPieceParams.x > 0.0) {
+		// records are 7 texels wide, see CGPUFlyingPieceDrawer
+		int partTexel = int(flyingPartAttr) * 7;
+
+		objTeamColor = texelFetch(flyingPieceData, partTexel + 6);
+		objectMatrix = FlyingPieceMatrix(partTexel);
+	}
+
+	mat4 modelPieceMatrix = objectMatrix * pieceMatrix;
 
 	vec4 vertexPos = vec4(positionAttr, 1.0);
 	vec4 vertexModelPos = modelPieceMatrix * vertexPos;
@@ -4,6 +4,10 @@ uniform mat4 modelMat;
 uniform mat4 pieceMats[128];
 uniform vec4 shadowParams;
 
+// see ModelVertProg
+uniform samplerBuffer flyingPieceData;
+uniform vec3 flyingPieceParams;
+
 
 layout(location = 0) in vec3 positionAttr;
 // layout(location = 1) in vec3   normalAttr;
@@ -12,10 +16,50 @@ layout(location = 0) in vec3 positionAttr;
 // layout(location = 4) in vec2 texCoor0Attr;
 // layout(location = 5) in vec2 texCoor1Attr;
 layout(location = 6) in uint pieceIdxAttr;
+layout(location = 7) in uint flyingPartAttr;
+
+
+mat4 FlyingPieceMatrix(int texel) {
+	const float airDrag = 0.995;
+	const float invAirDrag = 1.0 / (1.0 - airDrag);
+
+	vec4 speedFrame = texelFetch(flyingPieceData, texel + 4);
+	vec4 rotation = texelFetch(flyingPieceData, texel + 5);
+
+	float age = max(flyingPieceParams.y - speedFrame.w, 0.0);
+	float airDragPowOne = pow(airDrag, age + 1.0);
+	float airDragPowTwo = airDragPowOne * airDrag;
+	float speedDrag = (1.0 - airDragPowOne) * invAirDrag;
+	float gravityDrag = age * speedDrag - (age * (airDragPowTwo - airDragPowOne) - airDragPowOne + airDrag) * invAirDrag * invAirDrag;
+
+	float sr = sin(rotation.w * age);
+	float cr = cos(rotation.w * age);
 
+	mat4 m = mat4(
+		texelFetch(flyingPieceData, texel + 0),
+		texelFetch(flyingPieceData, texel + 1),
+		texelFetch(flyingPieceData, texel + 2),
+		texelFetch(flyingPieceData, texel + 3)
+	);
+
+	for (int i = 0; i < 3; i++) {
+		vec3 va = rotation.xyz * dot(m[i].xyz, rotation.xyz);
+		vec3 vp = m[i].xyz - va;
+
+		m[i].xyz = va + vp * cr + cross(rotation.xyz, vp) * sr;
+	}
+
+	m[3].xyz += (speedFrame.xyz * speedDrag + vec3(0.0, flyingPieceParams.z * gravityDrag, 0.0));
+	return m;
+}
 
 void main() {
-	mat4 modelPieceMat = modelMat * pieceMats[pieceIdxAttr];
+	mat4 objectMat = modelMat;
+
+	if (flyingPieceParams.x > 0.0)
+		objectMat = FlyingPieceMatrix(int(flyingPartAttr) * 7);
+
+	mat4 modelPieceMat = objectMat * pieceMats[pieceIdxAttr];
 
 	vec4 vertexPos = vec4(positionAttr, 1.0);
 	vec4 vertexShadowPos = shadowViewMat * modelPieceMat * vertexPos;
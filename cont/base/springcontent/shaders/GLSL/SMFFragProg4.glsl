@@ -33,8 +33,21 @@ uniform vec4 fogColor;
 
 uniform mat4 viewMat;
 
+#ifdef USE_LIGHT_GRID
+// light-records in the same layout as fwdDynLights, binned per map-column (see GL::LightHandler)
+uniform samplerBuffer lightDataTex;
+// {offsets of each column's range of indices, light-indices}
+uniform usamplerBuffer lightGridTex;
+uniform vec2 lightGridScale;
+
+#define DYN_LIGHT_VEC(k) texelFetch(lightDataTex, (k))
+#else
+// fwdDynLights[i] := {pos, dir, diffuse, specular, ambient, {fov, radius, -, -}}
 uniform vec4 fwdDynLights[MAX_LIGHT_UNIFORM_VECS];
 
+#define DYN_LIGHT_VEC(k) fwdDynLights[(k)]
+#endif
+
 uniform ivec4 texSquare;
 
 
@@ -257,22 +270,33 @@ vec3 DynamicLighting(vec3 wsNormal, vec3 camDir, vec3 diffuseColor, vec4 specula
 	specularColor.rgb = vec3(0.5, 0.5, 0.5);
 	#endif
 
-	#if (NUM_DYNAMIC_MAP_LIGHTS > 0)
+	#if defined(USE_LIGHT_GRID)
+	// only the lights binned into this fragment's grid-column
+	ivec2 gridTile = clamp(ivec2(vertexPos.xz * lightGridScale), ivec2(0), ivec2(LIGHT_GRID_SIZE - 1));
+	int gridIndex = gridTile.y * LIGHT_GRID_SIZE + gridTile.x;
+	int gridBegin = int(texelFetch(lightGridTex, gridIndex    ).r);
+	int gridEnd   = int(texelFetch(lightGridTex, gridIndex + 1).r);
+
+	for (int k = gridBegin; k < gridEnd; k++) {
+		int j = int(texelFetch(lightGridTex, LIGHT_GRID_SIZE * LIGHT_GRID_SIZE + 1 + k).r) * 6;
+	#elif (NUM_DYNAMIC_MAP_LIGHTS > 0)
 	for (int i = 0; i < NUM_DYNAMIC_MAP_LIGHTS; i++) {
 		int j = i * 6;
+	#endif
 
-		vec4 wsLightPos = fwdDynLights[j + 0];
-		vec4 wsLightDir = fwdDynLights[j + 1];
+	#if defined(USE_LIGHT_GRID) || (NUM_DYNAMIC_MAP_LIGHTS > 0)
+		vec4 wsLightPos = DYN_LIGHT_VEC(j + 0);
+		vec4 wsLightDir = DYN_LIGHT_VEC(j + 1);
 
-		vec4 lightDiffColor = fwdDynLights[j + 2];
-		vec4 lightSpecColor = fwdDynLights[j + 3];
-		vec4 lightAmbiColor = fwdDynLights[j + 4];
+		vec4 lightDiffColor = DYN_LIGHT_VEC(j + 2);
+		vec4 lightSpecColor = DYN_LIGHT_VEC(j + 3);
+		vec4 lightAmbiColor = DYN_LIGHT_VEC(j + 4);
 
 		vec3 wsLightVec = normalize(wsLightPos.xyz - vertexPos.xyz);
 		vec3 wsHalfVec = normalize(camDir + wsLightVec);
 
-		float lightAngle    = fwdDynLights[j + 5].x; // fov
-		float lightRadius   = fwdDynLights[j + 5].y; // or const. atten.
+		float lightAngle    = DYN_LIGHT_VEC(j + 5).x; // fov
+		float lightRadius   = DYN_LIGHT_VEC(j + 5).y; // or const. atten.
 		float lightDistance = dot(wsLightVec, wsLightPos.xyz - vertexPos.xyz);
 
 		// clamp lightCosAngleSpec from 0.001 because pow(0, exp) produces undefined results
@@ -281,9 +305,9 @@ vec3 DynamicLighting(vec3 wsNormal, vec3 camDir, vec3 diffuseColor, vec4 specula
 
 		#ifdef OGL_SPEC_ATTENUATION
 		// infinite falloff
-		float cLightAtten = fwdDynLights[j + 5].y;
-		float lLightAtten = fwdDynLights[j + 5].z;
-		float qLightAtten = fwdDynLights[j + 5].w;
+		float cLightAtten = DYN_LIGHT_VEC(j + 5).y;
+		float lLightAtten = DYN_LIGHT_VEC(j + 5).z;
+		float qLightAtten = DYN_LIGHT_VEC(j + 5).w;
 		float  lightAtten = cLightAtten + lLightAtten * lightDistance + qLightAtten * lightDistance * lightDistance;
 		float  lightConst = 1.0;
 
@@ -0,0 +1,18 @@
+#version 410 core
+
+// generates the full-resolution vertices of one CGPUMeshDrawer patch,
+// captured through transform-feedback (the rasterizer is disabled)
+
+uniform sampler2D heightMapTex; // corner-heightmap, (mapx + 1) x (mapy + 1) texels
+uniform ivec3 patchParams;      // x, y := patch origin in heightmap texels, z := vertices per row
+
+out vec3 vertexPos;
+
+
+void main() {
+	ivec2 vertexIdx = ivec2(gl_VertexID % patchParams.z, gl_VertexID / patchParams.z);
+	ivec2 texelIdx = patchParams.xy + vertexIdx;
+
+	vertexPos = vec3(texelIdx.x * SQUARE_SIZE, texelFetch(heightMapTex, texelIdx, 0).r, texelIdx.y * SQUARE_SIZE);
+}
+
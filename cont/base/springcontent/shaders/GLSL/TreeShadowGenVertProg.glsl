@@ -12,6 +12,11 @@ uniform vec3 cameraDirX;
 uniform vec3 cameraDirY;
 
 
+// see TreeVertProg
+uniform samplerBuffer treeMatTex;
+uniform int treeMatOffset;
+
+
 layout(location = 0) in vec3 vtxPositionAttr; // vertexPosAttr
 layout(location = 1) in vec2 vtxTexCoordAttr; // texCoordAttr
 layout(location = 2) in vec3 vtxNormalAttr;   // normalVecAttr
@@ -20,7 +25,22 @@ out vec2 vTexCoord;
 out vec4 vBaseColor;
 
 
+mat4 GetTreeMatrix() {
+	if (treeMatOffset < 0)
+		return treeMat;
+
+	int texelIdx = treeMatOffset + gl_InstanceID * 4;
+
+	return mat4(
+		texelFetch(treeMatTex, texelIdx + 0),
+		texelFetch(treeMatTex, texelIdx + 1),
+		texelFetch(treeMatTex, texelIdx + 2),
+		texelFetch(treeMatTex, texelIdx + 3)
+	);
+}
+
 void main() {
+	mat4 treeMat = GetTreeMatrix();
 	vec4 vertexPos = vec4(vtxPositionAttr, 1.0);
 		vertexPos.xyz += (cameraDirX * vtxNormalAttr.x);
 		vertexPos.xyz += (cameraDirY * vtxNormalAttr.y);
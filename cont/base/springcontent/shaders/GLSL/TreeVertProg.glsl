@@ -4,6 +4,11 @@ uniform mat4 projMat;
 uniform mat4 viewMat;
 uniform mat4 treeMat;             // world-transform
 
+// instanced trees fetch their world-transform from here if treeMatOffset
+// (a texel index, four texels per tree) is non-negative
+uniform samplerBuffer treeMatTex;
+uniform int treeMatOffset;
+
 uniform vec3 cameraDirX;          // needed for bush-type trees
 uniform vec3 cameraDirY;
 
@@ -26,7 +31,22 @@ out vec4 vBaseColor;
 out float vFogFactor;
 
 
+mat4 GetTreeMatrix() {
+	if (treeMatOffset < 0)
+		return treeMat;
+
+	int texelIdx = treeMatOffset + gl_InstanceID * 4;
+
+	return mat4(
+		texelFetch(treeMatTex, texelIdx + 0),
+		texelFetch(treeMatTex, texelIdx + 1),
+		texelFetch(treeMatTex, texelIdx + 2),
+		texelFetch(treeMatTex, texelIdx + 3)
+	);
+}
+
 void main() {
+	mat4 treeMat = GetTreeMatrix();
 	vec4 vertexPos = vec4(vtxPositionAttr, 1.0);
 
 	vertexPos.xyz += (cameraDirX * vtxNormalAttr.x);
@@ -0,0 +1,16 @@
+#version 410 core
+
+uniform sampler2DArray u_icon_atlas_tex;
+
+in vec3 v_texcoor_stp;
+in vec4 v_color_rgba;
+
+layout(location = 0) out vec4 f_color_rgba;
+
+void main() {
+	f_color_rgba = texture(u_icon_atlas_tex, v_texcoor_stp) * v_color_rgba;
+
+	if (f_color_rgba.a <= 0.5)
+		discard;
+}
+
@@ -0,0 +1,35 @@
+#version 410 core
+
+// unit-space corner offsets in [-1, 1] plus texcoords of the shared quad
+layout(location = 0) in vec2 a_vertex_xy;
+layout(location = 1) in vec2 a_texcoor_st;
+
+uniform mat4 u_movi_mat;
+uniform mat4 u_proj_mat;
+
+uniform vec3 u_cam_right;
+uniform vec3 u_cam_up;
+
+// two texels per icon, {pos, radius} and {color, atlasLayer}
+uniform samplerBuffer u_icon_inst_tex;
+uniform int u_icon_inst_offset;
+
+out vec3 v_texcoor_stp;
+out vec4 v_color_rgba;
+
+void main() {
+	int texelIdx = u_icon_inst_offset + gl_InstanceID * 2;
+
+	vec4 posRadius = texelFetch(u_icon_inst_tex, texelIdx + 0);
+	vec4 colorLayer = texelFetch(u_icon_inst_tex, texelIdx + 1);
+
+	vec3 vertexPos = posRadius.xyz;
+	vertexPos += (u_cam_right * a_vertex_xy.x * posRadius.w);
+	vertexPos += (u_cam_up    * a_vertex_xy.y * posRadius.w);
+
+	gl_Position = u_proj_mat * u_movi_mat * vec4(vertexPos, 1.0);
+
+	v_texcoor_stp = vec3(a_texcoor_st, colorLayer.w);
+	v_color_rgba = vec4(colorLayer.rgb, 1.0);
+}
+
@@ -48,6 +48,11 @@ uniform mat4 shadowMatrix;
 
 uniform mat4 projMatrix;
 
+#ifdef opt_reflection
+// player view the reflection texture was rendered from, may lag behind
+uniform mat4 reflViewProjMatrix;
+#endif
+
 
 
 uniform float frame;
@@ -265,6 +270,10 @@ vec4 GetReflection(vec3 normal, float angle)
  	vec4 reflColor = vec4(0.0, 0.0, 0.0, 0.0);
 
 	#ifdef opt_reflection
+	// reproject in case the reflection was not updated this frame
+	vec4 reflClipPos = reflViewProjMatrix * vec4(worldPos, 1.0);
+	reftexcoord = (reflClipPos.xy / reflClipPos.w) * 0.5 + 0.5;
+
 	// we have to mirror the Y-axis
 	reftexcoord  = vec2(reftexcoord.x, 1.0 - reftexcoord.y);
 	reftexcoord += vec2(0.0, 3.0 * ScreenInverse.y) + normal.xz * 0.09 * ReflDistortion;
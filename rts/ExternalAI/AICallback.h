@@ -9,6 +9,11 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <memory>
+
+namespace netcode {
+	class RawPacket;
+}
 
 struct Command;
 struct UnitDef;
@@ -27,10 +32,14 @@ private:
 	int team = -1;
 
 	bool allowOrders = true;
+	bool holdPackets = false;
+
+	std::vector<std::shared_ptr<const netcode::RawPacket>> heldPackets;
 
 private:
 	// utility methods
 	void verify();
+	void SendPacket(std::shared_ptr<const netcode::RawPacket> packet);
 
 	/// Returns the unit if the ID is valid
 	CUnit* GetUnit(int unitId) const;
@@ -47,6 +56,12 @@ public:
 	CAICallback(int teamId);
 
 	void AllowOrders(bool b) { allowOrders = b; }
+	/**
+	 * While enabled, network packets (orders, shares, map drawings, ...)
+	 * are buffered instead of sent; disabling sends the buffered packets
+	 * in the order they were created.
+	 */
+	void HoldPackets(bool b);
 
 	void SendStartPos(bool ready, float3 pos);
 	void SendTextMsg(const char* text, int zone);
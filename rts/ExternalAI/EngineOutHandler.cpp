@@ -19,9 +19,11 @@
 #include "Sim/Units/CommandAI/Command.h"
 #include "Sim/Weapons/WeaponDef.h"
 #include "Net/Protocol/NetProtocol.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/TimeProfiler.h"
 #include "System/SafeUtil.h"
+#include "System/Threading/ThreadPool.h"
 
 
 CR_BIND(CEngineOutHandler, )
@@ -29,10 +31,13 @@ CR_REG_METADATA(CEngineOutHandler, (
 	CR_IGNORED(hostSkirmishAIs),
 	CR_IGNORED(teamSkirmishAIs),
 	CR_IGNORED(activeSkirmishAIs),
+	CR_IGNORED(threadedUpdate),
 
 	CR_POSTLOAD(PostLoad)
 ))
 
+CONFIG(bool, AIThreadedUpdate).defaultValue(false).description("Run the per-frame Update of local Skirmish AIs concurrently on worker threads. Only safe if the AI libraries in use are thread-safe across instances.");
+
 
 static inline bool IsUnitInLosOrRadarOfAllyTeam(const CUnit& unit, const int allyTeamId) {
 	// NOTE:
@@ -65,6 +70,12 @@ void CEngineOutHandler::Create() {
 	numInstances += 1;
 }
 
+void CEngineOutHandler::Init() {
+	activeSkirmishAIs.reserve(16);
+
+	threadedUpdate = configHandler->GetBool("AIThreadedUpdate");
+}
+
 void CEngineOutHandler::Destroy() {
 	if (numInstances != 1)
 		return;
@@ -112,6 +123,15 @@ void CEngineOutHandler::Load(std::istream* s, const uint8_t skirmishAIId) {
 	ai.Load(s);
 }
 
+void CEngineOutHandler::SetEventBatchMask(const uint8_t skirmishAIId, int eventMask) {
+	auto& ai = hostSkirmishAIs[skirmishAIId];
+
+	if (!ai.Active())
+		return;
+
+	ai.SetEventBatchMask(eventMask);
+}
+
 void CEngineOutHandler::Save(std::ostream* s, const uint8_t skirmishAIId) {
 	AI_SCOPED_TIMER();
 	LOG_L(L_INFO, "[EOH::%s(id=%u)] active=%d", __func__, skirmishAIId, hostSkirmishAIs[skirmishAIId].Active());
@@ -127,7 +147,24 @@ void CEngineOutHandler::Save(std::ostream* s, const uint8_t skirmishAIId) {
 
 void CEngineOutHandler::Update() {
 	AI_SCOPED_TIMER();
-	DO_FOR_SKIRMISH_AIS(Update(gs->frameNum))
+
+	if (!threadedUpdate || activeSkirmishAIs.size() == 1) {
+		DO_FOR_SKIRMISH_AIS(Update(gs->frameNum))
+		return;
+	}
+
+	// the sim is frozen while AIs update, so they can all read it at once;
+	// commands are serialized by the callback and the packets they create
+	// are held back until every AI has finished, then sent in AI order so
+	// the server receives the same sequence as with serial updates
+	// (events are still delivered serially, from where the sim raises them)
+	DO_FOR_SKIRMISH_AIS(HoldPackets(true))
+
+	for_mt(0, activeSkirmishAIs.size(), [&](const int i) {
+		hostSkirmishAIs[activeSkirmishAIs[i]].Update(gs->frameNum);
+	});
+
+	DO_FOR_SKIRMISH_AIS(HoldPackets(false))
 }
 
 
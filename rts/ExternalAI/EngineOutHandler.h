@@ -31,7 +31,7 @@ public:
 	static void Create();
 	static void Destroy();
 
-	void Init() { activeSkirmishAIs.reserve(16); }
+	void Init();
 	void Kill() {
 		PreDestroy();
 
@@ -102,6 +102,9 @@ public:
 	 */
 	void DestroySkirmishAI(const uint8_t skirmishAIId);
 
+	/// see SSetEventBatchMaskCommand
+	void SetEventBatchMask(const uint8_t skirmishAIId, int eventMask);
+
 	void Load(std::istream* s, const uint8_t skirmishAIId);
 	void Save(std::ostream* s, const uint8_t skirmishAIId);
 
@@ -116,6 +119,9 @@ private:
 	std::array<std::vector<uint8_t>, MAX_TEAMS> teamSkirmishAIs;
 
 	std::vector<uint8_t> activeSkirmishAIs;
+
+	/// if true, AIs run their per-frame Update concurrently
+	bool threadedUpdate = false;
 };
 
 #define eoh CEngineOutHandler::GetInstance()
@@ -140,8 +140,9 @@ enum CommandTopic {
 	COMMAND_DEBUG_DRAWER_OVERLAYTEXTURE_SET_LABEL = 94,
 	COMMAND_TRACE_RAY_FEATURE                     = 95,
 	COMMAND_CALL_LUA_UI                           = 96,
+	COMMAND_SET_EVENT_BATCH_MASK                  = 97,
 };
-const int NUM_CMD_TOPICS = 97;
+const int NUM_CMD_TOPICS = 98;
 
 
 /**
@@ -244,6 +245,7 @@ enum UnitCommandOptions {
 		+ sizeof(struct SCustomUnitCommand) \
 		+ sizeof(struct STraceRayCommand) \
 		+ sizeof(struct SPauseCommand) \
+		+ sizeof(struct SSetEventBatchMaskCommand) \
 		+ sizeof(struct SReclaimFeatureUnitCommand) \
 		+ sizeof(struct SSetPositionGraphDrawerDebugCommand) \
 		+ sizeof(struct SSetSizeGraphDrawerDebugCommand) \
@@ -1485,6 +1487,16 @@ struct SPauseCommand {
 	const char* reason;
 }; //$ COMMAND_PAUSE Game_setPause
 
+/**
+ * Selects the event topics that are delivered batched through EVENT_BATCH
+ * instead of one event each; bit (1 << topic) selects a topic.
+ * Bits of topics that can not be batched (see SBatchEvent) are ignored,
+ * 0 (the default) disables batching.
+ */
+struct SSetEventBatchMaskCommand {
+	int eventMask;
+}; //$ COMMAND_SET_EVENT_BATCH_MASK Game_setEventBatchMask
+
 
 struct SSetPositionGraphDrawerDebugCommand {
 	float x;
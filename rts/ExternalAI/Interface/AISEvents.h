@@ -56,8 +56,9 @@ enum EventTopic {
 	EVENT_ENEMY_CREATED                = 25,
 	EVENT_ENEMY_FINISHED               = 26,
 	EVENT_LUA_MESSAGE                  = 27,
+	EVENT_BATCH                        = 28,
 };
-const int NUM_EVENTS = 28;
+const int NUM_EVENTS = 29;
 
 
 
@@ -89,6 +90,7 @@ const int NUM_EVENTS = 28;
 		+ sizeof(struct SEnemyCreatedEvent) \
 		+ sizeof(struct SEnemyFinishedEvent) \
 		+ sizeof(struct SLuaMessageEvent) \
+		+ sizeof(struct SBatchEvent) \
 		)
 
 /**
@@ -396,6 +398,25 @@ struct SEnemyFinishedEvent {
 	int enemy;
 }; //$ EVENT_ENEMY_FINISHED INTERFACES:Unit(enemy),Enemy(enemy)
 
+/**
+ * This AI event carries all events of the topics selected with
+ * Game_setEventBatchMask() that occurred since the last update, in the
+ * order they were raised, instead of one handleEvent call per event.
+ * It is sent right before EVENT_UPDATE, and only if it contains events.
+ * events holds one record per event: the event topic, the number of values
+ * that follow, then the members of the corresponding S*Event struct in
+ * declaration order, each as one int: floats bit-cast, bools as 0 or 1 and
+ * float3 members (*_posF3) expanded to three floats.
+ * Only events without strings or arrays can be batched, that is the unit,
+ * enemy, weapon-fired, command-finished and seismic-ping events.
+ */
+struct SBatchEvent {
+	int* events;
+	int events_size;
+	/// number of records in events
+	int numEvents;
+}; //$ EVENT_BATCH
+
 #ifdef	__cplusplus
 } // extern "C"
 #endif
@@ -1633,6 +1633,68 @@ struct SSkirmishAICallback {
 	/** @see getRadarMap() */
 	int               (CALLING_CONV *Map_getSonarJammerMap)(int skirmishAIId, int* sonarJammerValues, int sonarJammerValues_sizeMax); //$ ARRAY:sonarJammerValues
 
+	/**
+	 * @brief snapshot of all units visible to this AI
+	 * The snapshot is taken on the first call of a frame and shared by all
+	 * Map_getUnitSnapshot* functions during that frame, so the arrays they
+	 * return are parallel: index i always refers to the unit at
+	 * getUnitSnapshotIds()[i].
+	 * Contains the units of this teams ally-team plus all enemy and neutral
+	 * units in LOS or radar; if cheats are enabled, all units on the map.
+	 * Fetching one array per frame replaces one callback per unit and value
+	 * for AIs that track many units.
+	 * @return the number of units (array elements) in the snapshot
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotIds)(int skirmishAIId, int* unitIds, int unitIds_sizeMax); //$ FETCHER:MULTI:IDs:Unit:unitIds
+
+	/**
+	 * @brief the frame in which the current snapshot was taken
+	 * @see getUnitSnapshotIds()
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotFrame)(int skirmishAIId);
+
+	/**
+	 * @brief the unit-def of each snapshot unit, -1 if it is not known
+	 * (radar-only enemies that were never seen); decoys as in Unit_getDef()
+	 * @see getUnitSnapshotIds()
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotDefs)(int skirmishAIId, int* unitDefIds, int unitDefIds_sizeMax); //$ ARRAY:unitDefIds
+
+	/**
+	 * @brief the team of each snapshot unit, -1 for enemies not in LOS
+	 * @see getUnitSnapshotIds()
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotTeams)(int skirmishAIId, int* teamIds, int teamIds_sizeMax); //$ ARRAY:teamIds
+
+	/**
+	 * @brief the sensor state of each snapshot unit, a bit-field of:
+	 * - 1: unit is in this teams ally-team
+	 * - 2: unit is in LOS
+	 * - 4: unit is in radar
+	 * - 8: unit is being built
+	 * @see getUnitSnapshotIds()
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotFlags)(int skirmishAIId, int* flags, int flags_sizeMax); //$ ARRAY:flags
+
+	/**
+	 * @brief the health of each snapshot unit, -1 for enemies not in LOS
+	 * @see getUnitSnapshotIds()
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotHealths)(int skirmishAIId, float* healths, int healths_sizeMax); //$ ARRAY:healths
+
+	/**
+	 * @brief the position of each snapshot unit, three values per unit;
+	 * includes the radar error for radar-only enemies as in Unit_getPos()
+	 * @see getUnitSnapshotIds()
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotPositions)(int skirmishAIId, float* positions_AposF3, int positions_AposF3_sizeMax); //$ ARRAY:positions_AposF3
+
+	/**
+	 * @brief the velocity of each snapshot unit, three values per unit
+	 * @see getUnitSnapshotIds()
+	 */
+	int               (CALLING_CONV *Map_getUnitSnapshotVelocities)(int skirmishAIId, float* velocities_AposF3, int velocities_AposF3_sizeMax); //$ ARRAY:velocities_AposF3
+
 	/**
 	 * @brief resource maps
 	 * This map shows the resource density on the map.
@@ -1744,6 +1806,25 @@ struct SSkirmishAICallback {
 	 */
 	int               (CALLING_CONV *Map_getSpeedModMap)(int skirmishAIId, int speedModClass, float* speedMods, int speedMods_sizeMax); //$ ARRAY:speedMods
 
+	/**
+	 * Returns the connected areas of the map for units using the MoveData
+	 * with the given path-type, considering terrain only (no structures or
+	 * features).
+	 *
+	 * - 0 means not passable, squares with the same value > 0 are
+	 *   reachable from each other
+	 * - index 0 is top left
+	 * - each data position is 2*2 in size (relative to heightmap)
+	 * - the value for the full resolution position (x, z) is at index ((z * width + x) / 2)
+	 * - the last value, bottom right, is at index (width/2 * height/2 - 1)
+	 *
+	 * The map is computed once per path-type and terrain state and
+	 * shared by all AIs, instead of each sampling the slope map itself.
+	 *
+	 * @see MoveData#getPathType
+	 */
+	int               (CALLING_CONV *Map_getMoveAreaMap)(int skirmishAIId, int pathType, int* areaIds, int areaIds_sizeMax); //$ ARRAY:areaIds
+
 	/**
 	 * Returns all points drawn with this AIs team color,
 	 * and additionally the ones drawn with allied team colors,
@@ -3,6 +3,7 @@
 #include "ExternalAI/AICallback.h"
 #include "ExternalAI/AICheats.h"
 #include "ExternalAI/AILibraryManager.h"
+#include "ExternalAI/EngineOutHandler.h"
 #include "ExternalAI/SSkirmishAICallbackImpl.h"
 #include "ExternalAI/SkirmishAILibraryInfo.h"
 #include "ExternalAI/SkirmishAIWrapper.h"
@@ -29,6 +30,7 @@
 #include "Game/UI/Groups/Group.h"
 #include "Game/UI/Groups/GroupHandler.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Features/FeatureDefHandler.h"
 #include "Sim/Features/FeatureHandler.h"
@@ -36,6 +38,7 @@
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "Sim/Misc/CategoryHandler.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/Resource.h"
 #include "Sim/Misc/ResourceHandler.h"
 #include "Sim/Misc/ResourceMapAnalyzer.h"
@@ -45,6 +48,7 @@
 #include "Sim/Misc/QuadField.h" // for quadField.GetFeaturesExact(pos, radius)
 #include "System/SafeCStrings.h"
 #include "System/SpringMath.h"
+#include "System/Threading/SpringThreading.h"
 #include "System/FileSystem/ArchiveScanner.h"
 #include "System/Log/ILog.h"
 
@@ -61,6 +65,10 @@ static std::vector<LineMarker> AI_TMP_LINE_MARKERS[MAX_AIS];
 
 static constexpr size_t MAX_NUM_MARKERS = 16384;
 
+// commands can modify sim state (cheats, pathing, Lua calls); serializes
+// them when AIs run their Update concurrently, see CEngineOutHandler
+static spring::recursive_mutex AI_COMMAND_MUTEX;
+
 
 static inline CAICallback* GetCallBack(int skirmishAIId) { return &AI_LEGACY_CALLBACKS[skirmishAIId].first; }
 static inline CAICheats* GetCheatCallBack(int skirmishAIId) { return &AI_LEGACY_CALLBACKS[skirmishAIId].second; }
@@ -645,6 +653,8 @@ EXPORT(int) skirmishAiCallback_Engine_handleCommand(
 	int commandTopic,
 	void* commandData
 ) {
+	std::lock_guard<spring::recursive_mutex> lock(AI_COMMAND_MUTEX);
+
 	int ret = 0;
 
 	CAICallback* clb = GetCallBack(skirmishAIId);
@@ -963,6 +973,11 @@ EXPORT(int) skirmishAiCallback_Engine_handleCommand(
 			wrapper_HandleCommand(clb, clbCheat, AIHCPauseId, &cppCmdData);
 		} break;
 
+		case COMMAND_SET_EVENT_BATCH_MASK: {
+			const SSetEventBatchMaskCommand* cmd = static_cast<SSetEventBatchMaskCommand*>(commandData);
+			eoh->SetEventBatchMask(skirmishAIId, cmd->eventMask);
+		} break;
+
 		case COMMAND_DEBUG_DRAWER_GRAPH_LINE_ADD_POINT: {
 			SAddPointLineGraphDrawerDebugCommand* cCmdData = static_cast<SAddPointLineGraphDrawerDebugCommand*>(commandData);
 			AIHCDebugDraw cppCmdData = {
@@ -1997,6 +2012,125 @@ GET_SENSOR_MAP(Jammer, jammer)
 // skirmishAiCallback_Map_getSonarJammerMap
 GET_SENSOR_MAP(SonarJammer, sonarJammer)
 
+
+struct UnitSnapshot {
+	int frame = -1;
+	bool cheating = false;
+
+	std::vector<int> unitIds;
+	std::vector<int> unitDefIds;
+	std::vector<int> teamIds;
+	std::vector<int> flags;
+	std::vector<float> healths;
+	std::vector<float> positions;
+	std::vector<float> velocities;
+};
+
+static std::array<UnitSnapshot, MAX_AIS> AI_UNIT_SNAPSHOTS;
+
+static const UnitSnapshot& getUnitSnapshot(int skirmishAIId) {
+	UnitSnapshot& snapshot = AI_UNIT_SNAPSHOTS[skirmishAIId];
+
+	const bool cheating = skirmishAiCallback_Cheats_isEnabled(skirmishAIId);
+
+	// taken at most once per frame, all getters then copy from the same state
+	if (snapshot.frame == gs->frameNum && snapshot.cheating == cheating)
+		return snapshot;
+
+	snapshot.frame = gs->frameNum;
+	snapshot.cheating = cheating;
+
+	snapshot.unitIds.clear();
+	snapshot.unitDefIds.clear();
+	snapshot.teamIds.clear();
+	snapshot.flags.clear();
+	snapshot.healths.clear();
+	snapshot.positions.clear();
+	snapshot.velocities.clear();
+
+	const int allyTeam = teamHandler.AllyTeam(AI_TEAM_IDS[skirmishAIId]);
+
+	for (const CUnit* unit: unitHandler.GetActiveUnits()) {
+		const UnitDef* unitDef = unit->unitDef;
+		const UnitDef* decoyDef = unitDef->decoyDef;
+
+		const unsigned short losStatus = unit->losStatus[allyTeam];
+		const unsigned short prevMask = (LOS_PREVLOS | LOS_CONTRADAR);
+
+		const bool allied = teamHandler.Ally(unit->allyteam, allyTeam);
+		const bool inLos = cheating || allied || ((losStatus & LOS_INLOS) != 0);
+		const bool inRadar = cheating || allied || ((losStatus & LOS_INRADAR) != 0);
+
+		if (!inLos && !inRadar)
+			continue;
+
+		// same per-value visibility rules as the single-unit getters
+		const bool knownDef = inLos || ((losStatus & prevMask) == prevMask);
+		const bool useDecoy = !cheating && !allied && (decoyDef != nullptr);
+
+		const float3 pos = (cheating || allied)? unit->midPos: unit->GetErrorPos(allyTeam);
+
+		int unitFlags = 0;
+		unitFlags |= (allied << 0);
+		unitFlags |= (inLos << 1);
+		unitFlags |= (inRadar << 2);
+		unitFlags |= ((inLos && unit->beingBuilt) << 3);
+
+		snapshot.unitIds.push_back(unit->id);
+		snapshot.unitDefIds.push_back(knownDef? (useDecoy? decoyDef: unitDef)->id: -1);
+		snapshot.teamIds.push_back(inLos? unit->team: -1);
+		snapshot.flags.push_back(unitFlags);
+		snapshot.healths.push_back(inLos? (useDecoy? unit->health * (decoyDef->health / unitDef->health): unit->health): -1.0f);
+		snapshot.positions.insert(snapshot.positions.end(), {pos.x, pos.y, pos.z});
+		snapshot.velocities.insert(snapshot.velocities.end(), {unit->speed.x, unit->speed.y, unit->speed.z});
+	}
+
+	return snapshot;
+}
+
+template<typename T>
+static int copyUnitSnapshotValues(const std::vector<T>& values, T* dst, int dstMaxSize) {
+	if (dst == nullptr)
+		return values.size();
+
+	const int size = std::min(int(values.size()), std::max(0, dstMaxSize));
+
+	std::copy(values.begin(), values.begin() + size, dst);
+	return size;
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotIds(int skirmishAIId, int* unitIds, int unitIdsMaxSize) {
+	return copyUnitSnapshotValues(getUnitSnapshot(skirmishAIId).unitIds, unitIds, unitIdsMaxSize);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotFrame(int skirmishAIId) {
+	return getUnitSnapshot(skirmishAIId).frame;
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotDefs(int skirmishAIId, int* unitDefIds, int unitDefIdsMaxSize) {
+	return copyUnitSnapshotValues(getUnitSnapshot(skirmishAIId).unitDefIds, unitDefIds, unitDefIdsMaxSize);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotTeams(int skirmishAIId, int* teamIds, int teamIdsMaxSize) {
+	return copyUnitSnapshotValues(getUnitSnapshot(skirmishAIId).teamIds, teamIds, teamIdsMaxSize);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotFlags(int skirmishAIId, int* flags, int flagsMaxSize) {
+	return copyUnitSnapshotValues(getUnitSnapshot(skirmishAIId).flags, flags, flagsMaxSize);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotHealths(int skirmishAIId, float* healths, int healthsMaxSize) {
+	return copyUnitSnapshotValues(getUnitSnapshot(skirmishAIId).healths, healths, healthsMaxSize);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotPositions(int skirmishAIId, float* positions, int positionsMaxSize) {
+	return copyUnitSnapshotValues(getUnitSnapshot(skirmishAIId).positions, positions, positionsMaxSize);
+}
+
+EXPORT(int) skirmishAiCallback_Map_getUnitSnapshotVelocities(int skirmishAIId, float* velocities, int velocitiesMaxSize) {
+	return copyUnitSnapshotValues(getUnitSnapshot(skirmishAIId).velocities, velocities, velocitiesMaxSize);
+}
+
 EXPORT(int) skirmishAiCallback_Map_getResourceMapRaw(
 	int skirmishAIId,
 	int resourceId,
@@ -2201,6 +2335,106 @@ EXPORT(int) skirmishAiCallback_Map_getSpeedModMap(
 }
 
 
+struct MoveAreaMap {
+	// terrain state the labels were computed for
+	unsigned int mapChecksum = 0;
+	unsigned int moveDefChecksum = 0;
+	unsigned int heightMapVersion = -1u;
+
+	std::vector<int> areaIds;
+};
+
+// indexed by path-type, shared by all AIs
+static std::vector<MoveAreaMap> AI_MOVE_AREA_MAPS;
+static spring::mutex AI_MOVE_AREA_MAPS_MUTEX;
+
+static void calcMoveAreaMap(const MoveDef& moveDef, std::vector<int>& areaIds) {
+	const int sizeX = mapDims.hmapx;
+	const int sizeZ = mapDims.hmapy;
+
+	std::vector<int> queue;
+
+	areaIds.clear();
+	areaIds.resize(sizeX * sizeZ, -1);
+
+	// same terrain test as the path-finder, at the resolution of the speed-mod data
+	for (int z = 0; z < sizeZ; z++) {
+		for (int x = 0; x < sizeX; x++) {
+			if (CMoveMath::GetPosSpeedMod(moveDef, x * 2, z * 2) <= 0.0f)
+				areaIds[z * sizeX + x] = 0;
+		}
+	}
+
+	// label 4-connected passable areas with consecutive ids
+	int numAreas = 0;
+
+	for (int i = 0, n = sizeX * sizeZ; i < n; i++) {
+		if (areaIds[i] != -1)
+			continue;
+
+		areaIds[i] = ++numAreas;
+		queue.clear();
+		queue.push_back(i);
+
+		while (!queue.empty()) {
+			const int j = queue.back();
+			const int x = j % sizeX;
+			const int z = j / sizeX;
+
+			queue.pop_back();
+
+			const auto Visit = [&](int k) {
+				if (areaIds[k] != -1)
+					return;
+
+				areaIds[k] = numAreas;
+				queue.push_back(k);
+			};
+
+			if (x >         0) Visit(j -     1);
+			if (x < sizeX - 1) Visit(j +     1);
+			if (z >         0) Visit(j - sizeX);
+			if (z < sizeZ - 1) Visit(j + sizeX);
+		}
+	}
+}
+
+EXPORT(int) skirmishAiCallback_Map_getMoveAreaMap(
+	int skirmishAIId,
+	int pathType,
+	int* areaIds,
+	int areaIdsMaxSize
+) {
+	if (pathType < 0 || pathType >= int(moveDefHandler.GetNumMoveDefs()))
+		return 0;
+
+	const int areaIdsRealSize = mapDims.hmapx * mapDims.hmapy;
+
+	if (areaIds == nullptr)
+		return areaIdsRealSize;
+
+	std::lock_guard<spring::mutex> lock(AI_MOVE_AREA_MAPS_MUTEX);
+
+	AI_MOVE_AREA_MAPS.resize(std::max(AI_MOVE_AREA_MAPS.size(), size_t(moveDefHandler.GetNumMoveDefs())));
+
+	MoveAreaMap& map = AI_MOVE_AREA_MAPS[pathType];
+
+	// recomputed only if the map, the move-defs or the terrain changed
+	if (map.mapChecksum != readMap->GetMapChecksum() || map.moveDefChecksum != moveDefHandler.GetCheckSum() || map.heightMapVersion != readMap->GetSyncedHeightMapVersion()) {
+		map.mapChecksum = readMap->GetMapChecksum();
+		map.moveDefChecksum = moveDefHandler.GetCheckSum();
+		map.heightMapVersion = readMap->GetSyncedHeightMapVersion();
+
+		calcMoveAreaMap(*moveDefHandler.GetMoveDefByPathType(pathType), map.areaIds);
+	}
+
+	const int areaIdsSize = std::min(areaIdsRealSize, std::max(0, areaIdsMaxSize));
+
+	std::copy(map.areaIds.begin(), map.areaIds.begin() + areaIdsSize, areaIds);
+	return areaIdsSize;
+}
+
+
 EXPORT(bool) skirmishAiCallback_Map_isPossibleToBuildAt(int skirmishAIId, int unitDefId, float* pos_posF3, int facing) {
 	return GetCallBack(skirmishAIId)->CanBuildAt(getUnitDefById(skirmishAIId, unitDefId), pos_posF3, facing);
 }
@@ -5448,6 +5682,14 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->Map_getSeismicMap = &skirmishAiCallback_Map_getSeismicMap;
 	callback->Map_getJammerMap = &skirmishAiCallback_Map_getJammerMap;
 	callback->Map_getSonarJammerMap = &skirmishAiCallback_Map_getSonarJammerMap;
+	callback->Map_getUnitSnapshotIds = &skirmishAiCallback_Map_getUnitSnapshotIds;
+	callback->Map_getUnitSnapshotFrame = &skirmishAiCallback_Map_getUnitSnapshotFrame;
+	callback->Map_getUnitSnapshotDefs = &skirmishAiCallback_Map_getUnitSnapshotDefs;
+	callback->Map_getUnitSnapshotTeams = &skirmishAiCallback_Map_getUnitSnapshotTeams;
+	callback->Map_getUnitSnapshotFlags = &skirmishAiCallback_Map_getUnitSnapshotFlags;
+	callback->Map_getUnitSnapshotHealths = &skirmishAiCallback_Map_getUnitSnapshotHealths;
+	callback->Map_getUnitSnapshotPositions = &skirmishAiCallback_Map_getUnitSnapshotPositions;
+	callback->Map_getUnitSnapshotVelocities = &skirmishAiCallback_Map_getUnitSnapshotVelocities;
 	callback->Map_getResourceMapRaw = &skirmishAiCallback_Map_getResourceMapRaw;
 	callback->Map_getResourceMapSpotsPositions = &skirmishAiCallback_Map_getResourceMapSpotsPositions;
 	callback->Map_getResourceMapSpotsAverageIncome = &skirmishAiCallback_Map_getResourceMapSpotsAverageIncome;
@@ -5468,6 +5710,7 @@ static void skirmishAiCallback_init(SSkirmishAICallback* callback) {
 	callback->Map_getHardness = &skirmishAiCallback_Map_getHardness;
 	callback->Map_getHardnessModMap = &skirmishAiCallback_Map_getHardnessModMap;
 	callback->Map_getSpeedModMap = &skirmishAiCallback_Map_getSpeedModMap;
+	callback->Map_getMoveAreaMap = &skirmishAiCallback_Map_getMoveAreaMap;
 	callback->Map_getPoints = &skirmishAiCallback_Map_getPoints;
 	callback->Map_Point_getPosition = &skirmishAiCallback_Map_Point_getPosition;
 	callback->Map_Point_getColor = &skirmishAiCallback_Map_Point_getColor;
@@ -5650,6 +5893,7 @@ void skirmishAiCallback_Release(const CSkirmishAIWrapper* ai) {
 
 	AI_CHEAT_FLAGS[ai->GetSkirmishAIID()] = {false, false};
 	AI_TEAM_IDS[ai->GetSkirmishAIID()] = -1;
+	AI_UNIT_SNAPSHOTS[ai->GetSkirmishAIID()] = {};
 }
 
 void skirmishAiCallback_BlockOrders(const CSkirmishAIWrapper* ai)
@@ -5657,3 +5901,8 @@ void skirmishAiCallback_BlockOrders(const CSkirmishAIWrapper* ai)
 	GetCallBack(ai->GetSkirmishAIID())->AllowOrders(false);
 }
 
+void skirmishAiCallback_HoldPackets(const CSkirmishAIWrapper* ai, bool hold)
+{
+	GetCallBack(ai->GetSkirmishAIID())->HoldPackets(hold);
+}
+
@@ -910,6 +910,22 @@ EXPORT(int              ) skirmishAiCallback_Map_getJammerMap(int skirmishAIId,
 
 EXPORT(int              ) skirmishAiCallback_Map_getSonarJammerMap(int skirmishAIId, int* sonarJammerValues, int sonarJammerValues_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotIds(int skirmishAIId, int* unitIds, int unitIds_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotFrame(int skirmishAIId);
+
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotDefs(int skirmishAIId, int* unitDefIds, int unitDefIds_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotTeams(int skirmishAIId, int* teamIds, int teamIds_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotFlags(int skirmishAIId, int* flags, int flags_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotHealths(int skirmishAIId, float* healths, int healths_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotPositions(int skirmishAIId, float* positions_AposF3, int positions_AposF3_sizeMax);
+
+EXPORT(int              ) skirmishAiCallback_Map_getUnitSnapshotVelocities(int skirmishAIId, float* velocities_AposF3, int velocities_AposF3_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Map_getResourceMapRaw(int skirmishAIId, int resourceId, short* resources, int resources_sizeMax);
 
 EXPORT(int              ) skirmishAiCallback_Map_getResourceMapSpotsPositions(int skirmishAIId, int resourceId, float* spots_AposF3, int spots_AposF3_sizeMax);
@@ -946,6 +962,8 @@ EXPORT(int              ) skirmishAiCallback_Map_getHardnessModMap(int skirmishA
 
 EXPORT(int              ) skirmishAiCallback_Map_getSpeedModMap(int skirmishAIId, int speedModClass, float* speedMods, int speedMods_sizeMax);
 
+EXPORT(int              ) skirmishAiCallback_Map_getMoveAreaMap(int skirmishAIId, int pathType, int* areaIds, int areaIds_sizeMax);
+
 EXPORT(int              ) skirmishAiCallback_Map_getPoints(int skirmishAIId, bool includeAllies);
 
 EXPORT(void             ) skirmishAiCallback_Map_Point_getPosition(int skirmishAIId, int pointId, float* return_posF3_out);
@@ -1330,6 +1348,7 @@ SSkirmishAICallback* skirmishAiCallback_GetInstance(CSkirmishAIWrapper* ai);
 void skirmishAiCallback_Release(const CSkirmishAIWrapper* ai);
 
 void skirmishAiCallback_BlockOrders(const CSkirmishAIWrapper* ai);
+void skirmishAiCallback_HoldPackets(const CSkirmishAIWrapper* ai, bool hold);
 
 #endif // defined __cplusplus && !defined BUILDING_AI
 
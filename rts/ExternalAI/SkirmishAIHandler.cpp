@@ -29,7 +29,6 @@ CR_REG_METADATA(CSkirmishAIHandler, (
 	CR_MEMBER(skirmishAIDataMap),
 	CR_MEMBER(luaAIShortNames),
 
-	CR_IGNORED(currentAIId),
 	CR_IGNORED(numSkirmishAIs),
 
 	CR_MEMBER(gameInitialized)
@@ -38,6 +37,8 @@ CR_REG_METADATA(CSkirmishAIHandler, (
 
 CSkirmishAIHandler skirmishAIHandler;
 
+thread_local uint8_t CSkirmishAIHandler::currentAIId = MAX_AIS;
+
 
 void CSkirmishAIHandler::ResetState()
 {
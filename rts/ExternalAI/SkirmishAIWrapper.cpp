@@ -25,6 +25,7 @@
 #include "System/TimeProfiler.h"
 #include "System/StringUtil.h"
 
+#include <cstring>
 #include <string>
 #include <sstream>
 #include <iostream>
@@ -74,6 +75,10 @@ void CSkirmishAIWrapper::PreInit(int aiID)
 
 		cheatEvents = false;
 		blockEvents = false;
+
+		eventBatchMask = 0;
+		numBatchedEvents = 0;
+		eventBatch.clear();
 	}
 	{
 		const std::string& kn = key.GetShortName();
@@ -98,6 +103,26 @@ void CSkirmishAIWrapper::PreDestroy() {
 	skirmishAiCallback_BlockOrders(this);
 }
 
+void CSkirmishAIWrapper::HoldPackets(bool hold) {
+	skirmishAiCallback_HoldPackets(this, hold);
+}
+
+void CSkirmishAIWrapper::SetEventBatchMask(int mask) {
+	// events without strings or arrays, see SBatchEvent
+	constexpr int batchableEvents =
+		(1 << EVENT_UNIT_CREATED) | (1 << EVENT_UNIT_FINISHED) | (1 << EVENT_UNIT_IDLE) |
+		(1 << EVENT_UNIT_MOVE_FAILED) | (1 << EVENT_UNIT_DAMAGED) | (1 << EVENT_UNIT_DESTROYED) |
+		(1 << EVENT_UNIT_GIVEN) | (1 << EVENT_UNIT_CAPTURED) |
+		(1 << EVENT_ENEMY_ENTER_LOS) | (1 << EVENT_ENEMY_LEAVE_LOS) |
+		(1 << EVENT_ENEMY_ENTER_RADAR) | (1 << EVENT_ENEMY_LEAVE_RADAR) |
+		(1 << EVENT_ENEMY_DAMAGED) | (1 << EVENT_ENEMY_DESTROYED) |
+		(1 << EVENT_ENEMY_CREATED) | (1 << EVENT_ENEMY_FINISHED) |
+		(1 << EVENT_WEAPON_FIRED) | (1 << EVENT_COMMAND_FINISHED) | (1 << EVENT_SEISMIC_PING);
+
+	// already buffered events are still sent with the next update
+	eventBatchMask = mask & batchableEvents;
+}
+
 
 void CSkirmishAIWrapper::CreateCallback() {
 	library = nullptr;
@@ -296,6 +321,7 @@ void CSkirmishAIWrapper::Save(std::ostream* saveStream)
 	const SSaveEvent evtData = {tmpFile.c_str()};
 
 	assert(Active());
+	SendEventBatch();
 	HandleEvent(EVENT_SAVE, &evtData);
 
 	if (!FileSystem::FileExists(tmpFile))
@@ -314,22 +340,64 @@ void CSkirmishAIWrapper::Save(std::ostream* saveStream)
 
 
 
+static inline int EventBatchValue(int value) { return value; }
+static inline int EventBatchValue(bool value) { return value; }
+static inline int EventBatchValue(float value) {
+	int bits;
+	std::memcpy(&bits, &value, sizeof(bits));
+	return bits;
+}
+
+template<typename... T> bool CSkirmishAIWrapper::BatchEvent(int topic, T... values) {
+	if (blockEvents || (eventBatchMask & (1 << topic)) == 0)
+		return false;
+
+	eventBatch.insert(eventBatch.end(), {topic, int(sizeof...(values)), EventBatchValue(values)...});
+	numBatchedEvents += 1;
+	return true;
+}
+
+void CSkirmishAIWrapper::SendEventBatch() {
+	if (numBatchedEvents == 0)
+		return;
+
+	const SBatchEvent evtData = {eventBatch.data(), static_cast<int>(eventBatch.size()), numBatchedEvents};
+
+	HandleEvent(EVENT_BATCH, &evtData);
+
+	eventBatch.clear();
+	numBatchedEvents = 0;
+}
+
+
 void CSkirmishAIWrapper::UnitIdle(int unitId) {
+	if (BatchEvent(EVENT_UNIT_IDLE, unitId))
+		return;
+
 	const SUnitIdleEvent evtData = {unitId};
 	HandleEvent(EVENT_UNIT_IDLE, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitCreated(int unitId, int builderId) {
+	if (BatchEvent(EVENT_UNIT_CREATED, unitId, builderId))
+		return;
+
 	const SUnitCreatedEvent evtData = {unitId, builderId};
 	HandleEvent(EVENT_UNIT_CREATED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitFinished(int unitId) {
+	if (BatchEvent(EVENT_UNIT_FINISHED, unitId))
+		return;
+
 	const SUnitFinishedEvent evtData = {unitId};
 	HandleEvent(EVENT_UNIT_FINISHED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitDestroyed(int unitId, int attackerUnitId) {
+	if (BatchEvent(EVENT_UNIT_DESTROYED, unitId, attackerUnitId))
+		return;
+
 	const SUnitDestroyedEvent evtData = {unitId, attackerUnitId};
 	HandleEvent(EVENT_UNIT_DESTROYED, &evtData);
 }
@@ -342,6 +410,9 @@ void CSkirmishAIWrapper::UnitDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
+	if (BatchEvent(EVENT_UNIT_DAMAGED, unitId, attackerUnitId, damage, dir.x, dir.y, dir.z, weaponDefId, paralyzer))
+		return;
+
 	float3 cpyDir = dir;
 	const SUnitDamagedEvent evtData = {unitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
@@ -349,52 +420,82 @@ void CSkirmishAIWrapper::UnitDamaged(
 }
 
 void CSkirmishAIWrapper::UnitMoveFailed(int unitId) {
+	if (BatchEvent(EVENT_UNIT_MOVE_FAILED, unitId))
+		return;
+
 	const SUnitMoveFailedEvent evtData = {unitId};
 	HandleEvent(EVENT_UNIT_MOVE_FAILED, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitGiven(int unitId, int oldTeam, int newTeam) {
+	if (BatchEvent(EVENT_UNIT_GIVEN, unitId, oldTeam, newTeam))
+		return;
+
 	const SUnitGivenEvent evtData = {unitId, oldTeam, newTeam};
 	HandleEvent(EVENT_UNIT_GIVEN, &evtData);
 }
 
 void CSkirmishAIWrapper::UnitCaptured(int unitId, int oldTeam, int newTeam) {
+	if (BatchEvent(EVENT_UNIT_CAPTURED, unitId, oldTeam, newTeam))
+		return;
+
 	const SUnitCapturedEvent evtData = {unitId, oldTeam, newTeam};
 	HandleEvent(EVENT_UNIT_CAPTURED, &evtData);
 }
 
 
 void CSkirmishAIWrapper::EnemyCreated(int unitId) {
+	if (BatchEvent(EVENT_ENEMY_CREATED, unitId))
+		return;
+
 	const SEnemyCreatedEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_CREATED, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyFinished(int unitId) {
+	if (BatchEvent(EVENT_ENEMY_FINISHED, unitId))
+		return;
+
 	const SEnemyFinishedEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_FINISHED, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyEnterLOS(int unitId) {
+	if (BatchEvent(EVENT_ENEMY_ENTER_LOS, unitId))
+		return;
+
 	const SEnemyEnterLOSEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_ENTER_LOS, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveLOS(int unitId) {
+	if (BatchEvent(EVENT_ENEMY_LEAVE_LOS, unitId))
+		return;
+
 	const SEnemyLeaveLOSEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_LEAVE_LOS, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyEnterRadar(int unitId) {
+	if (BatchEvent(EVENT_ENEMY_ENTER_RADAR, unitId))
+		return;
+
 	const SEnemyEnterRadarEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_ENTER_RADAR, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyLeaveRadar(int unitId) {
+	if (BatchEvent(EVENT_ENEMY_LEAVE_RADAR, unitId))
+		return;
+
 	const SEnemyLeaveRadarEvent evtData = {unitId};
 	HandleEvent(EVENT_ENEMY_LEAVE_RADAR, &evtData);
 }
 
 void CSkirmishAIWrapper::EnemyDestroyed(int enemyUnitId, int attackerUnitId) {
+	if (BatchEvent(EVENT_ENEMY_DESTROYED, enemyUnitId, attackerUnitId))
+		return;
+
 	const SEnemyDestroyedEvent evtData = {enemyUnitId, attackerUnitId};
 	HandleEvent(EVENT_ENEMY_DESTROYED, &evtData);
 }
@@ -407,6 +508,9 @@ void CSkirmishAIWrapper::EnemyDamaged(
 	int weaponDefId,
 	bool paralyzer
 ) {
+	if (BatchEvent(EVENT_ENEMY_DAMAGED, enemyUnitId, attackerUnitId, damage, dir.x, dir.y, dir.z, weaponDefId, paralyzer))
+		return;
+
 	float3 cpyDir = dir;
 	const SEnemyDamagedEvent evtData = {enemyUnitId, attackerUnitId, damage, &cpyDir[0], weaponDefId, paralyzer};
 
@@ -414,6 +518,8 @@ void CSkirmishAIWrapper::EnemyDamaged(
 }
 
 void CSkirmishAIWrapper::Update(int frame) {
+	SendEventBatch();
+
 	const SUpdateEvent evtData = {frame};
 	HandleEvent(EVENT_UPDATE, &evtData);
 }
@@ -429,6 +535,9 @@ void CSkirmishAIWrapper::SendLuaMessage(const char* inData, const char** outData
 }
 
 void CSkirmishAIWrapper::WeaponFired(int unitId, int weaponDefId) {
+	if (BatchEvent(EVENT_WEAPON_FIRED, unitId, weaponDefId))
+		return;
+
 	const SWeaponFiredEvent evtData = {unitId, weaponDefId};
 	HandleEvent(EVENT_WEAPON_FIRED, &evtData);
 }
@@ -447,6 +556,9 @@ void CSkirmishAIWrapper::PlayerCommandGiven(
 }
 
 void CSkirmishAIWrapper::CommandFinished(int unitId, int commandId, int commandTopicId) {
+	if (BatchEvent(EVENT_COMMAND_FINISHED, unitId, commandId, commandTopicId))
+		return;
+
 	const SCommandFinishedEvent evtData = {unitId, commandId, commandTopicId};
 	HandleEvent(EVENT_COMMAND_FINISHED, &evtData);
 }
@@ -457,6 +569,9 @@ void CSkirmishAIWrapper::SeismicPing(
 	const float3& pos,
 	float strength
 ) {
+	if (BatchEvent(EVENT_SEISMIC_PING, pos.x, pos.y, pos.z, strength))
+		return;
+
 	/*const*/ float3 cpyPos = pos;
 	const SSeismicPingEvent evtData = {&cpyPos[0], strength};
 
@@ -102,6 +102,18 @@ public:
 	void SetBlockEvents(bool enable) { blockEvents = enable; }
 	void SetCheatEvents(bool enable) { cheatEvents = enable; }
 
+	/**
+	 * While enabled, network packets created by this AI's callback
+	 * (orders, shares, ...) are held back; disabling sends them.
+	 */
+	void HoldPackets(bool hold);
+
+	/**
+	 * Events whose topic bit is set in <mask> are buffered and sent
+	 * together as one EVENT_BATCH before the next update.
+	 */
+	void SetEventBatchMask(int mask);
+
 	bool CheatEventsEnabled() const { return cheatEvents; }
 
 	bool Active() const { return (skirmishAIId != -1); }
@@ -118,6 +130,9 @@ private:
 	 */
 	int HandleEvent(int topic, const void* data) const;
 
+	template<typename... T> bool BatchEvent(int topic, T... values);
+	void SendEventBatch();
+
 	uint32_t GetTimerNameHash() const { return *reinterpret_cast<const uint32_t*>(&timerName[0]); }
 
 	const char* GetTimerName() const { return (timerName + sizeof(uint32_t)); }
@@ -141,6 +156,12 @@ private:
 	bool libraryInit = false; // CSkirmishAILibrary::Init retval
 	bool cheatEvents = false;
 	bool blockEvents = false;
+
+	int eventBatchMask = 0;
+	int numBatchedEvents = 0;
+
+	// records of batched events, see SBatchEvent
+	std::vector<int> eventBatch;
 };
 
 #endif // SKIRMISH_AI_WRAPPER_H
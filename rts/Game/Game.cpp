@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/TimerQueries.h"
 
 #include "Game.h"
 #include "Camera.h"
@@ -9,10 +10,14 @@
 #include "CommandMessage.h"
 #include "ConsoleHistory.h"
 #include "GameHelper.h"
+#include "GameVersion.h"
 #include "GameSetup.h"
 #include "GlobalUnsynced.h"
 #include "LoadScreen.h"
+#include "LoadStages.h"
 #include "SelectedUnitsHandler.h"
+#include "SimFrameWatchdog.h"
+#include "StressTest.h"
 #include "WaitCommandsAI.h"
 #include "WordCompletion.h"
 #include "IVideoCapturing.h"
@@ -43,8 +48,10 @@
 #include "Rendering/HUDDrawer.h"
 #include "Rendering/IconHandler.h"
 #include "Rendering/TeamHighlight.h"
+#include "Rendering/Screenshot.h"
 #include "Rendering/UnitDrawer.h"
 #include "Rendering/Map/InfoTexture/IInfoTextureHandler.h"
+#include "Rendering/Models/IModelParser.h"
 #include "Rendering/Textures/NamedTextures.h"
 #include "Lua/LuaGaia.h"
 #include "Lua/LuaHandle.h"
@@ -65,6 +72,7 @@
 #include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/CategoryHandler.h"
 #include "Sim/Misc/DamageArrayHandler.h"
+#include "Sim/Misc/DrawSnapshot.h"
 #include "Sim/Misc/GeometricObjects.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/BuildingMaskMap.h"
@@ -106,21 +114,37 @@
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
+#include "System/MemoryStats.h"
 #include "System/Sync/FPUCheck.h"
 #include "System/SafeUtil.h"
 #include "System/SpringExitCode.h"
 #include "System/SpringMath.h"
+#include "System/FileSystem/ArchiveScanner.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/FileSystem/VFSHandler.h"
+#include "System/FileSystem/VFSTrace.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/LoadSave/CregLoadSaveHandler.h"
+#include "System/LoadSave/DemoBatch.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Log/ILog.h"
+#include "System/Net/UnpackPacket.h"
 #include "System/Platform/Misc.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
 #include "System/Sync/DumpState.h"
+#include "System/Sync/SHA512.hpp"
+#include "System/Sync/SyncChecker.h"
 #include "System/TimeProfiler.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
 
 #undef CreateDirectory
 
@@ -136,6 +160,13 @@ CONFIG(bool, ShowSpeed).defaultValue(false).description("Displays current game s
 CONFIG(int, ShowPlayerInfo).defaultValue(1).headlessValue(0);
 CONFIG(float, GuiOpacity).defaultValue(0.8f).minimumValue(0.0f).maximumValue(1.0f).description("Sets the opacity of the built-in Spring UI. Generally has no effect on LuaUI widgets. Can be set in-game using shift+, to decrease and shift+. to increase.");
 CONFIG(std::string, InputTextGeo).defaultValue("");
+CONFIG(int, CatchUpMinDrawFPS).defaultValue(10).minimumValue(CGlobalUnsynced::minDrawFPS).description("Framerate kept up while a client runs extra sim-frames to catch up with the server (after reconnecting or a lag spike).");
+CONFIG(float, CatchUpTargetTime).defaultValue(30.0f).minimumValue(1.0f).description("Seconds a client that fell behind the server aims to take to catch up, if it can simulate fast enough without dropping below CatchUpMinDrawFPS.");
+CONFIG(float, FramePacingSimBudget).defaultValue(0.0f).minimumValue(0.0f).description("If positive, enables frame-pacing: at most this many milliseconds of each drawn frame are spent running sim-frames (one always runs when due), and units are drawn interpolated between their last two sim states at a steady rate instead of snapping back when a sim-frame runs long.");
+CONFIG(bool, DefsSnapshotCache).defaultValue(true).description("Store the gamedata/defs.lua tables (after all post-processing) on disk and reuse them on the next load with the same game, map, mutators, options and engine.");
+CONFIG(bool, LoadingModelPreload).defaultValue(true).description("Parse the models of all unit- and feature-defs on worker threads while the rest of the game is loading.");
+CONFIG(int, VFSTraceMode).defaultValue(0).minimumValue(0).maximumValue(2).description("Trace the VFS file reads made while loading to cache/vfstrace/. 0 = off, 1 = record, 2 = also prefetch the files each load stage read in the previous trace for the same game and map.");
+CONFIG(int, DemoSnapshotInterval).defaultValue(0).minimumValue(0).description("Minutes of game-time between the sim-state snapshots embedded in recorded demos, which let replays skip ahead without simulating every frame. 0 disables snapshots.");
 
 
 CGame* game = nullptr;
@@ -199,11 +230,23 @@ CR_REG_METADATA(CGame, (
 
 	CR_MEMBER(speedControl),
 	CR_MEMBER(luaGCControl),
+	CR_IGNORED(demoSnapshotInterval),
+	CR_IGNORED(gameStateBuffer),
+	CR_IGNORED(gameStateReceived),
+	CR_IGNORED(catchUpFrames),
+	CR_IGNORED(catchUpStartLag),
+	CR_IGNORED(catchUpLag),
+	CR_IGNORED(catchUpMinDrawFPS),
+	CR_IGNORED(catchUpTargetTime),
+	CR_IGNORED(catchUpStartTime),
+	CR_IGNORED(framePacingSimBudget),
+	CR_IGNORED(pacedTimeOffset),
 
 	CR_IGNORED(jobDispatcher),
 	CR_IGNORED(curKeyChain),
 	CR_IGNORED(worldDrawer),
 	CR_IGNORED(saveFileHandler),
+	CR_IGNORED(reloadStateHandler),
 
 	// Post Load
 	CR_POSTLOAD(PostLoad)
@@ -241,6 +284,11 @@ CGame::CGame(const std::string& mapFileName, const std::string& modFileName, ILo
 	showSpeed = configHandler->GetBool("ShowSpeed");
 
 	speedControl = configHandler->GetInt("SpeedControl");
+	demoSnapshotInterval = configHandler->GetInt("DemoSnapshotInterval") * 60 * GAME_SPEED;
+
+	catchUpMinDrawFPS = configHandler->GetInt("CatchUpMinDrawFPS");
+	catchUpTargetTime = configHandler->GetFloat("CatchUpTargetTime");
+	framePacingSimBudget = configHandler->GetFloat("FramePacingSimBudget");
 
 	playerRoster.SetSortTypeByCode((PlayerRoster::SortType)configHandler->GetInt("ShowPlayerInfo"));
 
@@ -290,6 +338,7 @@ CGame::~CGame()
 
 	LOG("[Game::%s][2]", __func__);
 	spring::SafeDelete(saveFileHandler); // ILoadSaveHandler, depends on vfsHandler via ~IArchive
+	spring::SafeDelete(reloadStateHandler);
 
 	LOG("[Game::%s][3]", __func__);
 	CCategoryHandler::RemoveInstance();
@@ -340,6 +389,27 @@ void CGame::AddTimedJobs()
 	}
 }
 
+static void StartVFSTrace(int traceMode)
+{
+	if (traceMode == VFSTrace::MODE_OFF)
+		return;
+
+	// one trace per game and map, replayed on their next load
+	sha512::msg_vector msg;
+	sha512::raw_digest digest;
+	sha512::hex_digest hexDigest;
+
+	for (const std::string& archive: {gameSetup->modName, gameSetup->mapName}) {
+		const sha512::raw_digest& checksum = archiveScanner->GetArchiveCompleteChecksumBytes(archiveScanner->ArchiveFromName(archive));
+		msg.insert(msg.end(), checksum.begin(), checksum.end());
+	}
+
+	sha512::calc_digest(msg, digest);
+	sha512::dump_digest(digest, hexDigest);
+
+	VFSTrace::Start(FileSystem::GetCacheDir() + "/vfstrace/" + std::string(hexDigest.data(), 32) + ".txt", traceMode);
+}
+
 void CGame::Load(const std::string& mapFileName)
 {
 	// NOTE:
@@ -348,6 +418,8 @@ void CGame::Load(const std::string& mapFileName)
 	//   when LoadingMT=1 (!!!)
 	Threading::SetGameLoadThread();
 	Watchdog::RegisterThread(WDT_LOAD);
+	LoadStages::Reset();
+	StartVFSTrace(configHandler->GetInt("VFSTraceMode"));
 
 	GL::SetAttribStatePointer(Threading::IsMainThread());
 	GL::SetMatrixStatePointer(Threading::IsMainThread());
@@ -415,6 +487,12 @@ void CGame::Load(const std::string& mapFileName)
 			LOG("[Game::%s][5] globalQuit=%d forcedQuit=%d", __func__, globalQuit.load(), forcedQuit);
 
 			LoadFinalize();
+
+			if (gu->precomputePathCache) {
+				LOG("[Game::%s][5] path-cache precomputed, quitting", __func__);
+				globalQuit = true;
+			}
+
 			LoadSkirmishAIs();
 		} catch (const content_error& e) {
 			LOG_L(L_WARNING, "[Game::%s][5] forced quit with exception \"%s\"", __func__, e.what());
@@ -448,6 +526,10 @@ void CGame::Load(const std::string& mapFileName)
 	if (forcedQuit)
 		spring::exitCode = spring::EXIT_CODE_NOLOAD;
 
+	LoadStages::WaitAll();
+	LoadStages::Log();
+	VFSTrace::Stop();
+
 	loadDone = true;
 	globalQuit = globalQuit | forcedQuit;
 }
@@ -455,6 +537,8 @@ void CGame::Load(const std::string& mapFileName)
 
 void CGame::LoadMap(const std::string& mapFileName)
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	ENTER_SYNCED_CODE();
 
 	{
@@ -469,15 +553,118 @@ void CGame::LoadMap(const std::string& mapFileName)
 
 		// half size; building positions are snapped to multiples of BUILD_SQUARE_SIZE
 		buildingMaskMap.Init(mapDims.hmapx * mapDims.hmapy);
-		groundBlockingObjectMap.Init(mapDims.mapSquares);
+		groundBlockingObjectMap.Init(mapDims.mapx, mapDims.mapy);
 	}
 
 	LEAVE_SYNCED_CODE();
 }
 
 
+static std::string GetDefsSnapshotFileName()
+{
+	// the defs tables are a function of exactly these inputs
+	std::vector<std::string> archives = {gameSetup->modName, gameSetup->mapName};
+	std::vector<std::pair<std::string, std::string>> options;
+
+	archives.insert(archives.end(), gameSetup->GetMutatorsCont().begin(), gameSetup->GetMutatorsCont().end());
+	options.insert(options.end(), CGameSetup::GetModOptions().begin(), CGameSetup::GetModOptions().end());
+	options.insert(options.end(), CGameSetup::GetMapOptions().begin(), CGameSetup::GetMapOptions().end());
+	options.emplace_back("", "");
+
+	// mod- and map-options are separated by the empty pair
+	std::sort(options.begin(), options.begin() + CGameSetup::GetModOptions().size());
+	std::sort(options.begin() + CGameSetup::GetModOptions().size(), options.end() - 1);
+
+	sha512::msg_vector msg;
+	sha512::raw_digest digest;
+	sha512::hex_digest hexDigest;
+
+	const std::string& version = SpringVersion::GetFull();
+
+	msg.insert(msg.end(), version.begin(), version.end());
+	msg.push_back(0);
+
+	for (const std::string& archive: archives) {
+		const sha512::raw_digest& checksum = archiveScanner->GetArchiveCompleteChecksumBytes(archiveScanner->ArchiveFromName(archive));
+		msg.insert(msg.end(), checksum.begin(), checksum.end());
+	}
+
+	for (const auto& option: options) {
+		msg.insert(msg.end(), option.first.begin(), option.first.end());
+		msg.push_back(0);
+		msg.insert(msg.end(), option.second.begin(), option.second.end());
+		msg.push_back(0);
+	}
+
+	sha512::calc_digest(msg, digest);
+	sha512::dump_digest(digest, hexDigest);
+
+	return (FileSystem::GetCacheDir() + "/defs/" + std::string(hexDigest.data(), 32) + ".bin");
+}
+
+static bool LoadDefsSnapshot(LuaParser* defsParser, const std::string& fileName)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(fileName), std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	const std::string snapshot((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (!defsParser->ExecuteSnapshot(snapshot)) {
+		LOG_L(L_WARNING, "[Game::%s] ignoring defs snapshot \"%s\" (%s)", __func__, fileName.c_str(), defsParser->GetErrorLog().c_str());
+		return false;
+	}
+
+	LOG("[Game::%s] loaded defs snapshot \"%s\"", __func__, fileName.c_str());
+	return true;
+}
+
+static void SaveDefsSnapshot(LuaParser* defsParser, const std::string& fileName)
+{
+	// a snapshot would skip the synced RNG draws made by the defs code
+	if (defsParser->UsedSyncedRandom()) {
+		LOG("[Game::%s] defs called math.random, not storing a snapshot", __func__);
+		return;
+	}
+
+	std::string snapshot;
+
+	if (!defsParser->GetRootSnapshot(snapshot)) {
+		LOG("[Game::%s] defs contain non-data values, not storing a snapshot", __func__);
+		return;
+	}
+
+	FileSystem::CreateDirectory(FileSystem::GetDirectory(fileName));
+
+	const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+	const std::string tempPath = filePath + ".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return;
+
+		file.write(snapshot.data(), snapshot.size());
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return;
+		}
+	}
+
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0)
+		std::remove(tempPath.c_str());
+}
+
 void CGame::LoadDefs(LuaParser* defsParser)
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	ENTER_SYNCED_CODE();
 
 	{
@@ -491,9 +678,20 @@ void CGame::LoadDefs(LuaParser* defsParser)
 		defsParser->AddFunc("GetMapOptions", LuaSyncedRead::GetMapOptions);
 		defsParser->EndTable();
 
-		// run the parser
-		if (!defsParser->Execute())
-			throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
+		const bool useSnapshot = configHandler->GetBool("DefsSnapshotCache");
+		const std::string& snapshotName = useSnapshot? GetDefsSnapshotFileName(): "";
+
+		// run the parser, unless an earlier load left the finished tables behind
+		if (!useSnapshot || !LoadDefsSnapshot(defsParser, snapshotName)) {
+			// defs.lua includes (nearly) all of these, read them in one parallel batch
+			vfsHandler->PrefetchFiles({"gamedata/", "units/", "weapons/", "features/"}, CVFSHandler::Mod);
+
+			if (!defsParser->Execute())
+				throw content_error("Defs-Parser: " + defsParser->GetErrorLog());
+
+			if (useSnapshot)
+				SaveDefsSnapshot(defsParser, snapshotName);
+		}
 
 		const LuaTable& root = defsParser->GetRoot();
 
@@ -543,6 +741,8 @@ void CGame::LoadDefs(LuaParser* defsParser)
 
 void CGame::PreLoadSimulation(LuaParser* defsParser)
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	ENTER_SYNCED_CODE();
 
 	loadscreen->SetLoadMessage("Creating Smooth Height Mesh");
@@ -557,6 +757,8 @@ void CGame::PreLoadSimulation(LuaParser* defsParser)
 
 void CGame::PostLoadSimulation(LuaParser* defsParser)
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	CommonDefHandler::InitStatic();
 
 	{
@@ -575,6 +777,9 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 		featureDefHandler->Init(defsParser);
 	}
 
+	if (configHandler->GetBool("LoadingModelPreload"))
+		PreloadDefModels();
+
 	CUnit::InitStatic();
 	CCommandAI::InitCommandDescriptionCache();
 	CUnitScriptFactory::InitStatic();
@@ -626,8 +831,32 @@ void CGame::PostLoadSimulation(LuaParser* defsParser)
 }
 
 
+void CGame::PreloadDefModels()
+{
+	std::vector<std::string> modelNames;
+
+	for (const UnitDef& ud: unitDefHandler->GetUnitDefsVec()) {
+		modelNames.push_back(ud.modelName);
+	}
+	for (const FeatureDef& fd: featureDefHandler->GetFeatureDefsVec()) {
+		modelNames.push_back(fd.modelName);
+	}
+
+	std::sort(modelNames.begin(), modelNames.end());
+	modelNames.erase(std::unique(modelNames.begin(), modelNames.end()), modelNames.end());
+
+	// parse the models while map features, the PFS and Lua are being loaded; their
+	// render data is uploaded in-game a few models per frame, or on first use
+	LoadStages::RunAsync("PreloadDefModels", [names = std::move(modelNames)]() {
+		modelLoader.PreloadModels(names);
+	});
+}
+
+
 void CGame::PreLoadRendering()
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	geometricObjects = new CGeometricObjects();
 
 	// load components that need to exist before PostLoadSimulation
@@ -635,12 +864,16 @@ void CGame::PreLoadRendering()
 }
 
 void CGame::PostLoadRendering() {
+	const LoadStages::Scope loadStage(__func__);
+
 	worldDrawer.InitPost();
 }
 
 
 void CGame::LoadInterface()
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	camHandler->Init();
 	mouse->ReloadCursors();
 
@@ -728,6 +961,8 @@ void CGame::LoadInterface()
 
 void CGame::LoadLua(bool onlySynced, bool onlyUnsynced)
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	assert(!(onlySynced && onlyUnsynced));
 	// Lua components
 	ENTER_SYNCED_CODE();
@@ -740,6 +975,9 @@ void CGame::LoadLua(bool onlySynced, bool onlyUnsynced)
 	CSplitLuaHandle* handles[] = {luaRules, luaGaia};
 	decltype(&CLuaRules::LoadFreeHandler) loaders[] = {CLuaRules::LoadFreeHandler, CLuaGaia::LoadFreeHandler};
 
+	if (!onlyUnsynced)
+		vfsHandler->PrefetchFiles({"luarules/", "luagaia/"}, CVFSHandler::Mod);
+
 	for (int i = 0; i < 2; i++) {
 		loadscreen->SetLoadMessage("Loading " + prefix + names[i]);
 
@@ -760,6 +998,8 @@ void CGame::LoadLua(bool onlySynced, bool onlyUnsynced)
 
 void CGame::LoadSkirmishAIs()
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	if (gameSetup->hostDemo)
 		return;
 	// happens if LoadInterface was skipped or interrupted on forcedQuit
@@ -784,6 +1024,8 @@ void CGame::LoadSkirmishAIs()
 
 void CGame::LoadFinalize()
 {
+	const LoadStages::Scope loadStage(__func__);
+
 	if (saveFileHandler == nullptr) {
 		ENTER_SYNCED_CODE();
 		eventHandler.GamePreload();
@@ -805,6 +1047,8 @@ void CGame::LoadFinalize()
 		);
 	}
 
+	SimFrameWatchdog::Init();
+
 	lastReadNetTime = spring_gettime();
 	lastSimFrameTime = lastReadNetTime;
 	lastDrawFrameTime = lastReadNetTime;
@@ -856,6 +1100,7 @@ void CGame::KillMisc()
 	LOG("[Game::%s][1]", __func__);
 	CEndGameBox::Destroy();
 	IVideoCapturing::FreeInstance();
+	KillScreenshots();
 
 	LOG("[Game::%s][2]", __func__);
 	// delete this first since AI's might call back into sim-components in their dtors
@@ -897,6 +1142,8 @@ void CGame::KillSimulation()
 {
 	LOG("[Game::%s][1]", __func__);
 
+	SimFrameWatchdog::Kill();
+
 	// Kill all teams that are still alive, in
 	// case the game did not do so through Lua.
 	//
@@ -912,6 +1159,7 @@ void CGame::KillSimulation()
 
 	featureHandler.Kill(); // depends on unitHandler (via ~CFeature)
 	unitHandler.Kill();
+	drawSnapshot.Kill();
 	projectileHandler.Kill();
 
 	LOG("[Game::%s][3]", __func__);
@@ -1088,6 +1336,12 @@ bool CGame::Update()
 
 	LEAVE_SYNCED_CODE();
 
+	// the server broadcasts everything before flagging the end, only our queue can still hold frames
+	if (DemoBatch::IsWorker() && gameServer != nullptr && gameServer->ReachedDemoEnd() && clientNet->GetNumWaitingServerPackets() == 0) {
+		DemoBatch::Finish(gs->frameNum);
+		gu->globalQuit = true;
+	}
+
 	{
 		SLuaAllocError error = {};
 
@@ -1146,6 +1400,8 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 			gu->simFPS = (gs->frameNum - lsf) / (diffMilliSecs * 0.001f);
 			lsft = currentTime;
 			lsf = gs->frameNum;
+
+			MemoryStats::Update();
 		}
 	}
 
@@ -1163,11 +1419,25 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 	numDrawFrames++;
 
 	// Update the interpolation coefficient (globalRendering->timeOffset)
-	if (!gs->paused && !IsSimLagging() && !gs->PreSimFrame() && !videoCapturing->AllowRecord()) {
+	if (!gs->paused && (framePacingSimBudget > 0.0f || !IsSimLagging()) && !gs->PreSimFrame() && !videoCapturing->AllowRecord()) {
 		globalRendering->weightedSpeedFactor = 0.001f * gu->simFPS;
-		globalRendering->timeOffset = (currentTime - lastFrameTime).toMilliSecsf() * globalRendering->weightedSpeedFactor;
+
+		if (framePacingSimBudget > 0.0f) {
+			// advance by the drawn frame's duration at the nominal sim rate rather than
+			// measuring from the start of the last sim-frame, and hold at the newest sim
+			// state instead of extrapolating past it while the next one is late
+			pacedTimeOffset = std::min(pacedTimeOffset + deltaDrawFrameTime.toMilliSecsf() * 0.001f * GAME_SPEED * gs->speedFactor, 1.0f);
+			globalRendering->timeOffset = pacedTimeOffset;
+		} else {
+			globalRendering->timeOffset = (currentTime - lastFrameTime).toMilliSecsf() * globalRendering->weightedSpeedFactor;
+		}
 	} else {
 		globalRendering->timeOffset = videoCapturing->GetTimeOffset();
+		pacedTimeOffset = globalRendering->timeOffset;
+
+		// no sim-frames publish while paused, but synced Lua can still move units
+		if (gs->paused)
+			drawSnapshot.Publish();
 
 		lastSimFrameTime = currentTime;
 		lastFrameTime = currentTime;
@@ -1190,6 +1460,7 @@ bool CGame::UpdateUnsynced(const spring_time currentTime)
 	// set camera
 	camHandler->UpdateController(playerHandler.Player(gu->myPlayerNum), gu->fpsMode, fullscreenEdgeMove, windowedEdgeMove);
 
+	drawSnapshot.Acquire();
 	unitDrawer->Update();
 	lineDrawer.UpdateLineStipple();
 
@@ -1257,6 +1528,8 @@ bool CGame::Draw() {
 
 	SCOPED_SPECIAL_TIMER("Draw");
 	globalRendering->SetGLTimeStamp(CGlobalRendering::FRAME_REF_TIME_QUERY_IDX);
+	GL::UpdateTimerQueries();
+	glAttribStatePtr->ResetFrameStats();
 
 	SetDrawMode(Game::NormalDraw);
 
@@ -1342,6 +1615,8 @@ bool CGame::Draw() {
 
 	glAttribStatePtr->EnableDepthTest();
 
+	UpdateScreenshots();
+
 	if (videoCapturing->AllowRecord()) {
 		videoCapturing->SetLastFrameTime(globalRendering->lastFrameTime = 1000.0f / GAME_SPEED);
 		// does nothing unless StartCapturing has also been called via /createvideo (Windows-only)
@@ -1372,6 +1647,7 @@ void CGame::DrawInputReceivers()
 		{
 			// this has MANUAL ordering, draw it last (front-most)
 			SCOPED_TIMER("Draw::Screen::DrawScreen");
+			SCOPED_GL_TIMER("Draw::Screen::DrawScreen");
 			luaInputReceiver->Draw();
 		}
 	} else {
@@ -1415,6 +1691,13 @@ void CGame::DrawInterfaceWidgets()
 		smallFont->glFormat(0.99f, 0.90f, 1.0f, INF_FONT_FLAGS | FONT_BUFFERED, "%2.2f", gs->speedFactor);
 	}
 
+	if (catchUpFrames > 0) {
+		const float progress = 1.0f - catchUpLag / std::max(1.0f, catchUpStartLag * 1.0f);
+
+		smallFont->SetTextColor(1.0f, 0.5f, 0.25f, 1.0f);
+		smallFont->glFormat(0.5f, 0.80f, 1.5f, KEY_FONT_FLAGS | FONT_BUFFERED, "Catching up: %.1f seconds behind (%.0f%%)", catchUpLag / float(GAME_SPEED), std::max(0.0f, progress) * 100.0f);
+	}
+
 	CPlayerRosterDrawer::Draw();
 	smallFont->DrawBufferedGL4();
 }
@@ -1466,6 +1749,19 @@ void CGame::StartPlaying()
 
 	if (saveFileHandler == nullptr)
 		eventHandler.GameStart();
+
+	if (DemoBatch::IsWorker()) {
+		// replay as fast as we can simulate, the server throttles on our cpu-usage
+		clientNet->Send(CommandMessage("setmaxspeed 100", gu->myPlayerNum).Pack());
+		clientNet->Send(CBaseNetProtocol::Get().SendUserSpeed(gu->myPlayerNum, 100.0f));
+
+		DemoBatch::StartReplay();
+	}
+
+	if (StressTest::IsActive()) {
+		clientNet->Send(CommandMessage("setmaxspeed 100", gu->myPlayerNum).Pack());
+		clientNet->Send(CBaseNetProtocol::Get().SendUserSpeed(gu->myPlayerNum, 100.0f));
+	}
 }
 
 
@@ -1479,6 +1775,7 @@ void CGame::SimFrame() {
 	// note: starts at -1, first actual frame is 0
 	gs->frameNum += 1;
 	lastFrameTime = spring_gettime();
+	pacedTimeOffset = std::max(pacedTimeOffset - 1.0f, 0.0f);
 
 	// clear allocator statistics periodically
 	// note: allocator itself should do this (so that
@@ -1503,6 +1800,10 @@ void CGame::SimFrame() {
 		CTeamHighlight::Update(gs->frameNum);
 	}
 
+	// outside of the Sim timer it samples
+	StressTest::SimFrame(gs->frameNum);
+	SimFrameWatchdog::BeginFrame(gs->frameNum);
+
 	// everything from here is simulation
 	{
 		SCOPED_SPECIAL_TIMER("Sim");
@@ -1515,17 +1816,31 @@ void CGame::SimFrame() {
 			if (luaGCControl == 0)
 				eventHandler.CollectGarbage(false);
 
+			SCOPED_SYNC_LANE(SYNC_LANE_LUA);
 			eventHandler.GameFrame(gs->frameNum);
 		}
 
 		helper->Update();
 		mapDamage->Update();
-		pathManager->Update();
-		unitHandler.Update();
-		projectileHandler.Update();
-		featureHandler.Update();
+		{
+			SCOPED_SYNC_LANE(SYNC_LANE_PATH);
+			pathManager->Update();
+		}
+		{
+			SCOPED_SYNC_LANE(SYNC_LANE_UNITS);
+			unitHandler.Update();
+		}
+		{
+			SCOPED_SYNC_LANE(SYNC_LANE_PROJECTILES);
+			projectileHandler.Update();
+		}
+		{
+			SCOPED_SYNC_LANE(SYNC_LANE_FEATURES);
+			featureHandler.Update();
+		}
 		{
 			SCOPED_TIMER("Sim::Script");
+			SCOPED_SYNC_LANE(SYNC_LANE_UNITS);
 			unitScriptEngine->Tick(33);
 		}
 		envResHandler.Update();
@@ -1540,6 +1855,9 @@ void CGame::SimFrame() {
 		playerHandler.GameFrame(gs->frameNum);
 	}
 
+	drawSnapshot.Publish();
+	SimFrameWatchdog::EndFrame(gs->frameNum);
+
 	lastSimFrameTime = spring_gettime();
 	gu->avgSimFrameTime = mix(gu->avgSimFrameTime, (lastSimFrameTime - lastFrameTime).toMilliSecsf(), 0.05f);
 	gu->avgSimFrameTime = std::max(gu->avgSimFrameTime, 0.001f);
@@ -1621,7 +1939,7 @@ void CGame::GameEnd(const std::vector<unsigned char>& winningAllyTeams, bool tim
 	}
 	for (int i = 0; i < numTeams; ++i) {
 		const CTeam* team = teamHandler.Team(i);
-		record->SetTeamStats(i, team->statHistory);
+		record->SetTeamStats(i, team->statHistory, team->GetCurrentStats());
 		clientNet->Send(CBaseNetProtocol::Get().SendTeamStat(team->teamNum, team->GetCurrentStats()));
 	}
 }
@@ -1869,7 +2187,178 @@ void CGame::Save(std::string&& fileName, std::string&& saveArgs)
 	globalSaveFileData.args = std::move(saveArgs);
 }
 
+void CGame::ReloadState(ILoadSaveHandler* stateHandler)
+{
+	// loading a state on top of the running sim would leak and duplicate
+	// every object in it, so the game is rebuilt around the state instead
+	// (like a save-file, without map features or GameStart); this happens
+	// from the main loop since the game is deleted
+	spring::SafeDelete(reloadStateHandler);
+	reloadStateHandler = stateHandler;
+}
+
+ILoadSaveHandler* CGame::TakeReloadState()
+{
+	ILoadSaveHandler* stateHandler = reloadStateHandler;
+	reloadStateHandler = nullptr;
+	return stateHandler;
+}
+
+void CGame::SaveDemoSnapshot()
+{
+	CDemoRecorder* record = clientNet->GetDemoRecorder();
+
+	if (!record->IsValid())
+		return;
+
+	SCOPED_TIMER("Misc::DemoSnapshot");
+
+	CCregLoadSaveHandler loadSaveHandler;
+	std::vector<uint8_t> stateBlob;
+
+	loadSaveHandler.SaveInfo(gameSetup->mapName, gameSetup->modName);
+
+	if (!loadSaveHandler.SaveGameState(stateBlob))
+		return;
+
+	// same time as the NETMSG_NEWFRAME that was recorded just before, see ClientReadNet
+	std::shared_ptr<const netcode::RawPacket> packet = CBaseNetProtocol::Get().SendDemoSnapshot(gs->frameNum, stateBlob);
+	record->SaveToDemo(packet->data, packet->length, clientNet->GetPacketTime(gs->frameNum - 1));
+
+	LOG("[Game::%s] embedded sim-state snapshot for frame %d (" _STPF_ " bytes)", __func__, gs->frameNum, stateBlob.size());
+}
+
+bool CGame::LoadDemoSnapshot(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	constexpr unsigned int headerSize = 1 + 4 + 4;
+
+	if (packet->length <= headerSize)
+		return false;
+
+	const int32_t snapshotFrameNum = *reinterpret_cast<const int32_t*>(packet->data + 1 + 4);
+
+	CCregLoadSaveHandler* loadSaveHandler = new CCregLoadSaveHandler();
+
+	if (!loadSaveHandler->ReadGameState(packet->data + headerSize, packet->length - headerSize)) {
+		LOG_L(L_ERROR, "[Game::%s] could not load sim-state snapshot for frame %d", __func__, snapshotFrameNum);
+		delete loadSaveHandler;
+		return false;
+	}
+
+	LOG("[Game::%s] reloading from sim-state snapshot for frame %d", __func__, snapshotFrameNum);
+	ReloadState(loadSaveHandler);
+	return true;
+}
+
+
+void CGame::SendGameState(int playerNum)
+{
+	// largest part that fits a packet with uint16_t messageSize
+	constexpr uint32_t maxPartSize = 32768;
+
+	SCOPED_TIMER("Misc::SendGameState");
+
+	CCregLoadSaveHandler loadSaveHandler;
+	std::vector<uint8_t> stateBlob;
+
+	loadSaveHandler.SaveInfo(gameSetup->mapName, gameSetup->modName);
+
+	if (!loadSaveHandler.SaveGameState(stateBlob))
+		return;
+
+	// the sync checksums run across frames, the joiner has to continue ours
+	std::array<uint32_t, SYNC_LANE_COUNT> laneChecksums = {};
+#ifdef SYNCCHECK
+	std::copy_n(CSyncChecker::GetLaneChecksums(), SYNC_LANE_COUNT, laneChecksums.begin());
+#endif
+
+	stateBlob.insert(stateBlob.begin(), reinterpret_cast<const uint8_t*>(laneChecksums.data()), reinterpret_cast<const uint8_t*>(laneChecksums.data() + SYNC_LANE_COUNT));
+
+	std::vector<uint8_t> statePart;
+
+	for (uint32_t partOffset = 0; partOffset < stateBlob.size(); partOffset += maxPartSize) {
+		const uint32_t partSize = std::min(maxPartSize, uint32_t(stateBlob.size() - partOffset));
+
+		statePart.assign(stateBlob.begin() + partOffset, stateBlob.begin() + partOffset + partSize);
+		clientNet->Send(CBaseNetProtocol::Get().SendGameStatePart(playerNum, gs->frameNum, stateBlob.size(), partOffset, statePart));
+	}
+
+	LOG("[Game::%s] sent sim-state of frame %d to player %d (" _STPF_ " bytes)", __func__, gs->frameNum, playerNum, stateBlob.size());
+}
+
+bool CGame::ReadGameStatePart(std::shared_ptr<const netcode::RawPacket> packet)
+{
+	constexpr unsigned int headerSize = 1 + 2 + 1 + 4 + 4 + 4;
+	constexpr unsigned int checksumsSize = sizeof(uint32_t) * SYNC_LANE_COUNT;
+
+	netcode::UnpackPacket pckt(packet, 3);
+
+	uint8_t playerNum;
+	int32_t frameNum;
+	uint32_t stateSize;
+	uint32_t partOffset;
+
+	pckt >> playerNum;
+	pckt >> frameNum;
+	pckt >> stateSize;
+	pckt >> partOffset;
 
+	const uint32_t partSize = packet->length - headerSize;
+
+	if (playerNum != gu->myPlayerNum || stateSize <= checksumsSize || (partOffset + partSize) > stateSize)
+		return false;
+
+	// a new transfer, parts of an earlier one that failed are dropped
+	if (partOffset == 0) {
+		gameStateBuffer.clear();
+		gameStateBuffer.resize(stateSize);
+		gameStateReceived = 0;
+	}
+
+	if (gameStateBuffer.size() != stateSize || gameStateReceived != partOffset)
+		return false;
+
+	std::copy_n(packet->data + headerSize, partSize, gameStateBuffer.begin() + partOffset);
+
+	if ((gameStateReceived += partSize) < stateSize)
+		return false;
+
+	CCregLoadSaveHandler* loadSaveHandler = new CCregLoadSaveHandler();
+
+	if (!loadSaveHandler->ReadGameState(gameStateBuffer.data() + checksumsSize, gameStateBuffer.size() - checksumsSize)) {
+		LOG_L(L_ERROR, "[Game::%s] could not load sim-state of frame %d", __func__, frameNum);
+		delete loadSaveHandler;
+	} else {
+	#ifdef SYNCCHECK
+		std::array<uint32_t, SYNC_LANE_COUNT> laneChecksums;
+		std::copy_n(reinterpret_cast<const uint32_t*>(gameStateBuffer.data()), SYNC_LANE_COUNT, laneChecksums.begin());
+
+		// after loading, which is synced code itself
+		loadSaveHandler->SetPostLoadFunc([laneChecksums]() { CSyncChecker::SetLaneChecksums(laneChecksums.data()); });
+	#endif
+
+		// our demo lacks every frame before this one, replays load the state instead
+		CDemoRecorder* record = clientNet->GetDemoRecorder();
+
+		if (record != nullptr && record->IsValid()) {
+			const std::vector<uint8_t> stateBlob(gameStateBuffer.begin() + checksumsSize, gameStateBuffer.end());
+			std::shared_ptr<const netcode::RawPacket> snapshot = CBaseNetProtocol::Get().SendDemoSnapshot(frameNum, stateBlob);
+
+			record->SaveToDemo(snapshot->data, snapshot->length, clientNet->GetPacketTime(frameNum - 1));
+		}
+
+		// what we simulated so far (map features, GameStart) is replaced,
+		// the state is loaded into a game rebuilt as from a save-file
+		LOG("[Game::%s] reloading from sim-state of frame %d (" _STPF_ " bytes)", __func__, frameNum, gameStateBuffer.size());
+		ReloadState(loadSaveHandler);
+	}
+
+	gameStateBuffer.clear();
+	gameStateBuffer.shrink_to_fit();
+	gameStateReceived = 0;
+
+	return (HasReloadState());
+}
 
 
 bool CGame::ProcessCommandText(unsigned int key, const std::string& command) {
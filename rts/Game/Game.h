@@ -4,6 +4,7 @@
 #define _GAME_H
 
 #include <atomic>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -20,6 +21,7 @@ class LuaParser;
 class ILoadSaveHandler;
 class Action;
 class ChatMessage;
+namespace netcode { class RawPacket; }
 
 
 class CGame : public CGameController
@@ -52,6 +54,7 @@ private:
 	void LoadDefs(LuaParser* defsParser);
 	void PreLoadSimulation(LuaParser* defsParser);
 	void PostLoadSimulation(LuaParser* defsParser);
+	void PreloadDefModels();
 	void PreLoadRendering();
 	void PostLoadRendering();
 	void LoadInterface();
@@ -70,6 +73,7 @@ public:
 	bool IsClientPaused() const { return paused; }
 	bool IsSimLagging(float maxLatency = 500.0f) const;
 	bool IsSavedGame() const { return (saveFileHandler != nullptr); }
+	bool HasReloadState() const { return (reloadStateHandler != nullptr); }
 	bool IsGameOver() const { return gameOver; }
 
 	const spring::unordered_map<int, PlayerTrafficInfo>& GetPlayerTraffic() const {
@@ -94,6 +98,20 @@ public:
 	void Reload();
 	void Save(std::string&& fileName, std::string&& saveArgs);
 
+	/// queue a rebuild of the game from <stateHandler>'s state, see SpringApp::ReloadGame
+	void ReloadState(ILoadSaveHandler* stateHandler);
+	/// hands the state queued by ReloadState to the game replacing this one
+	ILoadSaveHandler* TakeReloadState();
+
+	/// embed the current sim-state in the demo being recorded
+	void SaveDemoSnapshot();
+	/// replace the current sim-state by the one in a NETMSG_DEMOSNAPSHOT, returns true if a reload was queued
+	bool LoadDemoSnapshot(std::shared_ptr<const netcode::RawPacket> packet);
+	/// send the current sim-state to player <playerNum> joining the game, in NETMSG_GAMESTATE parts
+	void SendGameState(int playerNum);
+	/// collect a NETMSG_GAMESTATE part, replaces the current sim-state by the one sent once complete (returns true if a reload was queued)
+	bool ReadGameStatePart(std::shared_ptr<const netcode::RawPacket> packet);
+
 	void ResizeEvent() override;
 
 	void SetDrawMode(Game::DrawMode mode) { gameDrawMode = mode; }
@@ -131,6 +149,7 @@ private:
 	void SendClientProcUsage();
 	void ClientReadNet();
 	void UpdateNumQueuedSimFrames();
+	void UpdateCatchUp(uint32_t numQueuedFrames);
 	void UpdateNetMessageProcessingTimeLeft();
 	void SimFrame();
 	void StartPlaying();
@@ -202,6 +221,25 @@ public:
 	// 0 := 1/f rate, 1 := 30/s rate
 	int luaGCControl = 0;
 
+	/// frames between snapshots embedded in recorded demos, 0 if disabled
+	int demoSnapshotInterval = 0;
+
+	/// NETMSG_GAMESTATE parts received so far, lane checksums followed by a CCregLoadSaveHandler state
+	std::vector<uint8_t> gameStateBuffer;
+	size_t gameStateReceived = 0;
+
+	// catch-up mode, entered when a client falls far behind the server
+	int catchUpFrames = 0;   ///< SimFrame() calls per drawn frame, 0 if not catching up
+	int catchUpStartLag = 0; ///< queued frames when catch-up began
+	int catchUpLag = 0;      ///< queued frames at the last update
+	int catchUpMinDrawFPS = 0;
+	float catchUpTargetTime = 0.0f; ///< seconds
+	spring_time catchUpStartTime;
+
+	// frame-pacing mode, see FramePacingSimBudget
+	float framePacingSimBudget = 0.0f; ///< milliseconds of sim-frames per drawn frame, 0 if disabled
+	float pacedTimeOffset = 0.0f;      ///< interpolation coefficient, advanced per drawn frame
+
 private:
 	JobDispatcher jobDispatcher;
 
@@ -214,6 +252,8 @@ private:
 
 	/// for reloading the savefile
 	ILoadSaveHandler* saveFileHandler;
+	/// state of a running game to rebuild this one from, see ReloadState
+	ILoadSaveHandler* reloadStateHandler = nullptr;
 
 	std::atomic<bool> loadDone = {false};
 	std::atomic<bool> gameOver = {false};
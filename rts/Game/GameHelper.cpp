@@ -38,6 +38,7 @@
 #include "System/EventHandler.h"
 #include "System/SpringMath.h"
 #include "System/Sound/ISoundChannels.h"
+#include "System/Threading/ThreadPool.h"
 
 
 static CGameHelper gGameHelper;
@@ -96,23 +97,41 @@ float CGameHelper::CalcImpulseScale(const DamageArray& damages, const float expD
 	return Clamp(rawImpulseScale, -MAX_EXPLOSION_IMPULSE, MAX_EXPLOSION_IMPULSE);
 }
 
-void CGameHelper::DoExplosionDamage(
-	CUnit* unit,
-	CUnit* owner,
+void CGameHelper::CalcExplosionFalloff(
+	ExplosionHit& hit,
+	const float3& volPos,
 	const float3& expPos,
 	const float expRadius,
-	const float expSpeed,
 	const float expEdgeEffect,
-	const bool ignoreOwner,
-	const DamageArray& damages,
-	const int weaponDefID,
-	const int projectileID
+	const DamageArray& damages
 ) {
-	assert(unit != nullptr);
+	const float expRim = hit.expDist * expEdgeEffect;
 
-	if (ignoreOwner && (unit == owner))
+	// return early if (distance > radius)
+	if (!(hit.inRange = !(hit.expDist > expRadius)))
 		return;
 
+	// expEdgeEffect should be in [0, 1], so expRadius >= expDist >= expDist*expEdgeEffect
+	assert(expRadius >= expRim);
+
+	// expMod will also be in [0, 1], no negatives
+	// TODO: damage attenuation for underwater units from surface explosions?
+	hit.expDistanceMod = (expRadius + 0.001f - hit.expDist) / (expRadius + 0.001f - expRim);
+
+	const float modImpulseScale = CalcImpulseScale(damages, hit.expDistanceMod);
+	const float3 impulseDir = (volPos - expPos).SafeNormalize();
+
+	hit.impulse = impulseDir * modImpulseScale;
+}
+
+void CGameHelper::CalcExplosionHit(
+	const CUnit* unit,
+	const float3& expPos,
+	const float expRadius,
+	const float expEdgeEffect,
+	const DamageArray& damages,
+	ExplosionHit& hit
+) {
 	const LocalModelPiece* lhp = unit->GetLastHitPiece(gs->frameNum);
 	const CollisionVolume* vol = unit->GetCollisionVolume(lhp);
 
@@ -120,20 +139,42 @@ void CGameHelper::DoExplosionDamage(
 	const float3& volPos = vol->GetWorldSpacePos(unit, lhpPos);
 
 	// linear damage falloff with distance
-	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(unit, lhp, expPos) : 0.0f;
-	const float expRim = expDist * expEdgeEffect;
+	hit.expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(unit, lhp, expPos) : 0.0f;
 
-	// return early if (distance > radius)
-	if (expDist > expRadius)
-		return;
+	CalcExplosionFalloff(hit, volPos, expPos, expRadius, expEdgeEffect, damages);
+}
 
-	// expEdgeEffect should be in [0, 1], so expRadius >= expDist >= expDist*expEdgeEffect
-	assert(expRadius >= expRim);
+void CGameHelper::CalcExplosionHit(
+	const CFeature* feature,
+	const float3& expPos,
+	const float expRadius,
+	const float expEdgeEffect,
+	const DamageArray& damages,
+	ExplosionHit& hit
+) {
+	const LocalModelPiece* lhp = feature->GetLastHitPiece(gs->frameNum);
+	const CollisionVolume* vol = feature->GetCollisionVolume(lhp);
 
-	// expMod will also be in [0, 1], no negatives
-	// TODO: damage attenuation for underwater units from surface explosions?
-	const float expDistanceMod = (expRadius + 0.001f - expDist) / (expRadius + 0.001f - expRim);
-	const float modImpulseScale = CalcImpulseScale(damages, expDistanceMod);
+	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
+	const float3& volPos = vol->GetWorldSpacePos(feature, lhpPos);
+
+	hit.expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(feature, nullptr, expPos) : 0.0f;
+
+	CalcExplosionFalloff(hit, volPos, expPos, expRadius, expEdgeEffect, damages);
+}
+
+
+void CGameHelper::ApplyExplosionHit(
+	CUnit* unit,
+	CUnit* owner,
+	const ExplosionHit& hit,
+	const float expSpeed,
+	const DamageArray& damages,
+	const int weaponDefID,
+	const int projectileID
+) {
+	if (!hit.inRange)
+		return;
 
 	// NOTE: if an explosion occurs right underneath a
 	// unit's map footprint, it might cause damage even
@@ -141,54 +182,71 @@ void CGameHelper::DoExplosionDamage(
 	// (because CQuadField coverage is based exclusively
 	// on unit->radius, so the DoDamage() iteration will
 	// include units that should not be touched)
+	DamageArray expDamages = damages * hit.expDistanceMod;
 
-	const float3 impulseDir = (volPos - expPos).SafeNormalize();
-	const float3 expImpulse = impulseDir * modImpulseScale;
-
-	DamageArray expDamages = damages * expDistanceMod;
-
-	if (expDist < (expSpeed * DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE)) {
+	if (hit.expDist < (expSpeed * DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE)) {
 		// damage directly
-		unit->DoDamage(expDamages, expImpulse, owner, weaponDefID, projectileID);
+		unit->DoDamage(expDamages, hit.impulse, owner, weaponDefID, projectileID);
 	} else {
 		// damage later
-		waitingDamages[(gs->frameNum + int(expDist / expSpeed) - (DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE - 1)) & (waitingDamages.size() - 1)].emplace_back(std::move(expDamages), expImpulse, ((owner != nullptr)? owner->id: -1), unit->id, weaponDefID, projectileID);
+		waitingDamages[(gs->frameNum + int(hit.expDist / expSpeed) - (DIRECT_EXPLOSION_DAMAGE_SPEED_SCALE - 1)) & (waitingDamages.size() - 1)].emplace_back(std::move(expDamages), hit.impulse, ((owner != nullptr)? owner->id: -1), unit->id, weaponDefID, projectileID);
 	}
 }
 
-void CGameHelper::DoExplosionDamage(
+void CGameHelper::ApplyExplosionHit(
 	CFeature* feature,
 	CUnit* owner,
-	const float3& expPos,
-	const float expRadius,
-	const float expEdgeEffect,
+	const ExplosionHit& hit,
 	const DamageArray& damages,
 	const int weaponDefID,
 	const int projectileID
 ) {
-	assert(feature != nullptr);
+	if (!hit.inRange)
+		return;
 
-	const LocalModelPiece* lhp = feature->GetLastHitPiece(gs->frameNum);
-	const CollisionVolume* vol = feature->GetCollisionVolume(lhp);
+	feature->DoDamage(damages * hit.expDistanceMod, hit.impulse, owner, weaponDefID, projectileID);
+}
 
-	const float3& lhpPos = (lhp != nullptr && vol == lhp->GetCollisionVolume())? lhp->GetAbsolutePos(): ZeroVector;
-	const float3& volPos = vol->GetWorldSpacePos(feature, lhpPos);
 
-	const float expDist = (expRadius != 0.0f) ? vol->GetPointSurfaceDistance(feature, nullptr, expPos) : 0.0f;
-	const float expRim = expDist * expEdgeEffect;
+void CGameHelper::DoExplosionDamage(
+	CUnit* unit,
+	CUnit* owner,
+	const float3& expPos,
+	const float expRadius,
+	const float expSpeed,
+	const float expEdgeEffect,
+	const bool ignoreOwner,
+	const DamageArray& damages,
+	const int weaponDefID,
+	const int projectileID
+) {
+	assert(unit != nullptr);
 
-	if (expDist > expRadius)
+	if (ignoreOwner && (unit == owner))
 		return;
 
-	assert(expRadius >= expRim);
+	ExplosionHit hit;
 
-	const float expDistanceMod = (expRadius + 0.001f - expDist) / (expRadius + 0.001f - expRim);
-	const float modImpulseScale = CalcImpulseScale(damages, expDistanceMod);
+	CalcExplosionHit(unit, expPos, expRadius, expEdgeEffect, damages, hit);
+	ApplyExplosionHit(unit, owner, hit, expSpeed, damages, weaponDefID, projectileID);
+}
 
-	const float3 impulseDir = (volPos - expPos).SafeNormalize();
-	const float3 expImpulse = impulseDir * modImpulseScale;
+void CGameHelper::DoExplosionDamage(
+	CFeature* feature,
+	CUnit* owner,
+	const float3& expPos,
+	const float expRadius,
+	const float expEdgeEffect,
+	const DamageArray& damages,
+	const int weaponDefID,
+	const int projectileID
+) {
+	assert(feature != nullptr);
+
+	ExplosionHit hit;
 
-	feature->DoDamage(damages * expDistanceMod, expImpulse, owner, weaponDefID, projectileID);
+	CalcExplosionHit(feature, expPos, expRadius, expEdgeEffect, damages, hit);
+	ApplyExplosionHit(feature, owner, hit, damages, weaponDefID, projectileID);
 }
 
 
@@ -198,8 +256,14 @@ void CGameHelper::DamageObjectsInExplosionRadius(
 	const float expRad,
 	const int weaponDefID
 ) {
+	// objects per task when evaluating hits in parallel; small
+	// explosions are not worth handing to the thread-pool
+	static constexpr int HIT_BATCH_GRAIN = 32;
+
 	static std::vector<CUnit*> unitCache;
 	static std::vector<CFeature*> featureCache;
+	static std::vector<ExplosionHit> unitHits;
+	static std::vector<ExplosionHit> featureHits;
 
 	const unsigned int oldNumUnits = unitCache.size();
 	const unsigned int oldNumFeatures = featureCache.size();
@@ -209,22 +273,57 @@ void CGameHelper::DamageObjectsInExplosionRadius(
 	const unsigned int newNumUnits = unitCache.size();
 	const unsigned int newNumFeatures = featureCache.size();
 
+	// distances, falloff and impulses only read object state and are
+	// evaluated for all candidates up front (in parallel if there are
+	// many); damage is still applied serially and in quadfield order
+	// since DoDamage runs Lua and can kill, move or spawn objects
+	unitHits.resize(newNumUnits);
+
+	for_mt_range(oldNumUnits, newNumUnits, HIT_BATCH_GRAIN, [&](const int lo, const int hi) {
+		for (int n = lo; n < hi; n++) {
+			unitHits[n] = {};
+
+			if (params.ignoreOwner && (unitCache[n] == params.owner))
+				continue;
+
+			CalcExplosionHit(unitCache[n], params.pos, expRad, params.edgeEffectiveness, params.damages, unitHits[n]);
+		}
+	});
+
 	// damage all units within the explosion radius
 	// NOTE:
 	//   this can recursively trigger ::Explosion() again
 	//   which would overwrite our object cache if we did
 	//   not keep track of end-markers --> certain objects
 	//   would not be damaged AT ALL (!)
-	for (unsigned int n = oldNumUnits; n < newNumUnits; n++)
-		DoExplosionDamage(unitCache[n], params.owner, params.pos, expRad, params.explosionSpeed, params.edgeEffectiveness, params.ignoreOwner, params.damages, weaponDefID, params.projectileID);
+	//   (the copy guards against unitHits being resized)
+	for (unsigned int n = oldNumUnits; n < newNumUnits; n++) {
+		const ExplosionHit hit = unitHits[n];
+
+		ApplyExplosionHit(unitCache[n], params.owner, hit, params.explosionSpeed, params.damages, weaponDefID, params.projectileID);
+	}
 
 	unitCache.resize(oldNumUnits);
+	unitHits.resize(oldNumUnits);
+
+	// features are evaluated only after all unit damage has been dealt
+	featureHits.resize(newNumFeatures);
+
+	for_mt_range(oldNumFeatures, newNumFeatures, HIT_BATCH_GRAIN, [&](const int lo, const int hi) {
+		for (int n = lo; n < hi; n++) {
+			CalcExplosionHit(featureCache[n], params.pos, expRad, params.edgeEffectiveness, params.damages, featureHits[n] = {});
+		}
+	});
 
 	// damage all features within the explosion radius
-	for (unsigned int n = oldNumFeatures; n < newNumFeatures; n++)
-		DoExplosionDamage(featureCache[n], params.owner, params.pos, expRad, params.edgeEffectiveness, params.damages, weaponDefID, params.projectileID);
+	for (unsigned int n = oldNumFeatures; n < newNumFeatures; n++) {
+		const ExplosionHit hit = featureHits[n];
+
+		ApplyExplosionHit(featureCache[n], params.owner, hit, params.damages, weaponDefID, params.projectileID);
+	}
 
 	featureCache.resize(oldNumFeatures);
+	featureHits.resize(oldNumFeatures);
 }
 
 void CGameHelper::Explosion(const CExplosionParams& params) {
@@ -382,6 +481,81 @@ static inline void QueryUnits(TFilter filter, TQuery& query)
 	}
 }
 
+/**
+ * @brief Spatial query for the closest unit.
+ *
+ * Same contract as QueryUnits, but Query must also implement
+ *  - bool IsBeyond(float minDist): returns true if no unit whose midPos is
+ *    at least minDist (2D) away could beat the current result
+ *
+ * Quads are visited nearest-first and the search stops at the first one
+ * that can not contain a better unit, so large-radius searches only touch
+ * the quads around the result. Fine-level units overlap their quads with
+ * their radius (at most one quad-size) and their midPos is assumed to be
+ * within MaxUnitRadius of their pos, which bounds how far outside a quad
+ * its units can be; coarse quads have no such bound and are always visited.
+ * Ties are broken by unit ID so the result does not depend on quad order.
+ */
+template<typename TFilter, typename TQuery>
+static inline void QueryClosestUnit(TFilter filter, TQuery& query)
+{
+	QuadFieldQuery qfQuery;
+	quadField.GetQuads(qfQuery, query.pos, query.radius);
+	const int tempNum = gs->GetTempNum();
+
+	const int numBaseQuads = quadField.GetNumBaseQuads();
+	const int numQuadsX = quadField.GetNumQuadsX();
+	const float quadSizeX = quadField.GetQuadSizeX();
+	const float quadSizeZ = quadField.GetQuadSizeZ();
+	const float quadSlack = quadSizeX + unitHandler.MaxUnitRadius();
+
+	const auto GetQuadSqDist = [&](const int qi) {
+		if (qi >= numBaseQuads)
+			return -1.0f;
+
+		const float x1 = (qi % numQuadsX) * quadSizeX;
+		const float z1 = (qi / numQuadsX) * quadSizeZ;
+		const float dx = std::max(0.0f, std::max(x1 - query.pos.x, query.pos.x - (x1 + quadSizeX)));
+		const float dz = std::max(0.0f, std::max(z1 - query.pos.z, query.pos.z - (z1 + quadSizeZ)));
+
+		return (dx * dx + dz * dz);
+	};
+
+	std::vector<int>& quads = *qfQuery.quads;
+
+	std::sort(quads.begin(), quads.end(), [&](const int a, const int b) {
+		const float da = GetQuadSqDist(a);
+		const float db = GetQuadSqDist(b);
+		return ((da < db) || (da == db && a < b));
+	});
+
+	for (const int qi: quads) {
+		const float sqDist = GetQuadSqDist(qi);
+
+		if (sqDist > 0.0f && query.IsBeyond(math::sqrt(sqDist) - quadSlack))
+			break;
+
+		const CQuadField::Quad& quad = quadField.GetQuad(qi);
+
+		for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+			if (!filter.Team(t))
+				continue;
+
+			for (CUnit* u: quad.teamUnits[t]) {
+				if (u->tempNum == tempNum)
+					continue;
+
+				u->tempNum = tempNum;
+
+				if (!filter.Unit(u))
+					continue;
+
+				query.AddUnit(u);
+			}
+		}
+	}
+}
+
 
 namespace {
 	namespace Filter {
@@ -514,12 +688,20 @@ namespace {
 
 			void AddUnit(CUnit* u) {
 				const float sqDist = (pos - u->midPos).SqLength2D();
-				if (sqDist <= closeSqDist) {
+				if (IsCloser(sqDist, u)) {
 					closeSqDist = sqDist;
 					closeUnit = u;
 				}
 			}
 
+			bool IsCloser(float sqDist, const CUnit* u) const {
+				if (sqDist != closeSqDist)
+					return (sqDist < closeSqDist);
+
+				return (closeUnit == nullptr || u->id < closeUnit->id);
+			}
+			bool IsBeyond(float minDist) const { return (minDist > 0.0f && Square(minDist) > closeSqDist); }
+
 			CUnit* GetClosestUnit() const { return closeUnit; }
 		};
 
@@ -576,12 +758,21 @@ namespace {
 				// (more for consistency than need)
 				const float dist = pos.distance(u->midPos) - u->radius;
 
-				if (dist <= closeDist && (!checkSightDist || (dist <= u->losRadius))) {
+				if (IsCloser(dist, u) && (!checkSightDist || (dist <= u->losRadius))) {
 					closeDist = dist;
 					closeUnit = u;
 				}
 			}
 
+			bool IsCloser(float dist, const CUnit* u) const {
+				if (dist != closeDist)
+					return (dist < closeDist);
+
+				return (closeUnit == nullptr || u->id < closeUnit->id);
+			}
+			// dist is reduced by the unit's radius
+			bool IsBeyond(float minDist) const { return ((minDist - unitHandler.MaxUnitRadius()) > closeDist); }
+
 			CUnit* GetClosestUnit() const { return closeUnit; }
 		};
 
@@ -601,7 +792,7 @@ namespace {
 			void AddUnit(CUnit* u) {
 				const float sqDist = (pos - u->midPos).SqLength2D();
 
-				if (sqDist <= closeSqDist && (!checkSightDist || sqDist <= Square(u->losRadius))) {
+				if (IsCloser(sqDist, u) && (!checkSightDist || sqDist <= Square(u->losRadius))) {
 					closeSqDist = sqDist;
 					closeUnit = u;
 				}
@@ -632,7 +823,79 @@ namespace {
 
 
 
-size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
+static float GetWeaponTargetScanRadius(const CWeapon* weapon)
+{
+	const float aimPosHeight = weapon->aimFromPos.y;
+	const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
+
+	// find theoretical maximum range based on height above lowest point on map
+	// const float scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
+	return (weapon->range + weapon->autoTargetRangeBoost + (aimPosHeight - minMapHeight) * weapon->weaponDef->heightmod);
+}
+
+void CGameHelper::GenerateWeaponTargetCandidates(const CWeapon* weapon, std::vector<CUnit*>& candidates, std::vector<int>& quads)
+{
+	const CUnit* weaponOwner = weapon->owner;
+
+	quadField.GetQuadsMT(quads, weaponOwner->pos, GetWeaponTargetScanRadius(weapon));
+	candidates.clear();
+
+	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
+		if (teamHandler.Ally(weaponOwner->allyteam, t))
+			continue;
+
+		for (const int qi: quads) {
+			for (CUnit* targetUnit: quadField.GetQuad(qi).teamUnits[t]) {
+				// units overlapping several quads are only taken from the first
+				// (quads are sorted), this replaces the usual tempNum test which
+				// is not possible when gathering for multiple weapons at once
+				const auto pred = [&](const int uqi) { return (uqi < qi && std::binary_search(quads.begin(), quads.end(), uqi)); };
+
+				if (std::find_if(targetUnit->quads.begin(), targetUnit->quads.end(), pred) != targetUnit->quads.end())
+					continue;
+
+				// cheap subset of the TestTarget checks, the rest needs the weapon's current state
+				if ((targetUnit->category & weapon->onlyTargetCategory) == 0)
+					continue;
+				if ((targetUnit->losStatus[weaponOwner->allyteam] & (LOS_INLOS | LOS_INRADAR)) == 0)
+					continue;
+
+				candidates.push_back(targetUnit);
+			}
+		}
+	}
+}
+
+void CGameHelper::BatchWeaponTargetCandidates(const std::vector<CUnit*>& units, size_t beg, size_t end)
+{
+	SCOPED_TIMER("Sim::Unit::Weapon::BatchTargetCandidates");
+
+	batchedWeapons.clear();
+	batchedWeaponQuads.resize(ThreadPool::GetMaxThreads());
+
+	for (size_t i = beg; i < end; i++) {
+		for (CWeapon* w: units[i]->weapons) {
+			// only the static AllowWeaponAutoTarget conditions, anything else
+			// (including Lua) is still evaluated when the weapon SlowUpdate's
+			if (w->weaponDef->noAutoTarget || w->noAutoTarget)
+				continue;
+			if (w->slavedTo != nullptr || w->weaponDef->interceptor)
+				continue;
+
+			batchedWeapons.push_back(w);
+		}
+	}
+
+	for_mt(0, batchedWeapons.size(), [&](const int i) {
+		CWeapon* w = batchedWeapons[i];
+
+		GenerateWeaponTargetCandidates(w, w->targetCandidates, batchedWeaponQuads[ThreadPool::GetThreadNum()]);
+		w->targetCandidatesFrame = gs->frameNum;
+	});
+}
+
+
+size_t CGameHelper::GenerateWeaponTargets(CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets)
 {
 	const CUnit*  weaponOwner = weapon->owner;
 	const CUnit* lastAttacker = ((weaponOwner->lastAttackFrame + 200) <= gs->frameNum) ? weaponOwner->lastAttacker : nullptr;
@@ -644,7 +907,6 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 	const float3 testPos;
 
 	const float aimPosHeight = weapon->aimFromPos.y;
-	const float minMapHeight = std::max(0.0f, readMap->GetCurrMinHeight());
 
 	// how much damage the weapon deals over 1 second
 	const float secDamage = weaponDmg->GetDefault() * weapon->salvoSize / weapon->reloadTime * GAME_SPEED;
@@ -652,98 +914,76 @@ size_t CGameHelper::GenerateWeaponTargets(const CWeapon* weapon, const CUnit* av
 
 	const float  baseRange = weapon->range;
 	const float rangeBoost = weapon->autoTargetRangeBoost;
-	// find theoretical maximum range based on height above lowest point on map
-	// const float scanRadius = weapon->GetRange2D(rangeBoost, (minMapHeight - aimPosHeight) * heightMod);
-	const float scanRadius = baseRange + rangeBoost + (aimPosHeight - minMapHeight) * heightMod;
 
 	// [0] := default, [1,2,3,4,5,6] := target is {avoidee, in bad category, crashing, last attacker, paralyzed, outside unboosted range}
 	constexpr float tgtPriorityMults[] = {1.0f, 10.0f, 100.0f, 1000.0f, 0.5f, 4.0f, 100000.0f};
 
 	const bool paralyzer = (weaponDmg->paralyzeDamageTime != 0);
 
-	// copy on purpose since the below calls lua
-	QuadFieldQuery qfQuery;
-	quadField.GetQuads(qfQuery, ownerPos, scanRadius);
+	// use the candidates batched by CUnitHandler::SlowUpdateUnits if they are
+	// from this frame, otherwise gather them now; either way the list is done
+	// before the below calls Lua so callins can not affect the traversal
+	if (weapon->targetCandidatesFrame != gs->frameNum)
+		GenerateWeaponTargetCandidates(weapon, weapon->targetCandidates, helper->targetQuads);
 
 	targets.clear();
 	targets.reserve(32);
 
-	const int tempNum = gs->GetTempNum();
-
-	for (int t = 0; t < teamHandler.ActiveAllyTeams(); ++t) {
-		if (teamHandler.Ally(weaponOwner->allyteam, t))
+	for (CUnit* targetUnit: weapon->targetCandidates) {
+		if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
 			continue;
 
-		for (const int qi: *qfQuery.quads) {
-			const std::vector<CUnit*>& allyTeamUnits = quadField.GetQuad(qi).teamUnits[t];
+		const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
 
-			for (CUnit* targetUnit: allyTeamUnits) {
-				if (targetUnit->tempNum == tempNum)
-					continue;
+		float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
+		float3 targetPos;
 
-				targetUnit->tempNum = tempNum;
-
-				if (!weapon->TestTarget(testPos, SWeaponTarget(targetUnit)))
-					continue;
-
-				const unsigned short targetLOSState = targetUnit->losStatus[weaponOwner->allyteam];
-
-				float targetPriority = tgtPriorityMults[(targetUnit == avoidUnit) * 1];
-				float3 targetPos;
-
-				if (targetLOSState & LOS_INLOS) {
-					targetPos = targetUnit->aimPos;
-				} else if (targetLOSState & LOS_INRADAR) {
-					targetPos = weapon->GetUnitPositionWithError(targetUnit);
-					targetPriority *= tgtPriorityMults[1];
-				} else {
-					continue;
-				}
-
-				const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
-				const float sqDist2D = ownerPos.SqDistance2D(targetPos);
-
-				if (sqDist2D > Square(modRange))
-					continue;
+		if (targetLOSState & LOS_INLOS) {
+			targetPos = targetUnit->aimPos;
+		} else if (targetLOSState & LOS_INRADAR) {
+			targetPos = weapon->GetUnitPositionWithError(targetUnit);
+			targetPriority *= tgtPriorityMults[1];
+		} else {
+			continue;
+		}
 
-				const float dist2D = math::sqrt(sqDist2D);
-				const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
-				const float damageMul = weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple;
+		const float modRange = weapon->GetRange2D(rangeBoost, (targetPos.y - aimPosHeight) * heightMod);
+		const float sqDist2D = ownerPos.SqDistance2D(targetPos);
 
-				targetPriority *= rangeMul;
-				targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
+		if (sqDist2D > Square(modRange))
+			continue;
 
-				if (targetLOSState & LOS_INLOS) {
-					targetPriority *= (secDamage + targetUnit->health);
+		const float dist2D = math::sqrt(sqDist2D);
+		const float rangeMul = (dist2D * weaponDef->proximityPriority + modRange * 0.4f + 100.0f);
+		const float damageMul = weaponDmg->Get(targetUnit->armorType) * targetUnit->curArmorMultiple;
 
-					if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
-						targetPriority *= tgtPriorityMults[5];
+		targetPriority *= rangeMul;
+		targetPriority *= tgtPriorityMults[(dist2D > baseRange) * 6];
 
-					if (weapon->hasTargetWeight)
-						targetPriority *= weapon->TargetWeight(targetUnit);
+		if (targetLOSState & LOS_INLOS) {
+			targetPriority *= (secDamage + targetUnit->health);
 
-				} else {
-					targetPriority *= (secDamage + 10000.0f);
-				}
+			if (paralyzer && targetUnit->paralyzeDamage > (modInfo.paralyzeOnMaxHealth? targetUnit->maxHealth: targetUnit->health))
+				targetPriority *= tgtPriorityMults[5];
 
-				if (targetLOSState & LOS_PREVLOS) {
-					targetPriority /= (damageMul * targetUnit->power * (0.7f + gsRNG.NextFloat() * 0.6f));
-					targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
-					targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
-					targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
-				}
+			if (weapon->hasTargetWeight)
+				targetPriority *= weapon->TargetWeight(targetUnit);
 
-				const bool allowTarget = eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority);
+		} else {
+			targetPriority *= (secDamage + 10000.0f);
+		}
 
-				// Lua call may have changed tempNum, so needs to be set again
-				targetUnit->tempNum = tempNum;
+		if (targetLOSState & LOS_PREVLOS) {
+			targetPriority /= (damageMul * targetUnit->power * (0.7f + gsRNG.NextFloat() * 0.6f));
+			targetPriority *= tgtPriorityMults[((targetUnit->category & weapon->badTargetCategory) != 0) * 2];
+			targetPriority *= tgtPriorityMults[(targetUnit->IsCrashing()) * 3];
+			targetPriority *= tgtPriorityMults[(targetUnit == lastAttacker) * 4];
+		}
 
-				if (!allowTarget)
-					continue;
+		if (!eventHandler.AllowWeaponTarget(weaponOwner->id, targetUnit->id, weapon->weaponNum, weaponDef->id, &targetPriority))
+			continue;
 
-				targets.emplace_back(targetPriority, targetUnit);
-			}
-		}
+		targets.emplace_back(targetPriority, targetUnit);
 	}
 
 	std::stable_sort(targets.begin(), targets.end(), [](const std::pair<float, CUnit*>& a, const std::pair<float, CUnit*>& b) { return (a.first < b.first); });
@@ -762,14 +1002,14 @@ CUnit* CGameHelper::GetClosestUnit(const float3& pos, float searchRadius)
 CUnit* CGameHelper::GetClosestEnemyUnit(const CUnit* excludeUnit, const float3& pos, float searchRadius, int searchAllyteam)
 {
 	Query::ClosestUnit q(pos, searchRadius);
-	QueryUnits(Filter::Enemy_InLos(excludeUnit, searchAllyteam), q);
+	QueryClosestUnit(Filter::Enemy_InLos(excludeUnit, searchAllyteam), q);
 	return q.GetClosestUnit();
 }
 
 CUnit* CGameHelper::GetClosestValidTarget(const float3& pos, float searchRadius, int searchAllyteam, const CMobileCAI* cai)
 {
 	Query::ClosestUnit q(pos, searchRadius);
-	QueryUnits(Filter::Enemy_InLos_ValidTarget(searchAllyteam, cai), q);
+	QueryClosestUnit(Filter::Enemy_InLos_ValidTarget(searchAllyteam, cai), q);
 	return q.GetClosestUnit();
 }
 
@@ -786,12 +1026,12 @@ CUnit* CGameHelper::GetClosestEnemyUnitNoLosTest(
 	if (sphereDistTest) {
 		// includes target radius
 		Query::ClosestUnit_InLos q(searchPos, searchRadius, checkSightDist);
-		QueryUnits(Filter::Enemy(excludeUnit, searchAllyteam), q);
+		QueryClosestUnit(Filter::Enemy(excludeUnit, searchAllyteam), q);
 		closestUnit = q.GetClosestUnit();
 	} else {
 		// excludes target radius
 		Query::ClosestUnit_InLos_Cylinder q(searchPos, searchRadius, checkSightDist);
-		QueryUnits(Filter::Enemy(excludeUnit, searchAllyteam), q);
+		QueryClosestUnit(Filter::Enemy(excludeUnit, searchAllyteam), q);
 		closestUnit = q.GetClosestUnit();
 	}
 
@@ -801,14 +1041,14 @@ CUnit* CGameHelper::GetClosestEnemyUnitNoLosTest(
 CUnit* CGameHelper::GetClosestFriendlyUnit(const CUnit* excludeUnit, const float3& pos, float searchRadius, int searchAllyteam)
 {
 	Query::ClosestUnit q(pos, searchRadius);
-	QueryUnits(Filter::Friendly(excludeUnit, searchAllyteam), q);
+	QueryClosestUnit(Filter::Friendly(excludeUnit, searchAllyteam), q);
 	return q.GetClosestUnit();
 }
 
 CUnit* CGameHelper::GetClosestEnemyAircraft(const CUnit* excludeUnit, const float3& pos, float searchRadius, int searchAllyteam)
 {
 	Query::ClosestUnit q(pos, searchRadius);
-	QueryUnits(Filter::EnemyAircraft(excludeUnit, searchAllyteam), q);
+	QueryClosestUnit(Filter::EnemyAircraft(excludeUnit, searchAllyteam), q);
 	return q.GetClosestUnit();
 }
 
@@ -917,6 +1157,81 @@ static const std::vector<SearchOffset>& GetSearchOffsetTable(int radius)
 }
 
 // used by AICallback, ResourceMapAnalyzer (unsynced), LuaSyncedRead
+// summed-area tables of the squares whose first blocking object is immobile
+// (a building or feature), and of those whose object also has an open yard;
+// covers a window of the map so ClosestBuildPos can test each candidate's
+// neighbourhood with four lookups instead of a loop over every square
+struct BuildBlockerSums {
+public:
+	// in map squares, [x1, x2) x [z1, z2)
+	struct Rect {
+		int x1, z1;
+		int x2, z2;
+	};
+
+public:
+	void Init(int x1, int z1, int x2, int z2) {
+		xmin = x1; xsize = std::max(0, x2 - x1);
+		zmin = z1; zsize = std::max(0, z2 - z1);
+
+		const size_t numSums = (xsize + 1) * (zsize + 1);
+
+		immobileSums.clear();
+		immobileSums.resize(numSums, 0);
+		openYardSums.clear();
+		openYardSums.resize(numSums, 0);
+
+		for (int z = 0; z < zsize; z++) {
+			int immobileRowSum = 0;
+			int openYardRowSum = 0;
+
+			for (int x = 0; x < xsize; x++) {
+				const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(xmin + x, zmin + z);
+
+				// immobile=true implies Feature or Building
+				immobileRowSum += (solObj != nullptr && solObj->immobile);
+				openYardRowSum += (solObj != nullptr && solObj->immobile && solObj->yardOpen);
+
+				immobileSums[(z + 1) * (xsize + 1) + (x + 1)] = immobileSums[z * (xsize + 1) + (x + 1)] + immobileRowSum;
+				openYardSums[(z + 1) * (xsize + 1) + (x + 1)] = openYardSums[z * (xsize + 1) + (x + 1)] + openYardRowSum;
+			}
+		}
+
+		valid = true;
+	}
+
+	void Kill() { valid = false; }
+	bool IsValid() const { return valid; }
+
+	bool AnyImmobile(const Rect& r, int margin) const { return (RectSum(immobileSums, r.x1 - margin, r.z1 - margin, r.x2 + margin, r.z2 + margin) != 0); }
+	bool AnyOpenYard(const Rect& r, int margin) const { return (RectSum(openYardSums, r.x1 - margin, r.z1 - margin, r.x2 + margin, r.z2 + margin) != 0); }
+
+private:
+	int RectSum(const std::vector<int>& sums, int x1, int z1, int x2, int z2) const {
+		x1 = Clamp(x1 - xmin, 0, xsize);
+		z1 = Clamp(z1 - zmin, 0, zsize);
+		x2 = Clamp(x2 - xmin, 0, xsize);
+		z2 = Clamp(z2 - zmin, 0, zsize);
+
+		if (x2 <= x1 || z2 <= z1)
+			return 0;
+
+		const int w = xsize + 1;
+		return (sums[z2 * w + x2] - sums[z1 * w + x2] - sums[z2 * w + x1] + sums[z1 * w + x1]);
+	}
+
+private:
+	std::vector<int> immobileSums;
+	std::vector<int> openYardSums;
+
+	int xmin = 0;
+	int zmin = 0;
+	int xsize = 0;
+	int zsize = 0;
+
+	bool valid = false;
+};
+
 float3 CGameHelper::ClosestBuildPos(
 	int team,
 	const UnitDef* unitDef,
@@ -929,6 +1244,12 @@ float3 CGameHelper::ClosestBuildPos(
 	if (unitDef == nullptr)
 		return -RgtVector;
 
+	// the tables are only worth building once the first few candidates
+	// have failed; most searches outside crowded bases end before that
+	constexpr int NUM_UNACCELERATED_TESTS = 16;
+
+	static BuildBlockerSums blockerSums;
+
 	CFeature* feature = nullptr;
 
 	const int allyTeam = teamHandler.AllyTeam(team);
@@ -937,70 +1258,95 @@ float3 CGameHelper::ClosestBuildPos(
 
 	const auto& offsets = GetSearchOffsetTable(maxRadius);
 
-	// no ranged loop, table can store more offsets than we are interested in checking
-	for (int i = 0, n = Square(maxRadius * 2); i < n; i++) {
-		const float wxpos = worldPos.x + offsets[i].dx * BUILD_SQUARE_SIZE;
-		const float wzpos = worldPos.z + offsets[i].dy * BUILD_SQUARE_SIZE;
+	// facing is fixed for the whole search, and so is the footprint
+	const BuildInfo fbi(unitDef, worldPos, buildFacing);
+	const int xsize = fbi.GetXSize();
+	const int zsize = fbi.GetZSize();
 
-		BuildInfo bi(unitDef, {wxpos, 0.0f, wzpos}, buildFacing);
-		bi.pos = Pos2BuildPos(bi, false);
+	const auto GetBlockRect = [&](float wxpos, float wzpos, int margin) {
+		const int xsqr = static_cast<int>(wxpos / SQUARE_SIZE);
+		const int zsqr = static_cast<int>(wzpos / SQUARE_SIZE);
 
-		if (!TestUnitBuildSquare(bi, feature, allyTeam, synced) && (feature == nullptr || feature->allyteam != allyTeam))
-			continue;
+		return BuildBlockerSums::Rect{
+			std::max(           0, xsqr - (xsize    ) / 2 - minDistance - margin),
+			std::max(           0, zsqr - (zsize    ) / 2 - minDistance - margin),
+			std::min(mapDims.mapx, xsqr + (xsize + 1) / 2 + minDistance + margin),
+			std::min(mapDims.mapy, zsqr + (zsize + 1) / 2 + minDistance + margin),
+		};
+	};
+	// true if neither a building nor a feature is within minDistance of the
+	// footprint, and no factory with an open yard is within two squares more
+	const auto IsAreaFree = [&](const BuildBlockerSums::Rect& r) {
+		if (blockerSums.IsValid())
+			return (!blockerSums.AnyImmobile(r, 0) && !blockerSums.AnyOpenYard(r, 2));
 
-		const int xsqr  = static_cast<int>(wxpos / SQUARE_SIZE);
-		const int zsqr  = static_cast<int>(wzpos / SQUARE_SIZE);
-		const int xsize = bi.GetXSize();
-		const int zsize = bi.GetZSize();
+		for (int z = r.z1; z < r.z2; ++z) {
+			for (int x = r.x1; x < r.x2; ++x) {
+				const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(x, z);
 
-		int xmin = std::max(           0, xsqr - (xsize    ) / 2 - minDistance);
-		int zmin = std::max(           0, zsqr - (zsize    ) / 2 - minDistance);
-		int xmax = std::min(mapDims.mapx, xsqr + (xsize + 1) / 2 + minDistance);
-		int zmax = std::min(mapDims.mapy, zsqr + (zsize + 1) / 2 + minDistance);
+				if (solObj == nullptr)
+					continue;
+				// immobile=true implies Feature or Building
+				if (!solObj->immobile)
+					continue;
 
-		bool free = true;
+				return false;
+			}
+		}
 
-		// check for nearby blocking objects
+		const int xmin = std::max(           0, r.x1 - 2);
+		const int zmin = std::max(           0, r.z1 - 2);
+		const int xmax = std::min(mapDims.mapx, r.x2 + 2);
+		const int zmax = std::min(mapDims.mapy, r.z2 + 2);
+
+		// none found, check for nearby factories with open yards
 		for (int z = zmin; z < zmax; ++z) {
 			for (int x = xmin; x < xmax; ++x) {
-				const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(z * mapDims.mapx + x);
+				const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(x, z);
 
 				if (solObj == nullptr)
 					continue;
-				// immobile=true implies Feature or Building
 				if (!solObj->immobile)
 					continue;
+				if (!solObj->yardOpen)
+					continue;
 
-				free = false;
-				break;
+				return false;
 			}
 		}
 
-		if (free) {
-			xmin = std::max(           0, xmin - 2);
-			zmin = std::max(           0, zmin - 2);
-			xmax = std::min(mapDims.mapx, xmax + 2);
-			zmax = std::min(mapDims.mapy, zmax + 2);
-
-			// none found, check for nearby factories with open yards
-			for (int z = zmin; z < zmax; ++z) {
-				for (int x = xmin; x < xmax; ++x) {
-					const CSolidObject* solObj = groundBlockingObjectMap.GroundBlockedUnsafe(z * mapDims.mapx + x);
-
-					if (solObj == nullptr)
-						continue;
-					if (!solObj->immobile)
-						continue;
-					if (!solObj->yardOpen)
-						continue;
-
-					free = false;
-					break;
-				}
-			}
+		return true;
+	};
+
+	blockerSums.Kill();
+
+	// no ranged loop, table can store more offsets than we are interested in checking
+	for (int i = 0, n = Square(maxRadius * 2); i < n; i++) {
+		const float wxpos = worldPos.x + offsets[i].dx * BUILD_SQUARE_SIZE;
+		const float wzpos = worldPos.z + offsets[i].dy * BUILD_SQUARE_SIZE;
+
+		if (i == NUM_UNACCELERATED_TESTS) {
+			// window covering the blocking rectangles of all remaining candidates
+			const float searchDist = maxRadius * BUILD_SQUARE_SIZE;
+			const BuildBlockerSums::Rect r0 = GetBlockRect(worldPos.x - searchDist, worldPos.z - searchDist, 2 + 1);
+			const BuildBlockerSums::Rect r1 = GetBlockRect(worldPos.x + searchDist, worldPos.z + searchDist, 2 + 1);
+
+			blockerSums.Init(r0.x1, r0.z1, r1.x2, r1.z2);
 		}
 
-		if (free)
+		const BuildBlockerSums::Rect blockRect = GetBlockRect(wxpos, wzpos, 0);
+
+		// the blocking-object test is the cheaper one once the tables exist
+		if (blockerSums.IsValid() && !IsAreaFree(blockRect))
+			continue;
+
+		BuildInfo bi(unitDef, {wxpos, 0.0f, wzpos}, buildFacing);
+		bi.pos = Pos2BuildPos(bi, false);
+
+		if (!TestUnitBuildSquare(bi, feature, allyTeam, synced) && (feature == nullptr || feature->allyteam != allyTeam))
+			continue;
+
+		if (blockerSums.IsValid() || IsAreaFree(blockRect))
 			return bi.pos;
 	}
 
@@ -126,7 +126,18 @@ public:
 		bool synced = false
 	);
 
-	static size_t GenerateWeaponTargets(const CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+	static size_t GenerateWeaponTargets(CWeapon* weapon, const CUnit* avoidUnit, std::vector<std::pair<float, CUnit*>>& targets);
+	/**
+	 * Collects the enemy units GenerateWeaponTargets should score for @c weapon,
+	 * in allyteam-major quad order. Read-only wrt. shared state, so it is safe
+	 * to call for several weapons concurrently.
+	 */
+	static void GenerateWeaponTargetCandidates(const CWeapon* weapon, std::vector<CUnit*>& candidates, std::vector<int>& quads);
+	/**
+	 * Gathers target candidates in parallel for all auto-targeting weapons of
+	 * units[beg, end), to be consumed by GenerateWeaponTargets this frame.
+	 */
+	void BatchWeaponTargetCandidates(const std::vector<CUnit*>& units, size_t beg, size_t end);
 
 	void Init();
 	void Update();
@@ -159,6 +170,61 @@ public:
 	void DamageObjectsInExplosionRadius(const CExplosionParams& params, const float expRad, const int weaponDefID);
 	void Explosion(const CExplosionParams& params);
 
+private:
+	// read-only part of an explosion's effect on one object
+	struct ExplosionHit {
+		float3 impulse;
+
+		float expDist = 0.0f;
+		float expDistanceMod = 0.0f;
+
+		bool inRange = false;
+	};
+
+	static void CalcExplosionFalloff(
+		ExplosionHit& hit,
+		const float3& volPos,
+		const float3& expPos,
+		const float expRadius,
+		const float expEdgeEffect,
+		const DamageArray& damages
+	);
+	// safe to call for different objects concurrently
+	static void CalcExplosionHit(
+		const CUnit* unit,
+		const float3& expPos,
+		const float expRadius,
+		const float expEdgeEffect,
+		const DamageArray& damages,
+		ExplosionHit& hit
+	);
+	static void CalcExplosionHit(
+		const CFeature* feature,
+		const float3& expPos,
+		const float expRadius,
+		const float expEdgeEffect,
+		const DamageArray& damages,
+		ExplosionHit& hit
+	);
+
+	void ApplyExplosionHit(
+		CUnit* unit,
+		CUnit* owner,
+		const ExplosionHit& hit,
+		const float expSpeed,
+		const DamageArray& damages,
+		const int weaponDefID,
+		const int projectileID
+	);
+	void ApplyExplosionHit(
+		CFeature* feature,
+		CUnit* owner,
+		const ExplosionHit& hit,
+		const DamageArray& damages,
+		const int weaponDefID,
+		const int projectileID
+	);
+
 private:
 	struct WaitingDamage {
 		WaitingDamage(const DamageArray& _damage, const float3& _impulse, int _attackerID, int _targetID, int _weaponID, int _projectileID)
@@ -185,6 +251,10 @@ private:
 public:
 	std::vector<int> targetUnitIDs; // GetEnemyUnits{NoLosTest}
 	std::vector<std::pair<float, CUnit*>> targetPairs; // GenerateWeaponTargets
+
+	std::vector<int> targetQuads; // GenerateWeaponTargets
+	std::vector<CWeapon*> batchedWeapons; // BatchWeaponTargetCandidates
+	std::vector<std::vector<int>> batchedWeaponQuads; // BatchWeaponTargetCandidates, per thread
 };
 
 extern CGameHelper* helper;
@@ -51,7 +51,8 @@ CR_REG_METADATA(CGlobalUnsynced, (
 	CR_MEMBER(spectatingFullSelect),
 	CR_IGNORED(fpsMode),
 	CR_IGNORED(globalQuit),
-	CR_IGNORED(globalReload)
+	CR_IGNORED(globalReload),
+	CR_IGNORED(precomputePathCache)
 ))
 
 
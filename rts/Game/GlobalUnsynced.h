@@ -170,6 +170,14 @@ public:
 	*/
 	std::atomic<bool> globalQuit = {false};
 	std::atomic<bool> globalReload = {false};
+
+	/**
+	* @brief precompute path cache
+	*
+	* Set by --precompute-path-cache; quit as soon as
+	* loading has finished (and written the PFS caches)
+	*/
+	bool precomputePathCache = false;
 };
 
 
@@ -0,0 +1,168 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LoadStages.h"
+
+#include "System/FileSystem/VFSTrace.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <cstring>
+#include <exception>
+#include <future>
+#include <memory>
+#include <vector>
+
+
+namespace LoadStages {
+	struct Stage {
+		const char* name;
+
+		spring_time beginTime;
+		spring_time endTime;
+
+		int threadNum;
+		bool async;
+		bool wait;
+	};
+
+	struct AsyncStage {
+		const char* name;
+		std::shared_ptr<std::future<void>> result;
+	};
+
+	// written by the load thread and by async stages
+	static spring::mutex stagesMutex;
+	static spring_time loadStartTime;
+
+	static std::vector<Stage> stages;
+	static std::vector<AsyncStage> asyncStages;
+
+
+	static int AddStage(const char* name, bool async, bool wait)
+	{
+		std::lock_guard<spring::mutex> lck(stagesMutex);
+
+		stages.push_back({name, spring_now(), spring_notime, ThreadPool::GetThreadNum(), async, wait});
+		return (stages.size() - 1);
+	}
+
+
+	void Reset()
+	{
+		WaitAll();
+
+		std::lock_guard<spring::mutex> lck(stagesMutex);
+
+		stages.clear();
+		asyncStages.clear();
+
+		loadStartTime = spring_now();
+	}
+
+	void Log()
+	{
+		std::lock_guard<spring::mutex> lck(stagesMutex);
+
+		float waitTime = 0.0f;
+
+		LOG("[LoadStages] %u stages (begin, end and duration in ms relative to start of loading)", unsigned(stages.size()));
+
+		for (const Stage& s: stages) {
+			const float beginTime = (s.beginTime - loadStartTime).toMilliSecsf();
+			const float   endTime = (s.endTime   - loadStartTime).toMilliSecsf();
+
+			LOG("\t%-8s %-32s thread=%-2d begin=%9.1f end=%9.1f duration=%9.1f", (s.async? "async": (s.wait? "wait": "sync")), s.name, s.threadNum, beginTime, endTime, endTime - beginTime);
+
+			waitTime += ((endTime - beginTime) * s.wait);
+		}
+
+		LOG("[LoadStages] load thread spent %.1fms waiting on async stages", waitTime);
+	}
+
+
+	int Begin(const char* name)
+	{
+		// replays the reads of this stage from the previous trace, if any
+		VFSTrace::SetPhase(name);
+		return (AddStage(name, false, false));
+	}
+
+	void End(int stageIdx)
+	{
+		std::lock_guard<spring::mutex> lck(stagesMutex);
+		stages[stageIdx].endTime = spring_now();
+	}
+
+
+	void RunAsync(const char* name, std::function<void()>&& func)
+	{
+		const auto task = [name, f = std::move(func)]() {
+			const int stageIdx = AddStage(name, true, false);
+
+			// Log shows the pool thread the stage actually ran on
+			f();
+			End(stageIdx);
+		};
+
+		#ifdef THREADPOOL
+		// without worker threads this runs the stage right away
+		std::shared_ptr<std::future<void>> result = ThreadPool::Enqueue(task);
+
+		std::lock_guard<spring::mutex> lck(stagesMutex);
+		asyncStages.push_back({name, std::move(result)});
+		#else
+		task();
+		#endif
+	}
+
+	void Wait(const char* name)
+	{
+		std::shared_ptr<std::future<void>> result;
+
+		{
+			std::lock_guard<spring::mutex> lck(stagesMutex);
+
+			for (AsyncStage& s: asyncStages) {
+				if (s.result == nullptr || strcmp(s.name, name) != 0)
+					continue;
+
+				result = std::move(s.result);
+				break;
+			}
+		}
+
+		if (result == nullptr)
+			return;
+
+		const int stageIdx = AddStage(name, false, true);
+
+		try {
+			result->get();
+		} catch (const std::exception& e) {
+			// async stages only do work that is redone on demand if it fails
+			LOG_L(L_ERROR, "[LoadStages::%s] stage \"%s\" failed: %s", __func__, name, e.what());
+		}
+
+		End(stageIdx);
+	}
+
+	void WaitAll()
+	{
+		std::vector<const char*> names;
+
+		{
+			std::lock_guard<spring::mutex> lck(stagesMutex);
+
+			for (const AsyncStage& s: asyncStages) {
+				if (s.result != nullptr)
+					names.push_back(s.name);
+			}
+		}
+
+		for (const char* name: names) {
+			Wait(name);
+		}
+	}
+}
@@ -0,0 +1,40 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _LOAD_STAGES_H
+#define _LOAD_STAGES_H
+
+#include <functional>
+
+/**
+ * @brief Timeline of the stages CGame::Load goes through
+ * Stages either run on the load thread (Scope) or as ThreadPool tasks
+ * (RunAsync) which overlap with the stages after them; a stage that
+ * depends on an asynchronous one has to Wait for it first. Log writes
+ * when each stage began and ended relative to Reset, on which thread,
+ * and how long the load thread was blocked by every Wait, so the
+ * critical path can be read off directly.
+ */
+namespace LoadStages {
+	void Reset();
+	void Log();
+
+	/// runs <func> on the ThreadPool, <name> must be a string literal
+	void RunAsync(const char* name, std::function<void()>&& func);
+	/// blocks until the asynchronous stage <name> is done
+	void Wait(const char* name);
+	void WaitAll();
+
+	int Begin(const char* name);
+	void End(int stageIdx);
+
+	class Scope {
+	public:
+		Scope(const char* name): stageIdx(Begin(name)) {}
+		~Scope() { End(stageIdx); }
+
+	private:
+		int stageIdx;
+	};
+}
+
+#endif // _LOAD_STAGES_H
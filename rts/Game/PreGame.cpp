@@ -19,6 +19,7 @@
 #include "Game/Players/PlayerHandler.h"
 #include "UI/InfoConsole.h"
 #include "ExternalAI/SkirmishAIHandler.h"
+#include "Lua/LuaBytecodeCache.h"
 #include "Map/Generation/SimpleMapGenerator.h"
 #include "Menu/LuaMenuController.h"
 #include "Net/GameServer.h"
@@ -222,6 +223,14 @@ void CPreGame::AddModArchivesToVFS(const CGameSetup* setup)
 	vfsHandler->AddArchiveWithDeps(setup->modName, false);
 
 	modFileName = archiveScanner->ArchiveFromName(setup->modName);
+
+	{
+		sha512::hex_digest modChecksumHex;
+		sha512::dump_digest(archiveScanner->GetArchiveCompleteChecksumBytes(modFileName), modChecksumHex);
+
+		// cached Lua chunks of other games (or game versions) are dropped here
+		LuaBytecodeCache::SetArchiveChecksum(modChecksumHex.data());
+	}
 }
 
 
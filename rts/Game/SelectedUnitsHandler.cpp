@@ -17,8 +17,10 @@
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
 #include "Rendering/GL/WideLineAdapter.hpp"
+#include "Map/ReadMap.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/QuadField.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Features/Feature.h"
 #include "Sim/Units/Unit.h"
@@ -44,6 +46,9 @@
 #include <SDL_mouse.h>
 #include <SDL_keycode.h>
 
+#include <cmath>
+#include <limits>
+
 
 
 CONFIG(bool, BuildIconsFirst).defaultValue(false);
@@ -83,7 +88,7 @@ void CSelectedUnitsHandler::ToggleBuildIconsFirst()
 }
 
 
-CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailableCommands()
+const CSelectedUnitsHandler::AvailableCommandsStruct& CSelectedUnitsHandler::GetAvailableCommands()
 {
 	possibleCommandsChanged = false;
 
@@ -91,18 +96,31 @@ CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailab
 	int foundGroup = -2;
 	int foundGroup2 = -2;
 
-	spring::unordered_map<int, int> states;
-	std::vector<SCommandDescription> commands;
+	// command descriptions are interned by commandDescriptionCache, so units
+	// with equal description-pointer lists (usually all units of one type)
+	// contribute exactly the same commands; only the first of each is merged
+	cmdDescLists.clear();
 
 	for (const int unitID: selectedUnits) {
 		const CUnit* u = unitHandler.GetUnit(unitID);
 		const CCommandAI* cai = u->commandAI;
 		const CGroup* group = u->GetGroup();
 
-		for (const SCommandDescription* cmdDesc: cai->GetPossibleCommands()) {
-			states[cmdDesc->id] = cmdDesc->disabled ? 2 : 1;
+		const std::vector<const SCommandDescription*>& cmdDescs = cai->GetPossibleCommands();
+
+		uint64_t hash = cmdDescs.size();
+
+		for (const SCommandDescription* cmdDesc: cmdDescs) {
+			hash = (hash * 0x100000001B3ull) ^ reinterpret_cast<uintptr_t>(cmdDesc);
 		}
 
+		const auto pred = [&](const std::pair<uint64_t, const std::vector<const SCommandDescription*>*>& p) {
+			return (p.first == hash && *p.second == cmdDescs);
+		};
+
+		if (std::find_if(cmdDescLists.begin(), cmdDescLists.end(), pred) == cmdDescLists.end())
+			cmdDescLists.emplace_back(hash, &cmdDescs);
+
 		if (cai->lastSelectedCommandPage < commandPage)
 			commandPage = cai->lastSelectedCommandPage;
 
@@ -119,12 +137,44 @@ CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailab
 			foundGroup2 = -1;
 	}
 
-	// load the first set (separating build and non-build commands)
-	for (const int unitID: selectedUnits) {
-		const CUnit* u = unitHandler.GetUnit(unitID);
-		const CCommandAI* cai = u->commandAI;
+	availableCommands.commandPage = commandPage;
+
+	{
+		cmdDescListsKey.clear();
+
+		for (const auto& p: cmdDescLists) {
+			cmdDescListsKey.insert(cmdDescListsKey.end(), p.second->begin(), p.second->end());
+			cmdDescListsKey.push_back(nullptr);
+		}
+
+		const bool multiSel = (selectedUnits.size() > 1);
+		const unsigned int numReleases = commandDescriptionCache.GetNumReleases();
+
+		// same lists as last time and no description freed (and possibly reused) since
+		if (cmdDescListsKey == availableCommandsKey && numReleases == availableCommandsReleases && multiSel == availableCommandsMultiSel && buildIconsFirst == availableCommandsIconsFirst)
+			return availableCommands;
+
+		std::swap(availableCommandsKey, cmdDescListsKey);
+
+		availableCommandsReleases = numReleases;
+		availableCommandsMultiSel = multiSel;
+		availableCommandsIconsFirst = buildIconsFirst;
+	}
+
+	spring::unordered_map<int, int> states;
+	std::vector<SCommandDescription>& commands = availableCommands.commands;
 
-		for (const SCommandDescription* cmdDesc: cai->GetPossibleCommands()) {
+	commands.clear();
+
+	for (const auto& p: cmdDescLists) {
+		for (const SCommandDescription* cmdDesc: *p.second) {
+			states[cmdDesc->id] = cmdDesc->disabled ? 2 : 1;
+		}
+	}
+
+	// load the first set (separating build and non-build commands)
+	for (const auto& p: cmdDescLists) {
+		for (const SCommandDescription* cmdDesc: *p.second) {
 			if (buildIconsFirst) {
 				if (cmdDesc->id >= 0)
 					continue;
@@ -144,11 +194,8 @@ CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailab
 	}
 
 	// load the second set (all those that have not already been included)
-	for (const int unitID: selectedUnits) {
-		const CUnit* u = unitHandler.GetUnit(unitID);
-		const CCommandAI* cai = u->commandAI;
-
-		for (const SCommandDescription* cmdDesc: cai->GetPossibleCommands()) {
+	for (const auto& p: cmdDescLists) {
+		for (const SCommandDescription* cmdDesc: *p.second) {
 			if (buildIconsFirst) {
 				if (cmdDesc->id < 0)
 					continue;
@@ -167,10 +214,7 @@ CSelectedUnitsHandler::AvailableCommandsStruct CSelectedUnitsHandler::GetAvailab
 		}
 	}
 
-	AvailableCommandsStruct ac;
-	ac.commandPage = commandPage;
-	ac.commands = commands;
-	return ac;
+	return availableCommands;
 }
 
 
@@ -284,6 +328,58 @@ void CSelectedUnitsHandler::GiveCommand(const Command& c, bool fromUser)
 }
 
 
+/*
+ * XZ-bounds of the region inside all <planes> (dot4 < 0), found by
+ * intersecting every triple of them and keeping the vertices that are
+ * inside the remaining ones; the caller has to bound the region in x,z
+ * and from below so that it has vertices
+ */
+static bool GetPlaneRegionBounds(const float4* planes, size_t numPlanes, float3& mins, float3& maxs)
+{
+	bool haveVertex = false;
+
+	mins = { std::numeric_limits<float>::max(), 0.0f,  std::numeric_limits<float>::max()};
+	maxs = {-std::numeric_limits<float>::max(), 0.0f, -std::numeric_limits<float>::max()};
+
+	for (size_t i = 0; i < numPlanes; i++) {
+		for (size_t j = i + 1; j < numPlanes; j++) {
+			for (size_t k = j + 1; k < numPlanes; k++) {
+				const float3 jk = planes[j].cross(planes[k]);
+				const float3 ki = planes[k].cross(planes[i]);
+				const float3 ij = planes[i].cross(planes[j]);
+
+				const float det = planes[i].dot(jk);
+
+				if (std::fabs(det) < 1e-6f)
+					continue;
+
+				const float3 vtx = (jk * planes[i].w + ki * planes[j].w + ij * planes[k].w) / -det;
+				const float4 vec(vtx, 1.0f);
+
+				// tolerance scales with the magnitude of the coordinates
+				const float eps = 1e-3f * (1.0f + vtx.Length());
+				bool inside = true;
+
+				for (size_t n = 0; n < numPlanes && inside; n++) {
+					inside = (vec.dot4(planes[n]) <= eps);
+				}
+
+				if (!inside)
+					continue;
+
+				mins.x = std::min(mins.x, vtx.x);
+				mins.z = std::min(mins.z, vtx.z);
+				maxs.x = std::max(maxs.x, vtx.x);
+				maxs.z = std::max(maxs.z, vtx.z);
+
+				haveVertex = true;
+			}
+		}
+	}
+
+	return haveVertex;
+}
+
 void CSelectedUnitsHandler::HandleUnitBoxSelection(const float4& planeRight, const float4& planeLeft, const float4& planeTop, const float4& planeBottom)
 {
 	CUnit* unit = nullptr;
@@ -300,11 +396,53 @@ void CSelectedUnitsHandler::HandleUnitBoxSelection(const float4& planeRight, con
 		maxTeam = teamHandler.ActiveTeams() - 1;
 	}
 
-	for (int team = minTeam; team <= maxTeam; team++) {
-		if (!gu->spectatingFullSelect && !myPlayer->CanControlTeam(team))
-			continue;
+	// bound the selection volume by the map and the lowest ground (unit
+	// midpoints never lie far below it) so only the quads it covers need
+	// to be visited instead of every unit of every selectable team
+	const float mapMaxX = float3::maxxpos + 1.0f;
+	const float mapMaxZ = float3::maxzpos + 1.0f;
+	const float minHeight = readMap->GetCurrMinHeight() - SQUARE_SIZE * 8;
+
+	const float4 planes[] = {
+		planeRight,
+		planeLeft,
+		planeTop,
+		planeBottom,
+		{-UpVector, minHeight},
+		{-RgtVector, 0.0f},
+		{ RgtVector, -mapMaxX},
+		{-FwdVector, 0.0f},
+		{ FwdVector, -mapMaxZ},
+	};
+
+	float3 mins;
+	float3 maxs;
+
+	if (!GetPlaneRegionBounds(planes, sizeof(planes) / sizeof(planes[0]), mins, maxs)) {
+		// degenerate planes, fall back to the whole map
+		mins = ZeroVector;
+		maxs = {mapMaxX, 0.0f, mapMaxZ};
+	}
+
+	const bool ctrlPressed = KeyInput::GetKeyModState(KMOD_CTRL);
+
+	QuadFieldQuery qfQuery;
+	quadField.GetQuadsRectangle(qfQuery, mins, maxs);
+
+	const int tempNum = gs->GetTempNum();
+
+	for (const int qi: *qfQuery.quads) {
+		for (CUnit* u: quadField.GetQuad(qi).units) {
+			if (u->tempNum == tempNum)
+				continue;
+
+			u->tempNum = tempNum;
+
+			if (u->team < minTeam || u->team > maxTeam)
+				continue;
+			if (!gu->spectatingFullSelect && !myPlayer->CanControlTeam(u->team))
+				continue;
 
-		for (CUnit* u: unitHandler.GetUnitsByTeam(team)) {
 			const float4 vec(u->midPos, 1.0f);
 
 			if (vec.dot4(planeRight) >= 0.0f)
@@ -316,7 +454,7 @@ void CSelectedUnitsHandler::HandleUnitBoxSelection(const float4& planeRight, con
 			if (vec.dot4(planeBottom) >= 0.0f)
 				continue;
 
-			if (KeyInput::GetKeyModState(KMOD_CTRL) && (selectedUnits.find(u->id) != selectedUnits.end())) {
+			if (ctrlPressed && (selectedUnits.find(u->id) != selectedUnits.end())) {
 				RemoveUnit(u);
 				continue;
 			}
@@ -384,19 +522,27 @@ void CSelectedUnitsHandler::HandleSingleUnitClickSelection(CUnit* unit, bool doI
 
 
 
-void CSelectedUnitsHandler::AddUnit(CUnit* unit)
+static bool IsSelectable(const CUnit* unit)
 {
 	// if unit is being transported, we should not be able to select it
 	const CUnit* trans = unit->GetTransporter();
 
 	if (trans != nullptr && trans->unitDef->IsTransportUnit() && !trans->unitDef->isFirePlatform)
+		return false;
+
+	return (!unit->noSelect);
+}
+
+void CSelectedUnitsHandler::AddUnit(CUnit* unit)
+{
+	if (!IsSelectable(unit))
 		return;
 
-	if (unit->noSelect)
+	// already selected, nothing changes
+	if (!selectedUnits.insert(unit->id).second)
 		return;
 
-	if (selectedUnits.insert(unit->id).second)
-		AddDeathDependence(unit, DEPENDENCE_SELECTED);
+	AddDeathDependence(unit, DEPENDENCE_SELECTED);
 
 	selectionChanged = true;
 	possibleCommandsChanged = true;
@@ -422,6 +568,34 @@ void CSelectedUnitsHandler::RemoveUnit(CUnit* unit)
 }
 
 
+void CSelectedUnitsHandler::ReplaceSelected(const std::vector<CUnit*>& units)
+{
+	const int tempNum = gs->GetTempNum();
+
+	for (CUnit* u: units) {
+		u->tempNum = tempNum;
+	}
+
+	// only units leaving or entering the selection are touched
+	std::vector<CUnit*> removedUnits;
+
+	for (const int unitID: selectedUnits) {
+		CUnit* u = unitHandler.GetUnit(unitID);
+
+		if (u->tempNum != tempNum || !IsSelectable(u))
+			removedUnits.push_back(u);
+	}
+
+	for (CUnit* u: removedUnits) {
+		RemoveUnit(u);
+	}
+
+	for (CUnit* u: units) {
+		AddUnit(u);
+	}
+}
+
+
 void CSelectedUnitsHandler::ClearSelected()
 {
 	for (const int unitID: selectedUnits) {
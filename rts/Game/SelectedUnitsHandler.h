@@ -33,10 +33,12 @@ public:
 		std::vector<SCommandDescription> commands;
 		int commandPage;
 	};
-	AvailableCommandsStruct GetAvailableCommands();
+	const AvailableCommandsStruct& GetAvailableCommands();
 	void GiveCommand(const Command& c, bool fromUser = true);
 	void AddUnit(CUnit* unit);
 	void RemoveUnit(CUnit* unit);
+	/// same as ClearSelected followed by AddUnit for each of <units>, but only touches the difference
+	void ReplaceSelected(const std::vector<CUnit*>& units);
 	void ClearSelected();
 
 	/// used by MouseHandler.cpp & MiniMap.cpp
@@ -82,6 +84,17 @@ public:
 private:
 	// buffer for SendCommand unordered_set->vector conversion
 	std::vector<int16_t> selectedUnitIDs;
+
+	// distinct command-description lists of the selected units, rebuilt by GetAvailableCommands
+	std::vector< std::pair<uint64_t, const std::vector<const SCommandDescription*>*> > cmdDescLists;
+
+	// last merge result and the (flattened, nullptr-separated) lists it was made from
+	AvailableCommandsStruct availableCommands;
+	std::vector<const SCommandDescription*> availableCommandsKey;
+	std::vector<const SCommandDescription*> cmdDescListsKey;
+	unsigned int availableCommandsReleases = -1u;
+	bool availableCommandsMultiSel = false;
+	bool availableCommandsIconsFirst = false;
 };
 
 extern CSelectedUnitsHandler selectedUnitsHandler;
@@ -0,0 +1,198 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "SimFrameWatchdog.h"
+
+#include "Sim/Path/IPathManager.h"
+#include "Sim/Units/UnitHandler.h"
+#include "System/MainDefines.h"
+#include "System/TimeProfiler.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Platform/Threading.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+CONFIG(float, SimFrameBudget)
+	.defaultValue(0.0f)
+	.minimumValue(0.0f)
+	.description("Sim-frames taking longer than this many milliseconds are reported to the infolog with a breakdown of their timers and Lua callins; 0 disables.");
+
+CONFIG(std::string, SimFrameReportFile)
+	.defaultValue("")
+	.description("If set, slow sim-frame reports (see SimFrameBudget) are also appended to this file.");
+
+
+namespace SimFrameWatchdog {
+	float frameBudget = 0.0f;
+
+	struct CallInRecord {
+		std::string handleName;
+		const char* callInName;
+
+		spring_time time;
+		unsigned int numCalls;
+	};
+
+	// callins of the current frame, and the stack of those still running
+	static std::vector<CallInRecord> callInRecords;
+	static std::vector< std::pair<size_t, spring_time> > callInStack;
+
+	static std::vector< std::pair<std::string, float> > frameTimes;
+	static std::string reportFile;
+
+	static spring_time frameStartTime;
+	static std::uint64_t framePathRequests = 0;
+
+	static unsigned int numSlowFrames = 0;
+	static bool inFrame = false;
+
+	static constexpr size_t MAX_REPORTED_CALLINS = 8;
+
+
+	static void Report(FILE* file, const char* line)
+	{
+		LOG_L(L_WARNING, "%s", line);
+
+		if (file != nullptr)
+			fprintf(file, "%s\n", line);
+	}
+
+	static void WriteReport(int frameNum, float frameTime)
+	{
+		FILE* file = reportFile.empty()? nullptr: fopen(reportFile.c_str(), "a");
+
+		char buf[512];
+
+		const std::uint64_t numPathRequests = pathManager->GetPathRequestStats().GetNumTotalRecords() - framePathRequests;
+		const unsigned int numUnits = unitHandler.GetActiveUnits().size();
+
+		SNPRINTF(buf, sizeof(buf), "[SimFrameWatchdog] frame %d took %.2fms (budget %.2fms, #%u): %u units updated, %u path requests served",
+			frameNum, frameTime, frameBudget, ++numSlowFrames, numUnits, unsigned(numPathRequests));
+		Report(file, buf);
+
+		// names sort parents before their children, indent by depth
+		profiler.GetFrameTimes(frameTimes);
+
+		for (const auto& p: frameTimes) {
+			const size_t depth = std::count(p.first.begin(), p.first.end(), ':') / 2;
+			const size_t sep = p.first.rfind("::");
+			const char* name = p.first.c_str() + ((sep == std::string::npos)? 0: (sep + 2));
+
+			SNPRINTF(buf, sizeof(buf), "  %*s%-*s %8.2fms", int(depth * 2), "", int(40 - depth * 2), name, p.second);
+			Report(file, buf);
+		}
+
+		std::sort(callInRecords.begin(), callInRecords.end(), [](const CallInRecord& a, const CallInRecord& b) {
+			return (a.time > b.time);
+		});
+
+		for (size_t i = 0, n = std::min(callInRecords.size(), MAX_REPORTED_CALLINS); i < n; i++) {
+			const CallInRecord& r = callInRecords[i];
+
+			SNPRINTF(buf, sizeof(buf), "  callin %s::%s %.2fms (%u calls)", r.handleName.c_str(), r.callInName, r.time.toMilliSecsf(), r.numCalls);
+			Report(file, buf);
+		}
+
+		if (file != nullptr)
+			fclose(file);
+	}
+
+
+	void Init()
+	{
+		reportFile = configHandler->GetString("SimFrameReportFile");
+		numSlowFrames = 0;
+
+		SetBudget(configHandler->GetFloat("SimFrameBudget"));
+	}
+
+	void Kill()
+	{
+		SetBudget(0.0f);
+
+		callInRecords.clear();
+		callInStack.clear();
+		inFrame = false;
+	}
+
+	void SetBudget(float budgetMs)
+	{
+		frameBudget = std::max(0.0f, budgetMs);
+		profiler.SetFrameRecording(IsArmed());
+	}
+
+
+	void BeginFrame(int frameNum)
+	{
+		if (!IsArmed())
+			return;
+
+		profiler.ResetFrameTimes();
+		callInRecords.clear();
+
+		frameStartTime = spring_gettime();
+		framePathRequests = pathManager->GetPathRequestStats().GetNumTotalRecords();
+		inFrame = true;
+	}
+
+	void EndFrame(int frameNum)
+	{
+		if (!inFrame)
+			return;
+
+		inFrame = false;
+
+		// disarmed during the frame
+		if (!IsArmed())
+			return;
+
+		const float frameTime = (spring_gettime() - frameStartTime).toMilliSecsf();
+
+		if (frameTime <= frameBudget)
+			return;
+
+		WriteReport(frameNum, frameTime);
+	}
+
+
+	bool EnterCallIn(const std::string& handleName, const char* callInName)
+	{
+		if (!inFrame || !Threading::IsMainThread())
+			return false;
+
+		const auto pred = [&](const CallInRecord& r) { return (r.callInName == callInName && r.handleName == handleName); };
+		const auto iter = std::find_if(callInRecords.begin(), callInRecords.end(), pred);
+
+		if (iter == callInRecords.end()) {
+			callInRecords.push_back({handleName, callInName, spring_notime, 0});
+			callInStack.emplace_back(callInRecords.size() - 1, spring_gettime());
+		} else {
+			callInStack.emplace_back(iter - callInRecords.begin(), spring_gettime());
+		}
+
+		return true;
+	}
+
+	void LeaveCallIn()
+	{
+		// records were cleared by Kill while the callin ran
+		if (callInStack.empty())
+			return;
+
+		const auto& top = callInStack.back();
+
+		if (top.first < callInRecords.size()) {
+			CallInRecord& r = callInRecords[top.first];
+
+			// nested callins count towards both
+			r.time += (spring_gettime() - top.second);
+			r.numCalls += 1;
+		}
+
+		callInStack.pop_back();
+	}
+}
@@ -0,0 +1,49 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SIM_FRAME_WATCHDOG_H
+#define SIM_FRAME_WATCHDOG_H
+
+#include <string>
+
+/**
+ * @brief Reports sim-frames that take longer than SimFrameBudget
+ * While armed every timer and Lua callin of a sim-frame is tallied, and a
+ * frame that exceeds the budget gets a compact report of its timer tree,
+ * slowest callins, served path requests and updated units written to the
+ * infolog (and SimFrameReportFile if set). Nothing is kept across frames,
+ * so the cost does not grow with game length.
+ */
+namespace SimFrameWatchdog {
+	/// reads the config, call before the first sim-frame
+	void Init();
+	void Kill();
+
+	/// milliseconds, 0 disables the watchdog
+	extern float frameBudget;
+
+	inline bool IsArmed() { return (frameBudget > 0.0f); }
+	void SetBudget(float budgetMs);
+
+	void BeginFrame(int frameNum);
+	void EndFrame(int frameNum);
+
+	/// @return false if this callin is not tallied (outside a sim-frame or the main thread)
+	bool EnterCallIn(const std::string& handleName, const char* callInName);
+	void LeaveCallIn();
+
+	struct ScopedCallIn {
+	public:
+		ScopedCallIn(const std::string& handleName, const char* callInName)
+			: entered(IsArmed() && EnterCallIn(handleName, callInName))
+		{}
+		~ScopedCallIn() {
+			if (entered)
+				LeaveCallIn();
+		}
+
+	private:
+		bool entered;
+	};
+}
+
+#endif // SIM_FRAME_WATCHDOG_H
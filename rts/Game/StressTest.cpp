@@ -0,0 +1,276 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "StressTest.h"
+#include "GlobalUnsynced.h"
+
+#include "Map/Ground.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Projectiles/ProjectileParams.h"
+#include "Sim/Projectiles/WeaponProjectiles/WeaponProjectileFactory.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitDefHandler.h"
+#include "Sim/Units/UnitHandler.h"
+#include "Sim/Units/UnitLoader.h"
+#include "Sim/Units/CommandAI/CommandAI.h"
+#include "Sim/Weapons/WeaponDef.h"
+#include "Sim/Weapons/WeaponDefHandler.h"
+#include "System/Exceptions.h"
+#include "System/GlobalRNG.h"
+#include "System/SpringMath.h"
+#include "System/TdfParser.h"
+#include "System/TimeProfiler.h"
+#include "System/Log/ILog.h"
+#include "System/Platform/Watchdog.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+
+namespace StressTest {
+	// timers sampled every frame; Sim covers all of them
+	static const char* timerNames[] = {
+		"Sim",
+		"Sim::GameFrame",
+		"Sim::Path",
+		"Sim::Unit::MoveType",
+		"Sim::Unit::MoveType::Collisions",
+		"Sim::Unit::SlowUpdate",
+		"Sim::Unit::Update",
+		"Sim::Unit::Weapon",
+		"Sim::Projectiles",
+		"Sim::Features",
+		"Sim::Los",
+	};
+
+	static constexpr size_t NUM_TIMERS = sizeof(timerNames) / sizeof(timerNames[0]);
+
+	struct Scenario {
+		std::vector< std::pair<std::string, int> > units;
+
+		std::string reportFile;
+		std::string projectileWeapon;
+
+		int projectilesPerFrame = 0;
+		int numFrames = 0;
+		int numWarmupFrames = 0;
+
+		unsigned int seed = 0;
+	};
+
+	static Scenario scenario;
+	static CGlobalRNG<PCG32, false> rng;
+
+	static const WeaponDef* projectileDef = nullptr;
+
+	static std::vector<float> frameSamples[NUM_TIMERS];
+	static spring_time lastTotals[NUM_TIMERS];
+
+	static int spawnFrame = -1;
+	static bool active = false;
+
+
+	static float3 RandomMapPos(float margin)
+	{
+		const float x = margin + rng.NextFloat() * (float3::maxxpos - margin * 2.0f);
+		const float z = margin + rng.NextFloat() * (float3::maxzpos - margin * 2.0f);
+
+		return {x, CGround::GetHeightReal(x, z), z};
+	}
+
+	static void SpawnUnits()
+	{
+		const int teamID = 0;
+
+		for (const auto& p: scenario.units) {
+			const UnitDef* unitDef = unitDefHandler->GetUnitDefByName(p.first);
+
+			if (unitDef == nullptr) {
+				LOG_L(L_WARNING, "[StressTest::%s] unknown unitdef \"%s\"", __func__, p.first.c_str());
+				continue;
+			}
+
+			const float margin = std::max(unitDef->xsize, unitDef->zsize) * SQUARE_SIZE;
+
+			int numSpawned = 0;
+
+			for (; numSpawned < p.second && !teamHandler.Team(teamID)->AtUnitLimit(); numSpawned++) {
+				Watchdog::ClearTimers(false, true);
+
+				const UnitLoadParams unitParams = {
+					unitDef,
+					nullptr,
+
+					RandomMapPos(margin),
+					ZeroVector,
+
+					-1,
+					teamID,
+					FACING_SOUTH,
+
+					false,
+					false,
+				};
+
+				CUnit* unit = unitLoader->LoadUnit(unitParams);
+
+				if (unit == nullptr)
+					break;
+
+				// draw the target even for immobile units so the sequence
+				// does not depend on which unit types the scenario lists
+				const float3 patrolPos = RandomMapPos(margin);
+
+				if (unitDef->IsImmobileUnit())
+					continue;
+
+				unit->commandAI->GiveCommand(Command(CMD_PATROL, patrolPos));
+			}
+
+			LOG("[StressTest::%s] spawned %d of %d %s", __func__, numSpawned, p.second, p.first.c_str());
+		}
+	}
+
+	static void SpawnProjectiles()
+	{
+		if (projectileDef == nullptr)
+			return;
+
+		for (int i = 0; i < scenario.projectilesPerFrame; i++) {
+			ProjectileParams params;
+
+			params.weaponDef = projectileDef;
+			params.teamID = teamHandler.GaiaTeamID();
+			params.end = RandomMapPos(0.0f);
+			params.pos = params.end + UpVector * 500.0f;
+			params.speed = -UpVector * std::max(1.0f, projectileDef->projectilespeed);
+			params.ttl = GAME_SPEED * 5;
+			params.gravity = -projectileDef->myGravity;
+			params.maxRange = 1000.0f;
+
+			WeaponProjectileFactory::LoadProjectile(params);
+		}
+	}
+
+	static void SampleTimers()
+	{
+		for (size_t i = 0; i < NUM_TIMERS; i++) {
+			const spring_time total = profiler.GetTimeRecord(timerNames[i]).total;
+
+			frameSamples[i].push_back((total - lastTotals[i]).toMilliSecsf());
+			lastTotals[i] = total;
+		}
+	}
+
+	static void WriteReport()
+	{
+		FILE* file = fopen(scenario.reportFile.c_str(), "w");
+
+		if (file == nullptr) {
+			LOG_L(L_ERROR, "[StressTest::%s] can not write report \"%s\"", __func__, scenario.reportFile.c_str());
+			return;
+		}
+
+		fprintf(file, "# units=%u projectiles=%u frames=%d seed=%u\n", unitHandler.NumUnitsByTeam(0), unsigned(projectileHandler.projectileContainers[true].size()), scenario.numFrames, scenario.seed);
+		fprintf(file, "timer\tmean\tp50\tp90\tp99\tmax\n");
+
+		for (size_t i = 0; i < NUM_TIMERS; i++) {
+			std::vector<float>& samples = frameSamples[i];
+
+			if (samples.empty())
+				continue;
+
+			float sum = 0.0f;
+
+			for (const float s: samples) {
+				sum += s;
+			}
+
+			std::sort(samples.begin(), samples.end());
+
+			const auto Percentile = [&](float p) { return samples[std::min(samples.size() - 1, size_t(p * samples.size()))]; };
+
+			fprintf(file, "%s\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n", timerNames[i], sum / samples.size(), Percentile(0.5f), Percentile(0.9f), Percentile(0.99f), samples.back());
+			LOG("[StressTest] %-32s mean=%.3fms p50=%.3fms p99=%.3fms", timerNames[i], sum / samples.size(), Percentile(0.5f), Percentile(0.99f));
+		}
+
+		fclose(file);
+	}
+
+
+	std::string Init(const std::string& specFile)
+	{
+		const TdfParser parser(specFile);
+
+		if (!parser.SectionExist("STRESSTEST"))
+			throw content_error("[StressTest] no STRESSTEST section in \"" + specFile + "\"");
+
+		parser.GetTDef(scenario.numFrames, GAME_SPEED * 60, "STRESSTEST\\frames");
+		parser.GetTDef(scenario.numWarmupFrames, GAME_SPEED, "STRESSTEST\\warmup");
+		parser.GetTDef(scenario.seed, 1u, "STRESSTEST\\seed");
+		parser.GetTDef(scenario.projectilesPerFrame, 0, "STRESSTEST\\projectilesPerFrame");
+
+		scenario.reportFile = parser.SGetValueDef("stresstest.txt", "STRESSTEST\\report");
+		scenario.projectileWeapon = parser.SGetValueDef("", "STRESSTEST\\projectileWeapon");
+
+		// TDF values are unordered, sort them to make spawning deterministic
+		for (const auto& p: parser.GetAllValues("STRESSTEST\\UNITS")) {
+			scenario.units.emplace_back(p.first, std::max(0, atoi(p.second.c_str())));
+		}
+
+		std::sort(scenario.units.begin(), scenario.units.end());
+
+		active = true;
+		return (parser.SGetValueDef("", "STRESSTEST\\map"));
+	}
+
+	bool IsActive() { return active; }
+
+	void SimFrame(int frameNum)
+	{
+		if (!active)
+			return;
+
+		if (spawnFrame < 0) {
+			rng.Seed(scenario.seed);
+			profiler.SetEnabled(true);
+
+			if (!scenario.projectileWeapon.empty() && (projectileDef = weaponDefHandler->GetWeaponDef(scenario.projectileWeapon)) == nullptr)
+				LOG_L(L_WARNING, "[StressTest::%s] unknown weapondef \"%s\"", __func__, scenario.projectileWeapon.c_str());
+
+			SpawnUnits();
+
+			spawnFrame = frameNum;
+			return;
+		}
+
+		SpawnProjectiles();
+
+		// the first sample covers the frame after warmup
+		const int measuredFrames = frameNum - spawnFrame - scenario.numWarmupFrames;
+
+		if (measuredFrames < 0)
+			return;
+
+		if (measuredFrames == 0) {
+			for (size_t i = 0; i < NUM_TIMERS; i++) {
+				lastTotals[i] = profiler.GetTimeRecord(timerNames[i]).total;
+			}
+
+			return;
+		}
+
+		SampleTimers();
+
+		if (measuredFrames < scenario.numFrames)
+			return;
+
+		WriteReport();
+
+		active = false;
+		gu->globalQuit = true;
+	}
+}
@@ -0,0 +1,38 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef STRESS_TEST_H
+#define STRESS_TEST_H
+
+#include <string>
+
+/**
+ * @brief Runs a generated load scenario and reports sim timings (--stress-test)
+ * The scenario file is a TDF table:
+ *
+ *   [STRESSTEST] {
+ *     map=...;               // used if --map is not given
+ *     frames=1800;           // frames measured after spawning
+ *     warmup=30;             // frames skipped before measuring
+ *     seed=1;
+ *     report=stresstest.txt;
+ *     projectileWeapon=...;  // weapondef name
+ *     projectilesPerFrame=0;
+ *     [UNITS] { <unitdef>=<count>; ... }
+ *   }
+ *
+ * Units are spread over the map by a seeded RNG when the game starts and
+ * mobile ones patrol to a second random point, projectiles are dropped on
+ * random positions every frame. Per-frame percentiles of the Sim timers
+ * are written to the report file, then the engine quits.
+ */
+namespace StressTest {
+	/// reads the scenario, @return the map it should run on
+	std::string Init(const std::string& specFile);
+
+	bool IsActive();
+
+	/// called at the start of every simulated frame
+	void SimFrame(int frameNum);
+}
+
+#endif // STRESS_TEST_H
@@ -27,6 +27,20 @@
 // Local/Helper functions
 //////////////////////////////////////////////////////////////////////
 
+// candidates for TraceRay, culled in batches by their bounding spheres
+static std::vector<CSolidObject*> traceObjects;
+static std::vector<float> traceDists;
+static CollisionSphereBatch traceSpheres;
+
+inline static void AddTraceObject(CSolidObject* obj)
+{
+	const CollisionVolume* cv = &obj->collisionVolume;
+
+	// piece-tree hits are not bounded by the volume, never cull those
+	traceObjects.push_back(obj);
+	traceSpheres.Add(cv->GetWorldSpacePos(obj), cv->DefaultToPieceTree()? 1e18f: cv->GetBoundingRadius());
+}
+
 /**
  * helper for TestCone
  * @return true if object <o> is in the firing cone, false otherwise
@@ -215,6 +229,9 @@ float TraceRay(
 
 		// feature intersection
 		if (scanForFeatures) {
+			traceObjects.clear();
+			traceSpheres.Clear();
+
 			for (const int quadIdx: *qfQuery.quads) {
 				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
@@ -225,24 +242,39 @@ float TraceRay(
 					if (!f->HasCollidableStateBit(CSolidObject::CSTATE_BIT_QUADMAPRAYS))
 						continue;
 
-					if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
+					AddTraceObject(f);
+				}
+			}
+
+			CCollisionHandler::IntersectBoundingSpheres(pos, dir, traceLength, traceSpheres, traceDists);
+
+			for (size_t i = 0; i < traceObjects.size(); i++) {
+				// bounding sphere is entered too far out to yield a closer hit
+				if (traceDists[i] >= traceLength)
+					continue;
+
+				CFeature* f = static_cast<CFeature*>(traceObjects[i]);
 
-						// we want the closest feature (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
+				if (CCollisionHandler::DetectHit(f, f->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
+					const float len = cq.GetHitPosDist(pos, dir);
 
-						traceLength = len;
+					// we want the closest feature (intersection point) on the ray
+					if (len >= traceLength)
+						continue;
+
+					traceLength = len;
 
-						hitFeature = f;
-						*hitColQuery = cq;
-					}
+					hitFeature = f;
+					*hitColQuery = cq;
 				}
 			}
 		}
 
 		// unit intersection
 		if (scanForAnyUnits) {
+			traceObjects.clear();
+			traceSpheres.Clear();
+
 			for (const int quadIdx: *qfQuery.quads) {
 				const CQuadField::Quad& quad = quadField.GetQuad(quadIdx);
 
@@ -263,18 +295,29 @@ float TraceRay(
 					if (!doHitTest)
 						continue;
 
-					if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
-						const float len = cq.GetHitPosDist(pos, dir);
+					AddTraceObject(u);
+				}
+			}
 
-						// we want the closest unit (intersection point) on the ray
-						if (len >= traceLength)
-							continue;
+			CCollisionHandler::IntersectBoundingSpheres(pos, dir, traceLength, traceSpheres, traceDists);
 
-						traceLength = len;
+			for (size_t i = 0; i < traceObjects.size(); i++) {
+				if (traceDists[i] >= traceLength)
+					continue;
 
-						hitUnit = u;
-						*hitColQuery = cq;
-					}
+				CUnit* u = static_cast<CUnit*>(traceObjects[i]);
+
+				if (CCollisionHandler::DetectHit(u, u->GetTransformMatrix(true), pos, pos + dir * traceLength, &cq, true)) {
+					const float len = cq.GetHitPosDist(pos, dir);
+
+					// we want the closest unit (intersection point) on the ray
+					if (len >= traceLength)
+						continue;
+
+					traceLength = len;
+
+					hitUnit = u;
+					*hitColQuery = cq;
 				}
 			}
 
@@ -389,7 +389,7 @@ void CEndGameBox::Draw()
 		if (dispMode == 1) {
 			maxy = std::max(stats[stat1].max,    (stat2 != -1) ? stats[stat2].max    : 0);
 		} else {
-			maxy = std::max(stats[stat1].maxdif, (stat2 != -1) ? stats[stat2].maxdif : 0) / TeamStatistics::statsPeriod;
+			maxy = std::max(stats[stat1].maxdif, (stat2 != -1) ? stats[stat2].maxdif : 0) / statPeriod;
 		}
 
 		const size_t numPoints = stats[0].values[0].size();
@@ -398,8 +398,8 @@ void CEndGameBox::Draw()
 		const float scaley = 0.54f / maxy;
 
 		for (int a = 0; a < 5; ++a) {
-			const int secs = int(a * 0.25f * (numPoints - 1) * TeamStatistics::statsPeriod) % 60;
-			const int mins = int(a * 0.25f * (numPoints    ) * TeamStatistics::statsPeriod) / 60;
+			const int secs = int(a * 0.25f * (numPoints - 1) * statPeriod) % 60;
+			const int mins = int(a * 0.25f * (numPoints    ) * statPeriod) / 60;
 
 			font->glPrint(box.x1 + 0.12f, box.y1 + 0.07f + (a * 0.135f), 0.8f, FONT_SCALE | FONT_NORM | FONT_BUFFERED, FloatToSmallString(maxy * 0.25f * a));
 			font->glFormat(box.x1 + 0.135f + (a * 0.135f), box.y1 + 0.057f, 0.8f, FONT_SCALE | FONT_NORM | FONT_BUFFERED, "%02i:%02i", mins, secs);
@@ -437,8 +437,8 @@ void CEndGameBox::Draw()
 						v1 = statValues[a + 1];
 					} else if (a > 0) {
 						// deltas
-						v0 = (statValues[a    ] - statValues[a - 1]) / TeamStatistics::statsPeriod;
-						v1 = (statValues[a + 1] - statValues[a    ]) / TeamStatistics::statsPeriod;
+						v0 = (statValues[a    ] - statValues[a - 1]) / statPeriod;
+						v1 = (statValues[a + 1] - statValues[a    ]) / statPeriod;
 					}
 
 					bufferC->SafeAppend({{box.x1 + 0.15f + (a    ) * scalex, box.y1 + 0.08f + v0 * scaley, 0.0f}, team->color});
@@ -460,8 +460,8 @@ void CEndGameBox::Draw()
 						v0 = statValues[a    ];
 						v1 = statValues[a + 1];
 					} else if (a > 0) {
-						v0 = (statValues[a    ] - statValues[a - 1]) / TeamStatistics::statsPeriod;
-						v1 = (statValues[a + 1] - statValues[a    ]) / TeamStatistics::statsPeriod;
+						v0 = (statValues[a    ] - statValues[a - 1]) / statPeriod;
+						v1 = (statValues[a + 1] - statValues[a    ]) / statPeriod;
 					}
 
 					bufferC->SafeAppend({{box.x1 + 0.15f + (a    ) * scalex, box.y1 + 0.08f + v0 * scaley, 0.0f}, team->color});
@@ -543,13 +543,23 @@ void CEndGameBox::FillTeamStats()
 	stats.emplace_back("Damage Dealt");
 	stats.emplace_back("Damage Received");
 
+	size_t maxEntries = 1;
+
+	for (int team = 0; team < teamHandler.ActiveTeams(); team++) {
+		maxEntries = std::max(maxEntries, teamHandler.Team(team)->statHistory.GetSize() + 1);
+	}
+
+	const size_t stride = (maxEntries + MAX_GRAPH_POINTS - 1) / MAX_GRAPH_POINTS;
+
+	statPeriod = TeamStatistics::statsPeriod * int(stride);
+
 	for (int team = 0; team < teamHandler.ActiveTeams(); team++) {
 		const CTeam* pteam = teamHandler.Team(team);
 
 		if (pteam->gaia)
 			continue;
 
-		for (const auto& si: pteam->statHistory) {
+		const auto AddStats = [&](const TeamStatistics& si) {
 			stats[ 0].AddStat(team, 0);
 
 			stats[ 1].AddStat(team, si.metalUsed);
@@ -582,6 +592,12 @@ void CEndGameBox::FillTeamStats()
 
 			stats[21].AddStat(team, si.damageDealt);
 			stats[22].AddStat(team, si.damageReceived);
-		}
+		};
+
+		// sample backwards from the current stats so all points are equally spaced
+		const size_t numEntries = pteam->statHistory.GetSize() + 1;
+
+		pteam->statHistory.ForEach((numEntries - 1) % stride, numEntries - 1, stride, [&](size_t, const TeamStatistics& si) { AddStats(si); });
+		AddStats(pteam->GetCurrentStats());
 	}
 }
@@ -44,6 +44,12 @@ protected:
 	int stat1 =  1;
 	int stat2 = -1;
 
+	// long games are downsampled to at most this many points per graph
+	static constexpr size_t MAX_GRAPH_POINTS = 512;
+
+	// seconds between two graph points
+	int statPeriod = 0;
+
 	struct Stat {
 		Stat(const char* s) : name(s), max(1), maxdif(1) {}
 
@@ -684,7 +684,7 @@ bool CGuiHandler::LayoutCustomIcons(bool useSelectionPage)
 	assert(luaUI != nullptr);
 
 	// get the commands to process
-	CSelectedUnitsHandler::AvailableCommandsStruct ac = selectedUnitsHandler.GetAvailableCommands();
+	const CSelectedUnitsHandler::AvailableCommandsStruct& ac = selectedUnitsHandler.GetAvailableCommands();
 	std::vector<SCommandDescription> cmds = ac.commands;
 
 	if (!cmds.empty()) {
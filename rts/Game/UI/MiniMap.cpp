@@ -57,6 +57,7 @@ CONFIG(bool, MiniMapDrawProjectiles).defaultValue(true).headlessValue(false);
 CONFIG(bool, SimpleMiniMapColors).defaultValue(false);
 
 CONFIG(int, MiniMapRefreshRate).defaultValue(0).minimumValue(0).description("Refresh rate of asynchronous MiniMap texture updates. Value of \"0\" autoselects between 10-60FPS.");
+CONFIG(int, MiniMapIconRefreshRate).defaultValue(0).minimumValue(0).description("Refresh rate of MiniMap unit icon positions, independent of MiniMapRefreshRate. Value of \"0\" refreshes them on every MiniMap texture update.");
 
 
 
@@ -94,6 +95,7 @@ CMiniMap::CMiniMap(): CInputReceiver(BACK)
 		drawProjectiles = configHandler->GetBool("MiniMapDrawProjectiles");
 		simpleColors = configHandler->GetBool("SimpleMiniMapColors");
 		minimapRefreshRate = configHandler->GetInt("MiniMapRefreshRate");
+		iconRefreshRate = configHandler->GetInt("MiniMapIconRefreshRate");
 	}
 
 	UpdateGeometry();
@@ -1581,7 +1583,7 @@ void CMiniMap::DrawBackground()
 }
 
 
-void CMiniMap::DrawUnitIcons() const
+void CMiniMap::DrawUnitIcons()
 {
 	GL::RenderDataBufferTC* buffer = GL::GetRenderBufferTC();
 	Shader::IProgramObject* shader = buffer->GetShader();
@@ -1598,7 +1600,15 @@ void CMiniMap::DrawUnitIcons() const
 	shader->SetUniform("u_alpha_test_ctrl", 0.0f, 1.0f, 0.0f, 0.0f); // test > 0.0
 	shader->SetUniform("u_tex0", 0); // icon texture binding
 
-	unitDrawer->DrawUnitMiniMapIcons(buffer);
+	{
+		const spring_time curTime = spring_gettime();
+		const bool refreshIcons = (iconRefreshRate == 0 || curTime >= nextIconRefreshTime);
+
+		if (refreshIcons && iconRefreshRate != 0)
+			nextIconRefreshTime = curTime + spring_msecs(1000.0f / iconRefreshRate);
+
+		unitDrawer->DrawUnitMiniMapIcons(buffer, refreshIcons);
+	}
 
 	shader->SetUniform("u_alpha_test_ctrl", 0.0f, 0.0f, 0.0f, 1.0f); // no test
 	shader->Disable();
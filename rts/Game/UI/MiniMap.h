@@ -14,6 +14,7 @@
 #include "System/float4.h"
 #include "System/type2.h"
 #include "System/Matrix44f.h"
+#include "System/Misc/SpringTime.h"
 
 
 class CUnit;
@@ -97,7 +98,7 @@ protected:
 	void ProxyMouseRelease(int x, int y, int button);
 
 	void DrawBackground();
-	void DrawUnitIcons() const;
+	void DrawUnitIcons();
 	void DrawUnitRanges() const;
 	void DrawWorldStuff() const;
 
@@ -135,6 +136,9 @@ protected:
 
 
 	float minimapRefreshRate = 0.0f;
+	float iconRefreshRate = 0.0f;
+
+	spring_time nextIconRefreshTime;
 
 	float unitBaseSize = 0.0f;
 	float unitExponent = 0.0f;
@@ -22,6 +22,7 @@
 #include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Weapons/WeaponMemPool.h"
 #include "System/EventHandler.h"
+#include "System/MemoryStats.h"
 #include "System/TimeProfiler.h"
 #include "System/SafeUtil.h"
 #include "lib/lua/include/LuaUser.h" // spring_lua_alloc_get_stats
@@ -115,6 +116,69 @@ static void DrawBufferStats(const float2 pos)
 	#undef FMT
 }
 
+static void DrawMemoryStats(const float2 pos)
+{
+	static std::vector<MemoryStats::Entry> entries;
+
+	MemoryStats::GetEntries(entries);
+
+	const MemoryStats::Usage total = MemoryStats::GetTotal();
+	const float4 drawArea = {pos.x, pos.y + 0.02f, pos.x + 0.2f, pos.y - (0.045f + (entries.size() + 1) * 0.02f)};
+
+	GL::RenderDataBufferC* rdbC = GL::GetRenderBufferC();
+
+	// background
+	rdbC->SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // TL
+	rdbC->SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // BL
+	rdbC->SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // BR
+
+	rdbC->SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // BR
+	rdbC->SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // TR
+	rdbC->SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // TL
+	rdbC->Submit(GL_TRIANGLES);
+
+	font->SetTextColor(1.0f, 1.0f, 0.5f, 0.8f);
+	font->glFormat(pos.x, pos.y - 0.00f, 0.7f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "Memory (live/peak MB)");
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		const MemoryStats::Entry& e = entries[i];
+		const float y = pos.y - 0.025f - i * 0.02f;
+
+		font->glFormat(pos.x        , y, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\t%s", e.name.c_str());
+		font->glFormat(pos.x + 0.19f, y, 0.5f, FONT_TOP | FONT_RIGHT | DBG_FONT_FLAGS | FONT_BUFFERED, "%.2f / %.2f", e.usage.liveBytes / (1024.0f * 1024.0f), e.usage.peakBytes / (1024.0f * 1024.0f));
+	}
+
+	const float y = pos.y - 0.035f - entries.size() * 0.02f;
+
+	font->glFormat(pos.x        , y, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\ttotal");
+	font->glFormat(pos.x + 0.19f, y, 0.5f, FONT_TOP | FONT_RIGHT | DBG_FONT_FLAGS | FONT_BUFFERED, "%.2f / %.2f", total.liveBytes / (1024.0f * 1024.0f), total.peakBytes / (1024.0f * 1024.0f));
+}
+
+static void DrawStateStats(const float2 pos)
+{
+	const GL::AttribState::FrameStats& stats = glAttribStatePtr->GetFrameStats();
+	const float4 drawArea = {pos.x, pos.y + 0.02f, pos.x + 0.2f, pos.y - (0.025f + 4 * 0.02f)};
+
+	GL::RenderDataBufferC* rdbC = GL::GetRenderBufferC();
+
+	// background
+	rdbC->SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // TL
+	rdbC->SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // BL
+	rdbC->SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // BR
+
+	rdbC->SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.w + 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // BR
+	rdbC->SafeAppend({{drawArea.z + 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // TR
+	rdbC->SafeAppend({{drawArea.x - 10.0f * globalRendering->pixelX, drawArea.y - 10.0f * globalRendering->pixelY, 0.0f}, {0.0f, 0.0f, 0.0f, 0.5f}}); // TL
+	rdbC->Submit(GL_TRIANGLES);
+
+	font->SetTextColor(1.0f, 1.0f, 0.5f, 0.8f);
+	font->glFormat(pos.x, pos.y - 0.00f, 0.7f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "GL State (issued/skipped)");
+	font->glFormat(pos.x, pos.y - 0.025f, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\tstate=%u/%u", stats.numStateChanges, stats.numStateSkipped);
+	font->glFormat(pos.x, pos.y - 0.045f, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\tprogram=%u/%u", stats.numProgramChanges, stats.numProgramSkipped);
+	font->glFormat(pos.x, pos.y - 0.065f, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\tvao=%u/%u", stats.numVertexArrayChanges, stats.numVertexArraySkipped);
+	font->glFormat(pos.x, pos.y - 0.085f, 0.5f, FONT_TOP | DBG_FONT_FLAGS | FONT_BUFFERED, "\ttexture=%u/%u", stats.numTextureChanges, stats.numTextureSkipped);
+}
+
 static void DrawTimeSlices(
 	std::deque<TimeSlice>& frames,
 	const spring_time curTime,
@@ -348,8 +412,14 @@ static void DrawProfiler(GL::RenderDataBufferC* buffer)
 		font->glFormat(fStartX += 0.04f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "\xff\xff%c%c%.2f%%", profileData.newPeak? 1: 255, profileData.newPeak? 1: 255, profileData.stats.z * 100.0f);
 		font->glFormat(fStartX += 0.04f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_RIGHT | FONT_BUFFERED, "\xff\xff%c%c%.0fms", profileData.newLagPeak? 1: 255, profileData.newLagPeak? 1: 255, profileData.stats.x);
 
-		// print timer name
-		font->glPrint(fStartX += 0.01f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_BUFFERED, p.first);
+		// print timer name, and its hardware counters if sampled (see /profiler hwcounters)
+		if (!profileData.hasPerfStats) {
+			font->glPrint(fStartX += 0.01f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_BUFFERED, p.first);
+			continue;
+		}
+
+		font->glFormat(fStartX += 0.01f, fStartY, textSize, FONT_DESCENDER | FONT_SCALE | FONT_NORM | FONT_BUFFERED, "%s  [ipc %.2f, %.1fk cache-/%.1fk branch-misses per frame]",
+			p.first.c_str(), profileData.perfStats.x, profileData.perfStats.y * 0.001f, profileData.perfStats.z * 0.001f);
 	}
 
 
@@ -490,7 +560,7 @@ static void DrawInfoText(GL::RenderDataBufferC* buffer)
 	}
 
 	{
-		SLuaAllocState state = {{0}, {0}, {0}, {0}};
+		SLuaAllocState state = {{0}, {0}, {0}, {0}, {0}};
 		spring_lua_alloc_get_stats(&state);
 
 		const    float allocMegs = state.allocedBytes.load() / 1024.0f / 1024.0f;
@@ -541,6 +611,8 @@ void ProfileDrawer::DrawScreen()
 	DrawInfoText(buffer);
 	DrawProfiler(buffer);
 	DrawBufferStats({0.01f, 0.605f});
+	DrawMemoryStats({0.24f, 0.605f});
+	DrawStateStats({0.47f, 0.605f});
 
 	shader->Disable();
 	font->DrawBufferedGL4();
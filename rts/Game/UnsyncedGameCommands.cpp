@@ -44,6 +44,7 @@
 #include "Game/UI/Groups/GroupHandler.h"
 #include "Game/UI/PlayerRoster.h"
 
+#include "Lua/LuaCallInProfiler.h"
 #include "Lua/LuaOpenGL.h"
 #include "Lua/LuaUI.h"
 
@@ -57,6 +58,7 @@
 #include "Net/GameServer.h"
 #include "Net/Protocol/NetProtocol.h"
 
+#include "Rendering/CommandDrawer.h"
 #include "Rendering/DebugColVolDrawer.h"
 #include "Rendering/DebugDrawerAI.h"
 #include "Rendering/IPathDrawer.h"
@@ -82,8 +84,10 @@
 
 #include "Sim/MoveTypes/MoveDefHandler.h"
 #include "Sim/Misc/TeamHandler.h"
+#include "Sim/Path/IPathManager.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Units/UnitHandler.h"
@@ -91,10 +95,13 @@
 
 #include "System/EventHandler.h"
 #include "System/GlobalConfig.h"
+#include "System/MemoryStats.h"
 #include "System/SafeUtil.h"
 #include "System/TimeProfiler.h"
 #include "System/Log/ILog.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/SimpleParser.h"
 #include "System/Sound/ISound.h"
 #include "System/Sound/ISoundChannels.h"
@@ -241,7 +248,7 @@ public:
 
 class MapMeshDrawerActionExecutor : public IUnsyncedActionExecutor {
 public:
-	MapMeshDrawerActionExecutor() : IUnsyncedActionExecutor("mapmeshdrawer", "Switch map-mesh rendering modes: 0=GCM, 1=HLOD, 2=ROAM") {
+	MapMeshDrawerActionExecutor() : IUnsyncedActionExecutor("mapmeshdrawer", "Switch map-mesh rendering modes: 0=GCM, 1=HLOD, 2=ROAM, 3=GPU") {
 	}
 
 	bool Execute(const UnsyncedAction& action) const final override {
@@ -1452,6 +1459,94 @@ public:
 };
 
 
+class LuaProfileActionExecutor: public IUnsyncedActionExecutor {
+public:
+	LuaProfileActionExecutor() : IUnsyncedActionExecutor(
+		"LuaProfile",
+		"Profile Lua callins per function: start [sample], stop, or dump [file] as folded stacks for flamegraph tools"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final override {
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		if (args.empty())
+			return false;
+
+		switch (hashString(args[0].c_str())) {
+			case hashString("start"): {
+				const bool sample = (args.size() > 1 && args[1] == "sample");
+
+				LuaCallInProfiler::SetMode(sample? LuaCallInProfiler::MODE_SAMPLE: LuaCallInProfiler::MODE_INSTRUMENT);
+				LOG("[LuaProfile] started (%s)", sample? "sampling": "instrumenting");
+			} break;
+			case hashString("stop"): {
+				LuaCallInProfiler::SetMode(LuaCallInProfiler::MODE_OFF);
+				LOG("[LuaProfile] stopped");
+			} break;
+			case hashString("dump"): {
+				const std::string fileName = dataDirsAccess.LocateFile((args.size() > 1)? args[1]: "luaprofile.txt", FileQueryFlags::WRITE);
+
+				if (LuaCallInProfiler::Dump(fileName)) {
+					LOG("[LuaProfile] wrote folded stacks to \"%s\"", fileName.c_str());
+				} else {
+					LOG_L(L_WARNING, "[LuaProfile] could not write \"%s\"", fileName.c_str());
+				}
+			} break;
+			default: {
+				return false;
+			} break;
+		}
+
+		return true;
+	}
+};
+
+
+
+class ProfilerActionExecutor: public IUnsyncedActionExecutor {
+public:
+	ProfilerActionExecutor() : IUnsyncedActionExecutor(
+		"Profiler",
+		"Capture all profiler timers: capture <frames> [file] writes a Chrome trace (chrome://tracing, ui.perfetto.dev), stop ends it early,"
+		" hwcounters [timer ...] samples hardware counters (Linux) around the given main-thread timers or stops without any"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final override {
+		const std::vector<std::string>& args = _local_strSpaceTokenize(action.GetArgs());
+
+		if (args.empty())
+			return false;
+
+		switch (hashString(args[0].c_str())) {
+			case hashString("capture"): {
+				if (args.size() < 2)
+					return false;
+
+				const int numFrames = atoi(args[1].c_str());
+
+				if (numFrames <= 0)
+					return false;
+
+				profiler.StartCapture(numFrames, dataDirsAccess.LocateFile((args.size() > 2)? args[2]: "profile-capture.json", FileQueryFlags::WRITE));
+			} break;
+			case hashString("stop"): {
+				profiler.StopCapture();
+			} break;
+			case hashString("hwcounters"): {
+				if (!profiler.SetPerfCounterTimers({args.begin() + 1, args.end()}))
+					LOG_L(L_WARNING, "[%s] hardware counters are not available", __func__);
+			} break;
+			default: {
+				return false;
+			} break;
+		}
+
+		return true;
+	}
+};
+
 
 
 class GameInfoActionExecutor : public IUnsyncedActionExecutor {
@@ -1894,6 +1989,63 @@ public:
 
 
 
+class PathStatsActionExecutor : public IUnsyncedActionExecutor {
+public:
+	PathStatsActionExecutor() : IUnsyncedActionExecutor(
+		"PathStats",
+		"Prints latency and cost histograms of recent path requests, or clears them if given \"reset\""
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final override {
+		CPathRequestStats& stats = pathManager->GetPathRequestStats();
+
+		if (action.GetArgs() == "reset") {
+			stats.Clear();
+			LOG("[PathStats] cleared");
+			return true;
+		}
+
+		const CPathRequestStats::Histograms& h = stats.GetHistograms();
+		const std::uint32_t n = std::max(h.numRecords, 1u);
+
+		LOG("[PathStats] last %u requests: full=%u partial=%u failed=%u, avg queue=%u frames, avg search=%uus, avg nodes=%u",
+			h.numRecords,
+			h.resultTypes[CPathRequestStats::RESULT_FULL],
+			h.resultTypes[CPathRequestStats::RESULT_PARTIAL],
+			h.resultTypes[CPathRequestStats::RESULT_FAILED],
+			unsigned(h.sumQueueFrames / n),
+			unsigned(h.sumSearchTimes / n),
+			unsigned(h.sumExpandedNodes / n)
+		);
+
+		const auto LogHistogram = [](const char* name, const std::array<std::uint32_t, CPathRequestStats::NUM_HIST_BINS>& bins, unsigned int shift) {
+			std::string str;
+
+			for (unsigned int i = 0; i < bins.size(); i++) {
+				char buf[64];
+
+				if (i < (bins.size() - 1)) {
+					SNPRINTF(buf, sizeof(buf), " <%u:%u", unsigned(CPathRequestStats::GetHistBinLimit(i, shift)), bins[i]);
+				} else {
+					SNPRINTF(buf, sizeof(buf), " >=%u:%u", unsigned(CPathRequestStats::GetHistBinLimit(i - 1, shift)), bins[i]);
+				}
+
+				str += buf;
+			}
+
+			LOG("[PathStats]   %s%s", name, str.c_str());
+		};
+
+		LogHistogram("queue-frames  ", h.queueFrames, CPathRequestStats::QUEUE_BIN_SHIFT);
+		LogHistogram("search-micros ", h.searchTimes, CPathRequestStats::TIME_BIN_SHIFT);
+		LogHistogram("expanded-nodes", h.expandedNodes, CPathRequestStats::NODE_BIN_SHIFT);
+		return true;
+	}
+};
+
+
+
 class ShareDialogActionExecutor : public IUnsyncedActionExecutor {
 public:
 	ShareDialogActionExecutor() : IUnsyncedActionExecutor(
@@ -2018,7 +2170,7 @@ public:
 
 class ScreenShotActionExecutor : public IUnsyncedActionExecutor {
 public:
-	ScreenShotActionExecutor() : IUnsyncedActionExecutor("ScreenShot", "Take a screen-shot of the current view") {
+	ScreenShotActionExecutor() : IUnsyncedActionExecutor("ScreenShot", "Take a screen-shot of the current view, or toggle capturing every frame with \"<type> sequence\"") {
 	}
 
 	bool Execute(const UnsyncedAction& action) const final override {
@@ -2193,6 +2345,7 @@ public:
 	bool Execute(const UnsyncedAction& action) const final override {
 		const std::string& fileName = action.GetArgs().empty() ? "cmdcolors.txt" : action.GetArgs();
 		cmdColors.LoadConfigFromFile(fileName);
+		commandDrawer->InvalidatePaths();
 		LOG("Reloaded cmdcolors from file: %s", fileName.c_str());
 		return true;
 	}
@@ -3086,7 +3239,7 @@ class DebugInfoActionExecutor : public IUnsyncedActionExecutor {
 public:
 	DebugInfoActionExecutor() : IUnsyncedActionExecutor(
 		"DebugInfo",
-		"Print debug info to the chat/log-file about either sound, profiling, or command-descriptions"
+		"Print debug info to the chat/log-file about either sound, profiling, command-descriptions, or the projectile memory-pool"
 	) {
 	}
 
@@ -3103,8 +3256,13 @@ public:
 			case hashString("cmddescrs"): {
 				commandDescriptionCache.Dump(true);
 			} break;
+			case hashString("projmempool"): {
+				for (size_t c = 0; c < ProjMemPool::NUM_CLASSES(); c++) {
+					LOG("[DbgInfoAction::%s] class %u (%u bytes): %u used, %u free, %.1fKB allocated", __func__, unsigned(c), unsigned(ProjMemPool::PAGE_SIZE(c)), unsigned(projMemPool.used_count(c)), unsigned(projMemPool.freed_count(c)), projMemPool.alloc_size(c) / 1024.0f);
+				}
+			} break;
 			default: {
-				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", or \"cmddescrs\")", __func__, args.c_str());
+				LOG_L(L_WARNING, "[DbgInfoAction::%s] unknown argument \"%s\" (use \"sound\", \"profiling\", \"cmddescrs\", or \"projmempool\")", __func__, args.c_str());
 			} break;
 		}
 
@@ -3114,6 +3272,23 @@ public:
 
 
 
+class MemStatsActionExecutor : public IUnsyncedActionExecutor {
+public:
+	MemStatsActionExecutor() : IUnsyncedActionExecutor(
+		"MemStats",
+		"Print the live and peak memory usage of the engine's large allocators to the log-file"
+	) {
+	}
+
+	bool Execute(const UnsyncedAction& action) const final override {
+		MemoryStats::Update();
+		MemoryStats::Print();
+		return true;
+	}
+};
+
+
+
 class RedirectToSyncedActionExecutor : public IUnsyncedActionExecutor {
 public:
 	RedirectToSyncedActionExecutor(const std::string& command): IUnsyncedActionExecutor(
@@ -3400,6 +3575,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<ToggleLOSActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<ToggleInfoActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<ShowPathTypeActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<PathStatsActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<ShareDialogActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<QuitMessageActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<QuitMenuActionExecutor>());
@@ -3432,6 +3608,8 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<NoLuaDrawActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<LuaUIActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<LuaGarbageCollectControlExecutor>());
+	AddActionExecutor(AllocActionExecutor<LuaProfileActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<ProfilerActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<MiniMapActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<GroundDecalsActionExecutor>());
 
@@ -3467,6 +3645,7 @@ void UnsyncedGameCommands::AddDefaultActionExecutors()
 	AddActionExecutor(AllocActionExecutor<ReloadGameActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<ReloadShadersActionExecutor>());
 	AddActionExecutor(AllocActionExecutor<DebugInfoActionExecutor>());
+	AddActionExecutor(AllocActionExecutor<MemStatsActionExecutor>());
 
 	// XXX are these redirects really required?
 	AddActionExecutor(AllocActionExecutor<RedirectToSyncedActionExecutor>("ATM"));
@@ -10,6 +10,8 @@ struct SLuaAllocState {
 	std::atomic<uint64_t> numLuaAllocs;
 	std::atomic<uint64_t> luaAllocTime;
 	std::atomic<uint64_t> numLuaStates;
+	// bytes by which allocations grew in total, never decreases
+	std::atomic<uint64_t> grownBytes;
 };
 
 #endif
@@ -0,0 +1,185 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaBytecodeCache.h"
+#include "LuaInclude.h"
+
+#include "Game/GameVersion.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/Sync/SHA512.hpp"
+#include "System/Threading/SpringThreading.h"
+
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+CONFIG(bool, LuaBytecodeCache)
+	.defaultValue(true)
+	.description("Cache compiled Lua chunks (defs, gadgets, widgets, ...) on disk and load them instead of reparsing unchanged sources.");
+
+
+// chunks below this size compile faster than their cache file can be found
+static constexpr size_t MIN_CACHED_CODE_SIZE = 1024;
+
+static spring::mutex cacheMutex;
+static std::string cacheDir;
+
+
+static const std::string& GetCacheDir()
+{
+	std::lock_guard<spring::mutex> lock(cacheMutex);
+
+	if (cacheDir.empty()) {
+		cacheDir = FileSystem::GetCacheDir() + "/luabytecode/";
+
+		if (!FileSystem::CreateDirectory(cacheDir))
+			LOG_L(L_WARNING, "[LuaBytecodeCache] could not create \"%s\"", cacheDir.c_str());
+	}
+
+	return cacheDir;
+}
+
+static std::string GetChunkFileName(const std::string& code, const std::string& chunkName)
+{
+	// anything that changes the bytecode layout or compiler output
+	static const std::string vmKey =
+		std::string(LUA_RELEASE) + "|" +
+		std::to_string(sizeof(lua_Number)) + "|" +
+		std::to_string(sizeof(void*)) + "|" +
+		SpringVersion::GetFull();
+
+	sha512::msg_vector msg;
+	sha512::raw_digest digest;
+	sha512::hex_digest hexDigest;
+
+	msg.reserve(vmKey.size() + chunkName.size() + code.size() + 2);
+	msg.insert(msg.end(), vmKey.begin(), vmKey.end());
+	msg.push_back(0);
+	msg.insert(msg.end(), chunkName.begin(), chunkName.end());
+	msg.push_back(0);
+	msg.insert(msg.end(), code.begin(), code.end());
+
+	sha512::calc_digest(msg, digest);
+	sha512::dump_digest(digest, hexDigest);
+
+	// 128 bits of the digest are plenty to tell chunks apart
+	return (GetCacheDir() + std::string(hexDigest.data(), 32) + ".luac");
+}
+
+
+static int WriteChunk(lua_State* L, const void* p, size_t sz, void* ud)
+{
+	std::string* chunk = static_cast<std::string*>(ud);
+	chunk->append(static_cast<const char*>(p), sz);
+	return 0;
+}
+
+static void StoreChunk(lua_State* L, const std::string& fileName)
+{
+	std::string chunk;
+
+	// function to dump is at the top of the stack
+	if (lua_dump(L, WriteChunk, &chunk) != 0 || chunk.empty())
+		return;
+
+	const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+	// write into a temporary file first; other processes may read the cache concurrently
+	const std::string tempPath = filePath + ".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return;
+
+		file.write(chunk.data(), chunk.size());
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return;
+		}
+	}
+
+	// rename does not replace existing files on every platform
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0)
+		std::remove(tempPath.c_str());
+}
+
+static bool LoadChunk(lua_State* L, const std::string& fileName, const std::string& chunkName)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(fileName), std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	const std::string chunk((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	if (chunk.empty() || chunk[0] != LUA_SIGNATURE[0])
+		return false;
+
+	if (luaL_loadbuffer(L, chunk.data(), chunk.size(), chunkName.c_str()) != 0) {
+		// truncated or otherwise broken; recompile from source
+		lua_pop(L, 1);
+		return false;
+	}
+
+	return true;
+}
+
+
+int LuaBytecodeCache::LoadBuffer(lua_State* L, const std::string& code, const std::string& chunkName)
+{
+	// precompiled code is loaded as-is, small chunks are not worth a file lookup
+	if (code.size() < MIN_CACHED_CODE_SIZE || code[0] == LUA_SIGNATURE[0] || !configHandler->GetBool("LuaBytecodeCache"))
+		return (luaL_loadbuffer(L, code.c_str(), code.size(), chunkName.c_str()));
+
+	const std::string fileName = GetChunkFileName(code, chunkName);
+
+	if (LoadChunk(L, fileName, chunkName))
+		return 0;
+
+	const int error = luaL_loadbuffer(L, code.c_str(), code.size(), chunkName.c_str());
+
+	if (error == 0)
+		StoreChunk(L, fileName);
+
+	return error;
+}
+
+
+void LuaBytecodeCache::SetArchiveChecksum(const std::string& checksumHex)
+{
+	const std::string& dir = GetCacheDir();
+	const std::string checksumFileName = dir + "checksum.txt";
+
+	std::string prevChecksumHex;
+
+	{
+		std::ifstream file(dataDirsAccess.LocateFile(checksumFileName));
+
+		if (file.is_open())
+			std::getline(file, prevChecksumHex);
+	}
+
+	if (prevChecksumHex == checksumHex)
+		return;
+
+	const std::vector<std::string>& chunkFiles = dataDirsAccess.FindFiles(dir, "*.luac");
+
+	LOG("[LuaBytecodeCache::%s] archive checksum changed, removing %u cached chunks", __func__, unsigned(chunkFiles.size()));
+
+	for (const std::string& chunkFile: chunkFiles) {
+		std::remove(dataDirsAccess.LocateFile(chunkFile).c_str());
+	}
+
+	std::ofstream file(dataDirsAccess.LocateFile(checksumFileName, FileQueryFlags::WRITE), std::ios::out | std::ios::trunc);
+
+	if (file.is_open())
+		file << checksumHex << '\n';
+}
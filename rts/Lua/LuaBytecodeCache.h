@@ -0,0 +1,26 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_BYTECODE_CACHE_H
+#define LUA_BYTECODE_CACHE_H
+
+#include <string>
+
+struct lua_State;
+
+/**
+ * @brief Compiled Lua chunks cached under <cachedir>/luabytecode/
+ * Entries are keyed by a digest of the source code, the chunk name (it ends
+ * up in the debug info) and the Lua VM / engine build, so a changed file or
+ * engine never loads a stale chunk. All entries are dropped whenever the game
+ * archive checksum differs from the one the cache was last used with, which
+ * keeps the directory from collecting chunks of every game version played.
+ */
+namespace LuaBytecodeCache {
+	/// drop-in replacement for luaL_loadbuffer, returns the same error codes
+	int LoadBuffer(lua_State* L, const std::string& code, const std::string& chunkName);
+
+	/// called once the game archives are in the VFS
+	void SetArchiveChecksum(const std::string& checksumHex);
+}
+
+#endif // LUA_BYTECODE_CACHE_H
@@ -0,0 +1,265 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaCallInProfiler.h"
+#include "LuaInclude.h"
+
+#include "System/UnorderedMap.hpp"
+#include "System/Misc/SpringTime.h"
+#include "System/Platform/Threading.h"
+
+#include <cassert>
+#include <cstdio>
+#include <vector>
+
+namespace LuaCallInProfiler {
+	struct Node {
+		std::uint32_t frameIdx;
+		std::uint32_t parentIdx;
+		std::int64_t selfTime; // ns
+	};
+
+	struct CallIn {
+		lua_State* state;
+
+		// restored on exit, debug.sethook might be in use
+		lua_Hook prevHook;
+		int prevHookMask;
+		int prevHookCount;
+
+		// profiler stack depth before entering, and with the handle and callin frames
+		size_t prevNodeDepth;
+		size_t nodeDepth;
+		// Lua stack depth before entering, frames above it belong to outer callins
+		int luaDepth;
+	};
+
+	struct FrameKey {
+		bool operator == (const FrameKey& k) const { return (source == k.source && name == k.name && line == k.line); }
+
+		// interned strings owned by the Lua state, stable while their function lives
+		const char* source;
+		const char* name;
+		int line;
+	};
+	struct FrameKeyHash {
+		size_t operator () (const FrameKey& k) const {
+			return (std::hash<const void*>()(k.source) ^ (std::hash<const void*>()(k.name) * 31) ^ k.line);
+		}
+	};
+
+	int mode = MODE_OFF;
+
+	// node 0 is the root, parents always precede their children
+	static std::vector<Node> nodes = {{0, 0, 0}};
+	static std::vector<std::string> frameNames;
+	static std::vector<std::uint32_t> nodeStack;
+	static std::vector<CallIn> callIns;
+
+	static spring::unsynced_map<std::uint64_t, std::uint32_t> childNodes; // (parent << 32 | frame) -> node
+	static spring::unsynced_map<std::string, std::uint32_t> frameIndices;
+	static spring::unsynced_map<FrameKey, std::uint32_t, FrameKeyHash> luaFrameIndices;
+
+	static spring_time lastTime;
+
+
+	static std::uint32_t GetFrameIndex(std::string name)
+	{
+		// folded stacks use ';' as separator
+		for (char& c: name) {
+			c = (c == ';')? ':': c;
+		}
+
+		const auto it = frameIndices.find(name);
+
+		if (it != frameIndices.end())
+			return it->second;
+
+		frameNames.push_back(name);
+		frameIndices.emplace(std::move(name), frameNames.size() - 1);
+		return (frameNames.size() - 1);
+	}
+
+	static std::uint32_t GetLuaFrameIndex(lua_State* L, lua_Debug* ar)
+	{
+		lua_getinfo(L, "Sn", ar);
+
+		const FrameKey key = {ar->source, ar->name, ar->linedefined};
+		const auto it = luaFrameIndices.find(key);
+
+		if (it != luaFrameIndices.end())
+			return it->second;
+
+		std::string name = (ar->name != nullptr)? ar->name: "?";
+
+		if (ar->what[0] != 'C') {
+			name += " (";
+			name += ar->short_src;
+			name += ":" + std::to_string(ar->linedefined) + ")";
+		} else {
+			name = "[C] " + name;
+		}
+
+		return (luaFrameIndices[key] = GetFrameIndex(std::move(name)));
+	}
+
+	static std::uint32_t GetChildNode(std::uint32_t parentIdx, std::uint32_t frameIdx)
+	{
+		const std::uint64_t key = (std::uint64_t(parentIdx) << 32) | frameIdx;
+		const auto it = childNodes.find(key);
+
+		if (it != childNodes.end())
+			return it->second;
+
+		nodes.push_back({frameIdx, parentIdx, 0});
+		childNodes.emplace(key, nodes.size() - 1);
+		return (nodes.size() - 1);
+	}
+
+	static int GetLuaStackDepth(lua_State* L)
+	{
+		lua_Debug ar;
+		int depth = 0;
+
+		while (lua_getstack(L, depth, &ar) != 0)
+			depth += 1;
+
+		return depth;
+	}
+
+
+	static void ChargeTime()
+	{
+		const spring_time now = spring_now();
+
+		nodes[nodeStack.back()].selfTime += (now - lastTime).toNanoSecsi();
+		lastTime = now;
+	}
+
+	static void InstrumentHook(lua_State* L, lua_Debug* ar)
+	{
+		// coroutines inherit the hook and might be resumed outside of a profiled callin
+		if (callIns.empty())
+			return;
+
+		ChargeTime();
+
+		if (ar->event == LUA_HOOKCALL) {
+			nodeStack.push_back(GetChildNode(nodeStack.back(), GetLuaFrameIndex(L, ar)));
+			return;
+		}
+
+		// a yielded coroutine never returns, but its resumer does
+		if (nodeStack.size() > callIns.back().nodeDepth)
+			nodeStack.pop_back();
+	}
+
+	static void SampleHook(lua_State* L, lua_Debug* ar)
+	{
+		if (callIns.empty())
+			return;
+
+		const CallIn& callIn = callIns.back();
+		const int numLevels = GetLuaStackDepth(L) - ((L == callIn.state)? callIn.luaDepth: 0);
+
+		nodeStack.resize(callIn.nodeDepth);
+
+		for (int level = numLevels - 1; level >= 0; level--) {
+			lua_Debug frame;
+			lua_getstack(L, level, &frame);
+			nodeStack.push_back(GetChildNode(nodeStack.back(), GetLuaFrameIndex(L, &frame)));
+		}
+
+		// the time since the last sample is charged to the stack it ended in
+		ChargeTime();
+	}
+
+
+	void SetMode(int newMode)
+	{
+		if (mode == MODE_OFF && newMode != MODE_OFF) {
+			for (Node& node: nodes) {
+				node.selfTime = 0;
+			}
+		}
+
+		mode = newMode;
+	}
+
+	bool Dump(const std::string& fileName)
+	{
+		FILE* file = fopen(fileName.c_str(), "w");
+
+		if (file == nullptr)
+			return false;
+
+		std::vector<std::string> stacks(nodes.size());
+
+		for (size_t i = 1; i < nodes.size(); i++) {
+			const Node& node = nodes[i];
+
+			if (node.parentIdx != 0)
+				stacks[i] = stacks[node.parentIdx] + ";";
+
+			stacks[i] += frameNames[node.frameIdx];
+
+			if ((node.selfTime / 1000) > 0)
+				fprintf(file, "%s %lld\n", stacks[i].c_str(), static_cast<long long>(node.selfTime / 1000));
+		}
+
+		fclose(file);
+		return true;
+	}
+
+
+	bool EnterCallIn(lua_State* L, const std::string& handleName, const char* callInName)
+	{
+		if (!Threading::IsMainThread())
+			return false;
+
+		if (nodeStack.empty()) {
+			nodeStack.push_back(0);
+			lastTime = spring_now();
+		} else {
+			ChargeTime();
+		}
+
+		CallIn callIn;
+		callIn.state = L;
+		callIn.prevHook = lua_gethook(L);
+		callIn.prevHookMask = lua_gethookmask(L);
+		callIn.prevHookCount = lua_gethookcount(L);
+		callIn.prevNodeDepth = nodeStack.size();
+		callIn.luaDepth = (mode == MODE_SAMPLE)? GetLuaStackDepth(L): 0;
+
+		nodeStack.push_back(GetChildNode(nodeStack.back(), GetFrameIndex(handleName)));
+		nodeStack.push_back(GetChildNode(nodeStack.back(), GetFrameIndex(callInName)));
+
+		callIn.nodeDepth = nodeStack.size();
+		callIns.push_back(callIn);
+
+		if (mode == MODE_SAMPLE) {
+			lua_sethook(L, SampleHook, LUA_MASKCOUNT, SAMPLE_INSTR_COUNT);
+		} else {
+			lua_sethook(L, InstrumentHook, LUA_MASKCALL | LUA_MASKRET, 0);
+		}
+
+		return true;
+	}
+
+	void LeaveCallIn(lua_State* L)
+	{
+		assert(!callIns.empty() && callIns.back().state == L);
+
+		const CallIn& callIn = callIns.back();
+
+		ChargeTime();
+		lua_sethook(L, callIn.prevHook, callIn.prevHookMask, callIn.prevHookCount);
+
+		// errors unwind the stack without return hooks
+		nodeStack.resize(callIn.prevNodeDepth);
+		callIns.pop_back();
+
+		if (callIns.empty())
+			nodeStack.clear();
+	}
+}
@@ -0,0 +1,55 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_CALLIN_PROFILER_H
+#define LUA_CALLIN_PROFILER_H
+
+#include <string>
+
+struct lua_State;
+
+/**
+ * @brief Attributes the time spent in Lua callins to Lua call stacks (/luaprofile)
+ * Every stack starts with the handle and callin names, followed by all Lua and
+ * C functions called below it; Lua frames carry their file and line, so time
+ * spent in a single widget or gadget shows up under its own file. The result
+ * is written as folded stacks ("frame;frame;frame usecs") which flamegraph.pl
+ * and speedscope read directly. Costs one branch per callin while stopped.
+ */
+namespace LuaCallInProfiler {
+	enum {
+		MODE_OFF        = 0,
+		MODE_INSTRUMENT = 1, // call and return hooks, exact but slows Lua code down noticeably
+		MODE_SAMPLE     = 2, // count hook, walks the Lua stack every SAMPLE_INSTR_COUNT instructions
+	};
+
+	static constexpr int SAMPLE_INSTR_COUNT = 1000;
+
+	extern int mode;
+
+	inline bool IsEnabled() { return (mode != MODE_OFF); }
+
+	/// resets the collected times when switching from MODE_OFF
+	void SetMode(int newMode);
+	/// @return false if the file could not be written
+	bool Dump(const std::string& fileName);
+
+	/// @return false if this callin is not profiled (outside the main thread)
+	bool EnterCallIn(lua_State* L, const std::string& handleName, const char* callInName);
+	void LeaveCallIn(lua_State* L);
+
+	struct ScopedCallIn {
+	public:
+		ScopedCallIn(lua_State* L, const std::string& handleName, const char* callInName)
+			: state((IsEnabled() && EnterCallIn(L, handleName, callInName))? L: nullptr)
+		{}
+		~ScopedCallIn() {
+			if (state != nullptr)
+				LeaveCallIn(state);
+		}
+
+	private:
+		lua_State* state;
+	};
+}
+
+#endif // LUA_CALLIN_PROFILER_H
@@ -45,7 +45,7 @@ public:
 	, readAllyTeam(0)
 	, selectTeam(CEventClient::NoAccessTeam)
 
-	, allocState{{0}, {0}, {0}, {0}}
+	, allocState{{0}, {0}, {0}, {0}, {0}}
 	{}
 
 	~luaContextData() {
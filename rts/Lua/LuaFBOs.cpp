@@ -536,6 +536,8 @@ int LuaFBOs::RawBindFBO(lua_State* L)
 
 int LuaFBOs::BlitFBO(lua_State* L)
 {
+	LuaOpenGL::FlushTextBatch();
+
 	if (lua_israwnumber(L, 1)) {
 		const GLint x0Src = (GLint)luaL_checknumber(L, 1);
 		const GLint y0Src = (GLint)luaL_checknumber(L, 2);
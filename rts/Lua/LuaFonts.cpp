@@ -70,6 +70,9 @@ bool LuaFonts::CreateMetatable(lua_State* L)
 
 inline void CheckDrawingEnabled(lua_State* L, const char* caller)
 {
+	// text from other fonts has to be drawn in call order
+	LuaOpenGL::FlushTextBatch();
+
 	if (LuaOpenGL::IsDrawingEnabled(L))
 		return;
 
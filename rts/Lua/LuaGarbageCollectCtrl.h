@@ -3,6 +3,7 @@
 #ifndef SPRING_LUA_GARBAGE_COLLECT_CTRL_H
 #define SPRING_LUA_GARBAGE_COLLECT_CTRL_H
 
+#include <cinttypes>
 #include <limits>
 
 struct SLuaGarbageCollectCtrl {
@@ -20,6 +21,9 @@ struct SLuaGarbageCollectCtrl {
 
 	float baseRunTimeMult = 0.0f;
 	float baseMemLoadMult = 0.0f;
+
+	// SLuaAllocState::grownBytes at the previous CollectGarbage call
+	uint64_t prevGrownBytes = 0;
 };
 
 #endif
@@ -6,7 +6,9 @@
 #include "LuaRules.h"
 #include "LuaUI.h"
 
+#include "LuaBytecodeCache.h"
 #include "LuaCallInCheck.h"
+#include "LuaCallInProfiler.h"
 #include "LuaConfig.h"
 #include "LuaHashString.h"
 #include "LuaOpenGL.h"
@@ -15,6 +17,7 @@
 #include "LuaUtils.h"
 #include "LuaZip.h"
 #include "Game/GlobalUnsynced.h"
+#include "Game/SimFrameWatchdog.h"
 #include "Game/Players/Player.h"
 #include "Game/Players/PlayerHandler.h"
 #include "Net/Protocol/NetProtocol.h"
@@ -26,10 +29,13 @@
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
 #include "Sim/Features/FeatureDef.h"
+#include "Sim/Features/FeatureDefHandler.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Weapons/WeaponDef.h"
+#include "Sim/Weapons/WeaponDefHandler.h"
 #include "System/creg/SerializeLuaState.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
@@ -38,6 +44,7 @@
 #include "System/Rectangle.h"
 #include "System/ScopedFPUSettings.h"
 #include "System/StringUtil.h"
+#include "System/UnorderedMap.hpp"
 #include "System/Log/ILog.h"
 #include "System/Input/KeyInput.h"
 #include "System/Platform/SDL1_keysym.h"
@@ -105,6 +112,8 @@ CLuaHandle::CLuaHandle(const string& _name, int _order, bool _userMode, bool _sy
 	D.owner = this;
 	D.synced = _synced;
 
+	callInFuncRefs.fill(LUA_NOREF);
+
 	D.gcCtrl.baseMemLoadMult = configHandler->GetFloat("LuaGarbageCollectionMemLoadMult");
 	D.gcCtrl.baseRunTimeMult = configHandler->GetFloat("LuaGarbageCollectionRunTimeMult");
 
@@ -153,6 +162,8 @@ void CLuaHandle::KillLua(bool inFreeHandler)
 	// false and FreeHandler runs next
 	LUA_ERASE_CONTEXT(&D, LUAHANDLE_CONTEXTS[D.synced]);
 	LUA_CLOSE(&L);
+
+	callInFuncRefs.fill(LUA_NOREF);
 }
 
 
@@ -408,6 +419,9 @@ int CLuaHandle::RunCallInTraceback(
 		int error;
 	};
 
+	const LuaCallInProfiler::ScopedCallIn profilerCallIn(L, GetName(), (hs != nullptr)? hs->GetString(): "LUS::?");
+	const SimFrameWatchdog::ScopedCallIn watchdogCallIn(GetName(), (hs != nullptr)? hs->GetString(): "LUS::?");
+
 	// TODO: use closure so we do not need to copy args
 	ScopedLuaCall call(this, L, (hs != nullptr)? hs->GetString(): "LUS::?", inArgs, outArgs, errFuncIndex, popErrorFunc);
 	call.CheckFixStack(*ts);
@@ -449,7 +463,7 @@ bool CLuaHandle::LoadCode(lua_State* L, const string& code, const string& debug)
 
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	const int error = luaL_loadbuffer(L, code.c_str(), code.size(), debug.c_str());
+	const int error = LuaBytecodeCache::LoadBuffer(L, code, debug);
 
 	if (error != 0) {
 		LOG_L(L_ERROR, "[%s::%s] error=%i (%s) debug=%s msg=%s", name.c_str(), __func__, error, LuaErrorString(error), debug.c_str(), lua_tostring(L, -1));
@@ -515,7 +529,7 @@ void CLuaHandle::Load(IArchive* archive)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_Load))
 		return;
 
 	// Load gets ZipFileReader userdatum as single argument
@@ -549,6 +563,64 @@ bool CLuaHandle::HasCallIn(lua_State* L, const string& name) const
 }
 
 
+int CLuaHandle::GetCallInIndex(const string& name)
+{
+	static const spring::unordered_map<std::string, int> callInIndices = {
+	#define SETUP_EVENT(name, props) {#name, CALLIN_IDX_ ## name},
+	#define SETUP_UNMANAGED_EVENT(name, props) {#name, CALLIN_IDX_ ## name},
+		#include "System/Events.def"
+	#undef SETUP_UNMANAGED_EVENT
+	#undef SETUP_EVENT
+	};
+
+	const auto iter = callInIndices.find(name);
+
+	if (iter == callInIndices.end())
+		return -1;
+
+	return iter->second;
+}
+
+bool CLuaHandle::PushCallInFuncByName(lua_State* L, int callInIdx)
+{
+	static const LuaHashString callInNames[] = {
+	#define SETUP_EVENT(name, props) LuaHashString(#name),
+	#define SETUP_UNMANAGED_EVENT(name, props) LuaHashString(#name),
+		#include "System/Events.def"
+	#undef SETUP_UNMANAGED_EVENT
+	#undef SETUP_EVENT
+	};
+
+	static_assert((sizeof(callInNames) / sizeof(callInNames[0])) == CALLIN_IDX_COUNT, "");
+
+	return (callInNames[callInIdx].GetGlobalFunc(L));
+}
+
+void CLuaHandle::UpdateCallInRef(lua_State* L, const string& name)
+{
+	const int callInIdx = GetCallInIndex(name);
+
+	if (callInIdx < 0)
+		return;
+
+	luaL_unref(L, LUA_REGISTRYINDEX, callInFuncRefs[callInIdx]);
+	callInFuncRefs[callInIdx] = LUA_NOREF;
+
+	if (!HasCallIn(L, name))
+		return;
+
+	lua_pushsstring(L, name);
+	lua_rawget(L, LUA_GLOBALSINDEX);
+
+	// HasCallIn is true for some names without a function
+	if (!lua_isfunction(L, -1)) {
+		lua_pop(L, 1);
+		return;
+	}
+
+	callInFuncRefs[callInIdx] = luaL_ref(L, LUA_REGISTRYINDEX);
+}
+
 bool CLuaHandle::UpdateCallIn(lua_State* L, const string& name)
 {
 	if (HasCallIn(L, name)) {
@@ -568,7 +640,7 @@ void CLuaHandle::GamePreload()
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GamePreload))
 		return;
 
 	// call the routine
@@ -583,7 +655,7 @@ void CLuaHandle::GameStart()
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GameStart))
 		return;
 
 	// call the routine
@@ -598,7 +670,7 @@ void CLuaHandle::GameOver(const std::vector<unsigned char>& winningAllyTeams)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GameOver))
 		return;
 
 	lua_createtable(L, winningAllyTeams.size(), 0);
@@ -620,7 +692,7 @@ void CLuaHandle::GamePaused(int playerID, bool paused)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GamePaused))
 		return;
 
 	lua_pushnumber(L, playerID);
@@ -648,7 +720,7 @@ void CLuaHandle::GameFrame(int frameNum)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GameFrame))
 		return;
 
 	lua_pushnumber(L, frameNum);
@@ -665,7 +737,7 @@ void CLuaHandle::GameID(const unsigned char* gameID, unsigned int numBytes)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GameID))
 		return;
 
 	char buf[33];
@@ -688,7 +760,7 @@ void CLuaHandle::TeamDied(int teamID)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_TeamDied))
 		return;
 
 	lua_pushnumber(L, teamID);
@@ -706,7 +778,7 @@ void CLuaHandle::TeamChanged(int teamID)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_TeamChanged))
 		return;
 
 	lua_pushnumber(L, teamID);
@@ -724,7 +796,7 @@ void CLuaHandle::PlayerChanged(int playerID)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_PlayerChanged))
 		return;
 
 	lua_pushnumber(L, playerID);
@@ -742,7 +814,7 @@ void CLuaHandle::PlayerAdded(int playerID)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_PlayerAdded))
 		return;
 
 	lua_pushnumber(L, playerID);
@@ -760,7 +832,7 @@ void CLuaHandle::PlayerRemoved(int playerID, int reason)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_PlayerRemoved))
 		return;
 
 	lua_pushnumber(L, playerID);
@@ -773,13 +845,13 @@ void CLuaHandle::PlayerRemoved(int playerID, int reason)
 
 /******************************************************************************/
 
-inline void CLuaHandle::UnitCallIn(const LuaHashString& hs, const CUnit* unit)
+inline void CLuaHandle::UnitCallIn(const LuaHashString& hs, int callInIdx, const CUnit* unit)
 {
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 6, __func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	if (!hs.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, callInIdx))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -799,7 +871,7 @@ void CLuaHandle::UnitCreated(const CUnit* unit, const CUnit* builder)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitCreated))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -816,7 +888,7 @@ void CLuaHandle::UnitCreated(const CUnit* unit, const CUnit* builder)
 void CLuaHandle::UnitFinished(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitFinished, unit);
 }
 
 
@@ -828,7 +900,7 @@ void CLuaHandle::UnitFromFactory(const CUnit* unit,
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitFromFactory))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -846,7 +918,7 @@ void CLuaHandle::UnitFromFactory(const CUnit* unit,
 void CLuaHandle::UnitReverseBuilt(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitReverseBuilt, unit);
 }
 
 
@@ -859,7 +931,7 @@ void CLuaHandle::UnitDestroyed(const CUnit* unit, const CUnit* attacker)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitDestroyed))
 		return;
 
 	const int argCount = 3 + 3;
@@ -890,7 +962,7 @@ void CLuaHandle::UnitTaken(const CUnit* unit, int oldTeam, int newTeam)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitTaken))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -910,7 +982,7 @@ void CLuaHandle::UnitGiven(const CUnit* unit, int oldTeam, int newTeam)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitGiven))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -926,7 +998,7 @@ void CLuaHandle::UnitGiven(const CUnit* unit, int oldTeam, int newTeam)
 void CLuaHandle::UnitIdle(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitIdle, unit);
 }
 
 
@@ -938,7 +1010,7 @@ void CLuaHandle::UnitCommand(const CUnit* unit, const Command& command, int play
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitCommand))
 		return;
 
 	const int argc = LuaUtils::PushUnitAndCommand(L, unit, command);
@@ -960,7 +1032,7 @@ void CLuaHandle::UnitCmdDone(const CUnit* unit, const Command& command)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitCmdDone))
 		return;
 
 	LuaUtils::PushUnitAndCommand(L, unit, command);
@@ -978,13 +1050,16 @@ void CLuaHandle::UnitDamaged(
 	int projectileID,
 	bool paralyzer)
 {
+	if (!eventFilters[EVENT_FILTER_UNITDAMAGED].Pass(unit->unitDef->id, weaponDefID, unit->team))
+		return;
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 11, __func__);
 
 	static const LuaHashString cmdStr(__func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitDamaged))
 		return;
 
 	int argCount = 7;
@@ -1019,7 +1094,7 @@ void CLuaHandle::UnitStunned(
 	static const LuaHashString cmdStr(__func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitStunned))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -1039,7 +1114,7 @@ void CLuaHandle::UnitExperience(const CUnit* unit, float oldExperience)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitExperience))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -1056,7 +1131,7 @@ void CLuaHandle::UnitExperience(const CUnit* unit, float oldExperience)
 void CLuaHandle::UnitHarvestStorageFull(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitHarvestStorageFull, unit);
 }
 
 
@@ -1073,7 +1148,7 @@ void CLuaHandle::UnitSeismicPing(const CUnit* unit, int allyTeam,
 	}
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitSeismicPing))
 		return;
 
 	lua_pushnumber(L, pos.x);
@@ -1093,12 +1168,12 @@ void CLuaHandle::UnitSeismicPing(const CUnit* unit, int allyTeam,
 
 /******************************************************************************/
 
-void CLuaHandle::LosCallIn(const LuaHashString& hs,
+void CLuaHandle::LosCallIn(const LuaHashString& hs, int callInIdx,
                            const CUnit* unit, int allyTeam)
 {
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 6, __func__);
-	if (!hs.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, callInIdx))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -1116,28 +1191,28 @@ void CLuaHandle::LosCallIn(const LuaHashString& hs,
 void CLuaHandle::UnitEnteredRadar(const CUnit* unit, int allyTeam)
 {
 	static const LuaHashString hs(__func__);
-	LosCallIn(hs, unit, allyTeam);
+	LosCallIn(hs, CALLIN_IDX_UnitEnteredRadar, unit, allyTeam);
 }
 
 
 void CLuaHandle::UnitEnteredLos(const CUnit* unit, int allyTeam)
 {
 	static const LuaHashString hs(__func__);
-	LosCallIn(hs, unit, allyTeam);
+	LosCallIn(hs, CALLIN_IDX_UnitEnteredLos, unit, allyTeam);
 }
 
 
 void CLuaHandle::UnitLeftRadar(const CUnit* unit, int allyTeam)
 {
 	static const LuaHashString hs(__func__);
-	LosCallIn(hs, unit, allyTeam);
+	LosCallIn(hs, CALLIN_IDX_UnitLeftRadar, unit, allyTeam);
 }
 
 
 void CLuaHandle::UnitLeftLos(const CUnit* unit, int allyTeam)
 {
 	static const LuaHashString hs(__func__);
-	LosCallIn(hs, unit, allyTeam);
+	LosCallIn(hs, CALLIN_IDX_UnitLeftLos, unit, allyTeam);
 }
 
 
@@ -1151,7 +1226,7 @@ void CLuaHandle::UnitLoaded(const CUnit* unit, const CUnit* transport)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitLoaded))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -1173,7 +1248,7 @@ void CLuaHandle::UnitUnloaded(const CUnit* unit, const CUnit* transport)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitUnloaded))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -1192,28 +1267,28 @@ void CLuaHandle::UnitUnloaded(const CUnit* unit, const CUnit* transport)
 void CLuaHandle::UnitEnteredWater(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitEnteredWater, unit);
 }
 
 
 void CLuaHandle::UnitEnteredAir(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitEnteredAir, unit);
 }
 
 
 void CLuaHandle::UnitLeftWater(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitLeftWater, unit);
 }
 
 
 void CLuaHandle::UnitLeftAir(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitLeftAir, unit);
 }
 
 
@@ -1222,14 +1297,14 @@ void CLuaHandle::UnitLeftAir(const CUnit* unit)
 void CLuaHandle::UnitCloaked(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitCloaked, unit);
 }
 
 
 void CLuaHandle::UnitDecloaked(const CUnit* unit)
 {
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitDecloaked, unit);
 }
 
 
@@ -1251,7 +1326,7 @@ bool CLuaHandle::UnitUnitCollision(const CUnit* collider, const CUnit* collidee)
 	static const LuaHashString cmdStr(__func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitUnitCollision))
 		return false;
 
 	lua_pushnumber(L, collider->id);
@@ -1283,7 +1358,7 @@ bool CLuaHandle::UnitFeatureCollision(const CUnit* collider, const CFeature* col
 	static const LuaHashString cmdStr(__func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitFeatureCollision))
 		return false;
 
 	lua_pushnumber(L, collider->id);
@@ -1305,7 +1380,7 @@ void CLuaHandle::UnitMoveFailed(const CUnit* unit)
 		return;
 
 	static const LuaHashString cmdStr(__func__);
-	UnitCallIn(cmdStr, unit);
+	UnitCallIn(cmdStr, CALLIN_IDX_UnitMoveFailed, unit);
 }
 
 
@@ -1318,7 +1393,7 @@ void CLuaHandle::RenderUnitDestroyed(const CUnit* unit)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_RenderUnitDestroyed))
 		return;
 
 	const int argCount = 3;
@@ -1342,7 +1417,7 @@ void CLuaHandle::FeatureCreated(const CFeature* feature)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_FeatureCreated))
 		return;
 
 	lua_pushnumber(L, feature->id);
@@ -1360,7 +1435,7 @@ void CLuaHandle::FeatureDestroyed(const CFeature* feature)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_FeatureDestroyed))
 		return;
 
 	lua_pushnumber(L, feature->id);
@@ -1377,12 +1452,15 @@ void CLuaHandle::FeatureDamaged(
 	int weaponDefID,
 	int projectileID)
 {
+	if (!eventFilters[EVENT_FILTER_FEATUREDAMAGED].Pass(feature->def->id, weaponDefID, feature->team))
+		return;
+
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 11, __func__);
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_FeatureDamaged))
 		return;
 
 	int argCount = 4;
@@ -1437,7 +1515,7 @@ void CLuaHandle::ProjectileCreated(const CProjectile* p)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_ProjectileCreated))
 		return;
 
 	lua_pushnumber(L, p->id);
@@ -1481,7 +1559,7 @@ void CLuaHandle::ProjectileDestroyed(const CProjectile* p)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_ProjectileDestroyed))
 		return;
 
 	lua_pushnumber(L, p->id);
@@ -1511,7 +1589,7 @@ bool CLuaHandle::Explosion(int weaponDefID, int projectileID, const float3& pos,
 	luaL_checkstack(L, 7, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_Explosion))
 		return false;
 
 	lua_pushnumber(L, weaponDefID);
@@ -1543,7 +1621,7 @@ void CLuaHandle::StockpileChanged(const CUnit* unit,
 	luaL_checkstack(L, 8, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_StockpileChanged))
 		return;
 
 	lua_pushnumber(L, unit->id);
@@ -1644,7 +1722,7 @@ void CLuaHandle::Save(zipFile archive)
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 3, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_Save))
 		return;
 
 	// Save gets ZipFileWriter userdatum as single argument
@@ -1660,7 +1738,7 @@ void CLuaHandle::UnsyncedHeightMapUpdate(const SRectangle& rect)
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 6, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnsyncedHeightMapUpdate))
 		return;
 
 	lua_pushnumber(L, rect.x1);
@@ -1678,7 +1756,7 @@ void CLuaHandle::Update()
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 2, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_Update))
 		return;
 
 	// call the routine
@@ -1691,7 +1769,7 @@ void CLuaHandle::ViewResize()
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 5, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_ViewResize))
 		return;
 
 	const int winPosY_bl = globalRendering->screenSizeY - globalRendering->winSizeY - globalRendering->winPosY; //! origin BOTTOMLEFT
@@ -1719,7 +1797,7 @@ void CLuaHandle::SunChanged()
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 2, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_SunChanged))
 		return;
 
 	// call the routine
@@ -1732,7 +1810,7 @@ bool CLuaHandle::DefaultCommand(const CUnit* unit,
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 5, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DefaultCommand))
 		return false;
 
 	if (unit) {
@@ -1778,11 +1856,11 @@ bool CLuaHandle::DefaultCommand(const CUnit* unit,
 }
 
 
-void CLuaHandle::RunDrawCallIn(const LuaHashString& hs)
+void CLuaHandle::RunDrawCallIn(const LuaHashString& hs, int callInIdx)
 {
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 2, __func__);
-	if (!hs.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, callInIdx))
 		return;
 
 	LuaOpenGL::SetDrawingEnabled(L, true);
@@ -1793,11 +1871,11 @@ void CLuaHandle::RunDrawCallIn(const LuaHashString& hs)
 	LuaOpenGL::SetDrawingEnabled(L, false);
 }
 
-#define DRAW_CALLIN(name)                     \
-void CLuaHandle::name()                       \
-{                                             \
-	static const LuaHashString cmdStr(#name); \
-	RunDrawCallIn(cmdStr);                    \
+#define DRAW_CALLIN(name)                        \
+void CLuaHandle::name()                          \
+{                                                \
+	static const LuaHashString cmdStr(#name);    \
+	RunDrawCallIn(cmdStr, CALLIN_IDX_ ## name);  \
 }
 
 
@@ -1820,9 +1898,9 @@ DRAW_CALLIN(DrawGroundPostDeferred)
 DRAW_CALLIN(DrawUnitsPostDeferred)
 DRAW_CALLIN(DrawFeaturesPostDeferred)
 
-inline void CLuaHandle::DrawScreenCommon(const LuaHashString& cmdStr)
+inline void CLuaHandle::DrawScreenCommon(const LuaHashString& cmdStr, int callInIdx)
 {
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, callInIdx))
 		return;
 
 	lua_pushnumber(L, globalRendering->viewSizeX);
@@ -1842,7 +1920,7 @@ void CLuaHandle::DrawScreen()
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
 
-	DrawScreenCommon(cmdStr);
+	DrawScreenCommon(cmdStr, CALLIN_IDX_DrawScreen);
 }
 
 
@@ -1852,7 +1930,7 @@ void CLuaHandle::DrawScreenEffects()
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
 
-	DrawScreenCommon(cmdStr);
+	DrawScreenCommon(cmdStr, CALLIN_IDX_DrawScreenEffects);
 }
 
 void CLuaHandle::DrawScreenPost()
@@ -1861,7 +1939,7 @@ void CLuaHandle::DrawScreenPost()
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
 
-	DrawScreenCommon(cmdStr);
+	DrawScreenCommon(cmdStr, CALLIN_IDX_DrawScreenPost);
 }
 
 
@@ -1870,7 +1948,7 @@ void CLuaHandle::DrawInMiniMap()
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DrawInMiniMap))
 		return;
 
 	lua_pushnumber(L, minimap->GetSizeX());
@@ -1891,7 +1969,7 @@ void CLuaHandle::DrawInMiniMapBackground()
 	LUA_CALL_IN_CHECK(L);
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DrawInMiniMapBackground))
 		return;
 
 	lua_pushnumber(L, minimap->GetSizeX());
@@ -1914,7 +1992,7 @@ void CLuaHandle::GameProgress(int frameNum)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GameProgress))
 		return;
 
 	lua_pushnumber(L, frameNum);
@@ -1930,7 +2008,7 @@ void CLuaHandle::Pong(uint8_t pingTag, const spring_time pktSendTime, const spri
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_Pong))
 		return;
 
 	lua_pushnumber(L, pingTag);
@@ -1952,7 +2030,7 @@ bool CLuaHandle::KeyPress(int key, bool isRepeat)
 	static const LuaHashString cmdStr(__func__);
 
 	// if the call is not defined, do not take the event
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_KeyPress))
 		return false;
 
 	//FIXME we should never had started using directly SDL consts, somaeday we should weakly force lua-devs to fix their code
@@ -1985,7 +2063,7 @@ bool CLuaHandle::KeyRelease(int key)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 5, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_KeyRelease))
 		return false;
 
 	lua_pushinteger(L, SDL21_keysyms(key));
@@ -2015,7 +2093,7 @@ bool CLuaHandle::TextInput(const std::string& utf8)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 3, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_TextInput))
 		return false;
 
 	lua_pushsstring(L, utf8);
@@ -2036,7 +2114,7 @@ bool CLuaHandle::TextEditing(const std::string& utf8, unsigned int start, unsign
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 5, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_TextEditing))
 		return false;
 
 	lua_pushsstring(L, utf8);
@@ -2058,7 +2136,7 @@ bool CLuaHandle::MousePress(int x, int y, int button)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 5, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_MousePress))
 		return false;
 
 	lua_pushnumber(L, x - globalRendering->viewPosX);
@@ -2080,7 +2158,7 @@ void CLuaHandle::MouseRelease(int x, int y, int button)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 5, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_MouseRelease))
 		return;
 
 	lua_pushnumber(L, x - globalRendering->viewPosX);
@@ -2097,7 +2175,7 @@ bool CLuaHandle::MouseMove(int x, int y, int dx, int dy, int button)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 7, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_MouseMove))
 		return false;
 
 	lua_pushnumber(L, x - globalRendering->viewPosX);
@@ -2121,7 +2199,7 @@ bool CLuaHandle::MouseWheel(bool up, float value)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_MouseWheel))
 		return false;
 
 	lua_pushboolean(L, up);
@@ -2141,7 +2219,7 @@ bool CLuaHandle::IsAbove(int x, int y)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_IsAbove))
 		return false;
 
 	lua_pushnumber(L, x - globalRendering->viewPosX);
@@ -2162,7 +2240,7 @@ string CLuaHandle::GetTooltip(int x, int y)
 	LUA_CALL_IN_CHECK(L, "");
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GetTooltip))
 		return "";
 
 	lua_pushnumber(L, x - globalRendering->viewPosX);
@@ -2183,7 +2261,7 @@ bool CLuaHandle::CommandNotify(const Command& cmd)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 5, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_CommandNotify))
 		return false;
 
 	// push the command id
@@ -2210,7 +2288,7 @@ bool CLuaHandle::AddConsoleLine(const string& msg, const string& section, int le
 	LUA_CALL_IN_CHECK(L, true);
 	luaL_checkstack(L, 4, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AddConsoleLine))
 		return true;
 
 	lua_pushsstring(L, msg);
@@ -2227,7 +2305,7 @@ bool CLuaHandle::GroupChanged(int groupID)
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 3, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GroupChanged))
 		return false;
 
 	lua_pushnumber(L, groupID);
@@ -2245,7 +2323,7 @@ string CLuaHandle::WorldTooltip(const CUnit* unit,
 	LUA_CALL_IN_CHECK(L, "");
 	luaL_checkstack(L, 6, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_WorldTooltip))
 		return "";
 
 	int args;
@@ -2289,7 +2367,7 @@ bool CLuaHandle::MapDrawCmd(int playerID, int type,
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 9, __func__);
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_MapDrawCmd))
 		return false;
 
 	int args;
@@ -2347,7 +2425,7 @@ bool CLuaHandle::GameSetup(const string& state, bool& ready,
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_GameSetup))
 		return false;
 
 	lua_pushsstring(L, state);
@@ -2423,7 +2501,7 @@ void CLuaHandle::DownloadQueued(int ID, const string& archiveName, const string&
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DownloadQueued))
 		return;
 
 	lua_pushinteger(L, ID);
@@ -2442,7 +2520,7 @@ void CLuaHandle::DownloadStarted(int ID)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DownloadStarted))
 		return;
 
 	lua_pushinteger(L, ID);
@@ -2459,7 +2537,7 @@ void CLuaHandle::DownloadFinished(int ID)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DownloadFinished))
 		return;
 
 	lua_pushinteger(L, ID);
@@ -2476,7 +2554,7 @@ void CLuaHandle::DownloadFailed(int ID, int errorID)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DownloadFailed))
 		return;
 
 	lua_pushinteger(L, ID);
@@ -2494,7 +2572,7 @@ void CLuaHandle::DownloadProgress(int ID, long downloaded, long total)
 	const LuaUtils::ScopedDebugTraceBack traceBack(L);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DownloadProgress))
 		return;
 
 	lua_pushinteger(L, ID);
@@ -2526,6 +2604,14 @@ void CLuaHandle::CollectGarbage(bool forced)
 	int  gcItersInBatch = 0;
 	int& gcStepsPerIter = D.gcCtrl.numStepsPerIter;
 
+	// KB allocated since the previous call; a LUA_GCSTEP of N collects
+	// about as much as N KB of allocations add, so this is the minimum
+	// number of steps per batch for the collector to keep pace
+	const uint64_t gcGrownBytes = D.allocState.grownBytes.load();
+	const uint64_t gcAllocRate = (gcGrownBytes - D.gcCtrl.prevGrownBytes) >> 10;
+
+	D.gcCtrl.prevGrownBytes = gcGrownBytes;
+
 	// if gc runs at a fixed rate, the upper limit to base runtime will
 	// quickly be reached since Lua's footprint can easily exceed 100MB
 	// and OOM exceptions become a concern when catching up
@@ -2573,6 +2659,13 @@ void CLuaHandle::CollectGarbage(bool forced)
 		gcStepsPerIter  = Clamp(gcStepsPerIter, D.gcCtrl.minStepsPerIter, D.gcCtrl.maxStepsPerIter);
 	}
 
+	if (gcItersInBatch > 0) {
+		// falling behind the allocation rate only defers the work into a larger (hitching) cycle
+		const uint64_t minStepsPerIter = std::min(gcAllocRate / gcItersInBatch, uint64_t(D.gcCtrl.maxStepsPerIter));
+
+		gcStepsPerIter = Clamp(std::max(gcStepsPerIter, int(minStepsPerIter)), D.gcCtrl.minStepsPerIter, D.gcCtrl.maxStepsPerIter);
+	}
+
 	eventHandler.DbgTimingInfo(TIMING_GC, startTime, finishTime);
 }
 
@@ -2597,6 +2690,7 @@ bool CLuaHandle::AddBasicCalls(lua_State* L)
 		HSTR_PUSH_CFUNC(L, "GetRegistry",     CallOutGetRegistry);
 		HSTR_PUSH_CFUNC(L, "GetCallInList",   CallOutGetCallInList);
 		HSTR_PUSH_CFUNC(L, "IsEngineMinVersion", CallOutIsEngineMinVersion);
+		HSTR_PUSH_CFUNC(L, "SetEventFilter",  CallOutSetEventFilter);
 		// special team constants
 		HSTR_PUSH_NUMBER(L, "NO_ACCESS_TEAM",  CEventClient::NoAccessTeam);
 		HSTR_PUSH_NUMBER(L, "ALL_ACCESS_TEAM", CEventClient::AllAccessTeam);
@@ -2695,6 +2789,66 @@ int CLuaHandle::CallOutIsEngineMinVersion(lua_State* L)
 }
 
 
+int CLuaHandle::CallOutSetEventFilter(lua_State* L)
+{
+	static const char* eventNames[NUM_EVENT_FILTERS] = {"UnitDamaged", "UnitPreDamaged", "FeatureDamaged", "FeaturePreDamaged"};
+
+	const char* eventName = luaL_checkstring(L, 1);
+	const auto it = std::find_if(std::begin(eventNames), std::end(eventNames), [&](const char* name) { return (strcmp(name, eventName) == 0); });
+
+	if (it == std::end(eventNames)) {
+		lua_pushboolean(L, false);
+		return 1;
+	}
+
+	const int eventIdx = it - std::begin(eventNames);
+	const bool unitEvent = (eventIdx == EVENT_FILTER_UNITDAMAGED || eventIdx == EVENT_FILTER_UNITPREDAMAGED);
+
+	EventFilter& filter = GetHandle(L)->eventFilters[eventIdx];
+
+	const auto ParseMask = [&](const char* key, std::vector<bool>& mask, size_t maskSize, int offset) {
+		mask.clear();
+		lua_getfield(L, 2, key);
+
+		if (lua_istable(L, -1)) {
+			mask.resize(maskSize, false);
+
+			for (int i = 1; /*no test*/; ++i) {
+				lua_rawgeti(L, -1, i);
+
+				if (!lua_isnumber(L, -1)) {
+					lua_pop(L, 1);
+					break;
+				}
+
+				const unsigned int idx = lua_toint(L, -1) + offset;
+
+				if (idx < mask.size())
+					mask[idx] = true;
+
+				lua_pop(L, 1);
+			}
+		}
+
+		lua_pop(L, 1);
+	};
+
+	// no filter table clears the filter
+	if (!lua_istable(L, 2)) {
+		filter = {};
+		lua_pushboolean(L, true);
+		return 1;
+	}
+
+	ParseMask("defIDs", filter.objectDefs, (unitEvent? unitDefHandler->NumUnitDefs(): featureDefHandler->NumFeatureDefs()) + 1, 0);
+	ParseMask("weaponDefIDs", filter.weaponDefs, weaponDefHandler->NumWeaponDefs() + EventFilter::WEAPON_DEF_OFFSET, EventFilter::WEAPON_DEF_OFFSET);
+	ParseMask("teamIDs", filter.teams, MAX_TEAMS, 0);
+
+	lua_pushboolean(L, true);
+	return 1;
+}
+
+
 int CLuaHandle::CallOutGetCallInList(lua_State* L)
 {
 	std::vector<std::string> eventList;
@@ -2721,6 +2875,9 @@ int CLuaHandle::CallOutUpdateCallIn(lua_State* L)
 
 	const string name = luaL_checkstring(L, 1);
 	CLuaHandle* lh = GetHandle(L);
+	// by calling this the handler promises to do so again whenever it
+	// reassigns <name>, which allows caching the function until then
+	lh->UpdateCallInRef(L, name);
 	lh->UpdateCallIn(L, name);
 	return 0;
 }
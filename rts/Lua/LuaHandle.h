@@ -10,6 +10,7 @@
 #include "LuaHashString.h"
 #include "lib/lua/include/LuaInclude.h" //FIXME needed for GetLuaContextData
 
+#include <array>
 #include <string>
 #include <vector>
 
@@ -245,7 +246,7 @@ class CLuaHandle : public CEventClient
 		void DrawGroundPostDeferred() override;
 		void DrawUnitsPostDeferred() override;
 		void DrawFeaturesPostDeferred() override;
-		void DrawScreenCommon(const LuaHashString& cmdStr);
+		void DrawScreenCommon(const LuaHashString& cmdStr, int callInIdx);
 		void DrawScreenEffects() override;
 		void DrawScreenPost()  override;
 		void DrawScreen() override;
@@ -295,10 +296,46 @@ class CLuaHandle : public CEventClient
 		/// returns false and prints message to log on error
 		bool RunCallIn(lua_State* L, const LuaHashString& hs, int inArgs, int outArgs);
 
-		void LosCallIn(const LuaHashString& hs, const CUnit* unit, int allyTeam);
-		void UnitCallIn(const LuaHashString& hs, const CUnit* unit);
+		void LosCallIn(const LuaHashString& hs, int callInIdx, const CUnit* unit, int allyTeam);
+		void UnitCallIn(const LuaHashString& hs, int callInIdx, const CUnit* unit);
 
-		void RunDrawCallIn(const LuaHashString& hs);
+		void RunDrawCallIn(const LuaHashString& hs, int callInIdx);
+
+		/// index of <name> in callInFuncRefs, -1 if not an event-handler call-in
+		static int GetCallInIndex(const std::string& name);
+		/// refreshes the cached function of call-in <name>
+		void UpdateCallInRef(lua_State* L, const std::string& name);
+
+		/// pushes the global function of a call-in, from the cache if Script.UpdateCallIn filled it
+		bool PushCallInFunc(lua_State* L, int callInIdx) const {
+			if (callInFuncRefs[callInIdx] == LUA_NOREF)
+				return (PushCallInFuncByName(L, callInIdx));
+
+			lua_rawgeti(L, LUA_REGISTRYINDEX, callInFuncRefs[callInIdx]);
+			return true;
+		}
+		static bool PushCallInFuncByName(lua_State* L, int callInIdx);
+
+	protected:
+		// EventClient.h leaves an empty SETUP_UNMANAGED_EVENT defined
+		#undef SETUP_UNMANAGED_EVENT
+		enum {
+		#define SETUP_EVENT(name, props) CALLIN_IDX_ ## name,
+		#define SETUP_UNMANAGED_EVENT(name, props) CALLIN_IDX_ ## name,
+			#include "System/Events.def"
+		#undef SETUP_UNMANAGED_EVENT
+		#undef SETUP_EVENT
+			CALLIN_IDX_COUNT
+		};
+
+		/**
+		 * Registry references to the global functions of each call-in, taken
+		 * only when the handler itself calls Script.UpdateCallIn for it (and
+		 * thereby promises to call it again after reassigning that global, as
+		 * gadgets.lua and handler.lua do); all other call-ins are looked up
+		 * by name every time so reassigning their global just works.
+		 */
+		std::array<int, CALLIN_IDX_COUNT> callInFuncRefs;
 
 	protected:
 		bool userMode = false;
@@ -318,6 +355,42 @@ class CLuaHandle : public CEventClient
 		std::vector<bool> watchExplosionDefs;   // callin masks for Explosion
 		std::vector<bool> watchAllowTargetDefs; // callin masks for AllowWeapon*Target*
 
+		/**
+		 * @brief Set by Script.SetEventFilter
+		 * A damage event only enters Lua if each non-empty mask contains
+		 * its (unit- or feature-) def, weapon-def and team respectively.
+		 */
+		struct EventFilter {
+			std::vector<bool> objectDefs;
+			std::vector<bool> weaponDefs; // offset by WEAPON_DEF_OFFSET for the negative damage-type IDs
+			std::vector<bool> teams;
+
+			static constexpr int WEAPON_DEF_OFFSET = 8;
+
+			bool Pass(int objectDefID, int weaponDefID, int teamID) const {
+				if (!PassMask(objectDefs, objectDefID))
+					return false;
+				if (!PassMask(weaponDefs, weaponDefID + WEAPON_DEF_OFFSET))
+					return false;
+
+				return (PassMask(teams, teamID));
+			}
+
+			static bool PassMask(const std::vector<bool>& mask, int idx) {
+				return (mask.empty() || (static_cast<unsigned int>(idx) < mask.size() && mask[idx]));
+			}
+		};
+
+		enum {
+			EVENT_FILTER_UNITDAMAGED       = 0,
+			EVENT_FILTER_UNITPREDAMAGED    = 1,
+			EVENT_FILTER_FEATUREDAMAGED    = 2,
+			EVENT_FILTER_FEATUREPREDAMAGED = 3,
+			NUM_EVENT_FILTERS              = 4,
+		};
+
+		std::array<EventFilter, NUM_EVENT_FILTERS> eventFilters;
+
 	private: // call-outs
 		static int KillActiveHandle(lua_State* L);
 		static int CallOutGetName(lua_State* L);
@@ -333,6 +406,7 @@ class CLuaHandle : public CEventClient
 		static int CallOutGetCallInList(lua_State* L);
 		static int CallOutUpdateCallIn(lua_State* L);
 		static int CallOutIsEngineMinVersion(lua_State* L);
+		static int CallOutSetEventFilter(lua_State* L);
 
 	public: // static
 #if (!defined(UNITSYNC) && !defined(DEDICATED))
@@ -110,8 +110,15 @@ bool CUnsyncedLuaHandle::Init(const std::string& code, const std::string& file)
 
 	LuaPushNamedCFunc(L, "loadstring", CSplitLuaHandle::LoadStringData);
 	LuaPushNamedCFunc(L, "CallAsTeam", CSplitLuaHandle::CallAsTeam);
+	LuaPushNamedCFunc(L, "GetSharedArray", GetSharedArray);
 	LuaPushNamedNumber(L, "COBSCALE",  COBSCALE);
 
+	luaL_newmetatable(L, "SharedArrayView");
+	HSTR_PUSH_CFUNC(L, "__index",    SharedArrayIndex);
+	HSTR_PUSH_CFUNC(L, "__newindex", SharedArrayNewIndex);
+	HSTR_PUSH_CFUNC(L, "__len",      SharedArrayLen);
+	lua_pop(L, 1);
+
 	// load our libraries
 	{
 		#define KILL { KillLua(); return false; }
@@ -185,13 +192,90 @@ void CUnsyncedLuaHandle::RecvFromSynced(lua_State* srcState, int args)
 }
 
 
+//
+// Call-Outs
+//
+
+struct SharedArrayView {
+	const CSplitLuaHandle* owner;
+	int id;
+};
+
+int CUnsyncedLuaHandle::GetSharedArray(lua_State* L)
+{
+	const int id = luaL_checkint(L, 1);
+
+	if (GetUnsyncedHandle(L)->base.GetSharedArray(id) == nullptr)
+		return 0;
+
+	SharedArrayView* view = static_cast<SharedArrayView*>(lua_newuserdata(L, sizeof(SharedArrayView)));
+	view->owner = &GetUnsyncedHandle(L)->base;
+	view->id = id;
+
+	luaL_getmetatable(L, "SharedArrayView");
+	lua_setmetatable(L, -2);
+	return 1;
+}
+
+int CUnsyncedLuaHandle::SharedArrayIndex(lua_State* L)
+{
+	const SharedArrayView* view = static_cast<SharedArrayView*>(luaL_checkudata(L, 1, "SharedArrayView"));
+	// the array can be recreated (or resized) by synced code while a view is held
+	const CSplitLuaHandle::SharedArray* array = view->owner->GetSharedArray(view->id);
+
+	if (array == nullptr)
+		return 0;
+
+	if (lua_israwnumber(L, 2)) {
+		const int index = lua_toint(L, 2) - 1;
+
+		if (index < 0 || index >= int(array->values.size()))
+			return 0;
+
+		lua_pushnumber(L, array->values[index]);
+		return 1;
+	}
+
+	if (!lua_israwstring(L, 2))
+		return 0;
+
+	switch (hashString(lua_tostring(L, 2))) {
+		case hashString("version"): { lua_pushnumber(L, array->version   ); return 1; } break;
+		case hashString("frame"  ): { lua_pushnumber(L, array->writeFrame); return 1; } break;
+		case hashString("size"   ): { lua_pushnumber(L, array->values.size()); return 1; } break;
+		default: {} break;
+	}
+
+	return 0;
+}
+
+int CUnsyncedLuaHandle::SharedArrayNewIndex(lua_State* L)
+{
+	luaL_error(L, "[%s] shared arrays are read-only in unsynced code", __func__);
+	return 0;
+}
+
+int CUnsyncedLuaHandle::SharedArrayLen(lua_State* L)
+{
+	const SharedArrayView* view = static_cast<SharedArrayView*>(luaL_checkudata(L, 1, "SharedArrayView"));
+	const CSplitLuaHandle::SharedArray* array = view->owner->GetSharedArray(view->id);
+
+	lua_pushnumber(L, (array != nullptr)? array->values.size(): 0);
+	return 1;
+}
+
+
+//
+// Call-Ins
+//
+
 bool CUnsyncedLuaHandle::DrawUnit(const CUnit* unit)
 {
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 4, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DrawUnit))
 		return false;
 
 	const bool oldDrawState = LuaOpenGL::IsDrawingEnabled(L);
@@ -218,7 +302,7 @@ bool CUnsyncedLuaHandle::DrawFeature(const CFeature* feature)
 	luaL_checkstack(L, 4, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DrawFeature))
 		return false;
 
 	const bool oldDrawState = LuaOpenGL::IsDrawingEnabled(L);
@@ -246,7 +330,7 @@ bool CUnsyncedLuaHandle::DrawShield(const CUnit* unit, const CWeapon* weapon)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DrawShield))
 		return false;
 
 	const bool oldDrawState = LuaOpenGL::IsDrawingEnabled(L);
@@ -276,7 +360,7 @@ bool CUnsyncedLuaHandle::DrawProjectile(const CProjectile* projectile)
 	luaL_checkstack(L, 5, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DrawProjectile))
 		return false;
 
 	const bool oldDrawState = LuaOpenGL::IsDrawingEnabled(L);
@@ -303,7 +387,7 @@ bool CUnsyncedLuaHandle::DrawMaterial(const LuaMaterial* material)
 	luaL_checkstack(L, 4, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_DrawMaterial))
 		return false;
 
 	const bool oldDrawState = LuaOpenGL::IsDrawingEnabled(L);
@@ -429,6 +513,8 @@ bool CSyncedLuaHandle::Init(const std::string& code, const std::string& file)
 
 	// add the custom file loader
 	LuaPushNamedCFunc(L, "SendToUnsynced", SendToUnsynced);
+	LuaPushNamedCFunc(L, "CreateSharedArray", CreateSharedArray);
+	LuaPushNamedCFunc(L, "SetSharedArray", SetSharedArray);
 	LuaPushNamedCFunc(L, "CallAsTeam",     CSplitLuaHandle::CallAsTeam);
 	LuaPushNamedNumber(L, "COBSCALE",      COBSCALE);
 
@@ -501,7 +587,7 @@ bool CSyncedLuaHandle::CommandFallback(const CUnit* unit, const Command& cmd)
 	luaL_checkstack(L, 9, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_CommandFallback))
 		return true; // the call is not defined
 
 	LuaUtils::PushUnitAndCommand(L, unit, cmd);
@@ -522,7 +608,7 @@ bool CSyncedLuaHandle::AllowCommand(const CUnit* unit, const Command& cmd, int p
 	luaL_checkstack(L, 7 + 3, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowCommand))
 		return true; // the call is not defined
 
 	const int argc = LuaUtils::PushUnitAndCommand(L, unit, cmd);
@@ -551,7 +637,7 @@ bool CSyncedLuaHandle::AllowUnitCreation(
 	luaL_checkstack(L, 9, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitCreation))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, unitDef->id);
@@ -583,7 +669,7 @@ bool CSyncedLuaHandle::AllowUnitTransfer(const CUnit* unit, int newTeam, bool ca
 	luaL_checkstack(L, 7, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitTransfer))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, unit->id);
@@ -609,7 +695,7 @@ bool CSyncedLuaHandle::AllowUnitBuildStep(const CUnit* builder, const CUnit* uni
 	luaL_checkstack(L, 7, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitBuildStep))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, builder->id);
@@ -636,7 +722,7 @@ bool CSyncedLuaHandle::AllowUnitTransport(const CUnit* transporter, const CUnit*
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitTransport))
 		return true;
 
 	lua_pushnumber(L, transporter->id);
@@ -666,7 +752,7 @@ bool CSyncedLuaHandle::AllowUnitTransportLoad(
 	static const LuaHashString cmdStr(__func__);
 
 	// use engine default if callin does not exist
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitTransportLoad))
 		return allowed;
 
 	lua_pushnumber(L, transporter->id);
@@ -699,7 +785,7 @@ bool CSyncedLuaHandle::AllowUnitTransportUnload(
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitTransportUnload))
 		return allowed;
 
 	lua_pushnumber(L, transporter->id);
@@ -728,7 +814,7 @@ bool CSyncedLuaHandle::AllowUnitCloak(const CUnit* unit, const CUnit* enemy)
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitCloak))
 		return true;
 
 
@@ -755,7 +841,7 @@ bool CSyncedLuaHandle::AllowUnitDecloak(const CUnit* unit, const CSolidObject* o
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitDecloak))
 		return true;
 
 
@@ -789,7 +875,7 @@ bool CSyncedLuaHandle::AllowUnitKamikaze(const CUnit* unit, const CUnit* target,
 
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowUnitKamikaze))
 		return allowed;
 
 	lua_pushnumber(L, unit->id);
@@ -810,7 +896,7 @@ bool CSyncedLuaHandle::AllowFeatureCreation(const FeatureDef* featureDef, int te
 	luaL_checkstack(L, 7, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowFeatureCreation))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, featureDef->id);
@@ -836,7 +922,7 @@ bool CSyncedLuaHandle::AllowFeatureBuildStep(const CUnit* builder, const CFeatur
 	luaL_checkstack(L, 7, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowFeatureBuildStep))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, builder->id);
@@ -862,7 +948,7 @@ bool CSyncedLuaHandle::AllowResourceLevel(int teamID, const std::string& type, f
 	luaL_checkstack(L, 5, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowResourceLevel))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, teamID);
@@ -886,7 +972,7 @@ bool CSyncedLuaHandle::AllowResourceTransfer(int oldTeam, int newTeam, const cha
 	luaL_checkstack(L, 6, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowResourceTransfer))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, oldTeam);
@@ -911,7 +997,7 @@ bool CSyncedLuaHandle::AllowDirectUnitControl(int playerID, const CUnit* unit)
 	luaL_checkstack(L, 6, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowDirectUnitControl))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, unit->id);
@@ -936,7 +1022,7 @@ bool CSyncedLuaHandle::AllowBuilderHoldFire(const CUnit* unit, int action)
 	luaL_checkstack(L, 2 + 3 + 1, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowBuilderHoldFire))
 		return true; // the call is not defined
 
 	lua_pushnumber(L, unit->id);
@@ -960,7 +1046,7 @@ bool CSyncedLuaHandle::AllowStartPosition(int playerID, int teamID, unsigned cha
 	luaL_checkstack(L, 13, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowStartPosition))
 		return true; // the call is not defined
 
 	// push the start position and playerID
@@ -991,7 +1077,7 @@ bool CSyncedLuaHandle::MoveCtrlNotify(const CUnit* unit, int data)
 	luaL_checkstack(L, 6, __func__);
 
 	static const LuaHashString cmdStr(__func__);
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_MoveCtrlNotify))
 		return false; // the call is not defined
 
 	// push the unit info
@@ -1019,7 +1105,7 @@ bool CSyncedLuaHandle::TerraformComplete(const CUnit* unit, const CUnit* build)
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_TerraformComplete))
 		return false; // the call is not defined
 
 	// push the unit info
@@ -1062,13 +1148,16 @@ bool CSyncedLuaHandle::UnitPreDamaged(
 	float* newDamage,
 	float* impulseMult
 ) {
+	if (!eventFilters[EVENT_FILTER_UNITPREDAMAGED].Pass(unit->unitDef->id, weaponDefID, unit->team))
+		return false;
+
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 2 + 2 + 10, __func__);
 
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_UnitPreDamaged))
 		return false;
 
 	int inArgCount = 5;
@@ -1135,13 +1224,16 @@ bool CSyncedLuaHandle::FeaturePreDamaged(
 	assert(newDamage != nullptr);
 	assert(impulseMult != nullptr);
 
+	if (!eventFilters[EVENT_FILTER_FEATUREPREDAMAGED].Pass(feature->def->id, weaponDefID, feature->team))
+		return false;
+
 	LUA_CALL_IN_CHECK(L, false);
 	luaL_checkstack(L, 2 + 9 + 2, __func__);
 
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_FeaturePreDamaged))
 		return false;
 
 	int inArgCount = 4;
@@ -1204,7 +1296,7 @@ bool CSyncedLuaHandle::ShieldPreDamaged(
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_ShieldPreDamaged))
 		return false;
 
 	// push the call-in arguments
@@ -1259,7 +1351,7 @@ int CSyncedLuaHandle::AllowWeaponTargetCheck(unsigned int attackerID, unsigned i
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowWeaponTargetCheck))
 		return ret;
 
 	lua_pushnumber(L, attackerID);
@@ -1294,7 +1386,7 @@ bool CSyncedLuaHandle::AllowWeaponTarget(
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowWeaponTarget))
 		return ret;
 
 	// casts are only here to preserve -1's passed from *CAI as floats
@@ -1343,7 +1435,7 @@ bool CSyncedLuaHandle::AllowWeaponInterceptTarget(
 	const LuaUtils::ScopedDebugTraceBack dbgTrace(L);
 	static const LuaHashString cmdStr(__func__);
 
-	if (!cmdStr.GetGlobalFunc(L))
+	if (!PushCallInFunc(L, CALLIN_IDX_AllowWeaponInterceptTarget))
 		return ret;
 
 	lua_pushnumber(L, interceptorUnit->id);
@@ -1504,6 +1596,80 @@ int CSyncedLuaHandle::SendToUnsynced(lua_State* L)
 }
 
 
+static void MarkSharedArrayWritten(CSplitLuaHandle::SharedArray& array)
+{
+	if (array.writeFrame == gs->frameNum)
+		return;
+
+	array.version += 1;
+	array.writeFrame = gs->frameNum;
+}
+
+int CSyncedLuaHandle::CreateSharedArray(lua_State* L)
+{
+	const int id = luaL_checkint(L, 1);
+	const int size = luaL_checkint(L, 2);
+
+	if (id < 0 || id >= CSplitLuaHandle::MAX_SHARED_ARRAYS)
+		luaL_error(L, "[%s] bad array ID %d (range is [0, %d))", __func__, id, CSplitLuaHandle::MAX_SHARED_ARRAYS);
+	if (size < 0)
+		luaL_error(L, "[%s] bad array size %d", __func__, size);
+
+	auto& sharedArrays = GetSyncedHandle(L)->base.sharedArrays;
+
+	if (id >= int(sharedArrays.size()))
+		sharedArrays.resize(id + 1);
+
+	CSplitLuaHandle::SharedArray& array = sharedArrays[id];
+
+	array.values.clear();
+	array.values.resize(size, luaL_optfloat(L, 3, 0.0f));
+	// always make a (re)created array visible as changed, even within the same frame
+	array.version += 1;
+	array.writeFrame = gs->frameNum;
+	return 0;
+}
+
+int CSyncedLuaHandle::SetSharedArray(lua_State* L)
+{
+	const int id = luaL_checkint(L, 1);
+	const int first = luaL_checkint(L, 2) - 1;
+
+	auto& sharedArrays = GetSyncedHandle(L)->base.sharedArrays;
+
+	if (id < 0 || id >= int(sharedArrays.size()) || sharedArrays[id].version == 0)
+		luaL_error(L, "[%s] no shared array with ID %d", __func__, id);
+
+	CSplitLuaHandle::SharedArray& array = sharedArrays[id];
+	std::vector<float>& values = array.values;
+
+	if (lua_istable(L, 3)) {
+		const int count = lua_objlen(L, 3);
+
+		if (first < 0 || (first + count) > int(values.size()))
+			luaL_error(L, "[%s] range [%d, %d] out of bounds for array %d", __func__, first + 1, first + count, id);
+
+		for (int i = 0; i < count; i++) {
+			lua_rawgeti(L, 3, i + 1);
+			values[first + i] = lua_tofloat(L, -1);
+			lua_pop(L, 1);
+		}
+	} else {
+		const int count = lua_gettop(L) - 2;
+
+		if (first < 0 || (first + count) > int(values.size()))
+			luaL_error(L, "[%s] range [%d, %d] out of bounds for array %d", __func__, first + 1, first + count, id);
+
+		for (int i = 0; i < count; i++) {
+			values[first + i] = luaL_checkfloat(L, 3 + i);
+		}
+	}
+
+	MarkSharedArrayWritten(array);
+	return 0;
+}
+
+
 int CSyncedLuaHandle::AddSyncedActionFallback(lua_State* L)
 {
 	std::string cmdRaw = "/" + std::string(luaL_checkstring(L, 1));
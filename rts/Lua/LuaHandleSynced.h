@@ -4,6 +4,7 @@
 #define LUA_HANDLE_SYNCED
 
 #include <string>
+#include <vector>
 
 #include "LuaHandle.h"
 #include "LuaRulesParams.h"
@@ -42,6 +43,13 @@ class CUnsyncedLuaHandle : public CLuaHandle
 
 	protected:
 		CSplitLuaHandle& base;
+
+	private: // call-outs
+		static int GetSharedArray(lua_State* L);
+
+		static int SharedArrayIndex(lua_State* L);
+		static int SharedArrayNewIndex(lua_State* L);
+		static int SharedArrayLen(lua_State* L);
 };
 
 
@@ -145,6 +153,8 @@ class CSyncedLuaHandle : public CLuaHandle
 		static int SyncedPairs(lua_State* L);
 
 		static int SendToUnsynced(lua_State* L);
+		static int CreateSharedArray(lua_State* L);
+		static int SetSharedArray(lua_State* L);
 
 		static int AddSyncedActionFallback(lua_State* L);
 		static int RemoveSyncedActionFallback(lua_State* L);
@@ -266,6 +276,30 @@ class CSplitLuaHandle
 		CSyncedLuaHandle syncedLuaHandle;
 		CUnsyncedLuaHandle unsyncedLuaHandle;
 
+	public:
+		// numeric channel from synced to unsynced code; written by
+		// synced gadgets, read in place through a view by unsynced
+		struct SharedArray {
+			std::vector<float> values;
+
+			// bumped once per sim-frame in which the array was written
+			int version = 0;
+			int writeFrame = -1;
+		};
+
+		static constexpr int MAX_SHARED_ARRAYS = 1024;
+
+		const SharedArray* GetSharedArray(int id) const {
+			if (id < 0 || id >= int(sharedArrays.size()))
+				return nullptr;
+			if (sharedArrays[id].version == 0)
+				return nullptr;
+			return &sharedArrays[id];
+		}
+
+	private:
+		std::vector<SharedArray> sharedArrays;
+
 	public:
 		static void ClearGameParams() { spring::clear_unordered_map(gameParams); }
 		static const LuaRulesParams::Params& GetGameParams() { return gameParams; }
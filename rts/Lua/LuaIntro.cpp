@@ -251,6 +251,7 @@ bool CLuaIntro::LoadUnsyncedReadFunctions(lua_State* L)
 
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetLogSections);
 
+	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigHandle);
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigInt);
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigFloat);
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigString);
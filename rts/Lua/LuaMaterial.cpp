@@ -130,7 +130,7 @@ void LuaMatShader::Execute(const LuaMatShader& prev, bool deferredPass) const
 		// reset old, setup new
 		switch (prev.type) {
 			case LUASHADER_GL: {
-				glUseProgram(0);
+				glAttribStatePtr->UseProgram(0);
 
 				assert(luaMatHandler.resetDrawStateFuncs[prev.type] != nullptr);
 				luaMatHandler.resetDrawStateFuncs[prev.type](prev.type, deferredPass);
@@ -147,7 +147,7 @@ void LuaMatShader::Execute(const LuaMatShader& prev, bool deferredPass) const
 		switch (type) {
 			case LUASHADER_GL: {
 				// custom shader
-				glUseProgram(openglID);
+				glAttribStatePtr->UseProgram(openglID);
 
 				assert(luaMatHandler.setupDrawStateFuncs[type] != nullptr);
 				luaMatHandler.setupDrawStateFuncs[type](type, deferredPass);
@@ -169,7 +169,7 @@ void LuaMatShader::Execute(const LuaMatShader& prev, bool deferredPass) const
 	if (openglID == prev.openglID)
 		return;
 
-	glUseProgram(openglID);
+	glAttribStatePtr->UseProgram(openglID);
 }
 
 
@@ -7,6 +7,7 @@
 
 #include "LuaMemPool.h"
 #include "System/MainDefines.h"
+#include "System/MemoryStats.h"
 #include "System/SafeUtil.h"
 #include "System/Log/ILog.h"
 #include "System/Threading/SpringThreading.h"
@@ -31,6 +32,11 @@ static std::vector<size_t> gIndcs;
 static std::atomic<size_t> gCount = {0};
 static spring::mutex gMutex;
 
+#ifndef UNIT_TEST
+// the pages in use are part of the Lua states' allocations, count only the rest
+static MemoryStats::Registrar luaMemPoolStats("Lua::MemPools::Unused", []() { return MemoryStats::Usage{LuaMemPool::GetUnusedBytes(), 0}; });
+#endif
+
 
 // Lua code tends to perform many smaller *short-lived* allocations
 // this frees us from having to handle all possible sizes, just the
@@ -39,6 +45,34 @@ static bool AllocInternal(size_t size) { return ((size * CHECK_MAX_ALLOC_SIZE) <
 static bool AllocExternal(size_t size) { return (!LuaMemPool::enabled || !AllocInternal(size)); }
 
 size_t LuaMemPool::GetPoolCount() { return (gCount.load()); }
+size_t LuaMemPool::GetUnusedBytes()
+{
+	if (!LuaMemPool::enabled)
+		return 0;
+
+	std::lock_guard<spring::mutex> lock(gMutex);
+
+	size_t numBytes = (gSharedPool != nullptr)? gSharedPool->GetFreedSize(): 0;
+
+	for (const LuaMemPool* p: gPools) {
+		numBytes += p->GetFreedSize();
+	}
+
+	return numBytes;
+}
+
+size_t LuaMemPool::GetFreedSize() const
+{
+	size_t numBytes = 0;
+
+	#if (LMP_USE_CHUNK_TABLE == 0)
+	for (uint32_t i = 0; i < PoolImpl::NUM_POOLS; i++) {
+		numBytes += poolImpl.GetPoolSizes(i).second;
+	}
+	#endif
+
+	return numBytes;
+}
 
 LuaMemPool* LuaMemPool::GetSharedPtr() { return gSharedPool; }
 LuaMemPool* LuaMemPool::AcquirePtr(bool shared, bool owned)
@@ -147,6 +181,35 @@ void LuaMemPool::LogStats(const char* handle, const char* lctype) const
 			allocStats[STAT_NCB],
 			allocStats[STAT_NBB]
 		);
+
+		// per size-class; pages are never returned, so occupancy and
+		// the fraction of page bytes lost to rounding up both matter
+		for (uint32_t i = 0; i < PoolImpl::NUM_POOLS; i++) {
+			const std::pair<size_t, size_t> poolSizes = poolImpl.GetPoolSizes(i);
+
+			if (poolSizes.first == 0)
+				continue;
+
+			const size_t pageSize = size_t(1) << i;
+			const size_t numPages = poolSizes.first / pageSize;
+			const size_t numUsedPages = (poolSizes.first - poolSizes.second) / pageSize;
+			const size_t numUsedBytes = numUsedPages * pageSize;
+			const size_t numReqBytes = std::min(poolImpl.allocSums[i], numUsedBytes);
+
+			LOG(
+				"[LuaMemPool::%s][handle=%s (%s)]\tsize=" _STPF_ " {used,total}Pages={" _STPF_ "," _STPF_ "} {req,used}Bytes={" _STPF_ "," _STPF_ "} {occupancy,waste}={%.1f%%,%.1f%%}",
+				__func__,
+				handle,
+				lctype,
+				pageSize,
+				numUsedPages,
+				numPages,
+				numReqBytes,
+				numUsedBytes,
+				(numUsedPages * 100.0f) / numPages,
+				(numUsedBytes > 0)? ((numUsedBytes - numReqBytes) * 100.0f) / numUsedBytes: 0.0f
+			);
+		}
 	#endif
 }
 
@@ -420,3 +483,43 @@ void LuaMemPool::PoolImpl::Free(void* ptr, uint32_t size) {
 	}
 }
 
+std::pair<size_t, size_t> LuaMemPool::PoolImpl::GetPoolSizes(uint32_t i) const {
+	switch (i) {
+		case  0: { return {GetPool< 0>()->alloc_size(), GetPool< 0>()->freed_size()}; } break;
+		case  1: { return {GetPool< 1>()->alloc_size(), GetPool< 1>()->freed_size()}; } break;
+		case  2: { return {GetPool< 2>()->alloc_size(), GetPool< 2>()->freed_size()}; } break;
+		case  3: { return {GetPool< 3>()->alloc_size(), GetPool< 3>()->freed_size()}; } break;
+		case  4: { return {GetPool< 4>()->alloc_size(), GetPool< 4>()->freed_size()}; } break;
+		case  5: { return {GetPool< 5>()->alloc_size(), GetPool< 5>()->freed_size()}; } break;
+		case  6: { return {GetPool< 6>()->alloc_size(), GetPool< 6>()->freed_size()}; } break;
+		case  7: { return {GetPool< 7>()->alloc_size(), GetPool< 7>()->freed_size()}; } break;
+		case  8: { return {GetPool< 8>()->alloc_size(), GetPool< 8>()->freed_size()}; } break;
+		case  9: { return {GetPool< 9>()->alloc_size(), GetPool< 9>()->freed_size()}; } break;
+		case 10: { return {GetPool<10>()->alloc_size(), GetPool<10>()->freed_size()}; } break;
+		case 11: { return {GetPool<11>()->alloc_size(), GetPool<11>()->freed_size()}; } break;
+		case 12: { return {GetPool<12>()->alloc_size(), GetPool<12>()->freed_size()}; } break;
+		case 13: { return {GetPool<13>()->alloc_size(), GetPool<13>()->freed_size()}; } break;
+		case 14: { return {GetPool<14>()->alloc_size(), GetPool<14>()->freed_size()}; } break;
+		case 15: { return {GetPool<15>()->alloc_size(), GetPool<15>()->freed_size()}; } break;
+		case 16: { return {GetPool<16>()->alloc_size(), GetPool<16>()->freed_size()}; } break;
+		case 17: { return {GetPool<17>()->alloc_size(), GetPool<17>()->freed_size()}; } break;
+		case 18: { return {GetPool<18>()->alloc_size(), GetPool<18>()->freed_size()}; } break;
+		case 19: { return {GetPool<19>()->alloc_size(), GetPool<19>()->freed_size()}; } break;
+		case 20: { return {GetPool<20>()->alloc_size(), GetPool<20>()->freed_size()}; } break;
+		case 21: { return {GetPool<21>()->alloc_size(), GetPool<21>()->freed_size()}; } break;
+		case 22: { return {GetPool<22>()->alloc_size(), GetPool<22>()->freed_size()}; } break;
+		case 23: { return {GetPool<23>()->alloc_size(), GetPool<23>()->freed_size()}; } break;
+		case 24: { return {GetPool<24>()->alloc_size(), GetPool<24>()->freed_size()}; } break;
+		case 25: { return {GetPool<25>()->alloc_size(), GetPool<25>()->freed_size()}; } break;
+		case 26: { return {GetPool<26>()->alloc_size(), GetPool<26>()->freed_size()}; } break;
+		case 27: {                                                                  } break;
+		case 28: {                                                                  } break;
+		case 29: {                                                                  } break;
+		case 30: {                                                                  } break;
+		case 31: {                                                                  } break;
+		default: {                                                                  } break;
+	}
+
+	return {0, 0};
+}
+
@@ -4,6 +4,7 @@
 #define LUA_MEM_POOL_H_
 
 #include <cstddef>
+#include <utility>
 #include <vector>
 
 #include "System/bitops.h"
@@ -35,6 +36,8 @@ public:
 
 public:
 	static size_t GetPoolCount();
+	/// bytes of pages held by all pools that are not handed out to Lua
+	static size_t GetUnusedBytes();
 
 	static LuaMemPool* GetSharedPtr();
 	static LuaMemPool* AcquirePtr(bool shared, bool owned);
@@ -88,6 +91,8 @@ public:
 		#endif
 	}
 
+	size_t GetFreedSize() const;
+
 	size_t  GetGlobalIndex() const { return globalIndex; }
 	size_t  GetSharedCount() const { return sharedCount; }
 	size_t& GetSharedCount()       { return sharedCount; }
@@ -101,7 +106,7 @@ public:
 
 private:
 	#if (LMP_USE_CHUNK_TABLE == 1)
-	spring::unsynced_map<size_t, void*> freeChunksTable;
+	spring::unsynced_swiss_map<size_t, void*> freeChunksTable;
 	spring::unsynced_map<size_t, size_t> chunkCountTable;
 
 	std::vector<void*> allocBlocks;
@@ -151,6 +156,11 @@ private:
 			return (static_cast<PoolType*>(poolPtrs[i]));
 		}
 
+		template<size_t i, typename PoolType = FixedDynMemPool<1 << i, NUM_CHUNKS[i], NUM_PAGES[i]>>
+		const PoolType* GetPool() const {
+			return (static_cast<const PoolType*>(poolPtrs[i]));
+		}
+
 		template<size_t i, typename PoolType = FixedDynMemPool<1 << i, NUM_CHUNKS[i], NUM_PAGES[i]>>
 		void KillPool() {
 			GetPool<i>()->~PoolType();
@@ -162,6 +172,9 @@ private:
 
 		void* Alloc(uint32_t size);
 		void Free(void* ptr, uint32_t size);
+
+		// {alloc,freed}_size of sub-pool <i>, in bytes
+		std::pair<size_t, size_t> GetPoolSizes(uint32_t i) const;
 	};
 
 	PoolImpl poolImpl;
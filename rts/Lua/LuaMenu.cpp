@@ -300,6 +300,7 @@ bool CLuaMenu::LoadUnsyncedReadFunctions(lua_State* L)
 
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetGameName);
 
+	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigHandle);
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigInt);
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigFloat);
 	REGISTER_SCOPED_LUA_CFUNC(LuaUnsyncedRead, GetConfigString);
@@ -20,6 +20,7 @@
 #include "LuaShaders.h"
 #include "LuaTextures.h"
 #include "LuaUtils.h"
+#include "LuaVFSBuffer.h"
 #include "Game/Camera.h"
 #include "Game/CameraHandler.h"
 #include "Game/UI/CommandColors.h"
@@ -96,6 +97,8 @@ static LuaOpenGL::DrawMode prevDrawMode = LuaOpenGL::DRAW_NONE; // for minimap (
 static FixedDynMemPool<sizeof(GL::RenderDataBuffer), 32, 256> renderBufferPool;
 
 static std::vector<GL::RenderDataBufferL> luaRenderBuffers;
+// content key of the last table-update of each vertex-array, see UpdateVertexArray
+static std::vector<std::string> luaRenderBufferKeys;
 static std::vector<LuaOcclusionQuery*> occlusionQueries;
 
 // global immediate buffer; null outside BeginEnd
@@ -107,6 +110,7 @@ static void (*resetMatrixFunc)() = nullptr;
 
 bool LuaOpenGL::inSafeMode = true;
 bool LuaOpenGL::inBeginEnd = false;
+bool LuaOpenGL::inTextBatch = false;
 
 
 
@@ -199,6 +203,7 @@ void LuaOpenGL::Free()
 	}
 
 	luaRenderBuffers.clear();
+	luaRenderBufferKeys.clear();
 	occlusionQueries.clear();
 }
 
@@ -267,6 +272,7 @@ bool LuaOpenGL::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(ChangeTextureParams);
 	REGISTER_LUA_CFUNC(DeleteTexture);
 	REGISTER_LUA_CFUNC(TextureInfo);
+	REGISTER_LUA_CFUNC(RequestTexture);
 	REGISTER_LUA_CFUNC(CopyToTexture);
 
 	// FIXME: obsolete
@@ -416,7 +422,7 @@ void LuaOpenGL::ResetGLState()
 	glAttribStatePtr->PolygonOffsetPoint(GL_FALSE);
 	#endif
 
-	glUseProgram(0);
+	glAttribStatePtr->UseProgram(0);
 }
 
 
@@ -447,7 +453,7 @@ void LuaOpenGL::DisableCommon(DrawMode mode)
 	if (inSafeMode)
 		glAttribStatePtr->PopBits();
 
-	glUseProgram(0);
+	glAttribStatePtr->UseProgram(0);
 
 }
 
@@ -813,8 +819,20 @@ void LuaOpenGL::RevertScreenMatrices()
 /******************************************************************************/
 /******************************************************************************/
 
+void LuaOpenGL::FlushTextBatch()
+{
+	if (!inTextBatch)
+		return;
+
+	inTextBatch = false;
+	font->End();
+}
+
 inline void LuaOpenGL::CheckDrawingEnabled(lua_State* L, const char* caller)
 {
+	// the current call might draw over or read back buffered text
+	FlushTextBatch();
+
 	if (IsDrawingEnabled(L))
 		return;
 
@@ -1015,7 +1033,9 @@ int LuaOpenGL::DrawBufferedText(lua_State* L)
 
 int LuaOpenGL::Text(lua_State* L)
 {
-	CheckDrawingEnabled(L, __func__);
+	// NB: does not flush the text batch itself
+	if (!IsDrawingEnabled(L))
+		luaL_error(L, "%s(): OpenGL calls can only be used in Draw() call-ins", __func__);
 
 	const std::string& text = luaL_checksstring(L, 1);
 
@@ -1069,6 +1089,16 @@ int LuaOpenGL::Text(lua_State* L)
 		}
 	}
 
+	if ((options & FONT_BUFFERED) != 0) {
+		// buffered text is drawn by gl.DrawBufferedText, not by the batch
+		FlushTextBatch();
+	} else if (!inTextBatch && !inBeginEnd) {
+		// consecutive calls without other GL calls in between share one
+		// Begin/End block (and hence one draw-call) instead of one each
+		font->Begin();
+		inTextBatch = true;
+	}
+
 	font->glPrint(xpos, ypos, size, options, text);
 	return 0;
 }
@@ -2481,6 +2511,42 @@ int LuaOpenGL::TextureInfo(lua_State* L)
 }
 
 
+int LuaOpenGL::RequestTexture(lua_State* L)
+{
+	const std::string texName = luaL_checksstring(L, 1);
+
+	switch (texName[0]) {
+		case LuaTextures::prefix:
+		case '%':
+		case '#':
+		case '^':
+		case '$': {
+			// not file-backed, nothing to stream
+			LuaMatTexture tex;
+
+			lua_pushboolean(L, LuaOpenGLUtils::ParseTextureImage(L, tex, texName));
+			lua_pushboolean(L, false);
+			return 2;
+		} break;
+		default: {
+		} break;
+	}
+
+	const CLuaHandle* luaHandle = CLuaHandle::GetHandle(L);
+	const CNamedTextures::TexInfo* texInfo = CNamedTextures::Request(texName, luaHandle->PersistOnReload());
+
+	if (texInfo == nullptr || texInfo->id == 0) {
+		lua_pushboolean(L, false);
+		lua_pushboolean(L, false);
+		return 2;
+	}
+
+	lua_pushboolean(L, true);
+	lua_pushboolean(L, texInfo->pending);
+	return 2;
+}
+
+
 int LuaOpenGL::CopyToTexture(lua_State* L)
 {
 	CheckDrawingEnabled(L, __func__);
@@ -2695,9 +2761,12 @@ int LuaOpenGL::CreateVertexArray(lua_State* L)
 		} else {
 			bufferID = luaRenderBuffers.size();
 			luaRenderBuffers.emplace_back();
+			luaRenderBufferKeys.emplace_back();
 		}
 	}
 
+	luaRenderBufferKeys[bufferID].clear();
+
 	if (luaL_optboolean(L, 3, false)) {
 		// persistent
 		luaRenderBuffers[bufferID].Setup(renderBufferPool.alloc<GL::RenderDataBuffer>(), &GL::VA_TYPE_L_ATTRS, luaL_checkint(L, 1), luaL_checkint(L, 2));
@@ -2732,9 +2801,33 @@ int LuaOpenGL::DeleteVertexArray(lua_State* L)
 	}
 
 	wb = {};
+	luaRenderBufferKeys[bufferID].clear();
 	return 1;
 }
 
+
+// strings packed by VFS.Pack* and VFS buffers are copied as-is, tables parsed per value
+template<typename T, typename ParseTableFunc>
+static int ParseBulkArray(lua_State* L, int index, T* array, int maxCount, ParseTableFunc parseTable)
+{
+	size_t size = 0;
+	const char* data = reinterpret_cast<const char*>(LuaVFSBuffer::ToData(L, index, &size));
+
+	if (data == nullptr && lua_type(L, index) == LUA_TSTRING)
+		data = lua_tolstring(L, index, &size);
+
+	if (data == nullptr)
+		return (parseTable(L, index, array, maxCount));
+
+	const int count = std::min(maxCount, static_cast<int>(size / sizeof(T)));
+
+	memcpy(array, data, count * sizeof(T));
+	return count;
+}
+
+static int ParseBulkFloatArray(lua_State* L, int index, float* array, int maxCount) { return (ParseBulkArray(L, index, array, maxCount, LuaUtils::ParseFloatArray)); }
+static int ParseBulkIntArray(lua_State* L, int index, int* array, int maxCount) { return (ParseBulkArray(L, index, array, maxCount, LuaUtils::ParseIntArray)); }
+
 int LuaOpenGL::UpdateVertexArray(lua_State* L)
 {
 	if (inBeginEnd)
@@ -2756,6 +2849,33 @@ int LuaOpenGL::UpdateVertexArray(lua_State* L)
 		return 1;
 	}
 
+	if (lua_istable(L, 4)) {
+		// t.key identifies the contents; an update with the same key as the last one is skipped
+		lua_getfield(L, 4, "key");
+
+		if (!lua_isnil(L, -1)) {
+			size_t keyLen = 0;
+			const char* keyStr = luaL_checklstring(L, -1, &keyLen);
+
+			std::string& bufferKey = luaRenderBufferKeys[bufferID];
+
+			if (bufferKey.size() == keyLen && memcmp(bufferKey.data(), keyStr, keyLen) == 0) {
+				lua_pop(L, 1);
+				lua_pushboolean(L, true);
+				lua_pushboolean(L, false);
+				return 2;
+			}
+
+			bufferKey.assign(keyStr, keyLen);
+		} else {
+			luaRenderBufferKeys[bufferID].clear();
+		}
+
+		lua_pop(L, 1);
+	} else {
+		luaRenderBufferKeys[bufferID].clear();
+	}
+
 
 	if (!rb->IsPinned()) {
 		wb.BindMapElems();
@@ -2783,13 +2903,14 @@ int LuaOpenGL::UpdateVertexArray(lua_State* L)
 
 			// ParseFloatArray reads at most |array| scalar values from each of t.{p,n,uv,c0,c1}, remaining elements will be zero-filled
 			// t = {p = {x,y,z,w|x,y,z,w|...}, n = {x,y,z|x,y,z|...}, uv = {s,t,u,v|s,t,u,v|...}, c0 = {r,g,b,a|r,g,b,a|...}, c1 = {...}}
+			// each of these (and t.i) can also be a string from VFS.PackF32 (VFS.PackU32 for t.i) or a VFS buffer, copied in bulk
 			// non-matching p/n/... table lengths qualifies as user error since verts are not initialized from any existing buffer data
-			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "p" ); numElems = std::max(numElems, LuaUtils::ParseFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsP (array); lua_pop(L, 1); }
-			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "n" ); numElems = std::max(numElems, LuaUtils::ParseFloatArray(L, -1, array.data(), array.size()) / 3); CopyFloatsN (array); lua_pop(L, 1); }
-			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "uv"); numElems = std::max(numElems, LuaUtils::ParseFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsUV(array); lua_pop(L, 1); }
-			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "c0"); numElems = std::max(numElems, LuaUtils::ParseFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsC0(array); lua_pop(L, 1); }
-			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "c1"); numElems = std::max(numElems, LuaUtils::ParseFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsC1(array); lua_pop(L, 1); }
-			{ memset(indcs.data(), 0, sizeof(indcs)); lua_getfield(L, 4, "i" ); numIndcs = std::max(numIndcs, LuaUtils::ParseIntArray  (L, -1, indcs.data(), indcs.size()) / 1);                      lua_pop(L, 1); }
+			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "p" ); numElems = std::max(numElems, ParseBulkFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsP (array); lua_pop(L, 1); }
+			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "n" ); numElems = std::max(numElems, ParseBulkFloatArray(L, -1, array.data(), array.size()) / 3); CopyFloatsN (array); lua_pop(L, 1); }
+			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "uv"); numElems = std::max(numElems, ParseBulkFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsUV(array); lua_pop(L, 1); }
+			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "c0"); numElems = std::max(numElems, ParseBulkFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsC0(array); lua_pop(L, 1); }
+			{ memset(array.data(), 0, sizeof(array)); lua_getfield(L, 4, "c1"); numElems = std::max(numElems, ParseBulkFloatArray(L, -1, array.data(), array.size()) / 4); CopyFloatsC1(array); lua_pop(L, 1); }
+			{ memset(indcs.data(), 0, sizeof(indcs)); lua_getfield(L, 4, "i" ); numIndcs = std::max(numIndcs, ParseBulkIntArray  (L, -1, indcs.data(), indcs.size()) / 1);                      lua_pop(L, 1); }
 
 			// NB: total buffer size can exceed |elems|, do not clamp args
 			wb.SafeUpdate(                            elems.data() , numElems, elemsPos);
@@ -2829,11 +2950,14 @@ int LuaOpenGL::UpdateVertexArray(lua_State* L)
 	}
 
 	lua_pushboolean(L, true);
-	return 1;
+	lua_pushboolean(L, true);
+	return 2;
 }
 
 int LuaOpenGL::RenderVertexArray(lua_State* L)
 {
+	FlushTextBatch();
+
 	if (inBeginEnd)
 		return 0;
 
@@ -2854,13 +2978,24 @@ int LuaOpenGL::RenderVertexArray(lua_State* L)
 	const unsigned int dataIndx = luaL_optint(L, 3,       0);
 	const unsigned int dataSize = luaL_optint(L, 4, 1 << 20); // arbitrary
 
+	// shaders can tell instances apart by gl_InstanceID, e.g. to index a uniform array
+	const unsigned int numInsts = luaL_optint(L, 5,       0);
+
 	const unsigned int numElems = rb->GetNumElems<VA_TYPE_L>();
 	const unsigned int numIndcs = rb->GetNumIndcs<uint32_t>();
 
 	if (numIndcs > 0) {
-		rb->SubmitIndexed(primType, dataIndx, std::min(dataSize, numIndcs));
+		if (numInsts > 0) {
+			rb->SubmitIndexedInstanced(primType, dataIndx, std::min(dataSize, numIndcs), numInsts);
+		} else {
+			rb->SubmitIndexed(primType, dataIndx, std::min(dataSize, numIndcs));
+		}
 	} else {
-		rb->Submit(primType, dataIndx, std::min(dataSize, numElems));
+		if (numInsts > 0) {
+			rb->SubmitInstanced(primType, dataIndx, std::min(dataSize, numElems), numInsts);
+		} else {
+			rb->Submit(primType, dataIndx, std::min(dataSize, numElems));
+		}
 	}
 
 	if (rb->IsPinned())
@@ -3309,6 +3444,8 @@ static void PushPixelData(lua_State* L, int fSize, const float*& data)
 
 int LuaOpenGL::ReadPixels(lua_State* L)
 {
+	FlushTextBatch();
+
 	const GLint x = luaL_checkint(L, 1);
 	const GLint y = luaL_checkint(L, 2);
 	const GLint w = luaL_checkint(L, 3);
@@ -3378,6 +3515,8 @@ int LuaOpenGL::ReadPixels(lua_State* L)
 
 int LuaOpenGL::SaveImage(lua_State* L)
 {
+	FlushTextBatch();
+
 	const GLint x = (GLint)luaL_checknumber(L, 1);
 	const GLint y = (GLint)luaL_checknumber(L, 2);
 	const GLsizei width  = (GLsizei)luaL_checknumber(L, 3);
@@ -3494,6 +3633,8 @@ int LuaOpenGL::DeleteOcclusionQuery(lua_State* L)
 
 int LuaOpenGL::RunOcclusionQuery(lua_State* L)
 {
+	LuaOpenGL::FlushTextBatch();
+
 	static bool running = false;
 
 	if (running)
@@ -32,7 +32,12 @@ class LuaOpenGL {
 		static bool PushEntries(lua_State* L);
 
 		static bool IsDrawingEnabled(lua_State* L) { return GetLuaContextData(L)->drawingEnabled; }
-		static void SetDrawingEnabled(lua_State* L, bool value) { GetLuaContextData(L)->drawingEnabled = value; }
+		static void SetDrawingEnabled(lua_State* L, bool value) { FlushTextBatch(); GetLuaContextData(L)->drawingEnabled = value; }
+
+		// submits the text buffered by consecutive gl.Text calls; called
+		// before any other GL call (see CheckDrawingEnabled) could depend
+		// on it and whenever a draw call-in ends
+		static void FlushTextBatch();
 
 		static bool GetSafeMode() { return inSafeMode; }
 		static void SetSafeMode(bool value) { inSafeMode = value; }
@@ -133,6 +138,7 @@ class LuaOpenGL {
 	private:
 		static bool inSafeMode;
 		static bool inBeginEnd;
+		static bool inTextBatch;
 
 	private:
 		static void CheckDrawingEnabled(lua_State* L, const char* caller);
@@ -199,6 +205,7 @@ class LuaOpenGL {
 		static int DeleteTexture(lua_State* L);
 		static int DeleteTextureFBO(lua_State* L);
 		static int TextureInfo(lua_State* L);
+		static int RequestTexture(lua_State* L);
 		static int CopyToTexture(lua_State* L);
 		static int RenderToTexture(lua_State* L);
 		static int GenerateMipmap(lua_State* L);
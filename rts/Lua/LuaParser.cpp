@@ -5,12 +5,14 @@
 
 #include <algorithm>
 #include <climits>
+#include <cstring>
 
 #include "lib/streflop/streflop_cond.h"
 
 #include "System/float3.h"
 #include "System/float4.h"
 #include "LuaInclude.h"
+#include "LuaBytecodeCache.h"
 
 #include "LuaConstGame.h"
 #include "LuaConstEngine.h"
@@ -108,6 +110,16 @@ LuaParser::~LuaParser()
 }
 
 
+static int LoadBuffer(lua_State* L, const std::string& code, const std::string& chunkName)
+{
+	#if (!defined(UNITSYNC) && !defined(DEDICATED))
+	return (LuaBytecodeCache::LoadBuffer(L, code, chunkName));
+	#else
+	return (luaL_loadbuffer(L, code.c_str(), code.size(), chunkName.c_str()));
+	#endif
+}
+
+
 void LuaParser::SetupLua(bool isSyncedCtxt, bool isDefsParser)
 {
 	if ((L = LUA_OPEN(&D)) == nullptr)
@@ -233,7 +245,7 @@ bool LuaParser::Execute()
 	char errorBuf[4096] = {0};
 	int errorNum = 0;
 
-	if ((errorNum = luaL_loadbuffer(L, code.c_str(), code.size(), codeLabel.c_str())) != 0) {
+	if ((errorNum = LoadBuffer(L, code, codeLabel)) != 0) {
 		SNPRINTF(errorBuf, sizeof(errorBuf), "[loadbuf] error %d (\"%s\") in %s", errorNum, lua_tostring(L, -1), codeLabel.c_str());
 		LUA_CLOSE(&L);
 
@@ -288,6 +300,262 @@ bool LuaParser::Execute()
 }
 
 
+/******************************************************************************/
+//
+//  Root table snapshots; plain data (booleans, numbers, strings and tables of
+//  those) only, keys are written in sorted order so equal tables always yield
+//  equal blobs
+//
+
+static constexpr char SNAPSHOT_MAGIC[] = "LPS1";
+static constexpr int SNAPSHOT_MAX_DEPTH = 64;
+
+enum {
+	SNAPSHOT_TAG_FALSE  = 0,
+	SNAPSHOT_TAG_TRUE   = 1,
+	SNAPSHOT_TAG_NUMBER = 2,
+	SNAPSHOT_TAG_STRING = 3,
+	SNAPSHOT_TAG_TABLE  = 4,
+};
+
+struct SnapshotKey {
+	bool operator < (const SnapshotKey& k) const {
+		if (type != k.type)
+			return (type < k.type);
+		if (type == LUA_TSTRING)
+			return (str < k.str);
+
+		return (num < k.num);
+	}
+
+	int type;
+	lua_Number num;
+	std::string str;
+};
+
+
+static void WriteSnapshotBytes(std::string& blob, const void* data, size_t size)
+{
+	blob.append(static_cast<const char*>(data), size);
+}
+
+static bool ReadSnapshotBytes(const char*& pos, const char* end, void* data, size_t size)
+{
+	if (size_t(end - pos) < size)
+		return false;
+
+	std::memcpy(data, pos, size);
+	pos += size;
+	return true;
+}
+
+
+static bool WriteSnapshotValue(lua_State* L, int index, std::string& blob, int depth)
+{
+	switch (lua_type(L, index)) {
+		case LUA_TBOOLEAN: {
+			blob.push_back(lua_toboolean(L, index)? SNAPSHOT_TAG_TRUE: SNAPSHOT_TAG_FALSE);
+			return true;
+		} break;
+		case LUA_TNUMBER: {
+			const lua_Number num = lua_tonumber(L, index);
+
+			blob.push_back(SNAPSHOT_TAG_NUMBER);
+			WriteSnapshotBytes(blob, &num, sizeof(num));
+			return true;
+		} break;
+		case LUA_TSTRING: {
+			size_t len = 0;
+			const char* str = lua_tolstring(L, index, &len);
+			const uint32_t len32 = len;
+
+			blob.push_back(SNAPSHOT_TAG_STRING);
+			WriteSnapshotBytes(blob, &len32, sizeof(len32));
+			WriteSnapshotBytes(blob, str, len);
+			return true;
+		} break;
+		case LUA_TTABLE: {
+			// also catches reference cycles
+			if (depth >= SNAPSHOT_MAX_DEPTH || !lua_checkstack(L, 3))
+				return false;
+
+			std::vector<SnapshotKey> keys;
+
+			for (lua_pushnil(L); lua_next(L, index) != 0; lua_pop(L, 1)) {
+				switch (lua_type(L, -2)) {
+					case LUA_TBOOLEAN: { keys.push_back({LUA_TBOOLEAN, lua_Number(lua_toboolean(L, -2)), ""}); } break;
+					case LUA_TNUMBER : { keys.push_back({LUA_TNUMBER, lua_tonumber(L, -2), ""}); } break;
+					// lua_tolstring is safe, the key is known to be a string
+					case LUA_TSTRING : {
+						size_t len = 0;
+						const char* str = lua_tolstring(L, -2, &len);
+
+						keys.push_back({LUA_TSTRING, 0.0f, std::string(str, len)});
+					} break;
+					default: {
+						lua_pop(L, 2);
+						return false;
+					} break;
+				}
+			}
+
+			std::sort(keys.begin(), keys.end());
+
+			const uint32_t numKeys = keys.size();
+
+			blob.push_back(SNAPSHOT_TAG_TABLE);
+			WriteSnapshotBytes(blob, &numKeys, sizeof(numKeys));
+
+			for (const SnapshotKey& key: keys) {
+				switch (key.type) {
+					case LUA_TBOOLEAN: { lua_pushboolean(L, key.num != 0.0f); } break;
+					case LUA_TNUMBER : { lua_pushnumber(L, key.num); } break;
+					case LUA_TSTRING : { lua_pushsstring(L, key.str); } break;
+					default          : {                               } break;
+				}
+
+				lua_pushvalue(L, -1);
+				lua_rawget(L, index);
+
+				const int top = lua_gettop(L);
+				const bool ret = (WriteSnapshotValue(L, top - 1, blob, depth + 1) && WriteSnapshotValue(L, top, blob, depth + 1));
+
+				lua_pop(L, 2);
+
+				if (!ret)
+					return false;
+			}
+
+			return true;
+		} break;
+		default: {
+		} break;
+	}
+
+	// functions, userdata, threads
+	return false;
+}
+
+static bool ReadSnapshotValue(lua_State* L, const char*& pos, const char* end, int depth)
+{
+	if (pos >= end)
+		return false;
+
+	switch (*(pos++)) {
+		case SNAPSHOT_TAG_FALSE: {
+			lua_pushboolean(L, false);
+			return true;
+		} break;
+		case SNAPSHOT_TAG_TRUE: {
+			lua_pushboolean(L, true);
+			return true;
+		} break;
+		case SNAPSHOT_TAG_NUMBER: {
+			lua_Number num = 0.0f;
+
+			if (!ReadSnapshotBytes(pos, end, &num, sizeof(num)))
+				return false;
+
+			lua_pushnumber(L, num);
+			return true;
+		} break;
+		case SNAPSHOT_TAG_STRING: {
+			uint32_t len = 0;
+
+			if (!ReadSnapshotBytes(pos, end, &len, sizeof(len)) || uint32_t(end - pos) < len)
+				return false;
+
+			lua_pushlstring(L, pos, len);
+			pos += len;
+			return true;
+		} break;
+		case SNAPSHOT_TAG_TABLE: {
+			uint32_t numKeys = 0;
+
+			if (depth >= SNAPSHOT_MAX_DEPTH || !lua_checkstack(L, 3))
+				return false;
+			if (!ReadSnapshotBytes(pos, end, &numKeys, sizeof(numKeys)))
+				return false;
+
+			lua_createtable(L, 0, std::min(numKeys, uint32_t(end - pos)));
+
+			for (uint32_t i = 0; i < numKeys; i++) {
+				if (!ReadSnapshotValue(L, pos, end, depth + 1))
+					return false;
+				if (lua_istable(L, -1))
+					return false;
+				if (!ReadSnapshotValue(L, pos, end, depth + 1))
+					return false;
+
+				lua_rawset(L, -3);
+			}
+
+			return true;
+		} break;
+		default: {
+		} break;
+	}
+
+	return false;
+}
+
+
+bool LuaParser::ExecuteSnapshot(const std::string& snapshot)
+{
+	if (!IsValid()) {
+		errorLog = "could not initialize Lua library";
+		return false;
+	}
+
+	assert(rootRef == LUA_NOREF);
+	assert(initDepth == 0);
+
+	const char* pos = snapshot.data();
+	const char* end = snapshot.data() + snapshot.size();
+
+	if (snapshot.compare(0, sizeof(SNAPSHOT_MAGIC) - 1, SNAPSHOT_MAGIC) != 0) {
+		errorLog = "invalid snapshot header";
+		return false;
+	}
+
+	pos += (sizeof(SNAPSHOT_MAGIC) - 1);
+
+	// on failure the parser stays usable, callers can still Execute it
+	if (!ReadSnapshotValue(L, pos, end, 0) || pos != end || !lua_istable(L, -1)) {
+		lua_settop(L, 0);
+
+		errorLog = "corrupt snapshot";
+		return false;
+	}
+
+	initDepth = -1;
+	rootRef = luaL_ref(L, LUA_REGISTRYINDEX);
+	lua_settop(L, 0);
+
+	return (valid = true);
+}
+
+bool LuaParser::GetRootSnapshot(std::string& snapshot)
+{
+	if (!valid || rootRef == LUA_NOREF)
+		return false;
+
+	snapshot.clear();
+	snapshot.append(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC) - 1);
+
+	lua_rawgeti(L, LUA_REGISTRYINDEX, rootRef);
+
+	const bool ret = WriteSnapshotValue(L, lua_gettop(L), snapshot, 0);
+
+	lua_settop(L, 0);
+
+	if (!ret)
+		snapshot.clear();
+
+	return ret;
+}
+
+
 void LuaParser::AddTable(LuaTable* tbl) { spring::VectorInsertUnique(tables, tbl); }
 void LuaParser::RemoveTable(LuaTable* tbl) { spring::VectorErase(tables, tbl); }
 
@@ -522,6 +790,7 @@ int LuaParser::Random(lua_State* L)
 {
 	// both US and DS depend on LuaParser via MapParser, etc
 	#if (!defined(UNITSYNC) && !defined(DEDICATED))
+	GetLuaParser(L)->numRandomCalls += 1;
 	lua_pushnumber(L, gsRNG.NextFloat());
 	return 1;
 	#else
@@ -597,7 +866,7 @@ int LuaParser::Include(lua_State* L)
  		lua_error(L);
 	}
 
-	int error = luaL_loadbuffer(L, code.c_str(), code.size(), filename.c_str());
+	int error = LoadBuffer(L, code, filename);
 	if (error != 0) {
 		char buf[1024];
 		SNPRINTF(buf, sizeof(buf), "error = %i, %s, %s\n", error, filename.c_str(), lua_tostring(L, -1));
@@ -1249,6 +1518,54 @@ bool LuaTable::GetPairs(std::vector<std::pair<std::string, std::string>>& data)
 }
 
 
+bool LuaTable::GetEntries(std::vector<Entry>& data) const
+{
+	if (!PushTable())
+		return false;
+
+	const int table = lua_gettop(L);
+
+	for (lua_pushnil(L); lua_next(L, table) != 0; lua_pop(L, 1)) {
+		if (!lua_israwstring(L, -2))
+			continue;
+
+		size_t len = 0;
+		const char* key = lua_tolstring(L, -2, &len);
+
+		data.emplace_back();
+		data.back().key.assign(key, len);
+
+		Entry& e = data.back();
+
+		switch (lua_type(L, -1)) {
+			case LUA_TBOOLEAN: {
+				e.type = BOOLEAN;
+				e.boolean = lua_toboolean(L, -1);
+			} break;
+			case LUA_TNUMBER: {
+				e.type = NUMBER;
+				e.num = lua_tonumber(L, -1);
+			} break;
+			case LUA_TSTRING: {
+				const char* str = lua_tolstring(L, -1, &len);
+
+				e.type = STRING;
+				e.str.assign(str, len);
+			} break;
+			case LUA_TTABLE: {
+				e.type = TABLE;
+			} break;
+			default: {
+				e.type = NIL;
+			} break;
+		}
+	}
+
+	std::stable_sort(data.begin(), data.end(), [](const Entry& a, const Entry& b) { return (a.key < b.key); });
+	return true;
+}
+
+
 /******************************************************************************/
 /******************************************************************************/
 //
@@ -67,6 +67,17 @@ public:
 	DataType GetType(int key) const;
 	DataType GetType(const std::string& key) const;
 
+	struct Entry {
+		std::string key;
+		std::string str;
+
+		DataType type = NIL;
+		float num = 0.0f;
+		bool boolean = false;
+	};
+	/// every string-keyed entry (sorted by key) gathered in one traversal; sub-table values only carry their type
+	bool GetEntries(std::vector<Entry>& data) const;
+
 	// numeric keys
 	template<typename T> T Get(int key, T def) const;
 	int    Get(int key, int def) const;
@@ -132,6 +143,11 @@ public:
 	void SetupLua(bool isSyncedCtxt, bool isDefsParser);
 
 	bool Execute();
+	/// builds the root table from a blob written by GetRootSnapshot instead of running any code
+	bool ExecuteSnapshot(const std::string& snapshot);
+	/// serializes the root table (plain data only) after a successful Execute
+	bool GetRootSnapshot(std::string& snapshot);
+
 	bool IsValid() const { return (L != nullptr); } // true if nothing failed during Execute
 	bool NoTable() const { return (errorLog.find("no return table") == 0); } // parser is still valid if true
 
@@ -160,6 +176,9 @@ public:
 	void SetLowerKeys(bool state) { lowerKeys = state; }
 	void SetLowerCppKeys(bool state) { lowerCppKeys = state; }
 
+	/// true if the executed code drew from the synced RNG
+	bool UsedSyncedRandom() const { return (numRandomCalls > 0); }
+
 public:
 	const std::string fileName;
 	const std::string fileModes;
@@ -187,6 +206,7 @@ private:
 	int initDepth = -1;
 	int rootRef = -1;
 	int currentRef = -1;
+	int numRandomCalls = 0;
 
 	bool valid = false;
 	bool lowerKeys = false; // convert all returned keys to lower case
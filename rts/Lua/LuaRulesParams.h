@@ -35,7 +35,7 @@ namespace LuaRulesParams
 		std::string valueString;
 	};
 
-	typedef spring::unordered_map<std::string, Param> Params;
+	typedef spring::swiss_map<std::string, Param> Params;
 }
 
 #endif // LUA_RULESPARAMS_H
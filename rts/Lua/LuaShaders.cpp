@@ -11,8 +11,10 @@
 #include "LuaUtils.h"
 
 #include "Game/Camera.h"
+#include "Rendering/Shaders/ShaderHandler.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
+#include "System/Sync/HsiehHash.h"
 
 #include <string>
 #include <vector>
@@ -327,7 +329,7 @@ static bool ParseUniformSetupTables(lua_State* L, int index, GLuint progName)
 	GLsizei uniformLen = 0;
 
 	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
-	glUseProgram(progName);
+	glAttribStatePtr->UseProgram(progName);
 	glGetProgramiv(progName, GL_ACTIVE_UNIFORMS, &numUniforms);
 
 
@@ -359,7 +361,7 @@ static bool ParseUniformSetupTables(lua_State* L, int index, GLuint progName)
 	ret = ret && ParseUniformsTable(L, uniforms, uniformPred, index, UNIFORM_TYPE_FLOAT,        progName);
 	ret = ret && ParseUniformsTable(L, uniforms, uniformPred, index, UNIFORM_TYPE_FLOAT_MATRIX, progName);
 
-	glUseProgram(currentProgram);
+	glAttribStatePtr->UseProgram(currentProgram);
 	return ret;
 }
 
@@ -521,6 +523,34 @@ int LuaShaders::CreateShader(lua_State* L)
 	if (vertSrcs.empty() && fragSrcs.empty() && geomSrcs.empty() && tcsSrcs.empty() && tesSrcs.empty())
 		return 0;
 
+	// geometry parameters come from the table rather than the sources
+	// and would not be covered by the key, so those are always linked
+	const bool useBinaryCache = geomSrcs.empty() && shaderHandler->UseProgramBinaryCache();
+
+	unsigned int binHash = 127;
+	unsigned int binSize = 0;
+
+	if (useBinaryCache) {
+		const std::vector<std::string>* srcTables[] = {&shdrDefs, &vertSrcs, &tcsSrcs, &tesSrcs, &fragSrcs};
+
+		for (const std::vector<std::string>* srcTable: srcTables) {
+			for (const std::string& src: *srcTable) {
+				binHash = HsiehHash(src.data(), src.size(), binHash);
+				binSize += src.size();
+			}
+
+			// moving a source to another stage must change the key
+			binHash = HsiehHash(&binSize, sizeof(binSize), binHash);
+		}
+
+		Program p(glCreateProgram());
+
+		if (shaderHandler->LoadProgramBinary(p.id, binHash, binSize))
+			return (PushLinkedProgram(L, p));
+
+		glDeleteProgram(p.id);
+	}
+
 	bool success;
 	const GLuint vertObj = CompileObject(L, shdrDefs, vertSrcs, GL_VERTEX_SHADER, success);
 
@@ -588,12 +618,29 @@ int LuaShaders::CreateShader(lua_State* L)
 		p.objects.emplace_back(fragObj, GL_FRAGMENT_SHADER);
 	}
 
+	if (useBinaryCache)
+		shaderHandler->SetBinaryRetrievable(prog);
+
 	GLint linkStatus;
-	GLint validStatus;
 
 	glLinkProgram(prog);
 	glGetProgramiv(prog, GL_LINK_STATUS, &linkStatus);
 
+	if (useBinaryCache && linkStatus == GL_TRUE)
+		shaderHandler->SaveProgramBinary(prog, binHash, binSize);
+
+	return (PushLinkedProgram(L, p));
+}
+
+int LuaShaders::PushLinkedProgram(lua_State* L, Program& p)
+{
+	const GLuint prog = p.id;
+
+	GLint linkStatus;
+	GLint validStatus;
+
+	glGetProgramiv(prog, GL_LINK_STATUS, &linkStatus);
+
 	// Allows setting up uniforms when drawing is disabled
 	// (much more convenient for sampler uniforms, and static
 	//  configuration values)
@@ -639,7 +686,7 @@ int LuaShaders::UseShader(lua_State* L)
 
 	const int progIdx = luaL_checkint(L, 1);
 	if (progIdx == 0) {
-		glUseProgram(0);
+		glAttribStatePtr->UseProgram(0);
 		lua_pushboolean(L, true);
 		return 1;
 	}
@@ -649,7 +696,7 @@ int LuaShaders::UseShader(lua_State* L)
 	if (progName == 0) {
 		lua_pushboolean(L, false);
 	} else {
-		glUseProgram(progName);
+		glAttribStatePtr->UseProgram(progName);
 		lua_pushboolean(L, true);
 	}
 	return 1;
@@ -658,6 +705,8 @@ int LuaShaders::UseShader(lua_State* L)
 
 int LuaShaders::ActiveShader(lua_State* L)
 {
+	LuaOpenGL::FlushTextBatch();
+
 	const int progIdx = luaL_checkint(L, 1);
 	luaL_checktype(L, 2, LUA_TFUNCTION);
 
@@ -674,11 +723,11 @@ int LuaShaders::ActiveShader(lua_State* L)
 	GLint currentProgram;
 	glGetIntegerv(GL_CURRENT_PROGRAM, &currentProgram);
 
-	glUseProgram(progName);
+	glAttribStatePtr->UseProgram(progName);
 	activeShaderDepth++;
 	const int error = lua_pcall(L, lua_gettop(L) - 2, 0, 0);
 	activeShaderDepth--;
-	glUseProgram(currentProgram);
+	glAttribStatePtr->UseProgram(currentProgram);
 
 	if (error != 0) {
 		LOG_L(L_ERROR, "gl.ActiveShader: error(%i) = %s", error, lua_tostring(L, -1));
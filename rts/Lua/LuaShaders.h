@@ -52,6 +52,8 @@ class LuaShaders {
 
 	private:
 		static bool DeleteProgram(Program& p);
+		// sets up uniforms of the linked (or binary-loaded) <p>, validates it and pushes its index
+		static int PushLinkedProgram(lua_State* L, Program& p);
 
 	private:
 		// the call-outs
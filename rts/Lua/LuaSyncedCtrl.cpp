@@ -65,6 +65,7 @@
 #include "Sim/Units/Scripts/LuaUnitScript.h"
 #include "Sim/Units/UnitTypes/Builder.h"
 #include "Sim/Units/UnitTypes/Factory.h"
+#include "Sim/Units/CommandAI/BuilderWorkIndex.h"
 #include "Sim/Units/CommandAI/Command.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Units/CommandAI/FactoryCAI.h"
@@ -156,6 +157,7 @@ bool LuaSyncedCtrl::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(SetFeatureRulesParam);
 
 	REGISTER_LUA_CFUNC(CreateUnit);
+	REGISTER_LUA_CFUNC(CreateUnits);
 	REGISTER_LUA_CFUNC(DestroyUnit);
 	REGISTER_LUA_CFUNC(TransferUnit);
 
@@ -769,7 +771,7 @@ int LuaSyncedCtrl::SetGlobalLos(lua_State* L)
 	if (!teamHandler.IsValidAllyTeam(allyTeam))
 		luaL_error(L, "bad allyTeam");
 
-	losHandler->globalLOS[allyTeam] = luaL_checkboolean(L, 2);
+	losHandler->SetGlobalLos(allyTeam, luaL_checkboolean(L, 2));
 	return 0;
 }
 
@@ -1239,90 +1241,154 @@ int LuaSyncedCtrl::GetCOBScriptID(lua_State* L)
 /******************************************************************************/
 /******************************************************************************/
 
-int LuaSyncedCtrl::CreateUnit(lua_State* L)
+// parses the CreateUnit arguments starting at stack index <argIdx>
+static void ParseUnitLoadParams(lua_State* L, const char* caller, int argIdx, UnitLoadParams& params)
 {
-	CheckAllowGameChanges(L);
-
-	if (inCreateUnit) {
-		luaL_error(L, "[%s()]: recursion is not permitted", __func__);
-		return 0;
-	}
-
 	const UnitDef* unitDef = nullptr;
 
-	if (lua_israwstring(L, 1)) {
-		unitDef = unitDefHandler->GetUnitDefByName(lua_tostring(L, 1));
-	} else if (lua_israwnumber(L, 1)) {
-		unitDef = unitDefHandler->GetUnitDefByID(lua_toint(L, 1));
+	if (lua_israwstring(L, argIdx)) {
+		unitDef = unitDefHandler->GetUnitDefByName(lua_tostring(L, argIdx));
+	} else if (lua_israwnumber(L, argIdx)) {
+		unitDef = unitDefHandler->GetUnitDefByID(lua_toint(L, argIdx));
 	} else {
-		luaL_error(L, "[%s()] incorrect type for first argument", __func__);
-		return 0;
+		luaL_error(L, "[%s()] incorrect type for first argument", caller);
+		return;
 	}
 
 	if (unitDef == nullptr) {
-		if (lua_israwstring(L, 1)) {
-			luaL_error(L, "[%s()]: bad unitDef name: %s", __func__, lua_tostring(L, 1));
+		if (lua_israwstring(L, argIdx)) {
+			luaL_error(L, "[%s()]: bad unitDef name: %s", caller, lua_tostring(L, argIdx));
 		} else {
-			luaL_error(L, "[%s()]: bad unitDef ID: %d", __func__, lua_toint(L, 1));
+			luaL_error(L, "[%s()]: bad unitDef ID: %d", caller, lua_toint(L, argIdx));
 		}
-		return 0;
+		return;
 	}
 
 	// CUnit::PreInit will clamp the position
 	// TODO: also allow off-map unit creation?
 	const float3 pos(
-		luaL_checkfloat(L, 2),
-		luaL_checkfloat(L, 3),
-		luaL_checkfloat(L, 4)
+		luaL_checkfloat(L, argIdx + 1),
+		luaL_checkfloat(L, argIdx + 2),
+		luaL_checkfloat(L, argIdx + 3)
 	);
-	const int facing = LuaUtils::ParseFacing(L, __func__, 5);
-	const int teamID = luaL_optint(L, 6, CtrlTeam(L));
+	const int facing = LuaUtils::ParseFacing(L, caller, argIdx + 4);
+	const int teamID = luaL_optint(L, argIdx + 5, CtrlTeam(L));
 
-	const bool beingBuilt = luaL_optboolean(L, 7, false);
-	const bool flattenGround = luaL_optboolean(L, 8, true);
+	const bool beingBuilt = luaL_optboolean(L, argIdx + 6, false);
+	const bool flattenGround = luaL_optboolean(L, argIdx + 7, true);
 
 	if (!teamHandler.IsValidTeam(teamID)) {
-		luaL_error(L, "[%s()]: invalid team number (%d)", __func__, teamID);
-		return 0;
+		luaL_error(L, "[%s()]: invalid team number (%d)", caller, teamID);
+		return;
 	}
 	if (!FullCtrl(L) && (CtrlTeam(L) != teamID)) {
-		luaL_error(L, "[%s()]: not a controllable team (%d)", __func__, teamID);
-		return 0;
+		luaL_error(L, "[%s()]: not a controllable team (%d)", caller, teamID);
+		return;
 	}
-	if (!unitHandler.CanBuildUnit(unitDef, teamID))
-		return 0; // unit limit reached
 
 	ASSERT_SYNCED(pos);
 	ASSERT_SYNCED(facing);
 
-	inCreateUnit = true;
-
-	CUnit* builder = unitHandler.GetUnit(luaL_optint(L, 10, -1));
-
-	UnitLoadParams params;
 	params.unitDef = unitDef; /// must be non-NULL
-	params.builder = builder; /// may be NULL
+	params.builder = unitHandler.GetUnit(luaL_optint(L, argIdx + 9, -1)); /// may be NULL
 	params.pos     = pos;
 	params.speed   = ZeroVector;
-	params.unitID  = luaL_optint(L, 9, -1);
+	params.unitID  = luaL_optint(L, argIdx + 8, -1);
 	params.teamID  = teamID;
 	params.facing  = facing;
 	params.beingBuilt = beingBuilt;
 	params.flattenGround = flattenGround;
+}
+
+
+int LuaSyncedCtrl::CreateUnit(lua_State* L)
+{
+	CheckAllowGameChanges(L);
+
+	if (inCreateUnit) {
+		luaL_error(L, "[%s()]: recursion is not permitted", __func__);
+		return 0;
+	}
+
+	UnitLoadParams params;
+	ParseUnitLoadParams(L, __func__, 1, params);
+
+	if (!unitHandler.CanBuildUnit(params.unitDef, params.teamID))
+		return 0; // unit limit reached
+
+	inCreateUnit = true;
 
+	CUnit* builder = const_cast<CUnit*>(params.builder);
 	CUnit* unit = unitLoader->LoadUnit(params);
 	inCreateUnit = false;
 
 	if (unit == nullptr)
 		return 0;
 
-	unit->SetSoloBuilder(builder, unitDef);
+	unit->SetSoloBuilder(builder, params.unitDef);
 
 	lua_pushnumber(L, unit->id);
 	return 1;
 }
 
 
+int LuaSyncedCtrl::CreateUnits(lua_State* L)
+{
+	CheckAllowGameChanges(L);
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	if (inCreateUnit) {
+		luaL_error(L, "[%s()]: recursion is not permitted", __func__);
+		return 0;
+	}
+
+	// each entry holds the arguments of a CreateUnit call
+	constexpr int NUM_ENTRY_ARGS = 10;
+
+	std::vector<UnitLoadParams> params(lua_objlen(L, 1));
+	std::vector<CUnit*> units;
+
+	for (size_t i = 0; i < params.size(); i++) {
+		lua_rawgeti(L, 1, i + 1);
+
+		if (!lua_istable(L, -1)) {
+			luaL_error(L, "[%s()]: entry %d is not a table", __func__, int(i + 1));
+			return 0;
+		}
+
+		luaL_checkstack(L, NUM_ENTRY_ARGS, __func__);
+
+		const int entryIdx = lua_gettop(L);
+
+		for (int n = 1; n <= NUM_ENTRY_ARGS; n++) {
+			lua_rawgeti(L, entryIdx, n);
+		}
+
+		ParseUnitLoadParams(L, __func__, entryIdx + 1, params[i]);
+		lua_settop(L, entryIdx - 1);
+	}
+
+	inCreateUnit = true;
+	unitLoader->LoadUnits(params, units);
+	inCreateUnit = false;
+
+	lua_createtable(L, units.size(), 0);
+
+	for (size_t i = 0; i < units.size(); i++) {
+		if (units[i] == nullptr) {
+			lua_pushboolean(L, false);
+		} else {
+			units[i]->SetSoloBuilder(const_cast<CUnit*>(params[i].builder), params[i].unitDef);
+			lua_pushnumber(L, units[i]->id);
+		}
+
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
+
+
 int LuaSyncedCtrl::DestroyUnit(lua_State* L)
 {
 	CheckAllowGameChanges(L); // FIXME -- recursion protection
@@ -1539,6 +1605,7 @@ int LuaSyncedCtrl::SetUnitHealth(lua_State* L)
 
 	if (lua_isnumber(L, 2)) {
 		unit->health = std::min(unit->maxHealth, lua_tofloat(L, 2));
+		builderWorkIndex.AddDamagedUnit(unit);
 	} else if (lua_istable(L, 2)) {
 		constexpr int tableIdx = 2;
 
@@ -1549,6 +1616,7 @@ int LuaSyncedCtrl::SetUnitHealth(lua_State* L)
 			switch (hashString(lua_tolstring(L, -2, nullptr))) {
 				case hashString("health"): {
 					unit->health = std::min(unit->maxHealth, lua_tofloat(L, -1));
+					builderWorkIndex.AddDamagedUnit(unit);
 				} break;
 				case hashString("capture"): {
 					unit->captureProgress = lua_tofloat(L, -1);
@@ -1588,6 +1656,8 @@ int LuaSyncedCtrl::SetUnitMaxHealth(lua_State* L)
 
 	unit->maxHealth = std::max(0.1f, luaL_checkfloat(L, 2));
 	unit->health = std::min(unit->maxHealth, unit->health);
+
+	builderWorkIndex.AddDamagedUnit(unit);
 	return 0;
 }
 
@@ -1979,6 +2049,8 @@ int LuaSyncedCtrl::SetUnitLosState(lua_State* L)
 	const unsigned char  newState = ParseLosBits(L, 3, oldState);
 
 	unit->SetLosStatus(allyTeam, (losStatus & 0xF0) | newState);
+	// unmasked bits are recalculated in the next frame as before
+	unit->losCheckEpoch = -1;
 	return 0;
 }
 
@@ -4006,7 +4078,7 @@ int LuaSyncedCtrl::LevelSmoothMesh(lua_State* L)
 
 	for (int z = z1; z <= z2; z++) {
 		for (int x = x1; x <= x2; x++) {
-			const int index = (z * smoothGround.GetMaxX()) + x;
+			const int index = (z * (smoothGround.GetMaxX() + 1)) + x;
 			smoothGround.SetHeight(index, height);
 		}
 	}
@@ -4021,7 +4093,7 @@ int LuaSyncedCtrl::AdjustSmoothMesh(lua_State* L)
 
 	for (int z = z1; z <= z2; z++) {
 		for (int x = x1; x <= x2; x++) {
-			const int index = (z * smoothGround.GetMaxX()) + x;
+			const int index = (z * (smoothGround.GetMaxX() + 1)) + x;
 			smoothGround.AddHeight(index, height);
 		}
 	}
@@ -4041,7 +4113,7 @@ int LuaSyncedCtrl::RevertSmoothMesh(lua_State* L)
 	if (origFactor == 1.0f) {
 		for (int z = z1; z <= z2; z++) {
 			for (int x = x1; x <= x2; x++) {
-				const int idx = (z * smoothGround.GetMaxX()) + x;
+				const int idx = (z * (smoothGround.GetMaxX() + 1)) + x;
 				smoothGround.SetHeight(idx, origMap[idx]);
 			}
 		}
@@ -4050,7 +4122,7 @@ int LuaSyncedCtrl::RevertSmoothMesh(lua_State* L)
 		const float currFactor = (1.0f - origFactor);
 		for (int z = z1; z <= z2; z++) {
 			for (int x = x1; x <= x2; x++) {
-				const int index = (z * smoothGround.GetMaxX()) + x;
+				const int index = (z * (smoothGround.GetMaxX() + 1)) + x;
 				const float ofh = origFactor * origMap[index];
 				const float cfh = currFactor * currMap[index];
 				smoothGround.SetHeight(index, ofh + cfh);
@@ -4082,7 +4154,7 @@ int LuaSyncedCtrl::AddSmoothMesh(lua_State* L)
 		return 0;
 	}
 
-	const int index = (z * smoothGround.GetMaxX()) + x;
+	const int index = (z * (smoothGround.GetMaxX() + 1)) + x;
 	const float oldHeight = smoothGround.GetMeshData()[index];
 	smoothMeshAmountChanged += math::fabsf(h);
 
@@ -4112,7 +4184,7 @@ int LuaSyncedCtrl::SetSmoothMesh(lua_State* L)
 		return 0;
 	}
 
-	const int index = (z * (smoothGround.GetMaxX())) + x;
+	const int index = (z * (smoothGround.GetMaxX() + 1)) + x;
 	const float oldHeight = smoothGround.GetMeshData()[index];
 	float height = oldHeight;
 
@@ -34,6 +34,7 @@
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GroundBlockingObjectMap.h"
 #include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -69,12 +70,15 @@
 #include "Sim/Weapons/Weapon.h"
 #include "Sim/Weapons/WeaponDefHandler.h"
 #include "System/bitops.h"
+#include "System/SpringHash.h"
 #include "System/SpringMath.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/StringUtil.h"
 
+#include <algorithm>
 #include <cctype>
+#include <cstring>
 
 
 using std::min;
@@ -175,6 +179,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitsInPlanes);
 	REGISTER_LUA_CFUNC(GetUnitsInSphere);
 	REGISTER_LUA_CFUNC(GetUnitsInCylinder);
+	REGISTER_LUA_CFUNC(GetUnitsInCircles);
 
 	REGISTER_LUA_CFUNC(GetFeaturesInRectangle);
 	REGISTER_LUA_CFUNC(GetFeaturesInSphere);
@@ -214,6 +219,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetUnitDirection);
 	REGISTER_LUA_CFUNC(GetUnitHeading);
 	REGISTER_LUA_CFUNC(GetUnitVelocity);
+	REGISTER_LUA_CFUNC(GetUnitsStateBulk);
 	REGISTER_LUA_CFUNC(GetUnitBuildFacing);
 	REGISTER_LUA_CFUNC(GetUnitIsBuilding);
 	REGISTER_LUA_CFUNC(GetUnitCurrentBuildPower);
@@ -309,6 +315,7 @@ bool LuaSyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetProjectileDamages);
 
 	REGISTER_LUA_CFUNC(GetGroundHeight);
+	REGISTER_LUA_CFUNC(GetGroundHeights);
 	REGISTER_LUA_CFUNC(GetGroundOrigHeight);
 	REGISTER_LUA_CFUNC(GetGroundNormal);
 	REGISTER_LUA_CFUNC(GetGroundInfo);
@@ -1393,15 +1400,14 @@ int LuaSyncedRead::GetTeamStatsHistory(lua_State* L)
 
 	const int args = lua_gettop(L);
 
+	// the last entry is the one still accumulating
+	const int statCount = team->statHistory.GetSize() + 1;
+
 	if (args == 1) {
-		lua_pushnumber(L, team->statHistory.size());
+		lua_pushnumber(L, statCount);
 		return 1;
 	}
 
-	const auto& teamStats = team->statHistory;
-	auto it = teamStats.cbegin();
-	const int statCount = teamStats.size();
-
 	int start = 0;
 	if ((args >= 2) && lua_isnumber(L, 2)) {
 		start = lua_toint(L, 2) - 1;
@@ -1414,51 +1420,53 @@ int LuaSyncedRead::GetTeamStatsHistory(lua_State* L)
 		end = max(0, min(statCount - 1, end));
 	}
 
-	std::advance(it, start);
-
-	lua_newtable(L);
-	if (statCount > 0) {
-		int count = 1;
-		for (int i = start; i <= end; ++i, ++it) {
-			const TeamStatistics& stats = *it;
-			lua_newtable(L); {
-				if (i+1 == teamStats.size()) {
-					// the `stats.frame` var indicates the frame when a new entry needs to get added,
-					// for the most recent stats entry this lies obviously in the future,
-					// so we just output the current frame here
-					HSTR_PUSH_NUMBER(L, "time",         gs->GetLuaSimFrame() / GAME_SPEED);
-					HSTR_PUSH_NUMBER(L, "frame",        gs->GetLuaSimFrame());
-				} else {
-					HSTR_PUSH_NUMBER(L, "time",         stats.frame / GAME_SPEED);
-					HSTR_PUSH_NUMBER(L, "frame",        stats.frame);
-				}
+	int count = 1;
 
-				HSTR_PUSH_NUMBER(L, "metalUsed",        stats.metalUsed);
-				HSTR_PUSH_NUMBER(L, "metalProduced",    stats.metalProduced);
-				HSTR_PUSH_NUMBER(L, "metalExcess",      stats.metalExcess);
-				HSTR_PUSH_NUMBER(L, "metalReceived",    stats.metalReceived);
-				HSTR_PUSH_NUMBER(L, "metalSent",        stats.metalSent);
-
-				HSTR_PUSH_NUMBER(L, "energyUsed",       stats.energyUsed);
-				HSTR_PUSH_NUMBER(L, "energyProduced",   stats.energyProduced);
-				HSTR_PUSH_NUMBER(L, "energyExcess",     stats.energyExcess);
-				HSTR_PUSH_NUMBER(L, "energyReceived",   stats.energyReceived);
-				HSTR_PUSH_NUMBER(L, "energySent",       stats.energySent);
-
-				HSTR_PUSH_NUMBER(L, "damageDealt",      stats.damageDealt);
-				HSTR_PUSH_NUMBER(L, "damageReceived",   stats.damageReceived);
-
-				HSTR_PUSH_NUMBER(L, "unitsProduced",    stats.unitsProduced);
-				HSTR_PUSH_NUMBER(L, "unitsDied",        stats.unitsDied);
-				HSTR_PUSH_NUMBER(L, "unitsReceived",    stats.unitsReceived);
-				HSTR_PUSH_NUMBER(L, "unitsSent",        stats.unitsSent);
-				HSTR_PUSH_NUMBER(L, "unitsCaptured",    stats.unitsCaptured);
-				HSTR_PUSH_NUMBER(L, "unitsOutCaptured", stats.unitsOutCaptured);
-				HSTR_PUSH_NUMBER(L, "unitsKilled",      stats.unitsKilled);
+	const auto PushStats = [&](const TeamStatistics& stats, bool current) {
+		lua_newtable(L); {
+			if (current) {
+				// the `stats.frame` var indicates the frame when a new entry needs to get added,
+				// for the most recent stats entry this lies obviously in the future,
+				// so we just output the current frame here
+				HSTR_PUSH_NUMBER(L, "time",         gs->GetLuaSimFrame() / GAME_SPEED);
+				HSTR_PUSH_NUMBER(L, "frame",        gs->GetLuaSimFrame());
+			} else {
+				HSTR_PUSH_NUMBER(L, "time",         stats.frame / GAME_SPEED);
+				HSTR_PUSH_NUMBER(L, "frame",        stats.frame);
 			}
-			lua_rawseti(L, -2, count++);
+
+			HSTR_PUSH_NUMBER(L, "metalUsed",        stats.metalUsed);
+			HSTR_PUSH_NUMBER(L, "metalProduced",    stats.metalProduced);
+			HSTR_PUSH_NUMBER(L, "metalExcess",      stats.metalExcess);
+			HSTR_PUSH_NUMBER(L, "metalReceived",    stats.metalReceived);
+			HSTR_PUSH_NUMBER(L, "metalSent",        stats.metalSent);
+
+			HSTR_PUSH_NUMBER(L, "energyUsed",       stats.energyUsed);
+			HSTR_PUSH_NUMBER(L, "energyProduced",   stats.energyProduced);
+			HSTR_PUSH_NUMBER(L, "energyExcess",     stats.energyExcess);
+			HSTR_PUSH_NUMBER(L, "energyReceived",   stats.energyReceived);
+			HSTR_PUSH_NUMBER(L, "energySent",       stats.energySent);
+
+			HSTR_PUSH_NUMBER(L, "damageDealt",      stats.damageDealt);
+			HSTR_PUSH_NUMBER(L, "damageReceived",   stats.damageReceived);
+
+			HSTR_PUSH_NUMBER(L, "unitsProduced",    stats.unitsProduced);
+			HSTR_PUSH_NUMBER(L, "unitsDied",        stats.unitsDied);
+			HSTR_PUSH_NUMBER(L, "unitsReceived",    stats.unitsReceived);
+			HSTR_PUSH_NUMBER(L, "unitsSent",        stats.unitsSent);
+			HSTR_PUSH_NUMBER(L, "unitsCaptured",    stats.unitsCaptured);
+			HSTR_PUSH_NUMBER(L, "unitsOutCaptured", stats.unitsOutCaptured);
+			HSTR_PUSH_NUMBER(L, "unitsKilled",      stats.unitsKilled);
 		}
-	}
+		lua_rawseti(L, -2, count++);
+	};
+
+	lua_newtable(L);
+
+	team->statHistory.ForEach(start, end + 1, 1, [&](size_t, const TeamStatistics& stats) { PushStats(stats, false); });
+
+	if (end == (statCount - 1))
+		PushStats(team->GetCurrentStats(), true);
 
 	return 1;
 }
@@ -2190,6 +2198,150 @@ static int ParseAllegiance(lua_State* L, const char* caller, int index)
 }
 
 
+/******************************************************************************/
+//
+//  Per-frame cache for GetUnitsIn{Rectangle,Sphere,Cylinder}
+//  (enabled by the system.luaSpatialQueryCache modrule); results
+//  reflect unit positions at the first query of a frame, so units
+//  moved later within the same frame are not accounted for
+//
+
+struct SpatialQueryKey {
+	bool operator == (const SpatialQueryKey& k) const {
+		return (std::memcmp(this, &k, sizeof(SpatialQueryKey)) == 0);
+	}
+
+	int shape;
+	float params[4];
+
+	// filter and read-access of the querying handle
+	int allegiance;
+	int readTeam;
+	int readAllyTeam;
+	int fullRead;
+};
+
+struct SpatialQueryKeyHash {
+	std::uint32_t operator()(const SpatialQueryKey& k) const {
+		return (HsiehHash(&k, sizeof(SpatialQueryKey), 0));
+	}
+};
+
+struct SpatialQueryCache {
+	spring::unordered_map<SpatialQueryKey, std::vector<int>, SpatialQueryKeyHash> results;
+	int frameNum = -1;
+};
+
+enum {
+	SPATIAL_QUERY_RECTANGLE = 0,
+	SPATIAL_QUERY_CYLINDER  = 1,
+	SPATIAL_QUERY_SPHERE    = 2,
+};
+
+// synced and unsynced states must never share results; which state fills
+// an entry first would otherwise depend on the (unsynced) draw schedule
+static SpatialQueryCache spatialQueryCaches[2];
+
+
+static SpatialQueryKey MakeSpatialQueryKey(lua_State* L, int shape, float p0, float p1, float p2, float p3, int allegiance)
+{
+	SpatialQueryKey key;
+
+	// zero any padding so memcmp and hashing see defined bytes
+	std::memset(&key, 0, sizeof(key));
+
+	key.shape = shape;
+	key.params[0] = p0;
+	key.params[1] = p1;
+	key.params[2] = p2;
+	key.params[3] = p3;
+	key.allegiance = allegiance;
+	key.readTeam = CLuaHandle::GetHandleReadTeam(L);
+	key.readAllyTeam = CLuaHandle::GetHandleReadAllyTeam(L);
+	key.fullRead = CLuaHandle::GetHandleFullRead(L);
+	return key;
+}
+
+static SpatialQueryCache* GetSpatialQueryCache(lua_State* L)
+{
+	if (!modInfo.luaSpatialQueryCache)
+		return nullptr;
+
+	SpatialQueryCache& cache = spatialQueryCaches[CLuaHandle::GetHandleSynced(L)];
+
+	if (cache.frameNum != gs->frameNum) {
+		cache.results.clear();
+		cache.frameNum = gs->frameNum;
+	}
+
+	return &cache;
+}
+
+static bool PushCachedSpatialQuery(lua_State* L, const SpatialQueryKey& key)
+{
+	const SpatialQueryCache* cache = GetSpatialQueryCache(L);
+
+	if (cache == nullptr)
+		return false;
+
+	const auto iter = cache->results.find(key);
+
+	if (iter == cache->results.end())
+		return false;
+
+	const std::vector<int>& unitIDs = iter->second;
+
+	lua_createtable(L, unitIDs.size(), 0);
+
+	for (size_t i = 0; i < unitIDs.size(); i++) {
+		lua_pushnumber(L, unitIDs[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return true;
+}
+
+// stores the result table at the top of the stack
+static void CacheSpatialQuery(lua_State* L, const SpatialQueryKey& key)
+{
+	SpatialQueryCache* cache = GetSpatialQueryCache(L);
+
+	if (cache == nullptr)
+		return;
+
+	std::vector<int>& unitIDs = cache->results[key];
+
+	unitIDs.clear();
+	unitIDs.reserve(lua_objlen(L, -1));
+
+	for (int i = 1, n = lua_objlen(L, -1); i <= n; i++) {
+		lua_rawgeti(L, -1, i);
+		unitIDs.push_back(lua_toint(L, -1));
+		lua_pop(L, 1);
+	}
+}
+
+
+static bool IsUnitInAllegiance(lua_State* L, const CUnit* unit, int allegiance)
+{
+	if (allegiance >= 0) {
+		if (unit->team != allegiance)
+			return false;
+
+		return (IsAlliedTeam(L, allegiance) || IsUnitVisible(L, unit));
+	}
+
+	switch (allegiance) {
+		case MyUnits   : { return (unit->team == CLuaHandle::GetHandleReadTeam(L)); } break;
+		case AllyUnits : { return (unit->allyteam == CLuaHandle::GetHandleReadAllyTeam(L)); } break;
+		case EnemyUnits: { return (unit->allyteam != CLuaHandle::GetHandleReadAllyTeam(L) && IsUnitVisible(L, unit)); } break;
+		default        : {} break;
+	}
+
+	return (IsUnitVisible(L, unit));
+}
+
+
 int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 {
 	const float xmin = luaL_checkfloat(L, 1);
@@ -2201,6 +2353,10 @@ int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 	const float3 maxs(xmax, 0.0f, zmax);
 
 	const int allegiance = ParseAllegiance(L, __func__, 5);
+	const SpatialQueryKey queryKey = MakeSpatialQueryKey(L, SPATIAL_QUERY_RECTANGLE, xmin, zmin, xmax, zmax, allegiance);
+
+	if (PushCachedSpatialQuery(L, queryKey))
+		return 1;
 
 #define RECTANGLE_TEST ; // no test, GetUnitsExact is sufficient
 
@@ -2229,6 +2385,7 @@ int LuaSyncedRead::GetUnitsInRectangle(lua_State* L)
 		LOOP_UNIT_CONTAINER(VISIBLE_TEST, RECTANGLE_TEST, true);
 	}
 
+	CacheSpatialQuery(L, queryKey);
 	return 1;
 }
 
@@ -2293,6 +2450,10 @@ int LuaSyncedRead::GetUnitsInCylinder(lua_State* L)
 	const float3 maxs(x + radius, 0.0f, z + radius);
 
 	const int allegiance = ParseAllegiance(L, __func__, 4);
+	const SpatialQueryKey queryKey = MakeSpatialQueryKey(L, SPATIAL_QUERY_CYLINDER, x, z, radius, 0.0f, allegiance);
+
+	if (PushCachedSpatialQuery(L, queryKey))
+		return 1;
 
 #define CYLINDER_TEST                         \
 	const float3& p = unit->midPos;             \
@@ -2328,6 +2489,7 @@ int LuaSyncedRead::GetUnitsInCylinder(lua_State* L)
 		LOOP_UNIT_CONTAINER(VISIBLE_TEST, CYLINDER_TEST, true);
 	}
 
+	CacheSpatialQuery(L, queryKey);
 	return 1;
 }
 
@@ -2345,6 +2507,10 @@ int LuaSyncedRead::GetUnitsInSphere(lua_State* L)
 	const float3 maxs(x + radius, 0.0f, z + radius);
 
 	const int allegiance = ParseAllegiance(L, __func__, 5);
+	const SpatialQueryKey queryKey = MakeSpatialQueryKey(L, SPATIAL_QUERY_SPHERE, x, y, z, radius, allegiance);
+
+	if (PushCachedSpatialQuery(L, queryKey))
+		return 1;
 
 #define SPHERE_TEST                           \
 	const float3& p = unit->midPos;             \
@@ -2382,6 +2548,89 @@ int LuaSyncedRead::GetUnitsInSphere(lua_State* L)
 		LOOP_UNIT_CONTAINER(VISIBLE_TEST, SPHERE_TEST, true);
 	}
 
+	CacheSpatialQuery(L, queryKey);
+	return 1;
+}
+
+
+int LuaSyncedRead::GetUnitsInCircles(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	// parse the circles, each {x, z, radius}
+	std::vector<float3> circles;
+	circles.reserve(lua_objlen(L, 1));
+
+	for (int i = 1, n = lua_objlen(L, 1); i <= n; i++) {
+		lua_rawgeti(L, 1, i);
+
+		float values[3];
+
+		if (!lua_istable(L, -1) || LuaUtils::ParseFloatArray(L, -1, values, 3) != 3)
+			luaL_error(L, "[%s] circle %d is not a {x, z, radius} table", __func__, i);
+
+		circles.emplace_back(values[0], values[2], values[1]);
+		lua_pop(L, 1);
+	}
+
+	const int allegiance = ParseAllegiance(L, __func__, 2);
+
+	// (quad, circle) pairs sorted by quad, so every quad is visited once for all circles overlapping it
+	std::vector<std::pair<int, int>> quadCircles;
+	std::vector<int> quads;
+
+	for (size_t i = 0; i < circles.size(); i++) {
+		quadField.GetQuadsMT(quads, float3(circles[i].x, 0.0f, circles[i].z), circles[i].y);
+
+		for (const int qi: quads) {
+			quadCircles.emplace_back(qi, i);
+		}
+	}
+
+	std::sort(quadCircles.begin(), quadCircles.end());
+
+	std::vector<std::vector<int>> circleUnitIDs(circles.size());
+
+	for (size_t i = 0, j = 0; i < quadCircles.size(); i = j) {
+		const int qi = quadCircles[i].first;
+
+		for (j = i; j < quadCircles.size() && quadCircles[j].first == qi; j++);
+
+		for (const CUnit* unit: quadField.GetQuad(qi).units) {
+			const float3& p = unit->midPos;
+
+			for (size_t k = i; k < j; k++) {
+				const float3& c = circles[quadCircles[k].second];
+
+				if (Square(p.x - c.x) + Square(p.z - c.z) > Square(c.y))
+					continue;
+				if (!IsUnitInAllegiance(L, unit, allegiance))
+					continue;
+
+				circleUnitIDs[quadCircles[k].second].push_back(unit->id);
+			}
+		}
+	}
+
+	lua_createtable(L, circles.size(), 0);
+
+	for (size_t i = 0; i < circleUnitIDs.size(); i++) {
+		std::vector<int>& unitIDs = circleUnitIDs[i];
+
+		// units overlapping several quads of the same circle were collected once per quad
+		std::sort(unitIDs.begin(), unitIDs.end());
+		unitIDs.erase(std::unique(unitIDs.begin(), unitIDs.end()), unitIDs.end());
+
+		lua_createtable(L, unitIDs.size(), 0);
+
+		for (size_t k = 0; k < unitIDs.size(); k++) {
+			lua_pushnumber(L, unitIDs[k]);
+			lua_rawseti(L, -2, k + 1);
+		}
+
+		lua_rawseti(L, -2, i + 1);
+	}
+
 	return 1;
 }
 
@@ -3165,6 +3414,203 @@ int LuaSyncedRead::GetUnitVelocity(lua_State* L)
 }
 
 
+/*
+ * Spring.GetUnitsStateBulk(unitIDs, fields [, columns]) -> columns
+ *
+ * Columnar GetUnitPosition, GetUnitVelocity, GetUnitHealth, GetUnitDefID
+ * and GetUnitTeam for many units in one call. <fields> is an array of
+ * "position", "velocity", "health", "unitDefID" and "teamID"; each adds
+ * the named columns below to <columns> (a new table unless one is given
+ * for reuse), holding one entry per element of <unitIDs>. Units that the
+ * single-unit call would return nothing for get false in every column
+ * of that field.
+ */
+int LuaSyncedRead::GetUnitsStateBulk(lua_State* L)
+{
+	enum {
+		FIELD_POSITION  = 0,
+		FIELD_VELOCITY  = 1,
+		FIELD_HEALTH    = 2,
+		FIELD_UNITDEFID = 3,
+		FIELD_TEAMID    = 4,
+		NUM_FIELDS      = 5,
+	};
+
+	static const char* fieldNames[NUM_FIELDS] = {"position", "velocity", "health", "unitDefID", "teamID"};
+	static const std::vector<const char*> fieldColumns[NUM_FIELDS] = {
+		{"x", "y", "z"},
+		{"vx", "vy", "vz", "speed"},
+		{"health", "maxHealth", "paralyzeDamage", "captureProgress", "buildProgress"},
+		{"unitDefID"},
+		{"teamID"},
+	};
+
+	luaL_checktype(L, 1, LUA_TTABLE);
+	luaL_checktype(L, 2, LUA_TTABLE);
+
+	bool wantedFields[NUM_FIELDS] = {false};
+
+	for (int i = 1; /*no test*/; ++i) {
+		lua_rawgeti(L, 2, i);
+
+		if (lua_isnil(L, -1)) {
+			lua_pop(L, 1);
+			break;
+		}
+
+		const char* fieldName = luaL_checkstring(L, -1);
+		const auto it = std::find_if(std::begin(fieldNames), std::end(fieldNames), [&](const char* name) { return (strcmp(name, fieldName) == 0); });
+
+		if (it == std::end(fieldNames))
+			luaL_error(L, "[%s] unknown field \"%s\"", __func__, fieldName);
+
+		wantedFields[it - std::begin(fieldNames)] = true;
+		lua_pop(L, 1);
+	}
+
+	if (lua_istable(L, 3)) {
+		lua_settop(L, 3);
+	} else {
+		lua_settop(L, 2);
+		lua_newtable(L);
+	}
+
+	const int numUnits = lua_objlen(L, 1);
+	const int columnsIdx = lua_gettop(L);
+
+	// stack index of each wanted column after columnsIdx
+	int columnIndices[NUM_FIELDS] = {0};
+
+	for (int f = 0; f < NUM_FIELDS; ++f) {
+		if (!wantedFields[f])
+			continue;
+
+		lua_checkstack(L, fieldColumns[f].size());
+		columnIndices[f] = lua_gettop(L) + 1;
+
+		for (const char* column: fieldColumns[f]) {
+			lua_getfield(L, columnsIdx, column);
+
+			if (lua_istable(L, -1)) {
+				// clear entries left over from a longer unitIDs array
+				for (int i = numUnits + 1; /*no test*/; ++i) {
+					lua_rawgeti(L, -1, i);
+					const bool isNil = lua_isnil(L, -1);
+					lua_pop(L, 1);
+
+					if (isNil)
+						break;
+
+					lua_pushnil(L);
+					lua_rawseti(L, -2, i);
+				}
+				continue;
+			}
+
+			lua_pop(L, 1);
+			lua_createtable(L, numUnits, 0);
+			lua_pushvalue(L, -1);
+			lua_setfield(L, columnsIdx, column);
+		}
+	}
+
+	const auto SetNumber = [&](int column, int i, float value) { lua_pushnumber(L, value); lua_rawseti(L, column, i); };
+	const auto SetFalse = [&](int field, int i) {
+		for (size_t c = 0; c < fieldColumns[field].size(); ++c) {
+			lua_pushboolean(L, false);
+			lua_rawseti(L, columnIndices[field] + c, i);
+		}
+	};
+
+	for (int i = 1; i <= numUnits; ++i) {
+		lua_rawgeti(L, 1, i);
+		const CUnit* unit = lua_isnumber(L, -1)? unitHandler.GetUnit(lua_toint(L, -1)): nullptr;
+		lua_pop(L, 1);
+
+		const bool isAlly    = (unit != nullptr && IsAllyUnit(L, unit));
+		const bool isVisible = (unit != nullptr && IsUnitVisible(L, unit));
+		const bool isInLos   = (unit != nullptr && ::IsUnitInLos(L, unit));
+
+		if (wantedFields[FIELD_POSITION]) {
+			const int c = columnIndices[FIELD_POSITION];
+
+			if (isVisible) {
+				float3 errorVec;
+
+				if (!isAlly)
+					errorVec = unit->GetLuaErrorVector(CLuaHandle::GetHandleReadAllyTeam(L), CLuaHandle::GetHandleFullRead(L));
+
+				SetNumber(c + 0, i, unit->pos.x + errorVec.x);
+				SetNumber(c + 1, i, unit->pos.y + errorVec.y);
+				SetNumber(c + 2, i, unit->pos.z + errorVec.z);
+			} else {
+				SetFalse(FIELD_POSITION, i);
+			}
+		}
+
+		if (wantedFields[FIELD_VELOCITY]) {
+			const int c = columnIndices[FIELD_VELOCITY];
+
+			if (isInLos) {
+				SetNumber(c + 0, i, unit->speed.x);
+				SetNumber(c + 1, i, unit->speed.y);
+				SetNumber(c + 2, i, unit->speed.z);
+				SetNumber(c + 3, i, unit->speed.w);
+			} else {
+				SetFalse(FIELD_VELOCITY, i);
+			}
+		}
+
+		if (wantedFields[FIELD_HEALTH]) {
+			const int c = columnIndices[FIELD_HEALTH];
+
+			if (isInLos) {
+				const UnitDef* ud = unit->unitDef;
+
+				if (ud->hideDamage && !isAlly) {
+					// single-unit call returns nil for these
+					SetFalse(FIELD_HEALTH, i);
+				} else {
+					const float scale = (isAlly || ud->decoyDef == nullptr)? 1.0f: (ud->decoyDef->health / ud->health);
+
+					SetNumber(c + 0, i, scale * unit->health);
+					SetNumber(c + 1, i, scale * unit->maxHealth);
+					SetNumber(c + 2, i, scale * unit->paralyzeDamage);
+				}
+
+				SetNumber(c + 3, i, unit->captureProgress);
+				SetNumber(c + 4, i, unit->buildProgress);
+			} else {
+				SetFalse(FIELD_HEALTH, i);
+			}
+		}
+
+		if (wantedFields[FIELD_UNITDEFID]) {
+			const int c = columnIndices[FIELD_UNITDEFID];
+
+			if (isVisible && (isAlly || IsUnitTyped(L, unit))) {
+				SetNumber(c, i, EffectiveUnitDef(L, unit)->id);
+			} else {
+				SetFalse(FIELD_UNITDEFID, i);
+			}
+		}
+
+		if (wantedFields[FIELD_TEAMID]) {
+			const int c = columnIndices[FIELD_TEAMID];
+
+			if (isVisible) {
+				SetNumber(c, i, unit->team);
+			} else {
+				SetFalse(FIELD_TEAMID, i);
+			}
+		}
+	}
+
+	lua_settop(L, columnsIdx);
+	return 1;
+}
+
+
 int LuaSyncedRead::GetUnitBuildFacing(lua_State* L)
 {
 	const CUnit* unit = ParseInLosUnit(L, __func__, 1);
@@ -5179,6 +5625,34 @@ int LuaSyncedRead::GetGroundHeight(lua_State* L)
 }
 
 
+int LuaSyncedRead::GetGroundHeights(lua_State* L)
+{
+	// {x1, z1, x2, z2, ...} -> {h1, h2, ...}; an optional
+	// second table is filled instead of creating a new one
+	static std::vector<float> coors;
+	static std::vector<float> heights;
+
+	if (LuaUtils::ParseFloatVector(L, 1, coors) < 0)
+		luaL_error(L, "[%s] arg #1 must be a table of {x1, z1, x2, z2, ...} coordinates", __func__);
+
+	heights.resize(coors.size() / 2);
+
+	CGround::GetHeightsReal(coors.data(), heights.data(), heights.size(), CLuaHandle::GetHandleSynced(L));
+
+	if (lua_istable(L, 2)) {
+		lua_settop(L, 2);
+	} else {
+		lua_createtable(L, heights.size(), 0);
+	}
+
+	for (size_t i = 0; i < heights.size(); i++) {
+		lua_pushnumber(L, heights[i]);
+		lua_rawseti(L, -2, i + 1);
+	}
+
+	return 1;
+}
+
 int LuaSyncedRead::GetGroundOrigHeight(lua_State* L)
 {
 	const float x = luaL_checkfloat(L, 1);
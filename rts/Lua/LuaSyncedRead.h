@@ -84,6 +84,7 @@ class LuaSyncedRead {
 		static int GetUnitsInPlanes(lua_State* L);
 		static int GetUnitsInSphere(lua_State* L);
 		static int GetUnitsInCylinder(lua_State* L);
+		static int GetUnitsInCircles(lua_State* L);
 
 		static int GetUnitNearestAlly(lua_State* L);
 		static int GetUnitNearestEnemy(lua_State* L);
@@ -123,6 +124,7 @@ class LuaSyncedRead {
 		static int GetUnitDirection(lua_State* L);
 		static int GetUnitHeading(lua_State* L);
 		static int GetUnitVelocity(lua_State* L);
+		static int GetUnitsStateBulk(lua_State* L);
 		static int GetUnitBuildFacing(lua_State* L);
 		static int GetUnitIsBuilding(lua_State* L);
 		static int GetUnitCurrentBuildPower(lua_State* L);
@@ -221,6 +223,7 @@ class LuaSyncedRead {
 		static int GetProjectileName(lua_State* L); // DEPRECATE ME?
 
 		static int GetGroundHeight(lua_State* L);
+		static int GetGroundHeights(lua_State* L);
 		static int GetGroundOrigHeight(lua_State* L);
 		static int GetGroundNormal(lua_State* L);
 		static int GetGroundInfo(lua_State* L);
@@ -29,6 +29,7 @@
 #include "LuaZip.h"
 #include "Game/Camera.h"
 #include "Game/GlobalUnsynced.h"
+#include "Rendering/GlobalRendering.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Units/CommandAI/CommandDescription.h"
@@ -183,6 +184,7 @@ CLuaUI::CLuaUI()
 
 CLuaUI::~CLuaUI()
 {
+	workers.Kill();
 	luaUI = nullptr;
 }
 
@@ -227,6 +229,20 @@ static bool IsDisallowedCallIn(const string& name)
 	return false;
 }
 
+void CLuaUI::GameFrame(int frameNum)
+{
+	// worker results must be available before any widget sees this frame
+	workers.GameFrame(frameNum);
+	CLuaHandle::GameFrame(frameNum);
+}
+
+void CLuaUI::Update()
+{
+	workers.Update(globalRendering->lastFrameTime * 0.001f);
+	CLuaHandle::Update();
+}
+
+
 bool CLuaUI::HasCallIn(lua_State* L, const string& name) const
 {
 	// never allow these calls
@@ -263,6 +279,11 @@ bool CLuaUI::LoadCFunctions(lua_State* L)
 
 	REGISTER_LUA_CFUNC(SetShockFrontFactors);
 
+	REGISTER_LUA_CFUNC(CreateWorkerState);
+	REGISTER_LUA_CFUNC(DestroyWorkerState);
+	REGISTER_LUA_CFUNC(SetWorkerInput);
+	REGISTER_LUA_CFUNC(GetWorkerResults);
+
 	lua_setglobal(L, "Spring");
 	return true;
 }
@@ -679,5 +700,40 @@ int CLuaUI::SetShockFrontFactors(lua_State* L)
 	return 0;
 }
 
+
+int CLuaUI::CreateWorkerState(lua_State* L)
+{
+	std::string error;
+
+	if (!luaUI->workers.Create(luaL_checksstring(L, 1), luaL_checksstring(L, 2), error)) {
+		lua_pushboolean(L, false);
+		lua_pushsstring(L, error);
+		return 2;
+	}
+
+	lua_pushboolean(L, true);
+	return 1;
+}
+
+int CLuaUI::DestroyWorkerState(lua_State* L)
+{
+	lua_pushboolean(L, luaUI->workers.Destroy(luaL_checksstring(L, 1)));
+	return 1;
+}
+
+int CLuaUI::SetWorkerInput(lua_State* L)
+{
+	const std::string name = luaL_checksstring(L, 1);
+
+	lua_settop(L, 2);
+	lua_pushboolean(L, luaUI->workers.SetInput(name, L));
+	return 1;
+}
+
+int CLuaUI::GetWorkerResults(lua_State* L)
+{
+	return (luaUI->workers.PushResults(luaL_checksstring(L, 1), L));
+}
+
 /******************************************************************************/
 /******************************************************************************/
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "LuaHandle.h"
+#include "LuaUIWorkers.h"
 #include "System/UnorderedMap.hpp"
 
 
@@ -74,6 +75,9 @@ public: // call-ins
 
 	void ShockFront(const float3& pos, float power, float areaOfEffect, const float* distMod = NULL);
 
+	void GameFrame(int frameNum) override;
+	void Update() override;
+
 protected:
 	CLuaUI();
 	virtual ~CLuaUI();
@@ -98,8 +102,15 @@ protected:
 	float shockFrontMinPower;
 	float shockFrontDistAdj;
 
+	CLuaUIWorkers workers;
+
 private: // call-outs
 	static int SetShockFrontFactors(lua_State* L);
+
+	static int CreateWorkerState(lua_State* L);
+	static int DestroyWorkerState(lua_State* L);
+	static int SetWorkerInput(lua_State* L);
+	static int GetWorkerResults(lua_State* L);
 };
 
 
@@ -0,0 +1,253 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "LuaUIWorkers.h"
+
+#include "LuaContextData.h"
+#include "LuaInclude.h"
+#include "LuaUtils.h"
+#include "Game/Camera.h"
+#include "Game/GlobalUnsynced.h"
+#include "Game/SelectedUnitsHandler.h"
+#include "Game/UI/MouseHandler.h"
+#include "Rendering/GlobalRendering.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+
+CONFIG(bool, LuaUIWorkersMT)
+	.defaultValue(true)
+	.description("Run LuaUI worker states (Spring.CreateWorkerState) on ThreadPool threads; if false they run one after another on the main thread.")
+;
+
+
+CLuaUIWorkers::Worker* CLuaUIWorkers::GetWorker(const std::string& name)
+{
+	const auto pred = [&](const Worker* w) { return (w->name == name); };
+	const auto iter = std::find_if(workers.begin(), workers.end(), pred);
+
+	if (iter == workers.end())
+		return nullptr;
+
+	return *iter;
+}
+
+
+bool CLuaUIWorkers::Create(const std::string& name, const std::string& code, std::string& error)
+{
+	Destroy(name);
+
+	Worker* w = new Worker();
+
+	w->name = name;
+	// own (unshared) pool, allocations happen on ThreadPool threads
+	w->ctxData = new luaContextData(false, false);
+	w->L = LUA_OPEN(w->ctxData);
+
+	lua_State* L = w->L;
+
+	LUA_OPEN_LIB(L, luaopen_base);
+	LUA_OPEN_LIB(L, luaopen_math);
+	LUA_OPEN_LIB(L, luaopen_table);
+	LUA_OPEN_LIB(L, luaopen_string);
+
+	lua_pushnil(L); lua_setglobal(L, "dofile");
+	lua_pushnil(L); lua_setglobal(L, "loadfile");
+	lua_pushnil(L); lua_setglobal(L, "loadlib");
+	lua_pushnil(L); lua_setglobal(L, "require");
+	lua_pushnil(L); lua_setglobal(L, "print");
+
+	// the unsynced RNG behind math.random is shared by all states
+	lua_getglobal(L, "math");
+	LuaPushNamedNil(L, "random");
+	LuaPushNamedNil(L, "randomseed");
+	lua_pop(L, 1);
+
+	if (luaL_loadbuffer(L, code.c_str(), code.size(), ("=" + name).c_str()) != 0 || lua_pcall(L, 0, 0, 0) != 0) {
+		error = lua_tostring(L, -1);
+		FreeWorker(w);
+		return false;
+	}
+
+	lua_settop(L, 0);
+	workers.push_back(w);
+	return true;
+}
+
+bool CLuaUIWorkers::Destroy(const std::string& name)
+{
+	Worker* w = GetWorker(name);
+
+	if (w == nullptr)
+		return false;
+
+	workers.erase(std::find(workers.begin(), workers.end(), w));
+	FreeWorker(w);
+	return true;
+}
+
+void CLuaUIWorkers::Kill()
+{
+	for (Worker* w: workers) {
+		FreeWorker(w);
+	}
+
+	workers.clear();
+}
+
+void CLuaUIWorkers::FreeWorker(Worker* w)
+{
+	if (w->L != nullptr)
+		LUA_CLOSE(&w->L);
+
+	delete w->ctxData;
+	delete w;
+}
+
+
+bool CLuaUIWorkers::SetInput(const std::string& name, lua_State* srcL)
+{
+	Worker* w = GetWorker(name);
+
+	if (w == nullptr || w->L == nullptr)
+		return false;
+
+	// keep the results of the last run (if any) below the input
+	LuaUtils::CopyData(w->L, srcL, 1);
+	lua_setglobal(w->L, "Input");
+	return true;
+}
+
+int CLuaUIWorkers::PushResults(const std::string& name, lua_State* dstL)
+{
+	Worker* w = GetWorker(name);
+
+	if (w == nullptr)
+		return 0;
+
+	if (w->L == nullptr) {
+		lua_pushnil(dstL);
+		lua_pushsstring(dstL, w->error);
+		return 2;
+	}
+
+	return (LuaUtils::CopyData(dstL, w->L, w->numResults));
+}
+
+
+void CLuaUIWorkers::PushSnapshot(Worker* w) const
+{
+	lua_State* L = w->L;
+
+	lua_createtable(L, 0, 16);
+
+	LuaPushNamedNumber(L, "frameNum", gs->frameNum);
+	LuaPushNamedBool(L, "paused", gs->paused);
+	LuaPushNamedNumber(L, "gameTime", gu->gameTime);
+	LuaPushNamedNumber(L, "myPlayerID", gu->myPlayerNum);
+	LuaPushNamedNumber(L, "myTeamID", gu->myTeam);
+	LuaPushNamedNumber(L, "myAllyTeamID", gu->myAllyTeam);
+	LuaPushNamedBool(L, "spectating", gu->spectating);
+
+	if (mouse != nullptr) {
+		LuaPushNamedNumber(L, "mouseX", mouse->lastx - globalRendering->viewPosX);
+		LuaPushNamedNumber(L, "mouseY", globalRendering->viewSizeY - mouse->lasty - 1);
+	}
+
+	{
+		const float3& pos = camera->GetPos();
+		const float3& dir = camera->GetDir();
+
+		lua_pushliteral(L, "cameraPos");
+		lua_createtable(L, 3, 0);
+		lua_pushnumber(L, pos.x); lua_rawseti(L, -2, 1);
+		lua_pushnumber(L, pos.y); lua_rawseti(L, -2, 2);
+		lua_pushnumber(L, pos.z); lua_rawseti(L, -2, 3);
+		lua_rawset(L, -3);
+
+		lua_pushliteral(L, "cameraDir");
+		lua_createtable(L, 3, 0);
+		lua_pushnumber(L, dir.x); lua_rawseti(L, -2, 1);
+		lua_pushnumber(L, dir.y); lua_rawseti(L, -2, 2);
+		lua_pushnumber(L, dir.z); lua_rawseti(L, -2, 3);
+		lua_rawset(L, -3);
+	}
+	{
+		const auto& selUnits = selectedUnitsHandler.selectedUnits;
+
+		lua_pushliteral(L, "selectedUnits");
+		lua_createtable(L, selUnits.size(), 0);
+
+		int count = 0;
+		for (const int unitID: selUnits) {
+			lua_pushnumber(L, unitID);
+			lua_rawseti(L, -2, ++count);
+		}
+
+		lua_rawset(L, -3);
+	}
+
+	lua_setglobal(L, "Snapshot");
+}
+
+
+void CLuaUIWorkers::RunWorker(Worker* w, const char* func, float arg)
+{
+	lua_State* L = w->L;
+
+	if (L == nullptr)
+		return;
+
+	lua_getglobal(L, func);
+
+	if (!lua_isfunction(L, -1)) {
+		lua_pop(L, 1);
+		return;
+	}
+
+	// drop the previous results but keep the function
+	lua_insert(L, 1);
+	lua_settop(L, 1);
+	lua_pushnumber(L, arg);
+
+	w->numResults = 0;
+
+	if (lua_pcall(L, 1, LUA_MULTRET, 0) != 0) {
+		w->error = lua_tostring(L, -1);
+		lua_settop(L, 0);
+		return;
+	}
+
+	w->numResults = lua_gettop(L);
+}
+
+void CLuaUIWorkers::Run(const char* func, float arg)
+{
+	if (workers.empty())
+		return;
+
+	// the snapshot is built on the main thread; workers see no engine state besides it
+	for (Worker* w: workers) {
+		if (w->L != nullptr)
+			PushSnapshot(w);
+	}
+
+	if (configHandler->GetBool("LuaUIWorkersMT")) {
+		for_mt(0, workers.size(), [&](const int i) { RunWorker(workers[i], func, arg); });
+	} else {
+		for (Worker* w: workers) {
+			RunWorker(w, func, arg);
+		}
+	}
+
+	// close failed states here, not on the worker threads; error stays retrievable
+	for (Worker* w: workers) {
+		if (w->L == nullptr || w->error.empty())
+			continue;
+
+		LOG_L(L_ERROR, "[LuaUI::%s] worker \"%s\" disabled: %s", func, w->name.c_str(), w->error.c_str());
+		LUA_CLOSE(&w->L);
+	}
+}
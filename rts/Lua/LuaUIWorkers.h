@@ -0,0 +1,63 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_UI_WORKERS_H
+#define LUA_UI_WORKERS_H
+
+#include <string>
+#include <vector>
+
+struct lua_State;
+struct luaContextData;
+
+/**
+ * @brief Isolated Lua states running widget logic on ThreadPool workers
+ * Each worker is created by LuaUI from a code string and has no access to the
+ * engine: only the base, math, table and string libraries (without random),
+ * a per-frame read-only `Snapshot` table of unsynced game state, and the
+ * `Input` value last passed to Spring.SetWorkerInput. Its global Update(dt)
+ * and GameFrame(frameNum) functions run in parallel with all other workers
+ * before the corresponding LuaUI callin, and their return values are kept
+ * until LuaUI fetches them with Spring.GetWorkerResults.
+ */
+class CLuaUIWorkers {
+public:
+	~CLuaUIWorkers() { Kill(); }
+
+	bool Create(const std::string& name, const std::string& code, std::string& error);
+	bool Destroy(const std::string& name);
+	void Kill();
+
+	/// copies the value at the top of srcL's stack into the worker
+	bool SetInput(const std::string& name, lua_State* srcL);
+	/// copies the results of the worker's last run onto dstL's stack
+	int PushResults(const std::string& name, lua_State* dstL);
+
+	void Update(float deltaTime) { Run("Update", deltaTime); }
+	void GameFrame(int frameNum) { Run("GameFrame", frameNum); }
+
+	bool Empty() const { return workers.empty(); }
+
+private:
+	struct Worker {
+		std::string name;
+		std::string error;
+
+		luaContextData* ctxData = nullptr;
+		lua_State* L = nullptr;
+
+		int numResults = 0;
+	};
+
+	Worker* GetWorker(const std::string& name);
+
+	void PushSnapshot(Worker* w) const;
+	void Run(const char* func, float arg);
+
+	static void RunWorker(Worker* w, const char* func, float arg);
+	static void FreeWorker(Worker* w);
+
+private:
+	std::vector<Worker*> workers;
+};
+
+#endif // LUA_UI_WORKERS_H
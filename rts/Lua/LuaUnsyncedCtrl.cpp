@@ -369,6 +369,23 @@ static inline CFeature* ParseCtrlFeature(lua_State* L, const char* caller, int i
 }
 
 
+// reused by SelectUnit{Array,Map}, selections of whole armies are common
+static std::vector<CUnit*> selectUnitsBuffer;
+
+static void SelectUnits(const std::vector<CUnit*>& units, bool append)
+{
+	// clear the current units, unless the append flag is present; only
+	// units whose selection state changes are touched either way
+	if (!append) {
+		selectedUnitsHandler.ReplaceSelected(units);
+		return;
+	}
+
+	for (CUnit* unit: units) {
+		selectedUnitsHandler.AddUnit(unit);
+	}
+}
+
 static inline CUnit* ParseSelectUnit(lua_State* L, const char* caller, int index)
 {
 	CUnit* unit = ParseRawUnit(L, caller, index);
@@ -874,9 +891,8 @@ int LuaUnsyncedCtrl::SelectUnitArray(lua_State* L)
 	if (!lua_istable(L, 1))
 		luaL_error(L, "[%s] incorrect arguments", __func__);
 
-	// clear the current units, unless the append flag is present
-	if (!luaL_optboolean(L, 2, false))
-		selectedUnitsHandler.ClearSelected();
+	std::vector<CUnit*>& units = selectUnitsBuffer;
+	units.clear();
 
 	constexpr int tableIdx = 1;
 	for (lua_pushnil(L); lua_next(L, tableIdx) != 0; lua_pop(L, 1)) {
@@ -884,10 +900,11 @@ int LuaUnsyncedCtrl::SelectUnitArray(lua_State* L)
 			CUnit* unit = ParseSelectUnit(L, __func__, -1); // the value
 
 			if (unit != nullptr)
-				selectedUnitsHandler.AddUnit(unit);
+				units.push_back(unit);
 		}
 	}
 
+	SelectUnits(units, luaL_optboolean(L, 2, false));
 	return 0;
 }
 
@@ -897,9 +914,8 @@ int LuaUnsyncedCtrl::SelectUnitMap(lua_State* L)
 	if (!lua_istable(L, 1))
 		luaL_error(L, "[%s] incorrect arguments", __func__);
 
-	// clear the current units, unless the append flag is present
-	if (!luaL_optboolean(L, 2, false))
-		selectedUnitsHandler.ClearSelected();
+	std::vector<CUnit*>& units = selectUnitsBuffer;
+	units.clear();
 
 	constexpr int tableIdx = 1;
 	for (lua_pushnil(L); lua_next(L, tableIdx) != 0; lua_pop(L, 1)) {
@@ -907,10 +923,11 @@ int LuaUnsyncedCtrl::SelectUnitMap(lua_State* L)
 			CUnit* unit = ParseSelectUnit(L, __func__, -2); // the key
 
 			if (unit != nullptr)
-				selectedUnitsHandler.AddUnit(unit);
+				units.push_back(unit);
 		}
 	}
 
+	SelectUnits(units, luaL_optboolean(L, 2, false));
 	return 0;
 }
 
@@ -1978,6 +1995,7 @@ int LuaUnsyncedCtrl::SetActiveCommand(lua_State* L)
 int LuaUnsyncedCtrl::LoadCmdColorsConfig(lua_State* L)
 {
 	cmdColors.LoadConfigFromString(luaL_checkstring(L, 1));
+	commandDrawer->InvalidatePaths();
 	return 0;
 }
 
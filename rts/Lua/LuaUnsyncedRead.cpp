@@ -48,6 +48,9 @@
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/ResourceHandler.h"
+#include "Sim/Misc/ResourceMapAnalyzer.h"
+#include "Sim/Path/IPathManager.h"
 #include "Sim/Projectiles/Projectile.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitHandler.h"
@@ -185,6 +188,8 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetFPS);
 	REGISTER_LUA_CFUNC(GetGameSpeed);
 	REGISTER_LUA_CFUNC(GetGameState);
+	REGISTER_LUA_CFUNC(GetPathStats);
+	REGISTER_LUA_CFUNC(GetResourceMapSpots);
 
 	REGISTER_LUA_CFUNC(GetActiveCommand);
 	REGISTER_LUA_CFUNC(GetDefaultCommand);
@@ -232,6 +237,7 @@ bool LuaUnsyncedRead::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(GetDrawSelectionInfo);
 
 	REGISTER_LUA_CFUNC(GetConfigParams);
+	REGISTER_LUA_CFUNC(GetConfigHandle);
 	REGISTER_LUA_CFUNC(GetConfigInt);
 	REGISTER_LUA_CFUNC(GetConfigFloat);
 	REGISTER_LUA_CFUNC(GetConfigString);
@@ -1928,6 +1934,74 @@ int LuaUnsyncedRead::GetGameState(lua_State* L)
 	return 4;
 }
 
+int LuaUnsyncedRead::GetPathStats(lua_State* L)
+{
+	const CPathRequestStats::Histograms& h = pathManager->GetPathRequestStats().GetHistograms();
+	const std::uint32_t n = std::max(h.numRecords, 1u);
+
+	// pushes {counts = {c1, ..., cN}, limits = {l1, ..., lN}} where li is the
+	// exclusive upper bound of bin i (math.huge for the last)
+	const auto PushHistogram = [&](const char* name, const std::array<std::uint32_t, CPathRequestStats::NUM_HIST_BINS>& bins, unsigned int shift) {
+		lua_pushstring(L, name);
+		lua_createtable(L, 0, 2);
+
+		lua_pushliteral(L, "counts");
+		lua_createtable(L, bins.size(), 0);
+		for (unsigned int i = 0; i < bins.size(); i++) {
+			lua_pushnumber(L, bins[i]);
+			lua_rawseti(L, -2, i + 1);
+		}
+		lua_rawset(L, -3);
+
+		lua_pushliteral(L, "limits");
+		lua_createtable(L, bins.size(), 0);
+		for (unsigned int i = 0; i < bins.size(); i++) {
+			lua_pushnumber(L, (i < (bins.size() - 1))? float(CPathRequestStats::GetHistBinLimit(i, shift)): std::numeric_limits<float>::infinity());
+			lua_rawseti(L, -2, i + 1);
+		}
+		lua_rawset(L, -3);
+
+		lua_rawset(L, -3);
+	};
+
+	lua_createtable(L, 0, 10);
+	HSTR_PUSH_NUMBER(L, "numRequests", h.numRecords);
+	HSTR_PUSH_NUMBER(L, "numFull", h.resultTypes[CPathRequestStats::RESULT_FULL]);
+	HSTR_PUSH_NUMBER(L, "numPartial", h.resultTypes[CPathRequestStats::RESULT_PARTIAL]);
+	HSTR_PUSH_NUMBER(L, "numFailed", h.resultTypes[CPathRequestStats::RESULT_FAILED]);
+	HSTR_PUSH_NUMBER(L, "avgQueueFrames", h.sumQueueFrames / float(n));
+	HSTR_PUSH_NUMBER(L, "avgSearchTime", h.sumSearchTimes / float(n));
+	HSTR_PUSH_NUMBER(L, "avgExpandedNodes", h.sumExpandedNodes / float(n));
+
+	PushHistogram("queueFrames", h.queueFrames, CPathRequestStats::QUEUE_BIN_SHIFT);
+	PushHistogram("searchTimes", h.searchTimes, CPathRequestStats::TIME_BIN_SHIFT);
+	PushHistogram("expandedNodes", h.expandedNodes, CPathRequestStats::NODE_BIN_SHIFT);
+	return 1;
+}
+
+
+int LuaUnsyncedRead::GetResourceMapSpots(lua_State* L)
+{
+	// the analysis is (disk-)cached, so not exposed to synced code
+	const CResourceMapAnalyzer* rma = resourceHandler->GetResourceMapAnalyzer(luaL_optint(L, 1, resourceHandler->GetMetalId()));
+
+	if (rma == nullptr)
+		return 0;
+
+	const std::vector<float3>& spots = rma->GetSpots();
+
+	// pushes {x1, y1, z1, x2, y2, z2, ...} with yi the spot's income
+	lua_createtable(L, spots.size() * 3, 0);
+
+	for (size_t i = 0; i < spots.size(); i++) {
+		lua_pushnumber(L, spots[i].x); lua_rawseti(L, -2, i * 3 + 1);
+		lua_pushnumber(L, spots[i].y); lua_rawseti(L, -2, i * 3 + 2);
+		lua_pushnumber(L, spots[i].z); lua_rawseti(L, -2, i * 3 + 3);
+	}
+
+	lua_pushnumber(L, rma->GetAverageIncome());
+	return 2;
+}
 
 /******************************************************************************/
 
@@ -2647,21 +2721,75 @@ int LuaUnsyncedRead::GetConfigParams(lua_State* L)
 	return 1;
 }
 
+// accepts either a key or a handle returned by GetConfigHandle
+static int ParseConfigHandle(lua_State* L)
+{
+	if (lua_type(L, 1) == LUA_TNUMBER) {
+		const int handle = lua_toint(L, 1);
+
+		if (handle < 0 || size_t(handle) >= ConfigVariable::GetNumMetaData())
+			luaL_error(L, "[%s] invalid config handle %d", __func__, handle);
+
+		return handle;
+	}
+
+	return (ConfigHandler::GetHandle(luaL_checkstring(L, 1)));
+}
+
+int LuaUnsyncedRead::GetConfigHandle(lua_State* L)
+{
+	const int handle = ConfigHandler::GetHandle(luaL_checkstring(L, 1));
+
+	if (handle < 0)
+		return 0;
+
+	lua_pushnumber(L, handle);
+	return 1;
+}
+
 int LuaUnsyncedRead::GetConfigInt(lua_State* L)
 {
-	lua_pushinteger(L, configHandler->GetIntSafe(luaL_checkstring(L, 1), luaL_optint(L, 2, 0)));
+	const int handle = ParseConfigHandle(L);
+	const int defValue = luaL_optint(L, 2, 0);
+
+	if (handle >= 0) {
+		lua_pushinteger(L, configHandler->IsSet(handle)? configHandler->GetInt(handle): defValue);
+	} else {
+		lua_pushinteger(L, configHandler->GetIntSafe(luaL_checkstring(L, 1), defValue));
+	}
+
 	return 1;
 }
 
 int LuaUnsyncedRead::GetConfigFloat(lua_State* L)
 {
-	lua_pushnumber(L, configHandler->GetFloatSafe(luaL_checkstring(L, 1), luaL_optfloat(L, 2, 0.0f)));
+	const int handle = ParseConfigHandle(L);
+	const float defValue = luaL_optfloat(L, 2, 0.0f);
+
+	if (handle >= 0) {
+		lua_pushnumber(L, configHandler->IsSet(handle)? configHandler->GetFloat(handle): defValue);
+	} else {
+		lua_pushnumber(L, configHandler->GetFloatSafe(luaL_checkstring(L, 1), defValue));
+	}
+
 	return 1;
 }
 
 int LuaUnsyncedRead::GetConfigString(lua_State* L)
 {
-	lua_pushsstring(L, configHandler->GetStringSafe(luaL_checkstring(L, 1), luaL_optstring(L, 2, "")));
+	const int handle = ParseConfigHandle(L);
+
+	if (handle < 0) {
+		lua_pushsstring(L, configHandler->GetStringSafe(luaL_checkstring(L, 1), luaL_optstring(L, 2, "")));
+		return 1;
+	}
+
+	if (configHandler->IsSet(handle)) {
+		lua_pushsstring(L, configHandler->GetString(handle));
+	} else {
+		lua_pushstring(L, luaL_optstring(L, 2, ""));
+	}
+
 	return 1;
 }
 
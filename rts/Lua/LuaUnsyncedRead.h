@@ -109,6 +109,8 @@ class LuaUnsyncedRead {
 		static int GetFPS(lua_State* L);
 		static int GetGameSpeed(lua_State* L);
 		static int GetGameState(lua_State* L);
+		static int GetPathStats(lua_State* L);
+		static int GetResourceMapSpots(lua_State* L);
 
 		static int GetMouseState(lua_State* L);
 		static int GetMouseCursor(lua_State* L);
@@ -162,6 +164,7 @@ class LuaUnsyncedRead {
 		static int GetDrawSelectionInfo(lua_State* L);
 
 		static int GetConfigParams(lua_State* L);
+		static int GetConfigHandle(lua_State* L);
 		static int GetConfigInt(lua_State* L);
 		static int GetConfigFloat(lua_State* L);
 		static int GetConfigString(lua_State* L);
@@ -5,10 +5,12 @@
 
 #include "LuaVFS.h"
 #include "LuaInclude.h"
+#include "LuaBytecodeCache.h"
 #include "LuaHandle.h"
 #include "LuaHashString.h"
 #include "LuaIO.h"
 #include "LuaUtils.h"
+#include "LuaVFSBuffer.h"
 #include "LuaZip.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/ArchiveScanner.h"
@@ -57,6 +59,8 @@ bool LuaVFS::PushCommon(lua_State* L)
 	HSTR_PUSH_CFUNC(L, "ZlibDecompress", ZlibDecompress);
 	HSTR_PUSH_CFUNC(L, "CalculateHash", CalculateHash);
 
+	LuaVFSBuffer::PushEntries(L);
+
 	return true;
 }
 
@@ -67,6 +71,7 @@ bool LuaVFS::PushSynced(lua_State* L)
 
 	HSTR_PUSH_CFUNC(L, "Include",    SyncInclude);
 	HSTR_PUSH_CFUNC(L, "LoadFile",   SyncLoadFile);
+	HSTR_PUSH_CFUNC(L, "LoadBuffer", SyncLoadBuffer);
 	HSTR_PUSH_CFUNC(L, "FileExists", SyncFileExists);
 	HSTR_PUSH_CFUNC(L, "DirList",    SyncDirList);
 	HSTR_PUSH_CFUNC(L, "SubDirs",    SyncSubDirs);
@@ -81,6 +86,7 @@ bool LuaVFS::PushUnsynced(lua_State* L)
 
 	HSTR_PUSH_CFUNC(L, "Include",             UnsyncInclude);
 	HSTR_PUSH_CFUNC(L, "LoadFile",            UnsyncLoadFile);
+	HSTR_PUSH_CFUNC(L, "LoadBuffer",          UnsyncLoadBuffer);
 	HSTR_PUSH_CFUNC(L, "FileExists",          UnsyncFileExists);
 	HSTR_PUSH_CFUNC(L, "DirList",             UnsyncDirList);
 	HSTR_PUSH_CFUNC(L, "SubDirs",             UnsyncSubDirs);
@@ -157,7 +163,7 @@ int LuaVFS::Include(lua_State* L, bool synced)
  		lua_error(L);
 	}
 
-	if ((luaError = luaL_loadbuffer(L, fileData.c_str(), fileData.size(), fileName.c_str())) != 0) {
+	if ((luaError = LuaBytecodeCache::LoadBuffer(L, fileData, fileName)) != 0) {
 		char buf[1024];
 		SNPRINTF(buf, sizeof(buf), "[LuaVFS::%s(synced=%d)][loadbuf] file=%s error=%i (%s) cenv=%d", __func__, synced, fileName.c_str(), luaError, lua_tostring(L, -1), hasCustomEnv);
 		lua_pushstring(L, buf);
@@ -234,6 +240,30 @@ int LuaVFS::UnsyncLoadFile(lua_State* L)
 }
 
 
+/******************************************************************************/
+
+int LuaVFS::LoadBuffer(lua_State* L, bool synced)
+{
+	const std::string fileName = luaL_checkstring(L, 1);
+
+	// same as LoadFile, but leaves the contents outside of Lua's string table
+	LuaVFSBuffer::PushNew(L, fileName, GetModes(L, 2, synced));
+	return 1;
+}
+
+
+int LuaVFS::SyncLoadBuffer(lua_State* L)
+{
+	return LoadBuffer(L, true);
+}
+
+
+int LuaVFS::UnsyncLoadBuffer(lua_State* L)
+{
+	return LoadBuffer(L, false);
+}
+
+
 /******************************************************************************/
 
 int LuaVFS::FileExists(lua_State* L, bool synced)
@@ -617,11 +647,15 @@ int LuaVFS::PackF32(lua_State* L) { return PackType<     float   >(L); }
 template <typename T>
 int UnpackType(lua_State* L)
 {
-	if (!lua_isstring(L, 1))
-		return 0;
+	size_t len = 0;
+	const char* str = reinterpret_cast<const char*>(LuaVFSBuffer::ToData(L, 1, &len));
+
+	if (str == nullptr) {
+		if (!lua_isstring(L, 1))
+			return 0;
 
-	size_t len;
-	const char* str = lua_tolstring(L, 1, &len);
+		str = lua_tolstring(L, 1, &len);
+	}
 
 	if (lua_isnumber(L, 2)) {
 		const int pos = lua_toint(L, 2);
@@ -637,8 +671,15 @@ int UnpackType(lua_State* L)
 	if (len < eSize)
 		return 0;
 
+	// buffer slices need not be aligned
+	const auto ReadValue = [&](size_t i) {
+		T value;
+		memcpy(&value, str + i * eSize, eSize);
+		return value;
+	};
+
 	if (!lua_isnumber(L, 3)) {
-		lua_pushnumber(L, *(reinterpret_cast<const T*>(str)));
+		lua_pushnumber(L, ReadValue(0));
 		return 1;
 	}
 
@@ -649,7 +690,7 @@ int UnpackType(lua_State* L)
 
 	lua_createtable(L, tableCount = std::min((int)maxCount, tableCount), 0);
 	for (int i = 0; i < tableCount; i++) {
-		lua_pushnumber(L, *(reinterpret_cast<const T*>(str) + i));
+		lua_pushnumber(L, ReadValue(i));
 		lua_rawseti(L, -2, (i + 1));
 	}
 	return 1;
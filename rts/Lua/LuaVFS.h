@@ -19,6 +19,7 @@ class LuaVFS {
 
 		static int Include(lua_State* L, bool synced);
 		static int LoadFile(lua_State* L, bool synced);
+		static int LoadBuffer(lua_State* L, bool synced);
 		static int FileExists(lua_State* L, bool synced);
 		static int DirList(lua_State* L, bool synced);
 		static int SubDirs(lua_State* L, bool synced);
@@ -28,12 +29,14 @@ class LuaVFS {
 
 		static int SyncInclude(lua_State* L);
 		static int SyncLoadFile(lua_State* L);
+		static int SyncLoadBuffer(lua_State* L);
 		static int SyncFileExists(lua_State* L);
 		static int SyncDirList(lua_State* L);
 		static int SyncSubDirs(lua_State* L);
 
 		static int UnsyncInclude(lua_State* L);
 		static int UnsyncLoadFile(lua_State* L);
+		static int UnsyncLoadBuffer(lua_State* L);
 		static int UnsyncFileExists(lua_State* L);
 		static int UnsyncDirList(lua_State* L);
 		static int UnsyncSubDirs(lua_State* L);
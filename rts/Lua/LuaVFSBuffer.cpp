@@ -0,0 +1,258 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+/**
+ * @class LuaVFSBuffer
+ *
+ * @brief A Lua userdatum holding the read-only contents of a VFS file
+ *
+ * Returned by VFS.LoadBuffer. Files that are stored uncompressed (raw files
+ * and stored archive members) are mapped, compressed members are decompressed
+ * once; in neither case are the contents copied into a Lua string. Slices
+ * share the storage of the buffer they were taken from, which is released
+ * when the last of them is collected or closed.
+ * Such a userdatum supports the following methods:
+ *  - #buffer        : size in bytes
+ *  - sub(i [, j])   : copies bytes i..j into a string (same indexing as string.sub)
+ *  - slice(i [, j]) : a new buffer for bytes i..j, without copying
+ *  - close()        : releases the storage, after this all methods raise an error
+ * and can be passed to the VFS.Unpack* functions in place of a string.
+ */
+
+#include "LuaVFSBuffer.h"
+#include "LuaInclude.h"
+#include "LuaHashString.h"
+#include "System/FileSystem/FileHandler.h"
+
+#include <algorithm>
+#include <memory>
+#include <new>
+#include <vector>
+
+
+static constexpr const char* METATABLE_NAME = "VFSBuffer";
+
+struct VFSBufferStorage {
+	VFSBufferStorage(): file("", "") {}
+
+	// owns the mapping or the decompressed archive member
+	CFileHandler file;
+	// only used if the file could be neither mapped nor buffered
+	std::vector<std::uint8_t> copy;
+
+	const std::uint8_t* data = nullptr;
+	size_t size = 0;
+};
+
+struct VFSBufferUserdata {
+	std::shared_ptr<const VFSBufferStorage> storage;
+
+	size_t offset;
+	size_t length;
+};
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+bool LuaVFSBuffer::PushEntries(lua_State* L)
+{
+	CreateMetatable(L);
+	return true;
+}
+
+
+bool LuaVFSBuffer::CreateMetatable(lua_State* L)
+{
+	luaL_newmetatable(L, METATABLE_NAME);
+
+	// metatable.__index = metatable
+	lua_pushvalue(L, -1);
+	lua_setfield(L, -2, "__index");
+
+	HSTR_PUSH_CFUNC(L, "__gc",       meta_gc);
+	HSTR_PUSH_CFUNC(L, "__len",      meta_len);
+	HSTR_PUSH_CFUNC(L, "__tostring", meta_tostring);
+	HSTR_PUSH_CFUNC(L, "close",      meta_close);
+	HSTR_PUSH_CFUNC(L, "sub",        meta_sub);
+	HSTR_PUSH_CFUNC(L, "slice",      meta_slice);
+
+	lua_pop(L, 1);
+	return true;
+}
+
+
+static VFSBufferUserdata* PushUserdata(lua_State* L, std::shared_ptr<const VFSBufferStorage> storage, size_t offset, size_t length)
+{
+	luaL_checkstack(L, 2, __func__);
+
+	void* mem = lua_newuserdata(L, sizeof(VFSBufferUserdata));
+	VFSBufferUserdata* udata = new (mem) VFSBufferUserdata{std::move(storage), offset, length};
+
+	luaL_getmetatable(L, METATABLE_NAME);
+	lua_setmetatable(L, -2);
+	return udata;
+}
+
+bool LuaVFSBuffer::PushNew(lua_State* L, const std::string& fileName, const std::string& vfsModes)
+{
+	std::shared_ptr<VFSBufferStorage> storage = std::make_shared<VFSBufferStorage>();
+	CFileHandler& file = storage->file;
+
+	file.OpenMapped(fileName, vfsModes);
+
+	if (!file.FileExists()) {
+		lua_pushnil(L);
+		return false;
+	}
+
+	if (file.IsMapped()) {
+		storage->data = file.GetMappedData();
+	} else if (file.IsBuffered()) {
+		storage->data = file.GetBuffer().data();
+	} else {
+		// plain stream, e.g. a file that failed to map
+		storage->copy.resize(file.FileSize());
+		storage->data = storage->copy.data();
+
+		if (file.Read(storage->copy.data(), file.FileSize()) != file.FileSize()) {
+			lua_pushnil(L);
+			return false;
+		}
+
+		file.Close();
+	}
+
+	storage->size = file.FileSize();
+
+	PushUserdata(L, std::move(storage), 0, file.FileSize());
+	return true;
+}
+
+
+static VFSBufferUserdata* ToUserdata(lua_State* L, int index)
+{
+	if (!lua_isuserdata(L, index) || !lua_getmetatable(L, index))
+		return nullptr;
+
+	luaL_getmetatable(L, METATABLE_NAME);
+
+	const bool isBuffer = lua_rawequal(L, -1, -2);
+
+	lua_pop(L, 2);
+
+	if (!isBuffer)
+		return nullptr;
+
+	return static_cast<VFSBufferUserdata*>(lua_touserdata(L, index));
+}
+
+static VFSBufferUserdata* CheckOpenBuffer(lua_State* L)
+{
+	VFSBufferUserdata* udata = static_cast<VFSBufferUserdata*>(luaL_checkudata(L, 1, METATABLE_NAME));
+
+	if (udata->storage == nullptr)
+		luaL_error(L, "buffer closed");
+
+	return udata;
+}
+
+// converts string.sub style indices into a [first, last) byte range
+static void CheckRange(lua_State* L, const VFSBufferUserdata* udata, size_t& first, size_t& last)
+{
+	const lua_Integer length = udata->length;
+
+	lua_Integer i = luaL_checkinteger(L, 2);
+	lua_Integer j = luaL_optinteger(L, 3, -1);
+
+	if (i < 0) i += (length + 1);
+	if (j < 0) j += (length + 1);
+
+	i = std::max(i, lua_Integer(1));
+	i = std::min(i, length + 1);
+	j = std::min(j, length);
+
+	first = i - 1;
+	last = std::max(j, i - 1);
+}
+
+
+const std::uint8_t* LuaVFSBuffer::ToData(lua_State* L, int index, size_t* size)
+{
+	const VFSBufferUserdata* udata = ToUserdata(L, index);
+
+	if (udata == nullptr || udata->storage == nullptr)
+		return nullptr;
+
+	*size = udata->length;
+	return (udata->storage->data + udata->offset);
+}
+
+
+/******************************************************************************/
+/******************************************************************************/
+
+int LuaVFSBuffer::meta_gc(lua_State* L)
+{
+	VFSBufferUserdata* udata = static_cast<VFSBufferUserdata*>(luaL_checkudata(L, 1, METATABLE_NAME));
+	udata->~VFSBufferUserdata();
+	return 0;
+}
+
+
+int LuaVFSBuffer::meta_len(lua_State* L)
+{
+	lua_pushnumber(L, CheckOpenBuffer(L)->length);
+	return 1;
+}
+
+
+int LuaVFSBuffer::meta_tostring(lua_State* L)
+{
+	const VFSBufferUserdata* udata = static_cast<const VFSBufferUserdata*>(luaL_checkudata(L, 1, METATABLE_NAME));
+
+	if (udata->storage == nullptr) {
+		lua_pushliteral(L, "VFSBuffer (closed)");
+	} else {
+		lua_pushfstring(L, "VFSBuffer (%d bytes)", int(udata->length));
+	}
+
+	return 1;
+}
+
+
+int LuaVFSBuffer::meta_close(lua_State* L)
+{
+	VFSBufferUserdata* udata = static_cast<VFSBufferUserdata*>(luaL_checkudata(L, 1, METATABLE_NAME));
+	udata->storage.reset();
+	udata->offset = 0;
+	udata->length = 0;
+	return 0;
+}
+
+
+int LuaVFSBuffer::meta_sub(lua_State* L)
+{
+	const VFSBufferUserdata* udata = CheckOpenBuffer(L);
+
+	size_t first = 0;
+	size_t last = 0;
+
+	CheckRange(L, udata, first, last);
+
+	lua_pushlstring(L, reinterpret_cast<const char*>(udata->storage->data + udata->offset + first), last - first);
+	return 1;
+}
+
+
+int LuaVFSBuffer::meta_slice(lua_State* L)
+{
+	const VFSBufferUserdata* udata = CheckOpenBuffer(L);
+
+	size_t first = 0;
+	size_t last = 0;
+
+	CheckRange(L, udata, first, last);
+
+	PushUserdata(L, udata->storage, udata->offset + first, last - first);
+	return 1;
+}
@@ -0,0 +1,31 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef LUA_VFS_BUFFER_H
+#define LUA_VFS_BUFFER_H
+
+#include <cstdint>
+#include <string>
+
+struct lua_State;
+
+
+class LuaVFSBuffer {
+public:
+	static bool PushEntries(lua_State* L);
+	/// pushes a buffer holding the contents of <fileName>, or nil if it can not be opened
+	static bool PushNew(lua_State* L, const std::string& fileName, const std::string& vfsModes);
+
+	/// returns the bytes of the buffer at <index> or nullptr if that is not a (open) buffer
+	static const std::uint8_t* ToData(lua_State* L, int index, size_t* size);
+
+private: // metatable methods
+	static bool CreateMetatable(lua_State* L);
+	static int meta_gc(lua_State* L);
+	static int meta_len(lua_State* L);
+	static int meta_tostring(lua_State* L);
+	static int meta_close(lua_State* L);
+	static int meta_sub(lua_State* L);
+	static int meta_slice(lua_State* L);
+};
+
+#endif /* LUA_VFS_BUFFER_H */
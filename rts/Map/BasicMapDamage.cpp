@@ -110,7 +110,7 @@ void CBasicMapDamage::Explosion(const float3& pos, float strength, float radius)
 	// figure out how much height to add to each square
 	for (int y = e.y1; y <= e.y2; ++y) {
 		for (int x = e.x1; x <= e.x2; ++x) {
-			const CSolidObject* so = groundBlockingObjectMap.GroundBlockedUnsafe(y * mapDims.mapx + x);
+			const CSolidObject* so = groundBlockingObjectMap.GroundBlockedUnsafe(x, y);
 
 			// do not change squares with buildings on them here
 			if (so != nullptr && so->blockHeightChanges) {
@@ -210,6 +210,62 @@ void CBasicMapDamage::Explosion(const float3& pos, float strength, float radius)
 			eb.tz2 = unit->mapPos.y + unit->zsize;
 		}
 	}
+
+	MergeExplosion();
+}
+
+void CBasicMapDamage::MergeExplosion()
+{
+	// rects are inclusive
+	const auto GetArea = [](const Explo& e) { return ((e.x2 - e.x1 + 1) * (e.y2 - e.y1 + 1)); };
+
+	Explo& e = explosionUpdateQueue.back();
+
+	// salvos produce many nearby craters before the next Update; every one
+	// queued since then still has its full lifetime left and read the same
+	// heightmap, so their deltas can be summed into a single set of squares
+	// as long as the union does not spread over more squares than the two
+	for (size_t i = explosionUpdateQueue.size() - 1; i > explUpdateQueueIdx; i--) {
+		Explo& m = explosionUpdateQueue[i - 1];
+
+		if (m.ttl != e.ttl)
+			break;
+
+		Explo u;
+		u.x1 = std::min(m.x1, e.x1);
+		u.x2 = std::max(m.x2, e.x2);
+		u.y1 = std::min(m.y1, e.y1);
+		u.y2 = std::max(m.y2, e.y2);
+
+		if (GetArea(u) > (GetArea(m) + GetArea(e)))
+			continue;
+
+		const unsigned int poolSize = explosionSquaresPool.size();
+		const unsigned int unionIdx = explSquaresPoolIdx;
+
+		for (int y = u.y1; y <= u.y2; ++y) {
+			for (int x = u.x1; x <= u.x2; ++x) {
+				float dif = 0.0f;
+
+				if (x >= m.x1 && x <= m.x2 && y >= m.y1 && y <= m.y2)
+					dif += explosionSquaresPool[(m.idx + (y - m.y1) * (m.x2 - m.x1 + 1) + (x - m.x1)) % poolSize];
+				if (x >= e.x1 && x <= e.x2 && y >= e.y1 && y <= e.y2)
+					dif += explosionSquaresPool[(e.idx + (y - e.y1) * (e.x2 - e.x1 + 1) + (x - e.x1)) % poolSize];
+
+				SetExplosionSquare(dif);
+			}
+		}
+
+		m.x1 = u.x1;
+		m.x2 = u.x2;
+		m.y1 = u.y1;
+		m.y2 = u.y2;
+		m.idx = unionIdx;
+		m.buildings.insert(m.buildings.end(), e.buildings.begin(), e.buildings.end());
+
+		explosionUpdateQueue.pop_back();
+		return;
+	}
 }
 
 void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
@@ -226,6 +282,73 @@ void CBasicMapDamage::RecalcArea(int x1, int x2, int y1, int y2)
 	}
 }
 
+void CBasicMapDamage::RecalcAreas(const std::vector<SRectangle>& rects)
+{
+	assert(dirtyRects.empty());
+
+	dirtyRects.insert(dirtyRects.end(), rects.begin(), rects.end());
+	RecalcDirtyRects();
+}
+
+
+void CBasicMapDamage::MergeDirtyRects()
+{
+	// rects are inclusive
+	const auto GetArea = [](const SRectangle& r) { return ((r.x2 - r.x1 + 1) * (r.z2 - r.z1 + 1)); };
+
+	// replace any two rects by their union as long as it does not cover
+	// more squares than the two would separately; overlapping craters of
+	// a barrage collapse into few rects without growing into empty space
+	for (bool merged = true; merged; ) {
+		merged = false;
+
+		for (size_t i = 0; i < dirtyRects.size(); i++) {
+			for (size_t j = i + 1; j < dirtyRects.size(); ) {
+				const SRectangle& a = dirtyRects[i];
+				const SRectangle& b = dirtyRects[j];
+				const SRectangle u = {std::min(a.x1, b.x1), std::min(a.z1, b.z1), std::max(a.x2, b.x2), std::max(a.z2, b.z2)};
+
+				if (GetArea(u) > (GetArea(a) + GetArea(b))) {
+					j++;
+					continue;
+				}
+
+				dirtyRects[i] = u;
+				dirtyRects[j] = dirtyRects.back();
+				dirtyRects.pop_back();
+
+				merged = true;
+			}
+		}
+	}
+}
+
+void CBasicMapDamage::RecalcDirtyRects()
+{
+	if (dirtyRects.empty())
+		return;
+
+	MergeDirtyRects();
+
+	for (const SRectangle& r: dirtyRects) {
+		readMap->UpdateHeightMapSynced(r);
+		featureHandler.TerrainChanged(r.x1, r.z1, r.x2, r.z2);
+	}
+	{
+		SCOPED_TIMER("Sim::BasicMapDamage::Los");
+		losHandler->UpdateHeightMapSynced(dirtyRects);
+	}
+	{
+		SCOPED_TIMER("Sim::BasicMapDamage::Path");
+
+		for (const SRectangle& r: dirtyRects) {
+			pathManager->TerrainChange(r.x1, r.z1, r.x2, r.z2, TERRAINCHANGE_DAMAGE_RECALCULATION);
+		}
+	}
+
+	dirtyRects.clear();
+}
+
 
 void CBasicMapDamage::Update()
 {
@@ -266,9 +389,11 @@ void CBasicMapDamage::Update()
 		if (e.ttl != 0)
 			continue;
 
-		RecalcArea(e.x1 - 1, e.x2 + 1, e.y1 - 1, e.y2 + 1);
+		dirtyRects.emplace_back(e.x1 - 1, e.y1 - 1, e.x2 + 1, e.y2 + 1);
 	}
 
+	RecalcDirtyRects();
+
 
 	// pop explosions that are no longer being processed
 	while (explUpdateQueueIdx < explosionUpdateQueue.size()) {
@@ -4,6 +4,7 @@
 #define _BASIC_MAP_DAMAGE_H
 
 #include "MapDamage.h"
+#include "System/Rectangle.h"
 
 #include <vector>
 
@@ -12,6 +13,7 @@ class CBasicMapDamage : public IMapDamage
 public:
 	void Explosion(const float3& pos, float strength, float radius) override;
 	void RecalcArea(int x1, int x2, int y1, int y2) override;
+	void RecalcAreas(const std::vector<SRectangle>& rects) override;
 	void TerrainTypeHardnessChanged(int ttIndex) override;
 	void TerrainTypeSpeedModChanged(int ttIndex) override;
 
@@ -21,6 +23,10 @@ public:
 	bool Disabled() const override { return false; }
 
 private:
+	void MergeExplosion();
+	void MergeDirtyRects();
+	void RecalcDirtyRects();
+
 	void SetExplosionSquare(float v) {
 		explosionSquaresPool[explSquaresPoolIdx] = v;
 
@@ -60,6 +66,9 @@ private:
 
 	std::vector<float> explosionSquaresPool;
 	std::vector<Explo> explosionUpdateQueue;
+	// areas of explosions that expired this frame (or of a RecalcAreas
+	// batch), recalculated together
+	std::vector<SRectangle> dirtyRects;
 
 	static constexpr unsigned int CRATER_TABLE_SIZE = 200;
 	static constexpr unsigned int EXPLOSION_LIFETIME = 10;
@@ -8,8 +8,14 @@
 #include "System/SpringMath.h"
 
 #include <cassert>
+#include <cmath>
 #include <limits>
 
+#if !defined(DEDICATED_NOSSE) && defined(__SSE2__)
+#define USE_SSE_GROUND_KERNELS
+#include <emmintrin.h>
+#endif
+
 #undef far // avoid collision with windef.h
 #undef near
 
@@ -69,6 +75,169 @@ static inline float InterpolateCornerHeight(float x, float z, const float* corne
 }
 
 
+#ifdef USE_SSE_GROUND_KERNELS
+// InterpolateCornerHeight for four positions, mirrors it operation by operation
+// s.t. results are bit-identical (sync-safety); returns false without writing
+// <heights> if any position lies on the right or bottom map edge, where the
+// scalar code only reads one of the triangles
+static inline bool InterpolateCornerHeights4(const float* xzs, float* heights, const float* cornerHeightMap)
+{
+	const __m128 xz0 = _mm_loadu_ps(xzs    );
+	const __m128 xz1 = _mm_loadu_ps(xzs + 4);
+
+	__m128 x = _mm_shuffle_ps(xz0, xz1, _MM_SHUFFLE(2, 0, 2, 0));
+	__m128 z = _mm_shuffle_ps(xz0, xz1, _MM_SHUFFLE(3, 1, 3, 1));
+
+	x = _mm_div_ps(_mm_min_ps(_mm_max_ps(x, _mm_setzero_ps()), _mm_set1_ps(float3::maxxpos)), _mm_set1_ps(SQUARE_SIZE));
+	z = _mm_div_ps(_mm_min_ps(_mm_max_ps(z, _mm_setzero_ps()), _mm_set1_ps(float3::maxzpos)), _mm_set1_ps(SQUARE_SIZE));
+
+	const __m128i ix = _mm_cvttps_epi32(x);
+	const __m128i iz = _mm_cvttps_epi32(z);
+
+	const __m128i xe = _mm_cmplt_epi32(ix, _mm_set1_epi32(mapDims.mapx));
+	const __m128i ze = _mm_cmplt_epi32(iz, _mm_set1_epi32(mapDims.mapy));
+
+	if (_mm_movemask_epi8(_mm_and_si128(xe, ze)) != 0xFFFF)
+		return false;
+
+	const __m128 dx = _mm_sub_ps(x, _mm_cvtepi32_ps(ix));
+	const __m128 dz = _mm_sub_ps(z, _mm_cvtepi32_ps(iz));
+
+	alignas(16) int ixs[4];
+	alignas(16) int izs[4];
+
+	_mm_store_si128(reinterpret_cast<__m128i*>(ixs), ix);
+	_mm_store_si128(reinterpret_cast<__m128i*>(izs), iz);
+
+	alignas(16) float h[4][4];
+
+	for (int i = 0; i < 4; i++) {
+		const int hs = ixs[i] + izs[i] * mapDims.mapxp1;
+
+		h[0][i] = cornerHeightMap[hs + 0                 ];
+		h[1][i] = cornerHeightMap[hs + 1                 ];
+		h[2][i] = cornerHeightMap[hs + 0 + mapDims.mapxp1];
+		h[3][i] = cornerHeightMap[hs + 1 + mapDims.mapxp1];
+	}
+
+	const __m128 h00 = _mm_load_ps(h[0]);
+	const __m128 h10 = _mm_load_ps(h[1]);
+	const __m128 h01 = _mm_load_ps(h[2]);
+	const __m128 h11 = _mm_load_ps(h[3]);
+
+	const __m128 one = _mm_set1_ps(1.0f);
+
+	// top-left and bottom-right triangles
+	const __m128 htl = _mm_add_ps(_mm_add_ps(h00, _mm_mul_ps(dx, _mm_sub_ps(h10, h00))), _mm_mul_ps(dz, _mm_sub_ps(h01, h00)));
+	const __m128 hbr = _mm_add_ps(_mm_add_ps(h11, _mm_mul_ps(_mm_sub_ps(one, dx), _mm_sub_ps(h01, h11))), _mm_mul_ps(_mm_sub_ps(one, dz), _mm_sub_ps(h10, h11)));
+	const __m128 tri = _mm_cmplt_ps(_mm_add_ps(dx, dz), one);
+
+	_mm_storeu_ps(heights, _mm_or_ps(_mm_and_ps(tri, htl), _mm_andnot_ps(tri, hbr)));
+	return true;
+}
+#endif
+
+
+// skips the squares of max-height blocks (see CReadMap::UpdateMaxHeightBlocks)
+// which the line passes above; a block is only skipped if no square inside it
+// could make LineGroundSquareCol report a collision, so results are unchanged
+class LineGroundBlockFilter {
+public:
+	LineGroundBlockFilter(const float3& from, const float3& to, bool synced): lineFrom(from), lineDir(to - from) {
+		// collision points are computed with some rounding error, allow for it
+		heightMargin = 1.0f + (std::fabs(from.y) + std::fabs(to.y)) * 0.0001f;
+
+		for (int level = 0; level < CReadMap::numMaxHeightLevels; level++) {
+			maxHeights[level] = readMap->GetSharedMaxHeightBlocks(synced, level);
+			numBlocksX[level] = CReadMap::GetNumMaxHeightBlocks(level).x;
+		}
+	}
+
+	bool SkipSquare(int xs, int zs) {
+		// LineGroundSquareCol does not test squares outside the map either
+		if (xs < 0 || zs < 0 || xs > mapDims.mapxm1 || zs > mapDims.mapym1)
+			return true;
+
+		if (cachedLevel >= 0) {
+			const int blockSize = CReadMap::GetMaxHeightBlockSize(cachedLevel);
+
+			if ((xs / blockSize) == cachedBlock.x && (zs / blockSize) == cachedBlock.y)
+				return cachedSkip;
+		}
+
+		// coarsest level first; the finest block is cached when nothing can be skipped
+		for (int level = CReadMap::numMaxHeightLevels - 1; level >= 0; level--) {
+			const int blockSize = CReadMap::GetMaxHeightBlockSize(level);
+			const int2 block = {xs / blockSize, zs / blockSize};
+
+			cachedLevel = level;
+			cachedBlock = block;
+			cachedSkip = LineAboveBlock(level, block);
+
+			if (cachedSkip)
+				return true;
+		}
+
+		return false;
+	}
+
+private:
+	static bool ClipSlab(float p, float d, float s0, float s1, float& t0, float& t1) {
+		if (d == 0.0f)
+			return (p >= s0 && p <= s1);
+
+		const float ta = (s0 - p) / d;
+		const float tb = (s1 - p) / d;
+
+		t0 = std::max(t0, std::min(ta, tb));
+		t1 = std::min(t1, std::max(ta, tb));
+		return (t0 <= t1);
+	}
+
+	bool LineAboveBlock(int level, int2 block) const {
+		const int blockSize = CReadMap::GetMaxHeightBlockSize(level);
+
+		// block grown by one square on each side; collision points can slightly
+		// leave the square they were computed for and the infinite line is used
+		// rather than the segment since the square tests do the same
+		const float x0 = (block.x * blockSize - 1) * SQUARE_SIZE;
+		const float z0 = (block.y * blockSize - 1) * SQUARE_SIZE;
+		const float x1 = ((block.x + 1) * blockSize + 1) * SQUARE_SIZE;
+		const float z1 = ((block.y + 1) * blockSize + 1) * SQUARE_SIZE;
+
+		float t0 = -std::numeric_limits<float>::infinity();
+		float t1 =  std::numeric_limits<float>::infinity();
+
+		if (!ClipSlab(lineFrom.x, lineDir.x, x0, x1, t0, t1))
+			return true;
+		if (!ClipSlab(lineFrom.z, lineDir.z, z0, z1, t0, t1))
+			return true;
+
+		// only possible for vertical lines, which never get here
+		if (std::isinf(t0) || std::isinf(t1))
+			return false;
+
+		const float minHeight = std::min(lineFrom.y + lineDir.y * t0, lineFrom.y + lineDir.y * t1);
+		const float maxHeight = maxHeights[level][block.y * numBlocksX[level] + block.x];
+
+		return (minHeight > (maxHeight + heightMargin));
+	}
+
+private:
+	float3 lineFrom;
+	float3 lineDir;
+
+	float heightMargin = 0.0f;
+
+	const float* maxHeights[CReadMap::numMaxHeightLevels];
+	int numBlocksX[CReadMap::numMaxHeightLevels];
+
+	int2 cachedBlock;
+	int cachedLevel = -1;
+	bool cachedSkip = false;
+};
+
+
 static inline float LineGroundSquareCol(
 	const float* heightmap,
 	const float3* normalmap,
@@ -261,6 +430,8 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 
 	bool stopTrace = false;
 
+	LineGroundBlockFilter blockFilter(from, to, synced);
+
 	if ((fsx == tsx) && (fsz == tsz)) {
 		// <from> and <to> are the same
 		const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, fsz);
@@ -276,10 +447,12 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		int zp = fsz;
 
 		for (unsigned int i = 0, n = Square(mapDims.mapyp1); (Square(i) <= n && zp != tsz); i++) {
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, zp);
+			if (!blockFilter.SkipSquare(fsx, zp)) {
+				const float ret = LineGroundSquareCol(hm, nm,  from, to,  fsx, zp);
 
-			if (ret >= 0.0f)
-				return (ret + skippedDist);
+				if (ret >= 0.0f)
+					return (ret + skippedDist);
+			}
 
 			zp += dirz;
 		}
@@ -292,10 +465,12 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 		int xp = fsx;
 
 		for (unsigned int i = 0, n = Square(mapDims.mapxp1); (Square(i) <= n && xp != tsx); i++) {
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  xp, fsz);
+			if (!blockFilter.SkipSquare(xp, fsz)) {
+				const float ret = LineGroundSquareCol(hm, nm,  from, to,  xp, fsz);
 
-			if (ret >= 0.0f)
-				return (ret + skippedDist);
+				if (ret >= 0.0f)
+					return (ret + skippedDist);
+			}
 
 			xp += dirx;
 		}
@@ -330,10 +505,12 @@ float CGround::LineGroundCol(float3 from, float3 to, bool synced)
 
 		for (unsigned int i = 0, n = Square(mapDims.mapxp1) + Square(mapDims.mapyp1); !stopTrace; i++) {
 			// test for collision with the ground-square triangles
-			const float ret = LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
+			if (!blockFilter.SkipSquare(curx, curz)) {
+				const float ret = LineGroundSquareCol(hm, nm,  from, to,  curx, curz);
 
-			if (ret >= 0.0f)
-				return (ret + skippedDist);
+				if (ret >= 0.0f)
+					return (ret + skippedDist);
+			}
 
 			// check if we reached the end already and need to stop the loop
 			const bool endReached = ((curx == tsx && curz == tsz) || (Square(i) > n));
@@ -452,6 +629,40 @@ float CGround::GetHeightReal(float x, float z, bool synced)
 	return InterpolateCornerHeight(x, z, readMap->GetSharedCornerHeightMap(synced));
 }
 
+void CGround::GetApproximateHeights(const float* xzs, float* heights, size_t n, bool synced)
+{
+	const float* heightMap = readMap->GetSharedCenterHeightMap(synced);
+
+	for (size_t i = 0; i < n; i++) {
+		const int xsquare = Clamp(int(xzs[i * 2 + 0]) / SQUARE_SIZE, 0, mapDims.mapxm1);
+		const int zsquare = Clamp(int(xzs[i * 2 + 1]) / SQUARE_SIZE, 0, mapDims.mapym1);
+
+		heights[i] = heightMap[zsquare * mapDims.mapx + xsquare];
+	}
+}
+
+void CGround::GetHeightsReal(const float* xzs, float* heights, size_t n, bool synced)
+{
+	const float* cornerHeightMap = readMap->GetSharedCornerHeightMap(synced);
+
+	size_t i = 0;
+
+	#ifdef USE_SSE_GROUND_KERNELS
+	for (; (i + 4) <= n; i += 4) {
+		if (InterpolateCornerHeights4(&xzs[i * 2], &heights[i], cornerHeightMap))
+			continue;
+
+		for (size_t j = i; j < (i + 4); j++) {
+			heights[j] = InterpolateCornerHeight(xzs[j * 2 + 0], xzs[j * 2 + 1], cornerHeightMap);
+		}
+	}
+	#endif
+
+	for (; i < n; i++) {
+		heights[i] = InterpolateCornerHeight(xzs[i * 2 + 0], xzs[i * 2 + 1], cornerHeightMap);
+	}
+}
+
 float CGround::GetOrigHeight(float x, float z)
 {
 	return InterpolateCornerHeight(x, z, readMap->GetOriginalHeightMapSynced());
@@ -467,6 +678,18 @@ const float3& CGround::GetNormal(float x, float z, bool synced)
 	return normalMap[xsquare + zsquare * mapDims.mapx];
 }
 
+void CGround::GetNormals(const float* xzs, float3* normals, size_t n, bool synced)
+{
+	const float3* normalMap = readMap->GetSharedCenterNormals(synced);
+
+	for (size_t i = 0; i < n; i++) {
+		const int xsquare = Clamp(int(xzs[i * 2 + 0]) / SQUARE_SIZE, 0, mapDims.mapxm1);
+		const int zsquare = Clamp(int(xzs[i * 2 + 1]) / SQUARE_SIZE, 0, mapDims.mapym1);
+
+		normals[i] = normalMap[xsquare + zsquare * mapDims.mapx];
+	}
+}
+
 const float3& CGround::GetNormalAboveWater(float x, float z, bool synced)
 {
 	if (GetHeightReal(x, z, synced) <= 0.0f)
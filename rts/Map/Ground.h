@@ -3,6 +3,8 @@
 #ifndef GROUND_H
 #define GROUND_H
 
+#include <cstddef>
+
 #include "System/float3.h"
 #include "System/type2.h"
 
@@ -24,6 +26,11 @@ public:
 	static const float3& GetNormalAboveWater(float x, float z, bool synced = true);
 	static float3 GetSmoothNormal(float x, float z, bool synced = true);
 
+	/// batched versions of the above, <xzs> holds <n> interleaved (x, z) pairs
+	static void GetApproximateHeights(const float* xzs, float* heights, size_t n, bool synced = true);
+	static void GetHeightsReal(const float* xzs, float* heights, size_t n, bool synced = true);
+	static void GetNormals(const float* xzs, float3* normals, size_t n, bool synced = true);
+
 	static float GetApproximateHeight(const float3& p, bool synced = true) { return (GetApproximateHeight(p.x, p.z, synced)); }
 	static float GetHeightAboveWater(const float3& p, bool synced = true) { return (GetHeightAboveWater(p.x, p.z, synced)); }
 	static float GetHeightReal(const float3& p, bool synced = true) { return (GetHeightReal(p.x, p.z, synced)); }
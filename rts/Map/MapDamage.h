@@ -4,6 +4,9 @@
 #define _MAP_DAMAGE_H_
 
 #include "System/float3.h"
+#include "System/Rectangle.h"
+
+#include <vector>
 
 class IMapDamage
 {
@@ -16,6 +19,12 @@ public:
 
 	virtual void Explosion(const float3& pos, float strength, float radius) = 0;
 	virtual void RecalcArea(int x1, int x2, int y1, int y2) = 0;
+	/// same as RecalcArea for each of <rects>, which may be merged first
+	virtual void RecalcAreas(const std::vector<SRectangle>& rects) {
+		for (const SRectangle& r: rects) {
+			RecalcArea(r.x1, r.x2, r.z1, r.z2);
+		}
+	}
 	virtual void TerrainTypeHardnessChanged(int ttIndex) {}
 	virtual void TerrainTypeSpeedModChanged(int ttIndex) {}
 
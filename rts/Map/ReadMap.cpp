@@ -3,13 +3,16 @@
 
 #include <cstdlib>
 #include <cstring> // memcpy
+#include <limits>
 
 #include "ReadMap.h"
 #include "MapDamage.h"
 #include "MapInfo.h"
 #include "MetalMap.h"
 #include "Rendering/Env/MapRendering.h"
+#include "Rendering/ShadowHandler.h"
 #include "SMF/SMFReadMap.h"
+#include "Sim/Misc/SmoothHeightMesh.h"
 #include "Game/LoadScreen.h"
 #include "System/bitops.h"
 #include "System/EventHandler.h"
@@ -29,8 +32,148 @@
 #include "Sim/Misc/LosHandler.h"
 #endif
 
+#if !defined(DEDICATED_NOSSE) && defined(__SSE2__)
+#define USE_SSE_HEIGHTMAP_KERNELS
+#include <emmintrin.h>
+#endif
+
 #define MAX_UHM_RECTS_PER_FRAME static_cast<size_t>(128)
 
+
+#ifdef USE_SSE_HEIGHTMAP_KERNELS
+// the kernels below process four squares at a time and mirror the scalar code
+// operation by operation (same association order, exact negation, no fused
+// multiply-add), s.t. their results are bit-identical to it (sync-safety)
+
+// math::isqrt (fastmath::isqrt2_nosse) for four values
+static inline __m128 ISqrt4(const __m128 x)
+{
+	const __m128 xh = _mm_mul_ps(_mm_set1_ps(0.5f), x);
+	const __m128 c = _mm_set1_ps(1.5f);
+
+	__m128 r = _mm_castsi128_ps(_mm_sub_epi32(_mm_set1_epi32(0x5f375a86), _mm_srai_epi32(_mm_castps_si128(x), 1)));
+
+	r = _mm_mul_ps(r, _mm_sub_ps(c, _mm_mul_ps(xh, _mm_mul_ps(r, r))));
+	r = _mm_mul_ps(r, _mm_sub_ps(c, _mm_mul_ps(xh, _mm_mul_ps(r, r))));
+	return r;
+}
+
+// float3::SafeNormalize for four vectors
+static inline void SafeNormalize4(__m128& x, __m128& y, __m128& z)
+{
+	const __m128 sql = _mm_add_ps(_mm_add_ps(_mm_mul_ps(x, x), _mm_mul_ps(y, y)), _mm_mul_ps(z, z));
+	const __m128 msk = _mm_cmpgt_ps(sql, _mm_set1_ps(float3::nrm_eps()));
+	const __m128 scl = _mm_or_ps(_mm_and_ps(msk, ISqrt4(sql)), _mm_andnot_ps(msk, _mm_set1_ps(1.0f)));
+
+	x = _mm_mul_ps(x, scl);
+	y = _mm_mul_ps(y, scl);
+	z = _mm_mul_ps(z, scl);
+}
+
+static inline void UpdateCenterHeights4(const float* hmRowT, const float* hmRowB, float* centerHeights)
+{
+	const __m128 hTL = _mm_loadu_ps(hmRowT    );
+	const __m128 hTR = _mm_loadu_ps(hmRowT + 1);
+	const __m128 hBL = _mm_loadu_ps(hmRowB    );
+	const __m128 hBR = _mm_loadu_ps(hmRowB + 1);
+
+	_mm_storeu_ps(centerHeights, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(hTL, hTR), hBL), hBR), _mm_set1_ps(0.25f)));
+}
+
+// reads eight values from each row, writes four
+static inline void UpdateMipHeights4(const float* mipRowT, const float* mipRowB, float* subMipHeights)
+{
+	const __m128 t0 = _mm_loadu_ps(mipRowT    );
+	const __m128 t1 = _mm_loadu_ps(mipRowT + 4);
+	const __m128 b0 = _mm_loadu_ps(mipRowB    );
+	const __m128 b1 = _mm_loadu_ps(mipRowB + 4);
+
+	const __m128 hTL = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(2, 0, 2, 0));
+	const __m128 hTR = _mm_shuffle_ps(t0, t1, _MM_SHUFFLE(3, 1, 3, 1));
+	const __m128 hBL = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(2, 0, 2, 0));
+	const __m128 hBR = _mm_shuffle_ps(b0, b1, _MM_SHUFFLE(3, 1, 3, 1));
+
+	_mm_storeu_ps(subMipHeights, _mm_mul_ps(_mm_add_ps(_mm_add_ps(_mm_add_ps(hTL, hBL), hTR), hBR), _mm_set1_ps(0.25f)));
+}
+
+static inline void UpdateFaceNormals4(
+	const float* hmRowT,
+	const float* hmRowB,
+	float3* faceNormals,
+	float3* centerNormals,
+	float3* centerNormals2D
+) {
+	const __m128 sgn = _mm_set1_ps(-0.0f);
+
+	const __m128 hTL = _mm_loadu_ps(hmRowT    );
+	const __m128 hTR = _mm_loadu_ps(hmRowT + 1);
+	const __m128 hBL = _mm_loadu_ps(hmRowB    );
+	const __m128 hBR = _mm_loadu_ps(hmRowB + 1);
+
+	__m128 tlx = _mm_xor_ps(_mm_sub_ps(hTR, hTL), sgn);
+	__m128 tly = _mm_set1_ps(SQUARE_SIZE);
+	__m128 tlz = _mm_xor_ps(_mm_sub_ps(hBL, hTL), sgn);
+	__m128 brx = _mm_sub_ps(hBL, hBR);
+	__m128 bry = _mm_set1_ps(SQUARE_SIZE);
+	__m128 brz = _mm_sub_ps(hTR, hBR);
+
+	SafeNormalize4(tlx, tly, tlz);
+	SafeNormalize4(brx, bry, brz);
+
+	__m128 cnx = _mm_add_ps(tlx, brx);
+	__m128 cny = _mm_add_ps(tly, bry);
+	__m128 cnz = _mm_add_ps(tlz, brz);
+	__m128 c2x = cnx;
+	__m128 c2y = _mm_setzero_ps();
+	__m128 c2z = cnz;
+
+	SafeNormalize4(cnx, cny, cnz);
+	SafeNormalize4(c2x, c2y, c2z);
+
+	alignas(16) float v[12][4];
+
+	_mm_store_ps(v[ 0], tlx); _mm_store_ps(v[ 1], tly); _mm_store_ps(v[ 2], tlz);
+	_mm_store_ps(v[ 3], brx); _mm_store_ps(v[ 4], bry); _mm_store_ps(v[ 5], brz);
+	_mm_store_ps(v[ 6], cnx); _mm_store_ps(v[ 7], cny); _mm_store_ps(v[ 8], cnz);
+	_mm_store_ps(v[ 9], c2x); _mm_store_ps(v[10], c2y); _mm_store_ps(v[11], c2z);
+
+	for (int i = 0; i < 4; i++) {
+		faceNormals[i * 2    ] = {v[0][i], v[ 1][i], v[ 2][i]};
+		faceNormals[i * 2 + 1] = {v[3][i], v[ 4][i], v[ 5][i]};
+		centerNormals[i]       = {v[6][i], v[ 7][i], v[ 8][i]};
+		centerNormals2D[i]     = {v[9][i], v[10][i], v[11][i]};
+	}
+}
+
+// <faceNormals> points to the first face of the top-left square
+static inline void UpdateSlopes4(const float3* faceNormals, const int mapx, float* slopes)
+{
+	const float3* fnRow0 = faceNormals;
+	const float3* fnRow1 = faceNormals + mapx * 2;
+
+	__m128 avgslope = _mm_setzero_ps();
+	__m128 maxslope = _mm_setzero_ps();
+
+	// face-normal y-components of the 2x2 squares per slope-square, in the scalar order
+	for (int j = 0; j < 8; j++) {
+		const float3* fns = (j < 4)? fnRow0: fnRow1;
+		const int k = j & 3;
+
+		const __m128 fny = _mm_setr_ps(fns[k].y, fns[k + 4].y, fns[k + 8].y, fns[k + 12].y);
+
+		avgslope = _mm_add_ps(avgslope, fny);
+		maxslope = (j == 0)? fny: _mm_min_ps(fny, maxslope);
+	}
+
+	avgslope = _mm_mul_ps(avgslope, _mm_set1_ps(0.125f));
+
+	const __m128 lerp = _mm_div_ps(maxslope, avgslope);
+	const __m128 slope = _mm_add_ps(maxslope, _mm_mul_ps(_mm_sub_ps(avgslope, maxslope), lerp));
+
+	_mm_storeu_ps(slopes, _mm_sub_ps(_mm_set1_ps(1.0f), slope));
+}
+#endif
+
 //////////////////////////////////////////////////////////////////////
 // Construction/Destruction
 //////////////////////////////////////////////////////////////////////
@@ -71,6 +214,7 @@ CR_REG_METADATA(CReadMap, (
 	CR_IGNORED(mipCenterHeightMaps),
 	*/
 	CR_IGNORED(mipPointerHeightMaps),
+	CR_IGNORED(maxHeightBlocks),
 	/*
 	CR_IGNORED(visVertexNormals),
 	CR_IGNORED(faceNormalsSynced),
@@ -112,6 +256,7 @@ MapDimensions mapDims;
 std::vector<float> CReadMap::originalHeightMap;
 std::vector<float> CReadMap::centerHeightMap;
 std::array<std::vector<float>, CReadMap::numHeightMipMaps - 1> CReadMap::mipCenterHeightMaps;
+std::array<std::vector<float>, CReadMap::numMaxHeightLevels> CReadMap::maxHeightBlocks[2];
 
 std::vector<float3> CReadMap::visVertexNormals;
 std::vector<float3> CReadMap::faceNormalsSynced;
@@ -297,6 +442,10 @@ void CReadMap::Initialize()
 		for (int i = 1; i < numHeightMipMaps; i++) {
 			reqMemFootPrintKB += ((((mapDims.mapx >> i) * (mapDims.mapy >> i)) * sizeof(float)) / 1024);
 		}
+		// maxHeightBlocks[{0, 1}][i]
+		for (int i = 0; i < numMaxHeightLevels; i++) {
+			reqMemFootPrintKB += ((GetNumMaxHeightBlocks(i).x * GetNumMaxHeightBlocks(i).y * 2 * sizeof(float)) / 1024);
+		}
 
 		sprintf(loadMsg, fmtString, reqMemFootPrintKB / 1024);
 		loadscreen->SetLoadMessage(loadMsg);
@@ -327,6 +476,15 @@ void CReadMap::Initialize()
 		mipPointerHeightMaps[i] = &mipCenterHeightMaps[i - 1][0];
 	}
 
+	for (int i = 0; i < numMaxHeightLevels; i++) {
+		const int2 numBlocks = GetNumMaxHeightBlocks(i);
+
+		maxHeightBlocks[0][i].clear();
+		maxHeightBlocks[0][i].resize(numBlocks.x * numBlocks.y);
+		maxHeightBlocks[1][i].clear();
+		maxHeightBlocks[1][i].resize(numBlocks.x * numBlocks.y);
+	}
+
 	slopeMap.clear();
 	slopeMap.resize(mapDims.hmapx * mapDims.hmapy);
 
@@ -425,6 +583,9 @@ void CReadMap::UpdateDraw(bool firstCall)
 	if (unsyncedHeightMapUpdates.empty())
 		return;
 
+	// terrain is part of the cached static shadow-caster layer
+	shadowHandler.InvalidateStaticCasters();
+
 	#if 0
 	static CRectangleOverlapHandler unsyncedHeightMapUpdatesSwap;
 
@@ -470,7 +631,14 @@ void CReadMap::UpdateDraw(bool firstCall)
 
 	// TODO: quadtree or whatever
 	for (size_t i = 0, n = std::min(MAX_UHM_RECTS_PER_FRAME, unsyncedHeightMapUpdates.size()); i < n; i++) {
-		UpdateHeightMapUnsynced(*(unsyncedHeightMapUpdates.begin() + i));
+		const SRectangle& rect = *(unsyncedHeightMapUpdates.begin() + i);
+
+		UpdateHeightMapUnsynced(rect);
+
+		#ifdef USE_UNSYNCED_HEIGHTMAP
+		// unsynced corner heights are copied over (x1 - 1, z1 - 1) - (x2 + 1, z2 + 1)
+		UpdateMaxHeightBlocks({rect.x1 - 1, rect.z1 - 1, rect.x2 + 1, rect.z2 + 1}, false);
+		#endif
 	}
 
 	for (size_t i = 0, n = std::min(MAX_UHM_RECTS_PER_FRAME, unsyncedHeightMapUpdates.size()); i < n; i++) {
@@ -490,6 +658,8 @@ void CReadMap::UpdateHeightMapSynced(const SRectangle& hgtMapRect, bool initiali
 	if (hgtMapRect.GetArea() <= 0)
 		return;
 
+	syncedHeightMapVersion += 1;
+
 	const int2 mins = {hgtMapRect.x1 - 1, hgtMapRect.z1 - 1};
 	const int2 maxs = {hgtMapRect.x2 + 1, hgtMapRect.z2 + 1};
 
@@ -505,6 +675,18 @@ void CReadMap::UpdateHeightMapSynced(const SRectangle& hgtMapRect, bool initiali
 	UpdateMipHeightmaps(centerRect, initialize);
 	UpdateFaceNormals(centerRect, initialize);
 	UpdateSlopemap(centerRect, initialize); // must happen after UpdateFaceNormals()!
+	UpdateMaxHeightBlocks(cornerRect, true);
+
+	#ifdef USE_UNSYNCED_HEIGHTMAP
+	// both heightmaps start out equal, afterwards the unsynced one changes in UpdateDraw
+	if (initialize)
+		UpdateMaxHeightBlocks(cornerRect, false);
+	#else
+	UpdateMaxHeightBlocks(cornerRect, false);
+	#endif
+
+	// no-op while initializing, the smooth mesh is built after the map
+	smoothGround.UpdateSmoothMesh(cornerRect);
 
 	#ifdef USE_UNSYNCED_HEIGHTMAP
 	// push the unsynced update; initial one without LOS check
@@ -541,7 +723,15 @@ void CReadMap::UpdateCenterHeightmap(const SRectangle& rect, bool initialize)
 	const float* heightmapSynced = GetCornerHeightMapSynced();
 
 	for (int y = rect.z1; y <= rect.z2; y++) {
-		for (int x = rect.x1; x <= rect.x2; x++) {
+		int x = rect.x1;
+
+		#ifdef USE_SSE_HEIGHTMAP_KERNELS
+		for (; (x + 3) <= rect.x2; x += 4) {
+			UpdateCenterHeights4(&heightmapSynced[y * mapDims.mapxp1 + x], &heightmapSynced[(y + 1) * mapDims.mapxp1 + x], &centerHeightMap[y * mapDims.mapx + x]);
+		}
+		#endif
+
+		for (; x <= rect.x2; x++) {
 			const int idxTL = (y    ) * mapDims.mapxp1 + x;
 			const int idxTR = (y    ) * mapDims.mapxp1 + x + 1;
 			const int idxBL = (y + 1) * mapDims.mapxp1 + x;
@@ -572,7 +762,15 @@ void CReadMap::UpdateMipHeightmaps(const SRectangle& rect, bool initialize)
 		float* subMipMap = mipPointerHeightMaps[i + 1];
 
 		for (int y = sy; y < ey; y += 2) {
-			for (int x = sx; x < ex; x += 2) {
+			int x = sx;
+
+			#ifdef USE_SSE_HEIGHTMAP_KERNELS
+			for (; (x + 6) < ex; x += 8) {
+				UpdateMipHeights4(&topMipMap[x + y * hmapx], &topMipMap[x + (y + 1) * hmapx], &subMipMap[(x / 2) + (y / 2) * hmapx / 2]);
+			}
+			#endif
+
+			for (; x < ex; x += 2) {
 				const float height =
 					topMipMap[(x    ) + (y    ) * hmapx] +
 					topMipMap[(x    ) + (y + 1) * hmapx] +
@@ -594,57 +792,76 @@ void CReadMap::UpdateFaceNormals(const SRectangle& rect, bool initialize)
 	const int z2 = std::min(mapDims.mapym1, rect.z2 + 1);
 	const int x2 = std::min(mapDims.mapxm1, rect.x2 + 1);
 
-	for_mt(z1, z2+1, [&](const int y) {
-		float3 fnTL;
-		float3 fnBR;
-
-		for (int x = x1; x <= x2; x++) {
-			const int idxTL = (y    ) * mapDims.mapxp1 + x; // TL
-			const int idxBL = (y + 1) * mapDims.mapxp1 + x; // BL
-
-			const float& hTL = heightmapSynced[idxTL    ];
-			const float& hTR = heightmapSynced[idxTL + 1];
-			const float& hBL = heightmapSynced[idxBL    ];
-			const float& hBR = heightmapSynced[idxBL + 1];
-
-			// normal of top-left triangle (face) in square
-			//
-			//  *---> e1
-			//  |
-			//  |
-			//  v
-			//  e2
-			//const float3 e1( SQUARE_SIZE, hTR - hTL,           0);
-			//const float3 e2(           0, hBL - hTL, SQUARE_SIZE);
-			//const float3 fnTL = (e2.cross(e1)).Normalize();
-			fnTL.y = SQUARE_SIZE;
-			fnTL.x = - (hTR - hTL);
-			fnTL.z = - (hBL - hTL);
-			fnTL.Normalize();
-
-			// normal of bottom-right triangle (face) in square
-			//
-			//         e3
-			//         ^
-			//         |
-			//         |
-			//  e4 <---*
-			//const float3 e3(-SQUARE_SIZE, hBL - hBR,           0);
-			//const float3 e4(           0, hTR - hBR,-SQUARE_SIZE);
-			//const float3 fnBR = (e4.cross(e3)).Normalize();
-			fnBR.y = SQUARE_SIZE;
-			fnBR.x = (hBL - hBR);
-			fnBR.z = (hTR - hBR);
-			fnBR.Normalize();
-
-			faceNormalsSynced[(y * mapDims.mapx + x) * 2    ] = fnTL;
-			faceNormalsSynced[(y * mapDims.mapx + x) * 2 + 1] = fnBR;
-			// square-normal
-			centerNormalsSynced[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize();
-			centerNormals2D[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize2D();
+	for_mt_range(z1, z2+1, 0, [&](const int lo, const int hi) {
+		for (int y = lo; y < hi; y++) {
+			float3 fnTL;
+			float3 fnBR;
+
+			int x = x1;
+
+			#ifdef USE_SSE_HEIGHTMAP_KERNELS
+			for (; (x + 3) <= x2; x += 4) {
+				UpdateFaceNormals4(
+					&heightmapSynced[(y    ) * mapDims.mapxp1 + x],
+					&heightmapSynced[(y + 1) * mapDims.mapxp1 + x],
+					&faceNormalsSynced[(y * mapDims.mapx + x) * 2],
+					&centerNormalsSynced[y * mapDims.mapx + x],
+					&centerNormals2D[y * mapDims.mapx + x]
+				);
+			}
+			#endif
+
+			for (; x <= x2; x++) {
+				const int idxTL = (y    ) * mapDims.mapxp1 + x; // TL
+				const int idxBL = (y + 1) * mapDims.mapxp1 + x; // BL
+
+				const float& hTL = heightmapSynced[idxTL    ];
+				const float& hTR = heightmapSynced[idxTL + 1];
+				const float& hBL = heightmapSynced[idxBL    ];
+				const float& hBR = heightmapSynced[idxBL + 1];
+
+				// normal of top-left triangle (face) in square
+				//
+				//  *---> e1
+				//  |
+				//  |
+				//  v
+				//  e2
+				//const float3 e1( SQUARE_SIZE, hTR - hTL,           0);
+				//const float3 e2(           0, hBL - hTL, SQUARE_SIZE);
+				//const float3 fnTL = (e2.cross(e1)).Normalize();
+				fnTL.y = SQUARE_SIZE;
+				fnTL.x = - (hTR - hTL);
+				fnTL.z = - (hBL - hTL);
+				fnTL.Normalize();
+
+				// normal of bottom-right triangle (face) in square
+				//
+				//         e3
+				//         ^
+				//         |
+				//         |
+				//  e4 <---*
+				//const float3 e3(-SQUARE_SIZE, hBL - hBR,           0);
+				//const float3 e4(           0, hTR - hBR,-SQUARE_SIZE);
+				//const float3 fnBR = (e4.cross(e3)).Normalize();
+				fnBR.y = SQUARE_SIZE;
+				fnBR.x = (hBL - hBR);
+				fnBR.z = (hTR - hBR);
+				fnBR.Normalize();
+
+				faceNormalsSynced[(y * mapDims.mapx + x) * 2    ] = fnTL;
+				faceNormalsSynced[(y * mapDims.mapx + x) * 2 + 1] = fnBR;
+				// square-normal
+				centerNormalsSynced[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize();
+				centerNormals2D[y * mapDims.mapx + x] = (fnTL + fnBR).Normalize2D();
+			}
 
 			#ifdef USE_UNSYNCED_HEIGHTMAP
-			if (initialize) {
+			if (!initialize)
+				continue;
+
+			for (x = x1; x <= x2; x++) {
 				faceNormalsUnsynced[(y * mapDims.mapx + x) * 2    ] = faceNormalsSynced[(y * mapDims.mapx + x) * 2    ];
 				faceNormalsUnsynced[(y * mapDims.mapx + x) * 2 + 1] = faceNormalsSynced[(y * mapDims.mapx + x) * 2 + 1];
 				centerNormalsUnsynced[y * mapDims.mapx + x] = centerNormalsSynced[y * mapDims.mapx + x];
@@ -655,6 +872,58 @@ void CReadMap::UpdateFaceNormals(const SRectangle& rect, bool initialize)
 }
 
 
+int2 CReadMap::GetNumMaxHeightBlocks(int level)
+{
+	const int blockSize = GetMaxHeightBlockSize(level);
+	return {(mapDims.mapx + blockSize - 1) / blockSize, (mapDims.mapy + blockSize - 1) / blockSize};
+}
+
+void CReadMap::UpdateMaxHeightBlocks(const SRectangle& cornerRect, bool synced)
+{
+	const float* heightMap = GetSharedCornerHeightMap(synced);
+
+	for (int level = 0; level < numMaxHeightLevels; level++) {
+		const int blockSize = GetMaxHeightBlockSize(level);
+		const int2 numBlocks = GetNumMaxHeightBlocks(level);
+
+		// block b covers corners [b * blockSize, (b + 1) * blockSize], so
+		// corners on a block border belong to both neighbouring blocks
+		const int bx1 = std::max(cornerRect.x1 - 1, 0) / blockSize;
+		const int bz1 = std::max(cornerRect.z1 - 1, 0) / blockSize;
+		const int bx2 = std::min(std::min(cornerRect.x2, mapDims.mapx) / blockSize, numBlocks.x - 1);
+		const int bz2 = std::min(std::min(cornerRect.z2, mapDims.mapy) / blockSize, numBlocks.y - 1);
+
+		float* blocks = &maxHeightBlocks[synced][level][0];
+
+		for (int bz = bz1; bz <= bz2; bz++) {
+			for (int bx = bx1; bx <= bx2; bx++) {
+				float maxHeight = std::numeric_limits<float>::lowest();
+
+				if (level == 0) {
+					for (int z = bz * blockSize, ze = std::min((bz + 1) * blockSize, mapDims.mapy); z <= ze; z++) {
+						for (int x = bx * blockSize, xe = std::min((bx + 1) * blockSize, mapDims.mapx); x <= xe; x++) {
+							maxHeight = std::max(maxHeight, heightMap[z * mapDims.mapxp1 + x]);
+						}
+					}
+				} else {
+					// union of the corner ranges of the (up to) 4x4 child blocks
+					const int2 numSubBlocks = GetNumMaxHeightBlocks(level - 1);
+					const float* subBlocks = &maxHeightBlocks[synced][level - 1][0];
+
+					for (int z = bz * 4, ze = std::min(bz * 4 + 3, numSubBlocks.y - 1); z <= ze; z++) {
+						for (int x = bx * 4, xe = std::min(bx * 4 + 3, numSubBlocks.x - 1); x <= xe; x++) {
+							maxHeight = std::max(maxHeight, subBlocks[z * numSubBlocks.x + x]);
+						}
+					}
+				}
+
+				blocks[bz * numBlocks.x + bx] = maxHeight;
+			}
+		}
+	}
+}
+
+
 void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 {
 	const int sx = std::max(0,                 (rect.x1 / 2) - 1);
@@ -663,7 +932,15 @@ void CReadMap::UpdateSlopemap(const SRectangle& rect, bool initialize)
 	const int ey = std::min(mapDims.hmapy - 1, (rect.z2 / 2) + 1);
 
 	for (int y = sy; y <= ey; y++) {
-		for (int x = sx; x <= ex; x++) {
+		int x = sx;
+
+		#ifdef USE_SSE_HEIGHTMAP_KERNELS
+		for (; (x + 3) <= ex; x += 4) {
+			UpdateSlopes4(&faceNormalsSynced[((y * 2) * mapDims.mapx + x * 2) * 2], mapDims.mapx, &slopeMap[y * mapDims.hmapx + x]);
+		}
+		#endif
+
+		for (; x <= ex; x++) {
 			const int idx0 = (y*2    ) * (mapDims.mapx) + x*2;
 			const int idx1 = (y*2 + 1) * (mapDims.mapx) + x*2;
 
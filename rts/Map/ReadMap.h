@@ -183,6 +183,11 @@ public:
 	const float3* GetSharedCenterNormals(bool synced) const { return sharedCenterNormals[synced]; }
 	const float* GetSharedSlopeMap(bool synced) const { return sharedSlopeMaps[synced]; }
 
+	/// max corner-height per block of squares, row-major with GetNumMaxHeightBlocks(level).x blocks per row
+	const float* GetSharedMaxHeightBlocks(bool synced, int level) const { return &maxHeightBlocks[synced][level][0]; }
+	static int GetMaxHeightBlockSize(int level) { return (maxHeightBlockSize << (2 * level)); }
+	static int2 GetNumMaxHeightBlocks(int level);
+
 	/// if you modify the heightmap through these, call UpdateHeightMapSynced
 	float SetHeight(const int idx, const float h, const int add = 0);
 	float AddHeight(const int idx, const float a);
@@ -203,6 +208,8 @@ public:
 	bool HasOnlyVoidWater() const;
 
 	unsigned int GetMapChecksum() const { return mapChecksum; }
+	/// bumped by every synced heightmap change, for caches of terrain tests
+	unsigned int GetSyncedHeightMapVersion() const { return syncedHeightMapVersion; }
 	unsigned int CalcHeightmapChecksum();
 	unsigned int CalcTypemapChecksum();
 
@@ -211,6 +218,7 @@ private:
 	void UpdateMipHeightmaps(const SRectangle& rect, bool initialize);
 	void UpdateFaceNormals(const SRectangle& rect, bool initialize);
 	void UpdateSlopemap(const SRectangle& rect, bool initialize);
+	void UpdateMaxHeightBlocks(const SRectangle& cornerRect, bool synced);
 
 	inline void HeightMapUpdateLOSCheck(const SRectangle& hgtMapRect);
 	inline bool HasHeightMapChanged(const int2 losMapPos);
@@ -219,6 +227,12 @@ public:
 	/// number of heightmap mipmaps, including full resolution
 	static constexpr int numHeightMipMaps = 7;
 
+	/// number of levels of the max-height block pyramid (used to skip terrain
+	/// in LineGroundCol); a level-l block covers maxHeightBlockSize << (2 * l)
+	/// squares along each axis
+	static constexpr int numMaxHeightLevels = 3;
+	static constexpr int maxHeightBlockSize = 4;
+
 protected:
 	// these point to the actual heightmap data
 	// which is allocated by subclass instances
@@ -245,6 +259,8 @@ protected:
 	static std::vector<float3> centerNormalsSynced;   //< size:   mapx      *  mapy     , contains 1 interpolated normal per quad, same as (facenormal0+facenormal1).Normalize()) [SYNCED]
 	static std::vector<float3> centerNormalsUnsynced;
 
+	static std::array<std::vector<float>, numMaxHeightLevels> maxHeightBlocks[2]; //< [0] = unsynced, [1] = synced
+
 	static std::vector<float> slopeMap;               //< size: (mapx/2)    * (mapy/2)  , same as 1.0 - interpolate(centernomal[i]).y [SYNCED]
 	static std::vector<uint8_t> typeMap;
 	static std::vector<float3> centerNormals2D;
@@ -272,6 +288,7 @@ private:
 #endif
 
 	unsigned int mapChecksum = 0;
+	unsigned int syncedHeightMapVersion = 0;
 
 	float2 initHeightBounds; //< initial minimum- and maximum-height (before any deformations)
 	float2 currHeightBounds; //< current minimum- and maximum-height
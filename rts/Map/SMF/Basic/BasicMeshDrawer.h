@@ -23,7 +23,7 @@ public:
 
 public:
 	CBasicMeshDrawer(CSMFGroundDrawer* gd);
-	~CBasicMeshDrawer();
+	virtual ~CBasicMeshDrawer();
 
 	static constexpr int32_t PATCH_SIZE = 128; // must match SMFReadMap::bigSquareSize
 	static constexpr int32_t LOD_LEVELS =   8; // log2(PATCH_SIZE) + 1; 129x129 to 2x2
@@ -61,7 +61,7 @@ public:
 	void DrawMesh(const DrawPass::e& drawPass) override;
 	void DrawBorderMesh(const DrawPass::e& drawPass) override;
 
-private:
+protected:
 	void UploadPatchSquareGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm);
 	void UploadPatchBorderGeometry(uint32_t n, uint32_t px, uint32_t py, const float* chm, const float3* cnm);
 	void UploadPatchIndices(uint32_t n);
@@ -71,7 +71,7 @@ private:
 
 	uint32_t CalcDrawPassLOD(const CCamera* cam, const DrawPass::e& drawPass) const;
 
-private:
+protected:
 	uint32_t numPatchesX;
 	uint32_t numPatchesY;
 	uint32_t drawPassLOD;
@@ -0,0 +1,139 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "GPUMeshDrawer.h"
+#include "Map/HeightMapTexture.h"
+#include "Map/ReadMap.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/myGL.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Shaders/Shader.h"
+#include "System/Log/ILog.h"
+#include "System/TimeProfiler.h"
+
+
+CGPUMeshDrawer::CGPUMeshDrawer(CSMFGroundDrawer* gd): CBasicMeshDrawer(gd)
+{
+	// the base-class performed the initial CPU upload, later updates go through here
+	dirtyPatches.resize(numPatchesX * numPatchesY, 0);
+
+	#define sh shaderHandler
+	meshGenShader = sh->CreateProgramObject("[GPUMeshDrawer]", "SMFMeshGenShader");
+	meshGenShader->AttachShaderObject(sh->CreateShaderObject("GLSL/SMFMeshGenVertProg.glsl", "", GL_VERTEX_SHADER));
+	meshGenShader->SetFlag("SQUARE_SIZE", float(SQUARE_SIZE));
+	static_cast<Shader::GLSLProgramObject*>(meshGenShader)->SetFeedbackVaryings({"vertexPos"});
+	meshGenShader->Link();
+	meshGenShader->Enable();
+	meshGenShader->SetUniform("heightMapTex", 0);
+	meshGenShader->Disable();
+	meshGenShader->Validate();
+	#undef sh
+
+	if (!meshGenShader->IsValid())
+		LOG_L(L_WARNING, "[GPUMeshDrawer::%s] failed to compile mesh-generation shader, falling back to CPU updates", __func__);
+
+	emptyArray.Generate();
+}
+
+CGPUMeshDrawer::~CGPUMeshDrawer()
+{
+	shaderHandler->ReleaseProgramObjects("[GPUMeshDrawer]");
+	emptyArray.Delete();
+}
+
+
+void CGPUMeshDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect)
+{
+	// called before the first frame for the entire map, the base-class
+	// constructor handles that (HeightMapTexture does not exist yet)
+	if (dirtyPatches.empty()) {
+		CBasicMeshDrawer::UnsyncedHeightMapUpdate(rect);
+		return;
+	}
+
+	if (!meshGenShader->IsValid()) {
+		CBasicMeshDrawer::UnsyncedHeightMapUpdate(rect);
+		return;
+	}
+
+	const uint32_t minPatchX = std::max(rect.x1 / PATCH_SIZE,    (              0));
+	const uint32_t minPatchY = std::max(rect.z1 / PATCH_SIZE,    (              0));
+	const uint32_t maxPatchX = std::min(rect.x2 / PATCH_SIZE, int(numPatchesX - 1));
+	const uint32_t maxPatchY = std::min(rect.z2 / PATCH_SIZE, int(numPatchesY - 1));
+
+	const float* heightMap = readMap->GetCornerHeightMapUnsynced();
+	const float3* normalMap = readMap->GetVisVertexNormalsUnsynced();
+
+	// HeightMapTexture receives this event after us, so only mark patches
+	// here and regenerate them in UpdateGeometry once the texture is current
+	for (uint32_t py = minPatchY; py <= maxPatchY; py += 1) {
+		for (uint32_t px = minPatchX; px <= maxPatchX; px += 1) {
+			numDirtyPatches += (1 - dirtyPatches[py * numPatchesX + px]);
+			dirtyPatches[py * numPatchesX + px] = 1;
+
+			// border strips are a handful of vertices and only exist for edge-patches
+			if (px != 0 && py != 0 && px != (numPatchesX - 1) && py != (numPatchesY - 1))
+				continue;
+
+			for (uint32_t n = 0; n < LOD_LEVELS; n += 1) {
+				UploadPatchBorderGeometry(n, px, py, heightMap, normalMap);
+			}
+		}
+	}
+}
+
+
+void CGPUMeshDrawer::UpdateGeometry()
+{
+	if (numDirtyPatches == 0)
+		return;
+	if (heightMapTexture == nullptr || heightMapTexture->GetTextureID() == 0)
+		return;
+
+	SCOPED_TIMER("Update::GPUMeshDrawer");
+
+	glEnable(GL_RASTERIZER_DISCARD);
+	glActiveTexture(GL_TEXTURE0);
+	glBindTexture(GL_TEXTURE_2D, heightMapTexture->GetTextureID());
+
+	meshGenShader->Enable();
+	emptyArray.Bind();
+
+	for (uint32_t py = 0; py < numPatchesY; py += 1) {
+		for (uint32_t px = 0; px < numPatchesX; px += 1) {
+			if (dirtyPatches[py * numPatchesX + px] == 0)
+				continue;
+
+			GenPatchSquareGeometry(px, py);
+			dirtyPatches[py * numPatchesX + px] = 0;
+		}
+	}
+
+	emptyArray.Unbind();
+	meshGenShader->Disable();
+
+	glBindTexture(GL_TEXTURE_2D, 0);
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	numDirtyPatches = 0;
+}
+
+void CGPUMeshDrawer::GenPatchSquareGeometry(uint32_t px, uint32_t py)
+{
+	MeshPatch& meshPatch = meshPatches[py * numPatchesX + px];
+	VBO& squareVBO = meshPatch.squareVertexBuffers[0].vbo;
+
+	constexpr uint32_t numVerts = PATCH_SIZE + 1;
+
+	meshPatch.uhmUpdateFrames[0] = globalRendering->drawFrame;
+
+	// same layout as UploadPatchSquareGeometry writes for LOD 0, the
+	// buffer was allocated by it and is only ever read by the GPU now
+	meshGenShader->SetUniform("patchParams", int(px * PATCH_SIZE), int(py * PATCH_SIZE), int(numVerts));
+
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, squareVBO.GetId());
+	glBeginTransformFeedback(GL_POINTS);
+	glDrawArrays(GL_POINTS, 0, numVerts * numVerts);
+	glEndTransformFeedback();
+	glBindBufferBase(GL_TRANSFORM_FEEDBACK_BUFFER, 0, 0);
+}
+
@@ -0,0 +1,47 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _GPU_MESH_DRAWER_H_
+#define _GPU_MESH_DRAWER_H_
+
+#include <vector>
+
+#include "Map/SMF/Basic/BasicMeshDrawer.h"
+#include "Rendering/GL/VAO.h"
+
+namespace Shader {
+	struct IProgramObject;
+}
+
+/**
+ * Variant of CBasicMeshDrawer whose patch geometry is generated on the GPU
+ * from HeightMapTexture via transform-feedback, so neither camera motion
+ * nor terrain deformation cost any per-vertex CPU work. LOD selection is
+ * done by index-stride over the full-resolution patch buffers as before,
+ * which keeps the mesh crack-free and every existing (Lua) map shader
+ * usable.
+ */
+class CGPUMeshDrawer : public CBasicMeshDrawer {
+public:
+	CGPUMeshDrawer(CSMFGroundDrawer* gd);
+	~CGPUMeshDrawer();
+
+	void UpdateGeometry() override;
+	void UnsyncedHeightMapUpdate(const SRectangle& rect) override;
+
+private:
+	void GenPatchSquareGeometry(uint32_t px, uint32_t py);
+
+private:
+	Shader::IProgramObject* meshGenShader = nullptr;
+
+	// transform-feedback pass sources nothing but gl_VertexID
+	VAO emptyArray;
+
+	// patches whose square geometry must be regenerated
+	std::vector<uint8_t> dirtyPatches;
+
+	uint32_t numDirtyPatches = 0;
+};
+
+#endif
+
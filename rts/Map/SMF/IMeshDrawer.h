@@ -19,6 +19,8 @@ public:
 	virtual ~IMeshDrawer() {}
 
 	virtual void Update() = 0;
+	// called once per frame by CSMFGroundDrawer::Update, outside of any draw-pass
+	virtual void UpdateGeometry() {}
 	virtual void DrawMesh(const DrawPass::e& drawPass) = 0;
 	virtual void DrawBorderMesh(const DrawPass::e& drawPass) = 0;
 };
@@ -111,8 +111,8 @@ Patch::Patch()
 
 Patch::~Patch()
 {
-	glDeleteVertexArrays(1, &vertexArrays[0]);
-	glDeleteVertexArrays(1, &vertexArrays[1]);
+	glAttribStatePtr->DeleteVertexArrays(1, &vertexArrays[0]);
+	glAttribStatePtr->DeleteVertexArrays(1, &vertexArrays[1]);
 
 	glDeleteBuffers(1, &vertexBuffers[0]);
 	glDeleteBuffers(1, &vertexBuffers[1]);
@@ -621,23 +621,23 @@ bool Patch::Tessellate(const float3& camPos, int viewRadius, bool shadowPass)
 
 void Patch::Draw()
 {
-	glBindVertexArray(vertexArrays[0]);
+	glAttribStatePtr->BindVertexArray(vertexArrays[0]);
 	glDrawRangeElements(GL_TRIANGLES, 0, vertices.size(), indices.size(), GL_UNSIGNED_INT, nullptr);
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 }
 
 void Patch::DrawBorder()
 {
-	glBindVertexArray(vertexArrays[1]);
+	glAttribStatePtr->BindVertexArray(vertexArrays[1]);
 	glDrawArrays(GL_TRIANGLES, 0, borderVertices.size());
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 }
 
 
 
 void Patch::UploadVertices()
 {
-	glBindVertexArray(vertexArrays[0]);
+	glAttribStatePtr->BindVertexArray(vertexArrays[0]);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indexBuffer);
 	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffers[0]);
 	glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), vertices.data(), GL_STATIC_DRAW);
@@ -645,7 +645,7 @@ void Patch::UploadVertices()
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 3, GL_FLOAT, false, sizeof(float3), VA_TYPE_OFFSET(float, 0));
 
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
 	glDisableVertexAttribArray(0);
@@ -654,7 +654,7 @@ void Patch::UploadVertices()
 
 void Patch::UploadBorderVertices()
 {
-	glBindVertexArray(vertexArrays[1]);
+	glAttribStatePtr->BindVertexArray(vertexArrays[1]);
 	glBindBuffer(GL_ARRAY_BUFFER, vertexBuffers[1]);
 
 	glEnableVertexAttribArray(0);
@@ -665,7 +665,7 @@ void Patch::UploadBorderVertices()
 
 	glBufferData(GL_ARRAY_BUFFER, borderVertices.size() * sizeof(VA_TYPE_C), borderVertices.data(), GL_STATIC_DRAW);
 
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 	glBindBuffer(GL_ARRAY_BUFFER, 0);
 	glDisableVertexAttribArray(1);
 	glDisableVertexAttribArray(0);
@@ -8,6 +8,7 @@
 #include "Map/MapInfo.h"
 #include "Map/ReadMap.h"
 #include "Map/SMF/Basic/BasicMeshDrawer.h"
+#include "Map/SMF/GPU/GPUMeshDrawer.h"
 // #include "Map/SMF/Legacy/LegacyMeshDrawer.h"
 #include "Map/SMF/ROAM/RoamMeshDrawer.h"
 #include "Rendering/GlobalRendering.h"
@@ -41,6 +42,12 @@ CONFIG(int, MaxDynamicMapLights)
 	.defaultValue(1)
 	.minimumValue(0);
 
+CONFIG(int, MaxClusteredMapLights)
+	.defaultValue(0)
+	.minimumValue(0)
+	.maximumValue(GL::LightHandler::MaxGridLights())
+	.description("If non-zero, replaces MaxDynamicMapLights by a light-grid holding this many map lights, of which each fragment only evaluates those in range.");
+
 CONFIG(bool, AllowDeferredMapRendering).defaultValue(false).safemodeValue(false);
 CONFIG(bool, AllowDrawMapPostDeferredEvents).defaultValue(true);
 
@@ -52,6 +59,12 @@ CONFIG(int, ROAM)
 	.maximumValue(1)
 	.description("Use ROAM for terrain mesh rendering: 0 to disable, 1 to enable.");
 
+CONFIG(bool, GPUMapMeshDrawer)
+	.defaultValue(false)
+	.safemodeValue(false)
+	.headlessValue(false)
+	.description("Generate the terrain mesh on the GPU from the heightmap texture, such that camera movement and terrain deformation cost no CPU time. Takes precedence over ROAM.");
+
 
 CSMFGroundDrawer::CSMFGroundDrawer(CSMFReadMap* rm)
 	: smfMap(rm)
@@ -59,6 +72,7 @@ CSMFGroundDrawer::CSMFGroundDrawer(CSMFReadMap* rm)
 	, geomBuffer{"GROUNDDRAWER-GBUFFER"}
 {
 	drawerMode = (configHandler->GetInt("ROAM") != 0)? SMF_MESHDRAWER_ROAM: SMF_MESHDRAWER_BASIC;
+	drawerMode = configHandler->GetBool("GPUMapMeshDrawer")? SMF_MESHDRAWER_GPU: drawerMode;
 	groundDetail = configHandler->GetInt("GroundDetail");
 
 	groundTextures = new CSMFGroundTextures(smfMap);
@@ -70,7 +84,7 @@ CSMFGroundDrawer::CSMFGroundDrawer(CSMFReadMap* rm)
 	smfRenderStates[RENDER_STATE_LUA] = ISMFRenderState::GetInstance(false,  true);
 
 	// LH must be initialized before render-state is initialized
-	lightHandler.Init(configHandler->GetInt("MaxDynamicMapLights"));
+	lightHandler.Init(configHandler->GetInt("MaxDynamicMapLights"), configHandler->GetInt("MaxClusteredMapLights"));
 
 	drawForward = true;
 	drawDeferred = geomBuffer.Valid();
@@ -103,14 +117,17 @@ CSMFGroundDrawer::CSMFGroundDrawer(CSMFReadMap* rm)
 
 CSMFGroundDrawer::~CSMFGroundDrawer()
 {
-	// remember if ROAM-mode was enabled
+	// remember if ROAM- or GPU-mode was enabled
 	configHandler->Set("ROAM", int(dynamic_cast<CRoamMeshDrawer*>(meshDrawer) != nullptr));
+	configHandler->Set("GPUMapMeshDrawer", dynamic_cast<CGPUMeshDrawer*>(meshDrawer) != nullptr);
 
 	smfRenderStates[RENDER_STATE_NOP]->Kill(); ISMFRenderState::FreeInstance(smfRenderStates[RENDER_STATE_NOP]);
 	smfRenderStates[RENDER_STATE_SSP]->Kill(); ISMFRenderState::FreeInstance(smfRenderStates[RENDER_STATE_SSP]);
 	smfRenderStates[RENDER_STATE_LUA]->Kill(); ISMFRenderState::FreeInstance(smfRenderStates[RENDER_STATE_LUA]);
 	smfRenderStates.clear();
 
+	lightHandler.Kill();
+
 	waterPlaneBuffers[0].Kill();
 	waterPlaneBuffers[1].Kill();
 
@@ -149,6 +166,11 @@ IMeshDrawer* CSMFGroundDrawer::SwitchMeshDrawer(int wantedMode)
 			spring::SafeDelete(meshDrawer);
 			meshDrawer = new CBasicMeshDrawer(this);
 		} break;
+		case SMF_MESHDRAWER_GPU: {
+			LOG("Switching to GPU Mesh Rendering");
+			spring::SafeDelete(meshDrawer);
+			meshDrawer = new CGPUMeshDrawer(this);
+		} break;
 		default: {
 			LOG("Switching to ROAM Mesh Rendering");
 			spring::SafeDelete(meshDrawer);
@@ -465,8 +487,8 @@ void CSMFGroundDrawer::DrawBorder(const DrawPass::e drawPass)
 	smfRenderStates[RENDER_STATE_SEL] = smfRenderStates[RENDER_STATE_NOP];
 
 
-	glActiveTexture(GL_TEXTURE2);
-	glBindTexture(GL_TEXTURE_2D, smfMap->GetDetailTexture());
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE2);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, smfMap->GetDetailTexture());
 
 
 	glAttribStatePtr->EnableCullFace();
@@ -554,6 +576,7 @@ void CSMFGroundDrawer::Update()
 	groundTextures->DrawUpdate();
 	// done by DrawMesh; needs to know the actual draw-pass
 	// meshDrawer->Update();
+	meshDrawer->UpdateGeometry();
 
 	if (drawDeferred) {
 		drawDeferred &= UpdateGeometryBuffer(false);
@@ -590,11 +613,14 @@ bool CSMFGroundDrawer::UpdateGeometryBuffer(bool init)
 
 void CSMFGroundDrawer::SetDetail(int newGroundDetail)
 {
-	const int minGroundDetail = MIN_GROUND_DETAIL[drawerMode != SMF_MESHDRAWER_BASIC];
-	const int maxGroundDetail = MAX_GROUND_DETAIL[drawerMode != SMF_MESHDRAWER_BASIC];
+	// the GPU drawer shares the LOD-bias semantics of the basic one
+	const bool lodBiasMode = (drawerMode == SMF_MESHDRAWER_BASIC || drawerMode == SMF_MESHDRAWER_GPU);
+
+	const int minGroundDetail = MIN_GROUND_DETAIL[!lodBiasMode];
+	const int maxGroundDetail = MAX_GROUND_DETAIL[!lodBiasMode];
 
 	configHandler->Set("GroundDetail", groundDetail = Clamp(newGroundDetail, minGroundDetail, maxGroundDetail));
-	LOG("GroundDetail%s set to %i", ((drawerMode == SMF_MESHDRAWER_BASIC)? "[Bias]": ""), groundDetail);
+	LOG("GroundDetail%s set to %i", (lodBiasMode? "[Bias]": ""), groundDetail);
 }
 
 
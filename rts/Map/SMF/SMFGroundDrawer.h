@@ -17,7 +17,8 @@ enum {
 	SMF_MESHDRAWER_LEGACY = 0,
 	SMF_MESHDRAWER_BASIC  = 1,
 	SMF_MESHDRAWER_ROAM   = 2,
-	SMF_MESHDRAWER_LAST   = 3,
+	SMF_MESHDRAWER_GPU    = 3,
+	SMF_MESHDRAWER_LAST   = 4,
 };
 
 
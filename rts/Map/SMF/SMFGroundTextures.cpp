@@ -4,6 +4,7 @@
 #include <cmath>
 #include <cstdlib>
 #include <cstdio>
+#include <numeric>
 
 #include "SMFGroundTextures.h"
 #include "SMFFormat.h"
@@ -16,6 +17,7 @@
 #include "Game/Game.h"
 #include "Game/GameSetup.h"
 #include "Game/LoadScreen.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Exceptions.h"
 #include "System/FastMath.h"
 #include "System/Log/ILog.h"
@@ -27,6 +29,14 @@
 
 using std::sprintf;
 
+CONFIG(bool, SMFStreamTiles)
+	.defaultValue(false)
+	.description("Only upload the lowest MIP level of the map ground textures at load time and decode finer levels on demand as squares come into view. SMT tiles are read from the (memory-mapped) tile-files instead of being copied.");
+CONFIG(int, SMFStreamUploadsPerFrame)
+	.defaultValue(8)
+	.minimumValue(1)
+	.description("Maximum number of streamed ground texture squares uploaded per frame if SMFStreamTiles is enabled.");
+
 #define LOG_SECTION_SMF_GROUND_TEXTURES "CSMFGroundTextures"
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_SMF_GROUND_TEXTURES)
 
@@ -42,6 +52,7 @@ std::vector<CSMFGroundTextures::GroundSquare> CSMFGroundTextures::squares;
 
 std::vector<int> CSMFGroundTextures::tileMap;
 std::vector<char> CSMFGroundTextures::tiles;
+std::vector<const char*> CSMFGroundTextures::tilePtrs;
 
 std::vector<float> CSMFGroundTextures::heightMaxima;
 std::vector<float> CSMFGroundTextures::heightMinima;
@@ -59,15 +70,25 @@ CSMFGroundTextures::GroundSquare::~GroundSquare()
 
 
 
-CSMFGroundTextures::CSMFGroundTextures(CSMFReadMap* rm): smfMap(rm)
+CSMFGroundTextures::CSMFGroundTextures(CSMFReadMap* rm)
+	: smfMap(rm)
+	, streamTiles(configHandler->GetBool("SMFStreamTiles"))
+	, maxSquareUploads(configHandler->GetInt("SMFStreamUploadsPerFrame"))
 {
 	LoadTiles(smfMap->GetMapFile());
-	LoadSquareTextures(0, 3); // preload all levels
+	LoadSquareTextures(streamTiles? 3: 0, 3); // preload all levels unless streaming
 	ConvolveHeightMap(mapDims.mapx, 1);
 }
 
 CSMFGroundTextures::~CSMFGroundTextures()
 {
+	// decode jobs read from the tile-files and write into their own buffers
+	for (const auto& job: decodeJobs) {
+		while (!job->done.load()) {
+			spring::this_thread::yield();
+		}
+	}
+
 	pbo.Release();
 	glDeleteTextures(1, &tileArrayTex);
 }
@@ -99,10 +120,13 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 	tileMap.clear();
 	tileMap.resize(smfMap->tileCount);
 	tiles.clear();
-	tiles.resize(tileHeader.numTiles * SMALL_TILE_SIZE);
+	tilePtrs.clear();
 	squares.clear();
 	squares.resize(smfMap->numBigTexX * smfMap->numBigTexY);
 
+	tileFiles.clear();
+	tileFiles.resize(tileHeader.numTileFiles);
+
 	bool smtHeaderOverride = false;
 
 	const std::string& smfDir = FileSystem::GetDirectory(gameSetup->MapFileName());
@@ -114,8 +138,18 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 		}
 	}
 
-	for (int a = 0, curTile = 0; a < tileHeader.numTileFiles; ++a) {
-		int numSmallTiles = 0;
+	std::vector<int> numFileTiles(tileHeader.numTileFiles, 0);
+	std::vector<int> fileTileDataPos(tileHeader.numTileFiles, -1);
+	std::vector<const char*> fileTileData(tileHeader.numTileFiles, nullptr);
+	std::vector<std::string> filePaths(tileHeader.numTileFiles);
+
+	size_t numCopiedTiles = 0;
+
+	// first pass; open and validate every tile-file and find out which can be
+	// referenced in place (streaming mode, file is mapped or already buffered)
+	// so the remaining tiles can be copied into one allocation
+	for (int a = 0; a < tileHeader.numTileFiles; ++a) {
+		int& numSmallTiles = numFileTiles[a];
 		char fileNameBuffer[256] = {0};
 
 		ifs->Read(&numSmallTiles, sizeof(int));
@@ -127,11 +161,15 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 			(smfDir + smtFileName):
 			(smfDir + smf.smtFileNames[a]);
 
-		CFileHandler tileFile(smtFilePath);
+		tileFiles[a].reset(new CFileHandler("", ""));
+		CFileHandler& tileFile = *tileFiles[a];
+
+		// when streaming tiles are referenced in place, otherwise copied one by one
+		tileFile.OpenMapped(smtFilePath);
 
 		// try absolute path
 		if (!tileFile.FileExists())
-			tileFile.Open(smtFilePath = (!smtHeaderOverride) ? smtFileName : smf.smtFileNames[a]);
+			tileFile.OpenMapped(smtFilePath = (!smtHeaderOverride) ? smtFileName : smf.smtFileNames[a]);
 
 		if (!tileFile.FileExists()) {
 			LOG_L(L_WARNING,
@@ -139,8 +177,8 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 				__func__, a, smtFilePath.c_str(), numSmallTiles
 			);
 
-			memset(&tiles[curTile * SMALL_TILE_SIZE], 0xaa, numSmallTiles * SMALL_TILE_SIZE);
-			curTile += numSmallTiles;
+			numCopiedTiles += numSmallTiles;
+			tileFiles[a].reset();
 			continue;
 		}
 
@@ -156,9 +194,60 @@ void CSMFGroundTextures::LoadTiles(CSMFMapFile& file)
 			throw content_error(tmp);
 		}
 
+		const int tileDataPos = tileFile.GetPos();
+
+		if (streamTiles && (tileFile.FileSize() - tileDataPos) >= (numSmallTiles * SMALL_TILE_SIZE)) {
+			if (tileFile.IsMapped()) {
+				fileTileData[a] = reinterpret_cast<const char*>(tileFile.GetMappedData() + tileDataPos);
+				continue;
+			}
+			if (tileFile.IsBuffered()) {
+				fileTileData[a] = reinterpret_cast<const char*>(tileFile.GetBuffer().data() + tileDataPos);
+				continue;
+			}
+		}
+
+		// reopened when copying, at most one file is held in memory at a time
+		numCopiedTiles += numSmallTiles;
+		fileTileDataPos[a] = tileDataPos;
+		filePaths[a] = smtFilePath;
+		tileFiles[a].reset();
+	}
+
+	tiles.resize(numCopiedTiles * SMALL_TILE_SIZE);
+	tilePtrs.resize(std::max(tileHeader.numTiles, std::accumulate(numFileTiles.begin(), numFileTiles.end(), 0)), nullptr);
+
+	for (int a = 0, curTile = 0, curCopiedTile = 0; a < tileHeader.numTileFiles; ++a) {
+		const int numSmallTiles = numFileTiles[a];
+
+		if (fileTileData[a] != nullptr) {
+			for (int b = 0; b < numSmallTiles; ++b) {
+				tilePtrs[curTile++] = fileTileData[a] + b * SMALL_TILE_SIZE;
+			}
+
+			continue;
+		}
+
+		char* copiedTiles = tiles.data() + curCopiedTile * SMALL_TILE_SIZE;
+
+		if (fileTileDataPos[a] < 0) {
+			memset(copiedTiles, 0xaa, numSmallTiles * SMALL_TILE_SIZE);
+		} else {
+			CFileHandler tileFile("", "");
+
+			tileFile.OpenMapped(filePaths[a]);
+			tileFile.Seek(fileTileDataPos[a]);
+
+			for (int b = 0; b < numSmallTiles; ++b) {
+				tileFile.Read(&copiedTiles[b * SMALL_TILE_SIZE], SMALL_TILE_SIZE);
+			}
+		}
+
 		for (int b = 0; b < numSmallTiles; ++b) {
-			tileFile.Read(&tiles[(curTile++) * SMALL_TILE_SIZE], SMALL_TILE_SIZE);
+			tilePtrs[curTile++] = &copiedTiles[b * SMALL_TILE_SIZE];
 		}
+
+		curCopiedTile += numSmallTiles;
 	}
 
 	ifs->Read(&tileMap[0], smfMap->tileCount * sizeof(int));
@@ -229,9 +318,7 @@ void CSMFGroundTextures::LoadSquareTextures(const int minLevel, const int maxLev
 
 	for (int i = minLevel; i <= maxLevel; i++) {
 		for (int y = 0; y < nty; ++y) {
-			for (int x = 0; x < ntx; ++x) {
-				LoadSquareTexture(x, y, i);
-			}
+			LoadSquareTextureRow(y, i);
 		}
 	}
 
@@ -327,6 +414,9 @@ inline bool CSMFGroundTextures::TexSquareInView(int btx, int bty) const
 
 void CSMFGroundTextures::DrawUpdate()
 {
+	if (streamTiles)
+		UploadDecodedSquares();
+
 	const CCamera* cam = CCameraHandler::GetActiveCamera();
 
 	const float3& camPos = cam->GetPos();
@@ -405,7 +495,14 @@ void CSMFGroundTextures::DrawUpdate()
 			if (stretchFactors[y * smfMap->numBigTexX + x] > 16000 && wantedLevel > 0)
 				wantedLevel--;
 
-			square->SetMipLevel(wantedLevel);
+			if (!streamTiles) {
+				square->SetMipLevel(wantedLevel);
+				continue;
+			}
+
+			// draw with the closest coarser level until the wanted one is uploaded
+			QueueSquareDecode(x, y, wantedLevel);
+			square->SetMipLevel(square->GetLoadedMipLevel(wantedLevel));
 		}
 	}
 }
@@ -496,7 +593,7 @@ void CSMFGroundTextures::ExtractSquareTiles(
 			const int tileX = tileOffsetX + x1;
 			const int tileY = tileOffsetY + y1;
 			const int tileIdx = tileMap[tileY * smfMap->tileMapSizeX + tileX];
-			const GLint* tile = (GLint*) &tiles[tileIdx * SMALL_TILE_SIZE + mipOffset];
+			const GLint* tile = (const GLint*) (tilePtrs[tileIdx] + mipOffset);
 
 			const int doff = (x1 * numBlocks) + (y1 * numBlocks * numBlocks) * BLOCK_SIZE;
 
@@ -511,40 +608,126 @@ void CSMFGroundTextures::ExtractSquareTiles(
 	}
 }
 
-void CSMFGroundTextures::LoadSquareTexture(int x, int y, int level)
+void CSMFGroundTextures::LoadSquareTextureRow(int y, int level)
 {
 	constexpr GLenum ttarget = GL_TEXTURE_2D_ARRAY;
 	constexpr GLbitfield access = GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT;
 
+	const int ntx = smfMap->numBigTexX;
 	const int mipSqSize = smfMap->bigTexSize >> level;
 	const int numSqBytes = (mipSqSize * mipSqSize) / 2;
 
-	GroundSquare* square = &squares[y * smfMap->numBigTexX + x];
-	square->SetMipLevel(level);
-	assert(!square->HasLuaTexture());
+	// tiles of all squares in the row are extracted in parallel straight into
+	// one mapped buffer, so at most a single row is held in memory at a time
+	pbo.Bind();
+	pbo.New(numSqBytes * ntx);
 
+	GLubyte* rowBuf = pbo.MapBuffer(0, pbo.bufSize, access | pbo.mapUnsyncedBit);
+
+	if (rowBuf != nullptr) {
+		for_mt(0, ntx, [&](const int x) {
+			ExtractSquareTiles(x, y, level, reinterpret_cast<GLint*>(rowBuf + x * numSqBytes));
+		});
+	}
 
-	pbo.Bind();
-	pbo.New(numSqBytes);
-	ExtractSquareTiles(x, y, level, (GLint*) pbo.MapBuffer(0, pbo.bufSize, access | pbo.mapUnsyncedBit));
 	pbo.UnmapBuffer();
 
-	glCompressedTexSubImage3D(
-		ttarget,
-		level,
+	for (int x = 0; x < ntx; ++x) {
+		GroundSquare* square = &squares[y * ntx + x];
+		square->SetMipLevel(level);
+		square->AddLoadedMipLevel(level);
+		assert(!square->HasLuaTexture());
 
-		0, 0, y * smfMap->numBigTexX + x, // xoffset, yoffset, zoffset=slice
-		mipSqSize, mipSqSize, 1, // width, height, depth
+		glCompressedTexSubImage3D(
+			ttarget,
+			level,
 
-		tileTexFormat,
-		numSqBytes,
-		pbo.GetPtr()
-	);
+			0, 0, y * ntx + x, // xoffset, yoffset, zoffset=slice
+			mipSqSize, mipSqSize, 1, // width, height, depth
+
+			tileTexFormat,
+			numSqBytes,
+			pbo.GetPtr(x * numSqBytes)
+		);
+	}
 
 	pbo.Invalidate();
 	pbo.Unbind();
 }
 
+void CSMFGroundTextures::QueueSquareDecode(int x, int y, int level)
+{
+	GroundSquare* square = &squares[y * smfMap->numBigTexX + x];
+
+	if (square->HasLoadedMipLevel(level) || square->HasQueuedMipLevel(level))
+		return;
+
+	// bound the amount of decoded data waiting to be uploaded
+	if (decodeJobs.size() >= size_t(maxSquareUploads * 4))
+		return;
+
+	std::shared_ptr<SquareDecodeJob> job = std::make_shared<SquareDecodeJob>();
+
+	job->x = x;
+	job->y = y;
+	job->level = level;
+
+	square->AddQueuedMipLevel(level);
+	decodeJobs.push_back(job);
+
+	ThreadPool::Enqueue([this, job]() {
+		const int mipSqSize = smfMap->bigTexSize >> job->level;
+
+		job->tileBuf.resize((mipSqSize * mipSqSize) / (2 * sizeof(GLint)));
+		ExtractSquareTiles(job->x, job->y, job->level, job->tileBuf.data());
+		job->done.store(true);
+	});
+}
+
+void CSMFGroundTextures::UploadDecodedSquares()
+{
+	if (decodeJobs.empty())
+		return;
+
+	BindSquareTextureArray();
+
+	int numUploads = 0;
+
+	for (size_t i = 0; i < decodeJobs.size() && numUploads < maxSquareUploads; ) {
+		const SquareDecodeJob* job = decodeJobs[i].get();
+
+		if (!job->done.load()) {
+			i += 1;
+			continue;
+		}
+
+		const int mipSqSize = smfMap->bigTexSize >> job->level;
+		const int sqrIdx = job->y * smfMap->numBigTexX + job->x;
+
+		glCompressedTexSubImage3D(
+			GL_TEXTURE_2D_ARRAY,
+			job->level,
+
+			0, 0, sqrIdx,
+			mipSqSize, mipSqSize, 1,
+
+			tileTexFormat,
+			job->tileBuf.size() * sizeof(GLint),
+			job->tileBuf.data()
+		);
+
+		squares[sqrIdx].AddLoadedMipLevel(job->level);
+		squares[sqrIdx].RemoveQueuedMipLevel(job->level);
+
+		decodeJobs[i] = std::move(decodeJobs.back());
+		decodeJobs.pop_back();
+
+		numUploads += 1;
+	}
+
+	UnBindSquareTextureArray();
+}
+
 void CSMFGroundTextures::BindSquareTextureArray() const { glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D_ARRAY, tileArrayTex); }
 void CSMFGroundTextures::UnBindSquareTextureArray() const { glActiveTexture(GL_TEXTURE0); glBindTexture(GL_TEXTURE_2D_ARRAY, 0); }
 
@@ -3,11 +3,14 @@
 #ifndef _SMF_GROUND_TEXTURES_H_
 #define _SMF_GROUND_TEXTURES_H_
 
+#include <atomic>
+#include <memory>
 #include <vector>
 
 #include "Map/BaseGroundTextures.h"
 #include "Rendering/GL/PBO.h"
 
+class CFileHandler;
 class CSMFMapFile;
 class CSMFReadMap;
 
@@ -33,7 +36,10 @@ protected:
 	void LoadSquareTextures(const int minLevel, const int maxLevel);
 	void ConvolveHeightMap(const int mapWidth, const int mipLevel);
 	void ExtractSquareTiles(const int texSquareX, const int texSquareY, const int mipLevel, GLint* tileBuf) const;
-	void LoadSquareTexture(int x, int y, int level);
+	void LoadSquareTextureRow(int y, int level);
+
+	void QueueSquareDecode(int x, int y, int level);
+	void UploadDecodedSquares();
 
 	inline bool TexSquareInView(int, int) const;
 
@@ -46,7 +52,7 @@ private:
 			LUA_TEX_IDX = 1,
 		};
 
-		GroundSquare(): textureIDs{0, 0}, texMipLevel(0), texDrawFrame(1) {}
+		GroundSquare(): textureIDs{0, 0}, texMipLevel(0), texDrawFrame(1), loadedLevels(0), queuedLevels(0) {}
 		~GroundSquare();
 
 		bool HasLuaTexture() const { return (textureIDs[LUA_TEX_IDX] != 0); }
@@ -61,17 +67,45 @@ private:
 		unsigned int GetMipLevel() const { return texMipLevel; }
 		unsigned int GetDrawFrame() const { return texDrawFrame; }
 
+		// streaming only; level 3 is always loaded
+		bool HasLoadedMipLevel(unsigned int l) const { return ((loadedLevels & (1u << l)) != 0); }
+		bool HasQueuedMipLevel(unsigned int l) const { return ((queuedLevels & (1u << l)) != 0); }
+		void AddLoadedMipLevel(unsigned int l) { loadedLevels |= (1u << l); }
+		void AddQueuedMipLevel(unsigned int l) { queuedLevels |= (1u << l); }
+		void RemoveQueuedMipLevel(unsigned int l) { queuedLevels &= ~(1u << l); }
+
+		unsigned int GetLoadedMipLevel(unsigned int l) const {
+			while (l < 3 && !HasLoadedMipLevel(l))
+				l++;
+			return l;
+		}
+
 	private:
 		unsigned int textureIDs[2];
 		unsigned int texMipLevel;
 		unsigned int texDrawFrame;
+
+		unsigned int loadedLevels;
+		unsigned int queuedLevels;
+	};
+
+	struct SquareDecodeJob {
+		std::vector<GLint> tileBuf;
+		std::atomic<bool> done = {false};
+
+		int x = 0;
+		int y = 0;
+		int level = 0;
 	};
 
 	// note: intentionally declared static (see ReadMap)
 	static std::vector<GroundSquare> squares;
 
 	static std::vector<int> tileMap;
+	// tiles that could not be referenced from their tile-file
 	static std::vector<char> tiles;
+	// SMALL_TILE_SIZE bytes of data for every tile
+	static std::vector<const char*> tilePtrs;
 
 	// FIXME? these are not updated at runtime
 	static std::vector<float> heightMaxima;
@@ -83,6 +117,13 @@ private:
 
 	unsigned int tileArrayTex = 0;
 	unsigned int tileTexFormat = 0;
+
+	// mapped or buffered tile-files referenced by tilePtrs (streaming only)
+	std::vector<std::unique_ptr<CFileHandler>> tileFiles;
+	std::vector<std::shared_ptr<SquareDecodeJob>> decodeJobs;
+
+	bool streamTiles = false;
+	int maxSquareUploads = 0;
 };
 
 #endif // _BF_GROUND_TEXTURES_H_
@@ -35,7 +35,8 @@ void CSMFMapFile::Open(const std::string& mapFileName)
 	memset(&featureHeader, 0, sizeof(featureHeader));
 	memset( featureTypes , 0, sizeof(featureTypes ));
 
-	ifs.Open(mapFileName);
+	// heightmap, minimap and info-maps are read straight from the mapping if possible
+	ifs.OpenMapped(mapFileName);
 
 	if (!ifs.FileExists()) {
 		snprintf(buf, sizeof(buf), fmts[0], __func__, mapFileName.c_str());
@@ -47,7 +47,9 @@ bool SMFRenderStateGLSL::Init(const CSMFGroundDrawer* smfGroundDrawer) {
 		("#define SMF_FRAGDATA_COUNT "     + IntToString(GL::GeometryBuffer::ATTACHMENT_COUNT) + "\n") +
 		("#define NUM_DYNAMIC_MAP_LIGHTS " + IntToString(    lightHandler->NumConfigLights()) + "\n") +
 		("#define MAX_DYNAMIC_MAP_LIGHTS " + IntToString(GL::LightHandler::MaxConfigLights()) + "\n") +
-		("#define MAX_LIGHT_UNIFORM_VECS " + IntToString(GL::LightHandler::MaxUniformVecs()) + "\n");
+		("#define MAX_LIGHT_UNIFORM_VECS " + IntToString(GL::LightHandler::MaxUniformVecs()) + "\n") +
+		("#define LIGHT_GRID_SIZE "        + IntToString(GL::LightHandler::LightGridSize()) + "\n") +
+		(lightHandler->UseLightGrid()? "#define USE_LIGHT_GRID\n": "");
 
 	if (useLuaShaders) {
 		for (unsigned int n = GLSL_SHADER_STANDARD; n <= GLSL_SHADER_DEFERRED; n++) {
@@ -99,7 +101,7 @@ void SMFRenderStateGLSL::Update(
 		assert(luaMapShaderData == nullptr);
 
 		const CSMFReadMap* smfMap = smfGroundDrawer->GetReadMap();
-		// const GL::LightHandler* lightHandler = smfGroundDrawer->GetLightHandler();
+		const GL::LightHandler* lightHandler = smfGroundDrawer->GetLightHandler();
 
 		const int2 normTexSize = smfMap->GetTextureSize(MAP_BASE_NORMALS_TEX);
 		// const int2 specTexSize = smfMap->GetTextureSize(MAP_SSMF_SPECULAR_TEX);
@@ -154,6 +156,9 @@ void SMFRenderStateGLSL::Update(
 			glslShaders[n]->SetUniform("splatDetailNormalTex2", 16);
 			glslShaders[n]->SetUniform("splatDetailNormalTex3", 17);
 			glslShaders[n]->SetUniform("splatDetailNormalTex4", 18);
+			glslShaders[n]->SetUniform("lightDataTex",          19);
+			glslShaders[n]->SetUniform("lightGridTex",          20);
+			glslShaders[n]->SetUniform2v<float>("lightGridScale", lightHandler->GetLightGridScale());
 
 			glslShaders[n]->SetUniform("mapSizePO2", mapDims.pwr2mapx * SQUARE_SIZE * 1.0f, mapDims.pwr2mapy * SQUARE_SIZE * 1.0f);
 			glslShaders[n]->SetUniform("mapSize",    mapDims.mapx     * SQUARE_SIZE * 1.0f, mapDims.mapy     * SQUARE_SIZE * 1.0f);
@@ -261,7 +266,12 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 
 	if (cLightHandler->NumConfigLights() > 0) {
 		mLightHandler->Update();
-		shader->SetUniform4v<float>("fwdDynLights", cLightHandler->NumUniformVecs(), cLightHandler->GetRawLightDataPtr());
+
+		if (cLightHandler->UseLightGrid()) {
+			cLightHandler->BindLightGrid(19);
+		} else {
+			shader->SetUniform4v<float>("fwdDynLights", cLightHandler->NumUniformVecs(), cLightHandler->GetRawLightDataPtr());
+		}
 	}
 
 	switch (drawPass) {
@@ -294,13 +304,16 @@ void SMFRenderStateGLSL::Enable(const CSMFGroundDrawer* smfGroundDrawer, const D
 	glActiveTexture(GL_TEXTURE0);
 }
 
-void SMFRenderStateGLSL::Disable(const CSMFGroundDrawer*, const DrawPass::e&) {
+void SMFRenderStateGLSL::Disable(const CSMFGroundDrawer* smfGroundDrawer, const DrawPass::e&) {
 	if (useLuaShaders) {
 		glActiveTexture(GL_TEXTURE0);
 		glslShaders[GLSL_SHADER_CURRENT]->DisableRaw();
 		return;
 	}
 
+	if (smfGroundDrawer->GetLightHandler()->UseLightGrid())
+		smfGroundDrawer->GetLightHandler()->UnbindLightGrid(19);
+
 	if (shadowHandler.ShadowsLoaded()) {
 		glActiveTexture(GL_TEXTURE4);
 		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_COMPARE_MODE, GL_NONE);
@@ -6,7 +6,10 @@
 #include "System/Log/ILog.h"
 #include "System/Net/Socket.h"
 
+#include <algorithm>
+#include <cassert>
 #include <cstring>
+#include <limits>
 #include <vector>
 #include <cinttypes>
 
@@ -48,6 +51,30 @@ enum EVENT
 	/// Server gave out a warning (string warningmessage)
 	SERVER_WARNING = 5,
 
+	/**
+	 * @brief Periodic server performance report, see ServerStatsInterval
+	 *
+	 * (uint16_t msgsize, int32_t frame, uint32_t ticks, uint32_t frames,
+	 * float[5] avgPhaseTimes, float[5] maxPhaseTimes, float maxTickTime,
+	 * float avgFrameJitter, float maxFrameJitter,
+	 * {uchar playernumber, uint16_t incoming, uint16_t outgoing,
+	 * uint16_t unacked, uint16_t frameLag}[X])
+	 * (X = remaining size / 9, one entry per connected player; all
+	 * times are in milliseconds and phases are listener, readnet,
+	 * update, lagprotection and flush)
+	 */
+	SERVER_STATS = 6,
+
+	/**
+	 * @brief Memory usage of the engine's large allocators, sent along with
+	 *   SERVER_STATS
+	 *
+	 * (uint16_t msgsize, {uint64_t liveBytes, uint64_t peakBytes,
+	 * string name}[X])
+	 * (names are NUL-terminated, X follows from msgsize)
+	 */
+	MEMORY_STATS = 7,
+
 	/// Player has joined the game (uchar playernumber, string name)
 	PLAYER_JOINED = 10,
 
@@ -276,6 +303,98 @@ void AutohostInterface::SendPlayerDefeated(uchar playerNum)
 	Send(asio::buffer(&msg, 2 * sizeof(uchar)));
 }
 
+void AutohostInterface::SendServerStats(const ServerStats& stats, const std::vector<ServerLinkStats>& links)
+{
+	if (!autohost.is_open())
+		return;
+
+	constexpr size_t statsSize =
+		sizeof(stats.serverFrameNum) + sizeof(stats.numTicks) + sizeof(stats.numFrames) +
+		sizeof(stats.sumPhaseTimes) + sizeof(stats.maxPhaseTimes) + sizeof(stats.maxTickTime) +
+		sizeof(stats.sumFrameJitter) + sizeof(stats.maxFrameJitter);
+	constexpr size_t linkSize = sizeof(uchar) + 4 * sizeof(std::uint16_t);
+
+	const std::uint16_t msgsize = 1 + sizeof(std::uint16_t) + statsSize + linkSize * std::min(links.size(), size_t(255));
+
+	std::vector<std::uint8_t> buffer(msgsize);
+	std::uint8_t* pos = buffer.data();
+
+	float avgPhaseTimes[ServerStats::NUM_PHASES];
+	float avgFrameJitter = stats.sumFrameJitter / std::max(stats.numFrameTicks, 1u);
+
+	for (unsigned int i = 0; i < ServerStats::NUM_PHASES; i++) {
+		avgPhaseTimes[i] = stats.sumPhaseTimes[i] / std::max(stats.numTicks, 1u);
+	}
+
+	// fields are written individually to keep the wire format free of padding
+	const auto Write = [&pos](const void* src, size_t size) { memcpy(pos, src, size); pos += size; };
+
+	*(pos++) = SERVER_STATS;
+	Write(&msgsize, sizeof(msgsize));
+	Write(&stats.serverFrameNum, sizeof(stats.serverFrameNum));
+	Write(&stats.numTicks, sizeof(stats.numTicks));
+	Write(&stats.numFrames, sizeof(stats.numFrames));
+	Write(&avgPhaseTimes[0], sizeof(avgPhaseTimes));
+	Write(&stats.maxPhaseTimes[0], sizeof(stats.maxPhaseTimes));
+	Write(&stats.maxTickTime, sizeof(stats.maxTickTime));
+	Write(&avgFrameJitter, sizeof(avgFrameJitter));
+	Write(&stats.maxFrameJitter, sizeof(stats.maxFrameJitter));
+
+	for (size_t i = 0, n = std::min(links.size(), size_t(255)); i < n; i++) {
+		const ServerLinkStats& link = links[i];
+
+		Write(&link.playerNum, sizeof(link.playerNum));
+		Write(&link.numIncoming, sizeof(link.numIncoming));
+		Write(&link.numOutgoing, sizeof(link.numOutgoing));
+		Write(&link.numUnacked, sizeof(link.numUnacked));
+		Write(&link.frameLag, sizeof(link.frameLag));
+	}
+
+	assert(pos == (buffer.data() + buffer.size()));
+	Send(asio::buffer(buffer));
+}
+
+void AutohostInterface::SendMemoryStats(const std::vector<MemoryStats::Entry>& entries)
+{
+	if (!autohost.is_open())
+		return;
+
+	constexpr size_t entrySize = 2 * sizeof(std::uint64_t);
+	constexpr size_t maxMsgSize = std::numeric_limits<std::uint16_t>::max();
+
+	size_t msgsize = 1 + sizeof(std::uint16_t);
+	size_t numEntries = 0;
+
+	for (; numEntries < entries.size(); numEntries++) {
+		const size_t size = entrySize + entries[numEntries].name.size() + 1;
+
+		if ((msgsize + size) > maxMsgSize)
+			break;
+
+		msgsize += size;
+	}
+
+	std::vector<std::uint8_t> buffer(msgsize);
+	std::uint8_t* pos = buffer.data();
+
+	const auto Write = [&pos](const void* src, size_t size) { memcpy(pos, src, size); pos += size; };
+	const std::uint16_t msgsize16 = msgsize;
+
+	*(pos++) = MEMORY_STATS;
+	Write(&msgsize16, sizeof(msgsize16));
+
+	for (size_t i = 0; i < numEntries; i++) {
+		const MemoryStats::Entry& e = entries[i];
+
+		Write(&e.usage.liveBytes, sizeof(e.usage.liveBytes));
+		Write(&e.usage.peakBytes, sizeof(e.usage.peakBytes));
+		Write(e.name.c_str(), e.name.size() + 1);
+	}
+
+	assert(pos == (buffer.data() + buffer.size()));
+	Send(asio::buffer(buffer));
+}
+
 void AutohostInterface::Message(const std::string& message)
 {
 	if (autohost.is_open()) {
@@ -4,9 +4,13 @@
 #define AUTOHOST_INTERFACE_H
 
 #include <string>
+#include <vector>
 #include <cinttypes>
 #include <asio/ip/udp.hpp>
 
+#include "ServerStats.h"
+#include "System/MemoryStats.h"
+
 /**
  * API for engine <-> autohost (or similar) communication, using UDP over
  * loopback.
@@ -16,6 +20,7 @@ class AutohostInterface
 public:
 	typedef unsigned char uchar;
 
+
 	/**
 	 * @brief Connects to a port on localhost
 	 * @param remoteIP IP of the autohost to connect to
@@ -43,6 +48,9 @@ public:
 	void SendPlayerChat(uchar playerNum, uchar destination, const std::string& msg);
 	void SendPlayerDefeated(uchar playerNum);
 
+	void SendServerStats(const ServerStats& stats, const std::vector<ServerLinkStats>& links);
+	void SendMemoryStats(const std::vector<MemoryStats::Entry>& entries);
+
 	void Message(const std::string& message);
 	void Warning(const std::string& message);
 
@@ -26,6 +26,8 @@ void GameParticipant::Connected(std::shared_ptr<netcode::CConnection> _link, boo
 	isLocal = local;
 	myState = CONNECTED;
 	lastFrameResponse = 0;
+	awaitingGameState = false;
+	gameStateFrame = -1;
 }
 
 void GameParticipant::Kill(const std::string& reason, const bool flush)
@@ -45,6 +47,7 @@ void GameParticipant::Kill(const std::string& reason, const bool flush)
 	aiClientLinks[MAX_AIS].link.reset();
 #ifdef SYNCCHECK
 	syncResponse.clear();
+	syncLaneResponse.clear();
 #endif
 
 	myState = DISCONNECTED;
@@ -3,11 +3,13 @@
 #ifndef _GAME_PARTICIPANT_H
 #define _GAME_PARTICIPANT_H
 
+#include <array>
 #include <memory>
 
 #include "Game/Players/PlayerBase.h"
 #include "Game/Players/PlayerStatistics.h"
 #include "System/Net/LoopbackConnection.h"
+#include "System/Sync/SyncChecker.h"
 #include "System/UnorderedMap.hpp"
 
 namespace netcode
@@ -42,6 +44,10 @@ public:
 	bool isLocal = false;
 	bool isReconn = false;
 	bool isMidgameJoin = false;
+	/// joined a running game, broadcasts are held back until it received the sim-state of another client
+	bool awaitingGameState = false;
+	/// frame of the sim-state this client received, it sends no sync-responses up to it
+	int gameStateFrame = -1;
 
 	PlayerStatistics lastStats;
 
@@ -62,6 +68,7 @@ public:
 
 	#ifdef SYNCCHECK
 	spring::unordered_map<int, unsigned int> syncResponse; // syncResponse[frameNum] = checksum
+	spring::unordered_map<int, std::array<unsigned int, SYNC_LANE_COUNT>> syncLaneResponse; // per SyncLane
 	#endif
 };
 
@@ -21,6 +21,7 @@
 #include "Game/Action.h"
 #include "Game/ChatMessage.h"
 #include "Game/CommandMessage.h"
+#include "Game/GameVersion.h"
 #include "Game/GlobalUnsynced.h" // for syncdebug
 #ifndef DEDICATED
 #include "Game/IVideoCapturing.h"
@@ -37,7 +38,9 @@
 	#undef interface
 #endif
 #include "System/CRC.h"
+#include "System/ContainerUtil.h"
 #include "System/GlobalConfig.h"
+#include "System/MemoryStats.h"
 #include "System/MsgStrings.h"
 #include "System/SpringMath.h"
 #include "System/SpringExitCode.h"
@@ -54,6 +57,7 @@
 #include "System/LoadSave/DemoReader.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/errorhandler.h"
+#include "System/Platform/Misc.h"
 #include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
 
@@ -68,6 +72,7 @@ using netcode::RawPacket;
 
 CONFIG(int, AutohostPort).defaultValue(0);
 CONFIG(int, ServerSleepTime).defaultValue(5).description("number of milliseconds to sleep per tick");
+CONFIG(int, ServerIdleSleepTime).defaultValue(100).minimumValue(0).description("Maximum number of milliseconds to block on the network per tick while no game is running or the game is paused and no client is local; incoming packets end the wait early. 0 disables.");
 CONFIG(int, SpeedControl).defaultValue(1).minimumValue(1).maximumValue(2)
 	.description("Sets how server adjusts speed according to player's load (CPU), 1: use average, 2: use highest");
 CONFIG(bool, AllowSpectatorJoin).defaultValue(true).dedicatedValue(false).description("allow any unauthenticated clients to join as spectator with any name, name will be prefixed with ~");
@@ -76,6 +81,12 @@ CONFIG(bool, ServerRecordDemos).defaultValue(false).dedicatedValue(true);
 CONFIG(bool, ServerLogInfoMessages).defaultValue(false);
 CONFIG(bool, ServerLogDebugMessages).defaultValue(false);
 CONFIG(std::string, AutohostIP).defaultValue("127.0.0.1");
+CONFIG(std::string, ServerThreadCores).defaultValue("").description("Cores (e.g. \"3\") the server (netcode) thread is pinned to; if empty it may run on any core.");
+CONFIG(int, ServerStatsInterval).defaultValue(0).minimumValue(0).description("seconds between the per-phase timing and link queue reports sent to the autohost, 0 disables them");
+CONFIG(std::string, ServerRelayUpstream).defaultValue("").description("host:port of a server to join as spectator and relay to our own clients; empty disables relaying");
+CONFIG(std::string, ServerRelayName).defaultValue("relay").description("player name used by a relay when joining its upstream server");
+CONFIG(bool, ServerGameStateJoin).defaultValue(false).description("Send clients that join or reconnect to a running game the sim-state of an in-sync client followed by the frames after it, instead of every frame since the game started.");
+CONFIG(std::string, ServerRelayPassword).defaultValue("").description("password used by a relay when joining its upstream server");
 
 
 // use the specific section for all LOG*() calls in this source file
@@ -110,6 +121,12 @@ static constexpr unsigned gameProgressFrameInterval = GAME_SPEED * 10;
 
 static constexpr unsigned syncResponseEchoInterval = GAME_SPEED * 2;
 
+/// simulating fewer frames than this is faster than loading a demo snapshot
+static constexpr int demoSnapshotMinSkipFrames = GAME_SPEED * 60;
+
+/// a joiner gets a full replay if its sim-state has not arrived after this long
+static const spring_time gameStateTransferTimeout = spring_secs(60);
+
 
 //FIXME remodularize server commands, so they get registered in word completion etc.
 decltype(CGameServer::commandBlacklist) CGameServer::commandBlacklist{
@@ -161,6 +178,7 @@ void CGameServer::Initialize()
 	curSpeedCtrl = configHandler->GetInt("SpeedControl");
 	allowSpecJoin = configHandler->GetBool("AllowSpectatorJoin") || myGameSetup->onlyLocal; ///!!! mantis #4418
 	whiteListAdditionalPlayers = configHandler->GetBool("WhiteListAdditionalPlayers");
+	gameStateJoin = configHandler->GetBool("ServerGameStateJoin");
 	logInfoMessages = configHandler->GetBool("ServerLogInfoMessages");
 	logDebugMessages = configHandler->GetBool("ServerLogDebugMessages");
 
@@ -187,6 +205,10 @@ void CGameServer::Initialize()
 		demoReader.reset(new CDemoReader(myGameSetup->demoName, modGameTime + 0.1f));
 	}
 
+	// join an upstream server (if relaying)
+	if (demoReader == nullptr && !myGameSetup->onlyLocal)
+		ConnectRelayUpstream(configHandler->GetString("ServerRelayUpstream"));
+
 	// initialize players, teams & ais
 	{
 		netPingTimings.fill(spring_notime);
@@ -255,10 +277,14 @@ void CGameServer::Initialize()
 	}
 
 	loopSleepTime = configHandler->GetInt("ServerSleepTime");
+	idleSleepTime = configHandler->GetInt("ServerIdleSleepTime");
+	threadCoreMask = Threading::ParseCoreList(configHandler->GetString("ServerThreadCores"));
+	statsReportInterval = configHandler->GetInt("ServerStatsInterval");
 	linkMinPacketSize = globalConfig.linkIncomingMaxPacketRate > 0 ? (globalConfig.linkIncomingSustainedBandwidth / globalConfig.linkIncomingMaxPacketRate) : 1;
 
 	lastNewFrameTick = spring_gettime();
 	lastBandwidthUpdate = spring_gettime();
+	lastStatsReport = spring_gettime();
 
 	thread = std::move(spring::thread(std::bind(&CGameServer::UpdateLoop, this)));
 
@@ -267,7 +293,7 @@ void CGameServer::Initialize()
 	// Set single precision floating point math.
 	streflop::streflop_init<streflop::Simple>();
 
-	if (!demoReader) {
+	if (demoReader == nullptr && relayLink == nullptr) {
 		GenerateAndSendGameID();
 		rng.Seed(gameID.intArray[0] ^ gameID.intArray[1] ^ gameID.intArray[2] ^ gameID.intArray[3]);
 		Broadcast(CBaseNetProtocol::Get().SendRandSeed(rng()));
@@ -326,7 +352,7 @@ void CGameServer::WriteDemoData()
 		demoRecorder->SetSkirmishAIStats(i, skirmishAIs[i].second.lastStats);
 	}
 	for (int i = 0; i < numTeams; ++i) {
-		record->SetTeamStats(i, teamHandler.Team(i)->statHistory);
+		record->SetTeamStats(i, teamHandler.Team(i)->statHistory, teamHandler.Team(i)->GetCurrentStats());
 	}
 	*/
 }
@@ -406,6 +432,11 @@ void CGameServer::SkipTo(int targetFrameNum)
 	CommandMessage endMsg("skip end", SERVER_PLAYER);
 	Broadcast(std::shared_ptr<const netcode::RawPacket>(startMsg.Pack()));
 
+	// jump ahead to the closest embedded sim-state snapshot if
+	// there is one, only possible when all viewers are local
+	if (CanSendDemoSnapshots() && demoReader->SeekToSnapshot(serverFrameNum + demoSnapshotMinSkipFrames, targetFrameNum))
+		modGameTime = demoReader->GetModGameTime() + 0.001f;
+
 	// fast-read and send demo data
 	//
 	// note that we must maintain <modGameTime> ourselves
@@ -503,10 +534,40 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 			case NETMSG_GAMEDATA:
 			case NETMSG_SETPLAYERNUM:
 			case NETMSG_USER_SPEED:
-			case NETMSG_INTERNAL_SPEED: {
+			case NETMSG_INTERNAL_SPEED:
+			case NETMSG_GAMESTATE_REQUEST:
+			case NETMSG_GAMESTATE: {
 				// never send these from demos
 				break;
 			}
+			case NETMSG_DEMOSNAPSHOT: {
+				// recorded right after simulating its frame, so during normal
+				// playback the viewers are already in this state; following a
+				// SeekToSnapshot they load it instead of simulating up to here
+				if (buf->length < (1 + 4 + 4)) {
+					Message("Warning: Discarding invalid snapshot packet in demo");
+					continue;
+				}
+
+				const int32_t snapshotFrameNum = *reinterpret_cast<const int32_t*>(buf->data + 1 + 4);
+
+				if (snapshotFrameNum == serverFrameNum)
+					break;
+
+				lastNewFrameTick = spring_gettime();
+				serverFrameNum = snapshotFrameNum;
+
+				for (GameParticipant& p: players) {
+					p.lastFrameResponse = serverFrameNum;
+				}
+
+#ifdef SYNCCHECK
+				outstandingSyncFrames.clear();
+#endif
+
+				Broadcast(rpkt);
+				break;
+			}
 			case NETMSG_CCOMMAND: {
 				try {
 					CommandMessage msg(rpkt);
@@ -535,19 +596,174 @@ bool CGameServer::SendDemoData(int targetFrameNum)
 		demoReader.reset();
 		Message(DemoEnd);
 
+		reachedDemoEnd = true;
+
 		ret = false;
 	}
 
 	return ret;
 }
 
+bool CGameServer::CanSendDemoSnapshots() const
+{
+	// snapshots are too large for the network protocol
+	for (const GameParticipant& p: players) {
+		if (p.clientLink != nullptr && !p.isLocal)
+			return false;
+	}
+
+	return HasLocalClient();
+}
+
+void CGameServer::ConnectRelayUpstream(const std::string& upstreamAddress)
+{
+	if (upstreamAddress.empty())
+		return;
+
+	const size_t sepPos = upstreamAddress.rfind(':');
+
+	if (sepPos == std::string::npos || sepPos == 0 || sepPos == (upstreamAddress.size() - 1)) {
+		Message(spring::format("Error: invalid relay upstream address \"%s\" (expected host:port)", upstreamAddress.c_str()), false);
+		return;
+	}
+
+	std::string host = upstreamAddress.substr(0, sepPos);
+	const unsigned port = std::atoi(upstreamAddress.c_str() + sepPos + 1);
+
+	// [::1]:8452
+	if (host.size() > 2 && host.front() == '[' && host.back() == ']')
+		host = host.substr(1, host.size() - 2);
+
+	try {
+		relayLink.reset(new netcode::UDPConnection(0, host, port));
+		relayLink->Unmute();
+		relayLink->SendData(CBaseNetProtocol::Get().SendAttemptConnect(configHandler->GetString("ServerRelayName"), configHandler->GetString("ServerRelayPassword"), SpringVersion::GetSync(), Platform::GetPlatformStr(), globalConfig.networkLossFactor, false, NETFLAG_FRAMEBUNDLES));
+		relayLink->Flush(true);
+	} catch (const std::exception& ex) {
+		Message(spring::format("Error: could not connect to relay upstream %s: %s", upstreamAddress.c_str(), ex.what()), false);
+		relayLink.reset();
+		return;
+	}
+
+	Message(spring::format("Relaying game from upstream server %s:%u", host.c_str(), port), false);
+}
+
+void CGameServer::ReadRelayData()
+{
+	relayLink->Update();
+
+	if (relayLink->CheckTimeout(0, !relayConnected)) {
+		Message(spring::format("Lost connection to relay upstream %s", relayLink->GetFullAddress().c_str()));
+		quitServer = true;
+		return;
+	}
+
+	std::shared_ptr<const RawPacket> rpkt;
+
+	while ((rpkt = relayLink->GetData()) != nullptr) {
+		if (rpkt->length <= 0)
+			continue;
+
+		relayConnected = true;
+
+		switch (rpkt->data[0]) {
+			case NETMSG_SETPLAYERNUM: {
+				// our own id upstream, meaningless to clients
+				relayPlayerNum = rpkt->data[1];
+			} break;
+
+			case NETMSG_GAMEDATA: {
+				// clients receive the setup of this server when they connect
+			} break;
+
+			case NETMSG_REJECT_CONNECT:
+			case NETMSG_QUIT: {
+				Message(spring::format("Relay upstream %s closed the connection", relayLink->GetFullAddress().c_str()));
+				Broadcast(rpkt);
+				quitServer = true;
+				return;
+			} break;
+
+			case NETMSG_NEWFRAME:
+			case NETMSG_KEYFRAME: {
+				// same as demo playback, we can't use CreateNewFrame() here
+				lastNewFrameTick = spring_gettime();
+				serverFrameNum++;
+
+#ifdef SYNCCHECK
+				outstandingSyncFrames.insert(serverFrameNum);
+				CheckSync();
+#endif
+
+				// keep upstream from counting us as lagging
+				if (rpkt->data[0] == NETMSG_KEYFRAME)
+					relayLink->SendData(CBaseNetProtocol::Get().SendKeyFrame(*(int*) &rpkt->data[1]));
+
+				Broadcast(rpkt);
+			} break;
+
+			case NETMSG_STARTPLAYING: {
+				if (!gameHasStarted && *(unsigned*) &rpkt->data[1] == 0) {
+					gameHasStarted = true;
+					startTime = gameTime;
+				}
+
+				Broadcast(rpkt);
+			} break;
+
+			case NETMSG_GAMEID: {
+				std::memcpy(gameID.charArray, &rpkt->data[1], sizeof(gameID.charArray));
+				generatedGameID = true;
+
+				if (demoRecorder != nullptr)
+					demoRecorder->SetGameID(gameID.charArray);
+
+				Broadcast(rpkt);
+			} break;
+
+			case NETMSG_CREATE_NEWPLAYER: {
+				try {
+					netcode::UnpackPacket pckt(rpkt, 3);
+					unsigned char spectator, team, playerNum;
+					std::string name;
+					pckt >> playerNum;
+					pckt >> spectator;
+					pckt >> team;
+					pckt >> name;
+
+					// keep the players vector in sync with upstream, unless a local viewer already took this id
+					if (playerNum >= players.size() || players[playerNum].myState == GameParticipant::UNCONNECTED)
+						AddAdditionalUser(name, "", true, (bool)spectator, (int)team, playerNum);
+					else
+						Message(spring::format("Warning: relay viewer id %u collides with upstream player %s", (unsigned)playerNum, name.c_str()), false);
+				} catch (const netcode::UnpackPacketException& ex) {
+					Message(spring::format("Warning: Discarding invalid new player packet from relay upstream: %s", ex.what()));
+					continue;
+				}
+
+				Broadcast(rpkt);
+			} break;
+
+			default: {
+				Broadcast(rpkt);
+			} break;
+		}
+	}
+
+	relayLink->Flush(false);
+}
+
 void CGameServer::Broadcast(std::shared_ptr<const netcode::RawPacket> packet)
 {
 	for (GameParticipant& p: players) {
+		// gets this from packetCache once its sim-state arrived
+		if (p.awaitingGameState)
+			continue;
+
 		p.SendData(packet);
 	}
 
-	if (canReconnect || allowSpecJoin || !gameHasStarted)
+	if (canReconnect || allowSpecJoin || !gameHasStarted || relayLink != nullptr)
 		packetCache.push_back(packet);
 
 	if (demoRecorder != nullptr)
@@ -579,6 +795,34 @@ void CGameServer::PrivateMessage(int playerNum, const std::string& message) {
 
 
 
+#ifdef SYNCCHECK
+/// names of the sync-lanes in which <p>'s checksums for <frameNum> differ from <correctLanes>
+static std::string GetDesyncedLanes(const GameParticipant& p, int frameNum, const std::array<unsigned int, SYNC_LANE_COUNT>* correctLanes)
+{
+	std::string lanes;
+
+	if (correctLanes == nullptr)
+		return lanes;
+
+	const auto pLanesIt = p.syncLaneResponse.find(frameNum);
+
+	if (pLanesIt == p.syncLaneResponse.end())
+		return lanes;
+
+	for (unsigned int lane = 0; lane < SYNC_LANE_COUNT; lane++) {
+		if (pLanesIt->second[lane] == (*correctLanes)[lane])
+			continue;
+
+		if (!lanes.empty())
+			lanes += ", ";
+
+		lanes += CSyncChecker::GetLaneName(lane);
+	}
+
+	return lanes;
+}
+#endif
+
 void CGameServer::CheckSync()
 {
 #ifdef SYNCCHECK
@@ -666,6 +910,9 @@ void CGameServer::CheckSync()
 		desyncGroups.clear();
 		desyncSpecs.clear();
 
+		// lane checksums of a player that has the correct checksum
+		const std::array<unsigned int, SYNC_LANE_COUNT>* correctLanes = nullptr;
+
 		for (GameParticipant& p: players) {
 			if (p.clientLink == nullptr)
 				continue;
@@ -673,6 +920,10 @@ void CGameServer::CheckSync()
 			const auto pChecksumIt = p.syncResponse.find(outstandingSyncFrame);
 
 			if (pChecksumIt == p.syncResponse.end()) {
+				// never simulated by a client that received a later sim-state
+				if (static_cast<int>(outstandingSyncFrame) <= p.gameStateFrame)
+					continue;
+
 				if (outstandingSyncFrame >= (serverFrameNum - static_cast<int>(SYNCCHECK_TIMEOUT)))
 					completeResponseSet = false;
 				else if (outstandingSyncFrame < p.lastFrameResponse)
@@ -683,6 +934,13 @@ void CGameServer::CheckSync()
 
 			const unsigned pChecksum = pChecksumIt->second;
 
+			if (correctLanes == nullptr && haveCorrectChecksum && pChecksum == correctChecksum) {
+				const auto pLanesIt = p.syncLaneResponse.find(outstandingSyncFrame);
+
+				if (pLanesIt != p.syncLaneResponse.end())
+					correctLanes = &pLanesIt->second;
+			}
+
 			if ((p.desynced = (haveCorrectChecksum && pChecksum != correctChecksum))) {
 				if (demoReader || !p.spectator) {
 					desyncGroups[pChecksum].push_back(p.id);
@@ -735,7 +993,12 @@ void CGameServer::CheckSync()
 				// the resync checksum request packets to multiple clients in the same group.
 				for (const auto& desyncGroup: desyncGroups) {
 					const std::string& playerNames = GetPlayerNames(desyncGroup.second);
+					const std::string& desyncLanes = GetDesyncedLanes(players[desyncGroup.second[0]], outstandingSyncFrame, correctLanes);
+
 					Message(spring::format(SyncError, playerNames.c_str(), outstandingSyncFrame, desyncGroup.first, correctChecksum));
+
+					if (!desyncLanes.empty())
+						Message(spring::format(SyncErrorLanes, playerNames.c_str(), outstandingSyncFrame, desyncLanes.c_str()));
 				}
 
 				// send spectator desyncs as private messages to reduce spam
@@ -744,6 +1007,11 @@ void CGameServer::CheckSync()
 					Message(spring::format(SyncError, players[p.first].name.c_str(), outstandingSyncFrame, p.second, correctChecksum));
 
 					PrivateMessage(p.first, spring::format(SyncError, players[p.first].name.c_str(), outstandingSyncFrame, p.second, correctChecksum));
+
+					const std::string& desyncLanes = GetDesyncedLanes(players[p.first], outstandingSyncFrame, correctLanes);
+
+					if (!desyncLanes.empty())
+						LOG_L(L_ERROR, "%s", spring::format(SyncErrorLanes, players[p.first].name.c_str(), outstandingSyncFrame, desyncLanes.c_str()).c_str());
 				}
 			}
 		}
@@ -751,8 +1019,11 @@ void CGameServer::CheckSync()
 		// Remove complete sets (for which all player's checksums have been received).
 		if (completeResponseSet) {
 			for (GameParticipant& p: players) {
-				if (p.myState < GameParticipant::DISCONNECTED)
-					p.syncResponse.erase(outstandingSyncFrame);
+				if (p.myState >= GameParticipant::DISCONNECTED)
+					continue;
+
+				p.syncResponse.erase(outstandingSyncFrame);
+				p.syncLaneResponse.erase(outstandingSyncFrame);
 			}
 
 			outstandingSyncFrameIt = outstandingSyncFrames.erase(outstandingSyncFrameIt);
@@ -797,8 +1068,12 @@ void CGameServer::Update()
 	if (lastPlayerInfo < (spring_gettime() - playerInfoTime)) {
 		lastPlayerInfo = spring_gettime();
 
-		if (!PreSimFrame()) {
+		if (relayLink != nullptr) {
+			// upstream decides speed and sends player-info for everybody
+		} else if (!PreSimFrame()) {
+			const spring_time t0 = spring_gettime();
 			LagProtection();
+			serverStats.AddPhaseTime(ServerStats::PHASE_LAGPROT, (spring_gettime() - t0).toMilliSecsf());
 		} else {
 			for (GameParticipant& p: players) {
 				if (p.isFromDemo)
@@ -821,7 +1096,12 @@ void CGameServer::Update()
 		}
 	}
 
-	if (!gameHasStarted)
+	if (!gameStateTransfers.empty())
+		UpdateGameStateTransfers();
+
+	if (relayLink != nullptr)
+		ReadRelayData();
+	else if (!gameHasStarted)
 		CheckForGameStart();
 	else if (!PreSimFrame() || demoReader != nullptr)
 		CreateNewFrame(true, false);
@@ -846,7 +1126,8 @@ void CGameServer::Update()
 	const bool canCheckForPlayers = (pregameTimeoutReached || gameHasStarted);
 
 	if (canCheckForPlayers) {
-		bool hasPlayers = false;
+		// a relay stays up for viewers to join as long as upstream does
+		bool hasPlayers = (relayLink != nullptr);
 
 		for (const GameParticipant& p: players) {
 			if ((hasPlayers |= (p.clientLink != nullptr)))
@@ -1016,6 +1297,23 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 	const unsigned a = playerNum;
 	const unsigned msgCode = (unsigned) inbuf[0];
 
+	// relay viewers are passive, only accept what keeps their link and sync-state alive
+	if (relayLink != nullptr) {
+		switch (msgCode) {
+			case NETMSG_KEYFRAME:
+			case NETMSG_PING:
+			case NETMSG_CPU_USAGE:
+			case NETMSG_QUIT:
+			case NETMSG_PATH_CHECKSUM:
+			case NETMSG_CHAT:
+			case NETMSG_SYNCRESPONSE:
+			case NETMSG_CLIENTDATA:
+				break;
+			default:
+				return;
+		}
+	}
+
 	switch (msgCode) {
 		case NETMSG_KEYFRAME: {
 			const int frameNum = *(int*) &inbuf[1];
@@ -1329,11 +1627,19 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			          int  frameNum; pckt >> frameNum;
 			unsigned  int  checkSum; pckt >> checkSum;
 
+			std::array<unsigned int, SYNC_LANE_COUNT> laneCheckSums;
+
+			for (unsigned int& laneCheckSum: laneCheckSums) {
+				pckt >> laneCheckSum;
+			}
+
 			assert(a == playerNum);
 			GameParticipant& p = players[a];
 
-			if (outstandingSyncFrames.find(frameNum) != outstandingSyncFrames.end())
+			if (outstandingSyncFrames.find(frameNum) != outstandingSyncFrames.end()) {
 				p.syncResponse[frameNum] = checkSum;
+				p.syncLaneResponse[frameNum] = laneCheckSums;
+			}
 
 			// update player's ping (if !defined(SYNCCHECK) this is done in NETMSG_KEYFRAME)
 			if (frameNum <= serverFrameNum && frameNum > p.lastFrameResponse)
@@ -1343,7 +1649,13 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			// (the only purpose of this is to allow a client to
 			// detect if it is desynced wrt. a demo-stream)
 			if ((frameNum % syncResponseEchoInterval) == 0) {
-				Broadcast((CBaseNetProtocol::Get()).SendSyncResponse(playerNum, frameNum, checkSum));
+				Broadcast((CBaseNetProtocol::Get()).SendSyncResponse(playerNum, frameNum, checkSum, laneCheckSums.data()));
+			}
+
+			// answer upstream sync-checks on behalf of our viewers (first response wins)
+			if (relayLink != nullptr && relayPlayerNum >= 0 && frameNum > relaySyncFrame) {
+				relayLink->SendData(CBaseNetProtocol::Get().SendSyncResponse(relayPlayerNum, frameNum, checkSum, laneCheckSums.data()));
+				relaySyncFrame = frameNum;
 			}
 #endif
 		} break;
@@ -1803,6 +2115,40 @@ void CGameServer::ProcessPacket(const unsigned playerNum, std::shared_ptr<const
 			break;
 		}
 
+		case NETMSG_GAMESTATE: {
+			try {
+				netcode::UnpackPacket pckt(packet, 3);
+
+				uint8_t joinerNum;
+				int32_t frameNum;
+				uint32_t stateSize;
+				uint32_t partOffset;
+
+				pckt >> joinerNum;
+				pckt >> frameNum;
+				pckt >> stateSize;
+				pckt >> partOffset;
+
+				const auto pred = [&](const GameStateTransfer& t) { return (t.donorNum == static_cast<int>(a) && t.joinerNum == joinerNum && t.frameNum == frameNum); };
+				const auto iter = std::find_if(gameStateTransfers.begin(), gameStateTransfers.end(), pred);
+
+				// late parts of a transfer that timed out, or spoofed ones
+				if (iter == gameStateTransfers.end())
+					break;
+
+				// relayed as-is, the joiner reassembles and loads it
+				players[joinerNum].SendData(packet);
+
+				const uint32_t partSize = packet->length - (1 + 2 + 1 + 4 + 4 + 4);
+
+				if ((partOffset + partSize) >= stateSize)
+					FinishGameStateTransfer(iter - gameStateTransfers.begin(), true);
+			} catch (const netcode::UnpackPacketException& ex) {
+				Message(spring::format("Player %s sent invalid GameState: %s", players[a].name.c_str(), ex.what()));
+			}
+			break;
+		}
+
 #ifdef SYNCDEBUG
 		case NETMSG_SD_CHKRESPONSE:
 		case NETMSG_SD_BLKRESPONSE:
@@ -1859,6 +2205,7 @@ void CGameServer::HandleConnectionAttempts()
 			std::string platform;
 			uint8_t reconnect;
 			uint8_t netloss;
+			uint8_t netflags;
 			uint16_t netversion;
 			msg >> netversion;
 			msg >> name;
@@ -1867,11 +2214,12 @@ void CGameServer::HandleConnectionAttempts()
 			msg >> platform;
 			msg >> reconnect;
 			msg >> netloss;
+			msg >> netflags;
 
 			if (netversion != NETWORK_VERSION)
 				throw netcode::UnpackPacketException(spring::format("Wrong network version: received %d, required %d", (int)netversion, (int)NETWORK_VERSION));
 
-			BindConnection(udpListener->AcceptConnection(), name, passwd, version, platform, false, reconnect, netloss);
+			BindConnection(udpListener->AcceptConnection(), name, passwd, version, platform, false, reconnect, netloss, netflags);
 		} catch (const netcode::UnpackPacketException& ex) {
 			const asio::ip::udp::endpoint endp = prev->GetEndpoint();
 			const asio::ip::address addr = endp.address();
@@ -2211,6 +2559,8 @@ void CGameServer::StartGame(bool forced)
 
 	Broadcast(CBaseNetProtocol::Get().SendStartPlaying(0));
 
+	gameStartCacheIndex = packetCache.size();
+
 	if (hostif != nullptr) {
 		if (demoRecorder != nullptr) {
 			hostif->SendStartPlaying(gameID.charArray, demoRecorder->GetName());
@@ -2620,6 +2970,21 @@ void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 	if (normalFrame || videoFrame || singleStep) {
 		assert(demoReader == nullptr);
 
+		if (numNewFrames > 0) {
+			const spring_time curFrameBroadcast = spring_gettime();
+
+			// frames are normally created one per tick, a tick creating
+			// several of them expects a proportionally longer interval
+			const float curFrameInterval = (curFrameBroadcast - lastFrameBroadcast).toMilliSecsf();
+			const float tgtFrameInterval = (1000.0f * numNewFrames) / (GAME_SPEED * internalSpeed);
+
+			if (spring_istime(lastFrameBroadcast))
+				serverStats.AddFrameJitter(std::fabs(curFrameInterval - tgtFrameInterval));
+
+			serverStats.numFrames += numNewFrames;
+			lastFrameBroadcast = curFrameBroadcast;
+		}
+
 		for (unsigned int i = 0; i < numNewFrames; ++i) {
 			++serverFrameNum;
 
@@ -2644,6 +3009,9 @@ void CGameServer::CreateNewFrame(bool fromServerThread, bool fixedFrameTime)
 			outstandingSyncFrames.insert(serverFrameNum);
 		#endif
 		}
+	} else {
+		// pauses are not jitter
+		lastFrameBroadcast = spring_notime;
 	}
 }
 
@@ -2669,22 +3037,61 @@ std::string CGameServer::SpeedControlToString(int speedCtrl)
 }
 
 
+bool CGameServer::IsIdle() const
+{
+	if (idleSleepTime <= loopSleepTime)
+		return false;
+	// local connections and the in-process client are not socket-driven
+	if (udpListener == nullptr || HasLocalClient())
+		return false;
+
+	return (!gameHasStarted || isPaused);
+}
+
+
 __FORCE_ALIGN_STACK__
 void CGameServer::UpdateLoop()
 {
 	try {
 		Threading::SetThreadName("netcode");
-		Threading::SetAffinity(~0);
+		Threading::SetAffinity((threadCoreMask != 0)? threadCoreMask: ~0u);
 
 		while (!quitServer) {
-			spring_msecs(loopSleepTime).sleep(true);
+			if (IsIdle()) {
+				// nothing is simulated, only packets can make work; block
+				// on the socket instead of ticking at the regular rate
+				udpListener->WaitForData(idleSleepTime);
+			} else {
+				spring_msecs(loopSleepTime).sleep(true);
+			}
+
+			const spring_time t0 = spring_gettime();
 
 			if (udpListener != nullptr)
 				udpListener->Update();
 
 			std::lock_guard<spring::recursive_mutex> scoped_lock(gameServerMutex);
+
+			const spring_time t1 = spring_gettime();
 			ServerReadNet();
+			const spring_time t2 = spring_gettime();
 			Update();
+			const spring_time t3 = spring_gettime();
+
+			// links flushed by the above would otherwise wait for the next iteration
+			if (udpListener != nullptr)
+				udpListener->FlushSendQueue();
+
+			const spring_time t4 = spring_gettime();
+
+			serverStats.AddPhaseTime(ServerStats::PHASE_LISTENER, (t1 - t0).toMilliSecsf());
+			serverStats.AddPhaseTime(ServerStats::PHASE_READNET, (t2 - t1).toMilliSecsf());
+			serverStats.AddPhaseTime(ServerStats::PHASE_UPDATE, (t3 - t2).toMilliSecsf());
+			serverStats.AddPhaseTime(ServerStats::PHASE_FLUSH, (t4 - t3).toMilliSecsf());
+			serverStats.maxTickTime = std::max(serverStats.maxTickTime, (t4 - t0).toMilliSecsf());
+			serverStats.numTicks += 1;
+
+			ReportServerStats();
 		}
 
 		if (hostif != nullptr)
@@ -2703,6 +3110,15 @@ void CGameServer::UpdateLoop()
 				p.clientLink->Flush();
 		}
 
+		if (udpListener != nullptr)
+			udpListener->FlushSendQueue();
+
+		// leave upstream cleanly so it does not wait for our timeout
+		if (relayLink != nullptr) {
+			relayLink->SendData(CBaseNetProtocol::Get().SendQuit("Relay shutdown"));
+			relayLink->Flush(true);
+		}
+
 		// now let clients close their connections
 		if (!reloadingServer && !myGameSetup->onlyLocal)
 			spring_sleep(spring_msecs(1500));
@@ -2711,6 +3127,47 @@ void CGameServer::UpdateLoop()
 }
 
 
+void CGameServer::ReportServerStats()
+{
+	if (statsReportInterval <= 0 || hostif == nullptr)
+		return;
+	if (spring_gettime() < (lastStatsReport + spring_secs(statsReportInterval)))
+		return;
+
+	std::vector<ServerLinkStats> links;
+	links.reserve(players.size());
+
+	for (const GameParticipant& p: players) {
+		if (p.clientLink == nullptr)
+			continue;
+
+		ServerLinkStats link;
+		link.playerNum = p.id;
+		link.numIncoming = std::min(p.clientLink->GetPacketQueueSize(), 0xFFFFu);
+		link.numOutgoing = std::min(p.clientLink->GetOutgoingQueueSize(), 0xFFFFu);
+		link.numUnacked = std::min(p.clientLink->GetUnackedChunkCount(), 0xFFFFu);
+		link.frameLag = Clamp(serverFrameNum - p.lastFrameResponse, 0, 0xFFFF);
+
+		links.push_back(link);
+	}
+
+	serverStats.serverFrameNum = serverFrameNum;
+	hostif->SendServerStats(serverStats, links);
+	serverStats.Reset();
+
+	std::vector<MemoryStats::Entry> memEntries;
+
+	// no game polls the sources on a dedicated server
+	#ifdef DEDICATED
+	MemoryStats::Update();
+	#endif
+	MemoryStats::GetEntries(memEntries);
+	hostif->SendMemoryStats(memEntries);
+
+	lastStatsReport = spring_gettime();
+}
+
+
 void CGameServer::KickPlayer(int playerNum)
 {
 	// only kick connected players
@@ -2802,8 +3259,11 @@ bool CGameServer::CheckPlayerPassword(const int playerNum, const std::string& pw
 }
 
 
-void CGameServer::AddAdditionalUser(const std::string& name, const std::string& passwd, bool fromDemo, bool spectator, int team, int playerNum)
+unsigned CGameServer::AddAdditionalUser(const std::string& name, const std::string& passwd, bool fromDemo, bool spectator, int team, int playerNum)
 {
+	// relay viewers take ids from the top down, upstream assigns the rest
+	if (playerNum < 0 && relayLink != nullptr)
+		playerNum = MAX_PLAYERS - 1 - std::min(numRelayViewers++, MAX_PLAYERS - 1u);
 	if (playerNum < 0)
 		playerNum = players.size();
 	if (playerNum >= players.size())
@@ -2825,6 +3285,8 @@ void CGameServer::AddAdditionalUser(const std::string& name, const std::string&
 	// inform all the players of the newcomer
 	if (!fromDemo)
 		Broadcast(CBaseNetProtocol::Get().SendCreateNewPlayer(p.id, p.spectator, p.team, p.name));
+
+	return playerNum;
 }
 
 
@@ -2836,7 +3298,8 @@ unsigned CGameServer::BindConnection(
 	const std::string& clientPlatform,
 	bool isLocal,
 	bool reconnect,
-	int netloss
+	int netloss,
+	int netflags
 ) {
 	Message(spring::format("%s attempt from %s", (reconnect ? "Reconnection" : "Connection"), clientName.c_str()));
 	Message(spring::format(" -> Version: %s [%s]", clientVersion.c_str(), clientPlatform.c_str()));
@@ -2917,7 +3380,7 @@ unsigned CGameServer::BindConnection(
 				clientName = "~" + clientName;
 
 			if (demoReader || allowSpecJoin)
-				AddAdditionalUser(clientName, clientPassword);
+				newPlayerNumber = AddAdditionalUser(clientName, clientPassword);
 			else
 				errMsg = "User name not authorized to connect";
 		}
@@ -2971,11 +3434,13 @@ unsigned CGameServer::BindConnection(
 
 		Message(spring::format(" -> Connection reestablished (id %i)", newPlayerNumber));
 		newPlayer.clientLink->SetLossFactor(netloss);
+		newPlayer.clientLink->SetFrameBundling(globalConfig.networkFrameBundles && (netflags & NETFLAG_FRAMEBUNDLES) != 0);
 		newPlayer.clientLink->Flush(!gameHasStarted);
 		return newPlayerNumber;
 	}
 
 	newPlayer.Connected(clientLink, isLocal);
+	newPlayer.clientLink->SetFrameBundling(globalConfig.networkFrameBundles && (netflags & NETFLAG_FRAMEBUNDLES) != 0);
 	newPlayer.SendData(std::shared_ptr<const RawPacket>(myGameData->Pack()));
 	newPlayer.SendData(CBaseNetProtocol::Get().SendSetPlayerNum((unsigned char)newPlayerNumber));
 
@@ -2995,9 +3460,18 @@ unsigned CGameServer::BindConnection(
 		}
 	}
 
-	// finally send player all packets he missed until now
-	for (const std::shared_ptr<const netcode::RawPacket>& p: packetCache)
-		newPlayer.SendData(p);
+	// finally send player all packets he missed until now; if the game is
+	// running and another client can send its sim-state, only those up to
+	// the game-start (the rest follows the state, see FinishGameStateTransfer)
+	if (gameHasStarted && CanTransferGameState(newPlayer)) {
+		for (size_t i = 0; i < gameStartCacheIndex; i++)
+			newPlayer.SendData(packetCache[i]);
+
+		RequestGameState(newPlayerNumber);
+	} else {
+		for (const std::shared_ptr<const netcode::RawPacket>& p: packetCache)
+			newPlayer.SendData(p);
+	}
 
 	// new connection established
 	Message(spring::format(" -> Connection established (given id %i)", newPlayerNumber));
@@ -3007,6 +3481,116 @@ unsigned CGameServer::BindConnection(
 }
 
 
+bool CGameServer::CanTransferGameState(const GameParticipant& joiner) const
+{
+	if (!gameStateJoin || demoReader != nullptr || relayLink != nullptr)
+		return false;
+	// packetCache is no longer kept
+	if (!canReconnect && !allowSpecJoin)
+		return false;
+
+	return (FindGameStateDonor(joiner.id) >= 0);
+}
+
+int CGameServer::FindGameStateDonor(int joinerNum) const
+{
+	int donorNum = -1;
+	int donorLag = std::numeric_limits<int>::max();
+
+	for (const GameParticipant& p: players) {
+		if (p.id == joinerNum || p.clientLink == nullptr || p.myState != GameParticipant::INGAME)
+			continue;
+		if (p.awaitingGameState || p.isFromDemo || p.IsDesynced())
+			continue;
+
+		// a local client can hand over its state without using the network
+		const int lag = (serverFrameNum - p.lastFrameResponse) - (p.isLocal * GAME_SPEED);
+
+		if (lag >= donorLag)
+			continue;
+
+		donorNum = p.id;
+		donorLag = lag;
+	}
+
+	return donorNum;
+}
+
+void CGameServer::RequestGameState(int joinerNum)
+{
+	GameParticipant& joiner = players[joinerNum];
+	const int donorNum = FindGameStateDonor(joinerNum);
+
+	// left over from a previous connection of the same client
+	spring::VectorEraseIf(gameStateTransfers, [&](const GameStateTransfer& t) { return (t.joinerNum == joinerNum); });
+
+	if (donorNum < 0) {
+		// nobody left to ask, replay everything since game-start
+		for (size_t i = gameStartCacheIndex; i < packetCache.size(); i++)
+			joiner.SendData(packetCache[i]);
+
+		return;
+	}
+
+	// the donor reads the request after every cached packet, its state
+	// follows the last frame sent so far and covers all of packetCache
+	joiner.awaitingGameState = true;
+	players[donorNum].SendData(CBaseNetProtocol::Get().SendGameStateRequest(joinerNum));
+	gameStateTransfers.push_back({joinerNum, donorNum, serverFrameNum, packetCache.size(), spring_gettime()});
+
+	Message(spring::format(" -> requested sim-state of frame %d from %s", serverFrameNum, players[donorNum].name.c_str()), false);
+}
+
+void CGameServer::FinishGameStateTransfer(size_t transferIdx, bool received)
+{
+	const GameStateTransfer transfer = gameStateTransfers[transferIdx];
+	GameParticipant& joiner = players[transfer.joinerNum];
+
+	gameStateTransfers[transferIdx] = gameStateTransfers.back();
+	gameStateTransfers.pop_back();
+
+	joiner.awaitingGameState = false;
+
+	if (joiner.clientLink == nullptr)
+		return;
+
+	if (!received) {
+		// a partially received state is never loaded, the joiner simulates every frame instead
+		Message(spring::format(" -> sim-state transfer to %s failed, sending all frames", joiner.name.c_str()), false);
+
+		for (size_t i = gameStartCacheIndex; i < packetCache.size(); i++)
+			joiner.SendData(packetCache[i]);
+
+		return;
+	}
+
+	joiner.gameStateFrame = transfer.frameNum;
+	joiner.lastFrameResponse = std::max(joiner.lastFrameResponse, transfer.frameNum);
+
+	for (size_t i = transfer.cacheIndex; i < packetCache.size(); i++)
+		joiner.SendData(packetCache[i]);
+}
+
+void CGameServer::UpdateGameStateTransfers()
+{
+	for (size_t i = 0; i < gameStateTransfers.size(); ) {
+		const GameStateTransfer& transfer = gameStateTransfers[i];
+		const GameParticipant& donor = players[transfer.donorNum];
+
+		if (players[transfer.joinerNum].clientLink == nullptr) {
+			FinishGameStateTransfer(i, false);
+			continue;
+		}
+		if (donor.clientLink == nullptr || donor.myState != GameParticipant::INGAME || (transfer.requestTime + gameStateTransferTimeout) < spring_gettime()) {
+			FinishGameStateTransfer(i, false);
+			continue;
+		}
+
+		++i;
+	}
+}
+
+
 void CGameServer::GotChatMessage(const ChatMessage& msg)
 {
 	// silently drop empty chat messages
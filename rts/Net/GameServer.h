@@ -15,6 +15,7 @@
 #include <vector>
 
 #include "Game/GameData.h"
+#include "Net/ServerStats.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamBase.h"
 #include "System/float3.h"
@@ -98,6 +99,8 @@ public:
 	bool HasLocalClient() const { return (localClientNumber != -1u); }
 	/// Is the server still running?
 	bool HasFinished() const;
+	/// Has every message of the demo being played been sent?
+	bool ReachedDemoEnd() const { return reachedDemoEnd; }
 
 	void UpdateSpeedControl(int speedCtrl);
 	static std::string SpeedControlToString(int speedCtrl);
@@ -152,12 +155,15 @@ private:
 		const std::string& clientPlatform,
 		bool isLocal,
 		bool reconnect = false,
-		int netloss = 0
+		int netloss = 0,
+		int netflags = 0
 	);
 
 	void CheckForGameStart(bool forced = false);
 	void StartGame(bool forced);
 	void UpdateLoop();
+	/// true if the loop may block on the network instead of ticking
+	bool IsIdle() const;
 	void Update();
 	void ProcessPacket(const unsigned playerNum, std::shared_ptr<const netcode::RawPacket> packet);
 	void CheckSync();
@@ -166,12 +172,33 @@ private:
 
 	void LagProtection();
 
+	/// send accumulated ServerStats to the autohost every <statsReportInterval> seconds
+	void ReportServerStats();
+
 	/** @brief Generate a unique game identifier and send it to all clients. */
 	void GenerateAndSendGameID();
 
 	void WriteDemoData();
 	/// read data from demo and send it to clients
 	bool SendDemoData(int targetFrameNum);
+	/// whether viewers can receive NETMSG_DEMOSNAPSHOT, see SkipTo
+	bool CanSendDemoSnapshots() const;
+
+	/// whether a client (re)joining the running game can be sent the sim-state of another client
+	bool CanTransferGameState(const GameParticipant& joiner) const;
+	/// the most up-to-date client that is in sync and can send its sim-state to <joinerNum>, or -1
+	int FindGameStateDonor(int joinerNum) const;
+	/// asks a donor for the sim-state of joiner <joinerNum>, falls back to a full replay if there is none
+	void RequestGameState(int joinerNum);
+	/// sends the frames following the transferred sim-state, or all frames since game-start if it failed
+	void FinishGameStateTransfer(size_t transferIdx, bool received);
+	/// drops transfers whose joiner left, and gives up on those whose donor left or timed out
+	void UpdateGameStateTransfers();
+
+	/// join an upstream server as spectator and fan its stream out to our own clients
+	void ConnectRelayUpstream(const std::string& upstreamAddress);
+	/// read data from the upstream server and send it to clients
+	void ReadRelayData();
 
 	void Broadcast(std::shared_ptr<const netcode::RawPacket> packet);
 
@@ -179,7 +206,8 @@ private:
 	 * @brief skip frames
 	 *
 	 * If you are watching a demo, this will push out all data until
-	 * targetFrame to all clients
+	 * targetFrame to all clients; data before the last sim-state
+	 * snapshot preceding targetFrame is skipped when possible
 	 */
 	void SkipTo(int targetFrameNum);
 
@@ -193,7 +221,7 @@ private:
 	void InternalSpeedChange(float newSpeed);
 	void UserSpeedChange(float newSpeed, int player);
 
-	void AddAdditionalUser( const std::string& name, const std::string& passwd, bool fromDemo = false, bool spectator = true, int team = 0, int playerNum = -1);
+	unsigned AddAdditionalUser( const std::string& name, const std::string& passwd, bool fromDemo = false, bool spectator = true, int team = 0, int playerNum = -1);
 
 	uint8_t ReserveSkirmishAIId();
 
@@ -223,6 +251,20 @@ private:
 
 	std::deque< std::shared_ptr<const netcode::RawPacket> > packetCache;
 
+	struct GameStateTransfer {
+		int joinerNum;
+		int donorNum;
+		int frameNum;
+		/// first packet in packetCache that is not part of the donor's sim-state
+		size_t cacheIndex;
+		spring_time requestTime;
+	};
+
+	std::vector<GameStateTransfer> gameStateTransfers;
+
+	/// packets in packetCache up to NETMSG_STARTPLAYING, sent to every joiner
+	size_t gameStartCacheIndex = 0;
+
 	/////////////////// sync stuff ///////////////////
 #ifdef SYNCCHECK
 	std::set<int> outstandingSyncFrames;
@@ -236,6 +278,8 @@ private:
 	spring_time lastPlayerInfo = spring_notime;
 	spring_time lastUpdate = spring_notime;
 	spring_time lastBandwidthUpdate = spring_notime;
+	spring_time lastStatsReport = spring_notime;
+	spring_time lastFrameBroadcast = spring_notime;
 
 	float modGameTime = 0.0f;
 	float gameTime = 0.0f;
@@ -249,6 +293,10 @@ private:
 	int medianPing = 0;
 	int curSpeedCtrl = 0;
 	int loopSleepTime = 0;
+	/// ServerIdleSleepTime, upper bound for blocking on the socket while idle
+	int idleSleepTime = 0;
+	/// ServerThreadCores, 0 if unset
+	std::uint32_t threadCoreMask = 0;
 
 
 	int serverFrameNum = -1;
@@ -276,6 +324,8 @@ private:
 	bool allowSpecDraw = true;
 	bool allowSpecJoin = false;
 	bool whiteListAdditionalPlayers = false;
+	/// ServerGameStateJoin, send (re)joining clients the sim-state of another client instead of every past frame
+	bool gameStateJoin = false;
 
 	bool logInfoMessages = false;
 	bool logDebugMessages = false;
@@ -289,6 +339,21 @@ private:
 	std::unique_ptr<CDemoRecorder> demoRecorder;
 	std::unique_ptr<AutohostInterface> hostif;
 
+	/// accumulated between two reports to the autohost
+	ServerStats serverStats;
+	int statsReportInterval = 0;
+
+	/// link to the upstream server when acting as a spectator relay
+	std::shared_ptr<netcode::CConnection> relayLink;
+
+	/// our own player-number on the upstream server
+	int relayPlayerNum = -1;
+	/// last frame for which a sync-response was forwarded upstream
+	int relaySyncFrame = -1;
+	/// local viewers take player-numbers from the top of the id-space down
+	unsigned numRelayViewers = 0;
+	bool relayConnected = false;
+
 	CGlobalUnsyncedRNG rng;
 	spring::thread thread;
 
@@ -298,6 +363,7 @@ private:
 	std::atomic<bool> generatedGameID{false};
 	std::atomic<bool> reloadingServer{false};
 	std::atomic<bool> quitServer{false};
+	std::atomic<bool> reachedDemoEnd{false};
 
 	union {
 		unsigned char charArray[16];
@@ -1,5 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <array>
 #include <cinttypes>
 
 #include "Game/Game.h"
@@ -33,6 +35,7 @@
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
 #include "System/TimeProfiler.h"
+#include "System/LoadSave/DemoBatch.h"
 #include "System/LoadSave/DemoRecorder.h"
 #include "System/Net/UnpackPacket.h"
 #include "System/Sound/ISound.h"
@@ -43,6 +46,7 @@ CONFIG(bool, LogClientData).defaultValue(false);
 LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_NET)
 
 static spring::unordered_map<int32_t, uint32_t> localSyncChecksums;
+static spring::unordered_map<int32_t, std::array<uint32_t, SYNC_LANE_COUNT>> localSyncLaneChecksums;
 
 
 void CGame::AddTraffic(int playerID, int packetCode, int length)
@@ -182,9 +186,56 @@ void CGame::UpdateNumQueuedSimFrames()
 	if (numQueuedFrames == 0)
 		msgProcTimeLeft = -1000.0f * gs->speedFactor;
 
+	UpdateCatchUp(numQueuedFrames);
+
 	lastUpdateTime = currTime;
 }
 
+void CGame::UpdateCatchUp(uint32_t numQueuedFrames)
+{
+	// hysteresis, small backlogs are left to consumeSpeedMult
+	constexpr uint32_t CATCHUP_START_LAG = GAME_SPEED * 5;
+	constexpr uint32_t CATCHUP_END_LAG = GAME_SPEED / 2;
+
+	const spring_time currTime = spring_gettime();
+
+	if (catchUpFrames == 0) {
+		if (numQueuedFrames < CATCHUP_START_LAG || skipping)
+			return;
+
+		catchUpStartLag = numQueuedFrames;
+		catchUpStartTime = currTime;
+
+		LOG("[Game::%s] %u frames behind the server, catching up", __func__, numQueuedFrames);
+	} else if (numQueuedFrames <= CATCHUP_END_LAG || skipping) {
+		LOG("[Game::%s] caught up with the server after %.1f seconds", __func__, (currTime - catchUpStartTime).toSecsf());
+
+		catchUpFrames = 0;
+		catchUpLag = 0;
+		profiler.SetCounter("Misc::CatchUp::FramesBehind", 0);
+		profiler.SetCounter("Misc::CatchUp::SimFramesPerDraw", 0);
+		return;
+	}
+
+	catchUpLag = numQueuedFrames;
+
+	// the server keeps advancing while we catch up
+	const float secsLeft = std::max(1.0f, catchUpTargetTime - (currTime - catchUpStartTime).toSecsf());
+	const float wantedSimRate = (numQueuedFrames / secsLeft + GAME_SPEED * gs->speedFactor) * 0.001f; // frames per msec
+
+	const float simFrameTime = std::max(0.01f, gu->avgSimFrameTime);
+	const float drawFrameTime = std::max(0.01f, gu->avgDrawFrameTime);
+
+	// n sim-frames per drawn frame give a rate of n / (drawFrameTime + n * simFrameTime)
+	const float maxFramesPerDraw = std::max(1.0f, (1000.0f / catchUpMinDrawFPS - drawFrameTime) / simFrameTime);
+	const float reqFramesPerDraw = (wantedSimRate * simFrameTime < 1.0f)? (wantedSimRate * drawFrameTime / (1.0f - wantedSimRate * simFrameTime)): maxFramesPerDraw;
+
+	catchUpFrames = std::ceil(Clamp(reqFramesPerDraw, 1.0f, maxFramesPerDraw));
+
+	profiler.SetCounter("Misc::CatchUp::FramesBehind", numQueuedFrames);
+	profiler.SetCounter("Misc::CatchUp::SimFramesPerDraw", catchUpFrames);
+}
+
 void CGame::UpdateNetMessageProcessingTimeLeft()
 {
 	// compute new msgProcTimeLeft to "smooth" out SimFrame() calls
@@ -194,6 +245,9 @@ void CGame::UpdateNetMessageProcessingTimeLeft()
 
 		if (skipping) {
 			msgProcTimeLeft = 10.0f;
+		} else if (catchUpFrames > 0) {
+			// SimFrame() subtracts 1000 per frame
+			msgProcTimeLeft = catchUpFrames * 1000.0f;
 		} else {
 			// at <N> Hz we should consume one simframe message every (1000/N) ms
 			//
@@ -223,6 +277,13 @@ float CGame::GetNetMessageProcessingTimeLimit() const
 	const float minDrawFPS   =         CGlobalUnsynced::reconnectSimDrawBalance  * 1000.0f / std::max(0.01f, gu->avgDrawFrameTime);
 	const float simDrawRatio = maxSimFPS / minDrawFPS;
 
+	// the frame-count is bounded by UpdateCatchUp, this only guards against spikes
+	if (catchUpFrames > 0)
+		return (std::max(5.0f, 1000.0f / catchUpMinDrawFPS - gu->avgDrawFrameTime));
+	// frame-pacing trades sim latency for an even draw cadence
+	if (framePacingSimBudget > 0.0f)
+		return framePacingSimBudget;
+
 	return Clamp(simDrawRatio * gu->avgSimFrameTime, 5.0f, 1000.0f / CGlobalUnsynced::minDrawFPS);
 }
 
@@ -265,8 +326,12 @@ void CGame::ClientReadNet()
 
 					const  int32_t syncFrameNum = *reinterpret_cast<const int32_t*>(peekPacket->data + sizeof(uint8_t) + sizeof(uint8_t));
 					const uint32_t syncCheckSum = localSyncChecksums[syncFrameNum];
+					const auto& syncLaneCheckSums = localSyncLaneChecksums[syncFrameNum];
+
+					uint8_t* syncCheckSumData = peekPacket->data + sizeof(uint8_t) + sizeof(uint8_t) + sizeof(int32_t);
 
-					memcpy(peekPacket->data + sizeof(uint8_t) + sizeof(uint8_t) + sizeof(int32_t), &syncCheckSum, sizeof(syncCheckSum));
+					memcpy(syncCheckSumData, &syncCheckSum, sizeof(syncCheckSum));
+					memcpy(syncCheckSumData + sizeof(syncCheckSum), syncLaneCheckSums.data(), sizeof(syncLaneCheckSums));
 				}
 			}
 		}
@@ -561,15 +626,23 @@ void CGame::ClientReadNet()
 
 				SimFrame();
 
+				// recorded right behind this frame's message, see CGameServer::SendDemoData
+				if (demoSnapshotInterval > 0 && (gs->frameNum % demoSnapshotInterval) == 0 && gs->frameNum > 0)
+					SaveDemoSnapshot();
+
 #ifdef SYNCCHECK
 				// both NETMSG_SYNCRESPONSE and NETMSG_NEWFRAME are used for ping calculation by server
 				ASSERT_SYNCED(gs->frameNum);
 				ASSERT_SYNCED(CSyncChecker::GetChecksum());
-				clientNet->Send(CBaseNetProtocol::Get().SendSyncResponse(gu->myPlayerNum, gs->frameNum, CSyncChecker::GetChecksum()));
+				clientNet->Send(CBaseNetProtocol::Get().SendSyncResponse(gu->myPlayerNum, gs->frameNum, CSyncChecker::GetChecksum(), CSyncChecker::GetLaneChecksums()));
 
 				// buffer all checksums, so we can check sync later between demo & local
-				if (haveServerDemo)
+				if (haveServerDemo) {
 					localSyncChecksums[gs->frameNum] = CSyncChecker::GetChecksum();
+					std::copy_n(CSyncChecker::GetLaneChecksums(), SYNC_LANE_COUNT, localSyncLaneChecksums[gs->frameNum].begin());
+				}
+				if (DemoBatch::IsWorker())
+					DemoBatch::AddSyncChecksum(CSyncChecker::GetChecksum());
 
 				// reset checksum every 4096 frames =~ 2.5 minutes
 				if ((gs->frameNum & 4095) == 0)
@@ -578,6 +651,34 @@ void CGame::ClientReadNet()
 				AddTraffic(-1, packetCode, dataLength);
 			} break;
 
+			case NETMSG_DEMOSNAPSHOT: {
+				// only sent by a local demo-server skipping ahead
+				AddTraffic(-1, packetCode, dataLength);
+
+				// the messages that follow are for the game rebuilt from it
+				if (LoadDemoSnapshot(packet))
+					return;
+			} break;
+
+			case NETMSG_GAMESTATE_REQUEST: {
+				// the server wants our state for a client joining the running game
+				SendGameState(inbuf[1]);
+				AddTraffic(-1, packetCode, dataLength);
+			} break;
+
+			case NETMSG_GAMESTATE: {
+				// we are joining, this replaces every frame simulated before it
+				AddTraffic(-1, packetCode, dataLength);
+
+				try {
+					// the messages that follow are for the game rebuilt from it
+					if (ReadGameStatePart(packet))
+						return;
+				} catch (const netcode::UnpackPacketException& ex) {
+					LOG_L(L_ERROR, "[Game::%s][NETMSG_GAMESTATE] exception \"%s\"", __func__, ex.what());
+				}
+			} break;
+
 			case NETMSG_SYNCRESPONSE: {
 #if (defined(SYNCCHECK))
 				if (haveServerDemo) {
@@ -591,7 +692,14 @@ void CGame::ClientReadNet()
 					int32_t   frameNum; pckt >> frameNum;
 					uint32_t  checkSum; pckt >> checkSum;
 
+					std::array<uint32_t, SYNC_LANE_COUNT> laneCheckSums;
+
+					for (uint32_t& laneCheckSum: laneCheckSums) {
+						pckt >> laneCheckSum;
+					}
+
 					const uint32_t ourCheckSum = localSyncChecksums[frameNum];
+					const auto& ourLaneCheckSums = localSyncLaneChecksums[frameNum];
 
 					// check if our checksum for this frame matches what
 					// player <playerNum> sent to the server at the same
@@ -608,6 +716,15 @@ void CGame::ClientReadNet()
 					const char* fmtStr = "[DESYNC WARNING] checksum %x from demo %s %d (%s) does not match our checksum %x for frame-number %d";
 
 					LOG_L(L_ERROR, fmtStr, checkSum, pType, playerNum, pName, ourCheckSum, frameNum);
+
+					for (unsigned int lane = 0; lane < SYNC_LANE_COUNT; lane++) {
+						if (laneCheckSums[lane] == ourLaneCheckSums[lane])
+							continue;
+
+						LOG_L(L_ERROR, "[DESYNC WARNING]\tlane %s: %x (demo) vs. %x (ours)", CSyncChecker::GetLaneName(lane), laneCheckSums[lane], ourLaneCheckSums[lane]);
+					}
+
+					DemoBatch::AddDesync();
 				}
 #endif
 			} break;
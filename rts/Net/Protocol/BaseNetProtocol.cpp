@@ -10,6 +10,7 @@
 #include <cinttypes>
 
 using netcode::PackPacket;
+using netcode::SharePacket;
 typedef std::shared_ptr<const netcode::RawPacket> PacketType;
 
 CBaseNetProtocol& CBaseNetProtocol::Get()
@@ -22,12 +23,12 @@ PacketType CBaseNetProtocol::SendKeyFrame(int32_t frameNum)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(frameNum), NETMSG_KEYFRAME);
 	*packet << frameNum;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendNewFrame()
 {
-	return PacketType(new PackPacket(sizeof(uint8_t), NETMSG_NEWFRAME));
+	return SharePacket(new PackPacket(sizeof(uint8_t), NETMSG_NEWFRAME));
 }
 
 
@@ -43,21 +44,21 @@ PacketType CBaseNetProtocol::SendQuit(const std::string& reason)
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_QUIT);
 	*packet << static_cast<uint16_t>(packetSize) << reason;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendStartPlaying(uint32_t countdown)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(countdown), NETMSG_STARTPLAYING);
 	*packet << countdown;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendSetPlayerNum(uint8_t playerNum)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum), NETMSG_SETPLAYERNUM);
 	*packet << playerNum;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendPlayerName(uint8_t playerNum, const std::string& playerName)
@@ -68,14 +69,14 @@ PacketType CBaseNetProtocol::SendPlayerName(uint8_t playerNum, const std::string
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_PLAYERNAME);
 	*packet << static_cast<uint8_t>(packetSize) << playerNum << playerName;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendRandSeed(uint32_t randSeed)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(randSeed), NETMSG_RANDSEED);
 	*packet << randSeed;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 // NETMSG_GAMEID = 9, char gameID[16];
@@ -83,7 +84,7 @@ PacketType CBaseNetProtocol::SendGameID(const uint8_t* buf)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + 16, NETMSG_GAMEID);
 	memcpy(packet->GetWritingPos(), buf, 16);
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendPathCheckSum(uint8_t playerNum, uint32_t checksum)
@@ -91,7 +92,7 @@ PacketType CBaseNetProtocol::SendPathCheckSum(uint8_t playerNum, uint32_t checks
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(uint32_t), NETMSG_PATH_CHECKSUM);
 	*packet << playerNum;
 	*packet << checksum;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -103,7 +104,7 @@ PacketType CBaseNetProtocol::SendSelect(uint8_t playerNum, const std::vector<int
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_SELECT);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << selectedUnitIDs;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -111,7 +112,7 @@ PacketType CBaseNetProtocol::SendPause(uint8_t playerNum, uint8_t bPaused)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(bPaused), NETMSG_PAUSE);
 	*packet << playerNum << bPaused;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -134,7 +135,7 @@ PacketType CBaseNetProtocol::SendCommand(
 		*packet << params[i];
 	}
 
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendAICommand(
@@ -173,7 +174,7 @@ PacketType CBaseNetProtocol::SendAICommand(
 		*packet << params[i];
 	}
 
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendAIShare(
@@ -194,7 +195,7 @@ PacketType CBaseNetProtocol::SendAIShare(
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_AISHARE);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << aiID << sourceTeam << destTeam << metal << energy << unitIDs;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -202,35 +203,35 @@ PacketType CBaseNetProtocol::SendUserSpeed(uint8_t playerNum, float userSpeed)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(userSpeed), NETMSG_USER_SPEED);
 	*packet << playerNum << userSpeed;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendInternalSpeed(float internalSpeed)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(internalSpeed), NETMSG_INTERNAL_SPEED);
 	*packet << internalSpeed;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendCPUUsage(float cpuUsage)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(cpuUsage), NETMSG_CPU_USAGE);
 	*packet << cpuUsage;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendDirectControl(uint8_t playerNum)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum), NETMSG_DIRECT_CONTROL);
 	*packet << playerNum;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendDirectControlUpdate(uint8_t playerNum, uint8_t status, int16_t heading, int16_t pitch)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(status) + sizeof(heading) + sizeof(pitch), NETMSG_DC_UPDATE);
 	*packet << playerNum << status << heading << pitch;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -240,12 +241,14 @@ PacketType CBaseNetProtocol::SendAttemptConnect(
 	const std::string& version,
 	const std::string& platform,
 	int32_t netloss,
-	bool reconnect
+	bool reconnect,
+	uint8_t netflags
 ) {
 	const uint32_t payloadSize =
 		sizeof(NETWORK_VERSION) +
 		sizeof(static_cast<uint8_t>(netloss)) +
 		sizeof(static_cast<uint8_t>(reconnect)) +
+		sizeof(netflags) +
 		(name.size() + 1) +
 		(passwd.size() + 1) +
 		(version.size() + 1) +
@@ -262,8 +265,9 @@ PacketType CBaseNetProtocol::SendAttemptConnect(
 	*packet << platform;
 	*packet << uint8_t(reconnect);
 	*packet << uint8_t(netloss);
+	*packet << netflags;
 
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -275,7 +279,7 @@ PacketType CBaseNetProtocol::SendRejectConnect(const std::string& reason)
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_REJECT_CONNECT);
 	*packet << static_cast<uint16_t>(packetSize) << reason;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -283,14 +287,14 @@ PacketType CBaseNetProtocol::SendShare(uint8_t playerNum, uint8_t shareTeam, uin
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(shareTeam) + sizeof(bShareUnits) + (sizeof(shareMetal) * 2), NETMSG_SHARE);
 	*packet << playerNum << shareTeam << bShareUnits << shareMetal << shareEnergy;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendSetShare(uint8_t playerNum, uint8_t myTeam, float metalShareFraction, float energyShareFraction)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(myTeam) + (sizeof(metalShareFraction) * 2), NETMSG_SETSHARE);
 	*packet << playerNum << myTeam << metalShareFraction << energyShareFraction;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -298,14 +302,14 @@ PacketType CBaseNetProtocol::SendPlayerStat(uint8_t playerNum, const PlayerStati
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(PlayerStatistics), NETMSG_PLAYERSTAT);
 	*packet << playerNum << currentStats;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendTeamStat(uint8_t teamNum, const TeamStatistics& currentStats)
 {
 	PackPacket* packet = new netcode::PackPacket(sizeof(uint8_t) + sizeof(teamNum) + sizeof(TeamStatistics), NETMSG_TEAMSTAT);
 	*packet << teamNum << currentStats;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -318,7 +322,7 @@ PacketType CBaseNetProtocol::SendGameOver(uint8_t playerNum, const std::vector<u
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_GAMEOVER);
 	*packet << static_cast<uint8_t>(packetSize) << playerNum << winningAllyTeams;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -332,7 +336,7 @@ PacketType CBaseNetProtocol::SendMapErase(uint8_t playerNum, int16_t x, int16_t
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_MAPDRAW);
 	*packet << static_cast<uint8_t>(packetSize) << playerNum << drawType << x << z;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -353,7 +357,7 @@ PacketType CBaseNetProtocol::SendMapDrawPoint(uint8_t playerNum, int16_t x, int1
 		z <<
 		static_cast<uint8_t>(fromLua) <<
 		label;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendMapDrawLine(uint8_t playerNum, int16_t x1, int16_t z1, int16_t x2, int16_t z2, bool fromLua)
@@ -372,15 +376,20 @@ PacketType CBaseNetProtocol::SendMapDrawLine(uint8_t playerNum, int16_t x1, int1
 		x1 << z1 <<
 		x2 << z2 <<
 		static_cast<uint8_t>(fromLua);
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
-PacketType CBaseNetProtocol::SendSyncResponse(uint8_t playerNum, int32_t frameNum, uint32_t checksum)
+PacketType CBaseNetProtocol::SendSyncResponse(uint8_t playerNum, int32_t frameNum, uint32_t checksum, const uint32_t* laneChecksums)
 {
-	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(frameNum) + sizeof(checksum), NETMSG_SYNCRESPONSE);
+	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(frameNum) + sizeof(checksum) * (1 + SYNC_LANE_COUNT), NETMSG_SYNCRESPONSE);
 	*packet << playerNum << frameNum << checksum;
-	return PacketType(packet);
+
+	for (unsigned int lane = 0; lane < SYNC_LANE_COUNT; lane++) {
+		*packet << laneChecksums[lane];
+	}
+
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendSystemMessage(uint8_t playerNum, std::string message)
@@ -396,28 +405,28 @@ PacketType CBaseNetProtocol::SendSystemMessage(uint8_t playerNum, std::string me
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_SYSTEMMSG);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << message;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendStartPos(uint8_t playerNum, uint8_t teamNum, uint8_t readyState, float x, float y, float z)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(teamNum) + sizeof(readyState) + (3 * sizeof(x)), NETMSG_STARTPOS);
 	*packet << playerNum << teamNum << readyState << x << y << z;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendPlayerInfo(uint8_t playerNum, float cpuUsage, int32_t ping)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(cpuUsage) + sizeof(ping), NETMSG_PLAYERINFO);
 	*packet << playerNum << cpuUsage << static_cast<uint32_t>(ping);
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendPlayerLeft(uint8_t playerNum, uint8_t bIntended)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(bIntended), NETMSG_PLAYERLEFT);
 	*packet << playerNum << bIntended;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -432,7 +441,7 @@ PacketType CBaseNetProtocol::SendLogMsg(uint8_t playerNum, uint8_t logMsgLvl, co
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_LOGMSG);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << logMsgLvl << strData;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendLuaMsg(uint8_t playerNum, uint16_t script, uint8_t mode, const std::vector<uint8_t>& rawData)
@@ -446,7 +455,7 @@ PacketType CBaseNetProtocol::SendLuaMsg(uint8_t playerNum, uint16_t script, uint
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_LUAMSG);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << script << mode << rawData;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -454,28 +463,28 @@ PacketType CBaseNetProtocol::SendGiveAwayEverything(uint8_t playerNum, uint8_t g
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + 1 + sizeof(giveToTeam) + sizeof(takeFromTeam), NETMSG_TEAM);
 	*packet << playerNum << static_cast<uint8_t>(TEAMMSG_GIVEAWAY) << giveToTeam << takeFromTeam;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendResign(uint8_t playerNum)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + 1 + 1 + 1, NETMSG_TEAM);
 	*packet << playerNum << static_cast<uint8_t>(TEAMMSG_RESIGN) << static_cast<uint8_t>(0) << static_cast<uint8_t>(0);
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendJoinTeam(uint8_t playerNum, uint8_t wantedTeamNum)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + 1 + sizeof(wantedTeamNum) + 1, NETMSG_TEAM);
 	*packet << playerNum << static_cast<uint8_t>(TEAMMSG_JOIN_TEAM) << wantedTeamNum << static_cast<uint8_t>(0);
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendTeamDied(uint8_t playerNum, uint8_t whichTeam)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + 1 + sizeof(whichTeam) + 1, NETMSG_TEAM);
 	*packet << playerNum << static_cast<uint8_t>(TEAMMSG_TEAM_DIED) << whichTeam << static_cast<uint8_t>(0);
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendAICreated(uint8_t playerNum, uint8_t whichSkirmishAI, uint8_t team, const std::string& name)
@@ -492,7 +501,7 @@ PacketType CBaseNetProtocol::SendAICreated(uint8_t playerNum, uint8_t whichSkirm
 		<< whichSkirmishAI
 		<< team
 		<< name;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendAIStateChanged(uint8_t playerNum, uint8_t whichSkirmishAI, uint8_t newState)
@@ -500,14 +509,14 @@ PacketType CBaseNetProtocol::SendAIStateChanged(uint8_t playerNum, uint8_t which
 	// do not hand optimize this math; the compiler will do that
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(whichSkirmishAI) + sizeof(newState), NETMSG_AI_STATE_CHANGED);
 	*packet << playerNum << whichSkirmishAI << newState;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendSetAllied(uint8_t playerNum, uint8_t whichAllyTeam, uint8_t state)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum) + sizeof(whichAllyTeam) + sizeof(state), NETMSG_ALLIANCE);
 	*packet << playerNum << whichAllyTeam << state;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -519,7 +528,7 @@ PacketType CBaseNetProtocol::SendCreateNewPlayer(uint8_t playerNum, bool spectat
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_CREATE_NEWPLAYER);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << (uint8_t)spectator << teamNum << playerName;
-	return PacketType(packet);
+	return SharePacket(packet);
 
 }
 
@@ -527,7 +536,39 @@ PacketType CBaseNetProtocol::SendCurrentFrameProgress(int32_t frameNum)
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(frameNum), NETMSG_GAME_FRAME_PROGRESS);
 	*packet << frameNum;
-	return PacketType(packet);
+	return SharePacket(packet);
+}
+
+PacketType CBaseNetProtocol::SendDemoSnapshot(int32_t frameNum, const std::vector<uint8_t>& stateBlob)
+{
+	const uint32_t payloadSize = sizeof(frameNum) + stateBlob.size();
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint32_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_DEMOSNAPSHOT);
+	*packet << packetSize << frameNum << stateBlob;
+	return SharePacket(packet);
+}
+
+PacketType CBaseNetProtocol::SendGameStateRequest(uint8_t playerNum)
+{
+	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(playerNum), NETMSG_GAMESTATE_REQUEST);
+	*packet << playerNum;
+	return SharePacket(packet);
+}
+
+PacketType CBaseNetProtocol::SendGameStatePart(uint8_t playerNum, int32_t frameNum, uint32_t stateSize, uint32_t partOffset, const std::vector<uint8_t>& statePart)
+{
+	const uint32_t payloadSize = sizeof(playerNum) + sizeof(frameNum) + sizeof(stateSize) + sizeof(partOffset) + statePart.size();
+	const uint32_t headerSize = sizeof(uint8_t) + sizeof(uint16_t);
+	const uint32_t packetSize = headerSize + payloadSize;
+
+	if (packetSize >= (1 << (sizeof(uint16_t) * 8)))
+		throw netcode::PackPacketException("[BaseNetProto::SendGameStatePart] maximum packet-size exceeded");
+
+	PackPacket* packet = new PackPacket(packetSize, NETMSG_GAMESTATE);
+	*packet << static_cast<uint16_t>(packetSize) << playerNum << frameNum << stateSize << partOffset << statePart;
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendPing(uint8_t playerNum, uint8_t pingTag, float localTime)
@@ -540,7 +581,7 @@ PacketType CBaseNetProtocol::SendPing(uint8_t playerNum, uint8_t pingTag, float
 	*packet << playerNum;
 	*packet << pingTag;
 	*packet << localTime;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -555,7 +596,7 @@ PacketType CBaseNetProtocol::SendClientData(uint8_t playerNum, const std::vector
 	*packet << playerNum;
 	*packet << data;
 
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 
@@ -565,7 +606,7 @@ PacketType CBaseNetProtocol::SendSdCheckrequest(int32_t frameNum)
 {
 	PackPacket* packet = new PackPacket(5, NETMSG_SD_CHKREQUEST);
 	*packet << frameNum;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendSdCheckresponse(uint8_t playerNum, uint64_t flop, std::vector<uint32_t> checksums)
@@ -576,12 +617,12 @@ PacketType CBaseNetProtocol::SendSdCheckresponse(uint8_t playerNum, uint64_t flo
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_SD_CHKRESPONSE);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << flop << checksums;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 
 PacketType CBaseNetProtocol::SendSdReset()
 {
-	return PacketType(new PackPacket(sizeof(uint8_t), NETMSG_SD_RESET));
+	return SharePacket(new PackPacket(sizeof(uint8_t), NETMSG_SD_RESET));
 }
 
 
@@ -589,7 +630,7 @@ PacketType CBaseNetProtocol::SendSdBlockrequest(uint16_t begin, uint16_t length,
 {
 	PackPacket* packet = new PackPacket(sizeof(uint8_t) + sizeof(begin) + sizeof(length) + sizeof(requestSize), NETMSG_SD_BLKREQUEST);
 	*packet << begin << length << requestSize;
-	return PacketType(packet);
+	return SharePacket(packet);
 
 }
 
@@ -601,7 +642,7 @@ PacketType CBaseNetProtocol::SendSdBlockresponse(uint8_t playerNum, std::vector<
 
 	PackPacket* packet = new PackPacket(packetSize, NETMSG_SD_BLKRESPONSE);
 	*packet << static_cast<uint16_t>(packetSize) << playerNum << checksums;
-	return PacketType(packet);
+	return SharePacket(packet);
 }
 #endif // SYNCDEBUG
 
@@ -645,7 +686,7 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_PLAYERSTAT, 2 + sizeof(PlayerStatistics));
 	proto->AddType(NETMSG_GAMEOVER, -1);
 	proto->AddType(NETMSG_MAPDRAW, -1);
-	proto->AddType(NETMSG_SYNCRESPONSE, 10);
+	proto->AddType(NETMSG_SYNCRESPONSE, 10 + sizeof(uint32_t) * SYNC_LANE_COUNT);
 	proto->AddType(NETMSG_SYSTEMMSG, -2);
 	proto->AddType(NETMSG_STARTPOS, 16);
 	proto->AddType(NETMSG_PLAYERINFO, 10);
@@ -666,6 +707,11 @@ CBaseNetProtocol::CBaseNetProtocol()
 	proto->AddType(NETMSG_AI_STATE_CHANGED, 4);
 	proto->AddType(NETMSG_GAME_FRAME_PROGRESS, 5);
 	proto->AddType(NETMSG_PING, 1 + (1 + 1 + 4));
+	proto->AddType(NETMSG_FRAMEBUNDLE, -2);
+	proto->AddType(NETMSG_GAMESTATE_REQUEST, 2);
+	proto->AddType(NETMSG_GAMESTATE, -2);
+	// NETMSG_DEMOSNAPSHOT is deliberately not registered, it does not fit a
+	// uint16_t size and must never pass through (or be accepted by) a UDP link
 
 #ifdef SYNCDEBUG
 	proto->AddType(NETMSG_SD_CHKREQUEST, 5);
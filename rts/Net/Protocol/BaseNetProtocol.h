@@ -11,6 +11,7 @@
 
 #include "Game/GameVersion.h"
 #include "NetMessageTypes.h"
+#include "System/Sync/SyncChecker.h"
 
 #if (!defined(DEDICATED) && !defined(UNITSYNC) && !defined(BUILDING_AI) && !defined(UNIT_TEST))
 #define CLIENT_NETLOG(p, l, m) clientNet->Send(CBaseNetProtocol::Get().SendLogMsg((p), (l), (m)))
@@ -65,7 +66,7 @@ public:
 	PacketType SendLuaDrawTime(uint8_t playerNum, int32_t mSec);
 	PacketType SendDirectControl(uint8_t playerNum);
 	PacketType SendDirectControlUpdate(uint8_t playerNum, uint8_t status, int16_t heading, int16_t pitch);
-	PacketType SendAttemptConnect(const std::string& name, const std::string& passwd, const std::string& version, const std::string& platform, int32_t netloss, bool reconnect = false);
+	PacketType SendAttemptConnect(const std::string& name, const std::string& passwd, const std::string& version, const std::string& platform, int32_t netloss, bool reconnect = false, uint8_t netflags = 0);
 	PacketType SendRejectConnect(const std::string& reason);
 	PacketType SendShare(uint8_t playerNum, uint8_t shareTeam, uint8_t bShareUnits, float shareMetal, float shareEnergy);
 	PacketType SendSetShare(uint8_t playerNum, uint8_t myTeam, float metalShareFraction, float energyShareFraction);
@@ -73,7 +74,8 @@ public:
 	PacketType SendMapErase(uint8_t playerNum, int16_t x, int16_t z);
 	PacketType SendMapDrawLine(uint8_t playerNum, int16_t x1, int16_t z1, int16_t x2, int16_t z2, bool);
 	PacketType SendMapDrawPoint(uint8_t playerNum, int16_t x, int16_t z, const std::string& label, bool);
-	PacketType SendSyncResponse(uint8_t playerNum, int32_t frameNum, uint32_t checksum);
+	/// <laneChecksums> holds SYNC_LANE_COUNT values
+	PacketType SendSyncResponse(uint8_t playerNum, int32_t frameNum, uint32_t checksum, const uint32_t* laneChecksums);
 	PacketType SendSystemMessage(uint8_t playerNum, std::string message);
 	PacketType SendStartPos(uint8_t playerNum, uint8_t teamNum, uint8_t readyState, float x, float y, float z);
 	PacketType SendPlayerInfo(uint8_t playerNum, float cpuUsage, int32_t ping);
@@ -82,6 +84,9 @@ public:
 	PacketType SendLuaMsg(uint8_t playerNum, uint16_t script, uint8_t mode, const std::vector<uint8_t>& rawData);
 	PacketType SendCurrentFrameProgress(int32_t frameNum);
 	PacketType SendPing(uint8_t playerNum, uint8_t pingTag, float localTime);
+	PacketType SendDemoSnapshot(int32_t frameNum, const std::vector<uint8_t>& stateBlob);
+	PacketType SendGameStateRequest(uint8_t playerNum);
+	PacketType SendGameStatePart(uint8_t playerNum, int32_t frameNum, uint32_t stateSize, uint32_t partOffset, const std::vector<uint8_t>& statePart);
 
 	PacketType SendPlayerStat(uint8_t playerNum, const PlayerStatistics& currentStats);
 	PacketType SendTeamStat(uint8_t teamNum, const TeamStatistics& currentStats);
@@ -52,7 +52,7 @@ enum NETMSG {
 	NETMSG_MAPDRAW          = 31, // uint8_t messageSize =  8, playerNum, command = MapDrawAction::NET_ERASE; int16_t x, z;
 	                              // uint8_t messageSize = 12, playerNum, command = MapDrawAction::NET_LINE; int16_t x1, z1, x2, z2;
 	                              // /*messageSize*/   uint8_t playerNum, command = MapDrawAction::NET_POINT; int16_t x, z; std::string label;
-	NETMSG_SYNCRESPONSE     = 33, // uint8_t playerNum; int32_t frameNum; uint32_t checksum;
+	NETMSG_SYNCRESPONSE     = 33, // uint8_t playerNum; int32_t frameNum; uint32_t checksum; uint32_t laneChecksums[SYNC_LANE_COUNT];
 	NETMSG_SYSTEMMSG        = 35, // uint8_t playerNum, std::string message;
 	NETMSG_STARTPOS         = 36, // uint8_t playerNum, uint8_t myTeam, ready /*0: not ready, 1: ready, 2: don't update readiness*/; float x, y, z;
 	NETMSG_PLAYERINFO       = 38, // uint8_t playerNum; float cpuUsage; int32_t ping /*in milliseconds*/;
@@ -77,7 +77,7 @@ enum NETMSG {
 	NETMSG_TEAMSTAT         = 60, // uint8_t teamNum, struct TeamStatistics statistics      # used by LadderBot #
 	NETMSG_CLIENTDATA       = 61, // uint16_t messageSize, std::string setupText
 
-	NETMSG_ATTEMPTCONNECT   = 65, // uint16_t msgsize, uint16_t netversion, string playername, string passwd, string VERSION_STRING_DETAILED
+	NETMSG_ATTEMPTCONNECT   = 65, // uint16_t msgsize, uint16_t netversion, string playername, string passwd, string VERSION_STRING_DETAILED, string platform, uint8_t reconnect, uint8_t netloss, uint8_t netflags
 	NETMSG_REJECT_CONNECT   = 66, // string reason
 
 	NETMSG_AI_CREATED       = 70, // /* uint8_t messageSize */, uint8_t playerNum, uint8_t whichSkirmishAI, uint8_t team, std::string name (ends with \0)
@@ -93,10 +93,22 @@ enum NETMSG {
 
 	NETMSG_PING = 78, // uint8_t playerNum, uint8_t pingTag, float localTime
 
+	NETMSG_FRAMEBUNDLE = 79, // uint16_t messageSize, uint16_t rawSize, std::vector<uint8_t> deflatedMessages # expanded by the receiving link, never queued or cached #
+
+	NETMSG_DEMOSNAPSHOT = 80, // uint32_t messageSize, int32_t frameNum, uint32_t rawSize, std::vector<uint8_t> deflatedState # creg state after frameNum, only in demo streams and local connections #
+
+	NETMSG_GAMESTATE_REQUEST = 81, // uint8_t playerNum # asks a client to send its current sim-state to player <playerNum> that is joining the running game #
+	NETMSG_GAMESTATE = 82, // uint16_t messageSize, uint8_t playerNum, int32_t frameNum, uint32_t stateSize, uint32_t partOffset, std::vector<uint8_t> statePart # one part of the sim-state after frameNum, relayed by the server to <playerNum> #
+
 	NETMSG_LAST //max types of netmessages, internal only
 };
 
 
+/// capability-flags of NETMSG_ATTEMPTCONNECT
+enum NETFLAGS {
+	NETFLAG_FRAMEBUNDLES = 1, // client can expand NETMSG_FRAMEBUNDLE
+};
+
 /// sub-action-types of NETMSG_TEAM
 enum TEAMMSG {
 //	TEAMMSG_NAME            = number    parameter1, ...
@@ -23,6 +23,8 @@ CONFIG(int, SourcePort).defaultValue(0);
 
 CNetProtocol* clientNet = nullptr;
 
+static uint8_t GetNetFlags() { return (globalConfig.networkFrameBundles? NETFLAG_FRAMEBUNDLES: 0); }
+
 CNetProtocol::CNetProtocol() {
 	static_assert(sizeof(serverConnMem) >= sizeof(netcode::UDPConnection), "");
 	static_assert(sizeof(serverConnMem) >= sizeof(netcode::CLocalConnection), "");
@@ -56,7 +58,7 @@ void CNetProtocol::InitClient(std::shared_ptr<ClientSetup> clientSetup, const st
 
 	serverConnPtr = new (serverConnMem) netcode::UDPConnection(configHandler->GetInt("SourcePort"), clientSetup->hostIP, clientSetup->hostPort);
 	serverConnPtr->Unmute();
-	serverConnPtr->SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, clientVersion, clientPlatform, globalConfig.networkLossFactor));
+	serverConnPtr->SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, clientVersion, clientPlatform, globalConfig.networkLossFactor, false, GetNetFlags()));
 	serverConnPtr->Flush(true);
 
 	LOG("[NetProto::%s] connecting to IP %s on port %i using name %s", __func__, clientSetup->hostIP.c_str(), clientSetup->hostPort, userName.c_str());
@@ -76,7 +78,7 @@ void CNetProtocol::AttemptReconnect(const std::string& myVersion, const std::str
 	netcode::UDPConnection conn(*serverConnPtr);
 
 	conn.Unmute();
-	conn.SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, myVersion, myPlatform, globalConfig.networkLossFactor, true));
+	conn.SendData(CBaseNetProtocol::Get().SendAttemptConnect(userName, userPasswd, myVersion, myPlatform, globalConfig.networkLossFactor, true, GetNetFlags()));
 	conn.Flush(true);
 
 	LOG("[NetProto::%s] reconnecting to server... %ds", __func__, dynamic_cast<decltype(conn)*>(serverConnPtr)->GetReconnectSecs());
@@ -0,0 +1,57 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SERVER_STATS_H
+#define SERVER_STATS_H
+
+#include <cinttypes>
+
+/**
+ * @brief CGameServer performance over one report interval
+ * Sent to the autohost as SERVER_STATS, all times are in milliseconds.
+ */
+struct ServerStats {
+	enum {
+		PHASE_LISTENER = 0, // UDPListener::Update
+		PHASE_READNET  = 1, // ServerReadNet, incl. packet processing
+		PHASE_UPDATE   = 2, // Update, incl. frame creation and lag protection
+		PHASE_LAGPROT  = 3, // LagProtection
+		PHASE_FLUSH    = 4, // flushing the shared send-queue
+		NUM_PHASES     = 5,
+	};
+
+	void Reset() { *this = {}; }
+
+	void AddPhaseTime(unsigned int phase, float time) {
+		sumPhaseTimes[phase] += time;
+		maxPhaseTimes[phase] = (time > maxPhaseTimes[phase])? time: maxPhaseTimes[phase];
+	}
+	void AddFrameJitter(float jitter) {
+		sumFrameJitter += jitter;
+		maxFrameJitter = (jitter > maxFrameJitter)? jitter: maxFrameJitter;
+		numFrameTicks += 1;
+	}
+
+	std::int32_t serverFrameNum = 0;
+	std::uint32_t numTicks = 0;
+	std::uint32_t numFrames = 0;
+	// ticks that broadcast at least one frame
+	std::uint32_t numFrameTicks = 0;
+
+	float sumPhaseTimes[NUM_PHASES] = {0.0f};
+	float maxPhaseTimes[NUM_PHASES] = {0.0f};
+	float maxTickTime = 0.0f;
+
+	// deviation of the interval between two frame broadcasts from the target game speed
+	float sumFrameJitter = 0.0f;
+	float maxFrameJitter = 0.0f;
+};
+
+struct ServerLinkStats {
+	std::uint8_t playerNum;
+	std::uint16_t numIncoming; // received, not yet processed
+	std::uint16_t numOutgoing; // queued, not yet packed into chunks
+	std::uint16_t numUnacked;  // chunks sent, not yet acknowledged
+	std::uint16_t frameLag;    // frames since the last keyframe response
+};
+
+#endif
@@ -8,6 +8,7 @@
 #include "Game/UI/MiniMap.h"
 #include "Game/WaitCommandsAI.h"
 #include "Map/Ground.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/GL/glExtra.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
@@ -24,11 +25,18 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "Sim/Units/UnitHandler.h"
+#include "System/ContainerUtil.h"
 #include "System/SpringMath.h"
 #include "System/Log/ILog.h"
 
-static const CUnit* GetTrackableUnit(const CUnit* caiOwner, const CUnit* cmdUnit)
+// paths not drawn for this many frames are evicted
+static constexpr unsigned int CACHED_PATH_LIFETIME = 60;
+
+const CUnit* CommandDrawer::GetTrackableUnit(const CUnit* caiOwner, const CUnit* cmdUnit) const
 {
+	// even a currently untrackable unit can become visible again
+	MarkPathDynamic();
+
 	if (cmdUnit == nullptr)
 		return nullptr;
 	if ((cmdUnit->losStatus[caiOwner->allyteam] & (LOS_INLOS | LOS_INRADAR)) == 0)
@@ -45,6 +53,80 @@ CommandDrawer* CommandDrawer::GetInstance() {
 
 
 
+void CommandDrawer::Update() {
+	luaQueuedUnitSet.clear();
+
+	for (auto it = cachedPathIndices.begin(); it != cachedPathIndices.end(); ) {
+		CachedPath& path = cachedPaths[it->second];
+
+		if ((path.lastDrawFrame + CACHED_PATH_LIFETIME) >= globalRendering->drawFrame) {
+			++it;
+			continue;
+		}
+
+		path.valid = false;
+		path.linePath.Clear();
+		path.buildIcons.clear();
+		path.circles.clear();
+
+		freePathIndices.push_back(it->second);
+		it = cachedPathIndices.erase(it);
+	}
+}
+
+
+CommandDrawer::CachedPath& CommandDrawer::GetCachedPath(int unitID) const {
+	const auto it = cachedPathIndices.find(unitID);
+
+	if (it != cachedPathIndices.end())
+		return cachedPaths[it->second];
+
+	size_t pathIndex = cachedPaths.size();
+
+	if (freePathIndices.empty()) {
+		cachedPaths.emplace_back();
+	} else {
+		pathIndex = spring::VectorBackPop(freePathIndices);
+	}
+
+	cachedPathIndices[unitID] = pathIndex;
+	return cachedPaths[pathIndex];
+}
+
+void CommandDrawer::RecordPath(const CCommandAI* cai, CachedPath& path) const {
+	const CUnit* owner = cai->owner;
+
+	path.buildIcons.clear();
+	path.circles.clear();
+	path.dynamic = false;
+
+	recordedPath = &path;
+
+	lineDrawer.StartRecording(&path.linePath);
+	lineDrawer.StartPath(owner->GetObjDrawMidPos(), cmdColors.start);
+
+	// note: {Air,Builder}CAI inherit from MobileCAI, so test that last
+	if (dynamic_cast<const     CAirCAI*>(cai) != nullptr) {
+		DrawAirCAICommands(static_cast<const CAirCAI*>(cai));
+	} else if (dynamic_cast<const CBuilderCAI*>(cai) != nullptr) {
+		DrawBuilderCAICommands(static_cast<const CBuilderCAI*>(cai));
+	} else if (dynamic_cast<const CFactoryCAI*>(cai) != nullptr) {
+		DrawFactoryCAICommands(static_cast<const CFactoryCAI*>(cai));
+	} else if (dynamic_cast<const  CMobileCAI*>(cai) != nullptr) {
+		DrawMobileCAICommands(static_cast<const CMobileCAI*>(cai));
+	} else {
+		DrawCommands(cai);
+	}
+
+	lineDrawer.EndRecording();
+
+	recordedPath = nullptr;
+
+	path.valid = !path.dynamic;
+	path.generation = pathGeneration;
+}
+
+
 void CommandDrawer::Draw(const CCommandAI* cai, bool onMiniMap) const {
 	GL::RenderDataBufferC* buffer = GL::GetRenderBufferC();
 	Shader::IProgramObject* shader = buffer->GetShader();
@@ -52,23 +134,57 @@ void CommandDrawer::Draw(const CCommandAI* cai, bool onMiniMap) const {
 	const CMatrix44f& projMat = onMiniMap? minimap->GetProjMat(0): camera->GetProjectionMatrix();
 	const CMatrix44f& viewMat = onMiniMap? minimap->GetViewMat(0): camera->GetViewMatrix();
 
-	const auto& DrawBuffer = [&viewMat, &projMat](GL::RenderDataBufferC* rdb, Shader::IProgramObject* ipo) {
-		// hand off all surface circles
-		ipo->Enable();
-		ipo->SetUniformMatrix4x4<float>("u_movi_mat", false, viewMat);
-		ipo->SetUniformMatrix4x4<float>("u_proj_mat", false, projMat);
-		rdb->Submit(GL_LINES);
-		ipo->Disable();
+	const CUnit* owner = cai->owner;
+	const CFactoryCAI* factoryCAI = dynamic_cast<const CFactoryCAI*>(cai);
+
+	const float3& startPos = owner->GetObjDrawMidPos();
+	const unsigned int queueRevisions[2] = {
+		cai->commandQue.GetRevision(),
+		(factoryCAI != nullptr)? factoryCAI->newUnitCommands.GetRevision(): 0u,
 	};
 
-	// note: {Air,Builder}CAI inherit from MobileCAI, so test that last
-	if (dynamic_cast<const     CAirCAI*>(cai) != nullptr) {     DrawAirCAICommands(static_cast<const     CAirCAI*>(cai), buffer); DrawBuffer(buffer, shader); return; }
-	if (dynamic_cast<const CBuilderCAI*>(cai) != nullptr) { DrawBuilderCAICommands(static_cast<const CBuilderCAI*>(cai), buffer); DrawBuffer(buffer, shader); return; }
-	if (dynamic_cast<const CFactoryCAI*>(cai) != nullptr) { DrawFactoryCAICommands(static_cast<const CFactoryCAI*>(cai), buffer); DrawBuffer(buffer, shader); return; }
-	if (dynamic_cast<const  CMobileCAI*>(cai) != nullptr) {  DrawMobileCAICommands(static_cast<const  CMobileCAI*>(cai), buffer); DrawBuffer(buffer, shader); return; }
+	CachedPath& path = GetCachedPath(owner->id);
+
+	path.lastDrawFrame = globalRendering->drawFrame;
+
+	{
+		bool recordPath = !path.valid;
+
+		recordPath |= (path.queueRevisions[0] != queueRevisions[0]);
+		recordPath |= (path.queueRevisions[1] != queueRevisions[1]);
+		recordPath |= (path.generation != pathGeneration);
+		recordPath |= !lineDrawer.IsPathCompatible(path.linePath);
+
+		if (recordPath) {
+			RecordPath(cai, path);
 
-	DrawCommands(cai, buffer);
-	DrawBuffer(buffer, shader);
+			path.queueRevisions[0] = queueRevisions[0];
+			path.queueRevisions[1] = queueRevisions[1];
+		}
+	}
+
+	lineDrawer.DrawPath(path.linePath, startPos);
+
+	if (owner->selfDCountdown != 0)
+		cursorIcons.AddIcon(CMD_SELFD, startPos);
+
+	for (const CachedPath::BuildIcon& icon: path.buildIcons) {
+		cursorIcons.AddBuildIcon(icon.cmdID, icon.pos, icon.team, icon.facing);
+	}
+
+	if (path.circles.empty())
+		return;
+
+	for (const CachedPath::SurfaceCircle& circle: path.circles) {
+		glSurfaceCircle(buffer, circle.center, circle.color, circle.res);
+	}
+
+	// hand off all surface circles
+	shader->Enable();
+	shader->SetUniformMatrix4x4<float>("u_movi_mat", false, viewMat);
+	shader->SetUniformMatrix4x4<float>("u_proj_mat", false, projMat);
+	buffer->Submit(GL_LINES);
+	shader->Disable();
 }
 
 
@@ -108,16 +224,11 @@ void CommandDrawer::DrawLuaQueuedUnitSetCommands(bool onMiniMap) const
 	glAttribStatePtr->EnableDepthTest();
 }
 
-void CommandDrawer::DrawCommands(const CCommandAI* cai, GL::RenderDataBufferC* rdb) const
+void CommandDrawer::DrawCommands(const CCommandAI* cai) const
 {
 	const CUnit* owner = cai->owner;
 	const CCommandQueue& commandQue = cai->commandQue;
 
-	lineDrawer.StartPath(owner->GetObjDrawMidPos(), cmdColors.start);
-
-	if (owner->selfDCountdown != 0)
-		lineDrawer.DrawIconAtLastPos(CMD_SELFD);
-
 	for (const auto& command: commandQue) {
 		const int cmdID = command.GetID();
 
@@ -137,6 +248,9 @@ void CommandDrawer::DrawCommands(const CCommandAI* cai, GL::RenderDataBufferC* r
 					const float z = command.GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
+					// terrain can be deformed
+					MarkPathDynamic();
+
 					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
@@ -149,7 +263,7 @@ void CommandDrawer::DrawCommands(const CCommandAI* cai, GL::RenderDataBufferC* r
 			} break;
 
 			default: {
-				DrawDefaultCommand(command, owner, rdb);
+				DrawDefaultCommand(command, owner);
 			} break;
 		}
 	}
@@ -157,16 +271,11 @@ void CommandDrawer::DrawCommands(const CCommandAI* cai, GL::RenderDataBufferC* r
 
 
 
-void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, GL::RenderDataBufferC* rdb) const
+void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai) const
 {
 	const CUnit* owner = cai->owner;
 	const CCommandQueue& commandQue = cai->commandQue;
 
-	lineDrawer.StartPath(owner->GetObjDrawMidPos(), cmdColors.start);
-
-	if (owner->selfDCountdown != 0)
-		lineDrawer.DrawIconAtLastPos(CMD_SELFD);
-
 	for (const auto& command: commandQue) {
 		const int cmdID = command.GetID();
 
@@ -195,6 +304,9 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, GL::RenderDataBufferC
 					const float z = command.GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
+					// terrain can be deformed
+					MarkPathDynamic();
+
 					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
@@ -204,7 +316,7 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, GL::RenderDataBufferC
 
 				lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.attack);
 				lineDrawer.Break(endPos, cmdColors.attack);
-				glSurfaceCircle(rdb, {endPos, command.GetParam(3)}, cmdColors.attack, 20.0f);
+				AddSurfaceCircle({endPos, command.GetParam(3)}, cmdColors.attack, 20.0f);
 				lineDrawer.RestartWithColor(cmdColors.attack);
 			} break;
 
@@ -224,7 +336,7 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, GL::RenderDataBufferC
 			} break;
 
 			default: {
-				DrawDefaultCommand(command, owner, rdb);
+				DrawDefaultCommand(command, owner);
 			} break;
 		}
 	}
@@ -232,16 +344,11 @@ void CommandDrawer::DrawAirCAICommands(const CAirCAI* cai, GL::RenderDataBufferC
 
 
 
-void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDataBufferC* rdb) const
+void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai) const
 {
 	const CUnit* owner = cai->owner;
 	const CCommandQueue& commandQue = cai->commandQue;
 
-	lineDrawer.StartPath(owner->GetObjDrawMidPos(), cmdColors.start);
-
-	if (owner->selfDCountdown != 0)
-		lineDrawer.DrawIconAtLastPos(CMD_SELFD);
-
 	for (const Command& ci: commandQue) {
 		const int cmdID = ci.GetID();
 
@@ -252,13 +359,13 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 				if (!bi.Parse(ci))
 					continue;
 
-				cursorIcons.AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
+				AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
 				lineDrawer.DrawLine(bi.pos, cmdColors.build);
 
 				// draw metal extraction range
 				if (bi.def->extractRange > 0.0f) {
 					lineDrawer.Break(bi.pos, cmdColors.build);
-					glSurfaceCircle(rdb, {bi.pos, bi.def->extractRange}, cmdColors.rangeExtract, 40.0f);
+					AddSurfaceCircle({bi.pos, bi.def->extractRange}, cmdColors.rangeExtract, 40.0f);
 					lineDrawer.Restart();
 				}
 			}
@@ -289,7 +396,7 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 
 				lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.restore);
 				lineDrawer.Break(endPos, cmdColors.restore);
-				glSurfaceCircle(rdb, {endPos, ci.GetParam(3)}, cmdColors.restore, 20.0f);
+				AddSurfaceCircle({endPos, ci.GetParam(3)}, cmdColors.restore, 20.0f);
 				lineDrawer.RestartWithColor(cmdColors.restore);
 			} break;
 
@@ -308,6 +415,9 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 					const float z = ci.GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
+					// terrain can be deformed
+					MarkPathDynamic();
+
 					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
@@ -321,7 +431,7 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 
 					lineDrawer.DrawLineAndIcon(cmdID, endPos, color);
 					lineDrawer.Break(endPos, color);
-					glSurfaceCircle(rdb, {endPos, ci.GetParam(3)}, color, 20.0f);
+					AddSurfaceCircle({endPos, ci.GetParam(3)}, color, 20.0f);
 					lineDrawer.RestartWithColor(color);
 				} else {
 					assert(ci.GetParam(0) >= 0.0f);
@@ -331,6 +441,8 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 					if (id >= unitHandler.MaxUnits()) {
 						const CFeature* feature = featureHandler.GetFeature(id - unitHandler.MaxUnits());
 
+						MarkPathDynamic();
+
 						if (feature != nullptr)
 							lineDrawer.DrawLineAndIcon(cmdID, feature->GetObjDrawMidPos(), color);
 
@@ -353,7 +465,7 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 
 					lineDrawer.DrawLineAndIcon(cmdID, endPos, color);
 					lineDrawer.Break(endPos, color);
-					glSurfaceCircle(rdb, {endPos, ci.GetParam(3)}, color, 20.0f);
+					AddSurfaceCircle({endPos, ci.GetParam(3)}, color, 20.0f);
 					lineDrawer.RestartWithColor(color);
 				} else {
 					if (ci.GetNumParams() >= 1) {
@@ -368,6 +480,8 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 
 			case CMD_LOAD_ONTO: {
 				const CUnit* unit = unitHandler.GetUnitUnsafe(ci.GetParam(0));
+
+				MarkPathDynamic();
 				lineDrawer.DrawLineAndIcon(cmdID, unit->pos, cmdColors.load);
 			} break;
 			case CMD_WAIT: {
@@ -378,7 +492,7 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 			} break;
 
 			default: {
-				DrawDefaultCommand(ci, owner, rdb);
+				DrawDefaultCommand(ci, owner);
 			} break;
 		}
 	}
@@ -386,17 +500,12 @@ void CommandDrawer::DrawBuilderCAICommands(const CBuilderCAI* cai, GL::RenderDat
 
 
 
-void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, GL::RenderDataBufferC* rdb) const
+void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai) const
 {
 	const CUnit* owner = cai->owner;
 	const CCommandQueue& commandQue = cai->commandQue;
 	const CCommandQueue& newUnitCommands = cai->newUnitCommands;
 
-	lineDrawer.StartPath(owner->GetObjDrawMidPos(), cmdColors.start);
-
-	if (owner->selfDCountdown != 0)
-		lineDrawer.DrawIconAtLastPos(CMD_SELFD);
-
 	if (!commandQue.empty() && (commandQue.front().GetID() == CMD_WAIT))
 		DrawWaitIcon(commandQue.front());
 
@@ -428,6 +537,9 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, GL::RenderDat
 					const float z = ci.GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
+					// terrain can be deformed
+					MarkPathDynamic();
+
 					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
@@ -448,7 +560,7 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, GL::RenderDat
 			} break;
 
 			default: {
-				DrawDefaultCommand(ci, owner, rdb);
+				DrawDefaultCommand(ci, owner);
 			} break;
 		}
 
@@ -458,13 +570,13 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, GL::RenderDat
 			if (!bi.Parse(ci))
 				continue;
 
-			cursorIcons.AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
+			AddBuildIcon(cmdID, bi.pos, owner->team, bi.buildFacing);
 			lineDrawer.DrawLine(bi.pos, cmdColors.build);
 
 			// draw metal extraction range
 			if (bi.def->extractRange > 0.0f) {
 				lineDrawer.Break(bi.pos, cmdColors.build);
-				glSurfaceCircle(rdb, {bi.pos, bi.def->extractRange}, cmdColors.rangeExtract, 40.0f);
+				AddSurfaceCircle({bi.pos, bi.def->extractRange}, cmdColors.rangeExtract, 40.0f);
 				lineDrawer.Restart();
 			}
 		}
@@ -473,16 +585,11 @@ void CommandDrawer::DrawFactoryCAICommands(const CFactoryCAI* cai, GL::RenderDat
 
 
 
-void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, GL::RenderDataBufferC* rdb) const
+void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai) const
 {
 	const CUnit* owner = cai->owner;
 	const CCommandQueue& commandQue = cai->commandQue;
 
-	lineDrawer.StartPath(owner->GetObjDrawMidPos(), cmdColors.start);
-
-	if (owner->selfDCountdown != 0)
-		lineDrawer.DrawIconAtLastPos(CMD_SELFD);
-
 	for (const auto& command: commandQue) {
 		const int cmdID = command.GetID();
 
@@ -514,6 +621,9 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, GL::RenderDataB
 					const float z = command.GetParam(2);
 					const float y = CGround::GetHeightReal(x, z, false) + 3.0f;
 
+					// terrain can be deformed
+					MarkPathDynamic();
+
 					lineDrawer.DrawLineAndIcon(cmdID, float3(x, y, z), cmdColors.attack);
 				}
 			} break;
@@ -528,6 +638,8 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, GL::RenderDataB
 
 			case CMD_LOAD_ONTO: {
 				const CUnit* unit = unitHandler.GetUnitUnsafe(command.GetParam(0));
+
+				MarkPathDynamic();
 				lineDrawer.DrawLineAndIcon(cmdID, unit->pos, cmdColors.load);
 			} break;
 
@@ -537,7 +649,7 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, GL::RenderDataB
 
 					lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.load);
 					lineDrawer.Break(endPos, cmdColors.load);
-					glSurfaceCircle(rdb, {endPos, command.GetParam(3)}, cmdColors.load, 20.0f);
+					AddSurfaceCircle({endPos, command.GetParam(3)}, cmdColors.load, 20.0f);
 					lineDrawer.RestartWithColor(cmdColors.load);
 				} else {
 					const CUnit* unit = GetTrackableUnit(owner, unitHandler.GetUnit(command.GetParam(0)));
@@ -554,7 +666,7 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, GL::RenderDataB
 
 					lineDrawer.DrawLineAndIcon(cmdID, endPos, cmdColors.unload);
 					lineDrawer.Break(endPos, cmdColors.unload);
-					glSurfaceCircle(rdb, {endPos, command.GetParam(3)}, cmdColors.unload, 20.0f);
+					AddSurfaceCircle({endPos, command.GetParam(3)}, cmdColors.unload, 20.0f);
 					lineDrawer.RestartWithColor(cmdColors.unload);
 				}
 			} break;
@@ -570,7 +682,7 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, GL::RenderDataB
 			} break;
 
 			default: {
-				DrawDefaultCommand(command, owner, rdb);
+				DrawDefaultCommand(command, owner);
 			} break;
 		}
 	}
@@ -579,10 +691,12 @@ void CommandDrawer::DrawMobileCAICommands(const CMobileCAI* cai, GL::RenderDataB
 
 void CommandDrawer::DrawWaitIcon(const Command& cmd) const
 {
+	// wait icons show the wait's current state
+	MarkPathDynamic();
 	waitCommandsAI.AddIcon(cmd, lineDrawer.GetLastPos());
 }
 
-void CommandDrawer::DrawDefaultCommand(const Command& c, const CUnit* owner, GL::RenderDataBufferC* rdb) const
+void CommandDrawer::DrawDefaultCommand(const Command& c, const CUnit* owner) const
 {
 	// TODO add Lua callin perhaps, for more elaborate needs?
 	const CCommandColors::DrawData* dd = cmdColors.GetCustomCmdData(c.GetID());
@@ -602,7 +716,7 @@ void CommandDrawer::DrawDefaultCommand(const Command& c, const CUnit* owner, GL:
 			} else {
 				lineDrawer.DrawLineAndIcon(dd->cmdIconID, endPos, dd->color);
 				lineDrawer.Break(endPos, dd->color);
-				glSurfaceCircle(rdb, {endPos, c.GetParam(3)}, dd->color, 20.0f);
+				AddSurfaceCircle({endPos, c.GetParam(3)}, dd->color, 20.0f);
 				lineDrawer.RestartWithColor(dd->color);
 			}
 
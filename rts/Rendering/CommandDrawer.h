@@ -3,7 +3,13 @@
 #ifndef COMMAND_DRAWER_H
 #define COMMAND_DRAWER_H
 
+#include <deque>
+#include <vector>
+
+#include "Rendering/LineDrawer.h"
 #include "Rendering/GL/RenderDataBufferFwd.hpp"
+#include "System/float4.h"
+#include "System/UnorderedMap.hpp"
 #include "System/UnorderedSet.hpp"
 
 struct Command;
@@ -19,7 +25,9 @@ public:
 	static CommandDrawer* GetInstance();
 
 	// clear the set after WorldDrawer and MiniMap have both used it
-	void Update() { luaQueuedUnitSet.clear(); }
+	void Update();
+	// drops all cached paths, for when their colors have changed
+	void InvalidatePaths() { pathGeneration += 1; }
 
 	void Draw(const CCommandAI*, bool onMiniMap) const;
 	void DrawLuaQueuedUnitSetCommands(bool onMiniMap) const;
@@ -30,14 +38,57 @@ public:
 	void SetBuildQueueSquareColor(const float* color) { buildQueueSquareColor = color; }
 
 private:
-	void DrawCommands(const CCommandAI*, GL::RenderDataBufferC* rdb) const;
-	void DrawAirCAICommands(const CAirCAI*, GL::RenderDataBufferC* rdb) const;
-	void DrawBuilderCAICommands(const CBuilderCAI*, GL::RenderDataBufferC* rdb) const;
-	void DrawFactoryCAICommands(const CFactoryCAI*, GL::RenderDataBufferC* rdb) const;
-	void DrawMobileCAICommands(const CMobileCAI*, GL::RenderDataBufferC* rdb) const;
+	/**
+	 * A unit's queue drawn from its position, recorded once and redrawn
+	 * for as long as the queue is unchanged; only the start of the path
+	 * follows the unit. Queues with commands whose positions can change
+	 * by themselves (unit or feature targets, waits, ...) are recorded
+	 * anew whenever they are drawn.
+	 */
+	struct CachedPath {
+		struct BuildIcon {
+			int cmdID;
+			float3 pos;
+			int team;
+			int facing;
+		};
+		struct SurfaceCircle {
+			float4 center;
+			float4 color;
+			unsigned int res;
+		};
+
+		CLineDrawer::Path linePath;
+
+		std::vector<BuildIcon> buildIcons;
+		std::vector<SurfaceCircle> circles;
+
+		// revisions of the command-queue and (for factories) the new-unit queue
+		unsigned int queueRevisions[2] = {0, 0};
+		unsigned int generation = 0;
+		unsigned int lastDrawFrame = 0;
+
+		bool valid = false;
+		bool dynamic = false;
+	};
+
+	CachedPath& GetCachedPath(int unitID) const;
+	void RecordPath(const CCommandAI*, CachedPath& path) const;
+
+	void DrawCommands(const CCommandAI*) const;
+	void DrawAirCAICommands(const CAirCAI*) const;
+	void DrawBuilderCAICommands(const CBuilderCAI*) const;
+	void DrawFactoryCAICommands(const CFactoryCAI*) const;
+	void DrawMobileCAICommands(const CMobileCAI*) const;
 
 	void DrawWaitIcon(const Command&) const;
-	void DrawDefaultCommand(const Command&, const CUnit*, GL::RenderDataBufferC* rdb) const;
+	void DrawDefaultCommand(const Command&, const CUnit*) const;
+
+	void AddBuildIcon(int cmdID, const float3& pos, int team, int facing) const { recordedPath->buildIcons.push_back({cmdID, pos, team, facing}); }
+	void AddSurfaceCircle(const float4& center, const float4& color, unsigned int res) const { recordedPath->circles.push_back({center, color, res}); }
+
+	const CUnit* GetTrackableUnit(const CUnit* caiOwner, const CUnit* cmdUnit) const;
+	void MarkPathDynamic() const { recordedPath->dynamic = true; }
 
 	void DrawQueuedBuildingSquaresAW(const CBuilderCAI* cai) const;
 	void DrawQueuedBuildingSquaresUW(const CBuilderCAI* cai) const;
@@ -47,6 +98,16 @@ private:
 
 	// used by DrawQueuedBuildingSquares
 	const float* buildQueueSquareColor = nullptr;
+
+	// owner unit-ID -> index into cachedPaths; a deque since lineDrawer
+	// holds on to the recorded lines of queued paths until it draws them
+	mutable spring::unordered_map<int, size_t> cachedPathIndices;
+	mutable std::deque<CachedPath> cachedPaths;
+	mutable std::vector<size_t> freePathIndices;
+
+	mutable CachedPath* recordedPath = nullptr;
+
+	unsigned int pathGeneration = 0;
 };
 
 #define commandDrawer (CommandDrawer::GetInstance())
@@ -17,6 +17,11 @@
 #include "Sim/Misc/LosHandler.h"
 #include "System/GlobalRNG.h"
 #include "System/Matrix44f.h"
+#include "System/Config/ConfigHandler.h"
+
+CONFIG(bool, InstancedTrees)
+	.defaultValue(false)
+	.description("Draws all visible trees of a type with one instanced call per pass, using transforms gathered once per frame.");
 
 
 struct CAdvTreeSquareDrawer : public CReadMap::IQuadDrawer
@@ -67,11 +72,17 @@ CAdvTreeDrawer::CAdvTreeDrawer()
 	rng.SetSeed(reinterpret_cast<CGlobalUnsyncedRNG::rng_val_type>(this), true);
 
 	treeSquares.resize(nTrees);
+
+	if ((drawInstanced = configHandler->GetBool("InstancedTrees"))) {
+		treeInstanceBuffer.Init();
+		drawInstanced = treeInstanceBuffer.IsValid();
+	}
 }
 
 CAdvTreeDrawer::~CAdvTreeDrawer()
 {
 	shaderHandler->ReleaseProgramObjects("[TreeDrawer]");
+	treeInstanceBuffer.Kill();
 }
 
 
@@ -109,6 +120,8 @@ void CAdvTreeDrawer::LoadTreeShaders() {
 		"treeMat",             // VP, idx TREE_MAT_IDX
 		"viewMat",             // VP, idx VIEW_MAT_IDX
 		"projMat",             // VP, idx PROJ_MAT_IDX
+		"treeMatTex",          // VP, idx 17
+		"treeMatOffset",       // VP, idx INST_OFS_IDX
 	};
 
 
@@ -145,6 +158,8 @@ void CAdvTreeDrawer::LoadTreeShaders() {
 		tp->SetUniform1i(9, 0);
 		tp->SetUniform1f(12, 1.0f - (sunLighting->groundShadowDensity * 0.5f));
 		tp->SetUniform1f(13, globalRendering->gammaExponent);
+		tp->SetUniform1i(17, CModelInstanceBuffer::TEXTURE_UNIT);
+		tp->SetUniform1i(INST_OFS_IDX, -1);
 		tp->Disable();
 		tp->Validate();
 	}
@@ -171,6 +186,9 @@ void CAdvTreeDrawer::Update()
 		}
 	}
 
+	if (drawInstanced)
+		GatherTreeInstances();
+
 	for (std::vector<FallingTree>& v : fallingTrees) {
 
 		for (size_t n = 0; n < v.size(); /*no-op*/) {
@@ -287,7 +305,7 @@ void CAdvTreeDrawer::SetupDrawState(const CCamera* cam, Shader::IProgramObject*
 
 void CAdvTreeDrawer::ResetDrawState()
 {
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 
 	if (shadowHandler.ShadowsLoaded()) {
 		// barkTex
@@ -331,7 +349,7 @@ void CAdvTreeDrawer::SetupShadowDrawState(const CCamera* cam, Shader::IProgramOb
 
 void CAdvTreeDrawer::ResetShadowDrawState()
 {
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 
 	treeShaders[TREE_PROGRAM_ACTIVE]->Disable();
 	treeShaders[TREE_PROGRAM_ACTIVE] = nullptr;
@@ -343,8 +361,111 @@ void CAdvTreeDrawer::ResetShadowDrawState()
 
 
 
+void CAdvTreeDrawer::GatherTreeInstances()
+{
+	constexpr int sqrWorldSize = SQUARE_SIZE * TREE_SQUARE_SIZE;
+
+	// same selection as DrawTrees, cam is also the one used by both passes
+	const CCamera* cam = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER);
+
+	for (auto& trees: instTrees) {
+		trees.clear();
+	}
+
+	for (const int2 idx: squareDrawer.inViewQuads) {
+		const float3 camPos  = cam->GetPos();
+		const float2 midPos = {(idx.x + 0.5f) * sqrWorldSize, (idx.y + 0.5f) * sqrWorldSize};
+		const float3 sqrPos = {midPos.x, CGround::GetHeightReal(midPos.x, midPos.y, false), midPos.y};
+
+		// soft cutoff (gradual density reduction)
+		const float drawProb = std::min(1.0f, Square(GetDrawDistance()) / sqrPos.SqDistance(camPos));
+
+		if (drawProb <= 0.001f)
+			continue;
+
+		rng.SetSeed(rng.GetInitSeed());
+
+		for (int i = 0; i < 2; i++) {
+			const auto& treeSquare = treeSquares[(idx.y * NumTreesX()) + idx.x];
+			const auto& treeStructs = treeSquare.trees[i];
+
+			for (const ITreeDrawer::TreeStruct& ts: treeStructs) {
+				if (rng.NextFloat() > drawProb)
+					continue;
+
+				const CFeature* f = featureHandler.GetFeature(ts.id);
+
+				if (f == nullptr)
+					continue;
+				if (!f->IsInLosForAllyTeam(gu->myAllyTeam))
+					continue;
+
+				instTrees[ts.type].push_back(&ts);
+			}
+		}
+	}
+
+	size_t numInsts = 0;
+
+	for (size_t i = 0; i < instTrees.size(); i++) {
+		instOffsets[i] = numInsts;
+		numInsts += instTrees[i].size();
+	}
+
+	if (numInsts == 0)
+		return;
+
+	float4* texels = treeInstanceBuffer.MapBlocks(numInsts * 4);
+
+	if (texels == nullptr) {
+		for (auto& trees: instTrees) {
+			trees.clear();
+		}
+
+		return;
+	}
+
+	for (size_t i = 0; i < instTrees.size(); i++) {
+		for (size_t j = 0; j < instTrees[i].size(); j++) {
+			float4* treeTexels = &texels[(instOffsets[i] + j) * 4];
+
+			for (size_t k = 0; k < 4; k++) {
+				treeTexels[k] = instTrees[i][j]->mat.col[k];
+			}
+		}
+
+		// convert to absolute texel offsets for the shaders
+		instOffsets[i] = treeInstanceBuffer.GetMappedOffset() + instOffsets[i] * 4;
+	}
+
+	treeInstanceBuffer.UnmapBlocks();
+}
+
+void CAdvTreeDrawer::DrawTreeInstances(Shader::IProgramObject* ipo, int offsetUniformIdx) const
+{
+	treeInstanceBuffer.BindTexture();
+
+	for (unsigned int i = 0; i < instTrees.size(); i++) {
+		if (instTrees[i].empty())
+			continue;
+
+		BindTreeGeometry(i);
+
+		ipo->SetUniform1i(offsetUniformIdx, instOffsets[i]);
+		treeGen.DrawTreeBufferInstanced(i, instTrees[i].size());
+	}
+
+	ipo->SetUniform1i(offsetUniformIdx, -1);
+	treeInstanceBuffer.UnbindTexture();
+}
+
 void CAdvTreeDrawer::DrawTrees(const CCamera* cam, Shader::IProgramObject* ipo)
 {
+	if (drawInstanced) {
+		DrawTreeInstances(ipo, mix(INST_OFS_IDX, 10, shadowHandler.InShadowPass()));
+		return;
+	}
+
 	constexpr int sqrWorldSize = SQUARE_SIZE * TREE_SQUARE_SIZE;
 	const     int matUniformIdx = mix(TREE_MAT_IDX, 3, shadowHandler.InShadowPass());
 
@@ -7,6 +7,7 @@
 
 #include "ITreeDrawer.h"
 #include "AdvTreeGenerator.h"
+#include "Rendering/Models/ModelInstanceBuffer.h"
 #include "System/type2.h"
 
 class CCamera;
@@ -29,6 +30,8 @@ public:
 	void SetupShadowDrawState(const CCamera* cam, Shader::IProgramObject* ipo);
 	void ResetShadowDrawState();
 	void DrawTrees(const CCamera* cam, Shader::IProgramObject* ipo);
+	void DrawTreeInstances(Shader::IProgramObject* ipo, int offsetUniformIdx) const;
+	void GatherTreeInstances();
 	void DrawFallingTrees(const CCamera* cam, Shader::IProgramObject* ipo) const;
 
 	void Update() override;
@@ -41,6 +44,7 @@ public:
 	void DrawTreeGeometry(int treeType) const;
 
 	void AddFallingTree(int treeID, int treeType, const float3& pos, const float3& dir) override;
+	bool HasFallingTrees() const override { return (!fallingTrees[0].empty() || !fallingTrees[1].empty()); }
 
 	struct FallingTree {
 		int id;
@@ -56,6 +60,7 @@ public:
 	static constexpr int TREE_MAT_IDX = 14;
 	static constexpr int VIEW_MAT_IDX = 15;
 	static constexpr int PROJ_MAT_IDX = 16;
+	static constexpr int INST_OFS_IDX = 18;
 
 private:
 	enum TreeShaderProgram {
@@ -68,12 +73,21 @@ private:
 	std::array<Shader::IProgramObject*, TREE_PROGRAM_LAST> treeShaders;
 	std::vector<FallingTree> fallingTrees[2];
 
+	// visible trees per type, gathered once per frame for the instanced
+	// path and shared by the shadow and the regular pass; the matrices
+	// of type i start at block instOffsets[i] of treeInstanceBuffer
+	std::array<std::vector<const TreeStruct*>, NUM_TREE_TYPES * 2> instTrees;
+	std::array<size_t, NUM_TREE_TYPES * 2> instOffsets;
+
+	CModelInstanceBuffer treeInstanceBuffer;
+
 	CAdvTreeGenerator treeGen;
 
 	float3 prvUpdateCamPos;
 	float3 prvUpdateCamDir;
 
 	bool updateVisibility = false;
+	bool drawInstanced = false;
 };
 
 #endif // _ADV_TREE_DRAWER_H_
@@ -185,7 +185,7 @@ void CAdvTreeGenerator::GenVertexBuffers()
 		glGenBuffers(1, &treeVBOs[0]);
 		glGenVertexArrays(1, &treeVAOs[0]);
 
-		glBindVertexArray(treeVAOs[0]);
+		glAttribStatePtr->BindVertexArray(treeVAOs[0]);
 		glBindBuffer(GL_ARRAY_BUFFER, treeVBOs[0]);
 		glBufferData(GL_ARRAY_BUFFER, bushVerts.size() * sizeof(VA_TYPE_TN), bushVerts.data(), GL_STATIC_DRAW);
 
@@ -196,7 +196,7 @@ void CAdvTreeGenerator::GenVertexBuffers()
 		glVertexAttribPointer(1, 2, GL_FLOAT, false, sizeof(VA_TYPE_TN), VA_TYPE_OFFSET(float, 3));
 		glVertexAttribPointer(2, 3, GL_FLOAT, false, sizeof(VA_TYPE_TN), VA_TYPE_OFFSET(float, 5));
 
-		glBindVertexArray(0);
+		glAttribStatePtr->BindVertexArray(0);
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		glDisableVertexAttribArray(2);
 		glDisableVertexAttribArray(1);
@@ -206,7 +206,7 @@ void CAdvTreeGenerator::GenVertexBuffers()
 		glGenBuffers(1, &treeVBOs[1]);
 		glGenVertexArrays(1, &treeVAOs[1]);
 
-		glBindVertexArray(treeVAOs[1]);
+		glAttribStatePtr->BindVertexArray(treeVAOs[1]);
 		glBindBuffer(GL_ARRAY_BUFFER, treeVBOs[1]);
 		glBufferData(GL_ARRAY_BUFFER, pineVerts.size() * sizeof(VA_TYPE_TN), pineVerts.data(), GL_STATIC_DRAW);
 
@@ -217,7 +217,7 @@ void CAdvTreeGenerator::GenVertexBuffers()
 		glVertexAttribPointer(1, 2, GL_FLOAT, false, sizeof(VA_TYPE_TN), VA_TYPE_OFFSET(float, 3));
 		glVertexAttribPointer(2, 3, GL_FLOAT, false, sizeof(VA_TYPE_TN), VA_TYPE_OFFSET(float, 5));
 
-		glBindVertexArray(0);
+		glAttribStatePtr->BindVertexArray(0);
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
 		glDisableVertexAttribArray(2);
 		glDisableVertexAttribArray(1);
@@ -233,7 +233,7 @@ void CAdvTreeGenerator::BindTreeBuffer(unsigned int treeType) const {
 	// to a bush rather than a pine, so flip the type
 	treeType = mix(treeType + NUM_TREE_TYPES, treeType - NUM_TREE_TYPES, treeType >= NUM_TREE_TYPES);
 
-	glBindVertexArray(treeVAOs[treeType >= NUM_TREE_TYPES]);
+	glAttribStatePtr->BindVertexArray(treeVAOs[treeType >= NUM_TREE_TYPES]);
 }
 
 void CAdvTreeGenerator::DrawTreeBuffer(unsigned int treeType) const {
@@ -247,6 +247,15 @@ void CAdvTreeGenerator::DrawTreeBuffer(unsigned int treeType) const {
 	glDrawArrays(primTypes[pineType], baseType * MAX_TREE_VERTS, numTreeVerts[treeType]);
 }
 
+void CAdvTreeGenerator::DrawTreeBufferInstanced(unsigned int treeType, unsigned int numInsts) const {
+	treeType = mix(treeType + NUM_TREE_TYPES, treeType - NUM_TREE_TYPES, treeType >= NUM_TREE_TYPES);
+
+	const unsigned int pineType = (treeType >= NUM_TREE_TYPES);
+	const unsigned int baseType = treeType - (NUM_TREE_TYPES * pineType);
+
+	glDrawArraysInstanced(GL_TRIANGLES, baseType * MAX_TREE_VERTS, numTreeVerts[treeType], numInsts);
+}
+
 
 
 void CAdvTreeGenerator::DrawBushTrunk(const float3& start, const float3& end, const float3& orto1, const float3& orto2, float size)
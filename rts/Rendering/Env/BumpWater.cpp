@@ -421,6 +421,7 @@ CBumpWater::CBumpWater()
 		waterShader->SetUniformLocation("fogColor");      // idx 17
 		waterShader->SetUniformLocation("fogParams");     // idx 18
 		waterShader->SetUniformLocation("gammaExponent"); // idx 19
+		waterShader->SetUniformLocation("reflViewProjMatrix"); // idx 20
 
 		if (!waterShader->IsValid()) {
 			const char* fmt = "water-shader compilation error: %s";
@@ -717,8 +718,8 @@ void CBumpWater::UpdateWater(CGame* game)
 	}
 
 
-	if (refraction > 1) DrawRefraction(game);
-	if (reflection > 0) DrawReflection(game);
+	if (refraction > 1 && UpdateRefractionTex()) DrawRefraction(game);
+	if (reflection > 0 && UpdateReflectionTex()) DrawReflection(game);
 	if (reflection || refraction) {
 		FBO::Unbind();
 		glAttribStatePtr->ViewPort(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
@@ -1106,6 +1107,7 @@ void CBumpWater::Draw()
 	waterShader->SetUniform1f(19, globalRendering->gammaExponent);
 	waterShader->SetUniformMatrix4fv(14, false, camera->GetViewMatrix());
 	waterShader->SetUniformMatrix4fv(15, false, camera->GetProjectionMatrix());
+	waterShader->SetUniformMatrix4fv(20, false, reflViewProjMatrix);
 
 	if (shadowHandler.ShadowsLoaded()) {
 		waterShader->SetUniformMatrix4fv(13, false, shadowHandler.GetShadowViewMatrixRaw());
@@ -1192,6 +1194,9 @@ void CBumpWater::DrawReflection(CGame* game)
 	CCamera* prvCam = CCameraHandler::GetSetActiveCamera(CCamera::CAMTYPE_UWREFL);
 	CCamera* curCam = CCameraHandler::GetActiveCamera();
 
+	// water-plane points project to the same texel in the reflected view
+	reflViewProjMatrix = prvCam->GetViewProjectionMatrix();
+
 	{
 		curCam->CopyStateReflect(prvCam);
 		curCam->UpdateLoadViewPort(0, 0, reflTexSize, reflTexSize);
@@ -9,6 +9,7 @@
 #include "IWater.h"
 
 #include "System/EventClient.h"
+#include "System/Matrix44f.h"
 #include "System/Misc/RectangleOverlapHandler.h"
 
 
@@ -120,6 +121,8 @@ private:
 
 	GLuint uniforms[20]; ///< see useUniforms
 
+	CMatrix44f reflViewProjMatrix; ///< player view at the time reflectTexture was last rendered
+
 	bool wasVisibleLastFrame;
 	GLuint occlusionQuery;
 	GLuint occlusionQueryResult;
@@ -41,6 +41,10 @@ static constexpr int NUM_SCAR_DECALS = SCAR_ATLAS_SIZE / SCAR_DECAL_SIZE;
 static constexpr int TEX_QUAD_SIZE  = SQUARE_SIZE * 2;
 static constexpr int MAX_NUM_DECALS = 4096;
 
+// alpha-buffer slots; [0, MAX_NUM_DECALS) belong to scars
+static constexpr int NUM_ALPHA_SLOTS = MAX_NUM_DECALS * 4;
+static constexpr int DECAL_ALPHA_TEX_UNIT = 4;
+
 // 4K * 2 (object plus scar) decals, 32MB per buffer
 #define NUM_BUFFER_ELEMS ((MAX_NUM_DECALS * 2) * 1024)
 #define ELEM_BUFFER_SIZE (sizeof(VA_TYPE_TC))
@@ -55,6 +59,10 @@ static std::vector<uint8_t> scarTexBuf;
 // free and used slots in <scars>
 static std::vector<int> freeScarIDs;
 static std::vector<int> usedScarIDs;
+// free object decal slots in the alpha-buffer, initially lowest on top
+static std::vector<int> freeAlphaSlots;
+// one past the highest alpha-slot handed out to an object decal
+static int maxAlphaSlot = MAX_NUM_DECALS;
 
 
 
@@ -80,6 +88,8 @@ CGroundDecalHandler::CGroundDecalHandler(): CEventClient("[CGroundDecalHandler]"
 	freeScarIDs.reserve(MAX_NUM_DECALS);
 	usedScarIDs.clear();
 	usedScarIDs.reserve(128);
+	freeAlphaSlots.clear();
+	freeAlphaSlots.reserve(NUM_ALPHA_SLOTS - MAX_NUM_DECALS);
 	scarTexBuf.clear();
 	scarTexBuf.resize(SCAR_ATLAS_SIZE * SCAR_ATLAS_SIZE * 4, 0);
 
@@ -89,6 +99,14 @@ CGroundDecalHandler::CGroundDecalHandler(): CEventClient("[CGroundDecalHandler]"
 		scars[i] = {};
 	}
 
+	for (int i = NUM_ALPHA_SLOTS - 1; i >= MAX_NUM_DECALS; i--) {
+		freeAlphaSlots.push_back(i);
+	}
+
+	maxAlphaSlot = MAX_NUM_DECALS;
+	decalAlphas.clear();
+	decalAlphas.resize(NUM_ALPHA_SLOTS, 0.0f);
+
 	scarFieldX = mapDims.mapx / 32;
 	scarFieldY = mapDims.mapy / 32;
 	scarField.resize(scarFieldX * scarFieldY);
@@ -120,10 +138,12 @@ CGroundDecalHandler::~CGroundDecalHandler()
 	}
 
 	glDeleteTextures(1, &scarAtlasTex);
+	glDeleteTextures(1, &decalAlphaTex);
 
 	shaderHandler->ReleaseProgramObjects("[GroundDecalHandler]");
 
 	decalBuffer.Kill();
+	decalAlphaBuffer.Release();
 }
 
 
@@ -139,6 +159,16 @@ void CGroundDecalHandler::GenDecalBuffers()
 	#ifndef HEADLESS
 	assert(mapBufferPtr != nullptr);
 	#endif
+
+	decalAlphaBuffer = VBO(GL_TEXTURE_BUFFER);
+	decalAlphaBuffer.Bind();
+	decalAlphaBuffer.New(NUM_ALPHA_SLOTS * sizeof(float), GL_STREAM_DRAW);
+	decalAlphaBuffer.Unbind();
+
+	glGenTextures(1, &decalAlphaTex);
+	glBindTexture(GL_TEXTURE_BUFFER, decalAlphaTex);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32F, decalAlphaBuffer.GetId());
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
 }
 
 
@@ -213,7 +243,7 @@ void CGroundDecalHandler::LoadDecalShaders() {
 	decalShaders[DECAL_SHADER_CURR] = decalShaders[DECAL_SHADER_NULL];
 	decalShaders[DECAL_SHADER_GLSL] = sh->CreateProgramObject("[GroundDecalHandler]", "DecalShaderGLSL");
 
-	decalShaders[DECAL_SHADER_GLSL]->AttachShaderObject(sh->CreateShaderObject("GLSL/GroundDecalsVertProg.glsl", "",       GL_VERTEX_SHADER));
+	decalShaders[DECAL_SHADER_GLSL]->AttachShaderObject(sh->CreateShaderObject("GLSL/GroundDecalsVertProg.glsl", "#define USE_DECAL_ALPHA_BUFFER\n", GL_VERTEX_SHADER));
 	decalShaders[DECAL_SHADER_GLSL]->AttachShaderObject(sh->CreateShaderObject("GLSL/GroundDecalsFragProg.glsl", extraDef, GL_FRAGMENT_SHADER));
 	decalShaders[DECAL_SHADER_GLSL]->Link();
 
@@ -233,6 +263,8 @@ void CGroundDecalHandler::LoadDecalShaders() {
 	decalShaders[DECAL_SHADER_GLSL]->SetUniformLocation("shadowDensity");      // idx 11
 	decalShaders[DECAL_SHADER_GLSL]->SetUniformLocation("decalAlpha");         // idx 12
 	decalShaders[DECAL_SHADER_GLSL]->SetUniformLocation("gammaExponent");      // idx 13
+	decalShaders[DECAL_SHADER_GLSL]->SetUniformLocation("decalAlphaTex");      // idx 14
+	decalShaders[DECAL_SHADER_GLSL]->SetUniformLocation("decalAlphaSlots");    // idx 15
 
 	decalShaders[DECAL_SHADER_GLSL]->Enable();
 	decalShaders[DECAL_SHADER_GLSL]->SetUniform1i(0, 0); // decalTex  (idx 0, texunit 0)
@@ -243,6 +275,8 @@ void CGroundDecalHandler::LoadDecalShaders() {
 	decalShaders[DECAL_SHADER_GLSL]->SetUniform1f(11, sunLighting->groundShadowDensity);
 	decalShaders[DECAL_SHADER_GLSL]->SetUniform1f(12, 1.0f);
 	decalShaders[DECAL_SHADER_GLSL]->SetUniform1f(13, globalRendering->gammaExponent);
+	decalShaders[DECAL_SHADER_GLSL]->SetUniform1i(14, DECAL_ALPHA_TEX_UNIT); // decalAlphaTex (idx 14, texunit 4)
+	decalShaders[DECAL_SHADER_GLSL]->SetUniform1f(15, 0.0f);
 	decalShaders[DECAL_SHADER_GLSL]->Disable();
 	decalShaders[DECAL_SHADER_GLSL]->Validate();
 
@@ -258,7 +292,7 @@ void CGroundDecalHandler::SunChanged() {
 
 
 
-inline void CGroundDecalHandler::DrawObjectDecal(SolidObjectGroundDecal* decal)
+inline void CGroundDecalHandler::BatchObjectDecal(SolidObjectGroundDecal* decal)
 {
 	#ifndef HEADLESS
 	if (!camera->InView(decal->pos, decal->radius + TEX_QUAD_SIZE))
@@ -271,9 +305,22 @@ inline void CGroundDecalHandler::DrawObjectDecal(SolidObjectGroundDecal* decal)
 	const unsigned int decalIdx = decal->bufIndx;
 	const unsigned int numVerts = decal->bufSize / sizeof(VA_TYPE_TC);
 
-	const SColor color(255, 255, 255, 255);
-
 	if (numVerts == 0) {
+		// alpha-buffer exhausted, decal stays invisible until a slot frees up
+		if (freeAlphaSlots.empty())
+			return;
+
+		decal->alphaSlot = spring::VectorBackPop(freeAlphaSlots);
+		maxAlphaSlot = std::max(maxAlphaSlot, decal->alphaSlot + 1);
+
+		// the slot travels with each vertex, VS fetches the alpha from it
+		const SColor color(decal->alphaSlot & 0xFF, decal->alphaSlot >> 8, 255, 255);
+
+		// pos{x,y} are multiples of SQUARE_SIZE, but pos might not be
+		// shift the decal visually in the latter case so it is aligned
+		// with the object on top of it
+		const float3 offset{(int(decal->pos.x) % SQUARE_SIZE) * 1.0f, 0.0f, (int(decal->pos.z) % SQUARE_SIZE) * 1.0f};
+
 		// NOTE: this really needs CLOD'ing
 		const int dxsize = decal->xsize;
 		const int dzsize = decal->ysize;
@@ -341,7 +388,7 @@ inline void CGroundDecalHandler::DrawObjectDecal(SolidObjectGroundDecal* decal)
 				}
 
 				#define HEIGHT2WORLD(x) ((x) << 3)
-				#define VERTEX(x, y, z) float3(HEIGHT2WORLD((x)), (y), HEIGHT2WORLD((z)))
+				#define VERTEX(x, y, z) (float3(HEIGHT2WORLD((x)), (y), HEIGHT2WORLD((z))) + offset)
 				*(curBufferPos++) = { VERTEX(px    , yv[0], pz    ),  uv[0], uv[1],  color}; // tl
 				*(curBufferPos++) = { VERTEX(px + 1, yv[1], pz    ),  uv[2], uv[3],  color}; // tr
 				*(curBufferPos++) = { VERTEX(px + 1, yv[2], pz + 1),  uv[4], uv[5],  color}; // br
@@ -357,28 +404,22 @@ inline void CGroundDecalHandler::DrawObjectDecal(SolidObjectGroundDecal* decal)
 		return;
 	}
 
-	// pos{x,y} are multiples of SQUARE_SIZE, but pos might not be
-	// shift the decal visually in the latter case so it is aligned
-	// with the object on top of it
-	const float3 pos{(int(decal->pos.x) % SQUARE_SIZE) * 1.0f, 0.0f, (int(decal->pos.z) % SQUARE_SIZE) * 1.0f};
-	const CMatrix44f mat{pos};
-
-	decalShaders[DECAL_SHADER_CURR]->SetUniform1f(12, decal->alpha);
-	decalShaders[DECAL_SHADER_CURR]->SetUniformMatrix4fv(8, false, mat);
-	decalBuffer.Submit(GL_TRIANGLES, decalIdx, numVerts);
+	decalAlphas[decal->alphaSlot] = decal->alpha;
 
-	#undef HEIGHT
+	batchFirsts.push_back(decalIdx);
+	batchCounts.push_back(numVerts);
 	#endif
 }
 
 
-inline void CGroundDecalHandler::DrawGroundScar(CGroundDecalHandler::Scar& scar)
+inline void CGroundDecalHandler::BatchGroundScar(CGroundDecalHandler::Scar& scar)
 {
 	#ifndef HEADLESS
 	if (!camera->InView(scar.pos, scar.radius + TEX_QUAD_SIZE))
 		return;
 
-	const SColor color(255, 255, 255, 255);
+	// scars use their id as alpha-slot
+	const SColor color(scar.id & 0xFF, scar.id >> 8, 255, 255);
 
 	const unsigned int decalIdx = scar.bufIndx;
 	const unsigned int numVerts = scar.bufSize / sizeof(VA_TYPE_TC);
@@ -450,13 +491,33 @@ inline void CGroundDecalHandler::DrawGroundScar(CGroundDecalHandler::Scar& scar)
 	if (gs->frameNum != scar.lastUpdateFrame)
 		scar.fadedAlpha = scarAlphaDecayFuncs[ (scar.creationTime + 10) <= gs->frameNum ](scar, scar.lastUpdateFrame = gs->frameNum);
 
-	decalShaders[DECAL_SHADER_CURR]->SetUniform1f(12, scar.fadedAlpha);
-	decalShaders[DECAL_SHADER_CURR]->SetUniformMatrix4fv(8, false, CMatrix44f::Identity());
-	decalBuffer.Submit(GL_TRIANGLES, decalIdx, numVerts);
+	decalAlphas[scar.id] = scar.fadedAlpha;
+
+	batchFirsts.push_back(decalIdx);
+	batchCounts.push_back(numVerts);
 	#endif
 }
 
 
+void CGroundDecalHandler::UploadDecalAlphas(size_t slotsBeg, size_t slotsEnd)
+{
+	if (slotsBeg >= slotsEnd)
+		return;
+
+	decalAlphaBuffer.Bind();
+	glBufferSubData(GL_TEXTURE_BUFFER, slotsBeg * sizeof(float), (slotsEnd - slotsBeg) * sizeof(float), &decalAlphas[slotsBeg]);
+	decalAlphaBuffer.Unbind();
+}
+
+void CGroundDecalHandler::SubmitDecalBatch(size_t batchBeg, size_t batchEnd)
+{
+	if (batchBeg >= batchEnd)
+		return;
+
+	decalBuffer.SubmitMulti(GL_TRIANGLES, &batchFirsts[batchBeg], &batchCounts[batchBeg], batchEnd - batchBeg);
+}
+
+
 
 void CGroundDecalHandler::GatherDecalsForType(CGroundDecalHandler::SolidObjectDecalType& decalType) {
 	decalsToDraw.clear();
@@ -483,6 +544,8 @@ void CGroundDecalHandler::GatherDecalsForType(CGroundDecalHandler::SolidObjectDe
 				// make sure RemoveSolidObject() won't try to modify this decal
 				if (decalOwner != nullptr)
 					decalOwner->groundDecal = nullptr;
+				if (decal->alphaSlot >= 0)
+					freeAlphaSlots.push_back(decal->alphaSlot);
 
 				sogdMemPool.free(decal);
 
@@ -527,22 +590,33 @@ void CGroundDecalHandler::GatherDecalsForType(CGroundDecalHandler::SolidObjectDe
 }
 
 void CGroundDecalHandler::DrawObjectDecals() {
-	// create and draw the quads for each building decal
-	for (SolidObjectDecalType& decalType: objectDecalTypes) {
-		if (decalType.objectDecals.empty())
-			continue;
+	batchFirsts.clear();
+	batchCounts.clear();
+	typeBatchRanges.clear();
 
-		GatherDecalsForType(decalType);
+	// create the quads for each building decal and gather one batch per type
+	for (SolidObjectDecalType& decalType: objectDecalTypes) {
+		const size_t batchBeg = batchFirsts.size();
 
-		if (!decalsToDraw.empty()) {
-			glBindTexture(GL_TEXTURE_2D, decalType.texture);
+		if (!decalType.objectDecals.empty()) {
+			GatherDecalsForType(decalType);
 
 			for (SolidObjectGroundDecal* decal: decalsToDraw) {
-				DrawObjectDecal(decal);
+				BatchObjectDecal(decal);
 			}
 		}
 
-		// glBindTexture(GL_TEXTURE_2D, 0);
+		typeBatchRanges.emplace_back(batchBeg, batchFirsts.size());
+	}
+
+	UploadDecalAlphas(MAX_NUM_DECALS, maxAlphaSlot);
+
+	for (size_t i = 0, n = objectDecalTypes.size(); i < n; i++) {
+		if (typeBatchRanges[i].first == typeBatchRanges[i].second)
+			continue;
+
+		glBindTexture(GL_TEXTURE_2D, objectDecalTypes[i].texture);
+		SubmitDecalBatch(typeBatchRanges[i].first, typeBatchRanges[i].second);
 	}
 }
 
@@ -575,7 +649,10 @@ void CGroundDecalHandler::AddScars()
 }
 
 void CGroundDecalHandler::DrawScars() {
-	// create and draw the 16x16 quads for each ground scar
+	batchFirsts.clear();
+	batchCounts.clear();
+
+	// create the 16x16 quads for each ground scar, all share the atlas
 	for (size_t i = 0; i < usedScarIDs.size(); ) {
 		Scar& scar = scars[ usedScarIDs[i] ];
 
@@ -586,10 +663,13 @@ void CGroundDecalHandler::DrawScars() {
 			continue;
 		}
 
-		DrawGroundScar(scar);
+		BatchGroundScar(scar);
 
 		i++;
 	}
+
+	UploadDecalAlphas(0, MAX_NUM_DECALS);
+	SubmitDecalBatch(0, batchFirsts.size());
 }
 
 
@@ -629,11 +709,17 @@ void CGroundDecalHandler::BindTextures()
 	if (shadowHandler.ShadowsLoaded())
 		shadowHandler.SetupShadowTexSampler(GL_TEXTURE2);
 
+	glActiveTexture(GL_TEXTURE0 + DECAL_ALPHA_TEX_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, decalAlphaTex);
+
 	glActiveTexture(GL_TEXTURE0);
 }
 
 void CGroundDecalHandler::KillTextures()
 {
+	glActiveTexture(GL_TEXTURE0 + DECAL_ALPHA_TEX_UNIT);
+	glBindTexture(GL_TEXTURE_BUFFER, 0);
+
 	glActiveTexture(GL_TEXTURE3);
 	glBindTexture(GL_TEXTURE_2D, 0);
 
@@ -664,6 +750,11 @@ void CGroundDecalHandler::BindShader(const float3& ambientColor)
 
 void CGroundDecalHandler::DrawDecals()
 {
+	// per-decal alphas come from the alpha-buffer instead of uniforms
+	decalShaders[DECAL_SHADER_CURR]->SetUniform1f(12, 1.0f);
+	decalShaders[DECAL_SHADER_CURR]->SetUniform1f(15, 1.0f);
+	decalShaders[DECAL_SHADER_CURR]->SetUniformMatrix4fv(8, false, CMatrix44f::Identity());
+
 	// draw building decals
 	glAttribStatePtr->PolygonOffset(-10.0f, -200.0f);
 	DrawObjectDecals();
@@ -674,6 +765,7 @@ void CGroundDecalHandler::DrawDecals()
 	AddScars();
 	DrawScars();
 
+	decalShaders[DECAL_SHADER_CURR]->SetUniform1f(15, 0.0f);
 	decalShaders[DECAL_SHADER_CURR]->Disable();
 }
 
@@ -713,6 +805,14 @@ void CGroundDecalHandler::AddExplosion(float3 pos, float damage, float radius)
 	if (damage > 400.0f)
 		damage = 400.0f + std::sqrt(damage - 399.0f);
 
+	// decal limit reached, evict the registered scar closest to expiring
+	if (freeScarIDs.empty() && !usedScarIDs.empty()) {
+		const auto pred = [](int a, int b) { return (scars[a].lifeTime < scars[b].lifeTime); };
+		const auto iter = std::min_element(usedScarIDs.begin(), usedScarIDs.end(), pred);
+
+		RemoveScar(scars[*iter]);
+	}
+
 	const int id = GetScarID();
 	const int ttl = std::max(1.0f, decalLevel * damage * 3.0f);
 
@@ -891,7 +991,7 @@ int CGroundDecalHandler::GetSolidObjectDecalType(const std::string& name)
 
 	SolidObjectDecalType tt;
 	tt.name = lowerName;
-	tt.texture = bm.CreateMipMapTexture();
+	tt.texture = bm.CreateCompressedTexture(0.0f, 0.0f, true);
 
 	objectDecalTypes.push_back(tt);
 	return (objectDecalTypes.size() - 1);
@@ -9,6 +9,7 @@
 #include "Rendering/Env/IGroundDecalDrawer.h"
 #include "Rendering/Env/Decals/LegacyTrackHandler.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
+#include "Rendering/GL/VBO.h"
 #include "System/float3.h"
 #include "System/EventClient.h"
 #include "Sim/Projectiles/ExplosionListener.h"
@@ -38,6 +39,8 @@ public:
 		bufIndx = d.bufIndx;
 		bufSize = d.bufSize;
 
+		alphaSlot = d.alphaSlot; d.alphaSlot = -1;
+
 		lastUpdateFrame = d.lastUpdateFrame;
 
 		posx   = d.posx;
@@ -63,6 +66,8 @@ public:
 
 	unsigned int lastUpdateFrame = 0;
 
+	int alphaSlot = -1; // index into the decal-alpha buffer, taken when verts are generated
+
 	int posx = 0;
 	int posy = 0;
 	int xsize = 0;
@@ -223,8 +228,10 @@ private:
 	void GatherDecalsForType(SolidObjectDecalType& decalType);
 	void AddDecal(CUnit* unit, const float3& newPos);
 
-	void DrawObjectDecal(SolidObjectGroundDecal* decal);
-	void DrawGroundScar(Scar& scar);
+	void BatchObjectDecal(SolidObjectGroundDecal* decal);
+	void BatchGroundScar(Scar& scar);
+	void UploadDecalAlphas(size_t slotsBeg, size_t slotsEnd);
+	void SubmitDecalBatch(size_t batchBeg, size_t batchEnd);
 
 	int GetScarID() const;
 	int ScarOverlapSize(const Scar& s1, const Scar& s2);
@@ -247,12 +254,23 @@ private:
 
 	std::vector<int> addedScars;
 
+	// (first, count) vertex-ranges of the decals drawn per multi-draw,
+	// and the range of batch entries belonging to each object decal type
+	std::vector<int> batchFirsts;
+	std::vector<int> batchCounts;
+	std::vector<std::pair<size_t, size_t>> typeBatchRanges;
+
 	// stores indices into <scars> of reserved slots, per quad
 	std::vector<std::vector<int>> scarField;
 
 
 	GL::RenderDataBuffer decalBuffer;
 
+	// R32F texture-buffer of per-decal alphas; scars use their id as
+	// slot, object decals the slots following those
+	VBO decalAlphaBuffer;
+	std::vector<float> decalAlphas;
+
 	VA_TYPE_TC* mapBufferPtr = nullptr; // start-pos
 	VA_TYPE_TC* curBufferPos = nullptr; // write-pos
 
@@ -261,6 +279,7 @@ private:
 	int scarFieldY = 0;
 
 	unsigned int scarAtlasTex = 0;
+	unsigned int decalAlphaTex = 0;
 
 	// number of calls made to TestScarOverlaps
 	int lastScarOverlapTest = 0;
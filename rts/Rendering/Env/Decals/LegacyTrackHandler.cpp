@@ -499,7 +499,7 @@ unsigned int LegacyTrackHandler::LoadTexture(const std::string& name)
 		}
 	}
 
-	return bm.CreateMipMapTexture();
+	return bm.CreateCompressedTexture(0.0f, 0.0f, true);
 }
 
 
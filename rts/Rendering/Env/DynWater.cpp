@@ -403,8 +403,11 @@ void CDynWater::UpdateWater(CGame* game)
 	glAttribStatePtr->Enable(GL_DEPTH_TEST);
 	glAttribStatePtr->DepthMask(1);
 
-	DrawRefraction(game);
-	DrawReflection(game);
+	if (UpdateRefractionTex())
+		DrawRefraction(game);
+	if (UpdateReflectionTex())
+		DrawReflection(game);
+
 	FBO::Unbind();
 	glAttribStatePtr->PopAttrib();
 }
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cmath>
 
 #include "GrassDrawer.h"
@@ -29,6 +30,7 @@
 #include "System/TimeProfiler.h"
 #include "System/Log/ILog.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/Threading/ThreadPool.h"
 
 CONFIG(int, GrassDetail).defaultValue(7).headlessValue(0).minimumValue(0).description("Sets how detailed the engine rendered grass will be on any given map.");
 
@@ -67,10 +69,12 @@ static constexpr int   blockMapSize    = grassSquareSize * grassBlockSize;
 static constexpr int   GSSSQ = SQUARE_SIZE * grassSquareSize;
 static constexpr int   BMSSQ = SQUARE_SIZE * blockMapSize;
 
-static GrassRNG drawRNG;
-static GrassRNG turfRNG;
+// {rotation, position + draw-threshold, block-reference position}
+static constexpr int   TURF_TEXELS       = 3;
+static constexpr int   MAX_TURF_DETAIL   = 128;
+static constexpr int   MAX_CACHED_BLOCKS = 1024;
 
-static std::array<CMatrix44f, 128> turfMatrices;
+static GrassRNG turfRNG;
 
 static CGrassBlockDrawer blockDrawer;
 
@@ -104,7 +108,6 @@ CGrassDrawer::CGrassDrawer(): CEventClient("[GrassDrawer]", 199992, false)
 			throw std::runtime_error(b);
 		}
 
-		// grassBlocks.resize(blockCount.x * blockCount.y);
 		grassMap.resize(mapDims.mapx * mapDims.mapy / (grassSquareSize * grassSquareSize));
 
 		memcpy(grassMap.data(), grassdata, grassMap.size());
@@ -132,8 +135,11 @@ CGrassDrawer::CGrassDrawer(): CEventClient("[GrassDrawer]", 199992, false)
 	}
 
 	// create shaders and finalize
+	grassBlocks.resize(blockCount.x * blockCount.y);
+	turfInstanceBuffer.Init();
+
 	ChangeDetail(detail);
-	defDrawGrass = LoadGrassShaders();
+	defDrawGrass = LoadGrassShaders() && turfInstanceBuffer.IsValid();
 	configHandler->NotifyOnChange(this, {"GrassDetail"});
 
 	// eventclient
@@ -150,6 +156,7 @@ CGrassDrawer::~CGrassDrawer()
 	glDeleteTextures(1, &grassBladeTex);
 
 	grassBuffer.Kill();
+	turfInstanceBuffer.Kill();
 	shaderHandler->ReleaseProgramObjects("[GrassDrawer]");
 }
 
@@ -165,12 +172,14 @@ void CGrassDrawer::ChangeDetail(int detail) {
 	grassDrawDist = std::sqrt(detail * 1.0f) * 100.0f;
 
 	// turfs per block
-	turfDetail.x = std::min(3 + int(minDetail * 0.5f), int(turfMatrices.size()));
+	turfDetail.x = std::min(3 + int(minDetail * 0.5f), MAX_TURF_DETAIL);
 	// straws per turf
 	turfDetail.y = std::min(50 + int(std::sqrt(minDetail * 1.0f) * 10), mapInfo->grass.maxStrawsPerTurf);
 
 	// recreate turf geometry
 	CreateGrassBuffer();
+	// number of turfs per square changed
+	InvalidateBlocks();
 }
 
 void CGrassDrawer::ConfigNotify(const std::string& key, const std::string& value) {
@@ -197,10 +206,6 @@ bool CGrassDrawer::LoadGrassShaders() {
 		grassShaders[i]->SetFlag("HAVE_SHADOWS", shadowHandler.ShadowsLoaded());
 		grassShaders[i]->SetFlag("SHADOW_GEN", i == GRASS_PROGRAM_SHADOW);
 
-		// idx 0, not settable as an array via name-based API
-		// needs to be named "[0]" or state-copying will fail
-		grassShaders[i]->SetUniformLocation("turfMatrices[0]");
-
 		grassShaders[i]->Enable();
 		grassShaders[i]->SetUniform("mapSizePO2", 1.0f / (mapDims.pwr2mapx * SQUARE_SIZE), 1.0f / (mapDims.pwr2mapy * SQUARE_SIZE));
 		grassShaders[i]->SetUniform("mapSize",    1.0f / (mapDims.mapx     * SQUARE_SIZE), 1.0f / (mapDims.mapy     * SQUARE_SIZE));
@@ -209,6 +214,8 @@ bool CGrassDrawer::LoadGrassShaders() {
 		grassShaders[i]->SetUniform("shadingTex",      2);
 		grassShaders[i]->SetUniform("infoMap",         3);
 		grassShaders[i]->SetUniform("shadowMap",       4);
+		grassShaders[i]->SetUniform("turfInstTex",     int(CModelInstanceBuffer::TEXTURE_UNIT));
+		grassShaders[i]->SetUniform("turfInstOffset",  0);
 		grassShaders[i]->SetUniform("infoTexIntensityMul", 1.0f);
 		grassShaders[i]->SetUniform("specularExponent", sunLighting->specularExponent);
 		grassShaders[i]->SetUniform("groundShadowDensity", sunLighting->groundShadowDensity);
@@ -332,6 +339,7 @@ void CGrassDrawer::CreateGrassBladeTex(uint8_t* buf)
 void CGrassDrawer::EnableShader(const GrassShaderProgram type) {
 	const float3 windSpeed = envResHandler.GetCurrentWindVec() * mapInfo->grass.bladeWaveScale;
 	const float3 fogParams = {sky->fogStart, sky->fogEnd, camera->GetFarPlaneDist()};
+	const float3& playerCamPos = CCameraHandler::GetCamera(CCamera::CAMTYPE_PLAYER)->GetPos();
 
 	Shader::IProgramObject* ipo = (grassShaders[GRASS_PROGRAM_CURR] = grassShaders[type]);
 
@@ -345,6 +353,9 @@ void CGrassDrawer::EnableShader(const GrassShaderProgram type) {
 	ipo->SetUniform3v("camDir",    &camera->GetDir().x);
 	ipo->SetUniform3v("camUp",     &camera->GetUp().x);
 	ipo->SetUniform3v("camRight",  &camera->GetRight().x);
+	// turf density always follows the player camera, also in the shadow pass
+	ipo->SetUniform3v("cullCamPos", &playerCamPos.x);
+	ipo->SetUniform("grassDrawDistSq", grassDrawDist * grassDrawDist);
 
 	ipo->SetUniform("infoTexIntensityMul", float(infoTextureHandler->InMetalMode()) + 1.0f);
 	ipo->SetUniform("specularExponent"   , sunLighting->specularExponent);
@@ -378,89 +389,175 @@ void CGrassDrawer::EnableShader(const GrassShaderProgram type) {
 //////////////////////////////////////////////////////////////////////////////////////////////////
 //
 // NB: has to use another RNG so density reduction is not influenced
-static float3 GetRandomTurfParams(const int2& blockPos)
+static float3 GetRandomTurfParams(GrassRNG& rng, const int2& squarePos)
 {
 	float3 p;
-	p.x = (blockPos.x + turfRNG.NextFloat()) * GSSSQ;
-	p.y = (blockPos.y + turfRNG.NextFloat()) * GSSSQ;
-	p.z = (turfRNG.NextFloat() * 360.0f) * math::DEG_TO_RAD; // rotation
+	p.x = (squarePos.x + rng.NextFloat()) * GSSSQ;
+	p.y = (squarePos.y + rng.NextFloat()) * GSSSQ;
+	p.z = (rng.NextFloat() * 360.0f) * math::DEG_TO_RAD; // rotation
 	return p;
 }
 
-static float GetGrassBlockCamDistSq(const float3& pos, const int2 coors)
+static float3 GetGrassSquareRefPos(const int2 coors)
 {
 	const float qx = coors.x * GSSSQ;
 	const float qz = coors.y * GSSSQ;
 
-	const float3 mid = {qx, CGround::GetHeightReal(qx, qz, false), qz};
-	const float3 dif = pos - mid;
-
-	return (dif.SqLength());
+	return {qx, CGround::GetHeightReal(qx, qz, false), qz};
 }
 
 
 
-unsigned int CGrassDrawer::DrawBlock(const float3& camPos, const int2& blockPos, unsigned int turfMatIndex)
+// called from worker threads, reads only the grass- and height-maps
+void CGrassDrawer::GenerateBlock(const int2& blockPos, std::vector<float4>& texels) const
 {
-	const float blockDist = GetGrassBlockCamDistSq(camPos, blockPos);
-	const float drawProb = std::min(1.0f, Square(grassDrawDist) / blockDist);
+	GrassRNG drawRNG;
+	GrassRNG posRNG;
 
-	if (drawProb < 0.001f)
-		return 0;
+	texels.clear();
 
-	drawRNG.Seed(blockPos.y * (mapDims.mapx / grassSquareSize) + blockPos.x);
-	turfRNG.Seed(blockPos.y * (mapDims.mapx / grassSquareSize) + blockPos.x);
+	for (int y = blockPos.y * grassBlockSize; y < (blockPos.y + 1) * grassBlockSize; ++y) {
+		for (int x = blockPos.x * grassBlockSize; x < (blockPos.x + 1) * grassBlockSize; ++x) {
+			const int squareIdx = y * (mapDims.mapx / grassSquareSize) + x;
 
-	unsigned int numVisibleTurfs = 0;
+			if (grassMap[squareIdx] == 0)
+				continue;
 
-	// TODO: LODs?
-	for (int a = 0; a < turfDetail.x; a++) {
-		if (drawRNG.NextFloat() > drawProb)
-			continue;
+			const float3 refPos = GetGrassSquareRefPos({x, y});
+
+			drawRNG.Seed(squareIdx);
+			posRNG.Seed(squareIdx);
+
+			// each turf keeps its draw-threshold, turfs with a threshold
+			// above the distance-based draw probability are discarded by
+			// the vertex shader
+			for (int a = 0; a < turfDetail.x; a++) {
+				const float drawThreshold = drawRNG.NextFloat();
 
-		const float3& rtp = GetRandomTurfParams(blockPos);
-		const float3  pos = {rtp.x, CGround::GetHeightReal(rtp.x, rtp.y, false) - CGround::GetSlope(rtp.x, rtp.y, false) * 30.0f, rtp.y};
+				const float3& rtp = GetRandomTurfParams(posRNG, {x, y});
+				const float3  pos = {rtp.x, CGround::GetHeightReal(rtp.x, rtp.y, false) - CGround::GetSlope(rtp.x, rtp.y, false) * 30.0f, rtp.y};
 
-		turfMatrices[turfMatIndex + numVisibleTurfs].LoadIdentity();
-		turfMatrices[turfMatIndex + numVisibleTurfs].Translate(pos);
-		turfMatrices[turfMatIndex + numVisibleTurfs].RotateY(-rtp.z);
+				CMatrix44f turfMatrix;
+				turfMatrix.Translate(pos);
+				turfMatrix.RotateY(-rtp.z);
 
-		numVisibleTurfs += 1;
+				texels.emplace_back(turfMatrix.m[0], turfMatrix.m[2], turfMatrix.m[8], turfMatrix.m[10]);
+				texels.emplace_back(pos, drawThreshold);
+				texels.emplace_back(refPos, 0.0f);
+			}
+		}
 	}
+}
 
-	return numVisibleTurfs;
+void CGrassDrawer::InvalidateBlock(int blockIdx)
+{
+	grassBlocks[blockIdx].cached = false;
+	updateInstances = true;
 }
 
-void CGrassDrawer::DrawBlocks(const CCamera* cam)
+void CGrassDrawer::InvalidateBlocks()
 {
-	Shader::IProgramObject* grassShader = grassShaders[GRASS_PROGRAM_CURR];
+	for (const int blockIdx: cachedBlocks) {
+		grassBlocks[blockIdx].texels.clear();
+		grassBlocks[blockIdx].lastVisUpdate = 0;
+		grassBlocks[blockIdx].cached = false;
+	}
 
-	const unsigned int maxTurfsPerBatch = turfMatrices.size() - turfDetail.x + 1;
-	      unsigned int numInstanceTurfs = 0;
+	cachedBlocks.clear();
+	updateInstances = true;
+}
+
+void CGrassDrawer::UpdateInstances()
+{
+	SCOPED_TIMER("Update::GrassDrawer::Instances");
+
+	visUpdateCount += 1;
+	pendingBlocks.clear();
+
+	size_t numTexels = 0;
 
 	for (const int2 idx: blockDrawer.inViewQuads) {
-		for (int y = idx.y * grassBlockSize; y < (idx.y + 1) * grassBlockSize; ++y) {
-			for (int x = idx.x * grassBlockSize; x < (idx.x + 1) * grassBlockSize; ++x) {
-				if (grassMap[y * (mapDims.mapx / grassSquareSize) + x] == 0)
-					continue;
+		const int blockIdx = idx.y * blockCount.x + idx.x;
+
+		GrassBlock& block = grassBlocks[blockIdx];
+
+		// a zero update-count marks blocks not (yet) in the cached list
+		if (block.lastVisUpdate == 0)
+			cachedBlocks.push_back(blockIdx);
+
+		if (!block.cached) {
+			pendingBlocks.push_back(blockIdx);
+			block.cached = true;
+		}
+
+		block.lastVisUpdate = visUpdateCount;
+	}
+
+	// only blocks that entered view (or were invalidated) since the
+	// last update need to be generated; do so in parallel
+	for_mt(0, pendingBlocks.size(), [&](const int i) {
+		const int blockIdx = pendingBlocks[i];
+		GenerateBlock({blockIdx % blockCount.x, blockIdx / blockCount.x}, grassBlocks[blockIdx].texels);
+	});
+
+	for (const int2 idx: blockDrawer.inViewQuads) {
+		numTexels += grassBlocks[idx.y * blockCount.x + idx.x].texels.size();
+	}
 
-				if ((numInstanceTurfs += DrawBlock(cam->GetPos(), {x, y}, numInstanceTurfs)) < maxTurfsPerBatch)
-					continue;
+	numInstanceTurfs = 0;
+	instanceTexelOffset = 0;
 
-				grassShader->SetUniformMatrix4fv(0, -int(numInstanceTurfs), false, &turfMatrices[0].m[0]);
-				grassBuffer.SubmitIndexedInstanced(GL_TRIANGLES, 0, grassBuffer.GetNumIndcs<uint32_t>(), numInstanceTurfs);
+	if (numTexels > 0) {
+		float4* texels = turfInstanceBuffer.MapBlocks(numTexels);
 
-				numInstanceTurfs = 0;
+		if (texels != nullptr) {
+			for (const int2 idx: blockDrawer.inViewQuads) {
+				const std::vector<float4>& blockTexels = grassBlocks[idx.y * blockCount.x + idx.x].texels;
+
+				std::copy(blockTexels.begin(), blockTexels.end(), texels);
+				texels += blockTexels.size();
 			}
+
+			numInstanceTurfs = numTexels / TURF_TEXELS;
+			instanceTexelOffset = turfInstanceBuffer.GetMappedOffset();
+
+			turfInstanceBuffer.UnmapBlocks();
 		}
 	}
 
+	if (cachedBlocks.size() <= MAX_CACHED_BLOCKS)
+		return;
+
+	// release the data of blocks that have left view
+	for (size_t i = 0; i < cachedBlocks.size(); ) {
+		GrassBlock& block = grassBlocks[cachedBlocks[i]];
+
+		if (block.lastVisUpdate == visUpdateCount) {
+			i += 1;
+			continue;
+		}
+
+		block.texels.clear();
+		block.texels.shrink_to_fit();
+		block.lastVisUpdate = 0;
+		block.cached = false;
+
+		cachedBlocks[i] = cachedBlocks.back();
+		cachedBlocks.pop_back();
+	}
+}
+
+void CGrassDrawer::DrawBlocks(const CCamera* cam)
+{
 	if (numInstanceTurfs == 0)
 		return;
 
-	// draw any leftovers
-	grassShader->SetUniformMatrix4fv(0, -int(numInstanceTurfs), false, &turfMatrices[0].m[0]);
+	Shader::IProgramObject* grassShader = grassShaders[GRASS_PROGRAM_CURR];
+
+	turfInstanceBuffer.BindTexture();
+	grassShader->SetUniform("turfInstOffset", int(instanceTexelOffset));
 	grassBuffer.SubmitIndexedInstanced(GL_TRIANGLES, 0, grassBuffer.GetNumIndcs<uint32_t>(), numInstanceTurfs);
+	turfInstanceBuffer.UnbindTexture();
 }
 
 
@@ -481,8 +578,36 @@ void CGrassDrawer::Update()
 		blockDrawer.ResetState();
 		readMap->GridVisibility(nullptr, &blockDrawer, grassDrawDist * grassDrawDist, blockMapSize);
 
+		// instance data only changes when the camera crosses block boundaries
+		updateInstances |= (blockDrawer.inViewQuads != prvInViewQuads);
 		updateVisibility = false;
 	}
+
+	if (!updateInstances || !defDrawGrass)
+		return;
+
+	UpdateInstances();
+
+	prvInViewQuads = blockDrawer.inViewQuads;
+	updateInstances = false;
+}
+
+void CGrassDrawer::UnsyncedHeightMapUpdate(const SRectangle& rect)
+{
+	if (grassBlocks.empty())
+		return;
+
+	// turfs near the rectangle's edges also sample the modified heights
+	const int x1 = Clamp((rect.x1 - 1) / blockMapSize, 0, blockCount.x - 1);
+	const int z1 = Clamp((rect.z1 - 1) / blockMapSize, 0, blockCount.y - 1);
+	const int x2 = Clamp((rect.x2 + 1) / blockMapSize, 0, blockCount.x - 1);
+	const int z2 = Clamp((rect.z2 + 1) / blockMapSize, 0, blockCount.y - 1);
+
+	for (int z = z1; z <= z2; z++) {
+		for (int x = x1; x <= x2; x++) {
+			InvalidateBlock(z * blockCount.x + x);
+		}
+	}
 }
 
 
@@ -600,6 +725,7 @@ void CGrassDrawer::AddGrass(const float3& pos)
 	assert(z >= 0 && z < (mapDims.mapy / grassSquareSize));
 
 	grassMap[z * (mapDims.mapx / grassSquareSize) + x] = 1;
+	InvalidateBlock((z / grassBlockSize) * blockCount.x + (x / grassBlockSize));
 }
 
 void CGrassDrawer::RemoveGrass(const float3& pos)
@@ -613,6 +739,7 @@ void CGrassDrawer::RemoveGrass(const float3& pos)
 	assert(z >= 0 && z < (mapDims.mapy / grassSquareSize));
 
 	grassMap[z * (mapDims.mapx / grassSquareSize) + x] = 0;
+	InvalidateBlock((z / grassBlockSize) * blockCount.x + (x / grassBlockSize));
 }
 
 uint8_t CGrassDrawer::GetGrass(const float3& pos)
@@ -7,6 +7,7 @@
 #include <vector>
 
 #include "Rendering/GL/RenderDataBuffer.hpp"
+#include "Rendering/Models/ModelInstanceBuffer.h"
 #include "System/float3.h"
 #include "System/type2.h"
 #include "System/EventClient.h"
@@ -50,7 +51,7 @@ public:
 
 public:
 	// EventClient
-	void UnsyncedHeightMapUpdate(const SRectangle& rect) override {}
+	void UnsyncedHeightMapUpdate(const SRectangle& rect) override;
 	void Update() override;
 
 protected:
@@ -71,18 +72,38 @@ protected:
 	void SetupStateShadow();
 	void ResetStateShadow();
 
-	unsigned int DrawBlock(const float3& camPos, const int2& blockPos, unsigned int turfMatIndex);
+	void GenerateBlock(const int2& blockPos, std::vector<float4>& texels) const;
+	void InvalidateBlock(int blockIdx);
+	void InvalidateBlocks();
+	void UpdateInstances();
 	void DrawBlocks(const CCamera* cam);
 
 protected:
+	// per-block turf instance data, generated when a block enters view
+	// and kept until it is invalidated or evicted (see MAX_CACHED_BLOCKS)
+	struct GrassBlock {
+		std::vector<float4> texels;
+
+		unsigned int lastVisUpdate = 0;
+
+		bool cached = false;
+	};
+
 	int2 blockCount;
 	int2 turfDetail;
 
 	unsigned int grassBladeTex = 0;
 
-	std::vector<int2> grassBlocks;
+	std::vector<GrassBlock> grassBlocks;
 	std::vector<uint8_t> grassMap;
 
+	// indices of all blocks with cached texels
+	std::vector<int> cachedBlocks;
+	std::vector<int> pendingBlocks;
+	std::vector<int2> prvInViewQuads;
+
+	CModelInstanceBuffer turfInstanceBuffer;
+
 	std::array<Shader::IProgramObject*, GRASS_PROGRAM_LAST> grassShaders;
 
 	GL::RenderDataBuffer grassBuffer;
@@ -93,9 +114,14 @@ protected:
 	float3 prvUpdateCamPos;
 	float3 prvUpdateCamDir;
 
+	unsigned int visUpdateCount = 0;
+	unsigned int numInstanceTurfs = 0;
+	unsigned int instanceTexelOffset = 0;
+
 	bool luaDrawGrass = false;
 	bool defDrawGrass = false;
 	bool updateVisibility = false;
+	bool updateInstances = false;
 };
 
 extern CGrassDrawer* grassDrawer;
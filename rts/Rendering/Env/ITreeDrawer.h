@@ -37,6 +37,7 @@ public:
 	virtual void AddTree(int treeID, int treeType, const float3& pos, float size);
 	virtual void DeleteTree(int treeID, int treeType, const float3& pos);
 	virtual void AddFallingTree(int treeID, int treeType, const float3& pos, const float3& dir) {}
+	virtual bool HasFallingTrees() const { return false; }
 
 	bool GetFullRead() const override { return true; }
 	bool WantsEvent(const std::string& eventName) override {
@@ -10,14 +10,18 @@
 #include "Game/GameHelper.h"
 #include "Map/ReadMap.h"
 #include "Map/BaseGroundDrawer.h"
+#include "Game/Camera.h"
 #include "Rendering/FeatureDrawer.h"
 #include "Rendering/UnitDrawer.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
+#include "Rendering/GL/TimerQueries.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Projectiles/ExplosionListener.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Exceptions.h"
 #include "System/SafeUtil.h"
+#include "System/TimeProfiler.h"
 #include "System/Log/ILog.h"
 
 CONFIG(int, Water)
@@ -28,6 +32,10 @@ CONFIG(int, Water)
 .maximumValue(IWater::NUM_WATER_RENDERERS - 1)
 .description("Defines the type of water rendering. Can be set in game. Options are: 0 = No water, 1 = Reflective water, 2 = Reflective and Refractive water, 3 = Dynamic water, 4 = Bumpmapped water");
 
+CONFIG(int, WaterReflectionUpdateRate).defaultValue(1).minimumValue(1).maximumValue(4).description("Re-render the reflection texture of Bumpmapped and Dynamic water only every N-th frame (1 = every frame).");
+CONFIG(int, WaterRefractionUpdateRate).defaultValue(1).minimumValue(1).maximumValue(4).description("Re-render the refraction texture of Dynamic water only every N-th frame (1 = every frame).");
+CONFIG(int, WaterPassMaxObjects).defaultValue(0).minimumValue(0).description("Maximum number of opaque units and features drawn into each water reflection or refraction pass (0 = unlimited).");
+
 
 static std::array<int, 4> waterModes = {{0}};
 
@@ -46,8 +54,17 @@ IWater* water = nullptr;
 
 IWater::IWater(bool wantEvents)
 {
-	if (wantEvents)
-		CExplosionCreator::AddExplosionListener(this);
+	// only the static placeholder renderer does not want events,
+	// it is constructed before the config-handler exists
+	if (!wantEvents)
+		return;
+
+	CExplosionCreator::AddExplosionListener(this);
+
+	reflSchedule.rate = configHandler->GetInt("WaterReflectionUpdateRate");
+	refrSchedule.rate = configHandler->GetInt("WaterRefractionUpdateRate");
+
+	maxPassObjects = configHandler->GetInt("WaterPassMaxObjects");
 }
 
 
@@ -149,11 +166,32 @@ void IWater::ExplosionOccurred(const CExplosionParams& event) {
 }
 
 
+bool IWater::UpdatePassTex(PassSchedule& schedule)
+{
+	const float3& camPos = camera->GetPos();
+	const float3& camDir = camera->GetDir();
+
+	// the stale image can not be reprojected that far, so update now
+	const bool camMoved = (camPos.SqDistance(schedule.camPos) > Square(SQUARE_SIZE * 16.0f) || camDir.dot(schedule.camDir) < 0.995f);
+
+	if (!camMoved && ((++schedule.count) % schedule.rate) != 0)
+		return false;
+
+	schedule.count = 0;
+	schedule.camPos = camPos;
+	schedule.camDir = camDir;
+	return true;
+}
+
+
 void IWater::DrawReflections(bool drawGround, bool drawSky) {
+	SCOPED_TIMER("Draw::World::Water::Reflection");
+	SCOPED_GL_TIMER("Draw::World::Water::Reflection");
 	game->SetDrawMode(Game::ReflectionDraw);
 
 	{
 		drawReflection = true;
+		numPassObjects = 0;
 
 		// opaque; do not clip skydome (is drawn in camera space)
 		if (drawSky)
@@ -186,10 +224,13 @@ void IWater::DrawReflections(bool drawGround, bool drawSky) {
 }
 
 void IWater::DrawRefractions(bool drawGround, bool drawSky) {
+	SCOPED_TIMER("Draw::World::Water::Refraction");
+	SCOPED_GL_TIMER("Draw::World::Water::Refraction");
 	game->SetDrawMode(Game::RefractionDraw);
 
 	{
 		drawRefraction = true;
+		numPassObjects = 0;
 
 		// opaque
 		if (drawSky)
@@ -3,6 +3,7 @@
 #ifndef I_WATER_H
 #define I_WATER_H
 
+#include "System/float3.h"
 #include "System/float4.h"
 #include "Sim/Projectiles/ExplosionListener.h"
 
@@ -36,6 +37,15 @@ public:
 
 	bool DrawReflectionPass() const { return drawReflection; }
 	bool DrawRefractionPass() const { return drawRefraction; }
+
+	// false once a reflection or refraction pass has drawn its budget of opaque models
+	bool CountPassObject() {
+		if (!drawReflection && !drawRefraction)
+			return true;
+
+		return (maxPassObjects == 0 || numPassObjects++ < maxPassObjects);
+	}
+
 	bool BlockWakeProjectiles() const { return (GetID() == WATER_RENDERER_DYNAMIC); }
 	bool& WireFrameModeRef() { return wireFrameMode; }
 
@@ -56,13 +66,38 @@ public:
 	static constexpr float4 ModelRefrClipPlane() { return {0.0f, -1.0f, 0.0f, 0.0f}; }
 
 protected:
+	struct PassSchedule {
+		unsigned int rate = 1;
+		unsigned int count = 0;
+
+		float3 camPos;
+		float3 camDir;
+	};
+
+	/**
+	 * Reflection and refraction textures may be re-rendered at a reduced
+	 * rate, implementations keep sampling (and should reproject) the last
+	 * image in between. Large camera movements always force an update.
+	 */
+	bool UpdateReflectionTex() { return (UpdatePassTex(reflSchedule)); }
+	bool UpdateRefractionTex() { return (UpdatePassTex(refrSchedule)); }
+
 	void DrawReflections(bool drawGround, bool drawSky);
 	void DrawRefractions(bool drawGround, bool drawSky);
 
+private:
+	static bool UpdatePassTex(PassSchedule& schedule);
+
 protected:
 	bool drawReflection = false;
 	bool drawRefraction = false;
 	bool wireFrameMode = false;
+
+	PassSchedule reflSchedule;
+	PassSchedule refrSchedule;
+
+	unsigned int maxPassObjects = 0;
+	unsigned int numPassObjects = 0;
 };
 
 extern IWater* water;
@@ -21,6 +21,7 @@ public:
 	);
 
 	void Update() override;
+	bool HasIsolatedUpdate() const override { return true; }
 	void Draw(GL::RenderDataBufferTC* va) const override;
 
 	int GetProjectilesCount() const override { return 1; }
@@ -15,6 +15,7 @@ public:
 
 	void Draw(GL::RenderDataBufferTC* va) const override;
 	void Update() override;
+	bool HasIsolatedUpdate() const override { return true; }
 
 	int GetProjectilesCount() const override { return (numSmoke * 2); }
 
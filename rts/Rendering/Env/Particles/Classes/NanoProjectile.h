@@ -16,6 +16,7 @@ public:
 	~CNanoProjectile();
 
 	void Update() override;
+	bool HasIsolatedUpdate() const override { return true; }
 	void Draw(GL::RenderDataBufferTC* va) const override;
 	void DrawOnMinimap(GL::RenderDataBufferC* va) override;
 
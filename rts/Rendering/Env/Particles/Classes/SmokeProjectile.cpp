@@ -8,8 +8,12 @@
 #include "Map/Ground.h"
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
+#include "Rendering/Env/Particles/GPUParticleDrawer.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
 #include "Rendering/Textures/TextureAtlas.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/TeamHandler.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/Projectiles/ExpGenSpawnableMemberInfo.h"
 
@@ -79,6 +83,44 @@ void CSmokeProjectile::Init(const CUnit* owner, const float3& offset)
 	CProjectile::Init(owner, offset);
 }
 
+bool CSmokeProjectile::InitGPU(const CUnit* owner, const float3& offset)
+{
+	if (projectileDrawer == nullptr)
+		return false;
+
+	CGPUParticleDrawer& gpuParticleDrawer = projectileDrawer->GetGPUParticleDrawer();
+
+	if (!gpuParticleDrawer.IsEnabled())
+		return false;
+
+	textureNum = (int) (guRNG.NextInt(projectileDrawer->NumSmokeTextures()));
+
+	useAirLos |= (offset.y - CGround::GetApproximateHeight(offset.x, offset.z, false) > 10.0f);
+	alwaysVisible |= (owner == nullptr);
+
+	pos += offset;
+
+	// LOS can only be tested here, particles spawned out of sight stay CPU-side
+	// (pos is restored s.t. a subsequent Init still receives the original state)
+	const bool allied = (owner != nullptr && teamHandler.Ally(owner->allyteam, gu->myAllyTeam));
+	const bool inLos = (gu->spectatingFullView || allied || losHandler->InLos(this, gu->myAllyTeam));
+
+	pos -= offset;
+
+	if (!inLos)
+		return false;
+
+	const AtlasedTexture* st = projectileDrawer->GetSmokeTexture(textureNum);
+	const float3 spawnPos = pos + offset;
+
+	return (gpuParticleDrawer.AddSmokeParticle({
+		{spawnPos, float(gs->frameNum)},
+		{speed.x, speed.y, speed.z, ageSpeed},
+		{startSize, sizeExpansion, color, size},
+		{st->xstart, st->ystart, st->xend, st->yend},
+	}));
+}
+
 void CSmokeProjectile::Update()
 {
 	pos += speed;
@@ -25,8 +25,10 @@ public:
 	);
 
 	void Update() override;
+	bool HasIsolatedUpdate() const override { return true; }
 	void Draw(GL::RenderDataBufferTC* va) const override;
 	void Init(const CUnit* owner, const float3& offset) override;
+	bool InitGPU(const CUnit* owner, const float3& offset) override;
 
 	int GetProjectilesCount() const override { return 1; }
 
@@ -26,6 +26,7 @@ public:
 	);
 
 	void Update() override;
+	bool HasIsolatedUpdate() const override { return true; }
 	void Draw(GL::RenderDataBufferTC* va) const override;
 	void Init(const CUnit* owner, const float3& offset) override;
 
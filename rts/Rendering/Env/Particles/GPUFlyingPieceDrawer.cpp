@@ -0,0 +1,349 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstring>
+
+#include "GPUFlyingPieceDrawer.h"
+#include "Game/GlobalUnsynced.h"
+#include "Map/Ground.h"
+#include "Map/MapInfo.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/UnitDrawer.h"
+#include "Rendering/GL/myGL.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/SpringMath.h"
+
+CONFIG(int, MaxGPUFlyingPieceParts).defaultValue(16384).minimumValue(0).maximumValue(1 << 16).headlessValue(0).description("Maximum number of shattered unit-piece parts whose motion is evaluated by the GPU; 0 disables the GPU path and falls back to CPU-updated flying pieces.");
+
+static_assert(sizeof(CMatrix44f) == (sizeof(float4) * 4), "");
+
+// see FlyingPiece
+static constexpr float EXPLOSION_SPEED = 2.0f;
+// ground-tests of a part's precomputed trajectory are spaced this many frames apart
+static constexpr int EXPIRE_TEST_STEP = 4;
+
+
+static float2 GetDragFactors(float age)
+{
+	// identical to FlyingPiece::GetDragFactors, .x := speed drag, .y := gravity drag
+	constexpr float airDrag = 0.995f;
+	constexpr float invAirDrag = 1.0f / (1.0f - airDrag);
+
+	const float airDragPowOne = std::pow(airDrag, age + 1.0f);
+	const float airDragPowTwo = airDragPowOne * airDrag;
+
+	float2 dragFactors;
+	dragFactors.x = (1.0f - airDragPowOne) * invAirDrag;
+	dragFactors.y = age * dragFactors.x - (age * (airDragPowTwo - airDragPowOne) - airDragPowOne + airDrag) * invAirDrag * invAirDrag;
+	return dragFactors;
+}
+
+
+void CGPUFlyingPieceDrawer::Init()
+{
+	GLint maxNumTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxNumTexels);
+
+	capacity = std::min(unsigned(configHandler->GetInt("MaxGPUFlyingPieceParts")), unsigned(std::max(maxNumTexels, 0)) / RECORD_SIZE);
+	writeIndex = 0;
+	pendingIndex = 0;
+	numSerials = 0;
+
+	if (capacity == 0)
+		return;
+
+	slotSerials.clear();
+	slotSerials.resize(capacity, 0);
+
+	recordBuffer = VBO(GL_TEXTURE_BUFFER);
+	recordBuffer.Bind();
+	recordBuffer.New(capacity * RECORD_SIZE * sizeof(float4), GL_DYNAMIC_DRAW);
+	recordBuffer.Unbind();
+
+	slotBuffer = VBO(GL_ARRAY_BUFFER);
+
+	glGenTextures(1, &textureID);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, textureID);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, recordBuffer.GetId());
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, 0);
+
+	partArray.Generate();
+}
+
+void CGPUFlyingPieceDrawer::Kill()
+{
+	if (textureID != 0)
+		glDeleteTextures(1, &textureID);
+
+	textureID = 0;
+
+	partArray.Delete();
+	recordBuffer.Release();
+	slotBuffer.Release();
+
+	for (std::vector<Group>& modelGroups: groups) {
+		modelGroups.clear();
+	}
+
+	groupIndices.clear();
+	pendingRecords.clear();
+	slotSerials.clear();
+	drawSlots.clear();
+	drawOffsets.clear();
+
+	capacity = 0;
+	writeIndex = 0;
+	pendingIndex = 0;
+	numSerials = 0;
+}
+
+
+int CGPUFlyingPieceDrawer::CalcExpireFrame(const CMatrix44f& pieceMatrix, const float3& speed, float pieceRadius) const
+{
+	// FlyingPiece tests its parts against the ground every frame; since the
+	// trajectory only depends on the age it can be walked once at spawn-time
+	const float3 pos = pieceMatrix.GetPos();
+	const float gravity = mapInfo->map.gravity;
+
+	int age = EXPIRE_TEST_STEP;
+
+	for (; age < (GAME_SPEED * 60); age += EXPIRE_TEST_STEP) {
+		const float2 dragFactors = GetDragFactors(age);
+		const float3 p = pos + speed * dragFactors.x + UpVector * (gravity * dragFactors.y);
+
+		if ((p.y + pieceRadius * 2.0f) < CGround::GetApproximateHeight(p.x, p.z, false))
+			break;
+	}
+
+	return (gs->frameNum + age);
+}
+
+
+bool CGPUFlyingPieceDrawer::AddFlyingPiece(
+	const S3DModel* model,
+	const S3DModelPiece* piece,
+	const CMatrix44f& pieceMatrix,
+	const float3 speed,
+	const float2 pieceParams, // (.x=radius, .y=chance)
+	const int2 renderParams // (.x=texType, .y=team)
+) {
+	if (capacity == 0)
+		return false;
+	if (!unitDrawer->GetDrawerState(DRAWER_STATE_SEL)->CanDrawInstanced())
+		return false;
+
+	const S3DModelPiecePart& shatterPiecePart = piece->shatterParts[guRNG.NextInt(piece->shatterParts.size())];
+	const float4 teamColor = IUnitDrawerState::GetTeamColor(renderParams.y, 1.0f);
+
+	for (const S3DModelPiecePart::RenderData& cp: shatterPiecePart.renderData) {
+		// same selection and randomization as FlyingPiece
+		if (guRNG.NextFloat() > pieceParams.x)
+			continue;
+
+		const float3 rndVec = guRNG.NextVector() * 0.3f;
+		const float3 flyDir = (cp.dir + rndVec).ANormalize();
+		const float3 partSpeed = speed + flyDir * mix<float>(1.0f, EXPLOSION_SPEED, guRNG.NextFloat());
+		const float4 partRotation = float4(guRNG.NextVector().ANormalize(), guRNG.NextFloat() * 0.1f);
+
+		const auto key = std::make_pair(piece, cp.vboOffset);
+		const auto iter = groupIndices.find(key);
+
+		std::vector<Group>& modelGroups = groups[model->type];
+
+		if (iter == groupIndices.end()) {
+			groupIndices[key] = modelGroups.size();
+			modelGroups.push_back({model, piece, cp.vboOffset, cp.indexCount, {}});
+		}
+
+		Group& group = modelGroups[groupIndices[key]];
+		Part part;
+
+		part.spawnPos = pieceMatrix.GetPos();
+		part.team = renderParams.y;
+		part.expireFrame = CalcExpireFrame(pieceMatrix, partSpeed, pieceParams.x);
+		part.slot = writeIndex;
+		part.serial = ++numSerials;
+
+		group.parts.push_back(part);
+
+		if (pendingRecords.empty())
+			pendingIndex = writeIndex;
+
+		// the oldest part loses its slot once the ring is full
+		slotSerials[writeIndex] = part.serial;
+		writeIndex = (writeIndex + 1) % capacity;
+
+		pendingRecords.resize(pendingRecords.size() + RECORD_SIZE);
+
+		float4* record = &pendingRecords[pendingRecords.size() - RECORD_SIZE];
+
+		for (size_t i = 0; i < 4; i++) {
+			record[i] = pieceMatrix.col[i];
+		}
+
+		record[4] = {partSpeed.x, partSpeed.y, partSpeed.z, float(gs->frameNum)};
+		record[5] = partRotation;
+		record[6] = teamColor;
+	}
+
+	return true;
+}
+
+
+void CGPUFlyingPieceDrawer::UploadRecords()
+{
+	if (pendingRecords.empty())
+		return;
+
+	// records that were already overwritten within this batch are skipped
+	const unsigned int numPending = pendingRecords.size() / RECORD_SIZE;
+	const unsigned int numUpload = std::min(numPending, capacity);
+	const float4* records = &pendingRecords[(numPending - numUpload) * RECORD_SIZE];
+
+	unsigned int slot = (pendingIndex + (numPending - numUpload)) % capacity;
+
+	recordBuffer.Bind();
+
+	for (unsigned int i = 0, n = 0; i < numUpload; i += n) {
+		n = std::min(numUpload - i, capacity - slot);
+
+		GLubyte* dst = recordBuffer.MapBuffer(slot * RECORD_SIZE * sizeof(float4), n * RECORD_SIZE * sizeof(float4), GL_WRITE_ONLY);
+
+		if (dst != nullptr)
+			std::memcpy(dst, records + i * RECORD_SIZE, n * RECORD_SIZE * sizeof(float4));
+
+		recordBuffer.UnmapBuffer();
+
+		slot = (slot + n) % capacity;
+	}
+
+	recordBuffer.Unbind();
+	pendingRecords.clear();
+}
+
+
+void CGPUFlyingPieceDrawer::Draw(int modelType)
+{
+	if (capacity == 0)
+		return;
+
+	UploadRecords();
+
+	std::vector<Group>& modelGroups = groups[modelType];
+
+	if (modelGroups.empty())
+		return;
+
+	const IUnitDrawerState* udState = unitDrawer->GetDrawerState(DRAWER_STATE_SEL);
+
+	if (!udState->CanDrawInstanced())
+		return;
+
+	drawSlots.clear();
+	drawOffsets.clear();
+	drawOffsets.reserve(modelGroups.size() + 1);
+
+	for (Group& group: modelGroups) {
+		std::vector<Part>& parts = group.parts;
+
+		drawOffsets.push_back(drawSlots.size());
+
+		for (size_t i = 0; i < parts.size(); ) {
+			const Part& part = parts[i];
+
+			if (gs->frameNum >= part.expireFrame || slotSerials[part.slot] != part.serial) {
+				parts[i] = parts.back();
+				parts.pop_back();
+				continue;
+			}
+
+			i++;
+
+			const bool noLosTst = gu->spectatingFullView || teamHandler.AlliedTeams(gu->myTeam, part.team);
+			const bool inAirLos = noLosTst || losHandler->InAirLos(part.spawnPos, gu->myAllyTeam);
+
+			if (!inAirLos)
+				continue;
+
+			drawSlots.push_back(part.slot);
+		}
+	}
+
+	drawOffsets.push_back(drawSlots.size());
+
+	if (drawSlots.empty())
+		return;
+
+	glAttribStatePtr->PushPolygonBit();
+	glAttribStatePtr->DisableCullFace();
+
+	slotBuffer.Bind();
+	glBufferData(GL_ARRAY_BUFFER, drawSlots.size() * sizeof(unsigned int), drawSlots.data(), GL_STREAM_DRAW);
+	slotBuffer.Unbind();
+
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, textureID);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+
+	udState->SetFlyingPieceParams(true, gs->frameNum + globalRendering->timeOffset, mapInfo->map.gravity);
+
+	partArray.Bind();
+
+	const S3DModel* boundModel = nullptr;
+	int boundTexture = -1;
+
+	for (size_t n = 0; n < modelGroups.size(); n++) {
+		const Group& group = modelGroups[n];
+
+		const size_t slotsBeg = drawOffsets[n    ];
+		const size_t slotsEnd = drawOffsets[n + 1];
+
+		if (slotsBeg == slotsEnd)
+			continue;
+
+		if (group.model != boundModel) {
+			const int texture = group.model->textureType;
+
+			if (texture != boundTexture && texture != -1)
+				CUnitDrawer::BindModelTypeTexture(MODELTYPE_S3O, boundTexture = texture);
+
+			// the part transforms are applied on top of the bind-pose
+			udState->SetMatrices(CMatrix44f::Identity(), group.model->GetPieceMatrices());
+
+			group.model->BindElemsBuffer();
+			group.model->EnableAttribs();
+
+			boundModel = group.model;
+		}
+
+		slotBuffer.Bind();
+		glEnableVertexAttribArray(7);
+		glVertexAttribIPointer(7, 1, GL_UNSIGNED_INT, sizeof(unsigned int), slotBuffer.GetPtr(slotsBeg * sizeof(unsigned int)));
+		glVertexAttribDivisor(7, 1);
+		slotBuffer.Unbind();
+
+		group.piece->BindShatterIndexBuffer();
+		glDrawElementsInstanced(GL_TRIANGLES, group.indexCount, GL_UNSIGNED_INT, group.piece->GetShatterIndexBuffer().GetPtr(group.vboOffset), slotsEnd - slotsBeg);
+		group.piece->UnbindShatterIndexBuffer();
+	}
+
+	glVertexAttribDivisor(7, 0);
+	glDisableVertexAttribArray(7);
+
+	boundModel->UnbindElemsBuffer();
+	boundModel->DisableAttribs();
+
+	partArray.Unbind();
+
+	udState->SetFlyingPieceParams(false, 0.0f, 0.0f);
+
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, 0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+
+	glAttribStatePtr->PopBits();
+}
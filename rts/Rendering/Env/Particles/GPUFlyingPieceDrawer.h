@@ -0,0 +1,103 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GPU_FLYING_PIECE_DRAWER_H
+#define GPU_FLYING_PIECE_DRAWER_H
+
+#include <array>
+#include <map>
+#include <vector>
+
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
+#include "Rendering/Models/3DModel.h"
+#include "System/float4.h"
+#include "System/type2.h"
+
+/**
+ * Draws the shattered parts of dying units without a CPU-side FlyingPiece.
+ * Each part's initial transform, velocity and spin are written once into a
+ * persistent RGBA32F texture-buffer (a ring, overwriting the oldest parts
+ * when full); the model vertex shaders evaluate FlyingPiece's closed-form
+ * ballistic motion for the current sim-frame. Parts sharing geometry (the
+ * same shatter-part of the same piece) are kept in persistent groups and
+ * drawn with one instanced call per group, so nothing is updated or sorted
+ * per frame besides gathering the slot indices of the live parts.
+ */
+class CGPUFlyingPieceDrawer {
+public:
+	static constexpr unsigned int TEXTURE_UNIT = 8;
+	// texels per part: {pieceMatrix, speed + spawn-frame, rotation axis + speed, teamColor}
+	static constexpr unsigned int RECORD_SIZE = 7;
+
+	void Init();
+	void Kill();
+
+	// returns false if the path is disabled, the caller should spawn a FlyingPiece instead
+	bool AddFlyingPiece(
+		const S3DModel* model,
+		const S3DModelPiece* piece,
+		const CMatrix44f& pieceMatrix,
+		const float3 speed,
+		const float2 pieceParams,
+		const int2 renderParams
+	);
+
+	// expects the model shader (or the projectile shadow-gen shader) to be bound
+	void Draw(int modelType);
+
+	bool IsEnabled() const { return (capacity > 0); }
+
+private:
+	struct Part {
+		float3 spawnPos;
+
+		int team;
+		int expireFrame;
+
+		unsigned int slot;
+		unsigned int serial;
+	};
+
+	// parts drawn from the same range of a piece's shatter-indices
+	struct Group {
+		const S3DModel* model;
+		const S3DModelPiece* piece;
+
+		size_t vboOffset;
+		size_t indexCount;
+
+		std::vector<Part> parts;
+	};
+
+	void UploadRecords();
+	int CalcExpireFrame(const CMatrix44f& pieceMatrix, const float3& speed, float pieceRadius) const;
+
+private:
+	VBO recordBuffer;
+	VBO slotBuffer;
+	VAO partArray;
+
+	unsigned int textureID = 0;
+
+	std::array<std::vector<Group>, MODELTYPE_OTHER> groups;
+	std::map<std::pair<const S3DModelPiece*, size_t>, size_t> groupIndices;
+
+	std::vector<float4> pendingRecords;
+	// serial of the part currently owning each ring-buffer slot
+	std::vector<unsigned int> slotSerials;
+	// per-draw gathered slot indices, consumed as an instanced attribute
+	std::vector<unsigned int> drawSlots;
+	// start of each group's range within drawSlots, plus the end of the last
+	std::vector<size_t> drawOffsets;
+
+	// maximum number of live parts, 0 if disabled
+	unsigned int capacity = 0;
+	// slot the next added part is assigned
+	unsigned int writeIndex = 0;
+	// slot of the first part in pendingRecords
+	unsigned int pendingIndex = 0;
+
+	unsigned int numSerials = 0;
+};
+
+#endif
@@ -0,0 +1,155 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstring>
+
+#include "GPUParticleDrawer.h"
+#include "Game/Camera.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/myGL.h"
+#include "Rendering/GL/VertexArrayTypes.h"
+#include "Rendering/Shaders/ShaderHandler.h"
+#include "Rendering/Shaders/Shader.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/Wind.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+
+CONFIG(int, MaxGPUParticles).defaultValue(0).minimumValue(0).maximumValue(1 << 20).headlessValue(0).description("Maximum number of CEG smoke particles simulated and drawn by the GPU instead of as CPU projectiles; 0 disables the GPU particle backend.");
+
+static_assert(sizeof(CGPUParticleDrawer::SmokeParticle) == (sizeof(float4) * 4), "");
+
+
+void CGPUParticleDrawer::Init()
+{
+	capacity = configHandler->GetInt("MaxGPUParticles");
+	writeIndex = 0;
+	numParticles = 0;
+
+	pendingParticles.clear();
+
+	if (capacity == 0)
+		return;
+
+	#define sh shaderHandler
+	smokeShader = sh->CreateProgramObject("[GPUParticleDrawer]", "GPUSmokeParticleShader");
+	smokeShader->AttachShaderObject(sh->CreateShaderObject("GLSL/GPUSmokeParticleVertProg.glsl", "", GL_VERTEX_SHADER));
+	smokeShader->AttachShaderObject(sh->CreateShaderObject("GLSL/GPUSmokeParticleFragProg.glsl", "", GL_FRAGMENT_SHADER));
+	smokeShader->Link();
+	smokeShader->Enable();
+	smokeShader->SetUniform("atlasTex", 0);
+	smokeShader->Disable();
+	smokeShader->Validate();
+	#undef sh
+
+	if (!smokeShader->IsValid()) {
+		LOG_L(L_WARNING, "[GPUParticleDrawer::%s] failed to compile smoke-particle shader, backend disabled", __func__);
+		Kill();
+		return;
+	}
+
+	particleBuffer = VBO(GL_ARRAY_BUFFER);
+	particleBuffer.Bind();
+	particleBuffer.New(capacity * sizeof(SmokeParticle), GL_DYNAMIC_DRAW);
+
+	particleArray.Generate();
+	particleArray.Bind();
+
+	// one record per instance, the six quad corners are derived from gl_VertexID
+	for (unsigned int i = 0; i < 4; i++) {
+		glEnableVertexAttribArray(i);
+		glVertexAttribPointer(i, 4, GL_FLOAT, false, sizeof(SmokeParticle), VA_TYPE_OFFSET(float4, i));
+		glVertexAttribDivisor(i, 1);
+	}
+
+	particleArray.Unbind();
+	particleBuffer.Unbind();
+}
+
+void CGPUParticleDrawer::Kill()
+{
+	if (smokeShader != nullptr)
+		shaderHandler->ReleaseProgramObjects("[GPUParticleDrawer]");
+
+	smokeShader = nullptr;
+
+	particleArray.Delete();
+	particleBuffer.Release();
+
+	pendingParticles.clear();
+
+	capacity = 0;
+	writeIndex = 0;
+	numParticles = 0;
+}
+
+
+bool CGPUParticleDrawer::AddSmokeParticle(const SmokeParticle& p)
+{
+	if (capacity == 0)
+		return false;
+
+	pendingParticles.push_back(p);
+	return true;
+}
+
+void CGPUParticleDrawer::UploadParticles()
+{
+	if (pendingParticles.empty())
+		return;
+
+	// the oldest pending particles would be overwritten within this upload anyway
+	const unsigned int numPending = std::min(pendingParticles.size(), size_t(capacity));
+	const SmokeParticle* pending = &pendingParticles[pendingParticles.size() - numPending];
+
+	particleBuffer.Bind();
+
+	for (unsigned int i = 0, n = 0; i < numPending; i += n) {
+		n = std::min(numPending - i, capacity - writeIndex);
+
+		GLubyte* dst = particleBuffer.MapBuffer(writeIndex * sizeof(SmokeParticle), n * sizeof(SmokeParticle), GL_WRITE_ONLY);
+
+		if (dst != nullptr)
+			std::memcpy(dst, pending + i, n * sizeof(SmokeParticle));
+
+		particleBuffer.UnmapBuffer();
+
+		writeIndex = (writeIndex + n) % capacity;
+	}
+
+	particleBuffer.Unbind();
+
+	numParticles = std::min(numParticles + numPending, capacity);
+	pendingParticles.clear();
+}
+
+
+void CGPUParticleDrawer::Draw(const CCamera* cam)
+{
+	if (capacity == 0)
+		return;
+
+	UploadParticles();
+
+	if (numParticles == 0)
+		return;
+
+	const float3& camRight = cam->GetRight();
+	const float3& camUp = cam->GetUp();
+	const float3& windVec = envResHandler.GetCurrentWindVec();
+
+	// the atlas texture is expected to be bound by CProjectileDrawer
+	smokeShader->Enable();
+	smokeShader->SetUniformMatrix4x4<float>("viewMat", false, cam->GetViewMatrix());
+	smokeShader->SetUniformMatrix4x4<float>("projMat", false, cam->GetProjectionMatrix());
+	smokeShader->SetUniform("camRight", camRight.x, camRight.y, camRight.z);
+	smokeShader->SetUniform("camUp", camUp.x, camUp.y, camUp.z);
+	smokeShader->SetUniform("windVec", windVec.x, windVec.y, windVec.z);
+	smokeShader->SetUniform("simFrame", gs->frameNum + globalRendering->timeOffset);
+
+	particleArray.Bind();
+	glDrawArraysInstanced(GL_TRIANGLES, 0, 6, numParticles);
+	particleArray.Unbind();
+
+	smokeShader->Disable();
+}
@@ -0,0 +1,64 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GPU_PARTICLE_DRAWER_H
+#define GPU_PARTICLE_DRAWER_H
+
+#include <vector>
+
+#include "Rendering/GL/VAO.h"
+#include "Rendering/GL/VBO.h"
+#include "System/float4.h"
+
+class CCamera;
+
+namespace Shader {
+	struct IProgramObject;
+};
+
+/**
+ * Draws purely visual smoke particles spawned by CEG's without creating
+ * a CProjectile for them. Only their spawn parameters are uploaded (into
+ * a ring-buffer, overwriting the oldest particles when full); the vertex
+ * shader evaluates CSmokeProjectile::Update in closed form for the age
+ * of each instance, so live particles cost no CPU time after spawning.
+ */
+class CGPUParticleDrawer {
+public:
+	struct SmokeParticle {
+		float4 posFrame;   // .xyz := spawn position, .w := spawn frame
+		float4 speedAge;   // .xyz := speed, .w := age increment per frame
+		float4 sizeParams; // .x := start size, .y := size expansion, .z := color, .w := initial size
+		float4 texCoords;  // atlas sub-rectangle {xstart, ystart, xend, yend}
+	};
+
+	void Init();
+	void Kill();
+
+	// returns false if the backend is disabled, the caller should spawn a CPU particle instead
+	bool AddSmokeParticle(const SmokeParticle& p);
+
+	void Draw(const CCamera* cam);
+
+	bool IsEnabled() const { return (capacity > 0); }
+	bool HasParticles() const { return (numParticles > 0 || !pendingParticles.empty()); }
+
+private:
+	void UploadParticles();
+
+private:
+	Shader::IProgramObject* smokeShader = nullptr;
+
+	VBO particleBuffer;
+	VAO particleArray;
+
+	std::vector<SmokeParticle> pendingParticles;
+
+	// maximum number of live particles, 0 if disabled
+	unsigned int capacity = 0;
+	// ring-buffer slot the next uploaded particle is written to
+	unsigned int writeIndex = 0;
+	// number of ring-buffer slots that hold a particle (dead or alive)
+	unsigned int numParticles = 0;
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "Rendering/Textures/TextureAtlas.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/DrawSnapshot.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
@@ -231,7 +232,7 @@ void CProjectileDrawer::Init() {
 	{
 		glGenTextures(8, perlinData.blendTextures);
 		for (const GLuint blendTexture: perlinData.blendTextures) {
-			glBindTexture(GL_TEXTURE_2D, blendTexture);
+			glAttribStatePtr->BindTexture(GL_TEXTURE_2D, blendTexture);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
 			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, PerlinData::blendTexSize, PerlinData::blendTexSize, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
@@ -262,6 +263,9 @@ void CProjectileDrawer::Init() {
 	}
 
 	LoadWeaponTextures();
+
+	gpuParticleDrawer.Init();
+	gpuFlyingPieceDrawer.Init();
 }
 
 void CProjectileDrawer::Kill() {
@@ -284,6 +288,8 @@ void CProjectileDrawer::Kill() {
 
 	perlinNoiseFBO.Kill();
 	flyingPieceVAO.Delete();
+	gpuParticleDrawer.Kill();
+	gpuFlyingPieceDrawer.Kill();
 
 	perlinData.texObjects = 0;
 	perlinData.fboComplete = false;
@@ -441,8 +447,15 @@ void CProjectileDrawer::DrawProjectiles(int modelType, bool drawReflection, bool
 
 void CProjectileDrawer::DrawProjectilesSet(const std::vector<CProjectile*>& projectiles, bool drawReflection, bool drawRefraction)
 {
+	projectileCuller.Clear();
+	projectileCuller.AddObjects(projectiles);
+	projectileCuller.Cull([&](CProjectile* p) { return (CullProjectile(p, drawReflection, drawRefraction)); });
+
 	for (CProjectile* p: projectiles) {
-		DrawProjectileNow(p, drawReflection, drawRefraction);
+		if (projectileCuller.NextResult() == ProjectileCuller::CULL_RESULT_HIDDEN)
+			continue;
+
+		DrawProjectileNow(p);
 	}
 }
 
@@ -453,26 +466,38 @@ bool CProjectileDrawer::CanDrawProjectile(const CProjectile* pro, const CSolidOb
 	return (gu->spectatingFullView || (owner != nullptr && th.Ally(owner->allyteam, gu->myAllyTeam)) || lh->InLos(pro, gu->myAllyTeam));
 }
 
-void CProjectileDrawer::DrawProjectileNow(CProjectile* pro, bool drawReflection, bool drawRefraction)
+uint8_t CProjectileDrawer::CullProjectile(CProjectile* pro, bool drawReflection, bool drawRefraction)
 {
-	pro->drawPos = pro->GetDrawPos(globalRendering->timeOffset);
+	const CDrawSnapshot::ProjectileState* state = drawSnapshot.GetState(pro);
+
+	if (state != nullptr) {
+		pro->drawPos = state->GetDrawPos(globalRendering->timeOffset);
+	} else {
+		// not published yet, e.g. spawned by unsynced code since the last sim-frame
+		pro->drawPos = pro->GetDrawPos(globalRendering->timeOffset);
+	}
 
 	if (!CanDrawProjectile(pro, pro->owner()))
-		return;
+		return ProjectileCuller::CULL_RESULT_HIDDEN;
 
 
 	if (drawRefraction && (pro->drawPos.y > pro->GetDrawRadius()) /*!pro->IsInWater()*/)
-		return;
+		return ProjectileCuller::CULL_RESULT_HIDDEN;
 	if (drawReflection && !CUnitDrawer::ObjectVisibleReflection(pro->drawPos, camera->GetPos(), pro->GetDrawRadius()))
-		return;
+		return ProjectileCuller::CULL_RESULT_HIDDEN;
 
 	if (!camera->InView(pro->drawPos, pro->GetDrawRadius()))
-		return;
+		return ProjectileCuller::CULL_RESULT_HIDDEN;
 
+	pro->SetSortDist(camera->ProjectedDistance(pro->pos));
+	return ProjectileCuller::CULL_RESULT_INVIEW;
+}
+
+void CProjectileDrawer::DrawProjectileNow(CProjectile* pro)
+{
 	// no-op if no model
 	DrawProjectileModel(pro);
 
-	pro->SetSortDist(camera->ProjectedDistance(pro->pos));
 	sortedProjectiles[drawSorted && pro->drawSorted].push_back(pro);
 }
 
@@ -492,18 +517,31 @@ void CProjectileDrawer::DrawProjectilesShadow(int modelType)
 
 void CProjectileDrawer::DrawProjectilesSetShadow(const std::vector<CProjectile*>& projectiles)
 {
+	projectileCuller.Clear();
+	projectileCuller.AddObjects(projectiles);
+	projectileCuller.Cull([&](const CProjectile* p) { return (CullProjectileShadow(p)); });
+
 	for (const CProjectile* p: projectiles) {
+		if (projectileCuller.NextResult() == ProjectileCuller::CULL_RESULT_HIDDEN)
+			continue;
+
 		DrawProjectileShadow(p);
 	}
 }
 
-void CProjectileDrawer::DrawProjectileShadow(const CProjectile* p)
+uint8_t CProjectileDrawer::CullProjectileShadow(const CProjectile* p)
 {
 	if (!CanDrawProjectile(p, p->owner()))
-		return;
+		return ProjectileCuller::CULL_RESULT_HIDDEN;
 
 	if (!camera->InView(p->drawPos, p->GetDrawRadius()))
-		return;
+		return ProjectileCuller::CULL_RESULT_HIDDEN;
+
+	return ProjectileCuller::CULL_RESULT_INVIEW;
+}
+
+void CProjectileDrawer::DrawProjectileShadow(const CProjectile* p)
+{
 
 	// if this returns false, then projectile is
 	// neither weapon nor piece, or has no model
@@ -558,6 +596,8 @@ void CProjectileDrawer::DrawFlyingPieces(int modelType)
 {
 	const FlyingPieceContainer& container = projectileHandler.flyingPieces[modelType];
 
+	gpuFlyingPieceDrawer.Draw(modelType);
+
 	if (container.empty())
 		return;
 
@@ -623,25 +663,30 @@ void CProjectileDrawer::DrawProjectilePass(Shader::IProgramObject*, bool drawRef
 
 void CProjectileDrawer::DrawParticlePass(Shader::IProgramObject* po, bool, bool)
 {
-	if (fxBuffer->NumElems() > 0) {
+	if (fxBuffer->NumElems() > 0 || gpuParticleDrawer.HasParticles()) {
 		glAttribStatePtr->BlendFunc(GL_ONE, GL_ONE_MINUS_SRC_ALPHA);
 		glAttribStatePtr->DisableDepthMask();
 
-		glActiveTexture(GL_TEXTURE0);
+		glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
 		// send event after the default state has been set, allows overriding
 		// it for specific cases such as proper blending with depth-aware fog
 		// (requires mask=true and func=always)
 		eventHandler.DrawWorldPreParticles();
 
-
-		po->Enable();
-		po->SetUniformMatrix4x4<float>("u_movi_mat", false, camera->GetViewMatrix());
-		po->SetUniformMatrix4x4<float>("u_proj_mat", false, camera->GetProjectionMatrix());
-		po->SetUniform("u_alpha_test_ctrl", 0.0f, 1.0f, 0.0f, 0.0f); // test > 0.0
 		textureAtlas->BindTexture();
-		fxBuffer->Submit(GL_TRIANGLES);
-		po->SetUniform("u_alpha_test_ctrl", 0.0f, 0.0f, 0.0f, 1.0f); // no test
-		po->Disable();
+
+		if (fxBuffer->NumElems() > 0) {
+			po->Enable();
+			po->SetUniformMatrix4x4<float>("u_movi_mat", false, camera->GetViewMatrix());
+			po->SetUniformMatrix4x4<float>("u_proj_mat", false, camera->GetProjectionMatrix());
+			po->SetUniform("u_alpha_test_ctrl", 0.0f, 1.0f, 0.0f, 0.0f); // test > 0.0
+			fxBuffer->Submit(GL_TRIANGLES);
+			po->SetUniform("u_alpha_test_ctrl", 0.0f, 0.0f, 0.0f, 1.0f); // no test
+			po->Disable();
+		}
+
+		// unsorted, like the CPU particles
+		gpuParticleDrawer.Draw(camera);
 	} else {
 		eventHandler.DrawWorldPreParticles();
 	}
@@ -784,7 +829,7 @@ void CProjectileDrawer::DrawGroundFlashes()
 	glAttribStatePtr->PolygonOffset(-20.0f, -1000.0f);
 	glAttribStatePtr->PolygonOffsetFill(GL_TRUE);
 
-	glActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
 	groundFXAtlas->BindTexture();
 
 	gfBuffer = GL::GetRenderBufferTC();
@@ -883,7 +928,7 @@ void CProjectileDrawer::UpdatePerlin() {
 		std::fill(std::begin(col), std::end(col), int((1.0f - perlinData.blendWeights[a]) * 16 * size));
 
 		{
-			glBindTexture(GL_TEXTURE_2D, perlinData.blendTextures[a * 2 + 0]);
+			glAttribStatePtr->BindTexture(GL_TEXTURE_2D, perlinData.blendTextures[a * 2 + 0]);
 			buffer->SafeAppend({ZeroVector,     0,     0, col});
 			buffer->SafeAppend({  UpVector,     0, tsize, col});
 			buffer->SafeAppend({  XYVector, tsize, tsize, col});
@@ -900,7 +945,7 @@ void CProjectileDrawer::UpdatePerlin() {
 		std::fill(std::begin(col), std::end(col), int(perlinData.blendWeights[a] * 16 * size));
 
 		{
-			glBindTexture(GL_TEXTURE_2D, perlinData.blendTextures[a * 2 + 1]);
+			glAttribStatePtr->BindTexture(GL_TEXTURE_2D, perlinData.blendTextures[a * 2 + 1]);
 			buffer->SafeAppend({ZeroVector,     0,     0, col});
 			buffer->SafeAppend({  UpVector,     0, tsize, col});
 			buffer->SafeAppend({  XYVector, tsize, tsize, col});
@@ -939,7 +984,7 @@ void CProjectileDrawer::GenerateNoiseTex(unsigned int tex)
 		mem[a * 4 + 3] = rnd;
 	}
 
-	glBindTexture(GL_TEXTURE_2D, tex);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, tex);
 	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, PerlinData::blendTexSize, PerlinData::blendTexSize, GL_RGBA, GL_UNSIGNED_BYTE, &mem[0]);
 }
 
@@ -956,6 +1001,17 @@ void CProjectileDrawer::RenderProjectileCreated(const CProjectile* p)
 	renderProjectiles.push_back(const_cast<CProjectile*>(p));
 }
 
+void CProjectileDrawer::RenderProjectilesCreated(const CProjectile* const* projectiles, size_t count)
+{
+	// keep the geometric growth an exact-size reserve per batch would defeat
+	if (renderProjectiles.capacity() < (renderProjectiles.size() + count))
+		renderProjectiles.reserve(std::max(renderProjectiles.size() + count, renderProjectiles.capacity() * 2));
+
+	for (size_t i = 0; i < count; i++) {
+		CProjectileDrawer::RenderProjectileCreated(projectiles[i]);
+	}
+}
+
 void CProjectileDrawer::RenderProjectileDestroyed(const CProjectile* p)
 {
 	if (p->model != nullptr) {
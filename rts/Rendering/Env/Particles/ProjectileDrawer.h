@@ -9,8 +9,11 @@
 #include "Rendering/GL/VAO.h"
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/RenderDataBufferFwd.hpp"
+#include "Rendering/Env/Particles/GPUFlyingPieceDrawer.h"
+#include "Rendering/Env/Particles/GPUParticleDrawer.h"
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Models/ModelRenderContainer.h"
+#include "Rendering/ObjectCuller.h"
 #include "Sim/Projectiles/ProjectileFunctors.h"
 #include "System/EventClient.h"
 #include "System/UnorderedSet.hpp"
@@ -53,6 +56,7 @@ public:
 	int GetReadAllyTeam() const override { return AllAccessTeam; }
 
 	void RenderProjectileCreated(const CProjectile* projectile) override;
+	void RenderProjectilesCreated(const CProjectile* const* projectiles, size_t count) override;
 	void RenderProjectileDestroyed(const CProjectile* projectile) override;
 
 
@@ -67,6 +71,9 @@ public:
 
 	const AtlasedTexture* GetSmokeTexture(unsigned int i) const { return smokeTextures[i]; }
 
+	CGPUParticleDrawer& GetGPUParticleDrawer() { return gpuParticleDrawer; }
+	CGPUFlyingPieceDrawer& GetGPUFlyingPieceDrawer() { return gpuFlyingPieceDrawer; }
+
 	GL::RenderDataBufferTC* fxBuffer = nullptr;
 	GL::RenderDataBufferTC* gfBuffer = nullptr;
 	Shader::IProgramObject* fxShader = nullptr;
@@ -113,6 +120,8 @@ public:
 	AtlasedTexture* seismictex = nullptr;
 
 private:
+	typedef CObjectCuller<CProjectile> ProjectileCuller;
+
 	static void ParseAtlasTextures(const bool, const LuaTable&, spring::unordered_set<std::string>&, CTextureAtlas*);
 
 	void DrawProjectilePass(Shader::IProgramObject*, bool, bool);
@@ -128,8 +137,11 @@ private:
 	void DrawProjectilesSetShadow(const std::vector<CProjectile*>& projectiles);
 
 	static bool CanDrawProjectile(const CProjectile* pro, const CSolidObject* owner);
-	void DrawProjectileNow(CProjectile* projectile, bool drawReflection, bool drawRefraction);
+	// both only touch <projectile>, i.e. can be run by ProjectileCuller::Cull
+	static uint8_t CullProjectile(CProjectile* projectile, bool drawReflection, bool drawRefraction);
+	static uint8_t CullProjectileShadow(const CProjectile* projectile);
 
+	void DrawProjectileNow(CProjectile* projectile);
 	void DrawProjectileShadow(const CProjectile* projectile);
 	static bool DrawProjectileModel(const CProjectile* projectile);
 
@@ -154,6 +166,10 @@ private:
 
 	VAO flyingPieceVAO;
 
+	/// CEG smoke particles simulated by the GPU
+	CGPUParticleDrawer gpuParticleDrawer;
+	CGPUFlyingPieceDrawer gpuFlyingPieceDrawer;
+
 	ProjectileDistanceComparator zSortCmp;
 
 
@@ -168,6 +184,9 @@ private:
 	/// used to render particle effects in back-to-front order
 	std::vector<CProjectile*> sortedProjectiles[2];
 
+	/// per-set visibility results, see DrawProjectilesSet{Shadow}
+	ProjectileCuller projectileCuller;
+
 	bool drawSorted = true;
 };
 
@@ -118,29 +118,49 @@ bool CFarTextureHandler::HaveFarIcon(const CSolidObject* obj) const
 
 
 /**
- * @brief Really create the far-texture for the given model.
+ * @brief Really create the far-textures for all models queued this frame.
+ * Drawing state and the atlas-sized depth-buffer are set up once for the
+ * whole batch rather than per model.
  */
-void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
+void CFarTextureHandler::CreateFarTextures()
 {
-	const S3DModel* model = obj->model;
+	size_t numIcons = 0;
+	bool haveSpace = true;
 
-	// make space
-	if (obj->team >= iconCache.size())
-		iconCache.resize(std::max(iconCache.size() * 2, size_t(obj->team + 1)), {});
+	// drop objects whose icon exists or is already part of this batch, and
+	// make room in the atlas for the rest before the FBO is bound
+	for (const CSolidObject* obj: createQueue) {
+		const S3DModel* model = obj->model;
 
-	if (model->id >= iconCache[obj->team].size())
-		iconCache[obj->team].resize(std::max(iconCache[obj->team].size() * 2, size_t(model->id + 1)), {0});
+		if (obj->team >= iconCache.size())
+			iconCache.resize(std::max(iconCache.size() * 2, size_t(obj->team + 1)), {});
 
-	// same object can be queued multiple times in different passes
-	if (iconCache[obj->team][model->id].farTexNum != 0)
-		return;
+		if (model->id >= iconCache[obj->team].size())
+			iconCache[obj->team].resize(std::max(iconCache[obj->team].size() * 2, size_t(model->id + 1)), {0});
+
+		// same object can be queued multiple times in different passes
+		if (iconCache[obj->team][model->id].farTexNum != 0)
+			continue;
+
+		// enough free space in the atlas?
+		if (!(haveSpace = haveSpace && CheckResizeAtlas(numIcons)))
+			continue;
+
+		// reserve the slot, filled in below
+		iconCache[obj->team][model->id].farTexNum = usedFarTextures + (++numIcons);
+		createQueue[numIcons - 1] = obj;
+	}
 
-	// enough free space in the atlas?
-	if (!CheckResizeAtlas())
+	if (numIcons == 0)
 		return;
 
 	fbo.Bind();
-	fbo.CreateRenderBuffer(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT16, texSize.x, texSize.y);
+
+	if (!haveDepthBuffer) {
+		fbo.CreateRenderBuffer(GL_DEPTH_ATTACHMENT, GL_DEPTH_COMPONENT16, texSize.x, texSize.y);
+		haveDepthBuffer = true;
+	}
+
 	fbo.CheckStatus("FARTEXTURE");
 
 	glAttribStatePtr->PushBits(GL_POLYGON_BIT | GL_ENABLE_BIT);
@@ -152,61 +172,69 @@ void CFarTextureHandler::CreateFarTexture(const CSolidObject* obj)
 	//   current state (advModelShading, sunDir, etc)
 	//   and will not track later state-changes
 	unitDrawer->SetupOpaqueDrawing(false);
-	unitDrawer->PushModelRenderState(model);
-	unitDrawer->SetTeamColour(obj->team);
 
 	// can pick any perspective-type
 	CCamera iconCam(CCamera::CAMTYPE_PLAYER);
 
-	CMatrix44f viewMat;
-	CMatrix44f iconMat;
-
-	// twice the radius is not quite far away enough for some models
-	viewMat.Translate(FwdVector * (-obj->GetDrawRadius() * (2.0f + 1.0f)));
-	viewMat.Scale(float3(-1.0f, 1.0f, 1.0f));
-	viewMat.RotateX(-60.0f * math::DEG_TO_RAD);
+	IUnitDrawerState* state = unitDrawer->GetDrawerState(DRAWER_STATE_SEL);
+	Shader::IProgramObject* shader = state->GetActiveShader();
 
 	// RTT with a 60-degree top-down view and 1:1 AR perspective
 	iconCam.UpdateMatrices(1, 1, 1.0f);
-	iconCam.SetViewMatrix(viewMat);
 
+	for (size_t i = 0; i < numIcons; i++) {
+		const CSolidObject* obj = createQueue[i];
+		const S3DModel* model = obj->model;
 
-	IUnitDrawerState* state = unitDrawer->GetDrawerState(DRAWER_STATE_SEL);
-	Shader::IProgramObject* shader = state->GetActiveShader();
+		CachedIcon& icon = iconCache[obj->team][model->id];
+
+		unitDrawer->PushModelRenderState(model);
+		unitDrawer->SetTeamColour(obj->team);
+
+		CMatrix44f viewMat;
+		CMatrix44f iconMat;
+
+		// twice the radius is not quite far away enough for some models
+		viewMat.Translate(FwdVector * (-obj->GetDrawRadius() * (2.0f + 1.0f)));
+		viewMat.Scale(float3(-1.0f, 1.0f, 1.0f));
+		viewMat.RotateX(-60.0f * math::DEG_TO_RAD);
 
-	// overwrite the matrices set by SetupOpaqueDrawing
-	shader->SetUniformMatrix4fv(7, false, iconCam.GetViewMatrix());
-	shader->SetUniformMatrix4fv(8, false, iconCam.GetProjectionMatrix());
+		iconCam.SetViewMatrix(viewMat);
 
+		// overwrite the matrices set by SetupOpaqueDrawing
+		shader->SetUniformMatrix4fv(7, false, iconCam.GetViewMatrix());
+		shader->SetUniformMatrix4fv(8, false, iconCam.GetProjectionMatrix());
 
-	for (int orient = 0; orient < NUM_ICON_ORIENTATIONS; ++orient) {
-		// setup viewport
-		const int2 pos = GetTextureCoordsInt(usedFarTextures, orient);
+		for (int orient = 0; orient < NUM_ICON_ORIENTATIONS; ++orient) {
+			// setup viewport
+			const int2 pos = GetTextureCoordsInt(icon.farTexNum - 1, orient);
 
-		glAttribStatePtr->ViewPort(pos.x * iconSize.x, pos.y * iconSize.y, iconSize.x, iconSize.y);
-		glAttribStatePtr->Clear(GL_DEPTH_BUFFER_BIT);
+			glAttribStatePtr->ViewPort(pos.x * iconSize.x, pos.y * iconSize.y, iconSize.x, iconSize.y);
+			glAttribStatePtr->Clear(GL_DEPTH_BUFFER_BIT);
 
-		// draw (static-pose) model
-		state->SetMatrices(iconMat, model->GetPieceMatrices());
-		model->Draw();
+			// draw (static-pose) model
+			state->SetMatrices(iconMat, model->GetPieceMatrices());
+			model->Draw();
 
-		iconMat.LoadIdentity();
-		iconMat.RotateY((360.0f / NUM_ICON_ORIENTATIONS) * (orient + 1) * math::DEG_TO_RAD);
+			iconMat.LoadIdentity();
+			iconMat.RotateY((360.0f / NUM_ICON_ORIENTATIONS) * (orient + 1) * math::DEG_TO_RAD);
+		}
+
+		unitDrawer->PopModelRenderState(model);
+
+		// cache object's current radius s.t. quad is always drawn with fixed size
+		icon.texScales = {obj->GetDrawRadius(), obj->GetDrawRadius()};
+		icon.texOffset = UpVector * obj->GetDrawRadius() * 0.5f;
 	}
 
-	unitDrawer->PopModelRenderState(model);
 	unitDrawer->ResetOpaqueDrawing(false);
 
 	// glAttribStatePtr->ViewPort(globalRendering->viewPosX, 0, globalRendering->viewSizeX, globalRendering->viewSizeY);
 	glAttribStatePtr->PopBits();
 
-	fbo.Detach(GL_DEPTH_ATTACHMENT);
 	fbo.Unbind();
 
-	// cache object's current radius s.t. quad is always drawn with fixed size
-	iconCache[obj->team][model->id].farTexNum = ++usedFarTextures;
-	iconCache[obj->team][model->id].texScales = {obj->GetDrawRadius(), obj->GetDrawRadius()};
-	iconCache[obj->team][model->id].texOffset = UpVector * obj->GetDrawRadius() * 0.5f;
+	usedFarTextures += numIcons;
 }
 
 
@@ -268,9 +296,8 @@ void CFarTextureHandler::Queue(const CSolidObject* obj)
 
 void CFarTextureHandler::Draw()
 {
-	for (const CSolidObject* obj: createQueue) {
-		CreateFarTexture(obj);
-	}
+	if (!createQueue.empty())
+		CreateFarTextures();
 
 	// render currently queued far-icons
 	if (!renderQueue.empty()) {
@@ -301,7 +328,7 @@ void CFarTextureHandler::Draw()
 
 
 
-bool CFarTextureHandler::CheckResizeAtlas()
+bool CFarTextureHandler::CheckResizeAtlas(size_t numPendingIcons)
 {
 	const int oldTexSizeY = texSize.y;
 	const int maxTexSizeY = globalRendering->maxTextureSize;
@@ -310,7 +337,7 @@ bool CFarTextureHandler::CheckResizeAtlas()
 		const int maxSpritesX = texSize.x / iconSize.x;
 		const int maxSpritesY = texSize.y / iconSize.y;
 		const int maxSprites  = maxSpritesX * maxSpritesY;
-		const int numSprites  = usedFarTextures * NUM_ICON_ORIENTATIONS;
+		const int numSprites  = (usedFarTextures + numPendingIcons) * NUM_ICON_ORIENTATIONS;
 
 		if ((numSprites + NUM_ICON_ORIENTATIONS) <= maxSprites)
 			break;
@@ -346,11 +373,13 @@ bool CFarTextureHandler::CheckResizeAtlas()
 	glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, texSize.x, texSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, &atlasPixels[0]);
 
 	fbo.Bind();
+	// also drops the depth-buffer, which has to match the new atlas size
 	fbo.DetachAll();
 	fbo.AttachTexture(farTextureID = newFarTextureID);
 	fbo.CheckStatus("FARTEXTURE");
 	fbo.Unbind();
 
+	haveDepthBuffer = false;
 	return true;
 }
 
@@ -25,13 +25,13 @@ public:
 
 private:
 	bool HaveFarIcon(const CSolidObject* obj) const;
-	bool CheckResizeAtlas();
+	bool CheckResizeAtlas(size_t numPendingIcons);
 
 	float2 GetTextureCoords(const int farTextureNum, const int orientation) const;
 	int2 GetTextureCoordsInt(const int farTextureNum, const int orientation) const;
 
 	void DrawFarTexture(const CSolidObject* obj, GL::RenderDataBufferTN* rdb);
-	void CreateFarTexture(const CSolidObject* obj);
+	void CreateFarTextures();
 
 private:
 	int2 texSize;
@@ -52,6 +52,9 @@ private:
 
 	unsigned int farTextureID;
 	unsigned int usedFarTextures;
+
+	// kept attached between batches, recreated when the atlas grows
+	bool haveDepthBuffer = false;
 };
 
 extern CFarTextureHandler* farTextureHandler;
@@ -17,6 +17,7 @@
 #include "Rendering/GL/glExtra.h"
 #include "Rendering/GL/myGL.h"
 #include "Rendering/LuaObjectDrawer.h"
+#include "Rendering/OcclusionCuller.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/Textures/S3OTextureHandler.h"
@@ -26,6 +27,7 @@
 #include "Sim/Features/Feature.h"
 #include "Sim/Features/FeatureDef.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/TeamHandler.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/ContainerUtil.h"
 #include "System/EventHandler.h"
@@ -190,6 +192,8 @@ void CFeatureDrawer::ConfigNotify(const std::string& key, const std::string& val
 
 void CFeatureDrawer::RenderFeatureCreated(const CFeature* feature)
 {
+	shadowHandler.InvalidateStaticCasters();
+
 	if (feature->def->drawType != DRAWTYPE_MODEL)
 		return;
 
@@ -205,6 +209,8 @@ void CFeatureDrawer::RenderFeatureCreated(const CFeature* feature)
 
 void CFeatureDrawer::RenderFeatureDestroyed(const CFeature* feature)
 {
+	shadowHandler.InvalidateStaticCasters();
+
 	CFeature* f = const_cast<CFeature*>(feature);
 
 	if (f->def->drawType == DRAWTYPE_MODEL)
@@ -219,6 +225,7 @@ void CFeatureDrawer::RenderFeatureDestroyed(const CFeature* feature)
 
 void CFeatureDrawer::FeatureMoved(const CFeature* feature, const float3& oldpos)
 {
+	shadowHandler.InvalidateStaticCasters();
 	UpdateDrawQuad(const_cast<CFeature*>(feature));
 }
 
@@ -303,6 +310,21 @@ void CFeatureDrawer::DrawOpaqueFeatures(int modelType)
 {
 	const auto& quads = camVisibleQuads[(CCameraHandler::GetActiveCamera())->GetCamType()];
 
+	const bool drawInstanced = unitDrawer->CanDrawInstanced();
+
+	featureCuller.Clear();
+
+	for (int quad: quads) {
+		const auto& mdlRenderProxy = modelRenderers[quad];
+
+		if (mdlRenderProxy.GetLastDrawFrame() < globalRendering->drawFrame)
+			continue;
+
+		featureCuller.AddObjects(mdlRenderProxy.GetRenderer(modelType));
+	}
+
+	featureCuller.Cull([&](const CFeature* f) { return (CullOpaqueFeature(f)); });
+
 	for (int quad: quads) {
 		const auto& mdlRenderProxy = modelRenderers[quad];
 
@@ -315,17 +337,17 @@ void CFeatureDrawer::DrawOpaqueFeatures(int modelType)
 		for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
 			CUnitDrawer::BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
+			if (drawInstanced)
+				instancedFeatures.AddBin(modelType, mdlRenderer.GetObjectBinKey(i));
+
 			for (CFeature* f: mdlRenderer.GetObjectBin(i)) {
-				// fartex, opaque, shadow are allowed here
-				switch (f->drawFlag) {
-					case CFeature::FD_NODRAW_FLAG: {                              continue; } break;
-					case CFeature::FD_ALPHAF_FLAG: {                              continue; } break;
-					case CFeature::FD_FARTEX_FLAG: { farTextureHandler->Queue(f); continue; } break;
+				switch (featureCuller.NextResult()) {
+					case FeatureCuller::CULL_RESULT_HIDDEN: {                              continue; } break;
+					case FeatureCuller::CULL_RESULT_FARTEX: { farTextureHandler->Queue(f); continue; } break;
 					default: {} break;
 				}
 
-				// test this before the LOD calls (for consistency with UD)
-				if (!CanDrawFeature(f))
+				if (!water->CountPassObject())
 					continue;
 
 				if ( inShadowPass && LuaObjectDrawer::AddShadowMaterialObject(f, LUAOBJ_FEATURE))
@@ -333,12 +355,43 @@ void CFeatureDrawer::DrawOpaqueFeatures(int modelType)
 				if (!inShadowPass && LuaObjectDrawer::AddOpaqueMaterialObject(f, LUAOBJ_FEATURE))
 					continue;
 
+				// team-less features keep whatever color was set last
+				if (drawInstanced && !f->luaDraw && teamHandler.IsValidTeam(f->team)) {
+					instancedFeatures.AddObject(f);
+					continue;
+				}
+
 				unitDrawer->SetTeamColour(f->team);
 
 				DrawFeatureDefTrans(f, false, false);
 			}
 		}
 	}
+
+	unitDrawer->DrawInstancedBatch(instancedFeatures);
+}
+
+uint8_t CFeatureDrawer::CullOpaqueFeature(const CFeature* feature) const
+{
+	// fartex, opaque, shadow are allowed here
+	switch (feature->drawFlag) {
+		case CFeature::FD_NODRAW_FLAG: { return FeatureCuller::CULL_RESULT_HIDDEN; } break;
+		case CFeature::FD_ALPHAF_FLAG: { return FeatureCuller::CULL_RESULT_HIDDEN; } break;
+		case CFeature::FD_FARTEX_FLAG: { return FeatureCuller::CULL_RESULT_FARTEX; } break;
+		default: {} break;
+	}
+
+	// test this before the LOD calls (for consistency with UD)
+	if (!CanDrawFeature(feature))
+		return FeatureCuller::CULL_RESULT_HIDDEN;
+
+	// terrain occlusion is only known for the player's view
+	if (!water->DrawReflectionPass() && !water->DrawRefractionPass() && (CCameraHandler::GetActiveCamera())->GetCamType() == CCamera::CAMTYPE_PLAYER) {
+		if (occlusionCuller.IsOccluded(feature->drawMidPos, feature->GetDrawRadius()))
+			return FeatureCuller::CULL_RESULT_HIDDEN;
+	}
+
+	return FeatureCuller::CULL_RESULT_INVIEW;
 }
 
 bool CFeatureDrawer::CanDrawFeature(const CFeature* feature) const
@@ -537,7 +590,7 @@ void CFeatureDrawer::DrawShadowPass()
 		// needed for 3do models (else they will use any currently bound texture)
 		// note: texture0 is by default a 1x1 texture with rgba(0,0,0,255)
 		// (we are just interested in the 255 alpha here)
-		glBindTexture(GL_TEXTURE_2D, 0);
+		glAttribStatePtr->BindTexture(GL_TEXTURE_2D, 0);
 
 		// need the alpha-mask for transparent features; threshold set in ShadowHandler
 		glAttribStatePtr->PushColorBufferBit();
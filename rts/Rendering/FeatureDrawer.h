@@ -7,7 +7,9 @@
 #include <array>
 
 #include "Game/Camera.h"
+#include "Rendering/Models/ModelInstanceBuffer.h"
 #include "Rendering/Models/ModelRenderContainer.h"
+#include "Rendering/ObjectCuller.h"
 #include "System/creg/creg_cond.h"
 #include "System/EventClient.h"
 
@@ -73,6 +75,8 @@ public:
 	bool DrawDeferred() const { return drawDeferred; }
 
 private:
+	typedef CObjectCuller<CFeature> FeatureCuller;
+
 	static void UpdateDrawPos(CFeature* f);
 
 	void DrawOpaqueFeatures(int modelType);
@@ -81,6 +85,7 @@ private:
 	void DrawFarFeatures();
 
 	bool CanDrawFeature(const CFeature*) const;
+	uint8_t CullOpaqueFeature(const CFeature*) const;
 
 	static void DrawFeatureModel(const CFeature* feature, bool noLuaCall);
 
@@ -131,6 +136,10 @@ private:
 	std::array< std::vector<int>, CCamera::CAMTYPE_ENVMAP> camVisibleQuads;
 	std::array<unsigned int, CCamera::CAMTYPE_ENVMAP> camVisDrawFrames;
 	std::vector<CFeature*> unsortedFeatures;
+	/// default-material features batched by DrawOpaqueFeatures
+	InstancedModelBatch instancedFeatures;
+	/// per-pass visibility results for DrawOpaqueFeatures
+	FeatureCuller featureCuller;
 
 	GL::GeometryBuffer* geomBuffer;
 };
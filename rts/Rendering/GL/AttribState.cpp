@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <cstring>
@@ -75,6 +76,10 @@ GL::AttribState::AttribState() {
 	colorMaskStack.Fill({GL_FALSE, GL_FALSE, GL_FALSE, GL_FALSE});
 	viewportStack.Fill({0, 0, 0, 0});
 	scissorStack.Fill({0, 0, 0, 0});
+
+	for (auto& unitTextures: boundTextures) {
+		std::fill(std::begin(unitTextures), std::end(unitTextures), -1u);
+	}
 }
 
 void GL::AttribState::Init() {
@@ -117,6 +122,40 @@ void GL::AttribState::Init() {
 }
 
 
+void GL::AttribState::ApplyDepthClamp(bool enable) {
+	if (UpdateApplied(appliedState.depthClamp, uint32_t(enable)))
+		glSetStateFuncs[enable](GL_DEPTH_CLAMP);
+}
+void GL::AttribState::ApplyDepthTest(bool enable) {
+	if (UpdateApplied(appliedState.depthTest, uint32_t(enable)))
+		glSetStateFuncs[enable](GL_DEPTH_TEST);
+}
+void GL::AttribState::ApplyDepthMask(bool enable) {
+	if (UpdateApplied(appliedState.depthMask, uint32_t(enable)))
+		glDepthMask(enable);
+}
+void GL::AttribState::ApplyDepthFunc(uint32_t func) {
+	if (UpdateApplied(appliedState.depthFunc, func))
+		glDepthFunc(func);
+}
+void GL::AttribState::ApplyBlendFunc(const BlendFuncState& v) {
+	if (UpdateApplied(appliedState.blendFunc, v))
+		glBlendFunc(v.srcFac, v.dstFac);
+}
+void GL::AttribState::ApplyBlendMask(bool enable) {
+	if (UpdateApplied(appliedState.blendMask, uint32_t(enable)))
+		glSetStateFuncs[enable](GL_BLEND);
+}
+void GL::AttribState::ApplyCullFace(uint32_t face) {
+	if (UpdateApplied(appliedState.cullFace, face))
+		glCullFace(face);
+}
+void GL::AttribState::ApplyCullFlag(bool enable) {
+	if (UpdateApplied(appliedState.cullFlag, uint32_t(enable)))
+		glSetStateFuncs[enable](GL_CULL_FACE);
+}
+
+
 void GL::AttribState::Enable(uint32_t attrib) {
 	switch (attrib) {
 		case GL_DEPTH_CLAMP         : { EnableDepthClamp  (); return; } break; // unofficial
@@ -363,46 +402,46 @@ void GL::AttribState::PopDepthRange() {
 
 
 void GL::AttribState::DepthClamp(bool enable) {
-	glSetStateFuncs[depthClampStack.Top() = enable](GL_DEPTH_CLAMP);
+	ApplyDepthClamp(depthClampStack.Top() = enable);
 }
 void GL::AttribState::PushDepthClamp(bool enable) {
-	glSetStateFuncs[depthClampStack.Push(enable)](GL_DEPTH_CLAMP);
+	ApplyDepthClamp(depthClampStack.Push(enable));
 }
 void GL::AttribState::PopDepthClamp() {
-	glSetStateFuncs[depthClampStack.Pop(true)](GL_DEPTH_CLAMP);
+	ApplyDepthClamp(depthClampStack.Pop(true));
 }
 
 
 void GL::AttribState::DepthTest(bool enable) {
-	glSetStateFuncs[depthTestStack.Top() = enable](GL_DEPTH_TEST);
+	ApplyDepthTest(depthTestStack.Top() = enable);
 }
 void GL::AttribState::PushDepthTest(bool enable) {
-	glSetStateFuncs[depthTestStack.Push(enable)](GL_DEPTH_TEST);
+	ApplyDepthTest(depthTestStack.Push(enable));
 }
 void GL::AttribState::PopDepthTest() {
-	glSetStateFuncs[depthTestStack.Pop(true)](GL_DEPTH_TEST);
+	ApplyDepthTest(depthTestStack.Pop(true));
 }
 
 
 void GL::AttribState::DepthMask(bool enable) {
-	glDepthMask(depthMaskStack.Top() = enable);
+	ApplyDepthMask(depthMaskStack.Top() = enable);
 }
 void GL::AttribState::PushDepthMask(bool enable) {
-	glDepthMask(depthMaskStack.Push(enable));
+	ApplyDepthMask(depthMaskStack.Push(enable));
 }
 void GL::AttribState::PopDepthMask() {
-	glDepthMask(depthMaskStack.Pop(true));
+	ApplyDepthMask(depthMaskStack.Pop(true));
 }
 
 
 void GL::AttribState::DepthFunc(uint32_t func) {
-	glDepthFunc(depthFuncStack.Top() = func);
+	ApplyDepthFunc(depthFuncStack.Top() = func);
 }
 void GL::AttribState::PushDepthFunc(uint32_t func) {
-	glDepthFunc(depthFuncStack.Push(func));
+	ApplyDepthFunc(depthFuncStack.Push(func));
 }
 void GL::AttribState::PopDepthFunc() {
-	glDepthFunc(depthFuncStack.Pop(true));
+	ApplyDepthFunc(depthFuncStack.Pop(true));
 }
 
 
@@ -438,10 +477,7 @@ void GL::AttribState::PopAlphaFunc() {
 
 
 void GL::AttribState::BlendFunc(uint32_t srcFac, uint32_t dstFac) {
-	glBlendFunc(
-		(blendFuncStack.Top()).srcFac = srcFac,
-		(blendFuncStack.Top()).dstFac = dstFac
-	);
+	ApplyBlendFunc(blendFuncStack.Top() = {srcFac, dstFac});
 }
 void GL::AttribState::PushBlendFunc(uint32_t srcFac, uint32_t dstFac) {
 	BlendFunc(blendFuncStack.Push({srcFac, dstFac}));
@@ -452,13 +488,13 @@ void GL::AttribState::PopBlendFunc() {
 
 
 void GL::AttribState::BlendMask(bool enable) {
-	glSetStateFuncs[blendMaskStack.Top() = enable](GL_BLEND);
+	ApplyBlendMask(blendMaskStack.Top() = enable);
 }
 void GL::AttribState::PushBlendMask(bool enable) {
-	glSetStateFuncs[blendMaskStack.Push(enable)](GL_BLEND);
+	ApplyBlendMask(blendMaskStack.Push(enable));
 }
 void GL::AttribState::PopBlendMask() {
-	glSetStateFuncs[blendMaskStack.Pop(true)](GL_BLEND);
+	ApplyBlendMask(blendMaskStack.Pop(true));
 }
 
 
@@ -629,24 +665,24 @@ void GL::AttribState::PopFrontFace() {
 
 
 void GL::AttribState::CullFace(uint32_t face) {
-	glCullFace(cullFaceStack.Top() = face);
+	ApplyCullFace(cullFaceStack.Top() = face);
 }
 void GL::AttribState::PushCullFace(uint32_t face) {
-	glCullFace(cullFaceStack.Push(face));
+	ApplyCullFace(cullFaceStack.Push(face));
 }
 void GL::AttribState::PopCullFace() {
-	glCullFace(cullFaceStack.Pop(true));
+	ApplyCullFace(cullFaceStack.Pop(true));
 }
 
 
 void GL::AttribState::CullFlag(bool enable) {
-	glSetStateFuncs[cullFlagStack.Top() = enable](GL_CULL_FACE);
+	ApplyCullFlag(cullFlagStack.Top() = enable);
 }
 void GL::AttribState::PushCullFlag(bool enable) {
-	glSetStateFuncs[cullFlagStack.Push(enable)](GL_CULL_FACE);
+	ApplyCullFlag(cullFlagStack.Push(enable));
 }
 void GL::AttribState::PopCullFlag() {
-	glSetStateFuncs[cullFlagStack.Pop(true)](GL_CULL_FACE);
+	ApplyCullFlag(cullFlagStack.Pop(true));
 }
 
 
@@ -705,6 +741,96 @@ void GL::AttribState::ClearStencil(uint32_t rval) {
 
 
 
+void GL::AttribState::UseProgram(uint32_t progID) {
+	if (boundProgram == progID) {
+		frameStats[0].numProgramSkipped++;
+		return;
+	}
+
+	glUseProgram(boundProgram = progID);
+	frameStats[0].numProgramChanges++;
+}
+
+void GL::AttribState::BindVertexArray(uint32_t vaoID) {
+	if (boundVertexArray == vaoID) {
+		frameStats[0].numVertexArraySkipped++;
+		return;
+	}
+
+	glBindVertexArray(boundVertexArray = vaoID);
+	frameStats[0].numVertexArrayChanges++;
+}
+
+void GL::AttribState::DeleteVertexArrays(uint32_t count, const uint32_t* vaoIDs) {
+	// GL reverts the binding to zero, and the name can be handed out again
+	boundVertexArray *= (std::find(vaoIDs, vaoIDs + count, boundVertexArray) == (vaoIDs + count));
+
+	glDeleteVertexArrays(count, vaoIDs);
+}
+
+
+static uint32_t GetTextureTargetIndex(uint32_t texTarget) {
+	switch (texTarget) {
+		case GL_TEXTURE_2D      : return 0;
+		case GL_TEXTURE_2D_ARRAY: return 1;
+		case GL_TEXTURE_CUBE_MAP: return 2;
+		case GL_TEXTURE_3D      : return 3;
+		case GL_TEXTURE_BUFFER  : return 4;
+		default                 : {    } break;
+	}
+
+	return -1u;
+}
+
+void GL::AttribState::ActiveTexture(uint32_t texUnit) {
+	if (textureCacheEnabled && activeTexUnit == texUnit) {
+		frameStats[0].numTextureSkipped++;
+		return;
+	}
+
+	glActiveTexture(activeTexUnit = texUnit);
+	frameStats[0].numTextureChanges++;
+}
+
+void GL::AttribState::BindTexture(uint32_t texTarget, uint32_t texID) {
+	const uint32_t unitIdx = activeTexUnit - GL_TEXTURE0;
+	const uint32_t targIdx = GetTextureTargetIndex(texTarget);
+
+	if (textureCacheEnabled && unitIdx < MAX_TEXTURE_UNITS && targIdx != -1u) {
+		if (boundTextures[unitIdx][targIdx] == texID) {
+			frameStats[0].numTextureSkipped++;
+			return;
+		}
+
+		boundTextures[unitIdx][targIdx] = texID;
+	}
+
+	glBindTexture(texTarget, texID);
+	frameStats[0].numTextureChanges++;
+}
+
+void GL::AttribState::EnableTextureCache() {
+	assert(!textureCacheEnabled);
+
+	// whatever was bound before is unknown, the first bind per unit goes through
+	for (auto& unitTextures: boundTextures) {
+		std::fill(std::begin(unitTextures), std::end(unitTextures), -1u);
+	}
+
+	activeTexUnit = -1u;
+	textureCacheEnabled = true;
+}
+
+void GL::AttribState::DisableTextureCache() {
+	textureCacheEnabled = false;
+}
+
+
+
+
+GL::ScopedTextureCache::ScopedTextureCache() { glAttribStatePtr->EnableTextureCache(); }
+GL::ScopedTextureCache::~ScopedTextureCache() { glAttribStatePtr->DisableTextureCache(); }
+
 
 GL::ScopedDepthFunc::~ScopedDepthFunc() { glDepthFunc(prevFunc); }
 GL::ScopedDepthFunc::ScopedDepthFunc(uint32_t func) {
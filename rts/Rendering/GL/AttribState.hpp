@@ -4,6 +4,8 @@
 #define GL_ATTRIB_STATE_H
 
 #include <array>
+#include <cstdint>
+#include <cstring>
 
 namespace GL {
 	struct AttribState {
@@ -222,6 +224,36 @@ namespace GL {
 		void ClearDepth(float depth);
 		void ClearStencil(uint32_t rval);
 
+		// bindings (GLuint); always go through the cache since every bind
+		// site in the engine does, deletion of a bound VAO reverts it to 0
+		void UseProgram(uint32_t progID);
+		void BindVertexArray(uint32_t vaoID);
+		void DeleteVertexArrays(uint32_t count, const uint32_t* vaoIDs);
+
+		// texture bindings (GLenum, GLuint); only filtered while the texture
+		// cache is enabled (see ScopedTextureCache) because most texture code
+		// including Lua binds directly, otherwise just forwarded and counted
+		void ActiveTexture(uint32_t texUnit);
+		void BindTexture(uint32_t texTarget, uint32_t texID);
+		void EnableTextureCache();
+		void DisableTextureCache();
+
+	public:
+		struct FrameStats {
+			uint32_t numStateChanges;
+			uint32_t numStateSkipped;
+			uint32_t numProgramChanges;
+			uint32_t numProgramSkipped;
+			uint32_t numVertexArrayChanges;
+			uint32_t numVertexArraySkipped;
+			uint32_t numTextureChanges;
+			uint32_t numTextureSkipped;
+		};
+
+		// called once per frame; GetFrameStats returns the counts of the last completed frame
+		void ResetFrameStats() { frameStats[1] = frameStats[0]; frameStats[0] = {}; }
+		const FrameStats& GetFrameStats() const { return frameStats[1]; }
+
 	private:
 		struct DepthRangeState {
 			float zn;
@@ -302,6 +334,27 @@ namespace GL {
 		void PushViewPort(const ViewPortState& v) { PushViewPort(v.x, v.y, v.w, v.h); }
 		void PushScissor(const ScissorState& v) { PushScissor(v.x, v.y, v.w, v.h); }
 
+		// forward a value to GL only if it differs from the last one sent
+		void ApplyDepthClamp(bool enable);
+		void ApplyDepthTest(bool enable);
+		void ApplyDepthMask(bool enable);
+		void ApplyDepthFunc(uint32_t func);
+		void ApplyBlendFunc(const BlendFuncState& v);
+		void ApplyBlendMask(bool enable);
+		void ApplyCullFace(uint32_t face);
+		void ApplyCullFlag(bool enable);
+
+		template<typename T> bool UpdateApplied(T& applied, const T& value) {
+			if (memcmp(&applied, &value, sizeof(T)) == 0) {
+				frameStats[0].numStateSkipped++;
+				return false;
+			}
+
+			applied = value;
+			frameStats[0].numStateChanges++;
+			return true;
+		}
+
 	private:
 		template<typename T, size_t S> struct ArrayStack {
 		static_assert((S & (S - 1)) == 0, "stack size must be a power of two");
@@ -367,6 +420,34 @@ namespace GL {
 		ArrayStack<ColorMaskState  , 64>   colorMaskStack;
 		ArrayStack<ViewPortState   , 64>    viewportStack;
 		ArrayStack< ScissorState   , 64>     scissorStack;
+
+		// values last sent to GL, ~0 until the first call (Init) goes through
+		struct AppliedState {
+			uint32_t depthClamp = -1u;
+			uint32_t depthTest = -1u;
+			uint32_t depthMask = -1u;
+			uint32_t depthFunc = -1u;
+			BlendFuncState blendFunc = {-1u, -1u};
+			uint32_t blendMask = -1u;
+			uint32_t cullFace = -1u;
+			uint32_t cullFlag = -1u;
+		};
+
+		static constexpr uint32_t MAX_TEXTURE_UNITS = 32;
+		static constexpr uint32_t NUM_TEXTURE_TARGETS = 5;
+
+		AppliedState appliedState;
+
+		uint32_t boundProgram = -1u;
+		uint32_t boundVertexArray = -1u;
+
+		uint32_t activeTexUnit = -1u;
+		uint32_t boundTextures[MAX_TEXTURE_UNITS][NUM_TEXTURE_TARGETS];
+
+		bool textureCacheEnabled = false;
+
+		// [0] current frame, [1] last completed frame
+		FrameStats frameStats[2] = {};
 	};
 
 
@@ -390,6 +471,16 @@ namespace GL {
 	};
 
 
+	// filters redundant texture binds for the duration of its scope; nothing in
+	// it may bind textures or change the active unit without going through the
+	// AttribState (which e.g. rules out Lua call-ins)
+	struct ScopedTextureCache {
+	public:
+		ScopedTextureCache();
+		~ScopedTextureCache();
+	};
+
+
 	AttribState* SetAttribStatePointer(bool mainThread);
 	AttribState* GetAttribStatePointer();
 }
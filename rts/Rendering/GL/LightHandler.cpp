@@ -3,17 +3,93 @@
 #include "myGL.h"
 #include "LightHandler.h"
 #include "Game/GlobalUnsynced.h"
+#include "Map/ReadMap.h"
+#include "Rendering/GlobalRendering.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Projectiles/Projectile.h"
 
-void GL::LightHandler::Init(unsigned int cfgMaxLights) {
-	maxLights = std::min(MaxConfigLights(), cfgMaxLights);
+void GL::LightHandler::Init(unsigned int cfgMaxLights, unsigned int cfgMaxGridLights) {
+	if (cfgMaxGridLights > 0) {
+		maxLights = std::min(MaxGridLights(), cfgMaxGridLights);
+	} else {
+		maxLights = std::min(MaxConfigLights(), cfgMaxLights);
+	}
+
+	glLights.clear();
+	glLights.resize(maxLights);
+	rawLights.clear();
+	rawLights.resize(maxLights, RawLight{});
 
 	for (unsigned int i = 0; i < maxLights; i++) {
 		glLights[i].SetID(GL_LIGHT0 + i);
 	}
+
+	if (cfgMaxGridLights == 0 || maxLights == 0)
+		return;
+
+	gridScale.x = LIGHT_GRID_SIZE / (mapDims.mapx * SQUARE_SIZE * 1.0f);
+	gridScale.y = LIGHT_GRID_SIZE / (mapDims.mapy * SQUARE_SIZE * 1.0f);
+
+	gridRects.clear();
+	gridRects.reserve(maxLights);
+	gridData.clear();
+	gridData.resize(NUM_GRID_TILES + 1 + MAX_GRID_INDICES, 0);
+
+	lightDataBuffer = VBO(GL_TEXTURE_BUFFER);
+	lightDataBuffer.Bind();
+	lightDataBuffer.New(maxLights * sizeof(RawLight), GL_DYNAMIC_DRAW);
+	lightDataBuffer.Unbind();
+
+	lightGridBuffer = VBO(GL_TEXTURE_BUFFER);
+	lightGridBuffer.Bind();
+	lightGridBuffer.New(gridData.size() * sizeof(unsigned int), GL_DYNAMIC_DRAW, gridData.data());
+	lightGridBuffer.Unbind();
+
+	glGenTextures(2, &gridTextureIDs[0]);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, gridTextureIDs[0]);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, lightDataBuffer.GetId());
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, gridTextureIDs[1]);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_R32UI, lightGridBuffer.GetId());
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, 0);
+}
+
+void GL::LightHandler::Kill() {
+	if (gridTextureIDs[0] != 0) {
+		glDeleteTextures(2, &gridTextureIDs[0]);
+
+		gridTextureIDs[0] = 0;
+		gridTextureIDs[1] = 0;
+	}
+
+	lightDataBuffer.Release();
+	lightGridBuffer.Release();
+
+	for (GL::Light& light: glLights) {
+		light.ClearDeathDependencies();
+	}
+
+	glLights.clear();
+	rawLights.clear();
+	gridRects.clear();
+	gridData.clear();
+
+	maxLights = 0;
+	gridUpdateFrame = -1u;
+}
+
+
+void GL::LightHandler::BindLightGrid(unsigned int texUnit) const {
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + texUnit    ); glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, gridTextureIDs[0]);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + texUnit + 1); glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, gridTextureIDs[1]);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+}
+
+void GL::LightHandler::UnbindLightGrid(unsigned int texUnit) const {
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + texUnit    ); glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, 0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + texUnit + 1); glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, 0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
 }
 
 
@@ -176,5 +252,95 @@ void GL::LightHandler::Update() {
 		rawLights[i].fovRadius = {light.GetFOV(), light.GetRadius(), light.GetRadius(), light.GetRadius()};
 		#endif
 	}
+
+	// Update runs for every pass, the light positions only change once per frame
+	if (UseLightGrid() && gridUpdateFrame != globalRendering->drawFrame) {
+		gridUpdateFrame = globalRendering->drawFrame;
+		UpdateLightGrid();
+	}
+}
+
+void GL::LightHandler::UpdateLightGrid() {
+	unsigned int* tileOffsets = &gridData[0];
+	unsigned int* tileIndices = &gridData[NUM_GRID_TILES + 1];
+
+	unsigned int numIndices = 0;
+	unsigned int numRawLights = 0;
+
+	gridRects.clear();
+	std::fill(tileOffsets, tileOffsets + NUM_GRID_TILES + 1, 0);
+
+	// pass 1: count the lights overlapping each tile
+	for (unsigned int i = 0; i < maxLights; i++) {
+		if (glLights[i].GetTTL() == 0)
+			continue;
+
+		numRawLights = i + 1;
+
+		const RawLight& rawLight = rawLights[i];
+
+		// not in LOS; its ambient term is bounded by the radius as well
+		if (rawLight.diffColor == ZeroVector && rawLight.specColor == ZeroVector && rawLight.ambiColor == ZeroVector)
+			continue;
+
+		const float radius = rawLight.fovRadius.y;
+
+		const float x1 = (rawLight.worldPos.x - radius) * gridScale.x;
+		const float z1 = (rawLight.worldPos.z - radius) * gridScale.y;
+		const float x2 = (rawLight.worldPos.x + radius) * gridScale.x;
+		const float z2 = (rawLight.worldPos.z + radius) * gridScale.y;
+
+		// positions outside the map are clamped to the border tiles, as in the shaders
+		GridRect rect;
+		rect.lightIndex = i;
+		rect.x1 = Clamp(int(x1), 0, int(LIGHT_GRID_SIZE - 1));
+		rect.z1 = Clamp(int(z1), 0, int(LIGHT_GRID_SIZE - 1));
+		rect.x2 = Clamp(int(x2), 0, int(LIGHT_GRID_SIZE - 1));
+		rect.z2 = Clamp(int(z2), 0, int(LIGHT_GRID_SIZE - 1));
+
+		const unsigned int numTiles = (rect.x2 - rect.x1 + 1) * (rect.z2 - rect.z1 + 1);
+
+		if ((numIndices + numTiles) > MAX_GRID_INDICES)
+			continue;
+
+		for (unsigned int z = rect.z1; z <= rect.z2; z++) {
+			for (unsigned int x = rect.x1; x <= rect.x2; x++) {
+				tileOffsets[z * LIGHT_GRID_SIZE + x + 1] += 1;
+			}
+		}
+
+		numIndices += numTiles;
+		gridRects.push_back(rect);
+	}
+
+	// counts to {begin, end} offsets; tileOffsets[t + 1] then serves as a write-cursor
+	for (unsigned int t = 1; t <= NUM_GRID_TILES; t++) {
+		tileOffsets[t] += tileOffsets[t - 1];
+	}
+	for (unsigned int t = NUM_GRID_TILES; t > 0; t--) {
+		tileOffsets[t] = tileOffsets[t - 1];
+	}
+
+	// pass 2: scatter light indices, ascending per tile
+	for (const GridRect& rect: gridRects) {
+		for (unsigned int z = rect.z1; z <= rect.z2; z++) {
+			for (unsigned int x = rect.x1; x <= rect.x2; x++) {
+				tileIndices[ tileOffsets[z * LIGHT_GRID_SIZE + x + 1]++ ] = rect.lightIndex;
+			}
+		}
+	}
+
+	assert(tileOffsets[NUM_GRID_TILES] == numIndices);
+
+	// not mapped unsynchronized, earlier passes of this frame may still read the buffers
+	if (numRawLights > 0) {
+		lightDataBuffer.Bind();
+		glBufferSubData(GL_TEXTURE_BUFFER, 0, numRawLights * sizeof(RawLight), rawLights.data());
+		lightDataBuffer.Unbind();
+	}
+
+	lightGridBuffer.Bind();
+	glBufferSubData(GL_TEXTURE_BUFFER, 0, (NUM_GRID_TILES + 1 + numIndices) * sizeof(unsigned int), gridData.data());
+	lightGridBuffer.Unbind();
 }
 
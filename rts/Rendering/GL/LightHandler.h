@@ -3,18 +3,32 @@
 #ifndef _GL_LIGHTHANDLER_H
 #define _GL_LIGHTHANDLER_H
 
-#include <array>
+#include <vector>
 
 #include "Light.h"
+#include "VBO.h"
+#include "System/type2.h"
 
 namespace Shader {
 	struct IProgramObject;
 }
 
 namespace GL {
+	/**
+	 * Without a light-grid, up to MAX_LIGHTS lights are uploaded as uniforms
+	 * and every fragment loops over all of them.
+	 *
+	 * With a light-grid (cfgMaxGridLights > 0), up to MAX_GRID_LIGHTS lights
+	 * are kept in a texture-buffer and binned each Update into a world-space
+	 * grid of LIGHT_GRID_SIZE^2 columns over the map, stored in a second one
+	 * as {the NUM_GRID_TILES + 1 offsets of each tile's range, light-indices}.
+	 * Fragments only visit the lights whose radius overlaps their column, so
+	 * the cost scales with the local light density instead of the count.
+	 */
 	struct LightHandler {
 	public:
-		void Init(unsigned int cfgMaxLights);
+		void Init(unsigned int cfgMaxLights, unsigned int cfgMaxGridLights = 0);
+		void Kill();
 		void Update();
 
 		unsigned int AddLight(const GL::Light&);
@@ -31,8 +45,30 @@ namespace GL {
 		static constexpr unsigned int MaxUniformVecs()       { return (MaxConfigLights() * (sizeof(RawLight) / sizeof(float4))); }
 		                 unsigned int NumUniformVecs() const { return (NumConfigLights() * (sizeof(RawLight) / sizeof(float4))); }
 
+		static constexpr unsigned int MaxGridLights() { return MAX_GRID_LIGHTS; }
+		static constexpr unsigned int LightGridSize() { return LIGHT_GRID_SIZE; }
+
+		bool UseLightGrid() const { return (gridTextureIDs[0] != 0); }
+
+		// world-space xz to grid-column scale, the shader's lightGridScale
+		const float* GetLightGridScale() const { return &gridScale.x; }
+
+		// binds the light-data buffer to <texUnit> and the grid to <texUnit> + 1
+		void BindLightGrid(unsigned int texUnit) const;
+		void UnbindLightGrid(unsigned int texUnit) const;
+
+	private:
+		void UpdateLightGrid();
+
 	private:
 		static constexpr unsigned int MAX_LIGHTS = 32;
+		static constexpr unsigned int MAX_GRID_LIGHTS = 4096;
+
+		static constexpr unsigned int LIGHT_GRID_SIZE = 64;
+		static constexpr unsigned int NUM_GRID_TILES = LIGHT_GRID_SIZE * LIGHT_GRID_SIZE;
+		// keeps the grid within the minimum GL_MAX_TEXTURE_BUFFER_SIZE (64K texels);
+		// lights covering more tiles than remain in the index-list are not binned
+		static constexpr unsigned int MAX_GRID_INDICES = (1 << 16) - (NUM_GRID_TILES + 1);
 
 		struct RawLight {
 			float4 worldPos;
@@ -43,11 +79,30 @@ namespace GL {
 			float4 fovRadius;
 		};
 
-		std::array<GL::Light, MAX_LIGHTS> glLights;
-		std::array<RawLight, MAX_LIGHTS> rawLights;
+		struct GridRect {
+			unsigned int lightIndex;
+			unsigned int x1, z1;
+			unsigned int x2, z2;
+		};
+
+		// sized once by Init; lights are referenced by death-dependencies
+		std::vector<GL::Light> glLights;
+		std::vector<RawLight> rawLights;
+
+		std::vector<GridRect> gridRects;
+		std::vector<unsigned int> gridData;
+
+		VBO lightDataBuffer;
+		VBO lightGridBuffer;
+
+		// {light-data, grid}
+		unsigned int gridTextureIDs[2] = {0, 0};
+
+		float2 gridScale;
 
 		unsigned int maxLights = 0;
 		unsigned int lightHandle = 0;
+		unsigned int gridUpdateFrame = -1u;
 	};
 }
 
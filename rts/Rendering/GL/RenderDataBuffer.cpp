@@ -7,6 +7,7 @@
 #include "RenderDataBuffer.hpp"
 #include "Rendering/Fonts/glFont.h"
 #include "Rendering/Shaders/ShaderHandler.h"
+#include "System/TimeProfiler.h"
 
 
 // global general-purpose buffers
@@ -129,9 +130,45 @@ void GL::KillRenderBuffers() {
 	}
 }
 
+template<typename T> static std::uint64_t GetNumFrameBytes(const T& buffer) {
+	return (buffer.SumElems() * sizeof(typename T::VertexArrayType) + buffer.SumIndcs() * sizeof(typename T::IndexArrayType));
+}
+
+template<typename T> static std::uint64_t GetNumFrameSubmits(const T& buffer) {
+	return (buffer.NumSubmits(false) + buffer.NumSubmits(true));
+}
+
+static void UpdateRenderBufferStats() {
+	// bytes written into and draw-calls made from each typed buffer this frame; most
+	// are shared by many producers, but FC,T4,TN and L only serve a single subsystem
+	#define SET_RBUFFER_COUNTERS(T)                                                                                         \
+		do {                                                                                                                \
+			profiler.SetCounter("Draw::RenderBuffers::" #T "::BytesPerFrame"  , GetNumFrameBytes  (tRenderBuffer ## T[0])); \
+			profiler.SetCounter("Draw::RenderBuffers::" #T "::SubmitsPerFrame", GetNumFrameSubmits(tRenderBuffer ## T[0])); \
+		} while (false)
+
+	SET_RBUFFER_COUNTERS( 0);
+	SET_RBUFFER_COUNTERS( C);
+	SET_RBUFFER_COUNTERS(FC);
+	SET_RBUFFER_COUNTERS( T);
+
+	SET_RBUFFER_COUNTERS(T4);
+	SET_RBUFFER_COUNTERS(TN);
+	SET_RBUFFER_COUNTERS(TC);
+
+	SET_RBUFFER_COUNTERS(2D0);
+	SET_RBUFFER_COUNTERS(2DT);
+
+	SET_RBUFFER_COUNTERS(L);
+
+	#undef SET_RBUFFER_COUNTERS
+}
+
 void GL::SwapRenderBuffers() {
 	static_assert(GL::NUM_RENDER_BUFFERS == 2 || GL::NUM_RENDER_BUFFERS == 3, "");
 
+	UpdateRenderBufferStats();
+
 	#if (SYNC_RENDER_BUFFERS == 1)
 	{
 		tRenderBuffer0 [0].Sync();
@@ -440,6 +477,20 @@ void GL::RenderDataBuffer::SubmitInstanced(uint32_t primType, uint32_t dataIndx,
 	array.Unbind();
 }
 
+void GL::RenderDataBuffer::SubmitMulti(uint32_t primType, const int32_t* dataIndcs, const int32_t* dataSizes, uint32_t numDraws) const {
+	assert(elems.GetSize() != 0);
+
+	if (numDraws == 0)
+		return;
+
+	array.Bind();
+
+	// one (first, count) pair per sub-draw, see Submit
+	glMultiDrawArrays(primType, dataIndcs, dataSizes, numDraws);
+
+	array.Unbind();
+}
+
 
 void GL::RenderDataBuffer::SubmitIndexed(uint32_t primType, uint32_t dataIndx, uint32_t dataSize) const {
 	assert(elems.GetSize() != 0);
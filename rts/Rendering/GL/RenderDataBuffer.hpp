@@ -325,6 +325,7 @@ namespace GL {
 
 		void Submit(uint32_t primType, uint32_t dataIndx, uint32_t dataSize) const;
 		void SubmitInstanced(uint32_t primType, uint32_t dataIndx, uint32_t dataSize, uint32_t numInsts) const;
+		void SubmitMulti(uint32_t primType, const int32_t* dataIndcs, const int32_t* dataSizes, uint32_t numDraws) const;
 		void SubmitIndexed(uint32_t primType, uint32_t dataIndx, uint32_t dataSize) const;
 		void SubmitIndexedInstanced(uint32_t primType, uint32_t dataIndx, uint32_t dataSize, uint32_t numInsts) const;
 		void Upload(
@@ -480,6 +481,9 @@ namespace GL {
 		bool SafeAppend(const VertexArrayType* e, size_t ne) { return false; }
 		bool SafeAppend(const  IndexArrayType* i, size_t ni) { return false; }
 
+		VertexArrayType* ReserveElems(size_t ne) { return nullptr; }
+		 IndexArrayType* ReserveIndcs(size_t ni) { return nullptr; }
+
 
 		void Submit(uint32_t primType, uint32_t dataIndx, uint32_t dataSize) const {}
 		void Submit(uint32_t primType) {}
@@ -673,6 +677,15 @@ namespace GL {
 			return (Append(i, ni), true);
 		}
 
+		// claims the next <ne> elements as if appended, with a single size-check;
+		// the caller fills the returned range before the next Submit and gets a
+		// nullptr if there is not enough space left
+		VertexArrayType* ReserveElems(size_t ne) {
+			if (elemsMap == nullptr || !CheckSizeE(ne, curElemPos))
+				return nullptr;
+			return (&elemsMap[(curElemPos += ne) - ne]);
+		}
+
 
 		void Submit(uint32_t primType, uint32_t dataIndx, uint32_t dataSize) const { rawBuffer->Submit(primType, dataIndx, dataSize); }
 		void Submit(uint32_t primType) {
@@ -0,0 +1,93 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "TimerQueries.h"
+#include "Rendering/GL/myGL.h"
+
+namespace GL {
+	static constexpr unsigned int MAX_TIMERS_PER_FRAME = 32;
+	static constexpr unsigned int NUM_QUERY_SETS = 2;
+
+	// {begin, end} timestamp pairs per timer, one set per frame-parity
+	static GLuint queryIDs[NUM_QUERY_SETS][MAX_TIMERS_PER_FRAME * 2];
+	static unsigned int nameHashes[NUM_QUERY_SETS][MAX_TIMERS_PER_FRAME];
+	static unsigned int numTimers[NUM_QUERY_SETS] = {0, 0};
+
+	static unsigned int querySet = 0;
+
+	static bool initialized = false;
+	static bool active = false;
+
+
+	ScopedGPUTimer::ScopedGPUTimer(unsigned int nameHash): timerIdx(-1u)
+	{
+		if (!active)
+			return;
+		if (numTimers[querySet] >= MAX_TIMERS_PER_FRAME)
+			return;
+
+		timerIdx = numTimers[querySet]++;
+		nameHashes[querySet][timerIdx] = nameHash;
+
+		glQueryCounter(queryIDs[querySet][timerIdx * 2 + 0], GL_TIMESTAMP);
+	}
+
+	ScopedGPUTimer::~ScopedGPUTimer()
+	{
+		if (timerIdx == -1u)
+			return;
+
+		glQueryCounter(queryIDs[querySet][timerIdx * 2 + 1], GL_TIMESTAMP);
+	}
+
+
+	void InitTimerQueries()
+	{
+		glGenQueries(NUM_QUERY_SETS * MAX_TIMERS_PER_FRAME * 2, &queryIDs[0][0]);
+
+		numTimers[0] = 0;
+		numTimers[1] = 0;
+		initialized = true;
+	}
+
+	void KillTimerQueries()
+	{
+		if (!initialized)
+			return;
+
+		glDeleteQueries(NUM_QUERY_SETS * MAX_TIMERS_PER_FRAME * 2, &queryIDs[0][0]);
+
+		initialized = false;
+		active = false;
+	}
+
+	void UpdateTimerQueries()
+	{
+		if (!initialized)
+			return;
+
+		querySet = (querySet + 1) % NUM_QUERY_SETS;
+
+		// the set about to be reused was written two frames ago; results that
+		// are still not available are dropped rather than waited for
+		for (unsigned int i = 0, n = numTimers[querySet]; i < n; i++) {
+			GLint available = 0;
+			GLuint64 t0 = 0;
+			GLuint64 t1 = 0;
+
+			glGetQueryObjectiv(queryIDs[querySet][i * 2 + 1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+			if (available == 0)
+				continue;
+
+			glGetQueryObjectui64v(queryIDs[querySet][i * 2 + 0], GL_QUERY_RESULT, &t0);
+			glGetQueryObjectui64v(queryIDs[querySet][i * 2 + 1], GL_QUERY_RESULT, &t1);
+
+			const spring_time dt = spring_time::fromNanoSecs(t1 - t0);
+
+			profiler.AddTime(nameHashes[querySet][i], spring_gettime() - dt, dt);
+		}
+
+		numTimers[querySet] = 0;
+		active = (profiler.IsEnabled() || profiler.IsCapturing());
+	}
+}
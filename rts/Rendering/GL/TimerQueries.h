@@ -0,0 +1,37 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef GL_TIMER_QUERIES_H
+#define GL_TIMER_QUERIES_H
+
+#include "System/TimeProfiler.h"
+
+// GPU-side counterpart of SCOPED_TIMER, only active while the profiler is
+// enabled or capturing; a pass is recorded as profiler timer "<name>::GPU"
+// so it sorts right below the CPU timer of the same name
+// NB: names are assumed to be compile-time literals
+#define SCOPED_GL_TIMER(name)  static TimerNameRegistrar __gtnr(name "::GPU"); GL::ScopedGPUTimer __scopedGPUTimer(hashString(name "::GPU"));
+
+
+namespace GL {
+	/**
+	 * @brief GPU pass timing via GL_TIMESTAMP queries
+	 * Writes a timestamp at construction and one at destruction; results are
+	 * collected two frames later (the query pool is double-buffered) so that
+	 * reading them never stalls the pipeline.
+	 */
+	class ScopedGPUTimer {
+	public:
+		ScopedGPUTimer(unsigned int nameHash);
+		~ScopedGPUTimer();
+
+	private:
+		unsigned int timerIdx;
+	};
+
+	void InitTimerQueries();
+	void KillTimerQueries();
+	/// called once per frame before any pass is timed
+	void UpdateTimerQueries();
+}
+
+#endif // GL_TIMER_QUERIES_H
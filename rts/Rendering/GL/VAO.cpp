@@ -4,7 +4,7 @@
 #include "Rendering/GL/myGL.h"
 
 void VAO::Generate() { glGenVertexArrays(1, &id); }
-void VAO::Delete() { glDeleteVertexArrays(1, &id); id = 0; }
-void VAO::Bind() const { glBindVertexArray(id); }
-void VAO::Unbind() const { glBindVertexArray(0); }
+void VAO::Delete() { glAttribStatePtr->DeleteVertexArrays(1, &id); id = 0; }
+void VAO::Bind() const { glAttribStatePtr->BindVertexArray(id); }
+void VAO::Unbind() const { glAttribStatePtr->BindVertexArray(0); }
 
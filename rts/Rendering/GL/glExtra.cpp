@@ -504,7 +504,7 @@ void gleGenMeshBuffers(unsigned int* meshData) {
 	{
 		// VAO
 		glGenVertexArrays(1, &meshData[2]);
-		glBindVertexArray(meshData[2]);
+		glAttribStatePtr->BindVertexArray(meshData[2]);
 	}
 	{
 		// VBO
@@ -533,7 +533,7 @@ void gleGenMeshBuffers(unsigned int* meshData) {
 	{
 		glEnableVertexAttribArray(0);
 		glVertexAttribPointer(0,  3, GL_FLOAT,  false,  sizeof(float3), nullptr);
-		glBindVertexArray(0);
+		glAttribStatePtr->BindVertexArray(0);
 		glDisableVertexAttribArray(0);
 
 		glBindBuffer(GL_ARRAY_BUFFER, 0);
@@ -551,7 +551,7 @@ void gleGenMeshBuffers(unsigned int* meshData) {
 void gleDelMeshBuffers(unsigned int* meshData) {
 	glDeleteBuffers(1, &meshData[0]);
 	glDeleteBuffers(1, &meshData[1]);
-	glDeleteVertexArrays(1, &meshData[2]);
+	glAttribStatePtr->DeleteVertexArrays(1, &meshData[2]);
 
 	meshData[0] = 0;
 	meshData[1] = 0;
@@ -561,9 +561,9 @@ void gleDelMeshBuffers(unsigned int* meshData) {
 
 void gleBindMeshBuffers(const unsigned int* meshData) {
 	if (meshData != nullptr) {
-		glBindVertexArray(meshData[2]);
+		glAttribStatePtr->BindVertexArray(meshData[2]);
 	} else {
-		glBindVertexArray(0);
+		glAttribStatePtr->BindVertexArray(0);
 	}
 }
 
@@ -9,6 +9,7 @@
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
+#include "Rendering/GL/TimerQueries.h"
 #include "System/bitops.h"
 #include "System/EventHandler.h"
 #include "System/SafeUtil.h"
@@ -250,6 +251,7 @@ CGlobalRendering::~CGlobalRendering()
 	// protect against aborted startup
 	if (glContexts[0] != nullptr) {
 		GL::KillRenderBuffers();
+		GL::KillTimerQueries();
 		glDeleteQueries(NUM_OPENGL_TIMER_QUERIES * 2, &glTimerQueries[0]);
 	}
 
@@ -544,6 +546,7 @@ void CGlobalRendering::PostInit() {
 	ToggleGLDebugOutput(0, 0, 0);
 
 	GL::InitRenderBuffers();
+	GL::InitTimerQueries();
 	glGenQueries(NUM_OPENGL_TIMER_QUERIES * 2, &glTimerQueries[0]);
 }
 
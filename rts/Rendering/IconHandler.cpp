@@ -7,6 +7,7 @@
 #include <locale>
 #include <cctype>
 #include <cmath>
+#include <cstring>
 
 #include "Rendering/GL/myGL.h"
 #include "System/Log/ILog.h"
@@ -29,10 +30,17 @@ static CIconData dummyIconData[CIconHandler::ICON_DATA_OFFSET];
 void CIconHandler::Kill()
 {
 	glDeleteTextures(1, &defTexID);
+	glDeleteTextures(1, &atlasTexID);
 
 	defTexID = 0;
 	numIcons = 0;
 
+	atlasTexID = 0;
+	numAtlasLayers = 0;
+	numAtlasTexLayers = 0;
+
+	atlasTexels.clear();
+
 	dummyIconData[ SAFETY_DATA_IDX] = {};
 	dummyIconData[DEFAULT_DATA_IDX] = {};
 
@@ -57,7 +65,7 @@ bool CIconHandler::LoadIcons(const std::string& filename)
 	iconTypes.GetKeys(iconNames);
 
 	dummyIconData[ SAFETY_DATA_IDX] = {};
-	dummyIconData[DEFAULT_DATA_IDX] = {"default", GetDefaultTexture(), 1.0f, 1.0f, false, false, DEFAULT_TEX_SIZE_X, DEFAULT_TEX_SIZE_Y};
+	dummyIconData[DEFAULT_DATA_IDX] = {"default", GetDefaultTexture(), 1.0f, 1.0f, false, false, DEFAULT_TEX_SIZE_X, DEFAULT_TEX_SIZE_Y, DEFAULT_ATLAS_LAYER};
 
 	for (const std::string& iconName : iconNames) {
 		const LuaTable iconTable = iconTypes.SubTable(iconName);
@@ -99,6 +107,7 @@ bool CIconHandler::AddIcon(
 	unsigned int texID = 0;
 	unsigned int xsize = 0;
 	unsigned int ysize = 0;
+	unsigned int layer = DEFAULT_ATLAS_LAYER;
 
 	bool ownTexture = true;
 
@@ -106,13 +115,24 @@ bool CIconHandler::AddIcon(
 		CBitmap bitmap;
 
 		if ((ownTexture = !texName.empty() && bitmap.Load(texName))) {
-			texID = bitmap.CreateMipMapTexture();
+			texID = bitmap.CreateCompressedTexture(0.0f, 0.0f, true);
 			
 			glBindTexture(GL_TEXTURE_2D, texID);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 			xsize = bitmap.xsize;
 			ysize = bitmap.ysize;
+
+			if (bitmap.compressed) {
+				// atlas layers are rescaled on the CPU, read back the decoded texels
+				CBitmap decoded;
+				decoded.Alloc(xsize, ysize, 4);
+				glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, decoded.GetRawMem());
+
+				layer = AddAtlasLayer(decoded);
+			} else {
+				layer = AddAtlasLayer(bitmap);
+			}
 		} else {
 			texID = GetDefaultTexture();
 			xsize = DEFAULT_TEX_SIZE_X;
@@ -130,7 +150,7 @@ bool CIconHandler::AddIcon(
 		FreeIcon(iconName);
 
 	// data must be constructed first since CIcon's ctor will Ref() it
-	iconData[numIcons] = {iconName, texID,  size, distance, radAdj, ownTexture, xsize, ysize};
+	iconData[numIcons] = {iconName, texID,  size, distance, radAdj, ownTexture, xsize, ysize, layer};
 	// indices 0 and 1 are reserved
 	iconMap[iconName] = CIcon(ICON_DATA_OFFSET + numIcons++);
 
@@ -209,10 +229,58 @@ unsigned int CIconHandler::GetDefaultTexture()
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
 	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
 
+	// the default texture is always created first
+	assert(numAtlasLayers == DEFAULT_ATLAS_LAYER);
+	AddAtlasLayer(bitmap);
+
 	return defTexID;
 }
 
 
+unsigned int CIconHandler::AddAtlasLayer(const CBitmap& bitmap)
+{
+	#ifndef HEADLESS
+	constexpr size_t layerSize = ATLAS_TEX_SIZE * ATLAS_TEX_SIZE * 4;
+
+	const CBitmap scaled = bitmap.CreateRescaled(ATLAS_TEX_SIZE, ATLAS_TEX_SIZE);
+
+	atlasTexels.resize((numAtlasLayers + 1) * layerSize);
+	std::memcpy(&atlasTexels[numAtlasLayers * layerSize], scaled.GetRawMem(), layerSize);
+
+	return (numAtlasLayers++);
+	#else
+	return DEFAULT_ATLAS_LAYER;
+	#endif
+}
+
+void CIconHandler::BindAtlasTexture()
+{
+	if (numAtlasLayers != numAtlasTexLayers) {
+		// icons were added since the last upload; the storage is immutable
+		// so the texture is recreated, which happens at most once per AddIcon
+		glDeleteTextures(1, &atlasTexID);
+		glGenTextures(1, &atlasTexID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, atlasTexID);
+
+		const int numLevels = 1 + std::log2(ATLAS_TEX_SIZE * 1.0f);
+
+		glTexStorage3D(GL_TEXTURE_2D_ARRAY, numLevels, GL_RGBA8, ATLAS_TEX_SIZE, ATLAS_TEX_SIZE, numAtlasLayers);
+		glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, 0, ATLAS_TEX_SIZE, ATLAS_TEX_SIZE, numAtlasLayers, GL_RGBA, GL_UNSIGNED_BYTE, atlasTexels.data());
+		glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+		numAtlasTexLayers = numAtlasLayers;
+		return;
+	}
+
+	glBindTexture(GL_TEXTURE_2D_ARRAY, atlasTexID);
+}
+
+
 
 /******************************************************************************/
 //
@@ -293,7 +361,8 @@ CIconData::CIconData(
 	bool radAdj,
 	bool ownTex,
 	unsigned int _xsize,
-	unsigned int _ysize
+	unsigned int _ysize,
+	unsigned int _atlasLayer
 )
 	: name(_name)
 	, refCount(0)
@@ -302,6 +371,8 @@ CIconData::CIconData(
 	, xsize(_xsize)
 	, ysize(_ysize)
 
+	, atlasLayer(_atlasLayer)
+
 	, size(_size)
 	, distance(_distance)
 	, distSqr(distance * distance)
@@ -334,6 +405,7 @@ void CIconData::CopyData(const CIconData* iconData)
 	radiusAdjust = iconData->radiusAdjust;
 	xsize        = iconData->xsize;
 	ysize        = iconData->ysize;
+	atlasLayer   = iconData->atlasLayer;
 	ownTexture   = false;
 }
 
@@ -5,11 +5,14 @@
 
 #include <array>
 #include <string>
+#include <vector>
 
 #include "Icon.h"
 #include "System/float3.h"
 #include "System/UnorderedMap.hpp"
 
+class CBitmap;
+
 namespace icon {
 	class CIconData {
 		public:
@@ -23,7 +26,8 @@ namespace icon {
 				bool radiusAdjust,
 				bool ownTexture,
 				unsigned int xsize,
-				unsigned int ysize
+				unsigned int ysize,
+				unsigned int atlasLayer
 			);
 			~CIconData();
 
@@ -36,6 +40,8 @@ namespace icon {
 				xsize = id.xsize;
 				ysize = id.ysize;
 
+				atlasLayer = id.atlasLayer;
+
 				size = id.size;
 				distance = id.distance;
 				distSqr = id.distSqr;
@@ -68,6 +74,8 @@ namespace icon {
 			unsigned int GetTextureID()    const { return texID;        }
 			int          GetSizeX()        const { return xsize;        }
 			int          GetSizeY()        const { return ysize;        }
+			// layer of CIconHandler's atlas holding a copy of the texture
+			unsigned int GetAtlasLayer()   const { return atlasLayer;   }
 
 			float        GetSize()         const { return size;         }
 			float        GetDistance()     const { return distance;     }
@@ -84,6 +92,8 @@ namespace icon {
 			int xsize = 1;
 			int ysize = 1;
 
+			unsigned int atlasLayer = 0;
+
 			float size = 1.0f;
 			float distance = 1.0f;
 			float distSqr = 1.0f;
@@ -120,6 +130,10 @@ namespace icon {
 			static const CIconData* GetSafetyIconData();
 			static const CIconData* GetDefaultIconData();
 
+			// binds the GL_TEXTURE_2D_ARRAY holding every icon texture (one
+			// layer each) to the active unit, re-uploading it after changes
+			void BindAtlasTexture();
+
 		private:
 			CIconData* GetIconDataMut(unsigned int idx) { return (const_cast<CIconData*>(GetIconData(idx))); }
 
@@ -135,6 +149,7 @@ namespace icon {
 
 			bool LoadIcons(const std::string& filename);
 			unsigned int GetDefaultTexture();
+			unsigned int AddAtlasLayer(const CBitmap& bitmap);
 
 		public:
 			static constexpr unsigned int  SAFETY_DATA_IDX = 0;
@@ -144,10 +159,21 @@ namespace icon {
 			static constexpr unsigned int DEFAULT_TEX_SIZE_X = 128;
 			static constexpr unsigned int DEFAULT_TEX_SIZE_Y = 128;
 
+			// icon textures are rescaled to this size when copied into the atlas
+			static constexpr unsigned int ATLAS_TEX_SIZE = 128;
+			static constexpr unsigned int DEFAULT_ATLAS_LAYER = 0;
+
 		private:
 			unsigned int defTexID = 0;
 			unsigned int numIcons = 0;
 
+			unsigned int atlasTexID = 0;
+			unsigned int numAtlasLayers = 0;
+			unsigned int numAtlasTexLayers = 0;
+
+			// RGBA8 texels of all atlas layers, kept to rebuild the texture
+			std::vector<uint8_t> atlasTexels;
+
 			spring::unordered_map<std::string, CIcon> iconMap;
 			std::array<CIconData, 2048> iconData;
 	};
@@ -128,32 +128,37 @@ void InMapDraw_QuadDrawer::DrawPoint(const CInMapDrawModel::MapPoint* point, GL:
 	const float3 pos1(pos.x,  pos.y  +   5.0f, pos.z);
 	const float3 pos2(pos1.x, pos1.y + 100.0f, pos1.z);
 
-	{
-		buffer->SafeAppend({pos1 - xdir * size,               0.25f, 0.0f, color}); // tl
-		buffer->SafeAppend({pos1 + xdir * size,               0.25f, 1.0f, color}); // tr
-		buffer->SafeAppend({pos1 + xdir * size + ydir * size, 0.00f, 1.0f, color}); // br
-
-		buffer->SafeAppend({pos1 + xdir * size + ydir * size, 0.00f, 1.0f, color}); // br
-		buffer->SafeAppend({pos1 - xdir * size + ydir * size, 0.00f, 0.0f, color}); // bl
-		buffer->SafeAppend({pos1 - xdir * size,               0.25f, 0.0f, color}); // tl
-	}
-	{
-		buffer->SafeAppend({pos1 - xdir * size,               0.75f, 0.0f, color});
-		buffer->SafeAppend({pos1 + xdir * size,               0.75f, 1.0f, color});
-		buffer->SafeAppend({pos2 + xdir * size,               0.75f, 1.0f, color});
-
-		buffer->SafeAppend({pos2 + xdir * size,               0.75f, 1.0f, color});
-		buffer->SafeAppend({pos2 - xdir * size,               0.75f, 0.0f, color});
-		buffer->SafeAppend({pos1 - xdir * size,               0.75f, 0.0f, color});
-	}
-	{
-		buffer->SafeAppend({pos2 - xdir * size,               0.25f, 0.0f, color});
-		buffer->SafeAppend({pos2 + xdir * size,               0.25f, 1.0f, color});
-		buffer->SafeAppend({pos2 + xdir * size - ydir * size, 0.00f, 1.0f, color});
-
-		buffer->SafeAppend({pos2 + xdir * size - ydir * size, 0.00f, 1.0f, color});
-		buffer->SafeAppend({pos2 - xdir * size - ydir * size, 0.00f, 0.0f, color});
-		buffer->SafeAppend({pos2 - xdir * size,               0.25f, 0.0f, color});
+	// one range for the whole marker instead of a size-check per vertex
+	GL::RenderDataBufferTC::VertexArrayType* verts = buffer->ReserveElems(18);
+
+	if (verts != nullptr) {
+		{
+			verts[ 0] = {pos1 - xdir * size,               0.25f, 0.0f, color}; // tl
+			verts[ 1] = {pos1 + xdir * size,               0.25f, 1.0f, color}; // tr
+			verts[ 2] = {pos1 + xdir * size + ydir * size, 0.00f, 1.0f, color}; // br
+
+			verts[ 3] = {pos1 + xdir * size + ydir * size, 0.00f, 1.0f, color}; // br
+			verts[ 4] = {pos1 - xdir * size + ydir * size, 0.00f, 0.0f, color}; // bl
+			verts[ 5] = {pos1 - xdir * size,               0.25f, 0.0f, color}; // tl
+		}
+		{
+			verts[ 6] = {pos1 - xdir * size,               0.75f, 0.0f, color};
+			verts[ 7] = {pos1 + xdir * size,               0.75f, 1.0f, color};
+			verts[ 8] = {pos2 + xdir * size,               0.75f, 1.0f, color};
+
+			verts[ 9] = {pos2 + xdir * size,               0.75f, 1.0f, color};
+			verts[10] = {pos2 - xdir * size,               0.75f, 0.0f, color};
+			verts[11] = {pos1 - xdir * size,               0.75f, 0.0f, color};
+		}
+		{
+			verts[12] = {pos2 - xdir * size,               0.25f, 0.0f, color};
+			verts[13] = {pos2 + xdir * size,               0.25f, 1.0f, color};
+			verts[14] = {pos2 + xdir * size - ydir * size, 0.00f, 1.0f, color};
+
+			verts[15] = {pos2 + xdir * size - ydir * size, 0.00f, 1.0f, color};
+			verts[16] = {pos2 - xdir * size - ydir * size, 0.00f, 0.0f, color};
+			verts[17] = {pos2 - xdir * size,               0.25f, 0.0f, color};
+		}
 	}
 
 	if (point->GetLabel().empty())
@@ -42,6 +42,20 @@ void CLineDrawer::SetupLineStipple()
 void CLineDrawer::Restart()
 {
 	const int idx = width * 2 + useColorRestarts;
+
+	if (recordedPath != nullptr) {
+		Line& line = spring::VectorEmplaceBack(recordedPath->lines);
+
+		if (useColorRestarts)
+			return;
+
+		if (atPathStart)
+			recordedPath->startLine = recordedPath->lines.size() - 1;
+
+		line.push_back({lastPos, lastColor});
+		return;
+	}
+
 	Line& line = spring::VectorEmplaceBack(lineStipple? stippleLines[idx]: regularLines[idx]);
 
 	if (useColorRestarts)
@@ -51,6 +65,28 @@ void CLineDrawer::Restart()
 }
 
 
+void CLineDrawer::StartRecording(Path* path)
+{
+	path->Clear();
+	path->lineIdx = width * 2 + useColorRestarts;
+	path->lineStipple = lineStipple;
+
+	recordedPath = path;
+}
+
+void CLineDrawer::DrawPath(Path& path, const float3& startPos)
+{
+	if (path.startLine >= 0)
+		path.lines[path.startLine][0].p = startPos;
+
+	for (const Path::Icon& icon: path.icons) {
+		cursorIcons.AddIcon(icon.cmdID, icon.atStart? startPos: icon.pos);
+	}
+
+	queuedPaths.push_back(&path);
+}
+
+
 void CLineDrawer::DrawAll(bool onMiniMap)
 {
 	if (!HaveRegularLines() && !HaveStippleLines())
@@ -70,7 +106,9 @@ void CLineDrawer::DrawAll(bool onMiniMap)
 	const int yScale = onMiniMap? minimap->GetSizeY(): globalRendering->viewSizeY;
 	wla->Setup(buffer, xScale, yScale, onMiniMap? 2.5f : 1.0f, projMat * viewMat, onMiniMap);
 
-	const auto DrawLines = [&](const std::vector<Line>& lines, unsigned int glType) {
+	const auto DrawLines = [&](int idx, bool stipple) {
+		const std::vector<Line>& lines = stipple? stippleLines[idx]: regularLines[idx];
+
 		for (const auto& line: lines) {
 			if (line.empty())
 				continue;
@@ -78,30 +116,42 @@ void CLineDrawer::DrawAll(bool onMiniMap)
 			wla->SafeAppend(line.data(), line.size());
 		}
 
-		wla->Submit(glType);
+		for (const Path* path: queuedPaths) {
+			if (path->lineIdx != idx || path->lineStipple != stipple)
+				continue;
+
+			for (const auto& line: path->lines) {
+				if (line.empty())
+					continue;
+
+				wla->SafeAppend(line.data(), line.size());
+			}
+		}
+
+		wla->Submit((idx & 1)? GL_LINES: GL_LINE_LOOP);
 	};
 
 	shader->Enable();
 	shader->SetUniformMatrix4x4<float>("u_proj_mat", false, projMat);
 	shader->SetUniformMatrix4x4<float>("u_movi_mat", false, viewMat);
 
-	DrawLines(regularLines[0], GL_LINE_LOOP);
-	DrawLines(regularLines[1], GL_LINES    );
+	DrawLines(0, false);
+	DrawLines(1, false);
 	// [deprecated]
 	// glAttribStatePtr->Enable(GL_LINE_STIPPLE);
-	DrawLines(stippleLines[0], GL_LINE_LOOP);
-	DrawLines(stippleLines[1], GL_LINES    );
+	DrawLines(0, true);
+	DrawLines(1, true);
 	// glAttribStatePtr->Disable(GL_LINE_STIPPLE);
 
 	if (!onMiniMap)
 		wla->SetWidth(cmdColors.QueuedLineWidth());
 
-	DrawLines(regularLines[2], GL_LINE_LOOP);
-	DrawLines(regularLines[3], GL_LINES    );
+	DrawLines(2, false);
+	DrawLines(3, false);
 	// [deprecated]
 	// glAttribStatePtr->Enable(GL_LINE_STIPPLE);
-	DrawLines(stippleLines[2], GL_LINE_LOOP);
-	DrawLines(stippleLines[3], GL_LINES    );
+	DrawLines(2, true);
+	DrawLines(3, true);
 	// glAttribStatePtr->Disable(GL_LINE_STIPPLE);
 
 	shader->Disable();
@@ -111,5 +161,7 @@ void CLineDrawer::DrawAll(bool onMiniMap)
 		regularLines[i].clear();
 		stippleLines[i].clear();
 	}
+
+	queuedPaths.clear();
 }
 
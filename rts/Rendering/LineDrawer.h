@@ -3,6 +3,7 @@
 #ifndef _LINE_DRAWER_H
 #define _LINE_DRAWER_H
 
+#include <array>
 #include <vector>
 
 #include "Game/UI/CursorIcons.h"
@@ -10,6 +11,35 @@
 #include "System/Color.h"
 
 class CLineDrawer {
+public:
+	typedef std::vector<VA_TYPE_C> Line;
+
+	// lines and icons of one path as recorded between {Start,End}Recording
+	struct Path {
+		struct Icon {
+			int cmdID;
+			float3 pos;
+			// true if placed at the path's start, which moves with its owner
+			bool atStart;
+		};
+
+		void Clear() {
+			lines.clear();
+			icons.clear();
+
+			startLine = -1;
+		}
+
+		std::vector<Line> lines;
+		std::vector<Icon> icons;
+
+		int lineIdx = 0;
+		// index of the line whose first vertex is the start position, if any
+		int startLine = -1;
+
+		bool lineStipple = false;
+	};
+
 public:
 	CLineDrawer() {
 		for (size_t i = 0; i < regularLines.size(); i++) {
@@ -46,15 +76,30 @@ public:
 	void RestartSameColor() { Restart(); }
 	void RestartWithColor(const float* color);
 
+	/**
+	 * Everything drawn after StartRecording (which must precede StartPath)
+	 * goes into <path> instead of being queued, until EndRecording. The path
+	 * can then be queued by DrawPath any number of times for as long as what
+	 * produced it stays the same; it is referenced rather than copied, so it
+	 * must outlive the next DrawAll.
+	 */
+	void StartRecording(Path* path);
+	void EndRecording() { recordedPath = nullptr; }
+	void DrawPath(Path& path, const float3& startPos);
+	// false if <path> was recorded with a different width or style than is current
+	bool IsPathCompatible(const Path& path) const { return (path.lineIdx == (width * 2 + useColorRestarts) && path.lineStipple == lineStipple); }
+
 	const float3& GetLastPos() const { return lastPos; }
 
-	bool HaveRegularLines() const { for (auto& v: regularLines) { if (!v.empty()) return true; } return false; }
-	bool HaveStippleLines() const { for (auto& v: stippleLines) { if (!v.empty()) return true; } return false; }
+	bool HaveRegularLines() const { for (auto& v: regularLines) { if (!v.empty()) return true; } return (!queuedPaths.empty()); }
+	bool HaveStippleLines() const { for (auto& v: stippleLines) { if (!v.empty()) return true; } return (!queuedPaths.empty()); }
 
 private:
 	bool lineStipple = false;
 	bool useColorRestarts = false;
 	bool useRestartColor = false;
+	// true until the first line-segment or break of a path
+	bool atPathStart = false;
 
 	float restartAlpha = 0.0f;
 	float stippleTimer = 0.0f;
@@ -66,7 +111,7 @@ private:
 	const float* restartColor = nullptr;
 	const float* lastColor = nullptr;
 
-	typedef std::vector<VA_TYPE_C> Line;
+	Path* recordedPath = nullptr;
 
 	// queue all lines and draw them in one go later
 	// even := GL_LINE_LOOP, odd := GL_LINES (useColorRestarts)
@@ -76,6 +121,8 @@ private:
 
 	std::array<std::vector<Line>, 4> regularLines;
 	std::array<std::vector<Line>, 4> stippleLines;
+
+	std::vector<const Path*> queuedPaths;
 };
 
 
@@ -99,6 +146,7 @@ inline void CLineDrawer::Configure(bool ucr, bool urc, const float* rc, float ra
 
 inline void CLineDrawer::Break(const float3& endPos, const float* color)
 {
+	atPathStart = false;
 	lastPos = endPos;
 	lastColor = color;
 }
@@ -113,6 +161,7 @@ inline void CLineDrawer::RestartWithColor(const float *color)
 
 inline void CLineDrawer::StartPath(const float3& pos, const float* color)
 {
+	atPathStart = true;
 	lastPos = pos;
 	lastColor = color;
 	Restart();
@@ -122,15 +171,19 @@ inline void CLineDrawer::StartPath(const float3& pos, const float* color)
 inline void CLineDrawer::DrawLine(const float3& endPos, const float* color)
 {
 	const int idx = width * 2 + useColorRestarts;
-	Line& line = (lineStipple)? stippleLines[idx].back(): regularLines[idx].back();
+	Line& line = (recordedPath != nullptr)? recordedPath->lines.back(): ((lineStipple)? stippleLines[idx].back(): regularLines[idx].back());
 
 	if (!useColorRestarts) {
 		line.push_back({endPos, color});
 	} else {
+		if (atPathStart && recordedPath != nullptr && line.empty())
+			recordedPath->startLine = recordedPath->lines.size() - 1;
+
 		line.push_back({lastPos, useRestartColor? restartColor: SColor{color[0], color[1], color[2], color[3] * restartAlpha}});
 		line.push_back({endPos, color});
 	}
 
+	atPathStart = false;
 	lastPos = endPos;
 	lastColor = color;
 }
@@ -138,13 +191,23 @@ inline void CLineDrawer::DrawLine(const float3& endPos, const float* color)
 
 inline void CLineDrawer::DrawLineAndIcon(int cmdID, const float3& endPos, const float* color)
 {
-	cursorIcons.AddIcon(cmdID, endPos);
+	if (recordedPath != nullptr) {
+		recordedPath->icons.push_back({cmdID, endPos, false});
+	} else {
+		cursorIcons.AddIcon(cmdID, endPos);
+	}
+
 	DrawLine(endPos, color);
 }
 
 
 inline void CLineDrawer::DrawIconAtLastPos(int cmdID)
 {
+	if (recordedPath != nullptr) {
+		recordedPath->icons.push_back({cmdID, lastPos, atPathStart});
+		return;
+	}
+
 	cursorIcons.AddIcon(cmdID, lastPos);
 }
 
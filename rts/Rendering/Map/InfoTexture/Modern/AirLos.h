@@ -29,6 +29,8 @@ private:
 	FBO fbo;
 	GLuint uploadTex;
 	Shader::IProgramObject* shader;
+
+	std::uint64_t numSeenRects = 0;
 };
 
 #endif // _AIRLOS_TEXTURE_H
@@ -3,24 +3,12 @@
 #include "Los.h"
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/GlobalRendering.h"
-#include "Rendering/GL/RenderDataBuffer.hpp"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Sim/Misc/LosHandler.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 
-constexpr VA_TYPE_0 VERTS[] = {
-	{{-1.0f, -1.0f, 0.0f}}, // bl
-	{{-1.0f, +1.0f, 0.0f}}, // tl
-	{{+1.0f, +1.0f, 0.0f}}, // tr
-
-	{{+1.0f, +1.0f, 0.0f}}, // tr
-	{{+1.0f, -1.0f, 0.0f}}, // br
-	{{-1.0f, -1.0f, 0.0f}}, // bl
-};
-
-
 CLosTexture::CLosTexture()
 : CPboInfoTexture("los")
 , uploadTex(0)
@@ -57,8 +45,11 @@ CLosTexture::CLosTexture()
 		layout(location = 1) in vec2 aTexCoords; // ignored
 		out vec2 vTexCoords;
 
+		// {x, y, w, h} of the updated region, the viewport covers only it
+		uniform vec4 texRect;
+
 		void main() {
-			vTexCoords = aVertexPos.xy * 0.5 + 0.5;
+			vTexCoords = texRect.xy + (aVertexPos.xy * 0.5 + 0.5) * texRect.zw;
 			gl_Position = vec4(aVertexPos, 1.0);
 		}
 	)";
@@ -95,6 +86,7 @@ CLosTexture::CLosTexture()
 
 	shader->Enable();
 	shader->SetUniform("tex0", 0);
+	shader->SetUniform("texRect", 0.0f, 0.0f, 1.0f, 1.0f);
 	shader->Disable();
 	shader->Validate();
 
@@ -149,6 +141,8 @@ void CLosTexture::Update()
 	if (!fbo.IsValid() || !shader->IsValid() || uploadTex == 0)
 		return UpdateCPU();
 
+	CheckFullUpdate(gu->myAllyTeam, losHandler->globalLOS[gu->myAllyTeam]);
+
 	if (losHandler->globalLOS[gu->myAllyTeam]) {
 		fbo.Bind();
 		glAttribStatePtr->ViewPort(0, 0, texSize.x, texSize.y);
@@ -163,33 +157,35 @@ void CLosTexture::Update()
 	}
 
 
+	MarkDirtyTiles(losHandler->los, numSeenRects, gu->myAllyTeam);
+
+	if (GetDirtyRuns().empty())
+		return;
+
+
 	infoTexPBO.Bind();
 
 	      uint8_t* infoTexMem = reinterpret_cast<uint8_t*>(infoTexPBO.MapBuffer());
 	const uint16_t* myLos = &losHandler->los.losMaps[gu->myAllyTeam].front();
 
-	memcpy(infoTexMem, myLos, texSize.x * texSize.y * texChannels * sizeof(uint16_t));
+	// only the changed regions are packed and uploaded
+	PackDirtyRuns(infoTexMem, myLos);
 	infoTexPBO.UnmapBuffer();
 
 
 	//Trick: Upload the ushort as 2 ubytes, and then check both for `!=0` in the shader.
 	// Faster than doing it on the CPU! And uploading it as shorts would be slow, cause the GPU
 	// has no native support for them and so the transformation would happen on the CPU, too.
-	glBindTexture(GL_TEXTURE_2D, uploadTex);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	UploadDirtyRuns(uploadTex, 0);
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 
 	// do post-processing on the gpu (los-checking & scaling)
 	fbo.Bind();
-	glAttribStatePtr->ViewPort(0, 0,  texSize.x, texSize.y);
 	glAttribStatePtr->DisableBlendMask();
 
-	GL::RenderDataBuffer0* rdb = GL::GetRenderBuffer0();
-
 	shader->Enable();
-	rdb->SafeAppend(VERTS, sizeof(VERTS) / sizeof(VERTS[0]));
-	rdb->Submit(GL_TRIANGLES);
+	DrawDirtyRuns(shader);
 	shader->Disable();
 
 	glAttribStatePtr->ViewPort(globalRendering->viewPosX, 0,  globalRendering->viewSizeX, globalRendering->viewSizeY);
@@ -1,6 +1,24 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <cstring>
+
 #include "PboInfoTexture.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/RenderDataBuffer.hpp"
+#include "Rendering/Shaders/Shader.h"
+#include "Sim/Misc/LosHandler.h"
+
+constexpr VA_TYPE_0 VERTS[] = {
+	{{-1.0f, -1.0f, 0.0f}}, // bl
+	{{-1.0f, +1.0f, 0.0f}}, // tl
+	{{+1.0f, +1.0f, 0.0f}}, // tr
+
+	{{+1.0f, +1.0f, 0.0f}}, // tr
+	{{+1.0f, -1.0f, 0.0f}}, // br
+	{{-1.0f, -1.0f, 0.0f}}, // bl
+};
+
 
 CPboInfoTexture::~CPboInfoTexture()
 {
@@ -8,3 +26,137 @@ CPboInfoTexture::~CPboInfoTexture()
 	infoTexPBO.Release();
 }
 
+
+bool CPboInfoTexture::CheckFullUpdate(int allyTeam, bool globalLOS)
+{
+	if (allyTeam == prvAllyTeam && globalLOS == prvGlobalLOS)
+		return false;
+
+	prvAllyTeam = allyTeam;
+	prvGlobalLOS = globalLOS;
+
+	MarkAllTilesDirty();
+	return true;
+}
+
+void CPboInfoTexture::MarkDirtyTiles(const ILosType& losType, std::uint64_t& numSeenRects, int allyTeam)
+{
+	const std::uint64_t numRects = losType.GetNumDirtyRects();
+
+	if (dirtyTiles.empty()) {
+		numDirtyTiles.x = (texSize.x + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+		numDirtyTiles.y = (texSize.y + DIRTY_TILE_SIZE - 1) / DIRTY_TILE_SIZE;
+
+		dirtyTiles.resize(numDirtyTiles.x * numDirtyTiles.y, 1);
+	}
+
+	if (numSeenRects > numRects || (numRects - numSeenRects) > ILosType::NUM_DIRTY_RECTS) {
+		numSeenRects = numRects;
+		MarkAllTilesDirty();
+		return;
+	}
+
+	for (; numSeenRects < numRects; numSeenRects++) {
+		const ILosType::DirtyRect& dr = losType.GetDirtyRect(numSeenRects);
+
+		if (dr.allyTeam != allyTeam)
+			continue;
+
+		// the LOS-type resolution need not match the texture's (e.g. radar
+		// changes are also tracked by the los-texture based overlays)
+		const int x1 = ((dr.rect.x1    ) * texSize.x) / (losType.size.x * DIRTY_TILE_SIZE);
+		const int y1 = ((dr.rect.y1    ) * texSize.y) / (losType.size.y * DIRTY_TILE_SIZE);
+		const int x2 = ((dr.rect.x2 - 1) * texSize.x) / (losType.size.x * DIRTY_TILE_SIZE);
+		const int y2 = ((dr.rect.y2 - 1) * texSize.y) / (losType.size.y * DIRTY_TILE_SIZE);
+
+		for (int y = std::max(y1, 0); y <= std::min(y2, numDirtyTiles.y - 1); y++) {
+			for (int x = std::max(x1, 0); x <= std::min(x2, numDirtyTiles.x - 1); x++) {
+				dirtyTiles[y * numDirtyTiles.x + x] = 1;
+			}
+		}
+	}
+}
+
+void CPboInfoTexture::MarkAllTilesDirty()
+{
+	std::fill(dirtyTiles.begin(), dirtyTiles.end(), 1);
+}
+
+
+const std::vector<CPboInfoTexture::DirtyRun>& CPboInfoTexture::GetDirtyRuns()
+{
+	dirtyRuns.clear();
+
+	for (int y = 0; y < numDirtyTiles.y; y++) {
+		for (int x = 0; x < numDirtyTiles.x; ) {
+			if (dirtyTiles[y * numDirtyTiles.x + x] == 0) {
+				x += 1;
+				continue;
+			}
+
+			const int runBeg = x;
+
+			for (; x < numDirtyTiles.x && dirtyTiles[y * numDirtyTiles.x + x] != 0; x++) {
+				dirtyTiles[y * numDirtyTiles.x + x] = 0;
+			}
+
+			DirtyRun run;
+			run.x = runBeg * DIRTY_TILE_SIZE;
+			run.y = y * DIRTY_TILE_SIZE;
+			run.w = std::min(x * DIRTY_TILE_SIZE, texSize.x) - run.x;
+			run.h = std::min(run.y + DIRTY_TILE_SIZE, texSize.y) - run.y;
+
+			// extend the previous row's run if it covers the same columns
+			if (!dirtyRuns.empty()) {
+				DirtyRun& prv = dirtyRuns.back();
+
+				if (prv.x == run.x && prv.w == run.w && (prv.y + prv.h) == run.y) {
+					prv.h += run.h;
+					continue;
+				}
+			}
+
+			dirtyRuns.push_back(run);
+		}
+	}
+
+	return dirtyRuns;
+}
+
+
+size_t CPboInfoTexture::PackDirtyRuns(std::uint8_t* dst, const std::uint16_t* src) const
+{
+	size_t numBytes = 0;
+
+	for (const DirtyRun& run: dirtyRuns) {
+		for (int y = run.y; y < (run.y + run.h); y++) {
+			std::memcpy(dst + numBytes, &src[y * texSize.x + run.x], run.w * sizeof(std::uint16_t));
+			numBytes += (run.w * sizeof(std::uint16_t));
+		}
+	}
+
+	return numBytes;
+}
+
+void CPboInfoTexture::UploadDirtyRuns(unsigned int tex, size_t pboOffset) const
+{
+	glBindTexture(GL_TEXTURE_2D, tex);
+
+	for (const DirtyRun& run: dirtyRuns) {
+		glTexSubImage2D(GL_TEXTURE_2D, 0, run.x, run.y, run.w, run.h, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr(pboOffset));
+		pboOffset += (run.w * run.h * sizeof(std::uint16_t));
+	}
+}
+
+void CPboInfoTexture::DrawDirtyRuns(Shader::IProgramObject* shader) const
+{
+	GL::RenderDataBuffer0* rdb = GL::GetRenderBuffer0();
+
+	for (const DirtyRun& run: dirtyRuns) {
+		glAttribStatePtr->ViewPort(run.x, run.y, run.w, run.h);
+
+		shader->SetUniform("texRect", run.x * 1.0f / texSize.x, run.y * 1.0f / texSize.y, run.w * 1.0f / texSize.x, run.h * 1.0f / texSize.y);
+		rdb->SafeAppend(VERTS, sizeof(VERTS) / sizeof(VERTS[0]));
+		rdb->Submit(GL_TRIANGLES);
+	}
+}
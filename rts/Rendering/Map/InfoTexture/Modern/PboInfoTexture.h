@@ -3,11 +3,18 @@
 #ifndef _PBO_INFO_TEXTURE_H
 #define _PBO_INFO_TEXTURE_H
 
+#include <cinttypes>
+#include <vector>
+
 #include "Rendering/Map/InfoTexture/InfoTexture.h"
 #include "Rendering/GL/PBO.h"
 
 
+namespace Shader {
+	struct IProgramObject;
+}
 
+class ILosType;
 class CPboInfoTexture : public CInfoTexture
 {
 public:
@@ -24,8 +31,43 @@ public:
 	virtual void Update() = 0;
 	virtual bool IsUpdateNeeded() = 0;
 
+protected:
+	// horizontal run of dirty tiles, in texels
+	struct DirtyRun {
+		int x, y;
+		int w, h;
+	};
+
+	static constexpr int DIRTY_TILE_SIZE = 32;
+
+	// returns true (and marks everything dirty) when the viewed allyteam or its globalLOS state changed
+	bool CheckFullUpdate(int allyTeam, bool globalLOS);
+
+	// marks the tiles touched by changes to <losType>'s map of <allyTeam> since the last call;
+	// if these could not be tracked (e.g. because there were too many) all tiles are marked
+	void MarkDirtyTiles(const ILosType& losType, std::uint64_t& numSeenRects, int allyTeam);
+	void MarkAllTilesDirty();
+
+	// merges the dirty tiles into runs and clears them
+	const std::vector<DirtyRun>& GetDirtyRuns();
+
+	// packs the dirty runs of the (uint16) ILosType map <src> into <dst>, returns the number of bytes written
+	size_t PackDirtyRuns(std::uint8_t* dst, const std::uint16_t* src) const;
+	// uploads the runs packed by PackDirtyRuns from <infoTexPBO> (must be bound) to <tex>
+	void UploadDirtyRuns(unsigned int tex, size_t pboOffset) const;
+	// draws every dirty run into the currently bound FBO, sets <shader>'s "texRect" uniform per run
+	void DrawDirtyRuns(Shader::IProgramObject* shader) const;
+
 protected:
 	PBO infoTexPBO;
+
+	std::vector<std::uint8_t> dirtyTiles;
+	std::vector<DirtyRun> dirtyRuns;
+
+	int2 numDirtyTiles;
+
+	int prvAllyTeam = -1;
+	bool prvGlobalLOS = false;
 };
 
 #endif // _PBO_INFO_TEXTURE_H
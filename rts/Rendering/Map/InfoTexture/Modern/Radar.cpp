@@ -4,7 +4,6 @@
 #include "InfoTextureHandler.h"
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/GlobalRendering.h"
-#include "Rendering/GL/RenderDataBuffer.hpp"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Sim/Misc/LosHandler.h"
@@ -12,17 +11,6 @@
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 
-constexpr VA_TYPE_0 VERTS[] = {
-	{{-1.0f, -1.0f, 0.0f}}, // bl
-	{{-1.0f, +1.0f, 0.0f}}, // tl
-	{{+1.0f, +1.0f, 0.0f}}, // tr
-
-	{{+1.0f, +1.0f, 0.0f}}, // tr
-	{{+1.0f, -1.0f, 0.0f}}, // br
-	{{-1.0f, -1.0f, 0.0f}}, // bl
-};
-
-
 CRadarTexture::CRadarTexture()
 : CPboInfoTexture("radar")
 , uploadTexRadar(0)
@@ -60,8 +48,11 @@ CRadarTexture::CRadarTexture()
 		layout(location = 1) in vec2 aTexCoords; // ignored
 		out vec2 vTexCoords;
 
+		// {x, y, w, h} of the updated region, the viewport covers only it
+		uniform vec4 texRect;
+
 		void main() {
-			vTexCoords = aVertexPos.xy * 0.5 + 0.5;
+			vTexCoords = texRect.xy + (aVertexPos.xy * 0.5 + 0.5) * texRect.zw;
 			gl_Position = vec4(aVertexPos, 1.0);
 		}
 	)";
@@ -106,6 +97,7 @@ CRadarTexture::CRadarTexture()
 	shader->SetUniform("texRadar",  1);
 	shader->SetUniform("texJammer", 0);
 	shader->SetUniform("texLoS",    2);
+	shader->SetUniform("texRect",   0.0f, 0.0f, 1.0f, 1.0f);
 	shader->Disable();
 	shader->Validate();
 
@@ -181,6 +173,8 @@ void CRadarTexture::Update()
 	if (!fbo.IsValid() || !shader->IsValid() || uploadTexRadar == 0 || uploadTexJammer == 0)
 		return UpdateCPU();
 
+	CheckFullUpdate(gu->myAllyTeam, losHandler->globalLOS[gu->myAllyTeam]);
+
 	if (losHandler->globalLOS[gu->myAllyTeam]) {
 		fbo.Bind();
 		glAttribStatePtr->ViewPort(0,0, texSize.x, texSize.y);
@@ -197,15 +191,24 @@ void CRadarTexture::Update()
 	const int jammerAllyTeam = modInfo.separateJammers ? gu->myAllyTeam : 0;
 
 
+	// the output also depends on the los-texture, so track its changes too
+	MarkDirtyTiles(losHandler->los,    numSeenLosRects,    gu->myAllyTeam);
+	MarkDirtyTiles(losHandler->radar,  numSeenRadarRects,  gu->myAllyTeam);
+	MarkDirtyTiles(losHandler->jammer, numSeenJammerRects, jammerAllyTeam);
+
+	if (GetDirtyRuns().empty())
+		return;
+
+
 	infoTexPBO.Bind();
 
-	const size_t arraySize = texSize.x * texSize.y * sizeof(uint16_t);
 	      uint8_t* infoTexMem = reinterpret_cast<uint8_t*>(infoTexPBO.MapBuffer());
 	const uint16_t* myRadar  = &losHandler->radar.losMaps[gu->myAllyTeam].front();
 	const uint16_t* myJammer = &losHandler->jammer.losMaps[jammerAllyTeam].front();
 
-	memcpy(infoTexMem, myRadar , arraySize); infoTexMem += arraySize;
-	memcpy(infoTexMem, myJammer, arraySize);
+	// only the changed regions are packed and uploaded
+	const size_t radarSize = PackDirtyRuns(infoTexMem, myRadar);
+	PackDirtyRuns(infoTexMem + radarSize, myJammer);
 
 	infoTexPBO.UnmapBuffer();
 
@@ -214,29 +217,23 @@ void CRadarTexture::Update()
 	// Faster than doing it on the CPU! And uploading it as shorts would be slow, cause the GPU
 	// has no native support for them and so the transformation would happen on the CPU, too.
 	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, uploadTexRadar);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr());
+	UploadDirtyRuns(uploadTexRadar, 0);
 
 	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, uploadTexJammer);
-	glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texSize.x, texSize.y, GL_RG, GL_UNSIGNED_BYTE, infoTexPBO.GetPtr(arraySize));
+	UploadDirtyRuns(uploadTexJammer, radarSize);
 
 	infoTexPBO.Invalidate();
 	infoTexPBO.Unbind();
 
 	// do post-processing on the gpu (los-checking & scaling)
 	fbo.Bind();
-	glAttribStatePtr->ViewPort(0, 0,  texSize.x, texSize.y);
 	glAttribStatePtr->DisableBlendMask();
 
 	glActiveTexture(GL_TEXTURE2);
 	glBindTexture(GL_TEXTURE_2D, infoTextureHandler->GetInfoTexture("los")->GetTexture());
 
-	GL::RenderDataBuffer0* rdb = GL::GetRenderBuffer0();
-
 	shader->Enable();
-	rdb->SafeAppend(VERTS, sizeof(VERTS) / sizeof(VERTS[0]));
-	rdb->Submit(GL_TRIANGLES);
+	DrawDirtyRuns(shader);
 	shader->Disable();
 
 	glAttribStatePtr->ViewPort(globalRendering->viewPosX, 0,  globalRendering->viewSizeX, globalRendering->viewSizeY);
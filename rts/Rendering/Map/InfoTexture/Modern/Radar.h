@@ -31,6 +31,10 @@ private:
 	GLuint uploadTexRadar;
 	GLuint uploadTexJammer;
 	Shader::IProgramObject* shader;
+
+	std::uint64_t numSeenLosRects = 0;
+	std::uint64_t numSeenRadarRects = 0;
+	std::uint64_t numSeenJammerRects = 0;
 };
 
 #endif // _RADAR_TEXTURE_H
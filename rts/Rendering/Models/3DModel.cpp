@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "3DModel.h"
+#include "ModelSimplifier.h"
 
 #include "Game/GlobalUnsynced.h"
 #include "Rendering/GL/myGL.h"
@@ -10,6 +11,7 @@
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "System/Exceptions.h"
 #include "System/SafeUtil.h"
+#include "System/SpringMath.h"
 
 #include <algorithm>
 #include <cctype>
@@ -51,7 +53,11 @@ CR_REG_METADATA(LocalModel, (
 	CR_IGNORED(elemsBuffer),
 	CR_IGNORED(indcsBuffer),
 	CR_IGNORED(vboNumVerts),
-	CR_IGNORED(vboNumIndcs)
+	CR_IGNORED(vboNumIndcs),
+	CR_IGNORED(numMeshLODs),
+	CR_IGNORED(lodIndxStart),
+	CR_IGNORED(lodNumIndcs),
+	CR_IGNORED(meshLOD)
 ))
 
 
@@ -61,7 +67,7 @@ CR_REG_METADATA(LocalModel, (
 void S3DModel::DeleteBuffers()
 {
 	if (vertexArray != 0)
-		glDeleteVertexArrays(1, &vertexArray);
+		glAttribStatePtr->DeleteVertexArrays(1, &vertexArray);
 	if (elemsBuffer != 0)
 		glDeleteBuffers(1, &elemsBuffer);
 	if (indcsBuffer != 0)
@@ -99,10 +105,18 @@ void S3DModel::UploadBuffers()
 
 		vboNumVerts = numVerts;
 		vboNumIndcs = numIndcs;
+
+		lodIndxStart[0] = 0;
+		lodNumIndcs[0] = numIndcs;
+
+		for (unsigned int i = 1; i < numMeshLODs; i++) {
+			lodIndxStart[i] = lodIndxStart[i - 1] + lodNumIndcs[i - 1];
+			lodNumIndcs[i] = lodIndices[i - 1].size();
+		}
 	}
 
 	glGenVertexArrays(1, &vertexArray);
-	glBindVertexArray(vertexArray);
+	glAttribStatePtr->BindVertexArray(vertexArray);
 
 
 	{
@@ -132,7 +146,7 @@ void S3DModel::UploadBuffers()
 		// indices
 		glGenBuffers(1, &indcsBuffer);
 		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indcsBuffer);
-		glBufferData(GL_ELEMENT_ARRAY_BUFFER, vboNumIndcs * sizeof(uint32_t), nullptr, GL_STATIC_DRAW);
+		glBufferData(GL_ELEMENT_ARRAY_BUFFER, (lodIndxStart[numMeshLODs - 1] + lodNumIndcs[numMeshLODs - 1]) * sizeof(uint32_t), nullptr, GL_STATIC_DRAW);
 
 		for (const S3DModelPiece* omp : pieceObjects) {
 
@@ -147,10 +161,15 @@ void S3DModel::UploadBuffers()
 			assert(!indcs.empty());
 			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, omp->vboStartIndx * sizeof(uint32_t), indcs.size() * sizeof(uint32_t), indcs.data());
 		}
+
+		// simplified meshes follow the full-detail one
+		for (unsigned int i = 1; i < numMeshLODs; i++) {
+			glBufferSubData(GL_ELEMENT_ARRAY_BUFFER, lodIndxStart[i] * sizeof(uint32_t), lodNumIndcs[i] * sizeof(uint32_t), lodIndices[i - 1].data());
+		}
 	}
 
 	EnableAttribs();
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 	DisableAttribs();
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
@@ -158,6 +177,89 @@ void S3DModel::UploadBuffers()
 }
 
 
+void S3DModel::CreateMeshLODs()
+{
+	// fraction of the full-detail index count aimed for per LOD
+	constexpr float lodTargets[NUM_MESH_LODS] = {1.0f, 0.5f, 0.25f};
+	// largest tolerated (quadric) deviation per LOD, relative to the radius
+	constexpr float lodErrors[NUM_MESH_LODS] = {0.0f, 0.02f, 0.05f};
+
+	numMeshLODs = 1;
+
+	size_t numIndcs = 0;
+
+	for (const S3DModelPiece* omp: pieceObjects) {
+		if (!omp->HasGeometryData())
+			continue;
+
+		numIndcs += omp->GetVertexIndices().size();
+	}
+
+	// low-poly models are cheap enough and lose their shape first
+	if (numIndcs < (3 * 256))
+		return;
+
+	std::vector<uint32_t> pieceIndcs;
+
+	for (unsigned int i = 1; i < NUM_MESH_LODS; i++) {
+		std::vector<uint32_t>& indcs = lodIndices[i - 1];
+
+		const float maxError = Square(radius * lodErrors[i]);
+
+		indcs.clear();
+		indcs.reserve(numIndcs * lodTargets[i]);
+
+		// same packing order as UploadBuffers, indices are stored buffer-relative
+		for (size_t j = 0, numVerts = 0; j < pieceObjects.size(); j++) {
+			const S3DModelPiece* omp = pieceObjects[j];
+
+			if (!omp->HasGeometryData())
+				continue;
+
+			const std::vector<SVertexData>& pieceElems = omp->GetVertexElements();
+
+			ModelSimplifier::Simplify(pieceElems, omp->GetVertexIndices(), omp->GetVertexIndices().size() * lodTargets[i], maxError, pieceIndcs);
+
+			for (const uint32_t idx: pieceIndcs) {
+				indcs.push_back(idx + numVerts);
+			}
+
+			numVerts += pieceElems.size();
+		}
+
+		// stop once the error bound keeps meshes from shrinking noticeably
+		if (indcs.size() > ((i == 1)? numIndcs: lodIndices[i - 2].size()) * 0.85f) {
+			indcs.clear();
+			break;
+		}
+
+		numMeshLODs += 1;
+	}
+}
+
+unsigned int S3DModel::CalcMeshLOD(float pixelRadius, unsigned int curLOD, unsigned int numLODs)
+{
+	// projected radius (in pixels) below which LOD i is used
+	constexpr float lodRadii[NUM_MESH_LODS] = {0.0f, 48.0f, 20.0f};
+	// objects must pass a threshold by this fraction before switching back
+	constexpr float hysteresis = 0.15f;
+
+	unsigned int newLOD = 0;
+
+	for (unsigned int i = 1; i < numLODs; i++) {
+		// a coarser level is easier to stay in than to enter
+		const float bias = (curLOD >= i)? (1.0f + hysteresis): (1.0f - hysteresis);
+
+		if (pixelRadius >= (lodRadii[i] * bias))
+			break;
+
+		newLOD = i;
+	}
+
+	return newLOD;
+}
+
+
 void S3DModel::EnableAttribs() const
 {
 	glEnableVertexAttribArray(0);
@@ -204,9 +306,19 @@ void S3DModel::Draw() const
 	// draw pieces in their static bind-pose (ie. without script-transforms)
 	// this now requires setting up bind-pose matrices via IUnitRenderState
 	// TODO: should convert S3O's that do not use PRIMTYPE=TRIANGLES?
-	glBindVertexArray(vertexArray);
+	glAttribStatePtr->BindVertexArray(vertexArray);
 	glDrawElements(GL_TRIANGLES, vboNumIndcs, GL_UNSIGNED_INT, nullptr);
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
+}
+
+void S3DModel::DrawInstanced(unsigned int numInstances, unsigned int meshLOD) const
+{
+	meshLOD = std::min(meshLOD, numMeshLODs - 1);
+
+	// per-instance transforms are fetched from CModelInstanceBuffer
+	glAttribStatePtr->BindVertexArray(vertexArray);
+	glDrawElementsInstanced(GL_TRIANGLES, lodNumIndcs[meshLOD], GL_UNSIGNED_INT, VA_TYPE_OFFSET(uint32_t, lodIndxStart[meshLOD]), numInstances);
+	glAttribStatePtr->BindVertexArray(0);
 }
 
 void S3DModel::DrawPiece(const S3DModelPiece* omp) const
@@ -216,9 +328,9 @@ void S3DModel::DrawPiece(const S3DModelPiece* omp) const
 	const std::vector<unsigned int>& indcs = omp->GetVertexIndices();
 
 	// draw the buffer sub-region corresponding to this piece
-	glBindVertexArray(vertexArray);
+	glAttribStatePtr->BindVertexArray(vertexArray);
 	glDrawElements(GL_TRIANGLES, indcs.size(), GL_UNSIGNED_INT, VA_TYPE_OFFSET(uint32_t, omp->vboStartIndx));
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 }
 
 // only used by projectiles with the PF_Recursive flag
@@ -462,7 +574,7 @@ void LocalModel::UpdatePieceMatrices(unsigned int gsFrameNum)
 
 void LocalModel::Draw() const
 {
-	glBindVertexArray(vertexArray);
+	glAttribStatePtr->BindVertexArray(vertexArray);
 
 	#if 0
 	switch (primType) {
@@ -474,10 +586,10 @@ void LocalModel::Draw() const
 		} break;
 	}
 	#else
-	glDrawElements(GL_TRIANGLES, vboNumIndcs, GL_UNSIGNED_INT, nullptr);
+	glDrawElements(GL_TRIANGLES, lodNumIndcs[meshLOD], GL_UNSIGNED_INT, VA_TYPE_OFFSET(uint32_t, lodIndxStart[meshLOD]));
 	#endif
 
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 }
 
 void LocalModel::DrawPiece(const LocalModelPiece* lmp) const 
@@ -488,9 +600,9 @@ void LocalModel::DrawPiece(const LocalModelPiece* lmp) const
 	const std::vector<unsigned int>& indcs = omp->GetVertexIndices();
 
 	// draw the buffer sub-region corresponding to this piece
-	glBindVertexArray(vertexArray);
+	glAttribStatePtr->BindVertexArray(vertexArray);
 	glDrawElements(GL_TRIANGLES, indcs.size(), GL_UNSIGNED_INT, VA_TYPE_OFFSET(uint32_t, omp->vboStartIndx));
-	glBindVertexArray(0);
+	glAttribStatePtr->BindVertexArray(0);
 }
 
 
@@ -508,6 +620,13 @@ void LocalModel::SetModel(const S3DModel* model, bool initialize)
 	indcsBuffer = model->indcsBuffer;
 	vboNumVerts = model->vboNumVerts;
 	vboNumIndcs = model->vboNumIndcs;
+	numMeshLODs = model->numMeshLODs;
+	meshLOD = 0;
+
+	for (unsigned int i = 0; i < S3DModel::NUM_MESH_LODS; i++) {
+		lodIndxStart[i] = model->lodIndxStart[i];
+		lodNumIndcs[i] = model->lodNumIndcs[i];
+	}
 
 	if (!initialize) {
 		assert(pieces.size() == model->numPieces);
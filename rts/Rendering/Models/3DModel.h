@@ -258,6 +258,15 @@ struct S3DModel
 		indcsBuffer = m.indcsBuffer; m.indcsBuffer = 0;
 		vboNumVerts = m.vboNumVerts;
 		vboNumIndcs = m.vboNumIndcs;
+		numMeshLODs = m.numMeshLODs;
+
+		for (unsigned int i = 0; i < NUM_MESH_LODS; i++) {
+			lodIndxStart[i] = m.lodIndxStart[i];
+			lodNumIndcs[i] = m.lodNumIndcs[i];
+		}
+		for (unsigned int i = 0; i < (NUM_MESH_LODS - 1); i++) {
+			lodIndices[i] = std::move(m.lodIndices[i]);
+		}
 
 		type = m.type;
 
@@ -285,18 +294,20 @@ struct S3DModel
 	}
 
 	void Draw() const;
+	void DrawInstanced(unsigned int numInstances, unsigned int meshLOD = 0) const;
 	void DrawPiece(const S3DModelPiece* omp) const;
 	void DrawPieceRec(const S3DModelPiece* omp) const;
 
 	void DeleteBuffers();
 	void UploadBuffers();
+	void CreateMeshLODs();
 	void EnableAttribs() const;
 	void DisableAttribs() const;
 
-	void BindVertexArray() const { glBindVertexArray(vertexArray); }
+	void BindVertexArray() const { glAttribStatePtr->BindVertexArray(vertexArray); }
 	void BindElemsBuffer() const { glBindBuffer(GL_ARRAY_BUFFER, elemsBuffer); }
 	void BindIndcsBuffer() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, indcsBuffer); }
-	void UnbindVertexArray() const { glBindVertexArray(0); }
+	void UnbindVertexArray() const { glAttribStatePtr->BindVertexArray(0); }
 	void UnbindElemsBuffer() const { glBindBuffer(GL_ARRAY_BUFFER, 0); }
 	void UnbindIndcsBuffer() const { glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0); }
 
@@ -319,7 +330,11 @@ struct S3DModel
 
 	bool UploadedBuffers() const { return (vertexArray != 0); }
 
+	static unsigned int CalcMeshLOD(float pixelRadius, unsigned int curLOD, unsigned int numLODs);
+
 public:
+	static constexpr unsigned int NUM_MESH_LODS = 3;
+
 	std::string name;
 	std::string texs[NUM_MODEL_TEXTURES];
 
@@ -338,6 +353,15 @@ public:
 	unsigned int vboNumVerts = 0;
 	unsigned int vboNumIndcs = 0;
 
+	// mesh LOD's share the vertex buffer; their simplified index-lists are
+	// appended to the full-detail one (which vboNumIndcs still refers to)
+	unsigned int numMeshLODs = 1;
+	unsigned int lodIndxStart[NUM_MESH_LODS] = {0, 0, 0};
+	unsigned int lodNumIndcs[NUM_MESH_LODS] = {0, 0, 0};
+
+	// buffer-relative index-lists of LOD's 1 and up, see CreateMeshLODs
+	std::vector<uint32_t> lodIndices[NUM_MESH_LODS - 1];
+
 	ModelType type;
 
 	float radius;
@@ -486,6 +510,11 @@ struct LocalModel
 		luaMaterialData.SetLODCount(lodCount);
 	}
 
+	// selected by the drawer from the projected size, with hysteresis
+	void SetMeshLOD(float pixelRadius) const { meshLOD = S3DModel::CalcMeshLOD(pixelRadius, meshLOD, numMeshLODs); }
+	void ResetMeshLOD() const { meshLOD = 0; }
+	unsigned int GetMeshLOD() const { return meshLOD; }
+
 	void UpdateBoundingVolume();
 	void UpdatePieceMatrices() { UpdatePieceMatrices(pmuFrameNum + 1); }
 	void UpdatePieceMatrices(unsigned int gsFrameNum);
@@ -539,6 +568,11 @@ private:
 	unsigned int indcsBuffer = 0;
 	unsigned int vboNumVerts = 0;
 	unsigned int vboNumIndcs = 0;
+	unsigned int numMeshLODs = 1;
+	unsigned int lodIndxStart[S3DModel::NUM_MESH_LODS] = {0, 0, 0};
+	unsigned int lodNumIndcs[S3DModel::NUM_MESH_LODS] = {0, 0, 0};
+
+	mutable unsigned int meshLOD = 0;
 };
 
 #endif /* _3DMODEL_H */
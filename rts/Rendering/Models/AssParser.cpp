@@ -10,11 +10,16 @@
 #include "Rendering/GlobalRendering.h"
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Log/ILog.h"
 #include "System/Exceptions.h"
 #include "System/ScopedFPUSettings.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Sync/SHA512.hpp"
+#include "System/Threading/ThreadPool.h"
 
 #include "lib/assimp/include/assimp/config.h"
 #include "lib/assimp/include/assimp/defs.h"
@@ -24,11 +29,24 @@
 #include "lib/assimp/include/assimp/Importer.hpp"
 #include "lib/assimp/include/assimp/DefaultLogger.hpp"
 
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
 #include <regex>
 
 
+CONFIG(bool, AssimpModelCache)
+	.defaultValue(true)
+	.description("Cache the imported geometry and piece hierarchy of Assimp models under <cachedir>/models/ instead of running the Assimp import on every load.");
+
+
 #define IS_QNAN(f) (f != f)
 
+// bump whenever the import pipeline or the cache-file layout changes
+static constexpr uint32_t ASS_CACHE_VERSION = 1;
+static constexpr uint32_t ASS_CACHE_MAGIC = 0x43535341; // "ASSC"
+
 // triangulate guarantees the most complex mesh is a triangle
 // sortbytype ensure only 1 type of primitive type per mesh is used
 static constexpr unsigned int ASS_POSTPROCESS_OPTIONS =
@@ -131,6 +149,9 @@ void CAssParser::Init()
 	maxVertices = std::max(globalRendering->glslMaxRecommendedVertices, 1024);
 	numPoolPieces = 0;
 
+	if (configHandler->GetBool("AssimpModelCache"))
+		FileSystem::CreateDirectory(FileSystem::GetCacheDir() + "/models/");
+
 	Assimp::DefaultLogger::create("", Assimp::Logger::VERBOSE);
 	// create a logger for debugging model loading issues
 	Assimp::DefaultLogger::get()->attachStream(new AssLogStream(), ASS_LOGGING_OPTIONS);
@@ -182,13 +203,6 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 		LOG_SL(LOG_SECTION_MODEL, L_INFO, "No valid model metadata in '%s' or no meta-file", metaFileName.c_str());
 
 
-	Assimp::Importer importer;
-
-	// speed-up processing by skipping things we don't need
-	importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, ASS_IMPORTER_OPTIONS);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
-	importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
-
 	if (!file.IsBuffered()) {
 		fileBuf.resize(file.FileSize(), 0);
 		file.Read(fileBuf.data(), fileBuf.size());
@@ -196,51 +210,71 @@ S3DModel CAssParser::Load(const std::string& modelFilePath)
 		fileBuf = std::move(file.GetBuffer());
 	}
 
-	if (modelTable.GetBool("nodenamesfromids", false)) {
-		assert(FileSystem::GetExtension(modelFilePath) == "dae");
-		PreProcessFileBuffer(fileBuf);
-	}
+	ModelPieceMap pieceMap;
+	ParentNameMap parentMap;
 
+	S3DModel model;
+	model.name = modelFilePath;
+	model.type = MODELTYPE_ASS;
 
-	// Read the model file to build a scene object
-	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Importing model file: %s", modelFilePath.c_str());
+	std::vector<std::string> matTextures;
 
-	const aiScene* scene = nullptr;
+	// the cache holds everything up to and including the piece hierarchy
+	const std::string& cacheFileName = configHandler->GetBool("AssimpModelCache")? GetCacheFileName(fileBuf, metaFileName): "";
 
-	{
-		// ASSIMP spams many SIGFPEs atm in normal & tangent generation
-		ScopedDisableFpuExceptions fe;
-		scene = importer.ReadFileFromMemory(fileBuf.data(), fileBuf.size(), ASS_POSTPROCESS_OPTIONS);
-	}
+	if (cacheFileName.empty() || !LoadCachedPieces(&model, matTextures, cacheFileName)) {
+		Assimp::Importer importer;
 
-	if (scene == nullptr)
-		throw content_error("[AssimpParser] Model Import: " + std::string(importer.GetErrorString()));
+		// speed-up processing by skipping things we don't need
+		importer.SetPropertyInteger(AI_CONFIG_PP_RVC_FLAGS, ASS_IMPORTER_OPTIONS);
+		importer.SetPropertyInteger(AI_CONFIG_PP_SLM_VERTEX_LIMIT,   maxVertices);
+		importer.SetPropertyInteger(AI_CONFIG_PP_SLM_TRIANGLE_LIMIT, maxIndices / 3);
 
-	LOG_SL(LOG_SECTION_MODEL, L_INFO,
-		"Processing scene for model: %s (%d meshes / %d materials / %d textures)",
-		modelFilePath.c_str(), scene->mNumMeshes, scene->mNumMaterials,
-		scene->mNumTextures
-	);
+		if (modelTable.GetBool("nodenamesfromids", false)) {
+			assert(FileSystem::GetExtension(modelFilePath) == "dae");
+			PreProcessFileBuffer(fileBuf);
+		}
 
-	ModelPieceMap pieceMap;
-	ParentNameMap parentMap;
 
-	S3DModel model;
-	model.name = modelFilePath;
-	model.type = MODELTYPE_ASS;
+		// Read the model file to build a scene object
+		LOG_SL(LOG_SECTION_MODEL, L_INFO, "Importing model file: %s", modelFilePath.c_str());
+
+		const aiScene* scene = nullptr;
+
+		{
+			// ASSIMP spams many SIGFPEs atm in normal & tangent generation
+			ScopedDisableFpuExceptions fe;
+			scene = importer.ReadFileFromMemory(fileBuf.data(), fileBuf.size(), ASS_POSTPROCESS_OPTIONS);
+		}
+
+		if (scene == nullptr)
+			throw content_error("[AssimpParser] Model Import: " + std::string(importer.GetErrorString()));
+
+		LOG_SL(LOG_SECTION_MODEL, L_INFO,
+			"Processing scene for model: %s (%d meshes / %d materials / %d textures)",
+			modelFilePath.c_str(), scene->mNumMeshes, scene->mNumMaterials,
+			scene->mNumTextures
+		);
+
+		GetMaterialTextures(scene, matTextures);
+
+		// Load all pieces in the model
+		LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loading pieces from root node '%s'", scene->mRootNode->mName.data);
+		LoadPiece(&model, scene->mRootNode, scene, modelTable, pieceMap, parentMap);
+
+		// Update piece hierarchy based on metadata
+		BuildPieceHierarchy(&model, pieceMap, parentMap);
+
+		if (!cacheFileName.empty())
+			SaveCachedPieces(&model, matTextures, cacheFileName);
+	}
 
 	// Load textures
-	FindTextures(&model, scene, modelTable, modelPath, modelName);
+	FindTextures(&model, matTextures, modelTable, modelPath, modelName);
 	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loading textures. Tex1: '%s' Tex2: '%s'", model.texs[0].c_str(), model.texs[1].c_str());
 
 	textureHandlerS3O.PreloadTexture(&model, modelTable.GetBool("fliptextures", true), modelTable.GetBool("invertteamcolor", true));
 
-	// Load all pieces in the model
-	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loading pieces from root node '%s'", scene->mRootNode->mName.data);
-	LoadPiece(&model, scene->mRootNode, scene, modelTable, pieceMap, parentMap);
-
-	// Update piece hierarchy based on metadata
-	BuildPieceHierarchy(&model, pieceMap, parentMap);
 	CalculateModelProperties(&model, modelTable);
 
 	// Verbose logging of model properties
@@ -776,9 +810,39 @@ static std::string FindTextureByRegex(const std::string& regex_path, const std::
 }
 
 
+void CAssParser::GetMaterialTextures(const aiScene* scene, std::vector<std::string>& matTextures)
+{
+	if (scene->mNumMaterials == 0)
+		return;
+
+	constexpr unsigned int texTypes[] = {
+		aiTextureType_SPECULAR,
+		aiTextureType_UNKNOWN,
+		aiTextureType_DIFFUSE,
+		/*
+		// TODO: support these too (we need to allow constructing tex1 & tex2 from several sources)
+		aiTextureType_EMISSIVE,
+		aiTextureType_HEIGHT,
+		aiTextureType_NORMALS,
+		aiTextureType_SHININESS,
+		aiTextureType_OPACITY,
+		*/
+	};
+
+	// model-defined textures of the first material, in increasing priority
+	for (unsigned int texType: texTypes) {
+		aiString textureFile;
+		if (scene->mMaterials[0]->Get(AI_MATKEY_TEXTURE(texType, 0), textureFile) != aiReturn_SUCCESS)
+			continue;
+
+		assert(textureFile.length > 0);
+		matTextures.emplace_back(textureFile.data);
+	}
+}
+
 void CAssParser::FindTextures(
 	S3DModel* model,
-	const aiScene* scene,
+	const std::vector<std::string>& matTextures,
 	const LuaTable& modelTable,
 	const std::string& modelPath,
 	const std::string& modelName
@@ -794,28 +858,8 @@ void CAssParser::FindTextures(
 	if (model->texs[1].empty()) model->texs[1] = FindTextureByRegex(modelPath, "glow"); // lowest-priority name
 
 	// 2. gather model-defined textures of first material (medium priority)
-	if (scene->mNumMaterials > 0) {
-		constexpr unsigned int texTypes[] = {
-			aiTextureType_SPECULAR,
-			aiTextureType_UNKNOWN,
-			aiTextureType_DIFFUSE,
-			/*
-			// TODO: support these too (we need to allow constructing tex1 & tex2 from several sources)
-			aiTextureType_EMISSIVE,
-			aiTextureType_HEIGHT,
-			aiTextureType_NORMALS,
-			aiTextureType_SHININESS,
-			aiTextureType_OPACITY,
-			*/
-		};
-		for (unsigned int texType: texTypes) {
-			aiString textureFile;
-			if (scene->mMaterials[0]->Get(AI_MATKEY_TEXTURE(texType, 0), textureFile) != aiReturn_SUCCESS)
-				continue;
-
-			assert(textureFile.length > 0);
-			model->texs[0] = FindTexture(textureFile.data, modelPath, model->texs[0]);
-		}
+	for (const std::string& textureFile: matTextures) {
+		model->texs[0] = FindTexture(textureFile, modelPath, model->texs[0]);
 	}
 
 	// 3. try to load from metafile (highest priority)
@@ -823,3 +867,264 @@ void CAssParser::FindTextures(
 	model->texs[1] = FindTexture(modelTable.GetString("tex2", ""), modelPath, model->texs[1]);
 }
 
+
+
+std::string CAssParser::GetCacheFileName(const std::vector<unsigned char>& fileBuffer, const std::string& metaFileName) const
+{
+	std::string metaFileData;
+	CFileHandler metaFile(metaFileName, SPRING_VFS_ZIP);
+
+	if (metaFile.FileExists())
+		metaFile.LoadStringData(metaFileData);
+
+	// the imported pieces are a function of the model file, its metadata
+	// (piece overrides) and the mesh-splitting limits, nothing else
+	const uint32_t params[] = {ASS_CACHE_VERSION, uint32_t(sizeof(SAssVertex)), maxVertices, maxIndices};
+
+	sha512::calc_state state;
+	sha512::raw_digest digest;
+	sha512::hex_digest hexDigest;
+
+	sha512::init_digest(state);
+	sha512::update_digest(state, reinterpret_cast<const uint8_t*>(params), sizeof(params));
+	sha512::update_digest(state, reinterpret_cast<const uint8_t*>(metaFileData.data()), metaFileData.size());
+	sha512::update_digest(state, fileBuffer.data(), fileBuffer.size());
+	sha512::final_digest(state, digest.data());
+	sha512::dump_digest(digest, hexDigest);
+
+	return (FileSystem::GetCacheDir() + "/models/" + std::string(hexDigest.data(), 32) + ".bin");
+}
+
+
+template<typename T> static void WriteCacheData(std::vector<uint8_t>& buf, const T* data, size_t count) {
+	const uint8_t* bytes = reinterpret_cast<const uint8_t*>(data);
+	buf.insert(buf.end(), bytes, bytes + count * sizeof(T));
+}
+template<typename T> static void WriteCacheValue(std::vector<uint8_t>& buf, const T& value) { WriteCacheData(buf, &value, 1); }
+
+static void WriteCacheString(std::vector<uint8_t>& buf, const std::string& str) {
+	WriteCacheValue(buf, uint32_t(str.size()));
+	WriteCacheData(buf, str.data(), str.size());
+}
+
+template<typename T> static bool ReadCacheData(const std::vector<uint8_t>& buf, size_t& pos, T* data, size_t count) {
+	if (count > ((buf.size() - pos) / sizeof(T)))
+		return false;
+
+	memcpy(data, buf.data() + pos, count * sizeof(T));
+	pos += (count * sizeof(T));
+	return true;
+}
+template<typename T> static bool ReadCacheValue(const std::vector<uint8_t>& buf, size_t& pos, T& value) { return (ReadCacheData(buf, pos, &value, 1)); }
+
+static bool ReadCacheString(const std::vector<uint8_t>& buf, size_t& pos, std::string& str) {
+	uint32_t size = 0;
+
+	if (!ReadCacheValue(buf, pos, size) || size > (buf.size() - pos))
+		return false;
+
+	str.assign(reinterpret_cast<const char*>(buf.data() + pos), size);
+	pos += size;
+	return true;
+}
+
+
+bool CAssParser::LoadCachedPieces(S3DModel* model, std::vector<std::string>& matTextures, const std::string& cacheFileName)
+{
+	struct CachedPiece {
+		std::string name;
+		std::vector<SAssVertex> vertices;
+		std::vector<unsigned int> indices;
+
+		CMatrix44f bakedMatrix;
+
+		float3 offset;
+		float3 scales;
+		float3 mins;
+		float3 maxs;
+
+		int32_t parentIndex = -1;
+		uint32_t numTexCoorChannels = 0;
+	};
+
+	std::vector<uint8_t> buf;
+	std::vector<CachedPiece> cachedPieces;
+
+	{
+		std::ifstream file(dataDirsAccess.LocateFile(cacheFileName), std::ios::in | std::ios::binary);
+
+		if (!file.is_open())
+			return false;
+
+		buf.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+	}
+
+	// validate everything before any pool pieces are taken
+	{
+		size_t pos = 0;
+
+		uint32_t magic = 0;
+		uint32_t version = 0;
+		uint32_t numTextures = 0;
+		uint32_t numPieces = 0;
+
+		if (!ReadCacheValue(buf, pos, magic) || magic != ASS_CACHE_MAGIC)
+			return false;
+		if (!ReadCacheValue(buf, pos, version) || version != ASS_CACHE_VERSION)
+			return false;
+
+		if (!ReadCacheValue(buf, pos, numTextures))
+			return false;
+
+		for (uint32_t i = 0; i < numTextures; i++) {
+			matTextures.emplace_back();
+
+			if (!ReadCacheString(buf, pos, matTextures.back())) {
+				matTextures.clear();
+				return false;
+			}
+		}
+
+		if (!ReadCacheValue(buf, pos, numPieces) || numPieces == 0 || numPieces > (buf.size() - pos)) {
+			matTextures.clear();
+			return false;
+		}
+
+		cachedPieces.resize(numPieces);
+
+		for (uint32_t i = 0; i < numPieces; i++) {
+			CachedPiece& cp = cachedPieces[i];
+
+			uint32_t numVertices = 0;
+			uint32_t numIndices = 0;
+
+			bool valid = true;
+
+			valid &= ReadCacheString(buf, pos, cp.name);
+			valid &= ReadCacheValue(buf, pos, cp.parentIndex);
+			valid &= ReadCacheData(buf, pos, &cp.bakedMatrix.m[0], 16);
+			valid &= ReadCacheData(buf, pos, &cp.offset.x, 3);
+			valid &= ReadCacheData(buf, pos, &cp.scales.x, 3);
+			valid &= ReadCacheData(buf, pos, &cp.mins.x, 3);
+			valid &= ReadCacheData(buf, pos, &cp.maxs.x, 3);
+			valid &= ReadCacheValue(buf, pos, cp.numTexCoorChannels);
+
+			// pieces are stored in flattened order, parents always come first
+			valid = valid && (int32_t(i) > cp.parentIndex) && ((i == 0) == (cp.parentIndex < 0));
+			valid = valid && ReadCacheValue(buf, pos, numVertices) && (numVertices <= ((buf.size() - pos) / sizeof(SAssVertex)));
+
+			if (valid) {
+				cp.vertices.resize(numVertices);
+				valid &= ReadCacheData(buf, pos, cp.vertices.data(), numVertices);
+			}
+
+			valid = valid && ReadCacheValue(buf, pos, numIndices) && (numIndices <= ((buf.size() - pos) / sizeof(unsigned int)));
+
+			if (valid) {
+				cp.indices.resize(numIndices);
+				valid &= ReadCacheData(buf, pos, cp.indices.data(), numIndices);
+			}
+
+			if (valid)
+				valid = std::all_of(cp.indices.begin(), cp.indices.end(), [&](unsigned int idx) { return (idx < numVertices); });
+
+			if (!valid) {
+				LOG_SL(LOG_SECTION_MODEL, L_WARNING, "Ignoring corrupt cache file '%s' for model %s", cacheFileName.c_str(), model->name.c_str());
+				matTextures.clear();
+				return false;
+			}
+		}
+
+		if (pos != buf.size()) {
+			matTextures.clear();
+			return false;
+		}
+	}
+
+	model->numPieces = cachedPieces.size();
+
+	for (CachedPiece& cp: cachedPieces) {
+		SAssPiece* piece = AllocPiece();
+
+		piece->name = std::move(cp.name);
+		piece->vertices = std::move(cp.vertices);
+		piece->indices = std::move(cp.indices);
+
+		piece->offset = cp.offset;
+		piece->scales = cp.scales;
+		piece->mins = cp.mins;
+		piece->maxs = cp.maxs;
+
+		piece->SetBakedMatrix(cp.bakedMatrix);
+		piece->SetNumTexCoorChannels(cp.numTexCoorChannels);
+
+		// appending children in flattened order reproduces their original order
+		if (cp.parentIndex >= 0) {
+			piece->parent = model->GetPiece(cp.parentIndex);
+			piece->parent->children.push_back(piece);
+		}
+
+		model->AddPiece(piece);
+	}
+
+	LOG_SL(LOG_SECTION_MODEL, L_INFO, "Loaded %d pieces of model %s from cache file '%s'", model->numPieces, model->name.c_str(), cacheFileName.c_str());
+	return true;
+}
+
+void CAssParser::SaveCachedPieces(const S3DModel* model, const std::vector<std::string>& matTextures, const std::string& cacheFileName)
+{
+	std::vector<uint8_t> buf;
+
+	WriteCacheValue(buf, ASS_CACHE_MAGIC);
+	WriteCacheValue(buf, ASS_CACHE_VERSION);
+	WriteCacheValue(buf, uint32_t(matTextures.size()));
+
+	for (const std::string& textureFile: matTextures) {
+		WriteCacheString(buf, textureFile);
+	}
+
+	WriteCacheValue(buf, uint32_t(model->pieceObjects.size()));
+
+	for (const S3DModelPiece* omp: model->pieceObjects) {
+		const SAssPiece* piece = static_cast<const SAssPiece*>(omp);
+		const auto parentIter = std::find(model->pieceObjects.begin(), model->pieceObjects.end(), piece->parent);
+
+		WriteCacheString(buf, piece->name);
+		WriteCacheValue(buf, int32_t((piece->parent != nullptr)? (parentIter - model->pieceObjects.begin()): -1));
+		WriteCacheData(buf, &piece->bakedMatrix.m[0], 16);
+		WriteCacheData(buf, &piece->offset.x, 3);
+		WriteCacheData(buf, &piece->scales.x, 3);
+		WriteCacheData(buf, &piece->mins.x, 3);
+		WriteCacheData(buf, &piece->maxs.x, 3);
+		WriteCacheValue(buf, uint32_t(piece->GetNumTexCoorChannels()));
+		WriteCacheValue(buf, uint32_t(piece->vertices.size()));
+		WriteCacheData(buf, piece->vertices.data(), piece->vertices.size());
+		WriteCacheValue(buf, uint32_t(piece->indices.size()));
+		WriteCacheData(buf, piece->indices.data(), piece->indices.size());
+	}
+
+	const std::string filePath = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+	// models are parsed by multiple threads, two of which might share a file
+	const std::string tempPath = filePath + ".tmp" + IntToString(ThreadPool::GetThreadNum());
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return;
+
+		file.write(reinterpret_cast<const char*>(buf.data()), buf.size());
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return;
+		}
+	}
+
+	// rename does not replace existing files on every platform
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0)
+		std::remove(tempPath.c_str());
+}
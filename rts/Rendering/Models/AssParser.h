@@ -117,14 +117,19 @@ private:
 	static void BuildPieceHierarchy(S3DModel* model, ModelPieceMap& pieceMap, const ParentNameMap& parentMap);
 	static void CalculateModelDimensions(S3DModel* model, S3DModelPiece* piece);
 	static void CalculateModelProperties(S3DModel* model, const LuaTable& pieceTable);
+	static void GetMaterialTextures(const aiScene* scene, std::vector<std::string>& matTextures);
 	static void FindTextures(
 		S3DModel* model,
-		const aiScene* scene,
+		const std::vector<std::string>& matTextures,
 		const LuaTable& pieceTable,
 		const std::string& modelPath,
 		const std::string& modelName
 	);
 
+	std::string GetCacheFileName(const std::vector<unsigned char>& fileBuffer, const std::string& metaFileName) const;
+	bool LoadCachedPieces(S3DModel* model, std::vector<std::string>& matTextures, const std::string& cacheFileName);
+	static void SaveCachedPieces(const S3DModel* model, const std::vector<std::string>& matTextures, const std::string& cacheFileName);
+
 private:
 	unsigned int maxIndices = 0;
 	unsigned int maxVertices = 0;
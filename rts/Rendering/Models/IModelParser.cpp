@@ -8,6 +8,7 @@
 #include "Rendering/Textures/S3OTextureHandler.h"
 #include "Net/Protocol/NetProtocol.h" // NETLOG
 #include "Sim/Misc/CollisionVolume.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
@@ -15,10 +16,18 @@
 #include "System/Exceptions.h"
 #include "System/MainDefines.h" // SNPRINTF
 #include "System/SafeUtil.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Platform/Threading.h"
 #include "System/Threading/ThreadPool.h"
 #include "lib/assimp/include/assimp/Importer.hpp"
 
 
+CONFIG(float, ModelUploadTimeBudget)
+	.defaultValue(1.0f)
+	.minimumValue(0.0f)
+	.description("Milliseconds per frame spent uploading the render data of models that were preloaded in the background; at least one model is uploaded per frame while any are pending.");
+
+
 CModelLoader modelLoader;
 
 static C3DOParser g3DOParser;
@@ -129,6 +138,11 @@ void CModelLoader::Init()
 	models.clear();
 	models.resize(MAX_MODEL_OBJECTS);
 
+	parsingModels.clear();
+	preloadedModels.clear();
+
+	uploadTimeBudget = configHandler->GetFloat("ModelUploadTimeBudget");
+
 	// dummy first model, legitimate model IDs start at 1
 	models[0] = std::move(CreateDummyModel(numModels = 0));
 }
@@ -224,6 +238,32 @@ void CModelLoader::PreloadModel(const std::string& modelName)
 	});
 }
 
+void CModelLoader::PreloadModels(const std::vector<std::string>& names)
+{
+	// models already cached or being parsed elsewhere are skipped by LoadModel
+	for_mt(0, names.size(), [&](const int i) {
+		LoadModel(names[i], true);
+	});
+}
+
+void CModelLoader::UploadPreloadedModels()
+{
+	assert(Threading::IsMainThread());
+
+	// see LogErrors
+	if (preloadedModels.empty())
+		return;
+
+	const spring_time endTime = spring_now() + spring_msecs(uploadTimeBudget);
+
+	std::lock_guard<spring::mutex> lock(mutex);
+
+	do {
+		UploadRenderData(&models[preloadedModels.back()]);
+		preloadedModels.pop_back();
+	} while (!preloadedModels.empty() && spring_now() < endTime);
+}
+
 void CModelLoader::LogErrors()
 {
 	assert(Threading::IsMainThread());
@@ -259,7 +299,20 @@ S3DModel* CModelLoader::LoadModel(std::string name, bool preload)
 	StringToLowerInPlace(name);
 
 	{
-		std::lock_guard<spring::mutex> lock(mutex);
+		std::unique_lock<spring::mutex> lock(mutex);
+
+		const auto IsParsing = [&]() {
+			return (std::find(parsingModels.begin(), parsingModels.end(), name) != parsingModels.end());
+		};
+
+		// some other thread is parsing this model already; a preload
+		// has nothing left to do, anyone else waits until it is cached
+		if (IsParsing()) {
+			if (preload)
+				return nullptr;
+
+			parsedCond.wait(lock, [&]() { return (!IsParsing()); });
+		}
 
 		// search in cache first
 		for (const auto& ref: refs) {
@@ -271,6 +324,8 @@ S3DModel* CModelLoader::LoadModel(std::string name, bool preload)
 			// expensive, delay until needed
 			path = FindModelPath(name);
 		}
+
+		parsingModels.push_back(name);
 	}
 
 	// not found in cache, create the model and cache it
@@ -308,6 +363,8 @@ S3DModel* CModelLoader::CreateModel(
 		assert(model.GetRootPiece() != nullptr);
 
 		model.SetPieceMatrices();
+		// simplification is done here so it also runs on the preload threads
+		model.CreateMeshLODs();
 
 		if (!preload)
 			UploadRenderData(&model);
@@ -315,6 +372,9 @@ S3DModel* CModelLoader::CreateModel(
 	{
 		std::lock_guard<spring::mutex> lock(mutex);
 
+		parsingModels.erase(std::find(parsingModels.begin(), parsingModels.end(), name));
+		parsedCond.notify_all();
+
 		// discard loaded model and return dummy if at limit
 		if (numModels >= MAX_MODEL_OBJECTS) {
 			errors.emplace_back(name, "numModels >= MAX_MODEL_OBJECTS");
@@ -328,6 +388,10 @@ S3DModel* CModelLoader::CreateModel(
 		cache[name] = model.id;
 		cache[path] = model.id;
 
+		// render data is uploaded by the main thread in small batches
+		if (preload)
+			preloadedModels.push_back(model.id);
+
 		*pmodel = std::move(model);
 	}
 
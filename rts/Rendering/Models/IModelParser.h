@@ -32,6 +32,10 @@ public:
 
 	bool IsValid() const { return (!formats.empty()); }
 	void PreloadModel(const std::string& name);
+	/// parses <names> in parallel, render data is uploaded later by the main thread
+	void PreloadModels(const std::vector<std::string>& names);
+	/// uploads preloaded models until the per-frame time budget is spent
+	void UploadPreloadedModels();
 	void LogErrors();
 
 public:
@@ -58,10 +62,19 @@ private:
 	ParserMap parsers;
 
 	spring::mutex mutex;
+	// signalled whenever a model in <parsingModels> is added to the cache
+	spring::condition_variable parsedCond;
 
 	std::vector<S3DModel> models;
 	std::vector< std::pair<std::string, std::string> > errors;
 
+	// names of models currently being parsed by some thread
+	std::vector<std::string> parsingModels;
+	// ids of preloaded models whose render data is not uploaded yet
+	std::vector<unsigned int> preloadedModels;
+
+	float uploadTimeBudget = 0.0f;
+
 	// all unique models loaded so far
 	unsigned int numModels = 0;
 };
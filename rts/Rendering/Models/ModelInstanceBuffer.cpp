@@ -0,0 +1,91 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+
+#include "ModelInstanceBuffer.h"
+#include "Rendering/GL/myGL.h"
+
+static_assert(sizeof(float4) == (sizeof(float) * 4), "");
+static_assert(sizeof(CMatrix44f) == (sizeof(float4) * 4), "");
+
+
+void CModelInstanceBuffer::Init()
+{
+	GLint maxNumTexels = 0;
+	glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxNumTexels);
+
+	if ((numTexels = std::min(MAX_NUM_TEXELS, size_t(std::max(maxNumTexels, 0)))) == 0)
+		return;
+
+	buffer = VBO(GL_TEXTURE_BUFFER);
+	buffer.Bind();
+	buffer.New(numTexels * sizeof(float4), GL_STREAM_DRAW);
+	buffer.Unbind();
+
+	glGenTextures(1, &textureID);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, textureID);
+	glTexBuffer(GL_TEXTURE_BUFFER, GL_RGBA32F, buffer.GetId());
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, 0);
+
+	mappedPos = 0;
+	cursorPos = 0;
+}
+
+void CModelInstanceBuffer::Kill()
+{
+	if (textureID != 0)
+		glDeleteTextures(1, &textureID);
+
+	textureID = 0;
+	numTexels = 0;
+
+	buffer.Release();
+}
+
+
+float4* CModelInstanceBuffer::MapBlocks(size_t numMapTexels)
+{
+	if (numMapTexels == 0 || numMapTexels > numTexels)
+		return nullptr;
+
+	buffer.Bind();
+
+	if ((cursorPos + numMapTexels) > numTexels) {
+		// orphan the current storage; draws issued from it are unaffected
+		// (VBO::Invalidate can not be used, New is a no-op for equal sizes)
+		glBufferData(GL_TEXTURE_BUFFER, numTexels * sizeof(float4), nullptr, GL_STREAM_DRAW);
+		cursorPos = 0;
+	}
+
+	float4* texels = reinterpret_cast<float4*>(buffer.MapBuffer(cursorPos * sizeof(float4), numMapTexels * sizeof(float4), GL_WRITE_ONLY));
+
+	if (texels == nullptr) {
+		UnmapBlocks();
+		return nullptr;
+	}
+
+	mappedPos = cursorPos;
+	cursorPos += numMapTexels;
+	return texels;
+}
+
+void CModelInstanceBuffer::UnmapBlocks()
+{
+	buffer.UnmapBuffer();
+	buffer.Unbind();
+}
+
+
+void CModelInstanceBuffer::BindTexture() const
+{
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, textureID);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+}
+
+void CModelInstanceBuffer::UnbindTexture() const
+{
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + TEXTURE_UNIT);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_BUFFER, 0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+}
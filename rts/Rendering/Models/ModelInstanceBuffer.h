@@ -0,0 +1,103 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MODEL_INSTANCE_BUFFER_H
+#define MODEL_INSTANCE_BUFFER_H
+
+#include <vector>
+
+#include "Rendering/GL/VBO.h"
+#include "System/float4.h"
+#include "System/Matrix44f.h"
+
+class CSolidObject;
+
+/**
+ * Streaming RGBA32F texture-buffer holding one block of texels per drawn
+ * model instance, laid out as {teamColor, texLayers, modelMatrix,
+ * pieceMatrices[]} and fetched by ModelVertProg via gl_InstanceID.
+ * Blocks are handed out by a write-cursor that orphans the storage when
+ * it wraps around, such that ranges mapped earlier in a frame stay intact
+ * for their draw-calls.
+ */
+class CModelInstanceBuffer {
+public:
+	static constexpr size_t MAX_NUM_TEXELS = 1 << 20; // 16MB
+	static constexpr unsigned int TEXTURE_UNIT = 5;
+
+	void Init();
+	void Kill();
+
+	// returns nullptr if <numTexels> exceeds the buffer capacity
+	float4* MapBlocks(size_t numTexels);
+	void UnmapBlocks();
+
+	void BindTexture() const;
+	void UnbindTexture() const;
+
+	bool IsValid() const { return (textureID != 0); }
+
+	// texel-offset of the range returned by the last MapBlocks call
+	size_t GetMappedOffset() const { return mappedPos; }
+
+	static size_t GetBlockSize(size_t numPieceMats) { return (1 + 1 + 4 + numPieceMats * 4); }
+	static void WriteBlock(
+		float4* block,
+		const float4& teamColor,
+		const float4& texLayers,
+		const CMatrix44f& modelMat,
+		const CMatrix44f* pieceMats,
+		size_t numPieceMats
+	) {
+		block[0] = teamColor;
+		block[1] = texLayers;
+
+		for (size_t i = 0; i < 4; i++) {
+			block[2 + i] = modelMat.col[i];
+		}
+		for (size_t i = 0; i < numPieceMats * 4; i++) {
+			block[6 + i] = pieceMats[i >> 2].col[i & 3];
+		}
+	}
+
+private:
+	VBO buffer;
+
+	unsigned int textureID = 0;
+
+	size_t numTexels = 0;
+	size_t mappedPos = 0;
+	size_t cursorPos = 0;
+};
+
+
+// default-material objects gathered by an opaque pass for the instanced
+// path; every bin is a contiguous range of <objects> sharing textures
+struct InstancedModelBatch {
+public:
+	struct Bin {
+		int mdlType;
+		int texType;
+
+		size_t objectsBeg;
+		size_t objectsEnd;
+	};
+
+	void Clear() {
+		objects.clear();
+		texelOffsets.clear();
+		bins.clear();
+	}
+
+	void AddBin(int mdlType, int texType) { bins.push_back({mdlType, texType, objects.size(), objects.size()}); }
+	void AddObject(CSolidObject* o) { objects.push_back(o); bins.back().objectsEnd = objects.size(); }
+
+	bool Empty() const { return objects.empty(); }
+
+public:
+	std::vector<CSolidObject*> objects;
+	// offset of each object's block relative to the mapped range
+	std::vector<size_t> texelOffsets;
+	std::vector<Bin> bins;
+};
+
+#endif
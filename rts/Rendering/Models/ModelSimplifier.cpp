@@ -0,0 +1,244 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "ModelSimplifier.h"
+#include "3DModel.h"
+
+#include <algorithm>
+#include <array>
+#include <queue>
+
+#include "System/UnorderedMap.hpp"
+
+namespace ModelSimplifier {
+	// symmetric 4x4 error quadric, upper triangle
+	struct Quadric {
+		Quadric() { q.fill(0.0); }
+		Quadric(double a, double b, double c, double d) {
+			q = {{a * a, a * b, a * c, a * d, b * b, b * c, b * d, c * c, c * d, d * d}};
+		}
+
+		Quadric& operator += (const Quadric& o) {
+			for (size_t i = 0; i < q.size(); i++) {
+				q[i] += o.q[i];
+			}
+			return *this;
+		}
+
+		double Eval(const float3& p) const {
+			const double x = p.x;
+			const double y = p.y;
+			const double z = p.z;
+
+			return (
+				q[0] * x * x + 2.0 * q[1] * x * y + 2.0 * q[2] * x * z + 2.0 * q[3] * x +
+				q[4] * y * y + 2.0 * q[5] * y * z + 2.0 * q[6] * y +
+				q[7] * z * z + 2.0 * q[8] * z +
+				q[9]
+			);
+		}
+
+		std::array<double, 10> q;
+	};
+
+	struct Collapse {
+		bool operator < (const Collapse& c) const { return (cost > c.cost); }
+
+		float cost;
+
+		uint32_t srcVert;
+		uint32_t dstVert;
+		uint32_t srcStamp;
+		uint32_t dstStamp;
+	};
+
+
+	static float3 TriangleNormal(const float3& p0, const float3& p1, const float3& p2) {
+		return ((p1 - p0).cross(p2 - p0));
+	}
+
+	static uint64_t EdgeKey(uint32_t a, uint32_t b) {
+		return ((uint64_t(std::min(a, b)) << 32) | std::max(a, b));
+	}
+
+
+	void Simplify(
+		const std::vector<SVertexData>& verts,
+		const std::vector<uint32_t>& indcs,
+		size_t targetIndexCount,
+		float maxError,
+		std::vector<uint32_t>& outIndcs
+	) {
+		outIndcs.clear();
+
+		const size_t numVerts = verts.size();
+		const size_t numTris = indcs.size() / 3;
+
+		std::vector<uint32_t> tris(indcs.begin(), indcs.begin() + numTris * 3);
+		std::vector<uint8_t> deadTris(numTris, 0);
+
+		std::vector<Quadric> quadrics(numVerts);
+		std::vector<std::vector<uint32_t>> vertTris(numVerts);
+
+		std::vector<uint32_t> vertStamps(numVerts, 0);
+		std::vector<uint8_t> lockedVerts(numVerts, 0);
+		std::vector<uint8_t> deadVerts(numVerts, 0);
+
+		spring::unordered_map<uint64_t, uint32_t> edgeUses;
+
+		size_t numLiveTris = numTris;
+
+		for (size_t t = 0; t < numTris; t++) {
+			const uint32_t* tri = &tris[t * 3];
+
+			if (tri[0] >= numVerts || tri[1] >= numVerts || tri[2] >= numVerts) {
+				// malformed input, leave the piece as it is
+				outIndcs = indcs;
+				return;
+			}
+
+			float3 n = TriangleNormal(verts[tri[0]].pos, verts[tri[1]].pos, verts[tri[2]].pos);
+
+			if (n.SqLength() > 0.0f)
+				n.ANormalize();
+
+			const Quadric tq(n.x, n.y, n.z, -n.dot(verts[tri[0]].pos));
+
+			for (int k = 0; k < 3; k++) {
+				quadrics[tri[k]] += tq;
+				vertTris[tri[k]].push_back(t);
+				edgeUses[EdgeKey(tri[k], tri[(k + 1) % 3])] += 1;
+			}
+		}
+
+		// open edges are either real borders or seams where the vertex was split
+		// (different normals or UVs); moving their endpoints would tear the mesh
+		for (const auto& p: edgeUses) {
+			if (p.second != 1)
+				continue;
+
+			lockedVerts[p.first >> 32] = 1;
+			lockedVerts[p.first & 0xFFFFFFFFu] = 1;
+		}
+
+		std::priority_queue<Collapse> collapses;
+
+		const auto PushCollapse = [&](uint32_t src, uint32_t dst) {
+			if (lockedVerts[src])
+				return;
+
+			Quadric q = quadrics[src];
+			q += quadrics[dst];
+
+			collapses.push({float(q.Eval(verts[dst].pos)), src, dst, vertStamps[src], vertStamps[dst]});
+		};
+
+		for (const auto& p: edgeUses) {
+			PushCollapse(p.first >> 32, p.first & 0xFFFFFFFFu);
+			PushCollapse(p.first & 0xFFFFFFFFu, p.first >> 32);
+		}
+
+		while (!collapses.empty() && (numLiveTris * 3) > targetIndexCount) {
+			const Collapse c = collapses.top();
+			collapses.pop();
+
+			if (c.cost > maxError)
+				break;
+
+			const uint32_t src = c.srcVert;
+			const uint32_t dst = c.dstVert;
+
+			// stale entries refer to vertices that died or whose quadric changed
+			if (deadVerts[src] || deadVerts[dst])
+				continue;
+			if (vertStamps[src] != c.srcStamp || vertStamps[dst] != c.dstStamp)
+				continue;
+
+			bool sharedEdge = false;
+			bool flipsFace = false;
+
+			for (const uint32_t t: vertTris[src]) {
+				if (deadTris[t])
+					continue;
+
+				const uint32_t* tri = &tris[t * 3];
+
+				if (tri[0] == dst || tri[1] == dst || tri[2] == dst) {
+					sharedEdge = true;
+					continue;
+				}
+
+				float3 p[3];
+
+				for (int k = 0; k < 3; k++) {
+					p[k] = verts[tri[k]].pos;
+				}
+
+				const float3 n0 = TriangleNormal(p[0], p[1], p[2]);
+
+				for (int k = 0; k < 3; k++) {
+					p[k] = (tri[k] == src)? verts[dst].pos: p[k];
+				}
+
+				const float3 n1 = TriangleNormal(p[0], p[1], p[2]);
+
+				if ((flipsFace = (n0.dot(n1) <= 0.0f)))
+					break;
+			}
+
+			if (!sharedEdge || flipsFace)
+				continue;
+
+			for (const uint32_t t: vertTris[src]) {
+				if (deadTris[t])
+					continue;
+
+				uint32_t* tri = &tris[t * 3];
+
+				if (tri[0] == dst || tri[1] == dst || tri[2] == dst) {
+					deadTris[t] = 1;
+					numLiveTris -= 1;
+					continue;
+				}
+
+				for (int k = 0; k < 3; k++) {
+					tri[k] = (tri[k] == src)? dst: tri[k];
+				}
+
+				vertTris[dst].push_back(t);
+			}
+
+			quadrics[dst] += quadrics[src];
+			deadVerts[src] = 1;
+			vertStamps[dst] += 1;
+
+			vertTris[src].clear();
+
+			// re-evaluate every edge whose cost depends on dst's quadric
+			for (const uint32_t t: vertTris[dst]) {
+				if (deadTris[t])
+					continue;
+
+				for (int k = 0; k < 3; k++) {
+					const uint32_t v = tris[t * 3 + k];
+
+					if (v == dst)
+						continue;
+
+					PushCollapse(v, dst);
+					PushCollapse(dst, v);
+				}
+			}
+		}
+
+		outIndcs.reserve(numLiveTris * 3);
+
+		for (size_t t = 0; t < numTris; t++) {
+			if (deadTris[t])
+				continue;
+
+			outIndcs.push_back(tris[t * 3 + 0]);
+			outIndcs.push_back(tris[t * 3 + 1]);
+			outIndcs.push_back(tris[t * 3 + 2]);
+		}
+	}
+}
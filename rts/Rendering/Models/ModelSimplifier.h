@@ -0,0 +1,32 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MODEL_SIMPLIFIER_H
+#define MODEL_SIMPLIFIER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct SVertexData;
+
+namespace ModelSimplifier {
+	/**
+	 * Quadric-error edge-collapse simplification of one piece's triangle list.
+	 * Vertices are only ever collapsed onto other existing vertices, so the
+	 * result is a new index list over the unchanged vertex array. Vertices on
+	 * open edges (including UV seams, which split vertices) never move, which
+	 * keeps piece outlines and seams crack-free.
+	 *
+	 * @param targetIndexCount stop once the list has shrunk to this many indices
+	 * @param maxError stop before any collapse whose quadric error exceeds this (squared world-units)
+	 */
+	void Simplify(
+		const std::vector<SVertexData>& verts,
+		const std::vector<uint32_t>& indcs,
+		size_t targetIndexCount,
+		float maxError,
+		std::vector<uint32_t>& outIndcs
+	);
+}
+
+#endif
@@ -0,0 +1,72 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef OBJECT_CULLER_H
+#define OBJECT_CULLER_H
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+#include "Rendering/Models/ModelRenderContainer.h"
+#include "System/Threading/ThreadPool.h"
+
+/**
+ * Runs the visibility test of a draw-pass over a flat list of objects on
+ * the ThreadPool. Results are kept in insertion order, so the submitting
+ * loop (which has to stay on the render thread) consumes them in step via
+ * NextResult instead of testing every object itself. Tests must not have
+ * side-effects beyond the object they are given.
+ */
+template<typename TObject> class CObjectCuller {
+public:
+	enum {
+		CULL_RESULT_HIDDEN = 0,
+		CULL_RESULT_FARTEX = 1, // outside draw-distance, queue as far-texture
+		CULL_RESULT_INVIEW = 2,
+	};
+
+	// below this many objects the tests are cheaper than waking the pool
+	static constexpr size_t MIN_PARALLEL_OBJECTS = 64;
+
+	void Clear() {
+		objects.clear();
+		results.clear();
+
+		readPos = 0;
+	}
+
+	void AddObjects(const std::vector<TObject*>& objs) { objects.insert(objects.end(), objs.begin(), objs.end()); }
+	void AddObjects(const ModelRenderContainer<TObject>& mdlRenderer) {
+		for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
+			AddObjects(mdlRenderer.GetObjectBin(i));
+		}
+	}
+
+	template<typename CullFunc> void Cull(const CullFunc& cullFunc) {
+		results.resize(objects.size());
+		readPos = 0;
+
+		if (objects.size() < MIN_PARALLEL_OBJECTS) {
+			for (size_t i = 0, n = objects.size(); i < n; i++) {
+				results[i] = cullFunc(objects[i]);
+			}
+
+			return;
+		}
+
+		for_mt(0, objects.size(), [&](const int i) { results[i] = cullFunc(objects[i]); });
+	}
+
+	uint8_t NextResult() {
+		assert(readPos < results.size());
+		return results[readPos++];
+	}
+
+private:
+	std::vector<TObject*> objects;
+	std::vector<uint8_t> results;
+
+	size_t readPos = 0;
+};
+
+#endif
@@ -0,0 +1,316 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <cstring>
+
+#include "OcclusionCuller.h"
+#include "Game/Camera.h"
+#include "Rendering/GlobalRendering.h"
+#include "Rendering/GL/myGL.h"
+#include "Rendering/Shaders/Shader.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/Log/ILog.h"
+#include "System/TimeProfiler.h"
+
+CONFIG(bool, TerrainOcclusionCulling).defaultValue(true).headlessValue(false).description("Skip drawing units and features hidden behind terrain, based on the terrain depth of the previous frame.");
+
+COcclusionCuller occlusionCuller;
+
+
+void COcclusionCuller::Init()
+{
+	#ifndef HEADLESS
+	if (!(enabled = configHandler->GetBool("TerrainOcclusionCulling")))
+		return;
+
+	{
+		glGenTextures(1, &depthTileTexID);
+		glBindTexture(GL_TEXTURE_2D, depthTileTexID);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, NUM_DEPTH_TILES_X, NUM_DEPTH_TILES_Y, 0, GL_RED, GL_FLOAT, nullptr);
+		glBindTexture(GL_TEXTURE_2D, 0);
+	}
+
+	// both FBOs are no-op constructed, initialize them manually
+	depthCopyFBO.Init(false);
+	depthTileFBO.Init(false);
+
+	if (!depthCopyFBO.IsValid() || !depthTileFBO.IsValid()) {
+		Kill();
+		return;
+	}
+
+	depthTileFBO.Bind();
+	depthTileFBO.AttachTexture(depthTileTexID, GL_TEXTURE_2D, GL_COLOR_ATTACHMENT0);
+
+	if (!depthTileFBO.CheckStatus("OCCLUSION-DEPTHTILES")) {
+		FBO::Unbind();
+		Kill();
+		return;
+	}
+
+	FBO::Unbind();
+
+	for (VBO& pbo: depthTilePBOs) {
+		pbo = VBO(GL_PIXEL_PACK_BUFFER);
+		pbo.Bind();
+		pbo.New(NUM_DEPTH_TILES_X * NUM_DEPTH_TILES_Y * sizeof(float), GL_STREAM_READ);
+		pbo.Unbind();
+	}
+
+	{
+		const std::string& vsText = Shader::GetShaderSource("GLSL/DepthTileVertProg.glsl");
+		const std::string& fsText = Shader::GetShaderSource("GLSL/DepthTileFragProg.glsl");
+
+		const std::array<VA_TYPE_2d0, 6> verts = {{
+			{-1.0f, -1.0f}, { 1.0f, -1.0f}, { 1.0f,  1.0f},
+			{ 1.0f,  1.0f}, {-1.0f,  1.0f}, {-1.0f, -1.0f},
+		}};
+
+		depthTileQuad.Init(false);
+		depthTileQuad.Upload2D0(verts.size(), 0, verts.data(), nullptr); // no indices
+
+		Shader::GLSLShaderObject shaderObjs[2] = {{GL_VERTEX_SHADER, vsText, ""}, {GL_FRAGMENT_SHADER, fsText, ""}};
+		Shader::IProgramObject* shaderProg = depthTileQuad.CreateShader((sizeof(shaderObjs) / sizeof(shaderObjs[0])), 0, &shaderObjs[0], nullptr);
+
+		shaderProg->Enable();
+		shaderProg->SetUniform("u_depth_tex", 0);
+		shaderProg->SetUniform("u_depth_size", 1, 1);
+		shaderProg->SetUniform("u_tile_count", int(NUM_DEPTH_TILES_X), int(NUM_DEPTH_TILES_Y));
+		shaderProg->Disable();
+
+		if (!shaderProg->IsValid()) {
+			Kill();
+			return;
+		}
+	}
+
+	depthTiles.clear();
+	depthTiles.resize(NUM_DEPTH_TILES_X * NUM_DEPTH_TILES_Y, 1.0f);
+
+	depthCopySize = {0, 0};
+	numCaptures = 0;
+
+	haveTiles = false;
+	clipDepth01 = globalRendering->supportClipSpaceControl;
+	#endif
+}
+
+void COcclusionCuller::Kill()
+{
+	glDeleteTextures(1, &depthCopyTexID);
+	glDeleteTextures(1, &depthTileTexID);
+
+	depthCopyTexID = 0;
+	depthTileTexID = 0;
+
+	depthCopyFBO.Kill();
+	depthTileFBO.Kill();
+	depthTileQuad.Kill();
+
+	for (VBO& pbo: depthTilePBOs) {
+		pbo.Release();
+	}
+
+	depthTiles.clear();
+
+	enabled = false;
+	haveTiles = false;
+}
+
+
+bool COcclusionCuller::CreateDepthCopyTexture(const int2 size)
+{
+	GLint depthBits = 0;
+	GLint stencilBits = 0;
+
+	// depth blits require matching formats, mirror that of the default FB
+	glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, GL_DEPTH, GL_FRAMEBUFFER_ATTACHMENT_DEPTH_SIZE, &depthBits);
+	glGetFramebufferAttachmentParameteriv(GL_READ_FRAMEBUFFER, GL_STENCIL, GL_FRAMEBUFFER_ATTACHMENT_STENCIL_SIZE, &stencilBits);
+
+	GLenum texFormat = GL_DEPTH_COMPONENT24;
+	GLenum dataFormat = GL_DEPTH_COMPONENT;
+	GLenum dataType = GL_UNSIGNED_INT;
+	GLenum attachment = GL_DEPTH_ATTACHMENT;
+
+	switch (depthBits) {
+		case 16: { texFormat = GL_DEPTH_COMPONENT16; } break;
+		case 32: { texFormat = GL_DEPTH_COMPONENT32; } break;
+		default: {} break;
+	}
+
+	if (stencilBits > 0) {
+		texFormat = (depthBits == 32)? GL_DEPTH32F_STENCIL8: GL_DEPTH24_STENCIL8;
+		dataFormat = GL_DEPTH_STENCIL;
+		dataType = (depthBits == 32)? GL_FLOAT_32_UNSIGNED_INT_24_8_REV: GL_UNSIGNED_INT_24_8;
+		attachment = GL_DEPTH_STENCIL_ATTACHMENT;
+	}
+
+	glDeleteTextures(1, &depthCopyTexID);
+	glGenTextures(1, &depthCopyTexID);
+	glBindTexture(GL_TEXTURE_2D, depthCopyTexID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, texFormat, size.x, size.y, 0, dataFormat, dataType, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	depthCopyFBO.Bind();
+	depthCopyFBO.AttachTexture(depthCopyTexID, GL_TEXTURE_2D, attachment);
+
+	// the window can be resized at any time, so retry on the next capture
+	if (!depthCopyFBO.CheckStatus("OCCLUSION-DEPTHCOPY")) {
+		depthCopySize = {0, 0};
+		return false;
+	}
+
+	depthCopySize = size;
+	return true;
+}
+
+void COcclusionCuller::CaptureDepth()
+{
+	if (!enabled)
+		return;
+
+	SCOPED_TIMER("Draw::World::OcclusionCapture");
+
+	// fetch the tiles captured last frame before overwriting anything
+	ReadDepthTiles();
+
+	GLint curDrawFBO = 0;
+	glGetIntegerv(GL_DRAW_FRAMEBUFFER_BINDING, &curDrawFBO);
+
+	// only the default framebuffer is known to hold the terrain depth
+	if (curDrawFBO != 0)
+		return;
+
+	const int2 viewPos = {globalRendering->viewPosX, globalRendering->viewPosY};
+	const int2 viewSize = {globalRendering->viewSizeX, globalRendering->viewSizeY};
+
+	// binds depthCopyFBO
+	if (viewSize != depthCopySize && !CreateDepthCopyTexture(viewSize)) {
+		glBindFramebuffer(GL_FRAMEBUFFER, curDrawFBO);
+		return;
+	}
+
+	// copy the terrain depth, multisampled buffers are resolved by the blit
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, curDrawFBO);
+	glBindFramebuffer(GL_DRAW_FRAMEBUFFER, depthCopyFBO.fboId);
+	glBlitFramebuffer(viewPos.x, viewPos.y, viewPos.x + viewSize.x, viewPos.y + viewSize.y,  0, 0, viewSize.x, viewSize.y,  GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+
+	{
+		// reduce it to the farthest depth per tile
+		depthTileFBO.Bind();
+
+		glAttribStatePtr->PushBits(GL_ENABLE_BIT | GL_DEPTH_BUFFER_BIT | GL_COLOR_BUFFER_BIT);
+		glAttribStatePtr->PushViewPort(0, 0, NUM_DEPTH_TILES_X, NUM_DEPTH_TILES_Y);
+		glAttribStatePtr->DisableDepthTest();
+		glAttribStatePtr->DisableDepthMask();
+		glAttribStatePtr->DisableBlendMask();
+
+		glActiveTexture(GL_TEXTURE0);
+		glBindTexture(GL_TEXTURE_2D, depthCopyTexID);
+
+		Shader::IProgramObject* shader = &depthTileQuad.GetShader();
+
+		shader->Enable();
+		shader->SetUniform("u_depth_size", viewSize.x, viewSize.y);
+		depthTileQuad.Submit(GL_TRIANGLES, 0, 6);
+		shader->Disable();
+
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		glAttribStatePtr->PopViewPort();
+		glAttribStatePtr->PopBits();
+	}
+	{
+		// start the asynchronous read-back, consumed next frame
+		const unsigned int pboIdx = (numCaptures++) & 1;
+
+		glBindFramebuffer(GL_READ_FRAMEBUFFER, depthTileFBO.fboId);
+		glReadBuffer(GL_COLOR_ATTACHMENT0);
+
+		depthTilePBOs[pboIdx].Bind();
+		glReadPixels(0, 0, NUM_DEPTH_TILES_X, NUM_DEPTH_TILES_Y, GL_RED, GL_FLOAT, nullptr);
+		depthTilePBOs[pboIdx].Unbind();
+
+		depthTileMats[pboIdx] = camera->GetViewProjectionMatrix();
+	}
+
+	glBindFramebuffer(GL_FRAMEBUFFER, curDrawFBO);
+}
+
+void COcclusionCuller::ReadDepthTiles()
+{
+	if (numCaptures == 0)
+		return;
+
+	// the PBO written by the previous capture
+	const unsigned int pboIdx = (numCaptures - 1) & 1;
+
+	VBO& pbo = depthTilePBOs[pboIdx];
+
+	pbo.Bind();
+
+	const float* tiles = reinterpret_cast<const float*>(pbo.MapBuffer(GL_READ_ONLY));
+
+	if (tiles != nullptr) {
+		std::memcpy(depthTiles.data(), tiles, depthTiles.size() * sizeof(float));
+
+		depthTileMat = depthTileMats[pboIdx];
+		haveTiles = true;
+	}
+
+	pbo.UnmapBuffer();
+	pbo.Unbind();
+}
+
+
+bool COcclusionCuller::IsOccluded(const float3& pos, float radius) const
+{
+	if (!haveTiles)
+		return false;
+
+	float3 mins = { 1e9f,  1e9f,  1e9f};
+	float3 maxs = {-1e9f, -1e9f, -1e9f};
+
+	// project the corners of the sphere's bounding box
+	for (int i = 0; i < 8; i++) {
+		const float3 corner = pos + float3(((i & 1) * 2 - 1) * radius, (((i >> 1) & 1) * 2 - 1) * radius, (((i >> 2) & 1) * 2 - 1) * radius);
+		const float4 clip = depthTileMat * float4(corner.x, corner.y, corner.z, 1.0f);
+
+		// crosses the near-plane
+		if (clip.w <= 0.0001f)
+			return false;
+
+		const float3 ndc = float3(clip.x, clip.y, clip.z) / clip.w;
+
+		mins = float3::min(mins, ndc);
+		maxs = float3::max(maxs, ndc);
+	}
+
+	// outside of the captured view, no information
+	if (mins.x < -1.0f || mins.y < -1.0f || maxs.x > 1.0f || maxs.y > 1.0f)
+		return false;
+
+	const int x0 = std::min(int((mins.x * 0.5f + 0.5f) * NUM_DEPTH_TILES_X), int(NUM_DEPTH_TILES_X - 1));
+	const int x1 = std::min(int((maxs.x * 0.5f + 0.5f) * NUM_DEPTH_TILES_X), int(NUM_DEPTH_TILES_X - 1));
+	const int y0 = std::min(int((mins.y * 0.5f + 0.5f) * NUM_DEPTH_TILES_Y), int(NUM_DEPTH_TILES_Y - 1));
+	const int y1 = std::min(int((maxs.y * 0.5f + 0.5f) * NUM_DEPTH_TILES_Y), int(NUM_DEPTH_TILES_Y - 1));
+
+	if (((x1 - x0 + 1) * (y1 - y0 + 1)) > int(MAX_TESTED_TILES))
+		return false;
+
+	// window-space depth of the nearest corner
+	const float minDepth = clipDepth01? mins.z: (mins.z * 0.5f + 0.5f);
+
+	for (int y = y0; y <= y1; y++) {
+		for (int x = x0; x <= x1; x++) {
+			if (depthTiles[y * NUM_DEPTH_TILES_X + x] >= minDepth)
+				return false;
+		}
+	}
+
+	return true;
+}
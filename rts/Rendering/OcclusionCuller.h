@@ -0,0 +1,80 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef OCCLUSION_CULLER_H
+#define OCCLUSION_CULLER_H
+
+#include <array>
+#include <vector>
+
+#include "Rendering/GL/FBO.h"
+#include "Rendering/GL/RenderDataBuffer.hpp"
+#include "Rendering/GL/VBO.h"
+#include "System/float3.h"
+#include "System/Matrix44f.h"
+#include "System/type2.h"
+
+/**
+ * Culls objects hidden behind terrain from the player's view. Right after
+ * the ground pass the depth-buffer only contains terrain; it is reduced on
+ * the GPU to a grid of tiles each holding the farthest depth it covers and
+ * read back through a pair of PBOs, such that the CPU receives the tiles of
+ * frame N-1 during frame N without stalling. Bounding spheres are projected
+ * with the view of the frame their tiles were captured in, and an object is
+ * occluded if every tile it covers lies in front of its nearest point. The
+ * one-frame lag only means objects emerging from behind terrain can appear
+ * one frame late.
+ */
+class COcclusionCuller {
+public:
+	COcclusionCuller(): depthCopyFBO(true), depthTileFBO(true) {}
+
+	void Init();
+	void Kill();
+
+	// called by CWorldDrawer after the terrain is drawn in the main pass
+	void CaptureDepth();
+
+	// may be called from the ThreadPool; objects are never occluded while
+	// culling is disabled or before the first tiles have been read back
+	bool IsOccluded(const float3& pos, float radius) const;
+
+public:
+	static constexpr unsigned int NUM_DEPTH_TILES_X = 256;
+	static constexpr unsigned int NUM_DEPTH_TILES_Y = 128;
+	// spheres covering more tiles are assumed to be visible, testing them
+	// costs more than drawing a few extra objects
+	static constexpr unsigned int MAX_TESTED_TILES = 1024;
+
+private:
+	bool CreateDepthCopyTexture(const int2 size);
+	void ReadDepthTiles();
+
+private:
+	FBO depthCopyFBO;
+	FBO depthTileFBO;
+
+	GL::RenderDataBuffer depthTileQuad;
+
+	std::array<VBO, 2> depthTilePBOs;
+	// view-projection matrices the PBO contents were captured with
+	std::array<CMatrix44f, 2> depthTileMats;
+
+	// tiles used by IsOccluded, bottom row first
+	std::vector<float> depthTiles;
+	CMatrix44f depthTileMat;
+
+	unsigned int depthCopyTexID = 0;
+	unsigned int depthTileTexID = 0;
+
+	int2 depthCopySize;
+
+	unsigned int numCaptures = 0;
+
+	bool enabled = false;
+	bool haveTiles = false;
+	bool clipDepth01 = false;
+};
+
+extern COcclusionCuller occlusionCuller;
+
+#endif
@@ -2,6 +2,10 @@
 
 #include "Screenshot.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
 #include <vector>
 
 #include "Rendering/GL/myGL.h"
@@ -12,11 +16,13 @@
 #include "System/Log/ILog.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/SimpleParser.h"
 #include "System/Threading/ThreadPool.h"
 
 #undef CreateDirectory
 
 CONFIG(int, ScreenshotCounter).defaultValue(0);
+CONFIG(int, ScreenshotMaxPendingEncodes).defaultValue(4).minimumValue(1).description("Number of captured frames allowed to wait for (or be in) encoding before further frames of a /screenshot sequence are dropped.");
 
 struct FunctionArgs
 {
@@ -26,33 +32,219 @@ struct FunctionArgs
 	int y;
 };
 
-void TakeScreenshot(std::string type)
+// readbacks go through a ring of pixel-pack buffers and are only mapped once
+// their fence has signaled (normally a frame or two later), so capturing does
+// not stall the pipeline; a sequence drops frames rather than waiting when the
+// ring or the encoders fall behind
+struct ReadbackSlot
 {
-	if (type.empty())
-		type = "jpg";
+	std::string filename;
 
-	if (!FileSystem::CreateDirectory("screenshots"))
-		return;
+	GLuint pbo = 0;
+	GLsync fence = 0;
 
-	FunctionArgs args;
+	int x = 0;
+	int y = 0;
+};
+
+static constexpr unsigned int NUM_READBACK_SLOTS = 3;
+
+static std::array<ReadbackSlot, NUM_READBACK_SLOTS> readbackSlots;
+static std::atomic<int> numPendingEncodes = {0};
+
+// non-empty while a sequence is being captured
+static std::string sequenceType;
+static std::string sequencePrefix;
+
+static unsigned int sequenceFrame = 0;
+static unsigned int sequenceDrops = 0;
+
+static int maxPendingEncodes = 0;
+
+
+static void GetScreenshotSize(FunctionArgs& args)
+{
 	args.x  = globalRendering->dualScreenMode? globalRendering->viewSizeX << 1: globalRendering->viewSizeX;
 	args.y  = globalRendering->viewSizeY;
 	args.x += ((4 - (args.x % 4)) * int((args.x % 4) != 0));
+}
 
+static std::string GetNextScreenshotName(const std::string& prefix)
+{
 	const int shotCounter = configHandler->GetInt("ScreenshotCounter");
 
 	// note: we no longer increment the counter until a "file not found" occurs
 	// since that stalls the thread and might run concurrently with an IL write
-	args.filename.assign("screenshots/screen" + IntToString(shotCounter, "%05d") + "." + type);
-	args.pixelbuf.resize(args.x * args.y * 4);
-
 	configHandler->Set("ScreenshotCounter", shotCounter + 1);
 
-	glReadPixels(0, 0, args.x, args.y, GL_RGBA, GL_UNSIGNED_BYTE, &args.pixelbuf[0]);
+	return ("screenshots/" + prefix + IntToString(shotCounter, "%05d"));
+}
+
+static void EncodeScreenshot(FunctionArgs&& args)
+{
+	numPendingEncodes += 1;
 
 	ThreadPool::Enqueue([](const FunctionArgs& args) {
 		CBitmap bmp(&args.pixelbuf[0], args.x, args.y);
 		bmp.ReverseYAxis();
 		bmp.Save(args.filename, true, true);
-	}, args);
+
+		numPendingEncodes -= 1;
+	}, std::move(args));
+}
+
+
+#ifndef HEADLESS
+static bool QueueReadback(std::string&& filename)
+{
+	const auto iter = std::find_if(readbackSlots.begin(), readbackSlots.end(), [](const ReadbackSlot& s) { return (s.fence == 0); });
+
+	if (iter == readbackSlots.end())
+		return false;
+
+	ReadbackSlot& slot = *iter;
+	FunctionArgs args;
+
+	GetScreenshotSize(args);
+
+	if (slot.pbo == 0)
+		glGenBuffers(1, &slot.pbo);
+
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+
+	// reallocate only when the view was resized
+	if (args.x != slot.x || args.y != slot.y)
+		glBufferData(GL_PIXEL_PACK_BUFFER, args.x * args.y * 4, nullptr, GL_STREAM_READ);
+
+	glReadPixels(0, 0, args.x, args.y, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+	slot.filename = std::move(filename);
+	slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	slot.x = args.x;
+	slot.y = args.y;
+	return true;
+}
+
+static void CollectReadbacks()
+{
+	for (ReadbackSlot& slot: readbackSlots) {
+		if (slot.fence == 0)
+			continue;
+
+		const GLenum waitRet = glClientWaitSync(slot.fence, 0, 0);
+
+		if (waitRet == GL_TIMEOUT_EXPIRED)
+			continue;
+
+		glDeleteSync(slot.fence);
+		slot.fence = 0;
+
+		if (waitRet == GL_WAIT_FAILED)
+			continue;
+
+		FunctionArgs args;
+		args.filename = std::move(slot.filename);
+		args.pixelbuf.resize(slot.x * slot.y * 4);
+		args.x = slot.x;
+		args.y = slot.y;
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pbo);
+
+		const uint8_t* mem = reinterpret_cast<const uint8_t*>(glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, args.pixelbuf.size(), GL_MAP_READ_BIT));
+
+		if (mem != nullptr) {
+			std::memcpy(args.pixelbuf.data(), mem, args.pixelbuf.size());
+			glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+		}
+
+		glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+		if (mem != nullptr)
+			EncodeScreenshot(std::move(args));
+	}
+}
+#endif
+
+
+void TakeScreenshot(std::string type)
+{
+	const std::vector<std::string> words = CSimpleParser::Tokenize(type, 0);
+	const bool sequence = (words.size() > 1 && words[1] == "sequence");
+
+	type = words.empty()? "jpg": words[0];
+
+	if (!FileSystem::CreateDirectory("screenshots"))
+		return;
+
+	if (sequence) {
+		if (!sequenceType.empty()) {
+			LOG("[%s] stopped sequence after %u frames (%u dropped)", __func__, sequenceFrame, sequenceDrops);
+			sequenceType.clear();
+			return;
+		}
+
+		// one counter value per sequence, frames are numbered within it
+		sequenceType = type;
+		sequencePrefix = GetNextScreenshotName("seq") + "_";
+		sequenceFrame = 0;
+		sequenceDrops = 0;
+
+		maxPendingEncodes = configHandler->GetInt("ScreenshotMaxPendingEncodes");
+
+		LOG("[%s] capturing every frame to %s*.%s", __func__, sequencePrefix.c_str(), type.c_str());
+		return;
+	}
+
+	std::string filename = GetNextScreenshotName("screen") + "." + type;
+
+	#ifndef HEADLESS
+	// single shots are never dropped, only read back synchronously if the ring is full
+	if (QueueReadback(std::move(filename)))
+		return;
+	#endif
+
+	FunctionArgs args;
+	GetScreenshotSize(args);
+
+	args.filename = std::move(filename);
+	args.pixelbuf.resize(args.x * args.y * 4);
+
+	glReadPixels(0, 0, args.x, args.y, GL_RGBA, GL_UNSIGNED_BYTE, &args.pixelbuf[0]);
+
+	EncodeScreenshot(std::move(args));
+}
+
+void UpdateScreenshots()
+{
+	#ifndef HEADLESS
+	CollectReadbacks();
+
+	if (sequenceType.empty())
+		return;
+
+	// frames are numbered without gaps so external encoders can consume them as-is
+	if (numPendingEncodes < maxPendingEncodes && QueueReadback(sequencePrefix + IntToString(sequenceFrame, "%06d") + "." + sequenceType)) {
+		sequenceFrame += 1;
+		return;
+	}
+
+	sequenceDrops += 1;
+	#endif
+}
+
+void KillScreenshots()
+{
+	#ifndef HEADLESS
+	for (ReadbackSlot& slot: readbackSlots) {
+		if (slot.fence != 0)
+			glDeleteSync(slot.fence);
+		if (slot.pbo != 0)
+			glDeleteBuffers(1, &slot.pbo);
+
+		slot = {};
+	}
+	#endif
+
+	sequenceType.clear();
 }
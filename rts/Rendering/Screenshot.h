@@ -5,6 +5,10 @@
 
 #include <string>
 
+/// "[type] [sequence]"; a sequence captures every frame until toggled off
 void TakeScreenshot(std::string type);
+/// called once per drawn frame, collects finished readbacks and advances a sequence
+void UpdateScreenshots();
+void KillScreenshots();
 
 #endif
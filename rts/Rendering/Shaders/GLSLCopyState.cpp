@@ -178,7 +178,7 @@ static void CopyUniforms(GLuint newProgID, GLuint oldProgID, spring::unordered_m
 	if (maxUniformNameLength >= sizeof(name))
 		return;
 
-	glUseProgram(newProgID);
+	glAttribStatePtr->UseProgram(newProgID);
 
 	for (int i = 0; i < numUniforms; ++i) {
 		GLsizei nameLength = 0;
@@ -291,7 +291,7 @@ static void CopyUniforms(GLuint newProgID, GLuint oldProgID, spring::unordered_m
 		}
 	}
 
-	glUseProgram(0);
+	glAttribStatePtr->UseProgram(0);
 }
 
 
@@ -246,12 +246,12 @@ namespace Shader {
 	}
 
 	void GLSLProgramObject::EnableRaw() {
-		glUseProgram(glid);
+		glAttribStatePtr->UseProgram(glid);
 		IProgramObject::Enable();
 	}
 	void GLSLProgramObject::DisableRaw() {
 		IProgramObject::Disable();
-		glUseProgram(0);
+		glAttribStatePtr->UseProgram(0);
 	}
 
 
@@ -263,6 +263,20 @@ namespace Shader {
 		if ((glid = glCreateProgram()) == 0)
 			return false;
 
+		// key for the persistent binary cache; <hash> already covers sources and flags
+		unsigned int binHash = hash;
+		unsigned int binSize = 0;
+
+		for (const IShaderObject* so: shaderObjs) {
+			binSize += so->GetSrc(true).size();
+		}
+		for (const std::string& varying: feedbackVaryings) {
+			binHash = HsiehHash(varying.data(), varying.size(), binHash);
+		}
+
+		if (shaderHandler->LoadProgramBinary(glid, binHash, binSize))
+			return true;
+
 		for (IShaderObject*& so: shaderObjs) {
 			// NOTE:
 			//   cso will call glDeleteShader when it goes out of scope
@@ -286,12 +300,30 @@ namespace Shader {
 		if (!shadersValid)
 			return false;
 
+		if (!feedbackVaryings.empty()) {
+			std::vector<const GLchar*> varyingPtrs;
+			varyingPtrs.reserve(feedbackVaryings.size());
+
+			for (const std::string& varying: feedbackVaryings) {
+				varyingPtrs.push_back(varying.c_str());
+			}
+
+			glTransformFeedbackVaryings(glid, varyingPtrs.size(), varyingPtrs.data(), GL_INTERLEAVED_ATTRIBS);
+		}
+
+		if (shaderHandler->UseProgramBinaryCache())
+			shaderHandler->SetBinaryRetrievable(glid);
+
 		glLinkProgram(glid);
 
 		// append the linker-log
 		log.append(glslGetLog(glid));
 
-		return (glslIsValid(glid));
+		if (!glslIsValid(glid))
+			return false;
+
+		shaderHandler->SaveProgramBinary(glid, binHash, binSize);
+		return true;
 	}
 
 	bool GLSLProgramObject::CopyUniformsAndValidate(unsigned int tgtProgID, unsigned int srcProgID)
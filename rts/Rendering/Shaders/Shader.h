@@ -354,6 +354,7 @@ namespace Shader {
 		GLSLProgramObject& operator = (const GLSLProgramObject& po) = delete;
 		GLSLProgramObject& operator = (GLSLProgramObject&& po) {
 			uniformHashes = std::move(po.uniformHashes);
+			feedbackVaryings = std::move(po.feedbackVaryings);
 
 			IProgramObject::operator = (std::move(po));
 			return *this;
@@ -377,6 +378,9 @@ namespace Shader {
 		void ReloadShaderObjects();
 		void RecalculateShaderHash();
 
+		// outputs captured (interleaved) by transform-feedback; must be set before Link
+		void SetFeedbackVaryings(const std::vector<std::string>& varyings) { feedbackVaryings = varyings; }
+
 	public:
 		int GetUniformLoc(const char* name) const override;
 		int GetUniformType(int idx) const override;
@@ -448,6 +452,7 @@ namespace Shader {
 
 	private:
 		std::vector<size_t> uniformHashes;
+		std::vector<std::string> feedbackVaryings;
 	};
 
 
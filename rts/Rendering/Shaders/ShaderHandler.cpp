@@ -2,9 +2,69 @@
 
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/Sync/HsiehHash.h"
 
 #include <cassert>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+CONFIG(bool, UseShaderBinaryCache).defaultValue(true).safemodeValue(false).headlessValue(false).description("Store linked shader programs in the cache-dir and load them from there on later runs instead of recompiling.");
+
+
+static constexpr char PROGRAM_BINARY_MAGIC[8] = {'S', 'P', 'R', 'G', 'B', 'I', 'N', '\0'};
+static constexpr unsigned int PROGRAM_BINARY_VERSION = 1;
+
+struct ProgramBinaryHeader {
+	char magic[8];
+
+	std::uint32_t version;
+	std::uint32_t srcHash;
+	std::uint32_t srcSize;
+	std::uint32_t drvHash;
+	std::uint32_t binFormat;
+	std::uint32_t binSize;
+};
+
+static unsigned int GetDriverHash()
+{
+	// a driver update invalidates every binary, fold in all identifying strings
+	static const unsigned int drvHash = []() {
+		const GLenum names[] = {GL_VENDOR, GL_RENDERER, GL_VERSION, GL_SHADING_LANGUAGE_VERSION};
+
+		unsigned int hash = 127;
+
+		for (const GLenum name: names) {
+			const char* str = reinterpret_cast<const char*>(glGetString(name));
+
+			if (str == nullptr)
+				continue;
+
+			hash = HsiehHash(str, strlen(str), hash);
+		}
+
+		return hash;
+	}();
+
+	return drvHash;
+}
+
+static std::string GetProgramBinaryDir() {
+	return (FileSystem::GetCacheDir() + "/shaders/");
+}
+
+static std::string GetProgramBinaryFileName(unsigned int srcHash, unsigned int drvHash)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%08x-%08x.bin", srcHash, drvHash);
+	return (GetProgramBinaryDir() + buf);
+}
 
 
 CShaderHandler* CShaderHandler::GetInstance()
@@ -110,6 +170,130 @@ Shader::IProgramObject* CShaderHandler::CreateProgramObject(const std::string& p
 }
 
 
+bool CShaderHandler::UseProgramBinaryCache() const
+{
+	static const bool useBinaryCache = configHandler->GetBool("UseShaderBinaryCache");
+
+	if (!useBinaryCache)
+		return false;
+
+	GLint numBinaryFormats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &numBinaryFormats);
+
+	// some drivers support the API but no formats at all
+	return (numBinaryFormats > 0);
+}
+
+void CShaderHandler::SetBinaryRetrievable(unsigned int progID) const
+{
+	glProgramParameteri(progID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+}
+
+bool CShaderHandler::LoadProgramBinary(unsigned int progID, unsigned int srcHash, unsigned int srcSize)
+{
+	if (!UseProgramBinaryCache())
+		return false;
+
+	const unsigned int drvHash = GetDriverHash();
+	const std::string fileName = GetProgramBinaryFileName(srcHash, drvHash);
+
+	if (!FileSystem::FileExists(fileName))
+		return false;
+
+	const std::string filePath = dataDirsAccess.LocateFile(fileName);
+
+	std::ifstream file(filePath, std::ios::in | std::ios::binary);
+	ProgramBinaryHeader header;
+
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+
+	// a hash collision (or stale version) is caught by the size and magic checks
+	if (std::memcmp(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic)) != 0)
+		return false;
+	if (header.version != PROGRAM_BINARY_VERSION || header.srcHash != srcHash || header.srcSize != srcSize || header.drvHash != drvHash)
+		return false;
+
+	std::vector<char> binary(header.binSize);
+
+	if (!file.read(binary.data(), binary.size()))
+		return false;
+
+	glProgramBinary(progID, header.binFormat, binary.data(), binary.size());
+
+	GLint linkStatus = 0;
+	glGetProgramiv(progID, GL_LINK_STATUS, &linkStatus);
+
+	if (linkStatus == 0) {
+		// driver rejected the binary; drop it so it gets rebuilt
+		file.close();
+		std::remove(filePath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+bool CShaderHandler::SaveProgramBinary(unsigned int progID, unsigned int srcHash, unsigned int srcSize)
+{
+	if (!UseProgramBinaryCache())
+		return false;
+
+	GLint binSize = 0;
+	glGetProgramiv(progID, GL_PROGRAM_BINARY_LENGTH, &binSize);
+
+	if (binSize <= 0)
+		return false;
+	if (!FileSystem::CreateDirectory(GetProgramBinaryDir()))
+		return false;
+
+	ProgramBinaryHeader header;
+	std::vector<char> binary(binSize);
+
+	GLenum binFormat = 0;
+	glGetProgramBinary(progID, binSize, nullptr, &binFormat, binary.data());
+
+	std::memcpy(header.magic, PROGRAM_BINARY_MAGIC, sizeof(header.magic));
+
+	header.version = PROGRAM_BINARY_VERSION;
+	header.srcHash = srcHash;
+	header.srcSize = srcSize;
+	header.drvHash = GetDriverHash();
+	header.binFormat = binFormat;
+	header.binSize = binSize;
+
+	const std::string filePath = dataDirsAccess.LocateFile(GetProgramBinaryFileName(srcHash, header.drvHash), FileQueryFlags::WRITE);
+	// another process may be reading the same cache, never expose a partial file
+	const std::string tempPath = filePath + ".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(binary.data(), binary.size());
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return false;
+		}
+	}
+
+	// rename does not replace existing files on every platform
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
 Shader::IShaderObject* CShaderHandler::CreateShaderObject(const std::string& soName, const std::string& soDefs, int soType)
 {
 	assert(!soName.empty());
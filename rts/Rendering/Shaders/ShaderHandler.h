@@ -111,6 +111,20 @@ public:
 	const ShaderCache& GetShaderCache() const { return shaderCache; }
 	      ShaderCache& GetShaderCache()       { return shaderCache; }
 
+	/**
+	 * Persistent cache of linked program binaries under the cache-dir,
+	 * keyed by a hash (and the length) of all sources and definitions
+	 * plus the GL driver. Load links <progID> from a cached binary and
+	 * returns false if there was none or the driver rejected it; Save
+	 * must be called after a successful link of a program created with
+	 * the retrievable-binary hint (see SetBinaryRetrievable).
+	 */
+	bool LoadProgramBinary(unsigned int progID, unsigned int srcHash, unsigned int srcSize);
+	bool SaveProgramBinary(unsigned int progID, unsigned int srcHash, unsigned int srcSize);
+	void SetBinaryRetrievable(unsigned int progID) const;
+
+	bool UseProgramBinaryCache() const;
+
 private:
 	// [0] := game-created programs, by name
 	// [1] := menu-created (persistent) programs, by name
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 #include <cfloat>
+#include <cstring>
 
 #include "ShadowHandler.h"
 #include "Game/Camera.h"
@@ -18,6 +19,7 @@
 #include "Rendering/Env/ITreeDrawer.h"
 #include "Rendering/GL/FBO.h"
 #include "Rendering/GL/myGL.h"
+#include "Rendering/Models/ModelInstanceBuffer.h"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "System/Config/ConfigHandler.h"
@@ -30,6 +32,7 @@
 
 CONFIG(int, Shadows).defaultValue(2).headlessValue(-1).minimumValue(-1).safemodeValue(-1).description("Sets whether shadows are rendered.\n-1:=forceoff, 0:=off, 1:=full, 2:=fast (skip terrain)"); //FIXME document bitmask
 CONFIG(int, ShadowMapSize).defaultValue(CShadowHandler::DEF_SHADOWMAP_SIZE).minimumValue(32).description("Sets the resolution of shadows. Higher numbers increase quality at the cost of performance.");
+CONFIG(int, ShadowStaticCasterCache).defaultValue(30).minimumValue(0).description("Maximum number of shadow updates a cached layer containing only static casters (terrain, features, trees) is reused for while the shadow projection stays unchanged; terrain deformation and feature changes refresh it sooner. 0 disables caching.");
 
 CShadowHandler shadowHandler;
 
@@ -65,11 +68,17 @@ void CShadowHandler::Init()
 	shadowMapSize = configHandler->GetInt("ShadowMapSize");
 	shadowGenBits = SHADOWGEN_BIT_NONE;
 
+	staticCasterCacheFrames = configHandler->GetInt("ShadowStaticCasterCache");
+	staticCasterLayerAge = 0;
+
 	shadowsLoaded = false;
 	inShadowPass = false;
+	useStaticCasterCache = false;
+	staticCastersDirty = true;
 
 	shadowTexture = 0;
 	dummyColorTexture = 0;
+	staticCasterTexture = 0;
 
 	if (!tmpFirstInit && !shadowsSupported)
 		return;
@@ -112,6 +121,17 @@ void CShadowHandler::Init()
 		return;
 	}
 
+	if (!(useStaticCasterCache = InitStaticCasterTarget())) {
+		if (staticCasterFBO.IsValid()) {
+			staticCasterFBO.Bind();
+			staticCasterFBO.DetachAll();
+			staticCasterFBO.Unbind();
+		}
+
+		staticCasterFBO.Kill();
+		glDeleteTextures(1, &staticCasterTexture); staticCasterTexture = 0;
+	}
+
 	LoadProjectionMatrix(CCameraHandler::GetCamera(CCamera::CAMTYPE_SHADOW));
 	LoadShadowGenShaders();
 }
@@ -130,10 +150,20 @@ void CShadowHandler::FreeTextures() {
 		shadowMapFBO.Unbind();
 	}
 
+	if (staticCasterFBO.IsValid()) {
+		staticCasterFBO.Bind();
+		staticCasterFBO.DetachAll();
+		staticCasterFBO.Unbind();
+	}
+
 	shadowMapFBO.Kill();
+	staticCasterFBO.Kill();
+
+	glDeleteTextures(1, &shadowTexture      ); shadowTexture       = 0;
+	glDeleteTextures(1, &dummyColorTexture  ); dummyColorTexture   = 0;
+	glDeleteTextures(1, &staticCasterTexture); staticCasterTexture = 0;
 
-	glDeleteTextures(1, &shadowTexture    ); shadowTexture     = 0;
-	glDeleteTextures(1, &dummyColorTexture); dummyColorTexture = 0;
+	useStaticCasterCache = false;
 }
 
 
@@ -239,10 +269,14 @@ void CShadowHandler::LoadShadowGenShaders()
 		po->SetUniformLocation("$dummy$"      ); // idx 6, unused
 		po->SetUniformLocation("alphaMaskTex" ); // idx 7
 		po->SetUniformLocation("alphaTestCtrl"); // idx 8
+		po->SetUniformLocation("treeMatTex"   ); // idx 9
+		po->SetUniformLocation("treeMatOffset"); // idx 10
 
 		po->Enable();
 		po->SetUniform1i(7, 0);
 		po->SetUniform2f(8, 0.5f, 0.5f);
+		po->SetUniform1i(9, CModelInstanceBuffer::TEXTURE_UNIT);
+		po->SetUniform1i(10, -1);
 		po->Disable();
 		po->Validate();
 	}
@@ -258,6 +292,13 @@ void CShadowHandler::LoadShadowGenShaders()
 		po->SetUniformLocation("shadowProjMat"); // idx 2
 		po->SetUniformLocation("modelMat"     ); // idx 3
 		po->SetUniformLocation("pieceMats"    ); // idx 4
+		po->SetUniformLocation("flyingPieceData"  ); // idx 5
+		po->SetUniformLocation("flyingPieceParams"); // idx 6
+
+		po->Enable();
+		po->SetUniform1i(5, CGPUFlyingPieceDrawer::TEXTURE_UNIT);
+		po->SetUniform3f(6, 0.0f, 0.0f, 0.0f);
+		po->Disable();
 		po->Validate();
 	}
 	{
@@ -345,6 +386,46 @@ bool CShadowHandler::InitDepthTarget()
 }
 
 
+bool CShadowHandler::InitStaticCasterTarget()
+{
+	// drivers that need a dummy color attachment for depth-only FBO's
+	// are not trusted to blit between them, skip caching in that case
+	if (staticCasterCacheFrames <= 0 || dummyColorTexture != 0)
+		return false;
+
+	staticCasterFBO.Init(false);
+
+	if (!staticCasterFBO.IsValid())
+		return false;
+
+	// the depth-blit into shadowMapFBO requires identical formats, and
+	// WorkaroundUnsupportedFboRenderTargets might have picked another one
+	GLint texFormat = GL_DEPTH_COMPONENT32;
+
+	glBindTexture(GL_TEXTURE_2D, shadowTexture);
+	glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_INTERNAL_FORMAT, &texFormat);
+
+	glGenTextures(1, &staticCasterTexture);
+	glBindTexture(GL_TEXTURE_2D, staticCasterTexture);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+	glTexImage2D(GL_TEXTURE_2D, 0, texFormat, shadowMapSize, shadowMapSize, 0, GL_DEPTH_COMPONENT, GL_FLOAT, nullptr);
+	glBindTexture(GL_TEXTURE_2D, 0);
+
+	staticCasterFBO.Bind();
+	staticCasterFBO.AttachTexture(staticCasterTexture, GL_TEXTURE_2D, GL_DEPTH_ATTACHMENT);
+
+	glDrawBuffer(GL_NONE);
+
+	const bool status = staticCasterFBO.CheckStatus("SHADOW-STATIC");
+
+	staticCasterFBO.Unbind();
+	return status;
+}
+
+
 bool CShadowHandler::WorkaroundUnsupportedFboRenderTargets()
 {
 	// some drivers/GPUs fail to render to GL_CLAMP_TO_BORDER (and GL_LINEAR may cause a drop in performance for them, too)
@@ -396,31 +477,42 @@ bool CShadowHandler::WorkaroundUnsupportedFboRenderTargets()
 }
 
 
-void CShadowHandler::DrawShadowPasses()
+void CShadowHandler::DrawShadowPasses(unsigned int casterTypes)
 {
+	const bool drawStatic  = ((casterTypes & SHADOWCASTER_STATIC ) != 0);
+	const bool drawDynamic = ((casterTypes & SHADOWCASTER_DYNAMIC) != 0);
+
 	inShadowPass = true;
 
 	glAttribStatePtr->PushBits(GL_ENABLE_BIT | GL_POLYGON_BIT);
 	glAttribStatePtr->EnableCullFace();
 	glAttribStatePtr->CullFace(GL_BACK);
 
-		eventHandler.DrawWorldShadow();
+		if (drawDynamic)
+			eventHandler.DrawWorldShadow();
 
 		if ((shadowGenBits & SHADOWGEN_BIT_TREE) != 0) {
 			currentShadowPass = SHADOWGEN_PROGRAM_TREE;
-			treeDrawer->DrawShadow();
-			grassDrawer->DrawShadow();
+
+			if (drawStatic)
+				treeDrawer->DrawShadow();
+			// grass is animated by wind
+			if (drawDynamic)
+				grassDrawer->DrawShadow();
 		}
 
-		if ((shadowGenBits & SHADOWGEN_BIT_PROJ) != 0) {
+		if ((shadowGenBits & SHADOWGEN_BIT_PROJ) != 0 && drawDynamic) {
 			currentShadowPass = SHADOWGEN_PROGRAM_PROJECTILE;
 			projectileDrawer->DrawShadowPass();
 		}
 
 		if ((shadowGenBits & SHADOWGEN_BIT_MODEL) != 0) {
 			currentShadowPass = SHADOWGEN_PROGRAM_MODEL;
-			unitDrawer->DrawShadowPass();
-			featureDrawer->DrawShadowPass();
+
+			if (drawDynamic)
+				unitDrawer->DrawShadowPass();
+			if (drawStatic)
+				featureDrawer->DrawShadowPass();
 		}
 
 		// cull front-faces during the terrain shadow pass: sun direction
@@ -438,7 +530,7 @@ void CShadowHandler::DrawShadowPasses()
 		// have changed culling at their own discretion
 		glAttribStatePtr->CullFace(GL_BACK);
 
-		if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0) {
+		if ((shadowGenBits & SHADOWGEN_BIT_MAP) != 0 && drawStatic) {
 			currentShadowPass = SHADOWGEN_PROGRAM_MAP;
 			readMap->GetGroundDrawer()->DrawShadowPass();
 		}
@@ -450,6 +542,39 @@ void CShadowHandler::DrawShadowPasses()
 	inShadowPass = false;
 }
 
+bool CShadowHandler::StaticCasterLayerStale()
+{
+	const CMatrix44f& svm = viewMatrix[SHADOWMAT_TYPE_DRAWING];
+
+	// any change in camera or sun direction moves the projection
+	staticCastersDirty |= (std::memcmp(&svm.m[0], &staticCasterViewMatrix.m[0], sizeof(svm.m)) != 0);
+	// catches changes without an event, e.g. features entering LOS
+	staticCastersDirty |= ((staticCasterLayerAge += 1) > staticCasterCacheFrames);
+	staticCastersDirty |= treeDrawer->HasFallingTrees();
+
+	return staticCastersDirty;
+}
+
+void CShadowHandler::DrawStaticCasterLayer()
+{
+	if (StaticCasterLayerStale()) {
+		staticCasterFBO.Bind();
+		glAttribStatePtr->Clear(GL_DEPTH_BUFFER_BIT);
+
+		DrawShadowPasses(SHADOWCASTER_STATIC);
+
+		staticCasterViewMatrix = viewMatrix[SHADOWMAT_TYPE_DRAWING];
+		staticCasterLayerAge = 0;
+		staticCastersDirty = false;
+
+		shadowMapFBO.Bind();
+	}
+
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, staticCasterFBO.fboId);
+	glBlitFramebuffer(0, 0, shadowMapSize, shadowMapSize,  0, 0, shadowMapSize, shadowMapSize,  GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+	glBindFramebuffer(GL_READ_FRAMEBUFFER, shadowMapFBO.fboId);
+}
+
 
 static CMatrix44f ComposeLightMatrix(const ISkyLight* light)
 {
@@ -590,8 +715,14 @@ void CShadowHandler::CreateShadows()
 	SetShadowMatrix(prvCam);
 	SetShadowCamera(curCam);
 
-	if ((sky->GetLight())->GetLightIntensity() > 0.0f)
-		DrawShadowPasses();
+	if ((sky->GetLight())->GetLightIntensity() > 0.0f) {
+		if (useStaticCasterCache) {
+			DrawStaticCasterLayer();
+			DrawShadowPasses(SHADOWCASTER_DYNAMIC);
+		} else {
+			DrawShadowPasses(SHADOWCASTER_ALL);
+		}
+	}
 
 
 	CCameraHandler::SetActiveCamera(prvCam->GetCamType());
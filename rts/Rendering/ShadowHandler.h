@@ -17,7 +17,7 @@ class CCamera;
 class CShadowHandler
 {
 public:
-	CShadowHandler(): shadowMapFBO(true) {}
+	CShadowHandler(): shadowMapFBO(true), staticCasterFBO(true) {}
 
 	void Init();
 	void Kill();
@@ -29,6 +29,9 @@ public:
 	void ResetShadowTexSamplerRaw() const;
 	void CreateShadows();
 
+	// forces the cached static-caster layer to be re-rendered next update
+	void InvalidateStaticCasters() { staticCastersDirty = true; }
+
 	enum ShadowGenerationBits {
 		SHADOWGEN_BIT_NONE  = 0,
 		SHADOWGEN_BIT_MAP   = 2,
@@ -51,6 +54,12 @@ public:
 		SHADOWGEN_PROGRAM_LAST       = 5,
 	};
 
+	enum ShadowCasterTypes {
+		SHADOWCASTER_STATIC  = 1, // terrain, features, trees
+		SHADOWCASTER_DYNAMIC = 2, // units, projectiles, grass, Lua
+		SHADOWCASTER_ALL     = 3,
+	};
+
 	enum ShadowMatrixType {
 		SHADOWMAT_TYPE_CULLING = 0,
 		SHADOWMAT_TYPE_DRAWING = 1,
@@ -77,11 +86,14 @@ public:
 	bool InShadowPass() const { return inShadowPass; }
 
 private:
-	void DrawShadowPasses();
+	void DrawShadowPasses(unsigned int casterTypes);
+	void DrawStaticCasterLayer();
 	void FreeTextures();
 
 	bool InitDepthTarget();
+	bool InitStaticCasterTarget();
 	bool WorkaroundUnsupportedFboRenderTargets();
+	bool StaticCasterLayerStale();
 
 	void LoadProjectionMatrix(const CCamera* shadowCam);
 	void LoadShadowGenShaders();
@@ -102,10 +114,17 @@ public:
 private:
 	unsigned int shadowTexture = 0;
 	unsigned int dummyColorTexture = 0;
+	unsigned int staticCasterTexture = 0;
 	unsigned int currentShadowPass = SHADOWGEN_PROGRAM_LAST;
 
+	// maximum number of updates the static-caster layer is reused for
+	int staticCasterCacheFrames = 0;
+	int staticCasterLayerAge = 0;
+
 	bool shadowsLoaded = false;
 	bool inShadowPass = false;
+	bool useStaticCasterCache = false;
+	bool staticCastersDirty = true;
 
 	static bool firstInit;
 	static bool shadowsSupported;
@@ -125,8 +144,12 @@ private:
 	CMatrix44f projMatrix[2];
 	CMatrix44f viewMatrix[2];
 	CMatrix44f biasMatrix = {OnesVector * 0.5f,  RgtVector * 0.5f, UpVector * 0.5f, FwdVector * 0.5f};
+	// drawing view-matrix the static-caster layer was rendered with
+	CMatrix44f staticCasterViewMatrix;
 
 	FBO shadowMapFBO;
+	// holds the depth of all static casters, copied into shadowMapFBO each update
+	FBO staticCasterFBO;
 };
 
 extern CShadowHandler shadowHandler;
@@ -9,6 +9,7 @@
 
 #ifndef BITMAP_NO_OPENGL
 	#include "Rendering/GL/myGL.h"
+	#include "Rendering/Textures/TextureCompressor.h"
 	#include "System/TimeProfiler.h"
 #endif
 
@@ -846,6 +847,47 @@ unsigned int CBitmap::CreateTexture(float aniso, float lodBias, bool mipmaps) co
 	return texture;
 }
 
+unsigned int CBitmap::CreateCompressedTexture(float aniso, float lodBias, bool mipmaps, int quality) const
+{
+	if (quality < 0)
+		quality = TextureCompressor::GetDefaultQuality();
+
+	if (compressed || channels != 4 || GetMemSize() == 0)
+		return CreateTexture(aniso, lodBias, mipmaps);
+
+	TextureCompressor::Image image;
+
+	if (!TextureCompressor::Compress(GetRawMem(), xsize, ysize, mipmaps, TextureCompressor::Quality(quality), image))
+		return CreateTexture(aniso, lodBias, mipmaps);
+
+	constexpr unsigned int intFormats[] = {GL_COMPRESSED_RGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGBA_S3TC_DXT5_EXT};
+
+	unsigned int texture = 0;
+
+	glGenTextures(1, &texture);
+	glBindTexture(GL_TEXTURE_2D, texture);
+
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, mipmaps? GL_LINEAR_MIPMAP_LINEAR: GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, image.levelOffsets.size() - 1);
+
+	if (lodBias != 0.0f)
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_LOD_BIAS, lodBias);
+	if (aniso > 0.0f)
+		glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, aniso);
+
+	for (size_t level = 0; level < image.levelOffsets.size(); level++) {
+		const int levelSizeX = std::max(xsize >> level, 1);
+		const int levelSizeY = std::max(ysize >> level, 1);
+
+		glCompressedTexImage2D(GL_TEXTURE_2D, level, intFormats[image.format], levelSizeX, levelSizeY, 0, image.GetLevelSize(level), &image.data[image.levelOffsets[level]]);
+	}
+
+	return texture;
+}
+
 
 static void HandleDDSMipmap(GLenum target, bool mipmaps, int num_mipmaps)
 {
@@ -943,6 +985,10 @@ unsigned int CBitmap::CreateTexture(float aniso, float lodBias, bool mipmaps) co
 	return 0;
 }
 
+unsigned int CBitmap::CreateCompressedTexture(float aniso, float lodBias, bool mipmaps, int quality) const {
+	return 0;
+}
+
 unsigned int CBitmap::CreateDDSTexture(unsigned int texID, float aniso, float lodBias, bool mipmaps) const {
 	return 0;
 }
@@ -49,6 +49,8 @@ public:
 	unsigned int CreateTexture(float aniso = 0.0f, float lodBias = 0.0f, bool mipmaps = false) const;
 	unsigned int CreateMipMapTexture(float aniso = 0.0f, float lodBias = 0.0f) const { return (CreateTexture(aniso, lodBias, true)); }
 	unsigned int CreateAnisoTexture(float aniso = 0.0f, float lodBias = 0.0f) const { return (CreateTexture(aniso, lodBias, false)); }
+	/// compresses RGBA images to BC1/BC3 first; quality -1 uses the BitmapTextureCompression setting
+	unsigned int CreateCompressedTexture(float aniso = 0.0f, float lodBias = 0.0f, bool mipmaps = false, int quality = -1) const;
 	unsigned int CreateDDSTexture(unsigned int texID = 0, float aniso = 0.0f, float lodBias = 0.0f, bool mipmaps = false) const;
 
 	void CreateAlpha(uint8_t red, uint8_t green, uint8_t blue);
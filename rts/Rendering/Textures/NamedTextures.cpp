@@ -5,12 +5,14 @@
 #include "NamedTextures.h"
 
 #include "Rendering/GL/myGL.h"
+#include "Rendering/GL/PBO.h"
 #include "Bitmap.h"
 #include "Rendering/GlobalRendering.h"
 #include "System/bitops.h"
 #include "System/type2.h"
 #include "System/Log/ILog.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/UnorderedMap.hpp"
 
 
@@ -23,6 +25,46 @@ namespace CNamedTextures {
 	static std::vector<size_t> freeIndices;
 	static std::vector<std::string> waitingTextures;
 
+	struct TexParams {
+		std::string filename;
+
+		bool border  = false;
+		bool clamped = false;
+		bool nearest = false;
+		bool linear  = false;
+		bool aniso   = false;
+		bool invert  = false;
+		bool greyed  = false;
+		bool tint    = false;
+		bool resize  = false;
+
+		float tintColor[3];
+		int2 resizeDimensions;
+	};
+
+	struct AsyncTex {
+		std::string texName;
+		unsigned int texID;
+
+		TexParams params;
+		CBitmap bitmap;
+
+		bool decoded;
+	};
+
+	// upper bound on the (uncompressed) bytes Update() uploads per frame,
+	// at least one finished request is always processed
+	static constexpr size_t MAX_ASYNC_UPLOAD_BYTES = 16 << 20;
+
+	// maps names of in-flight requests to their placeholder texture ids;
+	// results whose entry has vanished (Free, Kill) are discarded
+	static spring::unordered_map<std::string, unsigned int> asyncRequests;
+	static std::vector<AsyncTex> asyncResults;
+
+	// RR upload policy, same as HeightMapTexture
+	static PBO uploadPBOs[3];
+	static unsigned int numUploads = 0;
+
 	static spring::recursive_mutex mutex;
 
 	/******************************************************************************/
@@ -38,6 +80,11 @@ namespace CNamedTextures {
 
 		waitingTextures.clear();
 		waitingTextures.reserve(16);
+
+		asyncRequests.clear();
+		asyncRequests.reserve(16);
+		asyncResults.clear();
+		asyncResults.reserve(16);
 	}
 
 	void Kill(bool shutdown)
@@ -61,6 +108,21 @@ namespace CNamedTextures {
 
 		std::swap(texInfoMap, tempMap);
 		waitingTextures.clear();
+
+		for (auto it = asyncRequests.begin(); it != asyncRequests.end(); ) {
+			if (texInfoMap.find(it->first) == texInfoMap.end()) {
+				it = asyncRequests.erase(it);
+			} else {
+				++it;
+			}
+		}
+
+		if (!shutdown)
+			return;
+
+		for (PBO& pbo: uploadPBOs) {
+			pbo.Release();
+		}
 	}
 
 
@@ -123,6 +185,7 @@ namespace CNamedTextures {
 
 			freeIndices.push_back(texIdx);
 			texInfoMap.erase(it);
+			asyncRequests.erase(texName);
 			return true;
 		}
 
@@ -131,21 +194,13 @@ namespace CNamedTextures {
 
 
 
-	static bool Load(const std::string& texName, unsigned int texID)
+	static TexParams ParseTexParams(const std::string& texName)
 	{
 		// strip off the qualifiers
-		std::string filename = texName;
-		bool border  = false;
-		bool clamped = false;
-		bool nearest = false;
-		bool linear  = false;
-		bool aniso   = false;
-		bool invert  = false;
-		bool greyed  = false;
-		bool tint    = false;
-		float tintColor[3];
-		bool resize  = false;
-		int2 resizeDimensions;
+		TexParams params;
+		std::string& filename = params.filename;
+
+		filename = texName;
 
 		if (filename[0] == ':') {
 			size_t p;
@@ -153,26 +208,26 @@ namespace CNamedTextures {
 				const char ch = filename[p];
 
 				if (ch == ':')      { break; }
-				else if (ch == 'n') { nearest = true; }
-				else if (ch == 'l') { linear  = true; }
-				else if (ch == 'a') { aniso   = true; }
-				else if (ch == 'i') { invert  = true; }
-				else if (ch == 'g') { greyed  = true; }
-				else if (ch == 'c') { clamped = true; }
-				else if (ch == 'b') { border  = true; }
+				else if (ch == 'n') { params.nearest = true; }
+				else if (ch == 'l') { params.linear  = true; }
+				else if (ch == 'a') { params.aniso   = true; }
+				else if (ch == 'i') { params.invert  = true; }
+				else if (ch == 'g') { params.greyed  = true; }
+				else if (ch == 'c') { params.clamped = true; }
+				else if (ch == 'b') { params.border  = true; }
 				else if (ch == 't') {
 					const char* cstr = filename.c_str() + p + 1;
 					const char* start = cstr;
 					char* endptr;
-					tintColor[0] = (float)strtod(start, &endptr);
+					params.tintColor[0] = (float)strtod(start, &endptr);
 					if ((start != endptr) && (*endptr == ',')) {
 						start = endptr + 1;
-						tintColor[1] = (float)strtod(start, &endptr);
+						params.tintColor[1] = (float)strtod(start, &endptr);
 						if ((start != endptr) && (*endptr == ',')) {
 							start = endptr + 1;
-							tintColor[2] = (float)strtod(start, &endptr);
+							params.tintColor[2] = (float)strtod(start, &endptr);
 							if (start != endptr) {
-								tint = true;
+								params.tint = true;
 								p += (endptr - cstr);
 							}
 						}
@@ -182,12 +237,12 @@ namespace CNamedTextures {
 					const char* cstr = filename.c_str() + p + 1;
 					const char* start = cstr;
 					char* endptr;
-					resizeDimensions.x = (int)strtoul(start, &endptr, 10);
+					params.resizeDimensions.x = (int)strtoul(start, &endptr, 10);
 					if ((start != endptr) && (*endptr == ',')) {
 						start = endptr + 1;
-						resizeDimensions.y = (int)strtoul(start, &endptr, 10);
+						params.resizeDimensions.y = (int)strtoul(start, &endptr, 10);
 						if (start != endptr) {
-							resize = true;
+							params.resize = true;
 							p += (endptr - cstr);
 						}
 					}
@@ -201,63 +256,119 @@ namespace CNamedTextures {
 			}
 		}
 
-		// get the image
-		CBitmap bitmap;
-		TexInfo texInfo;
+		return params;
+	}
 
-		if (!bitmap.Load(filename)) {
-			LOG_L(L_WARNING, "[NamedTextures::%s] could not load texture \"%s\"", __func__, filename.c_str());
-			GenInsertTex(texName, texInfo, false, false, true, false);
+	// does not touch GL state, safe to call from worker threads
+	static bool DecodeTex(const TexParams& params, CBitmap& bitmap)
+	{
+		// get the image
+		if (!bitmap.Load(params.filename)) {
+			LOG_L(L_WARNING, "[NamedTextures::%s] could not load texture \"%s\"", __func__, params.filename.c_str());
 			return false;
 		}
 
-		if (bitmap.compressed) {
-			texID = bitmap.CreateDDSTexture(texID);
-		} else {
-			if (resize) bitmap = bitmap.CreateRescaled(resizeDimensions.x, resizeDimensions.y);
-			if (invert) bitmap.InvertColors();
-			if (greyed) bitmap.MakeGrayScale();
-			if (tint)   bitmap.Tint(tintColor);
+		if (bitmap.compressed)
+			return true;
 
-			// const int xbits = count_bits_set(bitmap.xsize);
-			// const int ybits = count_bits_set(bitmap.ysize);
+		if (params.resize) bitmap = bitmap.CreateRescaled(params.resizeDimensions.x, params.resizeDimensions.y);
+		if (params.invert) bitmap.InvertColors();
+		if (params.greyed) bitmap.MakeGrayScale();
+		if (params.tint)   bitmap.Tint(params.tintColor);
 
-			// make the texture
-			glBindTexture(GL_TEXTURE_2D, texID);
+		return true;
+	}
 
-			if (clamped) {
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+	// streams the bitmap through <pbo> if non-null, returns the final texture id
+	static unsigned int UploadTex(const TexParams& params, const CBitmap& bitmap, unsigned int texID, PBO* pbo)
+	{
+		if (bitmap.compressed)
+			return (bitmap.CreateDDSTexture(texID));
+
+		const void* texData = bitmap.GetRawMem();
+
+		if (pbo != nullptr) {
+			pbo->Bind();
+			pbo->New(bitmap.GetMemSize());
+
+			GLubyte* pboData = pbo->MapBuffer(0, pbo->bufSize, GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | pbo->mapUnsyncedBit);
+
+			if (pboData != nullptr) {
+				memcpy(pboData, texData, bitmap.GetMemSize());
+				pbo->UnmapBuffer();
+
+				texData = pbo->GetPtr();
+			} else {
+				pbo->UnmapBuffer();
+				pbo->Unbind();
+				pbo = nullptr;
 			}
+		}
 
-			if (nearest || linear) {
-				constexpr GLfloat white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
+		// const int xbits = count_bits_set(bitmap.xsize);
+		// const int ybits = count_bits_set(bitmap.ysize);
 
-				if (border)
-					glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, white);
+		// make the texture
+		glBindTexture(GL_TEXTURE_2D, texID);
 
-				if (nearest) {
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-				} else {
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-					glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-				}
+		if (params.clamped) {
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP);
+		}
+
+		if (params.nearest || params.linear) {
+			constexpr GLfloat white[4] = {1.0f, 1.0f, 1.0f, 1.0f};
 
-				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bitmap.xsize, bitmap.ysize, int(border), GL_RGBA, GL_UNSIGNED_BYTE, bitmap.GetRawMem());
+			if (params.border)
+				glTexParameterfv(GL_TEXTURE_2D, GL_TEXTURE_BORDER_COLOR, white);
+
+			if (params.nearest) {
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
 			} else {
-				// MIPMAPPING (default)
 				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+				glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+			}
+
+			glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bitmap.xsize, bitmap.ysize, int(params.border), GL_RGBA, GL_UNSIGNED_BYTE, texData);
+		} else {
+			// MIPMAPPING (default)
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+			glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
 
-				glBuildMipmaps(GL_TEXTURE_2D, GL_RGBA8, bitmap.xsize, bitmap.ysize, GL_RGBA, GL_UNSIGNED_BYTE, bitmap.GetRawMem());
+			if (pbo == nullptr) {
+				glBuildMipmaps(GL_TEXTURE_2D, GL_RGBA8, bitmap.xsize, bitmap.ysize, GL_RGBA, GL_UNSIGNED_BYTE, texData);
+			} else {
+				// glBuildMipmaps can not source from a PBO
+				glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, bitmap.xsize, bitmap.ysize, 0, GL_RGBA, GL_UNSIGNED_BYTE, texData);
+				glGenerateMipmap(GL_TEXTURE_2D);
 			}
+		}
 
-			if (aniso)
-				glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, globalRendering->maxTexAnisoLvl);
+		if (params.aniso)
+			glTexParameterf(GL_TEXTURE_2D, GL_TEXTURE_MAX_ANISOTROPY_EXT, globalRendering->maxTexAnisoLvl);
+
+		if (pbo != nullptr) {
+			pbo->Invalidate();
+			pbo->Unbind();
 		}
 
-		texInfo.id    = texID;
+		return texID;
+	}
+
+	static bool Load(const std::string& texName, unsigned int texID)
+	{
+		const TexParams params = ParseTexParams(texName);
+
+		CBitmap bitmap;
+		TexInfo texInfo;
+
+		if (!DecodeTex(params, bitmap)) {
+			GenInsertTex(texName, texInfo, false, false, true, false);
+			return false;
+		}
+
+		texInfo.id    = UploadTex(params, bitmap, texID, nullptr);
 		texInfo.xsize = bitmap.xsize;
 		texInfo.ysize = bitmap.ysize;
 
@@ -293,9 +404,53 @@ namespace CNamedTextures {
 	}
 
 
+	static void UpdateAsync()
+	{
+		size_t numUploadBytes = 0;
+		size_t numResults = 0;
+
+		for (AsyncTex& tex: asyncResults) {
+			if (numUploadBytes >= MAX_ASYNC_UPLOAD_BYTES)
+				break;
+
+			numResults += 1;
+
+			const auto rit = asyncRequests.find(tex.texName);
+			const auto mit = texInfoMap.find(tex.texName);
+
+			// freed or recycled while decoding
+			if (rit == asyncRequests.end() || rit->second != tex.texID)
+				continue;
+
+			asyncRequests.erase(rit);
+
+			if (mit == texInfoMap.end())
+				continue;
+
+			TexInfo& texInfo = texInfoVec[mit->second];
+
+			if (tex.decoded)
+				texInfo.id = UploadTex(tex.params, tex.bitmap, tex.texID, &uploadPBOs[(numUploads++) % 3]);
+
+			if (!tex.decoded || texInfo.id == 0) {
+				// match the synchronous path, failed loads keep a null id
+				glDeleteTextures(1, &tex.texID);
+				texInfo.id = 0;
+			} else {
+				texInfo.xsize = tex.bitmap.xsize;
+				texInfo.ysize = tex.bitmap.ysize;
+			}
+
+			texInfo.pending = false;
+			numUploadBytes += tex.bitmap.GetMemSize();
+		}
+
+		asyncResults.erase(asyncResults.begin(), asyncResults.begin() + numResults);
+	}
+
 	void Update()
 	{
-		if (waitingTextures.empty())
+		if (waitingTextures.empty() && asyncResults.empty())
 			return;
 
 		const std::lock_guard<spring::recursive_mutex> lck(mutex);
@@ -311,6 +466,8 @@ namespace CNamedTextures {
 			Load(texString, texInfoVec[mit->second].id);
 		}
 
+		UpdateAsync();
+
 		glAttribStatePtr->PopBits();
 		waitingTextures.clear();
 	}
@@ -359,6 +516,47 @@ namespace CNamedTextures {
 	}
 
 
+	const TexInfo* Request(const std::string& texName, bool persist)
+	{
+		if (texName.empty())
+			return nullptr;
+
+		// cached or already in flight
+		if (GetInfoIndex(texName) != size_t(-1))
+			return (GetInfo(texName, false, persist));
+
+		if (!ThreadPool::HasThreads())
+			return (GetInfo(texName, true, persist));
+
+		const std::lock_guard<spring::recursive_mutex> lck(mutex);
+
+		// placeholder, usable (as opaque white) until the upload replaces it
+		constexpr GLubyte white[4] = {255, 255, 255, 255};
+
+		TexInfo texInfo = GenTex(true, persist);
+		texInfo.pending = true;
+
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, 1, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE, white);
+		glBindTexture(GL_TEXTURE_2D, 0);
+
+		InsertTex(texName, texInfo, true);
+
+		asyncRequests[texName] = texInfo.id;
+
+		ThreadPool::Enqueue([texName, texID = texInfo.id]() {
+			AsyncTex tex = {texName, texID, ParseTexParams(texName), {}, false};
+			tex.decoded = DecodeTex(tex.params, tex.bitmap);
+
+			const std::lock_guard<spring::recursive_mutex> lck(mutex);
+			asyncResults.push_back(std::move(tex));
+		});
+
+		return &texInfoVec[ texInfoMap[texName] ];
+	}
+
+
 	/******************************************************************************/
 
 } // namespace CNamedTextures
@@ -14,6 +14,7 @@ namespace CNamedTextures {
 	 * when compiling a DList.
 	 * Otherwise, it would re-upload the texture-data on each call
 	 * of the DList, so we delay it and load them here.
+	 * Also uploads the results of finished Request() calls.
 	 */
 	void Update();
 
@@ -22,18 +23,27 @@ namespace CNamedTextures {
 
 	struct TexInfo {
 		TexInfo()
-			: id(0), xsize(-1), ysize(-1), alpha(false), persist(false) {}
+			: id(0), xsize(-1), ysize(-1), alpha(false), persist(false), pending(false) {}
 		unsigned int id;
 		int xsize;
 		int ysize;
 		bool alpha;
 		bool persist;
+		bool pending; // placeholder for a Request()'ed texture not yet uploaded
 	};
 
 	size_t GetInfoIndex(const std::string& texName);
 
 	const TexInfo* GetInfo(const std::string& texName, bool forceLoad = false, bool persist = false);
 	const TexInfo* GetInfo(size_t texIdx);
+
+	/**
+	 * Asynchronous variant of GetInfo(texName, true, persist): the image is
+	 * decoded on a worker thread and uploaded through a PBO by Update(), in
+	 * the meantime the returned entry holds a 1x1 white placeholder (with
+	 * the final texture id) and has its pending flag set.
+	 */
+	const TexInfo* Request(const std::string& texName, bool persist = false);
 }
 
 #endif /* NAMED_TEXTURES_H */
@@ -11,6 +11,7 @@
 #include "Rendering/Models/3DModel.h"
 #include "Rendering/Textures/Bitmap.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/Threading.h"
@@ -29,6 +30,8 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_TEXTURE)
 
 #define TEX_MAT_UID(pTxID, sTxID) ((std::uint64_t(pTxID) << 32u) | sTxID)
 
+CONFIG(bool, S3OTextureArrays).defaultValue(false).description("Additionally pack S3O textures into texture-arrays by size, so instanced models sharing an array are drawn without texture rebinds. Costs a second copy of every uncompressed S3O texture in video memory.");
+
 
 // The S3O texture handler uses two textures.
 // The first contains diffuse color (RGB) and teamcolor (A)
@@ -43,6 +46,9 @@ CS3OTextureHandler textureHandlerS3O;
 void CS3OTextureHandler::Init()
 {
 	textures.reserve(128);
+	textureArrays.reserve(16);
+
+	useTextureArrays = configHandler->GetBool("S3OTextureArrays");
 
 	// dummies
 	textures.emplace_back();
@@ -55,8 +61,12 @@ void CS3OTextureHandler::Kill()
 		glDeleteTextures(1, &(texture.tex1));
 		glDeleteTextures(1, &(texture.tex2));
 	}
+	for (TextureArray& texArray: textureArrays) {
+		glDeleteTextures(1, &(texArray.texID));
+	}
 
 	textures.clear();
+	textureArrays.clear();
 	textureCache.clear();
 	textureTable.clear();
 	bitmapCache.clear();
@@ -145,16 +155,61 @@ unsigned int CS3OTextureHandler::LoadAndCacheTexture(
 
 	const unsigned int texID = bitmap->CreateMipMapTexture();
 
-	textureCache[textureName] = {
+	CachedS3OTex& cachedTex = textureCache[textureName];
+
+	cachedTex = {
 		texID,
 		static_cast<unsigned int>(bitmap->xsize),
-		static_cast<unsigned int>(bitmap->ysize)
+		static_cast<unsigned int>(bitmap->ysize),
+		0,
+		-1
 	};
 
+	if (useTextureArrays)
+		PackBitmap(bitmap, cachedTex);
+
 	bitmapCache.erase(textureName);
 	return texID;
 }
 
+void CS3OTextureHandler::PackBitmap(const CBitmap* bitmap, CachedS3OTex& cachedTex)
+{
+	// DDS data would have to be decompressed first, leave those unpacked
+	if (bitmap->compressed || bitmap->channels != 4 || bitmap->GetMemSize() == 0)
+		return;
+
+	const auto pred = [&](const TextureArray& a) {
+		return (a.xsize == cachedTex.xsize && a.ysize == cachedTex.ysize && a.numLayers < a.maxLayers);
+	};
+	auto iter = std::find_if(textureArrays.begin(), textureArrays.end(), pred);
+
+	if (iter == textureArrays.end()) {
+		const size_t layerSize = bitmap->GetMemSize();
+		const int maxLayers = std::max(1, std::min(MAX_ARRAY_LAYERS, int(MAX_ARRAY_BYTES / layerSize)));
+
+		textureArrays.push_back({0, cachedTex.xsize, cachedTex.ysize, 0, maxLayers});
+		iter = textureArrays.end() - 1;
+
+		glGenTextures(1, &iter->texID);
+		glBindTexture(GL_TEXTURE_2D_ARRAY, iter->texID);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_S, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_WRAP_T, GL_REPEAT);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+		glTexParameteri(GL_TEXTURE_2D_ARRAY, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+		glTexImage3D(GL_TEXTURE_2D_ARRAY, 0, GL_RGBA8, iter->xsize, iter->ysize, maxLayers, 0, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+	} else {
+		glBindTexture(GL_TEXTURE_2D_ARRAY, iter->texID);
+	}
+
+	// mipmaps of all layers are regenerated, only happens at model load-time
+	glTexSubImage3D(GL_TEXTURE_2D_ARRAY, 0, 0, 0, iter->numLayers, iter->xsize, iter->ysize, 1, GL_RGBA, GL_UNSIGNED_BYTE, bitmap->GetRawMem());
+	glGenerateMipmap(GL_TEXTURE_2D_ARRAY);
+	glBindTexture(GL_TEXTURE_2D_ARRAY, 0);
+
+	cachedTex.arrayID = iter->texID;
+	cachedTex.arrayLayer = iter->numLayers++;
+}
+
 
 unsigned int CS3OTextureHandler::InsertTextureMat(const S3DModel* model)
 {
@@ -172,6 +227,10 @@ unsigned int CS3OTextureHandler::InsertTextureMat(const S3DModel* model)
 	texMat.tex1SizeY = tex1.ysize;
 	texMat.tex2SizeX = tex2.xsize;
 	texMat.tex2SizeY = tex2.ysize;
+	texMat.tex1Array = tex1.arrayID;
+	texMat.tex2Array = tex2.arrayID;
+	texMat.tex1Layer = tex1.arrayLayer;
+	texMat.tex2Layer = tex2.arrayLayer;
 
 	textureTable[TEX_MAT_UID(texMat.tex1, texMat.tex2)] = texMat.num;
 
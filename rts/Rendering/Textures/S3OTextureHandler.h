@@ -27,14 +27,43 @@ public:
 
 		unsigned int tex2SizeX;
 		unsigned int tex2SizeY;
+
+		// copies of tex1 and tex2 packed into texture-arrays, zero if unpacked
+		unsigned int tex1Array;
+		unsigned int tex2Array;
+
+		int tex1Layer;
+		int tex2Layer;
+
+		bool IsPacked() const { return (tex1Array != 0 && tex2Array != 0); }
 	};
 
 	struct CachedS3OTex {
 		unsigned int texID;
 		unsigned int xsize;
 		unsigned int ysize;
+
+		unsigned int arrayID;
+		int arrayLayer;
+	};
+
+	// array of equally sized RGBA8 textures, filled one layer per texture
+	struct TextureArray {
+		unsigned int texID;
+		unsigned int xsize;
+		unsigned int ysize;
+
+		int numLayers;
+		int maxLayers;
 	};
 
+	// texture-units the arrays are bound to by the instanced model path
+	static constexpr unsigned int TEX1_ARRAY_UNIT = 6;
+	static constexpr unsigned int TEX2_ARRAY_UNIT = 7;
+	// layer budget of a single array in bytes (excluding mipmaps)
+	static constexpr unsigned int MAX_ARRAY_BYTES = 64 << 20;
+	static constexpr int MAX_ARRAY_LAYERS = 32;
+
 	void Init();
 	void Kill();
 
@@ -49,7 +78,11 @@ public:
 		return nullptr;
 	}
 
+	bool UseTextureArrays() const { return useTextureArrays; }
+
 private:
+	void PackBitmap(const CBitmap* bitmap, CachedS3OTex& cachedTex);
+
 	unsigned int LoadAndCacheTexture(
 		const S3DModel* model,
 		unsigned int texNum,
@@ -71,6 +104,9 @@ private:
 	spring::mutex cacheMutex;
 
 	std::vector<S3OTexMat> textures;
+	std::vector<TextureArray> textureArrays;
+
+	bool useTextureArrays = false;
 };
 
 extern CS3OTextureHandler textureHandlerS3O;
@@ -10,14 +10,23 @@
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/PBO.h"
 #include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileHandler.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
 #include "System/StringUtil.h"
 #include "System/Exceptions.h"
+#include "System/Sync/HsiehHash.h"
+#include "System/Threading/ThreadPool.h"
 
+#include <cstdio>
 #include <cstring>
+#include <fstream>
 
 CONFIG(int, MaxTextureAtlasSizeX).defaultValue(2048).minimumValue(512).maximumValue(32768);
 CONFIG(int, MaxTextureAtlasSizeY).defaultValue(2048).minimumValue(512).maximumValue(32768);
+CONFIG(bool, UseTextureAtlasCache).defaultValue(true).headlessValue(false).description("Store finalized texture atlases in the cache-dir and load them from there on later runs instead of decoding and packing every source image again.");
 
 CR_BIND(AtlasedTexture, )
 CR_REG_METADATA(AtlasedTexture, (CR_MEMBER(x), CR_MEMBER(y), CR_MEMBER(z), CR_MEMBER(w)))
@@ -28,7 +37,56 @@ static AtlasedTexture dummy;
 bool CTextureAtlas::debug = false;
 
 
-CTextureAtlas::CTextureAtlas(unsigned int allocType)
+static constexpr char ATLAS_CACHE_MAGIC[8] = {'S', 'P', 'R', 'A', 'T', 'L', 'S', '\0'};
+static constexpr unsigned int ATLAS_CACHE_VERSION = 1;
+
+struct AtlasCacheHeader {
+	char magic[8];
+
+	std::uint32_t version;
+	std::uint32_t hash;
+
+	std::int32_t xsize;
+	std::int32_t ysize;
+	std::int32_t maxMipMaps;
+
+	std::uint32_t numNames;
+};
+
+static std::string GetAtlasCacheDir() {
+	return (FileSystem::GetCacheDir() + "/atlases/");
+}
+
+static std::string GetAtlasCacheFileName(std::uint32_t cacheHash)
+{
+	char buf[64];
+	snprintf(buf, sizeof(buf), "%08x.bin", cacheHash);
+	return (GetAtlasCacheDir() + buf);
+}
+
+static std::uint32_t HashString(const std::string& s, std::uint32_t hash) {
+	// include the terminator so {"ab", "c"} and {"a", "bc"} differ
+	return (HsiehHash(s.c_str(), s.size() + 1, hash));
+}
+
+static void CreateAtlasTexture(unsigned int* texID, int2 size, int maxMipMaps, const void* texels)
+{
+	glGenTextures(1, texID);
+	glBindTexture(GL_TEXTURE_2D, *texID);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (maxMipMaps > 0) ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,  maxMipMaps);
+	if (maxMipMaps > 0) {
+		glBuildMipmaps(GL_TEXTURE_2D, GL_RGBA8, size.x, size.y, GL_RGBA, GL_UNSIGNED_BYTE, texels); //FIXME disable texcompression, PBO
+	} else {
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, size.x, size.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, texels);
+	}
+}
+
+
+CTextureAtlas::CTextureAtlas(unsigned int _allocType): allocType(_allocType)
 {
 	switch (allocType) {
 		case ATLAS_ALLOC_LEGACY  : { atlasAllocator = new   CLegacyAtlasAlloc(); } break;
@@ -45,6 +103,7 @@ CTextureAtlas::CTextureAtlas(unsigned int allocType)
 
 	textures.reserve(256);
 	memTextures.reserve(128);
+	fileTextures.reserve(128);
 }
 
 CTextureAtlas::~CTextureAtlas()
@@ -92,39 +151,242 @@ size_t CTextureAtlas::AddTexFromFile(std::string name, std::string file)
 	const auto it = files.find(lcFile);
 
 	if (it != files.end()) {
-		memTextures[it->second].names.emplace_back(std::move(name));
+		fileTextures[it->second].names.emplace_back(std::move(name));
 		return (it->second);
 	}
 
+	fileTextures.emplace_back();
+	fileTextures.back().names.emplace_back(std::move(name));
+	fileTextures.back().file = std::move(file);
 
-	CBitmap bitmap;
-	if (!bitmap.Load(file)) {
-		bitmap.Alloc(2, 2, 4);
-		LOG_L(L_WARNING, "[TexAtlas::%s] could not load texture from file \"%s\"", __func__, file.c_str());
-	}
+	return (files[lcFile] = fileTextures.size() - 1);
+}
+
+void CTextureAtlas::LoadFileTextures()
+{
+	std::vector<CBitmap> bitmaps(fileTextures.size());
+
+	// decoding dominates atlas creation time, the images are independent
+	for_mt(0, fileTextures.size(), [&](const int i) {
+		if (bitmaps[i].Load(fileTextures[i].file))
+			return;
 
-	// only suport RGBA for now
-	if (bitmap.channels != 4 || bitmap.compressed)
-		throw content_error("Unsupported bitmap format in file " + file);
+		bitmaps[i].Alloc(2, 2, 4);
+		LOG_L(L_WARNING, "[TexAtlas::%s] could not load texture from file \"%s\"", __func__, fileTextures[i].file.c_str());
+	});
 
-	return (files[lcFile] = AddTexFromMem(std::move(name), bitmap.xsize, bitmap.ysize, RGBA32, bitmap.GetRawMem()));
+	for (size_t i = 0; i < fileTextures.size(); i++) {
+		CBitmap& bitmap = bitmaps[i];
+		const FileTex& fileTex = fileTextures[i];
+
+		// only suport RGBA for now
+		if (bitmap.channels != 4 || bitmap.compressed)
+			throw content_error("Unsupported bitmap format in file " + fileTex.file);
+
+		MemTex& memTex = memTextures[AddTexFromMem(fileTex.names[0], bitmap.xsize, bitmap.ysize, RGBA32, bitmap.GetRawMem())];
+
+		memTex.names.insert(memTex.names.end(), fileTex.names.begin() + 1, fileTex.names.end());
+	}
 }
 
 
 bool CTextureAtlas::Finalize()
 {
-	const bool success = atlasAllocator->Allocate() && (initialized = CreateTexture());
+	const bool useCache = (!fileTextures.empty() && configHandler->GetBool("UseTextureAtlasCache"));
+	const std::uint32_t cacheHash = useCache? GetCacheHash(): 0;
+
+	bool success = (useCache && (initialized = LoadCache(cacheHash)));
+
+	if (!success) {
+		LoadFileTextures();
+
+		success = atlasAllocator->Allocate() && (initialized = CreateTexture(cacheHash));
+	}
 
 	memTextures.clear();
+	fileTextures.clear();
 	files.clear();
 	return success;
 }
 
-bool CTextureAtlas::CreateTexture()
+
+std::uint32_t CTextureAtlas::GetCacheHash() const
+{
+	const int2 maxSize = atlasAllocator->GetMaxSize();
+	const int params[] = {int(allocType), maxSize.x, maxSize.y};
+
+	std::uint32_t hash = HashString(name, ATLAS_CACHE_VERSION);
+	std::vector<std::uint8_t> buffer;
+
+	hash = HsiehHash(&params[0], sizeof(params), hash);
+
+	for (const FileTex& fileTex: fileTextures) {
+		for (const std::string& texName: fileTex.names) {
+			hash = HashString(texName, hash);
+		}
+
+		CFileHandler file(fileTex.file);
+
+		hash = HashString(fileTex.file, hash);
+
+		if (!file.FileExists())
+			continue;
+
+		if (!file.IsBuffered()) {
+			buffer.clear();
+			buffer.resize(file.FileSize(), 0);
+			file.Read(buffer.data(), buffer.size());
+		} else {
+			buffer = std::move(file.GetBuffer());
+		}
+
+		hash = HsiehHash(buffer.data(), buffer.size(), hash);
+	}
+
+	for (const MemTex& memTex: memTextures) {
+		for (const std::string& texName: memTex.names) {
+			hash = HashString(texName, hash);
+		}
+
+		const int dims[] = {memTex.xsize, memTex.ysize, int(memTex.texType)};
+
+		hash = HsiehHash(&dims[0], sizeof(dims), hash);
+		hash = HsiehHash(memTex.mem.data(), memTex.mem.size(), hash);
+	}
+
+	return hash;
+}
+
+bool CTextureAtlas::LoadCache(std::uint32_t cacheHash)
+{
+	const std::string fileName = GetAtlasCacheFileName(cacheHash);
+
+	if (!FileSystem::FileExists(fileName))
+		return false;
+
+	std::ifstream file(dataDirsAccess.LocateFile(fileName), std::ios::in | std::ios::binary);
+	AtlasCacheHeader header;
+
+	if (!file.is_open())
+		return false;
+	if (!file.read(reinterpret_cast<char*>(&header), sizeof(header)))
+		return false;
+
+	if (std::memcmp(header.magic, ATLAS_CACHE_MAGIC, sizeof(ATLAS_CACHE_MAGIC)) != 0)
+		return false;
+	if (header.version != ATLAS_CACHE_VERSION || header.hash != cacheHash)
+		return false;
+	if (header.xsize <= 0 || header.ysize <= 0 || header.xsize > globalRendering->maxTextureSize || header.ysize > globalRendering->maxTextureSize)
+		return false;
+
+	spring::unordered_map<std::string, AtlasedTexture> cachedTextures;
+	std::string texName;
+
+	cachedTextures.reserve(header.numNames);
+
+	for (std::uint32_t i = 0; i < header.numNames; i++) {
+		std::uint32_t nameLen = 0;
+		float4 texCoords;
+
+		if (!file.read(reinterpret_cast<char*>(&nameLen), sizeof(nameLen)) || nameLen > 4096)
+			return false;
+
+		texName.resize(nameLen);
+
+		if (!file.read(&texName[0], nameLen))
+			return false;
+		if (!file.read(reinterpret_cast<char*>(&texCoords.x), sizeof(float) * 4))
+			return false;
+
+		cachedTextures[texName] = AtlasedTexture(texCoords);
+	}
+
+	PBO pbo;
+	pbo.Bind();
+	pbo.New(header.xsize * header.ysize * 4);
+
+	unsigned char* data = reinterpret_cast<unsigned char*>(pbo.MapBuffer(GL_WRITE_ONLY));
+	const bool valid = (data != nullptr && file.read(reinterpret_cast<char*>(data), header.xsize * header.ysize * 4));
+
+	pbo.UnmapBuffer();
+
+	if (valid) {
+		textures.insert(cachedTextures.begin(), cachedTextures.end());
+
+		CreateAtlasTexture(&atlasTexID, atlasSize = int2(header.xsize, header.ysize), header.maxMipMaps, pbo.GetPtr());
+		LOG("[TexAtlas::%s] loaded atlas \"%s\" (size=<%d,%d>) from cache", __func__, name.c_str(), atlasSize.x, atlasSize.y);
+	}
+
+	pbo.Invalidate();
+	pbo.Unbind();
+	pbo.Release();
+
+	return valid;
+}
+
+bool CTextureAtlas::SaveCache(std::uint32_t cacheHash, const unsigned char* texels) const
+{
+	if (!FileSystem::CreateDirectory(GetAtlasCacheDir()))
+		return false;
+
+	AtlasCacheHeader header;
+
+	std::memcpy(header.magic, ATLAS_CACHE_MAGIC, sizeof(ATLAS_CACHE_MAGIC));
+
+	header.version = ATLAS_CACHE_VERSION;
+	header.hash = cacheHash;
+	header.xsize = atlasSize.x;
+	header.ysize = atlasSize.y;
+	header.maxMipMaps = atlasAllocator->GetMaxMipMaps();
+	header.numNames = textures.size();
+
+	const std::string filePath = dataDirsAccess.LocateFile(GetAtlasCacheFileName(cacheHash), FileQueryFlags::WRITE);
+	// another process may be reading the same cache, never expose a partial file
+	const std::string tempPath = filePath + ".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+		for (const auto& pair: textures) {
+			const std::uint32_t nameLen = pair.first.size();
+
+			file.write(reinterpret_cast<const char*>(&nameLen), sizeof(nameLen));
+			file.write(pair.first.data(), nameLen);
+			file.write(reinterpret_cast<const char*>(&pair.second.x), sizeof(float) * 4);
+		}
+
+		file.write(reinterpret_cast<const char*>(texels), atlasSize.x * atlasSize.y * 4);
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return false;
+		}
+	}
+
+	// rename does not replace existing files on every platform
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+
+bool CTextureAtlas::CreateTexture(std::uint32_t cacheHash)
 {
-	const int2 atlasSize = atlasAllocator->GetAtlasSize();
 	const int maxMipMaps = atlasAllocator->GetMaxMipMaps();
 
+	atlasSize = atlasAllocator->GetAtlasSize();
+
 	// ATI drivers like to *crash* in glTexImage if x=0 or y=0
 	if (atlasSize.x <= 0 || atlasSize.y <= 0) {
 		LOG_L(L_ERROR, "[TextureAtlas::%s] bad allocation for atlas \"%s\" (size=<%d,%d>)", __func__, name.c_str(), atlasSize.x, atlasSize.y);
@@ -166,25 +428,16 @@ bool CTextureAtlas::CreateTexture()
 			CBitmap tex(data, atlasSize.x, atlasSize.y);
 			tex.Save(name + "-" + IntToString(atlasSize.x) + "x" + IntToString(atlasSize.y) + ".png");
 		}
+
+		if (cacheHash != 0 && !SaveCache(cacheHash, data))
+			LOG_L(L_WARNING, "[TextureAtlas::%s] failed to cache atlas \"%s\"", __func__, name.c_str());
 	} else {
 		LOG_L(L_ERROR, "[TextureAtlas::%s] failed to map PBO for atlas \"%s\" (size=<%d,%d>)", __func__, name.c_str(), atlasSize.x, atlasSize.y);
 	}
 
 	pbo.UnmapBuffer();
 
-
-	glGenTextures(1, &atlasTexID);
-	glBindTexture(GL_TEXTURE_2D, atlasTexID);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, (maxMipMaps > 0) ? GL_LINEAR_MIPMAP_NEAREST : GL_NEAREST);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S,     GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T,     GL_CLAMP_TO_EDGE);
-	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL,  maxMipMaps);
-	if (maxMipMaps > 0) {
-		glBuildMipmaps(GL_TEXTURE_2D, GL_RGBA8, atlasSize.x, atlasSize.y, GL_RGBA, GL_UNSIGNED_BYTE, pbo.GetPtr()); //FIXME disable texcompression, PBO
-	} else {
-		glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, atlasSize.x, atlasSize.y, 0, GL_RGBA, GL_UNSIGNED_BYTE, pbo.GetPtr());
-	}
+	CreateAtlasTexture(&atlasTexID, atlasSize, maxMipMaps, pbo.GetPtr());
 
 	pbo.Invalidate();
 	pbo.Unbind();
@@ -226,6 +479,6 @@ AtlasedTexture& CTextureAtlas::GetTextureWithBackup(const std::string& name, con
 }
 
 int2 CTextureAtlas::GetSize() const {
-	return (atlasAllocator->GetAtlasSize());
+	return atlasSize;
 }
 
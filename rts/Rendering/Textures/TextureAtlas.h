@@ -3,6 +3,7 @@
 #ifndef TEXTURE_ATLAS_H
 #define TEXTURE_ATLAS_H
 
+#include <cinttypes>
 #include <string>
 #include <vector>
 
@@ -45,7 +46,7 @@ public:
 
 	// add a texture from a memory pointer
 	size_t AddTexFromMem(std::string name, int xsize, int ysize, TextureType texType, void* data);
-	// add a texture from a file
+	// add a texture from a file; decoding is deferred until Finalize
 	size_t AddTexFromFile(std::string name, std::string file);
 	// add a blank texture
 	size_t AddTex(std::string name, int xsize, int ysize, TextureType texType = RGBA32);
@@ -61,6 +62,8 @@ public:
 
 	/**
 	 * Creates the atlas containing all the specified textures.
+	 * If the atlas contains file textures, the packed image and its
+	 * texcoords are cached and reused while none of the inputs change.
 	 * @return true if suceeded, false if not all textures did fit
 	 *         into the specified maxsize.
 	 */
@@ -107,11 +110,22 @@ protected:
 			default: return 32;
 		}
 	}
-	bool CreateTexture();
+	bool CreateTexture(std::uint32_t cacheHash);
+
+	void LoadFileTextures();
+
+	std::uint32_t GetCacheHash() const;
+	bool LoadCache(std::uint32_t cacheHash);
+	bool SaveCache(std::uint32_t cacheHash, const unsigned char* texels) const;
 
 protected:
 	IAtlasAllocator* atlasAllocator = nullptr;
 
+	struct FileTex {
+		std::vector<std::string> names;
+		std::string file;
+	};
+
 	struct MemTex {
 	public:
 		MemTex(): xsize(0), ysize(0), texType(RGBA32) {}
@@ -143,11 +157,15 @@ protected:
 
 	// temporary storage of all textures
 	std::vector<MemTex> memTextures;
+	std::vector<FileTex> fileTextures;
 
 	spring::unordered_map<std::string, size_t> files;
 	spring::unordered_map<std::string, AtlasedTexture> textures;
 
 	unsigned int atlasTexID = 0;
+	unsigned int allocType = ATLAS_ALLOC_LEGACY;
+
+	int2 atlasSize;
 
 	bool initialized = false;
 	bool freeTexture = true; // free texture on atlas destruction?
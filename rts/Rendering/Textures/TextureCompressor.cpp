@@ -0,0 +1,465 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "TextureCompressor.h"
+
+#include "System/Config/ConfigHandler.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/FileSystem/FileQueryFlags.h"
+#include "System/FileSystem/FileSystem.h"
+#include "System/Log/ILog.h"
+#include "System/Sync/SHA512.hpp"
+#include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+CONFIG(int, BitmapTextureCompression)
+	.defaultValue(0)
+	.minimumValue(0)
+	.maximumValue(2)
+	.description("Compress textures created from images (icons, decals, custom minimaps) to BC1/BC3 on the CPU. 0 = off, 1 = fast, 2 = high quality. Compressed results are cached on disk.");
+
+
+// bump whenever the encoder output or the cache-file layout changes
+static constexpr uint32_t CACHE_VERSION = 1;
+static constexpr uint32_t CACHE_MAGIC = 0x43545342; // "BSTC"
+
+static spring::mutex cacheMutex;
+static std::string cacheDir;
+
+
+static const std::string& GetCacheDir()
+{
+	std::lock_guard<spring::mutex> lock(cacheMutex);
+
+	if (cacheDir.empty()) {
+		cacheDir = FileSystem::GetCacheDir() + "/textures/";
+
+		if (!FileSystem::CreateDirectory(cacheDir))
+			LOG_L(L_WARNING, "[TextureCompressor] could not create \"%s\"", cacheDir.c_str());
+	}
+
+	return cacheDir;
+}
+
+static std::string GetCacheFileName(const uint8_t* rgba, int xsize, int ysize, bool mipmaps, TextureCompressor::Quality quality)
+{
+	const uint32_t params[] = {CACHE_VERSION, uint32_t(xsize), uint32_t(ysize), uint32_t(mipmaps), uint32_t(quality)};
+
+	sha512::calc_state state;
+	sha512::raw_digest digest;
+	sha512::hex_digest hexDigest;
+
+	sha512::init_digest(state);
+	sha512::update_digest(state, reinterpret_cast<const uint8_t*>(params), sizeof(params));
+	sha512::update_digest(state, rgba, xsize * ysize * 4);
+	sha512::final_digest(state, digest.data());
+	sha512::dump_digest(digest, hexDigest);
+
+	return (GetCacheDir() + std::string(hexDigest.data(), 32) + ".bin");
+}
+
+
+static bool LoadCachedImage(const std::string& fileName, TextureCompressor::Image& image)
+{
+	std::ifstream file(dataDirsAccess.LocateFile(fileName), std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	const std::vector<uint8_t> buf((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+	uint32_t header[3] = {0, 0, 0};
+
+	if (buf.size() < sizeof(header))
+		return false;
+
+	memcpy(header, buf.data(), sizeof(header));
+
+	if (header[0] != CACHE_MAGIC || header[1] > TextureCompressor::FORMAT_BC3 || header[2] != image.levelOffsets.size())
+		return false;
+
+	image.format = TextureCompressor::Format(header[1]);
+
+	// recompute the level layout for the stored format; must match the file size exactly
+	size_t dataSize = 0;
+
+	for (size_t level = 0; level < image.levelOffsets.size(); level++) {
+		image.levelOffsets[level] = dataSize;
+		dataSize += TextureCompressor::GetLevelSize(std::max(image.xsize >> level, 1), std::max(image.ysize >> level, 1), image.format);
+	}
+
+	if (buf.size() != (sizeof(header) + dataSize))
+		return false;
+
+	image.data.assign(buf.begin() + sizeof(header), buf.end());
+	return true;
+}
+
+static void SaveCachedImage(const std::string& fileName, const TextureCompressor::Image& image)
+{
+	const uint32_t header[3] = {CACHE_MAGIC, uint32_t(image.format), uint32_t(image.levelOffsets.size())};
+
+	const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+	const std::string tempPath = filePath + ".tmp";
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return;
+
+		file.write(reinterpret_cast<const char*>(header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(image.data.data()), image.data.size());
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return;
+		}
+	}
+
+	// rename does not replace existing files on every platform
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0)
+		std::remove(tempPath.c_str());
+}
+
+
+
+static uint16_t PackRGB565(const float c[3])
+{
+	const int r = std::min(std::max(int(c[0] * (31.0f / 255.0f) + 0.5f), 0), 31);
+	const int g = std::min(std::max(int(c[1] * (63.0f / 255.0f) + 0.5f), 0), 63);
+	const int b = std::min(std::max(int(c[2] * (31.0f / 255.0f) + 0.5f), 0), 31);
+
+	return ((r << 11) | (g << 5) | b);
+}
+
+static void UnpackRGB565(uint16_t c, int rgb[3])
+{
+	const int r = (c >> 11) & 31;
+	const int g = (c >>  5) & 63;
+	const int b = (c >>  0) & 31;
+
+	rgb[0] = (r << 3) | (r >> 2);
+	rgb[1] = (g << 2) | (g >> 4);
+	rgb[2] = (b << 3) | (b >> 2);
+}
+
+static void GetColorEndPoints(const uint8_t texels[16][4], TextureCompressor::Quality quality, float ep0[3], float ep1[3])
+{
+	float mins[3] = {255.0f, 255.0f, 255.0f};
+	float maxs[3] = {  0.0f,   0.0f,   0.0f};
+
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 3; c++) {
+			mins[c] = std::min(mins[c], float(texels[i][c]));
+			maxs[c] = std::max(maxs[c], float(texels[i][c]));
+		}
+	}
+
+	if (quality == TextureCompressor::QUALITY_FAST) {
+		// shrink the box a bit, the extremes are rarely hit exactly
+		for (int c = 0; c < 3; c++) {
+			const float inset = (maxs[c] - mins[c]) / 16.0f;
+
+			ep0[c] = maxs[c] - inset;
+			ep1[c] = mins[c] + inset;
+		}
+
+		return;
+	}
+
+	float mean[3] = {0.0f, 0.0f, 0.0f};
+	float cov[6] = {0.0f, 0.0f, 0.0f, 0.0f, 0.0f, 0.0f};
+
+	for (int i = 0; i < 16; i++) {
+		for (int c = 0; c < 3; c++) {
+			mean[c] += (texels[i][c] / 16.0f);
+		}
+	}
+
+	for (int i = 0; i < 16; i++) {
+		const float r = texels[i][0] - mean[0];
+		const float g = texels[i][1] - mean[1];
+		const float b = texels[i][2] - mean[2];
+
+		cov[0] += (r * r); cov[1] += (r * g); cov[2] += (r * b);
+		                   cov[3] += (g * g); cov[4] += (g * b);
+		                                      cov[5] += (b * b);
+	}
+
+	// principal axis by power iteration, starting from the box diagonal
+	float axis[3] = {maxs[0] - mins[0], maxs[1] - mins[1], maxs[2] - mins[2]};
+
+	for (int n = 0; n < 8; n++) {
+		const float x = cov[0] * axis[0] + cov[1] * axis[1] + cov[2] * axis[2];
+		const float y = cov[1] * axis[0] + cov[3] * axis[1] + cov[4] * axis[2];
+		const float z = cov[2] * axis[0] + cov[4] * axis[1] + cov[5] * axis[2];
+		const float l = std::max(std::fabs(x), std::max(std::fabs(y), std::fabs(z)));
+
+		if (l <= 0.0f)
+			break;
+
+		axis[0] = x / l;
+		axis[1] = y / l;
+		axis[2] = z / l;
+	}
+
+	float minDot =  1e9f;
+	float maxDot = -1e9f;
+
+	for (int i = 0; i < 16; i++) {
+		const float d =
+			(texels[i][0] - mean[0]) * axis[0] +
+			(texels[i][1] - mean[1]) * axis[1] +
+			(texels[i][2] - mean[2]) * axis[2];
+
+		minDot = std::min(minDot, d);
+		maxDot = std::max(maxDot, d);
+	}
+
+	const float inset = (maxDot - minDot) / 16.0f;
+
+	for (int c = 0; c < 3; c++) {
+		ep0[c] = mean[c] + axis[c] * (maxDot - inset);
+		ep1[c] = mean[c] + axis[c] * (minDot + inset);
+	}
+}
+
+static void EncodeColorBlock(const uint8_t texels[16][4], TextureCompressor::Quality quality, uint8_t* out)
+{
+	float ep0[3];
+	float ep1[3];
+
+	GetColorEndPoints(texels, quality, ep0, ep1);
+
+	uint16_t c0 = PackRGB565(ep0);
+	uint16_t c1 = PackRGB565(ep1);
+	uint32_t indices = 0;
+
+	// c0 > c1 selects the four-color mode
+	if (c0 < c1)
+		std::swap(c0, c1);
+
+	if (c0 != c1) {
+		int palette[4][3];
+
+		UnpackRGB565(c0, palette[0]);
+		UnpackRGB565(c1, palette[1]);
+
+		for (int c = 0; c < 3; c++) {
+			palette[2][c] = (2 * palette[0][c] +     palette[1][c]) / 3;
+			palette[3][c] = (    palette[0][c] + 2 * palette[1][c]) / 3;
+		}
+
+		for (int i = 0; i < 16; i++) {
+			int bestIdx = 0;
+			int bestDist = 0x7FFFFFFF;
+
+			for (int p = 0; p < 4; p++) {
+				const int dr = texels[i][0] - palette[p][0];
+				const int dg = texels[i][1] - palette[p][1];
+				const int db = texels[i][2] - palette[p][2];
+				const int dist = dr * dr + dg * dg + db * db;
+
+				if (dist < bestDist) {
+					bestDist = dist;
+					bestIdx = p;
+				}
+			}
+
+			indices |= (uint32_t(bestIdx) << (i * 2));
+		}
+	}
+
+	out[0] = c0 & 0xFF; out[1] = c0 >> 8;
+	out[2] = c1 & 0xFF; out[3] = c1 >> 8;
+
+	for (int i = 0; i < 4; i++) {
+		out[4 + i] = (indices >> (i * 8)) & 0xFF;
+	}
+}
+
+static void EncodeAlphaBlock(const uint8_t texels[16][4], uint8_t* out)
+{
+	int a0 =   0;
+	int a1 = 255;
+
+	for (int i = 0; i < 16; i++) {
+		a0 = std::max(a0, int(texels[i][3]));
+		a1 = std::min(a1, int(texels[i][3]));
+	}
+
+	uint64_t indices = 0;
+
+	// a0 > a1 selects the eight-value mode; a0 == a1 leaves all indices at zero
+	if (a0 != a1) {
+		int palette[8] = {a0, a1};
+
+		for (int p = 1; p < 7; p++) {
+			palette[p + 1] = ((7 - p) * a0 + p * a1) / 7;
+		}
+
+		for (int i = 0; i < 16; i++) {
+			int bestIdx = 0;
+			int bestDist = 0x7FFFFFFF;
+
+			for (int p = 0; p < 8; p++) {
+				const int dist = std::abs(texels[i][3] - palette[p]);
+
+				if (dist < bestDist) {
+					bestDist = dist;
+					bestIdx = p;
+				}
+			}
+
+			indices |= (uint64_t(bestIdx) << (i * 3));
+		}
+	}
+
+	out[0] = a0;
+	out[1] = a1;
+
+	for (int i = 0; i < 6; i++) {
+		out[2 + i] = (indices >> (i * 8)) & 0xFF;
+	}
+}
+
+static void CompressLevel(const uint8_t* rgba, int xsize, int ysize, TextureCompressor::Format format, TextureCompressor::Quality quality, uint8_t* out)
+{
+	const int numBlocksX = (xsize + 3) / 4;
+	const int numBlocksY = (ysize + 3) / 4;
+	const int blockSize = (format == TextureCompressor::FORMAT_BC1)? 8: 16;
+
+	for_mt(0, numBlocksY, [&](const int by) {
+		uint8_t texels[16][4];
+
+		for (int bx = 0; bx < numBlocksX; bx++) {
+			// edge blocks repeat the last row and column
+			for (int i = 0; i < 16; i++) {
+				const int x = std::min(bx * 4 + (i & 3), xsize - 1);
+				const int y = std::min(by * 4 + (i >> 2), ysize - 1);
+
+				memcpy(texels[i], &rgba[(y * xsize + x) * 4], 4);
+			}
+
+			uint8_t* block = &out[(by * numBlocksX + bx) * blockSize];
+
+			if (format == TextureCompressor::FORMAT_BC3) {
+				EncodeAlphaBlock(texels, block);
+				block += 8;
+			}
+
+			EncodeColorBlock(texels, quality, block);
+		}
+	});
+}
+
+static void DownsampleLevel(const uint8_t* src, int xsize, int ysize, std::vector<uint8_t>& dst)
+{
+	const int dstSizeX = std::max(xsize >> 1, 1);
+	const int dstSizeY = std::max(ysize >> 1, 1);
+
+	dst.resize(dstSizeX * dstSizeY * 4);
+
+	for_mt(0, dstSizeY, [&](const int y) {
+		const int y0 = std::min(y * 2 + 0, ysize - 1);
+		const int y1 = std::min(y * 2 + 1, ysize - 1);
+
+		for (int x = 0; x < dstSizeX; x++) {
+			const int x0 = std::min(x * 2 + 0, xsize - 1);
+			const int x1 = std::min(x * 2 + 1, xsize - 1);
+
+			for (int c = 0; c < 4; c++) {
+				const int sum =
+					src[(y0 * xsize + x0) * 4 + c] + src[(y0 * xsize + x1) * 4 + c] +
+					src[(y1 * xsize + x0) * 4 + c] + src[(y1 * xsize + x1) * 4 + c];
+
+				dst[(y * dstSizeX + x) * 4 + c] = (sum + 2) / 4;
+			}
+		}
+	});
+}
+
+
+
+TextureCompressor::Quality TextureCompressor::GetDefaultQuality()
+{
+	return Quality(configHandler->GetInt("BitmapTextureCompression"));
+}
+
+size_t TextureCompressor::GetLevelSize(int xsize, int ysize, Format format)
+{
+	return (((xsize + 3) / 4) * ((ysize + 3) / 4) * ((format == FORMAT_BC1)? 8: 16));
+}
+
+bool TextureCompressor::Compress(const uint8_t* rgba, int xsize, int ysize, bool mipmaps, Quality quality, Image& image)
+{
+	if (quality == QUALITY_NONE || xsize <= 0 || ysize <= 0)
+		return false;
+
+	int numLevels = 1;
+
+	while (mipmaps && ((xsize >> numLevels) > 0 || (ysize >> numLevels) > 0)) {
+		numLevels += 1;
+	}
+
+	image.xsize = xsize;
+	image.ysize = ysize;
+	image.levelOffsets.clear();
+	image.levelOffsets.resize(numLevels, 0);
+
+	const std::string& cacheFileName = GetCacheFileName(rgba, xsize, ysize, mipmaps, quality);
+
+	if (LoadCachedImage(cacheFileName, image))
+		return true;
+
+	// BC1 has no (useful) alpha
+	const auto IsOpaque = [&](int i) { return (rgba[i * 4 + 3] == 255); };
+	int i = 0;
+
+	while (i < (xsize * ysize) && IsOpaque(i)) {
+		i += 1;
+	}
+
+	image.format = (i == (xsize * ysize))? FORMAT_BC1: FORMAT_BC3;
+
+	size_t dataSize = 0;
+
+	for (int level = 0; level < numLevels; level++) {
+		image.levelOffsets[level] = dataSize;
+		dataSize += GetLevelSize(std::max(xsize >> level, 1), std::max(ysize >> level, 1), image.format);
+	}
+
+	image.data.clear();
+	image.data.resize(dataSize);
+
+	std::vector<uint8_t> srcLevel;
+	std::vector<uint8_t> dstLevel;
+
+	for (int level = 0; level < numLevels; level++) {
+		const int levelSizeX = std::max(xsize >> level, 1);
+		const int levelSizeY = std::max(ysize >> level, 1);
+		const uint8_t* levelTexels = (level == 0)? rgba: srcLevel.data();
+
+		CompressLevel(levelTexels, levelSizeX, levelSizeY, image.format, quality, &image.data[image.levelOffsets[level]]);
+
+		if ((level + 1) == numLevels)
+			break;
+
+		DownsampleLevel(levelTexels, levelSizeX, levelSizeY, dstLevel);
+		std::swap(srcLevel, dstLevel);
+	}
+
+	SaveCachedImage(cacheFileName, image);
+	return true;
+}
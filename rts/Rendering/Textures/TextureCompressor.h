@@ -0,0 +1,54 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef TEXTURE_COMPRESSOR_H
+#define TEXTURE_COMPRESSOR_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief BC1 (DXT1) and BC3 (DXT5) block encoder for RGBA8 images
+ * Blocks are encoded in parallel on the ThreadPool; images without any
+ * translucent texels become BC1, everything else BC3. Results (including
+ * the box-filtered MIP chain) are cached under <cachedir>/textures/ keyed
+ * by a digest of the source texels, so unchanged images are compressed
+ * only once.
+ */
+namespace TextureCompressor {
+	enum Quality {
+		QUALITY_NONE = 0,
+		QUALITY_FAST = 1, ///< bounding-box endpoints
+		QUALITY_HIGH = 2, ///< principal-axis endpoints
+	};
+
+	enum Format {
+		FORMAT_BC1 = 0,
+		FORMAT_BC3 = 1,
+	};
+
+	struct Image {
+		std::vector<uint8_t> data;
+		/// offset of each MIP level into data, level 0 first
+		std::vector<size_t> levelOffsets;
+
+		int xsize = 0;
+		int ysize = 0;
+
+		Format format = FORMAT_BC1;
+
+		size_t GetLevelSize(size_t level) const {
+			return (((level + 1) < levelOffsets.size())? levelOffsets[level + 1]: data.size()) - levelOffsets[level];
+		}
+	};
+
+	/// the BitmapTextureCompression config-setting
+	Quality GetDefaultQuality();
+
+	size_t GetLevelSize(int xsize, int ysize, Format format);
+
+	/// <rgba> holds xsize * ysize * 4 bytes
+	bool Compress(const uint8_t* rgba, int xsize, int ysize, bool mipmaps, Quality quality, Image& image);
+}
+
+#endif // TEXTURE_COMPRESSOR_H
@@ -24,6 +24,7 @@
 #include "Rendering/Colors.h"
 #include "Rendering/IconHandler.h"
 #include "Rendering/LuaObjectDrawer.h"
+#include "Rendering/OcclusionCuller.h"
 #include "Rendering/ShadowHandler.h"
 #include "Rendering/Shaders/Shader.h"
 #include "Rendering/Textures/Bitmap.h"
@@ -31,6 +32,7 @@
 #include "Rendering/Textures/S3OTextureHandler.h"
 
 #include "Sim/Features/Feature.h"
+#include "Sim/Misc/DrawSnapshot.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
@@ -46,16 +48,32 @@
 #include "System/EventHandler.h"
 #include "System/MemPoolTypes.h"
 #include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
+
+
+// shared quad of the instanced icon pass, expanded by UnitIconVertProg
+static GL::RenderDataBuffer iconQuadBuffer;
+
+// texels written per icon, see UnitIconVertProg
+static constexpr size_t ICON_BLOCK_SIZE = 2;
 
 
 CONFIG(int, UnitLodDist).defaultValue(1000).headlessValue(0);
 CONFIG(int, UnitIconDist).defaultValue(200).headlessValue(0);
 CONFIG(float, UnitTransparency).defaultValue(0.7f);
+CONFIG(float, MeshLODScale).defaultValue(1.0f).minimumValue(0.0f).description("Multiplier for the projected unit size at which simplified model meshes are swapped in; lower values keep full detail longer, 0 disables mesh LOD's.");
+CONFIG(bool, InstancedModelRendering).defaultValue(true).description("Batch opaque default-material units and features of the same model into instanced draw-calls.");
 
 CONFIG(int, MaxDynamicModelLights)
 	.defaultValue(1)
 	.minimumValue(0);
 
+CONFIG(int, MaxClusteredModelLights)
+	.defaultValue(0)
+	.minimumValue(0)
+	.maximumValue(GL::LightHandler::MaxGridLights())
+	.description("If non-zero, replaces MaxDynamicModelLights by a light-grid holding this many model lights, of which each fragment only evaluates those in range.");
+
 
 
 
@@ -95,39 +113,39 @@ static void LoadUnitExplosionGenerators() {
 
 
 static const void BindOpaqueTex(const CS3OTextureHandler::S3OTexMat* textureMat) {
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, textureMat->tex2);
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, textureMat->tex1);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE1);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, textureMat->tex2);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, textureMat->tex1);
 }
 
 static const void BindOpaqueTexAtlas(const CS3OTextureHandler::S3OTexMat*) {
-	glActiveTexture(GL_TEXTURE1);
-	glBindTexture(GL_TEXTURE_2D, textureHandler3DO.GetAtlasTex2ID());
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, textureHandler3DO.GetAtlasTex1ID());
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE1);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, textureHandler3DO.GetAtlasTex2ID());
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, textureHandler3DO.GetAtlasTex1ID());
 }
 static const void BindOpaqueTexDummy(const CS3OTextureHandler::S3OTexMat*) {}
 
 static const void BindShadowTex(const CS3OTextureHandler::S3OTexMat* textureMat) {
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, textureMat->tex2);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, textureMat->tex2);
 }
 
 static const void KillShadowTex(const CS3OTextureHandler::S3OTexMat*) {
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, 0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
 }
 
 
 static const void BindShadowTexAtlas(const CS3OTextureHandler::S3OTexMat*) {
-	glActiveTexture(GL_TEXTURE0);
-	glBindTexture(GL_TEXTURE_2D, textureHandler3DO.GetAtlasTex2ID());
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, textureHandler3DO.GetAtlasTex2ID());
 }
 
 static const void KillShadowTexAtlas(const CS3OTextureHandler::S3OTexMat*) {
-	glBindTexture(GL_TEXTURE_2D, 0);
-	glActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D, 0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
 }
 
 
@@ -282,9 +300,15 @@ void CUnitDrawer::Init() {
 
 	deadGhostBuildings.resize(teamHandler.ActiveAllyTeams());
 	liveGhostBuildings.resize(teamHandler.ActiveAllyTeams());
+	liveGhostIndices.resize(teamHandler.ActiveAllyTeams());
+
+	for (auto& indices: liveGhostIndices) {
+		indices.clear();
+		indices.resize(unitHandler.MaxUnits(), -1);
+	}
 
 	// LH must be initialized before drawer-state is initialized
-	lightHandler.Init(configHandler->GetInt("MaxDynamicModelLights"));
+	lightHandler.Init(configHandler->GetInt("MaxDynamicModelLights"), configHandler->GetInt("MaxClusteredModelLights"));
 
 	unitDrawerStates[DRAWER_STATE_NOP] = IUnitDrawerState::GetInstance( true, false);
 	unitDrawerStates[DRAWER_STATE_SSP] = IUnitDrawerState::GetInstance(false, false);
@@ -300,9 +324,13 @@ void CUnitDrawer::Init() {
 	drawForward = true;
 	drawDeferred = (geomBuffer->Valid());
 	wireFrameMode = false;
+	drawInstanced = configHandler->GetBool("InstancedModelRendering");
+	meshLODScale = configHandler->GetFloat("MeshLODScale");
 
 	unitDrawerStates[DRAWER_STATE_SSP]->Init(this);
 	cubeMapHandler.Init(); // can only fail if FBO's are invalid
+	modelInstanceBuffer.Init();
+	LoadUnitIconBuffer();
 
 	// note: state must be pre-selected before the first drawn frame
 	// Sun*Changed can be called first, e.g. if DynamicSun is enabled
@@ -319,6 +347,9 @@ void CUnitDrawer::Kill()
 	unitDrawerStates[DRAWER_STATE_LUA]->Kill(); IUnitDrawerState::FreeInstance(unitDrawerStates[DRAWER_STATE_LUA]);
 
 	cubeMapHandler.Free();
+	modelInstanceBuffer.Kill();
+	lightHandler.Kill();
+	iconQuadBuffer.Kill();
 
 	for (CUnit* u: unsortedUnits) {
 		groundDecals->ForceRemoveSolidObject(u);
@@ -345,6 +376,8 @@ void CUnitDrawer::Kill()
 			dgb.clear();
 			lgb.clear();
 		}
+
+		std::fill(liveGhostIndices[allyTeam].begin(), liveGhostIndices[allyTeam].end(), -1);
 	}
 
 	// reuse inner vectors when reloading
@@ -445,34 +478,215 @@ void CUnitDrawer::DrawOpaqueUnits(int modelType, bool drawReflection, bool drawR
 	const auto& mdlRenderer = opaqueModelRenderers[modelType];
 	// const auto& unitBinKeys = mdlRenderer.GetObjectBinKeys();
 
+	const bool drawInstanced = CanDrawInstanced();
+
+	unitCuller.Clear();
+	unitCuller.AddObjects(mdlRenderer);
+	unitCuller.Cull([&](const CUnit* unit) { return (CullOpaqueUnit(unit, drawReflection, drawRefraction)); });
+
 	for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
 		BindModelTypeTexture(modelType, mdlRenderer.GetObjectBinKey(i));
 
+		if (drawInstanced)
+			instancedUnits.AddBin(modelType, mdlRenderer.GetObjectBinKey(i));
+
 		for (CUnit* unit: mdlRenderer.GetObjectBin(i)) {
-			DrawOpaqueUnit(unit, drawReflection, drawRefraction);
+			DrawOpaqueUnit(unit, unitCuller.NextResult(), drawInstanced);
 		}
 	}
+
+	DrawInstancedBatch(instancedUnits);
 }
 
-inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, bool drawReflection, bool drawRefraction)
+inline void CUnitDrawer::DrawOpaqueUnit(CUnit* unit, uint8_t cullResult, bool drawInstanced)
 {
-	if (!CanDrawOpaqueUnit(unit, drawReflection, drawRefraction))
-		return;
+	switch (cullResult) {
+		case UnitCuller::CULL_RESULT_HIDDEN: {                                    return; } break;
+		case UnitCuller::CULL_RESULT_FARTEX: { farTextureHandler->Queue(unit); return; } break;
+		default: {} break;
+	}
 
-	if ((unit->pos).SqDistance(camera->GetPos()) > (unit->sqRadius * unitDrawDistSqr)) {
-		farTextureHandler->Queue(unit);
+	if (!water->CountPassObject())
 		return;
-	}
 
 	if (LuaObjectDrawer::AddOpaqueMaterialObject(unit, LUAOBJ_UNIT))
 		return;
 
+	// nano-frames and DrawUnit call-ins need the individual path
+	if (drawInstanced && !unit->luaDraw && (!unit->beingBuilt || !unit->unitDef->showNanoFrame)) {
+		instancedUnits.AddObject(unit);
+		return;
+	}
+
 	// draw the unit with the default (non-Lua) material
 	SetTeamColour(unit->team);
 	DrawUnitDefTrans(unit, false, false);
 }
 
 
+bool CUnitDrawer::CanDrawInstanced() const
+{
+	if (!drawInstanced || !modelInstanceBuffer.IsValid())
+		return false;
+	if (shadowHandler.InShadowPass())
+		return false;
+
+	return (unitDrawerStates[DRAWER_STATE_SEL]->CanDrawInstanced());
+}
+
+void CUnitDrawer::DrawInstancedBatch(InstancedModelBatch& batch)
+{
+	if (batch.Empty()) {
+		batch.Clear();
+		return;
+	}
+
+	const IUnitDrawerState* state = unitDrawerStates[DRAWER_STATE_SEL];
+
+	std::vector<CSolidObject*>& objects = batch.objects;
+	std::vector<size_t>& texelOffsets = batch.texelOffsets;
+
+	// group each bin by model, every run becomes a single instanced draw
+	for (const InstancedModelBatch::Bin& bin: batch.bins) {
+		std::sort(objects.begin() + bin.objectsBeg, objects.begin() + bin.objectsEnd, [](const CSolidObject* a, const CSolidObject* b) {
+			if (a->model != b->model)
+				return (a->model->id < b->model->id);
+			if (a->localModel.GetMeshLOD() != b->localModel.GetMeshLOD())
+				return (a->localModel.GetMeshLOD() < b->localModel.GetMeshLOD());
+
+			return (a->id < b->id);
+		});
+	}
+
+	texelOffsets.resize(objects.size() + 1);
+	texelOffsets[0] = 0;
+
+	for (size_t i = 0, n = objects.size(); i < n; i++) {
+		texelOffsets[i + 1] = texelOffsets[i] + CModelInstanceBuffer::GetBlockSize(objects[i]->localModel.GetPieceMatrices().size());
+	}
+
+	float4* texels = modelInstanceBuffer.MapBlocks(texelOffsets.back());
+
+	if (texels == nullptr) {
+		// batch does not fit, draw it the regular way
+		GL::ScopedTextureCache texCache;
+
+		for (const InstancedModelBatch::Bin& bin: batch.bins) {
+			BindModelTypeTexture(bin.mdlType, bin.texType);
+
+			for (size_t i = bin.objectsBeg; i < bin.objectsEnd; i++) {
+				CSolidObject* o = objects[i];
+
+				o->localModel.UpdatePieceMatrices(gs->frameNum);
+
+				SetTeamColour(o->team);
+				state->SetMatrices(o->GetTransformMatrix(), o->localModel.GetPieceMatrices());
+				o->localModel.Draw();
+			}
+		}
+
+		batch.Clear();
+		return;
+	}
+
+	// every task only touches the LocalModel of its own object and
+	// its own block of the mapped range, draw-calls follow afterwards
+	for_mt(0, objects.size(), [&](const int i) {
+		CSolidObject* o = objects[i];
+		LocalModel& lm = o->localModel;
+
+		lm.UpdatePieceMatrices(gs->frameNum);
+
+		const std::vector<CMatrix44f>& pieceMats = lm.GetPieceMatrices();
+
+		CModelInstanceBuffer::WriteBlock(texels + texelOffsets[i], IUnitDrawerState::GetTeamColor(o->team, 1.0f), GetInstanceTexLayers(o->model), o->GetTransformMatrix(), pieceMats.data(), pieceMats.size());
+	});
+
+	const size_t baseOffset = modelInstanceBuffer.GetMappedOffset();
+
+	modelInstanceBuffer.UnmapBlocks();
+	modelInstanceBuffer.BindTexture();
+
+	// bins sharing a pair of texture-arrays become adjacent and need no rebinds
+	std::sort(batch.bins.begin(), batch.bins.end(), [](const InstancedModelBatch::Bin& a, const InstancedModelBatch::Bin& b) {
+		return (GetInstanceTexArrays(a) < GetInstanceTexArrays(b));
+	});
+
+	std::uint64_t boundTexArrays = 0;
+
+	// bins without texture-arrays can still share model-type textures
+	GL::ScopedTextureCache texCache;
+
+	for (const InstancedModelBatch::Bin& bin: batch.bins) {
+		if (bin.objectsBeg == bin.objectsEnd)
+			continue;
+
+		const std::uint64_t binTexArrays = GetInstanceTexArrays(bin);
+
+		if (binTexArrays == 0) {
+			BindModelTypeTexture(bin.mdlType, bin.texType);
+		} else if (binTexArrays != boundTexArrays) {
+			glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + CS3OTextureHandler::TEX2_ARRAY_UNIT);
+			glAttribStatePtr->BindTexture(GL_TEXTURE_2D_ARRAY, binTexArrays & 0xFFFFFFFFu);
+			glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + CS3OTextureHandler::TEX1_ARRAY_UNIT);
+			glAttribStatePtr->BindTexture(GL_TEXTURE_2D_ARRAY, binTexArrays >> 32u);
+			glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+
+			boundTexArrays = binTexArrays;
+		}
+
+		for (size_t i = bin.objectsBeg, j = i; i < bin.objectsEnd; i = j) {
+			const S3DModel* mdl = objects[i]->model;
+			const unsigned int lod = objects[i]->localModel.GetMeshLOD();
+
+			for (j = i + 1; j < bin.objectsEnd && objects[j]->model == mdl && objects[j]->localModel.GetMeshLOD() == lod; j++);
+
+			state->SetInstanceParams(baseOffset + texelOffsets[i], texelOffsets[i + 1] - texelOffsets[i]);
+			mdl->DrawInstanced(j - i, lod);
+		}
+	}
+
+	state->SetInstanceParams(0, 0);
+
+	if (boundTexArrays != 0) {
+		glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + CS3OTextureHandler::TEX2_ARRAY_UNIT);
+		glAttribStatePtr->BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		glAttribStatePtr->ActiveTexture(GL_TEXTURE0 + CS3OTextureHandler::TEX1_ARRAY_UNIT);
+		glAttribStatePtr->BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+		glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+	}
+
+	modelInstanceBuffer.UnbindTexture();
+	batch.Clear();
+}
+
+float4 CUnitDrawer::GetInstanceTexLayers(const S3DModel* mdl)
+{
+	if (mdl->type == MODELTYPE_3DO)
+		return {-1.0f, -1.0f, 0.0f, 0.0f};
+
+	const CS3OTextureHandler::S3OTexMat* texMat = textureHandlerS3O.GetTexture(mdl->textureType);
+
+	if (texMat == nullptr || !texMat->IsPacked())
+		return {-1.0f, -1.0f, 0.0f, 0.0f};
+
+	return {texMat->tex1Layer * 1.0f, texMat->tex2Layer * 1.0f, 0.0f, 0.0f};
+}
+
+std::uint64_t CUnitDrawer::GetInstanceTexArrays(const InstancedModelBatch::Bin& bin)
+{
+	if (bin.mdlType == MODELTYPE_3DO)
+		return 0;
+
+	const CS3OTextureHandler::S3OTexMat* texMat = textureHandlerS3O.GetTexture(bin.texType);
+
+	if (texMat == nullptr || !texMat->IsPacked())
+		return 0;
+
+	return ((std::uint64_t(texMat->tex1Array) << 32u) | texMat->tex2Array);
+}
+
+
 void CUnitDrawer::DrawOpaqueAIUnits(int modelType)
 {
 	const std::vector<TempDrawUnit>& tmpOpaqueUnits = tempOpaqueUnits[modelType];
@@ -518,51 +732,150 @@ void CUnitDrawer::DrawUnitIcons()
 	if (globalRendering->msaaLevel >= 4)
 		glEnable(GL_SAMPLE_ALPHA_TO_COVERAGE);
 
-	GL::RenderDataBufferTC* buffer = GL::GetRenderBufferTC();
-	Shader::IProgramObject* shader = buffer->GetShader();
-
-	shader->Enable();
-	shader->SetUniformMatrix4x4<float>("u_movi_mat", false, camera->GetViewMatrix());
-	shader->SetUniformMatrix4x4<float>("u_proj_mat", false, camera->GetProjectionMatrix());
-	shader->SetUniform("u_alpha_test_ctrl", 0.5f, 1.0f, 0.0f, 0.0f); // test > 0.5
+	if (!DrawUnitIconsInstanced()) {
+		// one draw-call per icon texture
+		GL::RenderDataBufferTC* buffer = GL::GetRenderBufferTC();
+		Shader::IProgramObject* shader = buffer->GetShader();
 
+		shader->Enable();
+		shader->SetUniformMatrix4x4<float>("u_movi_mat", false, camera->GetViewMatrix());
+		shader->SetUniformMatrix4x4<float>("u_proj_mat", false, camera->GetProjectionMatrix());
+		shader->SetUniform("u_alpha_test_ctrl", 0.5f, 1.0f, 0.0f, 0.0f); // test > 0.5
 
-	for (const auto& p: unitsByIcon) {
-		const icon::CIconData* icon = p.first;
-		const std::vector<const CUnit*>& units = p.second;
+		for (const auto& p: unitsByIcon) {
+			const icon::CIconData* icon = p.first;
+			const std::vector<const CUnit*>& units = p.second;
 
-		if (icon == nullptr)
-			continue;
-		if (units.empty())
-			continue;
+			if (icon == nullptr)
+				continue;
+			if (units.empty())
+				continue;
 
-		icon->BindTexture();
+			icon->BindTexture();
 
-		for (const CUnit* unit: units) {
-			assert(unitIcons[unit->id] == icon);
+			for (const CUnit* unit: units) {
+				assert(unitIcons[unit->id] == icon);
 
-			// unitsByIcon is unfiltered, also used for drawing on minimap
-			if (!unit->isIcon)
-				continue;
+				// unitsByIcon is unfiltered, also used for drawing on minimap
+				if (!unit->isIcon)
+					continue;
 
-			const unsigned short closBits = (unit->losStatus[gu->myAllyTeam] & (LOS_INLOS                  ));
-			const unsigned short plosBits = (unit->losStatus[gu->myAllyTeam] & (LOS_PREVLOS | LOS_CONTRADAR));
+				DrawUnitIcon(const_cast<CUnit*>(unit), buffer, DrawUnitIconAsRadarBlip(unit));
+			}
 
-			DrawUnitIcon(const_cast<CUnit*>(unit), buffer, !gu->spectatingFullView && closBits == 0 && plosBits != (LOS_PREVLOS | LOS_CONTRADAR));
+			buffer->Submit(GL_TRIANGLES);
 		}
 
-		buffer->Submit(GL_TRIANGLES);
+		shader->SetUniform("u_alpha_test_ctrl", 0.0f, 1.0f, 0.0f, 1.0f); // no test
+		shader->Disable();
 	}
 
 
 	if (globalRendering->msaaLevel >= 4)
 		glDisable(GL_SAMPLE_ALPHA_TO_COVERAGE);
 
-	shader->SetUniform("u_alpha_test_ctrl", 0.0f, 1.0f, 0.0f, 1.0f); // no test
-	shader->Disable();
 	glAttribStatePtr->PopBits();
 }
 
+bool CUnitDrawer::DrawUnitIconsInstanced()
+{
+	Shader::IProgramObject* iconShader = &iconQuadBuffer.GetShader();
+
+	if (!modelInstanceBuffer.IsValid() || !iconShader->IsValid())
+		return false;
+
+	visibleIcons.clear();
+
+	for (const auto& p: unitsByIcon) {
+		if (p.first == nullptr)
+			continue;
+
+		for (const CUnit* unit: p.second) {
+			assert(unitIcons[unit->id] == p.first);
+
+			if (!unit->isIcon)
+				continue;
+
+			visibleIcons.emplace_back(const_cast<CUnit*>(unit), p.first);
+		}
+	}
+
+	if (visibleIcons.empty())
+		return true;
+
+	float4* texels = modelInstanceBuffer.MapBlocks(visibleIcons.size() * ICON_BLOCK_SIZE);
+
+	if (texels == nullptr)
+		return false;
+
+	// every task only touches its own unit's iconRadius and block
+	for_mt(0, visibleIcons.size(), [&](const int i) {
+		CUnit* unit = visibleIcons[i].first;
+
+		const float3 pos = UpdateUnitIconPos(unit, DrawUnitIconAsRadarBlip(unit));
+		const uint8_t* color = GetUnitIconColor(unit);
+
+		float4* block = texels + i * ICON_BLOCK_SIZE;
+
+		block[0] = {pos, unit->iconRadius};
+		block[1] = {color[0] / 255.0f, color[1] / 255.0f, color[2] / 255.0f, visibleIcons[i].second->GetAtlasLayer() * 1.0f};
+	});
+
+	const size_t baseOffset = modelInstanceBuffer.GetMappedOffset();
+
+	modelInstanceBuffer.UnmapBlocks();
+	modelInstanceBuffer.BindTexture();
+
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
+	icon::iconHandler.BindAtlasTexture();
+
+	iconShader->Enable();
+	iconShader->SetUniformMatrix4x4<float>("u_movi_mat", false, camera->GetViewMatrix());
+	iconShader->SetUniformMatrix4x4<float>("u_proj_mat", false, camera->GetProjectionMatrix());
+	iconShader->SetUniform("u_cam_right", camera->GetRight().x, camera->GetRight().y, camera->GetRight().z);
+	iconShader->SetUniform("u_cam_up", camera->GetUp().x, camera->GetUp().y, camera->GetUp().z);
+	iconShader->SetUniform("u_icon_inst_offset", int(baseOffset));
+
+	iconQuadBuffer.SubmitInstanced(GL_TRIANGLES, 0, 6, visibleIcons.size());
+
+	iconShader->Disable();
+
+	glAttribStatePtr->BindTexture(GL_TEXTURE_2D_ARRAY, 0);
+	modelInstanceBuffer.UnbindTexture();
+	return true;
+}
+
+void CUnitDrawer::LoadUnitIconBuffer()
+{
+	#ifndef HEADLESS
+	const std::string& vsText = Shader::GetShaderSource("GLSL/UnitIconVertProg.glsl");
+	const std::string& fsText = Shader::GetShaderSource("GLSL/UnitIconFragProg.glsl");
+
+	// corners in camera-aligned icon-radius units, texcoords as in DrawUnitIcon
+	const std::array<VA_TYPE_2dT, 6> verts = {{
+		{-1.0f, -1.0f,  0.0f, 1.0f}, // bl
+		{ 1.0f, -1.0f,  1.0f, 1.0f}, // br
+		{ 1.0f,  1.0f,  1.0f, 0.0f}, // tr
+
+		{ 1.0f,  1.0f,  1.0f, 0.0f}, // tr
+		{-1.0f,  1.0f,  0.0f, 0.0f}, // tl
+		{-1.0f, -1.0f,  0.0f, 1.0f}, // bl
+	}};
+
+	iconQuadBuffer.Init(false);
+	iconQuadBuffer.Upload2DT(verts.size(), 0, verts.data(), nullptr); // no indices
+
+	Shader::GLSLShaderObject shaderObjs[2] = {{GL_VERTEX_SHADER, vsText, ""}, {GL_FRAGMENT_SHADER, fsText, ""}};
+	Shader::IProgramObject* shaderProg = iconQuadBuffer.CreateShader((sizeof(shaderObjs) / sizeof(shaderObjs[0])), 0, &shaderObjs[0], nullptr);
+
+	shaderProg->Enable();
+	shaderProg->SetUniform("u_icon_atlas_tex", 0);
+	shaderProg->SetUniform("u_icon_inst_tex", int(CModelInstanceBuffer::TEXTURE_UNIT));
+	shaderProg->SetUniform("u_icon_inst_offset", 0);
+	shaderProg->Disable();
+	#endif
+}
+
 
 
 /******************************************************************************/
@@ -598,6 +911,37 @@ bool CUnitDrawer::CanDrawOpaqueUnit(
 	return (cam->InView(unit->drawMidPos, unit->GetDrawRadius()));
 }
 
+uint8_t CUnitDrawer::CullOpaqueUnit(const CUnit* unit, bool drawReflection, bool drawRefraction) const
+{
+	if (!CanDrawOpaqueUnit(unit, drawReflection, drawRefraction))
+		return UnitCuller::CULL_RESULT_HIDDEN;
+
+	// terrain occlusion is only known for the player's view
+	if (!drawReflection && !drawRefraction && (CCameraHandler::GetActiveCamera())->GetCamType() == CCamera::CAMTYPE_PLAYER) {
+		if (occlusionCuller.IsOccluded(unit->drawMidPos, unit->GetDrawRadius()))
+			return UnitCuller::CULL_RESULT_HIDDEN;
+	}
+
+	const float sqCamDist = (unit->pos).SqDistance(camera->GetPos());
+
+	if (sqCamDist > (unit->sqRadius * unitDrawDistSqr))
+		return UnitCuller::CULL_RESULT_FARTEX;
+
+	// mesh LOD follows the player's view, other passes reuse its choice
+	if (!drawReflection && !drawRefraction && (CCameraHandler::GetActiveCamera())->GetCamType() == CCamera::CAMTYPE_PLAYER) {
+		if (meshLODScale > 0.0f) {
+			const float camDist = std::max(fastmath::sqrt_builtin(sqCamDist), 1.0f);
+			const float pixelRadius = (unit->GetDrawRadius() * globalRendering->viewSizeY * 0.5f) / (camDist * camera->GetTanHalfFov() * meshLODScale);
+
+			unit->localModel.SetMeshLOD(pixelRadius);
+		} else {
+			unit->localModel.ResetMeshLOD();
+		}
+	}
+
+	return UnitCuller::CULL_RESULT_INVIEW;
+}
+
 bool CUnitDrawer::CanDrawOpaqueUnitShadow(const CUnit* unit) const
 {
 	if (unit->noDraw)
@@ -621,8 +965,8 @@ bool CUnitDrawer::CanDrawOpaqueUnitShadow(const CUnit* unit) const
 
 
 
-void CUnitDrawer::DrawOpaqueUnitShadow(CUnit* unit) {
-	if (!CanDrawOpaqueUnitShadow(unit))
+void CUnitDrawer::DrawOpaqueUnitShadow(CUnit* unit, uint8_t cullResult) {
+	if (cullResult == UnitCuller::CULL_RESULT_HIDDEN)
 		return;
 
 	if (LuaObjectDrawer::AddShadowMaterialObject(unit, LUAOBJ_UNIT))
@@ -636,13 +980,17 @@ void CUnitDrawer::DrawOpaqueUnitsShadow(int modelType) {
 	const auto& mdlRenderer = opaqueModelRenderers[modelType];
 	// const auto& unitBinKeys = mdlRenderer.GetObjectBinKeys();
 
+	unitCuller.Clear();
+	unitCuller.AddObjects(mdlRenderer);
+	unitCuller.Cull([&](const CUnit* unit) { return (uint8_t(CanDrawOpaqueUnitShadow(unit)) * UnitCuller::CULL_RESULT_INVIEW); });
+
 	for (unsigned int i = 0, n = mdlRenderer.GetNumObjectBins(); i < n; i++) {
 		// only need to bind the atlas once for 3DO's, but KISS
 		assert((modelType != MODELTYPE_3DO) || (mdlRenderer.GetObjectBinKey(i) == 0));
 		shadowTexBindFuncs[modelType](textureHandlerS3O.GetTexture(mdlRenderer.GetObjectBinKey(i)));
 
 		for (CUnit* unit: mdlRenderer.GetObjectBin(i)) {
-			DrawOpaqueUnitShadow(unit);
+			DrawOpaqueUnitShadow(unit, unitCuller.NextResult());
 		}
 
 		shadowTexKillFuncs[modelType](nullptr);
@@ -687,7 +1035,22 @@ void CUnitDrawer::DrawShadowPass()
 
 
 
-void CUnitDrawer::DrawUnitIcon(CUnit* unit, GL::RenderDataBufferTC* buffer, bool useDefaultIcon)
+bool CUnitDrawer::DrawUnitIconAsRadarBlip(const CUnit* unit)
+{
+	const unsigned short closBits = (unit->losStatus[gu->myAllyTeam] & (LOS_INLOS                  ));
+	const unsigned short plosBits = (unit->losStatus[gu->myAllyTeam] & (LOS_PREVLOS | LOS_CONTRADAR));
+
+	return (!gu->spectatingFullView && closBits == 0 && plosBits != (LOS_PREVLOS | LOS_CONTRADAR));
+}
+
+const uint8_t* CUnitDrawer::GetUnitIconColor(const CUnit* unit)
+{
+	// use white for selected units
+	const uint8_t* colors[] = {teamHandler.Team(unit->team)->color, color4::white};
+	return colors[unit->isSelected];
+}
+
+float3 CUnitDrawer::UpdateUnitIconPos(CUnit* unit, bool useDefaultIcon)
 {
 	// should never draw icons for void-space units, see UpdateUnitIconState
 	assert(!unit->IsInVoid());
@@ -721,10 +1084,13 @@ void CUnitDrawer::DrawUnitIcon(CUnit* unit, GL::RenderDataBufferTC* buffer, bool
 		pos.y = std::max(pos.y, CGround::GetHeightReal(pos.x, pos.z, false) + (unit->iconRadius = scaledSize * radiusMult));
 	}
 
+	return pos;
+}
 
-	// use white for selected units
-	const uint8_t* colors[] = {teamHandler.Team(unit->team)->color, color4::white};
-	const uint8_t* color = colors[unit->isSelected];
+void CUnitDrawer::DrawUnitIcon(CUnit* unit, GL::RenderDataBufferTC* buffer, bool useDefaultIcon)
+{
+	const float3 pos = UpdateUnitIconPos(unit, useDefaultIcon);
+	const uint8_t* color = GetUnitIconColor(unit);
 
 	// calculate the vertices
 	const float3 dy = camera->GetUp()    * unit->iconRadius;
@@ -938,6 +1304,38 @@ void CUnitDrawer::UpdateGhostedBuildings()
 	}
 }
 
+void CUnitDrawer::AddLiveGhostBuilding(CUnit* unit, int allyTeam)
+{
+	int& index = liveGhostIndices[allyTeam][unit->id];
+
+	if (index != -1)
+		return;
+
+	auto& lgb = liveGhostBuildings[allyTeam][MDL_TYPE(unit)];
+
+	index = lgb.size();
+	lgb.push_back(unit);
+}
+
+void CUnitDrawer::DelLiveGhostBuilding(CUnit* unit, int allyTeam)
+{
+	int& index = liveGhostIndices[allyTeam][unit->id];
+
+	if (index == -1)
+		return;
+
+	auto& lgb = liveGhostBuildings[allyTeam][MDL_TYPE(unit)];
+
+	assert(lgb[index] == unit);
+
+	// swap-and-pop, keeping the moved unit's index in sync
+	lgb[index] = lgb.back();
+	liveGhostIndices[allyTeam][lgb[index]->id] = index;
+	lgb.pop_back();
+
+	index = -1;
+}
+
 void CUnitDrawer::DrawGhostedBuildings(int modelType)
 {
 	assert((unsigned) gu->myAllyTeam < deadGhostBuildings.size());
@@ -1496,7 +1894,13 @@ inline void CUnitDrawer::UpdateUnitIconState(CUnit* unit) {
 inline void CUnitDrawer::UpdateUnitDrawPos(CUnit* u) {
 	const CUnit* t = u->GetTransporter();
 
-	if (t != nullptr) {
+	const CDrawSnapshot::UnitState* us = drawSnapshot.GetState(u);
+	const CDrawSnapshot::UnitState* ts = (t != nullptr)? drawSnapshot.GetState(t): us;
+
+	if (us != nullptr && ts != nullptr) {
+		u->drawPos = us->preFramePos + ts->GetDrawDeltaPos(globalRendering->timeOffset);
+	} else if (t != nullptr) {
+		// not published yet, e.g. created or loaded by synced Lua outside a sim-frame
 		u->drawPos = u->preFramePos + t->GetDrawDeltaPos(globalRendering->timeOffset);
 	} else {
 		u->drawPos = u->preFramePos + u->GetDrawDeltaPos(globalRendering->timeOffset);
@@ -1706,7 +2110,7 @@ inline float GetUnitIconScale(const CUnit* unit, const icon::CIconData* icon) {
 }
 
 
-void CUnitDrawer::DrawUnitMiniMapIcon(const CUnit* unit, GL::RenderDataBufferTC* buffer) const {
+void CUnitDrawer::DrawUnitMiniMapIcon(const CUnit* unit, std::vector<VA_TYPE_TC>& verts) const {
 	if (unit->noMinimap)
 		return;
 	if (unit->IsInVoid())
@@ -1744,32 +2148,50 @@ void CUnitDrawer::DrawUnitMiniMapIcon(const CUnit* unit, GL::RenderDataBufferTC*
 	const float y0 = iconPos.z - iconSizeY;
 	const float y1 = iconPos.z + iconSizeY;
 
-	buffer->SafeAppend({{x0, y0, 0.0f}, 0.0f, 0.0f, color}); // tl
-	buffer->SafeAppend({{x1, y0, 0.0f}, 1.0f, 0.0f, color}); // tr
-	buffer->SafeAppend({{x1, y1, 0.0f}, 1.0f, 1.0f, color}); // br
+	verts.push_back({{x0, y0, 0.0f}, 0.0f, 0.0f, color}); // tl
+	verts.push_back({{x1, y0, 0.0f}, 1.0f, 0.0f, color}); // tr
+	verts.push_back({{x1, y1, 0.0f}, 1.0f, 1.0f, color}); // br
 
-	buffer->SafeAppend({{x1, y1, 0.0f}, 1.0f, 1.0f, color}); // br
-	buffer->SafeAppend({{x0, y1, 0.0f}, 0.0f, 1.0f, color}); // bl
-	buffer->SafeAppend({{x0, y0, 0.0f}, 0.0f, 0.0f, color}); // tl
+	verts.push_back({{x1, y1, 0.0f}, 1.0f, 1.0f, color}); // br
+	verts.push_back({{x0, y1, 0.0f}, 0.0f, 1.0f, color}); // bl
+	verts.push_back({{x0, y0, 0.0f}, 0.0f, 0.0f, color}); // tl
 }
 
-void CUnitDrawer::DrawUnitMiniMapIcons(GL::RenderDataBufferTC* buffer) const {
-	for (const auto& iconPair: unitsByIcon) {
-		const icon::CIconData* icon = iconPair.first;
-		const std::vector<const CUnit*>& units = iconPair.second;
+void CUnitDrawer::DrawUnitMiniMapIcons(GL::RenderDataBufferTC* buffer, bool refresh) {
+	if (refresh) {
+		miniMapIconVerts.clear();
+		miniMapIconBatches.clear();
 
-		if (icon == nullptr)
-			continue;
-		if (units.empty())
-			continue;
+		for (const auto& iconPair: unitsByIcon) {
+			const icon::CIconData* icon = iconPair.first;
+			const std::vector<const CUnit*>& units = iconPair.second;
+
+			if (icon == nullptr)
+				continue;
+			if (units.empty())
+				continue;
 
-		icon->BindTexture();
+			for (const CUnit* unit: units) {
+				assert(unitIcons[unit->id] == icon);
+				DrawUnitMiniMapIcon(unit, miniMapIconVerts);
+			}
 
-		for (const CUnit* unit: units) {
-			assert(unitIcons[unit->id] == icon);
-			DrawUnitMiniMapIcon(unit, buffer);
+			miniMapIconBatches.emplace_back(icon, miniMapIconVerts.size());
 		}
+	}
+
+	// icons (and their positions) only change on refresh; the minimap
+	// texture itself may be redrawn more often, e.g. for Lua overlays
+	for (size_t i = 0, n = miniMapIconBatches.size(); i < n; i++) {
+		const size_t vertsBeg = (i == 0)? 0: miniMapIconBatches[i - 1].second;
+		const size_t vertsEnd = miniMapIconBatches[i].second;
+
+		if (vertsBeg == vertsEnd)
+			continue;
+
+		miniMapIconBatches[i].first->BindTexture();
 
+		buffer->SafeAppend(&miniMapIconVerts[vertsBeg], vertsEnd - vertsBeg);
 		buffer->Submit(GL_TRIANGLES);
 	}
 }
@@ -1850,7 +2272,7 @@ void CUnitDrawer::RenderUnitDestroyed(const CUnit* unit) {
 			gso->IncRef();
 		}
 
-		spring::VectorErase(liveGhostBuildings[allyTeam][MDL_TYPE(u)], u);
+		DelLiveGhostBuilding(u, allyTeam);
 	}
 
 	if (u->model != nullptr) {
@@ -1888,7 +2310,7 @@ void CUnitDrawer::UnitEnteredLos(const CUnit* unit, int allyTeam) {
 	CUnit* u = const_cast<CUnit*>(unit); //cleanup
 
 	if (gameSetup->ghostedBuildings && unit->unitDef->IsBuildingUnit())
-		spring::VectorErase(liveGhostBuildings[allyTeam][MDL_TYPE(unit)], u);
+		DelLiveGhostBuilding(u, allyTeam);
 
 	if (allyTeam != gu->myAllyTeam)
 		return;
@@ -1900,7 +2322,7 @@ void CUnitDrawer::UnitLeftLos(const CUnit* unit, int allyTeam) {
 	CUnit* u = const_cast<CUnit*>(unit); //cleanup
 
 	if (gameSetup->ghostedBuildings && unit->unitDef->IsBuildingUnit())
-		spring::VectorInsertUnique(liveGhostBuildings[allyTeam][MDL_TYPE(unit)], u, true);
+		AddLiveGhostBuilding(u, allyTeam);
 
 	if (allyTeam != gu->myAllyTeam)
 		return;
@@ -10,7 +10,9 @@
 #include "Rendering/GL/LightHandler.h"
 #include "Rendering/GL/RenderDataBufferFwd.hpp"
 #include "Rendering/Models/3DModel.h"
+#include "Rendering/Models/ModelInstanceBuffer.h"
 #include "Rendering/Models/ModelRenderContainer.h"
+#include "Rendering/ObjectCuller.h"
 #include "Rendering/UnitDrawerState.hpp"
 #include "Rendering/UnitDefImage.h"
 #include "System/EventClient.h"
@@ -56,7 +58,6 @@ public:
 };
 
 
-
 class CUnitDrawer: public CEventClient
 {
 public:
@@ -139,6 +140,18 @@ public:
 	void SetupAlphaDrawing(bool deferredPass, bool aboveWater);
 	void ResetAlphaDrawing(bool deferredPass);
 
+	// true if default-material models can be batched via DrawInstancedBatch
+	bool CanDrawInstanced() const;
+	// updates and uploads the piece-matrices of all objects in <batch> in
+	// parallel, then submits one draw per model-run (and clears <batch>)
+	void DrawInstancedBatch(InstancedModelBatch& batch);
+
+	// per-instance S3O texture-array layers, negative if the model is unpacked
+	static float4 GetInstanceTexLayers(const S3DModel* mdl);
+	// (tex1, tex2) texture-array pair used by <bin>, zero if unpacked
+	static std::uint64_t GetInstanceTexArrays(const InstancedModelBatch::Bin& bin);
+
+
 	void SetupShowUnitBuildSquares(bool onMiniMap, bool testCanBuild);
 	void ResetShowUnitBuildSquares(bool onMiniMap, bool testCanBuild);
 	bool ShowUnitBuildSquares(const BuildInfo& buildInfo, const std::vector<Command>& commands, bool testCanBuild);
@@ -154,6 +167,7 @@ public:
 
 public:
 	typedef void (*DrawModelFunc)(const CUnit*, bool);
+	typedef CObjectCuller<CUnit> UnitCuller;
 
 	const std::vector<CUnit*>& GetUnsortedUnits() const { return unsortedUnits; }
 
@@ -211,9 +225,10 @@ private:
 
 	bool CanDrawOpaqueUnit(const CUnit* unit, bool drawReflection, bool drawRefraction) const;
 	bool CanDrawOpaqueUnitShadow(const CUnit* unit) const;
+	uint8_t CullOpaqueUnit(const CUnit* unit, bool drawReflection, bool drawRefraction) const;
 
-	void DrawOpaqueUnit(CUnit* unit, bool drawReflection, bool drawRefraction);
-	void DrawOpaqueUnitShadow(CUnit* unit);
+	void DrawOpaqueUnit(CUnit* unit, uint8_t cullResult, bool drawInstanced);
+	void DrawOpaqueUnitShadow(CUnit* unit, uint8_t cullResult);
 	void DrawOpaqueUnitsShadow(int modelType);
 	void DrawOpaqueUnits(int modelType, bool drawReflection, bool drawRefraction);
 
@@ -227,16 +242,29 @@ private:
 
 	void DrawGhostedBuildings(int modelType);
 
+	// O(1) updates of liveGhostBuildings from the LOS events
+	void AddLiveGhostBuilding(CUnit* unit, int allyTeam);
+	void DelLiveGhostBuilding(CUnit* unit, int allyTeam);
+
 public:
 	void DrawUnitIcons();
-	void DrawUnitMiniMapIcon(const CUnit* unit, GL::RenderDataBufferTC* buffer) const;
-	void DrawUnitMiniMapIcons(GL::RenderDataBufferTC* buffer) const;
+	void DrawUnitMiniMapIcon(const CUnit* unit, std::vector<VA_TYPE_TC>& verts) const;
+	// regathers the icon batches from all units if <refresh> is true, then submits them
+	void DrawUnitMiniMapIcons(GL::RenderDataBufferTC* buffer, bool refresh);
 
 private:
 	void UpdateUnitMiniMapIcon(const CUnit* unit, bool forced, bool killed);
 	void UpdateUnitIconState(CUnit* unit);
 
+	// writes the instance-texels of every visible icon and draws them in one call
+	bool DrawUnitIconsInstanced();
+
+	void LoadUnitIconBuffer();
+
 	static void DrawUnitIcon(CUnit* unit, GL::RenderDataBufferTC* buffer, bool asRadarBlip);
+	static float3 UpdateUnitIconPos(CUnit* unit, bool asRadarBlip);
+	static const uint8_t* GetUnitIconColor(const CUnit* unit);
+	static bool DrawUnitIconAsRadarBlip(const CUnit* unit);
 	static void UpdateUnitDrawPos(CUnit* unit);
 
 public:
@@ -284,6 +312,8 @@ public:
 public:
 	float unitDrawDist;
 	float unitDrawDistSqr;
+	// divides the projected unit size used to pick mesh LOD's, 0 disables them
+	float meshLODScale;
 	float unitIconDist;
 	float iconLength;
 	float sqCamDistToGroundForIcons;
@@ -298,6 +328,7 @@ private:
 	bool drawForward;
 	bool drawDeferred;
 	bool wireFrameMode;
+	bool drawInstanced;
 
 	bool useDistToGroundForIcons;
 
@@ -308,6 +339,10 @@ private:
 	/// units being rendered (note that this is a completely
 	/// unsorted set of 3DO, S3O, opaque, and cloaked models!)
 	std::vector<CUnit*> unsortedUnits;
+	/// default-material units batched by DrawOpaqueUnits
+	InstancedModelBatch instancedUnits;
+	/// per-pass visibility results for the opaque and shadow passes
+	UnitCuller unitCuller;
 
 	/// AI unit ghosts
 	std::array< std::vector<TempDrawUnit>, MODELTYPE_OTHER> tempOpaqueUnits;
@@ -317,10 +352,18 @@ private:
 	std::vector<std::array<std::vector<GhostSolidObject*>, MODELTYPE_OTHER>> deadGhostBuildings;
 	/// buildings that left LOS but are still alive
 	std::vector<std::array<std::vector<CUnit*>, MODELTYPE_OTHER>> liveGhostBuildings;
+	/// per allyteam and unit-ID, the unit's index in liveGhostBuildings or -1
+	std::vector<std::vector<int>> liveGhostIndices;
 
 	/// units that are only rendered as icons this frame
 	spring::unsynced_map<icon::CIconData*, std::vector<const CUnit*> > unitsByIcon;
 	std::vector<icon::CIconData*> unitIcons;
+	/// icons drawn by the instanced pass this frame, with the icon whose texture they use
+	std::vector< std::pair<CUnit*, const icon::CIconData*> > visibleIcons;
+
+	/// minimap icon vertices from the last refresh, as {icon, end-vertex} batches
+	std::vector<VA_TYPE_TC> miniMapIconVerts;
+	std::vector< std::pair<const icon::CIconData*, size_t> > miniMapIconBatches;
 
 	std::vector<UnitDefImage> unitDefImages;
 
@@ -340,6 +383,8 @@ private:
 private:
 	GL::LightHandler lightHandler;
 	GL::GeometryBuffer* geomBuffer;
+
+	CModelInstanceBuffer modelInstanceBuffer;
 };
 
 extern CUnitDrawer* unitDrawer;
@@ -13,8 +13,11 @@
 #include "Rendering/Env/SkyLight.h"
 #include "Rendering/GL/GeometryBuffer.h"
 #include "Rendering/GL/myGL.h"
+#include "Rendering/Env/Particles/GPUFlyingPieceDrawer.h"
+#include "Rendering/Models/ModelInstanceBuffer.h"
 #include "Rendering/Shaders/ShaderHandler.h"
 #include "Rendering/Shaders/Shader.h"
+#include "Rendering/Textures/S3OTextureHandler.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/SpringMath.h"
@@ -71,17 +74,17 @@ void IUnitDrawerState::EnableTexturesCommon() const {
 	if (shadowHandler.ShadowsLoaded())
 		shadowHandler.SetupShadowTexSampler(GL_TEXTURE2);
 
-	glActiveTexture(GL_TEXTURE3);
-	glBindTexture(GL_TEXTURE_CUBE_MAP, cubeMapHandler.GetEnvReflectionTextureID());
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE3);
+	glAttribStatePtr->BindTexture(GL_TEXTURE_CUBE_MAP, cubeMapHandler.GetEnvReflectionTextureID());
 
-	glActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
 }
 
 void IUnitDrawerState::DisableTexturesCommon() const {
 	if (shadowHandler.ShadowsLoaded())
 		shadowHandler.ResetShadowTexSampler(GL_TEXTURE2);
 
-	glActiveTexture(GL_TEXTURE0);
+	glAttribStatePtr->ActiveTexture(GL_TEXTURE0);
 }
 
 
@@ -101,7 +104,9 @@ bool UnitDrawerStateGLSL::Init(const CUnitDrawer* ud) {
 		("#define MAX_DYNAMIC_MODEL_LIGHTS " + IntToString(GL::LightHandler::MaxConfigLights()) + "\n") +
 		("#define MAX_LIGHT_UNIFORM_VECS "   + IntToString(GL::LightHandler::MaxUniformVecs()) + "\n") +
 		("#define MDL_CLIP_PLANE_IDX "       + IntToString(            IWater::ClipPlaneIndex()) + "\n") +
-		("#define MDL_FRAGDATA_COUNT "       + IntToString(GL::GeometryBuffer::ATTACHMENT_COUNT) + "\n");
+		("#define MDL_FRAGDATA_COUNT "       + IntToString(GL::GeometryBuffer::ATTACHMENT_COUNT) + "\n") +
+		("#define LIGHT_GRID_SIZE "          + IntToString(GL::LightHandler::LightGridSize()) + "\n") +
+		(lightHandler->UseLightGrid()? "#define USE_LIGHT_GRID\n": "");
 
 	const float3 cameraPos = camera->GetPos();
 	const float3 fogParams = {sky->fogStart, sky->fogEnd, camera->GetFarPlaneDist()};
@@ -151,12 +156,30 @@ bool UnitDrawerStateGLSL::Init(const CUnitDrawer* ud) {
 		modelShaders[n]->SetUniformLocation("alphaTestCtrl");     // idx 24
 		modelShaders[n]->SetUniformLocation("gammaExponent");     // idx 25
 		modelShaders[n]->SetUniformLocation("fwdDynLights");      // idx 26
+		modelShaders[n]->SetUniformLocation("instanceData");      // idx 27
+		modelShaders[n]->SetUniformLocation("instanceParams");    // idx 28
+		modelShaders[n]->SetUniformLocation("diffuseTexArray");   // idx 29
+		modelShaders[n]->SetUniformLocation("shadingTexArray");   // idx 30
+		modelShaders[n]->SetUniformLocation("flyingPieceData");   // idx 31
+		modelShaders[n]->SetUniformLocation("flyingPieceParams"); // idx 32
+		modelShaders[n]->SetUniformLocation("lightDataTex");      // idx 33
+		modelShaders[n]->SetUniformLocation("lightGridTex");      // idx 34
+		modelShaders[n]->SetUniformLocation("lightGridScale");    // idx 35
 
 		modelShaders[n]->Enable();
 		modelShaders[n]->SetUniform1i(0, 0); // diffuseTex  (idx 0, texunit 0)
 		modelShaders[n]->SetUniform1i(1, 1); // shadingTex  (idx 1, texunit 1)
 		modelShaders[n]->SetUniform1i(2, 2); // shadowTex   (idx 2, texunit 2)
 		modelShaders[n]->SetUniform1i(3, 3); // reflectTex  (idx 3, texunit 3)
+		modelShaders[n]->SetUniform1i(27, CModelInstanceBuffer::TEXTURE_UNIT);
+		modelShaders[n]->SetUniform2i(28, 0, 0); // instanceParams (non-instanced)
+		modelShaders[n]->SetUniform1i(29, CS3OTextureHandler::TEX1_ARRAY_UNIT);
+		modelShaders[n]->SetUniform1i(30, CS3OTextureHandler::TEX2_ARRAY_UNIT);
+		modelShaders[n]->SetUniform1i(31, CGPUFlyingPieceDrawer::TEXTURE_UNIT);
+		modelShaders[n]->SetUniform3f(32, 0.0f, 0.0f, 0.0f); // flyingPieceParams (disabled)
+		modelShaders[n]->SetUniform1i(33, LIGHT_GRID_TEX_UNIT    );
+		modelShaders[n]->SetUniform1i(34, LIGHT_GRID_TEX_UNIT + 1);
+		modelShaders[n]->SetUniform2fv(35, lightHandler->GetLightGridScale());
 
 		modelShaders[n]->SetUniform3fv(4, sky->GetLight()->GetLightDir());
 		modelShaders[n]->SetUniform3fv(9, &fogParams.x);
@@ -208,7 +231,12 @@ void UnitDrawerStateGLSL::Enable(const CUnitDrawer* ud, bool deferredPass, bool
 
 	if (cLightHandler->NumConfigLights() > 0) {
 		mLightHandler->Update();
-		shader->SetUniform4fv(26, cLightHandler->NumUniformVecs(), cLightHandler->GetRawLightDataPtr());
+
+		if (cLightHandler->UseLightGrid()) {
+			cLightHandler->BindLightGrid(LIGHT_GRID_TEX_UNIT);
+		} else {
+			shader->SetUniform4fv(26, cLightHandler->NumUniformVecs(), cLightHandler->GetRawLightDataPtr());
+		}
 	}
 
 	shader->SetUniform3fv(9, &fogParams.x);
@@ -221,6 +249,9 @@ void UnitDrawerStateGLSL::Enable(const CUnitDrawer* ud, bool deferredPass, bool
 }
 
 void UnitDrawerStateGLSL::Disable(const CUnitDrawer* ud, bool deferredPass) {
+	if (ud->GetLightHandler()->UseLightGrid())
+		ud->GetLightHandler()->UnbindLightGrid(LIGHT_GRID_TEX_UNIT);
+
 	DisableCommon(ud, deferredPass);
 }
 
@@ -307,3 +338,23 @@ void UnitDrawerStateGLSL::SetBuildClipPlanes(const float4& upper, const float4&
 	modelShaders[MODEL_SHADER_ACTIVE]->SetUniform4fv(12, lower);
 }
 
+void UnitDrawerStateGLSL::SetInstanceParams(unsigned int offset, unsigned int stride) const {
+	assert(modelShaders[MODEL_SHADER_ACTIVE]->IsBound());
+	modelShaders[MODEL_SHADER_ACTIVE]->SetUniform2i(28, offset, stride);
+}
+
+void UnitDrawerStateGLSL::SetFlyingPieceParams(bool enabled, float simFrame, float gravity) const {
+	if (!shadowHandler.InShadowPass()) {
+		assert(modelShaders[MODEL_SHADER_ACTIVE]->IsBound());
+		modelShaders[MODEL_SHADER_ACTIVE]->SetUniform3f(32, float(enabled), simFrame, gravity);
+		return;
+	}
+
+	Shader::IProgramObject* po = shadowHandler.GetCurrentShadowGenProg();
+
+	assert(shadowHandler.GetCurrentPass() == CShadowHandler::SHADOWGEN_PROGRAM_PROJECTILE);
+	assert(po->IsBound());
+
+	po->SetUniform3f(6, float(enabled), simFrame, gravity);
+}
+
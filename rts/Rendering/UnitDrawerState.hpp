@@ -46,6 +46,7 @@ public:
 	virtual bool CanEnable(const CUnitDrawer*) const { return false; }
 	virtual bool CanDrawAlpha() const { return false; }
 	virtual bool CanDrawDeferred() const { return false; }
+	virtual bool CanDrawInstanced() const { return false; }
 
 	virtual void Enable(const CUnitDrawer*, bool, bool) = 0;
 	virtual void Disable(const CUnitDrawer*, bool) = 0;
@@ -63,6 +64,10 @@ public:
 	virtual void SetMatrices(const CMatrix44f& modelMat, const CMatrix44f* pieceMats, size_t numPieceMats) const = 0;
 	virtual void SetWaterClipPlane(const DrawPass::e& drawPass) const = 0; // water
 	virtual void SetBuildClipPlanes(const float4&, const float4&) const = 0; // nano-frames
+	// stride=0 disables instancing, see CModelInstanceBuffer
+	virtual void SetInstanceParams(unsigned int offset, unsigned int stride) const {}
+	// enables per-instance part records, see CGPUFlyingPieceDrawer
+	virtual void SetFlyingPieceParams(bool enabled, float simFrame, float gravity) const {}
 
 	void SetActiveShader(unsigned int shadowed, unsigned int deferred) {
 		// shadowed=1 --> shader 1 (deferred=0) or 3 (deferred=1)
@@ -151,12 +156,16 @@ public:
 
 struct UnitDrawerStateGLSL: public IUnitDrawerState {
 public:
+	// light-data and light-grid buffers, see GL::LightHandler
+	static constexpr unsigned int LIGHT_GRID_TEX_UNIT = 9;
+
 	bool Init(const CUnitDrawer*) override;
 	void Kill() override;
 
 	bool CanEnable(const CUnitDrawer*) const override { return true; }
 	bool CanDrawAlpha() const override { return true; }
 	bool CanDrawDeferred() const  override { return true; }
+	bool CanDrawInstanced() const override { return true; }
 
 	void Enable(const CUnitDrawer*, bool, bool) override;
 	void Disable(const CUnitDrawer*, bool) override;
@@ -174,6 +183,8 @@ public:
 	void SetMatrices(const CMatrix44f& modelMat, const CMatrix44f* pieceMats, size_t numPieceMats) const override;
 	void SetWaterClipPlane(const DrawPass::e& drawPass) const override;
 	void SetBuildClipPlanes(const float4&, const float4&) const override;
+	void SetInstanceParams(unsigned int offset, unsigned int stride) const override;
+	void SetFlyingPieceParams(bool enabled, float simFrame, float gravity) const override;
 };
 
 #endif
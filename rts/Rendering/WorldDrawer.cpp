@@ -2,6 +2,7 @@
 
 #include "Rendering/GL/myGL.h"
 #include "Rendering/GL/RenderDataBuffer.hpp"
+#include "Rendering/GL/TimerQueries.h"
 
 #include "WorldDrawer.h"
 #include "Rendering/Env/CubeMapHandler.h"
@@ -17,6 +18,7 @@
 #include "Rendering/FarTextureHandler.h"
 #include "Rendering/LineDrawer.h"
 #include "Rendering/LuaObjectDrawer.h"
+#include "Rendering/OcclusionCuller.h"
 #include "Rendering/FeatureDrawer.h"
 #include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Rendering/UnitDrawer.h"
@@ -104,6 +106,7 @@ void CWorldDrawer::InitPost() const
 	}
 	{
 		IGroundDecalDrawer::Init();
+		occlusionCuller.Init();
 	}
 	{
 		loadscreen->SetLoadMessage("Creating ProjectileDrawer & UnitDrawer");
@@ -151,6 +154,7 @@ void CWorldDrawer::Kill()
 
 	readMap->KillGroundDrawer();
 	IGroundDecalDrawer::FreeInstance();
+	occlusionCuller.Kill();
 	LuaObjectDrawer::Kill();
 	DebugColVolDrawer::Kill();
 
@@ -177,6 +181,11 @@ void CWorldDrawer::Update(bool newSimFrame)
 	featureDrawer->Update();
 	IWater::ApplyPushedChanges(game);
 
+	{
+		SCOPED_TIMER("Update::WorldDrawer::UploadModels");
+		modelLoader.UploadPreloadedModels();
+	}
+
 	if (newSimFrame) {
 		projectileDrawer->UpdateTextures();
 
@@ -202,6 +211,7 @@ void CWorldDrawer::GenerateIBLTextures() const
 
 	if (shadowHandler.ShadowsLoaded()) {
 		SCOPED_TIMER("Draw::World::CreateShadows");
+		SCOPED_GL_TIMER("Draw::World::CreateShadows");
 		game->SetDrawMode(Game::ShadowDraw);
 		shadowHandler.CreateShadows();
 		game->SetDrawMode(Game::NormalDraw);
@@ -258,6 +268,7 @@ void CWorldDrawer::Draw() const
 
 	{
 		SCOPED_TIMER("Draw::World::Projectiles");
+		SCOPED_GL_TIMER("Draw::World::Projectiles");
 		projectileDrawer->Draw(false);
 	}
 
@@ -265,6 +276,7 @@ void CWorldDrawer::Draw() const
 
 	{
 		SCOPED_TIMER("Draw::World::DrawWorld");
+		SCOPED_GL_TIMER("Draw::World::DrawWorld");
 		eventHandler.DrawWorld();
 	}
 
@@ -280,8 +292,13 @@ void CWorldDrawer::DrawOpaqueObjects() const
 	if (globalRendering->drawGround) {
 		{
 			SCOPED_TIMER("Draw::World::Terrain");
+			SCOPED_GL_TIMER("Draw::World::Terrain");
 			gd->Draw(DrawPass::Normal);
 		}
+
+		// depth-buffer contains only terrain at this point
+		occlusionCuller.CaptureDepth();
+
 		{
 			SCOPED_TIMER("Draw::World::Decals");
 			groundDecals->Draw();
@@ -305,6 +322,7 @@ void CWorldDrawer::DrawOpaqueObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Opaque");
+		SCOPED_GL_TIMER("Draw::World::Models::Opaque");
 		unitDrawer->Draw();
 		featureDrawer->Draw();
 
@@ -321,6 +339,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GL_TIMER("Draw::World::Models::Alpha");
 		glEnable(GL_CLIP_DISTANCE0 + IWater::ClipPlaneIndex());
 
 		// draw alpha-objects below water surface (farthest)
@@ -333,6 +352,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 	// draw water (in-between)
 	if (globalRendering->drawWater && !mapRendering->voidWater) {
 		SCOPED_TIMER("Draw::World::Water");
+		SCOPED_GL_TIMER("Draw::World::Water");
 
 		water->UpdateWater(game);
 		water->Draw();
@@ -340,6 +360,7 @@ void CWorldDrawer::DrawAlphaObjects() const
 
 	{
 		SCOPED_TIMER("Draw::World::Models::Alpha");
+		SCOPED_GL_TIMER("Draw::World::Models::Alpha");
 		glEnable(GL_CLIP_DISTANCE0 + IWater::ClipPlaneIndex());
 
 		// draw alpha-objects above water surface (closest)
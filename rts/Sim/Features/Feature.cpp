@@ -143,6 +143,12 @@ bool CFeature::IsInLosForAllyTeam(int argAllyTeam) const
 
 
 void CFeature::Initialize(const FeatureLoadParams& params)
+{
+	InitializeState(params);
+	InitializeHandlers(false);
+}
+
+void CFeature::InitializeState(const FeatureLoadParams& params)
 {
 	const CSolidObject* po = params.parentObj;
 
@@ -224,12 +230,18 @@ void CFeature::Initialize(const FeatureLoadParams& params)
 
 	collisionVolume.InitDefault(float4(radius, height,  xsize * SQUARE_SIZE, zsize * SQUARE_SIZE));
 	selectionVolume.InitDefault(float4(radius, height,  xsize * SQUARE_SIZE, zsize * SQUARE_SIZE));
+}
 
-
+void CFeature::InitializeHandlers(bool bulkLoad)
+{
 	// feature does not have an assigned ID yet
 	// this MUST be done before the Block() call
 	featureHandler.AddFeature(this);
-	quadField.AddFeature(this);
+
+	// bulk-loaded features are inserted into the quadfield and sent to
+	// the drawers by the caller, all at once
+	if (!bulkLoad)
+		quadField.AddFeature(this);
 
 	ChangeTeam(team);
 	UpdateCollidableStateBit(CSolidObject::CSTATE_BIT_SOLIDOBJECTS, def->collidable);
@@ -238,6 +250,10 @@ void CFeature::Initialize(const FeatureLoadParams& params)
 	// allow Spring.SetFeatureBlocking to be called from gadget:FeatureCreated
 	// (callin sees the complete default state, but can change any part of it)
 	eventHandler.FeatureCreated(this);
+
+	if (bulkLoad)
+		return;
+
 	eventHandler.RenderFeatureCreated(this);
 }
 
@@ -594,6 +610,27 @@ bool CFeature::UpdatePosition()
 }
 
 
+bool CFeature::TerrainChangeWakes(int x1, int z1, int x2, int z2) const
+{
+	// footprint plus one corner of margin, the ground height at pos
+	// is interpolated from the corners of the surrounding square
+	const int fx1 = int(pos.x / SQUARE_SIZE) - (xsize >> 1) - 1;
+	const int fz1 = int(pos.z / SQUARE_SIZE) - (zsize >> 1) - 1;
+	const int fx2 = int(pos.x / SQUARE_SIZE) + (xsize >> 1) + 1;
+	const int fz2 = int(pos.z / SQUARE_SIZE) + (zsize >> 1) + 1;
+
+	if (fx2 < x1 || fx1 > x2 || fz2 < z1 || fz1 > z2)
+		return false;
+
+	// non-upright features align themselves with the terrain normal
+	if (!def->upright)
+		return true;
+
+	// an upright feature at rest is only moved if the ground under it did
+	return (CGround::GetHeightReal(pos.x, pos.z) != pos.y);
+}
+
+
 bool CFeature::Update()
 {
 	bool continueUpdating = UpdatePosition();
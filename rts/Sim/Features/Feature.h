@@ -71,6 +71,14 @@ public:
 	 * This will add this to the FeatureHandler.
 	 */
 	void Initialize(const FeatureLoadParams& params);
+	/**
+	 * The two halves of Initialize. InitializeState only touches this
+	 * feature (and reads the ground), so features whose models are
+	 * already loaded can run it concurrently; InitializeHandlers then
+	 * registers it with the FeatureHandler, blocking-map and events.
+	 */
+	void InitializeState(const FeatureLoadParams& params);
+	void InitializeHandlers(bool bulkLoad);
 
 	const SolidObjectDef* GetDef() const override { return ((const SolidObjectDef*) def); }
 
@@ -95,6 +103,9 @@ public:
 	void UpdateTransformAndPhysState();
 	void UpdateQuadFieldPosition(const float3& moveVec);
 
+	/// whether a terrain change over heightmap corners <x1,z1>-<x2,z2> can disturb this (resting) feature
+	bool TerrainChangeWakes(int x1, int z1, int x2, int z2) const;
+
 	void StartFire();
 	void EmitGeoSmoke();
 
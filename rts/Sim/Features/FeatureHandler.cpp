@@ -11,7 +11,9 @@
 #include "Sim/Units/CommandAI/BuilderCAI.h"
 #include "System/creg/STL_Set.h"
 #include "System/EventHandler.h"
+#include "System/MemoryStats.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 
 /******************************************************************************/
 
@@ -21,12 +23,14 @@ CR_REG_METADATA(CFeatureHandler, (
 	CR_MEMBER(deletedFeatureIDs),
 	CR_MEMBER(activeFeatureIDs),
 	CR_MEMBER(features),
-	CR_MEMBER(updateFeatures)
+	CR_MEMBER(updateFeatures),
+	CR_IGNORED(numTerrainWakeUps)
 ))
 
 /******************************************************************************/
 
 FeatureMemPool featureMemPool;
+static MemoryStats::Registrar featureMemPoolStats("Sim::Features::MemPool", []() { return MemoryStats::GetPoolUsage(featureMemPool); });
 
 CFeatureHandler featureHandler;
 
@@ -64,21 +68,31 @@ void CFeatureHandler::LoadFeaturesFromMap()
 		return;
 
 	std::vector<MapFeatureInfo> mfi;
+	std::vector<FeatureLoadParams> featureParams;
+	std::vector<CFeature*> mapFeatures;
+
 	mfi.resize(numFeatures);
 	readMap->GetFeatureInfo(&mfi[0]);
 
+	featureParams.reserve(numFeatures);
+	mapFeatures.reserve(numFeatures);
+
 	for (int a = 0; a < numFeatures; ++a) {
 		const FeatureDef* def = featureDefHandler->GetFeatureDef(readMap->GetFeatureTypeName(mfi[a].featureType), true);
 
 		if (def == nullptr)
 			continue;
 
-		FeatureLoadParams params = {
+		// models are loaded lazily through the (shared) def, do it here
+		if (def->drawType == DRAWTYPE_MODEL)
+			def->LoadModel();
+
+		featureParams.push_back({
 			nullptr,
 			nullptr,
 			def,
 
-			float3(mfi[a].pos.x, CGround::GetHeightReal(mfi[a].pos.x, mfi[a].pos.z), mfi[a].pos.z),
+			float3(mfi[a].pos.x, 0.0f, mfi[a].pos.z),
 			ZeroVector,
 
 			-1, // featureID
@@ -90,10 +104,49 @@ void CFeatureHandler::LoadFeaturesFromMap()
 
 			0, // wreckLevels
 			0, // smokeTime
-		};
+		});
 
-		LoadFeature(params);
+		// map features never request a specific ID, CanAddFeature(-1) is always true
+		mapFeatures.push_back(featureMemPool.alloc<CFeature>());
 	}
+
+	// construct feature state concurrently; defs whose model failed to load
+	// would retry it (not thread-safe) from InitializeState, leave those to
+	// the serial pass below
+	const auto CanInitConcurrently = [](const FeatureLoadParams& params) {
+		return (params.featureDef->drawType != DRAWTYPE_MODEL || params.featureDef->model != nullptr);
+	};
+
+	for_mt_range(0, featureParams.size(), 0, [&](const int lo, const int hi) {
+		for (int i = lo; i < hi; i++) {
+			FeatureLoadParams& params = featureParams[i];
+
+			if (!CanInitConcurrently(params))
+				continue;
+
+			params.pos.y = CGround::GetHeightReal(params.pos.x, params.pos.z);
+			mapFeatures[i]->InitializeState(params);
+		}
+	});
+
+	for (size_t i = 0; i < featureParams.size(); i++) {
+		FeatureLoadParams& params = featureParams[i];
+
+		if (CanInitConcurrently(params))
+			continue;
+
+		params.pos.y = CGround::GetHeightReal(params.pos.x, params.pos.z);
+		mapFeatures[i]->InitializeState(params);
+	}
+
+	// IDs, blocking and synced events stay serial and in map order
+	quadField.AddFeatures(mapFeatures);
+
+	for (CFeature* feature: mapFeatures) {
+		feature->InitializeHandlers(true);
+	}
+
+	eventHandler.RenderFeaturesCreated(mapFeatures);
 }
 
 
@@ -190,6 +243,14 @@ void CFeatureHandler::Update()
 
 		updateFeatures.erase(iter, updateFeatures.end());
 	}
+
+	// features at rest are not in updateFeatures; they are woken by
+	// SetVelocity (impulses), Lua move-control, fire and TerrainChanged
+	profiler.SetCounter("Sim::Features::Awake", GetNumAwakeFeatures());
+	profiler.SetCounter("Sim::Features::Sleeping", GetNumSleepingFeatures());
+	profiler.SetCounter("Sim::Features::TerrainWakeUps", numTerrainWakeUps);
+
+	numTerrainWakeUps = 0;
 }
 
 
@@ -247,8 +308,9 @@ void CFeatureHandler::SetFeatureUpdateable(CFeature* feature)
 		return;
 	}
 
-	// always true
-	feature->inUpdateQue = spring::VectorInsertUnique(updateFeatures, feature);
+	// inUpdateQue already guarantees uniqueness, skip the linear search
+	updateFeatures.push_back(feature);
+	feature->inUpdateQue = true;
 }
 
 
@@ -262,8 +324,18 @@ void CFeatureHandler::TerrainChanged(int x1, int y1, int x2, int y2)
 
 	for (const int qi: *qfQuery.quads) {
 		for (CFeature* f: quadField.GetQuad(qi).features) {
+			if (f->inUpdateQue)
+				continue;
+
+			// quads are much larger than a typical deformation; only wake
+			// features whose own footprint was touched and whose resting
+			// state the new terrain actually invalidates
+			if (!f->TerrainChangeWakes(x1, y1, x2, y2))
+				continue;
+
 			// put this feature back in the update-queue
 			SetFeatureUpdateable(f);
+			numTerrainWakeUps += 1;
 		}
 	}
 }
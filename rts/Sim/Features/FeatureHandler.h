@@ -3,6 +3,7 @@
 #ifndef _FEATURE_HANDLER_H
 #define _FEATURE_HANDLER_H
 
+#include <algorithm>
 #include <vector>
 
 #include "System/float3.h"
@@ -67,6 +68,9 @@ public:
 
 	const spring::unordered_set<int>& GetActiveFeatureIDs() const { return activeFeatureIDs; }
 
+	unsigned int GetNumAwakeFeatures() const { return (updateFeatures.size()); }
+	unsigned int GetNumSleepingFeatures() const { return (activeFeatureIDs.size() - std::min(activeFeatureIDs.size(), updateFeatures.size())); }
+
 private:
 	bool CanAddFeature(int id) const {
 		// do we want to be assigned a random ID and are any left in pool?
@@ -88,6 +92,9 @@ private:
 	std::vector<int> deletedFeatureIDs;
 	std::vector<CFeature*> features;
 	std::vector<CFeature*> updateFeatures;
+
+	// number of features woken by TerrainChanged since the last Update
+	unsigned int numTerrainWakeUps = 0;
 };
 
 extern CFeatureHandler featureHandler;
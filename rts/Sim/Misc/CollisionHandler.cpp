@@ -8,8 +8,15 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Objects/SolidObject.h"
 #include "System/Matrix44f.h"
+#include "System/SpringMath.h"
 #include "System/Log/ILog.h"
 
+#include <limits>
+
+#ifndef DEDICATED_NOSSE
+#include <xmmintrin.h>
+#endif
+
 unsigned int CCollisionHandler::numDiscTests = 0;
 unsigned int CCollisionHandler::numContTests = 0;
 
@@ -72,6 +79,88 @@ bool CCollisionHandler::DetectHit(
 
 
 
+void CCollisionHandler::IntersectBoundingSpheres(
+	const float3& p0,
+	const float3& dir,
+	const float length,
+	const CollisionSphereBatch& batch,
+	std::vector<float>& entryDists
+) {
+	// widen every sphere slightly, so rounding differences between this and
+	// the exact tests can never make the filter reject a legitimate hit
+	constexpr float radiusScale = 1.01f;
+	constexpr float radiusBias  = 1.0f;
+	constexpr float noHitDist   = std::numeric_limits<float>::infinity();
+
+	const size_t n = batch.Size();
+
+	entryDists.clear();
+	entryDists.resize(n, noHitDist);
+
+	size_t i = 0;
+
+	#ifndef DEDICATED_NOSSE
+	{
+		const __m128 px = _mm_set1_ps(p0.x);
+		const __m128 py = _mm_set1_ps(p0.y);
+		const __m128 pz = _mm_set1_ps(p0.z);
+		const __m128 dx = _mm_set1_ps(dir.x);
+		const __m128 dy = _mm_set1_ps(dir.y);
+		const __m128 dz = _mm_set1_ps(dir.z);
+		const __m128 rl = _mm_set1_ps(length);
+
+		const __m128 rsc = _mm_set1_ps(radiusScale);
+		const __m128 rbi = _mm_set1_ps(radiusBias);
+		const __m128 inf = _mm_set1_ps(noHitDist);
+		const __m128 zro = _mm_setzero_ps();
+
+		for (; (i + 4) <= n; i += 4) {
+			// m = center - p0
+			const __m128 mx = _mm_sub_ps(_mm_loadu_ps(&batch.xs[i]), px);
+			const __m128 my = _mm_sub_ps(_mm_loadu_ps(&batch.ys[i]), py);
+			const __m128 mz = _mm_sub_ps(_mm_loadu_ps(&batch.zs[i]), pz);
+			const __m128 rr = _mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&batch.rs[i]), rsc), rbi);
+
+			// tc = m.dot(dir), dSq = m.dot(m) - tc^2
+			const __m128 tc = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, dx), _mm_mul_ps(my, dy)), _mm_mul_ps(mz, dz));
+			const __m128 mm = _mm_add_ps(_mm_add_ps(_mm_mul_ps(mx, mx), _mm_mul_ps(my, my)), _mm_mul_ps(mz, mz));
+			const __m128 hs = _mm_sub_ps(_mm_mul_ps(rr, rr), _mm_sub_ps(mm, _mm_mul_ps(tc, tc)));
+			const __m128 hc = _mm_sqrt_ps(_mm_max_ps(hs, zro));
+
+			const __m128 t0 = _mm_max_ps(_mm_sub_ps(tc, hc), zro);
+			const __m128 t1 = _mm_add_ps(tc, hc);
+
+			// hit iff ray-line passes within rr, sphere is not behind p0, and is entered before p0 + dir * length
+			const __m128 hit = _mm_and_ps(_mm_and_ps(_mm_cmpge_ps(hs, zro), _mm_cmpge_ps(t1, zro)), _mm_cmple_ps(t0, rl));
+
+			_mm_storeu_ps(&entryDists[i], _mm_or_ps(_mm_and_ps(hit, t0), _mm_andnot_ps(hit, inf)));
+		}
+	}
+	#endif
+
+	for (; i < n; ++i) {
+		const float3 m = float3(batch.xs[i], batch.ys[i], batch.zs[i]) - p0;
+		const float rr = batch.rs[i] * radiusScale + radiusBias;
+
+		const float tc = m.dot(dir);
+		const float hs = rr * rr - (m.dot(m) - tc * tc);
+
+		if (hs < 0.0f)
+			continue;
+
+		const float hc = math::sqrt(hs);
+		const float t0 = std::max(tc - hc, 0.0f);
+		const float t1 = tc + hc;
+
+		if (t1 < 0.0f || t0 > length)
+			continue;
+
+		entryDists[i] = t0;
+	}
+}
+
+
+
 bool CCollisionHandler::Collision(
 	const CSolidObject* o,
 	const CollisionVolume* v,
@@ -8,6 +8,7 @@
 #include "System/Matrix44f.h"
 
 #include <algorithm>
+#include <vector>
 
 class CSolidObject;
 struct LocalModelPiece;
@@ -86,6 +87,34 @@ private:
 	const LocalModelPiece* lmp = nullptr;
 };
 
+/**
+ * Structure-of-arrays list of world-space bounding spheres, input for
+ * CCollisionHandler::IntersectBoundingSpheres
+ */
+struct CollisionSphereBatch {
+public:
+	void Clear() {
+		xs.clear();
+		ys.clear();
+		zs.clear();
+		rs.clear();
+	}
+	void Add(const float3& pos, float radius) {
+		xs.push_back(pos.x);
+		ys.push_back(pos.y);
+		zs.push_back(pos.z);
+		rs.push_back(radius);
+	}
+
+	size_t Size() const { return rs.size(); }
+
+public:
+	std::vector<float> xs;
+	std::vector<float> ys;
+	std::vector<float> zs;
+	std::vector<float> rs;
+};
+
 /**
  * Responsible for detecting hits between projectiles
  * and solid objects (units, features), each SO has a
@@ -121,6 +150,23 @@ class CCollisionHandler {
 			CollisionQuery* cq = nullptr
 		);
 
+		/**
+		 * Batched broadphase for tracing one ray against many objects.
+		 * Computes for each sphere in <batch> the distance along the ray
+		 * (p0 + dir * t, dir normalized, 0 <= t <= length) at which it is
+		 * entered, or +inf if the segment misses it; four spheres at once
+		 * using SSE. The result is conservative: if entryDists[i] is not
+		 * less than some distance, no DetectHit against the object inside
+		 * sphere i can return a hit nearer than that distance.
+		 */
+		static void IntersectBoundingSpheres(
+			const float3& p0,
+			const float3& dir,
+			const float length,
+			const CollisionSphereBatch& batch,
+			std::vector<float>& entryDists
+		);
+
 	private:
 		// HITTEST_DISC helpers for DetectHit
 		static bool Collision(
@@ -0,0 +1,142 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DrawSnapshot.h"
+#include "Sim/Projectiles/Projectile.h"
+#include "Sim/Projectiles/ProjectileHandler.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitHandler.h"
+#include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+
+
+CDrawSnapshot drawSnapshot;
+
+
+void CDrawSnapshot::Kill()
+{
+	std::lock_guard<spring::spinlock> lock(mutex);
+
+	for (Buffer& buffer: buffers) {
+		buffer.units.clear();
+		buffer.projectiles[0].clear();
+		buffer.projectiles[1].clear();
+		buffer.stamp = 0;
+	}
+
+	numPublished = 0;
+
+	frontIdx = 0;
+	readIdx = -1;
+}
+
+
+void CDrawSnapshot::Publish()
+{
+	SCOPED_TIMER("Sim::DrawSnapshot");
+
+	int backIdx = -1;
+
+	{
+		std::lock_guard<spring::spinlock> lock(mutex);
+
+		// any buffer neither published last nor held by the renderer
+		for (backIdx = 0; backIdx == frontIdx || backIdx == readIdx; backIdx++);
+	}
+
+	// stamps tell current entries from those of objects that have since died
+	Buffer& buffer = buffers[backIdx];
+	const unsigned int stamp = ++numPublished;
+
+	{
+		const std::vector<CUnit*>& units = unitHandler.GetActiveUnits();
+
+		buffer.units.resize(unitHandler.MaxUnits());
+
+		for_mt(0, units.size(), [&](const int i) {
+			const CUnit* unit = units[i];
+			UnitState& state = buffer.units[unit->id];
+
+			state.unit = unit;
+			state.stamp = stamp;
+			state.preFramePos = unit->preFramePos;
+			state.pos = unit->pos;
+			state.frontdir = unit->frontdir;
+			state.updir = unit->updir;
+			state.rightdir = unit->rightdir;
+		});
+	}
+
+	for (int synced = 0; synced < 2; synced++) {
+		const ProjectileContainer& projectiles = projectileHandler.projectileContainers[synced];
+		std::vector<ProjectileState>& states = buffer.projectiles[synced];
+
+		int maxID = -1;
+
+		for (const CProjectile* p: projectiles) {
+			maxID = std::max(maxID, p->id);
+		}
+
+		states.resize(std::max(states.size(), size_t(maxID + 1)));
+
+		for_mt(0, projectiles.size(), [&](const int i) {
+			const CProjectile* p = projectiles[i];
+			ProjectileState& state = states[p->id];
+
+			state.projectile = p;
+			state.stamp = stamp;
+			state.pos = p->pos;
+			state.speed = p->speed;
+		});
+	}
+
+	std::lock_guard<spring::spinlock> lock(mutex);
+
+	buffer.stamp = stamp;
+	frontIdx = backIdx;
+}
+
+
+void CDrawSnapshot::Acquire()
+{
+	std::lock_guard<spring::spinlock> lock(mutex);
+	readIdx = frontIdx;
+}
+
+
+const CDrawSnapshot::UnitState* CDrawSnapshot::GetState(const CUnit* unit) const
+{
+	if (readIdx == -1)
+		return nullptr;
+
+	const Buffer& buffer = buffers[readIdx];
+
+	if (unit->id < 0 || size_t(unit->id) >= buffer.units.size())
+		return nullptr;
+
+	const UnitState& state = buffer.units[unit->id];
+
+	if (state.unit != unit || state.stamp != buffer.stamp)
+		return nullptr;
+
+	return &state;
+}
+
+const CDrawSnapshot::ProjectileState* CDrawSnapshot::GetState(const CProjectile* projectile) const
+{
+	if (readIdx == -1)
+		return nullptr;
+
+	const std::vector<ProjectileState>& states = buffers[readIdx].projectiles[projectile->synced];
+
+	if (projectile->id < 0 || size_t(projectile->id) >= states.size())
+		return nullptr;
+
+	const ProjectileState& state = states[projectile->id];
+
+	if (state.projectile != projectile || state.stamp != buffers[readIdx].stamp)
+		return nullptr;
+
+	return &state;
+}
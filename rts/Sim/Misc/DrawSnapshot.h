@@ -0,0 +1,89 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DRAW_SNAPSHOT_H
+#define DRAW_SNAPSHOT_H
+
+#include <array>
+#include <vector>
+
+#include "System/float3.h"
+#include "System/Matrix44f.h"
+#include "System/Threading/SpringThreading.h"
+
+class CUnit;
+class CProjectile;
+
+/**
+ * @brief Hand-off of the per-frame state of units and projectiles from the sim to the renderer
+ * The sim publishes a compact copy of every active unit's last two positions and
+ * orientation and of every projectile's position and speed at the end of each
+ * sim-frame, and renderers interpolate from the newest published copy rather
+ * than from the live objects, so drawing no longer depends on the sim not
+ * running at the same time and touches a few dense arrays instead of scattered
+ * objects. The buffers rotate between front (newest published), read (held by
+ * the renderer for the drawn frame) and back (being written), so neither side
+ * ever waits.
+ */
+class CDrawSnapshot {
+public:
+	struct UnitState {
+		const CUnit* unit = nullptr;
+		unsigned int stamp = 0;
+
+		float3 preFramePos;
+		float3 pos;
+
+		float3 frontdir;
+		float3 updir;
+		float3 rightdir;
+
+		float3 GetDrawDeltaPos(float dt) const { return ((pos - preFramePos) * dt); }
+		CMatrix44f ComposeMatrix(const float3& p) const { return (CMatrix44f(p, -rightdir, updir, frontdir)); }
+	};
+
+	struct ProjectileState {
+		const CProjectile* projectile = nullptr;
+		unsigned int stamp = 0;
+
+		float3 pos;
+		float3 speed;
+
+		float3 GetDrawPos(float t) const { return (pos + speed * t); }
+	};
+
+	void Kill();
+
+	/// sim side, called at the end of every sim-frame
+	void Publish();
+
+	/// render side, selects the newest snapshot for the drawn frame
+	void Acquire();
+
+	/// @return nullptr if the object was not part of the acquired snapshot (e.g. created since)
+	const UnitState* GetState(const CUnit* unit) const;
+	const ProjectileState* GetState(const CProjectile* projectile) const;
+
+private:
+	struct Buffer {
+		std::vector<UnitState> units;
+		// [0] unsynced, [1] synced; indexed by projectile ID
+		std::vector<ProjectileState> projectiles[2];
+
+		unsigned int stamp = 0;
+	};
+
+	static constexpr int NUM_BUFFERS = 3;
+
+	std::array<Buffer, NUM_BUFFERS> buffers;
+
+	unsigned int numPublished = 0;
+
+	int frontIdx = 0;
+	int readIdx = -1;
+
+	spring::spinlock mutex;
+};
+
+extern CDrawSnapshot drawSnapshot;
+
+#endif // DRAW_SNAPSHOT_H
@@ -22,7 +22,12 @@ CR_BIND(CGroundBlockingObjectMap, )
 CR_REG_METADATA(CGroundBlockingObjectMap, (
 	CR_MEMBER(arrCells),
 	CR_MEMBER(vecCells),
-	CR_MEMBER(vecIndcs)
+	CR_MEMBER(vecIndcs),
+	CR_MEMBER(tileBlockers),
+	CR_IGNORED(numTilesX),
+	CR_IGNORED(numTilesZ),
+	CR_IGNORED(mapSizeX),
+	CR_IGNORED(mapSizeZ)
 ))
 
 
@@ -46,7 +51,7 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object)
 
 	for (int zSqr = zminSqr; zSqr < zmaxSqr; zSqr++) {
 		for (int xSqr = xminSqr; xSqr < xmaxSqr; xSqr++) {
-			CellInsertUnique(zSqr * mapDims.mapx + xSqr, object);
+			CellInsertUnique(xSqr, zSqr, object);
 		}
 	}
 
@@ -74,7 +79,7 @@ void CGroundBlockingObjectMap::AddGroundBlockingObject(CSolidObject* object, con
 			if ((object->GetGroundBlockingMaskAtPos({x * SQUARE_SIZE * 1.0f, 0.0f, z * SQUARE_SIZE * 1.0f}) & mask) == 0)
 				continue;
 
-			CellInsertUnique(z * mapDims.mapx + x, object);
+			CellInsertUnique(x, z, object);
 		}
 	}
 
@@ -97,7 +102,7 @@ void CGroundBlockingObjectMap::RemoveGroundBlockingObject(CSolidObject* object)
 
 	for (int z = bz; z < bz + sz; ++z) {
 		for (int x = bx; x < bx + sx; ++x) {
-			CellErase(z * mapDims.mapx + x, object);
+			CellErase(x, z, object);
 		}
 	}
 
@@ -114,7 +119,7 @@ CSolidObject* CGroundBlockingObjectMap::GroundBlocked(int x, int z) const {
 	if (static_cast<unsigned int>(x) >= mapDims.mapx || static_cast<unsigned int>(z) >= mapDims.mapy)
 		return nullptr;
 
-	return (GroundBlockedUnsafe(x + z * mapDims.mapx));
+	return (GroundBlockedUnsafe(x, z));
 }
 
 
@@ -130,7 +135,7 @@ bool CGroundBlockingObjectMap::GroundBlocked(int x, int z, const CSolidObject* i
 	if (static_cast<unsigned int>(x) >= mapDims.mapx || static_cast<unsigned int>(z) >= mapDims.mapy)
 		return false;
 
-	const BlockingMapCell& cell = GetCellUnsafeConst(z * mapDims.mapx + x);
+	const BlockingMapCell& cell = GetCellUnsafeConst(x, z);
 
 	if (cell.empty())
 		return false;
@@ -159,7 +164,7 @@ CGroundBlockingObjectMap::BlockingMapCell CGroundBlockingObjectMap::GetCellUnsaf
 {
 	const int xSqr = static_cast<unsigned>(pos.x / SQUARE_SIZE);
 	const int zSqr = static_cast<unsigned>(pos.z / SQUARE_SIZE);
-	return (GetCellUnsafeConst(zSqr * mapDims.mapx + xSqr));
+	return (GetCellUnsafeConst(xSqr, zSqr));
 }
 
 
@@ -211,12 +216,31 @@ bool CGroundBlockingObjectMap::CheckYard(const CSolidObject* yardUnit, const Yar
 }
 
 
+bool CGroundBlockingObjectMap::RangeIsEmpty(int xmin, int xmax, int zmin, int zmax) const
+{
+	const int txmin = std::max(xmin, 0) / TILE_SIZE;
+	const int tzmin = std::max(zmin, 0) / TILE_SIZE;
+	const int txmax = std::min(xmax, int(mapSizeX) - 1) / TILE_SIZE;
+	const int tzmax = std::min(zmax, int(mapSizeZ) - 1) / TILE_SIZE;
+
+	for (int tz = tzmin; tz <= tzmax; tz++) {
+		for (int tx = txmin; tx <= txmax; tx++) {
+			if (GetTileBlockerMask(tx, tz) != 0)
+				return false;
+		}
+	}
+
+	return true;
+}
+
+
 unsigned int CGroundBlockingObjectMap::CalcChecksum() const
 {
 	unsigned int checksum = 666;
 
-	for (unsigned int i = 0; i < arrCells.size(); ++i) {
-		if (!arrCells[i].Empty())
+	// hash the (row-major) indices of occupied squares, independent of the tiling
+	for (unsigned int i = 0, n = mapSizeX * mapSizeZ; i < n; ++i) {
+		if (!arrCells[SquareToCell(i)].Empty())
 			checksum = HsiehHash(&i, sizeof(i), checksum);
 	}
 
@@ -225,14 +249,20 @@ unsigned int CGroundBlockingObjectMap::CalcChecksum() const
 
 
 
-bool CGroundBlockingObjectMap::CellInsertUnique(unsigned int sqr, CSolidObject* o) {
+bool CGroundBlockingObjectMap::CellInsertUnique(int x, int z, CSolidObject* o) {
+	const unsigned int sqr = XZToCell(x, z);
+
 	ArrCell& ac = GetArrCell(sqr);
 	VecCell* vc = nullptr;
 
+	uint32_t& tileCount = tileBlockers[(sqr / TILE_CELLS) * TILE_BLOCKER_TYPES + (o->immobile? TILE_BLOCKER_IMMOBILE: TILE_BLOCKER_MOBILE)];
+
 	if (ac.Contains(o))
 		return false;
-	if (ac.Insert(o))
+	if (ac.Insert(o)) {
+		tileCount += 1;
 		return true;
+	}
 
 	// array-cell is full, spill over
 	if ((vc = &GetVecCell(sqr)) == &vecCells[0]) {
@@ -246,14 +276,25 @@ bool CGroundBlockingObjectMap::CellInsertUnique(unsigned int sqr, CSolidObject*
 		}
 	}
 
-	return (spring::VectorInsertUnique(*vc, o, true));
+	if (!spring::VectorInsertUnique(*vc, o, true))
+		return false;
+
+	tileCount += 1;
+	return true;
 }
 
-bool CGroundBlockingObjectMap::CellErase(unsigned int sqr, CSolidObject* o) {
+bool CGroundBlockingObjectMap::CellErase(int x, int z, CSolidObject* o) {
+	const unsigned int sqr = XZToCell(x, z);
+
 	ArrCell& ac = GetArrCell(sqr);
 	VecCell* vc = nullptr;
 
+	uint32_t& tileCount = tileBlockers[(sqr / TILE_CELLS) * TILE_BLOCKER_TYPES + (o->immobile? TILE_BLOCKER_IMMOBILE: TILE_BLOCKER_MOBILE)];
+
 	if (ac.Erase(o)) {
+		assert(tileCount > 0);
+		tileCount -= 1;
+
 		if (ac.GetVecIndx() == 0)
 			return true;
 
@@ -276,6 +317,9 @@ bool CGroundBlockingObjectMap::CellErase(unsigned int sqr, CSolidObject* o) {
 	if (!spring::VectorErase(*(vc = &GetVecCell(sqr)), o))
 		return false;
 
+	assert(tileCount > 0);
+	tileCount -= 1;
+
 CommonExit:
 
 	if (vc->empty()) {
@@ -3,6 +3,7 @@
 #ifndef GROUNDBLOCKINGOBJECTMAP_H
 #define GROUNDBLOCKINGOBJECTMAP_H
 
+#include <algorithm>
 #include <array>
 #include <vector>
 
@@ -97,8 +98,27 @@ public:
 	};
 
 
-	void Init(unsigned int numSquares) {
-		arrCells.resize(numSquares);
+	// cells are stored in TILE_SIZE*TILE_SIZE tiles (row-major within
+	// each tile, tiles themselves row-major) so footprint and area scans
+	// touch a few contiguous runs of memory instead of one run per map
+	// row; each tile also keeps per-type blocker counts for early-outs
+	static constexpr int TILE_SIZE = 8;
+	static constexpr int TILE_CELLS = TILE_SIZE * TILE_SIZE;
+
+	enum TileBlockerType {
+		TILE_BLOCKER_IMMOBILE = 0,
+		TILE_BLOCKER_MOBILE   = 1,
+		TILE_BLOCKER_TYPES    = 2,
+	};
+
+	void Init(int mapx, int mapy) {
+		numTilesX = (mapx + TILE_SIZE - 1) / TILE_SIZE;
+		numTilesZ = (mapy + TILE_SIZE - 1) / TILE_SIZE;
+		mapSizeX = mapx;
+		mapSizeZ = mapy;
+
+		arrCells.resize(numTilesX * numTilesZ * TILE_CELLS);
+		tileBlockers.resize(numTilesX * numTilesZ * TILE_BLOCKER_TYPES, 0);
 		vecCells.reserve(32);
 		vecIndcs.reserve(32);
 
@@ -117,6 +137,7 @@ public:
 		}
 
 		vecIndcs.clear();
+		std::fill(tileBlockers.begin(), tileBlockers.end(), 0);
 	}
 
 	unsigned int CalcChecksum() const;
@@ -137,8 +158,9 @@ public:
 	CSolidObject* GroundBlocked(const float3& pos) const;
 
 	// same as GroundBlocked(), but does not bounds-check mapSquare
-	CSolidObject* GroundBlockedUnsafe(unsigned int mapSquare) const {
-		const BlockingMapCell& cell = GetCellUnsafeConst(mapSquare);
+	CSolidObject* GroundBlockedUnsafe(unsigned int mapSquare) const { return (GroundBlockedUnsafe(mapSquare % mapSizeX, mapSquare / mapSizeX)); }
+	CSolidObject* GroundBlockedUnsafe(int x, int z) const {
+		const BlockingMapCell& cell = GetCellUnsafeConst(x, z);
 
 		if (cell.empty())
 			return nullptr;
@@ -151,41 +173,67 @@ public:
 	bool GroundBlocked(const float3& pos, const CSolidObject* ignoreObj) const;
 
 	bool ObjectInCell(unsigned int mapSquare, const CSolidObject* obj) const {
-		if (mapSquare >= arrCells.size())
+		if (mapSquare >= (mapSizeX * mapSizeZ))
 			return false;
 
-		const ArrCell& ac = GetArrCell(mapSquare);
+		const unsigned int cellIdx = SquareToCell(mapSquare);
+
+		const ArrCell& ac = GetArrCell(cellIdx);
 		const VecCell* vc = nullptr;
 
 		if (ac.Contains(obj))
 			return true;
 
-		return (((vc = &GetVecCell(mapSquare)) != &vecCells[0]) && (std::find(vc->begin(), vc->end(), obj) != vc->end()));
+		return (((vc = &GetVecCell(cellIdx)) != &vecCells[0]) && (std::find(vc->begin(), vc->end(), obj) != vc->end()));
 	}
 
 
 	BlockingMapCell GetCellUnsafeConst(const float3& pos) const;
-	BlockingMapCell GetCellUnsafeConst(unsigned int mapSquare) const {
-		assert(mapSquare < arrCells.size());
+	BlockingMapCell GetCellUnsafeConst(unsigned int mapSquare) const { return (GetCellUnsafeConst(mapSquare % mapSizeX, mapSquare / mapSizeX)); }
+	BlockingMapCell GetCellUnsafeConst(int x, int z) const {
+		assert(XZToCell(x, z) < arrCells.size());
 		// avoid vec-cell lookup unless needed
-		return {GetArrCell(mapSquare), vecCells.data()};
+		return {GetArrCell(XZToCell(x, z)), vecCells.data()};
 	}
 
+	/// bit <t> is set iff tile <tx, tz> contains at least one blocker of TileBlockerType <t>
+	unsigned int GetTileBlockerMask(int tx, int tz) const {
+		const uint32_t* counts = &tileBlockers[(tz * numTilesX + tx) * TILE_BLOCKER_TYPES];
+		return ((counts[TILE_BLOCKER_IMMOBILE] != 0) << TILE_BLOCKER_IMMOBILE) | ((counts[TILE_BLOCKER_MOBILE] != 0) << TILE_BLOCKER_MOBILE);
+	}
+	/// true iff no tile overlapping the (inclusive) square-range contains any blocker
+	bool RangeIsEmpty(int xmin, int xmax, int zmin, int zmax) const;
+
 private:
 	bool CheckYard(const CSolidObject* yardUnit, const YardMapStatus& mask) const;
 
-	const ArrCell& GetArrCell(unsigned int mapSquare) const { return           arrCells[mapSquare]               ; }
-	      ArrCell& GetArrCell(unsigned int mapSquare)       { return           arrCells[mapSquare]               ; }
-	const VecCell& GetVecCell(unsigned int mapSquare) const { return vecCells[ arrCells[mapSquare].GetVecIndx() ]; }
-	      VecCell& GetVecCell(unsigned int mapSquare)       { return vecCells[ arrCells[mapSquare].GetVecIndx() ]; }
+	unsigned int XZToCell(unsigned int x, unsigned int z) const {
+		const unsigned int tileIdx = (z / TILE_SIZE) * numTilesX + (x / TILE_SIZE);
+		const unsigned int cellIdx = (z % TILE_SIZE) * TILE_SIZE + (x % TILE_SIZE);
+		return (tileIdx * TILE_CELLS + cellIdx);
+	}
+	unsigned int SquareToCell(unsigned int mapSquare) const { return (XZToCell(mapSquare % mapSizeX, mapSquare / mapSizeX)); }
+
+	const ArrCell& GetArrCell(unsigned int cellIdx) const { return           arrCells[cellIdx]               ; }
+	      ArrCell& GetArrCell(unsigned int cellIdx)       { return           arrCells[cellIdx]               ; }
+	const VecCell& GetVecCell(unsigned int cellIdx) const { return vecCells[ arrCells[cellIdx].GetVecIndx() ]; }
+	      VecCell& GetVecCell(unsigned int cellIdx)       { return vecCells[ arrCells[cellIdx].GetVecIndx() ]; }
 
-	bool CellInsertUnique(unsigned int sqr, CSolidObject* o);
-	bool CellErase(unsigned int sqr, CSolidObject* o);
+	bool CellInsertUnique(int x, int z, CSolidObject* o);
+	bool CellErase(int x, int z, CSolidObject* o);
 
 private:
 	std::vector<ArrCell> arrCells;
 	std::vector<VecCell> vecCells;
 	std::vector<uint32_t> vecIndcs;
+
+	// TILE_BLOCKER_TYPES object-counts per tile
+	std::vector<uint32_t> tileBlockers;
+
+	unsigned int numTilesX = 0;
+	unsigned int numTilesZ = 0;
+	unsigned int mapSizeX = 1;
+	unsigned int mapSizeZ = 0;
 };
 
 extern CGroundBlockingObjectMap groundBlockingObjectMap;
@@ -2,6 +2,7 @@
 
 #include <limits>
 #include <algorithm>
+#include <cmath>
 
 #include "InterceptHandler.h"
 
@@ -21,9 +22,24 @@
 CR_BIND_DERIVED(CInterceptHandler, CObject, )
 CR_REG_METADATA(CInterceptHandler, (
 	CR_MEMBER(interceptors),
-	CR_MEMBER(interceptables)
+	CR_MEMBER(interceptables),
+
+	CR_IGNORED(coverageCells),
+	CR_IGNORED(candidateInterceptors),
+	CR_IGNORED(interceptorVisits),
+
+	CR_IGNORED(gridMins),
+	CR_IGNORED(gridMaxs),
+	CR_IGNORED(gridSize),
+	CR_IGNORED(cellSize),
+
+	CR_IGNORED(gridFrame),
+	CR_IGNORED(visitNum)
 ))
 
+static constexpr int MAX_COVERAGE_GRID_SIZE = 64;
+static constexpr float MIN_COVERAGE_CELL_SIZE = 256.0f;
+
 CInterceptHandler interceptHandler;
 
 
@@ -32,13 +48,24 @@ void CInterceptHandler::Update(bool forced) {
 	if (((gs->frameNum % UNIT_SLOWUPDATE_RATE) != 0) && !forced)
 		return;
 
-	for (CWeapon* w: interceptors) {
-		const WeaponDef* wDef = w->weaponDef;
-		const CUnit* wOwner = w->owner;
+	if (interceptors.empty())
+		return;
+
+	UpdateCoverageGrid();
+
+	// projectiles are visited in order and every interceptor still gets its
+	// incoming projectiles in that order, as with the interceptor-major loop
+	for (CWeaponProjectile* p: interceptables) {
+		GetCandidateInterceptors(p);
+
+		for (const int wi: candidateInterceptors) {
+			CWeapon* w = interceptors[wi];
 
-		assert(wDef->interceptor || wDef->isShield);
+			const WeaponDef* wDef = w->weaponDef;
+			const CUnit* wOwner = w->owner;
+
+			assert(wDef->interceptor || wDef->isShield);
 
-		for (CWeaponProjectile* p: interceptables) {
 			if (!p->CanBeInterceptedBy(wDef))
 				continue;
 			if (w->HasIncomingProjectile(p->id))
@@ -115,10 +142,157 @@ void CInterceptHandler::Update(bool forced) {
 }
 
 
+void CInterceptHandler::UpdateCoverageGrid()
+{
+	if (gridFrame == gs->frameNum)
+		return;
+
+	gridFrame = gs->frameNum;
+
+	gridMins = { std::numeric_limits<float>::max(),  std::numeric_limits<float>::max()};
+	gridMaxs = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+
+	for (const CWeapon* w: interceptors) {
+		const float r = w->weaponDef->coverageRange;
+
+		gridMins.x = std::min(gridMins.x, w->aimFromPos.x - r);
+		gridMins.y = std::min(gridMins.y, w->aimFromPos.z - r);
+		gridMaxs.x = std::max(gridMaxs.x, w->aimFromPos.x + r);
+		gridMaxs.y = std::max(gridMaxs.y, w->aimFromPos.z + r);
+	}
+
+	cellSize = std::max(MIN_COVERAGE_CELL_SIZE, std::max(gridMaxs.x - gridMins.x, gridMaxs.y - gridMins.y) / MAX_COVERAGE_GRID_SIZE);
+	gridSize.x = Clamp(int((gridMaxs.x - gridMins.x) / cellSize) + 1, 1, MAX_COVERAGE_GRID_SIZE);
+	gridSize.y = Clamp(int((gridMaxs.y - gridMins.y) / cellSize) + 1, 1, MAX_COVERAGE_GRID_SIZE);
+
+	for (auto& cell: coverageCells) {
+		cell.clear();
+	}
+
+	coverageCells.resize(gridSize.x * gridSize.y);
+	interceptorVisits.clear();
+	interceptorVisits.resize(interceptors.size(), 0);
+
+	visitNum = 0;
+
+	for (size_t wi = 0; wi < interceptors.size(); wi++) {
+		const CWeapon* w = interceptors[wi];
+		const float r = w->weaponDef->coverageRange;
+
+		const int x1 = Clamp(int((w->aimFromPos.x - r - gridMins.x) / cellSize), 0, gridSize.x - 1);
+		const int z1 = Clamp(int((w->aimFromPos.z - r - gridMins.y) / cellSize), 0, gridSize.y - 1);
+		const int x2 = Clamp(int((w->aimFromPos.x + r - gridMins.x) / cellSize), 0, gridSize.x - 1);
+		const int z2 = Clamp(int((w->aimFromPos.z + r - gridMins.y) / cellSize), 0, gridSize.y - 1);
+
+		for (int z = z1; z <= z2; z++) {
+			for (int x = x1; x <= x2; x++) {
+				coverageCells[z * gridSize.x + x].push_back(wi);
+			}
+		}
+	}
+}
+
+void CInterceptHandler::AddCellInterceptors(int x, int z)
+{
+	if (x < 0 || x >= gridSize.x || z < 0 || z >= gridSize.y)
+		return;
+
+	for (const int wi: coverageCells[z * gridSize.x + x]) {
+		if (interceptorVisits[wi] == visitNum)
+			continue;
+
+		interceptorVisits[wi] = visitNum;
+		candidateInterceptors.push_back(wi);
+	}
+}
+
+void CInterceptHandler::GetCandidateInterceptors(const CWeaponProjectile* p)
+{
+	// every interception case in Update needs a point whose (XZ) distance to
+	// the interceptor is below its coverage range: the target position, or a
+	// point on p's trajectory ray (current, impact and closest-approach, the
+	// latter two at least one unit behind p->pos); the interceptor's circle
+	// overlaps the cell containing that point
+	candidateInterceptors.clear();
+	visitNum += 1;
+
+	const float3& tgtPos = p->GetTargetPos();
+
+	AddCellInterceptors(int(std::floor((tgtPos.x - gridMins.x) / cellSize)), int(std::floor((tgtPos.z - gridMins.y) / cellSize)));
+
+	// walk the cells crossed by the XZ-projection of the ray, clipped to the grid
+	const float2 rayPos = {p->pos.x - p->dir.x, p->pos.z - p->dir.z};
+	const float2 rayDir = {p->dir.x, p->dir.z};
+
+	float tmin = 0.0f;
+	float tmax = std::numeric_limits<float>::max();
+
+	for (int i = 0; i < 2; i++) {
+		const float o = (i == 0)? rayPos.x: rayPos.y;
+		const float d = (i == 0)? rayDir.x: rayDir.y;
+		const float lo = (i == 0)? gridMins.x: gridMins.y;
+		const float hi = (i == 0)? gridMaxs.x: gridMaxs.y;
+
+		if (d == 0.0f) {
+			if (o < lo || o > hi)
+				tmax = -1.0f;
+
+			continue;
+		}
+
+		const float t1 = (lo - o) / d;
+		const float t2 = (hi - o) / d;
+
+		tmin = std::max(tmin, std::min(t1, t2));
+		tmax = std::min(tmax, std::max(t1, t2));
+	}
+
+	if (tmin <= tmax) {
+		const float2 entryPos = {rayPos.x + rayDir.x * tmin, rayPos.y + rayDir.y * tmin};
+
+		int x = Clamp(int((entryPos.x - gridMins.x) / cellSize), 0, gridSize.x - 1);
+		int z = Clamp(int((entryPos.y - gridMins.y) / cellSize), 0, gridSize.y - 1);
+
+		const int stepX = (rayDir.x > 0.0f)? 1: -1;
+		const int stepZ = (rayDir.y > 0.0f)? 1: -1;
+
+		// ray parameters of the next cell-boundary crossings
+		const float inf = std::numeric_limits<float>::max();
+		const float nextBoundX = gridMins.x + (x + (stepX > 0)) * cellSize;
+		const float nextBoundZ = gridMins.y + (z + (stepZ > 0)) * cellSize;
+
+		float tx = (rayDir.x != 0.0f)? ((nextBoundX - rayPos.x) / rayDir.x): inf;
+		float tz = (rayDir.y != 0.0f)? ((nextBoundZ - rayPos.y) / rayDir.y): inf;
+
+		const float dtx = (rayDir.x != 0.0f)? (cellSize / std::fabs(rayDir.x)): inf;
+		const float dtz = (rayDir.y != 0.0f)? (cellSize / std::fabs(rayDir.y)): inf;
+
+		while (x >= 0 && x < gridSize.x && z >= 0 && z < gridSize.y) {
+			AddCellInterceptors(x, z);
+
+			if (tx < tz) {
+				x += stepX;
+				tx += dtx;
+			} else {
+				if (tz == inf)
+					break;
+
+				z += stepZ;
+				tz += dtz;
+			}
+		}
+	}
+
+	// keep the interceptor order of the exhaustive loop
+	std::sort(candidateInterceptors.begin(), candidateInterceptors.end());
+}
+
+
 
 void CInterceptHandler::AddInterceptorWeapon(CWeapon* weapon)
 {
 	interceptors.push_back(weapon);
+	gridFrame = -1;
 }
 
 
@@ -127,6 +301,7 @@ void CInterceptHandler::RemoveInterceptorWeapon(CWeapon* weapon)
 	auto it = std::find(interceptors.begin(), interceptors.end(), weapon);
 	if (it != interceptors.end()) {
 		interceptors.erase(it);
+		gridFrame = -1;
 	}
 }
 
@@ -4,8 +4,11 @@
 #define INTERCEPT_HANDLER_H
 
 #include <deque>
+#include <vector>
+
 #include "System/Misc/NonCopyable.h"
 #include "System/Object.h"
+#include "System/type2.h"
 
 class CWeapon;
 class CWeaponProjectile;
@@ -26,9 +29,30 @@ public:
 
 	void DependentDied(CObject* o) override;
 
+private:
+	void UpdateCoverageGrid();
+	void GetCandidateInterceptors(const CWeaponProjectile* p);
+
+	void AddCellInterceptors(int x, int z);
+
 private:
 	std::deque<CWeapon*> interceptors;
 	std::deque<CWeaponProjectile*> interceptables;
+
+	// coarse grid over the union of the interceptors' coverage circles;
+	// each cell lists the (indices of) interceptors whose circle overlaps
+	// it, rebuilt at most once per frame since interceptors can move
+	std::vector< std::vector<int> > coverageCells;
+	std::vector<int> candidateInterceptors;
+	std::vector<int> interceptorVisits;
+
+	float2 gridMins;
+	float2 gridMaxs;
+	int2 gridSize;
+	float cellSize = 0.0f;
+
+	int gridFrame = -1;
+	int visitNum = 0;
 };
 
 extern CInterceptHandler interceptHandler;
@@ -12,10 +12,15 @@
 #include "System/Sync/HsiehHash.h"
 #include "System/creg/STL_Deque.h"
 #include "System/EventHandler.h"
+#include "System/MemoryStats.h"
 #include "System/SafeUtil.h"
 #include "System/TimeProfiler.h"
 #include "System/Threading/ThreadPool.h"
 
+#include <algorithm>
+#include <limits>
+#include <tuple>
+
 #define USE_STAGGERED_UPDATES 0
 
 
@@ -41,7 +46,9 @@ CR_REG_METADATA(CLosHandler,(
 	CR_MEMBER(baseRadarErrorSize),
 	CR_MEMBER(baseRadarErrorMult),
 	CR_MEMBER(radarErrorSizes),
-	CR_IGNORED(losTypes)
+	CR_IGNORED(losTypes),
+	CR_IGNORED(unitLosEpoch),
+	CR_IGNORED(forcedUnitLosEpoch)
 ))
 
 
@@ -94,9 +101,42 @@ void ILosType::Init(const int mipLevel_, LosType type_)
 	const float* ctrHeightMap = readMap->GetCenterHeightMapSynced();
 	const float* mipHeightMap = readMap->GetMIPHeightMapSynced(mipLevel_);
 
+	squareEpochs.clear();
+	squareEpochs.resize(size.x * size.y, -1);
+
 	for (CLosMap& losMap: losMaps) {
-		losMap.Init(size, int2(mapDims.mapx, mapDims.mapy), ctrHeightMap, mipHeightMap, type == LOS_TYPE_LOS);
+		losMap.Init(size, int2(mapDims.mapx, mapDims.mapy), ctrHeightMap, mipHeightMap, squareEpochs.data(), type == LOS_TYPE_LOS);
 	}
+
+	footprintHits = 0;
+	footprintFails = 0;
+
+	if (algoType != LOS_ALGO_RAYCAST)
+		return;
+
+	footprintBlocks.x = (size.x + FOOTPRINT_BLOCK_SIZE - 1) / FOOTPRINT_BLOCK_SIZE;
+	footprintBlocks.y = (size.y + FOOTPRINT_BLOCK_SIZE - 1) / FOOTPRINT_BLOCK_SIZE;
+	footprintRevisions.clear();
+	footprintRevisions.resize(footprintBlocks.x * footprintBlocks.y, 0);
+}
+
+size_t ILosType::GetMemFootPrint() const
+{
+	size_t memFootPrint = instances.size() * sizeof(SLosInstance);
+
+	for (const CLosMap& losMap: losMaps) {
+		memFootPrint += losMap.GetMemFootPrint();
+	}
+	for (const SLosInstance& instance: instances) {
+		memFootPrint += (instance.squares.capacity() * sizeof(SLosInstance::RLE));
+	}
+	for (const auto& p: footprintCache) {
+		memFootPrint += (sizeof(LosFootprint) + p.second.squares.capacity() * sizeof(SLosInstance::RLE));
+	}
+
+	memFootPrint += (footprintRevisions.capacity() * sizeof(std::uint32_t));
+	memFootPrint += (squareEpochs.capacity() * sizeof(int));
+	return memFootPrint;
 }
 
 void ILosType::Kill()
@@ -123,6 +163,14 @@ void ILosType::Kill()
 	losDeleted.clear();
 	losRecalc.clear();
 
+	spring::clear_unordered_map(footprintCache);
+	footprintQue.clear();
+	footprintRevisions.clear();
+
+	losRecalcHashes.clear();
+	losRecalcRevisions.clear();
+	losRecalcHits.clear();
+
 	// mark as invalid
 	size = {0, 0};
 }
@@ -273,21 +321,104 @@ inline void ILosType::LosAdd(SLosInstance* li)
 	assert(li);
 	assert(teamHandler.IsValidAllyTeam(li->allyteam));
 
-	if (algoType == LOS_ALGO_RAYCAST) {
-		losMaps[li->allyteam].AddRaycast(li, 1);
-	} else {
-		losMaps[li->allyteam].AddCircle(li, 1);
-	}
+	losMaps[li->allyteam].AddRaycast(li, 1);
+	AddDirtyRect(li);
 }
 
 
 inline void ILosType::LosRemove(SLosInstance* li)
 {
-	if (algoType == LOS_ALGO_RAYCAST) {
-		losMaps[li->allyteam].AddRaycast(li, -1);
-	} else {
-		losMaps[li->allyteam].AddCircle(li, -1);
+	losMaps[li->allyteam].AddRaycast(li, -1);
+	AddDirtyRect(li);
+}
+
+
+inline void ILosType::LosDelta(SLosInstance* oldLi, SLosInstance* newLi)
+{
+	assert(oldLi->allyteam == newLi->allyteam);
+
+	losMaps[newLi->allyteam].AddDelta(oldLi, newLi);
+	AddDirtyRect(oldLi);
+	AddDirtyRect(newLi);
+}
+
+
+/**
+ * A unit moving to another LOS-square removes its old instance and adds a
+ * new one with the same allyteam and radius. For circles the two footprints
+ * mostly overlap, so instead of a full remove + add only the difference is
+ * applied (see CLosMap::AddDelta). Pairs are matched greedily, adds in id
+ * order take the first unpaired remove within half their radius.
+ * Paired instances are taken out of losRemove and losAdd.
+ */
+void ILosType::PairCircleInstances()
+{
+	losDeltaPairs.clear();
+
+	if (losRemove.empty() || losAdd.empty())
+		return;
+
+	const auto InstanceKey = [](const SLosInstance* li) {
+		return std::make_tuple(li->allyteam, li->radius, li->basePos.y, li->basePos.x, li->id);
+	};
+
+	// order is irrelevant for the final counts, only for determinism
+	std::sort(losRemove.begin(), losRemove.end(), [&](const SLosInstance* a, const SLosInstance* b) { return (InstanceKey(a) < InstanceKey(b)); });
+
+	losRemovePaired.clear();
+	losRemovePaired.resize(losRemove.size(), false);
+
+	for (SLosInstance*& addLi: losAdd) {
+		const int maxOffset = std::max(addLi->radius >> 1, 1);
+		const auto minKey = std::make_tuple(addLi->allyteam, addLi->radius, addLi->basePos.y - maxOffset, std::numeric_limits<int>::min(), std::numeric_limits<int>::min());
+
+		const auto beg = std::lower_bound(losRemove.begin(), losRemove.end(), minKey, [&](const SLosInstance* li, const decltype(minKey)& key) {
+			return (InstanceKey(li) < key);
+		});
+
+		for (auto it = beg; it != losRemove.end(); ++it) {
+			SLosInstance* remLi = *it;
+
+			if (remLi->allyteam != addLi->allyteam || remLi->radius != addLi->radius)
+				break;
+			if (remLi->basePos.y > addLi->basePos.y + maxOffset)
+				break;
+			if (std::abs(remLi->basePos.x - addLi->basePos.x) > maxOffset)
+				continue;
+			if (losRemovePaired[it - losRemove.begin()])
+				continue;
+
+			losRemovePaired[it - losRemove.begin()] = true;
+			losDeltaPairs.emplace_back(remLi, addLi);
+
+			addLi = nullptr;
+			break;
+		}
 	}
+
+	if (losDeltaPairs.empty())
+		return;
+
+	for (size_t i = 0, j = 0, n = losRemove.size(); i < n; ++i) {
+		if (!losRemovePaired[i])
+			losRemove[j++] = losRemove[i];
+	}
+
+	losRemove.resize(losRemove.size() - losDeltaPairs.size());
+	losAdd.erase(std::remove(losAdd.begin(), losAdd.end(), nullptr), losAdd.end());
+}
+
+
+void ILosType::AddDirtyRect(const SLosInstance* li)
+{
+	DirtyRect& dr = dirtyRects[(numDirtyRects++) % NUM_DIRTY_RECTS];
+
+	// max-bounds are exclusive
+	dr.rect.x1 = std::max(li->basePos.x - li->radius    , 0);
+	dr.rect.y1 = std::max(li->basePos.y - li->radius    , 0);
+	dr.rect.x2 = std::min(li->basePos.x + li->radius + 1, size.x);
+	dr.rect.y2 = std::min(li->basePos.y + li->radius + 1, size.y);
+	dr.allyTeam = li->allyteam;
 }
 
 
@@ -474,8 +605,88 @@ inline int ILosType::GetHashNum(const int allyteam, const int2 baseLos, const fl
 }
 
 
-void ILosType::Update()
+inline std::uint32_t ILosType::GetFootprintHash(const SLosInstance* li) const
 {
+	std::uint32_t hash = 0;
+	hash = HsiehHash(&li->basePos,    sizeof(li->basePos),    hash);
+	hash = HsiehHash(&li->radius,     sizeof(li->radius),     hash);
+	hash = HsiehHash(&li->baseHeight, sizeof(li->baseHeight), hash);
+	return hash;
+}
+
+
+std::uint32_t ILosType::GetFootprintRevision(const SLosInstance* li) const
+{
+	// revisions only ever increase, so their sum changes whenever any
+	// block overlapped by the footprint's bounding square is modified
+	const int x1 = Clamp(li->basePos.x - li->radius, 0, size.x - 1) / FOOTPRINT_BLOCK_SIZE;
+	const int x2 = Clamp(li->basePos.x + li->radius, 0, size.x - 1) / FOOTPRINT_BLOCK_SIZE;
+	const int y1 = Clamp(li->basePos.y - li->radius, 0, size.y - 1) / FOOTPRINT_BLOCK_SIZE;
+	const int y2 = Clamp(li->basePos.y + li->radius, 0, size.y - 1) / FOOTPRINT_BLOCK_SIZE;
+
+	std::uint32_t revision = 0;
+
+	for (int y = y1; y <= y2; ++y) {
+		for (int x = x1; x <= x2; ++x) {
+			revision += footprintRevisions[y * footprintBlocks.x + x];
+		}
+	}
+
+	return revision;
+}
+
+
+bool ILosType::GetCachedFootprint(SLosInstance* li, std::uint32_t& hash, std::uint32_t& revision) const
+{
+	hash = GetFootprintHash(li);
+	revision = GetFootprintRevision(li);
+
+	const auto it = footprintCache.find(hash);
+
+	if (it == footprintCache.end())
+		return false;
+
+	const LosFootprint& fp = it->second;
+
+	if (fp.revision != revision)
+		return false;
+	if (fp.basePos != li->basePos || fp.radius != li->radius || fp.baseHeight != li->baseHeight)
+		return false;
+
+	li->squares = fp.squares;
+	return true;
+}
+
+
+void ILosType::AddCachedFootprint(const SLosInstance* li, std::uint32_t hash, std::uint32_t revision)
+{
+	const auto it = footprintCache.find(hash);
+
+	if (it == footprintCache.end()) {
+		while (footprintQue.size() >= FOOTPRINT_CACHE_SIZE) {
+			footprintCache.erase(footprintQue.front());
+			footprintQue.pop_front();
+		}
+
+		footprintQue.push_back(hash);
+	}
+
+	// stale entries (or hash collisions) are simply replaced
+	LosFootprint& fp = footprintCache[hash];
+	fp.basePos = li->basePos;
+	fp.radius = li->radius;
+	fp.baseHeight = li->baseHeight;
+	fp.revision = revision;
+	fp.squares = li->squares;
+}
+
+
+void ILosType::Update(int changeEpoch)
+{
+	for (CLosMap& losMap: losMaps) {
+		losMap.SetChangeEpoch(changeEpoch);
+	}
+
 	// delayed delete
 	while (!delayedDeleteQue.empty() && delayedDeleteQue.front().timeoutTime < gs->frameNum) {
 		UnrefInstance(delayedDeleteQue.front().instance);
@@ -504,10 +715,8 @@ void ILosType::Update()
 	losDeleted.clear();
 	losDeleted.reserve(losUpdate.size());
 
-	if (algoType == LOS_ALGO_RAYCAST) {
-		losRecalc.clear();
-		losRecalc.reserve(losUpdate.size());
-	}
+	losRecalc.clear();
+	losRecalc.reserve(losUpdate.size());
 
 	// filter the updates into their subparts
 	for (SLosInstance* li: losUpdate) {
@@ -516,10 +725,12 @@ void ILosType::Update()
 
 		switch (status) {
 			case SLosInstance::TLosStatus::NEW: {
-				if (algoType == LOS_ALGO_RAYCAST) losRecalc.push_back(li);
+				losRecalc.push_back(li);
 				losAdd.push_back(li);
 			} break;
 			case SLosInstance::TLosStatus::REACTIVATE: {
+				// circle footprints are never cached, make sure they exist
+				if (algoType == LOS_ALGO_CIRCLE) losRecalc.push_back(li);
 				losAdd.push_back(li);
 			} break;
 			case SLosInstance::TLosStatus::RECALC: {
@@ -545,20 +756,64 @@ void ILosType::Update()
 		}
 	}
 
-	// remove sight
-	//FIXME multithread?
-	for (SLosInstance* li: losRemove) {
-		LosRemove(li);
+	// compute the footprints of new and recalculated instances in parallel;
+	// each writes only into its own SLosInstance::squares buffer, while the
+	// shared losMaps are touched by the cheap RLE add/remove passes below.
+	// remove still uses the old squares, so it has to run first.
+	std::sort(losRemove.begin(), losRemove.end(), [](const SLosInstance* a, const SLosInstance* b) { return (a->id < b->id); });
+	std::sort(losAdd.begin(), losAdd.end(), [](const SLosInstance* a, const SLosInstance* b) { return (a->id < b->id); });
+
+	// remove sight; circle footprints do not depend on the terrain, so they
+	// are removed after the recalc below (the removed ones are left intact)
+	if (algoType == LOS_ALGO_RAYCAST) {
+		for (SLosInstance* li: losRemove) {
+			LosRemove(li);
+		}
 	}
 
-	// raycast terrain
-	if (algoType == LOS_ALGO_RAYCAST)  {
-		for_mt(0, losRecalc.size(), [&](const int idx) {
-			auto li = losRecalc[idx];
-			assert(li->refCount > 0);
+	// raycast terrain (or rasterize circles)
+	losRecalcHashes.resize(losRecalc.size());
+	losRecalcRevisions.resize(losRecalc.size());
+	losRecalcHits.resize(losRecalc.size());
+
+	for_mt(0, losRecalc.size(), [&](const int idx) {
+		SLosInstance* li = losRecalc[idx];
+		assert(li->refCount > 0);
+
+		if (algoType == LOS_ALGO_RAYCAST) {
 			li->squares.clear();
+
+			// footprint cache is only read here, new entries are added below
+			if ((losRecalcHits[idx] = GetCachedFootprint(li, losRecalcHashes[idx], losRecalcRevisions[idx])))
+				return;
+
 			losMaps[li->allyteam].PrepareRaycast(li);
-		});
+		} else {
+			losMaps[li->allyteam].PrepareCircle(li);
+		}
+	});
+
+	if (algoType == LOS_ALGO_RAYCAST) {
+		for (size_t i = 0; i < losRecalc.size(); ++i) {
+			footprintHits += losRecalcHits[i];
+			footprintFails += (1 - losRecalcHits[i]);
+
+			if (losRecalcHits[i])
+				continue;
+
+			AddCachedFootprint(losRecalc[i], losRecalcHashes[i], losRecalcRevisions[i]);
+		}
+	}
+
+	if (algoType == LOS_ALGO_CIRCLE) {
+		PairCircleInstances();
+
+		for (const auto& p: losDeltaPairs) {
+			LosDelta(p.first, p.second);
+		}
+		for (SLosInstance* li: losRemove) {
+			LosRemove(li);
+		}
 	}
 
 	// add sight
@@ -596,6 +851,21 @@ void ILosType::UpdateHeightMapSynced(SRectangle rect)
 	if (algoType == LOS_ALGO_CIRCLE)
 		return;
 
+	{
+		// invalidate cached footprints; include a one-square margin since
+		// mip-heightmap squares straddling the rectangle also change
+		const int x1 = Clamp((rect.x1 * SQUARE_SIZE) / mipDiv - 1, 0, size.x - 1) / FOOTPRINT_BLOCK_SIZE;
+		const int x2 = Clamp((rect.x2 * SQUARE_SIZE) / mipDiv + 1, 0, size.x - 1) / FOOTPRINT_BLOCK_SIZE;
+		const int y1 = Clamp((rect.y1 * SQUARE_SIZE) / mipDiv - 1, 0, size.y - 1) / FOOTPRINT_BLOCK_SIZE;
+		const int y2 = Clamp((rect.y2 * SQUARE_SIZE) / mipDiv + 1, 0, size.y - 1) / FOOTPRINT_BLOCK_SIZE;
+
+		for (int y = y1; y <= y2; ++y) {
+			for (int x = x1; x <= x2; ++x) {
+				footprintRevisions[y * footprintBlocks.x + x] += 1;
+			}
+		}
+	}
+
 	auto CheckOverlap = [&](SLosInstance* li, SRectangle rect) -> bool {
 		int2 pos = li->basePos * mipDiv;
 		const int radius = li->radius * mipDiv;
@@ -653,6 +923,8 @@ static uint8_t losHandlerMem[sizeof(CLosHandler)];
 
 CLosHandler* losHandler = nullptr;
 
+static MemoryStats::Registrar losHandlerStats("Sim::Los", []() { return MemoryStats::Usage{(losHandler != nullptr)? losHandler->GetMemFootPrint(): 0, 0}; });
+
 
 void CLosHandler::InitStatic()
 {
@@ -683,6 +955,9 @@ void CLosHandler::Init()
 {
 	globalLOS.fill(false);
 
+	unitLosEpoch = 0;
+	forcedUnitLosEpoch = 0;
+
 	baseRadarErrorSize = defBaseRadarErrorSize;
 	baseRadarErrorMult = defBaseRadarErrorMult;
 
@@ -736,6 +1011,11 @@ void CLosHandler::Kill()
 		100.0f * float(ILosType::cacheHits - ILosType::cacheRefs) / (ILosType::cacheHits + ILosType::cacheFails),
 		100.0f * float(ILosType::cacheRefs) / (ILosType::cacheHits + ILosType::cacheFails)
 	);
+	LOG("[LosHandler::%s] raycast footprint cache-{hits,misses}={%u,%u}",
+		__func__,
+		unsigned(profiler.GetCounter("Sim::Los::FootprintCache::Hits")),
+		unsigned(profiler.GetCounter("Sim::Los::FootprintCache::Misses"))
+	);
 
 	losTypes.fill(nullptr);
 }
@@ -805,8 +1085,19 @@ void CLosHandler::Update()
 		}
 		#endif
 
-		lt->Update();
+		lt->Update(unitLosEpoch);
 	});
+
+	size_t footprintHits = 0;
+	size_t footprintFails = 0;
+
+	for (const ILosType* lt: losTypes) {
+		footprintHits += lt->footprintHits;
+		footprintFails += lt->footprintFails;
+	}
+
+	profiler.SetCounter("Sim::Los::FootprintCache::Hits", footprintHits);
+	profiler.SetCounter("Sim::Los::FootprintCache::Misses", footprintFails);
 }
 
 
@@ -817,6 +1108,16 @@ void CLosHandler::UpdateHeightMapSynced(SRectangle rect)
 	}
 }
 
+void CLosHandler::UpdateHeightMapSynced(const std::vector<SRectangle>& rects)
+{
+	// types share no state, same as in Update
+	for_mt(0, losTypes.size(), [&](const int idx) {
+		for (const SRectangle& rect: rects) {
+			losTypes[idx]->UpdateHeightMapSynced(rect);
+		}
+	});
+}
+
 
 bool CLosHandler::InLos(const CUnit* unit, int allyTeam) const
 {
@@ -854,6 +1155,60 @@ bool CLosHandler::InLos(const CUnit* unit, int allyTeam) const
 }
 
 
+bool CLosHandler::UnitLosInputsChanged(CUnit* unit) const
+{
+	const float3 nextPos = unit->pos + unit->speed;
+
+	// every square and flag read by InLos, InAirLos, InRadar and InJammer
+	const std::array<int, 8> squares = {{
+		los.PosToSquareIdx(unit->pos), los.PosToSquareIdx(nextPos),
+		airLos.PosToSquareIdx(unit->pos), airLos.PosToSquareIdx(nextPos),
+		radar.PosToSquareIdx(unit->pos),
+		sonar.PosToSquareIdx(unit->pos),
+		jammer.PosToSquareIdx(unit->pos),
+		sonarJammer.PosToSquareIdx(unit->pos),
+	}};
+	const std::array<const ILosType*, 8> squareTypes = {{&los, &los, &airLos, &airLos, &radar, &sonar, &jammer, &sonarJammer}};
+
+	const int flags =
+		(unit->isCloaked      << 0) |
+		(unit->alwaysVisible  << 1) |
+		(unit->useAirLos      << 2) |
+		(unit->IsInWater()    << 3) |
+		(unit->IsUnderWater() << 4) |
+		(unit->stealth        << 5) |
+		(unit->sonarStealth   << 6) |
+		(unit->beingBuilt     << 7) |
+		(unit->allyteam       << 8);
+
+	bool changed = (unit->losCheckEpoch <= forcedUnitLosEpoch);
+
+	changed |= (unit->losCheckFlags != flags);
+	changed |= (unit->losCheckSquares != squares);
+
+	// coverage changes since the previous check are stamped with its epoch or later
+	for (size_t i = 0; i < squares.size() && !changed; i++) {
+		changed |= (squareTypes[i]->GetSquareEpoch(squares[i]) >= unit->losCheckEpoch);
+	}
+
+	unit->losCheckSquares = squares;
+	unit->losCheckFlags = flags;
+	unit->losCheckEpoch = unitLosEpoch;
+	return changed;
+}
+
+
+size_t CLosHandler::GetMemFootPrint() const
+{
+	size_t memFootPrint = 0;
+
+	for (const ILosType* losType: losTypes) {
+		memFootPrint += losType->GetMemFootPrint();
+	}
+
+	return memFootPrint;
+}
+
 bool CLosHandler::InAirLos(const CUnit* unit, int allyTeam) const
 {
 	// NOTE: units are treated differently than world objects in two ways:
@@ -3,7 +3,10 @@
 #ifndef LOS_HANDLER_H
 #define LOS_HANDLER_H
 
+#include <array>
+#include <cstdint>
 #include <vector>
+#include <utility>
 #include <deque>
 
 #include "Map/Ground.h"
@@ -105,6 +108,13 @@ class ILosType
 public:
 	// the Interface
 	int2 PosToSquare(const float3 pos) const { return int2(pos.x * invDiv, pos.z * invDiv); }
+	int PosToSquareIdx(const float3 pos) const {
+		const int2 p = PosToSquare(pos);
+		return (Clamp(p.y, 0, size.y - 1) * size.x + Clamp(p.x, 0, size.x - 1));
+	}
+
+	/// last epoch (see Update) in which any allyteam gained or lost coverage of square <idx>
+	int GetSquareEpoch(int idx) const { return squareEpochs[idx]; }
 
 	inline bool InSight(const float3 pos, int allyTeam) const {
 		assert(allyTeam < losMaps.size());
@@ -127,17 +137,42 @@ public:
 	void Init(const int mipLevel, LosType type);
 	void Kill();
 
+	/// LOS-maps, instances and cached footprints, in bytes
+	size_t GetMemFootPrint() const;
+
 public:
-	void Update();
+	void Update(int changeEpoch);
 	void UpdateHeightMapSynced(SRectangle rect);
 	void RemoveUnit(CUnit* unit, bool delayed = false);
 	void UpdateUnit(CUnit* unit, bool ignore = false);
 
+public:
+	/**
+	 * Unsynced bookkeeping for incremental info-texture updates: every
+	 * LosAdd and LosRemove records the rectangle (in LOS-squares) it
+	 * touched. Readers remember how many rects they have consumed and
+	 * fall back to a full update once they lag NUM_DIRTY_RECTS behind.
+	 */
+	struct DirtyRect {
+		SRectangle rect;
+		int allyTeam;
+	};
+
+	static constexpr unsigned int NUM_DIRTY_RECTS = 2048;
+
+	const DirtyRect& GetDirtyRect(std::uint64_t n) const { return dirtyRects[n % NUM_DIRTY_RECTS]; }
+	std::uint64_t GetNumDirtyRects() const { return numDirtyRects; }
+
 private:
+	void AddDirtyRect(const SLosInstance* instance);
+
 	//void PostLoad();
 
 	void LosAdd(SLosInstance* instance);
 	void LosRemove(SLosInstance* instance);
+	void LosDelta(SLosInstance* oldInstance, SLosInstance* newInstance);
+
+	void PairCircleInstances();
 
 	void RefInstance(SLosInstance* instance);
 	void UnrefInstance(SLosInstance* instance);
@@ -150,8 +185,13 @@ private:
 	SLosInstance* CreateInstance();
 	void DeleteInstance(SLosInstance* instance);
 
+	bool GetCachedFootprint(SLosInstance* instance, std::uint32_t& hash, std::uint32_t& revision) const;
+	void AddCachedFootprint(const SLosInstance* instance, std::uint32_t hash, std::uint32_t revision);
+
 private:
 	int GetHashNum(const int allyteam, const int2 baseLos, const float radius) const;
+	std::uint32_t GetFootprintHash(const SLosInstance* instance) const;
+	std::uint32_t GetFootprintRevision(const SLosInstance* instance) const;
 
 	float GetRadius(const CUnit* unit) const;
 	float GetHeight(const CUnit* unit) const;
@@ -170,6 +210,9 @@ public:
 	static size_t cacheHits;
 	static size_t cacheRefs;
 
+	size_t footprintHits = 0;
+	size_t footprintFails = 0;
+
 	spring::unordered_map<int, std::vector<SLosInstance*> > instanceHashes;
 
 	std::vector<CLosMap> losMaps;
@@ -182,6 +225,34 @@ private:
 		int timeoutTime;
 	};
 
+	/**
+	 * Raycast footprints do not depend on the allyteam, only on the
+	 * instance's position, radius, height bucket and the terrain below.
+	 * They are kept here (independently of the instance lifetime) so
+	 * other allyteams and rebuilt structures can reuse them. Terrain
+	 * changes bump the revisions of the blocks they overlap, which
+	 * invalidates all footprints touching those blocks.
+	 */
+	struct LosFootprint {
+		int2 basePos;
+		int radius;
+		float baseHeight;
+		std::uint32_t revision;
+		std::vector<SLosInstance::RLE> squares;
+	};
+
+	spring::unordered_map<std::uint32_t, LosFootprint> footprintCache;
+	std::deque<std::uint32_t> footprintQue;
+
+	// per-block heightmap revisions, FOOTPRINT_BLOCK_SIZE^2 LOS-squares each
+	std::vector<std::uint32_t> footprintRevisions;
+	int2 footprintBlocks;
+
+	// per losRecalc entry: {hash, revision, hit}
+	std::vector<std::uint32_t> losRecalcHashes;
+	std::vector<std::uint32_t> losRecalcRevisions;
+	std::vector<std::uint8_t> losRecalcHits;
+
 	std::deque<DelayedInstance> delayedDeleteQue;
 	std::deque<DelayedInstance> delayedTerraQue;
 	std::deque<SLosInstance*> losUpdate;
@@ -192,7 +263,19 @@ private:
 	std::vector<SLosInstance*> losDeleted;
 	std::vector<SLosInstance*> losRecalc;
 
+	// {removed, added} circle instances applied as one difference
+	std::vector<std::pair<SLosInstance*, SLosInstance*>> losDeltaPairs;
+	std::vector<bool> losRemovePaired;
+
+	std::array<DirtyRect, NUM_DIRTY_RECTS> dirtyRects;
+	std::uint64_t numDirtyRects = 0;
+
+	// shared by all losMaps, written by them whenever a count becomes or leaves 0
+	std::vector<int> squareEpochs;
+
 	static constexpr int CACHE_SIZE = 4096;
+	static constexpr int FOOTPRINT_CACHE_SIZE = 8192;
+	static constexpr int FOOTPRINT_BLOCK_SIZE = 16;
 };
 
 
@@ -215,6 +298,8 @@ public:
 	void Init();
 	void Kill();
 
+	size_t GetMemFootPrint() const;
+
 	// the Interface
 	bool InLos(const CUnit* unit, int allyTeam) const;
 	bool InLos(const CWorldObject* obj, int allyTeam) const {
@@ -293,6 +378,24 @@ public:
 public:
 	void Update() override;
 	void UpdateHeightMapSynced(SRectangle rect);
+	void UpdateHeightMapSynced(const std::vector<SRectangle>& rects);
+
+public:
+	/**
+	 * CUnitHandler::UpdateUnitLosStates only recomputes the losStatus of units
+	 * for which UnitLosInputsChanged returns true. Each pass starts a new epoch;
+	 * sensor maps stamp squares whose coverage changes with the current epoch.
+	 */
+	void NextUnitLosEpoch() { unitLosEpoch++; }
+	/// call when an input of CUnit::CalcLosStatus changes for all units
+	void ForceUnitLosUpdates() { forcedUnitLosEpoch = unitLosEpoch; }
+	/// also records the current inputs of <unit>
+	bool UnitLosInputsChanged(CUnit* unit) const;
+
+	void SetGlobalLos(int allyTeam, bool enable) {
+		globalLOS[allyTeam] = enable;
+		ForceUnitLosUpdates();
+	}
 
 public:
 	/**
@@ -320,6 +423,9 @@ private:
 
 	std::vector<float> radarErrorSizes;
 	std::array<ILosType*, 7> losTypes;
+
+	int unitLosEpoch = 0;
+	int forcedUnitLosEpoch = 0;
 };
 
 
@@ -404,11 +404,10 @@ void CLosTableHelper::Debug(const LosTable& losRays, const std::vector<int2>& po
 //////////////////////////////////////////////////////////////////////
 /// CLosMap implementation
 
-void CLosMap::AddCircle(SLosInstance* instance, int amount)
+void CLosMap::PrepareCircle(SLosInstance* instance) const
 {
-#ifdef USE_UNSYNCED_HEIGHTMAP
-	//only AddRaycast supports UnsyncedHeightMap updates
-#endif
+	if (!instance->squares.empty())
+		return;
 
 	MidpointCircleAlgoPerLine(instance->radius, [&](int width, int y) {
 		const unsigned y_ = instance->basePos.y + y;
@@ -417,11 +416,15 @@ void CLosMap::AddCircle(SLosInstance* instance, int amount)
 			const unsigned sx = Clamp(instance->basePos.x - width,     0, size.x);
 			const unsigned ex = Clamp(instance->basePos.x + width + 1, 0, size.x);
 
-			for (unsigned x_ = sx; x_ < ex; ++x_) {
-				losmap[(y_ * size.x) + x_] += amount;
-			}
+			if (sx < ex)
+				instance->squares.push_back(SLosInstance::RLE{int(y_ * size.x + sx), ex - sx});
 		}
 	});
+
+	if (!instance->squares.empty())
+		return;
+
+	instance->squares.push_back(SLosInstance::EMPTY_RLE);
 }
 
 
@@ -440,7 +443,7 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 	if ((amount > 0) && updateUnsyncedHeightMap) {
 		for (const SLosInstance::RLE rle: losSquares) {
 			for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-				losmap[idx] += amount;
+				AddToSquare(idx, amount);
 
 				// skip if this los-square did not *enter* LOS
 				if (losmap[idx] != amount)
@@ -461,7 +464,47 @@ void CLosMap::AddRaycast(SLosInstance* instance, int amount)
 
 	for (const SLosInstance::RLE rle: losSquares) {
 		for (int idx = rle.start, len = rle.length; len > 0; --len, ++idx) {
-			losmap[idx] += amount;
+			AddToSquare(idx, amount);
+		}
+	}
+}
+
+
+void CLosMap::AddDelta(const SLosInstance* oldInstance, const SLosInstance* newInstance)
+{
+	// no ReadMap events are sent from here
+	assert(!sendReadmapEvents);
+
+	deltaEvents.clear();
+	deltaEvents.reserve((oldInstance->squares.size() + newInstance->squares.size()) * 2);
+
+	// every run opens (+) and closes (-) its amount; EMPTY_RLE cancels out
+	for (const SLosInstance::RLE rle: newInstance->squares) {
+		deltaEvents.emplace_back(rle.start                  ,  1);
+		deltaEvents.emplace_back(rle.start + int(rle.length), -1);
+	}
+	for (const SLosInstance::RLE rle: oldInstance->squares) {
+		deltaEvents.emplace_back(rle.start                  , -1);
+		deltaEvents.emplace_back(rle.start + int(rle.length),  1);
+	}
+
+	std::sort(deltaEvents.begin(), deltaEvents.end(), [](const int2& a, const int2& b) { return (a.x < b.x); });
+
+	// sweep; squares covered by both instances have a net amount of 0
+	int amount = 0;
+
+	for (size_t i = 0, n = deltaEvents.size(); i < n; ) {
+		const int idx = deltaEvents[i].x;
+
+		for (; i < n && deltaEvents[i].x == idx; ++i) {
+			amount += deltaEvents[i].y;
+		}
+
+		if (amount == 0 || i == n)
+			continue;
+
+		for (int j = idx, end = deltaEvents[i].x; j < end; ++j) {
+			AddToSquare(j, amount);
 		}
 	}
 }
@@ -17,7 +17,7 @@ struct SLosInstance;
 class CLosMap
 {
 public:
-	void Init(const int2 size_, const int2 mapDims, const float* ctrHeightMap_, const float* mipHeightMap_, bool sendReadmapEvents_)
+	void Init(const int2 size_, const int2 mapDims, const float* ctrHeightMap_, const float* mipHeightMap_, int* squareEpochs_, bool sendReadmapEvents_)
 	{
 		size = size_;
 		LOS2HEIGHT = mapDims / size;
@@ -28,17 +28,28 @@ public:
 		ctrHeightMap = ctrHeightMap_;
 		mipHeightMap = mipHeightMap_;
 
+		squareEpochs = squareEpochs_;
+		changeEpoch = 0;
+
 		sendReadmapEvents = sendReadmapEvents_;
 	}
 
 	void Kill() {}
 
-public:
-	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
-	void AddCircle(SLosInstance* instance, int amount);
+	/// stamped into squareEpochs by Add* whenever a count becomes or leaves 0
+	void SetChangeEpoch(int epoch) { changeEpoch = epoch; }
 
-	/// arbitrary area, for losMap, non-circular radar maps, ...
+public:
+	/// applies the precomputed squares of an instance (see Prepare*)
 	void AddRaycast(SLosInstance* instance, int amount);
+	/**
+	 * same result as AddRaycast(oldInstance, -1) + AddRaycast(newInstance, 1),
+	 * but only touches the squares covered by exactly one of the two
+	 */
+	void AddDelta(const SLosInstance* oldInstance, const SLosInstance* newInstance);
+
+	/// circular area, for airLosMap, circular radar maps, jammer maps, ...
+	void PrepareCircle(SLosInstance* instance) const;
 
 	/// arbitrary area, for losMap, non-circular radar maps, ...
 	void PrepareRaycast(SLosInstance* instance) const;
@@ -53,7 +64,16 @@ public:
 	// FIXME temp fix for CBaseGroundDrawer and AI interface, which need raw data
 	const unsigned short& front() const { return (losmap.front()); }
 
+	size_t GetMemFootPrint() const { return (losmap.capacity() * sizeof(unsigned short)); }
+
 private:
+	void AddToSquare(int idx, int amount) {
+		const unsigned short count = losmap[idx];
+
+		if ((losmap[idx] += amount) == 0 || count == 0)
+			squareEpochs[idx] = changeEpoch;
+	}
+
 	void LosAdd(SLosInstance* instance) const;
 	void UnsafeLosAdd(SLosInstance* instance) const;
 	void SafeLosAdd(SLosInstance* instance) const;
@@ -65,10 +85,15 @@ protected:
 	int2 LOS2HEIGHT;
 
 	std::vector<unsigned short> losmap;
+	// scratch space for AddDelta, {square, amount}
+	std::vector<int2> deltaEvents;
 
 	const float* ctrHeightMap = nullptr;
 	const float* mipHeightMap = nullptr;
 
+	int* squareEpochs = nullptr;
+	int changeEpoch = 0;
+
 	bool sendReadmapEvents = false;
 };
 
@@ -33,6 +33,7 @@ void CModInfo::ResetState()
 		allowSepAxisCollisionTest  = false;
 		allowGroundUnitGravity     = true;
 		allowHoverUnitStrafing     = true;
+		multiThreadedMoveTypes     = false;
 	}
 	{
 		constructionDecay      = true;
@@ -95,8 +96,13 @@ void CModInfo::ResetState()
 		pathFinderSystem = NOPFS_TYPE;
 		pfRawDistMult    = 1.25f;
 		pfUpdateRate     = 0.007f;
+		pfFlowFieldPaths = false;
+		pfSpliceCachedPaths = false;
 
 		allowTake = true;
+		batchedWeaponTargeting = false;
+		multiThreadedProjectiles = false;
+		luaSpatialQueryCache = false;
 	}
 }
 
@@ -134,8 +140,13 @@ void CModInfo::Init(const std::string& modFileName)
 		pathFinderSystem = Clamp(system.GetInt("pathFinderSystem", HAPFS_TYPE), int(NOPFS_TYPE), int(QTPFS_TYPE));
 		pfRawDistMult = system.GetFloat("pathFinderRawDistMult", pfRawDistMult);
 		pfUpdateRate = system.GetFloat("pathFinderUpdateRate", pfUpdateRate);
+		pfFlowFieldPaths = system.GetBool("pathFinderFlowFieldPaths", pfFlowFieldPaths);
+		pfSpliceCachedPaths = system.GetBool("pathFinderSpliceCachedPaths", pfSpliceCachedPaths);
 
 		allowTake = system.GetBool("allowTake", allowTake);
+		batchedWeaponTargeting = system.GetBool("batchedWeaponTargeting", batchedWeaponTargeting);
+		multiThreadedProjectiles = system.GetBool("multiThreadedProjectiles", multiThreadedProjectiles);
+		luaSpatialQueryCache = system.GetBool("luaSpatialQueryCache", luaSpatialQueryCache);
 	}
 
 	{
@@ -152,6 +163,7 @@ void CModInfo::Init(const std::string& modFileName)
 		allowSepAxisCollisionTest = movementTbl.GetBool("allowSepAxisCollisionTest", allowSepAxisCollisionTest);
 		allowGroundUnitGravity = movementTbl.GetBool("allowGroundUnitGravity", allowGroundUnitGravity);
 		allowHoverUnitStrafing = movementTbl.GetBool("allowHoverUnitStrafing", (pathFinderSystem == QTPFS_TYPE));
+		multiThreadedMoveTypes = movementTbl.GetBool("multiThreadedMoveTypes", multiThreadedMoveTypes);
 	}
 
 	{
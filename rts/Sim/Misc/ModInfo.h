@@ -51,6 +51,7 @@ public:
 	bool allowSepAxisCollisionTest;  //< determines if (ground-)units perform collision-testing via the SAT
 	bool allowGroundUnitGravity;     //< determines if (ground-)units experience gravity during regular movement
 	bool allowHoverUnitStrafing;     //< determines if (hover-)units carry their momentum sideways when turning
+	bool multiThreadedMoveTypes;     //< determines if the read-only part of movetype updates runs on the ThreadPool
 
 	// Build behaviour
 	/// Should constructions without builders decay?
@@ -161,8 +162,18 @@ public:
 
 	float pfRawDistMult;
 	float pfUpdateRate;
+	/// whether ground units follow shared flow-fields for long-distance moves (default PFS only)
+	bool pfFlowFieldPaths;
+	/// whether estimator cache-misses may reuse a cached path to the same goal from a nearby reachable block (default PFS only)
+	bool pfSpliceCachedPaths;
 
 	bool allowTake;
+	/// whether weapons due for a SlowUpdate gather their auto-target candidates in one parallel batch
+	bool batchedWeaponTargeting;
+	/// whether the motion of synced missiles, starbursts and torpedoes is integrated in parallel before their in-order updates
+	bool multiThreadedProjectiles;
+	/// whether identical Lua spatial unit queries within a frame reuse the first query's result
+	bool luaSpatialQueryCache;
 };
 
 extern CModInfo modInfo;
@@ -9,11 +9,13 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "System/ContainerUtil.h"
+#include "System/MemoryStats.h"
 
 #ifndef UNIT_TEST
 	#include "Sim/Features/Feature.h"
 	#include "Sim/Projectiles/Projectile.h"
 	#include "Sim/Units/Unit.h"
+	#include "Sim/Units/UnitHandler.h"
 	#include "Sim/Weapons/PlasmaRepulser.h"
 #endif
 
@@ -25,17 +27,25 @@ CR_REG_METADATA(CQuadField, (
 	CR_MEMBER(quadSizeX),
 	CR_MEMBER(quadSizeZ),
 	CR_MEMBER(invQuadSize),
+	CR_MEMBER(numCoarseQuadsX),
+	CR_MEMBER(numCoarseQuadsZ),
+	CR_MEMBER(coarseLevelUsed),
 
 	CR_IGNORED(tempUnits),
 	CR_IGNORED(tempFeatures),
 	CR_IGNORED(tempProjectiles),
 	CR_IGNORED(tempSolids),
-	CR_IGNORED(tempQuads)
+	CR_IGNORED(tempQuads),
+	CR_IGNORED(staticUnits),
+	CR_IGNORED(numMovedUnits),
+
+	CR_POSTLOAD(PostLoad)
 ))
 
 CR_BIND(CQuadField::Quad, )
 CR_REG_METADATA_SUB(CQuadField, Quad, (
 	CR_MEMBER(units),
+	CR_IGNORED(mobileUnits),
 	CR_IGNORED(teamUnits),
 	CR_MEMBER(features),
 	CR_MEMBER(projectiles),
@@ -47,6 +57,10 @@ CR_REG_METADATA_SUB(CQuadField, Quad, (
 
 CQuadField quadField;
 
+#ifndef UNIT_TEST
+static MemoryStats::Registrar quadFieldStats("Sim::QuadField", []() { return MemoryStats::Usage{quadField.GetMemFootPrint(), 0}; });
+#endif
+
 
 #ifndef UNIT_TEST
 /*
@@ -102,6 +116,29 @@ void CQuadField::Quad::PostLoad()
 
 	for (CUnit* unit: units) {
 		spring::VectorInsertUnique(teamUnits[unit->allyteam], unit, false);
+
+		if (unit->immobile)
+			continue;
+
+		spring::VectorInsertUnique(mobileUnits, unit, false);
+	}
+#endif
+}
+
+void CQuadField::PostLoad()
+{
+#ifndef UNIT_TEST
+	staticUnits.Init({mapDims.mapx * SQUARE_SIZE * 1.0f, mapDims.mapy * SQUARE_SIZE * 1.0f});
+
+	// structures spanning several quads are re-inserted once per quad,
+	// Update ignores those whose position and radius did not change
+	for (const Quad& quad: baseQuads) {
+		for (CUnit* unit: quad.units) {
+			if (!unit->immobile)
+				continue;
+
+			staticUnits.Update(unit, unit->pos, unit->radius, unit->id);
+		}
 	}
 #endif
 }
@@ -120,14 +157,20 @@ void CQuadField::Init(int2 mapDims, int quadSize)
 
 	invQuadSize = {1.0f / quadSizeX, 1.0f / quadSizeZ};
 
-	baseQuads.resize(numQuadsX * numQuadsZ);
-	tempQuads.ReserveAll(numQuadsX * numQuadsZ);
+	numCoarseQuadsX = (numQuadsX + COARSE_QUAD_SCALE - 1) / COARSE_QUAD_SCALE;
+	numCoarseQuadsZ = (numQuadsZ + COARSE_QUAD_SCALE - 1) / COARSE_QUAD_SCALE;
+	coarseLevelUsed = false;
+
+	baseQuads.resize(numQuadsX * numQuadsZ + numCoarseQuadsX * numCoarseQuadsZ);
+	tempQuads.ReserveAll(baseQuads.size());
 	tempQuads.ReleaseAll();
 
 #ifndef UNIT_TEST
 	for (Quad& quad: baseQuads) {
 		quad.Resize(teamHandler.ActiveAllyTeams());
 	}
+
+	staticUnits.Init({mapDims.x * SQUARE_SIZE * 1.0f, mapDims.y * SQUARE_SIZE * 1.0f});
 #endif
 }
 
@@ -139,6 +182,12 @@ void CQuadField::Kill()
 		quad.Clear();
 	}
 
+	coarseLevelUsed = false;
+
+#ifndef UNIT_TEST
+	staticUnits.Kill();
+#endif
+
 	tempUnits.ReleaseAll();
 	tempFeatures.ReleaseAll();
 	tempProjectiles.ReleaseAll();
@@ -146,6 +195,25 @@ void CQuadField::Kill()
 	tempQuads.ReleaseAll();
 }
 
+size_t CQuadField::GetMemFootPrint() const
+{
+	size_t memFootPrint = baseQuads.capacity() * sizeof(Quad);
+
+	for (const Quad& quad: baseQuads) {
+		memFootPrint += (quad.units.capacity() + quad.mobileUnits.capacity()) * sizeof(CUnit*);
+		memFootPrint += (quad.teamUnits.capacity() * sizeof(std::vector<CUnit*>));
+		memFootPrint += (quad.features.capacity() * sizeof(CFeature*));
+		memFootPrint += (quad.projectiles.capacity() * sizeof(CProjectile*));
+		memFootPrint += (quad.repulsers.capacity() * sizeof(CPlasmaRepulser*));
+
+		for (const auto& v: quad.teamUnits) {
+			memFootPrint += (v.capacity() * sizeof(CUnit*));
+		}
+	}
+
+	return memFootPrint;
+}
+
 
 int2 CQuadField::WorldPosToQuadField(const float3 p) const
 {
@@ -162,62 +230,131 @@ int CQuadField::WorldPosToQuadFieldIdx(const float3 p) const
 }
 
 
-#ifndef UNIT_TEST
-void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
+int CQuadField::WorldPosToCoarseQuadIdx(const float3 p) const
 {
-	pos.AssertNaNs();
-	pos.ClampInBounds();
-	qfq.quads = tempQuads.ReserveVector();
+	const int cqsx = quadSizeX * COARSE_QUAD_SCALE;
+	const int cqsz = quadSizeZ * COARSE_QUAD_SCALE;
+
+	return GetNumBaseQuads() + Clamp(int(p.z / cqsz), 0, numCoarseQuadsZ - 1) * numCoarseQuadsX + Clamp(int(p.x / cqsx), 0, numCoarseQuadsX - 1);
+}
+
 
-	const int2 min = WorldPosToQuadField(pos - radius);
-	const int2 max = WorldPosToQuadField(pos + radius);
+void CQuadField::GetLevelQuads(std::vector<int>& quads, float3 pos, float radius, bool coarse) const
+{
+	const int scale = coarse? COARSE_QUAD_SCALE: 1;
+	const int qsx = quadSizeX * scale;
+	const int qsz = quadSizeZ * scale;
+	const int nqx = coarse? numCoarseQuadsX: numQuadsX;
+	const int nqz = coarse? numCoarseQuadsZ: numQuadsZ;
+	const int base = coarse? GetNumBaseQuads(): 0;
+
+	const int2 min = {Clamp(int((pos.x - radius) / qsx), 0, nqx - 1), Clamp(int((pos.z - radius) / qsz), 0, nqz - 1)};
+	const int2 max = {Clamp(int((pos.x + radius) / qsx), 0, nqx - 1), Clamp(int((pos.z + radius) / qsz), 0, nqz - 1)};
 
 	if (max.y < min.y || max.x < min.x)
 		return;
 
 	// qsx and qsz are always equal
-	const float maxSqLength = (radius + quadSizeX * 0.72f) * (radius + quadSizeZ * 0.72f);
+	const float maxSqLength = (radius + qsx * 0.72f) * (radius + qsz * 0.72f);
 
 	for (int z = min.y; z <= max.y; ++z) {
 		for (int x = min.x; x <= max.x; ++x) {
-			assert(x < numQuadsX);
-			assert(z < numQuadsZ);
-			const float3 quadPos = float3(x * quadSizeX + quadSizeX * 0.5f, 0, z * quadSizeZ + quadSizeZ * 0.5f);
+			assert(x < nqx);
+			assert(z < nqz);
+			const float3 quadPos = float3(x * qsx + qsx * 0.5f, 0, z * qsz + qsz * 0.5f);
 			if (pos.SqDistance2D(quadPos) < maxSqLength) {
-				qfq.quads->push_back(z * numQuadsX + x);
+				quads.push_back(base + z * nqx + x);
 			}
 		}
 	}
-
-	return;
 }
 
 
-void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
+void CQuadField::GetLevelQuadsRectangle(std::vector<int>& quads, const float3& mins, const float3& maxs, bool coarse) const
 {
-	mins.AssertNaNs();
-	maxs.AssertNaNs();
-	qfq.quads = tempQuads.ReserveVector();
+	const int scale = coarse? COARSE_QUAD_SCALE: 1;
+	const int qsx = quadSizeX * scale;
+	const int qsz = quadSizeZ * scale;
+	const int nqx = coarse? numCoarseQuadsX: numQuadsX;
+	const int nqz = coarse? numCoarseQuadsZ: numQuadsZ;
+	const int base = coarse? GetNumBaseQuads(): 0;
 
-	const int2 min = WorldPosToQuadField(mins);
-	const int2 max = WorldPosToQuadField(maxs);
+	const int2 min = {Clamp(int(mins.x / qsx), 0, nqx - 1), Clamp(int(mins.z / qsz), 0, nqz - 1)};
+	const int2 max = {Clamp(int(maxs.x / qsx), 0, nqx - 1), Clamp(int(maxs.z / qsz), 0, nqz - 1)};
 
 	if (max.y < min.y || max.x < min.x)
 		return;
 
 	for (int z = min.y; z <= max.y; ++z) {
 		for (int x = min.x; x <= max.x; ++x) {
-			assert(x < numQuadsX);
-			assert(z < numQuadsZ);
-			qfq.quads->push_back(z * numQuadsX + x);
+			assert(x < nqx);
+			assert(z < nqz);
+			quads.push_back(base + z * nqx + x);
 		}
 	}
+}
 
-	return;
+
+#ifndef UNIT_TEST
+void CQuadField::GetInsertQuads(QuadFieldQuery& qfq, const float3& pos, float radius)
+{
+	const bool coarse = IsCoarseObject(radius);
+
+	pos.AssertNaNs();
+	qfq.quads = tempQuads.ReserveVector();
+	coarseLevelUsed |= coarse;
+
+	GetLevelQuads(*qfq.quads, pos.cClampInBounds(), radius, coarse);
 }
 #endif // UNIT_TEST
 
 
+void CQuadField::GetQuads(QuadFieldQuery& qfq, float3 pos, float radius)
+{
+	pos.AssertNaNs();
+	pos.ClampInBounds();
+	qfq.quads = tempQuads.ReserveVector();
+
+	GetLevelQuads(*qfq.quads, pos, radius, false);
+
+	if (!coarseLevelUsed)
+		return;
+
+	GetLevelQuads(*qfq.quads, pos, radius, true);
+}
+
+
+void CQuadField::GetQuadsMT(std::vector<int>& quads, float3 pos, float radius) const
+{
+	pos.AssertNaNs();
+	pos.ClampInBounds();
+	quads.clear();
+
+	// same selection as GetQuads; indices are generated in ascending order
+	GetLevelQuads(quads, pos, radius, false);
+
+	if (!coarseLevelUsed)
+		return;
+
+	GetLevelQuads(quads, pos, radius, true);
+}
+
+
+void CQuadField::GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
+{
+	mins.AssertNaNs();
+	maxs.AssertNaNs();
+	qfq.quads = tempQuads.ReserveVector();
+
+	GetLevelQuadsRectangle(*qfq.quads, mins, maxs, false);
+
+	if (!coarseLevelUsed)
+		return;
+
+	GetLevelQuadsRectangle(*qfq.quads, mins, maxs, true);
+}
+
+
 /// note: this function got an UnitTest, check the tests/ folder!
 void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length)
 {
@@ -226,6 +363,25 @@ void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const f
 
 	auto& queryQuads = *(qfq.quads = tempQuads.ReserveVector());
 
+	GetLevelQuadsOnRay(queryQuads, start, dir, length, false);
+
+	if (!coarseLevelUsed)
+		return;
+
+	GetLevelQuadsOnRay(queryQuads, start, dir, length, true);
+}
+
+
+void CQuadField::GetLevelQuadsOnRay(std::vector<int>& queryQuads, const float3& start, const float3& dir, float length, bool coarse) const
+{
+	const int scale = coarse? COARSE_QUAD_SCALE: 1;
+	const int qsz = quadSizeZ * scale;
+	const int nqx = coarse? numCoarseQuadsX: numQuadsX;
+	const int nqz = coarse? numCoarseQuadsZ: numQuadsZ;
+	const int base = coarse? GetNumBaseQuads(): 0;
+
+	const float2 invQuadSize = this->invQuadSize / float(scale);
+
 	const float3 to = start + (dir * length);
 
 	const bool noXdir = (math::floor(start.x * invQuadSize.x) == math::floor(to.x * invQuadSize.x));
@@ -234,22 +390,22 @@ void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const f
 
 	// special case
 	if (noXdir && noZdir) {
-		queryQuads.push_back(WorldPosToQuadFieldIdx(start));
+		queryQuads.push_back(coarse? WorldPosToCoarseQuadIdx(start): WorldPosToQuadFieldIdx(start));
 		assert(static_cast<unsigned>(queryQuads.back()) < baseQuads.size());
 		return;
 	}
 
 	// prevent div0
 	if (noZdir) {
-		int startX = Clamp<int>(start.x * invQuadSize.x, 0, numQuadsX - 1);
-		int finalX = Clamp<int>(   to.x * invQuadSize.x, 0, numQuadsX - 1);
+		int startX = Clamp<int>(start.x * invQuadSize.x, 0, nqx - 1);
+		int finalX = Clamp<int>(   to.x * invQuadSize.x, 0, nqx - 1);
 
 		if (finalX < startX)
 			std::swap(startX, finalX);
 
-		assert(finalX < numQuadsX);
+		assert(finalX < nqx);
 
-		const int row = Clamp<int>(start.z * invQuadSize.y, 0, numQuadsZ - 1) * numQuadsX;
+		const int row = base + Clamp<int>(start.z * invQuadSize.y, 0, nqz - 1) * nqx;
 
 		for (unsigned x = startX; x <= finalX; x++) {
 			queryQuads.push_back(row + x);
@@ -267,35 +423,35 @@ void CQuadField::GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const f
 	if (finalZuc < startZuc)
 		std::swap(startZuc, finalZuc);
 
-	const int startZ = Clamp<int>(startZuc, 0, numQuadsZ - 1);
-	const int finalZ = Clamp<int>(finalZuc, 0, numQuadsZ - 1);
+	const int startZ = Clamp<int>(startZuc, 0, nqz - 1);
+	const int finalZ = Clamp<int>(finalZuc, 0, nqz - 1);
 
-	assert(finalZ < quadSizeZ);
+	assert(finalZ < qsz);
 
 	const float invDirZ = 1.0f / dir.z;
 
 	for (int z = startZ; z <= finalZ; z++) {
-		float t0 = ((z    ) * quadSizeZ - start.z) * invDirZ;
-		float t1 = ((z + 1) * quadSizeZ - start.z) * invDirZ;
+		float t0 = ((z    ) * qsz - start.z) * invDirZ;
+		float t1 = ((z + 1) * qsz - start.z) * invDirZ;
 
-		if ((startZuc < 0 && z == 0) || (startZuc >= numQuadsZ && z == finalZ))
-			t0 = ((startZuc    ) * quadSizeZ - start.z) * invDirZ;
+		if ((startZuc < 0 && z == 0) || (startZuc >= nqz && z == finalZ))
+			t0 = ((startZuc    ) * qsz - start.z) * invDirZ;
 
-		if ((finalZuc < 0 && z == 0) || (finalZuc >= numQuadsZ && z == finalZ))
-			t1 = ((finalZuc + 1) * quadSizeZ - start.z) * invDirZ;
+		if ((finalZuc < 0 && z == 0) || (finalZuc >= nqz && z == finalZ))
+			t1 = ((finalZuc + 1) * qsz - start.z) * invDirZ;
 
 		t0 = Clamp(t0, 0.0f, length);
 		t1 = Clamp(t1, 0.0f, length);
 
-		unsigned startX = Clamp<int>((dir.x * t0 + start.x) * invQuadSize.x, 0, numQuadsX - 1);
-		unsigned finalX = Clamp<int>((dir.x * t1 + start.x) * invQuadSize.x, 0, numQuadsX - 1);
+		unsigned startX = Clamp<int>((dir.x * t0 + start.x) * invQuadSize.x, 0, nqx - 1);
+		unsigned finalX = Clamp<int>((dir.x * t1 + start.x) * invQuadSize.x, 0, nqx - 1);
 
 		if (finalX < startX)
 			std::swap(startX, finalX);
 
-		assert(finalX < numQuadsX);
+		assert(finalX < nqx);
 
-		const int row = Clamp(z, 0, numQuadsZ - 1) * numQuadsX;
+		const int row = base + Clamp(z, 0, nqz - 1) * nqx;
 
 		for (unsigned x = startX; x <= finalX; x++) {
 			queryQuads.push_back(row + x);
@@ -322,8 +478,7 @@ bool CQuadField::InsertUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorInsertUnique(unit->quads, wposQuadIdx, true))
 		return false;
 
-	spring::VectorInsertUnique(baseQuads[wposQuadIdx].units, unit, false);
-	spring::VectorInsertUnique(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit, false);
+	InsertQuadUnit(wposQuadIdx, unit);
 	return true;
 }
 
@@ -341,7 +496,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 		return false;
 
 	QuadFieldQuery qfQuery;
-	GetQuads(qfQuery, unit->pos, unit->radius);
+	GetInsertQuads(qfQuery, unit->pos, unit->radius);
 
 	// do nothing if the cells touched by unit now contain <wpos>
 	if (std::find(qfQuery.quads->begin(), qfQuery.quads->end(), wposQuadIdx) != qfQuery.quads->end()) {
@@ -352,8 +507,7 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 	if (!spring::VectorErase(unit->quads, wposQuadIdx))
 		return false;
 
-	spring::VectorErase(baseQuads[wposQuadIdx].units, unit);
-	spring::VectorErase(baseQuads[wposQuadIdx].teamUnits[unit->allyteam], unit);
+	EraseQuadUnit(wposQuadIdx, unit);
 	return true;
 }
 #endif
@@ -361,10 +515,42 @@ bool CQuadField::RemoveUnitIf(CUnit* unit, const float3& wpos)
 
 
 #ifndef UNIT_TEST
+void CQuadField::InsertQuadUnit(int qi, CUnit* unit)
+{
+	Quad& quad = baseQuads[qi];
+
+	spring::VectorInsertUnique(quad.units, unit, false);
+	spring::VectorInsertUnique(quad.teamUnits[unit->allyteam], unit, false);
+
+	if (unit->immobile)
+		return;
+
+	spring::VectorInsertUnique(quad.mobileUnits, unit, false);
+}
+
+void CQuadField::EraseQuadUnit(int qi, CUnit* unit)
+{
+	Quad& quad = baseQuads[qi];
+
+	spring::VectorErase(quad.units, unit);
+	spring::VectorErase(quad.teamUnits[unit->allyteam], unit);
+
+	if (unit->immobile)
+		return;
+
+	spring::VectorErase(quad.mobileUnits, unit);
+}
+
 void CQuadField::MovedUnit(CUnit* unit)
 {
+	numMovedUnits++;
+
+	// no-op unless the position or radius changed
+	if (unit->immobile)
+		staticUnits.Update(unit, unit->pos, unit->radius, unit->id);
+
 	QuadFieldQuery qfQuery;
-	GetQuads(qfQuery, unit->pos, unit->radius);
+	GetInsertQuads(qfQuery, unit->pos, unit->radius);
 
 	// compare if the quads have changed, if not stop here
 	if (qfQuery.quads->size() == unit->quads.size()) {
@@ -373,13 +559,11 @@ void CQuadField::MovedUnit(CUnit* unit)
 	}
 
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		EraseQuadUnit(qi, unit);
 	}
 
 	for (const int qi: *qfQuery.quads) {
-		spring::VectorInsertUnique(baseQuads[qi].units, unit, false);
-		spring::VectorInsertUnique(baseQuads[qi].teamUnits[unit->allyteam], unit, false);
+		InsertQuadUnit(qi, unit);
 	}
 
 	unit->quads = std::move(*qfQuery.quads);
@@ -388,11 +572,11 @@ void CQuadField::MovedUnit(CUnit* unit)
 void CQuadField::RemoveUnit(CUnit* unit)
 {
 	for (const int qi: unit->quads) {
-		spring::VectorErase(baseQuads[qi].units, unit);
-		spring::VectorErase(baseQuads[qi].teamUnits[unit->allyteam], unit);
+		EraseQuadUnit(qi, unit);
 	}
 
 	unit->quads.clear();
+	staticUnits.Remove(unit->id);
 
 	#ifdef DEBUG_QUADFIELD
 	for (const Quad& q: baseQuads) {
@@ -409,7 +593,7 @@ void CQuadField::RemoveUnit(CUnit* unit)
 void CQuadField::MovedRepulser(CPlasmaRepulser* repulser)
 {
 	QuadFieldQuery qfQuery;
-	GetQuads(qfQuery, repulser->weaponMuzzlePos, repulser->GetRadius());
+	GetInsertQuads(qfQuery, repulser->weaponMuzzlePos, repulser->GetRadius());
 
 	const auto& repulserQuads = repulser->GetQuads();
 
@@ -451,17 +635,53 @@ void CQuadField::RemoveRepulser(CPlasmaRepulser* repulser)
 void CQuadField::AddFeature(CFeature* feature)
 {
 	QuadFieldQuery qfQuery;
-	GetQuads(qfQuery, feature->pos, feature->radius);
+	GetInsertQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
 		spring::VectorInsertUnique(baseQuads[qi].features, feature, false);
 	}
 }
 
+void CQuadField::AddFeatures(const std::vector<CFeature*>& features)
+{
+	std::vector<int> featureQuads;
+	std::vector<unsigned int> featureQuadOffsets;
+	std::vector<unsigned int> numQuadInserts(baseQuads.size(), 0);
+
+	featureQuads.reserve(features.size() * 2);
+	featureQuadOffsets.reserve(features.size() + 1);
+	featureQuadOffsets.push_back(0);
+
+	for (const CFeature* feature: features) {
+		QuadFieldQuery qfQuery;
+		GetInsertQuads(qfQuery, feature->pos, feature->radius);
+
+		for (const int qi: *qfQuery.quads) {
+			featureQuads.push_back(qi);
+			numQuadInserts[qi] += 1;
+		}
+
+		featureQuadOffsets.push_back(featureQuads.size());
+	}
+
+	for (size_t qi = 0; qi < baseQuads.size(); qi++) {
+		if (numQuadInserts[qi] == 0)
+			continue;
+
+		baseQuads[qi].features.reserve(baseQuads[qi].features.size() + numQuadInserts[qi]);
+	}
+
+	for (size_t i = 0; i < features.size(); i++) {
+		for (unsigned int j = featureQuadOffsets[i]; j < featureQuadOffsets[i + 1]; j++) {
+			spring::VectorInsertUnique(baseQuads[ featureQuads[j] ].features, features[i], false);
+		}
+	}
+}
+
 void CQuadField::RemoveFeature(CFeature* feature)
 {
 	QuadFieldQuery qfQuery;
-	GetQuads(qfQuery, feature->pos, feature->radius);
+	GetInsertQuads(qfQuery, feature->pos, feature->radius);
 
 	for (const int qi: *qfQuery.quads) {
 		spring::VectorErase(baseQuads[qi].features, feature);
@@ -478,6 +698,22 @@ void CQuadField::RemoveFeature(CFeature* feature)
 
 
 
+bool CQuadField::IsCoarseProjectile(const CProjectile* p) const
+{
+	// projectiles are stored as points, but fast ones would change fine
+	// quads (nearly) every frame; keep those in the coarse level instead
+	return ((p->speed.w * 2.0f) > quadSizeX);
+}
+
+int CQuadField::GetProjectileQuadIdx(const CProjectile* p) const
+{
+	if (IsCoarseProjectile(p))
+		return (WorldPosToCoarseQuadIdx(p->pos));
+
+	return (WorldPosToQuadFieldIdx(p->pos));
+}
+
+
 void CQuadField::MovedProjectile(CProjectile* p)
 {
 	if (!p->synced)
@@ -486,7 +722,7 @@ void CQuadField::MovedProjectile(CProjectile* p)
 	if (p->hitscan)
 		return;
 
-	const int newQuad = WorldPosToQuadFieldIdx(p->pos);
+	const int newQuad = GetProjectileQuadIdx(p);
 	if (newQuad != p->quads.back()) {
 		RemoveProjectile(p);
 		AddProjectile(p);
@@ -499,7 +735,8 @@ void CQuadField::AddProjectile(CProjectile* p)
 
 	if (p->hitscan) {
 		QuadFieldQuery qfQuery;
-		GetQuadsOnRay(qfQuery, p->pos, p->dir, p->speed.w);
+		qfQuery.quads = tempQuads.ReserveVector();
+		GetLevelQuadsOnRay(*qfQuery.quads, p->pos, p->dir, p->speed.w, false);
 
 		for (const int qi: *qfQuery.quads) {
 			spring::VectorInsertUnique(baseQuads[qi].projectiles, p, false);
@@ -507,7 +744,8 @@ void CQuadField::AddProjectile(CProjectile* p)
 
 		p->quads = std::move(*qfQuery.quads);
 	} else {
-		int newQuad = WorldPosToQuadFieldIdx(p->pos);
+		const int newQuad = GetProjectileQuadIdx(p);
+		coarseLevelUsed |= (newQuad >= GetNumBaseQuads());
 		spring::VectorInsertUnique(baseQuads[newQuad].projectiles, p, false);
 		p->quads.clear();
 		p->quads.push_back(newQuad);
@@ -557,7 +795,7 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float rad
 	qfq.units = tempUnits.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
+		for (CUnit* u: baseQuads[qi].mobileUnits) {
 			if (u->tempNum == tempNum)
 				continue;
 
@@ -576,9 +814,39 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& pos, float rad
 		}
 	}
 
+	staticUnits.QueryCircle(pos, radius, spherical, [&](CUnit* u) {
+		u->tempNum = tempNum;
+		qfq.units->push_back(u);
+	});
+
 	return;
 }
 
+void CQuadField::GetUnitsExactMT(std::vector<CUnit*>& units, std::vector<int>& quads, const float3& pos, float radius) const
+{
+	GetQuadsMT(quads, pos, radius);
+	units.clear();
+
+	for (const int qi: quads) {
+		for (CUnit* u: baseQuads[qi].mobileUnits) {
+			// a unit overlapping several queried quads is only taken from the
+			// first (lowest-index) one, which mirrors the tempNum dedup order
+			const auto pred = [&](const int uqi) { return (uqi < qi && std::binary_search(quads.begin(), quads.end(), uqi)); };
+
+			if (std::find_if(u->quads.begin(), u->quads.end(), pred) != u->quads.end())
+				continue;
+
+			if (pos.SqDistance(u->pos) >= Square(radius + u->radius))
+				continue;
+
+			units.push_back(u);
+		}
+	}
+
+	// structures are never duplicated, the index holds each one once
+	staticUnits.QueryCircle(pos, radius, true, [&](CUnit* u) { units.push_back(u); });
+}
+
 void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const float3& maxs)
 {
 	QuadFieldQuery qfQuery;
@@ -587,7 +855,7 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 	qfq.units = tempUnits.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* unit: baseQuads[qi].units) {
+		for (CUnit* unit: baseQuads[qi].mobileUnits) {
 
 			if (unit->tempNum == tempNum)
 				continue;
@@ -604,6 +872,11 @@ void CQuadField::GetUnitsExact(QuadFieldQuery& qfq, const float3& mins, const fl
 		}
 	}
 
+	staticUnits.QueryRectangle(mins, maxs, [&](CUnit* unit) {
+		unit->tempNum = tempNum;
+		qfq.units->push_back(unit);
+	});
+
 	return;
 }
 
@@ -733,7 +1006,7 @@ void CQuadField::GetSolidsExact(
 	qfq.solids = tempSolids.ReserveVector();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
+		for (CUnit* u: baseQuads[qi].mobileUnits) {
 			if (u->tempNum == tempNum)
 				continue;
 
@@ -766,6 +1039,17 @@ void CQuadField::GetSolidsExact(
 		}
 	}
 
+	staticUnits.QueryCircle(pos, radius, true, [&](CUnit* u) {
+		u->tempNum = tempNum;
+
+		if (!u->HasPhysicalStateBit(physicalStateBits))
+			return;
+		if (!u->HasCollidableStateBit(collisionStateBits))
+			return;
+
+		qfq.solids->push_back(u);
+	});
+
 	return;
 }
 
@@ -781,7 +1065,7 @@ bool CQuadField::NoSolidsExact(
 	const int tempNum = gs->GetTempNum();
 
 	for (const int qi: *qfQuery.quads) {
-		for (CUnit* u: baseQuads[qi].units) {
+		for (CUnit* u: baseQuads[qi].mobileUnits) {
 			if (u->tempNum == tempNum)
 				continue;
 
@@ -814,7 +1098,13 @@ bool CQuadField::NoSolidsExact(
 		}
 	}
 
-	return true;
+	bool noSolids = true;
+
+	staticUnits.QueryCircle(pos, radius, true, [&](CUnit* u) {
+		noSolids &= (!u->HasPhysicalStateBit(physicalStateBits) || !u->HasCollidableStateBit(collisionStateBits));
+	});
+
+	return noSolids;
 }
 
 
@@ -5,9 +5,12 @@
 
 #include <algorithm>
 #include <array>
+#include <deque>
 #include <vector>
 
+#include "Sim/Misc/StaticObjectIndex.h"
 #include "System/Misc/NonCopyable.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
 #include "System/type2.h"
@@ -19,29 +22,39 @@ class CSolidObject;
 class CPlasmaRepulser;
 struct QuadFieldQuery;
 
+/**
+ * Pools of query result vectors, one per thread so that queries issued
+ * from ThreadPool workers never contend (or need a lock). Each pool grows
+ * when nested queries need more vectors than it currently holds; vectors
+ * live in a deque so handed-out pointers stay valid. A vector has to be
+ * released on the thread that reserved it.
+ */
 template<typename T>
 class QueryVectorCache {
 public:
-	typedef std::pair<bool, std::vector<T>> PairType;
+	std::vector<T>* ReserveVector(size_t capa = 1024) {
+		ThreadVectors& tv = threadVectors[ThreadPool::GetThreadNum()];
 
-	std::vector<T>* ReserveVector(size_t base = 0, size_t capa = 1024) {
-		const auto pred = [](const PairType& p) { return (!p.first); };
-		const auto iter = std::find_if(vectors.begin() + base, vectors.end(), pred);
-
-		if (iter != vectors.end()) {
-			iter->first = true;
-			iter->second.clear();
-			iter->second.reserve(capa);
-			return &iter->second;
+		if (tv.freeVectors.empty()) {
+			tv.vectors.emplace_back();
+			tv.freeVectors.push_back(&tv.vectors.back());
 		}
 
-		assert(false);
-		return nullptr;
+		std::vector<T>* vec = tv.freeVectors.back();
+		tv.freeVectors.pop_back();
+		vec->clear();
+		vec->reserve(capa);
+		return vec;
 	}
 
 	void ReserveAll(size_t capa) {
-		for (size_t i = 0; i < vectors.size(); ++i) {
-			ReserveVector(i, capa);
+		for (ThreadVectors& tv: threadVectors) {
+			// there are at most 2 concurrent users per thread in the common case
+			tv.vectors.resize(std::max(tv.vectors.size(), size_t(NUM_INITIAL_VECTORS)));
+
+			for (std::vector<T>& vec: tv.vectors) {
+				vec.reserve(capa);
+			}
 		}
 	}
 
@@ -49,26 +62,35 @@ public:
 		if (released == nullptr)
 			return;
 
-		const auto pred = [&](const PairType& p) { return (&p.second == released); };
-		const auto iter = std::find_if(vectors.begin(), vectors.end(), pred);
+		ThreadVectors& tv = threadVectors[ThreadPool::GetThreadNum()];
 
-		if (iter == vectors.end()) {
-			assert(false);
-			return;
-		}
+		#ifndef NDEBUG
+		const auto pred = [&](const std::vector<T>& vec) { return (&vec == released); };
+		assert(std::find_if(tv.vectors.begin(), tv.vectors.end(), pred) != tv.vectors.end());
+		assert(std::find(tv.freeVectors.begin(), tv.freeVectors.end(), released) == tv.freeVectors.end());
+		#endif
 
-		iter->first = false;
+		tv.freeVectors.push_back(const_cast<std::vector<T>*>(released));
 	}
 	void ReleaseAll() {
-		for (auto& pair: vectors) {
-			ReleaseVector(&pair.second);
+		for (ThreadVectors& tv: threadVectors) {
+			tv.freeVectors.clear();
+
+			for (std::vector<T>& vec: tv.vectors) {
+				tv.freeVectors.push_back(&vec);
+			}
 		}
 	}
+
 private:
-	// There should at most be 2 concurrent users of each vector type
-	// using 3 to be safe, increase this number if the assertions below
-	// fail
-	std::array<PairType, 3> vectors = {{{false, {}}, {false, {}}, {false, {}}}};
+	static constexpr size_t NUM_INITIAL_VECTORS = 3;
+
+	struct ThreadVectors {
+		std::deque< std::vector<T> > vectors;
+		std::vector< std::vector<T>* > freeVectors;
+	};
+
+	std::array<ThreadVectors, ThreadPool::MAX_THREADS> threadVectors;
 };
 
 
@@ -91,11 +113,21 @@ public:
 
 	void Init(int2 mapDims, int quadSize);
 	void Kill();
+	void PostLoad();
 
 	void GetQuads(QuadFieldQuery& qfq, float3 pos, float radius);
 	void GetQuadsRectangle(QuadFieldQuery& qfq, const float3& mins, const float3& maxs);
 	void GetQuadsOnRay(QuadFieldQuery& qfq, const float3& start, const float3& dir, float length);
 
+	/**
+	 * Thread-safe counterparts of GetQuads and GetUnitsExact for parallel
+	 * read-only passes: neither touches the shared vector caches or object
+	 * tempNum's, results go into caller-owned storage in the same order as
+	 * the regular queries would produce them
+	 */
+	void GetQuadsMT(std::vector<int>& quads, float3 pos, float radius) const;
+	void GetUnitsExactMT(std::vector<CUnit*>& units, std::vector<int>& quads, const float3& pos, float radius) const;
+
 	void GetUnitsAndFeaturesColVol(
 		const float3& pos,
 		const float radius,
@@ -157,7 +189,13 @@ public:
 	void MovedUnit(CUnit* unit);
 	void RemoveUnit(CUnit* unit);
 
+	/// number of MovedUnit calls so far; units get these when created or
+	/// moved outside their moveType's Update (e.g. teleported by Lua)
+	std::uint32_t GetNumMovedUnits() const { return numMovedUnits; }
+
 	void AddFeature(CFeature* feature);
+	/// same as calling AddFeature for each element in order, but reserves quad storage once
+	void AddFeatures(const std::vector<CFeature*>& features);
 	void RemoveFeature(CFeature* feature);
 
 	void MovedProjectile(CProjectile* projectile);
@@ -184,6 +222,7 @@ public:
 		Quad& operator = (const Quad& q) = delete;
 		Quad& operator = (Quad&& q) {
 			units = std::move(q.units);
+			mobileUnits = std::move(q.mobileUnits);
 			teamUnits = std::move(q.teamUnits);
 			features = std::move(q.features);
 			projectiles = std::move(q.projectiles);
@@ -195,6 +234,7 @@ public:
 		void Resize(int numAllyTeams) { teamUnits.resize(numAllyTeams); }
 		void Clear() {
 			units.clear();
+			mobileUnits.clear();
 			// reuse inner vectors when reloading
 			// teamUnits.clear();
 			for (auto& v: teamUnits) {
@@ -207,6 +247,9 @@ public:
 
 	public:
 		std::vector<CUnit*> units;
+		// subset of units that are not immobile; the Get*Exact queries
+		// take immobile ones from the static index instead of the quads
+		std::vector<CUnit*> mobileUnits;
 		std::vector< std::vector<CUnit*> > teamUnits;
 		std::vector<CFeature*> features;
 		std::vector<CProjectile*> projectiles;
@@ -223,21 +266,56 @@ public:
 	}
 
 
+	/// number of quads in the fine level, GetQuadAt and GetNumQuads{X,Z} only cover these
 	int GetNumQuadsX() const { return numQuadsX; }
 	int GetNumQuadsZ() const { return numQuadsZ; }
+	/// indices at or above this (returned by the Get*Quads* functions) belong to the coarse level
+	int GetNumBaseQuads() const { return (numQuadsX * numQuadsZ); }
 
 	int GetQuadSizeX() const { return quadSizeX; }
 	int GetQuadSizeZ() const { return quadSizeZ; }
 
+	/// quads and their object lists, in bytes
+	size_t GetMemFootPrint() const;
+
 	constexpr static unsigned int BASE_QUAD_SIZE = 128;
+	/// each coarse quad spans COARSE_QUAD_SCALE^2 fine quads
+	constexpr static unsigned int COARSE_QUAD_SCALE = 4;
 
-private:
 	int2 WorldPosToQuadField(const float3 p) const;
 	int WorldPosToQuadFieldIdx(const float3 p) const;
 
+private:
+	/**
+	 * Two-level layout: objects with a radius above one fine quad are
+	 * stored only in the coarse level (so they are inserted into a few
+	 * coarse quads instead of dozens of fine ones), everything else only
+	 * in the fine level. Both levels live in baseQuads, coarse quads
+	 * after the fine ones, so quad indices stay unique and ascending and
+	 * range queries simply return quads of both levels.
+	 */
+	bool IsCoarseObject(float radius) const { return (radius > quadSizeX); }
+	bool IsCoarseProjectile(const CProjectile* p) const;
+
+	int WorldPosToCoarseQuadIdx(const float3 p) const;
+	int GetProjectileQuadIdx(const CProjectile* p) const;
+
+	void GetLevelQuads(std::vector<int>& quads, float3 pos, float radius, bool coarse) const;
+	void GetLevelQuadsRectangle(std::vector<int>& quads, const float3& mins, const float3& maxs, bool coarse) const;
+	void GetLevelQuadsOnRay(std::vector<int>& quads, const float3& start, const float3& dir, float length, bool coarse) const;
+
+	/// quads an object of the given radius is stored in (only one level)
+	void GetInsertQuads(QuadFieldQuery& qfq, const float3& pos, float radius);
+
+	void InsertQuadUnit(int qi, CUnit* unit);
+	void EraseQuadUnit(int qi, CUnit* unit);
+
 private:
 	std::vector<Quad> baseQuads;
 
+	// immobile units, also present in baseQuads[i].units
+	CStaticObjectIndex staticUnits;
+
 	// preallocated vectors for Get*Exact functions
 	QueryVectorCache<CUnit*> tempUnits;
 	QueryVectorCache<CFeature*> tempFeatures;
@@ -252,6 +330,14 @@ private:
 
 	int quadSizeX;
 	int quadSizeZ;
+
+	int numCoarseQuadsX;
+	int numCoarseQuadsZ;
+
+	std::uint32_t numMovedUnits = 0;
+
+	// queries skip the coarse level until some object is stored there
+	bool coarseLevelUsed;
 };
 
 extern CQuadField quadField;
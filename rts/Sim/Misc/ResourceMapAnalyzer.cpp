@@ -18,10 +18,13 @@ using std::fclose;
 #include "Game/GameSetup.h"
 #include "Map/MapInfo.h"
 #include "Map/MetalMap.h"
+#include "System/StringUtil.h"
+#include "System/FileSystem/ArchiveScanner.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
 #include <stdexcept>
 
@@ -170,79 +173,53 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 		return;
 
 	// Now work out how much resources each spot can make
-	// by adding up the resources from nearby spots
-	for (int y = 0; y < mapHeight; y++) {
-		for (int x = 0; x < mapWidth; x++) {
-			totalResources = 0;
-
-			// first spot needs full calculation
-			if (x == 0 && y == 0)
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight){
-						for (int sx = x - xend[a]; sx <= x + xend[a]; sx++) {
-							if (sx >= 0 && sx < mapWidth) {
-								// get the resources from all pixels around the extractor radius
-								totalResources += rexArrayA[sy * mapWidth + sx];
-							}
-						}
-					}
-				}
-
-			// quick calc test
-			if (x > 0) {
-				totalResources = tempAverage[y * mapWidth + x - 1];
-				for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
-					if (sy >= 0 && sy < mapHeight) {
-						const int addX = x + xend[a];
-						const int remX = x - xend[a] - 1;
-
-						if (addX < mapWidth) {
-							totalResources += rexArrayA[sy * mapWidth + addX];
-						}
-						if (remX >= 0) {
-							totalResources -= rexArrayA[sy * mapWidth + remX];
-						}
-					}
-				}
-			} else if (y > 0) {
-				// x == 0 here
-				totalResources = tempAverage[(y - 1) * mapWidth];
-				// remove the top half
-				int a = xtractorRadius;
-
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int remY = y - xend[a] - 1;
-
-						if (remY >= 0) {
-							totalResources -= rexArrayA[remY * mapWidth + sx];
-						}
+	// by adding up the resources from nearby spots; every
+	// row starts with a full window sum and then slides it
+	// (integer sums, so equal to sliding down column 0) and
+	// is independent of all others
+	std::vector<int> rowMaxResource(mapHeight, 0);
+
+	for_mt(0, mapHeight, [&](const int y) {
+		int rowResources = 0;
+
+		for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+			if (sy >= 0 && sy < mapHeight) {
+				for (int sx = -xend[a]; sx <= xend[a]; sx++) {
+					if (sx >= 0 && sx < mapWidth) {
+						// get the resources from all pixels around the extractor radius
+						rowResources += rexArrayA[sy * mapWidth + sx];
 					}
 				}
+			}
+		}
 
-				// add the bottom half
-				a = xtractorRadius;
+		tempAverage[y * mapWidth] = rowResources;
+		rowMaxResource[y] = rowResources;
 
-				for (int sx = 0; sx <= xtractorRadius;  sx++, a++) {
-					if (sx < mapWidth) {
-						const int addY = y + xend[a];
+		for (int x = 1; x < mapWidth; x++) {
+			for (int sy = y - xtractorRadius, a = 0;  sy <= y + xtractorRadius;  sy++, a++) {
+				if (sy >= 0 && sy < mapHeight) {
+					const int addX = x + xend[a];
+					const int remX = x - xend[a] - 1;
 
-						if (addY < mapHeight) {
-							totalResources += rexArrayA[addY * mapWidth + sx];
-						}
+					if (addX < mapWidth) {
+						rowResources += rexArrayA[sy * mapWidth + addX];
+					}
+					if (remX >= 0) {
+						rowResources -= rexArrayA[sy * mapWidth + remX];
 					}
 				}
 			}
 
 			// set that spot's resource making ability
-			// (divide by cells to values are small)
-			tempAverage[y * mapWidth + x] = totalResources;
-
-			if (maxResource < totalResources) {
-				// find the spot with the highest resource value to set as the map's max
-				maxResource = totalResources;
-			}
+			tempAverage[y * mapWidth + x] = rowResources;
+			rowMaxResource[y] = std::max(rowMaxResource[y], rowResources);
 		}
+	});
+
+	// find the spot with the highest resource value to set as the map's max
+	for (int y = 0; y < mapHeight; y++) {
+		maxResource = std::max(maxResource, rowMaxResource[y]);
 	}
 
 	// make a list for the distribution of values
@@ -498,6 +475,30 @@ void CResourceMapAnalyzer::GetResourcePoints() {
 }
 
 
+struct CResourceMapAnalyzer::CacheHeader {
+	// bumped whenever the analysis or the file layout changes
+	static constexpr uint32_t VERSION = 2;
+
+	uint32_t version;
+	uint32_t mapChecksum;
+	int32_t mapWidth;
+	int32_t mapHeight;
+	float extractorRadius;
+	float maxWorth;
+	int32_t numSpots;
+	float averageIncome;
+
+	bool operator == (const CacheHeader& h) const {
+		if (version != h.version || mapChecksum != h.mapChecksum)
+			return false;
+		if (mapWidth != h.mapWidth || mapHeight != h.mapHeight)
+			return false;
+
+		return (extractorRadius == h.extractorRadius && maxWorth == h.maxWorth);
+	}
+};
+
+
 template<typename T>
 static inline void writeToFile(const T& value, FILE* file) {
 
@@ -516,16 +517,17 @@ void CResourceMapAnalyzer::SaveResourceMap() {
 			throw std::runtime_error("failed to open file for writing");
 
 		assert(numSpotsFound != -1);
-		writeToFile(numSpotsFound, saveFile);
-		writeToFile(averageIncome, saveFile);
-		for (int i = 0; i < numSpotsFound; i++) {
-			writeToFile(vectoredSpots[i], saveFile);
-		}
+		writeToFile(GetCacheHeader(), saveFile);
+
+		// spots are written as one block, they are read back the same way
+		if (numSpotsFound > 0 && fwrite(vectoredSpots.data(), sizeof(float3), numSpotsFound, saveFile) != numSpotsFound)
+			throw std::runtime_error("failed to write spots to file");
 	} catch (const std::runtime_error& err) {
 		LOG_L(L_WARNING, "Failed to save the analyzed resource-map to file %s, reason: %s", cacheFileName.c_str(), err.what());
 	}
 
-	fclose(saveFile);
+	if (saveFile != nullptr)
+		fclose(saveFile);
 }
 
 static void fileReadChecked(void* buf, size_t size, size_t count, FILE* fstream) {
@@ -545,15 +547,27 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 
 	if (cacheFile != nullptr) {
 		try {
-			fileReadChecked(&numSpotsFound, sizeof(int), 1, cacheFile);
+			CacheHeader header;
+			fileReadChecked(&header, sizeof(header), 1, cacheFile);
+
+			// written for another map revision, game (extractor radius) or engine version
+			if (!(header == GetCacheHeader()) || header.numSpots < 0)
+				throw std::runtime_error("stale cache");
+
+			numSpotsFound = header.numSpots;
+			averageIncome = header.averageIncome;
+
 			vectoredSpots.resize(numSpotsFound);
-			fileReadChecked(&averageIncome, sizeof(float), 1, cacheFile);
-			for (int i = 0; i < numSpotsFound; i++) {
-				fileReadChecked(&vectoredSpots[i], sizeof(float3), 1, cacheFile);
-			}
+			fileReadChecked(vectoredSpots.data(), sizeof(float3), numSpotsFound, cacheFile);
+
 			loaded = true;
 		} catch (const std::runtime_error& err) {
 			LOG_L(L_WARNING, "Failed to load the resource map cache from file %s: %s", cacheFileName.c_str(), err.what());
+
+			numSpotsFound = -1;
+			averageIncome = 0.0f;
+
+			vectoredSpots.clear();
 		}
 		fclose(cacheFile);
 	}
@@ -562,10 +576,30 @@ bool CResourceMapAnalyzer::LoadResourceMap() {
 }
 
 
+CResourceMapAnalyzer::CacheHeader CResourceMapAnalyzer::GetCacheHeader() const {
+
+	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
+
+	CacheHeader header;
+	header.version = CacheHeader::VERSION;
+	header.mapChecksum = archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName);
+	header.mapWidth = mapWidth;
+	header.mapHeight = mapHeight;
+	header.extractorRadius = extractorRadius;
+	header.maxWorth = resource->maxWorth;
+	header.numSpots = numSpotsFound;
+	header.averageIncome = averageIncome;
+
+	return header;
+}
+
 std::string CResourceMapAnalyzer::GetCacheFileName() const {
 
 	const CResourceDescription* resource = resourceHandler->GetResource(resourceId);
-	std::string absFile = CACHE_BASE + gameSetup->mapName + resource->name;
+
+	// keyed by map content rather than name, the header guards the rest
+	const uint32_t mapChecksum = archiveScanner->GetArchiveCompleteChecksum(gameSetup->mapName);
+	const std::string absFile = CACHE_BASE + IntToString(mapChecksum, "%08x") + "_" + resource->name;
 
 	return absFile;
 }
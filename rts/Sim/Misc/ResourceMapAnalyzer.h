@@ -33,10 +33,13 @@ public:
 	int GetNumSpots() const { return numSpotsFound; }
 
 private:
+	struct CacheHeader;
+
 	void GetResourcePoints();
 	void SaveResourceMap();
 	bool LoadResourceMap();
 
+	CacheHeader GetCacheHeader() const;
 	std::string GetCacheFileName() const;
 
 	int resourceId;
@@ -1,13 +1,16 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <vector>
 #include <cassert>
+#include <cmath>
 #include <limits>
 
 #include "SmoothHeightMesh.h"
 
 #include "Map/Ground.h"
 #include "Map/ReadMap.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "System/float3.h"
 #include "System/SpringMath.h"
 #include "System/TimeProfiler.h"
@@ -20,20 +23,23 @@ SmoothHeightMesh smoothGround;
 
 static float Interpolate(float x, float y, const int maxx, const int maxy, const float res, const float* heightmap)
 {
-	x = Clamp(x / res, 0.0f, maxx - 1.0f);
-	y = Clamp(y / res, 0.0f, maxy - 1.0f);
+	// the mesh has (maxx + 1) * (maxy + 1) vertices
+	const int lineSize = maxx + 1;
+
+	x = Clamp(x / res, 0.0f, maxx * 1.0f);
+	y = Clamp(y / res, 0.0f, maxy * 1.0f);
 	const int sx = x;
 	const int sy = y;
 	const float dx = (x - sx);
 	const float dy = (y - sy);
 
-	const int sxp1 = std::min(sx + 1, maxx - 1);
-	const int syp1 = std::min(sy + 1, maxy - 1);
+	const int sxp1 = std::min(sx + 1, maxx);
+	const int syp1 = std::min(sy + 1, maxy);
 
-	const float& h1 = heightmap[sx   + sy   * maxx];
-	const float& h2 = heightmap[sxp1 + sy   * maxx];
-	const float& h3 = heightmap[sx   + syp1 * maxx];
-	const float& h4 = heightmap[sxp1 + syp1 * maxx];
+	const float& h1 = heightmap[sx   + sy   * lineSize];
+	const float& h2 = heightmap[sxp1 + sy   * lineSize];
+	const float& h3 = heightmap[sx   + syp1 * lineSize];
+	const float& h4 = heightmap[sxp1 + syp1 * lineSize];
 
 	const float hi1 = mix(h1, h2, dx);
 	const float hi2 = mix(h3, h4, dx);
@@ -56,6 +62,11 @@ void SmoothHeightMesh::Kill() {
 
 	mesh.clear();
 	origMesh.clear();
+
+	groundHeights.clear();
+	colsMaxima.clear();
+	blurBuffers[0].clear();
+	blurBuffers[1].clear();
 }
 
 
@@ -91,301 +102,138 @@ float SmoothHeightMesh::SetMaxHeight(int index, float h)
 
 
 
-inline static void FindMaximumColumnHeights(
-	const int maxx,
-	const int maxy,
+// running maximum over windows of <2 * winSize + 1> lines (van Herk / Gil-Werman)
+// each line holds <numLanes> consecutive floats, lines outside [0, numLines) count
+// as -inf; the per-lane inner loops run over whole lines when filtering vertically
+// and are vectorized by the compiler
+static void RunningMaxLines(
+	const float* src,
+	      float* dst,
+	const int numLines,
+	const int numLanes,
 	const int winSize,
-	const float resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
+	std::vector<float>& prefMaxima,
+	std::vector<float>& suffMaxima
 ) {
-	// initialize the algorithm: find the maximum
-	// height per column and the corresponding row
-	for (int y = 0; y <= std::min(maxy, winSize); ++y) {
-		for (int x = 0; x <= maxx; ++x)  {
-			const float curx = x * resolution;
-			const float cury = y * resolution;
-			const float curh = CGround::GetHeightAboveWater(curx, cury);
-
-			if (curh > colsMaxima[x]) {
-				colsMaxima[x] = curh;
-				maximaRows[x] = y;
-			}
-		}
-	}
-}
+	constexpr float minHeight = -std::numeric_limits<float>::max();
 
-inline static void AdvanceMaximaRows(
-	const int y,
-	const int maxx,
-	const float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<int>& maximaRows
-) {
-	const float cury = y * resolution;
+	const int winLen = 2 * winSize + 1;
+	const int numBlocks = (numLines + 2 * winSize + winLen - 1) / winLen;
+	const int numPadLines = numBlocks * winLen;
 
-	// try to advance rows if they're equal to current maximum but are further away
-	for (int x = 0; x <= maxx; ++x) {
-		if (maximaRows[x] == (y - 1)) {
-			const float curx = x * resolution;
-			const float curh = CGround::GetHeightAboveWater(curx, cury);
+	prefMaxima.resize(numPadLines * numLanes);
+	suffMaxima.resize(numPadLines * numLanes);
 
-			if (curh == colsMaxima[x]) {
-				maximaRows[x] = y;
-			}
+	// padded line i corresponds to source line (i - winSize)
+	const auto MaxLine = [&](float* out, const float* acc, int i) {
+		const int line = i - winSize;
 
-			assert(curh <= colsMaxima[x]);
+		if (line < 0 || line >= numLines) {
+			if (acc == nullptr) {
+				std::fill(out, out + numLanes, minHeight);
+			} else {
+				std::copy(acc, acc + numLanes, out);
+			}
+			return;
 		}
-	}
-}
 
+		const float* in = &src[line * numLanes];
 
-
-inline static void FindRadialMaximum(
-	int y,
-	int maxx,
-	int winSize,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	      std::vector<float>& mesh
-) {
-	const float cury = y * resolution;
-
-	for (int x = 0; x <= maxx; ++x) {
-		float maxRowHeight = -std::numeric_limits<float>::max();
-
-		// find current maximum within radius smoothRadius
-		// (in every column stack) along the current row
-		const int startx = std::max(x - winSize, 0);
-		const int endx = std::min(maxx, x + winSize);
-
-		for (int i = startx; i <= endx; ++i) {
-			assert(i >= 0);
-			assert(i <= maxx);
-			assert(CGround::GetHeightReal(i * resolution, cury) <= colsMaxima[i]);
-
-			maxRowHeight = std::max(colsMaxima[i], maxRowHeight);
+		if (acc == nullptr) {
+			std::copy(in, in + numLanes, out);
+			return;
 		}
 
-#ifndef NDEBUG
-		const float curx = x * resolution;
-		assert(maxRowHeight <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-		assert(maxRowHeight >= CGround::GetHeightAboveWater(curx, cury));
-
-	#ifdef SMOOTHMESH_CORRECTNESS_CHECK
-		// naive algorithm
-		float maxRowHeightAlt = -std::numeric_limits<float>::max();
-
-		for (float y1 = cury - smoothRadius; y1 <= cury + smoothRadius; y1 += resolution) {
-			for (float x1 = curx - smoothRadius; x1 <= curx + smoothRadius; x1 += resolution) {
-				maxRowHeightAlt = std::max(maxRowHeightAlt, CGround::GetHeightAboveWater(x1, y1));
-			}
+		for (int k = 0; k < numLanes; ++k) {
+			out[k] = std::max(acc[k], in[k]);
 		}
+	};
 
-		assert(maxRowHeightAlt == maxRowHeight);
-	#endif
-#endif
+	for (int b = 0; b < numBlocks; ++b) {
+		const int i0 = b * winLen;
+		const int i1 = i0 + winLen - 1;
 
-		mesh[x + y * maxx] = maxRowHeight;
-	}
-}
-
-
-
-inline static void FixRemainingMaxima(
-	const int y,
-	const int maxx,
-	const int maxy,
-	const int winSize,
-	const float resolution,
-	std::vector<float>& colsMaxima,
-	std::vector<int>& maximaRows
-) {
-	// fix remaining maximums after a pass
-	const int nextrow = y + winSize + 1;
-	const float nextrowy = nextrow * resolution;
-
-	for (int x = 0; x <= maxx; ++x) {
-#ifdef _DEBUG
-		for (int y1 = std::max(0, y - winSize); y1 <= std::min(maxy, y + winSize); ++y1) {
-			assert(CGround::GetHeightReal(x * resolution, y1 * resolution) <= colsMaxima[x]);
+		for (int i = i0; i <= i1; ++i) {
+			MaxLine(&prefMaxima[i * numLanes], (i == i0)? nullptr: &prefMaxima[(i - 1) * numLanes], i);
 		}
-#endif
-		const float curx = x * resolution;
-
-		if (maximaRows[x] <= (y - winSize)) {
-			// find a new maximum if the old one left the window
-			colsMaxima[x] = -std::numeric_limits<float>::max();
-
-			for (int y1 = std::max(0, y - winSize + 1); y1 <= std::min(maxy, nextrow); ++y1) {
-				const float h = CGround::GetHeightAboveWater(curx, y1 * resolution);
-
-				if (h > colsMaxima[x]) {
-					colsMaxima[x] = h;
-					maximaRows[x] = y1;
-				} else if (colsMaxima[x] == h) {
-					// if equal, move as far down as possible
-					maximaRows[x] = y1;
-				}
-			}
-		} else if (nextrow <= maxy) {
-			// else, just check if a new maximum has entered the window
-			const float h = CGround::GetHeightAboveWater(curx, nextrowy);
-
-			if (h > colsMaxima[x]) {
-				colsMaxima[x] = h;
-				maximaRows[x] = nextrow;
-			}
+		for (int i = i1; i >= i0; --i) {
+			MaxLine(&suffMaxima[i * numLanes], (i == i1)? nullptr: &suffMaxima[(i + 1) * numLanes], i);
 		}
+	}
 
-		assert(maximaRows[x] <= nextrow);
-		assert(maximaRows[x] >= y - winSize + 1);
+	// window of output line j spans padded lines [j, j + 2 * winSize]
+	for (int j = 0; j < numLines; ++j) {
+		const float* suff = &suffMaxima[(j              ) * numLanes];
+		const float* pref = &prefMaxima[(j + 2 * winSize) * numLanes];
 
-#ifdef _DEBUG
-		for (int y1 = std::max(0, y - winSize + 1); y1 <= std::min(maxy, y + winSize + 1); ++y1) {
-			assert(colsMaxima[x] >= CGround::GetHeightReal(curx, y1 * resolution));
+		for (int k = 0; k < numLanes; ++k) {
+			dst[j * numLanes + k] = std::max(suff[k], pref[k]);
 		}
-#endif
 	}
 }
 
 
 
-inline static void BlurHorizontal(
+// <src> and <dst> cover <r>, <heights> covers <hr>; every window is clamped to the
+// map as in a full pass, cells whose window also leaves <r> come out wrong but are
+// never part of the final output (see SmoothMeshRect)
+static void BlurRect(
+	const SRectangle& r,
+	const SRectangle& hr,
 	const int maxx,
 	const int maxy,
 	const int blurSize,
-	const float resolution,
-	const std::vector<float>& mesh,
-	      std::vector<float>& smoothed
+	const bool horizontal,
+	const float* heights,
+	const float* src,
+	      float* dst
 ) {
 	const float n = 2.0f * blurSize + 1.0f;
 	const float recipn = 1.0f / n;
-	const int lineSize = maxx + 1;
+	const float maxHeight = readMap->GetCurrMaxHeight();
 
-	for_mt(0, maxy+1, [&](const int y) {
-		float avg = 0.0f;
+	const int sizeX = r.x2 - r.x1 + 1;
+	const int sizeY = r.z2 - r.z1 + 1;
+	const int hgtSizeX = hr.x2 - hr.x1 + 1;
 
-		for (int x = 0; x <= 2 * blurSize; ++x) {
-			avg += mesh[x + y * lineSize];
-		}
+	const int maxc = horizontal? maxx: maxy;
+	const int minr = horizontal? r.x1: r.z1;
+	const int maxr = horizontal? r.x2: r.z2;
+	const int step = horizontal? 1: sizeX;
 
-		for (int x = 0; x <= maxx; ++x) {
-			const int idx = x + y * lineSize;
+	for_mt(0, sizeY, [&](const int ly) {
+		const int y = r.z1 + ly;
 
-			if (x <= blurSize || x > (maxx - blurSize)) {
-				// map-border case
-				smoothed[idx] = 0.0f;
+		for (int lx = 0; lx < sizeX; ++lx) {
+			const int x = r.x1 + lx;
+			const int c = horizontal? x: y;
+			const int idx = lx + ly * sizeX;
 
-				const int xstart = std::max(x - blurSize, 0);
-				const int xend   = std::min(x + blurSize, maxx);
+			const int cmin = std::max(c - blurSize, 0);
+			const int cmax = std::min(c + blurSize, maxc);
 
-				for (int x1 = xstart; x1 <= xend; ++x1) {
-					smoothed[idx] += mesh[x1 + y * lineSize];
-				}
+			const int cbeg = std::max(cmin, minr);
+			const int cend = std::min(cmax, maxr);
 
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = smoothed[idx] / (xend - xstart + 1);
+			float sum = 0.0f;
 
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			} else {
-				// non-border case
-				avg += mesh[idx + blurSize] - mesh[idx - blurSize - 1];
-
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = recipn * avg;
-
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
+			for (int i = idx + (cbeg - c) * step, j = cbeg; j <= cend; i += step, ++j) {
+				sum += src[i];
 			}
 
-			assert(smoothed[idx] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(smoothed[idx] >=          readMap->GetCurrMinHeight()       );
-		}
-	});
-}
+			// map-border windows are averaged over their clamped size
+			const bool border = (c <= blurSize || c > (maxc - blurSize));
 
-inline static void BlurVertical(
-	const int maxx,
-	const int maxy,
-	const int blurSize,
-	const float resolution,
-	const std::vector<float>& mesh,
-	      std::vector<float>& smoothed
-) {
-	const float n = 2.0f * blurSize + 1.0f;
-	const float recipn = 1.0f / n;
-	const int lineSize = maxx + 1;
-
-	for_mt(0, maxx+1, [&](const int x) {
-		float avg = 0.0f;
-
-		for (int y = 0; y <= 2 * blurSize; ++y) {
-			avg += mesh[x + y * lineSize];
-		}
-
-		for (int y = 0; y <= maxy; ++y) {
-			const int idx = x + y * lineSize;
-
-			if (y <= blurSize || y > (maxy - blurSize)) {
-				// map-border case
-				smoothed[idx] = 0.0f;
-
-				const int ystart = std::max(y - blurSize, 0);
-				const int yend   = std::min(y + blurSize, maxy);
-
-				for (int y1 = ystart; y1 <= yend; ++y1) {
-					smoothed[idx] += mesh[x + y1 * lineSize];
-				}
-
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = smoothed[idx] / (yend - ystart + 1);
-
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			} else {
-				// non-border case
-				avg += mesh[x + (y + blurSize) * lineSize] - mesh[x + (y - blurSize - 1) * lineSize];
-
-				const float gh = CGround::GetHeightAboveWater(x * resolution, y * resolution);
-				const float sh = recipn * avg;
-
-				smoothed[idx] = std::min(readMap->GetCurrMaxHeight(), std::max(gh, sh));
-			}
+			const float gh = heights[(x - hr.x1) + (y - hr.z1) * hgtSizeX];
+			const float sh = border? (sum / (cmax - cmin + 1)): (recipn * sum);
 
-			assert(smoothed[idx] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(smoothed[idx] >=          readMap->GetCurrMinHeight()       );
+			dst[idx] = std::min(maxHeight, std::max(gh, sh));
 		}
 	});
 }
 
 
 
-inline static void CheckInvariants(
-	int y,
-	int maxx,
-	int maxy,
-	int winSize,
-	float resolution,
-	const std::vector<float>& colsMaxima,
-	const std::vector<int>& maximaRows
-) {
-	// check invariants
-	if (y < maxy) {
-		for (int x = 0; x <= maxx; ++x) {
-			assert(maximaRows[x] > y - winSize);
-			assert(maximaRows[x] <= maxy);
-			assert(colsMaxima[x] <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
-			assert(colsMaxima[x] >=          readMap->GetCurrMinHeight()       );
-		}
-	}
-	for (int y1 = std::max(0, y - winSize + 1); y1 <= std::min(maxy, y + winSize + 1); ++y1) {
-		for (int x1 = 0; x1 <= maxx; ++x1) {
-			assert(CGround::GetHeightReal(x1 * resolution, y1 * resolution) <= colsMaxima[x1]);
-		}
-	}
-}
-
-
-
 void SmoothHeightMesh::MakeSmoothMesh()
 {
 	ScopedOnceTimer timer("SmoothHeightMesh::MakeSmoothMesh");
@@ -397,44 +245,109 @@ void SmoothHeightMesh::MakeSmoothMesh()
 	//
 	//   row-width (number of height-value corners per row) is (maxx + 1)
 	//   col-height (number of height-value corners per col) is (maxy + 1)
-	//
-	//   1st row has indices [maxx*(  0) + (  0), maxx*(1) + (  0)] inclusive
-	//   2nd row has indices [maxx*(  1) + (  1), maxx*(2) + (  1)] inclusive
-	//   3rd row has indices [maxx*(  2) + (  2), maxx*(3) + (  2)] inclusive
-	//   ...
-	//   Nth row has indices [maxx*(N-1) + (N-1), maxx*(N) + (N-1)] inclusive
-	//
-	// use sliding window of maximums to reduce computational complexity
-	const     int winSize = smoothRadius / resolution;
-	constexpr int blurSize = 3;
-
 	assert(mesh.empty());
 	mesh.resize((maxx + 1) * (maxy + 1), 0.0f);
 	origMesh.resize((maxx + 1) * (maxy + 1), 0.0f);
 
-	colsMaxima.clear();
-	colsMaxima.resize(maxx + 1, -std::numeric_limits<float>::max());
-	maximaRows.clear();
-	maximaRows.resize(maxx + 1, -1);
+	SmoothMeshRect({0, 0, maxx, maxy});
+}
+
+void SmoothHeightMesh::UpdateSmoothMesh(const SRectangle& hgtMapRect)
+{
+	if (mesh.empty())
+		return;
 
-	FindMaximumColumnHeights(maxx, maxy, winSize, resolution, colsMaxima, maximaRows);
+	SCOPED_TIMER("Sim::SmoothHeightMesh::Update");
 
-	for (int y = 0; y <= maxy; ++y) {
-		AdvanceMaximaRows(y, maxx, resolution, colsMaxima, maximaRows);
-		FindRadialMaximum(y, maxx, winSize, resolution, colsMaxima, mesh);
-		FixRemainingMaxima(y, maxx, maxy, winSize, resolution, colsMaxima, maximaRows);
+	// mesh vertices whose ground samples lie inside the (corner) heightmap rectangle
+	const int x1 = int(std::floor(hgtMapRect.x1 * SQUARE_SIZE / resolution));
+	const int z1 = int(std::floor(hgtMapRect.z1 * SQUARE_SIZE / resolution));
+	const int x2 = int(std::ceil(hgtMapRect.x2 * SQUARE_SIZE / resolution));
+	const int z2 = int(std::ceil(hgtMapRect.z2 * SQUARE_SIZE / resolution));
 
-#ifdef _DEBUG
-		CheckInvariants(y, maxx, maxy, winSize, resolution, colsMaxima, maximaRows);
-#endif
+	// every vertex whose window-maximum or blur passes can see them
+	const int range = int(smoothRadius / resolution) + BLUR_SIZE * NUM_BLURS;
+
+	SmoothMeshRect({
+		std::max(x1 - range, 0),
+		std::max(z1 - range, 0),
+		std::min(x2 + range, maxx),
+		std::min(z2 + range, maxy)
+	});
+}
+
+void SmoothHeightMesh::SmoothMeshRect(const SRectangle& rect)
+{
+	// use a sliding window of maximums to reduce computational complexity,
+	// then smooth those with approximate Gaussian blur passes; the maxima
+	// are needed <blurRange> vertices beyond <rect> and ground heights are
+	// needed <winSize> vertices beyond those
+	const int winSize = smoothRadius / resolution;
+	const int blurRange = BLUR_SIZE * NUM_BLURS;
+
+	const SRectangle maxRect = {
+		std::max(rect.x1 - blurRange, 0),
+		std::max(rect.z1 - blurRange, 0),
+		std::min(rect.x2 + blurRange, maxx),
+		std::min(rect.z2 + blurRange, maxy)
+	};
+	const SRectangle hgtRect = {
+		std::max(maxRect.x1 - winSize, 0),
+		std::max(maxRect.z1 - winSize, 0),
+		std::min(maxRect.x2 + winSize, maxx),
+		std::min(maxRect.z2 + winSize, maxy)
+	};
+
+	const int hgtSizeX = hgtRect.x2 - hgtRect.x1 + 1;
+	const int hgtSizeY = hgtRect.z2 - hgtRect.z1 + 1;
+	const int maxSizeX = maxRect.x2 - maxRect.x1 + 1;
+	const int maxSizeY = maxRect.z2 - maxRect.z1 + 1;
+
+	groundHeights.resize(hgtSizeX * hgtSizeY);
+	colsMaxima.resize(hgtSizeX * hgtSizeY);
+	rowMaxima.resize(hgtSizeX);
+	blurBuffers[0].resize(maxSizeX * maxSizeY);
+	blurBuffers[1].resize(maxSizeX * maxSizeY);
+
+	for_mt(0, hgtSizeY, [&](const int ly) {
+		const float cury = (hgtRect.z1 + ly) * resolution;
+
+		for (int lx = 0; lx < hgtSizeX; ++lx) {
+			groundHeights[lx + ly * hgtSizeX] = CGround::GetHeightAboveWater((hgtRect.x1 + lx) * resolution, cury);
+		}
+	});
+
+	// maximum per column over the window rows, then per row over the window columns
+	RunningMaxLines(groundHeights.data(), colsMaxima.data(), hgtSizeY, hgtSizeX, winSize, prefMaxima, suffMaxima);
+
+	for (int y = maxRect.z1; y <= maxRect.z2; ++y) {
+		const float* cols = &colsMaxima[(y - hgtRect.z1) * hgtSizeX];
+		      float* maxs = &blurBuffers[0][(y - maxRect.z1) * maxSizeX];
+
+		RunningMaxLines(cols, rowMaxima.data(), hgtSizeX, 1, winSize, prefMaxima, suffMaxima);
+		std::copy(&rowMaxima[maxRect.x1 - hgtRect.x1], &rowMaxima[maxRect.x1 - hgtRect.x1] + maxSizeX, maxs);
 	}
 
-	// actually smooth with approximate Gaussian blur passes
-	for (int numBlurs = 3; numBlurs > 0; --numBlurs) {
-		BlurHorizontal(maxx, maxy, blurSize, resolution, mesh, origMesh); mesh.swap(origMesh);
-		BlurVertical(maxx, maxy, blurSize, resolution, mesh, origMesh); mesh.swap(origMesh);
+	for (int numBlurs = NUM_BLURS; numBlurs > 0; --numBlurs) {
+		BlurRect(maxRect, hgtRect, maxx, maxy, BLUR_SIZE,  true, groundHeights.data(), blurBuffers[0].data(), blurBuffers[1].data());
+		BlurRect(maxRect, hgtRect, maxx, maxy, BLUR_SIZE, false, groundHeights.data(), blurBuffers[1].data(), blurBuffers[0].data());
 	}
 
-	// <mesh> now contains the final smoothed heightmap, save it in origMesh
-	std::copy(mesh.begin(), mesh.end(), origMesh.begin());
+	const int lineSize = maxx + 1;
+
+	for (int y = rect.z1; y <= rect.z2; ++y) {
+		for (int x = rect.x1; x <= rect.x2; ++x) {
+			const int idx = x + y * lineSize;
+			const float h = blurBuffers[0][(x - maxRect.x1) + (y - maxRect.z1) * maxSizeX];
+
+			assert(h <= std::max(readMap->GetCurrMaxHeight(), 0.0f));
+			assert(h >=          readMap->GetCurrMinHeight()       );
+
+			// vertices changed through Lua keep their height, origMesh is what gets reverted to
+			if (mesh[idx] == origMesh[idx])
+				mesh[idx] = h;
+
+			origMesh[idx] = h;
+		}
+	}
 }
@@ -5,6 +5,8 @@
 
 #include <vector>
 
+#include "System/Rectangle.h"
+
 class CGround;
 
 /**
@@ -16,6 +18,9 @@ public:
 	void Init(float mx, float my, float res, float smoothRad);
 	void Kill();
 
+	/// recomputes the vertices affected by a change of the (corner) heightmap inside <hgtMapRect>
+	void UpdateSmoothMesh(const SRectangle& hgtMapRect);
+
 	float GetHeight(float x, float y);
 	float GetHeightAboveWater(float x, float y);
 	float SetHeight(int index, float h);
@@ -33,6 +38,10 @@ public:
 
 private:
 	void MakeSmoothMesh();
+	void SmoothMeshRect(const SRectangle& rect);
+
+	static constexpr int BLUR_SIZE = 3;
+	static constexpr int NUM_BLURS = 3;
 
 	int maxx = 0;
 	int maxy = 0;
@@ -44,8 +53,13 @@ private:
 	std::vector<float> mesh;
 	std::vector<float> origMesh;
 
+	// scratch buffers for SmoothMeshRect
+	std::vector<float> groundHeights;
 	std::vector<float> colsMaxima;
-	std::vector<int> maximaRows;
+	std::vector<float> rowMaxima;
+	std::vector<float> prefMaxima;
+	std::vector<float> suffMaxima;
+	std::vector<float> blurBuffers[2];
 };
 
 extern SmoothHeightMesh smoothGround;
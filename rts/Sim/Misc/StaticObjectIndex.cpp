@@ -0,0 +1,199 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "StaticObjectIndex.h"
+#include "System/SpringMath.h"
+
+#include <cassert>
+#include <limits>
+
+
+static std::uint32_t SpreadBits16(std::uint32_t v)
+{
+	v = (v | (v << 8)) & 0x00FF00FFu;
+	v = (v | (v << 4)) & 0x0F0F0F0Fu;
+	v = (v | (v << 2)) & 0x33333333u;
+	v = (v | (v << 1)) & 0x55555555u;
+	return v;
+}
+
+
+void CStaticObjectIndex::Init(const float2& mapSize)
+{
+	invMapSize = {1.0f / mapSize.x, 1.0f / mapSize.y};
+}
+
+void CStaticObjectIndex::Kill()
+{
+	nodes.clear();
+	entries.clear();
+	pendingEntries.clear();
+	unitSlots.clear();
+
+	numDeadEntries = 0;
+}
+
+
+void CStaticObjectIndex::Update(CUnit* unit, const float3& pos, float radius, int unitID)
+{
+	const int slot = GetSlot(unitID);
+
+	if (slot > 0) {
+		Entry& e = entries[slot - 1];
+
+		// nothing changed (the common case, quads are updated far more often)
+		if (e.pos == pos && e.radius == radius)
+			return;
+	}
+	if (slot < 0) {
+		// pending entries are not part of the tree, update in place
+		Entry& e = pendingEntries[-slot - 1];
+
+		e.pos = pos;
+		e.radius = radius;
+		return;
+	}
+
+	if (slot != 0)
+		Remove(unitID);
+
+	pendingEntries.push_back({pos, radius, unit, unitID, GetSortKey(pos)});
+	SetSlot(unitID, -int(pendingEntries.size()));
+
+	if (pendingEntries.size() <= std::max(MIN_REBUILD_SIZE, unsigned(entries.size() >> 4)))
+		return;
+
+	Rebuild();
+}
+
+void CStaticObjectIndex::Remove(int unitID)
+{
+	const int slot = GetSlot(unitID);
+
+	if (slot == 0)
+		return;
+
+	SetSlot(unitID, 0);
+
+	if (slot < 0) {
+		// swap-erase, repoint the moved entry
+		const unsigned int idx = -slot - 1;
+
+		if (idx != (pendingEntries.size() - 1)) {
+			pendingEntries[idx] = pendingEntries.back();
+			SetSlot(pendingEntries[idx].unitID, -int(idx + 1));
+		}
+
+		pendingEntries.pop_back();
+		return;
+	}
+
+	// tombstone; tree bounds stay conservative until the next rebuild
+	entries[slot - 1].unit = nullptr;
+	numDeadEntries += 1;
+
+	if (numDeadEntries <= std::max(MIN_REBUILD_SIZE, unsigned(entries.size() >> 2)))
+		return;
+
+	Rebuild();
+}
+
+
+std::uint32_t CStaticObjectIndex::GetSortKey(const float3& pos) const
+{
+	const std::uint32_t x = Clamp(pos.x * invMapSize.x, 0.0f, 1.0f) * 65535.0f;
+	const std::uint32_t z = Clamp(pos.z * invMapSize.y, 0.0f, 1.0f) * 65535.0f;
+
+	return (SpreadBits16(x) | (SpreadBits16(z) << 1));
+}
+
+void CStaticObjectIndex::SetSlot(int unitID, int slot)
+{
+	if (size_t(unitID) >= unitSlots.size())
+		unitSlots.resize(unitID + 1, 0);
+
+	unitSlots[unitID] = slot;
+}
+
+
+void CStaticObjectIndex::Rebuild()
+{
+	// compact live entries and merge in the pending ones
+	entries.erase(std::remove_if(entries.begin(), entries.end(), [](const Entry& e) { return (e.unit == nullptr); }), entries.end());
+	entries.insert(entries.end(), pendingEntries.begin(), pendingEntries.end());
+
+	pendingEntries.clear();
+	nodes.clear();
+
+	numDeadEntries = 0;
+
+	// unit ID breaks ties, the order must not depend on prior layout
+	std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+		return ((a.sortKey < b.sortKey) || (a.sortKey == b.sortKey && a.unitID < b.unitID));
+	});
+
+	for (size_t i = 0; i < entries.size(); i++) {
+		SetSlot(entries[i].unitID, i + 1);
+	}
+
+	if (entries.empty())
+		return;
+
+	// leaves
+	for (unsigned int i = 0; i < entries.size(); i += LEAF_SIZE) {
+		Node n;
+		n.first = i;
+		n.count = std::min(LEAF_SIZE, unsigned(entries.size() - i));
+		n.leaf = true;
+		n.mins = { std::numeric_limits<float>::max(),  std::numeric_limits<float>::max()};
+		n.maxs = {-std::numeric_limits<float>::max(), -std::numeric_limits<float>::max()};
+		n.posMins = n.mins;
+		n.posMaxs = n.maxs;
+
+		for (unsigned int j = n.first; j < (n.first + n.count); j++) {
+			const Entry& e = entries[j];
+
+			n.mins.x = std::min(n.mins.x, e.pos.x - e.radius);
+			n.mins.y = std::min(n.mins.y, e.pos.z - e.radius);
+			n.maxs.x = std::max(n.maxs.x, e.pos.x + e.radius);
+			n.maxs.y = std::max(n.maxs.y, e.pos.z + e.radius);
+
+			n.posMins.x = std::min(n.posMins.x, e.pos.x);
+			n.posMins.y = std::min(n.posMins.y, e.pos.z);
+			n.posMaxs.x = std::max(n.posMaxs.x, e.pos.x);
+			n.posMaxs.y = std::max(n.posMaxs.y, e.pos.z);
+		}
+
+		nodes.push_back(n);
+	}
+
+	// inner levels, until a single root remains
+	for (unsigned int levelBeg = 0, levelEnd = nodes.size(); (levelEnd - levelBeg) > 1; ) {
+		for (unsigned int i = levelBeg; i < levelEnd; i += NODE_ARITY) {
+			Node n;
+			n.first = i;
+			n.count = std::min(NODE_ARITY, levelEnd - i);
+			n.leaf = false;
+			n.mins = nodes[i].mins;
+			n.maxs = nodes[i].maxs;
+			n.posMins = nodes[i].posMins;
+			n.posMaxs = nodes[i].posMaxs;
+	
+			for (unsigned int j = n.first + 1; j < (n.first + n.count); j++) {
+				n.mins.x = std::min(n.mins.x, nodes[j].mins.x);
+				n.mins.y = std::min(n.mins.y, nodes[j].mins.y);
+				n.maxs.x = std::max(n.maxs.x, nodes[j].maxs.x);
+				n.maxs.y = std::max(n.maxs.y, nodes[j].maxs.y);
+
+				n.posMins.x = std::min(n.posMins.x, nodes[j].posMins.x);
+				n.posMins.y = std::min(n.posMins.y, nodes[j].posMins.y);
+				n.posMaxs.x = std::max(n.posMaxs.x, nodes[j].posMaxs.x);
+				n.posMaxs.y = std::max(n.posMaxs.y, nodes[j].posMaxs.y);
+			}
+
+			nodes.push_back(n);
+		}
+
+		levelBeg = levelEnd;
+		levelEnd = nodes.size();
+	}
+}
@@ -0,0 +1,165 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef STATIC_OBJECT_INDEX_H
+#define STATIC_OBJECT_INDEX_H
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "System/float3.h"
+#include "System/type2.h"
+
+class CUnit;
+
+/**
+ * Packed bounding-volume hierarchy over immobile units (structures), kept
+ * next to the QuadField so range queries do not have to filter through
+ * every structure stored in the quads they overlap.
+ *
+ * Objects are sorted along a Morton curve and packed into leaves of
+ * LEAF_SIZE, which are then grouped NODE_ARITY at a time up to the root;
+ * node bounds are XZ rectangles enclosing the objects' bounding circles.
+ * Insertions go to a small linearly-scanned pending list and removals
+ * leave tombstones, the tree is only rebuilt (on mutation, never during
+ * a query, so concurrent read-only queries are safe) once either grows
+ * past a fraction of its size.
+ *
+ * The index only depends on the sequence of mutations, so query results
+ * come out in the same order on every client.
+ */
+class CStaticObjectIndex {
+public:
+	void Init(const float2& mapSize);
+	void Kill();
+
+	/// inserts or updates <unit>
+	void Update(CUnit* unit, const float3& pos, float radius, int unitID);
+	void Remove(int unitID);
+
+	bool Contains(int unitID) const { return (GetSlot(unitID) != 0); }
+	size_t GetNumObjects() const { return (entries.size() - numDeadEntries + pendingEntries.size()); }
+
+	/**
+	 * calls f(unit) for every object whose bounding circle overlaps the
+	 * circle (or sphere, if <spherical>) of radius <radius> around <pos>
+	 */
+	template<typename F> void QueryCircle(const float3& pos, float radius, bool spherical, F&& f) const {
+		const auto OverlapsNode = [&](const Node& n) {
+			// node bounds already include the objects' radii
+			const float dx = std::max(n.mins.x - pos.x, std::max(0.0f, pos.x - n.maxs.x));
+			const float dz = std::max(n.mins.y - pos.z, std::max(0.0f, pos.z - n.maxs.y));
+			return ((dx * dx + dz * dz) <= (radius * radius));
+		};
+		const auto OverlapsEntry = [&](const Entry& e) {
+			const float totRad = radius + e.radius;
+			const float dstSq = spherical? pos.SqDistance(e.pos): pos.SqDistance2D(e.pos);
+			return (dstSq < (totRad * totRad));
+		};
+
+		Query(OverlapsNode, OverlapsEntry, f);
+	}
+
+	/// calls f(unit) for every object whose position lies inside the (XZ) rectangle
+	template<typename F> void QueryRectangle(const float3& mins, const float3& maxs, F&& f) const {
+		const auto OverlapsNode = [&](const Node& n) {
+			return (n.posMins.x <= maxs.x && n.posMaxs.x >= mins.x && n.posMins.y <= maxs.z && n.posMaxs.y >= mins.z);
+		};
+		const auto OverlapsEntry = [&](const Entry& e) {
+			return (e.pos.x >= mins.x && e.pos.x <= maxs.x && e.pos.z >= mins.z && e.pos.z <= maxs.z);
+		};
+
+		Query(OverlapsNode, OverlapsEntry, f);
+	}
+
+private:
+	static constexpr unsigned int LEAF_SIZE = 8;
+	static constexpr unsigned int NODE_ARITY = 4;
+	static constexpr unsigned int MIN_REBUILD_SIZE = 32;
+
+	struct Entry {
+		float3 pos;
+		float radius;
+
+		CUnit* unit;
+		int unitID;
+		std::uint32_t sortKey;
+	};
+
+	struct Node {
+		// bounds of the objects' circles, and of their positions only
+		float2 mins;
+		float2 maxs;
+		float2 posMins;
+		float2 posMaxs;
+
+		// range of children (inner nodes) or entries (leaves)
+		unsigned int first;
+		unsigned int count;
+		bool leaf;
+	};
+
+	template<typename NP, typename EP, typename F> void Query(const NP& OverlapsNode, const EP& OverlapsEntry, F& f) const {
+		for (const Entry& e: pendingEntries) {
+			if (OverlapsEntry(e))
+				f(e.unit);
+		}
+
+		if (nodes.empty())
+			return;
+
+		// explicit stack, depth is log4 of the number of leaves
+		unsigned int stack[64];
+		unsigned int depth = 0;
+
+		stack[depth++] = nodes.size() - 1;
+
+		while (depth > 0) {
+			const Node& n = nodes[stack[--depth]];
+
+			if (!OverlapsNode(n))
+				continue;
+
+			if (n.leaf) {
+				for (unsigned int i = n.first, end = n.first + n.count; i < end; i++) {
+					const Entry& e = entries[i];
+
+					if (e.unit == nullptr)
+						continue;
+					if (!OverlapsEntry(e))
+						continue;
+
+					f(e.unit);
+				}
+
+				continue;
+			}
+
+			// push in reverse so children are visited in curve order
+			for (unsigned int i = n.count; i > 0; i--) {
+				stack[depth++] = n.first + i - 1;
+			}
+		}
+	}
+
+	std::uint32_t GetSortKey(const float3& pos) const;
+	void Rebuild();
+
+	void SetSlot(int unitID, int slot);
+	int GetSlot(int unitID) const { return ((size_t(unitID) < unitSlots.size())? unitSlots[unitID]: 0); }
+
+private:
+	// packed tree; leaves first, then each level up to the root (last)
+	std::vector<Node> nodes;
+	std::vector<Entry> entries;
+	std::vector<Entry> pendingEntries;
+
+	// per unit-ID: 0 if absent, i+1 if in entries[i], -(i+1) if in pendingEntries[i]
+	std::vector<int> unitSlots;
+
+	unsigned int numDeadEntries = 0;
+
+	float2 invMapSize;
+};
+
+#endif
@@ -42,12 +42,14 @@ CR_REG_METADATA(CTeam, (
 	CR_MEMBER(resPrevExpense),
 	CR_MEMBER(resShare),
 	CR_MEMBER(resDelayedShare),
+	CR_MEMBER(resDelayedIncome),
 	CR_MEMBER(resSent),
 	CR_MEMBER(resPrevSent),
 	CR_MEMBER(resReceived),
 	CR_MEMBER(resPrevReceived),
 	CR_MEMBER(resPrevExcess),
 	CR_MEMBER(nextHistoryEntry),
+	CR_MEMBER(currentStats),
 	CR_MEMBER(statHistory),
 	CR_MEMBER(modParams),
 	CR_IGNORED(highlight)
@@ -71,8 +73,6 @@ CTeam::CTeam():
 	nextHistoryEntry(0),
 	highlight(0.0f)
 {
-	statHistory.reserve(1024);
-	statHistory.push_back(TeamStatistics());
 }
 
 void CTeam::SetDefaultStartPos()
@@ -169,6 +169,16 @@ void CTeam::AddEnergy(float amount, bool useIncomeMultiplier)
 	}
 }
 
+void CTeam::AddDelayedIncome()
+{
+	if (resDelayedIncome.empty())
+		return;
+
+	// one update of the team state instead of one per producing unit
+	AddResources(resDelayedIncome);
+	resDelayedIncome = {};
+}
+
 
 bool CTeam::HaveResources(const SResourcePack& amount) const
 {
@@ -304,8 +314,6 @@ void CTeam::ResetResourceState()
 
 void CTeam::SlowUpdate()
 {
-	TeamStatistics& currentStats = GetCurrentStats();
-
 	float eShare = 0.0f;
 	float mShare = 0.0f;
 
@@ -383,10 +391,10 @@ void CTeam::SlowUpdate()
 
 	if (nextHistoryEntry <= gs->frameNum) {
 		currentStats.frame = gs->frameNum;
-		statHistory.push_back(currentStats);
+		statHistory.Append(currentStats);
 
 		nextHistoryEntry = gs->frameNum + (TeamStatistics::statsPeriod * GAME_SPEED);
-		GetCurrentStats().frame = nextHistoryEntry;
+		currentStats.frame = nextHistoryEntry;
 	}
 }
 
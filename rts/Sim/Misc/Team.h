@@ -31,6 +31,7 @@ public:
 
 	void AddMetal(float amount, bool useIncomeMultiplier = true);
 	void AddEnergy(float amount, bool useIncomeMultiplier = true);
+	void AddDelayedIncome();
 	bool UseEnergy(float amount);
 	bool UseMetal(float amount);
 
@@ -50,8 +51,8 @@ public:
 	unsigned int GetNumUnits() const { return numUnits; }
 	bool AtUnitLimit() const { return (numUnits >= maxUnits); }
 
-	const TeamStatistics& GetCurrentStats() const { return statHistory.back(); }
-	      TeamStatistics& GetCurrentStats()       { return statHistory.back(); }
+	const TeamStatistics& GetCurrentStats() const { return currentStats; }
+	      TeamStatistics& GetCurrentStats()       { return currentStats; }
 
 	CTeam& operator = (const TeamBase& base) {
 		TeamBase::operator = (base);
@@ -89,12 +90,17 @@ public:
 	SResourcePack resExpense, resPrevExpense;
 	SResourcePack resShare;
 	SResourcePack resDelayedShare; //< excess that might be shared next SlowUpdate
+	SResourcePack resDelayedIncome; //< unit production of the current frame, see AddDelayedIncome
 	SResourcePack resSent,     resPrevSent;
 	SResourcePack resReceived, resPrevReceived;
 	SResourcePack resPrevExcess;
 
 	int nextHistoryEntry;
-	std::vector<TeamStatistics> statHistory;
+
+	/// accumulates until the next history entry, its frame is when that will be
+	TeamStatistics currentStats;
+	/// past entries, one per TeamStatistics::statsPeriod; excludes currentStats
+	TeamStatisticsHistory statHistory;
 
 	/// mod controlled parameters
 	LuaRulesParams::Params  modParams;
@@ -4,6 +4,8 @@
 
 #include "System/Platform/byteorder.h"
 
+#include <cassert>
+
 
 CR_BIND(TeamStatistics, )
 CR_REG_METADATA(TeamStatistics, (
@@ -29,6 +31,61 @@ CR_REG_METADATA(TeamStatistics, (
 	CR_MEMBER(unitsKilled)
 ))
 
+CR_BIND(TeamStatisticsHistory, )
+CR_REG_METADATA(TeamStatisticsHistory, (
+	CR_MEMBER(columns),
+	CR_MEMBER(checkpoints),
+	CR_MEMBER(lastEntry),
+	CR_MEMBER(numEntries)
+))
+
+
+static_assert((sizeof(TeamStatistics) % sizeof(uint32_t)) == 0, "");
+
+// metalUsed through damageReceived
+static constexpr uint32_t FLOAT_FIELD_MASK = ((1u << 13) - 1) & ~1u;
+
+static uint32_t EncodeField(unsigned int field, uint32_t prev, uint32_t curr)
+{
+	if ((FLOAT_FIELD_MASK & (1u << field)) != 0)
+		return (prev ^ curr);
+
+	const uint32_t delta = curr - prev;
+	return ((delta << 1) ^ (0u - (delta >> 31)));
+}
+
+static uint32_t DecodeField(unsigned int field, uint32_t prev, uint32_t code)
+{
+	if ((FLOAT_FIELD_MASK & (1u << field)) != 0)
+		return (prev ^ code);
+
+	return (prev + ((code >> 1) ^ (0u - (code & 1))));
+}
+
+static void PutVarInt(std::vector<uint8_t>& column, uint32_t value)
+{
+	for (; value >= 0x80; value >>= 7) {
+		column.push_back(uint8_t(value | 0x80));
+	}
+
+	column.push_back(uint8_t(value));
+}
+
+static uint32_t GetVarInt(const std::vector<uint8_t>& column, uint32_t& offset)
+{
+	uint32_t value = 0;
+
+	for (unsigned int shift = 0; ; shift += 7) {
+		const uint8_t byte = column[offset++];
+
+		value |= (uint32_t(byte & 0x7F) << shift);
+
+		if ((byte & 0x80) == 0)
+			return value;
+	}
+}
+
+
 TeamStatistics::TeamStatistics()
 	: frame(0)
 
@@ -81,3 +138,86 @@ void TeamStatistics::swab()
 	swabDWordInPlace(unitsKilled);
 }
 
+
+
+void TeamStatisticsHistory::Clear()
+{
+	columns.clear();
+	columns.resize(NUM_FIELDS);
+	checkpoints.clear();
+
+	lastEntry = {};
+	numEntries = 0;
+}
+
+void TeamStatisticsHistory::Append(const TeamStatistics& stats)
+{
+	std::array<uint32_t, NUM_FIELDS> prevWords;
+	std::array<uint32_t, NUM_FIELDS> currWords;
+
+	std::memcpy(prevWords.data(), &lastEntry, sizeof(lastEntry));
+	std::memcpy(currWords.data(), &stats, sizeof(stats));
+
+	if ((numEntries % CHECKPOINT_INTERVAL) == 0) {
+		for (unsigned int f = 0; f < NUM_FIELDS; f++) {
+			checkpoints.push_back(currWords[f]);
+			checkpoints.push_back(columns[f].size());
+		}
+	} else {
+		for (unsigned int f = 0; f < NUM_FIELDS; f++) {
+			PutVarInt(columns[f], EncodeField(f, prevWords[f], currWords[f]));
+		}
+	}
+
+	lastEntry = stats;
+	numEntries += 1;
+}
+
+size_t TeamStatisticsHistory::GetMemorySize() const
+{
+	size_t size = checkpoints.size() * sizeof(uint32_t);
+
+	for (const auto& column: columns) {
+		size += column.size();
+	}
+
+	return size;
+}
+
+TeamStatistics TeamStatisticsHistory::Get(size_t i) const
+{
+	assert(i < numEntries);
+
+	if (i == (numEntries - 1))
+		return lastEntry;
+
+	Cursor cursor;
+	Seek(cursor, i);
+	return (cursor.GetStats());
+}
+
+
+void TeamStatisticsHistory::Seek(Cursor& cursor, size_t i) const
+{
+	const uint32_t* checkpoint = &checkpoints[(i / CHECKPOINT_INTERVAL) * NUM_FIELDS * 2];
+
+	for (unsigned int f = 0; f < NUM_FIELDS; f++) {
+		cursor.words[f] = checkpoint[f * 2 + 0];
+		cursor.offsets[f] = checkpoint[f * 2 + 1];
+	}
+
+	cursor.index = i - (i % CHECKPOINT_INTERVAL);
+
+	while (cursor.index < i) {
+		Step(cursor);
+	}
+}
+
+void TeamStatisticsHistory::Step(Cursor& cursor) const
+{
+	for (unsigned int f = 0; f < NUM_FIELDS; f++) {
+		cursor.words[f] = DecodeField(f, cursor.words[f], GetVarInt(columns[f], cursor.offsets[f]));
+	}
+
+	cursor.index += 1;
+}
@@ -6,7 +6,12 @@
 #include "System/creg/creg_cond.h"
 #include "System/Platform/byteorder.h"
 
+#include <algorithm>
+#include <array>
+#include <cstdint>
 #include <cstring>
+#include <type_traits>
+#include <vector>
 
 #pragma pack(push, 1)
 
@@ -46,4 +51,82 @@ struct TeamStatistics
 
 #pragma pack(pop)
 
+// TeamStatisticsHistory copies entries to and from raw 32-bit words
+static_assert(std::is_trivially_copyable<TeamStatistics>::value, "");
+
+
+/**
+ * Append-only history of a team's statistics, stored per field rather than
+ * per entry. Consecutive entries differ little (the counters only grow), so
+ * each column stores the change from the previous entry as a varint: integer
+ * fields as zigzagged differences, float fields as the XOR of their bit
+ * patterns (lossless, so synced reads stay exact). Every CHECKPOINT_INTERVAL
+ * entries the raw values are stored instead, which bounds the decoding work
+ * for random access and makes strided (downsampled) iteration cheap.
+ */
+class TeamStatisticsHistory
+{
+	CR_DECLARE_STRUCT(TeamStatisticsHistory)
+
+public:
+	static constexpr unsigned int NUM_FIELDS = sizeof(TeamStatistics) / sizeof(uint32_t);
+	static constexpr unsigned int CHECKPOINT_INTERVAL = 32;
+
+	TeamStatisticsHistory() { Clear(); }
+
+	void Clear();
+	void Append(const TeamStatistics& stats);
+
+	size_t GetSize() const { return numEntries; }
+	size_t GetMemorySize() const;
+
+	TeamStatistics Get(size_t i) const;
+
+	/// calls func(index, stats) for every <stride>'th entry in [first, last)
+	template<typename F> void ForEach(size_t first, size_t last, size_t stride, F&& func) const {
+		Cursor cursor;
+
+		last = std::min(last, GetSize());
+		stride = std::max(stride, size_t(1));
+
+		for (size_t i = first; i < last; i += stride) {
+			if (cursor.index >= i || (cursor.index / CHECKPOINT_INTERVAL) != (i / CHECKPOINT_INTERVAL)) {
+				Seek(cursor, i);
+			} else {
+				while (cursor.index < i) {
+					Step(cursor);
+				}
+			}
+
+			func(i, cursor.GetStats());
+		}
+	}
+
+private:
+	struct Cursor {
+		TeamStatistics GetStats() const {
+			TeamStatistics stats;
+			std::memcpy(static_cast<void*>(&stats), words.data(), sizeof(stats));
+			return stats;
+		}
+
+		std::array<uint32_t, NUM_FIELDS> words;
+		std::array<uint32_t, NUM_FIELDS> offsets;
+
+		size_t index = size_t(-1);
+	};
+
+	void Seek(Cursor& cursor, size_t i) const;
+	void Step(Cursor& cursor) const;
+
+private:
+	// one varint-stream per field
+	std::vector< std::vector<uint8_t> > columns;
+	// {value, column offset} per field for every CHECKPOINT_INTERVAL'th entry
+	std::vector<uint32_t> checkpoints;
+
+	TeamStatistics lastEntry;
+	unsigned int numEntries = 0;
+};
+
 #endif
@@ -2,16 +2,20 @@
 
 #include "AAirMoveType.h"
 
+#include <algorithm>
+
 #include "Game/GlobalUnsynced.h"
 #include "Map/Ground.h"
 #include "Map/MapInfo.h"
 #include "Rendering/Env/Particles/Classes/SmokeProjectile.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/SmoothHeightMesh.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/ProjectileMemPool.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "System/SpringMath.h"
 
@@ -40,6 +44,11 @@ CR_REG_METADATA(AAirMoveType, (
 	CR_MEMBER(floatOnWater),
 
 	CR_MEMBER(lastCollidee),
+	CR_IGNORED(warningCandidates),
+	CR_IGNORED(collideeCandidates),
+	CR_IGNORED(candidateQuads),
+	CR_IGNORED(warningCandidatesFrame),
+	CR_IGNORED(collideeCandidatesFrame),
 
 	CR_MEMBER(crashExpGenID)
 ))
@@ -220,6 +229,52 @@ void AAirMoveType::UpdateLanding()
 }
 
 
+void AAirMoveType::UpdatePreCollisionsMT()
+{
+	// NOTE: runs on arbitrary threads, must not modify anything but our own members
+	if (!collide || owner->beingBuilt || owner->GetTransporter() != nullptr)
+		return;
+
+	// HandleCollisions does not run for these
+	if (aircraftState == AIRCRAFT_LANDED || aircraftState == AIRCRAFT_TAKEOFF)
+		return;
+
+	quadField.GetUnitsExactMT(collideeCandidates, candidateQuads, owner->pos, owner->radius + 6.0f + owner->speed.w + PRE_COLLISIONS_SLACK);
+	collideeCandidatesFrame = gs->frameNum;
+
+	if (((gs->frameNum + owner->id) & 3) != 0)
+		return;
+
+	// CheckForCollision searches ahead of the owner, which can still turn; cover every heading
+	quadField.GetUnitsExactMT(warningCandidates, candidateQuads, owner->midPos, 121.0f + 200.0f + owner->speed.w + PRE_COLLISIONS_SLACK);
+	warningCandidatesFrame = gs->frameNum;
+}
+
+
+const std::vector<CUnit*>& AAirMoveType::GetUnitsExact(
+	QuadFieldQuery& qfQuery,
+	std::vector<CUnit*>& candidates,
+	int& candidatesFrame,
+	const float3& pos,
+	float radius
+) {
+	if (candidatesFrame != gs->frameNum || !unitHandler.PreCollisionsValid(owner)) {
+		quadField.GetUnitsExact(qfQuery, pos, radius);
+		return *qfQuery.units;
+	}
+
+	const auto pred = [&](const CUnit* u) {
+		return (pos.SqDistance(u->pos) >= Square(radius + u->radius));
+	};
+
+	candidates.erase(std::remove_if(candidates.begin(), candidates.end(), pred), candidates.end());
+	// further calls this frame query the QuadField
+	candidatesFrame = -1;
+
+	return candidates;
+}
+
+
 void AAirMoveType::CheckForCollision()
 {
 	if (!collide)
@@ -231,7 +286,8 @@ void AAirMoveType::CheckForCollision()
 	float dist = 200.0f;
 
 	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos + forward * 121.0f, dist);
+
+	const std::vector<CUnit*>& units = GetUnitsExact(qfQuery, warningCandidates, warningCandidatesFrame, pos + forward * 121.0f, dist);
 
 	if (lastCollidee != nullptr) {
 		DeleteDeathDependence(lastCollidee, DEPENDENCE_LASTCOLWARN);
@@ -241,7 +297,7 @@ void AAirMoveType::CheckForCollision()
 	}
 
 	// find closest potential collidee
-	for (CUnit* unit: *qfQuery.units) {
+	for (CUnit* unit: units) {
 		if (unit == owner || !unit->unitDef->canfly)
 			continue;
 
@@ -269,7 +325,7 @@ void AAirMoveType::CheckForCollision()
 		return;
 	}
 
-	for (CUnit* u: *qfQuery.units) {
+	for (CUnit* u: units) {
 		if (u == owner)
 			continue;
 
@@ -3,8 +3,12 @@
 #ifndef A_AIR_MOVE_TYPE_H_
 #define A_AIR_MOVE_TYPE_H_
 
+#include <vector>
+
 #include "MoveType.h"
 
+struct QuadFieldQuery;
+
 /**
  * Supposed to be an abstract class.
  * Do not create an instance of this class.
@@ -35,6 +39,7 @@ public:
 	AAirMoveType(CUnit* unit);
 	virtual ~AAirMoveType() {}
 
+	void UpdatePreCollisionsMT() override;
 	virtual bool Update() override;
 	virtual void UpdateLanded();
 	virtual void Takeoff() {}
@@ -63,6 +68,19 @@ public:
 protected:
 	void CheckForCollision();
 
+	/**
+	 * Returns the units within <radius> of <pos> like QuadField::GetUnitsExact,
+	 * but filtered from <candidates> (consuming them) if UpdatePreCollisionsMT
+	 * gathered those this frame.
+	 */
+	const std::vector<CUnit*>& GetUnitsExact(
+		QuadFieldQuery& qfQuery,
+		std::vector<CUnit*>& candidates,
+		int& candidatesFrame,
+		const float3& pos,
+		float radius
+	);
+
 public:
 	AircraftState aircraftState = AIRCRAFT_LANDED;
 	CollisionState collisionState = COLLISION_NOUNIT;
@@ -93,6 +111,15 @@ protected:
 	/// unit found to be dangerously close to our path
 	CUnit* lastCollidee = nullptr;
 
+	// gathered in parallel by UpdatePreCollisionsMT, consumed by
+	// CheckForCollision and by the derived types' HandleCollisions
+	std::vector<CUnit*> warningCandidates;
+	std::vector<CUnit*> collideeCandidates;
+	std::vector<int> candidateQuads;
+
+	int warningCandidatesFrame = -1;
+	int collideeCandidatesFrame = -1;
+
 	unsigned int crashExpGenID = -1u;
 };
 
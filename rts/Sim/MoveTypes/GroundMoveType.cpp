@@ -82,6 +82,9 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_GMT)
 CR_BIND_DERIVED(CGroundMoveType, AMoveType, (nullptr))
 CR_REG_METADATA(CGroundMoveType, (
 	CR_IGNORED(pathController),
+	CR_IGNORED(avoideeCandidates),
+	CR_IGNORED(avoideeCandidateQuads),
+	CR_IGNORED(collideeCandidates),
 
 	CR_MEMBER(currWayPoint),
 	CR_MEMBER(nextWayPoint),
@@ -119,6 +122,8 @@ CR_REG_METADATA(CGroundMoveType, (
 
 	CR_MEMBER(pathID),
 	CR_MEMBER(nextObstacleAvoidanceFrame),
+	CR_IGNORED(avoideeCandidatesFrame),
+	CR_IGNORED(collideeCandidatesFrame),
 
 	CR_MEMBER(numIdlingUpdates),
 	CR_MEMBER(numIdlingSlowUpdates),
@@ -473,6 +478,31 @@ bool CGroundMoveType::OwnerMoved(const short oldHeading, const float3& posDif, c
 	return true;
 }
 
+void CGroundMoveType::UpdatePreCollisionsMT()
+{
+	// NOTE: runs on arbitrary threads, must not modify anything but our own members
+	if (owner->GetTransporter() != nullptr)
+		return;
+
+	// collidees are gathered for every unit HandleObjectCollisions might run
+	// on this frame (including skidding ones), the search radius mirrors the
+	// one used by HandleUnitCollisions plus the slack
+	if (!owner->beingBuilt) {
+		const float colliderFootPrintRadius = owner->moveDef->CalcFootPrintMaxInteriorRadius();
+
+		quadField.GetUnitsExactMT(collideeCandidates, avoideeCandidateQuads, owner->pos, owner->speed.w + (colliderFootPrintRadius * 2.0f) + PRE_COLLISIONS_SLACK);
+		collideeCandidatesFrame = gs->frameNum;
+	}
+
+	if (progressState != Active || owner->IsSkidding() || owner->IsFalling())
+		return;
+
+	const float avoidanceRadius = std::max(currentSpeed, 1.0f) * (owner->radius * 2.0f);
+
+	quadField.GetUnitsExactMT(avoideeCandidates, avoideeCandidateQuads, owner->pos, avoidanceRadius + PRE_COLLISIONS_SLACK);
+	avoideeCandidatesFrame = gs->frameNum;
+}
+
 bool CGroundMoveType::Update()
 {
 	ASSERT_SYNCED(owner->pos);
@@ -1179,6 +1209,7 @@ void CGroundMoveType::CheckCollisionSkid()
 
 			collider->Move( colliderImpactImpulse, true);
 			collidee->Move(-collideeImpactImpulse, true);
+			unitHandler.CheckPreCollisionsMove(collidee);
 			collider->SetVelocity        (collider->speed + colliderImpactImpulse);
 			collidee->SetVelocityAndSpeed(collidee->speed - collideeImpactImpulse);
 		}
@@ -1301,9 +1332,29 @@ float3 CGroundMoveType::GetObstacleAvoidanceDir(const float3& desiredDir) {
 	const float avoiderRadius = avoiderMD->CalcFootPrintMinExteriorRadius();
 
 	QuadFieldQuery qfQuery;
-	quadField.GetSolidsExact(qfQuery, avoider->pos, avoidanceRadius, 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
 
-	for (const CSolidObject* avoidee: *qfQuery.solids) {
+	// features are never avoided (they have no MoveDef), so the unit candidates
+	// from UpdatePreCollisionsMT suffice while they cover every unit in range;
+	// if some unit was created, teleported or moved too far since, query anew
+	const bool useCandidates = (avoideeCandidatesFrame == gs->frameNum && unitHandler.PreCollisionsValid(avoider));
+
+	if (useCandidates) {
+		const auto pred = [&](const CUnit* u) {
+			if (!u->HasCollidableStateBit(CSolidObject::CSTATE_BIT_SOLIDOBJECTS))
+				return true;
+
+			return ((avoider->pos - u->pos).SqLength() >= Square(avoidanceRadius + u->radius));
+		};
+
+		avoideeCandidates.erase(std::remove_if(avoideeCandidates.begin(), avoideeCandidates.end(), pred), avoideeCandidates.end());
+	} else {
+		quadField.GetSolidsExact(qfQuery, avoider->pos, avoidanceRadius, 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+	}
+
+	const size_t numAvoidees = useCandidates? avoideeCandidates.size(): qfQuery.solids->size();
+
+	for (size_t i = 0; i < numAvoidees; i++) {
+		const CSolidObject* avoidee = useCandidates? avoideeCandidates[i]: (*qfQuery.solids)[i];
 		const MoveDef* avoideeMD = avoidee->moveDef;
 		const UnitDef* avoideeUD = dynamic_cast<const UnitDef*>(avoidee->GetDef());
 
@@ -1469,7 +1520,13 @@ unsigned int CGroundMoveType::GetNewPath()
 	if ((owner->pos - goalPos).SqLength2D() <= Square(goalRadius + extraRadius))
 		return newPathID;
 
-	if ((newPathID = pathManager->RequestPath(owner, owner->moveDef, owner->pos, goalPos, goalRadius + extraRadius, true)) != 0) {
+	if (modInfo.pfFlowFieldPaths) {
+		newPathID = pathManager->RequestFlowPath(owner, owner->moveDef, owner->pos, goalPos, goalRadius + extraRadius, true);
+	} else {
+		newPathID = pathManager->RequestPath(owner, owner->moveDef, owner->pos, goalPos, goalRadius + extraRadius, true);
+	}
+
+	if (newPathID != 0) {
 		atGoal = false;
 		atEndOfPath = false;
 
@@ -1992,11 +2049,32 @@ void CGroundMoveType::HandleUnitCollisions(
 	const bool allowSAT = modInfo.allowSepAxisCollisionTest;
 	const bool forceSAT = (colliderParams.z > 0.1f);
 
+	const float searchRadius = colliderParams.x + (colliderParams.y * 2.0f);
+
 	// copy on purpose, since the below can call Lua
 	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, collider->pos, colliderParams.x + (colliderParams.y * 2.0f));
 
-	for (CUnit* collidee: *qfQuery.units) {
+	// candidates gathered by UpdatePreCollisionsMT only need the exact
+	// distance test re-applied against current positions while they still
+	// cover every unit in range (see CUnitHandler::PreCollisionsValid);
+	// collisions are resolved one collider at a time in activeUnits order
+	const bool useCandidates = (collideeCandidatesFrame == gs->frameNum && unitHandler.PreCollisionsValid(collider));
+
+	if (useCandidates) {
+		const auto pred = [&](const CUnit* u) {
+			return (collider->pos.SqDistance(u->pos) >= Square(searchRadius + u->radius));
+		};
+
+		collideeCandidates.erase(std::remove_if(collideeCandidates.begin(), collideeCandidates.end(), pred), collideeCandidates.end());
+		// HandleObjectCollisions can run more than once per frame (skidding)
+		collideeCandidatesFrame = -1;
+	} else {
+		quadField.GetUnitsExact(qfQuery, collider->pos, searchRadius);
+	}
+
+	const std::vector<CUnit*>& collidees = useCandidates? collideeCandidates: *qfQuery.units;
+
+	for (CUnit* collidee: collidees) {
 		if (collidee == collider) continue;
 		if (collidee->IsSkidding()) continue;
 		if (collidee->IsFlying()) continue;
@@ -2162,8 +2240,10 @@ void CGroundMoveType::HandleUnitCollisions(
 		if (moveCollider && colliderMD->TestMoveSquare(collider, collider->pos + colliderMoveVec, colliderMoveVec))
 			collider->Move(colliderMoveVec, true);
 
-		if (moveCollidee && collideeMD->TestMoveSquare(collidee, collidee->pos + collideeMoveVec, collideeMoveVec))
+		if (moveCollidee && collideeMD->TestMoveSquare(collidee, collidee->pos + collideeMoveVec, collideeMoveVec)) {
 			collidee->Move(collideeMoveVec, true);
+			unitHandler.CheckPreCollisionsMove(collidee);
+		}
 	}
 }
 
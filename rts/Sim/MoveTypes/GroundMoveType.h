@@ -4,6 +4,7 @@
 #define GROUNDMOVETYPE_H
 
 #include <array>
+#include <vector>
 
 #include "MoveType.h"
 #include "Sim/Path/IPathController.hpp"
@@ -29,6 +30,7 @@ public:
 
 	void PostLoad();
 
+	void UpdatePreCollisionsMT() override;
 	bool Update() override;
 	void SlowUpdate() override;
 
@@ -164,6 +166,13 @@ private:
 private:
 	GMTDefaultPathController pathController;
 
+	// gathered in parallel by UpdatePreCollisionsMT, consumed (and filtered
+	// against the then-current state) by GetObstacleAvoidanceDir in Update
+	std::vector<CUnit*> avoideeCandidates;
+	std::vector<int> avoideeCandidateQuads;
+	// likewise for HandleUnitCollisions
+	std::vector<CUnit*> collideeCandidates;
+
 	SyncedFloat3 currWayPoint;
 	SyncedFloat3 nextWayPoint;
 
@@ -202,6 +211,8 @@ private:
 
 	unsigned int pathID = 0;
 	unsigned int nextObstacleAvoidanceFrame = 0;
+	int avoideeCandidatesFrame = -1;        /// frame in which UpdatePreCollisionsMT last gathered avoideeCandidates
+	int collideeCandidatesFrame = -1;       /// frame in which UpdatePreCollisionsMT last gathered collideeCandidates
 
 	unsigned int numIdlingUpdates = 0;      /// {in, de}creased every Update if idling is true/false and pathId != 0
 	unsigned int numIdlingSlowUpdates = 0;  /// {in, de}creased every SlowUpdate if idling is true/false and pathId != 0
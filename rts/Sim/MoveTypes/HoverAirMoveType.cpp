@@ -13,6 +13,7 @@
 #include "Sim/Units/Scripts/UnitScript.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "System/SpringMath.h"
 #include "System/Matrix44f.h"
@@ -1031,9 +1032,8 @@ bool CHoverAirMoveType::HandleCollisions(bool checkCollisions)
 		// includes an extra condition for transports, which are exempt while loading
 		if (!forceHeading && checkCollisions) {
 			QuadFieldQuery qfQuery;
-			quadField.GetUnitsExact(qfQuery, pos, owner->radius + 6);
 
-			for (CUnit* unit: *qfQuery.units) {
+			for (CUnit* unit: GetUnitsExact(qfQuery, collideeCandidates, collideeCandidatesFrame, pos, owner->radius + 6)) {
 				const bool unloadingUnit  = ( unit->unloadingTransportId == owner->id);
 				const bool unloadingOwner = (owner->unloadingTransportId ==  unit->id);
 				const bool   loadingUnit  = ( unit->id == owner->loadingTransportId);
@@ -1084,6 +1084,7 @@ bool CHoverAirMoveType::HandleCollisions(bool checkCollisions)
 					if (!unit->UsingScriptMoveType()) {
 						unit->SetVelocityAndSpeed(unit->speed - (dif * colSpeed * (part)));
 						unit->Move(dif * (dist - totRad) * (part), true);
+						unitHandler.CheckPreCollisionsMove(unit);
 					}
 				}
 			}
@@ -12,6 +12,10 @@
 #include "Sim/Units/Unit.h"
 #include "System/Platform/Threading.h"
 
+#ifndef DEDICATED_NOSSE
+#include <xmmintrin.h>
+#endif
+
 bool CMoveMath::noHoverWaterMove = false;
 float CMoveMath::waterDamageCost = 0.0f;
 
@@ -105,6 +109,128 @@ float CMoveMath::GetPosSpeedMod(const MoveDef& moveDef, unsigned xSquare, unsign
 	return 0.0f;
 }
 
+void CMoveMath::GetRowSpeedMods(const MoveDef& moveDef, unsigned xSquareMin, unsigned xSquareMax, unsigned zSquare, float* speedMods)
+{
+	const unsigned int xSquareEnd = std::min(xSquareMax, unsigned(mapDims.mapx));
+
+	// out-of-map squares have no speed
+	for (unsigned int x = std::max(xSquareMin, xSquareEnd); x < xSquareMax; x++) {
+		speedMods[x - xSquareMin] = 0.0f;
+	}
+
+	if (zSquare >= mapDims.mapy) {
+		std::fill(speedMods, speedMods + (xSquareEnd - std::min(xSquareMin, xSquareEnd)), 0.0f);
+		return;
+	}
+
+	if (xSquareMin >= xSquareEnd)
+		return;
+
+	// all inputs are at half-heightmap resolution, so each cell covers
+	// two squares of the row; evaluate whole cells and write them twice
+	const int rowOffset = (zSquare >> 1) * mapDims.hmapx;
+
+	const float* heights = readMap->GetMIPHeightMapSynced(1) + rowOffset;
+	const float* slopes = readMap->GetSlopeMapSynced() + rowOffset;
+	const unsigned char* types = readMap->GetTypeMapSynced() + rowOffset;
+
+	const float CMapInfo::TerrainType::* ttSpeed = nullptr;
+
+	switch (moveDef.speedModClass) {
+		case MoveDef::Tank:  { ttSpeed = &CMapInfo::TerrainType::tankSpeed ; } break;
+		case MoveDef::KBot:  { ttSpeed = &CMapInfo::TerrainType::kbotSpeed ; } break;
+		case MoveDef::Hover: { ttSpeed = &CMapInfo::TerrainType::hoverSpeed; } break;
+		case MoveDef::Ship:  { ttSpeed = &CMapInfo::TerrainType::shipSpeed ; } break;
+		default: {
+			std::fill(speedMods, speedMods + (xSquareEnd - xSquareMin), 0.0f);
+			return;
+		} break;
+	}
+
+	const unsigned int cellMin = xSquareMin >> 1;
+	const unsigned int cellEnd = (xSquareEnd + 1) >> 1;
+
+	for (unsigned int cell = cellMin; cell < cellEnd; cell += 4) {
+		const unsigned int numCells = std::min(4u, cellEnd - cell);
+
+		float cellSpeedMods[4];
+		float cellTypeMods[4];
+
+		for (unsigned int i = 0; i < numCells; i++) {
+			cellTypeMods[i] = mapInfo->terrainTypes[ types[cell + i] ].*ttSpeed;
+		}
+
+		#ifndef DEDICATED_NOSSE
+		if (numCells == 4 && moveDef.speedModClass != MoveDef::Ship) {
+			// mirrors {Ground,Hover}SpeedMod operation by operation, s.t.
+			// results do not differ from the scalar code (sync-safety)
+			const __m128 h = _mm_loadu_ps(&heights[cell]);
+			const __m128 s = _mm_loadu_ps(&slopes[cell]);
+			const __m128 d = _mm_sub_ps(_mm_setzero_ps(), h);
+
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 zro = _mm_setzero_ps();
+
+			// slope too steep?
+			const __m128 steep = _mm_cmpgt_ps(s, _mm_set1_ps(moveDef.maxSlope));
+			const __m128 water = _mm_cmplt_ps(h, zro);
+
+			__m128 sm = _mm_div_ps(one, _mm_add_ps(one, _mm_mul_ps(s, _mm_set1_ps(moveDef.slopeMod))));
+
+			if (moveDef.speedModClass == MoveDef::Hover) {
+				// no speed-penalty if on water (unless noWaterMove)
+				const __m128 wm = _mm_set1_ps(1.0f * !noHoverWaterMove);
+
+				sm = _mm_andnot_ps(steep, sm);
+				sm = _mm_or_ps(_mm_and_ps(water, wm), _mm_andnot_ps(water, sm));
+			} else {
+				const float* dmp = &moveDef.depthModParams[0];
+
+				// MoveDef::GetDepthMod
+				const __m128 q = _mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_mul_ps(_mm_set1_ps(dmp[MoveDef::DEPTHMOD_QUA_COEFF]), d), d), _mm_mul_ps(_mm_set1_ps(dmp[MoveDef::DEPTHMOD_LIN_COEFF]), d)), _mm_set1_ps(dmp[MoveDef::DEPTHMOD_CON_COEFF]));
+				const __m128 c = _mm_min_ps(_mm_set1_ps(dmp[MoveDef::DEPTHMOD_MAX_SCALE]), _mm_max_ps(_mm_set1_ps(0.01f), q));
+				const __m128 dmMin = _mm_cmpgt_ps(h, _mm_set1_ps(-dmp[MoveDef::DEPTHMOD_MIN_HEIGHT]));
+				const __m128 dmMax = _mm_cmplt_ps(h, _mm_set1_ps(-dmp[MoveDef::DEPTHMOD_MAX_HEIGHT]));
+
+				__m128 dm = _mm_div_ps(one, c);
+
+				dm = _mm_andnot_ps(dmMax, dm);
+				dm = _mm_or_ps(_mm_and_ps(dmMin, one), _mm_andnot_ps(dmMin, dm));
+
+				sm = _mm_mul_ps(sm, _mm_or_ps(_mm_and_ps(water, _mm_set1_ps(waterDamageCost)), _mm_andnot_ps(water, one)));
+				sm = _mm_mul_ps(sm, dm);
+
+				// slope too steep or square too deep?
+				sm = _mm_andnot_ps(_mm_or_ps(steep, _mm_cmpgt_ps(d, _mm_set1_ps(moveDef.depth))), sm);
+			}
+
+			_mm_storeu_ps(cellSpeedMods, _mm_mul_ps(sm, _mm_loadu_ps(cellTypeMods)));
+		} else
+		#endif
+		{
+			for (unsigned int i = 0; i < numCells; i++) {
+				const float height = heights[cell + i];
+				const float slope  = slopes[cell + i];
+
+				switch (moveDef.speedModClass) {
+					case MoveDef::Tank:  // fall-through
+					case MoveDef::KBot:  { cellSpeedMods[i] = GroundSpeedMod(moveDef, height, slope) * cellTypeMods[i]; } break;
+					case MoveDef::Hover: { cellSpeedMods[i] =  HoverSpeedMod(moveDef, height, slope) * cellTypeMods[i]; } break;
+					case MoveDef::Ship:  { cellSpeedMods[i] =   ShipSpeedMod(moveDef, height, slope) * cellTypeMods[i]; } break;
+					default: {} break;
+				}
+			}
+		}
+
+		for (unsigned int i = 0; i < numCells; i++) {
+			const unsigned int x = (cell + i) << 1;
+
+			if (x     >= xSquareMin && x     < xSquareEnd) speedMods[x     - xSquareMin] = cellSpeedMods[i];
+			if (x + 1 >= xSquareMin && x + 1 < xSquareEnd) speedMods[x + 1 - xSquareMin] = cellSpeedMods[i];
+		}
+	}
+}
+
 /* Check if a given square-position is accessable by the MoveDef footprint. */
 CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheck(const MoveDef& moveDef, int xSquare, int zSquare, const CSolidObject* collider)
 {
@@ -115,13 +241,15 @@ CMoveMath::BlockType CMoveMath::IsBlockedNoSpeedModCheck(const MoveDef& moveDef,
 
 	BlockType ret = BLOCK_NONE;
 
+	// most footprints lie in open terrain; skip the per-square scan
+	if (groundBlockingObjectMap.RangeIsEmpty(xmin, xmax, zmin, zmax))
+		return ret;
+
 	// footprints are point-symmetric around <xSquare, zSquare>
 	// same as RangeIsBlocked but without anti-duplication test
 	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
-		const int zOffset = z * mapDims.mapx;
-
 		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
+			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(x, z);
 
 			for (size_t i = 0, n = cell.size(); i < n; i++) {
 				const CSolidObject* collidee = cell[i];
@@ -256,7 +384,7 @@ CMoveMath::BlockType CMoveMath::SquareIsBlocked(const MoveDef& moveDef, int xSqu
 
 	BlockType r = BLOCK_NONE;
 
-	const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zSquare * mapDims.mapx + xSquare);
+	const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(xSquare, zSquare);
 
 	for (size_t i = 0, n = cell.size(); i < n; i++) {
 		r |= ObjectBlockType(moveDef, cell[i], collider);
@@ -274,14 +402,15 @@ CMoveMath::BlockType CMoveMath::RangeIsBlocked(const MoveDef& moveDef, int xmin,
 
 	BlockType ret = BLOCK_NONE;
 
+	if (groundBlockingObjectMap.RangeIsEmpty(xmin, xmax, zmin, zmax))
+		return ret;
+
 	const int tempNum = gs->GetTempNum();
 
 	// footprints are point-symmetric around <xSquare, zSquare>
 	for (int z = zmin; z <= zmax; z += FOOTPRINT_ZSTEP) {
-		const int zOffset = z * mapDims.mapx;
-
 		for (int x = xmin; x <= xmax; x += FOOTPRINT_XSTEP) {
-			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(zOffset + x);
+			const CGroundBlockingObjectMap::BlockingMapCell& cell = groundBlockingObjectMap.GetCellUnsafeConst(x, z);
 
 			for (size_t i = 0, n = cell.size(); i < n; i++) {
 				CSolidObject* collidee = cell[i];
@@ -49,6 +49,10 @@ public:
 		return (GetPosSpeedMod(moveDef, pos.x / SQUARE_SIZE, pos.z / SQUARE_SIZE, moveDir));
 	}
 
+	// same as GetPosSpeedMod for the squares [xSquareMin, xSquareMax) of row <zSquare>,
+	// written to speedMods[0, xSquareMax - xSquareMin); bit-identical but vectorized
+	static void GetRowSpeedMods(const MoveDef& moveDef, unsigned xSquareMin, unsigned xSquareMax, unsigned zSquare, float* speedMods);
+
 	// tells whether a position is blocked (inaccessable for a given object's MoveDef)
 	static inline BlockType IsBlocked(const MoveDef& moveDef, const float3& pos, const CSolidObject* collider);
 	static inline BlockType IsBlocked(const MoveDef& moveDef, int xSquare, int zSquare, const CSolidObject* collider);
@@ -18,6 +18,10 @@ class AMoveType : public CObject
 	CR_DECLARE_DERIVED(AMoveType)
 
 public:
+	// extra search radius of UpdatePreCollisionsMT queries, to account for
+	// units that move between that pass and the sequential Update
+	static constexpr float PRE_COLLISIONS_SLACK = SQUARE_SIZE * 4.0f;
+
 	AMoveType(CUnit* owner);
 	virtual ~AMoveType() {}
 
@@ -49,6 +53,11 @@ public:
 	virtual void SetManeuverLeash(float leashLength) { maneuverLeash = leashLength; }
 	virtual void SetWaterline(float depth) { waterline = depth; }
 
+	// optional first stage of Update, run for all units in parallel when
+	// modInfo.multiThreadedMoveTypes is set; may only read shared state and
+	// write members of this movetype which the sequential Update consumes
+	// (see CUnitHandler::PreCollisionsValid)
+	virtual void UpdatePreCollisionsMT() {}
 	virtual bool Update() = 0;
 	virtual void SlowUpdate();
 
@@ -7,6 +7,7 @@
 #include "Map/MapInfo.h"
 #include "Sim/Misc/Wind.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/UnitTypes/Building.h"
 #include "System/EventHandler.h"
 #include "System/Matrix44f.h"
@@ -179,7 +180,7 @@ void CScriptMoveType::SetPhysics(const float3& _pos, const float3& _vel, const f
 }
 
 
-void CScriptMoveType::SetPosition(const float3& _pos) { owner->Move(_pos, false); }
+void CScriptMoveType::SetPosition(const float3& _pos) { owner->Move(_pos, false); unitHandler.CheckPreCollisionsMove(owner); }
 void CScriptMoveType::SetVelocity(const float3& _vel) { owner->SetVelocityAndSpeed(velVec = _vel); }
 
 
@@ -13,6 +13,7 @@
 #include "Sim/Units/Scripts/UnitScript.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
+#include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Weapons/Weapon.h"
 #include "System/SpringMath.h"
@@ -562,9 +563,8 @@ bool CStrafeAirMoveType::HandleCollisions(bool checkCollisions) {
 		if (checkCollisions) {
 			// copy on purpose, since the below can call Lua
 			QuadFieldQuery qfQuery;
-			quadField.GetUnitsExact(qfQuery, pos, owner->radius + 6);
 
-			for (CUnit* unit: *qfQuery.units) {
+			for (CUnit* unit: GetUnitsExact(qfQuery, collideeCandidates, collideeCandidatesFrame, pos, owner->radius + 6)) {
 				const bool unloadingUnit  = ( unit->unloadingTransportId == owner->id);
 				const bool unloadingOwner = (owner->unloadingTransportId ==  unit->id);
 				const bool   loadingUnit  = ( unit->id == owner->loadingTransportId);
@@ -619,8 +619,10 @@ bool CStrafeAirMoveType::HandleCollisions(bool checkCollisions) {
 					owner->Move(-dif * (dist - totRad) * (1 - part), true);
 					owner->SetVelocity(owner->speed * 0.99f);
 
-					if (!unit->UsingScriptMoveType())
+					if (!unit->UsingScriptMoveType()) {
 						unit->Move(dif * (dist - totRad) * (part), true);
+						unitHandler.CheckPreCollisionsMove(unit);
+					}
 
 					if (modInfo.allowUnitCollisionDamage) {
 						owner->DoDamage(DamageArray(damage), ZeroVector, nullptr, -CSolidObject::DAMAGE_COLLISION_OBJECT, -1);
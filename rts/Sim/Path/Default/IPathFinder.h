@@ -27,9 +27,11 @@ public:
 
 	// size of the memory-region we hold allocated (excluding sizeof(*this))
 	// (PathManager stores HeatMap and FlowMap, so we do not need to add them)
-	size_t GetMemFootPrint() const { return (blockStates.GetMemFootPrint()); }
+	virtual size_t GetMemFootPrint() const { return (blockStates.GetMemFootPrint()); }
 
 	PathNodeStateBuffer& GetNodeStateBuffer() { return blockStates; }
+	std::uint64_t GetNumTotalTestedBlocks() const { return numTotalTestedBlocks; }
+	const PathNodeStateBuffer& GetNodeStateBuffer() const { return blockStates; }
 
 	unsigned int GetBlockSize() const { return BLOCK_SIZE; }
 	int2 GetNumBlocks() const { return nbrOfBlocks; }
@@ -139,6 +141,9 @@ public:
 	unsigned int maxBlocksToBeSearched = 0;
 	unsigned int testedBlocks = 0;
 
+	// sum of testedBlocks over all searches run so far (for statistics)
+	std::uint64_t numTotalTestedBlocks = 0;
+
 	unsigned int instanceIndex = 0;
 
 	PathNodeBuffer openBlockBuffer;
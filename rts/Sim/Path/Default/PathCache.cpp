@@ -1,6 +1,7 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include <algorithm>
+#include <cstdlib>
 
 #include "PathCache.h"
 #include "Sim/Misc/GlobalConstants.h"
@@ -10,33 +11,43 @@
 #define MAX_CACHE_QUEUE_SIZE   200
 #define MAX_PATH_LIFETIME_SECS   6
 #define USE_NONCOLLIDABLE_HASH   1
+#define MAX_SPLICE_SQUARE_DIST  32
 
-CPathCache::CPathCache(int blocksX, int blocksZ)
+CPathCache::CPathCache(int blocksX, int blocksZ, int blockSize, bool splicePaths)
 	: numBlocksX(blocksX)
 	, numBlocksZ(blocksZ)
 	, numBlocks(numBlocksX * numBlocksZ)
+	, blockPixelSize(blockSize * SQUARE_SIZE)
+
+	, maxSpliceDist(std::max(1, MAX_SPLICE_SQUARE_DIST / blockSize))
+
+	, spliceCachedPaths(splicePaths)
 
 	, maxCacheSize(0)
 	, numCacheHits(0)
+	, numCacheSplices(0)
 	, numCacheMisses(0)
 	, numHashCollisions(0)
 {
 	// {result, path, strtBlock, goalBlock, goalRadius, pathType}
 	dummyCacheItem = {IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
 
+	splicedCacheItem = dummyCacheItem;
+
 	cachedPaths.reserve(4096);
+	goalCorridors.reserve(256);
 }
 
 CPathCache::~CPathCache()
 {
 	const char* fmt =
 #ifdef _WIN32
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%I64u";
+		"[%s(%ux%u)] cacheHits=%u cacheSplices=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%I64u";
 #else
-		"[%s(%ux%u)] cacheHits=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu";
+		"[%s(%ux%u)] cacheHits=%u cacheSplices=%u hitPercentage=%.0f%% numHashColls=%u maxCacheSize=%lu";
 #endif
 
-	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
+	LOG(fmt, __FUNCTION__, numBlocksX, numBlocksZ, numCacheHits, numCacheSplices, GetCacheHitPercentage(), numHashCollisions, maxCacheSize);
 }
 
 bool CPathCache::AddPath(
@@ -60,6 +71,10 @@ bool CPathCache::AddPath(
 
 	cachedPaths[hash] = CacheItem{result, *path, strtBlock, goalBlock, goalRadius, pathType};
 
+	// only complete paths can be reused as corridors by other requests
+	if (spliceCachedPaths && result == IPath::Ok && !path->path.empty())
+		goalCorridors[GetCorridorHash(goalBlock, goalRadius, pathType)].push_back(hash);
+
 	const int lifeTime = (result == IPath::Ok) ? GAME_SPEED * MAX_PATH_LIFETIME_SECS : GAME_SPEED * (MAX_PATH_LIFETIME_SECS / 2);
 
 	cacheQue.push_back({gs->frameNum + lifeTime, hash});
@@ -71,28 +86,97 @@ const CPathCache::CacheItem& CPathCache::GetCachedPath(
 	const int2 strtBlock,
 	const int2 goalBlock,
 	float goalRadius,
-	int pathType
+	int pathType,
+	const std::function<bool(const int2)>& isReachable
 ) {
 	const std::uint64_t hash = GetHash(strtBlock, goalBlock, goalRadius, pathType);
 	const auto iter = cachedPaths.find(hash);
 
-	if (iter == cachedPaths.end()) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).strtBlock != strtBlock) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).goalBlock != goalBlock) {
-		++numCacheMisses; return dummyCacheItem;
-	}
-	if ((iter->second).pathType != pathType) {
-		++numCacheMisses; return dummyCacheItem;
-	}
+	const auto CacheMiss = [&]() -> const CacheItem& {
+		const CacheItem* ci = spliceCachedPaths? SpliceCachedPath(strtBlock, goalBlock, goalRadius, pathType, isReachable): nullptr;
+
+		if (ci == nullptr) {
+			++numCacheMisses; return dummyCacheItem;
+		}
+
+		++numCacheSplices;
+		return *ci;
+	};
+
+	if (iter == cachedPaths.end())
+		return (CacheMiss());
+	if ((iter->second).strtBlock != strtBlock)
+		return (CacheMiss());
+	if ((iter->second).goalBlock != goalBlock)
+		return (CacheMiss());
+	if ((iter->second).pathType != pathType)
+		return (CacheMiss());
 
 	++numCacheHits;
 	return (iter->second);
 }
 
+const CPathCache::CacheItem* CPathCache::SpliceCachedPath(
+	const int2 strtBlock,
+	const int2 goalBlock,
+	float goalRadius,
+	int pathType,
+	const std::function<bool(const int2)>& isReachable
+) {
+	const auto iter = goalCorridors.find(GetCorridorHash(goalBlock, goalRadius, pathType));
+
+	if (iter == goalCorridors.end())
+		return nullptr;
+
+	const CacheItem* bestItem = nullptr;
+
+	int bestDist = maxSpliceDist + 1;
+	int bestNode = -1;
+
+	for (const std::uint64_t hash: iter->second) {
+		const CacheItem& ci = cachedPaths[hash];
+
+		if (ci.goalBlock != goalBlock || ci.pathType != pathType || ci.goalRadius != goalRadius)
+			continue;
+
+		// path[0] is the goal-node and path.back() the start-node; walk from
+		// the start so that ties prefer the node reached earliest along it
+		// (every node is a block-offset square, so it maps back onto its block)
+		for (int n = int(ci.path.path.size()) - 1; n >= 0; n--) {
+			const float3& node = ci.path.path[n];
+			const int2 nodeBlock = {int(node.x / blockPixelSize), int(node.z / blockPixelSize)};
+			const int nodeDist = std::max(std::abs(nodeBlock.x - strtBlock.x), std::abs(nodeBlock.y - strtBlock.y));
+
+			if (nodeDist >= bestDist)
+				continue;
+			// a nearby node can still be cut off from the start (e.g. across a cliff)
+			if (!isReachable(nodeBlock))
+				continue;
+
+			bestItem = &ci;
+			bestDist = nodeDist;
+			bestNode = n;
+		}
+	}
+
+	if (bestItem == nullptr)
+		return nullptr;
+
+	// keep the corridor from the splice-node to the goal; the gap between the
+	// request's start and that node is bridged by the finer-resolution search
+	// which PathManager runs over the first waypoints of any estimated path
+	splicedCacheItem.result = IPath::Ok;
+	splicedCacheItem.path.path.assign(bestItem->path.path.begin(), bestItem->path.path.begin() + bestNode + 1);
+	splicedCacheItem.path.squares.clear();
+	splicedCacheItem.path.pathGoal = bestItem->path.pathGoal;
+	splicedCacheItem.path.pathCost = bestItem->path.pathCost * ((bestNode + 1.0f) / bestItem->path.path.size());
+	splicedCacheItem.strtBlock = strtBlock;
+	splicedCacheItem.goalBlock = goalBlock;
+	splicedCacheItem.goalRadius = goalRadius;
+	splicedCacheItem.pathType = pathType;
+	return &splicedCacheItem;
+}
+
 void CPathCache::Update()
 {
 	while (!cacheQue.empty() && (cacheQue.front().timeout) < gs->frameNum)
@@ -104,6 +188,21 @@ void CPathCache::RemoveFrontQueItem()
 	const auto it = cachedPaths.find((cacheQue.front()).hash);
 
 	assert(it != cachedPaths.end());
+
+	{
+		const CacheItem& ci = it->second;
+		const auto cit = goalCorridors.find(GetCorridorHash(ci.goalBlock, ci.goalRadius, ci.pathType));
+
+		if (cit != goalCorridors.end()) {
+			std::vector<std::uint64_t>& hashes = cit->second;
+
+			hashes.erase(std::remove(hashes.begin(), hashes.end(), it->first), hashes.end());
+
+			if (hashes.empty())
+				goalCorridors.erase(cit);
+		}
+	}
+
 	cachedPaths.erase(it);
 	cacheQue.pop_front();
 }
@@ -146,6 +245,15 @@ std::uint64_t CPathCache::GetHash(
 	#undef N
 }
 
+std::uint64_t CPathCache::GetCorridorHash(
+	const int2 goalBlk,
+	std::uint32_t goalRadius,
+	std::int32_t pathType
+) const {
+	// same layout as GetHash without the start-block term
+	return ((goalBlk.y * numBlocksX + goalBlk.x) + (pathType * numBlocks) + (goalRadius * numBlocks * numBlocks));
+}
+
 bool CPathCache::HashCollision(
 	const CacheItem& ci,
 	const int2 strtBlk,
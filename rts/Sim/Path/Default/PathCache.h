@@ -4,6 +4,8 @@
 #define PATHCACHE_H
 
 #include <deque>
+#include <functional>
+#include <vector>
 
 #include "IPath.h"
 #include "System/type2.h"
@@ -12,7 +14,7 @@
 class CPathCache
 {
 public:
-	CPathCache(int blocksX, int blocksZ);
+	CPathCache(int blocksX, int blocksZ, int blockSize, bool spliceCachedPaths);
 	~CPathCache();
 
 	struct CacheItem {
@@ -34,16 +36,38 @@ public:
 		int pathType
 	);
 
+	// on a miss, the request may be spliced onto a cached path to the same
+	// goal at a node whose block <isReachable> says can be reached from the
+	// start-block (only if spliceCachedPaths was set)
 	const CacheItem& GetCachedPath(
 		const int2 strtBlock,
 		const int2 goalBlock,
 		float goalRadius,
-		int pathType
+		int pathType,
+		const std::function<bool(const int2)>& isReachable
 	);
 
+	std::uint32_t GetNumCacheHits() const { return numCacheHits; }
+	std::uint32_t GetNumCacheSplices() const { return numCacheSplices; }
+	std::uint32_t GetNumCacheMisses() const { return numCacheMisses; }
+
 private:
 	void RemoveFrontQueItem();
 
+	const CacheItem* SpliceCachedPath(
+		const int2 strtBlock,
+		const int2 goalBlock,
+		float goalRadius,
+		int pathType,
+		const std::function<bool(const int2)>& isReachable
+	);
+
+	std::uint64_t GetCorridorHash(
+		const int2 goalBlk,
+		std::uint32_t goalRadius,
+		std::int32_t pathType
+	) const;
+
 	std::uint64_t GetHash(
 		const int2 strtBlk,
 		const int2 goalBlk,
@@ -74,16 +98,28 @@ private:
 
 	// returned on any cache-miss
 	CacheItem dummyCacheItem;
+	// returned when a request was spliced onto a cached corridor
+	CacheItem splicedCacheItem;
 
 	std::deque<CacheQueItem> cacheQue;
 	spring::unordered_map<std::uint64_t, CacheItem> cachedPaths; // ints are sync-safe keys
+	// hashes of all successful cachedPaths leading to the same goal (in insertion order)
+	spring::unordered_map<std::uint64_t, std::vector<std::uint64_t>> goalCorridors;
 
 	std::uint32_t numBlocksX;
 	std::uint32_t numBlocksZ;
 	std::uint64_t numBlocks;
+	std::uint32_t blockPixelSize;
+
+	// maximum (Chebyshev) block-distance between a request's start
+	// and the corridor waypoint onto which it may be spliced
+	std::int32_t maxSpliceDist;
+
+	bool spliceCachedPaths;
 
 	std::uint64_t maxCacheSize;
 	std::uint32_t numCacheHits;
+	std::uint32_t numCacheSplices;
 	std::uint32_t numCacheMisses;
 	std::uint32_t numHashCollisions;
 };
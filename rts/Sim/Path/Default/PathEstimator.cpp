@@ -4,6 +4,10 @@
 
 #include "minizip/zip.h"
 
+#include <array>
+#include <cstdio>
+#include <fstream>
+
 #include "PathEstimator.h"
 #include "PathFinder.h"
 #include "PathFinderDef.h"
@@ -18,6 +22,7 @@
 #include "Sim/MoveTypes/MoveMath/MoveMath.h"
 #include "Net/Protocol/NetProtocol.h"
 #include "System/Threading/ThreadPool.h" // for_mt
+#include "System/MemoryStats.h"
 #include "System/TimeProfiler.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/Archives/IArchive.h"
@@ -34,20 +39,60 @@
 
 CONFIG(int, PathingThreadCount).defaultValue(0).safemodeValue(1).minimumValue(0);
 CONFIG(int, MaxPathCostsMemoryFootPrint).defaultValue(512).minimumValue(64).description("Maximum memusage (in MByte) of multithreaded pathcache generator at loading time.");
+CONFIG(bool, PathCacheMapped).defaultValue(false).description("Store pathcaches uncompressed and memory-map them at loading time. Loads much faster and lets processes on the same host share the pages, but needs more disk space.");
 
 PCMemPool pcMemPool;
 PEMemPool peMemPool;
 
+static MemoryStats::Registrar pathMemPoolStats("Sim::Path::MemPool", []() {
+	const MemoryStats::Usage pcUsage = MemoryStats::GetPoolUsage(pcMemPool);
+	const MemoryStats::Usage peUsage = MemoryStats::GetPoolUsage(peMemPool);
+	const MemoryStats::Usage pfUsage = MemoryStats::GetPoolUsage(pfMemPool);
+
+	return MemoryStats::Usage{pcUsage.liveBytes + peUsage.liveBytes + pfUsage.liveBytes, pcUsage.peakBytes + peUsage.peakBytes + pfUsage.peakBytes};
+});
+
 
 static const std::string GetPathCacheDir() {
 	return (FileSystem::GetCacheDir() + "/paths/");
 }
 
-static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName) {
-	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + ".zip");
+static const std::string GetCacheFileName(const std::string& fileHashCode, const std::string& peFileName, const std::string& mapFileName, bool mapped = false) {
+	return (GetPathCacheDir() + mapFileName + "." + peFileName + "-" + fileHashCode + (mapped? ".pec": ".zip"));
+}
+
+
+// layout of the uncompressed cache-file: this header, followed by the
+// node-offsets of all path-types and then all vertex-costs; each array
+// starts on its own page so the vertex-costs can be used in-place
+struct MappedCacheHeader {
+	char magic[4];
+	std::uint32_t version;
+	std::uint32_t hashCode;
+	std::uint32_t blockSize;
+	std::uint32_t numPathTypes;
+	std::uint32_t numBlocks;
+	std::uint32_t numVertexCosts;
+	std::uint32_t padding;
+	std::uint64_t nodeOffsetsPos;
+	std::uint64_t vertexCostsPos;
+};
+
+static constexpr char MAPPED_CACHE_MAGIC[4] = {'S', 'P', 'E', 'C'};
+static constexpr std::uint32_t MAPPED_CACHE_VERSION = 1;
+static constexpr std::uint64_t MAPPED_CACHE_ALIGNMENT = 4096;
+
+static std::uint64_t AlignCacheFilePos(std::uint64_t pos) {
+	return ((pos + MAPPED_CACHE_ALIGNMENT - 1) & ~(MAPPED_CACHE_ALIGNMENT - 1));
 }
 
 
+// parts of a block that are recalculated by Update; the lower bits
+// select which of the vertices owned by the block are out of date
+static constexpr unsigned int BLOCK_UPDATE_EDGES  = (1 << PATH_DIRECTION_VERTICES) - 1;
+static constexpr unsigned int BLOCK_UPDATE_OFFSET = (1 << PATH_DIRECTION_VERTICES);
+
+
 static size_t GetNumThreads() {
 	const size_t numThreads = std::max(0, configHandler->GetInt("PathingThreadCount"));
 	const size_t numCores = Threading::GetLogicalCpuCores();
@@ -70,20 +115,28 @@ void CPathEstimator::Init(IPathFinder* pf, unsigned int BLOCK_SIZE, const std::s
 		pathChecksum = 0;
 		fileHashCode = CalcHash(__func__);
 
-		offsetBlockNum = {nbrOfBlocks.x * nbrOfBlocks.y};
-		costBlockNum = {nbrOfBlocks.x * nbrOfBlocks.y};
+		offsetRowNum = {nbrOfBlocks.y};
+		costRowNum = {nbrOfBlocks.y};
 
 		parentPathFinder = pf;
 		nextPathEstimator = nullptr;
 	}
 	{
-		vertexCosts.clear();
-		vertexCosts.resize(moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES, PATHCOST_INFINITY);
+		numVertexCosts = moveDefHandler.GetNumMoveDefs() * blockStates.GetSize() * PATH_DIRECTION_VERTICES;
+
+		vertexCostsFile.Close();
+		vertexCostsData.clear();
+		vertexCostsData.resize(numVertexCosts, PATHCOST_INFINITY);
+		vertexCosts = vertexCostsData.data();
 		maxSpeedMods.clear();
 		maxSpeedMods.resize(moveDefHandler.GetNumMoveDefs(), 0.001f);
 
 		updatedBlocks.clear();
+		blockUpdateMasks.clear();
+		blockUpdateMasks.resize(blockStates.GetSize(), 0);
+		dirtyBlockRects.clear();
 		consumedBlocks.clear();
+		consumedEdges.clear();
 		offsetBlocksSortedByCost.clear();
 	}
 
@@ -117,9 +170,13 @@ void CPathEstimator::Init(IPathFinder* pf, unsigned int BLOCK_SIZE, const std::s
 		for_mt(0, moveDefHandler.GetNumMoveDefs(), [&](unsigned int i) {
 			const MoveDef* md = moveDefHandler.GetMoveDefByPathType(i);
 
+			std::vector<float> rowSpeedMods(mapDims.mapx);
+
 			for (int y = 0; y < mapDims.mapy; y++) {
-				for (int x = 0; x < mapDims.mapx; x++) {
-					childPE->maxSpeedMods[i] = std::max(childPE->maxSpeedMods[i], CMoveMath::GetPosSpeedMod(*md, x, y));
+				CMoveMath::GetRowSpeedMods(*md, 0, mapDims.mapx, y, rowSpeedMods.data());
+
+				for (const float speedMod: rowSpeedMods) {
+					childPE->maxSpeedMods[i] = std::max(childPE->maxSpeedMods[i], speedMod);
 				}
 			}
 		});
@@ -140,16 +197,24 @@ void CPathEstimator::Kill()
 {
 	pcMemPool.free(pathCache[0]);
 	pcMemPool.free(pathCache[1]);
+
+	vertexCosts = nullptr;
+	numVertexCosts = 0;
+
+	vertexCostsFile.Close();
+	vertexCostsData.clear();
+
+	KillUpdatePathFinders();
 }
 
 
 void CPathEstimator::InitEstimator(const std::string& peFileName, const std::string& mapFileName)
 {
-	const unsigned int numThreads = GetNumThreads();
+	// PathingThreadCount only caps the number of tasks, extra ones
+	// beyond the ThreadPool size would just cost CPathFinder memory
+	const unsigned int numThreads = std::min(GetNumThreads(), size_t(ThreadPool::GetNumThreads()));
 
-	if (threads.size() != numThreads) {
-		threads.clear();
-		threads.resize(numThreads);
+	if (pathFinders.size() != numThreads) {
 		pathFinders.clear();
 		pathFinders.resize(numThreads);
 	}
@@ -162,7 +227,7 @@ void CPathEstimator::InitEstimator(const std::string& peFileName, const std::str
 	InitBlocks();
 
 	if (!ReadFile(peFileName, mapFileName)) {
-		// start extra threads if applicable, but always keep the total
+		// run extra tasks if applicable, but always keep the total
 		// memory-footprint made by CPathFinder instances within bounds
 		const unsigned int minMemFootPrint = sizeof(CPathFinder) + parentPathFinder->GetMemFootPrint();
 		const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
@@ -183,19 +248,19 @@ void CPathEstimator::InitEstimator(const std::string& peFileName, const std::str
 		}
 
 
-		// note: only really needed if numExtraThreads > 0
-		spring::barrier pathBarrier(numExtraThreads + 1);
-
 		for (unsigned int i = 1; i <= numExtraThreads; i++) {
 			pathFinders[i] = pfMemPool.alloc<CPathFinder>(true);
-			threads[i] = std::move(spring::thread(&CPathEstimator::CalcOffsetsAndPathCosts, this, i, &pathBarrier));
 		}
 
-		// Use the current thread as thread zero
-		CalcOffsetsAndPathCosts(0, &pathBarrier);
+		// NOTE: EstimatePathCosts() [B] is temporally dependent on CalculateBlockOffsets() [A],
+		// A must be completely finished before B_i can be safely called; each for_mt returns
+		// only when all of its tasks are done and so doubles as the barrier between both
+		// every task owns pathFinders[taskNum] and keeps claiming rows until none are left,
+		// s.t. tasks which draw cheap rows (e.g. near map borders) simply process more
+		for_mt(0, numExtraThreads + 1, [&](const int taskNum) { CalcBlockOffsetRows(taskNum); });
+		for_mt(0, numExtraThreads + 1, [&](const int taskNum) { CalcPathCostRows(taskNum); });
 
 		for (unsigned int i = 1; i <= numExtraThreads; i++) {
-			threads[i].join();
 			pfMemPool.free(pathFinders[i]);
 		}
 
@@ -216,8 +281,8 @@ void CPathEstimator::InitEstimator(const std::string& peFileName, const std::str
 	pfMemPool.free(pathFinders[0]);
 	pathFinders[0] = parentPathFinder;
 
-	pathCache[0] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y);
-	pathCache[1] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y);
+	pathCache[0] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y, BLOCK_SIZE, modInfo.pfSpliceCachedPaths);
+	pathCache[1] = pcMemPool.alloc<CPathCache>(nbrOfBlocks.x, nbrOfBlocks.y, BLOCK_SIZE, modInfo.pfSpliceCachedPaths);
 }
 
 
@@ -231,30 +296,36 @@ void CPathEstimator::InitBlocks()
 
 
 __FORCE_ALIGN_STACK__
-void CPathEstimator::CalcOffsetsAndPathCosts(unsigned int threadNum, spring::barrier* pathBarrier)
+void CPathEstimator::CalcBlockOffsetRows(unsigned int taskNum)
 {
 	// reset FPU state for synced computations
 	streflop::streflop_init<streflop::Simple>();
 
-	if (threadNum > 0) {
-		Threading::SetAffinity(~0);
-		Threading::SetThreadName(IntToString(threadNum, "pathhelper%i"));
+	std::int64_t i;
+
+	while ((i = --offsetRowNum) >= 0) {
+		const unsigned int rowBlockIdx = (nbrOfBlocks.y - 1 - i) * nbrOfBlocks.x;
+
+		for (int x = 0; x < nbrOfBlocks.x; x++) {
+			CalculateBlockOffsets(rowBlockIdx + x, taskNum);
+		}
 	}
+}
 
-	// NOTE: EstimatePathCosts() [B] is temporally dependent on CalculateBlockOffsets() [A],
-	// A must be completely finished before B_i can be safely called. This means we cannot
-	// let thread i execute (A_i, B_i), but instead have to split the work such that every
-	// thread finishes its part of A before any starts B_i.
-	const unsigned int maxBlockIdx = blockStates.GetSize() - 1;
-	int i;
+__FORCE_ALIGN_STACK__
+void CPathEstimator::CalcPathCostRows(unsigned int taskNum)
+{
+	streflop::streflop_init<streflop::Simple>();
 
-	while ((i = --offsetBlockNum) >= 0)
-		CalculateBlockOffsets(maxBlockIdx - i, threadNum);
+	std::int64_t i;
 
-	pathBarrier->wait();
+	while ((i = --costRowNum) >= 0) {
+		const unsigned int rowBlockIdx = (nbrOfBlocks.y - 1 - i) * nbrOfBlocks.x;
 
-	while ((i = --costBlockNum) >= 0)
-		EstimatePathCosts(maxBlockIdx - i, threadNum);
+		for (int x = 0; x < nbrOfBlocks.x; x++) {
+			EstimatePathCosts(rowBlockIdx + x, taskNum);
+		}
+	}
 }
 
 
@@ -262,7 +333,7 @@ void CPathEstimator::CalculateBlockOffsets(unsigned int blockIdx, unsigned int t
 {
 	const int2 blockPos = BlockIdxToPos(blockIdx);
 
-	if (threadNum == 0 && blockIdx >= nextOffsetMessageIdx) {
+	if (ThreadPool::GetThreadNum() == 0 && blockIdx >= nextOffsetMessageIdx) {
 		nextOffsetMessageIdx = blockIdx + blockStates.GetSize() / 16;
 		clientNet->Send(CBaseNetProtocol::Get().SendCPUUsage(BLOCK_SIZE | (blockIdx << 8)));
 	}
@@ -279,7 +350,7 @@ void CPathEstimator::EstimatePathCosts(unsigned int blockIdx, unsigned int threa
 {
 	const int2 blockPos = BlockIdxToPos(blockIdx);
 
-	if (threadNum == 0 && blockIdx >= nextCostMessageIdx) {
+	if (ThreadPool::GetThreadNum() == 0 && blockIdx >= nextCostMessageIdx) {
 		nextCostMessageIdx = blockIdx + blockStates.GetSize() / 16;
 
 		char calcMsg[128];
@@ -365,17 +436,17 @@ void CPathEstimator::CalcVertexPathCosts(const MoveDef& moveDef, int2 block, uns
 	// see GetBlockVertexOffset(); costs are bi-directional and only
 	// calculated for *half* the outgoing edges (while costs for the
 	// other four directions are stored at the adjacent vertices)
-	CalcVertexPathCost(moveDef, block, PATHDIR_LEFT,     threadNum);
-	CalcVertexPathCost(moveDef, block, PATHDIR_LEFT_UP,  threadNum);
-	CalcVertexPathCost(moveDef, block, PATHDIR_UP,       threadNum);
-	CalcVertexPathCost(moveDef, block, PATHDIR_RIGHT_UP, threadNum);
+	CalcVertexPathCost(moveDef, block, PATHDIR_LEFT,     pathFinders[threadNum]);
+	CalcVertexPathCost(moveDef, block, PATHDIR_LEFT_UP,  pathFinders[threadNum]);
+	CalcVertexPathCost(moveDef, block, PATHDIR_UP,       pathFinders[threadNum]);
+	CalcVertexPathCost(moveDef, block, PATHDIR_RIGHT_UP, pathFinders[threadNum]);
 }
 
 void CPathEstimator::CalcVertexPathCost(
 	const MoveDef& moveDef,
 	int2 parentBlockPos,
 	unsigned int pathDir,
-	unsigned int threadNum
+	IPathFinder* pathFinder
 ) {
 	const int2 childBlockPos = parentBlockPos + PE_DIRECTION_VECTORS[pathDir];
 
@@ -419,9 +490,9 @@ void CPathEstimator::CalcVertexPathCost(
 
 	// find path from parent to child block
 	//
-	// since CPathFinder::GetPath() is not thread-safe, use
-	// this thread's "private" CPathFinder instance (rather
-	// than locking parentPathFinder->GetPath()) if we are
+	// since CPathFinder::GetPath() is not thread-safe, the
+	// caller passes this thread's "private" CPathFinder instance
+	// (rather than locking parentPathFinder->GetPath()) if we are
 	// invoked in one
 	pfDef.skipSubSearches = true;
 	pfDef.testMobile      = false;
@@ -430,7 +501,7 @@ void CPathEstimator::CalcVertexPathCost(
 	pfDef.dirIndependent  = true;
 
 	IPath::Path path;
-	IPath::SearchResult result = pathFinders[threadNum]->GetPath(moveDef, pfDef, nullptr, startPos, path, MAX_SEARCHED_NODES_PF >> 2);
+	IPath::SearchResult result = pathFinder->GetPath(moveDef, pfDef, nullptr, startPos, path, MAX_SEARCHED_NODES_PF >> 2);
 
 	// store the result
 	if (result == IPath::Ok) {
@@ -449,28 +520,158 @@ void CPathEstimator::MapChanged(unsigned int x1, unsigned int z1, unsigned int x
 	assert(x2 >= x1);
 	assert(z2 >= z1);
 
+	// speedmods depend on slope, so squares bordering the area can change too
+	MarkSquaresDirty(int(x1) - 1, int(z1) - 1, int(x2) + 1, int(z2) + 1);
+}
+
+void CPathEstimator::MarkSquaresDirty(int x1, int z1, int x2, int z2)
+{
 	// find the upper and lower corner of the rectangular area
-	const int lowerX = Clamp(int(x1 / BLOCK_SIZE) - 1, 0, int(nbrOfBlocks.x - 1));
-	const int upperX = Clamp(int(x2 / BLOCK_SIZE) + 1, 0, int(nbrOfBlocks.x - 1));
-	const int lowerZ = Clamp(int(z1 / BLOCK_SIZE) - 1, 0, int(nbrOfBlocks.y - 1));
-	const int upperZ = Clamp(int(z2 / BLOCK_SIZE) + 1, 0, int(nbrOfBlocks.y - 1));
+	SRectangle r;
+	r.x1 = Clamp(x1 / int(BLOCK_SIZE), 0, int(nbrOfBlocks.x - 1));
+	r.x2 = Clamp(x2 / int(BLOCK_SIZE), 0, int(nbrOfBlocks.x - 1));
+	r.z1 = Clamp(z1 / int(BLOCK_SIZE), 0, int(nbrOfBlocks.y - 1));
+	r.z2 = Clamp(z2 / int(BLOCK_SIZE), 0, int(nbrOfBlocks.y - 1));
+
+	const auto GetArea = [](const SRectangle& a) { return ((a.x2 - a.x1 + 1) * (a.z2 - a.z1 + 1)); };
+
+	// merge with pending rectangles that overlap this one, as long as
+	// the union does not cover more blocks than the two would separately
+	// (repeated impacts in one area otherwise queue the same blocks many
+	// times before Update gets to them)
+	for (size_t i = 0; i < dirtyBlockRects.size(); ) {
+		const SRectangle& dr = dirtyBlockRects[i];
+
+		if (dr.x1 > r.x2 || dr.x2 < r.x1 || dr.z1 > r.z2 || dr.z2 < r.z1) {
+			i++;
+			continue;
+		}
+
+		const SRectangle ur = {std::min(r.x1, dr.x1), std::min(r.z1, dr.z1), std::max(r.x2, dr.x2), std::max(r.z2, dr.z2)};
 
+		if (GetArea(ur) > (GetArea(r) + GetArea(dr))) {
+			i++;
+			continue;
+		}
+
+		r = ur;
+
+		dirtyBlockRects[i] = dirtyBlockRects.back();
+		dirtyBlockRects.pop_back();
+
+		// the union can overlap rectangles checked earlier
+		i = 0;
+	}
+
+	dirtyBlockRects.push_back(r);
+}
+
+void CPathEstimator::MarkBlocksDirty(const SRectangle& r)
+{
 	// mark the blocks inside the rectangle, enqueue them
 	// from upper to lower because of the placement of the
 	// bi-directional vertices
-	for (int z = upperZ; z >= lowerZ; z--) {
-		for (int x = upperX; x >= lowerX; x--) {
-			const int idx = BlockPosToIdx(int2(x, z));
+	for (int z = r.z2; z >= r.z1; z--) {
+		for (int x = r.x2; x >= r.x1; x--) {
+			QueueBlockUpdate(int2(x, z), BLOCK_UPDATE_OFFSET | BLOCK_UPDATE_EDGES);
 
-			if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) != 0)
-				continue;
+			// the remaining edges to and from this block are stored
+			// at the vertices of the neighbors that they lead from
+			for (unsigned int pathDir = 0; pathDir < PATH_DIRECTION_VERTICES; pathDir++) {
+				const int2 ngbBlockPos = int2(x, z) - PE_DIRECTION_VECTORS[pathDir];
+
+				if ((unsigned)ngbBlockPos.x >= nbrOfBlocks.x || (unsigned)ngbBlockPos.y >= nbrOfBlocks.y)
+					continue;
 
-			updatedBlocks.emplace_back(x, z);
-			blockStates.nodeMask[idx] |= PATHOPT_OBSOLETE;
+				QueueBlockUpdate(ngbBlockPos, 1 << pathDir);
+			}
 		}
 	}
 }
 
+void CPathEstimator::QueueBlockUpdate(int2 blockPos, unsigned int updateMask)
+{
+	const int idx = BlockPosToIdx(blockPos);
+
+	blockUpdateMasks[idx] |= updateMask;
+
+	if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) != 0)
+		return;
+
+	updatedBlocks.push_back(blockPos);
+	blockStates.nodeMask[idx] |= PATHOPT_OBSOLETE;
+}
+
+unsigned int CPathEstimator::GetNumPendingBlocks() const
+{
+	unsigned int numBlocks = updatedBlocks.size();
+
+	// upper bound, rectangles can still overlap queued blocks
+	for (const SRectangle& r: dirtyBlockRects) {
+		numBlocks += ((r.x2 - r.x1 + 1) * (r.z2 - r.z1 + 1));
+	}
+
+	return numBlocks;
+}
+
+size_t CPathEstimator::GetMemFootPrint() const
+{
+	size_t memFootPrint = IPathFinder::GetMemFootPrint();
+
+	memFootPrint += (numVertexCosts * sizeof(float));
+	memFootPrint += (maxSpeedMods.capacity() * sizeof(float));
+	memFootPrint += (blockUpdateMasks.capacity() * sizeof(std::uint8_t));
+	memFootPrint += (offsetBlocksSortedByCost.capacity() * sizeof(SOffsetBlock));
+
+	// the update helpers keep their own node-state buffers
+	for (const IPathFinder* pf: updatePathFinders) {
+		if (pf != parentPathFinder)
+			memFootPrint += pf->GetMemFootPrint();
+	}
+
+	return memFootPrint;
+}
+
+
+bool CPathEstimator::InitUpdatePathFinders()
+{
+	if (!updatePathFinders.empty())
+		return (updatePathFinders.size() > 1);
+
+	updatePathFinders.push_back(parentPathFinder);
+
+	// a parent estimator (low-res PE) keeps per-search state and
+	// its own cache, so it can not be duplicated for helper threads
+	const CPathFinder* parentPF = dynamic_cast<const CPathFinder*>(parentPathFinder);
+
+	if (parentPF == nullptr)
+		return false;
+
+	// same memory-bound as InitEstimator, these stay around until Kill
+	const unsigned int minMemFootPrint = sizeof(CPathFinder) + parentPathFinder->GetMemFootPrint();
+	const unsigned int maxMemFootPrint = configHandler->GetInt("MaxPathCostsMemoryFootPrint") * 1024 * 1024;
+	const unsigned int numExtraThreads = Clamp(int(maxMemFootPrint / minMemFootPrint) - 1, 0, ThreadPool::GetNumThreads() - 1);
+
+	for (unsigned int i = 1; i <= numExtraThreads; i++) {
+		CPathFinder* pf = pfMemPool.alloc<CPathFinder>(true);
+
+		// results must not depend on which instance ran a search
+		pf->SetExtraCostStates(&parentPathFinder->GetNodeStateBuffer());
+		updatePathFinders.push_back(pf);
+	}
+
+	return (updatePathFinders.size() > 1);
+}
+
+void CPathEstimator::KillUpdatePathFinders()
+{
+	for (size_t i = 1; i < updatePathFinders.size(); i++) {
+		pfMemPool.free(updatePathFinders[i]);
+	}
+
+	updatePathFinders.clear();
+}
+
 
 /**
  * Update some obsolete blocks using the FIFO-principle
@@ -485,6 +686,24 @@ void CPathEstimator::Update()
 	if (numMoveDefs == 0)
 		return;
 
+	for (const SRectangle& r: dirtyBlockRects) {
+		MarkBlocksDirty(r);
+	}
+
+	dirtyBlockRects.clear();
+
+	profiler.SetCounter((BLOCK_SIZE == LOWRES_PE_BLOCKSIZE)? "Sim::Path::Estimator::PendingBlocks::LowRes": "Sim::Path::Estimator::PendingBlocks::MedRes", updatedBlocks.size());
+
+	if (BLOCK_SIZE == LOWRES_PE_BLOCKSIZE) {
+		profiler.SetCounter("Sim::Path::Estimator::CacheHits::LowRes", pathCache[0]->GetNumCacheHits() + pathCache[1]->GetNumCacheHits());
+		profiler.SetCounter("Sim::Path::Estimator::CacheSplices::LowRes", pathCache[0]->GetNumCacheSplices() + pathCache[1]->GetNumCacheSplices());
+		profiler.SetCounter("Sim::Path::Estimator::CacheMisses::LowRes", pathCache[0]->GetNumCacheMisses() + pathCache[1]->GetNumCacheMisses());
+	} else {
+		profiler.SetCounter("Sim::Path::Estimator::CacheHits::MedRes", pathCache[0]->GetNumCacheHits() + pathCache[1]->GetNumCacheHits());
+		profiler.SetCounter("Sim::Path::Estimator::CacheSplices::MedRes", pathCache[0]->GetNumCacheSplices() + pathCache[1]->GetNumCacheSplices());
+		profiler.SetCounter("Sim::Path::Estimator::CacheMisses::MedRes", pathCache[0]->GetNumCacheMisses() + pathCache[1]->GetNumCacheMisses());
+	}
+
 	// determine how many blocks we should update
 	int blocksToUpdate = 0;
 	int consumeBlocks = 0;
@@ -510,39 +729,57 @@ void CPathEstimator::Update()
 	if (updatedBlocks.empty())
 		return;
 
+	// the budget is spent per vertex rather than per block, since blocks
+	// that are only queued for an edge leading into a changed neighbor
+	// are much cheaper than changed blocks
+	// NOTE: must stay independent of wall-clock time, vertex-costs are synced
+	const unsigned int edgesToUpdate = blocksToUpdate * PATH_DIRECTION_VERTICES;
+
 	consumedBlocks.clear();
 	consumedBlocks.reserve(consumeBlocks);
+	consumedEdges.clear();
+	consumedEdges.reserve(consumeBlocks * PATH_DIRECTION_VERTICES);
 
 	// get blocks to update
 	while (!updatedBlocks.empty()) {
 		const int2& pos = updatedBlocks.front();
 		const int idx = BlockPosToIdx(pos);
 
-		if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) == 0) {
+		const unsigned int updateMask = blockUpdateMasks[idx];
+
+		if ((blockStates.nodeMask[idx] & PATHOPT_OBSOLETE) == 0 || updateMask == 0) {
 			updatedBlocks.pop_front();
 			continue;
 		}
 
-		if (consumedBlocks.size() >= blocksToUpdate)
+		if (consumedEdges.size() >= edgesToUpdate)
 			break;
 
 		// issue repathing for all active movedefs
 		for (unsigned int i = 0; i < numMoveDefs; i++) {
 			const MoveDef* md = moveDefHandler.GetMoveDefByPathType(i);
 
-			consumedBlocks.emplace_back(pos, md);
+			if ((updateMask & BLOCK_UPDATE_OFFSET) != 0)
+				consumedBlocks.emplace_back(pos, md);
+
+			for (unsigned int pathDir = 0; pathDir < PATH_DIRECTION_VERTICES; pathDir++) {
+				if ((updateMask & (1 << pathDir)) == 0)
+					continue;
+
+				consumedEdges.emplace_back(pos, md, pathDir);
+			}
 		}
 
 		// inform dependent estimator that costs were updated and it should do the same
 		// FIXME?
 		//   adjacent med-res PE blocks will cause a low-res block to be updated twice
-		//   (in addition to the overlap that already exists because MapChanged() adds
-		//   boundary blocks)
+		//   (merging of dirty rectangles only catches the overlapping cases)
 		if (true && nextPathEstimator != nullptr)
-			nextPathEstimator->MapChanged(pos.x * BLOCK_SIZE, pos.y * BLOCK_SIZE, pos.x * BLOCK_SIZE, pos.y * BLOCK_SIZE);
+			nextPathEstimator->MarkSquaresDirty(pos.x * BLOCK_SIZE, pos.y * BLOCK_SIZE, (pos.x + 1) * BLOCK_SIZE - 1, (pos.y + 1) * BLOCK_SIZE - 1);
 
 		updatedBlocks.pop_front(); // must happen _after_ last usage of the `pos` reference!
 		blockStates.nodeMask[idx] &= ~PATHOPT_OBSOLETE;
+		blockUpdateMasks[idx] = 0;
 	}
 
 	// FindOffset (threadsafe)
@@ -557,11 +794,24 @@ void CPathEstimator::Update()
 		});
 	}
 
-	// CalcVertexPathCosts (not threadsafe)
+	// CalcVertexPathCosts (threadsafe only with a private PF per thread)
 	{
 		SCOPED_TIMER("Sim::Path::Estimator::CalcVertexPathCosts");
-		for (unsigned int n = 0; n < consumedBlocks.size(); ++n) {
-			CalcVertexPathCosts(*consumedBlocks[n].moveDef, consumedBlocks[n].blockPos);
+
+		if (InitUpdatePathFinders()) {
+			// every vertex is written by exactly one edge, each task owns one PF
+			const unsigned int numTasks = updatePathFinders.size();
+
+			for_mt(0, numTasks, [&](const int t) {
+				for (unsigned int n = t; n < consumedEdges.size(); n += numTasks) {
+					const SingleEdge& se = consumedEdges[n];
+					CalcVertexPathCost(*se.moveDef, se.blockPos, se.pathDir, updatePathFinders[t]);
+				}
+			});
+		} else {
+			for (const SingleEdge& se: consumedEdges) {
+				CalcVertexPathCost(*se.moveDef, se.blockPos, se.pathDir, parentPathFinder);
+			}
 		}
 	}
 }
@@ -569,7 +819,70 @@ void CPathEstimator::Update()
 
 const CPathCache::CacheItem& CPathEstimator::GetCache(const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced) const
 {
-	return pathCache[synced]->GetCachedPath(strtBlock, goalBlock, goalRadius, pathType);
+	const auto IsReachable = [&](const int2 nodeBlock) { return (IsBlockReachable(strtBlock, nodeBlock, pathType)); };
+
+	return pathCache[synced]->GetCachedPath(strtBlock, goalBlock, goalRadius, pathType, IsReachable);
+}
+
+bool CPathEstimator::IsBlockReachable(const int2 strtBlock, const int2 goalBlock, int pathType) const
+{
+	// flood the finite-cost vertices between the two blocks, without leaving
+	// the rectangle they span (a splice is never more than a few blocks away)
+	constexpr int MAX_RECT_SIZE = 5;
+
+	const int2 rectMins = {std::min(strtBlock.x, goalBlock.x), std::min(strtBlock.y, goalBlock.y)};
+	const int2 rectMaxs = {std::max(strtBlock.x, goalBlock.x), std::max(strtBlock.y, goalBlock.y)};
+	const int2 rectSize = {rectMaxs.x - rectMins.x + 1, rectMaxs.y - rectMins.y + 1};
+
+	if (rectSize.x > MAX_RECT_SIZE || rectSize.y > MAX_RECT_SIZE)
+		return false;
+	if ((unsigned)strtBlock.x >= nbrOfBlocks.x || (unsigned)strtBlock.y >= nbrOfBlocks.y)
+		return false;
+
+	std::array<int2, MAX_RECT_SIZE * MAX_RECT_SIZE> openBlocks;
+	std::array<bool, MAX_RECT_SIZE * MAX_RECT_SIZE> seenBlocks = {};
+
+	const unsigned int vertexBaseIdx = pathType * nbrOfBlocks.x * nbrOfBlocks.y * PATH_DIRECTION_VERTICES;
+
+	size_t numOpen = 0;
+	size_t numDone = 0;
+
+	openBlocks[numOpen++] = strtBlock;
+	seenBlocks[(strtBlock.y - rectMins.y) * rectSize.x + (strtBlock.x - rectMins.x)] = true;
+
+	while (numDone < numOpen) {
+		const int2 openBlock = openBlocks[numDone++];
+
+		if (openBlock == goalBlock)
+			return true;
+
+		for (unsigned int pathDir = 0; pathDir < PATH_DIRECTIONS; pathDir++) {
+			const int2 testBlock = openBlock + PE_DIRECTION_VECTORS[pathDir];
+
+			if (testBlock.x < rectMins.x || testBlock.x > rectMaxs.x)
+				continue;
+			if (testBlock.y < rectMins.y || testBlock.y > rectMaxs.y)
+				continue;
+
+			const int seenIdx = (testBlock.y - rectMins.y) * rectSize.x + (testBlock.x - rectMins.x);
+
+			if (seenBlocks[seenIdx])
+				continue;
+
+			const unsigned int vertexCostIdx =
+				vertexBaseIdx +
+				BlockPosToIdx(openBlock) * PATH_DIRECTION_VERTICES +
+				GetBlockVertexOffset(pathDir, nbrOfBlocks.x);
+
+			if (vertexCosts[vertexCostIdx] >= PATHCOST_INFINITY)
+				continue;
+
+			seenBlocks[seenIdx] = true;
+			openBlocks[numOpen++] = testBlock;
+		}
+	}
+
+	return false;
 }
 
 void CPathEstimator::AddCache(const IPath::Path* path, const IPath::SearchResult result, const int2 strtBlock, const int2 goalBlock, float goalRadius, int pathType, const bool synced)
@@ -733,7 +1046,7 @@ bool CPathEstimator::TestBlock(
 		GetBlockVertexOffset(pathDir, nbrOfBlocks.x);
 
 	assert(testBlockIdx < blockStates.peNodeOffsets[moveDef.pathType].size());
-	assert(vertexCostIdx < vertexCosts.size());
+	assert(vertexCostIdx < numVertexCosts);
 
 	// best accessible heightmap-coordinate within tested block
 	// [DBG] const int2 openBlockSquare = blockStates.peNodeOffsets[moveDef.pathType][openBlockIdx];
@@ -932,7 +1245,12 @@ void CPathEstimator::FinishSearch(const MoveDef& moveDef, const CPathFinderDef&
 
 bool CPathEstimator::RemoveCacheFile(const std::string& peFileName, const std::string& mapFileName)
 {
-	return (FileSystem::Remove(GetCacheFileName(IntToString(fileHashCode, "%x"), peFileName, mapFileName)));
+	const std::string hashHexString = IntToString(fileHashCode, "%x");
+
+	const bool removedZip = FileSystem::Remove(GetCacheFileName(hashHexString, peFileName, mapFileName, false));
+	const bool removedMap = FileSystem::Remove(GetCacheFileName(hashHexString, peFileName, mapFileName, true));
+
+	return (removedZip || removedMap);
 }
 
 /**
@@ -940,14 +1258,19 @@ bool CPathEstimator::RemoveCacheFile(const std::string& peFileName, const std::s
  */
 bool CPathEstimator::ReadFile(const std::string& peFileName, const std::string& mapFileName)
 {
+	const bool mappedCache = configHandler->GetBool("PathCacheMapped");
+
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
-	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName);
+	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName, mappedCache);
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
 	if (!FileSystem::FileExists(cacheFileName))
 		return false;
 
+	if (mappedCache)
+		return (ReadMappedFile(cacheFileName));
+
 	std::unique_ptr<IArchive> upfile(archiveLoader.OpenArchive(dataDirsAccess.LocateFile(cacheFileName), "sdz"));
 
 	if (upfile == nullptr || !upfile->IsOpen()) {
@@ -993,12 +1316,67 @@ bool CPathEstimator::ReadFile(const std::string& peFileName, const std::string&
 	}
 
 	// read vertex-cost data
-	if (buffer.size() < (pos + vertexCosts.size() * sizeof(float))) {
+	if (buffer.size() < (pos + numVertexCosts * sizeof(float))) {
+		FileSystem::Remove(cacheFileName);
+		return false;
+	}
+
+	std::memcpy(&vertexCosts[0], &buffer[pos], numVertexCosts * sizeof(float));
+	return true;
+}
+
+/**
+ * Map an uncompressed cache-file; the vertex-costs are used in-place
+ * (copy-on-write) so only pages touched by searches are ever paged in
+ */
+bool CPathEstimator::ReadMappedFile(const std::string& cacheFileName)
+{
+	const auto RemoveFile = [&]() {
+		vertexCostsFile.Close();
 		FileSystem::Remove(cacheFileName);
 		return false;
+	};
+
+	if (!vertexCostsFile.Open(dataDirsAccess.LocateFile(cacheFileName)))
+		return (RemoveFile());
+
+	MappedCacheHeader header;
+
+	if (vertexCostsFile.GetSize() < sizeof(header))
+		return (RemoveFile());
+
+	std::memcpy(&header, vertexCostsFile.GetData(), sizeof(header));
+
+	const std::uint64_t nodeOffsetsSize = blockStates.GetSize() * sizeof(short2) * moveDefHandler.GetNumMoveDefs();
+	const std::uint64_t vertexCostsSize = numVertexCosts * sizeof(float);
+
+	if (std::memcmp(header.magic, MAPPED_CACHE_MAGIC, sizeof(header.magic)) != 0 || header.version != MAPPED_CACHE_VERSION)
+		return (RemoveFile());
+	if (header.hashCode != fileHashCode || header.blockSize != BLOCK_SIZE)
+		return (RemoveFile());
+	if (header.numPathTypes != moveDefHandler.GetNumMoveDefs() || header.numBlocks != blockStates.GetSize() || header.numVertexCosts != numVertexCosts)
+		return (RemoveFile());
+	if ((header.nodeOffsetsPos % MAPPED_CACHE_ALIGNMENT) != 0 || (header.vertexCostsPos % MAPPED_CACHE_ALIGNMENT) != 0)
+		return (RemoveFile());
+	if ((header.nodeOffsetsPos + nodeOffsetsSize) > vertexCostsFile.GetSize() || (header.vertexCostsPos + vertexCostsSize) > vertexCostsFile.GetSize())
+		return (RemoveFile());
+
+	char calcMsg[512];
+	sprintf(calcMsg, "Mapping Estimate PathCosts [%d]", BLOCK_SIZE);
+	loadscreen->SetLoadMessage(calcMsg);
+
+	// node-offsets are small and also read by other code, copy them
+	for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
+		const std::uint64_t blockSize = blockStates.GetSize() * sizeof(short2);
+		const std::uint64_t blockPos = header.nodeOffsetsPos + pathType * blockSize;
+
+		std::memcpy(&blockStates.peNodeOffsets[pathType][0], vertexCostsFile.GetData() + blockPos, blockSize);
 	}
 
-	std::memcpy(&vertexCosts[0], &buffer[pos], vertexCosts.size() * sizeof(float));
+	vertexCosts = reinterpret_cast<float*>(vertexCostsFile.GetData() + header.vertexCostsPos);
+
+	vertexCostsData.clear();
+	vertexCostsData.shrink_to_fit();
 	return true;
 }
 
@@ -1012,11 +1390,16 @@ bool CPathEstimator::WriteFile(const std::string& peFileName, const std::string&
 	if (!FileSystem::CreateDirectory(GetPathCacheDir()))
 		return false;
 
+	const bool mappedCache = configHandler->GetBool("PathCacheMapped");
+
 	const std::string hashHexString = IntToString(fileHashCode, "%x");
-	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName);
+	const std::string cacheFileName = GetCacheFileName(hashHexString, peFileName, mapFileName, mappedCache);
 
 	LOG("[PathEstimator::%s] hash=%s file=\"%s\" (exists=%d)", __func__, hashHexString.c_str(), cacheFileName.c_str(), FileSystem::FileExists(cacheFileName));
 
+	if (mappedCache)
+		return (WriteMappedFile(cacheFileName));
+
 	// open file for writing in a suitable location
 	zipFile file = zipOpen(dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE).c_str(), APPEND_STATUS_CREATE);
 
@@ -1034,7 +1417,7 @@ bool CPathEstimator::WriteFile(const std::string& peFileName, const std::string&
 	}
 
 	// write vertex-costs
-	zipWriteInFileInZip(file, vertexCosts.data(), vertexCosts.size() * sizeof(float));
+	zipWriteInFileInZip(file, vertexCosts, numVertexCosts * sizeof(float));
 
 	zipCloseFileInZip(file);
 	zipClose(file, nullptr);
@@ -1052,11 +1435,74 @@ bool CPathEstimator::WriteFile(const std::string& peFileName, const std::string&
   return true;
 }
 
+/**
+ * Write offset and vertex data uncompressed, for ReadMappedFile
+ */
+bool CPathEstimator::WriteMappedFile(const std::string& cacheFileName)
+{
+	const std::string filePath = dataDirsAccess.LocateFile(cacheFileName, FileQueryFlags::WRITE);
+	// write into a temporary file first so processes mapping the cache
+	// concurrently never see a partially written one
+	const std::string tempPath = filePath + ".tmp";
+
+	MappedCacheHeader header;
+
+	std::memcpy(header.magic, MAPPED_CACHE_MAGIC, sizeof(header.magic));
+
+	header.version = MAPPED_CACHE_VERSION;
+	header.hashCode = fileHashCode;
+	header.blockSize = BLOCK_SIZE;
+	header.numPathTypes = moveDefHandler.GetNumMoveDefs();
+	header.numBlocks = blockStates.GetSize();
+	header.numVertexCosts = numVertexCosts;
+	header.padding = 0;
+	header.nodeOffsetsPos = AlignCacheFilePos(sizeof(header));
+	header.vertexCostsPos = AlignCacheFilePos(header.nodeOffsetsPos + header.numPathTypes * header.numBlocks * sizeof(short2));
+
+	{
+		std::ofstream file(tempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+		if (!file.is_open())
+			return false;
+
+		const std::vector<char> padding(MAPPED_CACHE_ALIGNMENT, 0);
+		const auto WritePadding = [&](std::uint64_t pos) {
+			file.write(padding.data(), pos - std::uint64_t(file.tellp()));
+		};
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		WritePadding(header.nodeOffsetsPos);
+
+		for (int pathType = 0; pathType < moveDefHandler.GetNumMoveDefs(); ++pathType) {
+			file.write(reinterpret_cast<const char*>(&blockStates.peNodeOffsets[pathType][0]), blockStates.peNodeOffsets[pathType].size() * sizeof(short2));
+		}
+
+		WritePadding(header.vertexCostsPos);
+		file.write(reinterpret_cast<const char*>(vertexCosts), numVertexCosts * sizeof(float));
+
+		if (!file.good()) {
+			file.close();
+			std::remove(tempPath.c_str());
+			return false;
+		}
+	}
+
+	// rename does not replace existing files on every platform
+	std::remove(filePath.c_str());
+
+	if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+		std::remove(tempPath.c_str());
+		return false;
+	}
+
+	return true;
+}
+
 
 std::uint32_t CPathEstimator::CalcChecksum() const
 {
 	std::uint32_t chksum = 0;
-	std::uint64_t nbytes = vertexCosts.size() * sizeof(float);
+	std::uint64_t nbytes = numVertexCosts * sizeof(float);
 	std::uint64_t offset = 0;
 
 	#if (ENABLE_NETLOG_CHECKSUM == 1)
@@ -1083,10 +1529,10 @@ std::uint32_t CPathEstimator::CalcChecksum() const
 	}
 
 	{
-		nbytes = vertexCosts.size() * sizeof(float);
+		nbytes = numVertexCosts * sizeof(float);
 		offset += nbytes;
 
-		std::memcpy(&rawBytes[offset - nbytes], vertexCosts.data(), nbytes);
+		std::memcpy(&rawBytes[offset - nbytes], vertexCosts, nbytes);
 
 		sha512::calc_digest(rawBytes, shaBytes); // hash(offsets|costs)
 		sha512::dump_digest(shaBytes, hexChars); // hexify(hash)
@@ -14,6 +14,8 @@
 #include "PathConstants.h"
 #include "PathDataTypes.h"
 #include "System/float3.h"
+#include "System/Rectangle.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/Threading/SpringThreading.h"
 
 
@@ -68,9 +70,15 @@ public:
 	std::uint32_t GetPathChecksum() const { return pathChecksum; }
 
 
-	const std::vector<float>& GetVertexCosts() const { return vertexCosts; }
+	const float* GetVertexCosts() const { return vertexCosts; }
 	const std::deque<int2>& GetUpdatedBlocks() const { return updatedBlocks; }
 
+	/// number of blocks with pending offset or vertex-cost updates
+	unsigned int GetNumPendingBlocks() const;
+
+	/// includes the vertex-costs, also if they are memory-mapped
+	size_t GetMemFootPrint() const override;
+
 
 protected: // IPathFinder impl
 	IPath::SearchResult DoBlockSearch(const CSolidObject* owner, const MoveDef& moveDef, const int2 s, const int2 g);
@@ -107,19 +115,31 @@ protected: // IPathFinder impl
 	) override;
 
 private:
+	bool IsBlockReachable(const int2 strtBlock, const int2 goalBlock, int pathType) const;
+
 	void InitEstimator(const std::string& peFileName, const std::string& mapFileName);
 	void InitBlocks();
 
-	void CalcOffsetsAndPathCosts(unsigned int threadNum, spring::barrier* pathBarrier);
+	void CalcBlockOffsetRows(unsigned int taskNum);
+	void CalcPathCostRows(unsigned int taskNum);
 	void CalculateBlockOffsets(unsigned int, unsigned int);
 	void EstimatePathCosts(unsigned int, unsigned int);
 
 	int2 FindBlockPosOffset(const MoveDef&, unsigned int, unsigned int) const;
 	void CalcVertexPathCosts(const MoveDef&, int2, unsigned int threadNum = 0);
-	void CalcVertexPathCost(const MoveDef&, int2, unsigned int pathDir, unsigned int threadNum = 0);
+	void CalcVertexPathCost(const MoveDef&, int2, unsigned int pathDir, IPathFinder* pathFinder);
+
+	void MarkSquaresDirty(int x1, int z1, int x2, int z2);
+	void MarkBlocksDirty(const SRectangle& blockRect);
+	void QueueBlockUpdate(int2 blockPos, unsigned int updateMask);
+
+	bool InitUpdatePathFinders();
+	void KillUpdatePathFinders();
 
 	bool ReadFile(const std::string& peFileName, const std::string& mapFileName);
 	bool WriteFile(const std::string& peFileName, const std::string& mapFileName);
+	bool ReadMappedFile(const std::string& cacheFileName);
+	bool WriteMappedFile(const std::string& cacheFileName);
 
 	std::uint32_t CalcChecksum() const;
 	std::uint32_t CalcHash(const char* caller) const;
@@ -138,20 +158,33 @@ private:
 	std::uint32_t pathChecksum = 0;
 	std::uint32_t fileHashCode = 0;
 
-	std::atomic<std::int64_t> offsetBlockNum = {0};
-	std::atomic<std::int64_t> costBlockNum = {0};
+	// rows of blocks not yet claimed by an InitEstimator task
+	std::atomic<std::int64_t> offsetRowNum = {0};
+	std::atomic<std::int64_t> costRowNum = {0};
 
 	IPathFinder* parentPathFinder; // parent (PF if BLOCK_SIZE is 16, PE[16] if 32)
 	CPathEstimator* nextPathEstimator; // next lower-resolution estimator
 	CPathCache* pathCache[2]; // [0] = !synced, [1] = synced
 
-	std::vector<IPathFinder*> pathFinders; // InitEstimator helpers
-	std::vector<spring::thread> threads;
+	std::vector<IPathFinder*> pathFinders; // InitEstimator helpers, one per task
+
+	// per-ThreadPool-thread helpers for Update; [0] is parentPathFinder
+	std::vector<IPathFinder*> updatePathFinders;
 
 	std::vector<float> maxSpeedMods;
-	std::vector<float> vertexCosts;
+	// points into either vertexCostsData or the mapped cache-file
+	float* vertexCosts = nullptr;
+	unsigned int numVertexCosts = 0;
+
+	std::vector<float> vertexCostsData;
+	CMappedFile vertexCostsFile;
 	/// blocks that may need an update due to map changes
 	std::deque<int2> updatedBlocks;
+	/// per block, which BLOCK_UPDATE_* parts are out of date
+	std::vector<std::uint8_t> blockUpdateMasks;
+	/// changed areas (in block-coordinates, inclusive) not yet
+	/// applied to blockUpdateMasks, overlapping ones are merged
+	std::vector<SRectangle> dirtyBlockRects;
 
 	struct SOffsetBlock {
 		float cost;
@@ -164,7 +197,15 @@ private:
 		SingleBlock(const int2& pos, const MoveDef* md) : blockPos(pos), moveDef(md) {}
 	};
 
+	struct SingleEdge {
+		int2 blockPos;
+		const MoveDef* moveDef;
+		unsigned int pathDir;
+		SingleEdge(const int2& pos, const MoveDef* md, unsigned int dir) : blockPos(pos), moveDef(md), pathDir(dir) {}
+	};
+
 	std::vector<SingleBlock> consumedBlocks;
+	std::vector<SingleEdge> consumedEdges;
 	std::vector<SOffsetBlock> offsetBlocksSortedByCost;
 };
 
@@ -122,6 +122,7 @@ void CPathFinder::Init(bool threadSafe)
 	IPathFinder::Init(1);
 
 	blockCheckFunc = blockCheckFuncs[threadSafe];
+	extraCostStates = nullptr;
 	dummyCacheItem = CPathCache::CacheItem{IPath::Error, {}, {-1, -1}, {-1, -1}, -1.0f, -1};
 }
 
@@ -425,7 +426,7 @@ bool CPathFinder::TestBlock(
 
 	const float heatCost  = (pfDef.testMobile) ? (PathHeatMap::GetInstance())->GetHeatCost(square.x, square.y, moveDef, ((owner != nullptr)? owner->id: -1U)) : 0.0f;
 	//const float flowCost  = (pfDef.testMobile) ? (PathFlowMap::GetInstance())->GetFlowCost(square.x, square.y, moveDef, pathOptDir) : 0.0f;
-	const float extraCost = blockStates.GetNodeExtraCost(square.x, square.y, pfDef.synced);
+	const float extraCost = ((extraCostStates != nullptr)? extraCostStates: &blockStates)->GetNodeExtraCost(square.x, square.y, pfDef.synced);
 
 	const float dirMoveCost = (1.0f + heatCost) * PF_DIRECTION_COSTS[pathOptDir];
 	const float nodeCost = (dirMoveCost / speedMod) + extraCost;
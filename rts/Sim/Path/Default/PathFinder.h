@@ -25,6 +25,10 @@ public:
 	void Init(bool threadSafe);
 	void Kill() { IPathFinder::Kill(); }
 
+	// makes this instance use the Lua-set node extra-costs of another PF
+	// (helper instances have none of their own); nullptr means our own
+	void SetExtraCostStates(const PathNodeStateBuffer* states) { extraCostStates = states; }
+
 	typedef CMoveMath::BlockType (*BlockCheckFunc)(const MoveDef&, int, int, const CSolidObject*);
 
 protected:
@@ -102,6 +106,8 @@ private:
 
 	BlockCheckFunc blockCheckFunc;
 	CPathCache::CacheItem dummyCacheItem;
+
+	const PathNodeStateBuffer* extraCostStates = nullptr;
 };
 
 #endif // PATH_FINDER_H
@@ -0,0 +1,207 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+#include <functional>
+#include <queue>
+
+#include "PathFlowFieldCache.h"
+#include "PathConstants.h"
+#include "PathEstimator.h"
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/MoveTypes/MoveDefHandler.h"
+#include "Sim/MoveTypes/MoveMath/MoveMath.h"
+#include "System/SpringMath.h"
+
+#define MAX_FLOWFIELD_CACHE_SIZE   32
+#define MAX_FLOWFIELD_LIFETIME_SECS 10
+
+
+void CPathFlowFieldCache::Init(CPathEstimator* pe)
+{
+	pathEstimator = pe;
+
+	cacheQue.clear();
+	flowFields.clear();
+	flowFields.reserve(MAX_FLOWFIELD_CACHE_SIZE);
+}
+
+void CPathFlowFieldCache::Kill()
+{
+	pathEstimator = nullptr;
+
+	cacheQue.clear();
+	flowFields.clear();
+}
+
+void CPathFlowFieldCache::Update()
+{
+	// fields are not patched when vertex costs change, so
+	// expire them based on age rather than on last usage
+	while (!cacheQue.empty() && cacheQue.front().timeout < gs->frameNum) {
+		RemoveFrontQueItem();
+	}
+}
+
+void CPathFlowFieldCache::Clear()
+{
+	cacheQue.clear();
+	flowFields.clear();
+}
+
+
+const CPathFlowFieldCache::FlowField* CPathFlowFieldCache::GetField(const MoveDef& moveDef, const float3& goalPos, bool synced)
+{
+	// every square in a block maps to the same field, the exact goal
+	// is restored by CPathManager::FinalizePath and the last max-res
+	// refinement
+	const int2 goalBlock = GetBlockPos(goalPos);
+	const std::uint64_t hash = GetHash(goalBlock, moveDef.pathType, synced);
+	const auto iter = flowFields.find(hash);
+
+	if (iter != flowFields.end())
+		return &(iter->second);
+
+	if (cacheQue.size() >= MAX_FLOWFIELD_CACHE_SIZE)
+		RemoveFrontQueItem();
+
+	FlowField& field = flowFields[hash];
+	field.goalBlock = goalBlock;
+	field.pathType = moveDef.pathType;
+	field.synced = synced;
+
+	CalcField(field);
+
+	cacheQue.push_back({gs->frameNum + GAME_SPEED * MAX_FLOWFIELD_LIFETIME_SECS, hash});
+	return &field;
+}
+
+bool CPathFlowFieldCache::TracePath(const FlowField& field, const MoveDef& moveDef, const float3& startPos, IPath::Path& path) const
+{
+	const PathNodeStateBuffer& blockStates = pathEstimator->GetNodeStateBuffer();
+
+	const unsigned int strtBlockIdx = pathEstimator->BlockPosToIdx(GetBlockPos(startPos));
+
+	if (field.costs[strtBlockIdx] >= PATHCOST_INFINITY)
+		return false;
+
+	path.path.clear();
+	path.squares.clear();
+
+	unsigned int blockIdx = strtBlockIdx;
+
+	// the field is a shortest-path tree, so this ends at the goal block
+	// (the step limit only guards against a malformed field)
+	for (size_t n = 0, numBlocks = field.costs.size(); n < numBlocks; n++) {
+		const short2 square = blockStates.peNodeOffsets[moveDef.pathType][blockIdx];
+		const unsigned int pathDir = field.dirs[blockIdx];
+
+		path.path.emplace_back(square.x * SQUARE_SIZE, CMoveMath::yLevel(moveDef, square.x, square.y), square.y * SQUARE_SIZE);
+
+		if (pathDir == PATH_DIRECTIONS)
+			break;
+
+		blockIdx = pathEstimator->BlockPosToIdx(pathEstimator->BlockIdxToPos(blockIdx) + PE_DIRECTION_VECTORS[pathDir]);
+	}
+
+	// waypoints are consumed from the back
+	std::reverse(path.path.begin(), path.path.end());
+
+	path.pathGoal = path.path[0];
+	path.pathCost = field.costs[strtBlockIdx];
+	return true;
+}
+
+
+void CPathFlowFieldCache::CalcField(FlowField& field) const
+{
+	typedef std::pair<float, unsigned int> OpenBlock;
+
+	const PathNodeStateBuffer& blockStates = pathEstimator->GetNodeStateBuffer();
+
+	const int2 numBlocks = pathEstimator->GetNumBlocks();
+	const unsigned int blockCount = numBlocks.x * numBlocks.y;
+	const unsigned int goalBlockIdx = pathEstimator->BlockPosToIdx(field.goalBlock);
+	const unsigned int vertexBaseIdx = field.pathType * blockCount * PATH_DIRECTION_VERTICES;
+
+	const float* vertexCosts = pathEstimator->GetVertexCosts();
+
+	// ties are broken by block index, which keeps the field deterministic
+	std::priority_queue<OpenBlock, std::vector<OpenBlock>, std::greater<OpenBlock>> openBlocks;
+
+	field.costs.clear();
+	field.costs.resize(blockCount, PATHCOST_INFINITY);
+	field.dirs.clear();
+	field.dirs.resize(blockCount, PATH_DIRECTIONS);
+
+	field.costs[goalBlockIdx] = 0.0f;
+	openBlocks.emplace(0.0f, goalBlockIdx);
+
+	while (!openBlocks.empty()) {
+		const OpenBlock ob = openBlocks.top();
+
+		openBlocks.pop();
+
+		// skip stale entries of blocks that were reached more cheaply
+		if (ob.first > field.costs[ob.second])
+			continue;
+
+		const int2 openBlockPos = pathEstimator->BlockIdxToPos(ob.second);
+		const short2 openBlockSquare = blockStates.peNodeOffsets[field.pathType][ob.second];
+
+		// same as CPathEstimator::TestBlock, moving *into* the open block
+		// costs the extra-cost of its offset square
+		const float extraCost = std::max(0.0f, blockStates.GetNodeExtraCost(openBlockSquare.x, openBlockSquare.y, field.synced));
+
+		for (unsigned int pathDir = 0; pathDir < PATH_DIRECTIONS; pathDir++) {
+			const int2 testBlockPos = openBlockPos + PE_DIRECTION_VECTORS[pathDir];
+
+			if (static_cast<unsigned int>(testBlockPos.x) >= numBlocks.x)
+				continue;
+			if (static_cast<unsigned int>(testBlockPos.y) >= numBlocks.y)
+				continue;
+
+			// vertices are bi-directional, so the cost of stepping from
+			// the tested block back to the open block is stored here too
+			const unsigned int testBlockIdx = pathEstimator->BlockPosToIdx(testBlockPos);
+			const unsigned int vertexCostIdx = vertexBaseIdx + ob.second * PATH_DIRECTION_VERTICES + GetBlockVertexOffset(pathDir, numBlocks.x);
+
+			const float vertexCost = vertexCosts[vertexCostIdx];
+
+			if (vertexCost >= PATHCOST_INFINITY)
+				continue;
+
+			const float gCost = ob.first + vertexCost + extraCost;
+
+			if (gCost >= field.costs[testBlockIdx])
+				continue;
+
+			field.costs[testBlockIdx] = gCost;
+			field.dirs[testBlockIdx] = (pathDir + PATH_DIRECTION_VERTICES) % PATH_DIRECTIONS;
+
+			openBlocks.emplace(gCost, testBlockIdx);
+		}
+	}
+}
+
+void CPathFlowFieldCache::RemoveFrontQueItem()
+{
+	flowFields.erase(cacheQue.front().hash);
+	cacheQue.pop_front();
+}
+
+
+int2 CPathFlowFieldCache::GetBlockPos(const float3& pos) const
+{
+	const int2 numBlocks = pathEstimator->GetNumBlocks();
+	const int blockPixelSize = pathEstimator->GetBlockSize() * SQUARE_SIZE;
+
+	return {Clamp(int(pos.x / blockPixelSize), 0, numBlocks.x - 1), Clamp(int(pos.z / blockPixelSize), 0, numBlocks.y - 1)};
+}
+
+std::uint64_t CPathFlowFieldCache::GetHash(const int2 goalBlock, unsigned int pathType, bool synced) const
+{
+	const std::uint64_t goalBlockIdx = pathEstimator->BlockPosToIdx(goalBlock);
+
+	return ((std::uint64_t(pathType) << 33) | (std::uint64_t(synced) << 32) | goalBlockIdx);
+}
@@ -0,0 +1,73 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATH_FLOWFIELD_CACHE_H
+#define PATH_FLOWFIELD_CACHE_H
+
+#include <cinttypes>
+#include <deque>
+#include <vector>
+
+#include "IPath.h"
+#include "System/float3.h"
+#include "System/type2.h"
+#include "System/UnorderedMap.hpp"
+
+struct MoveDef;
+class CPathEstimator;
+
+// goal-centric flow-fields over the blocks of a path estimator; a single
+// Dijkstra search outward from the goal block serves every path toward it
+// (which makes mass orders cost one search rather than one per unit)
+class CPathFlowFieldCache
+{
+public:
+	struct FlowField {
+		// summed vertex costs from each block to the goal block
+		std::vector<float> costs;
+		// PATHDIR_* leading one block closer to the goal, or
+		// PATH_DIRECTIONS for the goal and unreachable blocks
+		std::vector<std::uint8_t> dirs;
+
+		int2 goalBlock;
+
+		unsigned int pathType;
+		bool synced;
+	};
+
+	void Init(CPathEstimator* pe);
+	void Kill();
+	void Update();
+	void Clear();
+
+	const FlowField* GetField(const MoveDef& moveDef, const float3& goalPos, bool synced);
+
+	/**
+	 * Follows the field from the block containing startPos to the
+	 * goal block and stores the block offsets as waypoints, in the
+	 * same (reversed) order CPathEstimator uses.
+	 * Returns false if the goal can not be reached from startPos.
+	 */
+	bool TracePath(const FlowField& field, const MoveDef& moveDef, const float3& startPos, IPath::Path& path) const;
+
+	size_t GetSize() const { return flowFields.size(); }
+
+private:
+	void CalcField(FlowField& field) const;
+	void RemoveFrontQueItem();
+
+	int2 GetBlockPos(const float3& pos) const;
+	std::uint64_t GetHash(const int2 goalBlock, unsigned int pathType, bool synced) const;
+
+private:
+	struct CacheQueItem {
+		std::int32_t timeout;
+		std::uint64_t hash;
+	};
+
+	CPathEstimator* pathEstimator = nullptr;
+
+	std::deque<CacheQueItem> cacheQue;
+	spring::unordered_map<std::uint64_t, FlowField> flowFields;
+};
+
+#endif
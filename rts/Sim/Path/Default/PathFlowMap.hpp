@@ -45,6 +45,8 @@ public:
 	const std::vector<FlowCell>& GetFrontBuffer() { return buffers[fBufferIdx]; }
 	const std::vector<FlowCell>& GetBackBuffer() { return buffers[bBufferIdx]; }
 
+	size_t GetMemFootPrint() const { return ((buffers[0].capacity() + buffers[1].capacity()) * sizeof(FlowCell)); }
+
 private:
 	unsigned int GetCellIdx(const CSolidObject*) const;
 
@@ -42,6 +42,8 @@ public:
 
 	float GetHeatCost(unsigned int x, unsigned int z, const MoveDef&, unsigned int ownerID) const;
 
+	size_t GetMemFootPrint() const { return (heatMap.capacity() * sizeof(HeatCell) + pathSquares.capacity() * sizeof(int2)); }
+
 private:
 	struct HeatCell {
 		unsigned int value = 0;
@@ -4,11 +4,13 @@
 #include "PathConstants.h"
 #include "PathFinder.h"
 #include "PathEstimator.h"
+#include "PathFlowFieldCache.h"
 #include "PathFlowMap.hpp"
 #include "PathHeatMap.hpp"
 #include "PathLog.h"
 #include "PathMemPool.h"
 #include "Map/MapInfo.h"
+#include "Sim/Misc/GlobalSynced.h"
 #include "Sim/Misc/ModInfo.h"
 #include "Sim/Objects/SolidObject.h"
 #include "Sim/MoveTypes/MoveDefHandler.h"
@@ -46,6 +48,8 @@ CPathManager::~CPathManager()
 {
 	// Finalize is not called in case of forced exit
 	if (maxResPF != nullptr) {
+		flowFieldCache.Kill();
+
 		lowResPE->Kill();
 		medResPE->Kill();
 		maxResPF->Kill();
@@ -85,6 +89,8 @@ std::int64_t CPathManager::Finalize() {
 		maxResPF->Init(false);
 		medResPE->Init(maxResPF, MEDRES_PE_BLOCKSIZE, "pe" , mapInfo->map.name);
 		lowResPE->Init(medResPE, LOWRES_PE_BLOCKSIZE, "pe2", mapInfo->map.name);
+
+		flowFieldCache.Init(medResPE);
 	}
 
 	const spring_time dt = spring_gettime() - t0;
@@ -349,6 +355,111 @@ IPath::SearchResult CPathManager::ArrangePath(
 }
 
 
+static int2 GetBlockPos(const float3& pos, unsigned int blockSize) {
+	return {int(pos.x / (blockSize * SQUARE_SIZE)), int(pos.z / (blockSize * SQUARE_SIZE))};
+}
+
+/*
+Hand out a copy of an estimator path found earlier in this frame if the
+request shares its MoveDef and goal and starts in the same or an adjacent
+block; LowRes2MedRes and MedRes2MaxRes then only have to connect startPos
+to it.
+*/
+IPath::SearchResult CPathManager::CoalescePath(
+	MultiPath* newPath,
+	const float3& startPos,
+	const float3& goalPos,
+	float goalRadius,
+	bool synced
+) const {
+	if (coalescedSearches.empty())
+		return IPath::Error;
+
+	const MoveDef* moveDef = newPath->moveDef;
+	const CPathFinderDef* pfDef = &newPath->peDef;
+
+	// same distance as in ArrangePath; requests that would be handled at
+	// a higher resolution there must not get a coarser path from a group
+	const float heurGoalDist2D = pfDef->Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE, 1) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
+	const float maxResSearchDist = MAXRES_SEARCH_DISTANCE * std::max(modInfo.pfRawDistMult, 1.0f);
+	const float medResSearchDist = std::max(maxResSearchDist, MEDRES_SEARCH_DISTANCE);
+
+	for (const CoalescedSearch& cs: coalescedSearches) {
+		if (cs.pathType != moveDef->pathType || cs.synced != synced || cs.goalRadius != goalRadius)
+			continue;
+		if (heurGoalDist2D <= ((cs.blockSize == LOWRES_PE_BLOCKSIZE)? medResSearchDist: maxResSearchDist))
+			continue;
+		if (cs.goalBlock != GetBlockPos(goalPos, cs.blockSize))
+			continue;
+
+		const int2 strtBlock = GetBlockPos(startPos, cs.blockSize);
+
+		if (std::abs(strtBlock.x - cs.strtBlock.x) > 1 || std::abs(strtBlock.y - cs.strtBlock.y) > 1)
+			continue;
+
+		if (cs.blockSize == LOWRES_PE_BLOCKSIZE) {
+			newPath->lowResPath = cs.path;
+		} else {
+			newPath->medResPath = cs.path;
+		}
+
+		return IPath::Ok;
+	}
+
+	return IPath::Error;
+}
+
+void CPathManager::AddCoalescedSearch(
+	const MultiPath* newPath,
+	const float3& startPos,
+	const float3& goalPos,
+	float goalRadius,
+	bool synced
+) {
+	// max-res paths are short and not worth sharing
+	if (!newPath->maxResPath.path.empty())
+		return;
+
+	const IPath::Path* path = &newPath->lowResPath;
+	unsigned int blockSize = LOWRES_PE_BLOCKSIZE;
+
+	if (!newPath->medResPath.path.empty()) {
+		path = &newPath->medResPath;
+		blockSize = MEDRES_PE_BLOCKSIZE;
+	}
+
+	if (path->path.empty())
+		return;
+
+	coalescedSearches.emplace_back();
+
+	CoalescedSearch& cs = coalescedSearches.back();
+	cs.path = *path;
+	cs.strtBlock = GetBlockPos(startPos, blockSize);
+	cs.goalBlock = GetBlockPos(goalPos, blockSize);
+	cs.goalRadius = goalRadius;
+	cs.pathType = newPath->moveDef->pathType;
+	cs.blockSize = blockSize;
+	cs.synced = synced;
+}
+
+
+static unsigned int GetStatsResultType(IPath::SearchResult result)
+{
+	switch (result) {
+		case IPath::Ok            : return CPathRequestStats::RESULT_FULL;
+		case IPath::CantGetCloser : return CPathRequestStats::RESULT_PARTIAL;
+		case IPath::GoalOutOfRange: return CPathRequestStats::RESULT_PARTIAL;
+		default                   : return CPathRequestStats::RESULT_FAILED;
+	}
+}
+
+std::uint64_t CPathManager::GetNumTotalTestedNodes() const
+{
+	return (maxResPF->GetNumTotalTestedBlocks() + medResPE->GetNumTotalTestedBlocks() + lowResPE->GetNumTotalTestedBlocks());
+}
+
+
 /*
 Request a new multipath, store the result and return a handle-id to it.
 */
@@ -365,6 +476,10 @@ unsigned int CPathManager::RequestPath(
 
 	// in misc since it is called from many points
 	SCOPED_TIMER("Misc::Path::RequestPath");
+
+	const spring_time requestTime = spring_gettime();
+	const std::uint64_t numTestedNodes = GetNumTotalTestedNodes();
+
 	startPos.ClampInBounds();
 	goalPos.ClampInBounds();
 
@@ -380,7 +495,14 @@ unsigned int CPathManager::RequestPath(
 	if (caller != nullptr)
 		caller->UnBlock();
 
-	const IPath::SearchResult result = ArrangePath(&newPath, moveDef, startPos, goalPos, caller);
+	IPath::SearchResult result = CoalescePath(&newPath, startPos, goalPos, goalRadius, synced);
+
+	if (result == IPath::Error) {
+		result = ArrangePath(&newPath, moveDef, startPos, goalPos, caller);
+
+		if (result == IPath::Ok)
+			AddCoalescedSearch(&newPath, startPos, goalPos, goalRadius, synced);
+	}
 
 	unsigned int pathID = 0;
 
@@ -410,10 +532,70 @@ unsigned int CPathManager::RequestPath(
 	if (caller != nullptr)
 		caller->Block();
 
+	// requests are answered synchronously, so they never spend time queued
+	pathRequestStats.AddRecord(0, (spring_gettime() - requestTime).toMicroSecsi(), GetNumTotalTestedNodes() - numTestedNodes, GetStatsResultType(result));
 	return pathID;
 }
 
 
+/*
+Request a new multipath whose med-res part follows the cached flow-field
+toward goalPos; falls back to RequestPath for short distances or if the
+goal is not reachable through the field.
+*/
+unsigned int CPathManager::RequestFlowPath(
+	CSolidObject* caller,
+	const MoveDef* moveDef,
+	float3 startPos,
+	float3 goalPos,
+	float goalRadius,
+	bool synced
+) {
+	if (!IsFinalized())
+		return 0;
+
+	SCOPED_TIMER("Misc::Path::RequestFlowPath");
+
+	const spring_time requestTime = spring_gettime();
+	const std::uint64_t numTestedNodes = GetNumTotalTestedNodes();
+
+	startPos.ClampInBounds();
+	goalPos.ClampInBounds();
+
+	goalRadius = std::max<float>(goalRadius, PATH_NODE_SPACING * SQUARE_SIZE);
+
+	MultiPath newPath = MultiPath(moveDef, startPos, goalPos, goalRadius);
+	newPath.finalGoal = goalPos;
+	newPath.caller = caller;
+	newPath.peDef.synced = synced;
+
+	// paths ArrangePath would not hand to an estimator gain nothing from a field
+	const float heurGoalDist2D = newPath.peDef.Heuristic(startPos.x / SQUARE_SIZE, startPos.z / SQUARE_SIZE, 1) + math::fabs(goalPos.y - startPos.y) / SQUARE_SIZE;
+
+	if (heurGoalDist2D <= MEDRES_SEARCH_DISTANCE)
+		return (RequestPath(caller, moveDef, startPos, goalPos, goalRadius, synced));
+
+	const CPathFlowFieldCache::FlowField* flowField = flowFieldCache.GetField(*moveDef, goalPos, synced);
+
+	if (!flowFieldCache.TracePath(*flowField, *moveDef, startPos, newPath.medResPath))
+		return (RequestPath(caller, moveDef, startPos, goalPos, goalRadius, synced));
+
+	if (caller != nullptr)
+		caller->UnBlock();
+
+	MedRes2MaxRes(newPath, startPos, caller, synced);
+	FinalizePath(&newPath, startPos, goalPos, false);
+
+	if (caller != nullptr)
+		caller->Block();
+
+	pathRequestStats.AddRecord(0, (spring_gettime() - requestTime).toMicroSecsi(), GetNumTotalTestedNodes() - numTestedNodes, CPathRequestStats::RESULT_FULL);
+
+	newPath.searchResult = IPath::Ok;
+	return (Store(newPath));
+}
+
+
 // converts part of a med-res path into a max-res path
 void CPathManager::MedRes2MaxRes(MultiPath& multiPath, const float3& startPos, const CSolidObject* owner, bool synced) const
 {
@@ -623,8 +805,15 @@ void CPathManager::Update()
 	pathFlowMap->Update();
 	pathHeatMap->Update();
 
+	// estimator costs can change below
+	coalescedSearches.clear();
+	flowFieldCache.Update();
+
 	medResPE->Update();
 	lowResPE->Update();
+
+	if ((gs->frameNum % GAME_SPEED) == 0)
+		pathRequestStats.UpdateProfiler();
 }
 
 // used to deposit heat on the heat-map as a unit moves along its path
@@ -735,6 +924,8 @@ bool CPathManager::SetNodeExtraCost(unsigned int x, unsigned int z, float cost,
 	maxResBuf.SetNodeExtraCost(x, z, cost, synced);
 	medResBuf.SetNodeExtraCost(x, z, cost, synced);
 	lowResBuf.SetNodeExtraCost(x, z, cost, synced);
+	coalescedSearches.clear();
+	flowFieldCache.Clear();
 	return true;
 }
 
@@ -753,6 +944,8 @@ bool CPathManager::SetNodeExtraCosts(const float* costs, unsigned int sizex, uns
 	maxResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	medResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
 	lowResBuf.SetNodeExtraCosts(costs, sizex, sizez, synced);
+	coalescedSearches.clear();
+	flowFieldCache.Clear();
 	return true;
 }
 
@@ -777,12 +970,29 @@ const float* CPathManager::GetNodeExtraCosts(bool synced) const {
 	return costs;
 }
 
+std::uint64_t CPathManager::GetAllocatedBytes() const {
+	std::uint64_t numBytes = 0;
+
+	if (IsFinalized()) {
+		numBytes += maxResPF->GetMemFootPrint();
+		numBytes += medResPE->GetMemFootPrint();
+		numBytes += lowResPE->GetMemFootPrint();
+	}
+
+	if (pathFlowMap != nullptr)
+		numBytes += pathFlowMap->GetMemFootPrint();
+	if (pathHeatMap != nullptr)
+		numBytes += pathHeatMap->GetMemFootPrint();
+
+	return numBytes;
+}
+
 int2 CPathManager::GetNumQueuedUpdates() const {
 	int2 data;
 
 	if (IsFinalized()) {
-		data.x = medResPE->updatedBlocks.size();
-		data.y = lowResPE->updatedBlocks.size();
+		data.x = medResPE->GetNumPendingBlocks();
+		data.y = lowResPE->GetNumPendingBlocks();
 	}
 
 	return data;
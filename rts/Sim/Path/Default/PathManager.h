@@ -8,6 +8,7 @@
 #include "Sim/Path/IPathManager.h"
 #include "IPath.h"
 #include "PathFinderDef.h"
+#include "PathFlowFieldCache.h"
 #include "System/UnorderedMap.hpp"
 
 class CSolidObject;
@@ -115,6 +116,15 @@ public:
 		bool synced
 	) override;
 
+	unsigned int RequestFlowPath(
+		CSolidObject* caller,
+		const MoveDef* moveDef,
+		float3 startPos,
+		float3 goalPos,
+		float goalRadius,
+		bool synced
+	) override;
+
 	/**
 	 * Returns waypoints of the max-resolution path segments.
 	 * @param pathID
@@ -144,6 +154,7 @@ public:
 	const float* GetNodeExtraCosts(bool) const override;
 
 	int2 GetNumQueuedUpdates() const override;
+	std::uint64_t GetAllocatedBytes() const override;
 
 
 	const CPathFinder* GetMaxResPF() const { return maxResPF; }
@@ -152,6 +163,7 @@ public:
 
 	const PathFlowMap* GetPathFlowMap() const { return pathFlowMap; }
 	const PathHeatMap* GetPathHeatMap() const { return pathHeatMap; }
+	const CPathFlowFieldCache& GetFlowFieldCache() const { return flowFieldCache; }
 
 	const spring::unordered_map<unsigned int, MultiPath>& GetPathMap() const { return pathMap; }
 
@@ -164,6 +176,22 @@ private:
 		CSolidObject* caller
 	) const;
 
+	IPath::SearchResult CoalescePath(
+		MultiPath* newPath,
+		const float3& startPos,
+		const float3& goalPos,
+		float goalRadius,
+		bool synced
+	) const;
+
+	void AddCoalescedSearch(
+		const MultiPath* newPath,
+		const float3& startPos,
+		const float3& goalPos,
+		float goalRadius,
+		bool synced
+	);
+
 	MultiPath* GetMultiPath(int pathID) { return (const_cast<MultiPath*>(GetMultiPathConst(pathID))); }
 
 	const MultiPath* GetMultiPathConst(int pathID) const {
@@ -186,6 +214,8 @@ private:
 
 	bool IsFinalized() const { return (maxResPF != nullptr); }
 
+	std::uint64_t GetNumTotalTestedNodes() const;
+
 private:
 	CPathFinder* maxResPF;
 	CPathEstimator* medResPE;
@@ -196,6 +226,27 @@ private:
 
 	spring::unordered_map<unsigned int, MultiPath> pathMap;
 
+	// estimator paths found since the last Update; requests with the same
+	// MoveDef and goal that start next to one of these (e.g. all units of
+	// a group order) reuse it and only run their own refinement searches
+	struct CoalescedSearch {
+		IPath::Path path;
+
+		int2 strtBlock;
+		int2 goalBlock;
+
+		float goalRadius;
+
+		unsigned int pathType;
+		unsigned int blockSize;
+
+		bool synced;
+	};
+
+	std::vector<CoalescedSearch> coalescedSearches;
+
+	CPathFlowFieldCache flowFieldCache;
+
 	unsigned int nextPathID;
 };
 
@@ -3,11 +3,14 @@
 #include "IPathManager.h"
 #include "Default/PathManager.h"
 #include "QTPFS/PathManager.hpp"
+#include "System/MemoryStats.h"
 #include "System/Log/ILog.h"
 
 IPathManager nullPathManager;
 IPathManager* pathManager = &nullPathManager;
 
+static MemoryStats::Registrar pathDataStats("Sim::Path::Data", []() { return MemoryStats::Usage{pathManager->GetAllocatedBytes(), 0}; });
+
 IPathManager* IPathManager::GetInstance(int type) {
 	if (pathManager == &nullPathManager) {
 		const char* fmtStr = "[IPathManager::%s] using %sPFS";
@@ -7,6 +7,7 @@
 #include <cinttypes>
 
 #include "PFSTypes.h"
+#include "PathRequestStats.h"
 #include "System/type2.h"
 #include "System/float3.h"
 
@@ -144,6 +145,23 @@ public:
 		return 0;
 	}
 
+	/**
+	 * Same as RequestPath, but allows the path manager to answer with a
+	 * path that follows a flow-field shared by every request toward the
+	 * same goal (meant for large groups given a single move order).
+	 * Path managers without flow-fields handle it as a regular request.
+	 */
+	virtual unsigned int RequestFlowPath(
+		CSolidObject* caller,
+		const MoveDef* moveDef,
+		float3 startPos,
+		float3 goalPos,
+		float goalRadius,
+		bool synced
+	) {
+		return (RequestPath(caller, moveDef, startPos, goalPos, goalRadius, synced));
+	}
+
 	/**
 	 * Whenever there are any changes in the terrain
 	 * (examples: explosions, new buildings, etc.)
@@ -170,6 +188,15 @@ public:
 	virtual const float* GetNodeExtraCosts(bool synced) const { return nullptr; }
 
 	virtual int2 GetNumQueuedUpdates() const { return (int2(0, 0)); }
+	/// bytes held by the path-finding data (estimator tables, heat- and flow-maps, ...)
+	virtual std::uint64_t GetAllocatedBytes() const { return 0; }
+
+	const CPathRequestStats& GetPathRequestStats() const { return pathRequestStats; }
+	      CPathRequestStats& GetPathRequestStats()       { return pathRequestStats; }
+
+protected:
+	// filled by implementations with every request they answer
+	CPathRequestStats pathRequestStats;
 };
 
 extern IPathManager* pathManager;
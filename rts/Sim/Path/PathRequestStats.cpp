@@ -0,0 +1,56 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include <algorithm>
+
+#include "PathRequestStats.h"
+#include "System/TimeProfiler.h"
+
+void CPathRequestStats::UpdateProfiler() const
+{
+	const Histograms& h = GetHistograms();
+	const std::uint32_t n = std::max(h.numRecords, 1u);
+
+	profiler.SetCounter("Sim::Path::Requests::Full", h.resultTypes[RESULT_FULL]);
+	profiler.SetCounter("Sim::Path::Requests::Partial", h.resultTypes[RESULT_PARTIAL]);
+	profiler.SetCounter("Sim::Path::Requests::Failed", h.resultTypes[RESULT_FAILED]);
+	profiler.SetCounter("Sim::Path::Requests::AvgQueueFrames", h.sumQueueFrames / n);
+	profiler.SetCounter("Sim::Path::Requests::AvgSearchMicros", h.sumSearchTimes / n);
+	profiler.SetCounter("Sim::Path::Requests::AvgExpandedNodes", h.sumExpandedNodes / n);
+}
+
+CPathRequestStats::Histograms CPathRequestStats::GetHistograms() const
+{
+	Histograms h = {};
+	h.numRecords = std::min(numTotalRecords, std::uint64_t(NUM_RECORDS));
+
+	for (unsigned int i = 0; i < h.numRecords; i++) {
+		const Record& r = records[i];
+
+		h.queueFrames[GetHistBin(r.queueFrames, QUEUE_BIN_SHIFT)] += 1;
+		h.searchTimes[GetHistBin(r.searchTime, TIME_BIN_SHIFT)] += 1;
+		h.expandedNodes[GetHistBin(r.numNodes, NODE_BIN_SHIFT)] += 1;
+		h.resultTypes[std::min(r.resultType, NUM_RESULTS - 1u)] += 1;
+
+		h.sumQueueFrames += r.queueFrames;
+		h.sumSearchTimes += r.searchTime;
+		h.sumExpandedNodes += r.numNodes;
+	}
+
+	return h;
+}
+
+unsigned int CPathRequestStats::GetHistBin(std::uint32_t value, unsigned int shift)
+{
+	unsigned int bin = 0;
+
+	while (bin < (NUM_HIST_BINS - 1) && value >= GetHistBinLimit(bin, shift))
+		bin += 1;
+
+	return bin;
+}
+
+const char* CPathRequestStats::GetResultName(unsigned int resultType)
+{
+	static const char* names[NUM_RESULTS] = {"full", "partial", "failed"};
+	return names[std::min(resultType, NUM_RESULTS - 1u)];
+}
@@ -0,0 +1,81 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PATH_REQUEST_STATS_H
+#define PATH_REQUEST_STATS_H
+
+#include <array>
+#include <cinttypes>
+
+/**
+ * Records the latency and cost of the most recent path requests handled
+ * by an IPathManager implementation into a ring-buffer, and aggregates
+ * them into histograms for the profiler, /pathstats and Lua.
+ * Only wall-clock derived data is kept here, so none of it is synced.
+ */
+class CPathRequestStats {
+public:
+	enum {
+		RESULT_FULL    = 0,
+		RESULT_PARTIAL = 1,
+		RESULT_FAILED  = 2,
+		NUM_RESULTS    = 3,
+	};
+
+	static constexpr unsigned int NUM_RECORDS   = 1024;
+	static constexpr unsigned int NUM_HIST_BINS =   10;
+
+	// growth-factor (as a power of two) between the bins of each histogram
+	static constexpr unsigned int QUEUE_BIN_SHIFT = 1; // sim-frames
+	static constexpr unsigned int TIME_BIN_SHIFT  = 2; // microseconds
+	static constexpr unsigned int NODE_BIN_SHIFT  = 2; // expanded nodes
+
+	struct Record {
+		std::uint32_t queueFrames; // sim-frames between the request and its search
+		std::uint32_t searchTime;  // microseconds spent searching
+		std::uint32_t numNodes;    // nodes expanded by the search
+		std::uint32_t resultType;
+	};
+
+	struct Histograms {
+		std::array<std::uint32_t, NUM_HIST_BINS> queueFrames;
+		std::array<std::uint32_t, NUM_HIST_BINS> searchTimes;
+		std::array<std::uint32_t, NUM_HIST_BINS> expandedNodes;
+		std::array<std::uint32_t, NUM_RESULTS  > resultTypes;
+
+		std::uint64_t sumQueueFrames;
+		std::uint64_t sumSearchTimes;
+		std::uint64_t sumExpandedNodes;
+
+		std::uint32_t numRecords;
+	};
+
+public:
+	void AddRecord(const Record& r) {
+		records[(numTotalRecords++) % NUM_RECORDS] = r;
+	}
+	void AddRecord(std::uint32_t queueFrames, std::int64_t searchTime, std::uint32_t numNodes, std::uint32_t resultType) {
+		AddRecord({queueFrames, static_cast<std::uint32_t>(searchTime), numNodes, resultType});
+	}
+
+	void Clear() { numTotalRecords = 0; }
+
+	// publishes the current aggregates as CTimeProfiler counters
+	void UpdateProfiler() const;
+
+	Histograms GetHistograms() const;
+
+	std::uint64_t GetNumTotalRecords() const { return numTotalRecords; }
+
+	static unsigned int GetHistBin(std::uint32_t value, unsigned int shift);
+	// exclusive upper bound of the values falling into <bin>
+	static std::uint64_t GetHistBinLimit(unsigned int bin, unsigned int shift) { return (std::uint64_t(1) << (shift * bin)); }
+
+	static const char* GetResultName(unsigned int resultType);
+
+private:
+	std::array<Record, NUM_RECORDS> records;
+
+	std::uint64_t numTotalRecords = 0;
+};
+
+#endif
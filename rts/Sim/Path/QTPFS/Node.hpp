@@ -26,8 +26,10 @@ namespace QTPFS {
 	public:
 		void SetNodeNumber(unsigned int n) { nodeNumber = n; }
 		void SetHeapIndex(unsigned int n) { heapIndex = n; }
+		void SetPoolIndex(unsigned int n) { poolIndex = n; }
 		unsigned int GetNodeNumber() const { return nodeNumber; }
 		unsigned int GetHeapIndex() const { return heapIndex; }
+		unsigned int GetPoolIndex() const { return poolIndex; }
 		float GetHeapPriority() const { return GetPathCost(NODE_PATH_COST_F); }
 
 		bool operator <  (const INode* n) const { return (fCost <  n->fCost); }
@@ -90,6 +92,8 @@ namespace QTPFS {
 		//     but the only way to keep the cost of resorting acceptable
 		unsigned int nodeNumber = -1u;
 		unsigned int heapIndex = -1u;
+		// slot in NodeLayer::poolNodes, used to index per-search node state
+		unsigned int poolIndex = -1u;
 
 		float fCost = 0.0f;
 		float gCost = 0.0f;
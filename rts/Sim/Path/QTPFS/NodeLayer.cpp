@@ -88,13 +88,14 @@ void QTPFS::NodeLayer::QueueUpdate(const SRectangle& r, const MoveDef* md) {
 
 	// make a snapshot of the terrain-state within <r>
 	for (unsigned int hmz = r.z1; hmz < r.z2; hmz++) {
+		CMoveMath::GetRowSpeedMods(*md, r.x1, r.x2, hmz, &layerUpdate.speedMods[(hmz - r.z1) * r.GetWidth()]);
+
 		for (unsigned int hmx = r.x1; hmx < r.x2; hmx++) {
 			const unsigned int recIdx = (hmz - r.z1) * r.GetWidth() + (hmx - r.x1);
 
 			const unsigned int chmx = Clamp(int(hmx), md->xsizeh, r.x2 - md->xsizeh - 1);
 			const unsigned int chmz = Clamp(int(hmz), md->zsizeh, r.z2 - md->zsizeh - 1);
 
-			layerUpdate.speedMods[recIdx] = CMoveMath::GetPosSpeedMod(*md, hmx, hmz);
 			layerUpdate.blockBits[recIdx] = CMoveMath::IsBlockedNoSpeedModCheck(*md, chmx, chmz, nullptr);
 			// layerUpdate.blockBits[recIdx] = CMoveMath::SquareIsBlocked(*md, hmx, hmz, nullptr);
 		}
@@ -134,8 +135,14 @@ bool QTPFS::NodeLayer::Update(
 		avgRelSpeedMod = 0.0f;
 	}
 
+	// speed-modifiers of the current row if no snapshot was queued
+	std::vector<float> rowSpeedMods((luSpeedMods == nullptr)? r.GetWidth(): 0);
+
 	// divide speed-modifiers into bins
 	for (unsigned int hmz = r.z1; hmz < r.z2; hmz++) {
+		if (luSpeedMods == nullptr)
+			CMoveMath::GetRowSpeedMods(*md, r.x1, r.x2, hmz, rowSpeedMods.data());
+
 		for (unsigned int hmx = r.x1; hmx < r.x2; hmx++) {
 			const unsigned int sqrIdx = hmz * xsize + hmx;
 			const unsigned int recIdx = (hmz - r.z1) * r.GetWidth() + (hmx - r.x1);
@@ -144,7 +151,7 @@ bool QTPFS::NodeLayer::Update(
 			const unsigned int chmx = Clamp(int(hmx), md->xsizeh, r.x2 - md->xsizeh - 1);
 			const unsigned int chmz = Clamp(int(hmz), md->zsizeh, r.z2 - md->zsizeh - 1);
 
-			const float minSpeedMod = (luSpeedMods == nullptr)? CMoveMath::GetPosSpeedMod(*md, hmx, hmz): (*luSpeedMods)[recIdx];
+			const float minSpeedMod = (luSpeedMods == nullptr)? rowSpeedMods[hmx - r.x1]: (*luSpeedMods)[recIdx];
 			const   int maxBlockBit = (luBlockBits == nullptr)? CMoveMath::IsBlockedNoSpeedModCheck(*md, chmx, chmz, nullptr): (*luBlockBits)[recIdx];
 			// NOTE:
 			//   movetype code checks ONLY the *CENTER* square of a unit's footprint
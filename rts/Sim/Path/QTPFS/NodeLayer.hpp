@@ -76,6 +76,7 @@ namespace QTPFS {
 
 		INode* AllocRootNode(const INode* parent, unsigned int nn,  unsigned int x1, unsigned int z1, unsigned int x2, unsigned int z2) {
 			rootNode.Init(parent, nn, x1, z1, x2, z2);
+			rootNode.SetPoolIndex(POOL_TOTAL_SIZE);
 			return &rootNode;
 		}
 
@@ -89,6 +90,7 @@ namespace QTPFS {
 				poolNodes[idx / POOL_CHUNK_SIZE].resize(POOL_CHUNK_SIZE);
 
 			poolNodes[idx / POOL_CHUNK_SIZE][idx % POOL_CHUNK_SIZE].Init(parent, nn, x1, z1, x2, z2);
+			poolNodes[idx / POOL_CHUNK_SIZE][idx % POOL_CHUNK_SIZE].SetPoolIndex(idx);
 			nodeIndcs.pop_back();
 
 			return idx;
@@ -96,6 +98,10 @@ namespace QTPFS {
 
 		void FreePoolNode(unsigned int nodeIndex) { nodeIndcs.push_back(nodeIndex); }
 
+		// pool-indices are in [0, POOL_TOTAL_SIZE]; the root node takes the last one
+		static unsigned int GetPoolChunkSize() { return POOL_CHUNK_SIZE; }
+		static unsigned int GetNumPoolIndices() { return (POOL_TOTAL_SIZE + 1); }
+
 
 		const std::vector<SpeedBinType>& GetOldSpeedBins() const { return oldSpeedBins; }
 		const std::vector<SpeedBinType>& GetCurSpeedBins() const { return curSpeedBins; }
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <chrono>
 #include <cinttypes>
 #include <functional>
@@ -35,6 +36,10 @@
 #define NUL_RECTANGLE SRectangle(0, 0,             0,            0)
 #define MAP_RECTANGLE SRectangle(0, 0,  mapDims.mapx, mapDims.mapy)
 
+#ifdef QTPFS_ENABLE_THREADED_UPDATE
+CONFIG(std::string, PathThreadCores).defaultValue("").description("Cores (e.g. \"2\") the QTPFS update thread is pinned to; if empty it inherits the load thread's affinity.");
+#endif
+
 
 namespace QTPFS {
 	struct PMLoadScreen {
@@ -148,7 +153,7 @@ QTPFS::PathManager::~PathManager() {
 	numCurrExecutedSearches.clear();
 	numPrevExecutedSearches.clear();
 
-	PathSearch::FreeGlobalQueue();
+	PathSearch::FreeThreadData();
 
 	#ifdef QTPFS_ENABLE_THREADED_UPDATE
 	// at this point the thread is waiting, so notify it
@@ -185,8 +190,6 @@ void QTPFS::PathManager::InitStatic() {
 }
 
 void QTPFS::PathManager::Load() {
-	// NOTE: offset *must* start at a non-zero value
-	searchStateOffset = NODE_STATE_OFFSET;
 	numTerrainChanges = 0;
 	numPathRequests   = 0;
 	maxNumLeafNodes   = 0;
@@ -247,7 +250,7 @@ void QTPFS::PathManager::Load() {
 
 		{ SyncedUint tmp(pfsCheckSum); }
 
-		PathSearch::InitGlobalQueue(maxNumLeafNodes);
+		PathSearch::InitThreadData(maxNumLeafNodes);
 	}
 
 	{
@@ -686,6 +689,8 @@ void QTPFS::PathManager::Update() {
 __FORCE_ALIGN_STACK__
 void QTPFS::PathManager::ThreadUpdate() {
 	#ifdef QTPFS_ENABLE_THREADED_UPDATE
+	Threading::SetAffinity(Threading::ParseCoreList(configHandler->GetString("PathThreadCores")));
+
 	while (!nodeLayers.empty()) {
 		std::lock_guard<spring::mutex> lock(mutexThreadUpdate);
 
@@ -712,21 +717,36 @@ void QTPFS::PathManager::ThreadUpdate() {
 
 		sharedPaths.clear();
 
+		#ifndef QTPFS_IGNORE_DEAD_PATHS
 		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
-			#ifndef QTPFS_IGNORE_DEAD_PATHS
 			QueueDeadPathSearches(pathTypeUpdate);
-			#endif
+		}
+		#endif
 
-			#ifdef QTPFS_STAGGERED_LAYER_UPDATES
-			// NOTE: *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
-			ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
-			#endif
+		#ifdef QTPFS_STAGGERED_LAYER_UPDATES
+		{
+			// NOTE:
+			//   *must* be called between QueueDeadPathSearches and ExecuteQueuedSearches
+			//   each layer owns its tree, node-pool and path-cache (as during the threaded
+			//   initialization), so the queued updates for all layers in this window can be
+			//   tesselated in parallel here instead of stalling the searches layer by layer
+			SCOPED_TIMER("Sim::Path::LayerUpdates");
+
+			for_mt(minPathTypeUpdate, maxPathTypeUpdate, [&](const int pathTypeUpdate) {
+				ExecQueuedNodeLayerUpdates(pathTypeUpdate, !pathSearches[pathTypeUpdate].empty());
+			});
+		}
+		#endif
 
+		for (unsigned int pathTypeUpdate = minPathTypeUpdate; pathTypeUpdate < maxPathTypeUpdate; pathTypeUpdate++) {
 			ExecuteQueuedSearches(pathTypeUpdate);
 		}
 
 		std::copy(numCurrExecutedSearches.begin(), numCurrExecutedSearches.end(), numPrevExecutedSearches.begin());
 
+		if ((gs->frameNum % GAME_SPEED) == 0)
+			pathRequestStats.UpdateProfiler();
+
 		minPathTypeUpdate = (minPathTypeUpdate + numPathTypeUpdates);
 		maxPathTypeUpdate = (minPathTypeUpdate + numPathTypeUpdates);
 
@@ -758,14 +778,14 @@ void QTPFS::PathManager::ExecuteQueuedSearches(unsigned int pathType) {
 		// execute pending searches collected via
 		// RequestPath and QueueDeadPathSearches
 		while (searchesIt != searches.end()) {
-			if (ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType)) {
-				searchStateOffset += NODE_STATE_OFFSET;
-			}
+			ExecuteSearch(searches, searchesIt, nodeLayer, pathCache, pathType);
 		}
+
+		ExecuteSearchBatch();
 	}
 }
 
-bool QTPFS::PathManager::ExecuteSearch(
+void QTPFS::PathManager::ExecuteSearch(
 	PathSearchVect& searches,
 	PathSearchVectIt& searchesIt,
 	NodeLayer& nodeLayer,
@@ -778,10 +798,13 @@ bool QTPFS::PathManager::ExecuteSearch(
 	assert(search != nullptr);
 	assert(path != nullptr);
 
-	const auto DeleteSearch = [](IPathSearch* s, PathSearchVect& v, PathSearchVectIt& it) {
+	const auto RemoveSearch = [](PathSearchVect& v, PathSearchVectIt& it) {
 		// ordering of still-queued searches is not relevant
 		*it = v.back();
 		v.pop_back();
+	};
+	const auto DeleteSearch = [&](IPathSearch* s, PathSearchVect& v, PathSearchVectIt& it) {
+		RemoveSearch(v, it);
 		delete s;
 	};
 
@@ -789,7 +812,7 @@ bool QTPFS::PathManager::ExecuteSearch(
 	// DeletePath before we got a chance to process it
 	if (path->GetID() == 0) {
 		DeleteSearch(search, searches, searchesIt);
-		return false;
+		return;
 	}
 
 	assert(search->GetID() != 0);
@@ -800,12 +823,20 @@ bool QTPFS::PathManager::ExecuteSearch(
 
 	{
 		#ifdef QTPFS_SEARCH_SHARED_PATHS
+		const auto IsSharedSearch = [&](const BatchedSearch& bs) { return (bs.path->GetHash() == path->GetHash()); };
+
+		// an earlier search with the same hash might still be pending; it has
+		// to finish first for sharedPaths to be the same as without batching
+		if (std::find_if(searchBatch.begin(), searchBatch.end(), IsSharedSearch) != searchBatch.end())
+			ExecuteSearchBatch();
+
 		SharedPathMap::const_iterator sharedPathsIt = sharedPaths.find(path->GetHash());
 
 		if (sharedPathsIt != sharedPaths.end()) {
 			if (search->SharedFinalize(sharedPathsIt->second, path)) {
+				pathRequestStats.AddRecord(gs->frameNum - search->GetQueueFrame(), 0, 0, CPathRequestStats::RESULT_FULL);
 				DeleteSearch(search, searches, searchesIt);
-				return false;
+				return;
 			}
 		}
 		#endif
@@ -815,30 +846,69 @@ bool QTPFS::PathManager::ExecuteSearch(
 		const unsigned int numPrevSearches = numPrevExecutedSearches[search->GetTeam()];
 
 		if ((numCurrSearches - numPrevSearches) >= MAX_TEAM_SEARCHES) {
-			++searchesIt; return false;
+			++searchesIt; return;
 		}
 
 		numCurrExecutedSearches[search->GetTeam()] += 1;
 		#endif
 	}
 
-	// removes path from temp-paths, adds it to live-paths
-	if (search->Execute(searchStateOffset, numTerrainChanges)) {
-		search->Finalize(path);
+	searchBatch.push_back({search, path, false, 0});
+	RemoveSearch(searches, searchesIt);
+}
 
-		#ifdef QTPFS_SEARCH_SHARED_PATHS
-		sharedPaths[path->GetHash()] = path;
-		#endif
+void QTPFS::PathManager::ExecuteSearchBatch() {
+	// each search only writes to its own SearchThreadData and members,
+	// the node-layer and its neighbor-caches are read-only at this point
+	// (except in conservative mode where searches refresh stale caches)
+	#ifndef QTPFS_CONSERVATIVE_NEIGHBOR_CACHE_UPDATES
+	for_mt(0, searchBatch.size(), [&](const int i) {
+		const spring_time t0 = spring_gettime();
+
+		searchBatch[i].result = searchBatch[i].search->Execute(numTerrainChanges);
+		searchBatch[i].searchTime = (spring_gettime() - t0).toMicroSecsi();
+	});
+	#else
+	for (BatchedSearch& bs: searchBatch) {
+		const spring_time t0 = spring_gettime();
 
-		#ifdef QTPFS_TRACE_PATH_SEARCHES
-		pathTraces[path->GetID()] = search->GetExecutionTrace();
-		#endif
-	} else {
-		DeletePath(path->GetID());
+		bs.result = bs.search->Execute(numTerrainChanges);
+		bs.searchTime = (spring_gettime() - t0).toMicroSecsi();
 	}
+	#endif
 
-	DeleteSearch(search, searches, searchesIt);
-	return true;
+	// commit in batch order, independent of which thread ran what
+	for (const BatchedSearch& bs: searchBatch) {
+		IPathSearch* search = bs.search;
+		IPath* path = bs.path;
+
+		{
+			const unsigned int resultType = bs.result?
+				(search->HaveFullPath()? CPathRequestStats::RESULT_FULL: CPathRequestStats::RESULT_PARTIAL):
+				CPathRequestStats::RESULT_FAILED;
+
+			pathRequestStats.AddRecord(gs->frameNum - search->GetQueueFrame(), bs.searchTime, search->GetNumExpandedNodes(), resultType);
+		}
+
+		// removes path from temp-paths, adds it to live-paths
+		if (bs.result) {
+			search->Finalize(path);
+
+			#ifdef QTPFS_SEARCH_SHARED_PATHS
+			sharedPaths[path->GetHash()] = path;
+			#endif
+
+			#ifdef QTPFS_TRACE_PATH_SEARCHES
+			pathTraces[path->GetID()] = search->GetExecutionTrace();
+			#endif
+		} else {
+			DeletePath(path->GetID());
+		}
+
+		delete search;
+	}
+
+	searchBatch.clear();
 }
 
 void QTPFS::PathManager::QueueDeadPathSearches(unsigned int pathType) {
@@ -929,6 +999,8 @@ unsigned int QTPFS::PathManager::QueueSearch(
 		newSearch->SetTeam((object != nullptr)? object->team: teamHandler.ActiveTeams());
 	}
 
+	newSearch->SetQueueFrame(gs->frameNum);
+
 	assert((pathCaches[moveDef->pathType].GetTempPath(newPath->GetID()))->GetID() == 0);
 
 	// map the path-ID to the index of the cache that stores it
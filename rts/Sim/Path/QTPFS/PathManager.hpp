@@ -134,13 +134,14 @@ namespace QTPFS {
 			const bool synced
 		);
 
-		bool ExecuteSearch(
+		void ExecuteSearch(
 			PathSearchVect& searches,
 			PathSearchVectIt& searchesIt,
 			NodeLayer& nodeLayer,
 			PathCache& pathCache,
 			unsigned int pathType
 		);
+		void ExecuteSearchBatch();
 
 		bool IsFinalized() const { return (!nodeTrees.empty()); }
 
@@ -159,13 +160,23 @@ namespace QTPFS {
 		// maps "hashes" of executed searches to the found paths
 		spring::unordered_map<std::uint64_t, IPath*> sharedPaths;
 
+		struct BatchedSearch {
+			IPathSearch* search;
+			IPath* path;
+			bool result;
+			std::int64_t searchTime; // microseconds
+		};
+
+		// searches taken off the queue but not yet executed; run in
+		// parallel and committed in the order they were batched
+		std::vector<BatchedSearch> searchBatch;
+
 		std::vector<unsigned int> numCurrExecutedSearches;
 		std::vector<unsigned int> numPrevExecutedSearches;
 
 		static unsigned int LAYERS_PER_UPDATE;
 		static unsigned int MAX_TEAM_SEARCHES;
 
-		unsigned int searchStateOffset;
 		unsigned int numTerrainChanges;
 		unsigned int numPathRequests;
 		unsigned int maxNumLeafNodes;
@@ -15,7 +15,29 @@
 
 #include "System/float3.h"
 
-QTPFS::binary_heap<QTPFS::INode*> QTPFS::PathSearch::openNodes;
+std::array<QTPFS::SearchThreadData, ThreadPool::MAX_THREADS> QTPFS::PathSearch::threadData;
+
+
+
+QTPFS::SearchNode* QTPFS::SearchThreadData::GetNode(INode* n) {
+	const unsigned int poolIndex = n->GetPoolIndex();
+	const unsigned int chunkSize = NodeLayer::GetPoolChunkSize();
+	const unsigned int chunkIndex = poolIndex / chunkSize;
+
+	assert(poolIndex < NodeLayer::GetNumPoolIndices());
+
+	if (nodeChunks.empty())
+		nodeChunks.resize((NodeLayer::GetNumPoolIndices() + chunkSize - 1) / chunkSize);
+
+	// pool-indices are handed out in increasing order, so most
+	// maps only ever touch a few of these
+	if (nodeChunks[chunkIndex].empty())
+		nodeChunks[chunkIndex].resize(chunkSize);
+
+	SearchNode* sn = &nodeChunks[chunkIndex][poolIndex % chunkSize];
+	sn->node = n;
+	return sn;
+}
 
 
 
@@ -39,22 +61,26 @@ void QTPFS::PathSearch::Initialize(
 	tgtNode = nodeLayer->GetNode(tgtPoint.x / SQUARE_SIZE, tgtPoint.z / SQUARE_SIZE);
 	curNode = nullptr;
 	nxtNode = nullptr;
-	minNode = srcNode;
+	minNode = nullptr;
 }
 
-bool QTPFS::PathSearch::Execute(
-	unsigned int searchStateOffset,
-	unsigned int searchMagicNumber
-) {
-	searchState = searchStateOffset; // starts at NODE_STATE_OFFSET
+bool QTPFS::PathSearch::Execute(unsigned int searchMagicNumber) {
+	searchData = &threadData[ThreadPool::GetThreadNum()];
+
+	searchState = searchData->searchState; // starts at NODE_STATE_OFFSET
 	searchMagic = searchMagicNumber; // starts at numTerrainChanges
 
+	searchData->searchState += NODE_STATE_OFFSET;
+
 	haveFullPath = (srcNode == tgtNode);
 	havePartPath = false;
+	numExpandedNodes = 0;
 
 	// early-out
-	if (haveFullPath)
+	if (haveFullPath) {
+		searchData = nullptr;
 		return true;
+	}
 
 	#ifdef QTPFS_TRACE_PATH_SEARCHES
 	searchExec = new PathSearchTrace::Execution(gs->frameNum);
@@ -75,13 +101,17 @@ bool QTPFS::PathSearch::Execute(
 	// nodes can represent many terrain squares, some of which can still
 	// be passable and allow a unit to move within a node)
 	// NOTE: we need to make sure such paths do not have infinite cost!
-	if (srcNode->GetMoveCost() == QTPFS_POSITIVE_INFINITY)
-		srcNode->SetMoveCost(0.0f);
+	// (the node itself is shared with concurrent searches, so only our
+	// view of its cost is changed)
+	if ((srcMoveCost = srcNode->GetMoveCost()) == QTPFS_POSITIVE_INFINITY)
+		srcMoveCost = 0.0f;
 
-	ResetState(srcNode);
-	UpdateNode(srcNode, nullptr, 0);
+	minNode = searchData->GetNode(srcNode);
 
-	while (!openNodes.empty()) {
+	ResetState(minNode);
+	UpdateNode(minNode, nullptr, 0);
+
+	while (!searchData->openNodes.empty()) {
 		IterateNodes(nodeLayer->GetNodes());
 
 		#ifdef QTPFS_TRACE_PATH_SEARCHES
@@ -89,16 +119,13 @@ bool QTPFS::PathSearch::Execute(
 		searchIter.Clear();
 		#endif
 
-		haveFullPath = (curNode == tgtNode);
-		havePartPath = (minNode != srcNode);
+		haveFullPath = (curNode->node == tgtNode);
+		havePartPath = (minNode->node != srcNode);
 
 		if (haveFullPath)
-			openNodes.reset();
+			searchData->openNodes.reset();
 	}
 
-	if (srcNode->GetMoveCost() == 0.0f)
-		srcNode->SetMoveCost(QTPFS_POSITIVE_INFINITY);
-
 
 	#ifdef QTPFS_SUPPORT_PARTIAL_SEARCHES
 	// adjust the target-point if we only got a partial result
@@ -107,18 +134,22 @@ bool QTPFS::PathSearch::Execute(
 	//   units will end up spinning in-place over the last
 	//   waypoint (since "atGoal" can never become true)
 	if (!haveFullPath && havePartPath) {
-		tgtNode    = minNode;
-		tgtPoint.x = minNode->xmid() * SQUARE_SIZE;
-		tgtPoint.z = minNode->zmid() * SQUARE_SIZE;
+		tgtNode    = minNode->node;
+		tgtPoint.x = tgtNode->xmid() * SQUARE_SIZE;
+		tgtPoint.z = tgtNode->zmid() * SQUARE_SIZE;
 	}
 	#endif
 
+	if (haveFullPath || havePartPath)
+		StorePathNodes();
+
+	searchData = nullptr;
 	return (haveFullPath || havePartPath);
 }
 
 
 
-void QTPFS::PathSearch::ResetState(INode* node) {
+void QTPFS::PathSearch::ResetState(SearchNode* node) {
 	// will be copied into srcNode by UpdateNode()
 	netPoints[0] = {srcPoint.x, srcPoint.z};
 
@@ -136,60 +167,67 @@ void QTPFS::PathSearch::ResetState(INode* node) {
 		hCosts[i] = 0.0f;
 	}
 
-	openNodes.reset();
-	openNodes.push(node);
+	searchData->openNodes.reset();
+	searchData->openNodes.push(node);
 }
 
-void QTPFS::PathSearch::UpdateNode(INode* nextNode, INode* prevNode, unsigned int netPointIdx) {
+void QTPFS::PathSearch::UpdateNode(SearchNode* nextNode, SearchNode* prevNode, unsigned int netPointIdx) {
 	// NOTE:
 	//   the heuristic must never over-estimate the distance,
 	//   but this is *impossible* to achieve on a non-regular
 	//   grid on which any node only has an average move-cost
 	//   associated with it --> paths will be "nearly optimal"
-	nextNode->SetPrevNode(prevNode);
+	nextNode->prevNode = prevNode;
 	nextNode->SetPathCosts(gCosts[netPointIdx], hCosts[netPointIdx]);
-	nextNode->SetSearchState(searchState | NODE_STATE_OPEN);
-	nextNode->SetNeighborEdgeTransitionPoint(0, netPoints[netPointIdx]);
+	nextNode->searchState = searchState | NODE_STATE_OPEN;
+	nextNode->netPoint = netPoints[netPointIdx];
 }
 
 void QTPFS::PathSearch::IterateNodes(const std::vector<INode*>& allNodes) {
-	curNode = openNodes.top();
-	curNode->SetSearchState(searchState | NODE_STATE_CLOSED);
+	curNode = searchData->openNodes.top();
+	curNode->searchState = searchState | NODE_STATE_CLOSED;
+
+	INode* curINode = curNode->node;
+
 	#ifdef QTPFS_CONSERVATIVE_NEIGHBOR_CACHE_UPDATES
 	// in the non-conservative case, this is done from
 	// NodeLayer::ExecNodeNeighborCacheUpdates instead
-	curNode->SetMagicNumber(searchMagic);
+	curINode->SetMagicNumber(searchMagic);
 	#endif
 
-	openNodes.pop();
-	openNodes.check_heap_property(0);
+	searchData->openNodes.pop();
+	searchData->openNodes.check_heap_property(0);
+
+	numExpandedNodes += 1;
 
 	#ifdef QTPFS_TRACE_PATH_SEARCHES
-	searchIter.SetPoppedNodeIdx(curNode->zmin() * mapDims.mapx + curNode->xmin());
+	searchIter.SetPoppedNodeIdx(curINode->zmin() * mapDims.mapx + curINode->xmin());
 	#endif
 
-	if (curNode == tgtNode)
+	if (curINode == tgtNode)
 		return;
-	if (curNode->AllSquaresImpassable())
+	if (IsImpassable(curINode))
 		return;
 
-	if (curNode->xmid() < searchRect.x1) return;
-	if (curNode->zmid() < searchRect.z1) return;
-	if (curNode->xmid() > searchRect.x2) return;
-	if (curNode->zmid() > searchRect.z2) return;
+	if (curINode->xmid() < searchRect.x1) return;
+	if (curINode->zmid() < searchRect.z1) return;
+	if (curINode->xmid() > searchRect.x2) return;
+	if (curINode->zmid() > searchRect.z2) return;
 
 	#ifdef QTPFS_SUPPORT_PARTIAL_SEARCHES
 	// remember the node with lowest h-cost in case the search fails to reach tgtNode
-	if (curNode->GetPathCost(NODE_PATH_COST_H) < minNode->GetPathCost(NODE_PATH_COST_H))
+	if (curNode->hCost < minNode->hCost)
 		minNode = curNode;
 	#endif
 
-	IterateNodeNeighbors(curNode->GetNeighbors(allNodes));
+	IterateNodeNeighbors(curINode->GetNeighbors(allNodes));
 }
 
 void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes) {
+	const INode* curINode = curNode->node;
+
 	// if curNode equals srcNode, this is just the original srcPoint
-	const float2& curPoint2 = curNode->GetNeighborEdgeTransitionPoint(0);
+	const float2& curPoint2 = curNode->netPoint;
 	const float3  curPoint  = {curPoint2.x, 0.0f, curPoint2.y};
 
 	for (unsigned int i = 0; i < nxtNodes.size(); i++) {
@@ -210,14 +248,16 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		//   in the first case we would explore many more nodes than necessary (CPU
 		//   nightmare), while in the second we would get low-quality paths (player
 		//   nightmare)
-		nxtNode = nxtNodes[i];
+		const INode* nxtINode = nxtNodes[i];
 
-		if (nxtNode->AllSquaresImpassable())
+		if (IsImpassable(nxtINode))
 			continue;
 
-		const bool isCurrent = (nxtNode->GetSearchState() >= searchState);
-		const bool isClosed = ((nxtNode->GetSearchState() & 1) == NODE_STATE_CLOSED);
-		const bool isTarget = (nxtNode == tgtNode);
+		nxtNode = searchData->GetNode(nxtNodes[i]);
+
+		const bool isCurrent = (nxtNode->searchState >= searchState);
+		const bool isClosed = ((nxtNode->searchState & 1) == NODE_STATE_CLOSED);
+		const bool isTarget = (nxtINode == tgtNode);
 
 		unsigned int netPointIdx = 0;
 
@@ -228,16 +268,16 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 			// to be fancy (note that this is not always the best
 			// option, it causes local and global sub-optimalities
 			// which SmoothPath can only partially address)
-			netPoints[0] = curNode->GetNeighborEdgeTransitionPoint(1 + i);
+			netPoints[0] = curINode->GetNeighborEdgeTransitionPoint(1 + i);
 
 			// cannot use squared-distances because that will bias paths
 			// towards smaller nodes (eg. 1^2 + 1^2 + 1^2 + 1^2 != 4^2)
 			gDists[0] = curPoint.distance({netPoints[0].x, 0.0f, netPoints[0].y});
 			hDists[0] = tgtPoint.distance({netPoints[0].x, 0.0f, netPoints[0].y});
 			gCosts[0] =
-				curNode->GetPathCost(NODE_PATH_COST_G) +
-				curNode->GetMoveCost() * gDists[0] +
-				nxtNode->GetMoveCost() * hDists[0] * int(isTarget);
+				curNode->gCost +
+				GetMoveCost(curINode) * gDists[0] +
+				GetMoveCost(nxtINode) * hDists[0] * int(isTarget);
 			hCosts[0] = hDists[0] * hCostMult * int(!isTarget);
 		}
 		#else
@@ -248,14 +288,14 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		// not handle; more points means a greater degree
 		// of non-cardinality (but gets expensive quickly)
 		for (unsigned int j = 0; j < QTPFS_MAX_NETPOINTS_PER_NODE_EDGE; j++) {
-			netPoints[j] = curNode->GetNeighborEdgeTransitionPoint(1 + i * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE + j);
+			netPoints[j] = curINode->GetNeighborEdgeTransitionPoint(1 + i * QTPFS_MAX_NETPOINTS_PER_NODE_EDGE + j);
 
 			gDists[j] = curPoint.distance({netPoints[j].x, 0.0f, netPoints[j].y});
 			hDists[j] = tgtPoint.distance({netPoints[j].x, 0.0f, netPoints[j].y});
 			gCosts[j] =
-				curNode->GetPathCost(NODE_PATH_COST_G) +
-				curNode->GetMoveCost() * gDists[j] +
-				nxtNode->GetMoveCost() * hDists[j] * int(isTarget);
+				curNode->gCost +
+				GetMoveCost(curINode) * gDists[j] +
+				GetMoveCost(nxtINode) * hDists[j] * int(isTarget);
 			hCosts[j] = hDists[j] * hCostMult * int(!isTarget);
 
 			if ((gCosts[j] + hCosts[j]) < (gCosts[netPointIdx] + hCosts[netPointIdx])) {
@@ -267,19 +307,19 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		if (!isCurrent) {
 			UpdateNode(nxtNode, curNode, netPointIdx);
 
-			openNodes.push(nxtNode);
-			openNodes.check_heap_property(0);
+			searchData->openNodes.push(nxtNode);
+			searchData->openNodes.check_heap_property(0);
 
 			#ifdef QTPFS_TRACE_PATH_SEARCHES
-			searchIter.AddPushedNodeIdx(nxtNode->zmin() * mapDims.mapx + nxtNode->xmin());
+			searchIter.AddPushedNodeIdx(nxtINode->zmin() * mapDims.mapx + nxtINode->xmin());
 			#endif
 
 			continue;
 		}
-		if (gCosts[netPointIdx] >= nxtNode->GetPathCost(NODE_PATH_COST_G))
+		if (gCosts[netPointIdx] >= nxtNode->gCost)
 			continue;
 		if (isClosed)
-			openNodes.push(nxtNode);
+			searchData->openNodes.push(nxtNode);
 
 		UpdateNode(nxtNode, curNode, netPointIdx);
 
@@ -287,9 +327,27 @@ void QTPFS::PathSearch::IterateNodeNeighbors(const std::vector<INode*>& nxtNodes
 		// (changing the f-cost of an OPEN node messes up the
 		// queue's internal consistency; a pushed node remains
 		// OPEN until it gets popped)
-		openNodes.resort(nxtNode);
-		openNodes.check_heap_property(0);
+		searchData->openNodes.resort(nxtNode);
+		searchData->openNodes.check_heap_property(0);
+	}
+}
+
+void QTPFS::PathSearch::StorePathNodes() {
+	pathNodes.clear();
+	pathPoints.clear();
+
+	if (srcNode == tgtNode)
+		return;
+
+	// srcNode is the only node without a back-pointer
+	for (const SearchNode* n = searchData->GetNode(tgtNode); n != nullptr; n = n->prevNode) {
+		assert(n->searchState >= searchState);
+
+		pathNodes.push_back(n->node);
+		pathPoints.push_back(n->netPoint);
 	}
+
+	assert(pathNodes.back() == srcNode);
 }
 
 void QTPFS::PathSearch::Finalize(IPath* path) {
@@ -310,13 +368,11 @@ void QTPFS::PathSearch::TracePath(IPath* path) {
 //	std::deque<float3>::const_iterator pointsIt;
 
 	if (srcNode != tgtNode) {
-		INode* tmpNode = tgtNode;
-		INode* prvNode = tmpNode->GetPrevNode();
-
 		float3 prvPoint = tgtPoint;
 
-		while ((prvNode != nullptr) && (tmpNode != srcNode)) {
-			const float2& tmpPoint2 = tmpNode->GetNeighborEdgeTransitionPoint(0);
+		// pathNodes runs from tgtNode to srcNode; the latter contributes no point
+		for (size_t i = 0, n = pathNodes.size() - 1; i < n; i++) {
+			const float2& tmpPoint2 = pathPoints[i];
 			const float3  tmpPoint  = {tmpPoint2.x, 0.0f, tmpPoint2.y};
 
 			assert(!math::isinf(tmpPoint.x) && !math::isinf(tmpPoint.z));
@@ -325,22 +381,13 @@ void QTPFS::PathSearch::TracePath(IPath* path) {
 			//   waypoints should NEVER have identical coordinates
 			//   one exception: tgtPoint can legitimately coincide
 			//   with first transition-point, which we must ignore
-			assert(tmpNode != prvNode);
-			assert(tmpPoint != prvPoint || tmpNode == tgtNode);
+			assert(pathNodes[i] != pathNodes[i + 1]);
+			assert(tmpPoint != prvPoint || i == 0);
 
 			if (tmpPoint != prvPoint)
 				points.push_front(tmpPoint);
 
-			#ifndef QTPFS_SMOOTH_PATHS
-			// make sure the back-pointers can never become dangling
-			// (if smoothing IS enabled, we delay this until we reach
-			// SmoothPath() because we still need them there)
-			tmpNode->SetPrevNode(nullptr);
-			#endif
-
 			prvPoint = tmpPoint;
-			tmpNode = prvNode;
-			prvNode = tmpNode->GetPrevNode();
 		}
 	}
 
@@ -366,25 +413,12 @@ void QTPFS::PathSearch::SmoothPath(IPath* path) const {
 	if (path->NumPoints() == 2)
 		return;
 
-	assert(srcNode->GetPrevNode() == NULL);
-
 	for (unsigned int k = 0; k < QTPFS_MAX_SMOOTHING_ITERATIONS; k++) {
 		if (!SmoothPathIter(path)) {
 			// all waypoints stopped moving
 			break;
 		}
 	}
-
-	INode* n0 = tgtNode;
-	INode* n1 = tgtNode;
-
-	while (n1 != srcNode) {
-		n0 = n1;
-		n1 = n0->GetPrevNode();
-
-		// reset back-pointers
-		n0->SetPrevNode(NULL);
-	}
 }
 
 bool QTPFS::PathSearch::SmoothPathIter(IPath* path) const {
@@ -395,12 +429,10 @@ bool QTPFS::PathSearch::SmoothPathIter(IPath* path) const {
 	unsigned int ni = path->NumPoints();
 	unsigned int nm = 0;
 
-	INode* n0 = tgtNode;
-	INode* n1 = tgtNode;
+	for (size_t k = 1; k < pathNodes.size(); k++) {
+		const INode* n0 = pathNodes[k - 1];
+		const INode* n1 = pathNodes[k    ];
 
-	while (n1 != srcNode) {
-		n0 = n1;
-		n1 = n0->GetPrevNode();
 		ni -= 1;
 
 		assert(n1->GetNeighborRelation(n0) != 0);
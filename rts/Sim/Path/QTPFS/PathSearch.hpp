@@ -3,6 +3,7 @@
 #ifndef QTPFS_PATHSEARCH_HDR
 #define QTPFS_PATHSEARCH_HDR
 
+#include <array>
 #include <vector>
 
 #include "PathDefines.hpp"
@@ -10,6 +11,7 @@
 #include "NodeHeap.hpp"
 
 #include "System/float3.h"
+#include "System/Threading/ThreadPool.h"
 
 namespace QTPFS {
 	struct PathCache;
@@ -65,6 +67,62 @@ namespace QTPFS {
 	}
 
 
+	// per-search state of a node; kept outside the (shared) INode's so
+	// that multiple searches can run concurrently over the same layer
+	struct SearchNode {
+	public:
+		void SetHeapIndex(unsigned int n) { heapIndex = n; }
+		unsigned int GetHeapIndex() const { return heapIndex; }
+		float GetHeapPriority() const { return fCost; }
+
+		bool operator <  (const SearchNode* n) const { return (fCost <  n->fCost); }
+		bool operator >  (const SearchNode* n) const { return (fCost >  n->fCost); }
+		bool operator == (const SearchNode* n) const { return (fCost == n->fCost); }
+		bool operator <= (const SearchNode* n) const { return (fCost <= n->fCost); }
+		bool operator >= (const SearchNode* n) const { return (fCost >= n->fCost); }
+
+		void SetPathCosts(float g, float h) { fCost = g + h; gCost = g; hCost = h; }
+
+	public:
+		INode* node = nullptr;
+		SearchNode* prevNode = nullptr;
+
+		// transition-point through which this node was entered
+		float2 netPoint;
+
+		float fCost = 0.0f;
+		float gCost = 0.0f;
+		float hCost = 0.0f;
+
+		unsigned int searchState = 0;
+		unsigned int heapIndex = -1u;
+	};
+
+	// scratch memory owned by one worker thread, re-used by every search it runs
+	struct SearchThreadData {
+	public:
+		SearchNode* GetNode(INode* n);
+
+		void Clear() {
+			nodeChunks.clear();
+			openNodes.clear();
+
+			searchState = NODE_STATE_OFFSET;
+		}
+
+	public:
+		binary_heap<SearchNode*> openNodes;
+
+		// indexed by INode::GetPoolIndex and allocated lazily per pool-chunk
+		// a node's state belongs to the current search iff its searchState
+		// is at least <searchState>
+		std::vector< std::vector<SearchNode> > nodeChunks;
+
+		// NOTE: offset *must* start at a non-zero value
+		unsigned int searchState = NODE_STATE_OFFSET;
+	};
+
+
 	// NOTE:
 	//     we could support "time-sliced" execution, but we would have
 	//     to isolate each query from modifying another's INode members
@@ -81,6 +139,7 @@ namespace QTPFS {
 			, searchType(pathSearchType)
 			, searchState(0)
 			, searchMagic(0)
+			, queueFrame(0)
 			{}
 		virtual ~IPathSearch() {}
 
@@ -91,28 +150,33 @@ namespace QTPFS {
 			const float3& targetPoint,
 			const SRectangle& searchArea
 		) = 0;
-		virtual bool Execute(
-			unsigned int searchStateOffset = 0,
-			unsigned int searchMagicNumber = 0
-		) = 0;
+		// NOTE: must not modify any state shared with other searches (can run threaded)
+		virtual bool Execute(unsigned int searchMagicNumber = 0) = 0;
 		virtual void Finalize(IPath* path) = 0;
 		virtual bool SharedFinalize(const IPath* srcPath, IPath* dstPath) { return false; }
 		virtual PathSearchTrace::Execution* GetExecutionTrace() { return NULL; }
 
+		// statistics of the last Execute call
+		virtual unsigned int GetNumExpandedNodes() const { return 0; }
+		virtual bool HaveFullPath() const { return false; }
+
 		virtual const std::uint64_t GetHash(std::uint64_t N, std::uint32_t k) const = 0;
 
 		void SetID(unsigned int n) { searchID = n; }
 		void SetTeam(unsigned int n) { searchTeam = n; }
+		void SetQueueFrame(unsigned int n) { queueFrame = n; }
 		unsigned int GetID() const { return searchID; }
 		unsigned int GetTeam() const { return searchTeam; }
+		unsigned int GetQueueFrame() const { return queueFrame; }
 
 	protected:
 		unsigned int searchID;     // links us to the temp-path that this search will finalize
 		unsigned int searchTeam;   // which team queued this search
 
 		unsigned int searchType;   // indicates if Dijkstra (h==0) or A* (h!=0) search is employed
-		unsigned int searchState;  // offset that identifies nodes as part of current search
+		unsigned int searchState;  // offset that identifies SearchNode's as part of current search
 		unsigned int searchMagic;  // used to signal nodes they should update their neighbor-set
+		unsigned int queueFrame;   // sim-frame at which the search was queued
 	};
 
 
@@ -123,16 +187,18 @@ namespace QTPFS {
 			, nodeLayer(NULL)
 			, pathCache(NULL)
 			, searchExec(NULL)
+			, searchData(NULL)
 			, srcNode(NULL)
 			, tgtNode(NULL)
 			, curNode(NULL)
 			, nxtNode(NULL)
 			, minNode(NULL)
 			, hCostMult(0.0f)
+			, srcMoveCost(0.0f)
 			, haveFullPath(false)
 			, havePartPath(false)
 			{}
-		~PathSearch() { openNodes.reset(); }
+		~PathSearch() {}
 
 		void Initialize(
 			NodeLayer* layer,
@@ -141,33 +207,46 @@ namespace QTPFS {
 			const float3& targetPoint,
 			const SRectangle& searchArea
 		) override;
-		bool Execute(
-			unsigned int searchStateOffset = 0,
-			unsigned int searchMagicNumber = 0
-		) override;
+		bool Execute(unsigned int searchMagicNumber = 0) override;
 		void Finalize(IPath* path) override;
 		bool SharedFinalize(const IPath* srcPath, IPath* dstPath) override;
 		PathSearchTrace::Execution* GetExecutionTrace() override { return searchExec; }
 
+		unsigned int GetNumExpandedNodes() const override { return numExpandedNodes; }
+		bool HaveFullPath() const override { return haveFullPath; }
+
 		const std::uint64_t GetHash(std::uint64_t N, std::uint32_t k) const override;
 
-		static void InitGlobalQueue(unsigned int n) { openNodes.reserve(n); }
-		static void FreeGlobalQueue() { openNodes.clear(); }
+		static void InitThreadData(unsigned int n) {
+			for (SearchThreadData& data: threadData) {
+				data.openNodes.reserve(n);
+			}
+		}
+		static void FreeThreadData() {
+			for (SearchThreadData& data: threadData) {
+				data.Clear();
+			}
+		}
 
 	private:
-		void ResetState(INode* node);
-		void UpdateNode(INode* nextNode, INode* prevNode, unsigned int netPointIdx);
+		void ResetState(SearchNode* node);
+		void UpdateNode(SearchNode* nextNode, SearchNode* prevNode, unsigned int netPointIdx);
 
 		void IterateNodes(const std::vector<INode*>& allNodes);
 		void IterateNodeNeighbors(const std::vector<INode*>& nxtNodes);
 
+		void StorePathNodes();
 		void TracePath(IPath* path);
 		void SmoothPath(IPath* path) const;
 		bool SmoothPathIter(IPath* path) const;
 
-		// global queue: allocated once, re-used by all searches without clear()'s
-		// this relies on INode::operator< to sort the INode*'s by increasing f-cost
-		static binary_heap<INode*> openNodes;
+		// the source-node may be impassable, but must not have infinite cost
+		float GetMoveCost(const INode* n) const { return ((n == srcNode)? srcMoveCost: n->GetMoveCost()); }
+		bool IsImpassable(const INode* n) const { return (GetMoveCost(n) == QTPFS_POSITIVE_INFINITY); }
+
+		// per-thread queues and node-states: allocated once, re-used by all searches without clear()'s
+		// the queues rely on SearchNode::operator< to sort the SearchNode*'s by increasing f-cost
+		static std::array<SearchThreadData, ThreadPool::MAX_THREADS> threadData;
 
 		NodeLayer* nodeLayer;
 		PathCache* pathCache;
@@ -176,11 +255,20 @@ namespace QTPFS {
 		PathSearchTrace::Execution* searchExec;
 		PathSearchTrace::Iteration searchIter;
 
+		// only valid during Execute, points into <threadData>
+		SearchThreadData* searchData;
+
 		SRectangle searchRect;
 
 		INode *srcNode, *tgtNode;
-		INode *curNode, *nxtNode;
-		INode *minNode;
+		SearchNode *curNode, *nxtNode;
+		SearchNode *minNode;
+
+		// nodes and transition-points of the path from tgtNode back to srcNode,
+		// copied out of <searchData> before the next search on the same thread
+		// re-uses it
+		std::vector<INode*> pathNodes;
+		std::vector<float2> pathPoints;
 
 		float3 srcPoint;
 		float3 tgtPoint;
@@ -193,6 +281,9 @@ namespace QTPFS {
 		float hCosts[QTPFS_MAX_NETPOINTS_PER_NODE_EDGE];
 
 		float hCostMult;
+		float srcMoveCost;
+
+		unsigned int numExpandedNodes = 0;
 
 		bool haveFullPath;
 		bool havePartPath;
@@ -118,3 +118,18 @@ CExpGenSpawnable* CExpGenSpawnable::CreateSpawnable(int spawnableID)
 
 	return nullptr;
 }
+
+unsigned int CExpGenSpawnable::CreateSpawnables(int spawnableID, CExpGenSpawnable** spawnables, unsigned int count)
+{
+	int i = 0;
+#define CHECK_SPAWNABLE(spawnable)                                  \
+	if (spawnableID == i)                                           \
+		return (projMemPool.alloc_n<spawnable>(spawnables, count)); \
+	++i;
+
+	CHECK_ALL_SPAWNABLES()
+
+#undef CHECK_SPAWNABLE
+
+	return 0;
+}
@@ -16,12 +16,17 @@ public:
 
 	virtual ~CExpGenSpawnable();
 	virtual void Init(const CUnit* owner, const float3& offset) = 0;
+	// hands a purely visual spawnable to the GPU particle backend instead of
+	// Init'ing it; if this returns true the caller has to free the instance
+	virtual bool InitGPU(const CUnit* owner, const float3& offset) { return false; }
 
 	static bool GetSpawnableMemberInfo(const std::string& spawnableName, SExpGenSpawnableMemberInfo& memberInfo);
 	static int GetSpawnableID(const std::string& spawnableName);
 
 	//Memory handled in projectileHandler
 	static CExpGenSpawnable* CreateSpawnable(int spawnableID);
+	/// allocates <count> instances in one pass, returns how many the pool could fit
+	static unsigned int CreateSpawnables(int spawnableID, CExpGenSpawnable** spawnables, unsigned int count);
 
 protected:
 	CExpGenSpawnable();
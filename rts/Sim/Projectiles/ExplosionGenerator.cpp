@@ -1,9 +1,11 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <iostream>
 #include <stdexcept>
 #include <cassert>
 #include <cinttypes>
+#include <cstring>
 
 #include "ExplosionGenerator.h"
 #include "ExpGenSpawner.h" //!!
@@ -696,6 +698,18 @@ void CCustomExplosionGenerator::ExecuteExplosionCode(const char* code, float dam
 				code += 4;
 				break;
 			}
+			case OP_SCALE: {
+				val *= (*(float*) code);
+				code += 4;
+				break;
+			}
+			case OP_STOREC: {
+				std::uint8_t  size   = *(std::uint8_t*)  code; code++;
+				std::uint16_t offset = *(std::uint16_t*) code; code += 2;
+				std::memcpy(instance + offset, code, size);
+				code += size;
+				break;
+			}
 			default: {
 				assert(false);
 				break;
@@ -706,6 +720,219 @@ void CCustomExplosionGenerator::ExecuteExplosionCode(const char* code, float dam
 
 
 
+std::string CCustomExplosionGenerator::FoldExplosionCode(const std::string& code)
+{
+	// symbolic execution of the code; while val is known its runtime register
+	// holds zero (nothing has been emitted since the last store or yank) and
+	// the constant is only materialized once something unknown gets mixed in
+	// known buffer slots are never read at runtime, their consumers are folded
+	// NB: OP_YANK indices are clamped to [0, 16] by the parser
+	float val = 0.0f;
+	float buffer[17];
+	bool knownBuffer[17];
+	bool knownVal = true;
+
+	std::fill(std::begin(buffer), std::end(buffer), 0.0f);
+	std::fill(std::begin(knownBuffer), std::end(knownBuffer), true);
+
+	std::string folded;
+	folded.reserve(code.size());
+
+	const auto EmitOp = [&](char op, const char* operand, size_t size) {
+		folded.append(1, op);
+		folded.append(operand, operand + size);
+	};
+	const auto EmitVal = [&]() {
+		if (!knownVal)
+			return;
+
+		if (val != 0.0f)
+			EmitOp(OP_ADD, (const char*) &val, sizeof(val));
+
+		knownVal = false;
+	};
+
+	for (const char* c = code.data(), *e = c + code.size(); c < e; ) {
+		const char op = *(c++);
+
+		switch (op) {
+			case OP_END: {
+				folded.append(1, OP_END);
+				return folded;
+			}
+
+			case OP_STOREI:
+			case OP_STOREF: {
+				const std::uint8_t size = *(const std::uint8_t*) c;
+
+				if (!knownVal) {
+					EmitOp(op, c, 3);
+				} else {
+					// same conversions as ExecuteExplosionCode
+					std::int8_t  i8  = (int) val;
+					std::int16_t i16 = (int) val;
+					std::int32_t i32 = (int) val;
+					std::int64_t i64 = (int) val;
+					double       f64 = val;
+
+					const char* src = nullptr;
+
+					if (op == OP_STOREI) {
+						switch (size) {
+							case 1: { src = (const char*) &i8;  } break;
+							case 2: { src = (const char*) &i16; } break;
+							case 4: { src = (const char*) &i32; } break;
+							case 8: { src = (const char*) &i64; } break;
+							default: {} break;
+						}
+					} else {
+						switch (size) {
+							case 4: { src = (const char*) &val; } break;
+							case 8: { src = (const char*) &f64; } break;
+							default: {} break;
+						}
+					}
+
+					if (src != nullptr) {
+						EmitOp(OP_STOREC, c, 3);
+						folded.append(src, src + size);
+					}
+				}
+
+				c += 3;
+				val = 0.0f;
+				knownVal = true;
+			} break;
+
+			case OP_ADD: {
+				if (knownVal) {
+					val += *(const float*) c;
+				} else {
+					EmitOp(op, c, 4);
+				}
+				c += 4;
+			} break;
+
+			case OP_RAND:
+			case OP_DAMAGE:
+			case OP_INDEX: {
+				EmitVal();
+				EmitOp(op, c, 4);
+				c += 4;
+			} break;
+
+			case OP_LOADP: {
+				EmitOp(op, c, sizeof(void*));
+				c += sizeof(void*);
+			} break;
+			case OP_STOREP:
+			case OP_DIR: {
+				EmitOp(op, c, 2);
+				c += 2;
+			} break;
+
+			case OP_SAWTOOTH: {
+				if (knownVal) {
+					val -= (*(const float*) c) * math::floor(val / (*(const float*) c));
+				} else {
+					EmitOp(op, c, 4);
+				}
+				c += 4;
+			} break;
+			case OP_DISCRETE: {
+				if (knownVal) {
+					val = (*(const float*) c) * math::floor(spring::SafeDivide(val, (*(const float*) c)));
+				} else {
+					EmitOp(op, c, 4);
+				}
+				c += 4;
+			} break;
+			case OP_SINE: {
+				if (knownVal) {
+					val = (*(const float*) c) * math::sin(val);
+				} else {
+					EmitOp(op, c, 4);
+				}
+				c += 4;
+			} break;
+			case OP_POW: {
+				if (knownVal) {
+					val = math::pow(val, (*(const float*) c));
+				} else {
+					EmitOp(op, c, 4);
+				}
+				c += 4;
+			} break;
+
+			case OP_YANK: {
+				const int idx = *(const int*) c;
+
+				if ((knownBuffer[idx] = knownVal)) {
+					buffer[idx] = val;
+				} else {
+					EmitOp(op, c, 4);
+				}
+
+				c += 4;
+				val = 0.0f;
+				knownVal = true;
+			} break;
+			case OP_MULTIPLY: {
+				const int idx = *(const int*) c;
+
+				if (!knownBuffer[idx]) {
+					EmitVal();
+					EmitOp(op, c, 4);
+				} else if (knownVal) {
+					val *= buffer[idx];
+				} else {
+					EmitOp(OP_SCALE, (const char*) &buffer[idx], sizeof(float));
+				}
+
+				c += 4;
+			} break;
+			case OP_ADDBUFF: {
+				const int idx = *(const int*) c;
+
+				if (!knownBuffer[idx]) {
+					EmitVal();
+					EmitOp(op, c, 4);
+				} else if (knownVal) {
+					val += buffer[idx];
+				} else {
+					EmitOp(OP_ADD, (const char*) &buffer[idx], sizeof(float));
+				}
+
+				c += 4;
+			} break;
+			case OP_POWBUFF: {
+				const int idx = *(const int*) c;
+
+				if (!knownBuffer[idx]) {
+					EmitVal();
+					EmitOp(op, c, 4);
+				} else if (knownVal) {
+					val = math::pow(val, buffer[idx]);
+				} else {
+					EmitOp(OP_POW, (const char*) &buffer[idx], sizeof(float));
+				}
+
+				c += 4;
+			} break;
+
+			default: {
+				assert(false);
+				return code;
+			} break;
+		}
+	}
+
+	folded.append(1, OP_END);
+	return folded;
+}
+
+
+
 void CCustomExplosionGenerator::ParseExplosionCode(
 	CCustomExplosionGenerator::ProjectileSpawnInfo* psi,
 	const string& script,
@@ -896,6 +1123,7 @@ bool CCustomExplosionGenerator::Load(CExplosionGeneratorHandler* handler, const
 		}
 
 		code += (char)OP_END;
+		code = FoldExplosionCode(code);
 		psi.code.resize(code.size());
 		copy(code.begin(), code.end(), psi.code.begin());
 
@@ -951,6 +1179,11 @@ bool CCustomExplosionGenerator::Explosion(
 	const std::vector<ProjectileSpawnInfo>& spawnInfo = expGenParams.projectiles;
 	const GroundFlashInfo& groundFlash = expGenParams.groundFlash;
 
+	// spawnables never explode while being initialized, so one buffer suffices
+	static std::vector<CExpGenSpawnable*> spawnables;
+
+	projectileHandler.BeginCreationBatch();
+
 	for (int a = 0; a < spawnInfo.size(); a++) {
 		const ProjectileSpawnInfo& psi = spawnInfo[a];
 
@@ -962,13 +1195,26 @@ bool CCustomExplosionGenerator::Explosion(
 		if (projectileHandler.GetParticleSaturation() > 1.0f)
 			break;
 
-		for (unsigned int c = 0; c < psi.count; c++) {
-			CExpGenSpawnable* projectile = CExpGenSpawnable::CreateSpawnable(psi.spawnableID);
+		spawnables.resize(psi.count);
+
+		const unsigned int count = CExpGenSpawnable::CreateSpawnables(psi.spawnableID, spawnables.data(), psi.count);
+
+		for (unsigned int c = 0; c < count; c++) {
+			CExpGenSpawnable* projectile = spawnables[c];
 			ExecuteExplosionCode(&psi.code[0], damage, (char*) projectile, c, dir);
-			projectile->Init(owner, pos);
+
+			if (!projectile->InitGPU(owner, pos)) {
+				projectile->Init(owner, pos);
+				continue;
+			}
+
+			// simulated on the GPU from here on, no CPU instance needed
+			projMemPool.free(projectile);
 		}
 	}
 
+	projectileHandler.EndCreationBatch();
+
 	if (groundExplosion && (groundFlash.ttl > 0) && (groundFlash.flashSize > 1))
 		projMemPool.alloc<CStandardGroundFlash>(pos, groundFlash);
 
@@ -146,7 +146,7 @@ protected:
 		unsigned int count = 0;
 		unsigned int flags = 0;
 
-		/// parsed explosion script code
+		/// parsed explosion script code, with constant sub-expressions folded
 		std::vector<char> code;
 	};
 
@@ -201,12 +201,18 @@ public:
 		OP_ADDBUFF  = 16, // Adds buffer value
 		OP_POW      = 17, // Power with code as exponent
 		OP_POWBUFF  = 18, // Power with buffer as exponent
+		// only emitted by FoldExplosionCode
+		OP_SCALE    = 19, // Multiplies with code value (OP_MULTIPLY by a load-time constant)
+		OP_STOREC   = 20, // store a pre-converted load-time constant of any size
 	};
 
 private:
 	void ParseExplosionCode(ProjectileSpawnInfo* psi, const std::string& script, SExpGenSpawnableMemberInfo& memberInfo, std::string& code);
 	void ExecuteExplosionCode(const char* code, float damage, char* instance, int spawnIndex, const float3& dir);
 
+	/// evaluates every part of the code that does not depend on damage, randomness or spawn-index
+	static std::string FoldExplosionCode(const std::string& code);
+
 protected:
 	ExpGenParams expGenParams;
 };
@@ -50,6 +50,7 @@ CR_REG_METADATA(CProjectile,
 	CR_MEMBER(projectileType),
 	CR_MEMBER(collisionFlags),
 	CR_IGNORED(renderIndex),
+	CR_IGNORED(updateBucket),
 
 	CR_MEMBER(quads)
 ))
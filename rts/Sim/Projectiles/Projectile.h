@@ -41,6 +41,14 @@ public:
 	//Not inheritable - used for removing a projectile from Lua.
 	void Delete();
 	virtual void Update();
+	/// true if Update() only touches this projectile, so that all instances
+	/// of the class can be updated concurrently (unsynced particles only)
+	virtual bool HasIsolatedUpdate() const { return false; }
+	/// true if the motion part of Update() is split off into UpdateMotion(),
+	/// so that it can run for all instances of the class concurrently (synced)
+	virtual bool HasSplitUpdate() const { return false; }
+	/// reads shared state but writes only to this projectile, runs before Update()
+	virtual void UpdateMotion() {}
 	virtual void Init(const CUnit* owner, const float3& offset) override;
 
 	virtual void Draw(GL::RenderDataBufferTC* va) const {}
@@ -81,9 +89,11 @@ public:
 	unsigned int GetProjectileType() const { return projectileType; }
 	unsigned int GetCollisionFlags() const { return collisionFlags; }
 	unsigned int GetRenderIndex() const { return renderIndex; }
+	unsigned int GetUpdateBucket() const { return updateBucket; }
 
 	void SetCustomExpGenID(unsigned int id) { cegID = id; }
 	void SetRenderIndex(unsigned int idx) { renderIndex = idx; }
+	void SetUpdateBucket(unsigned int idx) { updateBucket = idx; }
 
 	// UNSYNCED ONLY
 	CMatrix44f GetTransformMatrix(float posOffsetMult = 0.0f) const;
@@ -127,6 +137,7 @@ protected:
 	unsigned int projectileType = -1u;
 	unsigned int collisionFlags = 0;
 	unsigned int renderIndex = -1u;
+	unsigned int updateBucket = -1u;
 
 	static bool GetMemberInfo(SExpGenSpawnableMemberInfo& memberInfo);
 
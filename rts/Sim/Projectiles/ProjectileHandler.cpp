@@ -15,10 +15,12 @@
 #include "Sim/Misc/CollisionHandler.h"
 #include "Sim/Misc/CollisionVolume.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Rendering/Env/Particles/Classes/FlyingPiece.h"
 #include "Rendering/Env/Particles/Classes/NanoProjectile.h"
+#include "Rendering/Env/Particles/ProjectileDrawer.h"
 #include "Sim/Projectiles/WeaponProjectiles/WeaponProjectile.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
@@ -28,8 +30,10 @@
 #include "System/Config/ConfigHandler.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
+#include "System/MemoryStats.h"
 #include "System/SpringMath.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 
 
 // reserve 5% of maxNanoParticles for important stuff such as capture and reclaim other teams' units
@@ -55,13 +59,27 @@ CR_REG_METADATA(CProjectileHandler, (
 	CR_MEMBER_UN(lastProjectileCounts),
 
 	CR_MEMBER(freeProjectileIDs),
-	CR_MEMBER(projectileMaps)
+	CR_MEMBER(projectileMaps),
+
+	CR_IGNORED(binnedProjectiles),
+	CR_IGNORED(projectileBins),
+	CR_IGNORED(binCandidates),
+	CR_IGNORED(collisionCandidates),
+
+	CR_IGNORED(updateBucketTypes),
+	CR_IGNORED(updateBuckets),
+	CR_IGNORED(updateBucketOffsets),
+	CR_IGNORED(sortedProjectiles),
+
+	CR_IGNORED(createdBatch),
+	CR_IGNORED(batchCreation)
 ))
 
 
 
 // note: stores all ExpGenSpawnable types, not just projectiles
 ProjMemPool projMemPool;
+static MemoryStats::Registrar projMemPoolStats("Sim::Projectiles::MemPool", []() { return MemoryStats::GetPoolUsage(projMemPool); });
 
 CProjectileHandler projectileHandler;
 
@@ -157,6 +175,17 @@ void CProjectileHandler::Kill()
 	projectileMaps[ true].clear();
 	projectileMaps[false].clear();
 
+	binnedProjectiles.clear();
+	projectileBins.clear();
+	binCandidates.clear();
+	collisionCandidates.clear();
+
+	updateBucketTypes[ true].clear();
+	updateBucketTypes[false].clear();
+	updateBuckets.clear();
+	updateBucketOffsets.clear();
+	sortedProjectiles.clear();
+
 	CCollisionHandler::PrintStats();
 }
 
@@ -180,6 +209,60 @@ static void MAPPOS_SANITY_CHECK(const float3 v)
 }
 
 
+unsigned int CProjectileHandler::GetUpdateBucket(const CProjectile* p)
+{
+	std::vector<const std::type_info*>& types = updateBucketTypes[p->synced];
+
+	const std::type_info* type = &typeid(*p);
+	const auto iter = std::find_if(types.begin(), types.end(), [&](const std::type_info* t) { return (*t == *type); });
+
+	if (iter != types.end())
+		return (iter - types.begin());
+
+	types.push_back(type);
+	return (types.size() - 1);
+}
+
+void CProjectileHandler::SortUpdateBuckets(bool synced)
+{
+	ProjectileContainer& pc = projectileContainers[synced];
+
+	const size_t numBuckets = updateBucketTypes[synced].size();
+
+	updateBuckets.clear();
+	updateBucketOffsets.clear();
+	updateBucketOffsets.resize(numBuckets + 1, 0);
+
+	bool sorted = true;
+
+	for (size_t i = 0; i < pc.size(); i++) {
+		assert(pc[i]->GetUpdateBucket() < numBuckets);
+
+		updateBucketOffsets[pc[i]->GetUpdateBucket() + 1] += 1;
+		sorted &= (i == 0 || pc[i - 1]->GetUpdateBucket() <= pc[i]->GetUpdateBucket());
+	}
+
+	for (size_t b = 0; b < numBuckets; b++) {
+		updateBucketOffsets[b + 1] += updateBucketOffsets[b];
+
+		if (updateBucketOffsets[b + 1] > updateBucketOffsets[b])
+			updateBuckets.emplace_back(updateBucketOffsets[b], updateBucketOffsets[b + 1]);
+	}
+
+	// usually only the projectiles added since the last frame are out of place
+	if (sorted)
+		return;
+
+	// stable counting-sort; keeps the (synced) relative order within a class
+	sortedProjectiles.resize(pc.size());
+
+	for (CProjectile* p: pc) {
+		sortedProjectiles[updateBucketOffsets[p->GetUpdateBucket()]++] = p;
+	}
+
+	pc.swap(sortedProjectiles);
+}
+
 void CProjectileHandler::UpdateProjectiles(bool synced)
 {
 	ProjectileContainer& pc = projectileContainers[synced];
@@ -216,8 +299,10 @@ void CProjectileHandler::UpdateProjectiles(bool synced)
 
 	SCOPED_TIMER("Sim::Projectiles::Update");
 
-	// WARNING: same as above but for p->Update()
-	for (size_t i = 0; i < pc.size(); ++i) {
+	// group by class so consecutive Update calls go to the same code
+	SortUpdateBuckets(synced);
+
+	const auto UpdateProjectile = [&](size_t i) {
 		CProjectile* p = pc[i];
 		assert(p != nullptr);
 
@@ -227,6 +312,40 @@ void CProjectileHandler::UpdateProjectiles(bool synced)
 		quadField.MovedProjectile(p);
 
 		MAPPOS_SANITY_CHECK(p->pos);
+	};
+
+	const size_t numSorted = pc.size();
+
+	for (const auto& bucket: updateBuckets) {
+		// unsynced particles that do not spawn anything can be updated concurrently;
+		// quadField.MovedProjectile is a no-op for them
+		if (!synced && (bucket.second - bucket.first) >= 512 && pc[bucket.first]->HasIsolatedUpdate()) {
+			for_mt(bucket.first, bucket.second, [&](const int i) { UpdateProjectile(i); });
+			continue;
+		}
+
+		// with the modrule, split synced projectiles first integrate the motion of the
+		// whole bucket (reading only shared state), then run the rest of Update
+		// in order; only whether the first step is threaded depends on the count
+		if (synced && modInfo.multiThreadedProjectiles && pc[bucket.first]->HasSplitUpdate()) {
+			if ((bucket.second - bucket.first) >= 64) {
+				for_mt(bucket.first, bucket.second, [&](const int i) { pc[i]->UpdateMotion(); });
+			} else {
+				for (int i = bucket.first; i < bucket.second; ++i) {
+					pc[i]->UpdateMotion();
+				}
+			}
+		}
+
+		// WARNING: same as above but for p->Update()
+		for (int i = bucket.first; i < bucket.second; ++i) {
+			UpdateProjectile(i);
+		}
+	}
+
+	// projectiles added by the Update calls above, still updated this frame
+	for (size_t i = numSorted; i < pc.size(); ++i) {
+		UpdateProjectile(i);
 	}
 }
 
@@ -293,13 +412,31 @@ static void UPDATE_REF_CONTAINER(T& cont) {
 void CProjectileHandler::CreateProjectile(CProjectile* p)
 {
 	p->createMe = false;
+	p->SetUpdateBucket(GetUpdateBucket(p));
 
 	if (p->synced || PH_UNSYNCED_PROJECTILE_EVENTS == 1)
 		eventHandler.ProjectileCreated(p, p->GetAllyteamID());
 
+	if (batchCreation) {
+		createdBatch.push_back(p);
+		return;
+	}
+
 	eventHandler.RenderProjectileCreated(p);
 }
 
+void CProjectileHandler::EndCreationBatch()
+{
+	assert(batchCreation);
+	batchCreation = false;
+
+	if (createdBatch.empty())
+		return;
+
+	eventHandler.RenderProjectilesCreated(createdBatch.data(), createdBatch.size());
+	createdBatch.clear();
+}
+
 void CProjectileHandler::DestroyProjectile(CProjectile* p)
 {
 	assert(!p->createMe);
@@ -600,12 +737,205 @@ void CProjectileHandler::CheckShieldCollisions(
 	}
 }
 
+// the first object hit ends a projectile's collision test, so the objects are
+// tested in ID order (repulsers by owner ID and weapon number); QuadField order
+// would depend on which quads were queried, the whole bin's or the projectile's
+static void SortCollisionCandidates(std::vector<CUnit*>& units, std::vector<CFeature*>& features, std::vector<CPlasmaRepulser*>& repulsers)
+{
+	std::sort(units.begin(), units.end(), [](const CUnit* a, const CUnit* b) { return (a->id < b->id); });
+	std::sort(features.begin(), features.end(), [](const CFeature* a, const CFeature* b) { return (a->id < b->id); });
+	std::sort(repulsers.begin(), repulsers.end(), [](const CPlasmaRepulser* a, const CPlasmaRepulser* b) {
+		if (a->owner->id != b->owner->id)
+			return (a->owner->id < b->owner->id);
+		return (a->weaponNum < b->weaponNum);
+	});
+}
+
+void CProjectileHandler::GatherCollisionCandidates(const ProjectileContainer& pc)
+{
+	// bin projectiles by the quad containing them; sorting by {quad, index}
+	// keeps the bins and their contents independent of thread scheduling
+	binnedProjectiles.clear();
+	binnedProjectiles.reserve(pc.size());
+	projectileBins.clear();
+
+	if (collisionCandidates.size() < pc.size())
+		collisionCandidates.resize(pc.size());
+
+	for (size_t i = 0; i < pc.size(); ++i) {
+		const CProjectile* p = pc[i];
+
+		if (!(collisionCandidates[i].binned = (p->checkCol && !p->deleteMe)))
+			continue;
+
+		binnedProjectiles.emplace_back(quadField.WorldPosToQuadFieldIdx(p->pos), i);
+	}
+
+	std::sort(binnedProjectiles.begin(), binnedProjectiles.end());
+
+	for (size_t i = 0, j = 0; i < binnedProjectiles.size(); i = j) {
+		float maxRadius = 0.0f;
+
+		for (j = i; j < binnedProjectiles.size() && binnedProjectiles[j].first == binnedProjectiles[i].first; ++j) {
+			const CProjectile* p = pc[binnedProjectiles[j].second];
+			maxRadius = std::max(maxRadius, p->speed.w + p->radius);
+		}
+
+		projectileBins.push_back({binnedProjectiles[i].first, int(i), int(j), maxRadius});
+	}
+
+	binCandidates.resize(ThreadPool::GetMaxThreads());
+
+	const float2 quadSize = {quadField.GetQuadSizeX() * 1.0f, quadField.GetQuadSizeZ() * 1.0f};
+	const float quadRadius = math::sqrt(Square(quadSize.x) + Square(quadSize.y)) * 0.5f;
+
+	for_mt(0, projectileBins.size(), [&](const int binIdx) {
+		const ProjectileQuadBin& bin = projectileBins[binIdx];
+
+		CollisionCandidates& bc = binCandidates[ThreadPool::GetThreadNum()];
+
+		const int qx = bin.quadIdx % quadField.GetNumQuadsX();
+		const int qz = bin.quadIdx / quadField.GetNumQuadsX();
+
+		// every projectile in this bin is within quadRadius of the quad's center,
+		// so this single query covers all their individual query spheres
+		const float3 binPos = {(qx + 0.5f) * quadSize.x, 0.0f, (qz + 0.5f) * quadSize.y};
+
+		quadField.GetQuadsMT(bc.quads, binPos, bin.maxRadius + quadRadius);
+
+		bc.units.clear();
+		bc.features.clear();
+		bc.repulsers.clear();
+
+		// objects overlapping multiple queried quads are only taken from the first
+		// one; features do not store their quads so are deduplicated by search
+		const auto InEarlierQuad = [&](const int oqi, const int qi) {
+			return (oqi < qi && std::binary_search(bc.quads.begin(), bc.quads.end(), oqi));
+		};
+
+		for (const int qi: bc.quads) {
+			const CQuadField::Quad& quad = quadField.GetQuad(qi);
+
+			for (CUnit* u: quad.units) {
+				if (std::find_if(u->quads.begin(), u->quads.end(), [&](int uqi) { return InEarlierQuad(uqi, qi); }) != u->quads.end())
+					continue;
+
+				bc.units.push_back(u);
+			}
+			for (CFeature* f: quad.features) {
+				if (std::find(bc.features.begin(), bc.features.end(), f) != bc.features.end())
+					continue;
+
+				bc.features.push_back(f);
+			}
+			for (CPlasmaRepulser* r: quad.repulsers) {
+				const std::vector<int>& rquads = r->GetQuads();
+
+				if (std::find_if(rquads.begin(), rquads.end(), [&](int rqi) { return InEarlierQuad(rqi, qi); }) != rquads.end())
+					continue;
+
+				bc.repulsers.push_back(r);
+			}
+		}
+
+		// the per-projectile lists below are filtered from these in order
+		SortCollisionCandidates(bc.units, bc.features, bc.repulsers);
+
+		bc.shieldSpheres.clear();
+		bc.shieldDeltaDists.clear();
+		bc.shieldHits.resize(bc.repulsers.size());
+
+		// shield volumes are offset-free spheres around the muzzle (see CheckShieldCollisions)
+		for (const CPlasmaRepulser* r: bc.repulsers) {
+			bc.shieldSpheres.emplace_back(r->weaponMuzzlePos, r->collisionVolume.GetBoundingRadius());
+			bc.shieldDeltaDists.push_back(r->GetDeltaDist());
+		}
+
+		// narrow the shared bin lists down per projectile (same tests as
+		// CQuadField::GetUnitsAndFeaturesColVol)
+		for (int k = bin.begIdx; k < bin.endIdx; ++k) {
+			const CProjectile* p = pc[binnedProjectiles[k].second];
+			const float3& pos = p->pos;
+			const float radius = p->speed.w + p->radius;
+
+			CollisionCandidates& cc = collisionCandidates[binnedProjectiles[k].second];
+
+			cc.units.clear();
+			cc.features.clear();
+			cc.repulsers.clear();
+
+			for (CUnit* u: bc.units) {
+				const float totRad = radius + u->collisionVolume.GetBoundingRadius();
+
+				if (pos.SqDistance(u->collisionVolume.GetWorldSpacePos(u)) >= (totRad * totRad))
+					continue;
+
+				cc.units.push_back(u);
+			}
+			for (CFeature* f: bc.features) {
+				const float totRad = radius + f->collisionVolume.GetBoundingRadius();
+
+				if (pos.SqDistance(f->collisionVolume.GetWorldSpacePos(f)) >= (totRad * totRad))
+					continue;
+
+				cc.features.push_back(f);
+			}
+
+			if (bc.repulsers.empty())
+				continue;
+
+			// segment-vs-sphere over the packed arrays, for the (nudged) segment
+			// CheckShieldCollisions hands to DetectHit; a shield only becomes a
+			// candidate if that segment can reach it
+			const float3 segVec = p->speed;
+			const float segLenSq = segVec.SqLength();
+
+			const float4* spheres = bc.shieldSpheres.data();
+			const float* deltaDists = bc.shieldDeltaDists.data();
+			unsigned char* hits = bc.shieldHits.data();
+
+			for (size_t n = 0, numShields = bc.repulsers.size(); n < numShields; ++n) {
+				const float3 center = {spheres[n].x, spheres[n].y, spheres[n].z};
+
+				// the previous (query-sphere) test, kept so no new candidates appear
+				const float totRad = radius + spheres[n].w;
+				// padded so float differences with DetectHit can not drop a hit
+				const float hitRad = spheres[n].w + 1.0f;
+
+				// the segment starts deltaDist lengths behind pos, ends at pos + speed
+				const float segScale = 1.0f + deltaDists[n];
+				const float3 begVec = center - (pos - segVec * deltaDists[n]);
+
+				const float t = (segLenSq > 0.0f)? Clamp(begVec.dot(segVec) / (segLenSq * segScale), 0.0f, 1.0f): 0.0f;
+				const float3 sepVec = begVec - segVec * (segScale * t);
+
+				hits[n] = (pos.SqDistance(center) < (totRad * totRad)) && (sepVec.SqLength() <= (hitRad * hitRad));
+			}
+
+			for (size_t n = 0, numShields = bc.repulsers.size(); n < numShields; ++n) {
+				if (!hits[n])
+					continue;
+
+				cc.repulsers.push_back(bc.repulsers[n]);
+			}
+		}
+	});
+}
+
 void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc)
 {
 	static std::vector<CUnit*> tempUnits;
 	static std::vector<CFeature*> tempFeatures;
 	static std::vector<CPlasmaRepulser*> tempRepulsers;
 
+	// broadphase (read-only) runs in parallel; the narrowphase and hit response
+	// stay sequential and in container order since a hit changes the state of
+	// the projectile, its target and (for shields) the projectile's trajectory
+	GatherCollisionCandidates(pc);
+
+	// collisions can spawn projectiles (appended) but not reorder the container
+	const size_t numGathered = pc.size();
+
 	for (size_t i = 0; i < pc.size(); ++i) {
 		CProjectile* p = pc[i];
 
@@ -616,7 +946,19 @@ void CProjectileHandler::CheckUnitFeatureCollisions(ProjectileContainer& pc)
 		const float3 ppos1 = p->pos + p->speed;
 		// const float3 ppos1 = p->pos + p->dir * (p->speed.w + p->radius);
 
+		// projectiles spawned by collisions earlier in this loop were not binned,
+		// nor were those that only became collidable after gathering
+		if (i < numGathered && collisionCandidates[i].binned) {
+			CollisionCandidates& cc = collisionCandidates[i];
+
+			CheckShieldCollisions(p, cc.repulsers, ppos0, ppos1);
+			CheckUnitCollisions(p, cc.units, ppos0, ppos1);
+			CheckFeatureCollisions(p, cc.features, ppos0, ppos1);
+			continue;
+		}
+
 		quadField.GetUnitsAndFeaturesColVol(p->pos, p->speed.w + p->radius, tempUnits, tempFeatures, &tempRepulsers);
+		SortCollisionCandidates(tempUnits, tempFeatures, tempRepulsers);
 
 		CheckShieldCollisions(p, tempRepulsers, ppos0, ppos1); tempRepulsers.clear();
 		CheckUnitCollisions(p, tempUnits, ppos0, ppos1); tempUnits.clear();
@@ -687,6 +1029,10 @@ void CProjectileHandler::AddFlyingPiece(
 	const float2 pieceParams,
 	const int2 renderParams
 ) {
+	// parts are only kept CPU-side if the GPU path is unavailable
+	if (projectileDrawer != nullptr && projectileDrawer->GetGPUFlyingPieceDrawer().AddFlyingPiece(model, piece, m, speed, pieceParams, renderParams))
+		return;
+
 	flyingPieces[model->type].emplace_back(model, piece, m, pos, speed, pieceParams, renderParams);
 	resortFlyingPieces[model->type] = true;
 }
@@ -4,6 +4,8 @@
 #define PROJECTILE_HANDLER_H
 
 #include <array>
+#include <cassert>
+#include <typeinfo>
 #include <vector>
 
 #include "Rendering/Models/3DModel.h"
@@ -64,6 +66,9 @@ public:
 	int GetCurrentParticles() const;
 
 	void AddProjectile(CProjectile* p);
+	/// projectiles added between these calls are announced to renderers as one batch
+	void BeginCreationBatch() { assert(!batchCreation); batchCreation = true; }
+	void EndCreationBatch();
 	void AddGroundFlash(CGroundFlash* flash) { groundFlashes.push_back(flash); }
 	void AddFlyingPiece(
 		const S3DModel* model,
@@ -108,6 +113,51 @@ private:
 		UpdateProjectiles(false);
 	}
 
+	void GatherCollisionCandidates(const ProjectileContainer&);
+
+	unsigned int GetUpdateBucket(const CProjectile* p);
+	void SortUpdateBuckets(bool synced);
+
+private:
+	struct CollisionCandidates {
+		std::vector<CUnit*> units;
+		std::vector<CFeature*> features;
+		std::vector<CPlasmaRepulser*> repulsers;
+		std::vector<int> quads;
+
+		// packed spheres (xyz := center, w := radius) and ray-nudge factors
+		// of <repulsers>, filled per bin for the segment-vs-sphere pre-test
+		std::vector<float4> shieldSpheres;
+		std::vector<float> shieldDeltaDists;
+		std::vector<unsigned char> shieldHits;
+
+		// false if the projectile was not binned this frame, the lists are then stale
+		bool binned = false;
+	};
+	struct ProjectileQuadBin {
+		int quadIdx;
+		int begIdx;
+		int endIdx;
+		float maxRadius;
+	};
+
+	// broadphase state for CheckUnitFeatureCollisions, rebuilt each frame
+	std::vector<std::pair<int, int>> binnedProjectiles; // {quadIdx, pcIdx}
+	std::vector<ProjectileQuadBin> projectileBins;
+	std::vector<CollisionCandidates> binCandidates; // per thread
+	std::vector<CollisionCandidates> collisionCandidates; // per pcIdx
+
+	// projectiles are updated grouped by concrete class; [0] unsynced, [1] synced
+	// (separate so the synced bucket indices only depend on synced history)
+	std::vector<const std::type_info*> updateBucketTypes[2];
+	std::vector<std::pair<int, int>> updateBuckets; // {begIdx, endIdx}, rebuilt each frame
+	std::vector<int> updateBucketOffsets;
+	ProjectileContainer sortedProjectiles;
+
+	// projectiles whose RenderProjectileCreated event is pending
+	std::vector<const CProjectile*> createdBatch;
+	bool batchCreation = false;
+
 private:
 	// [0] := available unsynced projectile ID's
 	// [1] := available synced (weapon, piece) projectile ID's
@@ -6,11 +6,11 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "System/MemPoolTypes.h"
 
-#if (defined(__x86_64) || defined(__x86_64__) || defined(__e2k__))
-typedef StaticMemPool<MAX_PROJECTILES, 868> ProjMemPool;
-#else
-typedef FixedDynMemPool<868, MAX_PROJECTILES / 2000, MAX_PROJECTILES / 64> ProjMemPool;
-#endif
+// most live projectiles are small particles (smoke, heatclouds, nano-spray and
+// ground-flashes are all below 432 bytes), weapon projectiles mostly fit into
+// 576 bytes and only a few types (flares, fireballs, starbursts) need the full
+// 872, so every class gets its own pages; sizes have to be in ascending order
+typedef MultiSizeMemPool<MAX_PROJECTILES / 2000, MAX_PROJECTILES / 64, 432, 576, 872> ProjMemPool;
 
 extern ProjMemPool projMemPool;
 
@@ -11,6 +11,7 @@
 #include "Rendering/Textures/TextureAtlas.h"
 #include "Sim/Misc/GeometricObjects.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/ModInfo.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Projectiles/ProjectileMemPool.h"
@@ -36,13 +37,16 @@ CR_REG_METADATA(CMissileProjectile,(
 	CR_MEMBER(wobbleDir),
 	CR_MEMBER(wobbleTime),
 	CR_MEMBER(wobbleDif),
+	CR_MEMBER(wobbleRand),
 	CR_MEMBER(danceMove),
 	CR_MEMBER(danceCenter),
+	CR_MEMBER(danceRand),
 	CR_MEMBER(danceTime),
 	CR_MEMBER(isDancing),
 	CR_MEMBER(extraHeight),
 	CR_MEMBER(extraHeightDecay),
 	CR_MEMBER(extraHeightTime),
+	CR_IGNORED(cegPos),
 	CR_IGNORED(smokeTrail)
 ))
 
@@ -78,6 +82,12 @@ CMissileProjectile::CMissileProjectile(const ProjectileParams& params): CWeaponP
 		isDancing = (weaponDef->dance > 0);
 		isWobbling = (weaponDef->wobble > 0);
 
+		// consumed by the first Update, later ones are drawn by UpdateRandomVectors
+		if (modInfo.multiThreadedProjectiles) {
+			wobbleRand = isWobbling? gsRNG.NextVector(): ZeroVector;
+			danceRand = isDancing? gsRNG.NextVector(): ZeroVector;
+		}
+
 		if (weaponDef->trajectoryHeight > 0.0f) {
 			const float dist = pos.distance(targetPos);
 
@@ -127,10 +137,8 @@ void CMissileProjectile::Collision(CFeature* feature)
 	oldSmoke = pos;
 }
 
-void CMissileProjectile::Update()
+void CMissileProjectile::IntegrateMotion()
 {
-	const CUnit* own = owner();
-
 	if (--ttl > 0) {
 		if (!luaMoveCtrl) {
 			speed.w += (weaponDef->weaponacceleration * (speed.w < maxSpeed));
@@ -186,21 +194,38 @@ void CMissileProjectile::Update()
 			// dir and speed.w have changed, keep speed-vector in sync
 			SetDirectionAndSpeed(dir, speed.w);
 		}
-
-		explGenHandler.GenExplosion(cegID, pos, dir, ttl, damages->damageAreaOfEffect, 0.0f, NULL, NULL);
 	} else {
-		if (weaponDef->selfExplode) {
-			Collision();
-		} else {
-			// only when TTL <= 0 do we (missiles)
-			// get influenced by gravity and drag
-			if (!luaMoveCtrl)
-				SetVelocityAndSpeed((speed * 0.98f) + (UpVector * mygravity));
-		}
+		// Update explodes us where we are
+		if (weaponDef->selfExplode)
+			return;
+
+		// only when TTL <= 0 do we (missiles)
+		// get influenced by gravity and drag
+		if (!luaMoveCtrl)
+			SetVelocityAndSpeed((speed * 0.98f) + (UpVector * mygravity));
 	}
 
+	cegPos = pos;
+
 	if (!luaMoveCtrl)
 		SetPosition(pos + speed);
+}
+
+void CMissileProjectile::Update()
+{
+	const CUnit* own = owner();
+
+	FinishMotion();
+	UpdateRandomVectors();
+
+	if (ttl > 0) {
+		explGenHandler.GenExplosion(cegID, cegPos, dir, ttl, damages->damageAreaOfEffect, 0.0f, NULL, NULL);
+	} else if (weaponDef->selfExplode) {
+		Collision();
+
+		if (!luaMoveCtrl)
+			SetPosition(pos + speed);
+	}
 
 	age++;
 	numParts++;
@@ -269,8 +294,8 @@ void CMissileProjectile::UpdateWobble() {
 		return;
 
 	if ((--wobbleTime) <= 0) {
-		wobbleDif = (gsRNG.NextVector() - wobbleDir) * (1.0f / 16);
-		wobbleTime = 16;
+		wobbleDif = ((modInfo.multiThreadedProjectiles? wobbleRand: gsRNG.NextVector()) - wobbleDir) * (1.0f / WOBBLE_PERIOD);
+		wobbleTime = WOBBLE_PERIOD;
 	}
 
 	float wobbleFact = weaponDef->wobble;
@@ -287,14 +312,26 @@ void CMissileProjectile::UpdateDance() {
 		return;
 
 	if ((--danceTime) <= 0) {
-		danceMove = gsRNG.NextVector() * weaponDef->dance - danceCenter;
+		danceMove = (modInfo.multiThreadedProjectiles? danceRand: gsRNG.NextVector()) * weaponDef->dance - danceCenter;
 		danceCenter += danceMove;
-		danceTime = 8;
+		danceTime = DANCE_PERIOD;
 	}
 
 	SetPosition(pos + danceMove);
 }
 
+// with multiThreadedProjectiles UpdateWobble and UpdateDance might run concurrently,
+// so the synced random vectors they consume are drawn here in order, once per period
+void CMissileProjectile::UpdateRandomVectors() {
+	if (luaMoveCtrl || !modInfo.multiThreadedProjectiles)
+		return;
+
+	if (isWobbling && wobbleTime == WOBBLE_PERIOD)
+		wobbleRand = gsRNG.NextVector();
+	if (isDancing && danceTime == DANCE_PERIOD)
+		danceRand = gsRNG.NextVector();
+}
+
 
 void CMissileProjectile::UpdateGroundBounce() {
 	if (luaMoveCtrl)
@@ -14,6 +14,7 @@ class CMissileProjectile : public CWeaponProjectile
 	CR_DECLARE_DERIVED(CMissileProjectile)
 protected:
 	void UpdateGroundBounce() override;
+	void IntegrateMotion() override;
 public:
 	// creg only
 	CMissileProjectile() { }
@@ -25,6 +26,7 @@ public:
 	void Collision() override;
 
 	void Update() override;
+	bool HasSplitUpdate() const override { return true; }
 	void Draw(GL::RenderDataBufferTC* va) const override;
 
 	int GetProjectilesCount() const override { return 1; }
@@ -37,6 +39,7 @@ private:
 	float3 UpdateTargeting();
 	void UpdateWobble();
 	void UpdateDance();
+	void UpdateRandomVectors();
 
 	bool ignoreError;
 
@@ -58,6 +61,9 @@ private:
 	float3 danceCenter;
 	float3 wobbleDir;
 	float3 wobbleDif;
+	float3 wobbleRand;
+	float3 danceRand;
+	float3 cegPos; // where IntegrateMotion was before its final move
 
 	float3 oldSmoke;
 	float3 oldDir;
@@ -65,6 +71,9 @@ private:
 
 	/// the smokes life-time in frames
 	static const float SMOKE_TIME;
+
+	static constexpr int WOBBLE_PERIOD = 16;
+	static constexpr int DANCE_PERIOD = 8;
 };
 
 
@@ -130,7 +130,7 @@ void CStarburstProjectile::Collision(CFeature* feature)
 }
 
 
-void CStarburstProjectile::Update()
+void CStarburstProjectile::IntegrateMotion()
 {
 	ttl--;
 	uptime--;
@@ -142,6 +142,11 @@ void CStarburstProjectile::Update()
 		UpdateTrajectory();
 		SetPosition(pos + speed);
 	}
+}
+
+void CStarburstProjectile::Update()
+{
+	FinishMotion();
 
 	if (ttl > 0)
 		explGenHandler.GenExplosion(cegID, pos, dir, ttl, damages->damageAreaOfEffect, 0.0f, nullptr, nullptr);
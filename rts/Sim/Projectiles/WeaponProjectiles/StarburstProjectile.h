@@ -23,6 +23,7 @@ public:
 	void Collision(CFeature* feature) override;
 	void Collision() override;
 	void Update() override;
+	bool HasSplitUpdate() const override { return true; }
 	void Draw(GL::RenderDataBufferTC* va) const override;
 
 	int GetProjectilesCount() const override { return (numParts + 1); }
@@ -30,6 +31,10 @@ public:
 	int ShieldRepulse(const float3& shieldPos, float shieldForce, float shieldMaxSpeed) override;
 
 	void SetIgnoreError(bool b) { ignoreError = b; }
+
+protected:
+	void IntegrateMotion() override;
+
 private:
 	void UpdateTargeting();
 	void UpdateTrajectory();
@@ -28,7 +28,8 @@ CR_REG_METADATA(CTorpedoProjectile,(
 	CR_MEMBER(maxSpeed),
 	CR_MEMBER(nextBubble),
 	CR_MEMBER(texx),
-	CR_MEMBER(texy)
+	CR_MEMBER(texy),
+	CR_IGNORED(cegPos)
 ))
 
 
@@ -106,7 +107,7 @@ float3 CTorpedoProjectile::UpdateTargetingDir(const float3& targetObjVel)
 	return (dir * speed.w);
 }
 
-void CTorpedoProjectile::Update()
+void CTorpedoProjectile::IntegrateMotion()
 {
 	// tracking only works when we are underwater
 	if (!weaponDef->submissile && pos.y > 0.0f) {
@@ -125,8 +126,6 @@ void CTorpedoProjectile::Update()
 				// do not need to update dir or speed.w here
 				CWorldObject::SetVelocity(targetHitVel);
 			}
-
-			explGenHandler.GenExplosion(cegID, pos, speed, ttl, damages->damageAreaOfEffect, 0.0f, nullptr, nullptr);
 		} else {
 			if (!luaMoveCtrl) {
 				// must update dir and speed.w here
@@ -135,8 +134,19 @@ void CTorpedoProjectile::Update()
 		}
 	}
 
+	cegPos = pos;
+
 	if (!luaMoveCtrl)
 		SetPosition(pos + speed);
+}
+
+void CTorpedoProjectile::Update()
+{
+	FinishMotion();
+
+	// ttl only counts down underwater, where the CEG is spawned
+	if ((weaponDef->submissile || cegPos.y <= 0.0f) && ttl > 0)
+		explGenHandler.GenExplosion(cegID, cegPos, speed, ttl, damages->damageAreaOfEffect, 0.0f, nullptr, nullptr);
 
 	if (pos.y < -2.0f) {
 		if ((--nextBubble) == 0) {
@@ -14,12 +14,16 @@ public:
 	CTorpedoProjectile(const ProjectileParams& params);
 
 	void Update() override;
+	bool HasSplitUpdate() const override { return true; }
 	void Draw(GL::RenderDataBufferTC* va) const override;
 
 	int GetProjectilesCount() const override { return 8; }
 
 	void SetIgnoreError(bool b) { ignoreError = b; }
 
+protected:
+	void IntegrateMotion() override;
+
 private:
 	float3 UpdateTargetingPos();
 	float3 UpdateTargetingDir(const float3& targetObjVel);
@@ -33,6 +37,8 @@ private:
 
 	float texx;
 	float texy;
+
+	float3 cegPos; // where IntegrateMotion was before its final move
 };
 
 
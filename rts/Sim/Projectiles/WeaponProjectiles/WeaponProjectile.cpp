@@ -39,6 +39,7 @@ CR_REG_METADATA(CWeaponProjectile,(
 	CR_MEMBER(ttl),
 	CR_MEMBER(bounces),
 	CR_MEMBER(weaponNum),
+	CR_IGNORED(motionUpdated),
 
 	CR_POSTLOAD(PostLoad)
 ))
@@ -258,6 +259,29 @@ void CWeaponProjectile::Update()
 	UpdateInterception();
 }
 
+void CWeaponProjectile::UpdateMotion()
+{
+	// the target might be moving concurrently, integrate in order instead
+	if (TracksProjectile())
+		return;
+
+	IntegrateMotion();
+	motionUpdated = true;
+}
+
+void CWeaponProjectile::FinishMotion()
+{
+	if (!motionUpdated)
+		IntegrateMotion();
+
+	motionUpdated = false;
+}
+
+bool CWeaponProjectile::TracksProjectile() const
+{
+	return (target != nullptr && dynamic_cast<const CProjectile*>(target) != nullptr);
+}
+
 
 void CWeaponProjectile::UpdateInterception()
 {
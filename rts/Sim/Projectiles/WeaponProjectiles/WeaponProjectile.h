@@ -29,6 +29,7 @@ public:
 	virtual void Collision(CFeature* feature) override;
 	virtual void Collision(CUnit* unit) override;
 	virtual void Update() override;
+	virtual void UpdateMotion() override;
 	/// @return 0=unaffected, 1=instant repulse, 2=gradual repulse
 	virtual int ShieldRepulse(const float3& shieldPos, float shieldForce, float shieldMaxSpeed) { return 0; }
 
@@ -70,6 +71,13 @@ protected:
 	void UpdateInterception();
 	virtual void UpdateGroundBounce();
 
+	/// targeting, steering and movement part of a split Update()
+	virtual void IntegrateMotion() {}
+	/// called first by a split Update(), integrates if UpdateMotion() did not
+	void FinishMotion();
+	/// projectile targets are themselves moved concurrently by UpdateMotion()
+	bool TracksProjectile() const;
+
 protected:
 	const WeaponDef* weaponDef;
 
@@ -84,6 +92,8 @@ protected:
 	// and an interceptor projectile is on the way
 	bool targeted;
 	bool bounced;
+	/// set by UpdateMotion() for the Update() call that follows it
+	bool motionUpdated = false;
 
 	float3 startPos;
 	float3 targetPos;
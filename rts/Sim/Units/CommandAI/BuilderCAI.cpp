@@ -3,6 +3,7 @@
 #include <cassert>
 
 #include "BuilderCAI.h"
+#include "BuilderWorkIndex.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "Game/GameHelper.h"
 #include "Game/SelectedUnitsHandler.h"
@@ -228,6 +229,8 @@ void CBuilderCAI::InitStatic()
 	spring::clear_unordered_set(reclaimers);
 	spring::clear_unordered_set(featureReclaimers);
 	spring::clear_unordered_set(resurrecters);
+
+	builderWorkIndex.Init();
 }
 
 void CBuilderCAI::PostLoad()
@@ -1713,8 +1716,21 @@ bool CBuilderCAI::FindRepairTargetAndRepair(
 	bool attackEnemy,
 	bool builtOnly
 ) {
+	// only a builder that may attack enemies has to look at every unit in range;
+	// otherwise the candidates are the damaged allied units from the work index
+	static std::vector<CUnit*> damagedUnits;
+
+	const bool canAttackEnemy = (attackEnemy && owner->unitDef->canAttack && (owner->maxRange > 0));
+
 	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, pos, radius, false);
+
+	if (canAttackEnemy) {
+		quadField.GetUnitsExact(qfQuery, pos, radius, false);
+	} else {
+		builderWorkIndex.GetDamagedUnits(damagedUnits, owner->allyteam, pos, radius);
+	}
+
+	const std::vector<CUnit*>& units = canAttackEnemy? *qfQuery.units: damagedUnits;
 	const CUnit* bestUnit = nullptr;
 
 	const float maxSpeed = owner->moveType->GetMaxSpeed();
@@ -1725,7 +1741,7 @@ bool CBuilderCAI::FindRepairTargetAndRepair(
 	bool trySelfRepair = false;
 	bool stationary = false;
 
-	for (const CUnit* unit: *qfQuery.units) {
+	for (const CUnit* unit: units) {
 		if (teamHandler.Ally(owner->allyteam, unit->allyteam)) {
 			if (!haveEnemy && (unit->health < unit->maxHealth)) {
 				// don't help allies build unless set on roam
@@ -1777,7 +1793,7 @@ bool CBuilderCAI::FindRepairTargetAndRepair(
 			if (unit->IsNeutral())
 				continue;
 
-			if (!attackEnemy || !owner->unitDef->canAttack || (owner->maxRange <= 0) )
+			if (!canAttackEnemy)
 				continue;
 
 			if (!(unit->losStatus[owner->allyteam] & (LOS_INRADAR | LOS_INLOS)))
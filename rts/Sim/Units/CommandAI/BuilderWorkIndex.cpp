@@ -0,0 +1,104 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "BuilderWorkIndex.h"
+#include "Sim/Misc/TeamHandler.h"
+#include "Sim/Units/Unit.h"
+#include "Sim/Units/UnitHandler.h"
+
+CBuilderWorkIndex builderWorkIndex;
+
+
+void CBuilderWorkIndex::Init()
+{
+	damagedUnits.clear();
+	unitAllyTeams.clear();
+
+	rebuild = true;
+}
+
+void CBuilderWorkIndex::Rebuild()
+{
+	damagedUnits.clear();
+	damagedUnits.resize(teamHandler.ActiveAllyTeams());
+	unitAllyTeams.clear();
+	unitAllyTeams.resize(unitHandler.MaxUnits(), -1);
+
+	rebuild = false;
+
+	for (const CUnit* unit: unitHandler.GetActiveUnits()) {
+		if (unit->health >= unit->maxHealth)
+			continue;
+
+		AddDamagedUnit(unit);
+	}
+}
+
+
+void CBuilderWorkIndex::AddDamagedUnit(const CUnit* unit)
+{
+	// everything gets picked up by the rebuild
+	if (rebuild)
+		return;
+
+	int& queuedAllyTeam = unitAllyTeams[unit->id];
+
+	if (queuedAllyTeam == unit->allyteam)
+		return;
+
+	// an entry left in another list is dropped once that is queried
+	damagedUnits[queuedAllyTeam = unit->allyteam].push_back(unit->id);
+}
+
+
+void CBuilderWorkIndex::GetDamagedUnits(std::vector<CUnit*>& units, int allyTeam, const float3& pos, float radius)
+{
+	if (rebuild)
+		Rebuild();
+
+	units.clear();
+
+	for (int at = 0, numAllyTeams = damagedUnits.size(); at < numAllyTeams; at++) {
+		if (!teamHandler.Ally(allyTeam, at))
+			continue;
+
+		std::vector<int>& unitIDs = damagedUnits[at];
+
+		size_t numUnitIDs = 0;
+
+		for (size_t i = 0, n = unitIDs.size(); i < n; i++) {
+			const int unitID = unitIDs[i];
+
+			// entry left behind by a later AddDamagedUnit for another allyteam
+			if (unitAllyTeams[unitID] != at)
+				continue;
+
+			CUnit* unit = unitHandler.GetUnit(unitID);
+
+			if (unit == nullptr || unit->health >= unit->maxHealth) {
+				unitAllyTeams[unitID] = -1;
+				continue;
+			}
+
+			if (unit->allyteam != at) {
+				unitAllyTeams[unitID] = -1;
+				AddDamagedUnit(unit);
+				continue;
+			}
+
+			// compact in place, keeps the order of the remaining entries
+			unitIDs[numUnitIDs++] = unitID;
+
+			if (unit->IsInVoid())
+				continue;
+
+			const float totRad = radius + unit->radius;
+
+			if (pos.SqDistance2D(unit->pos) >= (totRad * totRad))
+				continue;
+
+			units.push_back(unit);
+		}
+
+		unitIDs.resize(numUnitIDs);
+	}
+}
@@ -0,0 +1,49 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef BUILDER_WORK_INDEX_H
+#define BUILDER_WORK_INDEX_H
+
+#include <vector>
+
+#include "System/float3.h"
+
+class CUnit;
+
+/**
+ * Per-allyteam lists of units that might need repair or assistance, so
+ * builders looking for work do not have to range-query (and then reject)
+ * every healthy unit around them each SlowUpdate.
+ *
+ * Units are (re)added by whatever lowers their health or raises their
+ * maximum, or moves them to another allyteam; entries that are dead or
+ * back at full health are only dropped while querying. Not saved, the
+ * lists are rebuilt from the active units by the first query after Init.
+ */
+class CBuilderWorkIndex {
+public:
+	void Init();
+
+	/// call whenever <unit> may have dropped below full health or changed allyteam
+	void AddDamagedUnit(const CUnit* unit);
+
+	/**
+	 * fills <units> with the damaged units allied to <allyTeam> whose
+	 * bounding circle overlaps the (XZ) circle of <radius> around <pos>
+	 */
+	void GetDamagedUnits(std::vector<CUnit*>& units, int allyTeam, const float3& pos, float radius);
+
+private:
+	void Rebuild();
+
+private:
+	// IDs of possibly damaged units, per allyteam
+	std::vector< std::vector<int> > damagedUnits;
+	// allyteam-list each unit ID is queued in, or -1
+	std::vector<int> unitAllyTeams;
+
+	bool rebuild = true;
+};
+
+extern CBuilderWorkIndex builderWorkIndex;
+
+#endif
@@ -97,6 +97,20 @@ void Command::CopyParams(const Command& c) {
 	}
 }
 
+void Command::MoveParams(Command& c) {
+	if (IsPooledCommand())
+		cmdParamsPool.ReleasePage(pageIndex);
+
+	pageIndex = c.pageIndex;
+	numParams = c.numParams;
+
+	memcpy(&params[0], &c.params[0], sizeof(params));
+
+	// <c> no longer owns the page
+	c.pageIndex = -1u;
+	c.numParams = 0;
+}
+
 void Command::Serialize(creg::ISerializer* s) {
 	if (s->IsWriting()) {
 		for (unsigned int i = 0; i < numParams; i++) {
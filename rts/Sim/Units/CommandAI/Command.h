@@ -6,6 +6,7 @@
 #include <string>
 #include <climits> // INT_MAX
 #include <cstring> // memset
+#include <utility> // std::move
 
 #include "System/creg/creg_cond.h"
 #include "System/float3.h"
@@ -173,6 +174,22 @@ public:
 		return *this;
 	}
 
+	Command(Command&& c) {
+		*this = std::move(c);
+	}
+
+	// takes over <c>'s pooled params instead of copying them to a new page
+	Command& operator = (Command&& c) {
+		if (this == &c)
+			return *this;
+
+		memcpy(&id[0], &c.id[0], sizeof(id));
+
+		SetFlags(c.timeOut, c.tag, c.options);
+		MoveParams(c);
+		return *this;
+	}
+
 	Command(const float3& pos) {
 		memset(&params[0], 0, sizeof(params));
 
@@ -423,6 +440,7 @@ public:
 	}
 
 	void CopyParams(const Command& c);
+	void MoveParams(Command& c);
 
 	void Serialize(creg::ISerializer* s);
 
@@ -38,7 +38,8 @@ CR_REG_METADATA(CCommandDescriptionCache, (
 
 	CR_MEMBER(numCmdDescrs),
 	CR_MEMBER(numFreeSlots),
-	CR_MEMBER(cacheFullCtr)
+	CR_MEMBER(cacheFullCtr),
+	CR_IGNORED(numReleases)
 ))
 
 
@@ -82,6 +83,7 @@ void CCommandDescriptionCache::Init()
 	numCmdDescrs = 0;
 	numFreeSlots = slots.size();
 	cacheFullCtr = 0;
+	numReleases += 1;
 }
 
 void CCommandDescriptionCache::Dump(bool forced)
@@ -222,6 +224,7 @@ void CCommandDescriptionCache::DecRef(const SCommandDescription& cd)
 		if (icd.refCount == 1) {
 			// return free slot
 			slots[numFreeSlots++] = it->second;
+			numReleases += 1;
 
 			// delete from index
 			for (unsigned int j = it - ibeg, n = --numCmdDescrs; j < n; j++) {
@@ -88,6 +88,9 @@ public:
 	void DecRef(std::vector<const SCommandDescription*>& cmdDescs);
 	void DecRef(const SCommandDescription& cd);
 
+	/// changes whenever a slot is released, pointers obtained before may then refer to other descriptions
+	unsigned int GetNumReleases() const { return numReleases; }
+
 private:
 	int CalcHash(const SCommandDescription& cd) const;
 
@@ -102,6 +105,7 @@ private:
 	unsigned int numCmdDescrs = 0;
 	unsigned int numFreeSlots = 0;
 	unsigned int cacheFullCtr = 0;
+	unsigned int numReleases = 0;
 };
 
 extern CCommandDescriptionCache commandDescriptionCache;
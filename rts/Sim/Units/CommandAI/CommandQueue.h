@@ -4,8 +4,66 @@
 #define _COMMAND_QUEUE_H
 
 #include <deque>
+#include <vector>
 #include "Command.h"
 
+/**
+ * Hands out the deque's blocks (its Command chunks and its chunk map)
+ * from per-size free-lists, so queues that keep filling up and draining
+ * stop going to the heap once the lists are warm. A contiguous ring would
+ * avoid the chunks altogether but moves elements when it grows, while
+ * the CAI's routinely hold references to queued commands across push_*.
+ */
+template<typename T> struct CommandQueueAllocator {
+public:
+	typedef T value_type;
+
+	CommandQueueAllocator() = default;
+	template<typename U> CommandQueueAllocator(const CommandQueueAllocator<U>&) {}
+
+	T* allocate(size_t n) {
+		std::vector<void*>& blocks = GetFreeBlocks(n);
+
+		if (blocks.empty())
+			return (static_cast<T*>(::operator new(n * sizeof(T))));
+
+		T* p = static_cast<T*>(blocks.back());
+		blocks.pop_back();
+		return p;
+	}
+
+	void deallocate(T* p, size_t n) { GetFreeBlocks(n).push_back(p); }
+
+	template<typename U> bool operator == (const CommandQueueAllocator<U>&) const { return true; }
+	template<typename U> bool operator != (const CommandQueueAllocator<U>&) const { return false; }
+
+private:
+	struct FreeBlocks {
+		~FreeBlocks() {
+			for (const auto& blocks: lists) {
+				for (void* p: blocks) {
+					::operator delete(p);
+				}
+			}
+		}
+
+		// indexed by block size in elements; the deque only asks for its
+		// fixed chunk size and a handful of (doubling) map sizes
+		std::vector< std::vector<void*> > lists;
+	};
+
+	static std::vector<void*>& GetFreeBlocks(size_t n) {
+		// blocks freed on another thread simply migrate to its lists
+		static thread_local FreeBlocks freeBlocks;
+
+		if (n >= freeBlocks.lists.size())
+			freeBlocks.lists.resize(n + 1);
+
+		return freeBlocks.lists[n];
+	}
+};
+
+
 /// A wrapper class for std::deque<Command> to keep track of commands
 class CCommandQueue {
 
@@ -28,7 +86,7 @@ class CCommandQueue {
 		/// limit to a float's integer range
 		static const int maxTagValue = (1 << 24); // 16777216
 
-		typedef std::deque<Command> basis;
+		typedef std::deque<Command, CommandQueueAllocator<Command> > basis;
 
 		typedef basis::size_type              size_type;
 		typedef basis::iterator               iterator;
@@ -42,54 +100,70 @@ class CCommandQueue {
 
 		inline void push_back(const Command& cmd);
 		inline void push_front(const Command& cmd);
+		inline void push_back(Command&& cmd);
+		inline void push_front(Command&& cmd);
 
 		inline iterator insert(iterator pos, const Command& cmd);
+		inline iterator insert(iterator pos, Command&& cmd);
 
 		inline void pop_back()
 		{
 			queue.pop_back();
+			BumpRevision();
 		}
 		inline void pop_front()
 		{
 			queue.pop_front();
+			BumpRevision();
 		}
 
 		inline iterator erase(iterator pos)
 		{
+			BumpRevision();
 			return queue.erase(pos);
 		}
 		inline iterator erase(iterator first, iterator last)
 		{
+			BumpRevision();
 			return queue.erase(first, last);
 		}
 		inline void clear()
 		{
 			queue.clear();
+			BumpRevision();
 		}
 
-		inline iterator       end()         { return queue.end(); }
+		// non-const access can modify commands in-place, so it also counts as a change
+		inline iterator       end()         { return (BumpRevision(), queue.end()); }
 		inline const_iterator end()   const { return queue.end(); }
-		inline iterator       begin()       { return queue.begin(); }
+		inline iterator       begin()       { return (BumpRevision(), queue.begin()); }
 		inline const_iterator begin() const { return queue.begin(); }
 
-		inline reverse_iterator       rend()         { return queue.rend(); }
+		inline reverse_iterator       rend()         { return (BumpRevision(), queue.rend()); }
 		inline const_reverse_iterator rend()   const { return queue.rend(); }
-		inline reverse_iterator       rbegin()       { return queue.rbegin(); }
+		inline reverse_iterator       rbegin()       { return (BumpRevision(), queue.rbegin()); }
 		inline const_reverse_iterator rbegin() const { return queue.rbegin(); }
 
-		inline       Command& back()        { return queue.back(); }
+		inline       Command& back()        { return (BumpRevision(), queue.back()); }
 		inline const Command& back()  const { return queue.back(); }
-		inline       Command& front()       { return queue.front(); }
+		inline       Command& front()       { return (BumpRevision(), queue.front()); }
 		inline const Command& front() const { return queue.front(); }
 
-		inline       Command& at(size_type i)       { return queue.at(i); }
+		inline       Command& at(size_type i)       { return (BumpRevision(), queue.at(i)); }
 		inline const Command& at(size_type i) const { return queue.at(i); }
 
-		inline       Command& operator[](size_type i)       { return queue[i]; }
+		inline       Command& operator[](size_type i)       { return (BumpRevision(), queue[i]); }
 		inline const Command& operator[](size_type i) const { return queue[i]; }
 
+		/**
+		 * Changes whenever the queue (possibly) did, for caching anything
+		 * derived from it. Values are unique across all queues, so a revision
+		 * also identifies the queue it was taken from.
+		 */
+		inline unsigned int GetRevision() const { return revision; }
+
 	private:
-		CCommandQueue() : queueType(CommandQueueType), tagCounter(0) {};
+		CCommandQueue() : queueType(CommandQueueType), tagCounter(0) { BumpRevision(); };
 		CCommandQueue(const CCommandQueue&);
 		CCommandQueue& operator=(const CCommandQueue&);
 
@@ -97,15 +171,26 @@ class CCommandQueue {
 		inline int GetNextTag();
 		inline void SetQueueType(QueueType type) { queueType = type; }
 
+		inline void BumpRevision() {
+			// unsynced; shared by all queues, wrapping around is harmless
+			static unsigned int revisionCounter = 0;
+			revision = ++revisionCounter;
+		}
+
 	private:
-		std::deque<Command> queue;
+		basis queue;
 		QueueType queueType;
 		int tagCounter;
+
+		unsigned int revision = 0;
 };
 
 
 inline int CCommandQueue::GetNextTag()
 {
+	// every insertion goes through here
+	BumpRevision();
+
 	tagCounter++;
 	if (tagCounter >= maxTagValue)
 		tagCounter = 1;
@@ -128,11 +213,32 @@ inline void CCommandQueue::push_front(const Command& cmd)
 }
 
 
+inline void CCommandQueue::push_back(Command&& cmd)
+{
+	queue.push_back(std::move(cmd));
+	queue.back().SetTag(GetNextTag());
+}
+
+
+inline void CCommandQueue::push_front(Command&& cmd)
+{
+	queue.push_front(std::move(cmd));
+	queue.front().SetTag(GetNextTag());
+}
+
+
 inline CCommandQueue::iterator CCommandQueue::insert(iterator pos, const Command& cmd)
 {
 	Command tmpCmd = cmd;
 	tmpCmd.SetTag(GetNextTag());
-	return queue.insert(pos, tmpCmd);
+	return queue.insert(pos, std::move(tmpCmd));
+}
+
+
+inline CCommandQueue::iterator CCommandQueue::insert(iterator pos, Command&& cmd)
+{
+	cmd.SetTag(GetNextTag());
+	return queue.insert(pos, std::move(cmd));
 }
 
 
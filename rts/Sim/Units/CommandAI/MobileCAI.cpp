@@ -2,6 +2,7 @@
 
 
 #include "MobileCAI.h"
+#include "TransportAreaIndex.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "Game/GameHelper.h"
 #include "Game/GlobalUnsynced.h"
@@ -1588,6 +1589,16 @@ bool CMobileCAI::FindEmptySpot(const CUnit* unloadee, const float3& center, floa
 		// adjust to mid-position
 		pos.y -= unloadee->radius;
 
+		// synced callers share one solids-snapshot per area and frame, which
+		// also holds the spots already handed out to other transports
+		if (fromSynced) {
+			if (!transportAreaIndex.IsUnloadSpotFree(center, radius, owner->allyteam, pos, spread, unitDef->IsAirUnit()? owner: nullptr))
+				continue;
+
+			found = pos;
+			return true;
+		}
+
 		// passing spread as query-radius ensures units are spaced at least
 		// this far apart, since <units> will be non-empty if pos is closer
 		// to a previous unloadee than <spread> elmos
@@ -1613,10 +1624,12 @@ CUnit* CMobileCAI::FindUnitToTransport(float3 center, float radius)
 	CUnit* bestUnit = nullptr;
 	float bestDist = std::numeric_limits<float>::max();
 
-	QuadFieldQuery qfQuery;
-	quadField.GetUnitsExact(qfQuery, center, radius);
+	// transports given the same area-load order share the gathered candidates;
+	// each pick is claimed via loadingTransportId before the next one searches
+	for (CUnit* unit: transportAreaIndex.GetLoadCandidates(center, radius, owner->allyteam)) {
+		if (unit->isDead)
+			continue;
 
-	for (CUnit* unit: *qfQuery.units) {
 		const float dist = unit->pos.SqDistance2D(owner->pos);
 
 		if (unit->loadingTransportId != -1 && unit->loadingTransportId != owner->id) {
@@ -1632,10 +1645,8 @@ CUnit* CMobileCAI::FindUnitToTransport(float3 center, float radius)
 		if (!owner->CanTransport(unit))
 			continue;
 
-		if (unit->losStatus[owner->allyteam] & (LOS_INRADAR | LOS_INLOS)) {
-			bestDist = dist;
-			bestUnit = unit;
-		}
+		bestDist = dist;
+		bestUnit = unit;
 	}
 
 	return bestUnit;
@@ -1758,6 +1769,7 @@ void CMobileCAI::UnloadUnits_Land(Command& c)
 
 		if (FindEmptySpot(tu.unit, pos, radius, spread, unloadPos)) {
 			transportee = tu.unit;
+			transportAreaIndex.ReserveUnloadSpot(pos, radius, owner->allyteam, unloadPos, transportee->radius);
 			break;
 		}
 	}
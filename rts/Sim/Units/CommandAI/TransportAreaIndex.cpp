@@ -0,0 +1,118 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "TransportAreaIndex.h"
+#include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/QuadField.h"
+#include "Sim/Units/Unit.h"
+#include "System/SpringMath.h"
+
+#include <algorithm>
+
+CTransportAreaIndex transportAreaIndex;
+
+
+CTransportAreaIndex::Area& CTransportAreaIndex::GetArea(const float3& center, float radius, int allyTeam)
+{
+	// drop areas no order has referred to for a while
+	areas.erase(std::remove_if(areas.begin(), areas.end(), [](const Area& a) { return ((gs->frameNum - a.lastUseFrame) > UNLOAD_SPOT_TTL); }), areas.end());
+
+	for (Area& a: areas) {
+		if (a.allyTeam != allyTeam || a.radius != radius || a.center != center)
+			continue;
+
+		a.lastUseFrame = gs->frameNum;
+		return a;
+	}
+
+	areas.emplace_back();
+
+	Area& a = areas.back();
+	a.center = center;
+	a.radius = radius;
+	a.allyTeam = allyTeam;
+	a.loadFrame = -1;
+	a.unloadFrame = -1;
+	a.lastUseFrame = gs->frameNum;
+	return a;
+}
+
+
+const std::vector<CUnit*>& CTransportAreaIndex::GetLoadCandidates(const float3& center, float radius, int allyTeam)
+{
+	Area& a = GetArea(center, radius, allyTeam);
+
+	if (a.loadFrame == gs->frameNum)
+		return a.loadCandidates;
+
+	a.loadFrame = gs->frameNum;
+	a.loadCandidates.clear();
+
+	QuadFieldQuery qfQuery;
+	quadField.GetUnitsExact(qfQuery, center, radius);
+
+	for (CUnit* unit: *qfQuery.units) {
+		if ((unit->losStatus[allyTeam] & (LOS_INRADAR | LOS_INLOS)) == 0)
+			continue;
+
+		a.loadCandidates.push_back(unit);
+	}
+
+	return a.loadCandidates;
+}
+
+
+bool CTransportAreaIndex::IsUnloadSpotFree(const float3& center, float radius, int allyTeam, const float3& pos, float spread, const CSolidObject* ignoree)
+{
+	Area& a = GetArea(center, radius, allyTeam);
+
+	if (a.unloadFrame != gs->frameNum) {
+		a.unloadFrame = gs->frameNum;
+		a.solids.clear();
+		a.solidObjects.clear();
+
+		// spread never exceeds max(radius, SQUARE_SIZE), so this covers
+		// every solid within spread of any position inside the area
+		QuadFieldQuery qfQuery;
+		quadField.GetSolidsExact(qfQuery, center, radius + std::max(radius, 1.0f * SQUARE_SIZE), 0xFFFFFFFF, CSolidObject::CSTATE_BIT_SOLIDOBJECTS);
+
+		for (const CSolidObject* obj: *qfQuery.solids) {
+			a.solids.emplace_back(obj->pos, obj->radius);
+			a.solidObjects.push_back(obj);
+		}
+
+		for (size_t i = 0; i < a.spots.size(); ) {
+			if ((gs->frameNum - a.spotFrames[i]) <= UNLOAD_SPOT_TTL) {
+				i++;
+				continue;
+			}
+
+			a.spots[i] = a.spots.back();
+			a.spotFrames[i] = a.spotFrames.back();
+			a.spots.pop_back();
+			a.spotFrames.pop_back();
+		}
+	}
+
+	// same test as GetSolidsExact(pos, spread)
+	for (size_t i = 0, n = a.solids.size(); i < n; i++) {
+		if (a.solidObjects[i] == ignoree)
+			continue;
+		if ((pos - a.solids[i]).SqLength() < Square(spread + a.solids[i].w))
+			return false;
+	}
+
+	for (const float4& spot: a.spots) {
+		if ((pos - spot).SqLength() < Square(spread + spot.w))
+			return false;
+	}
+
+	return true;
+}
+
+void CTransportAreaIndex::ReserveUnloadSpot(const float3& center, float radius, int allyTeam, const float3& pos, float unloadeeRadius)
+{
+	Area& a = GetArea(center, radius, allyTeam);
+
+	a.spots.emplace_back(pos, unloadeeRadius);
+	a.spotFrames.push_back(gs->frameNum);
+}
@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef TRANSPORT_AREA_INDEX_H
+#define TRANSPORT_AREA_INDEX_H
+
+#include <vector>
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "System/float3.h"
+#include "System/float4.h"
+
+class CUnit;
+class CSolidObject;
+
+/**
+ * Shares the spatial queries of area load and unload orders between all
+ * transports given the same order, usually a whole airlift group.
+ *
+ * Area-load candidates are gathered once per area and frame. Transports
+ * then take the closest unclaimed unit in turn; the claim each one makes
+ * (CUnit::loadingTransportId) keeps the rest from going for the same unit,
+ * so the group is matched to its cargo greedily in a single pass.
+ *
+ * Area-unload spots are tested against one per-frame snapshot of the solids
+ * in and around the area, plus the spots already handed out to the group,
+ * instead of a QuadField query per sampled position. Handed-out spots stay
+ * reserved for UNLOAD_SPOT_TTL frames, so transports that arrive later are
+ * spread over the rest of the area.
+ *
+ * Only used from synced code. Not saved, areas are rebuilt on demand.
+ */
+class CTransportAreaIndex {
+public:
+	void Init() { areas.clear(); }
+
+	/// units inside the area that are in LOS or radar of <allyTeam>, in QuadField order
+	const std::vector<CUnit*>& GetLoadCandidates(const float3& center, float radius, int allyTeam);
+
+	/**
+	 * true if a unit unloaded at <pos> inside the area would be at least <spread>
+	 * elmos away from every solid (ignoring <ignoree>) and every reserved spot
+	 */
+	bool IsUnloadSpotFree(const float3& center, float radius, int allyTeam, const float3& pos, float spread, const CSolidObject* ignoree);
+	void ReserveUnloadSpot(const float3& center, float radius, int allyTeam, const float3& pos, float unloadeeRadius);
+
+private:
+	struct Area {
+		float3 center;
+		float radius;
+		int allyTeam;
+
+		int loadFrame;
+		int unloadFrame;
+		int lastUseFrame;
+
+		std::vector<CUnit*> loadCandidates;
+
+		// {pos, radius} of each solid, never dereferenced
+		std::vector<float4> solids;
+		std::vector<const CSolidObject*> solidObjects;
+
+		// {pos, radius} and reservation frame of each handed-out spot
+		std::vector<float4> spots;
+		std::vector<int> spotFrames;
+	};
+
+	Area& GetArea(const float3& center, float radius, int allyTeam);
+
+private:
+	static constexpr int UNLOAD_SPOT_TTL = GAME_SPEED * 15;
+
+	std::vector<Area> areas;
+};
+
+extern CTransportAreaIndex transportAreaIndex;
+
+#endif
@@ -4,6 +4,10 @@
 #include "CobEngine.h"
 #include "CobThread.h"
 #include "CobFile.h"
+#include "System/TimeProfiler.h"
+#include "System/creg/ISerializer.h"
+
+#include <algorithm>
 
 
 CR_BIND(CCobEngine, )
@@ -13,20 +17,24 @@ CR_REG_METADATA(CCobEngine, (
 	CR_MEMBER(tickAddedThreads),
 
 	CR_MEMBER(runningThreadIDs),
-	CR_MEMBER(sleepingThreadIDs),
 	// always null/empty when saving
 	CR_IGNORED(waitingThreadIDs),
 
+	// saved as a flat list by Serialize
+	CR_IGNORED(sleepWheel),
+	CR_IGNORED(dueThreads),
+	CR_IGNORED(wokenThreadIDs),
+
 	CR_IGNORED(curThread),
 
 	CR_MEMBER(currentTime),
-	CR_MEMBER(threadCounter)
-))
+	CR_MEMBER(threadCounter),
 
-CR_BIND(CCobEngine::SleepingThread, )
-CR_REG_METADATA(CCobEngine::SleepingThread, (
-	CR_MEMBER(id),
-	CR_MEMBER(wt)
+	CR_IGNORED(wheelTime),
+	CR_IGNORED(numWokenThreads),
+	CR_IGNORED(numRunningThreads),
+
+	CR_SERIALIZER(Serialize)
 ))
 
 
@@ -54,7 +62,7 @@ void CCobEngine::ScheduleThread(const CCobThread* thread)
 			waitingThreadIDs.push_back(thread->GetID());
 		} break;
 		case CCobThread::Sleep: {
-			sleepingThreadIDs.push(SleepingThread{thread->GetID(), thread->GetWakeTime()});
+			AddSleepingThread(SleepingThread{thread->GetID(), thread->GetWakeTime()});
 		} break;
 		default: {
 			LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, thread->GetState(), thread->GetID());
@@ -88,38 +96,103 @@ void CCobEngine::TickThread(CCobThread* thread)
 	curThread = nullptr;
 }
 
+void CCobEngine::AddSleepingThread(const SleepingThread& st)
+{
+	// negative sleeps can ask to wake up before the wheel's current time
+	if (st.wt < wheelTime) {
+		dueThreads.push_back(st);
+		return;
+	}
+
+	// the lowest level whose slot size spans every bit in which the
+	// wake-time differs from the wheel's time
+	const unsigned int diff = unsigned(st.wt) ^ unsigned(wheelTime);
+	unsigned int level = 0;
+
+	while ((level + 1) < WHEEL_LEVELS && (diff >> (WHEEL_SLOT_BITS * (level + 1))) != 0)
+		level++;
+
+	const unsigned int slot = (unsigned(st.wt) >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1);
+
+	sleepWheel[level * WHEEL_SLOTS + slot].push_back(st);
+}
+
+void CCobEngine::CascadeSleepWheel(unsigned int level)
+{
+	const unsigned int slot = (unsigned(wheelTime) >> (WHEEL_SLOT_BITS * level)) & (WHEEL_SLOTS - 1);
+
+	std::vector<SleepingThread>& sleepers = sleepWheel[level * WHEEL_SLOTS + slot];
+
+	// these now share every bit above <level> with wheelTime and land lower
+	for (const SleepingThread& st: sleepers) {
+		AddSleepingThread(st);
+	}
+
+	sleepers.clear();
+}
+
+void CCobEngine::AdvanceSleepWheel(int time)
+{
+	for (; wheelTime < time; wheelTime++) {
+		// entering a new slot on a higher level, hand its entries down (top first)
+		for (unsigned int level = WHEEL_LEVELS - 1; level > 0; level--) {
+			if ((unsigned(wheelTime) & ((1u << (WHEEL_SLOT_BITS * level)) - 1)) == 0)
+				CascadeSleepWheel(level);
+		}
+
+		// everything in the current level-0 slot wakes up at exactly wheelTime
+		std::vector<SleepingThread>& sleepers = sleepWheel[unsigned(wheelTime) & (WHEEL_SLOTS - 1)];
+
+		dueThreads.insert(dueThreads.end(), sleepers.begin(), sleepers.end());
+		sleepers.clear();
+	}
+}
+
 void CCobEngine::WakeSleepingThreads()
 {
-	// check on the sleeping threads, remove any whose owner died
-	while (!sleepingThreadIDs.empty()) {
-		CCobThread* zzzThread = GetThread((sleepingThreadIDs.top()).id);
+	// take every thread whose wake-time has passed off the wheel
+	AdvanceSleepWheel(currentTime);
 
-		if (zzzThread == nullptr) {
-			sleepingThreadIDs.pop();
-			continue;
+	numWokenThreads = 0;
+
+	// a woken thread that sleeps again normally goes back on the wheel for a
+	// later frame, but a negative sleep puts it straight back in <dueThreads>
+	while (!dueThreads.empty()) {
+		wokenThreadIDs.clear();
+
+		for (const SleepingThread& st: dueThreads) {
+			wokenThreadIDs.push_back(st.id);
 		}
 
-		// not yet time to execute this thread or any subsequent sleepers
-		if (zzzThread->GetWakeTime() >= currentTime)
-			break;
-
-		// remove executing thread from the queue
-		sleepingThreadIDs.pop();
-
-		// wake up the thread and tick it (if not dead)
-		// this can quite possibly re-add the thread to <sleepingThreadIDs>
-		// again, but any thread is guaranteed to sleep for at least 1 tick
-		switch (zzzThread->GetState()) {
-			case CCobThread::Sleep: {
-				zzzThread->SetState(CCobThread::Run);
-				TickThread(zzzThread);
-			} break;
-			case CCobThread::Dead: {
-				RemoveThread(zzzThread->GetID());
-			} break;
-			default: {
-				LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, zzzThread->GetState(), zzzThread->GetID());
-			} break;
+		dueThreads.clear();
+
+		// wake in ID order, regardless of when in the frame each thread's
+		// sleep ended or in which order the threads went to sleep
+		std::sort(wokenThreadIDs.begin(), wokenThreadIDs.end());
+
+		for (const int threadID: wokenThreadIDs) {
+			CCobThread* zzzThread = GetThread(threadID);
+
+			// owner died while the thread was sleeping
+			if (zzzThread == nullptr)
+				continue;
+
+			// wake up the thread and tick it (if not dead)
+			// this can quite possibly re-add the thread to the wheel
+			switch (zzzThread->GetState()) {
+				case CCobThread::Sleep: {
+					zzzThread->SetState(CCobThread::Run);
+					TickThread(zzzThread);
+
+					numWokenThreads += 1;
+				} break;
+				case CCobThread::Dead: {
+					RemoveThread(zzzThread->GetID());
+				} break;
+				default: {
+					LOG_L(L_ERROR, "[COBEngine::%s] unknown state %d for thread %d", __func__, zzzThread->GetState(), zzzThread->GetID());
+				} break;
+			}
 		}
 	}
 }
@@ -133,6 +206,44 @@ void CCobEngine::Tick(int deltaTime)
 
 	WakeSleepingThreads();
 	AddQueuedThreads();
+
+	profiler.SetCounter("Sim::Script::COB::RunningThreads", numRunningThreads);
+	profiler.SetCounter("Sim::Script::COB::WokenThreads", numWokenThreads);
+}
+
+
+void CCobEngine::Serialize(creg::ISerializer* s)
+{
+	// the wheel is saved as its flat list of <id, waketime> pairs and
+	// rebuilt around the (already loaded) current time
+	std::vector<SleepingThread> sleepers;
+
+	if (s->IsWriting()) {
+		for (const auto& slot: sleepWheel) {
+			sleepers.insert(sleepers.end(), slot.begin(), slot.end());
+		}
+
+		sleepers.insert(sleepers.end(), dueThreads.begin(), dueThreads.end());
+	}
+
+	int numSleepers = sleepers.size();
+
+	s->SerializeInt(&numSleepers, sizeof(numSleepers));
+	sleepers.resize(numSleepers);
+
+	for (SleepingThread& st: sleepers) {
+		s->SerializeInt(&st.id, sizeof(st.id));
+		s->SerializeInt(&st.wt, sizeof(st.wt));
+	}
+
+	if (s->IsWriting())
+		return;
+
+	wheelTime = currentTime;
+
+	for (const SleepingThread& st: sleepers) {
+		AddSleepingThread(st);
+	}
 }
 
 
@@ -8,6 +8,7 @@
  * It also manages reading and caching of the actual .cob files.
  */
 
+#include <array>
 #include <vector>
 
 #include "CobThread.h"
@@ -27,18 +28,17 @@ class CCobEngine
 
 private:
 	struct SleepingThread {
-		CR_DECLARE_STRUCT(SleepingThread)
-
 		int id;
 		int wt;
 	};
 
-	struct CCobThreadComp: public std::binary_function<const SleepingThread&, const SleepingThread&, bool> {
-	public:
-		bool operator() (const SleepingThread& a, const SleepingThread& b) const {
-			return (a.wt > b.wt);
-		}
-	};
+	// hierarchical timer wheel for sleeping threads, keyed by wake-time (in
+	// milliseconds, frames need not be of equal length); level L has slots
+	// of 2^(8*L) ms and hands its entries down once the current time enters
+	// them, which makes sleeping and waking O(1)
+	static constexpr unsigned int WHEEL_LEVELS = 4;
+	static constexpr unsigned int WHEEL_SLOT_BITS = 8;
+	static constexpr unsigned int WHEEL_SLOTS = 1 << WHEEL_SLOT_BITS;
 
 public:
 	void Init() {
@@ -60,9 +60,14 @@ public:
 		runningThreadIDs.clear();
 		waitingThreadIDs.clear();
 
-		while (!sleepingThreadIDs.empty()) {
-			sleepingThreadIDs.pop();
+		for (auto& slot: sleepWheel) {
+			slot.clear();
 		}
+
+		dueThreads.clear();
+		wokenThreadIDs.clear();
+
+		wheelTime = 0;
 	}
 
 	void Tick(int deltaTime);
@@ -108,11 +113,19 @@ public:
 	void ScheduleThread(const CCobThread* thread);
 	void SanityCheckThreads(const CCobInstance* owner);
 
+	void Serialize(creg::ISerializer* s);
+
 private:
 	void TickThread(CCobThread* thread);
 
+	void AddSleepingThread(const SleepingThread& st);
+	void AdvanceSleepWheel(int time);
+	void CascadeSleepWheel(unsigned int level);
+
 	void WakeSleepingThreads();
 	void TickRunningThreads() {
+		numRunningThreads = runningThreadIDs.size();
+
 		// advance all currently running threads
 		for (const int threadID: runningThreadIDs) {
 			TickThread(GetThread(threadID));
@@ -139,12 +152,21 @@ private:
 
 	// stores <id, waketime> pairs s.t. after waking up the ID can be checked
 	// for validity; thread owner might get removed while a thread is sleeping
-	std::priority_queue<SleepingThread, std::vector<SleepingThread>, CCobThreadComp> sleepingThreadIDs;
+	std::array<std::vector<SleepingThread>, WHEEL_LEVELS * WHEEL_SLOTS> sleepWheel;
+	// sleepers whose wake-time has passed, not yet woken
+	std::vector<SleepingThread> dueThreads;
+	std::vector<int> wokenThreadIDs;
 
 	CCobThread* curThread = nullptr;
 
 	int currentTime = 0;
 	int threadCounter = 0;
+
+	// every sleeper waking before this time has been moved off the wheel
+	int wheelTime = 0;
+
+	int numWokenThreads = 0;
+	int numRunningThreads = 0;
 };
 
 
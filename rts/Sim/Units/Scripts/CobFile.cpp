@@ -10,6 +10,8 @@
 #include "System/StringUtil.h"
 
 #include <algorithm>
+#include <cassert>
+#include <iterator>
 #include <locale>
 #include <cctype>
 #include <cstring>
@@ -85,6 +87,240 @@ do {									\
 static std::vector<uint8_t> cobFileData;
 
 
+// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
+// And some information from basm0.8 source (basm ops.txt)
+
+// Model interaction
+constexpr int MOVE       = 0x10001000;
+constexpr int TURN       = 0x10002000;
+constexpr int SPIN       = 0x10003000;
+constexpr int STOP_SPIN  = 0x10004000;
+constexpr int SHOW       = 0x10005000;
+constexpr int HIDE       = 0x10006000;
+constexpr int CACHE      = 0x10007000;
+constexpr int DONT_CACHE = 0x10008000;
+constexpr int MOVE_NOW   = 0x1000B000;
+constexpr int TURN_NOW   = 0x1000C000;
+constexpr int SHADE      = 0x1000D000;
+constexpr int DONT_SHADE = 0x1000E000;
+constexpr int EMIT_SFX   = 0x1000F000;
+
+// Blocking operations
+constexpr int WAIT_TURN  = 0x10011000;
+constexpr int WAIT_MOVE  = 0x10012000;
+constexpr int SLEEP      = 0x10013000;
+
+// Stack manipulation
+constexpr int PUSH_CONSTANT    = 0x10021001;
+constexpr int PUSH_LOCAL_VAR   = 0x10021002;
+constexpr int PUSH_STATIC      = 0x10021004;
+constexpr int CREATE_LOCAL_VAR = 0x10022000;
+constexpr int POP_LOCAL_VAR    = 0x10023002;
+constexpr int POP_STATIC       = 0x10023004;
+constexpr int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
+
+// Arithmetic operations
+constexpr int ADD         = 0x10031000;
+constexpr int SUB         = 0x10032000;
+constexpr int MUL         = 0x10033000;
+constexpr int DIV         = 0x10034000;
+constexpr int MOD		  = 0x10034001; ///< spring specific
+constexpr int BITWISE_AND = 0x10035000;
+constexpr int BITWISE_OR  = 0x10036000;
+constexpr int BITWISE_XOR = 0x10037000;
+constexpr int BITWISE_NOT = 0x10038000;
+
+// Native function calls
+constexpr int RAND           = 0x10041000;
+constexpr int GET_UNIT_VALUE = 0x10042000;
+constexpr int GET            = 0x10043000;
+
+// Comparison
+constexpr int SET_LESS             = 0x10051000;
+constexpr int SET_LESS_OR_EQUAL    = 0x10052000;
+constexpr int SET_GREATER          = 0x10053000;
+constexpr int SET_GREATER_OR_EQUAL = 0x10054000;
+constexpr int SET_EQUAL            = 0x10055000;
+constexpr int SET_NOT_EQUAL        = 0x10056000;
+constexpr int LOGICAL_AND          = 0x10057000;
+constexpr int LOGICAL_OR           = 0x10058000;
+constexpr int LOGICAL_XOR          = 0x10059000;
+constexpr int LOGICAL_NOT          = 0x1005A000;
+
+// Flow control
+constexpr int START           = 0x10061000;
+constexpr int CALL            = 0x10062000; ///< converted when executed
+constexpr int REAL_CALL       = 0x10062001; ///< spring custom
+constexpr int LUA_CALL        = 0x10062002; ///< spring custom
+constexpr int JUMP            = 0x10064000;
+constexpr int RETURN          = 0x10065000;
+constexpr int JUMP_NOT_EQUAL  = 0x10066000;
+constexpr int SIGNAL          = 0x10067000;
+constexpr int SET_SIGNAL_MASK = 0x10068000;
+
+// Piece destruction
+constexpr int EXPLODE    = 0x10071000;
+constexpr int PLAY_SOUND = 0x10072000;
+
+// Special functions
+constexpr int SET    = 0x10082000;
+constexpr int ATTACH = 0x10083000;
+constexpr int DROP   = 0x10084000;
+
+
+// in the same order as the opcodes above and CCobFile::DecodedOp
+static constexpr struct {
+	int opcode;
+	int decodedOp;
+	int numArgs;
+} decodedOps[] = {
+	{MOVE,       CCobFile::OP_MOVE,       2},
+	{TURN,       CCobFile::OP_TURN,       2},
+	{SPIN,       CCobFile::OP_SPIN,       2},
+	{STOP_SPIN,  CCobFile::OP_STOP_SPIN,  2},
+	{SHOW,       CCobFile::OP_SHOW,       1},
+	{HIDE,       CCobFile::OP_HIDE,       1},
+	{CACHE,      CCobFile::OP_CACHE,      1},
+	{DONT_CACHE, CCobFile::OP_DONT_CACHE, 1},
+	{MOVE_NOW,   CCobFile::OP_MOVE_NOW,   2},
+	{TURN_NOW,   CCobFile::OP_TURN_NOW,   2},
+	{SHADE,      CCobFile::OP_SHADE,      1},
+	{DONT_SHADE, CCobFile::OP_DONT_SHADE, 1},
+	{EMIT_SFX,   CCobFile::OP_EMIT_SFX,   1},
+
+	{WAIT_TURN, CCobFile::OP_WAIT_TURN, 2},
+	{WAIT_MOVE, CCobFile::OP_WAIT_MOVE, 2},
+	{SLEEP,     CCobFile::OP_SLEEP,     0},
+
+	{PUSH_CONSTANT,    CCobFile::OP_PUSH_CONSTANT,    1},
+	{PUSH_LOCAL_VAR,   CCobFile::OP_PUSH_LOCAL_VAR,   1},
+	{PUSH_STATIC,      CCobFile::OP_PUSH_STATIC,      1},
+	{CREATE_LOCAL_VAR, CCobFile::OP_CREATE_LOCAL_VAR, 0},
+	{POP_LOCAL_VAR,    CCobFile::OP_POP_LOCAL_VAR,    1},
+	{POP_STATIC,       CCobFile::OP_POP_STATIC,       1},
+	{POP_STACK,        CCobFile::OP_POP_STACK,        0},
+
+	{ADD,         CCobFile::OP_ADD,         0},
+	{SUB,         CCobFile::OP_SUB,         0},
+	{MUL,         CCobFile::OP_MUL,         0},
+	{DIV,         CCobFile::OP_DIV,         0},
+	{MOD,         CCobFile::OP_MOD,         0},
+	{BITWISE_AND, CCobFile::OP_BITWISE_AND, 0},
+	{BITWISE_OR,  CCobFile::OP_BITWISE_OR,  0},
+	{BITWISE_XOR, CCobFile::OP_BITWISE_XOR, 0},
+	{BITWISE_NOT, CCobFile::OP_BITWISE_NOT, 0},
+
+	{RAND,           CCobFile::OP_RAND,           0},
+	{GET_UNIT_VALUE, CCobFile::OP_GET_UNIT_VALUE, 0},
+	{GET,            CCobFile::OP_GET,            0},
+
+	{SET_LESS,             CCobFile::OP_SET_LESS,             0},
+	{SET_LESS_OR_EQUAL,    CCobFile::OP_SET_LESS_OR_EQUAL,    0},
+	{SET_GREATER,          CCobFile::OP_SET_GREATER,          0},
+	{SET_GREATER_OR_EQUAL, CCobFile::OP_SET_GREATER_OR_EQUAL, 0},
+	{SET_EQUAL,            CCobFile::OP_SET_EQUAL,            0},
+	{SET_NOT_EQUAL,        CCobFile::OP_SET_NOT_EQUAL,        0},
+	{LOGICAL_AND,          CCobFile::OP_LOGICAL_AND,          0},
+	{LOGICAL_OR,           CCobFile::OP_LOGICAL_OR,           0},
+	{LOGICAL_XOR,          CCobFile::OP_LOGICAL_XOR,          0},
+	{LOGICAL_NOT,          CCobFile::OP_LOGICAL_NOT,          0},
+
+	{START,           CCobFile::OP_START,           2},
+	{CALL,            CCobFile::OP_REAL_CALL,       2}, // resolved by DecodeCode
+	{REAL_CALL,       CCobFile::OP_REAL_CALL,       2},
+	{LUA_CALL,        CCobFile::OP_LUA_CALL,        2},
+	{JUMP,            CCobFile::OP_JUMP,            1},
+	{RETURN,          CCobFile::OP_RETURN,          0},
+	{JUMP_NOT_EQUAL,  CCobFile::OP_JUMP_NOT_EQUAL,  1},
+	{SIGNAL,          CCobFile::OP_SIGNAL,          0},
+	{SET_SIGNAL_MASK, CCobFile::OP_SET_SIGNAL_MASK, 0},
+
+	{EXPLODE,    CCobFile::OP_EXPLODE,    1},
+	{PLAY_SOUND, CCobFile::OP_PLAY_SOUND, 1},
+
+	{SET,    CCobFile::OP_SET,    0},
+	{ATTACH, CCobFile::OP_ATTACH, 0},
+	{DROP,   CCobFile::OP_DROP,   0},
+};
+
+#if 0
+static const char* GetOpcodeName(int opcode)
+{
+	switch (opcode) {
+		case MOVE: return "move";
+		case TURN: return "turn";
+		case SPIN: return "spin";
+		case STOP_SPIN: return "stop-spin";
+		case SHOW: return "show";
+		case HIDE: return "hide";
+		case CACHE: return "cache";
+		case DONT_CACHE: return "dont-cache";
+		case TURN_NOW: return "turn-now";
+		case MOVE_NOW: return "move-now";
+		case SHADE: return "shade";
+		case DONT_SHADE: return "dont-shade";
+		case EMIT_SFX: return "sfx";
+
+		case WAIT_TURN: return "wait-for-turn";
+		case WAIT_MOVE: return "wait-for-move";
+		case SLEEP: return "sleep";
+
+		case PUSH_CONSTANT: return "pushc";
+		case PUSH_LOCAL_VAR: return "pushl";
+		case PUSH_STATIC: return "pushs";
+		case CREATE_LOCAL_VAR: return "clv";
+		case POP_LOCAL_VAR: return "popl";
+		case POP_STATIC: return "pops";
+		case POP_STACK: return "pop-stack";
+
+		case ADD: return "add";
+		case SUB: return "sub";
+		case MUL: return "mul";
+		case DIV: return "div";
+		case MOD: return "mod";
+		case BITWISE_AND: return "and";
+		case BITWISE_OR: return "or";
+		case BITWISE_XOR: return "xor";
+		case BITWISE_NOT: return "not";
+
+		case RAND: return "rand";
+		case GET_UNIT_VALUE: return "getuv";
+		case GET: return "get";
+
+		case SET_LESS: return "setl";
+		case SET_LESS_OR_EQUAL: return "setle";
+		case SET_GREATER: return "setg";
+		case SET_GREATER_OR_EQUAL: return "setge";
+		case SET_EQUAL: return "sete";
+		case SET_NOT_EQUAL: return "setne";
+		case LOGICAL_AND: return "land";
+		case LOGICAL_OR: return "lor";
+		case LOGICAL_XOR: return "lxor";
+		case LOGICAL_NOT: return "neg";
+
+		case START: return "start";
+		case CALL: return "call";
+		case REAL_CALL: return "call";
+		case LUA_CALL: return "lua_call";
+		case JUMP: return "jmp";
+		case RETURN: return "return";
+		case JUMP_NOT_EQUAL: return "jne";
+		case SIGNAL: return "signal";
+		case SET_SIGNAL_MASK: return "mask";
+
+		case EXPLODE: return "explode";
+		case PLAY_SOUND: return "play-sound";
+
+		case SET: return "set";
+		case ATTACH: return "attach";
+		case DROP: return "drop";
+	}
+
+	return "unknown";
+}
+#endif
+
+
 CCobFile::CCobFile(CFileHandler& in, const std::string& scriptName)
 {
 	name.assign(scriptName);
@@ -159,6 +395,8 @@ CCobFile::CCobFile(CFileHandler& in, const std::string& scriptName)
 		swabDWordInPlace(code[i]);
 	}
 
+	DecodeCode();
+
 	numStaticVars = ch.NumberOfStaticVars;
 
 	// if this is a TA:K script, read the sound names
@@ -199,6 +437,52 @@ CCobFile::CCobFile(CFileHandler& in, const std::string& scriptName)
 }
 
 
+void CCobFile::DecodeCode()
+{
+	const auto opsBeg = std::begin(decodedOps);
+	const auto opsEnd = std::end(decodedOps);
+
+	assert(std::is_sorted(opsBeg, opsEnd, [](const auto& a, const auto& b) { return (a.opcode < b.opcode); }));
+
+	decodedCode.clear();
+	decodedCode.resize(code.size());
+
+	for (size_t i = 0, n = code.size(); i < n; i++) {
+		DecodedInstr& instr = decodedCode[i];
+
+		const int opcode = code[i];
+		const auto iter = std::lower_bound(opsBeg, opsEnd, opcode, [](const auto& a, int op) { return (a.opcode < op); });
+
+		if (iter == opsEnd || iter->opcode != opcode) {
+			instr = {OP_UNKNOWN, {opcode, 0}};
+			continue;
+		}
+
+		// the interpreter fetched operands with bounds-checking, keep that
+		if ((i + iter->numArgs) >= n) {
+			instr = {OP_TRUNCATED, {0, 0}};
+			continue;
+		}
+
+		instr.op = iter->decodedOp;
+		instr.args[0] = (iter->numArgs > 0)? code[i + 1]: 0;
+		instr.args[1] = (iter->numArgs > 1)? code[i + 2]: 0;
+
+		if (opcode != CALL)
+			continue;
+
+		// the interpreter used to patch these into the code when first executed
+		if (static_cast<size_t>(instr.args[0]) >= scriptNames.size()) {
+			instr = {OP_UNKNOWN, {opcode, 0}};
+			continue;
+		}
+
+		if (scriptNames[instr.args[0]].find("lua_") == 0)
+			instr.op = OP_LUA_CALL;
+	}
+}
+
+
 int CCobFile::GetFunctionId(const std::string& name)
 {
 	const auto i = scriptMap.find(name);
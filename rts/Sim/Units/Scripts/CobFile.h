@@ -23,6 +23,7 @@ public:
 		numStaticVars = f.numStaticVars;
 
 		code = std::move(f.code);
+		decodedCode = std::move(f.decodedCode);
 		scriptNames = std::move(f.scriptNames);
 		scriptOffsets = std::move(f.scriptOffsets);
 
@@ -39,10 +40,99 @@ public:
 
 	int GetFunctionId(const std::string& name);
 
+public:
+	/// dense opcodes, index the dispatch table in CCobThread::Tick
+	enum DecodedOp {
+		OP_MOVE,
+		OP_TURN,
+		OP_SPIN,
+		OP_STOP_SPIN,
+		OP_SHOW,
+		OP_HIDE,
+		OP_CACHE,
+		OP_DONT_CACHE,
+		OP_MOVE_NOW,
+		OP_TURN_NOW,
+		OP_SHADE,
+		OP_DONT_SHADE,
+		OP_EMIT_SFX,
+
+		OP_WAIT_TURN,
+		OP_WAIT_MOVE,
+		OP_SLEEP,
+
+		OP_PUSH_CONSTANT,
+		OP_PUSH_LOCAL_VAR,
+		OP_PUSH_STATIC,
+		OP_CREATE_LOCAL_VAR,
+		OP_POP_LOCAL_VAR,
+		OP_POP_STATIC,
+		OP_POP_STACK,
+
+		OP_ADD,
+		OP_SUB,
+		OP_MUL,
+		OP_DIV,
+		OP_MOD,
+		OP_BITWISE_AND,
+		OP_BITWISE_OR,
+		OP_BITWISE_XOR,
+		OP_BITWISE_NOT,
+
+		OP_RAND,
+		OP_GET_UNIT_VALUE,
+		OP_GET,
+
+		OP_SET_LESS,
+		OP_SET_LESS_OR_EQUAL,
+		OP_SET_GREATER,
+		OP_SET_GREATER_OR_EQUAL,
+		OP_SET_EQUAL,
+		OP_SET_NOT_EQUAL,
+		OP_LOGICAL_AND,
+		OP_LOGICAL_OR,
+		OP_LOGICAL_XOR,
+		OP_LOGICAL_NOT,
+
+		OP_START,
+		OP_REAL_CALL, ///< CALL is resolved to this or LUA_CALL when decoding
+		OP_LUA_CALL,
+		OP_JUMP,
+		OP_RETURN,
+		OP_JUMP_NOT_EQUAL,
+		OP_SIGNAL,
+		OP_SET_SIGNAL_MASK,
+
+		OP_EXPLODE,
+		OP_PLAY_SOUND,
+
+		OP_SET,
+		OP_ATTACH,
+		OP_DROP,
+
+		OP_UNKNOWN,   ///< args[0] holds the raw opcode
+		OP_TRUNCATED, ///< operands would lie past the end of <code>
+		OP_COUNT
+	};
+
+	struct DecodedInstr {
+		int op;
+		int args[2];
+	};
+
+private:
+	void DecodeCode();
+
 public:
 	int numStaticVars = 0;
 
 	std::vector<int> code;
+	/**
+	 * One entry per word of <code>, decoded as if an instruction started
+	 * there; program counters, jump targets and return addresses are all
+	 * word offsets and index this directly.
+	 */
+	std::vector<DecodedInstr> decodedCode;
 	std::vector<std::string> scriptNames;
 	std::vector<int> scriptOffsets;
 	/// Assumes that the scripts are sorted by offset in the file
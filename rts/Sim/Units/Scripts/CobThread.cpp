@@ -8,6 +8,8 @@
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/GlobalSynced.h"
 
+#include <stdexcept>
+
 CR_BIND(CCobThread, )
 
 CR_REG_METADATA(CCobThread, (
@@ -198,86 +200,6 @@ void CCobThread::InitStack(unsigned int n, CCobThread* t)
 
 
 
-// Command documentation from http://visualta.tauniverse.com/Downloads/cob-commands.txt
-// And some information from basm0.8 source (basm ops.txt)
-
-// Model interaction
-constexpr int MOVE       = 0x10001000;
-constexpr int TURN       = 0x10002000;
-constexpr int SPIN       = 0x10003000;
-constexpr int STOP_SPIN  = 0x10004000;
-constexpr int SHOW       = 0x10005000;
-constexpr int HIDE       = 0x10006000;
-constexpr int CACHE      = 0x10007000;
-constexpr int DONT_CACHE = 0x10008000;
-constexpr int MOVE_NOW   = 0x1000B000;
-constexpr int TURN_NOW   = 0x1000C000;
-constexpr int SHADE      = 0x1000D000;
-constexpr int DONT_SHADE = 0x1000E000;
-constexpr int EMIT_SFX   = 0x1000F000;
-
-// Blocking operations
-constexpr int WAIT_TURN  = 0x10011000;
-constexpr int WAIT_MOVE  = 0x10012000;
-constexpr int SLEEP      = 0x10013000;
-
-// Stack manipulation
-constexpr int PUSH_CONSTANT    = 0x10021001;
-constexpr int PUSH_LOCAL_VAR   = 0x10021002;
-constexpr int PUSH_STATIC      = 0x10021004;
-constexpr int CREATE_LOCAL_VAR = 0x10022000;
-constexpr int POP_LOCAL_VAR    = 0x10023002;
-constexpr int POP_STATIC       = 0x10023004;
-constexpr int POP_STACK        = 0x10024000; ///< Not sure what this is supposed to do
-
-// Arithmetic operations
-constexpr int ADD         = 0x10031000;
-constexpr int SUB         = 0x10032000;
-constexpr int MUL         = 0x10033000;
-constexpr int DIV         = 0x10034000;
-constexpr int MOD		  = 0x10034001; ///< spring specific
-constexpr int BITWISE_AND = 0x10035000;
-constexpr int BITWISE_OR  = 0x10036000;
-constexpr int BITWISE_XOR = 0x10037000;
-constexpr int BITWISE_NOT = 0x10038000;
-
-// Native function calls
-constexpr int RAND           = 0x10041000;
-constexpr int GET_UNIT_VALUE = 0x10042000;
-constexpr int GET            = 0x10043000;
-
-// Comparison
-constexpr int SET_LESS             = 0x10051000;
-constexpr int SET_LESS_OR_EQUAL    = 0x10052000;
-constexpr int SET_GREATER          = 0x10053000;
-constexpr int SET_GREATER_OR_EQUAL = 0x10054000;
-constexpr int SET_EQUAL            = 0x10055000;
-constexpr int SET_NOT_EQUAL        = 0x10056000;
-constexpr int LOGICAL_AND          = 0x10057000;
-constexpr int LOGICAL_OR           = 0x10058000;
-constexpr int LOGICAL_XOR          = 0x10059000;
-constexpr int LOGICAL_NOT          = 0x1005A000;
-
-// Flow control
-constexpr int START           = 0x10061000;
-constexpr int CALL            = 0x10062000; ///< converted when executed
-constexpr int REAL_CALL       = 0x10062001; ///< spring custom
-constexpr int LUA_CALL        = 0x10062002; ///< spring custom
-constexpr int JUMP            = 0x10064000;
-constexpr int RETURN          = 0x10065000;
-constexpr int JUMP_NOT_EQUAL  = 0x10066000;
-constexpr int SIGNAL          = 0x10067000;
-constexpr int SET_SIGNAL_MASK = 0x10068000;
-
-// Piece destruction
-constexpr int EXPLODE    = 0x10071000;
-constexpr int PLAY_SOUND = 0x10072000;
-
-// Special functions
-constexpr int SET    = 0x10082000;
-constexpr int ATTACH = 0x10083000;
-constexpr int DROP   = 0x10084000;
-
 // Indices for SET, GET, and GET_UNIT_VALUE for LUA return values
 #define LUA0 110 // (LUA0 returns the lua call status, 0 or 1)
 #define LUA1 111
@@ -290,89 +212,16 @@ constexpr int DROP   = 0x10084000;
 #define LUA8 118
 #define LUA9 119
 
-#if 0
-#define GET_LONG_PC() (cobFile->code[pc++])
-#else
-// mantis #5981
-#define GET_LONG_PC() (cobFile->code.at(pc++))
-#endif
-
+// mantis #5981; pc is bounds-checked on every fetch, operands were
+// checked when the code was decoded (see CCobFile::DecodeCode)
+#define GET_INSTR_PC() (&instrs.at(pc))
 
-#if 0
-static const char* GetOpcodeName(int opcode)
-{
-	switch (opcode) {
-		case MOVE: return "move";
-		case TURN: return "turn";
-		case SPIN: return "spin";
-		case STOP_SPIN: return "stop-spin";
-		case SHOW: return "show";
-		case HIDE: return "hide";
-		case CACHE: return "cache";
-		case DONT_CACHE: return "dont-cache";
-		case TURN_NOW: return "turn-now";
-		case MOVE_NOW: return "move-now";
-		case SHADE: return "shade";
-		case DONT_SHADE: return "dont-shade";
-		case EMIT_SFX: return "sfx";
-
-		case WAIT_TURN: return "wait-for-turn";
-		case WAIT_MOVE: return "wait-for-move";
-		case SLEEP: return "sleep";
-
-		case PUSH_CONSTANT: return "pushc";
-		case PUSH_LOCAL_VAR: return "pushl";
-		case PUSH_STATIC: return "pushs";
-		case CREATE_LOCAL_VAR: return "clv";
-		case POP_LOCAL_VAR: return "popl";
-		case POP_STATIC: return "pops";
-		case POP_STACK: return "pop-stack";
-
-		case ADD: return "add";
-		case SUB: return "sub";
-		case MUL: return "mul";
-		case DIV: return "div";
-		case MOD: return "mod";
-		case BITWISE_AND: return "and";
-		case BITWISE_OR: return "or";
-		case BITWISE_XOR: return "xor";
-		case BITWISE_NOT: return "not";
-
-		case RAND: return "rand";
-		case GET_UNIT_VALUE: return "getuv";
-		case GET: return "get";
-
-		case SET_LESS: return "setl";
-		case SET_LESS_OR_EQUAL: return "setle";
-		case SET_GREATER: return "setg";
-		case SET_GREATER_OR_EQUAL: return "setge";
-		case SET_EQUAL: return "sete";
-		case SET_NOT_EQUAL: return "setne";
-		case LOGICAL_AND: return "land";
-		case LOGICAL_OR: return "lor";
-		case LOGICAL_XOR: return "lxor";
-		case LOGICAL_NOT: return "neg";
-
-		case START: return "start";
-		case CALL: return "call";
-		case REAL_CALL: return "call";
-		case LUA_CALL: return "lua_call";
-		case JUMP: return "jmp";
-		case RETURN: return "return";
-		case JUMP_NOT_EQUAL: return "jne";
-		case SIGNAL: return "signal";
-		case SET_SIGNAL_MASK: return "mask";
-
-		case EXPLODE: return "explode";
-		case PLAY_SOUND: return "play-sound";
-
-		case SET: return "set";
-		case ATTACH: return "attach";
-		case DROP: return "drop";
-	}
-
-	return "unknown";
-}
+// GCC and Clang dispatch through a label table (threaded code), every
+// handler jumps straight to the next; others fall back to a switch
+#if defined(__GNUC__)
+	#define COB_COMPUTED_GOTO 1
+#else
+	#define COB_COMPUTED_GOTO 0
 #endif
 
 
@@ -386,39 +235,75 @@ bool CCobThread::Tick()
 
 	state = Run;
 
+	const std::vector<CCobFile::DecodedInstr>& instrs = cobFile->decodedCode;
+	const CCobFile::DecodedInstr* ins = nullptr;
+
 	int r1, r2, r3, r4, r5, r6;
 
+#if (COB_COMPUTED_GOTO == 1)
+	static const void* const dispatchTable[CCobFile::OP_COUNT] = {
+		&&op_MOVE, &&op_TURN, &&op_SPIN, &&op_STOP_SPIN, &&op_SHOW, &&op_HIDE, &&op_CACHE, &&op_DONT_CACHE,
+		&&op_MOVE_NOW, &&op_TURN_NOW, &&op_SHADE, &&op_DONT_SHADE, &&op_EMIT_SFX,
+		&&op_WAIT_TURN, &&op_WAIT_MOVE, &&op_SLEEP,
+		&&op_PUSH_CONSTANT, &&op_PUSH_LOCAL_VAR, &&op_PUSH_STATIC, &&op_CREATE_LOCAL_VAR, &&op_POP_LOCAL_VAR, &&op_POP_STATIC, &&op_POP_STACK,
+		&&op_ADD, &&op_SUB, &&op_MUL, &&op_DIV, &&op_MOD, &&op_BITWISE_AND, &&op_BITWISE_OR, &&op_BITWISE_XOR, &&op_BITWISE_NOT,
+		&&op_RAND, &&op_GET_UNIT_VALUE, &&op_GET,
+		&&op_SET_LESS, &&op_SET_LESS_OR_EQUAL, &&op_SET_GREATER, &&op_SET_GREATER_OR_EQUAL, &&op_SET_EQUAL, &&op_SET_NOT_EQUAL,
+		&&op_LOGICAL_AND, &&op_LOGICAL_OR, &&op_LOGICAL_XOR, &&op_LOGICAL_NOT,
+		&&op_START, &&op_REAL_CALL, &&op_LUA_CALL, &&op_JUMP, &&op_RETURN, &&op_JUMP_NOT_EQUAL, &&op_SIGNAL, &&op_SET_SIGNAL_MASK,
+		&&op_EXPLODE, &&op_PLAY_SOUND,
+		&&op_SET, &&op_ATTACH, &&op_DROP,
+		&&op_UNKNOWN, &&op_TRUNCATED,
+	};
+
+	#define COB_OP(name) op_##name:
+	#define COB_NEXT() do { if (state != Run) goto exit; ins = GET_INSTR_PC(); goto *dispatchTable[ins->op]; } while (false)
+
+	COB_NEXT();
+	{
+		{
+#else
+	#define COB_OP(name) case CCobFile::OP_##name:
+	#define COB_NEXT() continue
+
 	while (state == Run) {
-		const int opcode = GET_LONG_PC();
-
-		switch (opcode) {
-			case PUSH_CONSTANT: {
-				r1 = GET_LONG_PC();
-				PushDataStack(r1);
-			} break;
-			case SLEEP: {
+		ins = GET_INSTR_PC();
+
+		switch (ins->op) {
+#endif
+			// every handler first steps pc over its opcode and operands, as the
+			// original fetch-as-you-go loop did; ins->args hold those operands
+			COB_OP(PUSH_CONSTANT) {
+				pc += 2;
+				PushDataStack(ins->args[0]);
+			} COB_NEXT();
+			COB_OP(SLEEP) {
+				pc += 1;
 				r1 = PopDataStack();
 				wakeTime = cobEngine->GetCurrentTime() + r1;
 				state = Sleep;
 
 				cobEngine->ScheduleThread(this);
 				return true;
-			} break;
-			case SPIN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			}
+			COB_OP(SPIN) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 				r3 = PopDataStack();         // speed
 				r4 = PopDataStack();         // accel
 				cobInst->Spin(r1, r2, r3, r4);
-			} break;
-			case STOP_SPIN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			} COB_NEXT();
+			COB_OP(STOP_SPIN) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 				r3 = PopDataStack();         // decel
 
 				cobInst->StopSpin(r1, r2, r3);
-			} break;
-			case RETURN: {
+			} COB_NEXT();
+			COB_OP(RETURN) {
+				pc += 1;
 				retCode = PopDataStack();
 
 				if (LocalReturnAddr() == -1) {
@@ -433,276 +318,294 @@ bool CCobThread::Tick()
 				pc = LocalReturnAddr();
 				dataStackSize = std::min(dataStackSize, LocalStackFrame());
 				callStackSize -= 1;
-			} break;
-
-
-			case SHADE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case DONT_SHADE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case CACHE: {
-				r1 = GET_LONG_PC();
-			} break;
-			case DONT_CACHE: {
-				r1 = GET_LONG_PC();
-			} break;
-
-
-			case CALL: {
-				r1 = GET_LONG_PC();
-				pc--;
-
-				if (cobFile->scriptNames[r1].find("lua_") == 0) {
-					cobFile->code[pc - 1] = LUA_CALL;
-					LuaCall();
-					break;
-				}
+			} COB_NEXT();
 
-				cobFile->code[pc - 1] = REAL_CALL;
 
-				// fall-through
-			}
-			case REAL_CALL: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_OP(SHADE) {
+				pc += 2;
+			} COB_NEXT();
+			COB_OP(DONT_SHADE) {
+				pc += 2;
+			} COB_NEXT();
+			COB_OP(CACHE) {
+				pc += 2;
+			} COB_NEXT();
+			COB_OP(DONT_CACHE) {
+				pc += 2;
+			} COB_NEXT();
 
-				// do not call zero-length functions
-				if (cobFile->scriptLengths[r1] == 0)
-					break;
 
-				CallInfo& ci = PushCallStackRef();
-				ci.functionId = r1;
-				ci.returnAddr = pc;
-				ci.stackTop = dataStackSize - r2;
+			COB_OP(REAL_CALL) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 
-				paramCount = r2;
+				// do not call zero-length functions
+				if (cobFile->scriptLengths[r1] != 0) {
+					CallInfo& ci = PushCallStackRef();
+					ci.functionId = r1;
+					ci.returnAddr = pc;
+					ci.stackTop = dataStackSize - r2;
+
+					paramCount = r2;
 
-				// call cobFile->scriptNames[r1]
-				pc = cobFile->scriptOffsets[r1];
-			} break;
-			case LUA_CALL: {
-				LuaCall();
-			} break;
+					// call cobFile->scriptNames[r1]
+					pc = cobFile->scriptOffsets[r1];
+				}
+			} COB_NEXT();
+			COB_OP(LUA_CALL) {
+				pc += 3;
+				LuaCall(ins->args[0], ins->args[1]);
+			} COB_NEXT();
 
 
-			case POP_STATIC: {
-				r1 = GET_LONG_PC();
+			COB_OP(POP_STATIC) {
+				pc += 2;
+				r1 = ins->args[0];
 				r2 = PopDataStack();
 
 				if (static_cast<size_t>(r1) < cobInst->staticVars.size())
 					cobInst->staticVars[r1] = r2;
-			} break;
-			case POP_STACK: {
+			} COB_NEXT();
+			COB_OP(POP_STACK) {
+				pc += 1;
 				PopDataStack();
-			} break;
+			} COB_NEXT();
 
 
-			case START: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_OP(START) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 
-				if (cobFile->scriptLengths[r1] == 0)
-					break;
+				if (cobFile->scriptLengths[r1] != 0) {
+					CCobThread t(cobInst);
 
+					t.SetID(cobEngine->GenThreadID());
+					t.InitStack(r2, this);
+					t.Start(r1, signalMask, {{0}}, true);
 
-				CCobThread t(cobInst);
-
-				t.SetID(cobEngine->GenThreadID());
-				t.InitStack(r2, this);
-				t.Start(r1, signalMask, {{0}}, true);
+					// calling AddThread directly might move <this>, defer it
+					cobEngine->QueueAddThread(std::move(t));
+				}
+			} COB_NEXT();
 
-				// calling AddThread directly might move <this>, defer it
-				cobEngine->QueueAddThread(std::move(t));
-			} break;
+			COB_OP(CREATE_LOCAL_VAR) {
+				pc += 1;
 
-			case CREATE_LOCAL_VAR: {
 				if (paramCount == 0) {
 					PushDataStack(0);
 				} else {
 					paramCount--;
 				}
-			} break;
-			case GET_UNIT_VALUE: {
+			} COB_NEXT();
+			COB_OP(GET_UNIT_VALUE) {
+				pc += 1;
 				r1 = PopDataStack();
+
 				if ((r1 >= LUA0) && (r1 <= LUA9)) {
 					PushDataStack(luaArgs[r1 - LUA0]);
-					break;
+				} else {
+					PushDataStack(cobInst->GetUnitVal(r1, 0, 0, 0, 0));
 				}
-				r1 = cobInst->GetUnitVal(r1, 0, 0, 0, 0);
-				PushDataStack(r1);
-			} break;
+			} COB_NEXT();
 
 
-			case JUMP_NOT_EQUAL: {
-				r1 = GET_LONG_PC();
+			COB_OP(JUMP_NOT_EQUAL) {
+				pc += 2;
+				r1 = ins->args[0];
 				r2 = PopDataStack();
 
 				if (r2 == 0)
 					pc = r1;
 
-			} break;
-			case JUMP: {
-				r1 = GET_LONG_PC();
+			} COB_NEXT();
+			COB_OP(JUMP) {
+				r1 = ins->args[0];
 				// this seem to be an error in the docs..
 				//r2 = cobFile->scriptOffsets[LocalFunctionID()] + r1;
 				pc = r1;
-			} break;
+			} COB_NEXT();
 
 
-			case POP_LOCAL_VAR: {
-				r1 = GET_LONG_PC();
+			COB_OP(POP_LOCAL_VAR) {
+				pc += 2;
+				r1 = ins->args[0];
 				r2 = PopDataStack();
 				dataStack[LocalStackFrame() + r1] = r2;
-			} break;
-			case PUSH_LOCAL_VAR: {
-				r1 = GET_LONG_PC();
+			} COB_NEXT();
+			COB_OP(PUSH_LOCAL_VAR) {
+				pc += 2;
+				r1 = ins->args[0];
 				r2 = dataStack[LocalStackFrame() + r1];
 				PushDataStack(r2);
-			} break;
+			} COB_NEXT();
 
 
-			case BITWISE_AND: {
+			COB_OP(BITWISE_AND) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 				PushDataStack(r1 & r2);
-			} break;
-			case BITWISE_OR: {
+			} COB_NEXT();
+			COB_OP(BITWISE_OR) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 				PushDataStack(r1 | r2);
-			} break;
-			case BITWISE_XOR: {
+			} COB_NEXT();
+			COB_OP(BITWISE_XOR) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 				PushDataStack(r1 ^ r2);
-			} break;
-			case BITWISE_NOT: {
+			} COB_NEXT();
+			COB_OP(BITWISE_NOT) {
+				pc += 1;
 				r1 = PopDataStack();
 				PushDataStack(~r1);
-			} break;
+			} COB_NEXT();
 
-			case EXPLODE: {
-				r1 = GET_LONG_PC();
+			COB_OP(EXPLODE) {
+				pc += 2;
+				r1 = ins->args[0];
 				r2 = PopDataStack();
 				cobInst->Explode(r1, r2);
-			} break;
+			} COB_NEXT();
 
-			case PLAY_SOUND: {
-				r1 = GET_LONG_PC();
+			COB_OP(PLAY_SOUND) {
+				pc += 2;
+				r1 = ins->args[0];
 				r2 = PopDataStack();
 				cobInst->PlayUnitSound(r1, r2);
-			} break;
+			} COB_NEXT();
 
-			case PUSH_STATIC: {
-				r1 = GET_LONG_PC();
+			COB_OP(PUSH_STATIC) {
+				pc += 2;
+				r1 = ins->args[0];
 
 				if (static_cast<size_t>(r1) < cobInst->staticVars.size())
 					PushDataStack(cobInst->staticVars[r1]);
-			} break;
+			} COB_NEXT();
 
-			case SET_NOT_EQUAL: {
+			COB_OP(SET_NOT_EQUAL) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 
 				PushDataStack(int(r1 != r2));
-			} break;
-			case SET_EQUAL: {
+			} COB_NEXT();
+			COB_OP(SET_EQUAL) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 
 				PushDataStack(int(r1 == r2));
-			} break;
+			} COB_NEXT();
 
-			case SET_LESS: {
+			COB_OP(SET_LESS) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 
 				PushDataStack(int(r1 < r2));
-			} break;
-			case SET_LESS_OR_EQUAL: {
+			} COB_NEXT();
+			COB_OP(SET_LESS_OR_EQUAL) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 
 				PushDataStack(int(r1 <= r2));
-			} break;
+			} COB_NEXT();
 
-			case SET_GREATER: {
+			COB_OP(SET_GREATER) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 
 				PushDataStack(int(r1 > r2));
-			} break;
-			case SET_GREATER_OR_EQUAL: {
+			} COB_NEXT();
+			COB_OP(SET_GREATER_OR_EQUAL) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 
 				PushDataStack(int(r1 >= r2));
-			} break;
+			} COB_NEXT();
 
-			case RAND: {
+			COB_OP(RAND) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 				r3 = gsRNG.NextInt(r2 - r1 + 1) + r1;
 				PushDataStack(r3);
-			} break;
-			case EMIT_SFX: {
+			} COB_NEXT();
+			COB_OP(EMIT_SFX) {
+				pc += 2;
 				r1 = PopDataStack();
-				r2 = GET_LONG_PC();
+				r2 = ins->args[0];
 				cobInst->EmitSfx(r1, r2);
-			} break;
-			case MUL: {
+			} COB_NEXT();
+			COB_OP(MUL) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 				PushDataStack(r1 * r2);
-			} break;
+			} COB_NEXT();
 
 
-			case SIGNAL: {
+			COB_OP(SIGNAL) {
+				pc += 1;
 				r1 = PopDataStack();
 				cobInst->Signal(r1);
-			} break;
-			case SET_SIGNAL_MASK: {
+			} COB_NEXT();
+			COB_OP(SET_SIGNAL_MASK) {
+				pc += 1;
 				r1 = PopDataStack();
 				signalMask = r1;
-			} break;
+			} COB_NEXT();
 
 
-			case TURN: {
+			COB_OP(TURN) {
+				pc += 3;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
-				r3 = GET_LONG_PC(); // piece
-				r4 = GET_LONG_PC(); // axis
+				r3 = ins->args[0]; // piece
+				r4 = ins->args[1]; // axis
 
 				cobInst->Turn(r3, r4, r1, r2);
-			} break;
-			case GET: {
+			} COB_NEXT();
+			COB_OP(GET) {
+				pc += 1;
 				r5 = PopDataStack();
 				r4 = PopDataStack();
 				r3 = PopDataStack();
 				r2 = PopDataStack();
 				r1 = PopDataStack();
+
 				if ((r1 >= LUA0) && (r1 <= LUA9)) {
 					PushDataStack(luaArgs[r1 - LUA0]);
-					break;
+				} else {
+					r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
+					PushDataStack(r6);
 				}
-				r6 = cobInst->GetUnitVal(r1, r2, r3, r4, r5);
-				PushDataStack(r6);
-			} break;
-			case ADD: {
+			} COB_NEXT();
+			COB_OP(ADD) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 				PushDataStack(r1 + r2);
-			} break;
-			case SUB: {
+			} COB_NEXT();
+			COB_OP(SUB) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 				r3 = r1 - r2;
 				PushDataStack(r3);
-			} break;
+			} COB_NEXT();
 
-			case DIV: {
+			COB_OP(DIV) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 
@@ -713,8 +616,9 @@ bool CCobThread::Tick()
 					ShowError("division by zero");
 				}
 				PushDataStack(r3);
-			} break;
-			case MOD: {
+			} COB_NEXT();
+			COB_OP(MOD) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 
@@ -724,33 +628,37 @@ bool CCobThread::Tick()
 					PushDataStack(0);
 					ShowError("modulo division by zero");
 				}
-			} break;
+			} COB_NEXT();
 
 
-			case MOVE: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_OP(MOVE) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 				r4 = PopDataStack();
 				r3 = PopDataStack();
 				cobInst->Move(r1, r2, r3, r4);
-			} break;
-			case MOVE_NOW: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			} COB_NEXT();
+			COB_OP(MOVE_NOW) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 				r3 = PopDataStack();
 				cobInst->MoveNow(r1, r2, r3);
-			} break;
-			case TURN_NOW: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			} COB_NEXT();
+			COB_OP(TURN_NOW) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 				r3 = PopDataStack();
 				cobInst->TurnNow(r1, r2, r3);
-			} break;
+			} COB_NEXT();
 
 
-			case WAIT_TURN: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			COB_OP(WAIT_TURN) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 
 				if (cobInst->NeedsWait(CCobInstance::ATurn, r1, r2)) {
 					state = WaitTurn;
@@ -758,10 +666,11 @@ bool CCobThread::Tick()
 					waitAxis = r2;
 					return true;
 				}
-			} break;
-			case WAIT_MOVE: {
-				r1 = GET_LONG_PC();
-				r2 = GET_LONG_PC();
+			} COB_NEXT();
+			COB_OP(WAIT_MOVE) {
+				pc += 3;
+				r1 = ins->args[0];
+				r2 = ins->args[1];
 
 				if (cobInst->NeedsWait(CCobInstance::AMove, r1, r2)) {
 					state = WaitMove;
@@ -769,62 +678,70 @@ bool CCobThread::Tick()
 					waitAxis = r2;
 					return true;
 				}
-			} break;
+			} COB_NEXT();
 
 
-			case SET: {
+			COB_OP(SET) {
+				pc += 1;
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 
 				if ((r1 >= LUA0) && (r1 <= LUA9)) {
 					luaArgs[r1 - LUA0] = r2;
-					break;
+				} else {
+					cobInst->SetUnitVal(r1, r2);
 				}
+			} COB_NEXT();
 
-				cobInst->SetUnitVal(r1, r2);
-			} break;
 
-
-			case ATTACH: {
+			COB_OP(ATTACH) {
+				pc += 1;
 				r3 = PopDataStack();
 				r2 = PopDataStack();
 				r1 = PopDataStack();
 				cobInst->AttachUnit(r2, r1);
-			} break;
-			case DROP: {
+			} COB_NEXT();
+			COB_OP(DROP) {
+				pc += 1;
 				r1 = PopDataStack();
 				cobInst->DropUnit(r1);
-			} break;
+			} COB_NEXT();
 
 			// like bitwise ops, but only on values 1 and 0
-			case LOGICAL_NOT: {
+			COB_OP(LOGICAL_NOT) {
+				pc += 1;
 				r1 = PopDataStack();
 				PushDataStack(int(r1 == 0));
-			} break;
-			case LOGICAL_AND: {
+			} COB_NEXT();
+			COB_OP(LOGICAL_AND) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 				PushDataStack(int(r1 && r2));
-			} break;
-			case LOGICAL_OR: {
+			} COB_NEXT();
+			COB_OP(LOGICAL_OR) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 				PushDataStack(int(r1 || r2));
-			} break;
-			case LOGICAL_XOR: {
+			} COB_NEXT();
+			COB_OP(LOGICAL_XOR) {
+				pc += 1;
 				r1 = PopDataStack();
 				r2 = PopDataStack();
 				PushDataStack(int((!!r1) ^ (!!r2)));
-			} break;
+			} COB_NEXT();
 
 
-			case HIDE: {
-				r1 = GET_LONG_PC();
+			COB_OP(HIDE) {
+				pc += 2;
+				r1 = ins->args[0];
 				cobInst->SetVisibility(r1, false);
-			} break;
+			} COB_NEXT();
 
-			case SHOW: {
-				r1 = GET_LONG_PC();
+			COB_OP(SHOW) {
+				pc += 2;
+				r1 = ins->args[0];
 
 				int i;
 				for (i = 0; i < MAX_WEAPONS_PER_UNIT; ++i)
@@ -837,28 +754,33 @@ bool CCobThread::Tick()
 				} else {
 					cobInst->SetVisibility(r1, true);
 				}
-			} break;
+			} COB_NEXT();
+
+			COB_OP(TRUNCATED) {
+				// operands run past the end of the code, the original fetch threw here
+				throw std::out_of_range("[COBThread::Tick] operand fetch out of range");
+			}
+			COB_OP(UNKNOWN) {
+				pc += 1;
 
-			default: {
 				const char* name = cobFile->name.c_str();
 				const char* func = cobFile->scriptNames[LocalFunctionID()].c_str();
 
-				LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, opcode, name, func, pc - 1);
-
-				#if 0
-				auto ei = execTrace.begin();
-				while (ei != execTrace.end()) {
-					LOG_L(L_ERROR, "\tprogctr: %3x  opcode: %s", __func__, *ei, GetOpcodeName(cobFile->code[*ei]));
-					++ei;
-				}
-				#endif
+				LOG_L(L_ERROR, "[COBThread::%s] unknown opcode %x (in %s:%s at %x)", __func__, ins->args[0], name, func, pc - 1);
 
 				state = Dead;
 				return false;
-			} break;
+			}
 		}
 	}
 
+#if (COB_COMPUTED_GOTO == 1)
+exit:
+#endif
+
+	#undef COB_NEXT
+	#undef COB_OP
+
 	// can arrive here as dead, through CCobInstance::Signal()
 	return (state != Dead);
 }
@@ -880,10 +802,9 @@ void CCobThread::ShowError(const char* msg)
 }
 
 
-void CCobThread::LuaCall()
+void CCobThread::LuaCall(int r1, int r2)
 {
-	const int r1 = GET_LONG_PC(); // script id
-	const int r2 = GET_LONG_PC(); // arg count
+	// r1 is the script id, r2 the arg count
 
 	// setup the parameter array
 	const int size = dataStackSize;
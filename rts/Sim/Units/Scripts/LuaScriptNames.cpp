@@ -48,6 +48,9 @@ void CLuaUnitScriptNames::InitScriptNames()
 	scriptNames[LUAFN_MoveFinished] = "MoveFinished";
 	scriptNames[LUAFN_TurnFinished] = "TurnFinished";
 
+	scriptNames[LUAFN_AnimEvent]        = "AnimEvent";
+	scriptNames[LUAFN_AnimClipFinished] = "AnimClipFinished";
+
 	// Also add the weapon aiming stuff
 	scriptNames[LUAFN_QueryWeapon]   = "QueryWeapon";
 	scriptNames[LUAFN_AimWeapon]     = "AimWeapon";
@@ -43,6 +43,8 @@ enum {
 	LUAFN_QueryBuildInfo,       // ( ) -> number piece
 	LUAFN_MoveFinished,         // ( piece, axis ) -> nil
 	LUAFN_TurnFinished,         // ( piece, axis ) -> nil
+	LUAFN_AnimEvent,            // ( clipID, eventNum ) -> nil
+	LUAFN_AnimClipFinished,     // ( clipID ) -> nil
 
 	// Weapon functions
 	LUAFN_QueryWeapon,   // ( ) -> number piece
@@ -17,6 +17,7 @@
 #include "Lua/LuaRules.h"
 #include "Lua/LuaUtils.h"
 #include "Sim/Projectiles/ExplosionGenerator.h"
+#include "UnitScriptEngine.h"
 #include "Sim/Units/UnitHandler.h"
 #include "Sim/Units/Unit.h"
 #include "Sim/Weapons/PlasmaRepulser.h"
@@ -130,6 +131,7 @@ callIn notes:
 - AimWeapon for a shield (plasma repulser) takes no arguments instead of 0,0
 - Shot takes no arguments instead of 0
 - new callins MoveFinished and TurnFinished, see below
+- new callins AnimEvent and AnimClipFinished, see below
 
 
 docs for callins defined in this file:
@@ -146,6 +148,13 @@ MoveFinished(number piece, number axis)
 	Should resume coroutine of the particular thread which called the Lua
 	WaitForMove function (see below).
 
+AnimEvent(number clipID, number eventNum)
+	Called when a clip playing for this unit passes the eventNum'th time
+	of its events list (see CreateAnimClip below).
+
+AnimClipFinished(number clipID)
+	Called after a non-looping clip played for this unit reached its end.
+
 
 docs for callouts defined in this file:
 
@@ -198,6 +207,33 @@ Spring.UnitScript.WaitForMove(number piece, number axis) -> boolean
 	Returns true iff such an animation exists, false otherwise.  Iff it returns
 	true, the MoveFinished callIn will be called once the move completes.
 
+Spring.UnitScript.CreateAnimClip(table clip) -> number clipID
+	Uploads a keyframe animation which any unit script can then play without
+	further calls into Lua; the engine interpolates linearly between keys.
+	clip = {
+		tracks = {
+			{piece = number, axis = number, type = "turn" | "move", keys = {time1, value1, time2, value2, ...}},
+			...
+		},
+		length = number, -- seconds, defaults to the time of the last key
+		events = {time1, time2, ...}, -- optional, see the AnimEvent callin
+	}
+	Key times are in seconds and must be ascending, values are the same as
+	the destinations of Turn and Move.
+
+Spring.UnitScript.PlayAnimClip(number clipID[, number speed = 1[, boolean loop = true[, number blendTime = 0]]]) -> boolean
+	(Re)starts a clip; during the first blendTime seconds the pieces fade from
+	their current pose into it. Its tracks replace any turn, spin or move on
+	the same piece and axis. Events at time 0 only fire after looping around.
+
+Spring.UnitScript.StopAnimClip(number clipID) -> boolean
+	Stops a clip; pieces keep their current pose.
+
+Spring.UnitScript.SetAnimClipSpeed(number clipID, number speed) -> boolean
+	Changes the playback rate of a clip, e.g. to match the unit's speed.
+
+Spring.UnitScript.IsPlayingAnimClip(number clipID) -> boolean
+
 Spring.UnitScript.SetDeathScriptFinished(number wreckLevel])
 	Tells Spring the Killed script finished, and which wreckLevel to use.
 	If wreckLevel is not given no wreck is created.
@@ -867,6 +903,15 @@ void CLuaUnitScript::AnimFinished(AnimType type, int piece, int axis)
 	Call((type == AMove)? LUAFN_MoveFinished : LUAFN_TurnFinished, piece + 1, axis + 1);
 }
 
+void CLuaUnitScript::AnimClipEvent(int clipID, int eventNum)
+{
+	if (eventNum < 0) {
+		Call(LUAFN_AnimClipFinished, clipID + 1);
+	} else {
+		Call(LUAFN_AnimEvent, clipID + 1, eventNum + 1);
+	}
+}
+
 
 void CLuaUnitScript::RawCall(int functionId)
 {
@@ -978,6 +1023,12 @@ bool CLuaUnitScript::PushEntries(lua_State* L)
 	REGISTER_LUA_CFUNC(WaitForTurn);
 	REGISTER_LUA_CFUNC(WaitForMove);
 
+	REGISTER_LUA_CFUNC(CreateAnimClip);
+	REGISTER_LUA_CFUNC(PlayAnimClip);
+	REGISTER_LUA_CFUNC(StopAnimClip);
+	REGISTER_LUA_CFUNC(SetAnimClipSpeed);
+	REGISTER_LUA_CFUNC(IsPlayingAnimClip);
+
 	REGISTER_LUA_CFUNC(SetDeathScriptFinished);
 
 	REGISTER_LUA_CFUNC(GetPieceTranslation);
@@ -1450,6 +1501,165 @@ int CLuaUnitScript::WaitForMove(lua_State* L)
 }
 
 
+static void ParseAnimTrack(lua_State* L, int index, int trackNum, UnitScriptAnimTrack& track)
+{
+	lua_getfield(L, index, "piece");
+	lua_getfield(L, index, "axis");
+	lua_getfield(L, index, "type");
+
+	if (!lua_israwnumber(L, -3))
+		luaL_error(L, "CreateAnimClip(): track %d has no piece", trackNum);
+	if (!lua_israwnumber(L, -2) || (lua_toint(L, -2) < 1) || (lua_toint(L, -2) > 3))
+		luaL_error(L, "CreateAnimClip(): track %d has a bad axis", trackNum);
+	if (!lua_israwstring(L, -1))
+		luaL_error(L, "CreateAnimClip(): track %d has no type", trackNum);
+
+	const std::string type = lua_tostring(L, -1);
+
+	track.piece = lua_toint(L, -3) - 1;
+	track.axis = lua_toint(L, -2) - 1;
+
+	if (type == "turn") {
+		track.type = CUnitScript::ATurn;
+	} else if (type == "move") {
+		track.type = CUnitScript::AMove;
+	} else {
+		luaL_error(L, "CreateAnimClip(): track %d has a bad type \"%s\"", trackNum, type.c_str());
+	}
+
+	lua_pop(L, 3);
+	lua_getfield(L, index, "keys");
+
+	if (!lua_istable(L, -1))
+		luaL_error(L, "CreateAnimClip(): track %d has no keys", trackNum);
+
+	const int numValues = lua_objlen(L, -1);
+
+	if (numValues < 2 || (numValues & 1) != 0)
+		luaL_error(L, "CreateAnimClip(): track %d needs {time, value} pairs of keys", trackNum);
+
+	track.times.reserve(numValues / 2);
+	track.values.reserve(numValues / 2);
+
+	for (int i = 1; i <= numValues; i += 2) {
+		lua_rawgeti(L, -1, i    );
+		lua_rawgeti(L, -2, i + 1);
+
+		if (!lua_israwnumber(L, -2) || !lua_israwnumber(L, -1))
+			luaL_error(L, "CreateAnimClip(): track %d has a non-numeric key", trackNum);
+
+		const float time = lua_tofloat(L, -2);
+
+		if (time < 0.0f || (!track.times.empty() && time <= track.times.back()))
+			luaL_error(L, "CreateAnimClip(): track %d key times are not ascending", trackNum);
+
+		track.times.push_back(time);
+		track.values.push_back(lua_tofloat(L, -1));
+
+		lua_pop(L, 2);
+	}
+
+	lua_pop(L, 1);
+}
+
+int CLuaUnitScript::CreateAnimClip(lua_State* L)
+{
+	luaL_checktype(L, 1, LUA_TTABLE);
+
+	UnitScriptAnimClip clip;
+	clip.length = 0.0f;
+
+	lua_getfield(L, 1, "tracks");
+
+	if (!lua_istable(L, -1))
+		luaL_error(L, "%s(): clip has no tracks", __func__);
+
+	clip.tracks.resize(lua_objlen(L, -1));
+
+	for (size_t i = 0; i < clip.tracks.size(); i++) {
+		lua_rawgeti(L, -1, i + 1);
+
+		if (!lua_istable(L, -1))
+			luaL_error(L, "%s(): track %d is not a table", __func__, int(i + 1));
+
+		ParseAnimTrack(L, lua_gettop(L), i + 1, clip.tracks[i]);
+		clip.length = std::max(clip.length, clip.tracks[i].times.back());
+
+		lua_pop(L, 1);
+	}
+
+	lua_pop(L, 1);
+	lua_getfield(L, 1, "length");
+
+	if (lua_israwnumber(L, -1))
+		clip.length = std::max(lua_tofloat(L, -1), 0.0f);
+
+	lua_pop(L, 1);
+	lua_getfield(L, 1, "events");
+
+	if (lua_istable(L, -1)) {
+		for (int i = 1, n = lua_objlen(L, -1); i <= n; i++) {
+			lua_rawgeti(L, -1, i);
+
+			if (!lua_israwnumber(L, -1))
+				luaL_error(L, "%s(): event %d has no time", __func__, i);
+
+			clip.events.push_back(std::min(std::max(lua_tofloat(L, -1), 0.0f), clip.length));
+			lua_pop(L, 1);
+		}
+	}
+
+	lua_pop(L, 1);
+	lua_pushnumber(L, unitScriptEngine->AddAnimClip(clip) + 1);
+	return 1;
+}
+
+
+int CLuaUnitScript::PlayAnimClip(lua_State* L)
+{
+	if (activeScript == nullptr)
+		return 0;
+
+	const int clipID = luaL_checkint(L, 1) - 1;
+	const float speed = luaL_optfloat(L, 2, 1.0f);
+	const bool loop = luaL_optboolean(L, 3, true);
+	const float blendTime = luaL_optfloat(L, 4, 0.0f);
+
+	lua_pushboolean(L, activeScript->PlayAnimClip(clipID, speed, blendTime, loop));
+	return 1;
+}
+
+
+int CLuaUnitScript::StopAnimClip(lua_State* L)
+{
+	if (activeScript == nullptr)
+		return 0;
+
+	lua_pushboolean(L, activeScript->StopAnimClip(luaL_checkint(L, 1) - 1));
+	return 1;
+}
+
+
+int CLuaUnitScript::SetAnimClipSpeed(lua_State* L)
+{
+	if (activeScript == nullptr)
+		return 0;
+
+	lua_pushboolean(L, activeScript->SetAnimClipSpeed(luaL_checkint(L, 1) - 1, luaL_checkfloat(L, 2)));
+	return 1;
+}
+
+
+int CLuaUnitScript::IsPlayingAnimClip(lua_State* L)
+{
+	if (activeScript == nullptr)
+		return 0;
+
+	lua_pushboolean(L, activeScript->IsPlayingAnimClip(luaL_checkint(L, 1) - 1));
+	return 1;
+}
+
+
 int CLuaUnitScript::SetDeathScriptFinished(lua_State* L)
 {
 	if (activeUnit == nullptr || activeScript == nullptr)
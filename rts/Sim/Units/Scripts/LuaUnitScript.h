@@ -134,6 +134,7 @@ public:
 
 	// special callin to allow Lua to resume threads blocking on this anim
 	void AnimFinished(AnimType type, int piece, int axis) override;
+	void AnimClipEvent(int clipID, int eventNum) override;
 
 public:
 	static void HandleFreed(CLuaHandle* handle);
@@ -173,6 +174,13 @@ private:
 	static int WaitForTurn(lua_State* L);
 	static int WaitForMove(lua_State* L);
 
+	// natively played keyframe animations
+	static int CreateAnimClip(lua_State* L);
+	static int PlayAnimClip(lua_State* L);
+	static int StopAnimClip(lua_State* L);
+	static int SetAnimClipSpeed(lua_State* L);
+	static int IsPlayingAnimClip(lua_State* L);
+
 	// Lua COB function to work around lack of working CBCobThreadFinish
 	static int SetDeathScriptFinished(lua_State* L);
 
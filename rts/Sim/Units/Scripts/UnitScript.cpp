@@ -53,6 +53,11 @@ CR_REG_METADATA(CUnitScript, (
 	CR_MEMBER(unit),
 	CR_MEMBER(busy),
 	CR_MEMBER(anims),
+	CR_MEMBER(animClips),
+
+	// always empty when saving
+	CR_IGNORED(doneAnims),
+	CR_IGNORED(clipEvents),
 
 	//Populated by children
 	CR_IGNORED(pieces),
@@ -73,6 +78,18 @@ CR_REG_METADATA_SUB(CUnitScript, AnimInfo,(
 	CR_MEMBER(hasWaiting)
 ))
 
+CR_BIND(CUnitScript::AnimClipState,)
+
+CR_REG_METADATA_SUB(CUnitScript, AnimClipState,(
+	CR_MEMBER(clipID),
+	CR_MEMBER(time),
+	CR_MEMBER(speed),
+	CR_MEMBER(blendTime),
+	CR_MEMBER(blendElapsed),
+	CR_MEMBER(loop),
+	CR_MEMBER(blendValues)
+))
+
 
 CUnitScript::CUnitScript(CUnit* unit)
 	: unit(unit)
@@ -173,51 +190,113 @@ bool CUnitScript::DoSpin(float& cur, float dest, float& speed, float accel, int
 
 
 
-void CUnitScript::TickAnims(int tickRate, const TickAnimFunc& tickAnimFunc, AnimContainerType& liveAnims, AnimContainerType& doneAnims) {
-	for (size_t i = 0; i < liveAnims.size(); ) {
+void CUnitScript::TickAnimBatch(
+	int animType,
+	int tickRate,
+	int count,
+	float* curValues,
+	const float* destValues,
+	float* speeds,
+	const float* accels,
+	std::uint8_t* finished
+) {
+	// flat loops over independent elements, no per-anim indirection
+	switch (animType) {
+		case ATurn: {
+			for (int i = 0; i < count; i++) {
+				finished[i] = TurnToward(curValues[i], destValues[i], speeds[i] / tickRate);
+			}
+		} break;
+		case ASpin: {
+			for (int i = 0; i < count; i++) {
+				finished[i] = DoSpin(curValues[i], destValues[i], speeds[i], accels[i], tickRate);
+			}
+		} break;
+		case AMove: {
+			for (int i = 0; i < count; i++) {
+				finished[i] = MoveToward(curValues[i], destValues[i], speeds[i] / tickRate);
+			}
+		} break;
+		default: {
+			assert(false);
+		} break;
+	}
+}
+
+void CUnitScript::GatherAnims(int animType, float* curValues, float* destValues, float* speeds, float* accels) const
+{
+	const AnimContainerType& liveAnims = anims[animType];
+
+	for (size_t i = 0, n = liveAnims.size(); i < n; i++) {
+		const AnimInfo& ai = liveAnims[i];
+		const LocalModelPiece& lmp = *pieces[ai.piece];
+
+		curValues[i] = (animType == AMove)? lmp.GetPosition()[ai.axis]: lmp.GetRotation()[ai.axis];
+		destValues[i] = ai.dest;
+		speeds[i] = ai.speed;
+		accels[i] = ai.accel;
+	}
+}
+
+void CUnitScript::ScatterAnims(int animType, const float* curValues, const float* speeds, const std::uint8_t* finished)
+{
+	AnimContainerType& liveAnims = anims[animType];
+
+	for (size_t i = 0, n = liveAnims.size(); i < n; i++) {
 		AnimInfo& ai = liveAnims[i];
 		LocalModelPiece& lmp = *pieces[ai.piece];
 
-		if ((ai.done |= (this->*tickAnimFunc)(tickRate, lmp, ai))) {
-			if (ai.hasWaiting)
-				doneAnims.push_back(ai);
+		// note: must copy-and-set here (LMP dirty flag, etc)
+		if (animType == AMove) {
+			float3 pos = lmp.GetPosition();
+			pos[ai.axis] = curValues[i];
+			lmp.SetPosition(pos);
+		} else {
+			float3 rot = lmp.GetRotation();
+			rot[ai.axis] = curValues[i];
+			lmp.SetRotation(rot);
+		}
+
+		// only spins change their speed
+		ai.speed = speeds[i];
+		ai.done |= (finished[i] != 0);
+	}
 
-			ai = liveAnims.back();
-			liveAnims.pop_back();
+	// same removal order as when each anim was ticked and removed in turn
+	for (size_t i = 0; i < liveAnims.size(); ) {
+		AnimInfo& ai = liveAnims[i];
+
+		if (!ai.done) {
+			++i;
 			continue;
 		}
 
-		++i;
+		if (ai.hasWaiting)
+			doneAnims[animType].push_back(ai);
+
+		ai = liveAnims.back();
+		liveAnims.pop_back();
 	}
 }
 
-/**
- * @brief Called by the engine when we are registered as animating.
-          If we return false there are no active animations left.
- * @param deltaTime int delta time to update
- * @return true if there are still active animations
- */
-bool CUnitScript::Tick(int deltaTime)
+bool CUnitScript::DispatchAnimEvents()
 {
-	// vector of indexes of finished animations,
-	// so we can get rid of them in constant time
-	static AnimContainerType doneAnims[AMove + 1];
-	// tick-functions; these never change address
-	static constexpr TickAnimFunc tickAnimFuncs[AMove + 1] = {&CUnitScript::TickTurnAnim, &CUnitScript::TickSpinAnim, &CUnitScript::TickMoveAnim};
-
-	for (int animType = ATurn; animType <= AMove; animType++) {
-		TickAnims(1000 / deltaTime, tickAnimFuncs[animType], anims[animType], doneAnims[animType]);
-	}
-
 	// Tell listeners to unblock, and remove finished animations from the unit/script.
 	for (int animType = ATurn; animType <= AMove; animType++) {
-		for (AnimInfo& ai: doneAnims[animType]) {
+		for (const AnimInfo& ai: doneAnims[animType]) {
 			AnimFinished((AnimType) animType, ai.piece, ai.axis);
 		}
 
 		doneAnims[animType].clear();
 	}
 
+	// AnimClipEvent might start or stop clips, but not recurse into the engine's Tick
+	for (const int2& clipEvent: clipEvents) {
+		AnimClipEvent(clipEvent.x, clipEvent.y);
+	}
+
+	clipEvents.clear();
+
 	return (HaveAnimations());
 }
 
@@ -419,6 +498,198 @@ void CUnitScript::TurnNow(int piece, int axis, float destination)
 }
 
 
+/******************************************************************************/
+
+std::vector<CUnitScript::AnimClipState>::iterator CUnitScript::FindAnimClip(int clipID)
+{
+	const auto pred = [&](const AnimClipState& acs) { return (acs.clipID == clipID); };
+	const auto iter = std::find_if(animClips.begin(), animClips.end(), pred);
+	return iter;
+}
+
+
+bool CUnitScript::PlayAnimClip(int clipID, float speed, float blendTime, bool loop)
+{
+	const UnitScriptAnimClip* clip = unitScriptEngine->GetAnimClip(clipID);
+
+	if (clip == nullptr)
+		return false;
+
+	for (const UnitScriptAnimTrack& track: clip->tracks) {
+		if (!PieceExists(track.piece)) {
+			ShowUnitScriptError("[US::PlayAnimClip] invalid script piece index");
+			return false;
+		}
+	}
+
+	// the clip owns its channels from now on; note that
+	// RemoveAnim might call back into the script first
+	for (const UnitScriptAnimTrack& track: clip->tracks) {
+		if (track.type == AMove) {
+			RemoveAnim(AMove, FindAnim(AMove, track.piece, track.axis));
+		} else {
+			RemoveAnim(ATurn, FindAnim(ATurn, track.piece, track.axis));
+			RemoveAnim(ASpin, FindAnim(ASpin, track.piece, track.axis));
+		}
+	}
+
+	auto clipStateIt = FindAnimClip(clipID);
+
+	if (clipStateIt == animClips.end()) {
+		if (!HaveAnimations())
+			unitScriptEngine->AddInstance(this);
+
+		animClips.emplace_back();
+		clipStateIt = animClips.end() - 1;
+	}
+
+	AnimClipState& acs = *clipStateIt;
+
+	acs.clipID = clipID;
+	acs.time = 0.0f;
+	acs.speed = std::max(speed, 0.0f);
+	acs.blendTime = std::max(blendTime, 0.0f);
+	acs.blendElapsed = 0.0f;
+	acs.loop = loop;
+	acs.blendValues.clear();
+	acs.blendValues.reserve(clip->tracks.size());
+
+	for (const UnitScriptAnimTrack& track: clip->tracks) {
+		const LocalModelPiece* lmp = pieces[track.piece];
+
+		if (track.type == AMove) {
+			acs.blendValues.push_back(lmp->GetPosition()[track.axis]);
+		} else {
+			acs.blendValues.push_back(lmp->GetRotation()[track.axis]);
+		}
+	}
+
+	return true;
+}
+
+
+bool CUnitScript::StopAnimClip(int clipID)
+{
+	const auto clipStateIt = FindAnimClip(clipID);
+
+	if (clipStateIt == animClips.end())
+		return false;
+
+	// pieces keep their current pose
+	*clipStateIt = animClips.back();
+	animClips.pop_back();
+
+	if (!HaveAnimations())
+		unitScriptEngine->RemoveInstance(this);
+
+	return true;
+}
+
+
+bool CUnitScript::SetAnimClipSpeed(int clipID, float speed)
+{
+	const auto clipStateIt = FindAnimClip(clipID);
+
+	if (clipStateIt == animClips.end())
+		return false;
+
+	clipStateIt->speed = std::max(speed, 0.0f);
+	return true;
+}
+
+
+void CUnitScript::ApplyAnimTrack(const UnitScriptAnimTrack& track, float time, float blendValue, float blendWeight)
+{
+	LocalModelPiece& lmp = *pieces[track.piece];
+
+	const float value = track.Sample(time);
+
+	if (track.type == AMove) {
+		float3 pos = lmp.GetPosition();
+		pos[track.axis] = mix(blendValue, lmp.original->offset[track.axis] + value, blendWeight);
+		lmp.SetPosition(pos);
+		return;
+	}
+
+	float3 rot = lmp.GetRotation();
+
+	if (blendWeight >= 1.0f) {
+		rot[track.axis] = ClampRad(value);
+	} else {
+		// blend in along the shorter arc, as TurnToward does
+		float delta = ClampRad(value) - blendValue;
+
+		if (delta > math::PI) {
+			delta -= math::TWOPI;
+		} else if (delta <= -math::PI) {
+			delta += math::TWOPI;
+		}
+
+		rot[track.axis] = ClampRad(blendValue + delta * blendWeight);
+	}
+
+	lmp.SetRotation(rot);
+}
+
+
+void CUnitScript::TickAnimClips(int deltaTime)
+{
+	const float deltaSecs = deltaTime * 0.001f;
+
+	for (size_t i = 0; i < animClips.size(); ) {
+		AnimClipState& acs = animClips[i];
+
+		const UnitScriptAnimClip* clip = unitScriptEngine->GetAnimClip(acs.clipID);
+		const float prevTime = acs.time;
+
+		bool finished = false;
+
+		acs.time += (deltaSecs * acs.speed);
+		acs.blendElapsed += deltaSecs;
+
+		if (acs.time >= clip->length) {
+			if (acs.loop && clip->length > 0.0f) {
+				acs.time = math::fmod(acs.time, clip->length);
+			} else {
+				acs.time = clip->length;
+				finished = true;
+			}
+		}
+
+		// events at or before the previous time fire again only after wrapping around
+		for (size_t j = 0; j < clip->events.size(); j++) {
+			const float eventTime = clip->events[j];
+
+			if (acs.time >= prevTime) {
+				if (eventTime <= prevTime || eventTime > acs.time)
+					continue;
+			} else {
+				if (eventTime <= prevTime && eventTime > acs.time)
+					continue;
+			}
+
+			clipEvents.emplace_back(acs.clipID, j);
+		}
+
+		const float blendWeight = (acs.blendElapsed < acs.blendTime)? (acs.blendElapsed / acs.blendTime): 1.0f;
+
+		for (size_t j = 0; j < clip->tracks.size(); j++) {
+			ApplyAnimTrack(clip->tracks[j], acs.time, acs.blendValues[j], blendWeight);
+		}
+
+		if (finished) {
+			clipEvents.emplace_back(acs.clipID, -1);
+
+			acs = animClips.back();
+			animClips.pop_back();
+			continue;
+		}
+
+		++i;
+	}
+}
+
+
 void CUnitScript::SetVisibility(int piece, bool visible)
 {
 	if (!PieceExists(piece)) {
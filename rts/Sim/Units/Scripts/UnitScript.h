@@ -5,6 +5,7 @@
 #ifndef UNIT_SCRIPT_H
 #define UNIT_SCRIPT_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 
@@ -14,11 +15,13 @@
 
 class CUnit;
 class CPlasmaRepulser;
+struct UnitScriptAnimTrack;
 
 class CUnitScript
 {
 	CR_DECLARE(CUnitScript)
 	CR_DECLARE_SUB(AnimInfo)
+	CR_DECLARE_SUB(AnimClipState)
 public:
 	enum AnimType {ANone = -1, ATurn = 0, ASpin = 1, AMove = 2};
 
@@ -40,23 +43,42 @@ protected:
 	typedef std::vector<AnimInfo> AnimContainerType;
 	typedef AnimContainerType::iterator AnimContainerTypeIt;
 
-	typedef bool(CUnitScript::*TickAnimFunc)(int, LocalModelPiece&, AnimInfo&);
-
 	AnimContainerType anims[AMove + 1];
+	// finished anims with waiting threads and {clipID, eventNum} pairs,
+	// filled by ScatterAnims and TickAnimClips, sent by DispatchAnimEvents
+	AnimContainerType doneAnims[AMove + 1];
+	std::vector<int2> clipEvents;
+
+	struct AnimClipState {
+		CR_DECLARE_STRUCT(AnimClipState)
+		int clipID;
+		float time;
+		float speed;
+		float blendTime;    // seconds over which the clip fades in from blendValues
+		float blendElapsed;
+		bool loop;
+		std::vector<float> blendValues; // per track, piece position or rotation when playback began
+	};
+
+	std::vector<AnimClipState> animClips;
 
 
 	bool hasSetSFXOccupy;
 	bool hasRockUnit;
 	bool hasStartBuilding;
 
-	bool MoveToward(float& cur, float dest, float speed);
-	bool TurnToward(float& cur, float dest, float speed);
-	bool DoSpin(float& cur, float dest, float& speed, float accel, int divisor);
+	static bool MoveToward(float& cur, float dest, float speed);
+	static bool TurnToward(float& cur, float dest, float speed);
+	static bool DoSpin(float& cur, float dest, float& speed, float accel, int divisor);
 
 	AnimContainerTypeIt FindAnim(AnimType type, int piece, int axis);
 	void RemoveAnim(AnimType type, const AnimContainerTypeIt& animInfoIt);
 	void AddAnim(AnimType type, int piece, int axis, float speed, float dest, float accel);
 
+	std::vector<AnimClipState>::iterator FindAnimClip(int clipID);
+	void ApplyAnimTrack(const UnitScriptAnimTrack& track, float time, float blendValue, float blendWeight);
+
+
 	virtual void ShowScriptError(const std::string& msg) = 0;
 
 	void ShowUnitScriptError(const std::string& msg);
@@ -106,12 +128,18 @@ public:
 	      CUnit* GetUnit()       { return unit; }
 	const CUnit* GetUnit() const { return unit; }
 
-	bool Tick(int tickRate);
-	// note: must copy-and-set here (LMP dirty flag, etc)
-	bool TickMoveAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 pos = lmp.GetPosition(); const bool ret = MoveToward(pos[ai.axis], ai.dest, ai.speed / tickRate); lmp.SetPosition(pos); return ret; }
-	bool TickTurnAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 rot = lmp.GetRotation(); const bool ret = TurnToward(rot[ai.axis], ai.dest, ai.speed / tickRate); lmp.SetRotation(rot); return ret; }
-	bool TickSpinAnim(int tickRate, LocalModelPiece& lmp, AnimInfo& ai) { float3 rot = lmp.GetRotation(); const bool ret = DoSpin(rot[ai.axis], ai.dest, ai.speed, ai.accel, tickRate); lmp.SetRotation(rot); return ret; }
-	void TickAnims(int tickRate, const TickAnimFunc& tickAnimFunc, AnimContainerType& liveAnims, AnimContainerType& doneAnims);
+	// piece animations are ticked by CUnitScriptEngine for all scripts at
+	// once: it gathers them into per-type arrays, advances those with
+	// TickAnimBatch and scatters the results back, none of which calls
+	// into the script; finished-events are sent afterwards
+	size_t GetNumAnims(int animType) const { return anims[animType].size(); }
+	void GatherAnims(int animType, float* curValues, float* destValues, float* speeds, float* accels) const;
+	void ScatterAnims(int animType, const float* curValues, const float* speeds, const std::uint8_t* finished);
+	void TickAnimClips(int deltaTime);
+	/// returns true if there are still active animations
+	bool DispatchAnimEvents();
+
+	static void TickAnimBatch(int animType, int tickRate, int count, float* curValues, const float* destValues, float* speeds, const float* accels, std::uint8_t* finished);
 
 	// animation, used by CCobThread
 	void Spin(int piece, int axis, float speed, float accel);
@@ -123,6 +151,13 @@ public:
 
 	bool NeedsWait(AnimType type, int piece, int axis);
 
+	// keyframe clips (see CUnitScriptEngine::AddAnimClip), played natively;
+	// their tracks take over from any Turn, Spin or Move on the same piece-axes
+	bool PlayAnimClip(int clipID, float speed, float blendTime, bool loop);
+	bool StopAnimClip(int clipID);
+	bool SetAnimClipSpeed(int clipID, float speed);
+	bool IsPlayingAnimClip(int clipID) { return (FindAnimClip(clipID) != animClips.end()); }
+
 	// misc, used by CCobThread and callouts for Lua unitscripts
 	void SetVisibility(int piece, bool visible);
 
@@ -142,7 +177,7 @@ public:
 		return (FindAnim(type, piece, axis) != anims[type].end());
 	}
 	bool HaveAnimations() const {
-		return (!anims[ATurn].empty() || !anims[ASpin].empty() || !anims[AMove].empty());
+		return (!anims[ATurn].empty() || !anims[ASpin].empty() || !anims[AMove].empty() || !animClips.empty());
 	}
 
 	// checks for callin existence
@@ -204,6 +239,8 @@ public:
 	virtual bool  BlockShot(int weaponNum, const CUnit* targetUnit, bool userTarget) = 0; // returns whether shot should be blocked
 	virtual float TargetWeight(int weaponNum, const CUnit* targetUnit) = 0; // returns target weight
 	virtual void AnimFinished(AnimType type, int piece, int axis) = 0;
+	// eventNum indexes UnitScriptAnimClip::events, or is -1 when a non-looping clip ended
+	virtual void AnimClipEvent(int clipID, int eventNum) {}
 };
 
 #endif // UNIT_SCRIPT_H
@@ -13,6 +13,10 @@
 #include "Sim/Units/UnitHandler.h"
 #include "System/ContainerUtil.h"
 #include "System/SafeUtil.h"
+#include "System/SpringMath.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
 
 static CCobEngine gCobEngine;
 static CCobFileHandler gCobFileHandler;
@@ -27,11 +31,47 @@ CR_BIND(CUnitScriptEngine, )
 
 CR_REG_METADATA(CUnitScriptEngine, (
 	CR_MEMBER(animating),
+	CR_MEMBER(animClips),
 
 	// always null when saving
-	CR_IGNORED(currentScript)
+	CR_IGNORED(currentScript),
+	CR_IGNORED(animBatches)
 ))
 
+CR_BIND(UnitScriptAnimTrack, )
+
+CR_REG_METADATA(UnitScriptAnimTrack, (
+	CR_MEMBER(piece),
+	CR_MEMBER(axis),
+	CR_MEMBER(type),
+	CR_MEMBER(times),
+	CR_MEMBER(values)
+))
+
+CR_BIND(UnitScriptAnimClip, )
+
+CR_REG_METADATA(UnitScriptAnimClip, (
+	CR_MEMBER(length),
+	CR_MEMBER(tracks),
+	CR_MEMBER(events)
+))
+
+
+float UnitScriptAnimTrack::Sample(float time) const
+{
+	const auto iter = std::upper_bound(times.begin(), times.end(), time);
+
+	if (iter == times.begin())
+		return values.front();
+	if (iter == times.end())
+		return values.back();
+
+	const size_t k = iter - times.begin();
+	const float alpha = (time - times[k - 1]) / (times[k] - times[k - 1]);
+
+	return (mix(values[k - 1], values[k], alpha));
+}
+
 
 void CUnitScriptEngine::InitStatic() {
 	cobEngine = &gCobEngine;
@@ -114,15 +154,77 @@ void CUnitScriptEngine::RemoveInstance(CUnitScript* instance)
 }
 
 
+void CUnitScriptEngine::TickAnims(int deltaTime)
+{
+	const int tickRate = 1000 / deltaTime;
+	const int numScripts = animating.size();
+
+	for (int animType = CUnitScript::ATurn; animType <= CUnitScript::AMove; animType++) {
+		AnimBatch& batch = animBatches[animType];
+
+		batch.offsets.resize(numScripts + 1);
+		batch.offsets[0] = 0;
+
+		for (int i = 0; i < numScripts; i++) {
+			batch.offsets[i + 1] = batch.offsets[i] + animating[i]->GetNumAnims(animType);
+		}
+
+		batch.curValues.resize(batch.offsets[numScripts]);
+		batch.destValues.resize(batch.offsets[numScripts]);
+		batch.speeds.resize(batch.offsets[numScripts]);
+		batch.accels.resize(batch.offsets[numScripts]);
+		batch.finished.resize(batch.offsets[numScripts]);
+	}
+
+	// every script only touches its own pieces and anims, and none of
+	// these steps calls back into a script (that waits for Tick below)
+	for_mt_range(0, numScripts, 0, [&](const int lo, const int hi) {
+		for (int i = lo; i < hi; i++) {
+			for (int animType = CUnitScript::ATurn; animType <= CUnitScript::AMove; animType++) {
+				AnimBatch& b = animBatches[animType];
+				const int j = b.offsets[i];
+
+				animating[i]->GatherAnims(animType, b.curValues.data() + j, b.destValues.data() + j, b.speeds.data() + j, b.accels.data() + j);
+			}
+		}
+	});
+
+	for (int animType = CUnitScript::ATurn; animType <= CUnitScript::AMove; animType++) {
+		AnimBatch& b = animBatches[animType];
+
+		for_mt_range(0, b.offsets[numScripts], 0, [&](const int lo, const int hi) {
+			CUnitScript::TickAnimBatch(animType, tickRate, hi - lo, b.curValues.data() + lo, b.destValues.data() + lo, b.speeds.data() + lo, b.accels.data() + lo, b.finished.data() + lo);
+		});
+	}
+
+	for_mt_range(0, numScripts, 0, [&](const int lo, const int hi) {
+		for (int i = lo; i < hi; i++) {
+			for (int animType = CUnitScript::ATurn; animType <= CUnitScript::AMove; animType++) {
+				const AnimBatch& b = animBatches[animType];
+				const int j = b.offsets[i];
+
+				animating[i]->ScatterAnims(animType, b.curValues.data() + j, b.speeds.data() + j, b.finished.data() + j);
+			}
+
+			animating[i]->TickAnimClips(deltaTime);
+		}
+	});
+}
+
 void CUnitScriptEngine::Tick(int deltaTime)
 {
 	cobEngine->Tick(deltaTime);
 
-	// tick all (COB or LUS) script instances that have registered themselves as animating
+	// advance all (COB or LUS) script instances that have registered themselves as animating
+	TickAnims(deltaTime);
+
+	// send their finished-events in list order, scripts can start or stop
+	// animations (also on other units) in response; any that start doing so
+	// here are only advanced next frame
 	for (size_t i = 0; i < animating.size(); ) {
 		currentScript = animating[i];
 
-		if (!currentScript->Tick(deltaTime)) {
+		if (!currentScript->DispatchAnimEvents()) {
 			animating[i] = animating.back();
 			animating.pop_back();
 			continue;
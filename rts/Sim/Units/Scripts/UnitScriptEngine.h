@@ -5,6 +5,7 @@
 #ifndef UNIT_SCRIPT_ENGINE_H
 #define UNIT_SCRIPT_ENGINE_H
 
+#include <cstdint>
 #include <vector>
 
 #include "System/creg/creg_cond.h"
@@ -14,6 +15,32 @@ class CUnit;
 class CUnitScript;
 
 
+// keyframe curve for one axis of one piece, sampled with linear interpolation
+struct UnitScriptAnimTrack {
+	CR_DECLARE_STRUCT(UnitScriptAnimTrack)
+
+	float Sample(float time) const;
+
+	int piece; // script piece index
+	int axis;
+	int type; // CUnitScript::ATurn or CUnitScript::AMove
+
+	// ascending, same size as values
+	std::vector<float> times;
+	std::vector<float> values;
+};
+
+// animation clip shared by all scripts that play it, see CUnitScript::PlayAnimClip
+struct UnitScriptAnimClip {
+	CR_DECLARE_STRUCT(UnitScriptAnimClip)
+
+	float length;
+
+	std::vector<UnitScriptAnimTrack> tracks;
+	std::vector<float> events; // times at which AnimClipEvent is sent
+};
+
+
 class CUnitScriptEngine
 {
 	CR_DECLARE_STRUCT(CUnitScriptEngine)
@@ -25,16 +52,46 @@ public:
 
 	void Tick(int deltaTime);
 
+	int AddAnimClip(const UnitScriptAnimClip& clip) {
+		animClips.push_back(clip);
+		return (animClips.size() - 1);
+	}
+	const UnitScriptAnimClip* GetAnimClip(int clipID) const {
+		if (clipID < 0 || size_t(clipID) >= animClips.size())
+			return nullptr;
+
+		return &animClips[clipID];
+	}
+
 	void Init() { animating.reserve(256); }
-	void Kill() { animating.clear(); }
+	void Kill() { animating.clear(); animClips.clear(); }
 
 	static void InitStatic();
 	static void KillStatic();
 
 private:
+	void TickAnims(int deltaTime);
+
+private:
+	// per anim-type scratch arrays, every animating script's anims of
+	// that type in turn (see CUnitScript::GatherAnims)
+	struct AnimBatch {
+		std::vector<float> curValues;
+		std::vector<float> destValues;
+		std::vector<float> speeds;
+		std::vector<float> accels;
+		std::vector<std::uint8_t> finished;
+
+		// offsets[i] is the index of animating[i]'s first anim
+		std::vector<int> offsets;
+	};
+
+	AnimBatch animBatches[3]; // ATurn, ASpin, AMove
+
 	CUnitScript* currentScript = nullptr;
 
 	std::vector<CUnitScript*> animating;
+	std::vector<UnitScriptAnimClip> animClips;
 };
 
 extern CUnitScriptEngine* unitScriptEngine;
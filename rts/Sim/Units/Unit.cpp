@@ -16,6 +16,8 @@
 #include "CommandAI/FactoryCAI.h"
 #include "CommandAI/AirCAI.h"
 #include "CommandAI/BuilderCAI.h"
+#include "CommandAI/BuilderWorkIndex.h"
+#include "CommandAI/TransportAreaIndex.h"
 #include "CommandAI/CommandAI.h"
 #include "CommandAI/FactoryCAI.h"
 #include "CommandAI/MobileCAI.h"
@@ -40,6 +42,7 @@
 #include "Sim/Features/FeatureHandler.h"
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/CollisionVolume.h"
+#include "Sim/Misc/DrawSnapshot.h"
 #include "Sim/Misc/LosHandler.h"
 #include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
@@ -161,6 +164,7 @@ void CUnit::InitStatic()
 	SetExpGrade(0.0f);
 
 	CBuilderCAI::InitStatic();
+	transportAreaIndex.Init();
 	unitToolTipMap.Clear();
 }
 
@@ -269,6 +273,9 @@ void CUnit::PreInit(const UnitLoadParams& params)
 
 	unitToolTipMap.Set(id, unitDef->humanName + " - " + unitDef->tooltip);
 
+	if (beingBuilt)
+		builderWorkIndex.AddDamagedUnit(this);
+
 
 	// sensor parameters
 	realLosRadius    = Clamp(int(unitDef->losRadius)    , 0, MAX_UNIT_SENSOR_RADIUS);
@@ -983,44 +990,47 @@ void CUnit::SlowUpdate()
 	moveType->SlowUpdate();
 
 
+	// production is accumulated per team and credited once after all units
+	// of this frame were SlowUpdate'd (see CTeam::AddDelayedIncome), usage
+	// depends on the team's current resources and is still applied directly
 	// FIXME: scriptMakeMetal ...?
-	AddMetal(resourcesUncondMake.metal);
-	AddEnergy(resourcesUncondMake.energy);
+	AddDelayedMetal(resourcesUncondMake.metal);
+	AddDelayedEnergy(resourcesUncondMake.energy);
 	UseMetal(resourcesUncondUse.metal);
 	UseEnergy(resourcesUncondUse.energy);
 
 	if (activated) {
 		if (UseMetal(resourcesCondUse.metal))
-			AddEnergy(resourcesCondMake.energy);
+			AddDelayedEnergy(resourcesCondMake.energy);
 
 		if (UseEnergy(resourcesCondUse.energy))
-			AddMetal(resourcesCondMake.metal);
+			AddDelayedMetal(resourcesCondMake.metal);
 
 	}
 
-	AddMetal(unitDef->metalMake * 0.5f);
+	AddDelayedMetal(unitDef->metalMake * 0.5f);
 
 	if (activated) {
 		if (UseEnergy(unitDef->energyUpkeep * 0.5f)) {
-			AddMetal(unitDef->makesMetal * 0.5f);
+			AddDelayedMetal(unitDef->makesMetal * 0.5f);
 
 			if (unitDef->extractsMetal > 0.0f)
-				AddMetal(metalExtract * 0.5f);
+				AddDelayedMetal(metalExtract * 0.5f);
 		}
 
 		UseMetal(unitDef->metalUpkeep * 0.5f);
 
 		if (unitDef->windGenerator > 0.0f) {
 			if (envResHandler.GetCurrentWindStrength() > unitDef->windGenerator) {
- 				AddEnergy(unitDef->windGenerator * 0.5f);
+ 				AddDelayedEnergy(unitDef->windGenerator * 0.5f);
 			} else {
-				AddEnergy(envResHandler.GetCurrentWindStrength() * 0.5f);
+				AddDelayedEnergy(envResHandler.GetCurrentWindStrength() * 0.5f);
 			}
 		}
 	}
 
 	// FIXME: tidal part should be under "if (activated)"?
-	AddEnergy((unitDef->energyMake + unitDef->tidalGenerator * envResHandler.GetCurrentTidalStrength()) * 0.5f);
+	AddDelayedEnergy((unitDef->energyMake + unitDef->tidalGenerator * envResHandler.GetCurrentTidalStrength()) * 0.5f);
 
 
 	if (health < maxHealth) {
@@ -1177,6 +1187,7 @@ void CUnit::ApplyDamage(CUnit* attacker, const DamageArray& damages, float& base
 			AddUnitDamageStats(this, Clamp(maxHealth - health, 0.0f, baseDamage), false);
 
 			health -= baseDamage;
+			builderWorkIndex.AddDamagedUnit(this);
 		} else {
 			// healing
 			health -= baseDamage;
@@ -1338,11 +1349,20 @@ void CUnit::ApplyImpulse(const float3& impulse) {
 
 CMatrix44f CUnit::GetTransformMatrix(bool synced, bool fullread) const
 {
-	float3 interPos = synced ? pos : drawPos;
+	if (synced)
+		return (ComposeMatrix(pos));
 
-	if (!synced && !fullread && !gu->spectatingFullView)
+	float3 interPos = drawPos;
+
+	if (!fullread && !gu->spectatingFullView)
 		interPos += GetErrorVector(gu->myAllyTeam);
 
+	// orientation as of the snapshot drawPos was interpolated from
+	const CDrawSnapshot::UnitState* state = drawSnapshot.GetState(this);
+
+	if (state != nullptr)
+		return (state->ComposeMatrix(interPos));
+
 	return (ComposeMatrix(interPos));
 }
 
@@ -1379,6 +1399,9 @@ void CUnit::AddExperience(float exp)
 	if (expHealthScale > 0.0f) {
 		maxHealth = std::max(0.1f, unitDef->health * (1.0f + (limExperience * expHealthScale)));
 		health *= (maxHealth / oldMaxHealth);
+
+		if (health < maxHealth)
+			builderWorkIndex.AddDamagedUnit(this);
 	}
 }
 
@@ -1499,6 +1522,9 @@ bool CUnit::ChangeTeam(int newteam, ChangeType type)
 	// insert for new allyteam
 	quadField.MovedUnit(this);
 
+	if (health < maxHealth)
+		builderWorkIndex.AddDamagedUnit(this);
+
 	eventHandler.UnitGiven(this, oldteam, newteam);
 	eoh->UnitGiven(*this, oldteam, newteam);
 
@@ -1987,6 +2013,8 @@ bool CUnit::AddBuildPower(CUnit* builder, float amount)
 		health = postHealth;
 		buildProgress = postBuildProgress;
 
+		builderWorkIndex.AddDamagedUnit(this);
+
 		// reclaim finished?
 		if (killMe || buildProgress <= 0.0f || health <= 0.0f) {
 			health = 0.0f;
@@ -2095,6 +2123,29 @@ void CUnit::AddEnergy(float energy, bool useIncomeMultiplier)
 }
 
 
+void CUnit::AddDelayedMetal(float metal)
+{
+	if (metal < 0.0f) {
+		UseMetal(-metal);
+		return;
+	}
+
+	resourcesMakeI.metal += metal;
+	teamHandler.Team(team)->resDelayedIncome.metal += metal;
+}
+
+void CUnit::AddDelayedEnergy(float energy)
+{
+	if (energy < 0.0f) {
+		UseEnergy(-energy);
+		return;
+	}
+
+	resourcesMakeI.energy += energy;
+	teamHandler.Team(team)->resDelayedIncome.energy += energy;
+}
+
+
 bool CUnit::AddHarvestedMetal(float metal)
 {
 	if (harvestStorage.metal <= 0.0f) {
@@ -2804,6 +2855,9 @@ CR_REG_METADATA(CUnit, (
 	CR_MEMBER(weapons),
 	CR_IGNORED(los),
 	CR_MEMBER(losStatus),
+	CR_IGNORED(losCheckSquares),
+	CR_IGNORED(losCheckFlags),
+	CR_IGNORED(losCheckEpoch),
 	CR_MEMBER(posErrorMask),
 	CR_MEMBER(quads),
 
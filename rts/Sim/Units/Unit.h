@@ -109,6 +109,10 @@ public:
 	void AddEnergy(float energy, bool useIncomeMultiplier = true);
 	bool AddHarvestedMetal(float metal);
 
+	/// like AddMetal and AddEnergy, but only credited to the team after the SlowUpdate pass
+	void AddDelayedMetal(float metal);
+	void AddDelayedEnergy(float energy);
+
 	void SetStorage(const SResourcePack& newstorage);
 	bool HaveResources(const SResourcePack& res) const;
 	bool UseResources(const SResourcePack& res);
@@ -311,6 +315,11 @@ public:
 	// indicates the los/radar status each allyteam has on this unit
 	// should technically be MAX_ALLYTEAMS, but #allyteams <= #teams
 	std::array<unsigned char, /*MAX_TEAMS*/ 255> losStatus{{0}};
+	// sensor-map squares, state flags and epoch of the last losStatus update
+	// (see CLosHandler::UnitLosInputsChanged); -1 forces the next update
+	std::array<int, 8> losCheckSquares{{-1}};
+	int losCheckFlags = -1;
+	int losCheckEpoch = -1;
 	// bit-mask indicating which allyteams see this unit with positional error
 	std::array<unsigned  int, /*MAX_TEAMS/32*/ 8> posErrorMask{{1}};
 
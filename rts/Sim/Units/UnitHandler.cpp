@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 
 #include "UnitHandler.h"
@@ -11,14 +12,20 @@
 #include "UnitTypes/Factory.h"
 
 #include "CommandAI/BuilderCAI.h"
+#include "Game/GameHelper.h"
 #include "Sim/Misc/GlobalSynced.h"
+#include "Sim/Misc/LosHandler.h"
+#include "Sim/Misc/ModInfo.h"
+#include "Sim/Misc/QuadField.h"
 #include "Sim/Misc/TeamHandler.h"
 #include "Sim/MoveTypes/MoveType.h"
 #include "Sim/Weapons/Weapon.h"
 #include "System/EventHandler.h"
 #include "System/Log/ILog.h"
 #include "System/SpringMath.h"
+#include "System/MemoryStats.h"
 #include "System/TimeProfiler.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/creg/STL_Deque.h"
 #include "System/creg/STL_Set.h"
 
@@ -34,18 +41,26 @@ CR_REG_METADATA(CUnitHandler, (
 
 	CR_MEMBER(builderCAIs),
 
-	CR_MEMBER(activeSlowUpdateUnit),
+	CR_MEMBER(slowUpdateSlots),
+	CR_MEMBER(slowUpdateSlotCosts),
+
 	CR_MEMBER(activeUpdateUnit),
 
 	CR_MEMBER(maxUnits),
 	CR_MEMBER(maxUnitRadius),
 
-	CR_MEMBER(inUpdateCall)
+	CR_MEMBER(inUpdateCall),
+
+	CR_IGNORED(batchBinPositions),
+	CR_IGNORED(preCollisionsPositions),
+	CR_IGNORED(preCollisionsFrame),
+	CR_IGNORED(preCollisionsMovedUnits)
 ))
 
 
 
 UnitMemPool unitMemPool;
+static MemoryStats::Registrar unitMemPoolStats("Sim::Units::MemPool", []() { return MemoryStats::GetPoolUsage(unitMemPool); });
 
 CUnitHandler unitHandler;
 
@@ -95,11 +110,18 @@ void CUnitHandler::Init() {
 		maxUnitRadius = 0.0f;
 	}
 	{
-		activeSlowUpdateUnit = 0;
 		activeUpdateUnit = 0;
 	}
+	{
+		for (auto& slot: slowUpdateSlots) {
+			slot.clear();
+		}
+
+		slowUpdateSlotCosts.fill(0);
+	}
 	{
 		units.resize(maxUnits, nullptr);
+		preCollisionsPositions.resize(maxUnits);
 		activeUnits.reserve(maxUnits);
 
 		unitMemPool.reserve(128);
@@ -141,6 +163,10 @@ void CUnitHandler::Kill()
 		activeUnits.clear();
 		unitsToBeRemoved.clear();
 
+		for (auto& slot: slowUpdateSlots) {
+			slot.clear();
+		}
+
 		// only iterated by unsynced code, GetBuilderCAIs has no synced callers
 		builderCAIs.clear();
 	}
@@ -181,10 +207,9 @@ void CUnitHandler::InsertActiveUnit(CUnit* unit)
 	assert(insertionPos < activeUnits.size());
 	activeUnits.insert(activeUnits.begin() + insertionPos, unit);
 
-	// do not (slow)update the same unit twice if the new one
-	// gets inserted behind our current iterator position and
+	// do not update the same unit twice if the new one gets
+	// inserted behind our current iterator position and
 	// right-shifts the rest
-	activeSlowUpdateUnit += (insertionPos <= activeSlowUpdateUnit);
 	activeUpdateUnit += (insertionPos <= activeUpdateUnit);
 
 	#else
@@ -192,6 +217,52 @@ void CUnitHandler::InsertActiveUnit(CUnit* unit)
 	#endif
 
 	units[unit->id] = unit;
+
+	InsertSlowUpdateUnit(unit);
+}
+
+
+static int GetSlowUpdateCost(const CUnit* unit)
+{
+	// rough relative costs; must only depend on synced state since
+	// they decide which frame each unit is SlowUpdate'd in
+	const UnitDef* ud = unit->unitDef;
+
+	int cost = 1 + ud->NumWeapons();
+
+	// builder CAI's search their surroundings for work on every SlowUpdate
+	cost += (4 * (ud->IsMobileBuilderUnit() || ud->IsStaticBuilderUnit()));
+	cost += (2 * ud->IsFactoryUnit());
+	return cost;
+}
+
+void CUnitHandler::InsertSlowUpdateUnit(CUnit* unit)
+{
+	// least-loaded slot, ties go to the earliest one
+	const auto it = std::min_element(slowUpdateSlotCosts.begin(), slowUpdateSlotCosts.end());
+	const size_t slot = it - slowUpdateSlotCosts.begin();
+
+	slowUpdateSlots[slot].push_back(unit);
+	slowUpdateSlotCosts[slot] += GetSlowUpdateCost(unit);
+}
+
+void CUnitHandler::EraseSlowUpdateUnit(CUnit* unit)
+{
+	for (size_t slot = 0; slot < slowUpdateSlots.size(); slot++) {
+		std::vector<CUnit*>& slotUnits = slowUpdateSlots[slot];
+
+		const auto it = std::find(slotUnits.begin(), slotUnits.end(), unit);
+
+		if (it == slotUnits.end())
+			continue;
+
+		// keep the (synced) update order within the slot
+		slotUnits.erase(it);
+		slowUpdateSlotCosts[slot] -= GetSlowUpdateCost(unit);
+		return;
+	}
+
+	assert(false);
 }
 
 
@@ -210,6 +281,7 @@ bool CUnitHandler::AddUnit(CUnit* unit)
 	spring::VectorInsertUnique(GetUnitsByTeamAndDef(unit->team, unit->unitDef->id), unit, false);
 
 	maxUnitRadius = std::max(unit->radius, maxUnitRadius);
+
 	return true;
 }
 
@@ -255,12 +327,102 @@ bool CUnitHandler::QueueDeleteUnit(CUnit* unit)
 
 void CUnitHandler::DeleteUnits()
 {
+	if (unitsToBeRemoved.size() > 1) {
+		DeleteUnitBatch();
+		return;
+	}
+
 	while (!unitsToBeRemoved.empty()) {
 		DeleteUnit(unitsToBeRemoved.back());
 		unitsToBeRemoved.pop_back();
 	}
 }
 
+void CUnitHandler::DeleteUnitBatch()
+{
+	// same result as calling DeleteUnit on each (back to front), but every
+	// container is passed over once instead of once per unit: activeUnits
+	// and the SlowUpdate slots are compacted in a single stable pass, and
+	// the swap-and-pop erasures from the team and unitDef bins are replayed
+	// through a per-ID position index instead of searching for each unit
+	std::vector<int>& teamBinPositions = batchBinPositions[0];
+	std::vector<int>&  defBinPositions = batchBinPositions[1];
+
+	std::vector<const std::vector<CUnit*>*> indexedBins;
+
+	teamBinPositions.resize(maxUnits, -1);
+	defBinPositions.resize(maxUnits, -1);
+
+	const auto IndexBin = [&](const std::vector<CUnit*>& bin, std::vector<int>& binPositions) {
+		if (std::find(indexedBins.begin(), indexedBins.end(), &bin) != indexedBins.end())
+			return;
+
+		for (size_t i = 0; i < bin.size(); i++) {
+			binPositions[bin[i]->id] = i;
+		}
+
+		indexedBins.push_back(&bin);
+	};
+	const auto EraseFromBin = [&](std::vector<CUnit*>& bin, std::vector<int>& binPositions, const CUnit* unit) {
+		const int binPos = binPositions[unit->id];
+
+		assert(binPos >= 0 && bin[binPos] == unit);
+
+		bin[binPos] = bin.back();
+		binPositions[bin[binPos]->id] = binPos;
+		bin.pop_back();
+	};
+
+	for (auto it = unitsToBeRemoved.rbegin(); it != unitsToBeRemoved.rend(); ++it) {
+		CUnit* delUnit = *it;
+
+		assert(delUnit->isDead);
+		assert(units[delUnit->id] == delUnit);
+		// we want to call RenderUnitDestroyed while the unit is still valid
+		eventHandler.RenderUnitDestroyed(delUnit);
+
+		const int delUnitTeam = delUnit->team;
+		const int delUnitType = delUnit->unitDef->id;
+
+		teamHandler.Team(delUnitTeam)->RemoveUnit(delUnit, CTeam::RemoveDied);
+
+		std::vector<CUnit*>& teamBin = GetUnitsByTeamAndDef(delUnitTeam,           0);
+		std::vector<CUnit*>&  defBin = GetUnitsByTeamAndDef(delUnitTeam, delUnitType);
+
+		IndexBin(teamBin, teamBinPositions);
+		IndexBin( defBin,  defBinPositions);
+		EraseFromBin(teamBin, teamBinPositions, delUnit);
+		EraseFromBin( defBin,  defBinPositions, delUnit);
+
+		idPool.FreeID(delUnit->id, true);
+
+		// also marks the unit for the compaction passes below
+		units[delUnit->id] = nullptr;
+	}
+
+	const auto IsDeleted = [&](const CUnit* unit) { return (units[unit->id] != unit); };
+
+	activeUnits.erase(std::remove_if(activeUnits.begin(), activeUnits.end(), IsDeleted), activeUnits.end());
+
+	for (size_t slot = 0; slot < slowUpdateSlots.size(); slot++) {
+		std::vector<CUnit*>& slotUnits = slowUpdateSlots[slot];
+
+		for (const CUnit* unit: slotUnits) {
+			slowUpdateSlotCosts[slot] -= (GetSlowUpdateCost(unit) * IsDeleted(unit));
+		}
+
+		slotUnits.erase(std::remove_if(slotUnits.begin(), slotUnits.end(), IsDeleted), slotUnits.end());
+	}
+
+	for (auto it = unitsToBeRemoved.rbegin(); it != unitsToBeRemoved.rend(); ++it) {
+		CSolidObject::SetDeletingRefID((*it)->id);
+		unitMemPool.free(*it);
+		CSolidObject::SetDeletingRefID(-1);
+	}
+
+	unitsToBeRemoved.clear();
+}
+
 void CUnitHandler::DeleteUnit(CUnit* delUnit)
 {
 	assert(delUnit->isDead);
@@ -279,10 +441,8 @@ void CUnitHandler::DeleteUnit(CUnit* delUnit)
 
 	teamHandler.Team(delUnitTeam)->RemoveUnit(delUnit, CTeam::RemoveDied);
 
-	if (activeSlowUpdateUnit > std::distance(activeUnits.begin(), it))
-		--activeSlowUpdateUnit;
-
 	activeUnits.erase(it);
+	EraseSlowUpdateUnit(delUnit);
 
 	spring::VectorErase(GetUnitsByTeamAndDef(delUnitTeam,           0), delUnit);
 	spring::VectorErase(GetUnitsByTeamAndDef(delUnitTeam, delUnitType), delUnit);
@@ -301,6 +461,21 @@ void CUnitHandler::UpdateUnitMoveTypes()
 {
 	SCOPED_TIMER("Sim::Unit::MoveType");
 
+	if (modInfo.multiThreadedMoveTypes) {
+		// read-only stage; per-unit results are consumed by the sequential
+		// pass below, which still applies all moves in activeUnits order so
+		// the outcome does not depend on the number or timing of threads
+		SCOPED_TIMER("Sim::Unit::MoveType::PreCollisionsMT");
+
+		for_mt(0, activeUnits.size(), [&](const int i) {
+			preCollisionsPositions[activeUnits[i]->id] = activeUnits[i]->pos;
+			activeUnits[i]->moveType->UpdatePreCollisionsMT();
+		});
+
+		preCollisionsFrame = gs->frameNum;
+		preCollisionsMovedUnits = quadField.GetNumMovedUnits();
+	}
+
 	for (activeUpdateUnit = 0; activeUpdateUnit < activeUnits.size(); ++activeUpdateUnit) {
 		CUnit* unit = activeUnits[activeUpdateUnit];
 		AMoveType* moveType = unit->moveType;
@@ -311,6 +486,8 @@ void CUnitHandler::UpdateUnitMoveTypes()
 		if (moveType->Update())
 			eventHandler.UnitMoved(unit);
 
+		CheckPreCollisionsMove(unit);
+
 		// this unit is not coming back, kill it now without any death
 		// sequence (s.t. deathScriptFinished becomes true immediately)
 		if (!unit->pos.IsInBounds() && (unit->speed.w > MAX_UNIT_SPEED))
@@ -319,38 +496,82 @@ void CUnitHandler::UpdateUnitMoveTypes()
 		unit->SanityCheck();
 		assert(activeUnits[activeUpdateUnit] == unit);
 	}
+
+	preCollisionsFrame = -1;
+}
+
+bool CUnitHandler::PreCollisionsValid(const CUnit* unit) const
+{
+	if (preCollisionsFrame != gs->frameNum)
+		return false;
+	if (preCollisionsMovedUnits != quadField.GetNumMovedUnits())
+		return false;
+
+	// the other units have moved at most half the slack since, as long as
+	// <unit> has too every unit within range now was in the candidate query
+	return (unit->pos.SqDistance(preCollisionsPositions[unit->id]) <= Square(AMoveType::PRE_COLLISIONS_SLACK * 0.5f));
+}
+
+void CUnitHandler::CheckPreCollisionsMove(const CUnit* unit)
+{
+	if (preCollisionsFrame != gs->frameNum)
+		return;
+	if (unit->pos.SqDistance(preCollisionsPositions[unit->id]) <= Square(AMoveType::PRE_COLLISIONS_SLACK * 0.5f))
+		return;
+
+	preCollisionsFrame = -1;
 }
 
 void CUnitHandler::UpdateUnitLosStates()
 {
+	size_t numUpdates = 0;
+
+	// a unit's status can only change if one of its inputs did
+	losHandler->NextUnitLosEpoch();
+
 	for (CUnit* unit: activeUnits) {
+		if (!losHandler->UnitLosInputsChanged(unit))
+			continue;
+
 		for (int at = 0; at < teamHandler.ActiveAllyTeams(); ++at) {
 			unit->UpdateLosStatus(at);
 		}
+
+		numUpdates++;
 	}
+
+	profiler.SetCounter("Sim::Unit::LosStatusUpdates", numUpdates);
 }
 
 
 void CUnitHandler::SlowUpdateUnits()
 {
 	SCOPED_TIMER("Sim::Unit::SlowUpdate");
-	assert(activeSlowUpdateUnit >= 0);
 
-	// reset the iterator every <UNIT_SLOWUPDATE_RATE> frames
-	if ((gs->frameNum % UNIT_SLOWUPDATE_RATE) == 0)
-		activeSlowUpdateUnit = 0;
+	const size_t slot = gs->frameNum % UNIT_SLOWUPDATE_RATE;
+
+	// units created by a SlowUpdate call below can land in this slot, they
+	// wait for its next turn so every unit is SlowUpdate'd once per cycle
+	const std::vector<CUnit*>& slotUnits = slowUpdateSlots[slot];
+	const size_t numSlowUpdates = slotUnits.size();
+
+	if (modInfo.batchedWeaponTargeting)
+		helper->BatchWeaponTargetCandidates(slotUnits, 0, numSlowUpdates);
 
-	// stagger the SlowUpdate's
-	for (size_t n = (activeUnits.size() / UNIT_SLOWUPDATE_RATE) + 1; (activeSlowUpdateUnit < activeUnits.size() && n != 0); ++activeSlowUpdateUnit) {
-		CUnit* unit = activeUnits[activeSlowUpdateUnit];
+	profiler.SetCounter("Sim::Unit::SlowUpdateCost", slowUpdateSlotCosts[slot]);
+
+	for (size_t i = 0; i < numSlowUpdates; i++) {
+		CUnit* unit = slotUnits[i];
 
 		unit->SanityCheck();
 		unit->SlowUpdate();
 		unit->SlowUpdateWeapons();
 		unit->SlowUpdateLocalModel();
 		unit->SanityCheck();
+	}
 
-		n--;
+	for (int teamNum = 0; teamNum < teamHandler.ActiveTeams(); teamNum++) {
+		teamHandler.Team(teamNum)->AddDelayedIncome();
 	}
 }
 
@@ -8,6 +8,7 @@
 
 #include "Sim/Misc/GlobalConstants.h"
 #include "Sim/Misc/SimObjectIDPool.h"
+#include "System/float3.h"
 #include "System/creg/STL_Map.h"
 
 struct UnitDef;
@@ -71,14 +72,25 @@ public:
 	std::vector<CUnit*>& GetUnitsByTeam      (int teamNum               ) { return unitsByDefs[teamNum][        0]; }
 	std::vector<CUnit*>& GetUnitsByTeamAndDef(int teamNum, int unitDefID) { return unitsByDefs[teamNum][unitDefID]; }
 
-	const spring::unordered_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
+	const spring::swiss_map<unsigned int, CBuilderCAI*>& GetBuilderCAIs() const { return builderCAIs; }
+
+	/// whether the candidates gathered by UpdatePreCollisionsMT this frame still hold every unit an
+	/// exact query around <unit> would find: true until any unit moved more than half the slack or
+	/// some unit was created or moved outside the moveType updates (which calls QuadField::MovedUnit)
+	bool PreCollisionsValid(const CUnit* unit) const;
+	/// must be called after <unit> was moved by another unit's moveType Update
+	void CheckPreCollisionsMove(const CUnit* unit);
+
 
 private:
 	void InsertActiveUnit(CUnit* unit);
+	void InsertSlowUpdateUnit(CUnit* unit);
+	void EraseSlowUpdateUnit(CUnit* unit);
 	bool QueueDeleteUnit(CUnit* unit);
 	void QueueDeleteUnits();
 	void DeleteUnit(CUnit* unit);
 	void DeleteUnits();
+	void DeleteUnitBatch();
 	void SlowUpdateUnits();
 	void UpdateUnitMoveTypes();
 	void UpdateUnitLosStates();
@@ -94,10 +106,23 @@ private:
 	std::vector<CUnit*> activeUnits;                                     ///< used to get all active units
 	std::vector<CUnit*> unitsToBeRemoved;                                ///< units that will be removed at start of next update
 
-	spring::unordered_map<unsigned int, CBuilderCAI*> builderCAIs;
+	spring::swiss_map<unsigned int, CBuilderCAI*> builderCAIs;
+
+	///< scratch space of DeleteUnitBatch, positions of units (by ID) in their {team, unitDef} bins
+	std::array<std::vector<int>, 2> batchBinPositions;
+
+	///< units are spread over the <UNIT_SLOWUPDATE_RATE> frames of a SlowUpdate
+	///< cycle by estimated cost, each slot holds the units updated in one frame
+	std::array<std::vector<CUnit*>, UNIT_SLOWUPDATE_RATE> slowUpdateSlots;
+	std::array<int, UNIT_SLOWUPDATE_RATE> slowUpdateSlotCosts;
+
+	///< positions of units (by ID) when UpdatePreCollisionsMT last ran
+	std::vector<float3> preCollisionsPositions;
+
+	int preCollisionsFrame = -1;
+	std::uint32_t preCollisionsMovedUnits = 0;
 
 
-	size_t activeSlowUpdateUnit = 0;  ///< first unit of batch that will be SlowUpdate'd this frame
 	size_t activeUpdateUnit = 0;      ///< first unit of batch that will be SlowUpdate'd this frame
 
 
@@ -107,6 +107,43 @@ CUnit* CUnitLoader::LoadUnit(const UnitLoadParams& params)
 	return unit;
 }
 
+void CUnitLoader::LoadUnits(const std::vector<UnitLoadParams>& params, std::vector<CUnit*>& units)
+{
+	std::vector<SRectangle> flattenedRects;
+
+	units.clear();
+	units.reserve(params.size());
+	flattenedRects.reserve(params.size());
+
+	for (const UnitLoadParams& unitParams: params) {
+		const int teamID = (unitParams.teamID < 0)? teamHandler.GaiaTeamID(): unitParams.teamID;
+
+		// limits have to be checked per unit, earlier ones count against them
+		if (unitParams.unitDef != nullptr && teamID >= 0 && !unitHandler.CanBuildUnit(unitParams.unitDef, teamID)) {
+			units.push_back(nullptr);
+			continue;
+		}
+
+		UnitLoadParams deferredParams = unitParams;
+		deferredParams.flattenGround = false;
+
+		CUnit* unit = LoadUnit(deferredParams);
+		SRectangle rect;
+
+		// heights are changed right away (as LoadUnit would), only the
+		// derived terrain data is recalculated once for the whole batch
+		if (unit != nullptr && unitParams.flattenGround && FlattenGroundHeights(unit, rect))
+			flattenedRects.push_back(rect);
+
+		units.push_back(unit);
+	}
+
+	if (flattenedRects.empty())
+		return;
+
+	mapDamage->RecalcAreas(flattenedRects);
+}
+
 
 
 void CUnitLoader::ParseAndExecuteGiveUnitsCommand(const std::vector<std::string>& args, int team)
@@ -335,20 +372,30 @@ void CUnitLoader::GiveUnits(const std::string& objectName, float3 pos, int amoun
 
 
 void CUnitLoader::FlattenGround(const CUnit* unit)
+{
+	SRectangle rect;
+
+	if (!FlattenGroundHeights(unit, rect))
+		return;
+
+	mapDamage->RecalcArea(rect.x1, rect.x2, rect.z1, rect.z2);
+}
+
+bool CUnitLoader::FlattenGroundHeights(const CUnit* unit, SRectangle& rect)
 {
 	const UnitDef* unitDef = unit->unitDef;
 	// const MoveDef* moveDef = unit->moveDef;
 
 	if (mapDamage->Disabled())
-		return;
+		return false;
 	if (!unitDef->levelGround)
-		return;
+		return false;
 	if (unitDef->IsAirUnit())
-		return;
+		return false;
 	if (!unitDef->IsImmobileUnit())
-		return;
+		return false;
 	if (unit->FloatOnWater() && unit->IsInWater())
-		return;
+		return false;
 
 	// if we are float-capable, only flatten
 	// if the terrain here is above sea level
@@ -367,7 +414,8 @@ void CUnitLoader::FlattenGround(const CUnit* unit)
 		}
 	}
 
-	mapDamage->RecalcArea(tx1, tx2, tz1, tz2);
+	rect = SRectangle(tx1, tz1, tx2, tz2);
+	return true;
 }
 
 void CUnitLoader::RestoreGround(const CUnit* unit)
@@ -12,6 +12,8 @@ class CCommandAI;
 class CUnit;
 class CWeapon;
 
+struct SRectangle;
+
 struct UnitDef;
 struct UnitDefWeapon;
 
@@ -39,6 +41,15 @@ public:
 	CUnit* LoadUnit(const std::string& name, const UnitLoadParams& params);
 	CUnit* LoadUnit(const UnitLoadParams& params);
 
+	/**
+	 * Loads the units of <params> in order, like LoadUnit, but recalculates
+	 * the terrain flattened below them once for the whole batch (merging
+	 * overlapping footprints) instead of after each unit. Units beyond their
+	 * team's or unitDef's limit are skipped. units[i] is nullptr for every
+	 * params[i] that was not loaded.
+	 */
+	void LoadUnits(const std::vector<UnitLoadParams>& params, std::vector<CUnit*>& units);
+
 	CWeapon* LoadWeapon(CUnit* owner, const UnitDefWeapon* udw);
 
 	void ParseAndExecuteGiveUnitsCommand(const std::vector<std::string>& args, int team);
@@ -46,6 +57,10 @@ public:
 
 	void FlattenGround(const CUnit* unit);
 	void RestoreGround(const CUnit* unit);
+
+private:
+	/// sets the heights below <unit>, returns false if it does not level ground
+	bool FlattenGroundHeights(const CUnit* unit, SRectangle& rect);
 };
 
 #define unitLoader (CUnitLoader::GetInstance())
@@ -20,6 +20,7 @@
 #include "Sim/Projectiles/ProjectileHandler.h"
 #include "Sim/Units/Scripts/CobInstance.h"
 #include "Sim/Units/CommandAI/BuilderCAI.h"
+#include "Sim/Units/CommandAI/BuilderWorkIndex.h"
 #include "Sim/Units/CommandAI/CommandAI.h"
 #include "Sim/Units/UnitDefHandler.h"
 #include "Sim/Units/UnitHandler.h"
@@ -431,6 +432,7 @@ bool CBuilder::UpdateResurrect(const Command& fCommand)
 
 		// TODO: make configurable if this should happen
 		resurrectee->health *= 0.05f;
+		builderWorkIndex.AddDamagedUnit(resurrectee);
 
 		for (const int resurrecterID: cai->resurrecters) {
 			CBuilder* resurrecter = static_cast<CBuilder*>(unitHandler.GetUnit(resurrecterID));
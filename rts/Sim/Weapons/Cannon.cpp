@@ -5,6 +5,7 @@
 #include "Game/TraceRay.h"
 #include "Map/Ground.h"
 #include "Map/MapInfo.h"
+#include "Map/ReadMap.h"
 #include "Rendering/Env/Particles/Classes/HeatCloudProjectile.h"
 #include "Rendering/Env/Particles/Classes/SmokeProjectile.h"
 #include "Sim/Misc/GlobalSynced.h"
@@ -13,6 +14,8 @@
 #include "System/SpringMath.h"
 #include "System/FastMath.h"
 
+#include <cstring>
+
 CR_BIND_DERIVED(CCannon, CWeapon, )
 
 CR_REG_METADATA(CCannon,(
@@ -20,7 +23,8 @@ CR_REG_METADATA(CCannon,(
 	CR_MEMBER(rangeBoostFactor),
 	CR_MEMBER(gravity),
 	CR_MEMBER(lastTargetVec),
-	CR_MEMBER(lastLaunchDir)
+	CR_MEMBER(lastLaunchDir),
+	CR_IGNORED(aimSolutions)
 ))
 
 //////////////////////////////////////////////////////////////////////
@@ -62,13 +66,17 @@ bool CCannon::HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const
 	if (projectileSpeed == 0.0f)
 		return true;
 
-	float3 launchDir = CalcWantedDir(tgtPos - srcPos);
+	const AimSolution& aim = GetAimSolution(srcPos, tgtPos);
+
+	float3 launchDir = aim.launchDir;
 	float3 targetVec = (tgtPos - srcPos) * XZVector;
 
 	if (launchDir.SqLength() == 0.0f)
 		return false;
 	if (targetVec.SqLength2D() == 0.0f)
 		return true;
+	if (aim.groundDist > 0.0f)
+		return false;
 
 	// pick launchDir[0] if .x != 0, otherwise launchDir[2]
 	const unsigned int dirIdx = 2 - 2 * (launchDir.x != 0.0f);
@@ -82,20 +90,70 @@ bool CCannon::HaveFreeLineOfFire(const float3 srcPos, const float3 tgtPos, const
 	// by projectiles
 	const float linCoeff = launchDir.y * xzCoeffRatio;
 	const float qdrCoeff = (gravity * 0.5f) / (projectileSpeed * projectileSpeed);
-
-	// CGround::SimTrajectoryGroundColDist(weaponMuzzlePos, launchDir, UpVector * gravity, {projectileSpeed, xzTargetDist - 10.0f})
-	const float groundDist = ((avoidFlags & Collision::NOGROUND) == 0)?
-		CGround::TrajectoryGroundCol(weaponMuzzlePos, targetVec, xzTargetDist - 10.0f, linCoeff, qdrCoeff):
-		-1.0f;
 	const float angleSpread = (AccuracyExperience() + SprayAngleExperience()) * 0.6f * 0.9f;
 
-	if (groundDist > 0.0f)
-		return false;
-
 	// TODO: add a forcedUserTarget mode (enabled with meta key e.g.) and skip this test accordingly
 	return (!TraceRay::TestTrajectoryCone(srcPos, targetVec, xzTargetDist, linCoeff, qdrCoeff, angleSpread, owner->allyteam, avoidFlags, owner));
 }
 
+const CCannon::AimSolution& CCannon::GetAimSolution(const float3& srcPos, const float3& tgtPos) const
+{
+	const auto HashPos = [](const float3& pos) {
+		unsigned int x = 0;
+		unsigned int z = 0;
+
+		std::memcpy(&x, &pos.x, sizeof(x));
+		std::memcpy(&z, &pos.z, sizeof(z));
+		return ((x * 73856093u) ^ (z * 19349663u));
+	};
+	// float3::operator== has a tolerance
+	const auto SamePos = [](const float3& a, const float3& b) {
+		return (a.x == b.x && a.y == b.y && a.z == b.z);
+	};
+
+	const bool testGround = ((avoidFlags & Collision::NOGROUND) == 0);
+	const unsigned int heightMapVersion = readMap->GetSyncedHeightMapVersion();
+
+	AimSolution& aim = aimSolutions[HashPos(tgtPos) % AIM_CACHE_SIZE];
+
+	// all key values must match exactly, a hit may not change the outcome
+	if (aim.valid &&
+		SamePos(aim.srcPos, srcPos) && SamePos(aim.tgtPos, tgtPos) && SamePos(aim.muzzlePos, weaponMuzzlePos) &&
+		aim.projSpeed == projectileSpeed && aim.highTrajectory == highTrajectory &&
+		aim.testGround == testGround && aim.heightMapVersion == heightMapVersion) {
+		return aim;
+	}
+
+	aim.srcPos = srcPos;
+	aim.tgtPos = tgtPos;
+	aim.muzzlePos = weaponMuzzlePos;
+	aim.launchDir = CalcWantedDir(tgtPos - srcPos);
+	aim.projSpeed = projectileSpeed;
+	aim.groundDist = -1.0f;
+	aim.heightMapVersion = heightMapVersion;
+	aim.highTrajectory = highTrajectory;
+	aim.testGround = testGround;
+	aim.valid = true;
+
+	float3 targetVec = (tgtPos - srcPos) * XZVector;
+
+	if (!testGround || aim.launchDir.SqLength() == 0.0f || targetVec.SqLength2D() == 0.0f)
+		return aim;
+
+	// same parabola as the cone test in HaveFreeLineOfFire
+	const unsigned int dirIdx = 2 - 2 * (aim.launchDir.x != 0.0f);
+
+	const float xzTargetDist = targetVec.LengthNormalize();
+	const float xzCoeffRatio = targetVec[dirIdx] / aim.launchDir[dirIdx];
+
+	const float linCoeff = aim.launchDir.y * xzCoeffRatio;
+	const float qdrCoeff = (gravity * 0.5f) / (projectileSpeed * projectileSpeed);
+
+	// CGround::SimTrajectoryGroundColDist(weaponMuzzlePos, launchDir, UpVector * gravity, {projectileSpeed, xzTargetDist - 10.0f})
+	aim.groundDist = CGround::TrajectoryGroundCol(weaponMuzzlePos, targetVec, xzTargetDist - 10.0f, linCoeff, qdrCoeff);
+	return aim;
+}
+
 void CCannon::FireImpl(const bool scriptCall)
 {
 	float3 targetVec = currentTargetPos - weaponMuzzlePos;
@@ -6,6 +6,8 @@
 #include "Weapon.h"
 #include "System/type2.h"
 
+#include <array>
+
 class CCannon: public CWeapon
 {
 	CR_DECLARE_DERIVED(CCannon)
@@ -25,6 +27,32 @@ protected:
 	/// indicates high trajectory on/off state
 	bool highTrajectory = false;
 
+private:
+	// ballistic solution and ground-collision result of a HaveFreeLineOfFire
+	// test; both only depend on the key values and the synced heightmap, so
+	// a hit is exactly what recomputing would give (the cone test against
+	// units and features is still run every time)
+	struct AimSolution {
+		float3 srcPos;
+		float3 tgtPos;
+		float3 muzzlePos;
+		float3 launchDir;
+
+		float projSpeed;
+		float groundDist;
+
+		unsigned int heightMapVersion;
+
+		bool highTrajectory;
+		bool testGround;
+		bool valid;
+	};
+
+	static constexpr unsigned int AIM_CACHE_SIZE = 8;
+
+	/// indexed by a hash of the target position, not saved
+	mutable std::array<AimSolution, AIM_CACHE_SIZE> aimSolutions = {};
+
 public:
 	CCannon(CUnit* owner = nullptr, const WeaponDef* def = nullptr): CWeapon(owner, def) {}
 
@@ -45,6 +73,7 @@ private:
 	/// tells where to point the gun to hit the point at pos+diff
 	float3 GetWantedDir(const float3& diff);
 	float3 CalcWantedDir(const float3& diff) const;
+	const AimSolution& GetAimSolution(const float3& srcPos, const float3& tgtPos) const;
 
 	const float3& GetAimFromPos(bool useMuzzle = false) const override { return weaponMuzzlePos; }
 
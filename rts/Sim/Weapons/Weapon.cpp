@@ -102,7 +102,10 @@ CR_REG_METADATA(CWeapon, (
 	CR_MEMBER(currentTarget),
 	CR_MEMBER(currentTargetPos),
 
-	CR_MEMBER(incomingProjectileIDs)
+	CR_MEMBER(incomingProjectileIDs),
+
+	CR_IGNORED(targetCandidates),
+	CR_IGNORED(targetCandidatesFrame)
 ))
 
 
@@ -177,7 +180,9 @@ CWeapon::CWeapon(CUnit* owner, const WeaponDef* def):
 	errorVector(ZeroVector),
 	errorVectorAdd(ZeroVector),
 
-	muzzleFlareSize(1)
+	muzzleFlareSize(1),
+
+	targetCandidatesFrame(-1)
 {
 	assert(weaponMemPool.alloced(this));
 }
@@ -197,6 +197,11 @@ public:
 
 	float muzzleFlareSize;                  // size of muzzle flare if drawn
 
+	// enemy units GenerateWeaponTargets will score, gathered ahead of time
+	// by CGameHelper::BatchWeaponTargetCandidates if <frame> is current
+	std::vector<CUnit*> targetCandidates;
+	int targetCandidatesFrame;
+
 protected:
 	SWeaponTarget currentTarget;
 	float3 currentTargetPos;
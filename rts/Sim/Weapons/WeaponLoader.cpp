@@ -25,10 +25,12 @@
 #include "Sim/Units/Unit.h"
 #include "Sim/Units/UnitDef.h"
 #include "System/Log/ILog.h"
+#include "System/MemoryStats.h"
 
 static std::array<uint8_t, 2048> udWeaponCounts;
 
 WeaponMemPool weaponMemPool;
+static MemoryStats::Registrar weaponMemPoolStats("Sim::Weapons::MemPool", []() { return MemoryStats::GetPoolUsage(weaponMemPool); });
 
 static_assert((sizeof(UnitDef::weapons) / sizeof(UnitDef::weapons[0])) == MAX_WEAPONS_PER_UNIT, "");
 static_assert(MAX_WEAPONS_PER_UNIT < std::numeric_limits<decltype(udWeaponCounts)::value_type>::max(), "");
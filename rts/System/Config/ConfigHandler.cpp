@@ -119,6 +119,7 @@ ConfigHandlerImpl::ConfigHandlerImpl(const std::vector<std::string>& locations,
 
 	// Perform migrations that need to happen on every load.
 	RemoveDefaults();
+	UpdateCachedValues();
 }
 
 ConfigHandlerImpl::~ConfigHandlerImpl()
@@ -213,6 +214,8 @@ void ConfigHandlerImpl::Delete(const std::string& key)
 
 		rwcs->Delete(key);
 	}
+
+	UpdateCachedValue(key);
 }
 
 bool ConfigHandlerImpl::IsSet(const std::string& key) const
@@ -307,6 +310,8 @@ void ConfigHandlerImpl::SetString(const std::string& key, const std::string& val
 		}
 	}
 
+	UpdateCachedValue(key);
+
 	std::lock_guard<spring::mutex> lck(observerMutex);
 	changedValues[key] = value;
 }
@@ -405,4 +410,40 @@ bool ConfigHandler::Get(const std::string& key) const
 }
 
 
+void ConfigHandler::UpdateCachedValue(const std::string& key)
+{
+	const int handle = GetHandle(key);
+
+	if (handle < 0)
+		return;
+
+	CachedValue& cv = cachedValues[handle];
+
+	if (!(cv.isSet = IsSet(key))) {
+		cv = {};
+		return;
+	}
+
+	cv.stringValue = GetString(key);
+	cv.boolValue = StringToBool(cv.stringValue);
+
+	// same parsing as Get<T>; leaves zero if the value is not numeric
+	cv.intValue = 0;
+	cv.floatValue = 0.0f;
+
+	{ std::istringstream buf(cv.stringValue); buf >> cv.intValue; }
+	{ std::istringstream buf(cv.stringValue); buf >> cv.floatValue; }
+}
+
+void ConfigHandler::UpdateCachedValues()
+{
+	cachedValues.clear();
+	cachedValues.resize(ConfigVariable::GetNumMetaData());
+
+	for (const auto& p: ConfigVariable::GetMetaDataMap()) {
+		UpdateCachedValue(p.first);
+	}
+}
+
+
 /******************************************************************************/
@@ -3,6 +3,7 @@
 #ifndef CONFIGHANDLER_H
 #define CONFIGHANDLER_H
 
+#include <cassert>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -83,6 +84,26 @@ public:
 	float GetFloatSafe(const std::string& key, float def) const { return (IsSet(key)? GetFloat(key): def); }
 	std::string GetStringSafe(const std::string& key, const std::string& def) const { return (IsSet(key)? GetString(key): def); }
 
+
+	/**
+	 * @brief Resolve a CONFIG-declared variable to a handle for the getters below
+	 * @return handle, or -1 if <key> was never declared
+	 *
+	 * Handles stay valid for the lifetime of the process. The value behind
+	 * each one is parsed once and refreshed whenever the key is set or
+	 * deleted through this handler, so reading it costs no string lookup.
+	 */
+	static int GetHandle(const std::string& key) {
+		const ConfigVariableMetaData* meta = ConfigVariable::GetMetaData(key);
+		return ((meta != nullptr)? meta->GetIndex(): -1);
+	}
+
+	bool IsSet(int handle) const { return (GetCachedValue(handle).isSet); }
+	bool GetBool(int handle) const { return (GetCachedValue(handle).boolValue); }
+	int GetInt(int handle) const { return (GetCachedValue(handle).intValue); }
+	float GetFloat(int handle) const { return (GetCachedValue(handle).floatValue); }
+	const std::string& GetString(int handle) const { return (GetCachedValue(handle).stringValue); }
+
 public:
 	virtual ~ConfigHandler() {}
 
@@ -157,6 +178,27 @@ protected:
 	virtual void AddObserver(ConfigNotifyCallback callback, void* observer, const std::vector<std::string>& configs) = 0;
 	virtual void RemoveObserver(void* observer) = 0;
 
+	struct CachedValue {
+		std::string stringValue;
+
+		float floatValue = 0.0f;
+		int intValue = 0;
+		bool boolValue = false;
+		bool isSet = false;
+	};
+
+	const CachedValue& GetCachedValue(int handle) const {
+		assert(handle >= 0 && size_t(handle) < cachedValues.size());
+		return cachedValues[handle];
+	}
+
+	/// re-parses the cached value of <key>, no-op if it was not declared
+	void UpdateCachedValue(const std::string& key);
+	void UpdateCachedValues();
+
+	// indexed by handle, never resized after construction
+	std::vector<CachedValue> cachedValues;
+
 private:
 	/// @see GetString
 	template<typename T>
@@ -23,7 +23,7 @@ const ConfigVariable::MetaDataMap& ConfigVariable::GetMetaDataMap()
 	return GetMutableMetaDataMap();
 }
 
-void ConfigVariable::AddMetaData(const ConfigVariableMetaData* data)
+void ConfigVariable::AddMetaData(ConfigVariableMetaData* data)
 {
 	MetaDataMap& vars = GetMutableMetaDataMap();
 	MetaDataMap::const_iterator pos = vars.find(data->GetKey());
@@ -33,6 +33,7 @@ void ConfigVariable::AddMetaData(const ConfigVariableMetaData* data)
 		LOG_VAR(pos->second, "  Previously declared here");
 	}
 	else {
+		data->index = vars.size();
 		vars[data->GetKey()] = data;
 	}
 }
@@ -54,6 +54,9 @@ public:
 	const OptionalString& GetDescription() const { return description; }
 	const OptionalInt& GetReadOnly() const { return readOnly; }
 
+	/// @brief Get the registration index of this config variable, stable for the lifetime of the process.
+	int GetIndex() const { return index; }
+
 protected:
 	const char* key;
 	const char* type;
@@ -62,7 +65,10 @@ protected:
 	OptionalString description;
 	OptionalInt readOnly;
 
+	int index = -1;
+
 	template<typename F> friend class ConfigVariableBuilder;
+	friend class ConfigVariable;
 };
 
 /**
@@ -138,7 +144,7 @@ class ConfigVariableBuilder : public spring::noncopyable
 {
 public:
 	ConfigVariableBuilder(ConfigVariableTypedMetaData<T>& data) : data(&data) {}
-	const ConfigVariableMetaData* GetData() const { return data; }
+	ConfigVariableMetaData* GetData() const { return data; }
 
 #define MAKE_CHAIN_METHOD(property, type) \
 	ConfigVariableBuilder& property(type const& x) { \
@@ -179,9 +185,12 @@ public:
 	static const ConfigVariableMetaData* GetMetaData(const std::string& key);
 	static void OutputMetaDataMap();
 
+	/// @brief Number of registered config variables, their indices are [0, n).
+	static size_t GetNumMetaData() { return (GetMetaDataMap().size()); }
+
 private:
 	static MetaDataMap& GetMutableMetaDataMap();
-	static void AddMetaData(const ConfigVariableMetaData* data);
+	static void AddMetaData(ConfigVariableMetaData* data);
 
 public:
 	/// @brief Implicit conversion from ConfigVariableBuilder<T>.
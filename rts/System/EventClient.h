@@ -187,6 +187,12 @@ class CEventClient
 		virtual void ProjectileDestroyed(const CProjectile* proj) {}
 
 		virtual void RenderProjectileCreated(const CProjectile* proj) {}
+		/// delivered to RenderProjectileCreated clients for projectiles created in bulk
+		virtual void RenderProjectilesCreated(const CProjectile* const* projs, size_t count) {
+			for (size_t i = 0; i < count; i++) {
+				RenderProjectileCreated(projs[i]);
+			}
+		}
 		virtual void RenderProjectileDestroyed(const CProjectile* proj) {}
 
 		virtual void StockpileChanged(const CUnit* unit,
@@ -74,8 +74,11 @@ class CEventHandler
 		void RenderUnitCreated(const CUnit* unit, int cloaked);
 		void RenderUnitDestroyed(const CUnit* unit);
 		void RenderFeatureCreated(const CFeature* feature);
+		/// RenderFeatureCreated for a batch of features, client by client
+		void RenderFeaturesCreated(const std::vector<CFeature*>& features);
 		void RenderFeatureDestroyed(const CFeature* feature);
 		void RenderProjectileCreated(const CProjectile* proj);
+		void RenderProjectilesCreated(const CProjectile* const* projs, size_t count);
 		void RenderProjectileDestroyed(const CProjectile* proj);
 
 		void UnitIdle(const CUnit* unit);
@@ -729,6 +732,19 @@ inline void CEventHandler::RenderFeatureCreated(const CFeature* feature)
 	ITERATE_EVENTCLIENTLIST(RenderFeatureCreated, feature)
 }
 
+inline void CEventHandler::RenderFeaturesCreated(const std::vector<CFeature*>& features)
+{
+	for (size_t i = 0; i < listRenderFeatureCreated.size(); ) {
+		CEventClient* ec = listRenderFeatureCreated[i];
+
+		for (const CFeature* feature: features) {
+			ec->RenderFeatureCreated(feature);
+		}
+
+		i += (i < listRenderFeatureCreated.size() && ec == listRenderFeatureCreated[i]);
+	}
+}
+
 inline void CEventHandler::RenderFeatureDestroyed(const CFeature* feature)
 {
 	ITERATE_EVENTCLIENTLIST(RenderFeatureDestroyed, feature)
@@ -740,6 +756,17 @@ inline void CEventHandler::RenderProjectileCreated(const CProjectile* proj)
 	ITERATE_EVENTCLIENTLIST(RenderProjectileCreated, proj)
 }
 
+inline void CEventHandler::RenderProjectilesCreated(const CProjectile* const* projs, size_t count)
+{
+	// not an event of its own, goes to the clients of the per-projectile one
+	for (size_t i = 0; i < listRenderProjectileCreated.size(); ) {
+		CEventClient* ec = listRenderProjectileCreated[i];
+		ec->RenderProjectilesCreated(projs, count);
+
+		i += (i < listRenderProjectileCreated.size() && ec == listRenderProjectileCreated[i]);
+	}
+}
+
 inline void CEventHandler::RenderProjectileDestroyed(const CProjectile* proj)
 {
 	ITERATE_EVENTCLIENTLIST(RenderProjectileDestroyed, proj)
@@ -18,6 +18,7 @@
 #include "DataDirsAccess.h"
 #include "FileSystem.h"
 #include "FileQueryFlags.h"
+#include "MappedFile.h"
 #include "Lua/LuaParser.h"
 #include "System/ContainerUtil.h"
 #include "System/StringUtil.h"
@@ -54,6 +55,72 @@ LOG_REGISTER_SECTION_GLOBAL(LOG_SECTION_ARCHIVESCANNER)
 constexpr static int INTERNAL_VER = 16;
 
 
+/*
+ * Layout of ArchiveCache<INTERNAL_VER>.bin, all in native byte-order:
+ *
+ *   BinaryCacheHeader
+ *   BinaryArchiveRecord[numArchives]
+ *   BinaryBrokenArchiveRecord[numBrokenArchives]
+ *   BinaryInfoItemRecord[numInfoItems]
+ *   uint32_t dependencies[numDependencies]
+ *   char strings[stringTableSize]
+ *
+ * Strings are stored as offsets into the (NUL-separated) string table.
+ * ArchiveCache<INTERNAL_VER>.lua holds the same data for humans and tools,
+ * and is only read if no binary cache exists yet.
+ */
+constexpr static char BINARY_CACHE_MAGIC[8] = "SPRARCH";
+constexpr static uint32_t BINARY_CACHE_VERSION = 1;
+
+struct BinaryCacheHeader {
+	char magic[8];
+	uint32_t version;
+	uint32_t internalVer;
+
+	uint32_t numArchives;
+	uint32_t numBrokenArchives;
+	uint32_t numInfoItems;
+	uint32_t numDependencies;
+	uint32_t stringTableSize;
+	uint32_t padding;
+};
+
+struct BinaryArchiveRecord {
+	uint32_t name;
+	uint32_t path;
+	uint32_t archiveDataPath;
+
+	uint32_t modified;
+	uint32_t modifiedArchiveData;
+
+	uint32_t firstInfoItem;
+	uint32_t numInfoItems;
+	uint32_t firstDependency;
+	uint32_t numDependencies;
+
+	uint8_t checksum[sha512::SHA_LEN];
+};
+
+struct BinaryBrokenArchiveRecord {
+	uint32_t name;
+	uint32_t path;
+	uint32_t problem;
+	uint32_t modified;
+};
+
+struct BinaryInfoItemRecord {
+	uint32_t key;
+	uint32_t valueType; // InfoValueType
+	uint32_t value; // int, float or bool bits, or string offset
+};
+
+// records are read in place from the mapped file
+static_assert((sizeof(BinaryCacheHeader) % 4) == 0, "");
+static_assert((sizeof(BinaryArchiveRecord) % 4) == 0, "");
+static_assert((sizeof(BinaryBrokenArchiveRecord) % 4) == 0, "");
+static_assert((sizeof(BinaryInfoItemRecord) % 4) == 0, "");
+
+
 /*
  * Engine known (and used?) tags in [map|mod]info.lua
  */
@@ -387,8 +454,7 @@ static std::atomic<uint32_t> numScannedArchives{0};
 CArchiveScanner::CArchiveScanner()
 {
 	Clear();
-	// the "cache" dir is created in DataDirLocater
-	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
+	ReadCacheData();
 	ScanAllDirs();
 }
 
@@ -432,7 +498,24 @@ void CArchiveScanner::Reload()
 
 	// ctor
 	Clear();
-	ReadCacheData(cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.lua"));
+	ReadCacheData();
+	ScanAllDirs();
+}
+
+void CArchiveScanner::Rescan()
+{
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+	// as if freshly read from the cache; archives that are not found
+	// again get dropped when the cache is written, unchanged ones are
+	// not reopened (and keep their checksums)
+	for (ArchiveInfo& ai: archiveInfos) {
+		ai.updated = false;
+	}
+	for (BrokenArchive& ba: brokenArchives) {
+		ba.updated = false;
+	}
+
 	ScanAllDirs();
 }
 
@@ -763,7 +846,7 @@ void CArchiveScanner::ScanArchive(const std::string& fullName, bool doChecksum)
 
 	ai.origName = fname;
 	ai.updated = true;
-	ai.hashed = doChecksum && GetArchiveChecksum(fullName, ai);
+	ai.hashed = doChecksum && GetArchiveChecksum(fullName, ai.checksum);
 
 	archiveInfosIndex.insert(lcfn, archiveInfos.size());
 	archiveInfos.emplace_back(std::move(ai));
@@ -827,7 +910,7 @@ bool CArchiveScanner::CheckCachedData(const std::string& fullName, unsigned& mod
 		ai.updated = true;
 
 		if (doChecksum && !ai.hashed)
-			isDirty |= (ai.hashed = GetArchiveChecksum(fullName, ai));
+			isDirty |= (ai.hashed = GetArchiveChecksum(fullName, ai.checksum));
 
 		return true;
 	}
@@ -916,7 +999,7 @@ IFileFilter* CArchiveScanner::CreateIgnoreFilter(IArchive* ar)
  * Get checksum of the data in the specified archive.
  * Returns 0 if file could not be opened.
  */
-bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, ArchiveInfo& archiveInfo)
+bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, uint8_t checksum[sha512::SHA_LEN])
 {
 	// try to open an archive
 	std::unique_ptr<IArchive> ar(archiveLoader.OpenArchive(archiveName));
@@ -958,10 +1041,10 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 
 	// combine individual hashes, initialize to hash(name)
 	for (size_t i = 0; i < fileNames.size(); i++) {
-		sha512::calc_digest(reinterpret_cast<const uint8_t*>(fileNames[i].c_str()), fileNames[i].size(), archiveInfo.checksum);
+		sha512::calc_digest(reinterpret_cast<const uint8_t*>(fileNames[i].c_str()), fileNames[i].size(), checksum);
 
 		for (uint8_t j = 0; j < sha512::SHA_LEN; j++) {
-			archiveInfo.checksum[j] ^= fileHashes[i][j];
+			checksum[j] ^= fileHashes[i][j];
 		}
 
 		#if !defined(DEDICATED) && !defined(UNITSYNC)
@@ -973,7 +1056,162 @@ bool CArchiveScanner::GetArchiveChecksum(const std::string& archiveName, Archive
 }
 
 
-void CArchiveScanner::ReadCacheData(const std::string& filename)
+void CArchiveScanner::ReadCacheData()
+{
+	// the "cache" dir is created in DataDirLocater
+	cachefile = FileSystem::EnsurePathSepAtEnd(FileSystem::GetCacheDir()) + IntToString(INTERNAL_VER, "ArchiveCache%i.bin");
+
+	if (ReadBinaryCacheData(cachefile))
+		return;
+
+	// e.g. first start after upgrading; the binary cache is written after scanning
+	ReadLuaCacheData(GetLuaFilepath());
+}
+
+bool CArchiveScanner::ReadBinaryCacheData(const std::string& filename)
+{
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+	CMappedFile file;
+
+	if (!file.Open(filename))
+		return false;
+
+	const uint8_t* data = file.GetData();
+	const uint64_t size = file.GetSize();
+
+	if (size < sizeof(BinaryCacheHeader))
+		return false;
+
+	const BinaryCacheHeader* header = reinterpret_cast<const BinaryCacheHeader*>(data);
+
+	if (std::memcmp(header->magic, BINARY_CACHE_MAGIC, sizeof(header->magic)) != 0)
+		return false;
+	if (header->version != BINARY_CACHE_VERSION || header->internalVer != INTERNAL_VER)
+		return false;
+
+	const uint64_t archivesPos = sizeof(BinaryCacheHeader);
+	const uint64_t brokenArchivesPos = archivesPos       + uint64_t(header->numArchives      ) * sizeof(BinaryArchiveRecord);
+	const uint64_t infoItemsPos      = brokenArchivesPos + uint64_t(header->numBrokenArchives) * sizeof(BinaryBrokenArchiveRecord);
+	const uint64_t dependenciesPos   = infoItemsPos      + uint64_t(header->numInfoItems     ) * sizeof(BinaryInfoItemRecord);
+	const uint64_t stringsPos        = dependenciesPos   + uint64_t(header->numDependencies  ) * sizeof(uint32_t);
+
+	if ((stringsPos + header->stringTableSize) != size)
+		return false;
+	// every string must be terminated within the table
+	if (header->stringTableSize == 0 || data[size - 1] != 0)
+		return false;
+
+	const BinaryArchiveRecord* archiveRecords = reinterpret_cast<const BinaryArchiveRecord*>(data + archivesPos);
+	const BinaryBrokenArchiveRecord* brokenArchiveRecords = reinterpret_cast<const BinaryBrokenArchiveRecord*>(data + brokenArchivesPos);
+	const BinaryInfoItemRecord* infoItemRecords = reinterpret_cast<const BinaryInfoItemRecord*>(data + infoItemsPos);
+	const uint32_t* dependencyRecords = reinterpret_cast<const uint32_t*>(data + dependenciesPos);
+	const char* strings = reinterpret_cast<const char*>(data + stringsPos);
+
+	// validate all offsets up front so a corrupt file leaves nothing half-read
+	for (uint32_t i = 0; i < header->numArchives; i++) {
+		const BinaryArchiveRecord& ar = archiveRecords[i];
+
+		if (ar.name >= header->stringTableSize || ar.path >= header->stringTableSize || ar.archiveDataPath >= header->stringTableSize)
+			return false;
+		if ((uint64_t(ar.firstInfoItem) + ar.numInfoItems) > header->numInfoItems)
+			return false;
+		if ((uint64_t(ar.firstDependency) + ar.numDependencies) > header->numDependencies)
+			return false;
+	}
+	for (uint32_t i = 0; i < header->numBrokenArchives; i++) {
+		const BinaryBrokenArchiveRecord& br = brokenArchiveRecords[i];
+
+		if (br.name >= header->stringTableSize || br.path >= header->stringTableSize || br.problem >= header->stringTableSize)
+			return false;
+	}
+	for (uint32_t i = 0; i < header->numInfoItems; i++) {
+		const BinaryInfoItemRecord& ir = infoItemRecords[i];
+
+		if (ir.key >= header->stringTableSize || ir.valueType > INFO_VALUE_TYPE_BOOL)
+			return false;
+		if (ir.valueType == INFO_VALUE_TYPE_STRING && ir.value >= header->stringTableSize)
+			return false;
+	}
+	for (uint32_t i = 0; i < header->numDependencies; i++) {
+		if (dependencyRecords[i] >= header->stringTableSize)
+			return false;
+	}
+
+
+	for (uint32_t i = 0; i < header->numArchives; i++) {
+		const BinaryArchiveRecord& ar = archiveRecords[i];
+		const std::string curArchiveName = strings + ar.name;
+
+		ArchiveInfo& ai = GetAddArchiveInfo(StringToLower(curArchiveName));
+		ArchiveInfo tmp; // used to compare against all-zero hash
+
+		ai.origName            = curArchiveName;
+		ai.path                = strings + ar.path;
+		ai.archiveDataPath     = strings + ar.archiveDataPath;
+		ai.modified            = ar.modified;
+		ai.modifiedArchiveData = ar.modifiedArchiveData;
+
+		std::memcpy(ai.checksum, ar.checksum, sha512::SHA_LEN);
+
+		ai.updated = false;
+		ai.hashed = (memcmp(ai.checksum, tmp.checksum, sha512::SHA_LEN) != 0);
+
+		ai.archiveData = {};
+
+		for (uint32_t j = ar.firstInfoItem, n = ar.firstInfoItem + ar.numInfoItems; j < n; j++) {
+			const BinaryInfoItemRecord& ir = infoItemRecords[j];
+			const std::string key = strings + ir.key;
+
+			switch (ir.valueType) {
+				case INFO_VALUE_TYPE_STRING: {
+					ai.archiveData.SetInfoItemValueString(key, strings + ir.value);
+				} break;
+				case INFO_VALUE_TYPE_INTEGER: {
+					int32_t value;
+					std::memcpy(&value, &ir.value, sizeof(value));
+					ai.archiveData.SetInfoItemValueInteger(key, value);
+				} break;
+				case INFO_VALUE_TYPE_FLOAT: {
+					float value;
+					std::memcpy(&value, &ir.value, sizeof(value));
+					ai.archiveData.SetInfoItemValueFloat(key, value);
+				} break;
+				case INFO_VALUE_TYPE_BOOL: {
+					ai.archiveData.SetInfoItemValueBool(key, ir.value != 0);
+				} break;
+				default: {
+				} break;
+			}
+		}
+
+		for (uint32_t j = ar.firstDependency, n = ar.firstDependency + ar.numDependencies; j < n; j++) {
+			ai.archiveData.GetDependencies().emplace_back(strings + dependencyRecords[j]);
+		}
+
+		if (ai.archiveData.IsMap()) {
+			AddDependency(ai.archiveData.GetDependencies(), GetMapHelperContentName());
+		} else if (ai.archiveData.IsGame()) {
+			AddDependency(ai.archiveData.GetDependencies(), GetSpringBaseContentName());
+		}
+	}
+
+	for (uint32_t i = 0; i < header->numBrokenArchives; i++) {
+		const BinaryBrokenArchiveRecord& br = brokenArchiveRecords[i];
+
+		BrokenArchive& ba = GetAddBrokenArchive(strings + br.name);
+		ba.name = strings + br.name;
+		ba.path = strings + br.path;
+		ba.modified = br.modified;
+		ba.updated = false;
+		ba.problem = strings + br.problem;
+	}
+
+	isDirty = false;
+	return true;
+}
+
+void CArchiveScanner::ReadLuaCacheData(const std::string& filename)
 {
 	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
 	if (!FileSystem::FileExists(filename)) {
@@ -1077,12 +1315,6 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 	if (!isDirty)
 		return;
 
-	FILE* out = fopen(filename.c_str(), "wt");
-	if (out == nullptr) {
-		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
-		return;
-	}
-
 	// First delete all outdated information
 	{
 		std::stable_sort(archiveInfos.begin(), archiveInfos.end(), [](const ArchiveInfo& a, const ArchiveInfo& b) { return (a.origName < b.origName); });
@@ -1106,6 +1338,153 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 		}
 	}
 
+	if (!WriteBinaryCacheData(filename))
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+
+	WriteLuaCacheData(GetLuaFilepath());
+
+	isDirty = false;
+}
+
+bool CArchiveScanner::WriteBinaryCacheData(const std::string& filename) const
+{
+	std::vector<BinaryArchiveRecord> archiveRecords;
+	std::vector<BinaryBrokenArchiveRecord> brokenArchiveRecords;
+	std::vector<BinaryInfoItemRecord> infoItemRecords;
+	std::vector<uint32_t> dependencyRecords;
+
+	std::string strings;
+	spring::unordered_map<std::string, uint32_t> stringOffsets;
+
+	const auto AddString = [&](const std::string& str) {
+		const auto iter = stringOffsets.find(str);
+
+		if (iter != stringOffsets.end())
+			return (iter->second);
+
+		const uint32_t offset = strings.size();
+
+		strings.append(str.c_str(), str.size() + 1);
+		stringOffsets.insert(str, offset);
+		return offset;
+	};
+
+	archiveRecords.reserve(archiveInfos.size());
+	brokenArchiveRecords.reserve(brokenArchives.size());
+	infoItemRecords.reserve(archiveInfos.size() * 8);
+	stringOffsets.reserve(archiveInfos.size() * 8);
+
+	for (const ArchiveInfo& arcInfo: archiveInfos) {
+		const ArchiveData& archData = arcInfo.archiveData;
+
+		std::vector<std::string> deps = archData.GetDependencies();
+		if (archData.IsMap()) {
+			FilterDep(deps, GetMapHelperContentName());
+		} else if (archData.IsGame()) {
+			FilterDep(deps, GetSpringBaseContentName());
+		}
+
+		archiveRecords.emplace_back();
+
+		BinaryArchiveRecord& ar = archiveRecords.back();
+
+		ar.name = AddString(arcInfo.origName);
+		ar.path = AddString(arcInfo.path);
+		ar.archiveDataPath = AddString(arcInfo.archiveDataPath);
+		ar.modified = arcInfo.modified;
+		ar.modifiedArchiveData = arcInfo.modifiedArchiveData;
+		ar.firstInfoItem = infoItemRecords.size();
+		ar.numInfoItems = archData.GetInfo().size();
+		ar.firstDependency = dependencyRecords.size();
+		ar.numDependencies = deps.size();
+
+		std::memcpy(ar.checksum, arcInfo.checksum, sha512::SHA_LEN);
+
+		for (const auto& ii: archData.GetInfo()) {
+			BinaryInfoItemRecord ir;
+
+			ir.key = AddString(ii.first);
+			ir.valueType = ii.second.valueType;
+			ir.value = 0;
+
+			switch (ii.second.valueType) {
+				case INFO_VALUE_TYPE_STRING : { ir.value = AddString(ii.second.valueTypeString); } break;
+				case INFO_VALUE_TYPE_INTEGER: { std::memcpy(&ir.value, &ii.second.value.typeInteger, sizeof(ir.value)); } break;
+				case INFO_VALUE_TYPE_FLOAT  : { std::memcpy(&ir.value, &ii.second.value.typeFloat, sizeof(ir.value)); } break;
+				case INFO_VALUE_TYPE_BOOL   : { ir.value = ii.second.value.typeBool; } break;
+				default                     : {                                                          } break;
+			}
+
+			infoItemRecords.push_back(ir);
+		}
+
+		for (const std::string& dep: deps) {
+			dependencyRecords.push_back(AddString(dep));
+		}
+	}
+
+	for (const BrokenArchive& ba: brokenArchives) {
+		brokenArchiveRecords.push_back({AddString(ba.name), AddString(ba.path), AddString(ba.problem), ba.modified});
+	}
+
+	// never empty; the reader relies on a terminated table
+	AddString("");
+
+	BinaryCacheHeader header;
+
+	std::memcpy(header.magic, BINARY_CACHE_MAGIC, sizeof(header.magic));
+
+	header.version = BINARY_CACHE_VERSION;
+	header.internalVer = INTERNAL_VER;
+	header.numArchives = archiveRecords.size();
+	header.numBrokenArchives = brokenArchiveRecords.size();
+	header.numInfoItems = infoItemRecords.size();
+	header.numDependencies = dependencyRecords.size();
+	header.stringTableSize = strings.size();
+	header.padding = 0;
+
+	// other processes (unitsync, other engine instances) may have the old file
+	// mapped or be reading it; only replace it once the new one is complete
+	const std::string tempName = filename + ".tmp";
+
+	FILE* out = fopen(tempName.c_str(), "wb");
+
+	if (out == nullptr)
+		return false;
+
+	bool ret = true;
+
+	ret &= (fwrite(&header, sizeof(header), 1, out) == 1);
+	ret &= (fwrite(archiveRecords.data(), sizeof(BinaryArchiveRecord), archiveRecords.size(), out) == archiveRecords.size());
+	ret &= (fwrite(brokenArchiveRecords.data(), sizeof(BinaryBrokenArchiveRecord), brokenArchiveRecords.size(), out) == brokenArchiveRecords.size());
+	ret &= (fwrite(infoItemRecords.data(), sizeof(BinaryInfoItemRecord), infoItemRecords.size(), out) == infoItemRecords.size());
+	ret &= (fwrite(dependencyRecords.data(), sizeof(uint32_t), dependencyRecords.size(), out) == dependencyRecords.size());
+	ret &= (fwrite(strings.data(), 1, strings.size(), out) == strings.size());
+	ret &= (fclose(out) != EOF);
+
+	if (!ret) {
+		std::remove(tempName.c_str());
+		return false;
+	}
+
+	// rename does not replace existing files on every platform
+	std::remove(filename.c_str());
+
+	if (std::rename(tempName.c_str(), filename.c_str()) != 0) {
+		std::remove(tempName.c_str());
+		return false;
+	}
+
+	return true;
+}
+
+void CArchiveScanner::WriteLuaCacheData(const std::string& filename) const
+{
+	FILE* out = fopen(filename.c_str(), "wt");
+	if (out == nullptr) {
+		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
+		return;
+	}
 
 	fprintf(out, "local archiveCache = {\n\n");
 	fprintf(out, "\tinternalver = %i,\n\n", INTERNAL_VER);
@@ -1181,8 +1560,6 @@ void CArchiveScanner::WriteCacheData(const std::string& filename)
 
 	if (fclose(out) == EOF)
 		LOG_L(L_ERROR, "[AS::%s] failed to write to \"%s\"!", __func__, filename.c_str());
-
-	isDirty = false;
 }
 
 
@@ -1420,10 +1797,18 @@ sha512::raw_digest CArchiveScanner::GetArchiveCompleteChecksumBytes(const std::s
 	sha512::raw_digest checksum;
 	std::fill(checksum.begin(), checksum.end(), 0);
 
+	std::vector<std::string> archivePaths;
+
 	for (const std::string& depName: GetAllArchivesUsedBy(name)) {
 		const std::string& archiveName = ArchiveFromName(depName);
-		const std::string  archivePath = GetArchivePath(archiveName) + archiveName;
 
+		archivePaths.emplace_back(GetArchivePath(archiveName) + archiveName);
+	}
+
+	// hash all dependencies at once rather than one after another below
+	HashArchives(archivePaths);
+
+	for (const std::string& archivePath: archivePaths) {
 		const sha512::raw_digest& archiveChecksum = GetArchiveSingleChecksumBytes(archivePath);
 
 		for (uint8_t i = 0; i < sha512::SHA_LEN; i++) {
@@ -1434,6 +1819,64 @@ sha512::raw_digest CArchiveScanner::GetArchiveCompleteChecksumBytes(const std::s
 	return checksum;
 }
 
+void CArchiveScanner::HashArchives(const std::vector<std::string>& filePaths)
+{
+	std::lock_guard<decltype(scannerMutex)> lck(scannerMutex);
+
+	std::vector<std::pair<std::string, size_t>> hashJobs;
+	std::vector<sha512::raw_digest> checksums;
+	std::vector<uint8_t> hashed;
+
+	hashJobs.reserve(filePaths.size());
+
+	for (const std::string& filePath: filePaths) {
+		// registers (or validates the cached info of) the archive, without hashing it
+		ScanArchive(filePath, false);
+
+		const auto aiIter = archiveInfosIndex.find(StringToLower(FileSystem::GetFilename(filePath)));
+
+		if (aiIter == archiveInfosIndex.end())
+			continue;
+
+		const ArchiveInfo& ai = archiveInfos[aiIter->second];
+
+		// obsoleted or shadowed archives are left to ScanArchive, like any duplicates
+		if (ai.hashed || !ai.replaced.empty() || ai.path != FileSystem::GetDirectory(filePath))
+			continue;
+
+		const auto pred = [&](const std::pair<std::string, size_t>& p) { return (p.second == aiIter->second); };
+
+		if (std::find_if(hashJobs.begin(), hashJobs.end(), pred) != hashJobs.end())
+			continue;
+
+		hashJobs.emplace_back(filePath, aiIter->second);
+	}
+
+	if (hashJobs.empty())
+		return;
+
+	checksums.resize(hashJobs.size());
+	hashed.resize(hashJobs.size(), 0);
+
+	// one job per archive, each of which hashes its files in parallel again; while
+	// one archive waits on disk another is being inflated or hashed. zip archives
+	// are streamed through a fixed-size chunk, so memory use stays bounded by the
+	// number of threads rather than by the size of the archives
+	for_mt(0, hashJobs.size(), [&](const int i) {
+		hashed[i] = GetArchiveChecksum(hashJobs[i].first, checksums[i].data());
+	});
+
+	for (size_t i = 0; i < hashJobs.size(); i++) {
+		ArchiveInfo& ai = archiveInfos[hashJobs[i].second];
+
+		if (!(ai.hashed = (hashed[i] != 0)))
+			continue;
+
+		std::memcpy(ai.checksum, checksums[i].data(), sha512::SHA_LEN);
+		isDirty = true;
+	}
+}
+
 
 void CArchiveScanner::CheckArchive(
 	const std::string& name,
@@ -133,6 +133,8 @@ public:
 	sha512::raw_digest GetArchiveSingleChecksumBytes(const std::string& name);
 	/// calculate checksum of the given archive and all its dependencies
 	sha512::raw_digest GetArchiveCompleteChecksumBytes(const std::string& name);
+	/// compute the checksums of all given archives (full paths) not hashed yet, in parallel
+	void HashArchives(const std::vector<std::string>& filePaths);
 
 	/// first 4 bytes of single checksum (TODO: get rid of this in unitsync)
 	uint32_t GetArchiveSingleChecksum(const std::string& name) { return *reinterpret_cast<const uint32_t*>(&GetArchiveSingleChecksumBytes(name)[0]); }
@@ -145,6 +147,8 @@ public:
 	void ScanAllDirs();
 	void Clear();
 	void Reload();
+	/// like Reload, but keeps the archive infos in memory instead of re-reading the cache
+	void Rescan();
 
 	std::string ArchiveFromName(const std::string& versionedName) const;
 	std::string NameFromArchive(const std::string& archiveName) const;
@@ -202,8 +206,16 @@ private:
 	std::string SearchMapFile(const IArchive* ar, std::string& error);
 
 
-	void ReadCacheData(const std::string& filename);
+	/// binary cache, falls back to the Lua export if there is none yet
+	void ReadCacheData();
+	bool ReadBinaryCacheData(const std::string& filename);
+	void ReadLuaCacheData(const std::string& filename);
+
 	void WriteCacheData(const std::string& filename);
+	bool WriteBinaryCacheData(const std::string& filename) const;
+	void WriteLuaCacheData(const std::string& filename) const;
+
+	std::string GetLuaFilepath() const { return (cachefile.substr(0, cachefile.rfind('.')) + ".lua"); }
 
 	IFileFilter* CreateIgnoreFilter(IArchive* ar);
 
@@ -211,7 +223,7 @@ private:
 	 * Get hash of the data in the specified archive.
 	 * Returns false if file could not be opened.
 	 */
-	bool GetArchiveChecksum(const std::string& filename, ArchiveInfo& archiveInfo);
+	bool GetArchiveChecksum(const std::string& filename, uint8_t checksum[sha512::SHA_LEN]);
 
 	bool CheckCachedData(const std::string& fullName, unsigned& modified, bool doChecksum);
 
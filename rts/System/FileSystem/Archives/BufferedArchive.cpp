@@ -3,15 +3,31 @@
 #include "BufferedArchive.h"
 #include "System/GlobalConfig.h"
 #include "System/MainDefines.h"
+#include "System/MemoryStats.h"
 #include "System/Log/ILog.h"
+#include "System/Threading/ThreadPool.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 
-spring::mutex CBufferedArchive::archiveLock;
+
+// summed over all open archives
+static std::atomic<std::uint64_t> totalCacheSize = {0};
+static MemoryStats::Registrar archiveCacheStats("FileSystem::ArchiveCache", []() { return MemoryStats::Usage{totalCacheSize.load(), 0}; });
 
 
 CBufferedArchive::~CBufferedArchive()
 {
+	totalCacheSize -= cacheSize;
+
+	if (numPrefetched > 0) {
+		const uint32_t numReads = numPrefetchHits + numCacheMisses;
+		const float hitRate = (numReads > 0)? (numPrefetchHits * 100.0f) / numReads: 0.0f;
+
+		LOG_L(L_INFO, "[%s][name=%s] %u files prefetched, %u reads served by prefetch and %u by disk (hit-rate %.1f%%)", __func__, archiveFile.c_str(), numPrefetched, numPrefetchHits, numCacheMisses, hitRate);
+	}
+
 	// filter archives for which only {map,mod}info.lua was accessed
 	if (cacheSize <= 1 || fileCount <= 1)
 		return;
@@ -53,6 +69,11 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 
 		cacheSize += fb.data.size();
 		fileCount += fb.exists;
+		totalCacheSize += fb.data.size();
+		numCacheMisses += 1;
+	} else if (fb.prefetched) {
+		fb.prefetched = false;
+		numPrefetchHits += 1;
 	}
 
 	if (!fb.exists) {
@@ -67,3 +88,70 @@ bool CBufferedArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buff
 	std::copy(fb.data.begin(), fb.data.end(), buffer.begin());
 	return true;
 }
+
+void CBufferedArchive::Prefetch(const std::vector<unsigned int>& fids)
+{
+	// nothing would be kept around
+	if (noCache || !globalConfig.vfsCacheArchiveFiles)
+		return;
+
+	std::vector<unsigned int> pendingIDs;
+	std::vector<FileBuffer> fileBuffers;
+
+	{
+		std::lock_guard<spring::mutex> lck(archiveLock);
+
+		if (fileCache.empty())
+			fileCache.resize(NumFiles());
+
+		pendingIDs.reserve(fids.size());
+
+		for (const unsigned int fid: fids) {
+			if (!IsFileId(fid) || fileCache[fid].populated)
+				continue;
+
+			pendingIDs.push_back(fid);
+		}
+	}
+
+	// archive order is (mostly) on-disk order, keeps the reads sequential
+	std::sort(pendingIDs.begin(), pendingIDs.end());
+	pendingIDs.erase(std::unique(pendingIDs.begin(), pendingIDs.end()), pendingIDs.end());
+
+	if (pendingIDs.empty())
+		return;
+
+	fileBuffers.resize(pendingIDs.size());
+
+	if (HasConcurrentFileImpl()) {
+		// many small files; parallel reads let the OS reorder the seeks
+		for_mt(0, pendingIDs.size(), [&](const int i) {
+			fileBuffers[i].exists = (GetFileImpl(pendingIDs[i], fileBuffers[i].data) == 1);
+		});
+	} else {
+		std::lock_guard<spring::mutex> lck(archiveLock);
+
+		for (size_t i = 0; i < pendingIDs.size(); i++) {
+			fileBuffers[i].exists = (GetFileImpl(pendingIDs[i], fileBuffers[i].data) == 1);
+		}
+	}
+
+	std::lock_guard<spring::mutex> lck(archiveLock);
+
+	for (size_t i = 0; i < pendingIDs.size(); i++) {
+		FileBuffer& fb = fileCache[pendingIDs[i]];
+
+		// read by GetFile in the meantime
+		if (fb.populated)
+			continue;
+
+		fb = std::move(fileBuffers[i]);
+		fb.populated = true;
+		fb.prefetched = true;
+
+		cacheSize += fb.data.size();
+		fileCount += fb.exists;
+		totalCacheSize += fb.data.size();
+		numPrefetched += 1;
+	}
+}
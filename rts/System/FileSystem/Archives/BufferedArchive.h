@@ -23,8 +23,12 @@ public:
 
 	bool GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
 
+	void Prefetch(const std::vector<unsigned int>& fids) override;
+
 protected:
 	virtual int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) = 0;
+	/// true if GetFileImpl can run for different files at the same time
+	virtual bool HasConcurrentFileImpl() const { return false; }
 
 	struct FileBuffer {
 		FileBuffer() = default;
@@ -36,22 +40,28 @@ protected:
 
 		bool populated = false; // files may be empty (0 bytes)
 		bool exists = false;
+		bool prefetched = false; // not yet requested through GetFile
 
 		std::vector<std::uint8_t> data;
 	};
 
 	// indexed by file-id
 	std::vector<FileBuffer> fileCache;
-	// neither 7zip (.sd7) nor minizip (.sdz) are thread-safe
+	// neither 7zip (.sd7) nor minizip (.sdz) handles are thread-safe
 	// zlib (used to extract pool archive .gz entries) should
 	// not need this, but currently each buffered GetFileImpl
-	// call is protected
-	static spring::mutex archiveLock;
+	// call is protected; handles are per archive so different
+	// archives can be extracted (e.g. hashed) concurrently
+	spring::mutex archiveLock;
 
 private:
 	uint32_t cacheSize = 0;
 	uint32_t fileCount = 0;
 
+	uint32_t numPrefetched = 0;
+	uint32_t numPrefetchHits = 0;
+	uint32_t numCacheMisses = 0;
+
 	bool noCache = false;
 };
 
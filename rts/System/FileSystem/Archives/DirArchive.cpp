@@ -63,6 +63,21 @@ bool CDirArchive::GetFile(unsigned int fid, std::vector<std::uint8_t>& buffer)
 	return true;
 }
 
+bool CDirArchive::MapFile(unsigned int fid, MappedFileView& view)
+{
+	assert(IsFileId(fid));
+
+	std::shared_ptr<CMappedFile> file = std::make_shared<CMappedFile>();
+
+	if (!file->Open(dataDirsAccess.LocateFile(dirName + searchFiles[fid])))
+		return false;
+
+	view.data = file->GetData();
+	view.size = file->GetSize();
+	view.file = std::move(file);
+	return true;
+}
+
 void CDirArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 {
 	assert(IsFileId(fid));
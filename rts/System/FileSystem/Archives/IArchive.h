@@ -8,6 +8,7 @@
 #include <cinttypes>
 
 #include "ArchiveTypes.h"
+#include "System/FileSystem/MappedFile.h"
 #include "System/Sync/SHA512.hpp"
 #include "System/UnorderedMap.hpp"
 
@@ -126,6 +127,23 @@ public:
 	 */
 	virtual bool CalcHash(uint32_t fid, uint8_t hash[sha512::SHA_LEN], std::vector<std::uint8_t>& fb);
 
+	/**
+	 * Reads the given files ahead of a load phase that will need them, so
+	 * later GetFile calls are served from memory. Archives which do not
+	 * keep file contents around ignore this.
+	 * @param fids file IDs in [0, NumFiles()), invalid IDs are skipped
+	 */
+	virtual void Prefetch(const std::vector<unsigned int>& fids) {}
+
+	/**
+	 * Maps the content of a file by its ID without copying it, which only
+	 * works for entries stored uncompressed (and not empty); callers fall
+	 * back to GetFile otherwise.
+	 * @param view on success, refers to the read-only file content
+	 * @return true if the file could be mapped
+	 */
+	virtual bool MapFile(unsigned int fid, MappedFileView& view) { return false; }
+
 
 protected:
 	// Spring expects the contents of archives to be case-independent
@@ -103,6 +103,8 @@ public:
 
 protected:
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
+	// every entry is a separate .gz file in the pool
+	bool HasConcurrentFileImpl() const override { return true; }
 
 	std::pair<uint64_t, uint64_t> GetSums() const {
 		std::pair<uint64_t, uint64_t> p;
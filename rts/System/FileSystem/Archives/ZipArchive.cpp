@@ -81,6 +81,95 @@ void CZipArchive::FileInfo(unsigned int fid, std::string& name, int& size) const
 }
 
 
+bool CZipArchive::CalcHash(uint32_t fid, uint8_t hash[sha512::SHA_LEN], std::vector<std::uint8_t>& fb)
+{
+	// large enough to keep zlib busy, small enough to hash many archives at once
+	constexpr size_t HASH_CHUNK_SIZE = 1024 * 1024;
+
+	std::lock_guard<spring::mutex> lck(archiveLock);
+	assert(IsFileId(fid));
+
+	if (zip == nullptr)
+		return false;
+
+	unzGoToFilePos(zip, &fileEntries[fid].fp);
+
+	unz_file_info fi;
+	unzGetCurrentFileInfo(zip, &fi, nullptr, 0, nullptr, 0, nullptr, 0);
+
+	// empty files have no hash, same as IArchive::CalcHash
+	if (fi.uncompressed_size == 0)
+		return false;
+
+	if (unzOpenCurrentFile(zip) != UNZ_OK)
+		return false;
+
+	fb.resize(std::min(size_t(fi.uncompressed_size), HASH_CHUNK_SIZE));
+
+	sha512::calc_state ctx;
+	sha512::init_digest(ctx);
+
+	size_t numRead = 0;
+	int ret = 0;
+
+	while ((ret = unzReadCurrentFile(zip, fb.data(), fb.size())) > 0) {
+		sha512::update_digest(ctx, fb.data(), ret);
+		numRead += ret;
+	}
+
+	// read errors and CRC mismatches fail like GetFileImpl does
+	if (unzCloseCurrentFile(zip) == UNZ_CRCERROR || ret < 0 || numRead != fi.uncompressed_size)
+		return false;
+
+	sha512::final_digest(ctx, hash);
+	return true;
+}
+
+
+bool CZipArchive::MapFile(unsigned int fid, MappedFileView& view)
+{
+	std::lock_guard<spring::mutex> lck(archiveLock);
+	assert(IsFileId(fid));
+
+	if (zip == nullptr)
+		return false;
+
+	unzGoToFilePos(zip, &fileEntries[fid].fp);
+
+	unz_file_info fi;
+	unzGetCurrentFileInfo(zip, &fi, nullptr, 0, nullptr, 0, nullptr, 0);
+
+	// only stored, unencrypted entries exist verbatim in the archive
+	if (fi.compression_method != 0 || (fi.flag & 1) != 0 || fi.uncompressed_size == 0 || fi.compressed_size != fi.uncompressed_size)
+		return false;
+
+	// opening the entry skips its local header, which has a variable size
+	if (unzOpenCurrentFile(zip) != UNZ_OK)
+		return false;
+
+	const uint64_t dataOffset = unzGetCurrentFileZStreamPos64(zip);
+
+	unzCloseCurrentFile(zip);
+
+	if (zipMapping == nullptr) {
+		zipMapping = std::make_shared<CMappedFile>();
+
+		if (!zipMapping->Open(archiveFile)) {
+			LOG_L(L_WARNING, "[ZipArchive::%s] could not map \"%s\"", __func__, archiveFile.c_str());
+			return false;
+		}
+	}
+
+	if (!zipMapping->IsOpen() || (dataOffset + fi.uncompressed_size) > zipMapping->GetSize())
+		return false;
+
+	view.file = zipMapping;
+	view.data = zipMapping->GetData() + dataOffset;
+	view.size = fi.uncompressed_size;
+	return true;
+}
+
+
 // To simplify things, files are always read completely into memory from
 // the zip-file, since zlib does not provide any way of reading more
 // than one file at a time
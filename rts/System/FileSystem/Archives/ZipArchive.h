@@ -7,6 +7,7 @@
 #include "BufferedArchive.h"
 #include "minizip/unzip.h"
 
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -40,6 +41,11 @@ public:
 	unsigned int NumFiles() const override { return (fileEntries.size()); }
 	void FileInfo(unsigned int fid, std::string& name, int& size) const override;
 
+	/// hashes the file while inflating it, <fb> only holds one chunk at a time
+	bool CalcHash(uint32_t fid, uint8_t hash[sha512::SHA_LEN], std::vector<std::uint8_t>& fb) override;
+	/// stored (uncompressed) entries are served straight from a mapping of the archive
+	bool MapFile(unsigned int fid, MappedFileView& view) override;
+
 	#if 0
 	unsigned int GetCrc32(unsigned int fid) {
 		assert(IsFileId(fid));
@@ -60,6 +66,9 @@ protected:
 
 	std::vector<FileEntry> fileEntries;
 
+	// created by the first MapFile call
+	std::shared_ptr<CMappedFile> zipMapping;
+
 	int GetFileImpl(unsigned int fid, std::vector<std::uint8_t>& buffer) override;
 };
 
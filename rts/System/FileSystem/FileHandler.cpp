@@ -73,6 +73,20 @@ bool CFileHandler::TryReadFromRawFS(const string& fileName)
 {
 #ifndef TOOLS
 	const string rawpath = dataDirsAccess.LocateFile(fileName);
+
+	if (allowMapping) {
+		std::shared_ptr<CMappedFile> file = std::make_shared<CMappedFile>();
+
+		if (file->Open(rawpath)) {
+			fileMapping.data = file->GetData();
+			fileMapping.size = file->GetSize();
+			fileMapping.file = std::move(file);
+
+			fileSize = fileMapping.size;
+			return true;
+		}
+	}
+
 	ifs.open(rawpath.c_str(), std::ios::in | std::ios::binary);
 	if (ifs && !ifs.bad() && ifs.is_open()) {
 		ifs.seekg(0, std::ios_base::end);
@@ -92,6 +106,11 @@ bool CFileHandler::TryReadFromVFS(const string& fileName, int section)
 	if (vfsHandler == nullptr)
 		return (loadCode = -2, false);
 
+	if (allowMapping && (loadCode = vfsHandler->MapFile(StringToLower(fileName), fileMapping, (CVFSHandler::Section) section)) == 1) {
+		fileSize = fileMapping.size;
+		return true;
+	}
+
 	if ((loadCode = vfsHandler->LoadFile(StringToLower(fileName), fileBuffer, (CVFSHandler::Section) section)) == 1) {
 		// capacity can exceed size if FH was used to open more than one file
 		// assert(fileBuffer.size() == fileBuffer.capacity());
@@ -122,6 +141,13 @@ void CFileHandler::Open(const string& fileName, const string& modes)
 	}
 }
 
+void CFileHandler::OpenMapped(const string& fileName, const string& modes)
+{
+	allowMapping = true;
+	Open(fileName, modes);
+	allowMapping = false;
+}
+
 void CFileHandler::Close()
 {
 	filePos = 0;
@@ -130,6 +156,7 @@ void CFileHandler::Close()
 
 	ifs.close();
 	fileBuffer.clear();
+	fileMapping.Reset();
 }
 
 
@@ -173,15 +200,15 @@ int CFileHandler::Read(void* buf, int length)
 		return ifs.gcount();
 	}
 
-	if (fileBuffer.empty())
+	if (!HaveFileData())
 		return 0;
 
 	if ((length + filePos) > fileSize)
 		length = fileSize - filePos;
 
 	if (length > 0) {
-		assert(fileBuffer.size() >= (filePos + length));
-		memcpy(buf, &fileBuffer[filePos], length);
+		assert(fileSize >= (filePos + length));
+		memcpy(buf, GetFileData() + filePos, length);
 		filePos += length;
 	}
 
@@ -218,7 +245,7 @@ void CFileHandler::Seek(int length, std::ios_base::seekdir where)
 		ifs.seekg(length, where);
 		return;
 	}
-	if (fileBuffer.empty())
+	if (!HaveFileData())
 		return;
 
 	switch (where) {
@@ -234,7 +261,7 @@ bool CFileHandler::Eof() const
 	if (ifs.is_open())
 		return ifs.eof();
 
-	if (!fileBuffer.empty())
+	if (HaveFileData())
 		return (filePos >= fileSize);
 
 	return true;
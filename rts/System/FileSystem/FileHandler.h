@@ -8,6 +8,7 @@
 #include <fstream>
 #include <cinttypes>
 
+#include "MappedFile.h"
 #include "VFSModes.h"
 
 /**
@@ -27,6 +28,8 @@ public:
 	virtual ~CFileHandler() { Close(); }
 
 	void Open(const std::string& fileName, const std::string& modes = SPRING_VFS_RAW_FIRST);
+	/// like Open, but maps uncompressed (archive or raw) files instead of copying them
+	void OpenMapped(const std::string& fileName, const std::string& modes = SPRING_VFS_RAW_FIRST);
 	void Close();
 
 	int Read(void* buf, int length);
@@ -38,6 +41,8 @@ public:
 	bool FileExists() const { return (fileSize >= 0); }
 	// true if (and only if) TryReadFromVFS succeeds
 	bool IsBuffered() const { return (!fileBuffer.empty()); }
+	// true if the file was opened through OpenMapped and could be mapped
+	bool IsMapped() const { return (fileMapping.IsValid()); }
 
 	bool Eof() const;
 	int GetPos();
@@ -50,6 +55,7 @@ public:
 	static std::string GetArchiveContainingFile(const std::string& filePath, const std::string& modes);
 
 	std::vector<std::uint8_t>& GetBuffer() { return fileBuffer; }
+	const std::uint8_t* GetMappedData() const { return fileMapping.data; }
 
 	static bool InReadDir(const std::string& path);
 	static bool InWriteDir(const std::string& path);
@@ -69,6 +75,10 @@ protected:
 	virtual bool TryReadFromRawFS(const std::string& fileName);
 	virtual bool TryReadFromVFS(const std::string& fileName, int section);
 
+	// file contents loaded into memory, if any
+	const std::uint8_t* GetFileData() const { return (fileMapping.IsValid()? fileMapping.data: fileBuffer.data()); }
+	bool HaveFileData() const { return (fileMapping.IsValid() || !fileBuffer.empty()); }
+
 	static bool InsertRawFiles(std::vector<std::string>& fileSet, const std::string& path, const std::string& pattern);
 	static bool InsertVFSFiles(std::vector<std::string>& fileSet, const std::string& path, const std::string& pattern, int section);
 
@@ -78,10 +88,13 @@ protected:
 	std::string fileName;
 	std::ifstream ifs;
 	std::vector<std::uint8_t> fileBuffer;
+	MappedFileView fileMapping;
 
 	int filePos = 0;
 	int fileSize = -1;
 	int loadCode = -3; // {-1,0,1} if loaded from VFS
+
+	bool allowMapping = false;
 };
 
 #endif // _FILE_HANDLER_H
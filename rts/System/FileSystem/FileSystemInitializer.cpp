@@ -108,6 +108,20 @@ void FileSystemInitializer::Cleanup(bool deallocConfigHandler)
 	}
 }
 
+bool FileSystemInitializer::Rescan()
+{
+	if (!initSuccess)
+		return false;
+
+	// data-dirs were (re)located by PreInitializeConfigHandler
+	dataDirLocater.Check();
+	archiveScanner->Rescan();
+
+	CVFSHandler::FreeGlobalInstance();
+	CVFSHandler::SetGlobalInstance(new CVFSHandler("SpringVFS"));
+	return true;
+}
+
 void FileSystemInitializer::Reload()
 {
 	// repopulated by PreGame, etc
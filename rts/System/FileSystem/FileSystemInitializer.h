@@ -15,6 +15,8 @@ public:
 	static void InitializeThr(bool* retPtr) { *retPtr = Initialize(); }
 	static void Cleanup(bool deallocConfigHandler = true);
 	static void Reload();
+	/// rescans the data-dirs for new, modified or removed archives and resets the VFS
+	static bool Rescan();
 
 	// either result counts
 	static bool Initialized() { return (initSuccess || initFailure); }
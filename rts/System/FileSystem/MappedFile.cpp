@@ -0,0 +1,119 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "MappedFile.h"
+
+
+#ifndef _WIN32
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#else
+	#include <windows.h>
+#endif
+
+
+CMappedFile& CMappedFile::operator = (CMappedFile&& f)
+{
+	if (this == &f)
+		return *this;
+
+	Close();
+
+	std::swap(fileData, f.fileData);
+	std::swap(fileSize, f.fileSize);
+
+	#ifdef _WIN32
+	std::swap(fileHandle, f.fileHandle);
+	std::swap(mappingHandle, f.mappingHandle);
+	#endif
+	return *this;
+}
+
+
+bool CMappedFile::Open(const std::string& filePath)
+{
+	Close();
+
+	#ifndef _WIN32
+	const int fd = open(filePath.c_str(), O_RDONLY);
+
+	if (fd == -1)
+		return false;
+
+	struct stat info;
+
+	if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+		close(fd);
+		return false;
+	}
+
+	// MAP_PRIVATE: pages stay shared until written, the file is never modified
+	void* data = mmap(nullptr, info.st_size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+
+	// the mapping keeps its own reference to the file
+	close(fd);
+
+	if (data == MAP_FAILED)
+		return false;
+
+	fileData = reinterpret_cast<std::uint8_t*>(data);
+	fileSize = info.st_size;
+
+	#else
+
+	HANDLE file = CreateFileA(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE)
+		return false;
+
+	LARGE_INTEGER size;
+
+	if (!GetFileSizeEx(file, &size) || size.QuadPart <= 0) {
+		CloseHandle(file);
+		return false;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		return false;
+	}
+
+	void* data = MapViewOfFile(mapping, FILE_MAP_COPY, 0, 0, 0);
+
+	if (data == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		return false;
+	}
+
+	fileHandle = file;
+	mappingHandle = mapping;
+	fileData = reinterpret_cast<std::uint8_t*>(data);
+	fileSize = size.QuadPart;
+	#endif
+
+	return true;
+}
+
+void CMappedFile::Close()
+{
+	if (fileData == nullptr)
+		return;
+
+	#ifndef _WIN32
+	munmap(fileData, fileSize);
+	#else
+	UnmapViewOfFile(fileData);
+	CloseHandle(mappingHandle);
+	CloseHandle(fileHandle);
+
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+	#endif
+
+	fileData = nullptr;
+	fileSize = 0;
+}
@@ -0,0 +1,70 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _MAPPED_FILE_H
+#define _MAPPED_FILE_H
+
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <utility>
+
+/**
+ * Maps a file from the raw filesystem into memory (copy-on-write).
+ * Pages are loaded lazily and shared with every other process that
+ * maps the same file until they are written to; writes never reach
+ * the file on disk.
+ */
+class CMappedFile
+{
+public:
+	CMappedFile() = default;
+	CMappedFile(const CMappedFile&) = delete;
+	CMappedFile(CMappedFile&& f) { *this = std::move(f); }
+	~CMappedFile() { Close(); }
+
+	CMappedFile& operator = (const CMappedFile&) = delete;
+	CMappedFile& operator = (CMappedFile&& f);
+
+	/// @param filePath absolute path, e.g. from DataDirsAccess::LocateFile
+	bool Open(const std::string& filePath);
+	void Close();
+
+	bool IsOpen() const { return (fileData != nullptr); }
+
+	      std::uint8_t* GetData()       { return fileData; }
+	const std::uint8_t* GetData() const { return fileData; }
+
+	std::uint64_t GetSize() const { return fileSize; }
+
+private:
+	std::uint8_t* fileData = nullptr;
+	std::uint64_t fileSize = 0;
+
+	#ifdef _WIN32
+	void* fileHandle = nullptr;
+	void* mappingHandle = nullptr;
+	#endif
+};
+
+
+/**
+ * Read-only view of (part of) a mapped file, e.g. an uncompressed archive
+ * entry. The mapping stays alive for as long as any view references it.
+ */
+struct MappedFileView
+{
+	bool IsValid() const { return (file != nullptr); }
+
+	void Reset() {
+		file.reset();
+		data = nullptr;
+		size = 0;
+	}
+
+	std::shared_ptr<const CMappedFile> file;
+
+	const std::uint8_t* data = nullptr;
+	std::uint64_t size = 0;
+};
+
+#endif // _MAPPED_FILE_H
@@ -9,9 +9,11 @@
 #include "ArchiveLoader.h"
 #include "ArchiveScanner.h"
 #include "FileSystem.h"
+#include "VFSTrace.h"
 #include "System/FileSystem/Archives/IArchive.h"
 #include "System/FileSystem/Archives/DirArchive.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 #include "System/Exceptions.h"
 #include "System/Log/ILog.h"
 #include "System/SafeUtil.h"
@@ -454,8 +456,38 @@ int CVFSHandler::LoadFile(const std::string& filePath, std::vector<std::uint8_t>
 	if (fileData.ar == nullptr)
 		return -1;
 
+	if (!VFSTrace::IsActive())
+		return (fileData.ar->GetFile(normalizedPath, buffer));
+
+	const float beginTime = VFSTrace::GetTime();
 	// 0 or 1
-	return (fileData.ar->GetFile(normalizedPath, buffer));
+	const int ret = fileData.ar->GetFile(normalizedPath, buffer);
+
+	VFSTrace::AddRead(fileData.ar->GetArchiveFile(), normalizedPath, section, buffer.size(), beginTime, VFSTrace::GetTime() - beginTime, false);
+	return ret;
+}
+
+int CVFSHandler::MapFile(const std::string& filePath, MappedFileView& view, Section section)
+{
+	LOG_L(L_DEBUG, "[%s::%s<this=%p>(filePath=\"%s\", section=%d)]", vfsName, __func__, this, filePath.c_str(), section);
+
+	const std::string& normalizedPath = GetNormalizedPath(filePath);
+	const FileData& fileData = GetFileData(normalizedPath, section);
+
+	if (fileData.ar == nullptr)
+		return -1;
+
+	if (!VFSTrace::IsActive())
+		return (fileData.ar->MapFile(fileData.ar->FindFile(normalizedPath), view));
+
+	const float beginTime = VFSTrace::GetTime();
+	// 0 or 1; a failed mapping is followed by a traced LoadFile
+	const int ret = fileData.ar->MapFile(fileData.ar->FindFile(normalizedPath), view);
+
+	if (ret == 1)
+		VFSTrace::AddRead(fileData.ar->GetArchiveFile(), normalizedPath, section, fileData.size, beginTime, VFSTrace::GetTime() - beginTime, true);
+
+	return ret;
 }
 
 int CVFSHandler::FileExists(const std::string& filePath, Section section)
@@ -630,3 +662,58 @@ std::vector<std::string> CVFSHandler::GetDirsInDir(const std::string& rawDir, Se
 	return dirs;
 }
 
+
+void CVFSHandler::PrefetchFiles(const std::vector<std::string>& filePaths, Section section)
+{
+	// also keeps the archives from being removed while they are read
+	std::lock_guard<decltype(vfsMutex)> lck(vfsMutex);
+
+	assert(section < Section::Count);
+
+	std::vector< std::pair<IArchive*, std::vector<unsigned int>> > archiveFiles;
+
+	const auto AddFile = [&](const FileEntry& entry) {
+		const auto pred = [&](const std::pair<IArchive*, std::vector<unsigned int>>& p) { return (p.first == entry.second.ar); };
+		const auto iter = std::find_if(archiveFiles.begin(), archiveFiles.end(), pred);
+
+		if (iter == archiveFiles.end()) {
+			archiveFiles.emplace_back(entry.second.ar, std::vector<unsigned int>{});
+			archiveFiles.back().second.push_back(entry.second.ar->FindFile(entry.first));
+			return;
+		}
+
+		iter->second.push_back(iter->first->FindFile(entry.first));
+	};
+
+	const auto filesPred = [](const FileEntry& a, const FileEntry& b) { return (a.first < b.first); };
+	const auto& filesVec = files[section];
+
+	for (const std::string& filePath: filePaths) {
+		std::string path = std::move(GetNormalizedPath(filePath));
+
+		if (path.empty())
+			continue;
+
+		if (path.back() != '/') {
+			const auto iter = std::lower_bound(filesVec.begin(), filesVec.end(), FileEntry{path, FileData{}}, filesPred);
+
+			if (iter != filesVec.end() && iter->first == path)
+				AddFile(*iter);
+
+			continue;
+		}
+
+		// entire subtree; turn '/' into '0' for the end of the range
+		const auto filesBeg = std::lower_bound(filesVec.begin(), filesVec.end(), FileEntry{path, FileData{}}, filesPred); path.back() += 1;
+		const auto filesEnd = std::upper_bound(filesVec.begin(), filesVec.end(), FileEntry{path, FileData{}}, filesPred); path.back() -= 1;
+
+		std::for_each(filesBeg, filesEnd, AddFile);
+	}
+
+	LOG_L(L_DEBUG, "[%s::%s<this=%p>] %u paths in %u archives", vfsName, __func__, this, unsigned(filePaths.size()), unsigned(archiveFiles.size()));
+
+	for_mt(0, archiveFiles.size(), [&](const int i) {
+		archiveFiles[i].first->Prefetch(archiveFiles[i].second);
+	});
+}
+
@@ -8,6 +8,7 @@
 #include <vector>
 #include <cinttypes>
 
+#include "MappedFile.h"
 #include "System/UnorderedMap.hpp"
 
 class IArchive;
@@ -103,6 +104,15 @@ public:
 	 * @return 1 if the file exists in the VFS and was successfully read
 	 */
 	int LoadFile(const std::string& filePath, std::vector<std::uint8_t>& buffer, Section section);
+	/**
+	 * Maps the contents of a file from within the VFS without copying them,
+	 * if the archive containing it stores it uncompressed.
+	 * @param filePath raw file path, for example "maps/myMap.smf",
+	 *   case-insensitive
+	 * @return 1 if the file exists in the VFS and was mapped, 0 if it
+	 *   exists but can not be mapped (use LoadFile), -1 otherwise
+	 */
+	int MapFile(const std::string& filePath, MappedFileView& view, Section section);
 
 
 	/**
@@ -121,6 +131,14 @@ public:
 	 */
 	std::vector<std::string> GetDirsInDir(const std::string& dir, Section section);
 
+	/**
+	 * Reads files a load phase is about to need into the archive caches,
+	 * in parallel across archives (and within pool archives).
+	 * @param filePaths raw file paths, case-insensitive; paths ending with
+	 *   a '/' select everything below that directory, e.g. "gamedata/"
+	 */
+	void PrefetchFiles(const std::vector<std::string>& filePaths, Section section);
+
 
 	bool HasTempArchive(const std::string& archiveName) const { return (HasArchive(archiveName, GetTempArchiveSection(archiveName))); }
 
@@ -0,0 +1,239 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "VFSTrace.h"
+
+#include "DataDirsAccess.h"
+#include "FileQueryFlags.h"
+#include "FileSystem.h"
+#include "VFSHandler.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+
+namespace VFSTrace {
+	struct Read {
+		const char* phase;
+
+		std::string archive;
+		std::string file;
+
+		size_t numBytes;
+
+		float beginTime;
+		float readTime;
+
+		int section;
+		int threadNum;
+		bool mapped;
+	};
+
+	struct ReplayPhase {
+		std::string name;
+		std::vector<std::string> files[CVFSHandler::Section::Count];
+	};
+
+
+	static spring::mutex readsMutex;
+	static spring_time startTime;
+
+	static std::atomic<bool> active = {false};
+	static std::atomic<const char*> curPhase = {""};
+
+	static std::string traceFileName;
+	static std::vector<Read> reads;
+	static std::vector<ReplayPhase> replayPhases;
+
+
+	static void LoadReplay(const std::string& fileName)
+	{
+		std::ifstream file(dataDirsAccess.LocateFile(fileName));
+		std::string line;
+
+		if (!file.is_open()) {
+			LOG("[VFSTrace] no trace to replay in \"%s\"", fileName.c_str());
+			return;
+		}
+
+		unsigned int numFiles = 0;
+
+		while (std::getline(file, line)) {
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			// phase, section, archive, file, bytes, begin, duration, thread, mapped
+			std::vector<std::string> fields;
+			std::istringstream lineStream(line);
+			std::string field;
+
+			while (std::getline(lineStream, field, '\t')) {
+				fields.push_back(std::move(field));
+			}
+
+			if (fields.size() != 9)
+				continue;
+
+			const int section = std::atoi(fields[1].c_str());
+
+			// mapped files are read in place, a prefetch would only copy them
+			if (section < 0 || section >= CVFSHandler::Section::Count || fields[8] != "0")
+				continue;
+
+			const auto pred = [&](const ReplayPhase& p) { return (p.name == fields[0]); };
+			const auto iter = std::find_if(replayPhases.begin(), replayPhases.end(), pred);
+
+			const size_t phaseIdx = iter - replayPhases.begin();
+
+			if (phaseIdx == replayPhases.size())
+				replayPhases.emplace_back().name = fields[0];
+
+			ReplayPhase& phase = replayPhases[phaseIdx];
+			std::vector<std::string>& files = phase.files[section];
+
+			if (std::find(files.begin(), files.end(), fields[3]) != files.end())
+				continue;
+
+			files.push_back(std::move(fields[3]));
+			numFiles += 1;
+		}
+
+		LOG("[VFSTrace] replaying %u files in %u phases from \"%s\"", numFiles, unsigned(replayPhases.size()), fileName.c_str());
+	}
+
+	static void SaveTrace(const std::string& fileName)
+	{
+		FileSystem::CreateDirectory(FileSystem::GetDirectory(fileName));
+
+		const std::string filePath = dataDirsAccess.LocateFile(fileName, FileQueryFlags::WRITE);
+		const std::string tempPath = filePath + ".tmp";
+
+		size_t numBytes = 0;
+		float readTime = 0.0f;
+
+		{
+			std::ofstream file(tempPath, std::ios::out | std::ios::trunc);
+
+			if (!file.is_open())
+				return;
+
+			file << "# phase\tsection\tarchive\tfile\tbytes\tbegin(ms)\tduration(ms)\tthread\tmapped\n";
+
+			for (const Read& r: reads) {
+				file << r.phase << '\t' << r.section << '\t' << r.archive << '\t' << r.file << '\t' << r.numBytes << '\t';
+				file << r.beginTime << '\t' << r.readTime << '\t' << r.threadNum << '\t' << r.mapped << '\n';
+
+				numBytes += r.numBytes;
+				readTime += r.readTime;
+			}
+
+			if (!file.good()) {
+				file.close();
+				std::remove(tempPath.c_str());
+				return;
+			}
+		}
+
+		std::remove(filePath.c_str());
+
+		if (std::rename(tempPath.c_str(), filePath.c_str()) != 0) {
+			std::remove(tempPath.c_str());
+			return;
+		}
+
+		LOG("[VFSTrace] %u reads (%.1fMB in %.1fms) written to \"%s\"", unsigned(reads.size()), numBytes / (1024.0f * 1024.0f), readTime, fileName.c_str());
+	}
+
+
+	void Start(const std::string& fileName, int mode)
+	{
+		Stop();
+
+		if (mode == MODE_OFF)
+			return;
+
+		{
+			std::lock_guard<spring::mutex> lck(readsMutex);
+
+			traceFileName = fileName;
+			startTime = spring_now();
+
+			reads.clear();
+			replayPhases.clear();
+
+			if (mode == MODE_REPLAY)
+				LoadReplay(fileName);
+		}
+
+		curPhase = "";
+		active = true;
+	}
+
+	void Stop()
+	{
+		if (!active.exchange(false))
+			return;
+
+		std::lock_guard<spring::mutex> lck(readsMutex);
+
+		SaveTrace(traceFileName);
+
+		reads.clear();
+		replayPhases.clear();
+	}
+
+	bool IsActive() { return active; }
+
+	float GetTime() { return ((spring_now() - startTime).toMilliSecsf()); }
+
+
+	void SetPhase(const char* phase)
+	{
+		if (!active)
+			return;
+
+		curPhase = phase;
+
+		ReplayPhase replayPhase;
+
+		{
+			std::lock_guard<spring::mutex> lck(readsMutex);
+
+			const auto pred = [&](const ReplayPhase& p) { return (p.name == phase); };
+			const auto iter = std::find_if(replayPhases.begin(), replayPhases.end(), pred);
+
+			if (iter == replayPhases.end())
+				return;
+
+			// each phase is replayed only once
+			replayPhase = std::move(*iter);
+			replayPhases.erase(iter);
+		}
+
+		// not under readsMutex, loads on other threads keep being traced meanwhile
+		for (int section = 0; section < CVFSHandler::Section::Count; section++) {
+			if (replayPhase.files[section].empty())
+				continue;
+
+			vfsHandler->PrefetchFiles(replayPhase.files[section], CVFSHandler::Section(section));
+		}
+	}
+
+	void AddRead(const std::string& archiveFile, const std::string& filePath, int section, size_t numBytes, float beginTime, float readTime, bool mapped)
+	{
+		if (!active)
+			return;
+
+		std::lock_guard<spring::mutex> lck(readsMutex);
+		reads.push_back({curPhase, FileSystem::GetFilename(archiveFile), filePath, numBytes, beginTime, readTime, section, ThreadPool::GetThreadNum(), mapped});
+	}
+}
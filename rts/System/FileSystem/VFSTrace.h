@@ -0,0 +1,39 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _VFS_TRACE_H
+#define _VFS_TRACE_H
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Records which VFS files are read while loading
+ * Every CVFSHandler::LoadFile and ::MapFile call made while a trace is
+ * active is logged with the load phase it happened in, the archive and
+ * section it was served from, its size, when it started, how long it
+ * took and the thread it ran on. Stop writes the trace as tab-separated
+ * text. In replay mode the trace of an earlier run is read back first
+ * and the files each phase read last time are prefetched (through
+ * CVFSHandler::PrefetchFiles) as soon as that phase begins again.
+ */
+namespace VFSTrace {
+	enum Mode {
+		MODE_OFF    = 0,
+		MODE_RECORD = 1,
+		MODE_REPLAY = 2, ///< replays the previous trace and records a new one
+	};
+
+	void Start(const std::string& fileName, int mode);
+	void Stop();
+
+	bool IsActive();
+
+	/// <phase> must be a string literal
+	void SetPhase(const char* phase);
+	void AddRead(const std::string& archiveFile, const std::string& filePath, int section, size_t numBytes, float beginTime, float readTime, bool mapped);
+
+	/// ms since Start, the base of AddRead's beginTime
+	float GetTime();
+}
+
+#endif // _VFS_TRACE_H
@@ -50,6 +50,10 @@ CONFIG(int, LinkIncomingMaxWaitingPackets)
 	.defaultValue(512)
 	.minimumValue(0);
 
+CONFIG(bool, NetworkFrameBundles)
+	.defaultValue(false)
+	.description("Bundle and deflate the messages of each sim-frame sent by the server into one packet. Only used if both client and server enable it.");
+
 CONFIG(int, TeamHighlight)
 	.defaultValue(CTeamHighlight::HIGHLIGHT_PLAYERS)
 	.minimumValue(CTeamHighlight::HIGHLIGHT_FIRST)
@@ -70,6 +74,7 @@ void GlobalConfig::Init()
 	networkTimeout = configHandler->GetInt("NetworkTimeout");
 	reconnectTimeout = configHandler->GetInt("ReconnectTimeout");
 	mtu = configHandler->GetInt("MaximumTransmissionUnit");
+	networkFrameBundles = configHandler->GetBool("NetworkFrameBundles");
 
 	linkOutgoingBandwidth = configHandler->GetInt("LinkOutgoingBandwidth");
 	linkIncomingSustainedBandwidth = configHandler->GetInt("LinkIncomingSustainedBandwidth");
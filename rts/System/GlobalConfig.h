@@ -46,6 +46,14 @@ public:
 	 */
 	unsigned mtu = 1400;
 
+	/**
+	 * @brief network frame bundles
+	 *
+	 * Whether to request (client) or allow (server) server-to-client
+	 * messages to be bundled and deflated per sim-frame
+	 */
+	bool networkFrameBundles = false;
+
 
 	/**
 	 * @brief linkBandwidth
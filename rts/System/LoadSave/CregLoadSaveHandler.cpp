@@ -1,8 +1,18 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <future>
 #include <sstream>
 #include <zlib.h>
 
+#if defined(__linux__)
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
 #include "ExternalAI/SkirmishAIHandler.h"
 #include "ExternalAI/EngineOutHandler.h"
 #include "CregLoadSaveHandler.h"
@@ -34,7 +44,9 @@
 #include "Sim/Units/Scripts/NullUnitScript.h"
 #include "Sim/Weapons/PlasmaRepulser.h"
 #include "System/SafeUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/Platform/errorhandler.h"
+#include "System/Platform/Threading.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/GZFileHandler.h"
@@ -46,6 +58,13 @@
 
 #define MAX_STRING_SIZE (1 << 19) // 512kB excluding null-term
 
+#if defined(__linux__)
+CONFIG(bool, SaveGameFork).defaultValue(false).description("Serialize and write save-games from a forked copy of the process (Linux only) so the game only pauses for the fork itself.");
+#endif
+
+// set in a forked save process, which must not touch the logger (its lock may have been held by another thread during fork)
+static bool inSaveChild = false;
+
 
 CCregLoadSaveHandler::CCregLoadSaveHandler()
 {}
@@ -139,6 +158,9 @@ static void WriteString(std::ostream& s, const std::string& str)
 
 static void PrintSize(const char* txt, int size)
 {
+	if (inSaveChild)
+		return;
+
 	if (size > (1024 * 1024 * 1024)) {
 		LOG("%s %.1f GB", txt, size / (1024.0f * 1024 * 1024));
 	} else if (size >  (1024 * 1024)) {
@@ -194,14 +216,10 @@ static void LoadLuaState(CSplitLuaHandle* handle, creg::CInputStreamSerializer&
 }
 
 
-void CCregLoadSaveHandler::SaveGame(const std::string& path)
+bool CCregLoadSaveHandler::SerializeGameState(std::stringstream& oss)
 {
 #ifdef USING_CREG
-	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
-
 	try {
-		std::stringstream oss;
-
 		// write our own header. SavePackage() will add its own
 		WriteString(oss, SpringVersion::GetSync());
 		WriteString(oss, gameSetup->setupText);
@@ -240,27 +258,7 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 			PrintSize("AIs", ((int)oss.tellp()) - aiStart);
 		}
 
-		{
-			gzFile file = gzopen(dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE).c_str(), "wb5");
-
-			if (file == nullptr) {
-				LOG_L(L_ERROR, "[LSH::%s] could not open save-file", __func__);
-				return;
-			}
-
-			std::string data = std::move(oss.str());
-			std::function<void(gzFile, std::string&&)> func = [](gzFile file, std::string&& data) {
-				gzwrite(file, data.c_str(), data.size());
-				gzflush(file, Z_FINISH);
-				gzclose(file);
-			};
-
-			// gzFile is just a plain typedef (struct gzFile_s {}* gzFile), can be copied
-			// need to keep a reference to the future around or its destructor will block
-			ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), file, std::move(data))));
-		}
-
-		//FIXME add lua state
+		return true;
 	} catch (const content_error& ex) {
 		LOG_L(L_ERROR, "[LSH::%s] content error \"%s\"", __func__, ex.what());
 	} catch (const std::exception& ex) {
@@ -275,6 +273,168 @@ void CCregLoadSaveHandler::SaveGame(const std::string& path)
 #else //USING_CREG
 	LOG_L(L_ERROR, "[LSH::%s] creg is disabled", __func__);
 #endif //USING_CREG
+
+	return false;
+}
+
+
+/// deflates <data> into a self-contained gzip member; concatenated members form a valid gzip stream
+static std::string CompressSaveChunk(const char* data, size_t size)
+{
+	std::string member;
+	z_stream zs;
+	memset(&zs, 0, sizeof(zs));
+
+	if (deflateInit2(&zs, 5, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+		return member;
+
+	member.resize(deflateBound(&zs, size));
+
+	zs.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(data));
+	zs.avail_in = size;
+	zs.next_out = reinterpret_cast<Bytef*>(&member[0]);
+	zs.avail_out = member.size();
+
+	if (deflate(&zs, Z_FINISH) == Z_STREAM_END) {
+		member.resize(zs.total_out);
+	} else {
+		member.clear();
+	}
+
+	deflateEnd(&zs);
+	return member;
+}
+
+/// compresses <data> in 4MB chunks on up to <numWorkers> threads while earlier chunks are written
+static bool WriteCompressedSave(const std::string& filePath, const std::string& data, unsigned int numWorkers)
+{
+	constexpr size_t CHUNK_SIZE = 4 * 1024 * 1024;
+
+	std::ofstream file(filePath, std::ios::out | std::ios::binary | std::ios::trunc);
+
+	if (!file.is_open())
+		return false;
+
+	const size_t numChunks = std::max(size_t(1), (data.size() + CHUNK_SIZE - 1) / CHUNK_SIZE);
+	const auto CompressChunk = [&](size_t i) {
+		const size_t offset = i * CHUNK_SIZE;
+		return (CompressSaveChunk(data.data() + offset, std::min(CHUNK_SIZE, data.size() - offset)));
+	};
+
+	std::deque<std::future<std::string>> window;
+	size_t nextChunk = 0;
+
+	for (size_t i = 0; i < numChunks; i++) {
+		std::string member;
+
+		if (numWorkers == 0) {
+			member = CompressChunk(i);
+		} else {
+			// keep numWorkers chunks in flight ahead of the writer
+			for (; nextChunk < numChunks && window.size() < numWorkers; nextChunk++) {
+				window.emplace_back(std::async(std::launch::async, CompressChunk, nextChunk));
+			}
+
+			member = window.front().get();
+			window.pop_front();
+		}
+
+		if (member.empty()) {
+			// drain before <data> goes out of scope
+			for (auto& f: window) {
+				f.wait();
+			}
+
+			return false;
+		}
+
+		file.write(member.data(), member.size());
+	}
+
+	return file.good();
+}
+
+void CCregLoadSaveHandler::SaveGame(const std::string& path)
+{
+	LOG("[LSH::%s] saving game to \"%s\"", __func__, path.c_str());
+
+	const std::string filePath = dataDirsAccess.LocateFile(path, FileQueryFlags::WRITE);
+
+#if defined(__linux__)
+	if (configHandler->GetBool("SaveGameFork")) {
+		const pid_t pid = fork();
+
+		if (pid == 0) {
+			// child; owns a copy-on-write snapshot of the game state and only this thread
+			inSaveChild = true;
+
+			std::stringstream oss;
+
+			if (!SerializeGameState(oss))
+				_exit(1);
+
+			_exit(WriteCompressedSave(filePath, oss.str(), 0)? 0: 2);
+		}
+
+		if (pid > 0) {
+			ThreadPool::AddExtJob(std::async(std::launch::async, [pid, filePath]() {
+				int status = 0;
+
+				if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+					LOG_L(L_ERROR, "[LSH::SaveGame] forked save to \"%s\" failed (status %d)", filePath.c_str(), status);
+					return;
+				}
+
+				LOG("[LSH::SaveGame] forked save to \"%s\" finished", filePath.c_str());
+			}));
+			return;
+		}
+
+		LOG_L(L_WARNING, "[LSH::%s] fork failed, saving in-process", __func__);
+	}
+#endif
+
+	std::stringstream oss;
+
+	if (!SerializeGameState(oss))
+		return;
+
+	std::string data = std::move(oss.str());
+	std::function<void(std::string&&)> func = [filePath](std::string&& data) {
+		const unsigned int numWorkers = std::max(1, Threading::GetPhysicalCpuCores() / 2);
+
+		if (!WriteCompressedSave(filePath, data, numWorkers))
+			LOG_L(L_ERROR, "[LSH::SaveGame] could not write save-file \"%s\"", filePath.c_str());
+	};
+
+	// need to keep a reference to the future around or its destructor will block
+	ThreadPool::AddExtJob(std::move(std::async(std::launch::async, std::move(func), std::move(data))));
+}
+
+bool CCregLoadSaveHandler::SaveGameState(std::vector<std::uint8_t>& stateBlob)
+{
+	std::stringstream oss;
+
+	if (!SerializeGameState(oss))
+		return false;
+
+	const std::string data = std::move(oss.str());
+	const std::uint32_t rawSize = data.size();
+
+	// snapshots are kept in memory until the demo is written, so deflate
+	// them with the fastest level (zeroed creg padding compresses well)
+	uLongf deflSize = compressBound(rawSize);
+
+	stateBlob.resize(sizeof(rawSize) + deflSize);
+	memcpy(stateBlob.data(), &rawSize, sizeof(rawSize));
+
+	if (compress2(stateBlob.data() + sizeof(rawSize), &deflSize, reinterpret_cast<const Bytef*>(data.data()), rawSize, Z_BEST_SPEED) != Z_OK) {
+		LOG_L(L_ERROR, "[LSH::%s] could not compress game state (%u bytes)", __func__, rawSize);
+		return false;
+	}
+
+	stateBlob.resize(sizeof(rawSize) + deflSize);
+	return true;
 }
 
 /// loads the data (map&mod-name,setup-script) needed by PreGame
@@ -308,10 +468,50 @@ bool CCregLoadSaveHandler::LoadGameStartInfo(const std::string& path)
 	return (saveVersion == syncVersion);
 }
 
+bool CCregLoadSaveHandler::ReadGameState(const std::uint8_t* stateBlob, size_t blobSize)
+{
+	std::uint32_t rawSize = 0;
+
+	if (blobSize <= sizeof(rawSize))
+		return false;
+
+	memcpy(&rawSize, stateBlob, sizeof(rawSize));
+
+	std::string data(rawSize, 0);
+	uLongf dataSize = rawSize;
+
+	if (uncompress(reinterpret_cast<Bytef*>(&data[0]), &dataSize, stateBlob + sizeof(rawSize), blobSize - sizeof(rawSize)) != Z_OK || dataSize != rawSize) {
+		LOG_L(L_ERROR, "[LSH::%s] corrupt game state (" _STPF_ " bytes)", __func__, blobSize);
+		return false;
+	}
+
+	std::string saveVersion;
+
+	iss.str(std::move(data));
+	ReadString(iss, saveVersion);
+
+	// unlike save-files, a state from another version can never be loaded
+	if (saveVersion != SpringVersion::GetSync()) {
+		LOG_L(L_ERROR, "[LSH::%s] game state saved by engine version \"%s\"", __func__, saveVersion.c_str());
+		iss.str("");
+		return false;
+	}
+
+	ReadString(iss, scriptText);
+	ReadString(iss, modName);
+	ReadString(iss, mapName);
+
+	replacesRunningGame = true;
+	return true;
+}
+
 /// this should be called on frame 0 when the game has started
 void CCregLoadSaveHandler::LoadGame()
 {
 #ifdef USING_CREG
+	// gu is part of the state, but ours in a game we are already running
+	const int myPlayerNum = gu->myPlayerNum;
+
 	ENTER_SYNCED_CODE();
 	{
 		creg::CInputStreamSerializer inputStream;
@@ -348,12 +548,23 @@ void CCregLoadSaveHandler::LoadGame()
 	// cleanup
 	iss.str("");
 
-	gs->paused = false;
-	if (gameServer != nullptr) {
-		gameServer->isPaused = false;
-		gameServer->syncErrorFrame = 0;
+	if (replacesRunningGame) {
+		// the loaded gs->paused is the synced one, and a demo
+		// server's pause is up to its viewer; neither is reset
+		gu->SetMyPlayer(myPlayerNum);
+	} else {
+		gs->paused = false;
+
+		if (gameServer != nullptr)
+			gameServer->isPaused = false;
 	}
 
+	if (gameServer != nullptr)
+		gameServer->syncErrorFrame = 0;
+
+	if (postLoadFunc)
+		postLoadFunc();
+
 	LEAVE_SYNCED_CODE();
 #else //USING_CREG
 	LOG_L(L_ERROR, "Load failed: creg is disabled");
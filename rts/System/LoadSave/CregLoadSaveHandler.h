@@ -3,8 +3,11 @@
 #ifndef CREG_LOAD_SAVE_HANDLER_H
 #define CREG_LOAD_SAVE_HANDLER_H
 
+#include <cinttypes>
+#include <functional>
 #include <string>
 #include <sstream>
+#include <vector>
 #include "LoadSaveHandler.h"
 
 class CCregLoadSaveHandler : public ILoadSaveHandler
@@ -17,8 +20,26 @@ public:
 	void LoadGame() override;
 	void SaveGame(const std::string& path) override;
 
+	/// as SaveGame but into memory, <stateBlob> is (uint32_t rawSize, deflated state)
+	bool SaveGameState(std::vector<std::uint8_t>& stateBlob);
+	/**
+	 * replaces LoadGameStartInfo for a state written by SaveGameState,
+	 * which LoadGame then restores in place of the one of a running game
+	 * (keeping our own player and the pause state), see CGame::ReloadState
+	 */
+	bool ReadGameState(const std::uint8_t* stateBlob, size_t blobSize);
+	/// run by LoadGame once the state is restored
+	void SetPostLoadFunc(std::function<void()>&& func) { postLoadFunc = std::move(func); }
+
+protected:
+	bool SerializeGameState(std::stringstream& oss);
+
 protected:
 	std::stringstream iss;
+
+	bool replacesRunningGame = false;
+
+	std::function<void()> postLoadFunc;
 };
 
 #endif // CREG_LOAD_SAVE_HANDLER_H
@@ -0,0 +1,270 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoBatch.h"
+#include "demofile.h"
+
+#include "System/Exceptions.h"
+#include "System/TdfParser.h"
+#include "System/FileSystem/DataDirsAccess.h"
+#include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Platform/Threading.h"
+#include "System/Platform/Watchdog.h"
+#include "System/Sync/HsiehHash.h"
+#include "System/Threading/ThreadPool.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+#include <zlib.h>
+
+
+namespace DemoBatch {
+	struct Job {
+		std::string demoFile;
+		std::string mapName;
+	};
+
+	struct Worker {
+		int pid;
+		int resultFd;
+		size_t jobIndex;
+	};
+
+	// write-end of the pipe to the parent, only set in workers
+	static int resultFd = -1;
+
+	static spring_time startTime;
+	static spring_time replayTime;
+
+	static std::uint32_t syncChecksum = 0;
+	static std::uint32_t numDesyncs = 0;
+
+
+	// reads only the header and script, CDemoReader would inflate the whole file
+	static std::string ReadMapName(const std::string& demoFile)
+	{
+		gzFile file = gzopen(dataDirsAccess.LocateFile(demoFile).c_str(), "rb");
+
+		if (file == nullptr)
+			return "";
+
+		DemoFileHeader fileHeader;
+		std::string script;
+
+		if (gzread(file, &fileHeader, sizeof(fileHeader)) == sizeof(fileHeader)) {
+			fileHeader.swab();
+
+			if (memcmp(fileHeader.magic, DEMOFILE_MAGIC, sizeof(fileHeader.magic)) == 0 && fileHeader.headerSize == sizeof(fileHeader)) {
+				script.resize(fileHeader.scriptSize);
+
+				if (gzread(file, &script[0], script.size()) != static_cast<int>(script.size()))
+					script.clear();
+			}
+		}
+
+		gzclose(file);
+
+		if (script.empty())
+			return "";
+
+		const TdfParser parser(script.data(), script.size());
+		return (parser.SGetValueDef("", "GAME\\MapName"));
+	}
+
+	static std::vector<Job> ReadJobList(const std::string& listFile)
+	{
+		std::ifstream list(listFile);
+		std::vector<Job> jobs;
+
+		if (!list.is_open())
+			throw content_error("[DemoBatch] can not open demo list \"" + listFile + "\"");
+
+		for (std::string line; std::getline(list, line); ) {
+			line.erase(line.find_last_not_of(" \t\r") + 1);
+
+			if (line.empty() || line[0] == '#')
+				continue;
+
+			jobs.push_back({line, ReadMapName(line)});
+		}
+
+		// same-map demos back to back
+		std::stable_sort(jobs.begin(), jobs.end(), [](const Job& a, const Job& b) { return (a.mapName < b.mapName); });
+		return jobs;
+	}
+
+
+	std::string Run(const std::string& listFile, const std::string& reportFile, int numWorkers)
+	{
+#ifdef _WIN32
+		throw content_error("[DemoBatch] --demo-batch needs fork() and is not available on Windows");
+#else
+		const std::vector<Job> jobs = ReadJobList(listFile);
+
+		FILE* report = fopen(reportFile.c_str(), "w");
+
+		if (report == nullptr)
+			throw content_error("[DemoBatch] can not write report \"" + reportFile + "\"");
+
+		if (numWorkers <= 0)
+			numWorkers = Threading::GetPhysicalCpuCores();
+
+		LOG("[DemoBatch::%s] replaying %u demos with %d workers, report \"%s\"", __func__, static_cast<unsigned>(jobs.size()), numWorkers, reportFile.c_str());
+
+		fprintf(report, "demo\tmap\tresult\tframes\tchecksum\tdesyncs\tloadtime\tsimtime\n");
+		fflush(report);
+
+		// only the forking thread survives in a worker, nothing may hold a lock
+		ThreadPool::SetThreadCount(0);
+		// blocks in waitpid, sometimes for hours
+		Watchdog::ClearTimer(WDT_MAIN, true);
+
+		std::vector<Worker> workers;
+		std::vector<std::uint8_t> jobStates(jobs.size(), 0); // 0=waiting, 1=running, 2=done
+		std::vector<std::string> primedMaps;
+
+		const auto CanStart = [&](size_t jobIndex) {
+			const std::string& mapName = jobs[jobIndex].mapName;
+
+			// unreadable, the worker reports why
+			if (mapName.empty())
+				return true;
+			if (std::find(primedMaps.begin(), primedMaps.end(), mapName) != primedMaps.end())
+				return true;
+
+			// the first demo of a map writes its caches alone
+			for (const Worker& w: workers) {
+				if (jobs[w.jobIndex].mapName == mapName)
+					return false;
+			}
+
+			return true;
+		};
+
+		for (size_t numDone = 0; numDone < jobs.size(); ) {
+			for (size_t jobIndex = 0; jobIndex < jobs.size() && workers.size() < static_cast<size_t>(numWorkers); ++jobIndex) {
+				if (jobStates[jobIndex] != 0 || !CanStart(jobIndex))
+					continue;
+
+				int fds[2];
+
+				if (pipe(fds) != 0)
+					throw content_error("[DemoBatch] pipe() failed: " + std::string(strerror(errno)));
+
+				const pid_t pid = fork();
+
+				if (pid < 0)
+					throw content_error("[DemoBatch] fork() failed: " + std::string(strerror(errno)));
+
+				if (pid == 0) {
+					close(fds[0]);
+
+					for (const Worker& w: workers) {
+						close(w.resultFd);
+					}
+
+					resultFd = fds[1];
+					startTime = spring_gettime();
+
+					ThreadPool::SetDefaultThreadCount();
+					return jobs[jobIndex].demoFile;
+				}
+
+				close(fds[1]);
+
+				workers.push_back({pid, fds[0], jobIndex});
+				jobStates[jobIndex] = 1;
+			}
+
+			int status = 0;
+			const pid_t pid = waitpid(-1, &status, 0);
+
+			const auto it = std::find_if(workers.begin(), workers.end(), [&](const Worker& w) { return (w.pid == pid); });
+
+			if (it == workers.end())
+				continue;
+
+			char result[256] = {0};
+			const ssize_t resultSize = read(it->resultFd, result, sizeof(result) - 1);
+			close(it->resultFd);
+
+			const Job& job = jobs[it->jobIndex];
+
+			if (resultSize <= 0) {
+				if (WIFSIGNALED(status)) {
+					snprintf(result, sizeof(result), "signal%d\t\t\t\t\t\n", WTERMSIG(status));
+				} else {
+					snprintf(result, sizeof(result), "exit%d\t\t\t\t\t\n", WEXITSTATUS(status));
+				}
+			}
+
+			fprintf(report, "%s\t%s\t%s", job.demoFile.c_str(), job.mapName.c_str(), result);
+			fflush(report);
+
+			LOG("[DemoBatch::%s] %u/%u %s: %.*s", __func__, static_cast<unsigned>(numDone + 1), static_cast<unsigned>(jobs.size()), job.demoFile.c_str(), static_cast<int>(strcspn(result, "\t")), result);
+
+			if (std::find(primedMaps.begin(), primedMaps.end(), job.mapName) == primedMaps.end())
+				primedMaps.push_back(job.mapName);
+
+			jobStates[it->jobIndex] = 2;
+			workers.erase(it);
+			numDone += 1;
+		}
+
+		fclose(report);
+		return "";
+#endif
+	}
+
+
+	bool IsWorker() { return (resultFd != -1); }
+
+	void StartReplay() { replayTime = spring_gettime(); }
+
+	void AddSyncChecksum(std::uint32_t checksum)
+	{
+		syncChecksum = HsiehHash(&checksum, sizeof(checksum), syncChecksum);
+	}
+
+	void AddDesync() { numDesyncs += 1; }
+
+	void Finish(int frameNum)
+	{
+		if (resultFd == -1)
+			return;
+
+		const spring_time endTime = spring_gettime();
+		const spring_time simTime = spring_istime(replayTime)? replayTime: endTime;
+
+		char result[256];
+		const int resultSize = snprintf(result, sizeof(result), "%s\t%d\t%08x\t%u\t%.3f\t%.3f\n",
+			(numDesyncs == 0)? "ok": "desync",
+			frameNum,
+			syncChecksum,
+			numDesyncs,
+			(simTime - startTime).toSecsf(),
+			(endTime - simTime).toSecsf()
+		);
+
+#ifndef _WIN32
+		// a single write below PIPE_BUF is atomic
+		if (write(resultFd, result, resultSize) != resultSize)
+			LOG_L(L_ERROR, "[DemoBatch::%s] could not send result to the parent", __func__);
+
+		close(resultFd);
+#endif
+
+		resultFd = -1;
+	}
+}
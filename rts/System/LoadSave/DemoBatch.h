@@ -0,0 +1,37 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_BATCH_H
+#define DEMO_BATCH_H
+
+#include <cinttypes>
+#include <string>
+
+/**
+ * @brief Replays a list of demos in forked worker processes (--demo-batch)
+ * The parent scans the archives once and every worker inherits that state,
+ * so a replay only pays for loading its game and map. Demos are grouped by
+ * map and the first demo of each map runs alone, so later ones find the
+ * path-estimator cache already written. Each worker replays one demo as
+ * fast as the sim allows and reports back its sync checksums and timings,
+ * the parent writes one tab-separated line per demo to the report file.
+ */
+namespace DemoBatch {
+	/**
+	 * Does not return in the parent until all demos have been replayed.
+	 * @return the demo to replay if called in a worker, empty in the parent
+	 */
+	std::string Run(const std::string& listFile, const std::string& reportFile, int numWorkers);
+
+	bool IsWorker();
+
+	/// called by the worker once its game has loaded
+	void StartReplay();
+	/// called by the worker for every simulated frame (SYNCCHECK builds)
+	void AddSyncChecksum(std::uint32_t checksum);
+	/// called by the worker if a checksum recorded in the demo does not match
+	void AddDesync();
+	/// sends the result of this worker's replay to the parent, call once before quitting
+	void Finish(int frameNum);
+}
+
+#endif // DEMO_BATCH_H
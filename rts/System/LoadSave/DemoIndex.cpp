@@ -0,0 +1,103 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "DemoIndex.h"
+
+#include <cstring>
+#include <zlib.h>
+
+// CRC32 and ISIZE
+static constexpr unsigned int GZIP_TRAILER_SIZE = 8;
+
+
+bool CDemoIndex::Load(const std::string& filename)
+{
+	demoName = filename;
+	blocks.clear();
+
+	file.open(filename, std::ios::in | std::ios::binary);
+
+	if (!file.is_open())
+		return false;
+
+	file.seekg(0, std::ios::end);
+
+	const std::streamoff fileSize = file.tellg();
+
+	if (fileSize < std::streamoff(sizeof(DemoIndexFooter) + GZIP_TRAILER_SIZE))
+		return false;
+
+	DemoIndexFooter footer;
+
+	file.seekg(fileSize - (sizeof(footer) + GZIP_TRAILER_SIZE));
+	file.read(reinterpret_cast<char*>(&footer), sizeof(footer));
+	footer.swab();
+
+	if (!file.good() || memcmp(footer.magic, DEMOINDEX_MAGIC, sizeof(footer.magic)) != 0)
+		return false;
+
+	// the index member holds the block table followed by the footer
+	const std::uint32_t indexSize = footer.numBlocks * sizeof(DemoIndexBlock) + sizeof(footer);
+
+	if (footer.indexOffset >= fileSize || !ReadMember(footer.indexOffset, fileSize - footer.indexOffset, indexSize, memberBuffer))
+		return false;
+
+	blocks.resize(footer.numBlocks);
+	memcpy(blocks.data(), memberBuffer.data(), footer.numBlocks * sizeof(DemoIndexBlock));
+
+	for (DemoIndexBlock& block: blocks) {
+		block.swab();
+	}
+
+	// the header member precedes the first block
+	const std::uint32_t headerFileSize = blocks.empty()? footer.indexOffset: blocks[0].fileOffset;
+
+	if (!ReadMember(0, headerFileSize, sizeof(fileHeader), memberBuffer))
+		return false;
+
+	memcpy(&fileHeader, memberBuffer.data(), sizeof(fileHeader));
+	fileHeader.swab();
+
+	return (fileHeader.headerSize == sizeof(fileHeader));
+}
+
+
+bool CDemoIndex::ReadBlock(size_t blockNum, std::vector<std::uint8_t>& data)
+{
+	if (blockNum >= blocks.size())
+		return false;
+
+	const DemoIndexBlock& block = blocks[blockNum];
+	return (ReadMember(block.fileOffset, block.fileSize, block.dataSize, data));
+}
+
+bool CDemoIndex::ReadMember(std::uint32_t fileOffset, std::uint32_t fileSize, std::uint32_t dataSize, std::vector<std::uint8_t>& data)
+{
+	std::vector<std::uint8_t> member(fileSize);
+
+	file.clear();
+	file.seekg(fileOffset);
+	file.read(reinterpret_cast<char*>(member.data()), member.size());
+
+	if (!file.good())
+		return false;
+
+	z_stream stream;
+	memset(&stream, 0, sizeof(stream));
+
+	// +16 selects the gzip wrapper, inflation stops at the end of the member
+	if (inflateInit2(&stream, MAX_WBITS + 16) != Z_OK)
+		return false;
+
+	data.resize(dataSize);
+
+	stream.next_in   = member.data();
+	stream.avail_in  = member.size();
+	stream.next_out  = data.data();
+	stream.avail_out = data.size();
+
+	const int ret = inflate(&stream, Z_FINISH);
+	const bool complete = (ret == Z_STREAM_END && stream.total_out == dataSize);
+
+	inflateEnd(&stream);
+	return complete;
+}
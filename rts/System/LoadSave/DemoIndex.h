@@ -0,0 +1,46 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef DEMO_INDEX
+#define DEMO_INDEX
+
+#include <cinttypes>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "Demo.h"
+
+/**
+ * @brief Random access to the blocks of streamed demofiles
+ * Reads only the DemoIndexBlock table and the blocks asked for, instead
+ * of decompressing the whole file like CDemoReader.
+ */
+class CDemoIndex : public CDemo
+{
+public:
+	/**
+	@brief Open a demofile and read its index
+	@return false if the file has no index (not streamed, or not closed properly)
+	*/
+	bool Load(const std::string& filename);
+
+	const std::vector<DemoIndexBlock>& GetBlocks() const { return blocks; }
+
+	/// offsets of the demo stream within the decompressed file
+	std::uint32_t GetStreamStart() const { return (fileHeader.headerSize + fileHeader.scriptSize); }
+	std::uint32_t GetStreamEnd() const { return (GetStreamStart() + fileHeader.demoStreamSize); }
+
+	/// inflate block <blockNum>, data[0] is at blocks[blockNum].dataOffset
+	bool ReadBlock(size_t blockNum, std::vector<std::uint8_t>& data);
+
+private:
+	bool ReadMember(std::uint32_t fileOffset, std::uint32_t fileSize, std::uint32_t dataSize, std::vector<std::uint8_t>& data);
+
+private:
+	std::ifstream file;
+
+	std::vector<DemoIndexBlock> blocks;
+	std::vector<std::uint8_t> memberBuffer;
+};
+
+#endif
@@ -3,6 +3,7 @@
 #include "DemoReader.h"
 
 #include "Game/GameVersion.h"
+#include "Net/Protocol/NetMessageTypes.h"
 #include "Sim/Misc/GlobalConstants.h"
 
 #ifndef TOOLS
@@ -15,6 +16,7 @@ CONFIG(bool, DisableDemoVersionCheck).defaultValue(false).description("Allow to
 #include "System/Log/ILog.h"
 #include "System/Net/RawPacket.h"
 
+#include <algorithm>
 #include <array>
 #include <climits>
 #include <stdexcept>
@@ -80,6 +82,8 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		playbackDemo->Read(const_cast<char*>(setupScript.data()), setupScript.size());
 	}
 
+	demoStreamStart = playbackDemo->GetPos();
+
 	playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader));
 	chunkHeader.swab();
 
@@ -99,6 +103,9 @@ CDemoReader::CDemoReader(const std::string& filename, float curTime): playbackDe
 		// (if this had still used CFileHandler that would have been easier ;-))
 		bytesRemaining = playbackDemoSize - curPos;
 	}
+
+	demoStreamEnd = std::min(demoStreamStart + ((fileHeader.demoStreamSize != 0)? fileHeader.demoStreamSize: (playbackDemoSize - demoStreamStart)), playbackDemoSize);
+
 	playbackDemo->Seek(curPos);
 }
 
@@ -153,6 +160,70 @@ bool CDemoReader::ReachedEnd()
 }
 
 
+void CDemoReader::BuildSnapshotIndex()
+{
+	const int curPos = playbackDemo->GetPos();
+
+	// NETMSG_DEMOSNAPSHOT, uint32_t messageSize, int32_t frameNum
+	constexpr unsigned int snapshotHeaderSize = 1 + 4 + 4;
+
+	haveSnapshotIndex = true;
+	snapshotIndex.clear();
+
+	// the decompressed stream is held in memory, so this only visits chunk headers
+	for (int streamPos = demoStreamStart; (streamPos + int(sizeof(DemoStreamChunkHeader))) <= demoStreamEnd; ) {
+		DemoStreamChunkHeader header;
+		unsigned char buf[snapshotHeaderSize];
+
+		playbackDemo->Seek(streamPos);
+
+		if (playbackDemo->Read((char*)&header, sizeof(header)) < sizeof(header))
+			break;
+
+		header.swab();
+
+		if (header.length >= snapshotHeaderSize && playbackDemo->Read((char*)buf, sizeof(buf)) == sizeof(buf) && buf[0] == NETMSG_DEMOSNAPSHOT) {
+			int frameNum = 0;
+			memcpy(&frameNum, buf + 1 + 4, sizeof(frameNum));
+
+			snapshotIndex.push_back({swabDWord(frameNum), streamPos});
+		}
+
+		streamPos += (sizeof(header) + header.length);
+	}
+
+	playbackDemo->Seek(curPos);
+
+	LOG("[DemoReader::%s] found %u sim-state snapshots", __func__, (unsigned int) snapshotIndex.size());
+}
+
+bool CDemoReader::SeekToSnapshot(int minFrameNum, int maxFrameNum)
+{
+	if (!haveSnapshotIndex)
+		BuildSnapshotIndex();
+
+	// entries are in stream-order and thus sorted by frame
+	const auto pred = [](const SnapshotIndexEntry& e, int frameNum) { return (e.frameNum <= frameNum); };
+	const auto iter = std::lower_bound(snapshotIndex.begin(), snapshotIndex.end(), maxFrameNum, pred);
+
+	if (iter == snapshotIndex.begin())
+		return false;
+
+	const SnapshotIndexEntry& entry = *(iter - 1);
+
+	if (entry.frameNum < minFrameNum)
+		return false;
+
+	playbackDemo->Seek(entry.streamPos);
+	playbackDemo->Read((char*)&chunkHeader, sizeof(chunkHeader));
+	chunkHeader.swab();
+
+	nextDemoReadTime = chunkHeader.modGameTime + demoTimeOffset;
+	bytesRemaining = demoStreamEnd - playbackDemo->GetPos();
+	return true;
+}
+
+
 void CDemoReader::LoadStats()
 {
 	// Stats are not available if Spring crashed while writing the demo.
@@ -48,6 +48,13 @@ public:
 		return setupScript;
 	};
 
+	/**
+	@brief Positions the stream at the last sim-state snapshot recorded for a frame in [minFrameNum, maxFrameNum]
+	The next GetData returns the NETMSG_DEMOSNAPSHOT, followed by everything recorded after it.
+	@return false if there is no such snapshot, the stream position is unchanged then
+	*/
+	bool SeekToSnapshot(int minFrameNum, int maxFrameNum);
+
 	const std::vector<PlayerStatistics>& GetPlayerStats() const { return playerStats; }
 	const std::vector< std::vector<TeamStatistics> >& GetTeamStats() const { return teamStats; }
 	const std::vector< unsigned char >& GetWinningAllyTeams() const { return winningAllyTeams; }
@@ -56,15 +63,29 @@ public:
 	void LoadStats();
 
 private:
+	void BuildSnapshotIndex();
+
+private:
+	struct SnapshotIndexEntry {
+		int frameNum;
+		int streamPos; ///< of the chunk header
+	};
+
 	CFileHandler* playbackDemo;
 
 	float demoTimeOffset;
 	float nextDemoReadTime;
 	int bytesRemaining;
 	int playbackDemoSize;
+	int demoStreamStart;
+	int demoStreamEnd;
 
 	DemoStreamChunkHeader chunkHeader;
 
+	/// built on the first seek, requires a pass over the entire stream
+	std::vector<SnapshotIndexEntry> snapshotIndex;
+	bool haveSnapshotIndex = false;
+
 	std::string setupScript;	// the original, unaltered version from script
 
 	std::vector<PlayerStatistics> playerStats; // one stat per player
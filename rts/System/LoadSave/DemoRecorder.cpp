@@ -2,19 +2,25 @@
 
 #include <cassert>
 #include <cerrno>
+#include <cstdio>
 #include <cstring>
+#include <deque>
 #include <memory>
 
 #include "DemoRecorder.h"
 #include "Game/GameVersion.h"
+#include "Net/Protocol/NetMessageTypes.h"
 #include "Sim/Misc/TeamStatistics.h"
 #include "System/TimeUtil.h"
 #include "System/StringUtil.h"
+#include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/DataDirsAccess.h"
 #include "System/FileSystem/FileSystem.h"
 #include "System/FileSystem/FileQueryFlags.h"
 #include "System/FileSystem/FileHandler.h"
 #include "System/Log/ILog.h"
+#include "System/Misc/SpringTime.h"
+#include "System/Platform/Threading.h"
 #include "System/Threading/ThreadPool.h"
 
 #ifdef CreateDirectory
@@ -26,31 +32,329 @@
 #endif
 
 
+CONFIG(int, DemoStreamInterval).defaultValue(0).minimumValue(0).description("If greater than 0, demos are compressed and written to disk while recording, at least every N seconds. Otherwise the entire demo is kept in memory until the game ends.");
+CONFIG(int, DemoStreamBlockSize).defaultValue(1024).minimumValue(64).description("Size in KB after which a streamed demo block is written before DemoStreamInterval has passed.");
+
+
 // server and client memory-streams
 static std::string demoStreams[2];
 static spring::mutex demoMutex;
 
 
+/**
+ * @brief Compresses and writes demo blocks on its own thread
+ * Every block becomes a separate gzip member (which gzread concatenates),
+ * so a demo cut short by a crash stays readable up to the last block. The
+ * header is kept in a stored member of constant size at the start of the
+ * file, which allows patching it in place when the game ends. Closing the
+ * writer appends an index of all blocks, see DemoIndexBlock.
+ */
+class CDemoStreamWriter
+{
+public:
+	/// blocks queued beyond this make the recording thread wait
+	static constexpr size_t MAX_PENDING_BLOCKS = 4;
+
+	static std::shared_ptr<CDemoStreamWriter> Open(const std::string& fileName, int flushInterval, int blockSize);
+
+	CDemoStreamWriter(const std::string& fileName, int flushInterval, int blockSize);
+	~CDemoStreamWriter();
+
+	bool WantFlush(size_t streamSize) const {
+		return (streamSize >= blockSize || (spring_gettime() - lastWriteTime) >= flushInterval);
+	}
+	size_t GetBlockSize() const { return blockSize; }
+
+	/// called for each stream chunk added to the current block
+	void AddChunk(std::uint8_t msgType) {
+		nextBlockInfo.AddMsgType(msgType);
+		frameNum += (msgType == NETMSG_NEWFRAME || msgType == NETMSG_KEYFRAME);
+	}
+
+	void WriteHeader(const DemoFileHeader& header);
+	void WriteBlock(std::string&& block);
+	/// writes all pending data, the writer thread is joined at exit
+	void Close();
+
+private:
+	struct PendingBlock {
+		std::string data;
+		DemoIndexBlock info;
+	};
+
+	void Run();
+	void WriteIndex();
+	bool WriteMember(z_stream& stream, const void* data, size_t size);
+
+private:
+	FILE* file = nullptr;
+
+	spring::thread thread;
+	spring::mutex mutex;
+	spring::condition_variable cond;
+
+	std::deque<PendingBlock> pendingBlocks;
+	std::vector<std::uint8_t> memberBuffer;
+
+	// only touched by the writer thread
+	std::vector<DemoIndexBlock> indexBlocks;
+	std::uint32_t dataOffset = sizeof(DemoFileHeader);
+
+	// only touched by the recording thread
+	DemoIndexBlock nextBlockInfo;
+	int frameNum = -1;
+
+	DemoFileHeader pendingHeader;
+
+	z_stream headerStream;
+	z_stream blockStream;
+
+	spring_time flushInterval;
+	spring_time lastWriteTime;
+
+	size_t blockSize = 0;
+	size_t headerMemberSize = 0;
+
+	bool haveHeader = false;
+	bool finished = false;
+};
+
+
+std::shared_ptr<CDemoStreamWriter> CDemoStreamWriter::Open(const std::string& fileName, int flushInterval, int blockSize)
+{
+	std::shared_ptr<CDemoStreamWriter> writer = std::make_shared<CDemoStreamWriter>(fileName, flushInterval, blockSize);
+
+	if (writer->file == nullptr) {
+		LOG_L(L_ERROR, "[DemoStreamWriter::%s] could not open \"%s\" (%s)", __func__, fileName.c_str(), strerror(errno));
+		return nullptr;
+	}
+
+	// the thread shares ownership, it can outlive the recorder after Close
+	writer->thread = spring::thread([writer]() { writer->Run(); });
+	return writer;
+}
+
+CDemoStreamWriter::CDemoStreamWriter(const std::string& fileName, int flushInterval_, int blockSize_)
+	: file(fopen(fileName.c_str(), "wb"))
+	, flushInterval(spring_secs(flushInterval_))
+	, lastWriteTime(spring_gettime())
+	, blockSize(blockSize_ * 1024)
+{
+	memset(&pendingHeader, 0, sizeof(pendingHeader));
+	memset(&nextBlockInfo, 0, sizeof(nextBlockInfo));
+	memset(&headerStream, 0, sizeof(headerStream));
+	nextBlockInfo.firstFrameNum = -1;
+	memset(&blockStream, 0, sizeof(blockStream));
+
+	// windowBits + 16 selects a gzip wrapper, level 0 makes the header member size fixed
+	deflateInit2(&headerStream, Z_NO_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+	deflateInit2(&blockStream, Z_BEST_COMPRESSION, Z_DEFLATED, MAX_WBITS + 16, 8, Z_DEFAULT_STRATEGY);
+}
+
+CDemoStreamWriter::~CDemoStreamWriter()
+{
+	assert(!thread.joinable());
+
+	deflateEnd(&headerStream);
+	deflateEnd(&blockStream);
+
+	if (file != nullptr)
+		fclose(file);
+}
+
+
+void CDemoStreamWriter::WriteHeader(const DemoFileHeader& header)
+{
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+		memcpy(&pendingHeader, &header, sizeof(header));
+		haveHeader = true;
+	}
+
+	cond.notify_all();
+}
+
+void CDemoStreamWriter::WriteBlock(std::string&& block)
+{
+	lastWriteTime = spring_gettime();
+
+	{
+		std::unique_lock<spring::mutex> lock(mutex);
+		// bound memory use if the disk can not keep up
+		cond.wait(lock, [&]() { return (pendingBlocks.size() < MAX_PENDING_BLOCKS); });
+		pendingBlocks.push_back({std::move(block), nextBlockInfo});
+	}
+
+	cond.notify_all();
+
+	// frame-messages added from now on belong to the next block
+	memset(&nextBlockInfo, 0, sizeof(nextBlockInfo));
+	nextBlockInfo.firstFrameNum = frameNum;
+}
+
+void CDemoStreamWriter::Close()
+{
+	{
+		std::lock_guard<spring::mutex> lock(mutex);
+		finished = true;
+	}
+
+	cond.notify_all();
+
+	// NOTE: can not use ThreadPool workers here, might already be gone
+	ThreadPool::AddExtJob(std::move(thread));
+}
+
+
+bool CDemoStreamWriter::WriteMember(z_stream& stream, const void* data, size_t size)
+{
+	deflateReset(&stream);
+	memberBuffer.resize(deflateBound(&stream, size));
+
+	stream.next_in   = reinterpret_cast<Bytef*>(const_cast<void*>(data));
+	stream.avail_in  = size;
+	stream.next_out  = memberBuffer.data();
+	stream.avail_out = memberBuffer.size();
+
+	if (deflate(&stream, Z_FINISH) != Z_STREAM_END)
+		return false;
+
+	memberBuffer.resize(stream.total_out);
+	return true;
+}
+
+void CDemoStreamWriter::Run()
+{
+	Threading::SetThreadName("demowriter");
+
+	DemoFileHeader header;
+	PendingBlock block;
+
+	while (true) {
+		bool writeHeader = false;
+		bool writeBlock = false;
+
+		{
+			std::unique_lock<spring::mutex> lock(mutex);
+			cond.wait(lock, [&]() { return (haveHeader || !pendingBlocks.empty() || finished); });
+
+			if ((writeHeader = haveHeader)) {
+				memcpy(&header, &pendingHeader, sizeof(header));
+				haveHeader = false;
+			}
+			if ((writeBlock = !pendingBlocks.empty())) {
+				block = std::move(pendingBlocks.front());
+				pendingBlocks.pop_front();
+			}
+
+			if (!writeHeader && !writeBlock)
+				break;
+		}
+
+		// wake up a recording thread waiting for space
+		cond.notify_all();
+
+		if (writeHeader && WriteMember(headerStream, &header, sizeof(header))) {
+			if (headerMemberSize == 0) {
+				// the first header is queued before any block
+				headerMemberSize = memberBuffer.size();
+				fwrite(memberBuffer.data(), memberBuffer.size(), 1, file);
+			} else if (memberBuffer.size() == headerMemberSize) {
+				fseek(file, 0, SEEK_SET);
+				fwrite(memberBuffer.data(), memberBuffer.size(), 1, file);
+				fseek(file, 0, SEEK_END);
+			} else {
+				LOG_L(L_ERROR, "[DemoStreamWriter::%s] header size changed (" _STPF_ " vs. " _STPF_ " bytes)", __func__, memberBuffer.size(), headerMemberSize);
+			}
+		}
+
+		if (writeBlock && WriteMember(blockStream, block.data.data(), block.data.size())) {
+			block.info.fileOffset = ftell(file);
+			block.info.fileSize = memberBuffer.size();
+			block.info.dataOffset = dataOffset;
+			block.info.dataSize = block.data.size();
+
+			fwrite(memberBuffer.data(), memberBuffer.size(), 1, file);
+
+			indexBlocks.push_back(block.info);
+			dataOffset += block.data.size();
+		}
+
+		fflush(file);
+	}
+
+	WriteIndex();
+
+	fclose(file);
+	file = nullptr;
+}
+
+void CDemoStreamWriter::WriteIndex()
+{
+	DemoIndexFooter footer;
+
+	memset(&footer, 0, sizeof(footer));
+	strcpy(footer.magic, DEMOINDEX_MAGIC);
+
+	footer.numBlocks = indexBlocks.size();
+	footer.indexOffset = ftell(file);
+	footer.swab();
+
+	for (DemoIndexBlock& block: indexBlocks) {
+		block.swab();
+	}
+
+	std::vector<std::uint8_t> index(indexBlocks.size() * sizeof(DemoIndexBlock) + sizeof(footer));
+
+	memcpy(index.data(), indexBlocks.data(), indexBlocks.size() * sizeof(DemoIndexBlock));
+	memcpy(index.data() + index.size() - sizeof(footer), &footer, sizeof(footer));
+
+	// stored like the header, so the footer is at a fixed distance from the end
+	if (WriteMember(headerStream, index.data(), index.size()))
+		fwrite(memberBuffer.data(), memberBuffer.size(), 1, file);
+}
+
+
+
 CDemoRecorder::CDemoRecorder(const std::string& mapName, const std::string& modName, bool serverDemo): isServerDemo(serverDemo)
 {
 	std::lock_guard<spring::mutex> lock(demoMutex);
 
-	SetStream();
 	SetName(mapName, modName);
+
+	if (configHandler->GetInt("DemoStreamInterval") > 0)
+		streamWriter = CDemoStreamWriter::Open(demoName, configHandler->GetInt("DemoStreamInterval"), configHandler->GetInt("DemoStreamBlockSize"));
+
+	SetStream();
 	SetFileHeader();
 	WriteFileHeader(false);
 
+	if (streamWriter != nullptr)
+		return;
+
 	file = gzopen(demoName.c_str(), "wb9");
 }
 
 CDemoRecorder::~CDemoRecorder()
 {
-	if (file == nullptr)
+	if (!IsValid())
 		return;
 
 	WriteWinnerList();
 	WritePlayerStats();
 	WriteTeamStats();
+
+	if (streamWriter != nullptr) {
+		LOG("[DemoRecorder::%s] closing %s-demo \"%s\"", __func__, (isServerDemo? "server": "client"), demoName.c_str());
+
+		FlushStream(true);
+		WriteFileHeader(true);
+
+		streamWriter->Close();
+		streamWriter.reset();
+		return;
+	}
+
 	WriteFileHeader(true);
 	WriteDemoFile();
 }
@@ -59,7 +363,22 @@ CDemoRecorder::~CDemoRecorder()
 void CDemoRecorder::SetStream()
 {
 	demoStreams[isServerDemo].clear();
-	demoStreams[isServerDemo].reserve(8 * 1024 * 1024);
+	demoStreams[isServerDemo].reserve((streamWriter != nullptr)? streamWriter->GetBlockSize(): (8 * 1024 * 1024));
+}
+
+void CDemoRecorder::FlushStream(bool force)
+{
+	std::string& stream = demoStreams[isServerDemo];
+
+	if (stream.empty())
+		return;
+	if (!force && !streamWriter->WantFlush(stream.size()))
+		return;
+
+	streamWriter->WriteBlock(std::move(stream));
+
+	stream.clear();
+	stream.reserve(streamWriter->GetBlockSize());
 }
 
 void CDemoRecorder::SetFileHeader()
@@ -124,6 +443,14 @@ void CDemoRecorder::SaveToDemo(const unsigned char* buf, const unsigned length,
 	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&chunkHeader), sizeof(chunkHeader));
 	demoStreams[isServerDemo].append(reinterpret_cast<const char*>(buf), length);
 	fileHeader.demoStreamSize += (length + sizeof(chunkHeader));
+
+	if (streamWriter == nullptr)
+		return;
+
+	if (length > 0)
+		streamWriter->AddChunk(buf[0]);
+
+	FlushStream(false);
 }
 
 void CDemoRecorder::SetName(const std::string& mapName, const std::string& modName)
@@ -195,16 +522,13 @@ void CDemoRecorder::SetPlayerStats(int playerNum, const PlayerStatistics& stats)
 }
 
 /** @brief Set (overwrite) the TeamStatistics history for team teamNum */
-void CDemoRecorder::SetTeamStats(int teamNum, const std::vector<TeamStatistics>& stats)
+void CDemoRecorder::SetTeamStats(int teamNum, const TeamStatisticsHistory& statHistory, const TeamStatistics& currentStats)
 {
 	assert((unsigned)teamNum < teamStats.size()); //FIXME
 
-	teamStats[teamNum].clear();
-	teamStats[teamNum].reserve(stats.size());
-
-	for (const auto& stat: stats) {
-		teamStats[teamNum].push_back(stat);
-	}
+	// kept compact until written, entries are only expanded into the stream
+	teamStats[teamNum] = statHistory;
+	teamStats[teamNum].Append(currentStats);
 }
 
 
@@ -229,6 +553,12 @@ unsigned int CDemoRecorder::WriteFileHeader(bool updateStreamLength)
 	// to little endian
 	tmpHeader.swab();
 
+	// streamed demos keep the header out of the memory-stream
+	if (streamWriter != nullptr) {
+		streamWriter->WriteHeader(tmpHeader);
+		return 0;
+	}
+
 	if (demoStreams[isServerDemo].empty()) {
 		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&tmpHeader), sizeof(tmpHeader));
 	} else {
@@ -281,17 +611,17 @@ void CDemoRecorder::WriteTeamStats()
 	const size_t pos = demoStreams[isServerDemo].size();
 
 	// Write array of dwords indicating number of TeamStatistics per team.
-	for (std::vector<TeamStatistics>& history: teamStats) {
-		unsigned int c = swabDWord(history.size());
+	for (const TeamStatisticsHistory& history: teamStats) {
+		unsigned int c = swabDWord(history.GetSize());
 		demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&c), sizeof(unsigned int));
 	}
 
 	// Write big array of TeamStatistics.
-	for (std::vector<TeamStatistics>& history: teamStats) {
-		for (TeamStatistics& stats: history) {
+	for (const TeamStatisticsHistory& history: teamStats) {
+		history.ForEach(0, history.GetSize(), 1, [&](size_t, TeamStatistics stats) {
 			stats.swab();
 			demoStreams[isServerDemo].append(reinterpret_cast<const char*>(&stats), sizeof(TeamStatistics));
-		}
+		});
 	}
 
 	fileHeader.teamStatSize = int(demoStreams[isServerDemo].size() - pos);
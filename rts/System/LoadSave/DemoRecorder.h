@@ -3,6 +3,7 @@
 #ifndef DEMO_RECORDER
 #define DEMO_RECORDER
 
+#include <memory>
 #include <vector>
 #include <sstream>
 #include <zlib.h>
@@ -11,6 +12,7 @@
 #include "Game/Players/PlayerStatistics.h"
 #include "Sim/Misc/TeamStatistics.h"
 
+class CDemoStreamWriter;
 
 /**
  * @brief Used to record demos
@@ -33,6 +35,7 @@ public:
 		memset(&r.fileHeader, 0, sizeof(fileHeader));
 
 		std::swap(file, r.file);
+		std::swap(streamWriter, r.streamWriter);
 
 		std::swap(demoName, r.demoName);
 		std::swap(playerStats, r.playerStats);
@@ -44,7 +47,7 @@ public:
 	}
 
 
-	bool IsValid() const { return (file != nullptr); }
+	bool IsValid() const { return (file != nullptr || streamWriter != nullptr); }
 
 	void WriteSetupText(const std::string& text);
 	void SaveToDemo(const unsigned char* buf, const unsigned length, const float modGameTime);
@@ -59,7 +62,7 @@ public:
 	void AddNewPlayer(const std::string& name, int playerNum);
 	void InitializeStats(int numPlayers, int numTeams);
 	void SetPlayerStats(int playerNum, const PlayerStatistics& stats);
-	void SetTeamStats(int teamNum, const std::vector<TeamStatistics>& stats);
+	void SetTeamStats(int teamNum, const TeamStatisticsHistory& statHistory, const TeamStatistics& currentStats);
 	void SetWinningAllyTeams(const std::vector<unsigned char>& winningAllyTeams);
 
 private:
@@ -69,12 +72,17 @@ private:
 	void WriteTeamStats();
 	void WriteWinnerList();
 	void WriteDemoFile();
+	/// hand the buffered stream to the writer thread if due (or <force>'d)
+	void FlushStream(bool force);
 
 private:
 	gzFile file = nullptr;
 
+	/// set when demos are written to disk while recording, see DemoStreamInterval
+	std::shared_ptr<CDemoStreamWriter> streamWriter;
+
 	std::vector<PlayerStatistics> playerStats;
-	std::vector< std::vector<TeamStatistics> > teamStats;
+	std::vector<TeamStatisticsHistory> teamStats;
 	std::vector<unsigned char> winningAllyTeams;
 
 	bool isServerDemo = false;
@@ -17,6 +17,9 @@
 /** The first 16 bytes of each demofile. */
 #define DEMOFILE_MAGIC "spring demofile"
 
+/** The first 16 bytes of the index footer of streamed demofiles. */
+#define DEMOINDEX_MAGIC "spring demo idx"
+
 /**
  * The current demofile version. Only change on major modifications for which
  * appending stuff to DemoFileHeader is not sufficient.
@@ -115,6 +118,61 @@ struct DemoStreamChunkHeader
 	}
 };
 
+/**
+ * @brief Spring demo index entry
+ *
+ * Demos recorded in streaming mode (DemoStreamInterval) are concatenated
+ * gzip members: one holding the DemoFileHeader, one for each block of the
+ * remaining file, and a final uncompressed member holding the index:
+ *
+ * - DemoIndexBlock, one for each block member
+ * - DemoIndexFooter
+ *
+ * Since the last member is stored, the footer is always found right before
+ * the 8-byte gzip trailer at the end of the file. Blocks start and end at
+ * stream chunk boundaries and can be inflated on their own. To readers that
+ * decompress the entire file the index is trailing data after the stats.
+ * Demos that were not closed properly have no index.
+ */
+struct DemoIndexBlock
+{
+	std::uint32_t fileOffset;   ///< Offset of the block's gzip member in the compressed file.
+	std::uint32_t fileSize;     ///< Size of the block's gzip member.
+	std::uint32_t dataOffset;   ///< Offset of the block in the decompressed file.
+	std::uint32_t dataSize;     ///< Size of the block in the decompressed file.
+	int firstFrameNum;          ///< Number of frame messages preceding the block, minus one.
+	std::uint8_t msgTypes[32];  ///< Bit-set of the message types (first byte) of all stream chunks in the block.
+
+	bool HasMsgType(std::uint8_t msgType) const { return ((msgTypes[msgType >> 3] & (1 << (msgType & 7))) != 0); }
+	void AddMsgType(std::uint8_t msgType) { msgTypes[msgType >> 3] |= (1 << (msgType & 7)); }
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(fileOffset);
+		swabDWordInPlace(fileSize);
+		swabDWordInPlace(dataOffset);
+		swabDWordInPlace(dataSize);
+		swabDWordInPlace(firstFrameNum);
+	}
+};
+
+/**
+ * @brief Spring demo index footer
+ * @see DemoIndexBlock
+ */
+struct DemoIndexFooter
+{
+	char magic[16];             ///< DEMOINDEX_MAGIC
+	std::uint32_t numBlocks;    ///< Number of DemoIndexBlock's preceding the footer.
+	std::uint32_t indexOffset;  ///< Offset of the index' gzip member in the compressed file.
+
+	/// Change structure from host endian to little endian or vice versa.
+	void swab() {
+		swabDWordInPlace(numBlocks);
+		swabDWordInPlace(indexOffset);
+	}
+};
+
 #pragma pack(pop)
 
 #endif // DEMO_FILE_H
@@ -7,19 +7,30 @@
 
 #include <algorithm>
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <string>
+#include <thread>
 
 #include "Backend.h"
 #include "DefaultFilter.h"
+#include "FramePrefixer.h"
+#include "Level.h"
 #include "LogUtil.h"
+#include "Section.h"
+#include "System/ConcurrentQueue.h"
 #include "System/MainDefines.h"
 
 #define MAX_LOG_SINKS 8
 
 namespace log_formatter {
 	static std::array<log_sink_ptr, MAX_LOG_SINKS> sinks = {{nullptr}};
+	static std::array<log_sink_ptr, MAX_LOG_SINKS> asyncSinks = {{nullptr}};
 	static std::array<log_cleanup_ptr, MAX_LOG_SINKS> cleanupFuncs = {{nullptr}};
 
 	static size_t numSinks = 0;
+	static size_t numAsyncSinks = 0;
 	static size_t numFuncs = 0;
 
 	template<typename T, size_t S> bool array_insert(std::array<T, S>& array, T value, size_t& count) {
@@ -57,12 +68,161 @@ namespace log_formatter {
 		return (array_remove(sinks, sink, numSinks));
 	}
 
+	bool insert_async_sink(log_sink_ptr sink) {
+		return (array_insert(asyncSinks, sink, numAsyncSinks));
+	}
+	bool remove_async_sink(log_sink_ptr sink) {
+		return (array_remove(asyncSinks, sink, numAsyncSinks));
+	}
+
 	bool insert_func(log_cleanup_ptr func) {
 		return (array_insert(cleanupFuncs, func, numFuncs));
 	}
 	bool remove_func(log_cleanup_ptr func) {
 		return (array_remove(cleanupFuncs, func, numFuncs));
 	}
+
+	static void sink_async_record(int level, const char* section, const char* record) {
+		for (size_t i = 0; i < numAsyncSinks; i++) {
+			assert(asyncSinks[i] != nullptr);
+			asyncSinks[i](level, section, record);
+		}
+	}
+}
+
+
+namespace log_async {
+	struct Record {
+		int level;
+		int frameNum;
+		int hasFrameNum;
+		const char* section; // literals or interned by log_filter_section_getSectionCString
+		std::string msg;
+	};
+
+	static moodycamel::ConcurrentQueue<Record> queue;
+
+	static std::atomic<bool> enabled = {false};
+	static std::atomic<bool> running = {false};
+	static std::atomic<unsigned int> numQueued = {0};
+	static std::atomic<unsigned int> numDropped = {0};
+
+	static unsigned int maxQueued = 0;
+
+	static std::mutex sinkMutex;
+	static std::thread writer;
+
+
+	static size_t SinkQueuedRecords() {
+		std::array<Record, 64> records;
+
+		size_t numRecords = 0;
+		size_t numSunk = 0;
+
+		while ((numRecords = queue.try_dequeue_bulk(records.begin(), records.size())) > 0) {
+			numQueued -= numRecords;
+			numSunk += numRecords;
+
+			for (size_t i = 0; i < numRecords; i++) {
+				const Record& r = records[i];
+
+				log_framePrefixer_overrideFrameNum(1, r.hasFrameNum, r.frameNum);
+				log_formatter::sink_async_record(r.level, r.section, r.msg.c_str());
+			}
+		}
+
+		log_framePrefixer_overrideFrameNum(0, 0, 0);
+
+		const unsigned int numLost = numDropped.exchange(0);
+
+		if (numLost > 0) {
+			char msg[128];
+			SNPRINTF(msg, sizeof(msg), "[LogAsync] dropped %u log records, queue is full", numLost);
+			log_formatter::sink_async_record(LOG_LEVEL_WARNING, LOG_SECTION_DEFAULT, msg);
+		}
+
+		return numSunk;
+	}
+
+	static void WriterLoop() {
+		while (running.load()) {
+			size_t numSunk = 0;
+
+			{
+				std::lock_guard<std::mutex> lock(sinkMutex);
+				numSunk = SinkQueuedRecords();
+			}
+
+			if (numSunk == 0)
+				std::this_thread::sleep_for(std::chrono::milliseconds(5));
+		}
+	}
+
+	static void Flush() {
+		if (!running.load())
+			return;
+
+		// the writer itself crashed, do not touch the sinks again
+		if (std::this_thread::get_id() == writer.get_id())
+			return;
+
+		// the writer might be stuck (or dead) inside a sink, write out
+		// the queue regardless of it after a short wait
+		for (unsigned int n = 0; n < 100; n++) {
+			if (!sinkMutex.try_lock()) {
+				std::this_thread::sleep_for(std::chrono::milliseconds(1));
+				continue;
+			}
+
+			SinkQueuedRecords();
+			sinkMutex.unlock();
+			return;
+		}
+
+		SinkQueuedRecords();
+	}
+
+	static void Stop() {
+		if (!running.load())
+			return;
+
+		enabled = false;
+		running = false;
+
+		writer.join();
+
+		// catch records queued while the writer was exiting
+		SinkQueuedRecords();
+	}
+
+	static void Start(unsigned int queueSize) {
+		if (running.load())
+			return;
+
+		maxQueued = std::max(queueSize, 1u);
+		running = true;
+		writer = std::thread(WriterLoop);
+		enabled = true;
+	}
+
+	static void Enqueue(int level, const char* section, const char* msg) {
+		if (numQueued.fetch_add(1) >= maxQueued) {
+			numQueued -= 1;
+			numDropped += 1;
+			return;
+		}
+
+		Record r = {level, 0, 0, section, msg};
+		r.hasFrameNum = log_framePrefixer_getFrameNum(&r.frameNum);
+
+		queue.enqueue(std::move(r));
+	}
+
+
+	/// joins the writer before the queue is destroyed, if nobody disabled it
+	struct WriterStopper {
+		~WriterStopper() { Stop(); }
+	} writerStopper;
 }
 
 
@@ -81,6 +241,18 @@ extern void log_formatter_format(log_record_t* log, va_list arguments);
 void log_backend_registerSink(log_sink_ptr sink) { log_formatter::insert_sink(sink); }
 void log_backend_unregisterSink(log_sink_ptr sink) { log_formatter::remove_sink(sink); }
 
+void log_backend_registerAsyncSink(log_sink_ptr sink) { log_formatter::insert_async_sink(sink); }
+void log_backend_unregisterAsyncSink(log_sink_ptr sink) { log_formatter::remove_async_sink(sink); }
+
+void log_backend_setAsync(int enable, unsigned int queueSize)
+{
+	if (enable != 0) {
+		log_async::Start(queueSize);
+	} else {
+		log_async::Stop();
+	}
+}
+
 void log_backend_registerCleanup(log_cleanup_ptr cleanupFunc) { log_formatter::insert_func(cleanupFunc); }
 void log_backend_unregisterCleanup(log_cleanup_ptr cleanupFunc) { log_formatter::remove_func(cleanupFunc); }
 
@@ -96,7 +268,7 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 {
 	const auto& sinks = log_formatter::sinks;
 
-	if (log_formatter::numSinks == 0)
+	if ((log_formatter::numSinks + log_formatter::numAsyncSinks) == 0)
 		return;
 
 	cur_record.sec = section;
@@ -122,6 +294,14 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 		sinks[i](level, section, cur_record.msg);
 	}
 
+	if (log_formatter::numAsyncSinks > 0) {
+		if (log_async::enabled.load()) {
+			log_async::Enqueue(level, section, cur_record.msg);
+		} else {
+			log_formatter::sink_async_record(level, section, cur_record.msg);
+		}
+	}
+
 	if (cur_record.cnt > 0)
 		return;
 
@@ -132,6 +312,9 @@ void log_backend_record(int level, const char* section, const char* fmt, va_list
 void log_backend_cleanup() {
 	const auto& funcs = log_formatter::cleanupFuncs;
 
+	// called on crashes, so get queued records out before the sinks flush
+	log_async::Flush();
+
 	for (size_t i = 0; i < log_formatter::numFuncs; i++) {
 		assert(funcs[i] != nullptr);
 		funcs[i]();
@@ -27,6 +27,26 @@ void log_backend_registerSink(log_sink_ptr sink);
 void log_backend_unregisterSink(log_sink_ptr sink);
 
 
+/**
+ * Start routing log records to the supplied sink, which may be called from
+ * the asynchronous log writer thread instead of the logging thread.
+ * @see log_backend_setAsync
+ */
+void log_backend_registerAsyncSink(log_sink_ptr sink);
+
+/// Stop routing log records to the supplied async sink
+void log_backend_unregisterAsyncSink(log_sink_ptr sink);
+
+/**
+ * Enables or disables the asynchronous log writer.
+ * While enabled, records for async sinks are formatted on the logging thread,
+ * queued (at most <queueSize> of them, further records are dropped and their
+ * number reported) and sunk by a dedicated thread. Disabling, and the
+ * cleanup run on crashes, write out whatever is still queued.
+ */
+void log_backend_setAsync(int enable, unsigned int queueSize);
+
+
 typedef void (*log_cleanup_ptr)();
 
 /**
@@ -318,11 +318,11 @@ namespace {
 	/// Auto-registers the sink defined in this file before main() is called
 	struct FileSinkRegistrator {
 		FileSinkRegistrator() {
-			log_backend_registerSink(&log_sink_record_file);
+			log_backend_registerAsyncSink(&log_sink_record_file);
 			log_backend_registerCleanup(&log_sink_cleanup_file);
 		}
 		~FileSinkRegistrator() {
-			log_backend_unregisterSink(&log_sink_record_file);
+			log_backend_unregisterAsyncSink(&log_sink_record_file);
 			log_backend_unregisterCleanup(&log_sink_cleanup_file);
 		}
 	} fileSinkRegistrator;
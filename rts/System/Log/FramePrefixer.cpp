@@ -17,6 +17,10 @@ extern "C" {
 // GlobalSynced makes sure this can not be dangling
 static int* frameNumRef = nullptr;
 
+// set while the async log writer sinks a record
+static _threadlocal int overrideFrameNum = 0;
+static _threadlocal int overrideState = 0; // 0: none, 1: no prefix, 2: overrideFrameNum
+
 void log_framePrefixer_setFrameNumReference(int* frameNumReference)
 {
 	frameNumRef = frameNumReference;
@@ -24,7 +28,10 @@ void log_framePrefixer_setFrameNumReference(int* frameNumReference)
 
 size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
 {
-	if (frameNumRef == nullptr) {
+	if (overrideState == 2)
+		return (SNPRINTF(result, resultSize, "[f=%07d] ", overrideFrameNum));
+
+	if (frameNumRef == nullptr || overrideState == 1) {
 		if (resultSize > 0) {
 			result[0] = '\0';
 			return 1;
@@ -35,6 +42,21 @@ size_t log_framePrefixer_createPrefix(char* result, size_t resultSize)
 	return (SNPRINTF(result, resultSize, "[f=%07d] ", *frameNumRef));
 }
 
+int log_framePrefixer_getFrameNum(int* frameNum)
+{
+	if (frameNumRef == nullptr)
+		return 0;
+
+	*frameNum = *frameNumRef;
+	return 1;
+}
+
+void log_framePrefixer_overrideFrameNum(int override, int hasFrameNum, int frameNum)
+{
+	overrideFrameNum = frameNum;
+	overrideState = (override != 0) * (1 + (hasFrameNum != 0));
+}
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -22,6 +22,20 @@ void log_framePrefixer_setFrameNumReference(int* frameNumReference);
  */
 size_t log_framePrefixer_createPrefix(char* result, size_t resultSize);
 
+/**
+ * Stores the frame number a prefix created now would contain.
+ * @return 0 if there is none (no prefix), 1 otherwise
+ */
+int log_framePrefixer_getFrameNum(int* frameNum);
+
+/**
+ * Makes prefixes created on the calling thread contain <frameNum> (or
+ * nothing if <hasFrameNum> is 0) instead of the current frame number,
+ * until called again with <override> set to 0.
+ * Used by the asynchronous log writer thread.
+ */
+void log_framePrefixer_overrideFrameNum(int override, int hasFrameNum, int frameNum);
+
 #ifdef __cplusplus
 } // extern "C"
 #endif
@@ -6,6 +6,7 @@
 #include "Game/GameVersion.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/FileSystem/FileSystem.h"
+#include "System/Log/Backend.h"
 #include "System/Log/DefaultFilter.h"
 #include "System/Log/FileSink.h"
 #include "System/Log/ILog.h"
@@ -43,6 +44,15 @@ CONFIG(int, LogRepeatLimit)
 	.defaultValue(10)
 	.description("Allow at most this many consecutive identical messages to be logged.");
 
+CONFIG(bool, LogAsync)
+	.defaultValue(true)
+	.description("Write the logfile and console output from a separate thread; records are flushed synchronously on crashes.");
+
+CONFIG(int, LogAsyncQueueSize)
+	.defaultValue(16384)
+	.minimumValue(256)
+	.description("Maximum number of log records waiting for the LogAsync writer thread, further records are dropped (and counted).");
+
 /******************************************************************************/
 /******************************************************************************/
 
@@ -184,6 +194,7 @@ void CLogOutput::Initialize()
 
 	log_filter_setRepeatLimit(configHandler->GetInt("LogRepeatLimit")); // all sinks
 	log_file_addLogFile(filePath.c_str(), nullptr, LOG_LEVEL_ALL, configHandler->GetInt("LogFlushLevel"));
+	log_backend_setAsync(configHandler->GetBool("LogAsync"), configHandler->GetInt("LogAsyncQueueSize"));
 
 	LOG("LogOutput initialized. Logging to %s", filePath.c_str());
 }
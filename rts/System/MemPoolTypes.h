@@ -6,8 +6,10 @@
 #include <cassert>
 #include <cstring> // memset
 
+#include <algorithm>
 #include <array>
 #include <deque>
+#include <functional>
 #include <vector>
 
 #include <memory>
@@ -221,6 +223,194 @@ private:
 
 
 
+// size-segregated dynamic version
+// number of chunks and pages per chunk (per class), page sizes
+// objects are placed in the smallest class whose page size S_i fits
+// them; every class grows by one chunk of K pages at a time so memory
+// follows the per-class demand, and at most <N * K> allocations can be
+// made from each class
+template<size_t N, size_t K, size_t... S> struct MultiSizeMemPool {
+public:
+	template<typename T, typename... A> T* alloc(A&&... a) {
+		constexpr size_t c = SIZE_CLASS(sizeof(T));
+
+		static_assert(c < NUM_CLASSES(), "");
+		return (new (allocPage(c)) T(std::forward<A>(a)...));
+	}
+
+	void* allocMem(size_t size) {
+		assert(SIZE_CLASS(size) < NUM_CLASSES());
+		return (allocPage(SIZE_CLASS(size)));
+	}
+
+	// default-constructs up to <n> T's in ascending page order (contiguous
+	// when they come from a fresh chunk), returns the number allocated
+	template<typename T, typename B> size_t alloc_n(B** objs, size_t n) {
+		constexpr size_t c = SIZE_CLASS(sizeof(T));
+
+		static_assert(c < NUM_CLASSES(), "");
+
+		t_size_class& sc = classes[c];
+
+		while (sc.indcs.size() < n && addChunk(c));
+
+		const size_t m = std::min(n, sc.indcs.size());
+
+		// indices are popped from the back
+		std::sort(sc.indcs.end() - m, sc.indcs.end(), std::greater<uint32_t>());
+
+		for (size_t i = 0; i < m; i++) {
+			objs[i] = new (allocPage(c)) T();
+		}
+
+		return m;
+	}
+
+
+	template<typename T> void free(T*& ptr) {
+		T* tmp = ptr;
+
+		spring::SafeDestruct(ptr);
+		freeMem(tmp);
+	}
+
+	void freeMem(void* ptr) {
+		const t_page_hdr hdr = page_hdr(ptr);
+
+		assert(mapped(ptr));
+		memset(page_mem(hdr.cls, hdr.idx), 0, PAGE_STRIDE(hdr.cls));
+
+		classes[hdr.cls].indcs.push_back(hdr.idx);
+	}
+
+
+	void reserve(size_t n) {
+		for (t_size_class& sc: classes) {
+			sc.indcs.reserve(n);
+		}
+	}
+	void clear() {
+		// for every allocated chunk, add back all indices
+		// (objects are assumed to have already been freed)
+		for (t_size_class& sc: classes) {
+			sc.indcs.clear();
+
+			for (size_t i = 0; i < sc.num_chunks; i++) {
+				for (size_t j = 0; j < K; j++) {
+					sc.indcs.push_back(static_cast<uint32_t>((i + 1) * K - j - 1));
+				}
+			}
+		}
+
+		page_class = 0;
+		page_index = 0;
+	}
+
+
+	static constexpr size_t NUM_CLASSES() { return (sizeof...(S)); }
+	static constexpr size_t NUM_CHUNKS() { return N; } // per class
+	static constexpr size_t NUM_PAGES() { return K; } // per chunk
+	static constexpr size_t PAGE_SIZE(size_t c) { return (PAGE_SIZES[c]); }
+	// header plus page, rounded up to keep objects 8-byte aligned
+	static constexpr size_t PAGE_STRIDE(size_t c) { return ((sizeof(t_page_hdr) + PAGE_SIZES[c] + 7) & ~size_t(7)); }
+	// NUM_CLASSES() if <size> does not fit any class
+	static constexpr size_t SIZE_CLASS(size_t size) {
+		size_t c = 0;
+
+		while (c < NUM_CLASSES() && PAGE_SIZES[c] < size)
+			c += 1;
+
+		return c;
+	}
+
+	size_t alloc_size(size_t c) const { return (classes[c].num_chunks * NUM_PAGES() * PAGE_SIZE(c)); }
+	size_t freed_size(size_t c) const { return (classes[c].indcs.size() * PAGE_SIZE(c)); }
+	size_t alloc_size() const { size_t n = 0; for (size_t c = 0; c < NUM_CLASSES(); c++) { n += alloc_size(c); } return n; }
+	size_t freed_size() const { size_t n = 0; for (size_t c = 0; c < NUM_CLASSES(); c++) { n += freed_size(c); } return n; }
+
+	size_t alloc_count(size_t c) const { return (classes[c].num_chunks * NUM_PAGES()); } // pages added over the pool's lifetime
+	size_t freed_count(size_t c) const { return (classes[c].indcs.size()); }
+	size_t used_count(size_t c) const { return (alloc_count(c) - freed_count(c)); }
+
+	bool mapped(void* ptr) const {
+		const t_page_hdr hdr = page_hdr(ptr);
+
+		if (hdr.cls >= NUM_CLASSES() || hdr.idx >= (classes[hdr.cls].num_chunks * K))
+			return false;
+
+		return (page_mem(hdr.cls, hdr.idx, sizeof(t_page_hdr)) == ptr);
+	}
+	bool alloced(void* ptr) const {
+		return ((page_index < (classes[page_class].num_chunks * K)) && (page_mem(page_class, page_index, sizeof(t_page_hdr)) == ptr));
+	}
+
+private:
+	// precedes every page; 8 bytes so the page itself stays aligned
+	struct t_page_hdr {
+		uint32_t cls;
+		uint32_t idx;
+	};
+
+	struct t_size_class {
+		std::array<std::unique_ptr<uint8_t[]>, N> chunks;
+		std::vector<uint32_t> indcs;
+
+		size_t num_chunks = 0;
+	};
+
+	bool addChunk(size_t c) {
+		t_size_class& sc = classes[c];
+
+		// class is full
+		if (sc.num_chunks == N)
+			return false;
+
+		assert(sc.chunks[sc.num_chunks] == nullptr);
+		sc.chunks[sc.num_chunks].reset(new uint8_t[K * PAGE_STRIDE(c)]());
+
+		// reserve new indices; in reverse order since each will be popped from the back
+		sc.indcs.reserve(sc.indcs.size() + K);
+
+		for (size_t j = 0; j < K; j++) {
+			sc.indcs.push_back(static_cast<uint32_t>((sc.num_chunks + 1) * K - j - 1));
+		}
+
+		sc.num_chunks += 1;
+		return true;
+	}
+
+	void* allocPage(size_t c) {
+		t_size_class& sc = classes[c];
+
+		if (sc.indcs.empty() && !addChunk(c))
+			return nullptr;
+
+		const t_page_hdr hdr = {static_cast<uint32_t>(c), spring::VectorBackPop(sc.indcs)};
+		uint8_t* ptr = page_mem(page_class = hdr.cls, page_index = hdr.idx);
+
+		memcpy(ptr, &hdr, sizeof(hdr));
+		return (ptr + sizeof(hdr));
+	}
+
+	const uint8_t* page_mem(size_t c, size_t idx, size_t ofs = 0) const { return (classes[c].chunks[idx / K].get() + (idx % K) * PAGE_STRIDE(c) + ofs); }
+	      uint8_t* page_mem(size_t c, size_t idx, size_t ofs = 0)       { return (classes[c].chunks[idx / K].get() + (idx % K) * PAGE_STRIDE(c) + ofs); }
+
+	t_page_hdr page_hdr(const void* ptr) const {
+		t_page_hdr hdr;
+		memcpy(&hdr, reinterpret_cast<const uint8_t*>(ptr) - sizeof(hdr), sizeof(hdr));
+		return hdr;
+	}
+
+private:
+	static constexpr std::array<size_t, sizeof...(S)> PAGE_SIZES = {{S...}};
+
+	std::array<t_size_class, sizeof...(S)> classes;
+
+	size_t page_class = 0;
+	size_t page_index = 0;
+};
+
+
 // fixed-size version
 template<size_t N, size_t S> struct StaticMemPool {
 public:
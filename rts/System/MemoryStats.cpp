@@ -0,0 +1,145 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/MemoryStats.h"
+#include "System/Log/ILog.h"
+#include "System/Threading/SpringThreading.h"
+
+#include <algorithm>
+
+
+namespace MemoryStats {
+	struct Source {
+		std::string name;
+		UsageFunc func;
+		Usage usage;
+	};
+
+	// function-local, sources register during static initialization
+	static std::vector<Source>& GetSources() {
+		static std::vector<Source> sources;
+		return sources;
+	}
+
+	static spring::spinlock& GetMutex() {
+		static spring::spinlock mutex;
+		return mutex;
+	}
+
+
+	void Register(const char* name, UsageFunc func)
+	{
+		std::lock_guard<spring::spinlock> lock(GetMutex());
+		std::vector<Source>& sources = GetSources();
+
+		const auto pred = [&](const Source& s) { return (s.name == name); };
+		const auto iter = std::find_if(sources.begin(), sources.end(), pred);
+
+		if (iter != sources.end()) {
+			iter->func = std::move(func);
+			return;
+		}
+
+		sources.push_back({name, std::move(func), {}});
+
+		// keep sorted so readers need not
+		std::sort(sources.begin(), sources.end(), [](const Source& a, const Source& b) { return (a.name < b.name); });
+	}
+
+	void UnRegister(const char* name)
+	{
+		std::lock_guard<spring::spinlock> lock(GetMutex());
+		std::vector<Source>& sources = GetSources();
+
+		const auto pred = [&](const Source& s) { return (s.name == name); };
+		const auto iter = std::find_if(sources.begin(), sources.end(), pred);
+
+		if (iter != sources.end())
+			sources.erase(iter);
+	}
+
+
+	void Update()
+	{
+		std::vector<Source>& sources = GetSources();
+
+		// sources are only added or removed during init and load, copy so
+		// the callbacks do not run with the lock held
+		std::vector<UsageFunc> funcs;
+		std::vector<Usage> usages;
+
+		{
+			std::lock_guard<spring::spinlock> lock(GetMutex());
+
+			funcs.reserve(sources.size());
+
+			for (const Source& s: sources) {
+				funcs.push_back(s.func);
+			}
+		}
+
+		usages.reserve(funcs.size());
+
+		for (const UsageFunc& f: funcs) {
+			usages.push_back(f());
+		}
+
+		std::lock_guard<spring::spinlock> lock(GetMutex());
+
+		// bail if a source was (un)registered meanwhile, the next poll catches up
+		if (sources.size() != usages.size())
+			return;
+
+		for (size_t i = 0; i < sources.size(); i++) {
+			Usage& u = sources[i].usage;
+
+			u.liveBytes = usages[i].liveBytes;
+			u.peakBytes = std::max(u.peakBytes, std::max(usages[i].peakBytes, usages[i].liveBytes));
+		}
+	}
+
+
+	void GetEntries(std::vector<Entry>& entries)
+	{
+		std::lock_guard<spring::spinlock> lock(GetMutex());
+
+		entries.clear();
+		entries.reserve(GetSources().size());
+
+		for (const Source& s: GetSources()) {
+			entries.push_back({s.name, s.usage});
+		}
+	}
+
+	Usage GetTotal()
+	{
+		std::lock_guard<spring::spinlock> lock(GetMutex());
+
+		Usage total;
+
+		// sum of the peaks, the peaks were not necessarily reached at the same time
+		for (const Source& s: GetSources()) {
+			total.liveBytes += s.usage.liveBytes;
+			total.peakBytes += s.usage.peakBytes;
+		}
+
+		return total;
+	}
+
+
+	void Print()
+	{
+		std::vector<Entry> entries;
+
+		GetEntries(entries);
+
+		LOG("[MemoryStats] %-32s %12s %12s", "source", "live (KB)", "peak (KB)");
+
+		for (const Entry& e: entries) {
+			LOG("[MemoryStats] %-32s %12.1f %12.1f", e.name.c_str(), e.usage.liveBytes / 1024.0, e.usage.peakBytes / 1024.0);
+		}
+
+		const Usage total = GetTotal();
+
+		LOG("[MemoryStats] %-32s %12.1f %12.1f", "total", total.liveBytes / 1024.0, total.peakBytes / 1024.0);
+	}
+}
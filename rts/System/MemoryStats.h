@@ -0,0 +1,58 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef MEMORY_STATS_H
+#define MEMORY_STATS_H
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Registry of the engine's large memory consumers
+ * Subsystems register a named source (usually via a static Registrar next
+ * to the allocator it describes) that reports how many bytes it currently
+ * holds and, if it knows, the most it ever held. Update polls all sources
+ * about once per second; peaks of sources that do not track their own are
+ * the largest value seen by those polls. Names follow the profiler's
+ * "Sim::Los" style.
+ */
+namespace MemoryStats {
+	struct Usage {
+		std::uint64_t liveBytes = 0;
+		std::uint64_t peakBytes = 0;
+	};
+
+	struct Entry {
+		std::string name;
+		Usage usage;
+	};
+
+	typedef std::function<Usage()> UsageFunc;
+
+	/// replaces an existing source of the same name
+	void Register(const char* name, UsageFunc func);
+	void UnRegister(const char* name);
+
+	/// polls all sources, main thread only
+	void Update();
+
+	/// the values of the last Update sorted by name, callable from any thread
+	void GetEntries(std::vector<Entry>& entries);
+	Usage GetTotal();
+
+	void Print();
+
+
+	/// for the {alloc,freed}_size interface of MemPoolTypes; pools never shrink, so peak is their size
+	template<typename PoolType> Usage GetPoolUsage(const PoolType& pool) {
+		return {pool.alloc_size() - pool.freed_size(), pool.alloc_size()};
+	}
+
+	struct Registrar {
+	public:
+		Registrar(const char* name, UsageFunc func) { Register(name, std::move(func)); }
+	};
+}
+
+#endif // MEMORY_STATS_H
@@ -64,12 +64,16 @@ public:
 	unsigned int GetDataReceived() const { return dataRecv; }
 	unsigned int GetNumQueuedPings() const { return numPings; }
 	virtual unsigned int GetPacketQueueSize() const { return 0; }
+	virtual unsigned int GetOutgoingQueueSize() const { return 0; }
+	virtual unsigned int GetUnackedChunkCount() const { return 0; }
 
 	virtual std::string Statistics() const = 0;
 	virtual std::string GetFullAddress() const = 0;
 	virtual void Unmute() = 0;
 	virtual void Close(bool flush = false) = 0;
 	virtual void SetLossFactor(int factor) = 0;
+	/// pack outgoing messages per sim-frame into NETMSG_FRAMEBUNDLE's, if supported
+	virtual void SetFrameBundling(bool enable) {}
 
 	/**
 	 * @brief update internals
@@ -0,0 +1,207 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "FrameBundle.h"
+#include "ProtocolDef.h"
+#include "Net/Protocol/NetMessageTypes.h"
+#include "System/Log/ILog.h"
+
+#include <cassert>
+#include <cstring>
+
+namespace netcode {
+
+// NETMSG_FRAMEBUNDLE, uint16_t messageSize, uint16_t rawSize
+static constexpr unsigned int BUNDLE_HEADER_SIZE = 1 + 2 + 2;
+
+// negative means raw deflate (no zlib header or checksum, the link is reliable)
+static constexpr int BUNDLE_WINDOW_BITS = -12;
+static constexpr int BUNDLE_MEM_LEVEL   =   5;
+
+static_assert(FrameBundler::MAX_BUNDLE_SIZE <= (1u << -BUNDLE_WINDOW_BITS), "");
+static_assert(FrameBundler::MAX_BUNDLE_SIZE <= 0xFFFF - BUNDLE_HEADER_SIZE, "");
+
+
+static const std::vector<std::uint8_t>& GetBundleDictionary()
+{
+	// deflate favors matches near the end of the dictionary, so the
+	// most frequent server-to-client sequences are appended last
+	static const std::vector<std::uint8_t> dict = []() {
+		std::vector<std::uint8_t> d;
+
+		const auto Append = [&](std::initializer_list<std::uint8_t> bytes) { d.insert(d.end(), bytes); };
+
+		// params of common unit commands: float 0, float 1, float -1 and empty ids
+		Append({0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+		Append({0x00, 0x00, 0x80, 0x3f, 0x00, 0x00, 0x80, 0xbf});
+		Append({0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff});
+
+		Append({NETMSG_MAPDRAW});
+		Append({NETMSG_LUAMSG});
+		Append({NETMSG_SELECT});
+		Append({NETMSG_AICOMMAND});
+		Append({NETMSG_COMMAND, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+		Append({NETMSG_PLAYERINFO, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00});
+		Append({NETMSG_KEYFRAME, 0x00, 0x00, 0x00, 0x00});
+		Append({NETMSG_NEWFRAME, NETMSG_NEWFRAME, NETMSG_NEWFRAME, NETMSG_NEWFRAME});
+
+		return d;
+	}();
+
+	return dict;
+}
+
+
+FrameBundler::FrameBundler()
+{
+	memset(&deflStream, 0, sizeof(deflStream));
+	memset(&inflStream, 0, sizeof(inflStream));
+
+	pendingPackets.reserve(32);
+}
+
+FrameBundler::~FrameBundler()
+{
+	if (deflInited)
+		deflateEnd(&deflStream);
+	if (inflInited)
+		inflateEnd(&inflStream);
+}
+
+
+bool FrameBundler::IsBundled(const RawPacket& packet)
+{
+	return (packet.length > BUNDLE_HEADER_SIZE && packet.data[0] == NETMSG_FRAMEBUNDLE);
+}
+
+bool FrameBundler::Add(std::shared_ptr<const RawPacket> packet)
+{
+	if (pendingPackets.empty()) {
+		firstPacketTime = spring_gettime();
+		rawBuffer.clear();
+	}
+
+	rawBuffer.insert(rawBuffer.end(), packet->data, packet->data + packet->length);
+	pendingPackets.push_back(std::move(packet));
+
+	const std::uint8_t msgCode = pendingPackets.back()->data[0];
+	const bool frameMsg = (msgCode == NETMSG_NEWFRAME || msgCode == NETMSG_KEYFRAME);
+
+	return (frameMsg || rawBuffer.size() >= MAX_BUNDLE_SIZE);
+}
+
+void FrameBundler::Seal(std::deque< std::shared_ptr<const RawPacket> >& packets)
+{
+	if (pendingPackets.empty())
+		return;
+
+	const auto SealRaw = [&]() {
+		packets.insert(packets.end(), pendingPackets.begin(), pendingPackets.end());
+		pendingPackets.clear();
+	};
+
+	// a single message can only grow
+	if (pendingPackets.size() == 1 || rawBuffer.size() > MAX_BUNDLE_SIZE) {
+		SealRaw();
+		return;
+	}
+
+	if (!deflInited) {
+		if (deflateInit2(&deflStream, Z_BEST_SPEED, Z_DEFLATED, BUNDLE_WINDOW_BITS, BUNDLE_MEM_LEVEL, Z_DEFAULT_STRATEGY) != Z_OK) {
+			SealRaw();
+			return;
+		}
+
+		deflInited = true;
+	}
+
+	const std::vector<std::uint8_t>& dict = GetBundleDictionary();
+
+	deflateReset(&deflStream);
+	deflateSetDictionary(&deflStream, dict.data(), dict.size());
+
+	deflBuffer.resize(deflateBound(&deflStream, rawBuffer.size()));
+
+	deflStream.next_in   = rawBuffer.data();
+	deflStream.avail_in  = rawBuffer.size();
+	deflStream.next_out  = deflBuffer.data();
+	deflStream.avail_out = deflBuffer.size();
+
+	if (deflate(&deflStream, Z_FINISH) != Z_STREAM_END) {
+		SealRaw();
+		return;
+	}
+
+	const unsigned int deflSize = deflStream.total_out;
+	const unsigned int bundleSize = BUNDLE_HEADER_SIZE + deflSize;
+
+	if (bundleSize >= rawBuffer.size()) {
+		SealRaw();
+		return;
+	}
+
+	RawPacket* bundle = new RawPacket(bundleSize, NETMSG_FRAMEBUNDLE);
+	*bundle << static_cast<std::uint16_t>(bundleSize);
+	*bundle << static_cast<std::uint16_t>(rawBuffer.size());
+	memcpy(bundle->GetWritingPos(), deflBuffer.data(), deflSize);
+
+	packets.push_back(SharePacket(bundle));
+	pendingPackets.clear();
+}
+
+
+bool FrameBundler::Expand(const RawPacket& bundle, std::deque< std::shared_ptr<const RawPacket> >& packets)
+{
+	assert(IsBundled(bundle));
+
+	std::uint16_t rawSize = 0;
+	memcpy(&rawSize, bundle.data + 3, sizeof(rawSize));
+
+	if (rawSize == 0 || rawSize > MAX_BUNDLE_SIZE)
+		return false;
+
+	if (!inflInited) {
+		if (inflateInit2(&inflStream, BUNDLE_WINDOW_BITS) != Z_OK)
+			return false;
+
+		inflInited = true;
+	}
+
+	const std::vector<std::uint8_t>& dict = GetBundleDictionary();
+
+	inflateReset(&inflStream);
+	inflateSetDictionary(&inflStream, dict.data(), dict.size());
+
+	inflBuffer.resize(rawSize);
+
+	inflStream.next_in   = bundle.data + BUNDLE_HEADER_SIZE;
+	inflStream.avail_in  = bundle.length - BUNDLE_HEADER_SIZE;
+	inflStream.next_out  = inflBuffer.data();
+	inflStream.avail_out = inflBuffer.size();
+
+	if (inflate(&inflStream, Z_FINISH) != Z_STREAM_END || inflStream.total_out != rawSize)
+		return false;
+
+	const ProtocolDef* proto = ProtocolDef::GetInstance();
+	const size_t numPackets = packets.size();
+
+	for (unsigned int pos = 0; pos < rawSize; ) {
+		const unsigned char* bufp = &inflBuffer[pos];
+		const unsigned int msgLength = rawSize - pos;
+
+		const int pktLength = proto->PacketLength(bufp, msgLength);
+
+		// bundles never nest, and never contain partial messages
+		if (!proto->IsValidLength(pktLength, msgLength) || *bufp == NETMSG_FRAMEBUNDLE) {
+			LOG_L(L_ERROR, "[FrameBundler::%s] discarding bundle with invalid message: ID %d, LEN %d", __func__, (int)*bufp, pktLength);
+			packets.resize(numPackets);
+			return false;
+		}
+
+		packets.push_back(SharePacket(new RawPacket(bufp, pktLength)));
+		pos += pktLength;
+	}
+
+	return true;
+}
+
+}
@@ -0,0 +1,77 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _FRAME_BUNDLE_H
+#define _FRAME_BUNDLE_H
+
+#include <cinttypes>
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include <zlib.h>
+
+#include "RawPacket.h"
+#include "System/Misc/NonCopyable.h"
+#include "System/Misc/SpringTime.h"
+
+namespace netcode
+{
+
+/**
+ * @brief Packs all messages a connection sends for one sim-frame into a single NETMSG_FRAMEBUNDLE
+ * Commands, player-info and the frame message that follows them are
+ * concatenated and deflated as one, which removes most per-message
+ * framing and lets repeated command layouts compress against each other
+ * and against a small fixed dictionary of common message prefixes.
+ * Every bundle is compressed on its own so that reconnects and resent
+ * chunks need no shared stream state.
+ */
+class FrameBundler : spring::noncopyable
+{
+public:
+	/// raw bytes after which a bundle is sealed early, also bounds the deflate window
+	static constexpr unsigned int MAX_BUNDLE_SIZE = 4096;
+
+	FrameBundler();
+	~FrameBundler();
+
+	/// @return true if the bundle should be sealed now (after a frame message or when full)
+	bool Add(std::shared_ptr<const RawPacket> packet);
+
+	/**
+	 * @brief Moves all pending messages to <packets>
+	 * As one bundle if that is smaller, otherwise unchanged.
+	 */
+	void Seal(std::deque< std::shared_ptr<const RawPacket> >& packets);
+
+	/**
+	 * @brief Appends the messages contained in <bundle> to <packets>
+	 * @return false if the bundle could not be inflated
+	 */
+	bool Expand(const RawPacket& bundle, std::deque< std::shared_ptr<const RawPacket> >& packets);
+
+	bool Empty() const { return pendingPackets.empty(); }
+	spring_time GetFirstPacketTime() const { return firstPacketTime; }
+
+	static bool IsBundled(const RawPacket& packet);
+
+private:
+	std::vector< std::shared_ptr<const RawPacket> > pendingPackets;
+
+	// pending outgoing messages, back to back
+	std::vector<std::uint8_t> rawBuffer;
+	std::vector<std::uint8_t> deflBuffer;
+	std::vector<std::uint8_t> inflBuffer;
+
+	spring_time firstPacketTime;
+
+	z_stream deflStream;
+	z_stream inflStream;
+
+	bool deflInited = false;
+	bool inflInited = false;
+};
+
+}
+
+#endif // _FRAME_BUNDLE_H
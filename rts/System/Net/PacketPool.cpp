@@ -0,0 +1,125 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PacketPool.h"
+#include "RawPacket.h"
+#include "System/Threading/SpringThreading.h"
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <new>
+#include <vector>
+
+namespace netcode
+{
+
+struct BlockList {
+	spring::spinlock lock;
+	std::vector<void*> blocks;
+};
+
+static std::array<BlockList, PacketPool::NUM_BLOCK_SIZES>& GetBlockLists()
+{
+	// never destroyed, packets may still be freed by other static dtors
+	static std::array<BlockList, PacketPool::NUM_BLOCK_SIZES>* blockLists = new std::array<BlockList, PacketPool::NUM_BLOCK_SIZES>();
+	return *blockLists;
+}
+
+static std::atomic<std::uint64_t> numAllocs = {0};
+static std::atomic<std::uint64_t> numReused = {0};
+static std::atomic<std::uint64_t> numUnpooled = {0};
+static std::atomic<std::uint64_t> numFrees = {0};
+
+static_assert((PacketPool::MIN_BLOCK_SIZE << (PacketPool::NUM_BLOCK_SIZES - 1)) == PacketPool::MAX_BLOCK_SIZE, "");
+
+
+static size_t GetBlockIndex(size_t size)
+{
+	size_t idx = 0;
+
+	while ((PacketPool::MIN_BLOCK_SIZE << idx) < size)
+		idx += 1;
+
+	return idx;
+}
+
+
+void* PacketPool::Alloc(size_t size)
+{
+	numAllocs += 1;
+
+	if (size > MAX_BLOCK_SIZE) {
+		numUnpooled += 1;
+		return ::operator new(size);
+	}
+
+	const size_t idx = GetBlockIndex(size);
+
+	BlockList& list = GetBlockLists()[idx];
+
+	{
+		std::lock_guard<spring::spinlock> lock(list.lock);
+
+		if (!list.blocks.empty()) {
+			void* ptr = list.blocks.back();
+			list.blocks.pop_back();
+
+			numReused += 1;
+			return ptr;
+		}
+	}
+
+	return ::operator new(MIN_BLOCK_SIZE << idx);
+}
+
+void PacketPool::Free(void* ptr, size_t size)
+{
+	if (ptr == nullptr)
+		return;
+
+	numFrees += 1;
+
+	if (size > MAX_BLOCK_SIZE) {
+		::operator delete(ptr);
+		return;
+	}
+
+	BlockList& list = GetBlockLists()[GetBlockIndex(size)];
+
+	{
+		std::lock_guard<spring::spinlock> lock(list.lock);
+
+		if (list.blocks.size() < MAX_FREE_BLOCKS) {
+			list.blocks.push_back(ptr);
+			return;
+		}
+	}
+
+	::operator delete(ptr);
+}
+
+
+PacketPool::Stats PacketPool::GetStats()
+{
+	Stats stats;
+	stats.numAllocs = numAllocs;
+	stats.numReused = numReused;
+	stats.numUnpooled = numUnpooled;
+	stats.numLive = stats.numAllocs - numFrees;
+	stats.numFree = 0;
+
+	for (BlockList& list: GetBlockLists()) {
+		std::lock_guard<spring::spinlock> lock(list.lock);
+		stats.numFree += list.blocks.size();
+	}
+
+	return stats;
+}
+
+
+std::shared_ptr<const RawPacket> SharePacket(RawPacket* packet)
+{
+	return std::shared_ptr<const RawPacket>(packet, std::default_delete<RawPacket>(), PacketPoolAllocator<RawPacket>());
+}
+
+} // namespace netcode
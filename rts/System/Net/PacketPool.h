@@ -0,0 +1,68 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _PACKET_POOL_H
+#define _PACKET_POOL_H
+
+#include <cinttypes>
+#include <cstddef>
+#include <memory>
+
+namespace netcode
+{
+
+class RawPacket;
+
+/**
+ * @brief Recycles the memory of network messages
+ * Every sim-frame creates dozens of small and short-lived packets on the
+ * server and on each client, each needing a payload buffer, a RawPacket
+ * and a shared_ptr control-block. Blocks up to MAX_BLOCK_SIZE bytes are
+ * rounded up to a power of two and kept in per-size free-lists instead
+ * of being returned to the heap; larger blocks bypass the pool.
+ * Thread-safe, packets are created by the server and game threads.
+ */
+class PacketPool
+{
+public:
+	static constexpr size_t MIN_BLOCK_SIZE   =   16;
+	static constexpr size_t MAX_BLOCK_SIZE   = 4096;
+	static constexpr size_t NUM_BLOCK_SIZES  =    9; // MIN_BLOCK_SIZE << [0, NUM_BLOCK_SIZES)
+	static constexpr size_t MAX_FREE_BLOCKS  = 1024; // per block-size, more are returned to the heap
+
+	struct Stats {
+		std::uint64_t numAllocs;    // all blocks handed out
+		std::uint64_t numReused;    // blocks taken from a free-list
+		std::uint64_t numUnpooled;  // blocks larger than MAX_BLOCK_SIZE
+		std::uint64_t numLive;      // blocks not yet freed
+		std::uint64_t numFree;      // blocks waiting in free-lists
+	};
+
+	static void* Alloc(size_t size);
+	/// <size> must equal the size passed to Alloc
+	static void Free(void* ptr, size_t size);
+
+	static Stats GetStats();
+};
+
+
+/// std::allocator replacement that takes its memory from PacketPool
+template<typename T> struct PacketPoolAllocator {
+	typedef T value_type;
+
+	PacketPoolAllocator() = default;
+	template<typename U> PacketPoolAllocator(const PacketPoolAllocator<U>&) {}
+
+	T* allocate(size_t n) { return static_cast<T*>(PacketPool::Alloc(n * sizeof(T))); }
+	void deallocate(T* p, size_t n) { PacketPool::Free(p, n * sizeof(T)); }
+
+	template<typename U> bool operator == (const PacketPoolAllocator<U>&) const { return true; }
+	template<typename U> bool operator != (const PacketPoolAllocator<U>&) const { return false; }
+};
+
+
+/// takes ownership of <packet>, with the control-block also coming from PacketPool
+std::shared_ptr<const RawPacket> SharePacket(RawPacket* packet);
+
+} // namespace netcode
+
+#endif // _PACKET_POOL_H
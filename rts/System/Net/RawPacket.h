@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 
+#include "PacketPool.h"
 #include "System/SafeVector.h"
 
 namespace netcode
@@ -39,7 +40,7 @@ public:
 		if (length == 0)
 			return;
 
-		data = new uint8_t[length];
+		data = static_cast<uint8_t*>(PacketPool::Alloc(length));
 	}
 
 	RawPacket(const uint32_t length, uint8_t msgID): RawPacket(length) {
@@ -51,6 +52,9 @@ public:
 
 	~RawPacket() { Delete(); }
 
+	static void* operator new(size_t size) { return PacketPool::Alloc(size); }
+	static void operator delete(void* ptr, size_t size) { PacketPool::Free(ptr, size); }
+
 
 	RawPacket& operator = (const RawPacket&  p) = delete;
 	RawPacket& operator = (      RawPacket&& p) {
@@ -116,7 +120,7 @@ public:
 		if (length == 0)
 			return;
 
-		delete[] data;
+		PacketPool::Free(data, length);
 		data = nullptr;
 
 		length = 0;
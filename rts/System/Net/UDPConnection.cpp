@@ -1,14 +1,18 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
 #include "UDPConnection.h"
+#include "UDPSendQueue.h"
+#include "FrameBundle.h"
 
 #include <cinttypes>
+#include <limits>
 
 
 #include "Socket.h"
 #include "ProtocolDef.h"
 #include "Exception.h"
 #include "Net/Protocol/BaseNetProtocol.h"
+#include "Sim/Misc/GlobalConstants.h"
 #include "System/Config/ConfigHandler.h"
 #include "System/CRC.h"
 #include "System/GlobalConfig.h"
@@ -154,10 +158,12 @@ Packet::Packet(const unsigned char* data, unsigned length)
 	buf.Unpack(nakType);
 	buf.Unpack(checksum);
 
-	if (nakType > 0) {
-		naks.reserve(nakType);
+	const int numNakBytes = (nakType == SACK_BITMAP)? SACK_BITMAP_SIZE: std::max(int(nakType), 0);
 
-		for (int i = 0; i != nakType; ++i) {
+	if (numNakBytes > 0) {
+		naks.reserve(numNakBytes);
+
+		for (int i = 0; i != numNakBytes; ++i) {
 			if (buf.Remaining() < sizeof(naks[i]))
 				break;
 
@@ -282,10 +288,13 @@ void UDPConnection::Init()
 	incomingChunkNums.clear();
 	incomingChunkNums.reserve(256);
 
-	resendRequested.clear();
-	resendRequested.reserve(256);
-	erasedResendChunks.clear();
-	erasedResendChunks.reserve(256);
+	unackedChunks.clear();
+	unackedStates.clear();
+	resendQueue.clear();
+	retryQueue.clear();
+
+	smoothedRTT = spring_msecs(0);
+	resendPacing = spring_msecs(0);
 
 	#ifdef ENABLE_DEBUG_STATS
 	sumDeltaFramePacketRecvTime = 0.0f;
@@ -319,7 +328,6 @@ void UDPConnection::Init()
 	#endif
 
 	netLossFactor = globalConfig.networkLossFactor;
-	lastMidChunk = -1;
 #if	NETWORK_TEST
 	lossCounter = 0;
 #endif
@@ -330,12 +338,13 @@ void UDPConnection::ReconnectTo(CConnection& conn) {
 }
 
 void UDPConnection::CopyConnection(UDPConnection &conn) {
-	conn.InitConnection(addr, mySocket);
+	conn.InitConnection(addr, mySocket, sendQueue);
 }
 
-void UDPConnection::InitConnection(ip::udp::endpoint address, std::shared_ptr<ip::udp::socket> socket) {
+void UDPConnection::InitConnection(ip::udp::endpoint address, std::shared_ptr<ip::udp::socket> socket, std::shared_ptr<UDPSendQueue> queue) {
 	addr = address;
 	mySocket = socket;
+	sendQueue = queue;
 }
 
 UDPConnection::~UDPConnection()
@@ -349,7 +358,41 @@ UDPConnection::~UDPConnection()
 void UDPConnection::SendData(std::shared_ptr<const RawPacket> pkt)
 {
 	assert(pkt->length > 0);
-	outgoingData.push_back(pkt);
+
+	// pings measure latency, never hold them back
+	if (!bundleFrames || pkt->data[0] == NETMSG_PING) {
+		outgoingData.push_back(pkt);
+		return;
+	}
+
+	if (frameBundler->Add(std::move(pkt)))
+		frameBundler->Seal(outgoingData);
+}
+
+void UDPConnection::SetFrameBundling(bool enable)
+{
+	if ((bundleFrames = enable) && frameBundler == nullptr)
+		frameBundler.reset(new FrameBundler());
+
+	if (!enable && frameBundler != nullptr)
+		frameBundler->Seal(outgoingData);
+}
+
+void UDPConnection::ExpandFrameBundle(const unsigned char* data, unsigned length)
+{
+	if (frameBundler == nullptr)
+		frameBundler.reset(new FrameBundler());
+
+	const size_t numMessages = msgQueue.size();
+
+	if (!frameBundler->Expand(RawPacket(data, length), msgQueue)) {
+		LOG_L(L_ERROR, "\t[%s] discarding incoming invalid frame-bundle: LEN %u", __func__, length);
+		return;
+	}
+
+	for (size_t i = numMessages; i < msgQueue.size(); i++) {
+		numPings += (msgQueue[i]->data[0] == NETMSG_PING);
+	}
 }
 
 std::shared_ptr<const RawPacket> UDPConnection::Peek(unsigned ahead) const
@@ -485,42 +528,6 @@ void UDPConnection::UpdateWaitingPackets()
 	waitingPackets.erase(pos, end);
 }
 
-void UDPConnection::UpdateResendRequests()
-{
-	using P = decltype(resendRequested)::value_type;
-
-	const auto cmpPred = [](const P& a, const P& b) { return (a.first <  b.first); };
-	const auto dupPred = [](const P& a, const P& b) { return (a.first == b.first); };
-
-	// sort by chunk-number
-	std::sort(resendRequested.begin(), resendRequested.end(), cmpPred);
-
-	{
-		const auto beg = resendRequested.begin();
-		const auto end = resendRequested.end();
-		const auto iter = std::unique(beg, end, dupPred);
-
-		// filter duplicates
-		resendRequested.erase(iter, end);
-	}
-
-	if (erasedResendChunks.empty())
-		return;
-
-	{
-		const auto pred = [&](const std::pair<std::int32_t, ChunkPtr>& p) { return (erasedResendChunks.find(p.first) != erasedResendChunks.end()); };
-
-		const auto beg = resendRequested.begin();
-		const auto end = resendRequested.end();
-		const auto pos = std::remove_if(beg, end, pred);
-
-		// remove chunks that no longer need resending
-		resendRequested.erase(pos, end);
-		erasedResendChunks.clear();
-	}
-}
-
-
 void UDPConnection::ProcessRawPacket(Packet& incoming)
 {
 	#ifdef ENABLE_DEBUG_STATS
@@ -549,47 +556,42 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 
 
 	AckChunks(incoming.lastContinuous);
-	UpdateResendRequests();
 
 	if (!unackedChunks.empty()) {
+		const spring_time curTime = spring_gettime();
 		const int nextCont = incoming.lastContinuous + 1;
-		const int unAckDiff = unackedChunks[0]->chunkNumber - nextCont;
-
-		if (-256 <= unAckDiff && unAckDiff <= 256) {
-			if (incoming.nakType < 0) {
-				for (int i = 0; i != -incoming.nakType; ++i) {
-					const int unAckPos = i + unAckDiff;
-
-					if (unAckPos >= 0 && unAckPos < unackedChunks.size()) {
-						assert(unackedChunks[unAckPos]->chunkNumber == nextCont + i);
-						RequestResend(unackedChunks[unAckPos], true);
-					}
-				}
-			} else if (incoming.nakType > 0) {
-				int unAckPos = 0;
 
-				for (int i = 0; i != incoming.naks.size(); ++i) {
-					if (unAckDiff + incoming.naks[i] < 0)
-						continue;
+		if (incoming.nakType == Packet::SACK_BITMAP) {
+			int numBits = incoming.naks.size() * 8;
 
-					while (unAckPos < (unAckDiff + incoming.naks[i])) {
-						// if there are gaps in the array, assume that further resends are not needed
-						if (unAckPos < unackedChunks.size())
-							erasedResendChunks.insert(unackedChunks[unAckPos]->chunkNumber);
-
-						++unAckPos;
-					}
-
-					if (unAckPos < unackedChunks.size()) {
-						assert(unackedChunks[unAckPos]->chunkNumber == (nextCont + incoming.naks[i]));
-						RequestResend(unackedChunks[unAckPos], true);
-					}
+			// chunks after the last received one are not known to be lost yet
+			while (numBits > 0 && !incoming.GetSackBit(numBits - 1)) {
+				--numBits;
+			}
 
-					++unAckPos;
+			for (int i = 0; i < numBits; ++i) {
+				if (incoming.GetSackBit(i)) {
+					SelectiveAck(nextCont + i);
+				} else {
+					RequestResend(nextCont + i, curTime);
 				}
 			}
+		} else if (incoming.nakType < 0) {
+			for (int i = 0; i != -incoming.nakType; ++i) {
+				RequestResend(nextCont + i, curTime);
+			}
+		} else if (incoming.nakType > 0) {
+			int next = 0;
+
+			for (const std::uint8_t nak: incoming.naks) {
+				// gaps in the list were received
+				for (; next < nak; ++next) {
+					SelectiveAck(nextCont + next);
+				}
 
-			UpdateResendRequests();
+				RequestResend(nextCont + nak, curTime);
+				next = nak + 1;
+			}
 		}
 	}
 
@@ -643,8 +645,11 @@ void UDPConnection::ProcessRawPacket(Packet& incoming)
 			const int pktLength = ProtocolDef::GetInstance()->PacketLength(bufp, msgLength);
 
 			// this returns false for zero/invalid pktLength
-			if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength)) {
-				msgQueue.emplace_back(new RawPacket(bufp, pktLength));
+			if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength) && *bufp == NETMSG_FRAMEBUNDLE) {
+				ExpandFrameBundle(bufp, pktLength);
+				pos += pktLength;
+			} else if (ProtocolDef::GetInstance()->IsValidLength(pktLength, msgLength)) {
+				msgQueue.push_back(SharePacket(new RawPacket(bufp, pktLength)));
 				std::shared_ptr<const RawPacket>& msgPacket = msgQueue.back();
 
 				#ifdef ENABLE_DEBUG_STATS
@@ -700,6 +705,13 @@ void UDPConnection::Flush(const bool forced)
 
 	const spring_time curTime = spring_gettime();
 
+	// bundles normally end with a frame message, do not hold back
+	// messages sent while paused or before the game has started
+	if (frameBundler != nullptr && !frameBundler->Empty()) {
+		if (forced || frameBundler->GetFirstPacketTime() < (curTime - spring_msecs(1000 / GAME_SPEED)))
+			frameBundler->Seal(outgoingData);
+	}
+
 	// do not create chunks more than chunksPerSec times per second
 	const bool waitMore = (lastChunkCreatedTime >= (curTime - spring_msecs(1000 / chunksPerSec)));
 	// if the packet is tiny, reduce the send frequency further
@@ -723,6 +735,10 @@ void UDPConnection::Flush(const bool forced)
 		bool partialPacket = false;
 		bool sendMore = true;
 
+		// bytes of the front packet already copied; it is shared with
+		// other links (broadcasts) so the remainder is never copied out
+		unsigned packetOffset = 0;
+
 		do {
 			sendMore  = (outgoing.GetAverage(true) <= globalConfig.linkOutgoingBandwidth);
 			sendMore |= ((globalConfig.linkOutgoingBandwidth <= 0) || partialPacket || forced);
@@ -737,22 +753,23 @@ void UDPConnection::Flush(const bool forced)
 					);
 					outgoingData.pop_front();
 				} else {
-					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length);
+					const unsigned numBytes = std::min((unsigned)maxChunkSize - pos, packet->length - packetOffset);
 
-					assert(packet->length > 0);
-					memcpy(buffer + pos, packet->data, numBytes);
+					assert(packet->length > packetOffset);
+					memcpy(buffer + pos, packet->data + packetOffset, numBytes);
 
 					pos += numBytes;
 					sentOverhead += Packet::headerSize;
 
 					outgoing.DataSent(numBytes, true);
 
-					if ((partialPacket = (numBytes != packet->length))) {
-						// partially transfered
-						packet.reset(new RawPacket(packet->data + numBytes, packet->length - numBytes));
-					} else {
+					packetOffset += numBytes;
+
+					// if partially transfered, continue with the same packet
+					if (!(partialPacket = (packetOffset != packet->length))) {
 						// full packet copied
 						outgoingData.pop_front();
+						packetOffset = 0;
 					}
 				}
 			}
@@ -809,14 +826,18 @@ std::string UDPConnection::Statistics() const
 		"\t{%.3fx, %.3fx} relative protocol overhead {up, down}\n",
 		"\t%u incoming chunks dropped, %u outgoing chunks resent\n",
 		"\t%u incoming chunks processed\n",
+		"\t%" PRIu64 " packet blocks allocated (%" PRIu64 " reused, %" PRIu64 " unpooled), %" PRIu64 " live, %" PRIu64 " pooled\n",
 	};
 
+	const PacketPool::Stats& poolStats = PacketPool::GetStats();
+
 	std::string msg = "[UDPConnection::Statistics]\n";
 	msg += spring::format(fmts[0], dataSent, sentPackets, spring::SafeDivide(dataSent * 1.0f, sentPackets * 1.0f));
 	msg += spring::format(fmts[1], dataRecv, recvPackets, spring::SafeDivide(dataRecv * 1.0f, recvPackets * 1.0f));
 	msg += spring::format(fmts[2], spring::SafeDivide(sentOverhead * 1.0f, dataSent * 1.0f), spring::SafeDivide(recvOverhead * 1.0f, dataRecv * 1.0f));
 	msg += spring::format(fmts[3], droppedChunks, resentChunks);
 	msg += spring::format(fmts[4], lastInOrder + 1);
+	msg += spring::format(fmts[5], poolStats.numAllocs, poolStats.numReused, poolStats.numUnpooled, poolStats.numLive, poolStats.numFree);
 	return msg;
 }
 
@@ -850,7 +871,6 @@ void UDPConnection::SendIfNecessary(bool flushed)
 	const spring_time unackTime = spring_msecs(400 >> netLossFactor);
 
 	int nak = 0;
-	int rev = 0;
 
 	droppedPackets.clear();
 
@@ -885,11 +905,18 @@ void UDPConnection::SendIfNecessary(bool flushed)
 			nak = std::min(droppedPackets.size(), (size_t)127);
 			// needs 1 byte per requested packet, so do not spam to often
 			lastNakTime = curTime;
+
+			// a bitmap also covers the chunks received in between
+			if (droppedPackets.size() > Packet::SACK_BITMAP_SIZE)
+				nak = Packet::SACK_BITMAP;
 		} else {
 			nak = -(int)std::min(127u, numContinuous);
 		}
 	}
 
+	// do not resend a chunk before an ack for its last copy could have arrived
+	resendPacing = std::max(unackTime * 0.5f, smoothedRTT);
+
 	if (!unackedChunks.empty() &&
 		(curTime - lastChunkCreatedTime) > unackTime &&
 		(curTime - lastUnackResentTime) > unackTime) {
@@ -897,65 +924,38 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		// resend last packet if we didn't get an ack within reasonable time
 		// and don't plan sending out a new chunk either
 		if (newChunks.empty())
-			RequestResend(*unackedChunks.rbegin(), false);
+			RequestResend(unackedChunks.back()->chunkNumber, curTime);
 
 		lastUnackResentTime = curTime;
 	}
 
 
 	const bool flushSend = (flushed || !newChunks.empty());
-	const bool otherSend = (UseMinLossFactor() && !resendRequested.empty());
-	const bool unackSend = (nak > 0) || (difTime > (unackTime * 0.5f));
+	const bool otherSend = (UseMinLossFactor() && NextResendChunk(curTime) != nullptr);
+	const bool unackSend = (nak > 0 || nak == Packet::SACK_BITMAP) || (difTime > (unackTime * 0.5f));
 
 	if (!flushSend && !otherSend && !unackSend)
 		return;
 
-	int maxResend = resendRequested.size();
-	int unackPrevSize = unackedChunks.size();
-
-	decltype(resendRequested)::iterator resFwdIter = resendRequested.begin();
-	decltype(resendRequested)::iterator resMidIter;
-	decltype(resendRequested)::iterator resMidIterStart;
-	decltype(resendRequested)::iterator resMidIterEnd;
-	decltype(resendRequested)::reverse_iterator resRevIter;
-
-	// resend chunk size
-	const auto CalcResendSize = [&]() {
-		return ((UseMinLossFactor() || (rev == 0)) ? resFwdIter->second->GetSize() : ((rev == 1) ? resRevIter->second->GetSize() : resMidIter->second->GetSize()));
-	};
+	// keep resend reasonable, or it could cause a tremendous flood of packets
+	int maxResend = UseMinLossFactor()? std::numeric_limits<int>::max(): (20 * netLossFactor);
 
-	if (!UseMinLossFactor()) {
-		// keep resend reasonable, or it could cause a tremendous flood of packets
-		maxResend = std::min(maxResend, 20 * netLossFactor);
-
-		resMidIter = resendRequested.begin();
-		resMidIterStart = resendRequested.begin();
-		resMidIterEnd = resendRequested.end();
-		resRevIter = resendRequested.rbegin();
-
-		const int resMidStart = (maxResend + 3) / 4;
-		const int resMidEnd   = (maxResend + 2) / 4;
-
-		std::advance(resMidIterStart, resMidStart);
-
-		if (resMidIterStart != resendRequested.end() && lastMidChunk < resMidIterStart->first)
-			lastMidChunk = resMidIterStart->first - 1;
-
-		std::advance(resMidIterEnd, -resMidEnd);
-
-		while (resMidIter != resendRequested.end() && resMidIter->first <= lastMidChunk) {
-			++resMidIter;
-		}
+	while (((outgoing.GetAverage() <= globalConfig.linkOutgoingBandwidth) || (globalConfig.linkOutgoingBandwidth <= 0))) {
+		Packet buf(lastInOrder, nak);
 
-		if (resMidIter == resendRequested.end() || resMidIterEnd == resendRequested.end() || resMidIter->first >= resMidIterEnd->first)
-			resMidIter = resMidIterStart;
-	}
+		if (nak == Packet::SACK_BITMAP) {
+			buf.naks.resize(Packet::SACK_BITMAP_SIZE, 0);
 
+			for (const auto& pair: waitingPackets) {
+				const int bit = pair.first - (lastInOrder + 1);
 
-	while (((outgoing.GetAverage() <= globalConfig.linkOutgoingBandwidth) || (globalConfig.linkOutgoingBandwidth <= 0))) {
-		Packet buf(lastInOrder, nak);
+				if (bit >= 0 && bit < int(Packet::SACK_BITMAP_SIZE * 8))
+					buf.SetSackBit(bit);
+			}
 
-		if (nak > 0) {
+			// 1 request is enough, unless high loss
+			nak *= (1 - UseMinLossFactor());
+		} else if (nak > 0) {
 			buf.naks.resize(nak);
 
 			for (unsigned i = 0; i != buf.naks.size(); ++i) {
@@ -970,8 +970,9 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		bool sent = false;
 
 		while (true) {
-			// NB: if maxResend equals 0, then resendRequested is empty and iterators will be invalid
-			const bool canResend = (maxResend > 0) && ((buf.GetSize() + CalcResendSize()) <= mtu);
+			const ChunkPtr resendChunk = (maxResend > 0)? NextResendChunk(curTime): nullptr;
+
+			const bool canResend = (resendChunk != nullptr) && ((buf.GetSize() + resendChunk->GetSize()) <= mtu);
 			const bool canSendNew = !newChunks.empty() && ((buf.GetSize() + newChunks[0]->GetSize()) <= mtu);
 
 			if (!canResend && !canSendNew)
@@ -981,35 +982,8 @@ void UDPConnection::SendIfNecessary(bool flushed)
 			resend = !resend;
 
 			if (resend && canResend) {
-				if (UseMinLossFactor()) {
-					if (erasedResendChunks.find(resFwdIter->first) == erasedResendChunks.end())
-						buf.chunks.push_back(resFwdIter->second);
-
-					erasedResendChunks.insert((resFwdIter++)->first);
-				} else {
-					// on a lossy connection, just keep resending until it is acked
-					// alternate between sending from front, middle and back of requested
-					// chunks, since this improves performance on high latency connections
-					switch (rev) {
-						case 0: {
-							buf.chunks.push_back((resFwdIter++)->second);
-						} break;
-						case 1: {
-							buf.chunks.push_back((resRevIter++)->second);
-						} break;
-						case 2:
-						case 3: {
-							buf.chunks.push_back(resMidIter->second);
-
-							lastMidChunk = resMidIter->first;
-
-							if ((++resMidIter) == resMidIterEnd)
-								resMidIter = resMidIterStart;
-						} break;
-					}
-
-					rev = (rev + 1) % 4;
-				}
+				buf.chunks.push_back(resendChunk);
+				PopResendChunk(curTime);
 
 				resentChunks += 1;
 				maxResend -= 1;
@@ -1018,7 +992,14 @@ void UDPConnection::SendIfNecessary(bool flushed)
 			} else if (!resend && canSendNew) {
 				buf.chunks.push_back(newChunks[0]);
 				unackedChunks.push_back(newChunks[0]);
+				unackedStates.emplace_back();
+				unackedStates.back().lastSendTime = curTime;
 				newChunks.pop_front();
+
+				// on a lossy connection chunks are resent until acked, once per resendPacing
+				if (!UseMinLossFactor())
+					QueueResend(unackedChunks.back()->chunkNumber, true);
+
 				sent = true;
 			}
 		}
@@ -1031,19 +1012,6 @@ void UDPConnection::SendIfNecessary(bool flushed)
 		if (!sent || (maxResend == 0 && newChunks.empty()))
 			break;
 	}
-
-
-	if (UseMinLossFactor()) {
-		UpdateResendRequests();
-		return;
-	}
-
-	// on a lossy connection chunks can be sent multiple times, see switch above
-	for (int i = unackPrevSize; i < unackedChunks.size(); ++i) {
-		RequestResend(unackedChunks[i], true);
-	}
-
-	UpdateResendRequests();
 }
 
 void UDPConnection::SendPacket(Packet& pkt)
@@ -1057,7 +1025,11 @@ void UDPConnection::SendPacket(Packet& pkt)
 	asio::error_code err;
 
 	EMULATE_LATENCY( !EMULATE_PACKET_LOSS( LOSS_COUNTER ) ) {
-		mySocket->send_to(buffer(sendBuffer), addr, flags, err);
+		if (sendQueue != nullptr) {
+			sendQueue->Push(sendBuffer, addr);
+		} else {
+			mySocket->send_to(buffer(sendBuffer), addr, flags, err);
+		}
 	}
 
 	if (CheckErrorCode(err))
@@ -1069,33 +1041,116 @@ void UDPConnection::SendPacket(Packet& pkt)
 
 void UDPConnection::AckChunks(int lastAck)
 {
-	while (!unackedChunks.empty() && (lastAck >= (*unackedChunks.begin())->chunkNumber)) {
+	const spring_time curTime = spring_gettime();
+
+	while (!unackedChunks.empty() && (lastAck >= unackedChunks[0]->chunkNumber)) {
+		const UnackedChunkState& state = unackedStates[0];
+
+		// acks of resent chunks can not be attributed to a copy
+		if (!state.resent) {
+			const spring_time rtt = curTime - state.lastSendTime;
+			smoothedRTT = smoothedRTT.isDuration()? ((smoothedRTT * 7 + rtt) * 0.125f): rtt;
+		}
+
+		// entries in the resend queues are dropped when they reach the front
 		unackedChunks.pop_front();
+		unackedStates.pop_front();
 	}
+}
 
-	// resend requested and later acked, happens every now and then
-	for (size_t i = 0, n = resendRequested.size(); i < n; i++) {
-		if (lastAck < resendRequested[i].first)
-			break;
+UDPConnection::UnackedChunkState* UDPConnection::GetUnackedState(std::int32_t chunkNumber)
+{
+	if (unackedChunks.empty())
+		return nullptr;
 
-		erasedResendChunks.insert(resendRequested[i].first);
-	}
+	const std::int32_t idx = chunkNumber - unackedChunks[0]->chunkNumber;
+
+	if (idx < 0 || idx >= int(unackedStates.size()))
+		return nullptr;
+
+	return &unackedStates[idx];
 }
 
-void UDPConnection::RequestResend(ChunkPtr ptr, bool noSort)
+void UDPConnection::SelectiveAck(std::int32_t chunkNumber)
 {
-	resendRequested.emplace_back(ptr->chunkNumber, ptr);
+	UnackedChunkState* state = GetUnackedState(chunkNumber);
 
-	if (noSort)
+	if (state == nullptr)
 		return;
 
-	// swap into position; duplicates are filtered out later
-	for (size_t i = resendRequested.size() - 1; i > 0; i--) {
-		if (resendRequested[i - 1].first < resendRequested[i].first)
-			break;
+	state->selectiveAcked = true;
+}
+
+void UDPConnection::RequestResend(std::int32_t chunkNumber, spring_time curTime)
+{
+	const UnackedChunkState* state = GetUnackedState(chunkNumber);
+
+	if (state == nullptr || state->selectiveAcked)
+		return;
+
+	// the request was probably sent before our last copy arrived
+	if ((curTime - state->lastSendTime) < resendPacing)
+		return;
+
+	QueueResend(chunkNumber, false);
+}
+
+void UDPConnection::QueueResend(std::int32_t chunkNumber, bool retry)
+{
+	UnackedChunkState* state = GetUnackedState(chunkNumber);
+
+	if (state == nullptr || state->resendQueued)
+		return;
+
+	state->resendQueued = true;
+
+	if (retry) {
+		retryQueue.push_back(chunkNumber);
+	} else {
+		resendQueue.push_back(chunkNumber);
+	}
+}
 
-		std::swap(resendRequested[i - 1], resendRequested[i]);
+ChunkPtr UDPConnection::NextResendChunk(spring_time curTime)
+{
+	const auto IsQueued = [&](std::int32_t chunkNumber) {
+		const UnackedChunkState* state = GetUnackedState(chunkNumber);
+		return (state != nullptr && state->resendQueued && !state->selectiveAcked);
+	};
+
+	while (!resendQueue.empty() && !IsQueued(resendQueue.front())) {
+		resendQueue.pop_front();
+	}
+	while (!retryQueue.empty() && !IsQueued(retryQueue.front())) {
+		retryQueue.pop_front();
 	}
+
+	// requested chunks were already paced in RequestResend
+	if (!resendQueue.empty())
+		return unackedChunks[resendQueue.front() - unackedChunks[0]->chunkNumber];
+
+	// retries are in send order, if the oldest one has to wait so do all others
+	if (!retryQueue.empty() && (curTime - GetUnackedState(retryQueue.front())->lastSendTime) >= resendPacing)
+		return unackedChunks[retryQueue.front() - unackedChunks[0]->chunkNumber];
+
+	return nullptr;
+}
+
+void UDPConnection::PopResendChunk(spring_time curTime)
+{
+	std::deque<std::int32_t>& queue = resendQueue.empty()? retryQueue: resendQueue;
+
+	const std::int32_t chunkNumber = queue.front();
+	UnackedChunkState* state = GetUnackedState(chunkNumber);
+
+	queue.pop_front();
+
+	state->lastSendTime = curTime;
+	state->resendQueued = false;
+	state->resent = true;
+
+	if (!UseMinLossFactor())
+		QueueResend(chunkNumber, true);
 }
 
 
@@ -16,6 +16,9 @@ class CRC;
 
 namespace netcode {
 
+class UDPSendQueue;
+class FrameBundler;
+
 // for reliability testing, introduce fake packet loss with a percentage probability
 #define NETWORK_TEST 0                        // in [0, 1] // enable network reliability testing mode
 #define PACKET_LOSS_FACTOR 50                 // in [0, 100)
@@ -56,7 +59,16 @@ public:
 
 	void Serialize(std::vector<std::uint8_t>& data);
 
+	/// nakType of packets whose naks hold a SACK_BITMAP_SIZE byte bitmap instead of a list
+	static constexpr std::int8_t SACK_BITMAP = -128;
+	static constexpr unsigned SACK_BITMAP_SIZE = 32;
+
+	/// bit i of the bitmap is set if chunk (lastContinuous + 1 + i) was received
+	void SetSackBit(unsigned i) { naks[i >> 3] |= (1 << (i & 7)); }
+	bool GetSackBit(unsigned i) const { return (((naks[i >> 3] >> (i & 7)) & 1) != 0); }
+
 	std::int32_t lastContinuous;
+	/// if SACK_BITMAP, naks is a bitmap of received chunks since lastContinuous
 	/// if < 0, we lost -x packets since lastContinuous
 	/// if > 0, x = size of naks
 	std::int8_t nakType;
@@ -73,6 +85,11 @@ public:
  * - 4 (int): last in order (tell the client we received all packages with
  *   packetNumber less or equal)
  * - 1 (unsigned char): nak (we missed x packets, starting with firstUnacked)
+ *
+ * A list of naks (1 byte offsets from last in order) or, if more chunks are
+ * missing than fit into Packet::SACK_BITMAP_SIZE bytes, a bitmap of received
+ * chunks follows. Chunks between listed naks or with their bit set have been
+ * received out of order and are never resent.
  */
 
 /**
@@ -106,6 +123,8 @@ public:
 	bool NeedsReconnect() override;
 
 	unsigned int GetPacketQueueSize() const override { return msgQueue.size(); }
+	unsigned int GetOutgoingQueueSize() const override { return outgoingData.size(); }
+	unsigned int GetUnackedChunkCount() const override { return unackedChunks.size(); }
 
 	std::string Statistics() const override;
 	std::string GetFullAddress() const override;
@@ -131,12 +150,27 @@ public:
 	void Unmute() override { muted = false; }
 	void Close(bool flush) override;
 	void SetLossFactor(int factor) override;
+	void SetFrameBundling(bool enable) override;
 
 	const asio::ip::udp::endpoint& GetEndpoint() const { return addr; }
 
+	/// batch outgoing packets with other connections on the same socket, nullptr sends directly
+	void SetSendQueue(std::shared_ptr<UDPSendQueue> queue) { sendQueue = std::move(queue); }
+
 private:
+	struct UnackedChunkState {
+		spring_time lastSendTime;
+
+		/// has an entry in resendQueue or retryQueue
+		bool resendQueued = false;
+		/// received out of order by the other side
+		bool selectiveAcked = false;
+		bool resent = false;
+	};
+
 	void InitConnection(asio::ip::udp::endpoint address,
-			std::shared_ptr<asio::ip::udp::socket> socket);
+			std::shared_ptr<asio::ip::udp::socket> socket,
+			std::shared_ptr<UDPSendQueue> queue);
 
 	void CopyConnection(UDPConnection& conn);
 
@@ -149,11 +183,19 @@ private:
 	void SendIfNecessary(bool flushed);
 	void AckChunks(int lastAck);
 
-	void RequestResend(ChunkPtr ptr, bool noSort);
+	UnackedChunkState* GetUnackedState(std::int32_t chunkNumber);
+	void SelectiveAck(std::int32_t chunkNumber);
+	void RequestResend(std::int32_t chunkNumber, spring_time curTime);
+	void QueueResend(std::int32_t chunkNumber, bool retry);
+	/// front of the resend queues, after dropping entries that no longer need resending
+	ChunkPtr NextResendChunk(spring_time curTime);
+	void PopResendChunk(spring_time curTime);
 	void SendPacket(Packet& pkt);
 
 	void UpdateWaitingPackets();
-	void UpdateResendRequests();
+
+	/// queue the messages contained in a received NETMSG_FRAMEBUNDLE
+	void ExpandFrameBundle(const unsigned char* data, unsigned length);
 
 private:
 	spring_time lastChunkCreatedTime;
@@ -192,12 +234,24 @@ private:
 
 	/// Newly created and not yet sent
 	std::deque<ChunkPtr> newChunks;
-	/// packets the other side did not ack'ed until now
+	/**
+	 * packets the other side did not ack'ed until now, contiguous, so the state
+	 * of chunk n is at unackedStates[n - unackedChunks[0]->chunkNumber]
+	 */
 	std::deque<ChunkPtr> unackedChunks;
+	std::deque<UnackedChunkState> unackedStates;
 
-	/// Packets the other side missed
-	std::vector< std::pair<std::int32_t, ChunkPtr> > resendRequested;
-	spring::unordered_set<std::int32_t> erasedResendChunks;
+	/**
+	 * chunk-numbers of packets the other side missed, and (on lossy connections)
+	 * of all sent packets in send order; a chunk is only resent once resendPacing
+	 * has passed since it was last sent
+	 */
+	std::deque<std::int32_t> resendQueue;
+	std::deque<std::int32_t> retryQueue;
+
+	/// smoothed round-trip time from acks of chunks that were sent only once
+	spring_time smoothedRTT;
+	spring_time resendPacing;
 
 	/// complete packets we received but did not yet consume
 	std::deque< std::shared_ptr<const RawPacket> > msgQueue;
@@ -208,8 +262,6 @@ private:
 
 	std::vector<int> droppedPackets;
 
-	std::int32_t lastMidChunk;
-
 #if	NETWORK_TEST
 	/// Delayed packets, for testing purposes
 	std::map< spring_time, std::vector<std::uint8_t> > delayed;
@@ -221,6 +273,12 @@ private:
 
 	/// Our socket
 	std::shared_ptr<asio::ip::udp::socket> mySocket;
+	/// owned by the UDPListener of mySocket, if any
+	std::shared_ptr<UDPSendQueue> sendQueue;
+	/// created on first use, bundles outgoing and expands incoming messages
+	std::unique_ptr<FrameBundler> frameBundler;
+
+	bool bundleFrames = false;
 
 	RawPacket fragmentBuffer;
 
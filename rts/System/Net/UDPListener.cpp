@@ -9,16 +9,23 @@
 
 #include <memory>
 #include <asio.hpp>
+#include <cerrno>
 #include <cinttypes>
+#include <cstring>
 #include <queue>
 
+#if defined(__linux__)
+#include <poll.h>
+#endif
 
 #include "ProtocolDef.h"
 #include "UDPConnection.h"
+#include "UDPSendQueue.h"
 #include "Socket.h"
 #include "System/Log/ILog.h"
 #include "System/Platform/errorhandler.h"
 #include "System/StringUtil.h" // for IntToString (header only)
+#include "System/Misc/SpringTime.h"
 
 
 namespace netcode
@@ -36,10 +43,32 @@ UDPListener::UDPListener(int port, const std::string& ip): acceptNewConnections(
 	socket->non_blocking(true);
 	SetAcceptingConnections(true);
 
+	sendQueue = std::make_shared<UDPSendQueue>(socket);
+
+	#if defined(__linux__)
+	recvBuffer.resize(RECV_BATCH_SIZE * RECV_BUFFER_SIZE, 0);
+
+	for (unsigned int i = 0; i < RECV_BATCH_SIZE; i++) {
+		recvVectors[i].iov_base = &recvBuffer[i * RECV_BUFFER_SIZE];
+		recvVectors[i].iov_len = RECV_BUFFER_SIZE;
+	}
+	#endif
+
 	LOG("[%s] successfully bound socket on port %i", __func__, socket->local_endpoint().port());
 }
 
 UDPListener::~UDPListener() {
+	sendQueue->Flush();
+
+	// connections can outlive us, nobody would flush their queued packets
+	for (const auto& p: connMap) {
+		if (auto conn = p.second.lock())
+			conn->SetSendQueue(nullptr);
+	}
+	for (; !waiting.empty(); waiting.pop()) {
+		waiting.front()->SetSendQueue(nullptr);
+	}
+
 	for (const auto& p: dropMap) {
 		LOG("[%s] dropped %lu packets from unknown IP %s", __func__, (unsigned long) p.second, (p.first).c_str());
 	}
@@ -110,6 +139,53 @@ std::string UDPListener::TryBindSocket(int port, std::shared_ptr<asio::ip::udp::
 void UDPListener::Update() {
 	netservice.poll();
 
+	#if defined(__linux__)
+	ReceiveBatched();
+	#else
+	Receive();
+	#endif
+
+	for (auto i = connMap.cbegin(); i != connMap.cend(); ) {
+		if (i->second.expired()) {
+			LOG_L(L_DEBUG, "[UDPListener::%s] connection closed: [%s]:%i", __func__, i->first.address().to_string().c_str(), i->first.port());
+			i = connMap.erase(i);
+			continue;
+		}
+		i->second.lock()->Update();
+		++i;
+	}
+
+	sendQueue->Flush();
+}
+
+void UDPListener::FlushSendQueue() { sendQueue->Flush(); }
+
+bool UDPListener::WaitForData(int timeoutMillis) {
+	#if defined(__linux__)
+	pollfd pfd = {socket->native_handle(), POLLIN, 0};
+	int ret = 0;
+
+	while ((ret = poll(&pfd, 1, timeoutMillis)) < 0 && errno == EINTR);
+
+	return (ret > 0);
+	#else
+	// no portable blocking wait with a timeout on a non-blocking asio socket;
+	// check at a fine enough granularity that wake-up latency stays low
+	const spring_time waitEndTime = spring_gettime() + spring_msecs(timeoutMillis);
+
+	while (socket->available() == 0) {
+		if (spring_gettime() >= waitEndTime)
+			return false;
+
+		spring_msecs(1).sleep(true);
+	}
+
+	return true;
+	#endif
+}
+
+
+void UDPListener::Receive() {
 	size_t bytesAvailable = 0;
 
 	while ((bytesAvailable = socket->available()) > 0) {
@@ -122,73 +198,113 @@ void UDPListener::Update() {
 
 		const size_t bytesReceived = socket->receive_from(asio::buffer(recvBuffer), udpEndPoint, msgFlags, err);
 
-		const auto ci = connMap.find(udpEndPoint);
-
-		// known connection but expired
-		if (ci != connMap.end() && ci->second.expired())
-			continue;
-
 		if (CheckErrorCode(err))
 			break;
 
-		if (bytesReceived < Packet::headerSize)
-			continue;
+		ProcessDatagram(&recvBuffer[0], bytesReceived, udpEndPoint);
+	}
+}
 
-		Packet data(&recvBuffer[0], bytesReceived);
+void UDPListener::ReceiveBatched() {
+	#if defined(__linux__)
+	int numMsgs = 0;
 
-		if (ci != connMap.end()) {
-			ci->second.lock()->ProcessRawPacket(data);
-			continue;
+	do {
+		for (unsigned int i = 0; i < RECV_BATCH_SIZE; i++) {
+			msghdr& hdr = recvHeaders[i].msg_hdr;
+
+			hdr = {};
+			hdr.msg_name = recvEndPoints[i].data();
+			hdr.msg_namelen = recvEndPoints[i].capacity();
+			hdr.msg_iov = &recvVectors[i];
+			hdr.msg_iovlen = 1;
 		}
 
+		if ((numMsgs = recvmmsg(socket->native_handle(), recvHeaders.data(), RECV_BATCH_SIZE, MSG_DONTWAIT, nullptr)) < 0) {
+			if (errno == EINTR)
+				continue;
 
-		// unknown connection but still have the packet, maybe a new client wants to connect from sender's address
-		if (acceptNewConnections && data.lastContinuous == -1 && data.nakType == 0)	{
-			if (!data.chunks.empty() && (*data.chunks.begin())->chunkNumber == 0) {
-				std::shared_ptr<UDPConnection> incoming(new UDPConnection(socket, udpEndPoint));
-				waiting.push(incoming);
-				connMap[udpEndPoint] = incoming;
-				incoming->ProcessRawPacket(data);
-			}
+			if (errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED)
+				LOG_L(L_WARNING, "Network error %i: %s", errno, std::strerror(errno));
 
-			continue;
+			break;
 		}
 
+		for (int i = 0; i < numMsgs; i++) {
+			const msghdr& hdr = recvHeaders[i].msg_hdr;
 
-		const asio::ip::address& senderAddr = udpEndPoint.address();
-		const std::string& senderIP = senderAddr.to_string();
+			if ((hdr.msg_flags & MSG_TRUNC) != 0)
+				continue;
 
-		if (dropMap.find(senderIP) == dropMap.end()) {
-			LOG_L(L_DEBUG, "[UDPListener::%s] dropping packet from unknown IP: [%s]:%i", __func__, senderIP.c_str(), udpEndPoint.port());
-			dropMap[senderIP] = 0;
-		} else {
-			dropMap[senderIP] += 1;
-		}
+			recvEndPoints[i].resize(hdr.msg_namelen);
 
-	#ifdef DEBUG
-		std::string conns;
-		for (auto it = connMap.cbegin(); it != connMap.cend(); ++it) {
-			conns += spring::format(" [%s]:%i;", it->first.address().to_string().c_str(),it->first.port());
+			ProcessDatagram(&recvBuffer[i * RECV_BUFFER_SIZE], recvHeaders[i].msg_len, recvEndPoints[i]);
 		}
-		LOG_L(L_DEBUG, "[UDPListener::%s] open connections: %s", __func__, conns.c_str());
+	} while (numMsgs == int(RECV_BATCH_SIZE));
 	#endif
+}
+
+void UDPListener::ProcessDatagram(const std::uint8_t* data, size_t length, const ip::udp::endpoint& udpEndPoint) {
+	const auto ci = connMap.find(udpEndPoint);
+
+	// known connection but expired
+	if (ci != connMap.end() && ci->second.expired())
+		return;
+
+	if (length < Packet::headerSize)
+		return;
+
+	Packet packet(data, length);
+
+	if (ci != connMap.end()) {
+		ci->second.lock()->ProcessRawPacket(packet);
+		return;
 	}
 
-	for (auto i = connMap.cbegin(); i != connMap.cend(); ) {
-		if (i->second.expired()) {
-			LOG_L(L_DEBUG, "[UDPListener::%s] connection closed: [%s]:%i", __func__, i->first.address().to_string().c_str(), i->first.port());
-			i = connMap.erase(i);
-			continue;
+
+	// unknown connection but still have the packet, maybe a new client wants to connect from sender's address
+	if (acceptNewConnections && packet.lastContinuous == -1 && packet.nakType == 0)	{
+		if (!packet.chunks.empty() && (*packet.chunks.begin())->chunkNumber == 0) {
+			std::shared_ptr<UDPConnection> incoming = CreateConnection(udpEndPoint);
+			waiting.push(incoming);
+			connMap[udpEndPoint] = incoming;
+			incoming->ProcessRawPacket(packet);
 		}
-		i->second.lock()->Update();
-		++i;
+
+		return;
+	}
+
+
+	const asio::ip::address& senderAddr = udpEndPoint.address();
+	const std::string& senderIP = senderAddr.to_string();
+
+	if (dropMap.find(senderIP) == dropMap.end()) {
+		LOG_L(L_DEBUG, "[UDPListener::%s] dropping packet from unknown IP: [%s]:%i", __func__, senderIP.c_str(), udpEndPoint.port());
+		dropMap[senderIP] = 0;
+	} else {
+		dropMap[senderIP] += 1;
 	}
+
+#ifdef DEBUG
+	std::string conns;
+	for (auto it = connMap.cbegin(); it != connMap.cend(); ++it) {
+		conns += spring::format(" [%s]:%i;", it->first.address().to_string().c_str(),it->first.port());
+	}
+	LOG_L(L_DEBUG, "[UDPListener::%s] open connections: %s", __func__, conns.c_str());
+#endif
 }
 
 
+std::shared_ptr<UDPConnection> UDPListener::CreateConnection(const ip::udp::endpoint& udpEndPoint)
+{
+	std::shared_ptr<UDPConnection> newConn(new UDPConnection(socket, udpEndPoint));
+	newConn->SetSendQueue(sendQueue);
+	return newConn;
+}
+
 std::shared_ptr<UDPConnection> UDPListener::SpawnConnection(const std::string& ip, const unsigned port)
 {
-	std::shared_ptr<UDPConnection> newConn(new UDPConnection(socket, ip::udp::endpoint(WrapIP(ip), port)));
+	std::shared_ptr<UDPConnection> newConn = CreateConnection(ip::udp::endpoint(WrapIP(ip), port));
 	connMap[newConn->GetEndpoint()] = newConn;
 	return newConn;
 }
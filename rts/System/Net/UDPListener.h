@@ -6,13 +6,21 @@
 #include "System/Misc/NonCopyable.h"
 #include <memory>
 #include <asio/ip/udp.hpp>
+#include <array>
 #include <map>
 #include <queue>
 #include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
 
 namespace netcode
 {
 class UDPConnection;
+class UDPSendQueue;
 
 /**
  * @brief Class for handling Connections on an UDPSocket
@@ -36,6 +44,11 @@ public:
 	 */
 	~UDPListener();
 
+	/// datagrams received per recvmmsg call
+	static constexpr unsigned int RECV_BATCH_SIZE = 64;
+	/// maximum size of each datagram, larger ones are dropped
+	static constexpr unsigned int RECV_BUFFER_SIZE = 4096;
+
 	/**
 	 * Try to bind a socket to a local address and port.
 	 * If no IP or an empty one is given, this method will use
@@ -51,10 +64,24 @@ public:
 	/**
 	 * @brief Run this from time to time
 	 * Recieve data from the socket and hand it to the associated UDPConnection,
-	 * or open a new UDPConnection. It also Updates all of its connections.
+	 * or open a new UDPConnection. It also Updates all of its connections
+	 * and sends everything they queued.
 	 */
 	void Update();
 
+	/**
+	 * @brief Send all packets queued by the connections on our socket
+	 * Call after flushing connections outside of Update.
+	 */
+	void FlushSendQueue();
+
+	/**
+	 * @brief Block until a datagram is readable or the timeout expires
+	 * Lets an idle owner sleep on the socket instead of polling it.
+	 * @return true if data is waiting to be received
+	 */
+	bool WaitForData(int timeoutMillis);
+
 	/**
 	 * Set if we are accepting new connections
 	 * or drop all data from unconnected addresses.
@@ -75,6 +102,13 @@ public:
 	void RejectConnection() { waiting.pop(); }
 	void UpdateConnections(); // Updates connections when the endpoint has been reconnected
 
+private:
+	void Receive();
+	void ReceiveBatched();
+	void ProcessDatagram(const std::uint8_t* data, size_t length, const asio::ip::udp::endpoint& udpEndPoint);
+
+	std::shared_ptr<UDPConnection> CreateConnection(const asio::ip::udp::endpoint& udpEndPoint);
+
 private:
 	/**
 	 * @brief Do we accept packets from unknown sources?
@@ -84,9 +118,18 @@ private:
 
 	/// socket being listened on
 	std::shared_ptr<asio::ip::udp::socket> socket;
+	/// outgoing packets of all our connections
+	std::shared_ptr<UDPSendQueue> sendQueue;
 
+	/// RECV_BATCH_SIZE slots of RECV_BUFFER_SIZE bytes on Linux
 	std::vector<std::uint8_t> recvBuffer;
 
+	#if defined(__linux__)
+	std::array<asio::ip::udp::endpoint, RECV_BATCH_SIZE> recvEndPoints;
+	std::array<mmsghdr, RECV_BATCH_SIZE> recvHeaders;
+	std::array<iovec, RECV_BATCH_SIZE> recvVectors;
+	#endif
+
 	/// all connections
 	std::map< asio::ip::udp::endpoint, std::weak_ptr<UDPConnection> > connMap;
 	std::map< std::string, size_t> dropMap;
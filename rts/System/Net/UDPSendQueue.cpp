@@ -0,0 +1,79 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "UDPSendQueue.h"
+
+#include <asio.hpp>
+#include <cerrno>
+#include <cstring>
+
+#include "Socket.h"
+#include "System/Log/ILog.h"
+
+
+namespace netcode
+{
+
+void UDPSendQueue::Push(const std::vector<std::uint8_t>& data, const asio::ip::udp::endpoint& addr)
+{
+	datagrams.push_back({addr, sendBuffer.size(), data.size()});
+	sendBuffer.insert(sendBuffer.end(), data.begin(), data.end());
+}
+
+void UDPSendQueue::Flush()
+{
+	if (datagrams.empty())
+		return;
+
+	#if defined(__linux__)
+	msgHeaders.clear();
+	msgHeaders.resize(datagrams.size());
+	msgVectors.clear();
+	msgVectors.resize(datagrams.size());
+
+	for (size_t i = 0, n = datagrams.size(); i < n; i++) {
+		Datagram& d = datagrams[i];
+		msghdr& hdr = msgHeaders[i].msg_hdr;
+
+		msgVectors[i].iov_base = &sendBuffer[d.offset];
+		msgVectors[i].iov_len = d.length;
+
+		hdr.msg_name = d.addr.data();
+		hdr.msg_namelen = d.addr.size();
+		hdr.msg_iov = &msgVectors[i];
+		hdr.msg_iovlen = 1;
+	}
+
+	for (size_t numSent = 0, numMsgs = msgHeaders.size(); numSent < numMsgs; ) {
+		const int ret = sendmmsg(socket->native_handle(), &msgHeaders[numSent], numMsgs - numSent, 0);
+
+		if (ret > 0) {
+			numSent += ret;
+			continue;
+		}
+
+		if (ret < 0 && errno == EINTR)
+			continue;
+
+		// the failing datagram is dropped like with send_to, the peer requests a resend
+		if (ret < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != ECONNREFUSED)
+			LOG_L(L_WARNING, "Network error %i: %s", errno, std::strerror(errno));
+
+		numSent += 1;
+	}
+
+	#else
+
+	for (const Datagram& d: datagrams) {
+		asio::ip::udp::socket::message_flags flags = 0;
+		asio::error_code err;
+
+		socket->send_to(asio::buffer(&sendBuffer[d.offset], d.length), d.addr, flags, err);
+		CheckErrorCode(err);
+	}
+	#endif
+
+	sendBuffer.clear();
+	datagrams.clear();
+}
+
+}
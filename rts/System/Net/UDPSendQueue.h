@@ -0,0 +1,62 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _UDP_SEND_QUEUE_H
+#define _UDP_SEND_QUEUE_H
+
+#include <asio/ip/udp.hpp>
+#include <cinttypes>
+#include <memory>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/socket.h>
+#include <sys/uio.h>
+#endif
+
+#include "System/Misc/NonCopyable.h"
+
+namespace netcode
+{
+
+/**
+ * @brief Collects the datagrams of all connections sharing one socket
+ * Sending every datagram with its own send_to is dominated by syscall
+ * overhead on busy servers, so UDPConnections that share the socket of
+ * an UDPListener append their packets here and the listener sends all
+ * of them at once per update (with a single sendmmsg on Linux).
+ */
+class UDPSendQueue : spring::noncopyable
+{
+public:
+	UDPSendQueue(std::shared_ptr<asio::ip::udp::socket> netSocket): socket(netSocket) {}
+	~UDPSendQueue() { Flush(); }
+
+	/// copies <data>, it is sent to <addr> on the next Flush
+	void Push(const std::vector<std::uint8_t>& data, const asio::ip::udp::endpoint& addr);
+	void Flush();
+
+	bool Empty() const { return datagrams.empty(); }
+
+private:
+	struct Datagram {
+		asio::ip::udp::endpoint addr;
+
+		size_t offset;
+		size_t length;
+	};
+
+	std::shared_ptr<asio::ip::udp::socket> socket;
+
+	/// payloads of all queued datagrams, back to back
+	std::vector<std::uint8_t> sendBuffer;
+	std::vector<Datagram> datagrams;
+
+	#if defined(__linux__)
+	std::vector<mmsghdr> msgHeaders;
+	std::vector<iovec> msgVectors;
+	#endif
+};
+
+}
+
+#endif // _UDP_SEND_QUEUE_H
@@ -0,0 +1,104 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "PerfCounters.h"
+#include "System/Log/ILog.h"
+
+#ifdef __linux__
+	#include <cerrno>
+	#include <cstring>
+	#include <linux/perf_event.h>
+	#include <sys/ioctl.h>
+	#include <sys/syscall.h>
+	#include <unistd.h>
+#endif
+
+
+namespace PerfCounters {
+#ifdef __linux__
+	static int counterFDs[NUM_COUNTERS] = {-1, -1, -1, -1};
+
+	static const std::uint64_t counterConfigs[NUM_COUNTERS] = {
+		PERF_COUNT_HW_CPU_CYCLES,
+		PERF_COUNT_HW_INSTRUCTIONS,
+		PERF_COUNT_HW_CACHE_MISSES,
+		PERF_COUNT_HW_BRANCH_MISSES,
+	};
+
+	static int OpenCounter(std::uint64_t config, int groupFD)
+	{
+		perf_event_attr attr;
+		memset(&attr, 0, sizeof(attr));
+
+		attr.size = sizeof(attr);
+		attr.type = PERF_TYPE_HARDWARE;
+		attr.config = config;
+		attr.read_format = PERF_FORMAT_GROUP;
+		// the leader starts disabled and enables the whole group at once
+		attr.disabled = (groupFD == -1);
+		attr.exclude_kernel = 1;
+		attr.exclude_hv = 1;
+
+		// pid 0 and cpu -1: the calling thread, on whatever cpu it runs
+		return (syscall(__NR_perf_event_open, &attr, 0, -1, groupFD, 0));
+	}
+
+
+	bool Init()
+	{
+		if (IsOpen())
+			return true;
+
+		for (int i = 0; i < NUM_COUNTERS; i++) {
+			if ((counterFDs[i] = OpenCounter(counterConfigs[i], counterFDs[0])) != -1)
+				continue;
+
+			LOG_L(L_WARNING, "[PerfCounters::%s] perf_event_open failed for counter %d: %s", __func__, i, strerror(errno));
+			Kill();
+			return false;
+		}
+
+		ioctl(counterFDs[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+		ioctl(counterFDs[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+		return true;
+	}
+
+	void Kill()
+	{
+		for (int& fd: counterFDs) {
+			if (fd != -1)
+				close(fd);
+
+			fd = -1;
+		}
+	}
+
+	bool IsOpen() { return (counterFDs[0] != -1); }
+
+	bool Read(Values& values)
+	{
+		// PERF_FORMAT_GROUP layout: {nr, values[nr]}
+		std::uint64_t buf[1 + NUM_COUNTERS];
+
+		if (!IsOpen())
+			return false;
+		if (read(counterFDs[0], buf, sizeof(buf)) != sizeof(buf))
+			return false;
+
+		for (int i = 0; i < NUM_COUNTERS; i++) {
+			values.v[i] = buf[1 + i];
+		}
+
+		return true;
+	}
+
+#else
+
+	bool Init() {
+		LOG_L(L_WARNING, "[PerfCounters::%s] hardware counters are only supported on Linux", __func__);
+		return false;
+	}
+	void Kill() {}
+	bool IsOpen() { return false; }
+	bool Read(Values& values) { return false; }
+#endif
+}
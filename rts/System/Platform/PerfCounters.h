@@ -0,0 +1,50 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <cstdint>
+
+/**
+ * @brief Hardware performance counters of the main thread
+ * Backed by perf_event_open on Linux (user-space events only, so it works
+ * with the default perf_event_paranoid level), unavailable elsewhere. All
+ * counters form one group and are read together with a single syscall.
+ */
+namespace PerfCounters {
+	enum {
+		COUNTER_CYCLES        = 0,
+		COUNTER_INSTRUCTIONS  = 1,
+		COUNTER_CACHE_MISSES  = 2,
+		COUNTER_BRANCH_MISSES = 3,
+		NUM_COUNTERS          = 4,
+	};
+
+	struct Values {
+		std::uint64_t v[NUM_COUNTERS] = {0, 0, 0, 0};
+
+		Values operator - (const Values& o) const {
+			Values r;
+			for (int i = 0; i < NUM_COUNTERS; i++) {
+				r.v[i] = v[i] - o.v[i];
+			}
+			return r;
+		}
+		Values& operator += (const Values& o) {
+			for (int i = 0; i < NUM_COUNTERS; i++) {
+				v[i] += o.v[i];
+			}
+			return *this;
+		}
+	};
+
+	/// opens the counters for the calling thread, @return false if not supported
+	bool Init();
+	void Kill();
+	bool IsOpen();
+
+	/// only valid on the thread that called Init
+	bool Read(Values& values);
+}
+
+#endif // PERF_COUNTERS_H
@@ -12,6 +12,7 @@
 #include <functional>
 #include <memory>
 #include <cinttypes>
+#include <cstdlib>
 #if defined(__APPLE__) || defined(__FreeBSD__)
 #elif defined(_WIN32)
 	#include <windows.h>
@@ -178,6 +179,50 @@ namespace Threading {
 	}
 
 
+	std::uint32_t ParseCoreList(const std::string& coreList)
+	{
+		std::uint32_t coreMask = 0;
+
+		const char* str = coreList.c_str();
+		char* end = nullptr;
+
+		while (*str != 0) {
+			const unsigned long first = std::strtoul(str, &end, 10);
+			unsigned long last = first;
+
+			if (end == str)
+				return 0;
+
+			if (*(str = end) == '-') {
+				last = std::strtoul(++str, &end, 10);
+
+				if (end == str || last < first)
+					return 0;
+
+				str = end;
+			}
+
+			if (last >= 32) {
+				LOG_L(L_WARNING, "[Threading::%s] ignoring cores above 31 in \"%s\"", __func__, coreList.c_str());
+				last = 31;
+			}
+
+			for (unsigned long core = first; core <= last; core++) {
+				coreMask |= (1u << core);
+			}
+
+			if (*str == ',') {
+				str++;
+				continue;
+			}
+			if (*str != 0)
+				return 0;
+		}
+
+		return coreMask;
+	}
+
+
 	std::uint32_t GetAvailableCoresMask()
 	{
 	#if defined(__APPLE__) || defined(__FreeBSD__)
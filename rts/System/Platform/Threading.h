@@ -117,6 +117,12 @@ namespace Threading {
 	void SetAffinityHelper(const char* threadName, std::uint32_t affinity);
 	std::uint32_t GetAvailableCoresMask();
 
+	/**
+	 * Parses a list of (0-based) cores like "0-3,8,10-11" into a mask
+	 * for SetAffinity; returns 0 if the list is empty or malformed
+	 */
+	std::uint32_t ParseCoreList(const std::string& coreList);
+
 	/**
 	 * returns count of cpu cores/ hyperthreadings cores
 	 */
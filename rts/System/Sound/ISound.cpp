@@ -35,6 +35,7 @@ CONFIG(int, snd_volbattle).defaultValue(100).minimumValue(0).maximumValue(200).d
 CONFIG(int, snd_volui).defaultValue(100).minimumValue(0).maximumValue(200).description("Volume for \"ui\" sound channel.");
 CONFIG(int, snd_volmusic).defaultValue(100).minimumValue(0).maximumValue(200).description("Volume for \"music\" sound channel.");
 CONFIG(float, snd_airAbsorption).defaultValue(0.1f);
+CONFIG(int, snd_maxPlayLatency).defaultValue(100).minimumValue(0).description("Maximum time in milliseconds a sound may wait for its file to finish decoding before being dropped.");
 
 CONFIG(std::string, snd_device).defaultValue("").description("Sets the used output device. See \"Available Devices\" section in infolog.txt.");
 
@@ -70,6 +70,8 @@ public:
 public:
 	unsigned numEmptyPlayRequests = 0;
 	unsigned numAbortedPlays = 0;
+	unsigned numCulledPlayRequests = 0;
+	unsigned numMergedPlayRequests = 0;
 
 private:
 	virtual bool LoadSoundDefsImpl(LuaParser* defsParser) = 0;
@@ -16,6 +16,17 @@
 
 extern spring::recursive_mutex soundMutex;
 
+// requests estimated quieter than this at the listener are culled
+static constexpr float MIN_AUDIBILITY = 1.0f / 256.0f;
+// requests for the same item closer than this to one emitted in the same frame are merged
+static constexpr float MERGE_DISTANCE = 64.0f;
+
+
+static bool Outranks(int prioA, float audibilityA, int prioB, float audibilityB)
+{
+	return (prioA > prioB || (prioA == prioB && audibilityA > audibilityB));
+}
+
 
 
 void AudioChannel::SetVolume(float newVolume)
@@ -87,10 +98,29 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 		LOG("[AudioChannel::%s] maximum distance ignored for relative playback of sound-item \"%s\"", __func__, (sndItem->Name()).c_str());
 	}
 
+	const float audibility = CSoundSource::GetAudibility(this, sndItem, pos, volume, relative);
+
+	if (audibility < MIN_AUDIBILITY) {
+		sound->numCulledPlayRequests++;
+		return;
+	}
+
 	// don't spam to many sounds per frame
 	if (emitsThisFrame >= emitsPerFrame)
 		return;
 
+	// identical sounds emitted from (nearly) the same spot in one frame would only be louder
+	for (unsigned int i = 0, n = std::min(emitsThisFrame, unsigned(MAX_MERGE_HISTORY)); i < n; i++) {
+		const EmittedSample& sample = emittedSamples[i];
+
+		if (sample.id != id || sample.pos.SqDistance(pos) > (MERGE_DISTANCE * MERGE_DISTANCE))
+			continue;
+
+		sound->numMergedPlayRequests++;
+		return;
+	}
+
+	emittedSamples[emitsThisFrame % MAX_MERGE_HISTORY] = {id, pos};
 	emitsThisFrame++;
 
 	// check if the sound item is already played
@@ -98,15 +128,17 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 		CSoundSource* src = nullptr;
 
 		int prio = INT_MAX;
+		float aud = 0.0f;
 
 		for (CSoundSource* tmp: curSources) {
-			if (tmp->GetCurrentPriority() < prio) {
+			if (Outranks(prio, aud, tmp->GetCurrentPriority(), tmp->GetCurrentAudibility())) {
 				src  = tmp;
 				prio = src->GetCurrentPriority();
+				aud  = src->GetCurrentAudibility();
 			}
 		}
 
-		if (src == nullptr || prio > sndItem->GetPriority()) {
+		if (src == nullptr || Outranks(prio, aud, sndItem->GetPriority(), audibility)) {
 			LOG_L(L_DEBUG, "[AudioChannel::%s] maximum concurrent playbacks reached for sound-item %s", __func__, (sndItem->Name()).c_str());
 			return;
 		}
@@ -117,15 +149,16 @@ void AudioChannel::FindSourceAndPlay(size_t id, const float3& pos, const float3&
 	// find a sound source to play the item in
 	CSoundSource* sndSource = sound->GetNextBestSource();
 
-	if (sndSource == nullptr || (sndSource->GetCurrentPriority() >= sndItem->GetPriority())) {
+	if (sndSource == nullptr || !Outranks(sndItem->GetPriority(), audibility, sndSource->GetCurrentPriority(), sndSource->GetCurrentAudibility())) {
 		LOG_L(L_DEBUG, "[AudioChannel::%s] no source found for sound-item %s", __func__, (sndItem->Name()).c_str());
+		sound->numCulledPlayRequests++;
 		return;
 	}
 	if (sndSource->IsPlaying())
 		sound->numAbortedPlays++;
 
 	// play the sound item
-	sndSource->PlayAsync(this, id, pos, velocity, volume, sndItem->GetPriority(), relative);
+	sndSource->PlayAsync(this, id, pos, velocity, volume, sndItem->GetPriority(), audibility, relative);
 	curSources.insert(sndSource);
 }
 
@@ -3,6 +3,7 @@
 #ifndef AUDIO_CHANNEL_H
 #define AUDIO_CHANNEL_H
 
+#include <array>
 #include <deque>
 #include <cstring>
 
@@ -53,8 +54,19 @@ protected:
 	void FindSourceAndPlay(size_t id, const float3& pos, const float3& velocity, float volume, bool relative) override;
 	void SoundSourceFinished(CSoundSource* sndSource) override;
 
+private:
+	struct EmittedSample {
+		size_t id;
+		float3 pos;
+	};
+
+	static constexpr size_t MAX_MERGE_HISTORY = 32;
+
 private:
 	spring::unsynced_set<CSoundSource*> curSources;
+
+	// most recent samples emitted this frame, valid up to emitsThisFrame
+	std::array<EmittedSample, MAX_MERGE_HISTORY> emittedSamples;
 	std::deque<StreamQueueItem> streamQueue;
 
 	CSoundSource* curStreamSrc = nullptr;
@@ -41,6 +41,7 @@
 #include "System/Platform/Threading.h"
 #include "System/Platform/Watchdog.h"
 #include "System/Threading/SpringThreading.h"
+#include "System/Threading/ThreadPool.h"
 
 #include "System/float3.h"
 
@@ -88,6 +89,8 @@ void CSound::Init()
 		Channels::Battle->SetVolume(configHandler->GetInt("snd_volbattle") * 0.01f);
 		Channels::UserInterface->SetVolume(configHandler->GetInt("snd_volui") * 0.01f);
 		Channels::BGMusic->SetVolume(configHandler->GetInt("snd_volmusic") * 0.01f);
+
+		CSoundSource::SetMaxPlayLatency(configHandler->GetInt("snd_maxPlayLatency"));
 	}
 	{
 		SoundBuffer::Initialise();
@@ -97,6 +100,7 @@ void CSound::Init()
 		preloadSet.clear();
 		preloadSet.reserve(16);
 		failureSet.clear();
+		decodedBuffers.clear();
 
 		defaultItemNameMap.clear();
 		soundItemDefsMap.clear();
@@ -121,6 +125,11 @@ void CSound::Kill()
 			soundThread.join();
 	}
 
+	// decode tasks push into decodedBuffers, let them finish first
+	while (numPendingDecodes > 0) {
+		spring::this_thread::yield();
+	}
+
 	SoundBuffer::Deinitialise();
 }
 
@@ -240,9 +249,10 @@ CSoundSource* CSound::GetNextBestSource(bool lock)
 	if (iter != soundSources.end())
 		return &(*iter);
 
-	// check the next best free source
+	// check the next best free source; among equal priorities, the least audible one
 	CSoundSource* bestSrc = nullptr;
 	int bestPriority = INT_MAX;
+	float bestAudibility = 0.0f;
 
 	for (CSoundSource& src: soundSources) {
 		#if 0
@@ -251,9 +261,12 @@ CSoundSource* CSound::GetNextBestSource(bool lock)
 		#endif
 		if (src.GetCurrentPriority() > bestPriority)
 			continue;
+		if (src.GetCurrentPriority() == bestPriority && bestSrc != nullptr && src.GetCurrentAudibility() >= bestAudibility)
+			continue;
 
 		bestSrc = &src;
 		bestPriority = src.GetCurrentPriority();
+		bestAudibility = src.GetCurrentAudibility();
 	}
 
 	return bestSrc;
@@ -706,6 +719,8 @@ void CSound::Update()
 		GetSoundId(*preloadSet.begin());
 	}
 
+	UploadDecodedBuffers();
+
 	for (CSoundSource& source: soundSources) {
 		source.Update();
 	}
@@ -783,11 +798,13 @@ void CSound::PrintDebugInfo()
 	std::lock_guard<spring::recursive_mutex> lck(soundMutex);
 
 	LOG_L(L_DEBUG, "OpenAL Sound System:");
-	LOG_L(L_DEBUG, "# SoundSources: %i", (int)soundSources.size());
+	LOG_L(L_DEBUG, "# SoundSources: %i (%i active)", (int)soundSources.size(), (int)std::count_if(soundSources.begin(), soundSources.end(), [](const CSoundSource& src) { return src.IsPlaying(false); }));
 	LOG_L(L_DEBUG, "# SoundBuffers: %i", (int)SoundBuffer::Count());
 
 	LOG_L(L_DEBUG, "# reserved for buffers: %i kB", (int)(SoundBuffer::AllocedSize() / 1024));
 	LOG_L(L_DEBUG, "# PlayRequests for empty sound: %i", numEmptyPlayRequests);
+	LOG_L(L_DEBUG, "# PlayRequests culled: %i", numCulledPlayRequests);
+	LOG_L(L_DEBUG, "# PlayRequests merged: %i", numMergedPlayRequests);
 	LOG_L(L_DEBUG, "# Samples disrupted: %i", numAbortedPlays);
 	LOG_L(L_DEBUG, "# SoundItems: %i", (int)soundItems.size());
 }
@@ -889,7 +906,8 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 	loadBuffer.reserve(1024 * 1024);
 
 	file.GetBuffer() = std::move(loadBuffer);
-	file.Open(path, SPRING_VFS_RAW_FIRST);
+	// uncompressed files are decoded straight from their mapping
+	file.OpenMapped(path, SPRING_VFS_RAW_FIRST);
 
 	// steal back
 	loadBuffer = std::move(file.GetBuffer());
@@ -900,19 +918,50 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 		return 0;
 	}
 
-	if (loadBuffer.empty()) {
+	if (!file.IsMapped() && loadBuffer.empty()) {
 		// copy file into buffer manually if not in VFS
 		loadBuffer.resize(file.FileSize());
 		file.Read(loadBuffer.data(), loadBuffer.size());
 	}
 
+	const std::uint8_t* soundData = file.IsMapped()? file.GetMappedData(): loadBuffer.data();
+	const size_t soundSize = file.IsMapped()? file.FileSize(): loadBuffer.size();
 
-	SoundBuffer soundBuf;
 	const std::string& soundExt = file.GetFileExt();
 
+	SoundBuffer soundBuf;
+	SoundBuffer::PCMData pcm;
+
 	switch (soundExt[0]) {
-		case 'w': { soundBuf.LoadWAV   (path, loadBuffer); } break; // wav
-		case 'o': { soundBuf.LoadVorbis(path, loadBuffer); } break; // ogg
+		case 'w': {
+			// nothing to decode, upload right away
+			if (SoundBuffer::DecodeWAV(path, soundData, soundSize, pcm) && pcm.length > 0.0f) {
+				soundBuf.Reserve(path);
+				soundBuf.Upload(pcm);
+			}
+		} break;
+		case 'o': {
+			// decoded off-thread; the buffer can be referenced at once but plays only after UploadDecodedBuffers
+			soundBuf.Reserve(path);
+
+			const size_t bufferID = SoundBuffer::Insert(std::move(soundBuf));
+
+			numPendingDecodes += 1;
+
+			ThreadPool::Enqueue([this, path, bufferID, fileData = std::vector<std::uint8_t>(soundData, soundData + soundSize)]() {
+				DecodedBuffer decoded = {{}, bufferID, false};
+				decoded.valid = (SoundBuffer::DecodeVorbis(path, fileData.data(), fileData.size(), decoded.pcm) && decoded.pcm.length > 0.0f);
+
+				{
+					std::lock_guard<spring::mutex> lck(decodedBuffersMutex);
+					decodedBuffers.push_back(std::move(decoded));
+				}
+
+				numPendingDecodes -= 1;
+			});
+
+			return bufferID;
+		} break;
 		default : {
 			LOG_L(L_WARNING, "[%s] unknown audio format \"%s\"", __func__, soundExt.c_str());
 		} break;
@@ -929,6 +978,30 @@ size_t CSound::LoadSoundBuffer(const std::string& path)
 	return (SoundBuffer::Insert(std::move(soundBuf)));
 }
 
+void CSound::UploadDecodedBuffers()
+{
+	std::vector<DecodedBuffer> buffers;
+
+	{
+		std::lock_guard<spring::mutex> lck(decodedBuffersMutex);
+		std::swap(buffers, decodedBuffers);
+	}
+
+	for (const DecodedBuffer& decoded: buffers) {
+		SoundBuffer& buffer = SoundBuffer::GetById(decoded.bufferID);
+
+		if (decoded.valid && buffer.Upload(decoded.pcm))
+			continue;
+
+		// items referring to the buffer stay silent
+		LOG_L(L_WARNING, "[%s] failed to load file \"%s\"", __func__, buffer.GetFilename().c_str());
+		buffer.CancelReserve();
+		failureSet.insert(buffer.GetFilename());
+	}
+
+	CheckError("[Sound::UploadDecodedBuffers]");
+}
+
 void CSound::NewFrame()
 {
 	Channels::General->UpdateFrame();
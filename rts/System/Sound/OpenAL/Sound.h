@@ -15,10 +15,10 @@
 #include "System/UnorderedSet.hpp"
 #include "System/Threading/SpringThreading.h"
 
+#include "SoundBuffer.h"
 #include "SoundItem.h"
 
 class CSoundSource;
-class SoundBuffer;
 class SoundItem;
 
 /// Default sound system implementation (OpenAL)
@@ -73,6 +73,12 @@ private:
 	typedef spring::unordered_map<std::string, std::string> SoundItemNameMap;
 	typedef spring::unordered_map<std::string, SoundItemNameMap> SoundItemDefsMap;
 
+	struct DecodedBuffer {
+		SoundBuffer::PCMData pcm;
+		size_t bufferID;
+		bool valid;
+	};
+
 private:
 	void Cleanup();
 	void OpenOpenALDevice(const std::string& deviceName);
@@ -89,6 +95,7 @@ private:
 
 	size_t MakeItemFromDef(const SoundItemNameMap& itemDef);
 	size_t LoadSoundBuffer(const std::string& filename);
+	void UploadDecodedBuffers();
 
 private:
 	ALCdevice* curDevice = nullptr;
@@ -105,6 +112,11 @@ private:
 
 	std::vector<std::uint8_t> loadBuffer;
 
+	// Ogg files are decoded on the thread-pool, results are uploaded by Update
+	spring::mutex decodedBuffersMutex;
+	std::vector<DecodedBuffer> decodedBuffers;
+	std::atomic<int> numPendingDecodes = {0};
+
 	SoundItemNameMap defaultItemNameMap;
 	SoundItemDefsMap soundItemDefsMap; // parsed from sounds.lua
 
@@ -43,8 +43,6 @@ int	VorbisClose(void* datasource)
 SoundBuffer::bufferMapT SoundBuffer::bufferMap;
 SoundBuffer::bufferVecT SoundBuffer::buffers;
 
-static std::vector<std::uint8_t> decodeBuffer;
-
 
 #pragma pack(push, 1)
 // Header copied from WavLib by Michael McTernan
@@ -66,11 +64,20 @@ struct WAVHeader
 #pragma pack(pop)
 
 
-bool SoundBuffer::LoadWAV(const std::string& file, const std::vector<std::uint8_t>& buffer)
+bool SoundBuffer::DecodeWAV(const std::string& file, const std::uint8_t* data, size_t size, PCMData& pcm)
 {
-	WAVHeader* header = (WAVHeader*)(&buffer[0]);
+	if (size < sizeof(WAVHeader)) {
+		LOG_L(L_ERROR, "[%s(%s)] invalid header", __func__, file.c_str());
+		return false;
+	}
+
+	// the header is byte-swapped and patched below, work on a copy
+	WAVHeader wavHeader;
+	WAVHeader* header = &wavHeader;
 
-	if ((buffer.empty()) || memcmp(header->riff, "RIFF", 4) || memcmp(header->wavefmt, "WAVEfmt", 7)) {
+	memcpy(header, data, sizeof(WAVHeader));
+
+	if (memcmp(header->riff, "RIFF", 4) || memcmp(header->wavefmt, "WAVEfmt", 7)) {
 		LOG_L(L_ERROR, "[%s(%s)] invalid header", __func__, file.c_str());
 		return false;
 	}
@@ -117,11 +124,11 @@ bool SoundBuffer::LoadWAV(const std::string& file, const std::vector<std::uint8_
 		return false;
 	}
 
-	if (static_cast<unsigned>(header->datalen) > buffer.size() - sizeof(WAVHeader)) {
+	if (static_cast<unsigned>(header->datalen) > size - sizeof(WAVHeader)) {
 		LOG_L(L_ERROR,
 				"[%s(%s)] data length %i greater than actual data length %i",
 				__func__, file.c_str(), header->datalen,
-				(int)(buffer.size() - sizeof(WAVHeader)));
+				(int)(size - sizeof(WAVHeader)));
 
 //		LOG_L(L_WARNING, "OpenAL: size %d\n", size);
 //		LOG_L(L_WARNING, "OpenAL: sizeof(WAVHeader) %d\n", sizeof(WAVHeader));
@@ -134,25 +141,24 @@ bool SoundBuffer::LoadWAV(const std::string& file, const std::vector<std::uint8_
 //		LOG_L(L_WARNING, "OpenAL: SamplesPerSec %d\n", header->SamplesPerSec);
 //		LOG_L(L_WARNING, "OpenAL: AvgBytesPerSec %d\n", header->AvgBytesPerSec);
 
-		header->datalen = std::uint32_t(buffer.size() - sizeof(WAVHeader))&(~std::uint32_t((header->BitsPerSample*header->channels)/8 -1));
+		header->datalen = std::uint32_t(size - sizeof(WAVHeader))&(~std::uint32_t((header->BitsPerSample*header->channels)/8 -1));
 	}
 
-	if (!AlGenBuffer(file, format, &buffer[sizeof(WAVHeader)], header->datalen, header->SamplesPerSec))
-		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
-
-	filename = file;
-	channels = header->channels;
-	length   = float(header->datalen) / (header->channels * header->SamplesPerSec * header->BitsPerSample);
+	pcm.samples.assign(data + sizeof(WAVHeader), data + sizeof(WAVHeader) + header->datalen);
+	pcm.format   = format;
+	pcm.rate     = header->SamplesPerSec;
+	pcm.channels = header->channels;
+	pcm.length   = float(header->datalen) / (header->channels * header->SamplesPerSec * header->BitsPerSample);
 
 	return true;
 }
 
-bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer)
+bool SoundBuffer::DecodeVorbis(const std::string& file, const std::uint8_t* data, size_t size, PCMData& pcm)
 {
 	VorbisInputBuffer buf;
-	buf.data = &buffer[0];
+	buf.data = data;
 	buf.pos = 0;
-	buf.size = buffer.size();
+	buf.size = size;
 
 	ov_callbacks vorbisCallbacks;
 	vorbisCallbacks.read_func  = VorbisRead;
@@ -185,6 +191,9 @@ bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uin
 	int section = 0;
 	long read = 0;
 
+	// per-call buffer, decoding runs concurrently on worker threads
+	std::vector<std::uint8_t>& decodeBuffer = pcm.samples;
+
 	decodeBuffer.clear();
 	decodeBuffer.resize(512 * 1024); // 512kb read buffer
 
@@ -210,14 +219,29 @@ bool SoundBuffer::LoadVorbis(const std::string& file, const std::vector<std::uin
 		pos += read;
 	} while (read > 0); // read == 0 indicated EOF, read < 0 is error
 
-	if (!AlGenBuffer(file, format, &decodeBuffer[0], pos, vorbisInfo->rate))
-		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, file.c_str());
+	decodeBuffer.resize(pos);
 
 	// for non-seekable streams, ov_time_total returns OV_EINVAL (-131) while
 	// ov_time_tell always[?] returns the decoding time offset relative to EOS
-	filename = file;
-	channels = vorbisInfo->channels;
-	length   = (ov_seekable(&oggStream) == 0)? ov_time_tell(&oggStream): ov_time_total(&oggStream, -1);
+	pcm.format   = format;
+	pcm.rate     = vorbisInfo->rate;
+	pcm.channels = vorbisInfo->channels;
+	pcm.length   = (ov_seekable(&oggStream) == 0)? ov_time_tell(&oggStream): ov_time_total(&oggStream, -1);
+	return true;
+}
+
+
+bool SoundBuffer::Upload(const PCMData& pcm)
+{
+	pending = false;
+
+	if (!AlGenBuffer(filename, pcm.format, pcm.samples.data(), pcm.samples.size(), pcm.rate)) {
+		LOG_L(L_WARNING, "[%s(%s)] failed generating buffer", __func__, filename.c_str());
+		return false;
+	}
+
+	channels = pcm.channels;
+	length   = pcm.length;
 	return true;
 }
 
@@ -34,11 +34,29 @@ public:
 		sb.id = 0;
 		channels = sb.channels;
 		length = sb.length;
+		pending = sb.pending;
 		return *this;
 	}
 
-	bool LoadWAV(const std::string& file, const std::vector<std::uint8_t>& buffer);
-	bool LoadVorbis(const std::string& file, const std::vector<std::uint8_t>& buffer);
+	/// decoded samples, produced by Decode* on any thread and handed to OpenAL by Upload
+	struct PCMData {
+		std::vector<std::uint8_t> samples;
+
+		ALenum format = 0;
+		int rate = 0;
+
+		ALuint channels = 0;
+		ALfloat length = 0.0f;
+	};
+
+	// <data> may point into a read-only file mapping
+	static bool DecodeWAV(const std::string& file, const std::uint8_t* data, size_t size, PCMData& pcm);
+	static bool DecodeVorbis(const std::string& file, const std::uint8_t* data, size_t size, PCMData& pcm);
+
+	/// creates a not yet playable buffer for <file>, filled in later by Upload
+	void Reserve(const std::string& file) { filename = file; pending = true; }
+	void CancelReserve() { pending = false; }
+	bool Upload(const PCMData& pcm);
 	bool Release();
 
 	const std::string& GetFilename() const { return filename; }
@@ -47,6 +65,9 @@ public:
 	ALuint GetChannels() const { return channels; }
 	ALfloat GetLength() const { return length; }
 
+	bool IsLoaded() const { return (id != 0); }
+	bool IsPending() const { return pending; }
+
 	int BufferSize() const;
 
 	static void Initialise() {
@@ -75,6 +96,8 @@ private:
 	ALuint channels = 0;
 	ALfloat length = 0.0f;
 
+	bool pending = false;
+
 	typedef spring::unsynced_map<std::string, size_t> bufferMapT;
 	typedef std::vector<SoundBuffer> bufferVecT;
 
@@ -31,6 +31,8 @@ float CSoundSource::globalPitch = 1.0f;
 // reduce the rolloff when the camera is height above the ground (so we still hear something in tab mode or far zoom)
 float CSoundSource::heightRolloffModifier = 1.0f;
 
+spring_time CSoundSource::maxPlayLatency = spring_msecs(100);
+
 
 CSoundSource::CSoundSource()
 	: curChannel(nullptr)
@@ -50,7 +52,7 @@ CSoundSource::CSoundSource()
 		CheckError("CSoundSource::CSoundSource");
 	}
 
-	curPlayingItem = {0,  0, 0,  0.0f, 0.0f};
+	curPlayingItem = {0,  0, 0,  0.0f, 0.0f, 0.0f};
 }
 
 
@@ -58,8 +60,25 @@ void CSoundSource::Update()
 {
 	if (asyncPlayItem.id != 0) {
 		// Sound::Update() holds mutex, soundItems can not be accessed concurrently
-		Play(asyncPlayItem.channel, sound->GetSoundItem(asyncPlayItem.id), asyncPlayItem.position, asyncPlayItem.velocity, asyncPlayItem.volume, asyncPlayItem.relative);
-		asyncPlayItem = AsyncSoundItemData();
+		SoundItem* item = sound->GetSoundItem(asyncPlayItem.id);
+		const SoundBuffer& itemBuffer = SoundBuffer::GetById(item->GetSoundBufferID());
+
+		// buffer still being decoded; keep waiting for it unless that takes too long
+		if (!itemBuffer.IsPending() || (spring_gettime() - asyncPlayItem.requestTime) > maxPlayLatency) {
+			IAudioChannel* channel = asyncPlayItem.channel;
+
+			if (itemBuffer.IsLoaded()) {
+				Play(channel, item, asyncPlayItem.position, asyncPlayItem.velocity, asyncPlayItem.volume, asyncPlayItem.relative);
+				curPlayingItem.audibility = asyncPlayItem.audibility;
+				asyncPlayItem = AsyncSoundItemData();
+			} else {
+				asyncPlayItem = AsyncSoundItemData();
+
+				// dropped, release the source from the requesting channel
+				Stop();
+				channel->SoundSourceFinished(this);
+			}
+		}
 	}
 
 	if (curPlayingItem.id != 0) {
@@ -124,6 +143,31 @@ int CSoundSource::GetCurrentPriority() const
 	return (curPlayingItem.priority);
 }
 
+float CSoundSource::GetCurrentAudibility() const
+{
+	if (asyncPlayItem.id != 0)
+		return asyncPlayItem.audibility;
+
+	if (curStream.Valid())
+		return 1.0f;
+
+	return (curPlayingItem.audibility);
+}
+
+float CSoundSource::GetAudibility(const IAudioChannel* channel, const SoundItem* item, const float3& pos, float volume, bool relative)
+{
+	const float gain = volume * item->gain * channel->volume;
+
+	if (relative || !item->in3D)
+		return gain;
+
+	// AL_INVERSE_DISTANCE_CLAMPED, see CSound::InitThread
+	const float rolloff = ROLLOFF_FACTOR * item->rolloff * heightRolloffModifier;
+	const float distance = std::max(pos.distance(sound->GetListenerPos()), REFERENCE_DIST);
+
+	return (gain * REFERENCE_DIST / (REFERENCE_DIST + rolloff * (distance - REFERENCE_DIST)));
+}
+
 bool CSoundSource::IsPlaying(const bool checkOpenAl) const
 {
 	if (curStream.Valid())
@@ -268,7 +312,7 @@ void CSoundSource::Play(IAudioChannel* channel, SoundItem* item, float3 pos, flo
 }
 
 
-void CSoundSource::PlayAsync(IAudioChannel* channel, size_t id, float3 pos, float3 velocity, float volume, float priority, bool relative)
+void CSoundSource::PlayAsync(IAudioChannel* channel, size_t id, float3 pos, float3 velocity, float volume, float priority, float audibility, bool relative)
 {
 	asyncPlayItem.channel  = channel;
 	asyncPlayItem.id       = id;
@@ -276,10 +320,13 @@ void CSoundSource::PlayAsync(IAudioChannel* channel, size_t id, float3 pos, floa
 	asyncPlayItem.position = pos;
 	asyncPlayItem.velocity = velocity;
 
-	asyncPlayItem.volume   = volume;
-	asyncPlayItem.priority = priority;
+	asyncPlayItem.volume     = volume;
+	asyncPlayItem.priority   = priority;
+	asyncPlayItem.audibility = audibility;
 
 	asyncPlayItem.relative = relative;
+
+	asyncPlayItem.requestTime = spring_gettime();
 }
 
 
@@ -40,12 +40,13 @@ public:
 	bool IsValid() const { return (id != 0); };
 
 	int GetCurrentPriority() const;
+	float GetCurrentAudibility() const;
 	bool IsPlaying(const bool checkOpenAl = false) const;
 	void Stop();
 
 	/// will stop a currently playing sound, if any
 	void Play(IAudioChannel* channel, SoundItem* item, float3 pos, float3 velocity, float volume, bool relative = false);
-	void PlayAsync(IAudioChannel* channel, size_t id, float3 pos, float3 velocity, float volume, float priority, bool relative = false);
+	void PlayAsync(IAudioChannel* channel, size_t id, float3 pos, float3 velocity, float volume, float priority, float audibility, bool relative = false);
 	void PlayStream(IAudioChannel* channel, const std::string& stream, float volume);
 	void StreamStop();
 	void StreamPause();
@@ -54,6 +55,10 @@ public:
 
 	static void SetPitch(const float& newPitch) { globalPitch = newPitch; }
 	static void SetHeightRolloffModifer(const float& mod) { heightRolloffModifier = mod; }
+	static void SetMaxPlayLatency(int msecs) { maxPlayLatency = spring_msecs(msecs); }
+
+	/// estimated gain of <item> at the listener, with the same attenuation model as OpenAL
+	static float GetAudibility(const IAudioChannel* channel, const SoundItem* item, const float3& pos, float volume, bool relative);
 
 private:
 	struct AsyncSoundItemData {
@@ -66,8 +71,11 @@ private:
 
 		float volume = 1.0f;
 		float priority = 0.0f;
+		float audibility = 0.0f;
 
 		bool relative = false;
+
+		spring_time requestTime;
 	};
 
 	// light-weight SoundItem with only the data needed for playback
@@ -79,6 +87,7 @@ private:
 
 		float rndGain;
 		float rolloff;
+		float audibility;
 	};
 
 private:
@@ -88,6 +97,9 @@ private:
 	// reduce the rolloff when the camera is height above the ground (so we still hear something in tab mode or far zoom)
 	static float heightRolloffModifier;
 
+	// how long a play request may wait for its buffer to be decoded
+	static spring_time maxPlayLatency;
+
 private:
 	ALuint id;
 
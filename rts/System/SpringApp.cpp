@@ -35,7 +35,9 @@
 #include "Game/GameController.h"
 #include "Game/Game.h"
 #include "Game/GlobalUnsynced.h"
+#include "Game/LoadScreen.h"
 #include "Game/PreGame.h"
+#include "Game/StressTest.h"
 #include "Game/UI/KeyBindings.h"
 #include "Game/UI/KeyCodes.h"
 #include "Game/UI/InfoConsole.h"
@@ -79,7 +81,9 @@
 #include "System/FileSystem/FileSystemInitializer.h"
 #include "System/Input/KeyInput.h"
 #include "System/Input/MouseInput.h"
+#include "System/LoadSave/DemoBatch.h"
 #include "System/LoadSave/LoadSaveHandler.h"
+#include "System/Log/Backend.h"
 #include "System/Log/ConsoleSink.h"
 #include "System/Log/ILog.h"
 #include "System/Log/DefaultFilter.h"
@@ -97,6 +101,7 @@
 
 
 CONFIG(unsigned, SetCoreAffinity).defaultValue(0).safemodeValue(1).description("Defines a bitmask indicating which CPU cores the main-thread should use.");
+CONFIG(std::string, MainThreadCores).defaultValue("").description("Cores (e.g. \"0-3\") the main-thread is pinned to, overrides SetCoreAffinity. Memory the main and load threads allocate first-touch stays on these cores' NUMA node.");
 CONFIG(unsigned, TextureMemPoolSize).defaultValue(128 * (1 + (__archBits__ == 64))).minimumValue(1);
 CONFIG(bool, UseLuaMemPools).defaultValue(__archBits__ == 64).description("Whether Lua VM memory allocations are made from pools.");
 CONFIG(bool, UseHighResTimer).defaultValue(false).description("On Windows, sets whether Spring will use low- or high-resolution timer functions for tasks like graphical interpolation between game frames.");
@@ -135,6 +140,11 @@ DEFINE_string   (map,                                      "",    "Specify the m
 DEFINE_string   (menu,                                     "",    "Specify a lua menu archive to be used by spring");
 DEFINE_string   (name,                                     "",    "Set your player name");
 DEFINE_bool     (oldmenu,                                  false, "Start the old menu");
+DEFINE_string_EX(precompute_path_cache, "precompute-path-cache", "", "Write the path-estimator cache files for all MoveDefs of --game on the given map, then quit");
+DEFINE_string_EX(demo_batch,         "demo-batch",         "",    "Replay all demos listed (one per line) in the given file as fast as possible, then quit");
+DEFINE_string_EX(demo_batch_report,  "demo-batch-report",  "demobatch.txt", "Where --demo-batch writes its tab-separated results");
+DEFINE_int32_EX (demo_batch_jobs,    "demo-batch-jobs",    0,     "Number of demos --demo-batch replays at once (0 = one per physical core)");
+DEFINE_string_EX(stress_test,        "stress-test",        "",    "Run the load scenario in the given file on --game, write its sim timings, then quit");
 
 
 
@@ -601,6 +611,40 @@ void SpringApp::Startup()
 	if (inputFile.empty()) {
 		clientSetup->isHost = true;
 
+		if (!FLAGS_precompute_path_cache.empty()) {
+			if (FLAGS_game.empty())
+				throw content_error("--precompute-path-cache requires --game");
+
+			// load a minimal skirmish, CGame::Load quits after LoadFinalize
+			gu->precomputePathCache = true;
+			activeController = RunScript(StartScriptGen::CreateMinimalSetup(FLAGS_game, FLAGS_precompute_path_cache));
+			return;
+		}
+
+		if (!FLAGS_stress_test.empty()) {
+			const std::string scenarioMap = StressTest::Init(FLAGS_stress_test);
+			const std::string& mapName = FLAGS_map.empty()? scenarioMap: FLAGS_map;
+
+			if (FLAGS_game.empty() || mapName.empty())
+				throw content_error("--stress-test requires --game and a map (--map or in the scenario)");
+
+			activeController = RunScript(StartScriptGen::CreateMinimalSetup(FLAGS_game, mapName));
+			return;
+		}
+
+		if (!FLAGS_demo_batch.empty()) {
+			// returns in each forked worker, and in the parent when all are done
+			const std::string demoFile = DemoBatch::Run(FLAGS_demo_batch, FLAGS_demo_batch_report, FLAGS_demo_batch_jobs);
+
+			if (demoFile.empty()) {
+				gu->globalQuit = true;
+				return;
+			}
+
+			LoadDemoFile(demoFile);
+			return;
+		}
+
 		if ((!FLAGS_game.empty()) && (!FLAGS_map.empty())) {
 			// --game and --map directly specified, try to run them
 			activeController = RunScript(StartScriptGen::CreateMinimalSetup(FLAGS_game, FLAGS_map));
@@ -749,6 +793,35 @@ void SpringApp::Reload(const std::string script)
 	LOG("[SpringApp::%s][13] reloadCount=%u\n\n\n", __func__, ++reloadCount);
 }
 
+void SpringApp::ReloadGame()
+{
+	LOG("[SpringApp::%s][1] frame=%d", __func__, gs->frameNum);
+
+	// get rid of any running worker threads
+	ThreadPool::SetThreadCount(0);
+	ThreadPool::SetDefaultThreadCount();
+
+	// owned by the new game as its save-file
+	ILoadSaveHandler* stateHandler = game->TakeReloadState();
+
+	// unlike ::Reload the connection (and a local server) stay up, the
+	// messages following the state are read by the rebuilt game
+	game->KillLua(false);
+
+	// thread might access readMap which is deleted by ~CGame
+	ISound::Shutdown(true);
+
+	LOG("[SpringApp::%s][2]", __func__);
+
+	spring::SafeDelete(game);
+
+	ISound::Initialize(true);
+
+	LOG("[SpringApp::%s][3]", __func__);
+
+	CLoadScreen::CreateDeleteInstance(gameSetup->MapFileName(), archiveScanner->ArchiveFromName(gameSetup->modName), stateHandler);
+}
+
 /**
  * @return return code of ActiveController::Update
  */
@@ -774,6 +847,7 @@ bool SpringApp::Update()
 
 	// always swap by default, not doing so can upset some drivers
 	globalRendering->SwapBuffers(swap, false);
+	profiler.NewFrame();
 	return retc;
 }
 
@@ -806,6 +880,8 @@ int SpringApp::Run()
 			if (gu->globalReload) {
 				// copy; reloadScript is cleared by ResetState
 				Reload(gameSetup->reloadScript);
+			} else if (game != nullptr && game->HasReloadState()) {
+				ReloadGame();
 			} else {
 				gu->globalQuit = (!Update() || gu->globalQuit);
 			}
@@ -937,6 +1013,9 @@ void SpringApp::Kill(bool fromRun)
 	Watchdog::Uninstall();
 	LOG("[SpringApp::%s][9]", __func__);
 
+	// remaining records are written synchronously from here on
+	log_backend_setAsync(false, 0);
+
 	killedCount -= 1;
 }
 
@@ -48,6 +48,7 @@ private:
 	void Startup();                                 //!< Parses startup data (script etc.) and starts SelectMenu or PreGame
 	void StartScript(const std::string& script);    //!< Starts game from specified script.txt
 	void Reload(const std::string script);          //!< Returns from game back to menu, or directly starts a new game
+	void ReloadGame();                              //!< Rebuilds the running game from the state queued by CGame::ReloadState
 	void LoadSpringMenu();                          //!< Load menu (old or luaified depending on start parameters)
 
 	CGameController* RunScript(const std::string& buf);
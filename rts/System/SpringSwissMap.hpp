@@ -0,0 +1,517 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef _SPRING_SWISS_MAP_H_
+#define _SPRING_SWISS_MAP_H_
+
+#include <cassert>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <new>
+#include <utility>
+
+#include "System/bitops.h"
+
+#if (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)))
+	#define SPRING_SWISS_MAP_SSE2
+	#include <emmintrin.h>
+#endif
+
+namespace spring {
+	/**
+	 * Open-addressing hash map after the "Swiss table" design: every slot has
+	 * a control byte (empty, deleted, or seven bits of its key's hash) and the
+	 * control bytes are matched sixteen at a time, so a lookup usually compares
+	 * at most one key. Pairs live inline in one flat array; there are no node
+	 * allocations and erasing only leaves a tombstone until the next rehash.
+	 *
+	 * The interface and iterator semantics follow emilib::HashMap (including
+	 * erase(iterator) returning the next element and never rehashing), so both
+	 * can back the same code. The layout depends only on the hash values and
+	 * the sequence of operations, never on addresses or on whether the SSE2 or
+	 * the scalar matcher is used, so iteration order is the same on all clients.
+	 */
+	template<typename KeyT, typename ValueT, typename HashT, typename CompT>
+	class SwissMap
+	{
+	public:
+		using MyType = SwissMap<KeyT, ValueT, HashT, CompT>;
+		using PairT = std::pair<KeyT, ValueT>;
+
+		using key_type        = KeyT;
+		using mapped_type     = ValueT;
+		using size_type       = size_t;
+		using value_type      = PairT;
+		using reference       = PairT&;
+		using const_reference = const PairT&;
+
+		class iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using difference_type   = size_t;
+			using distance_type     = size_t;
+			using value_type        = std::pair<KeyT, ValueT>;
+			using pointer           = value_type*;
+			using reference         = value_type&;
+
+			iterator() {}
+			iterator(MyType* map, size_t bucket): _map(map), _bucket(bucket) {}
+
+			iterator& operator ++ () { _bucket = _map->next_filled_bucket(_bucket + 1); return *this; }
+			iterator operator ++ (int) { iterator it = *this; ++(*this); return it; }
+
+			reference operator * () const { return _map->_pairs[_bucket]; }
+			pointer operator -> () const { return (_map->_pairs + _bucket); }
+
+			bool operator == (const iterator& rhs) const { return (_bucket == rhs._bucket); }
+			bool operator != (const iterator& rhs) const { return (_bucket != rhs._bucket); }
+
+		public:
+			MyType* _map = nullptr;
+			size_t _bucket = 0;
+		};
+
+		class const_iterator
+		{
+		public:
+			using iterator_category = std::forward_iterator_tag;
+			using difference_type   = size_t;
+			using distance_type     = size_t;
+			using value_type        = const std::pair<KeyT, ValueT>;
+			using pointer           = value_type*;
+			using reference         = value_type&;
+
+			const_iterator() {}
+			const_iterator(iterator proto): _map(proto._map), _bucket(proto._bucket) {}
+			const_iterator(const MyType* map, size_t bucket): _map(map), _bucket(bucket) {}
+
+			const_iterator& operator ++ () { _bucket = _map->next_filled_bucket(_bucket + 1); return *this; }
+			const_iterator operator ++ (int) { const_iterator it = *this; ++(*this); return it; }
+
+			reference operator * () const { return _map->_pairs[_bucket]; }
+			pointer operator -> () const { return (_map->_pairs + _bucket); }
+
+			bool operator == (const const_iterator& rhs) const { return (_bucket == rhs._bucket); }
+			bool operator != (const const_iterator& rhs) const { return (_bucket != rhs._bucket); }
+
+		public:
+			const MyType* _map = nullptr;
+			size_t _bucket = 0;
+		};
+
+	public:
+		SwissMap() = default;
+		SwissMap(size_t num_elems) { reserve(num_elems); }
+		SwissMap(const std::initializer_list<PairT>& l) {
+			reserve(l.size());
+
+			for (const auto& pair: l) {
+				insert(pair.first, pair.second);
+			}
+		}
+
+		SwissMap(const SwissMap& other) {
+			reserve(other.size());
+			insert(other.cbegin(), other.cend());
+		}
+		SwissMap(SwissMap&& other) { swap(other); }
+
+		~SwissMap() {
+			destroy_pairs();
+			free(_ctrl);
+			free(_pairs);
+		}
+
+		SwissMap& operator = (const SwissMap& other) {
+			if (this == &other)
+				return *this;
+
+			clear();
+			reserve(other.size());
+			insert(other.cbegin(), other.cend());
+			return *this;
+		}
+		SwissMap& operator = (SwissMap&& other) {
+			swap(other);
+			return *this;
+		}
+
+		void swap(SwissMap& other) {
+			std::swap(_hasher,      other._hasher);
+			std::swap(_comp,        other._comp);
+			std::swap(_ctrl,        other._ctrl);
+			std::swap(_pairs,       other._pairs);
+			std::swap(_num_buckets, other._num_buckets);
+			std::swap(_num_filled,  other._num_filled);
+			std::swap(_growth_left, other._growth_left);
+			std::swap(_mask,        other._mask);
+		}
+
+		iterator begin() { return iterator(this, next_filled_bucket(0)); }
+		iterator end() { return iterator(this, _num_buckets); }
+
+		const_iterator begin() const { return const_iterator(this, next_filled_bucket(0)); }
+		const_iterator end() const { return const_iterator(this, _num_buckets); }
+		const_iterator cbegin() const { return (begin()); }
+		const_iterator cend() const { return (end()); }
+
+		size_t size() const { return _num_filled; }
+		bool empty() const { return (_num_filled == 0); }
+
+		iterator find(const KeyT& key) {
+			const size_t bucket = find_filled_bucket(key);
+
+			if (bucket == size_t(-1))
+				return end();
+
+			return iterator(this, bucket);
+		}
+
+		const_iterator find(const KeyT& key) const {
+			const size_t bucket = find_filled_bucket(key);
+
+			if (bucket == size_t(-1))
+				return end();
+
+			return const_iterator(this, bucket);
+		}
+
+		bool contains(const KeyT& key) const { return (find_filled_bucket(key) != size_t(-1)); }
+		size_t count(const KeyT& key) const { return (contains(key)? 1: 0); }
+
+		ValueT* try_get(const KeyT& key) {
+			const size_t bucket = find_filled_bucket(key);
+			return ((bucket != size_t(-1))? &_pairs[bucket].second: nullptr);
+		}
+		const ValueT* try_get(const KeyT& key) const {
+			const size_t bucket = find_filled_bucket(key);
+			return ((bucket != size_t(-1))? &_pairs[bucket].second: nullptr);
+		}
+
+		const ValueT get_or_return_default(const KeyT& key) const {
+			const ValueT* ret = try_get(key);
+			return ((ret != nullptr)? *ret: ValueT());
+		}
+
+
+		std::pair<iterator, bool> insert(const KeyT& key, const ValueT& value) {
+			const size_t hash = _hasher(key);
+			const size_t bucket = find_filled_bucket(key, hash);
+
+			if (bucket != size_t(-1))
+				return {iterator(this, bucket), false};
+
+			const size_t slot = prepare_insert(hash);
+			new (_pairs + slot) PairT(key, value);
+			return {iterator(this, slot), true};
+		}
+
+		std::pair<iterator, bool> insert(const PairT& p) { return (insert(p.first, p.second)); }
+		std::pair<iterator, bool> emplace(const KeyT& key, const ValueT& value) { return (insert(key, value)); }
+
+		void insert(const_iterator begin, const_iterator end) {
+			for (; begin != end; ++begin) {
+				insert(begin->first, begin->second);
+			}
+		}
+
+		// contains(key) MUST be false
+		void insert_unique(KeyT&& key, ValueT&& value) {
+			assert(!contains(key));
+
+			const size_t slot = prepare_insert(_hasher(key));
+			new (_pairs + slot) PairT(std::move(key), std::move(value));
+		}
+		void insert_unique(PairT&& p) { insert_unique(std::move(p.first), std::move(p.second)); }
+
+		// returns the old value or ValueT() if it did not exist
+		ValueT set_get(const KeyT& key, const ValueT& new_value) {
+			const size_t hash = _hasher(key);
+			const size_t bucket = find_filled_bucket(key, hash);
+
+			if (bucket != size_t(-1)) {
+				ValueT old_value = std::move(_pairs[bucket].second);
+				_pairs[bucket].second = new_value;
+				return old_value;
+			}
+
+			new (_pairs + prepare_insert(hash)) PairT(key, new_value);
+			return ValueT();
+		}
+
+		ValueT& operator [] (const KeyT& key) {
+			const size_t hash = _hasher(key);
+			const size_t bucket = find_filled_bucket(key, hash);
+
+			if (bucket != size_t(-1))
+				return _pairs[bucket].second;
+
+			const size_t slot = prepare_insert(hash);
+			new (_pairs + slot) PairT(key, ValueT());
+			return _pairs[slot].second;
+		}
+
+
+		bool erase(const KeyT& key) {
+			const size_t bucket = find_filled_bucket(key);
+
+			if (bucket == size_t(-1))
+				return false;
+
+			erase_bucket(bucket);
+			return true;
+		}
+
+		// returns an iterator to the next element (or end())
+		iterator erase(iterator it) {
+			erase_bucket(it._bucket);
+			return ++it;
+		}
+
+		// removes all elements, keeping full capacity
+		void clear() {
+			destroy_pairs();
+
+			if (_ctrl != nullptr)
+				std::memset(_ctrl, CTRL_EMPTY, _num_buckets + GROUP_WIDTH);
+
+			_num_filled = 0;
+			_growth_left = max_fill(_num_buckets);
+		}
+
+		// makes room for this many elements
+		void reserve(size_t num_elems) {
+			size_t num_buckets = GROUP_WIDTH;
+
+			while (max_fill(num_buckets) < num_elems) {
+				num_buckets *= 2;
+			}
+
+			if (num_buckets <= _num_buckets)
+				return;
+
+			rehash(num_buckets);
+		}
+
+	private:
+		static constexpr size_t GROUP_WIDTH = 16;
+
+		// full slots store the low seven bits of H2 (0..127)
+		static constexpr int8_t CTRL_EMPTY = -128;
+		static constexpr int8_t CTRL_DELETED = -2;
+
+		// sixteen control bytes starting at an arbitrary slot; the bytes past
+		// the last slot mirror the first GROUP_WIDTH so no wrapping is needed
+		struct Group {
+			explicit Group(const int8_t* p) {
+				#ifdef SPRING_SWISS_MAP_SSE2
+				ctrl = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				#else
+				std::memcpy(ctrl, p, GROUP_WIDTH);
+				#endif
+			}
+
+			#ifdef SPRING_SWISS_MAP_SSE2
+			uint32_t Match(int8_t h2) const { return (_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl))); }
+			uint32_t MatchEmpty() const { return (Match(CTRL_EMPTY)); }
+			uint32_t MatchEmptyOrDeleted() const { return (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl))); }
+
+			__m128i ctrl;
+			#else
+			uint32_t Match(int8_t h2) const {
+				uint32_t mask = 0;
+
+				for (size_t i = 0; i < GROUP_WIDTH; i++) {
+					mask |= (uint32_t(ctrl[i] == h2) << i);
+				}
+
+				return mask;
+			}
+			uint32_t MatchEmpty() const { return (Match(CTRL_EMPTY)); }
+			uint32_t MatchEmptyOrDeleted() const {
+				uint32_t mask = 0;
+
+				for (size_t i = 0; i < GROUP_WIDTH; i++) {
+					mask |= (uint32_t(ctrl[i] < -1) << i);
+				}
+
+				return mask;
+			}
+
+			int8_t ctrl[GROUP_WIDTH];
+			#endif
+		};
+
+		// 7/8 maximum load, tombstones included
+		static size_t max_fill(size_t num_buckets) { return (num_buckets - num_buckets / 8); }
+
+		// hashers such as synced_hash<int> are the identity, scatter them first
+		static uint64_t mix_hash(size_t hash) { return (uint64_t(hash) * 0x9E3779B97F4A7C15ull); }
+
+		static size_t h1(size_t hash) { const uint64_t m = mix_hash(hash); return (size_t(m ^ (m >> 32))); }
+		static int8_t h2(size_t hash) { return (int8_t(mix_hash(hash) >> 57)); }
+
+		static size_t first_bit(uint32_t mask) { return (bits_ffs(mask) - 1); }
+
+
+		size_t next_filled_bucket(size_t bucket) const {
+			while (bucket < _num_buckets && _ctrl[bucket] < 0) {
+				++bucket;
+			}
+
+			return bucket;
+		}
+
+		void set_ctrl(size_t bucket, int8_t value) {
+			_ctrl[bucket] = value;
+			_ctrl[((bucket - GROUP_WIDTH) & _mask) + GROUP_WIDTH] = value;
+		}
+
+		size_t find_filled_bucket(const KeyT& key) const {
+			if (empty())
+				return size_t(-1);
+
+			return (find_filled_bucket(key, _hasher(key)));
+		}
+
+		size_t find_filled_bucket(const KeyT& key, size_t hash) const {
+			if (empty())
+				return size_t(-1);
+
+			const int8_t tag = h2(hash);
+
+			size_t pos = h1(hash) & _mask;
+			size_t step = 0;
+
+			// triangular group-steps visit every group of a power-of-two table
+			while (true) {
+				const Group group(_ctrl + pos);
+
+				for (uint32_t mask = group.Match(tag); mask != 0; mask &= (mask - 1)) {
+					const size_t bucket = (pos + first_bit(mask)) & _mask;
+
+					if (_comp(_pairs[bucket].first, key))
+						return bucket;
+				}
+
+				// a probe only ever continues past groups without empty slots
+				if (group.MatchEmpty() != 0)
+					return size_t(-1);
+
+				step += GROUP_WIDTH;
+				pos = (pos + step) & _mask;
+			}
+		}
+
+		size_t find_insert_bucket(size_t hash) const {
+			size_t pos = h1(hash) & _mask;
+			size_t step = 0;
+
+			while (true) {
+				const uint32_t mask = Group(_ctrl + pos).MatchEmptyOrDeleted();
+
+				if (mask != 0)
+					return ((pos + first_bit(mask)) & _mask);
+
+				step += GROUP_WIDTH;
+				pos = (pos + step) & _mask;
+			}
+		}
+
+		// claims a slot for a key known not to be present, the caller constructs its pair
+		size_t prepare_insert(size_t hash) {
+			if (_num_buckets == 0)
+				rehash(GROUP_WIDTH);
+
+			size_t bucket = find_insert_bucket(hash);
+
+			// reusing a tombstone does not consume growth
+			if (_growth_left == 0 && _ctrl[bucket] != CTRL_DELETED) {
+				// mostly tombstones, rehash in place instead of growing
+				rehash(_num_buckets * (1 + (_num_filled >= max_fill(_num_buckets) / 2)));
+				bucket = find_insert_bucket(hash);
+			}
+
+			_growth_left -= (_ctrl[bucket] == CTRL_EMPTY);
+			_num_filled += 1;
+
+			set_ctrl(bucket, h2(hash));
+			return bucket;
+		}
+
+		void erase_bucket(size_t bucket) {
+			assert(bucket < _num_buckets && _ctrl[bucket] >= 0);
+
+			set_ctrl(bucket, CTRL_DELETED);
+			_pairs[bucket].~PairT();
+			_num_filled -= 1;
+		}
+
+		void destroy_pairs() {
+			for (size_t bucket = 0; bucket < _num_buckets; ++bucket) {
+				if (_ctrl[bucket] >= 0) {
+					_pairs[bucket].~PairT();
+				}
+			}
+		}
+
+		void rehash(size_t num_buckets) {
+			assert(num_buckets >= GROUP_WIDTH && (num_buckets & (num_buckets - 1)) == 0);
+
+			int8_t* new_ctrl  = (int8_t*) malloc(num_buckets + GROUP_WIDTH);
+			PairT*  new_pairs = (PairT*) malloc(num_buckets * sizeof(PairT));
+
+			if (new_ctrl == nullptr || new_pairs == nullptr) {
+				free(new_ctrl);
+				free(new_pairs);
+				throw std::bad_alloc();
+			}
+
+			std::memset(new_ctrl, CTRL_EMPTY, num_buckets + GROUP_WIDTH);
+
+			const size_t old_num_buckets = _num_buckets;
+
+			int8_t* old_ctrl  = _ctrl;
+			PairT*  old_pairs = _pairs;
+
+			_ctrl        = new_ctrl;
+			_pairs       = new_pairs;
+			_num_buckets = num_buckets;
+			_mask        = num_buckets - 1;
+			_growth_left = max_fill(num_buckets) - _num_filled;
+
+			for (size_t src_bucket = 0; src_bucket < old_num_buckets; src_bucket++) {
+				if (old_ctrl[src_bucket] < 0)
+					continue;
+
+				PairT& src_pair = old_pairs[src_bucket];
+
+				const size_t hash = _hasher(src_pair.first);
+				const size_t dst_bucket = find_insert_bucket(hash);
+
+				set_ctrl(dst_bucket, h2(hash));
+				new (_pairs + dst_bucket) PairT(std::move(src_pair));
+
+				src_pair.~PairT();
+			}
+
+			free(old_ctrl);
+			free(old_pairs);
+		}
+
+	private:
+		HashT   _hasher;
+		CompT   _comp;
+		int8_t* _ctrl        = nullptr; // _num_buckets + GROUP_WIDTH control bytes
+		PairT*  _pairs       = nullptr;
+		size_t  _num_buckets = 0;
+		size_t  _num_filled  = 0;
+		size_t  _growth_left = 0; // insertions into empty slots left before the next rehash
+		size_t  _mask        = 0; // _num_buckets minus one
+	};
+}
+
+#endif
@@ -1,5 +1,6 @@
 /* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 
@@ -83,6 +84,67 @@ void sha512::calc_digest(const uint8_t msg_bytes[], size_t len, uint8_t sha_byte
 }
 
 
+void sha512::init_digest(calc_state& ctx) {
+	std::memcpy(&ctx.state[0], &STATE_CONSTS[0], sizeof(STATE_CONSTS));
+	std::memset(&ctx.block[0], 0, BLK_LEN);
+
+	ctx.len = 0;
+}
+
+void sha512::update_digest(calc_state& ctx, const uint8_t msg_bytes[], size_t len) {
+	size_t used = ctx.len & (BLK_LEN - 1);
+	size_t ofs = 0;
+
+	ctx.len += len;
+
+	// top up a partial block left over from the previous call
+	if (used > 0) {
+		const size_t num = std::min(len, BLK_LEN - used);
+
+		std::memcpy(&ctx.block[used], &msg_bytes[0], num);
+
+		if ((used += num) < BLK_LEN)
+			return;
+
+		dm_compress(ctx.state, ctx.block, BLK_LEN);
+		ofs = num;
+	}
+
+	const size_t end = ofs + ((len - ofs) & (~static_cast<size_t>(BLK_LEN - 1)));
+
+	dm_compress(ctx.state, &msg_bytes[ofs], end - ofs);
+
+	if (end < len)
+		std::memcpy(&ctx.block[0], &msg_bytes[end], len - end);
+}
+
+void sha512::final_digest(calc_state& ctx, uint8_t sha_bytes[SHA_LEN]) {
+	// same padding as calc_digest
+	uint64_t len = ctx.len;
+	size_t ofs = (len & (BLK_LEN - 1)) + 1;
+
+	std::memset(&ctx.block[ofs - 1], 0, BLK_LEN - (ofs - 1));
+	ctx.block[ofs - 1] = 0x80;
+
+	if ((ofs + 16) > BLK_LEN) {
+		dm_compress(ctx.state, ctx.block, BLK_LEN);
+		std::memset(ctx.block, 0, BLK_LEN);
+	}
+
+	ctx.block[BLK_LEN - 1] = static_cast<uint8_t>((len & 0x1Fu) << 3);
+	len >>= 5;
+
+	for (uint8_t i = 1; i < 16; i++, len >>= 8) {
+		ctx.block[BLK_LEN - 1 - i] = static_cast<uint8_t>(len);
+	}
+
+	dm_compress(ctx.state, ctx.block, BLK_LEN);
+
+	for (uint8_t i = 0; i < SHA_LEN; i++) {
+		sha_bytes[i] = static_cast<uint8_t>(ctx.state[i >> 3] >> ((7 - (i & 7)) << 3));
+	}
+}
+
 void sha512::dm_compress(uint64_t state[NUM_STATE_CONSTS], const uint8_t blocks[], size_t len) {
 	assert(len == 0 || (len % BLK_LEN) == 0);
 
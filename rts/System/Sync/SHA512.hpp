@@ -54,10 +54,20 @@ namespace sha512 {
 	typedef std::array<   char, SHA_LEN * 2 + 1> hex_digest; // null-terminated
 	typedef std::vector<uint8_t                > msg_vector;
 
+	// incremental digest, for messages that are not available in one piece
+	struct calc_state {
+		uint64_t state[NUM_STATE_CONSTS];
+		uint8_t block[BLK_LEN];
+		uint64_t len;
+	};
+
 	void read_digest(const hex_digest& hex_chars, raw_digest& sha_bytes); // hex to raw
 	void dump_digest(const raw_digest& sha_bytes, hex_digest& hex_chars); // raw to hex
 	void calc_digest(const msg_vector& msg_bytes, raw_digest& sha_bytes);
 	void calc_digest(const uint8_t msg_bytes[], size_t len, uint8_t sha_bytes[SHA_LEN]);
+	void init_digest(calc_state& ctx);
+	void update_digest(calc_state& ctx, const uint8_t msg_bytes[], size_t len);
+	void final_digest(calc_state& ctx, uint8_t sha_bytes[SHA_LEN]);
 	void dm_compress(uint64_t state[NUM_STATE_CONSTS], const uint8_t blocks[], size_t len);
 
 	bool unit_test(const char* msg_str = TEST_STR_PAIR[0], const char* sha_str = TEST_STR_PAIR[1]);
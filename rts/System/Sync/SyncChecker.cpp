@@ -6,7 +6,8 @@
 #include "SyncChecker.h"
 
 
-unsigned CSyncChecker::g_checksum;
+unsigned CSyncChecker::laneChecksums[SYNC_LANE_COUNT];
+thread_local unsigned CSyncChecker::curLane = SYNC_LANE_MISC;
 int CSyncChecker::inSyncedCode;
 
 
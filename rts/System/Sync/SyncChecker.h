@@ -3,6 +3,21 @@
 #ifndef SYNCCHECKER_H
 #define SYNCCHECKER_H
 
+/**
+ * Sim subsystems whose synced writes are summed into separate checksums,
+ * combined in this order into the frame checksum. Also part of the
+ * NETMSG_SYNCRESPONSE layout, so defined regardless of SYNCCHECK.
+ */
+enum SyncLane {
+	SYNC_LANE_MISC        = 0, // commands, teams, everything not covered below
+	SYNC_LANE_LUA         = 1,
+	SYNC_LANE_PATH        = 2,
+	SYNC_LANE_UNITS       = 3,
+	SYNC_LANE_PROJECTILES = 4,
+	SYNC_LANE_FEATURES    = 5,
+	SYNC_LANE_COUNT       = 6,
+};
+
 #ifdef SYNCCHECK
 
 #ifdef TRACE_SYNC_HEAVY
@@ -14,8 +29,11 @@
 /**
  * @brief sync checker class
  *
- * A Lightweight sync debugger that just keeps a running checksum over all
- * assignments to synced variables.
+ * A Lightweight sync debugger that just keeps running checksums over all
+ * assignments to synced variables, one per SyncLane. The lane is selected
+ * per thread (see ScopedLane), so subsystems that run concurrently do not
+ * contend on one checksum; a lane must only be written by one thread at
+ * a time.
  */
 class CSyncChecker {
 
@@ -27,13 +45,54 @@ class CSyncChecker {
 		static void EnterSyncedCode() { ++inSyncedCode; }
 		static void LeaveSyncedCode() { assert(InSyncedCode()); --inSyncedCode; }
 
+		/**
+		 * Selects the lane synced writes on the current thread go to until
+		 * the end of the scope.
+		 */
+		class ScopedLane {
+		public:
+			ScopedLane(SyncLane lane): prevLane(curLane) { curLane = lane; }
+			~ScopedLane() { curLane = prevLane; }
+		private:
+			unsigned prevLane;
+		};
+
 		/**
 		 * Keeps a running checksum over all assignments to synced variables.
 		 */
-		static unsigned GetChecksum() { return g_checksum; }
-		static void NewFrame() { g_checksum = 0xfade1eaf; }
+		static unsigned GetChecksum() {
+			unsigned checksum = 0;
+
+			for (unsigned lane = 0; lane < SYNC_LANE_COUNT; ++lane) {
+				checksum += laneChecksums[lane];
+				checksum ^= checksum << 16;
+				checksum += checksum >> 11;
+			}
+
+			return checksum;
+		}
+		static unsigned GetLaneChecksum(unsigned lane) { return laneChecksums[lane]; }
+		static const unsigned* GetLaneChecksums() { return laneChecksums; }
+		/// continues the running checksums of another client, see CGame::ReadGameStatePart
+		static void SetLaneChecksums(const unsigned* checksums) {
+			for (unsigned lane = 0; lane < SYNC_LANE_COUNT; ++lane) {
+				laneChecksums[lane] = checksums[lane];
+			}
+		}
+		static const char* GetLaneName(unsigned lane) {
+			constexpr const char* names[SYNC_LANE_COUNT] = {"misc", "lua", "path", "units", "projectiles", "features"};
+			return ((lane < SYNC_LANE_COUNT)? names[lane]: "unknown");
+		}
+
+		static void NewFrame() {
+			for (unsigned& checksum: laneChecksums) {
+				checksum = 0xfade1eaf;
+			}
+		}
 
 		static void Sync(const void* p, unsigned size) {
+			unsigned& g_checksum = laneChecksums[curLane];
+
 			// most common cases first, make it easy for compiler to optimize for it
 			// simple xor is not enough to detect multiple zeroes, e.g.
 #ifdef TRACE_SYNC_HEAVY
@@ -85,9 +144,11 @@ class CSyncChecker {
 	private:
 
 		/**
-		 * The sync checksum
+		 * The sync checksums, one per SyncLane
 		 */
-		static unsigned g_checksum;
+		static unsigned laneChecksums[SYNC_LANE_COUNT];
+
+		static thread_local unsigned curLane;
 
 		/**
 		 * @brief in synced code
@@ -70,6 +70,12 @@ namespace Sync {
 #  define LEAVE_SYNCED_CODE()
 #endif
 
+#ifdef SYNCCHECK
+#  define SCOPED_SYNC_LANE(lane) CSyncChecker::ScopedLane __syncLane(lane)
+#else
+#  define SCOPED_SYNC_LANE(lane)
+#endif
+
 #ifdef SYNCDEBUG
 #  define ASSERT_SYNCED(x) Sync::AssertDebugger(x, "assert(" #x ")")
 #else
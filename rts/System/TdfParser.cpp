@@ -3,6 +3,7 @@
 #include <algorithm>
 #include <cctype>
 #include <climits>
+#include <cstring>
 #include <stdexcept>
 #include <sstream>
 #include <vector>
@@ -66,10 +67,10 @@ bool TdfParser::TdfSection::remove(const std::string& key, bool caseSensitive)
 	return ret;
 }
 
-void TdfParser::TdfSection::add_name_value(const std::string& name, const std::string& value)
+void TdfParser::TdfSection::add_name_value(std::string name, std::string value)
 {
-	std::string lowerd_name = StringToLower(name);
-	values[lowerd_name] = value;
+	StringToLowerInPlace(name);
+	values[std::move(name)] = std::move(value);
 }
 
 TdfParser::TdfSection::~TdfSection()
@@ -99,26 +100,29 @@ void TdfParser::print(std::ostream & out) const {
 
 
 void TdfParser::ParseLuaTable(const LuaTable& table, TdfSection* currentSection) {
-	std::vector<std::string> keys;
-	table.GetKeys(keys);
+	std::vector<LuaTable::Entry> entries;
+	table.GetEntries(entries);
+
+	char buf[64];
 
-	for (const std::string& key: keys) {
-		LuaTable::DataType dt = table.GetType(key);
-		switch (dt) {
+	for (LuaTable::Entry& e: entries) {
+		switch (e.type) {
 			case LuaTable::DataType::TABLE: {
-				ParseLuaTable(table.SubTable(key), currentSection->construct_subsection(key));
+				ParseLuaTable(table.SubTable(e.key), currentSection->construct_subsection(e.key));
 			} break;
 			case LuaTable::DataType::BOOLEAN: {
-				currentSection->AddPair(key, table.Get(key, false));
+				currentSection->add_name_value(std::move(e.key), e.boolean? "1": "0");
 			} break;
 			case LuaTable::DataType::NUMBER: {
-				currentSection->AddPair(key, table.Get(key, 0.0f));
+				// same formatting as AddPair's default-precision ostream
+				SNPRINTF(buf, sizeof(buf), "%g", e.num);
+				currentSection->add_name_value(std::move(e.key), buf);
 			} break;
 			case LuaTable::DataType::STRING: {
-				currentSection->AddPair(key, table.Get(key, std::string("")));
+				currentSection->add_name_value(std::move(e.key), std::move(e.str));
 			} break;
 			default:
-				throw content_error("invalid datatype for key " + key);
+				throw content_error("invalid datatype for key " + e.key);
 		}
 	}
 }
@@ -130,7 +134,16 @@ void TdfParser::ParseBuffer(const char* buf, size_t size) {
 	vfsHandler->SetName("TDFParserVFS");
 
 	{
-		const std::string script = std::string("local TDF = VFS.Include('gamedata/parse_tdf.lua'); return TDF.ParseText([[") + buf + "]])";
+		constexpr const char* head = "local TDF = VFS.Include('gamedata/parse_tdf.lua'); return TDF.ParseText([[";
+		constexpr const char* tail = "]])";
+
+		std::string script;
+
+		// the buffer need not be null-terminated
+		script.reserve(std::strlen(head) + size + std::strlen(tail));
+		script.append(head);
+		script.append(buf, std::find(buf, buf + size, 0));
+		script.append(tail);
 
 		LuaParser luaParser(script, SPRING_VFS_BASE);
 		luaParser.Execute();
@@ -171,10 +184,9 @@ void TdfParser::LoadFile(const std::string& filename)
 
 std::string TdfParser::SGetValueDef(const std::string& defaultValue, const std::string& location) const
 {
-	std::string lcLocation = StringToLower(location);
 	std::string value;
 
-	if (!SGetValue(value, lcLocation))
+	if (!SGetValue(value, location))
 		value = defaultValue;
 
 	return value;
@@ -182,11 +194,10 @@ std::string TdfParser::SGetValueDef(const std::string& defaultValue, const std::
 
 bool TdfParser::SGetValue(std::string& value, const std::string& location) const
 {
-	std::string lcLocation = StringToLower(location);
 	std::string searchpath; // for error-messages
 
-	// split the location string
-	const std::vector<std::string>& loclist = GetLocationVector(lcLocation);
+	// split the (lowercased) location string
+	const std::vector<std::string>& loclist = GetLocationVector(location);
 	sectionsMap_t::const_iterator sit = root_section.sections.find(loclist[0]);
 
 	if (sit == root_section.sections.end()) {
@@ -244,8 +255,7 @@ const TdfParser::valueMap_t& TdfParser::GetAllValues(const std::string& location
 {
 	const static valueMap_t emptymap;
 
-	const std::string& lcLocation = StringToLower(location);
-	const std::vector<std::string>& loclist = GetLocationVector(lcLocation);
+	const std::vector<std::string>& loclist = GetLocationVector(location);
 
 	sectionsMap_t::const_iterator sit = root_section.sections.find(loclist[0]);
 
@@ -276,8 +286,7 @@ const TdfParser::valueMap_t& TdfParser::GetAllValues(const std::string& location
 
 std::vector<std::string> TdfParser::GetSectionList(const std::string& location) const
 {
-	const std::string& lcLocation = StringToLower(location);
-	const std::vector<std::string>& loclist = GetLocationVector(lcLocation);
+	const std::vector<std::string>& loclist = GetLocationVector(location);
 
 	const sectionsMap_t* sectionsptr = &root_section.sections;
 
@@ -309,8 +318,7 @@ std::vector<std::string> TdfParser::GetSectionList(const std::string& location)
 
 bool TdfParser::SectionExist(const std::string& location) const
 {
-	const std::string& lcLocation = StringToLower(location);
-	const std::vector<std::string>& loclist = GetLocationVector(lcLocation);
+	const std::vector<std::string>& loclist = GetLocationVector(location);
 
 	sectionsMap_t::const_iterator sit = root_section.sections.find(loclist[0]);
 
@@ -32,7 +32,7 @@ public:
 		TdfSection* construct_subsection(const std::string& name);
 		void print(std::ostream& out) const;
 		bool remove(const std::string& key, bool caseSensitive = true);
-		void add_name_value(const std::string& name, const std::string& value);
+		void add_name_value(std::string name, std::string value);
 
 		template<typename T>
 		void AddPair(const std::string& key, const T& value);
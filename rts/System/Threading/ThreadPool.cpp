@@ -40,12 +40,14 @@
 
 #ifndef UNIT_TEST
 CONFIG(int, WorkerThreadCount).defaultValue(-1).safemodeValue(0).minimumValue(-1).description("Number of workers (including the main thread!) used by ThreadPool.");
+CONFIG(std::string, WorkerThreadCores).defaultValue("").description("Cores (e.g. \"4-7,12\") all ThreadPool workers are pinned to; if empty, each worker picks a core not used by the main thread.");
 #endif
 
 
 
 struct ThreadStats {
 	uint64_t numTasksRun;
+	uint64_t numTasksStolen;
 	uint64_t sumExecTime;
 	uint64_t minExecTime;
 	uint64_t maxExecTime;
@@ -60,22 +62,37 @@ struct ThreadStats {
 static std::vector< spring::thread > extThreads;
 static std::vector< std::future<void> > extFutures;
 
+// sync tasks (for_mt, parallel) run on the sync workers; async workers first
+// run all frame-critical tasks (parallel_reduce) and only then background jobs
+// (Enqueue), and steal background jobs from other async workers when idle
+enum TaskLane {
+	LANE_SYNC       = 0,
+	LANE_ASYNC      = 1,
+	LANE_ASYNC_PRIO = 2,
+	LANE_COUNT      = 3,
+};
+
+static const char* laneNames[LANE_COUNT] = {"sync", "async", "async-prio"};
+
 // global [idx = 0] and smaller per-thread [idx > 0] queues; the latter are
 // for tasks that want to execute on specific threads, e.g. parallel_reduce
 // note: std::shared_ptr<T> can not be made atomic, queues must store T*'s
 #ifdef USE_BOOST_LOCKFREE_QUEUE
-static std::array<boost::lockfree::queue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[2];
+static std::array<boost::lockfree::queue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[LANE_COUNT];
 #else
-static std::array<moodycamel::ConcurrentQueue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[2];
+static std::array<moodycamel::ConcurrentQueue<ITaskGroup*>, ThreadPool::MAX_THREADS> taskQueues[LANE_COUNT];
 #endif
 
 static std::vector<void*> workerThreads[2];
 static std::array<bool, ThreadPool::MAX_THREADS> exitFlags;
-static std::array<ThreadStats, ThreadPool::MAX_THREADS> threadStats[2];
+static std::array<ThreadStats, ThreadPool::MAX_THREADS> threadStats[LANE_COUNT];
 static spring::signal newTasksSignal[2];
 
 static _threadlocal int threadnum(0);
 
+// explicit core-set for all workers (WorkerThreadCores), 0 if none
+static std::uint32_t workerCoreMask = 0;
+
 #ifndef UNITSYNC
 // if enabled, allows OpenGL calls from ThreadPool tasks
 // so certain logic (e.g. loading models) can be written
@@ -104,6 +121,27 @@ static int GetConfigNumWorkers() {
 	#endif
 }
 
+static std::uint32_t GetConfigWorkerCores() {
+	#ifndef UNIT_TEST
+	return (Threading::ParseCoreList(configHandler->GetString("WorkerThreadCores")));
+	#else
+	return 0;
+	#endif
+}
+
+static std::uint32_t GetConfigMainCores() {
+	#ifndef UNIT_TEST
+	const std::string& mainCores = configHandler->GetString("MainThreadCores");
+
+	if (!mainCores.empty())
+		return (Threading::ParseCoreList(mainCores));
+
+	return (configHandler->GetUnsigned("SetCoreAffinity"));
+	#else
+	return 0;
+	#endif
+}
+
 static int GetDefaultNumWorkers() {
 	const int maxNumThreads = GetMaxThreads(); // min(MAX_THREADS, cpuCores)
 	const int cfgNumWorkers = GetConfigNumWorkers();
@@ -138,70 +176,79 @@ bool HasThreads() { return !workerThreads[false].empty(); }
 
 
 
-static bool DoTask(int tid, bool async)
+static TaskLane GetTaskLane(const ITaskGroup* tg)
 {
-	#ifndef UNIT_TEST
-	SCOPED_MT_TIMER("ThreadPool::RunTask");
+	if (!tg->IsAsyncTask())
+		return LANE_SYNC;
+
+	return (tg->IsHighPriority()? LANE_ASYNC_PRIO: LANE_ASYNC);
+}
+
+static bool PopTask(int tid, int lane, int idx, ITaskGroup*& tg)
+{
+	auto& queue = taskQueues[lane][idx];
+
+	#ifdef USE_BOOST_LOCKFREE_QUEUE
+	return (queue.pop(tg));
+	#else
+	return (queue.try_dequeue(tg));
+	#endif
+}
+
+static bool StealTask(int tid, ITaskGroup*& tg)
+{
+	// only background jobs can be stolen, the rest is pinned to its thread
+	for (int i = 1, n = ThreadPool::GetNumThreads(); i < n - 1; i++) {
+		if (PopTask(tid, LANE_ASYNC, 1 + (tid - 1 + i) % (n - 1), tg))
+			return true;
+	}
+
+	return false;
+}
+
+static void RunTask(int tid, int lane, ITaskGroup* tg, bool stolen)
+{
+	assert(GetTaskLane(tg) == lane);
+
+	#ifdef USE_TASK_STATS_TRACKING
+	const uint64_t wdt = tg->GetDeltaTime(spring_now());
+	const uint64_t edt = tg->ExecuteLoop(tid, false);
+
+	ThreadStats& ts = threadStats[lane][tid];
+
+	ts.numTasksRun    += 1;
+	ts.numTasksStolen += stolen;
+	ts.sumExecTime    += edt;
+	ts.sumWaitTime    += wdt;
+	ts.minExecTime     = std::min(ts.minExecTime, edt);
+	ts.maxExecTime     = std::max(ts.maxExecTime, edt);
+	ts.minWaitTime     = std::min(ts.minWaitTime, wdt);
+	ts.maxWaitTime     = std::max(ts.maxWaitTime, wdt);
+	#else
+	tg->ExecuteLoop(tid, false);
 	#endif
+}
 
+static bool DoSyncTask(int tid)
+{
 	ITaskGroup* tg = nullptr;
 
 	// any external thread calling WaitForFinished will have
 	// id=0 and *only* processes tasks from the global queue
 	for (int idx = 0; idx <= tid; idx += std::max(tid, 1)) {
-		auto& queue = taskQueues[async][idx];
-
-		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		if (queue.pop(tg)) {
-		#else
-		if (queue.try_dequeue(tg)) {
-		#endif
+		if (PopTask(tid, LANE_SYNC, idx, tg)) {
 			// inform other workers when there is global work to do
 			// waking is an expensive kernel-syscall, so better shift this
 			// cost to the workers too (the main thread only wakes when ALL
 			// workers are sleeping)
 			if (idx == 0)
-				NotifyWorkerThreads(true, async);
-
-			assert(!async || tg->IsAsyncTask());
-
-			#ifdef USE_TASK_STATS_TRACKING
-			const uint64_t wdt = tg->GetDeltaTime(spring_now());
-			const uint64_t edt = tg->ExecuteLoop(tid, false);
-
-			threadStats[async][tid].numTasksRun += 1;
-			threadStats[async][tid].sumExecTime += edt;
-			threadStats[async][tid].sumWaitTime += wdt;
-			threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
-			threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
-			threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
-			threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
-			#else
-			tg->ExecuteLoop(tid, false);
-			#endif
+				NotifyWorkerThreads(true, false);
+
+			RunTask(tid, LANE_SYNC, tg, false);
 		}
 
-		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		while (queue.pop(tg)) {
-		#else
-		while (queue.try_dequeue(tg)) {
-		#endif
-			assert(!async || tg->IsAsyncTask());
-
-			#ifdef USE_TASK_STATS_TRACKING
-			const uint64_t wdt = tg->GetDeltaTime(spring_now());
-			const uint64_t edt = tg->ExecuteLoop(tid, false);
-
-			threadStats[async][tid].numTasksRun += 1;
-			threadStats[async][tid].sumExecTime += edt;
-			threadStats[async][tid].sumWaitTime += wdt;
-			threadStats[async][tid].minExecTime  = std::min(threadStats[async][tid].minExecTime, edt);
-			threadStats[async][tid].maxExecTime  = std::max(threadStats[async][tid].maxExecTime, edt);
-			threadStats[async][tid].minWaitTime  = std::min(threadStats[async][tid].minWaitTime, wdt);
-			threadStats[async][tid].maxWaitTime  = std::max(threadStats[async][tid].maxWaitTime, wdt);
-			#else
-			tg->ExecuteLoop(tid, false);
-			#endif
+		while (PopTask(tid, LANE_SYNC, idx, tg)) {
+			RunTask(tid, LANE_SYNC, tg, false);
 		}
 	}
 
@@ -209,6 +256,49 @@ static bool DoTask(int tid, bool async)
 	return (tg != nullptr);
 }
 
+static bool DoAsyncTask(int tid)
+{
+	ITaskGroup* tg = nullptr;
+
+	bool ranTask = false;
+
+	while (true) {
+		// frame-critical tasks are rechecked after every background job
+		for (int idx = 0; idx <= tid; idx += std::max(tid, 1)) {
+			while (PopTask(tid, LANE_ASYNC_PRIO, idx, tg)) {
+				RunTask(tid, LANE_ASYNC_PRIO, tg, false);
+				ranTask = true;
+			}
+		}
+
+		if (PopTask(tid, LANE_ASYNC, tid, tg) || PopTask(tid, LANE_ASYNC, 0, tg)) {
+			RunTask(tid, LANE_ASYNC, tg, false);
+			ranTask = true;
+			continue;
+		}
+
+		if (!StealTask(tid, tg))
+			break;
+
+		RunTask(tid, LANE_ASYNC, tg, true);
+		ranTask = true;
+	}
+
+	return ranTask;
+}
+
+static bool DoTask(int tid, bool async)
+{
+	#ifndef UNIT_TEST
+	SCOPED_MT_TIMER("ThreadPool::RunTask");
+	#endif
+
+	if (async)
+		return (DoAsyncTask(tid));
+
+	return (DoSyncTask(tid));
+}
+
 
 __FORCE_ALIGN_STACK__
 static void WorkerLoop(int tid, bool async)
@@ -219,6 +309,9 @@ static void WorkerLoop(int tid, bool async)
 	Threading::SetThreadName(IntToString(tid, "worker%i"));
 	#endif
 
+	if (workerCoreMask != 0)
+		Threading::SetAffinity(workerCoreMask);
+
 	// make first worker spin a while before sleeping/waiting on the thread signal
 	// this increases the chance that at least one worker is awake when a new task
 	// is inserted, which can then take over the job of waking up sleeping workers
@@ -306,7 +399,7 @@ void WaitForFinished(std::shared_ptr<ITaskGroup>&& taskGroup)
 void PushTaskGroup(std::shared_ptr<ITaskGroup>&& taskGroup) { PushTaskGroup(taskGroup.get()); }
 void PushTaskGroup(ITaskGroup* taskGroup)
 {
-	auto& queue = taskQueues[ taskGroup->IsAsyncTask() ][ taskGroup->WantedThread() ];
+	auto& queue = taskQueues[ GetTaskLane(taskGroup) ][ taskGroup->WantedThread() ];
 
 	#if 0
 	// fake single-task group, handled by WaitForFinished to
@@ -324,9 +417,15 @@ void PushTaskGroup(ITaskGroup* taskGroup)
 	#endif
 
 	#if 1
-	// AsyncTask's do not care about wakeup-latency as much
-	if (taskGroup->IsAsyncTask())
+	// AsyncTask's do not care about wakeup-latency as much, unless
+	// the caller is waiting for them; these target a specific (and
+	// possibly sleeping) worker, so always wake
+	if (taskGroup->IsAsyncTask()) {
+		if (taskGroup->IsHighPriority())
+			NotifyWorkerThreads(true, true);
+
 		return;
+	}
 
 	NotifyWorkerThreads(false, false);
 	#else
@@ -350,6 +449,9 @@ void NotifyWorkerThreads(bool force, bool async)
 
 static void SpawnThreads(int wantedNumThreads, int curNumThreads)
 {
+	// read by each new worker when it starts
+	workerCoreMask = GetConfigWorkerCores();
+
 #ifndef UNITSYNC
 	if (glThreadSupport) {
 		try {
@@ -409,13 +511,9 @@ static void KillThreads(int wantedNumThreads, int curNumThreads)
 	for (int i = curNumThreads - 1; i >= wantedNumThreads && i > 0; --i) {
 		ITaskGroup* tg = nullptr;
 
-		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		while (taskQueues[false][i].pop(tg));
-		while (taskQueues[ true][i].pop(tg));
-		#else
-		while (taskQueues[false][i].try_dequeue(tg));
-		while (taskQueues[ true][i].try_dequeue(tg));
-		#endif
+		for (int lane = LANE_SYNC; lane < LANE_COUNT; lane++) {
+			while (PopTask(i, lane, i, tg));
+		}
 	}
 
 	assert((wantedNumThreads != 0) || workerThreads[false].empty());
@@ -466,14 +564,14 @@ void SetThreadCount(int wantedNumThreads)
 	const char* fmts[4] = {
 		"[ThreadPool::%s][1] wanted=%d current=%d maximum=%d (init=%d)",
 		"[ThreadPool::%s][2] workers=%lu",
-		"\t[async=%d] threads=%d tasks=%lu {sum,avg}{exec,wait}time={{%.3f, %.3f}, {%.3f, %.3f}}ms",
-		"\t\tthread=%d tasks=%lu {sum,min,max,avg}{exec,wait}time={{%.3f, %.3f, %.3f, %.3f}, {%.3f, %.3f, %.3f, %.3f}}ms",
+		"\t[lane=%s] threads=%d tasks=%lu {sum,avg}{exec,wait}time={{%.3f, %.3f}, {%.3f, %.3f}}ms",
+		"\t\tthread=%d tasks=%lu stolen=%lu {sum,min,max,avg}{exec,wait}time={{%.3f, %.3f, %.3f, %.3f}, {%.3f, %.3f, %.3f, %.3f}}ms",
 	};
 
 	// total number of tasks executed by pool; total time spent in DoTask
-	uint64_t pNumTasksRun [2] = {0lu, 0lu};
-	uint64_t pSumExecTimes[2] = {0lu, 0lu};
-	uint64_t pSumWaitTimes[2] = {0lu, 0lu};
+	uint64_t pNumTasksRun [LANE_COUNT] = {0lu, 0lu, 0lu};
+	uint64_t pSumExecTimes[LANE_COUNT] = {0lu, 0lu, 0lu};
+	uint64_t pSumWaitTimes[LANE_COUNT] = {0lu, 0lu, 0lu};
 
 	LOG(fmts[0], __func__, wantedNumThreads, curNumThreads, GetMaxThreads(), workerThreads[false].empty());
 
@@ -481,20 +579,22 @@ void SetThreadCount(int wantedNumThreads)
 		assert(workerThreads[true].empty());
 
 		#ifdef USE_BOOST_LOCKFREE_QUEUE
-		taskQueues[false][0].reserve(1024);
-		taskQueues[ true][0].reserve(1024);
+		for (int lane = LANE_SYNC; lane < LANE_COUNT; lane++) {
+			taskQueues[lane][0].reserve(1024);
+		}
 		#endif
 
 		#ifdef USE_TASK_STATS_TRACKING
-		for (bool async: {false, true}) {
+		for (int lane = LANE_SYNC; lane < LANE_COUNT; lane++) {
 			for (int i = 0; i < MAX_THREADS; i++) {
-				threadStats[async][i].numTasksRun = std::numeric_limits<uint64_t>::min();
-				threadStats[async][i].sumExecTime = std::numeric_limits<uint64_t>::min();
-				threadStats[async][i].minExecTime = std::numeric_limits<uint64_t>::max();
-				threadStats[async][i].maxExecTime = std::numeric_limits<uint64_t>::min();
-				threadStats[async][i].sumWaitTime = std::numeric_limits<uint64_t>::min();
-				threadStats[async][i].minWaitTime = std::numeric_limits<uint64_t>::max();
-				threadStats[async][i].maxWaitTime = std::numeric_limits<uint64_t>::min();
+				threadStats[lane][i].numTasksRun    = std::numeric_limits<uint64_t>::min();
+				threadStats[lane][i].numTasksStolen = std::numeric_limits<uint64_t>::min();
+				threadStats[lane][i].sumExecTime    = std::numeric_limits<uint64_t>::min();
+				threadStats[lane][i].minExecTime    = std::numeric_limits<uint64_t>::max();
+				threadStats[lane][i].maxExecTime    = std::numeric_limits<uint64_t>::min();
+				threadStats[lane][i].sumWaitTime    = std::numeric_limits<uint64_t>::min();
+				threadStats[lane][i].minWaitTime    = std::numeric_limits<uint64_t>::max();
+				threadStats[lane][i].maxWaitTime    = std::numeric_limits<uint64_t>::min();
 			}
 		}
 		#endif
@@ -528,24 +628,24 @@ void SetThreadCount(int wantedNumThreads)
 	if (workerThreads[false].empty()) {
 		assert(workerThreads[true].empty());
 
-		for (bool async: {false, true}) {
+		for (int lane = LANE_SYNC; lane < LANE_COUNT; lane++) {
 			for (int i = 0; i < curNumThreads; i++) {
-				pNumTasksRun [async] += threadStats[async][i].numTasksRun;
-				pSumExecTimes[async] += threadStats[async][i].sumExecTime;
-				pSumWaitTimes[async] += threadStats[async][i].sumWaitTime;
+				pNumTasksRun [lane] += threadStats[lane][i].numTasksRun;
+				pSumExecTimes[lane] += threadStats[lane][i].sumExecTime;
+				pSumWaitTimes[lane] += threadStats[lane][i].sumWaitTime;
 			}
 		}
 
-		for (bool async: {false, true}) {
-			const float pSumExecTime =  pSumExecTimes[async] * 1e-6f;
-			const float pSumWaitTime =  pSumWaitTimes[async] * 1e-6f;
-			const float pAvgExecTime = (pSumExecTimes[async] * 1e-6f) / std::max(pNumTasksRun[async], uint64_t(1));
-			const float pAvgWaitTime = (pSumWaitTimes[async] * 1e-6f) / std::max(pNumTasksRun[async], uint64_t(1));
+		for (int lane = LANE_SYNC; lane < LANE_COUNT; lane++) {
+			const float pSumExecTime =  pSumExecTimes[lane] * 1e-6f;
+			const float pSumWaitTime =  pSumWaitTimes[lane] * 1e-6f;
+			const float pAvgExecTime = (pSumExecTimes[lane] * 1e-6f) / std::max(pNumTasksRun[lane], uint64_t(1));
+			const float pAvgWaitTime = (pSumWaitTimes[lane] * 1e-6f) / std::max(pNumTasksRun[lane], uint64_t(1));
 
-			LOG(fmts[2], async, curNumThreads, pNumTasksRun[async],  pSumExecTime, pAvgExecTime,  pSumWaitTime, pAvgWaitTime);
+			LOG(fmts[2], laneNames[lane], curNumThreads, pNumTasksRun[lane],  pSumExecTime, pAvgExecTime,  pSumWaitTime, pAvgWaitTime);
 
 			for (int i = 0; i < curNumThreads; i++) {
-				const ThreadStats& ts = threadStats[async][i];
+				const ThreadStats& ts = threadStats[lane][i];
 
 				if (ts.numTasksRun == 0)
 					continue;
@@ -559,7 +659,7 @@ void SetThreadCount(int wantedNumThreads)
 				const float tAvgExecTime = tSumExecTime / std::max(ts.numTasksRun, uint64_t(1));
 				const float tAvgWaitTime = tSumWaitTime / std::max(ts.numTasksRun, uint64_t(1));
 
-				LOG(fmts[3], i, ts.numTasksRun,  tSumExecTime, tMinExecTime, tMaxExecTime, tAvgExecTime,  tSumWaitTime, tMinWaitTime, tMaxWaitTime, tAvgWaitTime);
+				LOG(fmts[3], i, ts.numTasksRun, ts.numTasksStolen,  tSumExecTime, tMinExecTime, tMaxExecTime, tAvgExecTime,  tSumWaitTime, tMinWaitTime, tMaxWaitTime, tAvgWaitTime);
 			}
 		}
 	}
@@ -592,16 +692,21 @@ void SetMaximumThreadCount()
 void SetDefaultThreadCount()
 {
 	std::uint32_t systemCores  = Threading::GetAvailableCoresMask();
-	std::uint32_t mainAffinity = systemCores;
-
-	#ifndef UNIT_TEST
-	mainAffinity &= configHandler->GetUnsigned("SetCoreAffinity");
-	#endif
+	std::uint32_t mainAffinity = systemCores & GetConfigMainCores();
 
 	std::uint32_t workerAvailCores = systemCores & ~mainAffinity;
 
 	SetThreadCount(GetDefaultNumWorkers());
 
+	if (workerCoreMask != 0) {
+		// workers pinned themselves on startup, keep main off their cores unless told otherwise
+		if (mainAffinity == 0)
+			mainAffinity = systemCores & ~workerCoreMask;
+
+		Threading::SetAffinityHelper("Main", mainAffinity);
+		return;
+	}
+
 	{
 		// parallel_reduce now folds over shared_ptrs to futures
 		// const auto ReduceFunc = [](std::uint32_t a, std::future<std::uint32_t>& b) -> std::uint32_t { return (a | b.get()); };
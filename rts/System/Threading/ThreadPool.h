@@ -48,6 +48,13 @@ static inline void for_mt2(int start, int end, unsigned worksize, const std::fun
 	for_mt(start, end, 1, std::move(f));
 }
 
+template <typename F>
+static inline void for_mt_range(int begin, int end, int grain, F&& f)
+{
+	if (begin < end)
+		f(begin, end);
+}
+
 
 static inline void parallel(const std::function<void()>&& f)
 {
@@ -126,6 +133,8 @@ public:
 
 	virtual bool IsAsyncTask() const { return false; }
 	virtual bool IsSliceTask() const { return false; }
+	// async tasks only; if true, runs ahead of queued background jobs and is never stolen
+	virtual bool IsHighPriority() const { return false; }
 	virtual bool ExecuteStep() = 0;
 	virtual bool SelfDelete() const { return false; }
 
@@ -220,7 +229,7 @@ class AsyncTask: public ITaskGroup
 public:
 	typedef  typename std::result_of<F(Args...)>::type  return_type;
 
-	AsyncTask(F f, Args... args) : selfDelete(true) {
+	AsyncTask(F f, Args... args) : selfDelete(true), highPriority(false) {
 		task = std::make_shared<std::packaged_task<return_type()>>(std::bind(f, std::forward<Args>(args)...));
 		result = std::make_shared<std::future<return_type>>(task->get_future());
 
@@ -229,6 +238,7 @@ public:
 
 	bool IsAsyncTask() const override { return true; }
 	bool SelfDelete() const override { return (selfDelete.load()); }
+	bool IsHighPriority() const override { return (highPriority.load()); }
 	bool ExecuteStep() override {
 		// note: *never* called from WaitForFinished
 		(*task)();
@@ -242,6 +252,8 @@ public:
 public:
 	// if true, we are not managed by a shared_ptr
 	std::atomic<bool> selfDelete;
+	// if true, the caller is blocking on our result (parallel_reduce)
+	std::atomic<bool> highPriority;
 
 	std::shared_ptr<std::packaged_task<return_type()>> task;
 	std::shared_ptr<std::future<return_type>> result;
@@ -636,6 +648,68 @@ private:
 #endif
 
 
+template<typename F>
+class ForRangeTaskGroup: public ITaskGroup
+{
+public:
+	ForRangeTaskGroup(bool pooled) : ITaskGroup(false, pooled) {}
+
+	void Enqueue(const int from, const int to, const int grain, F& func, bool timed)
+	{
+		assert(to >= from);
+		assert(grain > 0);
+
+		remainingTasks.store((to - from + grain - 1) / grain);
+		ctr.store(0);
+		execTime.store(0);
+
+		this->from  = from;
+		this->to    = to;
+		this->grain = grain;
+		this->timed = timed;
+		// not copied; the caller blocks in WaitForFinished while we run
+		this->func  = &func;
+	}
+
+	bool IsSliceTask() const override { return true; }
+	bool ExecuteStep() override
+	{
+		const int lo = from + (grain * ctr.fetch_add(1, std::memory_order_relaxed));
+
+		if (lo >= to)
+			return false;
+
+		const int hi = std::min(lo + grain, to);
+
+		if (timed) {
+			const spring_time t0 = spring_now();
+
+			(*func)(lo, hi);
+			execTime.fetch_add((spring_now() - t0).toNanoSecsi(), std::memory_order_relaxed);
+		} else {
+			(*func)(lo, hi);
+		}
+
+		remainingTasks -= 1;
+		return true;
+	}
+
+	uint64_t GetExecTime() const { return (execTime.load()); }
+
+private:
+	std::atomic<int> ctr;
+	std::atomic<uint64_t> execTime; // ns, summed over all chunks if timed
+
+	typename std::remove_reference<F>::type* func;
+
+	int from;
+	int to;
+	int grain;
+
+	bool timed;
+};
+
+
 
 
 
@@ -721,6 +795,72 @@ static inline void for_mt(int start, int end, F&& f)
 }
 
 
+namespace ThreadPool {
+	// aims for chunks of ~50us given <itemCost> (ns per item), but
+	// leaves at least four chunks per thread for load-balancing
+	static inline int GetRangeGrainSize(int numItems, float itemCost)
+	{
+		const int maxGrain = std::max(1, numItems / (GetNumThreads() * 4));
+
+		if (itemCost <= 0.0f)
+			return maxGrain;
+
+		return std::max(1, std::min(int(50000.0f / itemCost), maxGrain));
+	}
+}
+
+// like for_mt, but each task is handed a [lo, hi) range of up to <grain>
+// items and <f> is called without type-erasure; if <grain> is 0 the size
+// is derived from the per-item cost measured during earlier calls made
+// with the same <f> (call-site)
+template <typename F>
+static inline void for_mt_range(int begin, int end, int grain, F&& f)
+{
+	if (!ThreadPool::HasThreads() || ((end - begin) <= std::max(grain, 1))) {
+		if (begin < end)
+			f(begin, end);
+		return;
+	}
+
+	SCOPED_MT_TIMER("ThreadPool::AddTask");
+
+	// static, so TaskGroup's are recycled
+	static TaskPool<ForRangeTaskGroup, F> pool;
+	// ns per item, smoothed over calls; 0 until first measured
+	static std::atomic<float> itemCost = {0.0f};
+
+	const bool adaptive = (grain <= 0);
+
+	if (adaptive)
+		grain = ThreadPool::GetRangeGrainSize(end - begin, itemCost.load(std::memory_order_relaxed));
+
+	auto taskGroup = pool.GetTaskGroup();
+
+	taskGroup->Enqueue(begin, end, grain, f, adaptive);
+	taskGroup->UpdateId();
+
+	assert(taskGroup->IsInJobQueue());
+
+	// store the group in all worker queues s.t. each executes a slice
+	for (size_t i = 1; i < ThreadPool::GetNumThreads(); ++i) {
+		taskGroup->wantedThread.store(i);
+		ThreadPool::PushTaskGroup(taskGroup);
+	}
+
+	// make calling thread also run ExecuteLoop
+	ThreadPool::WaitForFinished(taskGroup);
+
+	if (!adaptive)
+		return;
+
+	// pooled groups are handed out round-robin, ours is not reused yet
+	const float curCost = taskGroup->GetExecTime() / float(end - begin);
+	const float oldCost = itemCost.load(std::memory_order_relaxed);
+
+	itemCost.store((oldCost > 0.0f)? (oldCost * 0.75f + curCost * 0.25f): curCost, std::memory_order_relaxed);
+}
+
+
 template <typename F>
 static inline void parallel(F&& f)
 {
@@ -781,6 +921,7 @@ static inline auto parallel_reduce(F&& f, G&& g) -> typename std::result_of<F()>
 
 		// tasks[i]->selfDelete.store(false);
 		tasks[i]->wantedThread.store(i);
+		tasks[i]->highPriority.store(true);
 
 		ThreadPool::PushTaskGroup(tasks[i]);
 	}
@@ -814,6 +955,7 @@ namespace ThreadPool {
 		// minor hack: assume AsyncTask's will cause (heavy) disk IO
 		// although these can never block the main thread, the async
 		// workers might still be handed an uneven work distribution
+		// (idle async workers steal from the queues of busy ones)
 		task->wantedThread.store(1 + task->GetId() % (ThreadPool::GetNumThreads() - 1));
 
 		ThreadPool::PushTaskGroup(task);
@@ -3,11 +3,13 @@
 #include <algorithm>
 #include <climits>
 #include <cstring>
+#include <fstream>
 
 #include "System/TimeProfiler.h"
 #include "System/GlobalRNG.h"
 #include "System/StringHash.h"
 #include "System/Log/ILog.h"
+#include "System/Platform/Threading.h"
 #include "System/Threading/SpringThreading.h"
 
 #ifdef THREADPOOL
@@ -21,6 +23,17 @@ static spring::unordered_map<unsigned, int> refCounters;
 
 static CGlobalUnsyncedRNG profileColorRNG;
 
+// guards the trace-event ring and thread names during a capture
+static spring::spinlock traceEventMutex;
+// trace-viewer names of all threads that ever added an event, by index
+static std::vector<std::string> traceThreadNames;
+
+static constexpr size_t MAX_TRACE_EVENTS = 1 << 20;
+static constexpr size_t MAX_TRACE_COUNTER_EVENTS = 1 << 16;
+
+// guards frameTimes, timers on worker threads add to it concurrently
+static spring::spinlock frameTimesMutex;
+
 
 spring_time BasicTimer::GetDuration() const
 {
@@ -40,7 +53,13 @@ ScopedTimer::ScopedTimer(const unsigned _nameHash, bool _autoShowGraph, bool _sp
 	if (iter == refCounters.end())
 		iter = refCounters.insert(std::pair<unsigned, int>(nameHash, 0)).first;
 
-	++(iter->second);
+	// nested scopes of the same timer are sampled once, like their time
+	if ((++(iter->second)) != 1 || !profiler.IsPerfCounterTimer(nameHash))
+		return;
+	if (!Threading::IsMainThread())
+		return;
+
+	perfSampled = PerfCounters::Read(perfStart);
 }
 
 ScopedTimer::~ScopedTimer()
@@ -51,9 +70,21 @@ ScopedTimer::~ScopedTimer()
 	assert(iter != refCounters.end());
 	assert(iter->second > 0);
 
-	if (--(iter->second) == 0) {
-		profiler.AddTime(nameHash, startTime, GetDuration(), autoShowGraph, specialTimer, false);
-	}
+	if (--(iter->second) != 0)
+		return;
+
+	PerfCounters::Values perfEnd;
+
+	// read before AddTime so the profiler's own work is not counted
+	const bool perfRead = perfSampled && PerfCounters::Read(perfEnd);
+	const spring_time duration = GetDuration();
+
+	profiler.AddTime(nameHash, startTime, duration, autoShowGraph, specialTimer, false);
+
+	if (!perfRead)
+		return;
+
+	profiler.AddPerfCounters(nameHash, startTime + duration, perfEnd - perfStart);
 }
 
 
@@ -177,6 +208,7 @@ void CTimeProfiler::ResetState() {
 	profiles.clear();
 	profiles.reserve(128);
 	sortedProfiles.clear();
+	counters.clear();
 	#ifdef THREADPOOL
 	threadProfiles.clear();
 	threadProfiles.resize(ThreadPool::GetMaxThreads());
@@ -186,6 +218,7 @@ void CTimeProfiler::ResetState() {
 
 	currentPosition = 0;
 	resortProfiles = 0;
+	numUpdateFrames = 0;
 
 	enabled = false;
 }
@@ -226,6 +259,8 @@ void CTimeProfiler::UpdateRaw()
 		pi.second.frames[currentPosition] = spring_notime;
 	}
 
+	numUpdateFrames += 1;
+
 	const spring_time curTime = spring_gettime();
 	const float timeDiff = spring_diffmsecs(curTime, lastBigUpdate);
 
@@ -237,6 +272,15 @@ void CTimeProfiler::UpdateRaw()
 			p.stats.y = spring_tomsecs(p.current) / timeDiff;
 			p.current = spring_notime;
 
+			if ((p.hasPerfStats = (p.perfCurrent.v[PerfCounters::COUNTER_CYCLES] > 0))) {
+				const auto& v = p.perfCurrent.v;
+
+				p.perfStats.x = v[PerfCounters::COUNTER_INSTRUCTIONS] * 1.0f / v[PerfCounters::COUNTER_CYCLES];
+				p.perfStats.y = v[PerfCounters::COUNTER_CACHE_MISSES] * 1.0f / numUpdateFrames;
+				p.perfStats.z = v[PerfCounters::COUNTER_BRANCH_MISSES] * 1.0f / numUpdateFrames;
+				p.perfCurrent = {};
+			}
+
 			p.newLagPeak = false;
 			p.newPeak = (p.stats.y > p.stats.z);
 
@@ -248,6 +292,7 @@ void CTimeProfiler::UpdateRaw()
 		}
 
 		lastBigUpdate = curTime;
+		numUpdateFrames = 0;
 	}
 
 	if (curTime.toSecsi() % 6 == 0) {
@@ -342,6 +387,14 @@ void CTimeProfiler::AddTime(
 ) {
 	const spring_time t0 = spring_now();
 
+	if (capturing)
+		AddTraceEvent(nameHash, startTime, deltaTime);
+
+	if (frameRecording) {
+		std::lock_guard<spring::spinlock> lock(frameTimesMutex);
+		frameTimes[nameHash] += deltaTime;
+	}
+
 	if (!enabled) {
 		if (!specialTimer)
 			return;
@@ -396,6 +449,97 @@ void CTimeProfiler::AddTimeRaw(
 	}
 }
 
+bool CTimeProfiler::SetPerfCounterTimers(const std::vector<std::string>& names)
+{
+	numPerfCounterTimers = 0;
+
+	if (names.empty()) {
+		PerfCounters::Kill();
+		return true;
+	}
+
+	// counters are per-thread, only main-thread timers can be sampled
+	assert(Threading::IsMainThread());
+
+	if (!PerfCounters::Init())
+		return false;
+
+	const unsigned int n = std::min(names.size(), size_t(MAX_PERF_COUNTER_TIMERS));
+
+	for (unsigned int i = 0; i < n; i++) {
+		perfCounterTimers[i] = hashString(names[i].c_str());
+	}
+
+	if (names.size() > n)
+		LOG_L(L_WARNING, "[%s] only the first %u timers are sampled", __func__, n);
+
+	numPerfCounterTimers = n;
+	return true;
+}
+
+void CTimeProfiler::AddPerfCounters(unsigned nameHash, const spring_time endTime, const PerfCounters::Values& delta)
+{
+	if (capturing) {
+		std::lock_guard<spring::spinlock> lock(traceEventMutex);
+
+		if (traceCounterEvents.size() < MAX_TRACE_COUNTER_EVENTS)
+			traceCounterEvents.push_back({nameHash, endTime, delta});
+	}
+
+	// like AddTime, only lock if other threads can add profiles
+	if (!enabled) {
+		const auto pi = profiles.find(nameHash);
+
+		if (pi != profiles.end())
+			pi->second.perfCurrent += delta;
+
+		return;
+	}
+
+	std::lock_guard<spring::spinlock> lock(profileMutex);
+
+	const auto pi = profiles.find(nameHash);
+
+	if (pi != profiles.end())
+		pi->second.perfCurrent += delta;
+}
+
+
+void CTimeProfiler::ResetFrameTimes()
+{
+	std::lock_guard<spring::spinlock> lock(frameTimesMutex);
+
+	// keep the keys, the same timers run every frame
+	for (auto& p: frameTimes) {
+		p.second = spring_notime;
+	}
+}
+
+void CTimeProfiler::GetFrameTimes(std::vector< std::pair<std::string, float> >& times) const
+{
+	times.clear();
+
+	{
+		std::lock_guard<spring::spinlock> frameLock(frameTimesMutex);
+		std::lock_guard<spring::spinlock> nameLock(hashToNameMutex);
+
+		for (const auto& p: frameTimes) {
+			if (!p.second.isDuration())
+				continue;
+
+			const auto iter = hashToName.find(p.first);
+
+			if (iter == hashToName.end())
+				continue;
+
+			times.emplace_back(iter->second, p.second.toMilliSecsf());
+		}
+	}
+
+	std::sort(times.begin(), times.end());
+}
+
+
 void CTimeProfiler::PrintProfilingInfo() const
 {
 	if (sortedProfiles.empty())
@@ -409,5 +553,214 @@ void CTimeProfiler::PrintProfilingInfo() const
 
 		LOG("%35s %16.2fms %5.2f%%", name.c_str(), tr.total.toMilliSecsf(), tr.stats.y * 100);
 	}
+
+	for (const auto& counter: counters) {
+		LOG("%35s %18lu", counter.first.c_str(), static_cast<unsigned long>(counter.second));
+	}
+}
+
+
+void CTimeProfiler::SetCounter(const char* name, std::uint64_t value)
+{
+	std::lock_guard<spring::spinlock> lock(profileMutex);
+
+	const auto pred = [&](const std::pair<std::string, std::uint64_t>& p) { return (p.first == name); };
+	const auto iter = std::find_if(counters.begin(), counters.end(), pred);
+
+	if (iter == counters.end()) {
+		counters.emplace_back(name, value);
+		return;
+	}
+
+	iter->second = value;
 }
 
+std::uint64_t CTimeProfiler::GetCounter(const char* name) const
+{
+	const auto pred = [&](const std::pair<std::string, std::uint64_t>& p) { return (p.first == name); };
+	const auto iter = std::find_if(counters.begin(), counters.end(), pred);
+
+	if (iter == counters.end())
+		return 0;
+
+	return iter->second;
+}
+
+
+
+
+void CTimeProfiler::StartCapture(unsigned int numFrames, const std::string& fileName)
+{
+	StopCapture();
+
+	if (numFrames == 0)
+		return;
+
+	{
+		std::lock_guard<spring::spinlock> lock(traceEventMutex);
+
+		traceEvents.clear();
+		traceEvents.resize(MAX_TRACE_EVENTS);
+		traceCounterEvents.clear();
+
+		captureFileName = fileName;
+		captureFrames = numFrames;
+
+		traceEventHead = 0;
+		traceEventCount = 0;
+	}
+
+	capturing = true;
+
+	LOG("[%s] capturing %u frames to \"%s\"", __func__, numFrames, fileName.c_str());
+}
+
+void CTimeProfiler::StopCapture()
+{
+	if (!capturing.exchange(false))
+		return;
+
+	WriteCapture();
+}
+
+void CTimeProfiler::NewFrame()
+{
+	if (!capturing)
+		return;
+	if ((captureFrames -= 1) > 0)
+		return;
+
+	StopCapture();
+}
+
+
+void CTimeProfiler::AddTraceEvent(unsigned nameHash, const spring_time startTime, const spring_time deltaTime)
+{
+	static std::atomic<unsigned int> numTraceThreads = {0};
+	static thread_local unsigned int traceThreadIdx = -1u;
+
+	std::lock_guard<spring::spinlock> lock(traceEventMutex);
+
+	if (traceThreadIdx == -1u) {
+		traceThreadIdx = numTraceThreads++;
+
+		std::string threadName = "thread " + std::to_string(traceThreadIdx);
+
+		if (Threading::IsMainThread())
+			threadName = "main";
+		else if (Threading::IsGameLoadThread())
+			threadName = "load";
+		#ifdef THREADPOOL
+		else if (ThreadPool::GetThreadNum() > 0)
+			threadName = "worker " + std::to_string(ThreadPool::GetThreadNum());
+		#endif
+
+		traceThreadNames.resize(std::max(traceThreadNames.size(), size_t(traceThreadIdx + 1)));
+		traceThreadNames[traceThreadIdx] = std::move(threadName);
+	}
+
+	// capture may have ended between the caller's check and here
+	if (traceEvents.empty())
+		return;
+
+	traceEvents[traceEventHead] = {nameHash, traceThreadIdx, startTime, startTime + deltaTime};
+	traceEventHead = (traceEventHead + 1) % traceEvents.size();
+	traceEventCount = std::min(traceEventCount + 1, traceEvents.size());
+}
+
+void CTimeProfiler::WriteCapture()
+{
+	std::vector<TraceEvent> events;
+	std::vector<TraceCounterEvent> counterEvents;
+	std::vector<std::string> threadNames;
+
+	size_t head = 0;
+	size_t count = 0;
+
+	{
+		std::lock_guard<spring::spinlock> lock(traceEventMutex);
+
+		events.swap(traceEvents);
+		counterEvents.swap(traceCounterEvents);
+		threadNames = traceThreadNames;
+
+		head = traceEventHead;
+		count = traceEventCount;
+	}
+
+	std::ofstream file(captureFileName, std::ios::out | std::ios::trunc);
+
+	if (!file.is_open()) {
+		LOG_L(L_ERROR, "[%s] could not open \"%s\" for writing", __func__, captureFileName.c_str());
+		return;
+	}
+
+	const auto WriteName = [&](const std::string& name) {
+		file << '"';
+
+		for (const char c: name) {
+			if (c == '"' || c == '\\')
+				file << '\\';
+
+			file << c;
+		}
+
+		file << '"';
+	};
+
+	const size_t first = (head + events.size() - count) % std::max(events.size(), size_t(1));
+
+	// events are stored when they end, an outer timer can start before the oldest one
+	spring_time baseTime = (count > 0)? events[first].startTime: spring_notime;
+
+	for (size_t i = 0; i < count; i++) {
+		baseTime = std::min(baseTime, events[(first + i) % events.size()].startTime);
+	}
+
+	file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+	file << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"spring\"}}";
+
+	for (size_t i = 0; i < threadNames.size(); i++) {
+		file << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << i << ",\"args\":{\"name\":";
+		WriteName(threadNames[i]);
+		file << "}}";
+	}
+
+	{
+		std::lock_guard<spring::spinlock> lock(hashToNameMutex);
+
+		for (size_t i = 0; i < count; i++) {
+			const TraceEvent& e = events[(first + i) % events.size()];
+			const auto iter = hashToName.find(e.nameHash);
+
+			file << ",\n{\"name\":";
+			WriteName((iter != hashToName.end())? iter->second: "???");
+			file << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << e.threadIdx;
+			file << ",\"ts\":" << (e.startTime - baseTime).toMicroSecs<double>();
+			file << ",\"dur\":" << (e.endTime - e.startTime).toMicroSecs<double>() << "}";
+		}
+
+		// hardware counters of one timer scope each, shown as counter tracks
+		for (const TraceCounterEvent& e: counterEvents) {
+			const auto iter = hashToName.find(e.nameHash);
+			const auto& v = e.values.v;
+
+			file << ",\n{\"name\":";
+			WriteName(((iter != hashToName.end())? iter->second: "???") + " (hw)");
+			file << ",\"ph\":\"C\",\"pid\":1,\"tid\":0";
+			file << ",\"ts\":" << (e.time - baseTime).toMicroSecs<double>();
+			file << ",\"args\":{\"ipc\":" << ((v[PerfCounters::COUNTER_CYCLES] > 0)? (v[PerfCounters::COUNTER_INSTRUCTIONS] * 1.0 / v[PerfCounters::COUNTER_CYCLES]): 0.0);
+			file << ",\"cacheMisses\":" << v[PerfCounters::COUNTER_CACHE_MISSES];
+			file << ",\"branchMisses\":" << v[PerfCounters::COUNTER_BRANCH_MISSES] << "}}";
+		}
+	}
+
+	file << "\n]}\n";
+
+	if (!file.good()) {
+		LOG_L(L_ERROR, "[%s] error writing \"%s\"", __func__, captureFileName.c_str());
+		return;
+	}
+
+	LOG("[%s] %u trace events written to \"%s\"", __func__, unsigned(count), captureFileName.c_str());
+}
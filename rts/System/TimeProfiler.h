@@ -4,6 +4,7 @@
 #define TIME_PROFILER_H
 
 #include <atomic>
+#include <cstdint>
 #include <cstring> // memset
 #include <string>
 #include <deque>
@@ -14,6 +15,7 @@
 #include "System/float3.h"
 #include "System/StringHash.h"
 #include "System/UnorderedMap.hpp"
+#include "System/Platform/PerfCounters.h"
 
 // disable these for minimal profiling; all special
 // timers contribute even when profiler is disabled
@@ -56,6 +58,10 @@ public:
 private:
 	const bool autoShowGraph;
 	const bool specialTimer;
+
+	// hardware counters at construction, if this timer is sampled
+	bool perfSampled = false;
+	PerfCounters::Values perfStart;
 };
 
 
@@ -119,9 +125,15 @@ public:
 		float3 stats;
 		float3 color;
 
+		// hardware counters summed since the last percentage update, and
+		// .x := instructions per cycle, .y := cache-misses per frame, .z := branch-misses per frame
+		PerfCounters::Values perfCurrent;
+		float3 perfStats;
+
 		bool newPeak = false;
 		bool newLagPeak = false;
 		bool showGraph = false;
+		bool hasPerfStats = false;
 	};
 
 public:
@@ -165,8 +177,46 @@ public:
 	void RefreshProfilesRaw();
 
 	void SetEnabled(bool b) { enabled = b; }
+	bool IsEnabled() const { return enabled; }
 	void PrintProfilingInfo() const;
 
+	// plain named counters (e.g. cache statistics) shown next to the timers
+	void SetCounter(const char* name, std::uint64_t value);
+	std::uint64_t GetCounter(const char* name) const;
+	const std::vector< std::pair<std::string, std::uint64_t> >& GetCounters() const { return counters; }
+
+	// records every timer (enabled or not) as a trace event for the next
+	// <numFrames> frames, then writes them as Chrome Trace Event JSON that
+	// chrome://tracing and ui.perfetto.dev can open
+	void StartCapture(unsigned int numFrames, const std::string& fileName);
+	void StopCapture();
+	bool IsCapturing() const { return capturing; }
+	/// called once per rendered frame; ends a capture after its last frame
+	void NewFrame();
+
+	// while frame recording is on every timer (enabled or not) also adds
+	// to a per-name sum that ResetFrameTimes clears, used to break down a
+	// single slow sim-frame
+	void SetFrameRecording(bool b) { frameRecording = b; }
+	bool IsFrameRecording() const { return frameRecording; }
+	void ResetFrameTimes();
+	/// fills <times> with {name, milliseconds} pairs sorted by name
+	void GetFrameTimes(std::vector< std::pair<std::string, float> >& times) const;
+
+	// samples hardware counters (see PerfCounters) around the named timers
+	// when they run on the main thread; an empty list turns sampling off
+	// @return false if the counters are not available
+	bool SetPerfCounterTimers(const std::vector<std::string>& names);
+	bool IsPerfCounterTimer(unsigned nameHash) const {
+		for (unsigned int i = 0, n = numPerfCounterTimers; i < n; i++) {
+			if (perfCounterTimers[i] == nameHash)
+				return true;
+		}
+
+		return false;
+	}
+	void AddPerfCounters(unsigned nameHash, const spring_time endTime, const PerfCounters::Values& delta);
+
 	void AddTime(
 		unsigned nameHash,
 		const spring_time startTime,
@@ -183,20 +233,63 @@ public:
 		const bool threadTimer
 	);
 
+private:
+	void AddTraceEvent(unsigned nameHash, const spring_time startTime, const spring_time deltaTime);
+	void WriteCapture();
+
+	struct TraceEvent {
+		unsigned int nameHash;
+		unsigned int threadIdx;
+
+		spring_time startTime;
+		spring_time endTime;
+	};
+
+	struct TraceCounterEvent {
+		unsigned int nameHash;
+
+		spring_time time;
+		PerfCounters::Values values;
+	};
+
 private:
 	spring::unordered_map<unsigned, TimeRecord> profiles;
 
 	std::vector< std::pair<std::string, TimeRecord> > sortedProfiles;
 	std::vector< std::deque< std::pair<spring_time, spring_time> > > threadProfiles;
+	std::vector< std::pair<std::string, std::uint64_t> > counters;
 
 	spring_time lastBigUpdate;
 
 	/// increases each update, from 0 to (numFrames-1)
 	unsigned currentPosition;
 	unsigned resortProfiles;
+	/// updates since the last percentage update
+	unsigned numUpdateFrames = 0;
 
 	// if false, AddTime is a no-op for (almost) all timers
 	std::atomic<bool> enabled;
+
+	// ring-buffer; once full the oldest events are overwritten
+	std::vector<TraceEvent> traceEvents;
+	std::vector<TraceCounterEvent> traceCounterEvents;
+	std::string captureFileName;
+
+	size_t traceEventHead = 0;
+	size_t traceEventCount = 0;
+
+	unsigned int captureFrames = 0;
+
+	std::atomic<bool> capturing = {false};
+
+	spring::unordered_map<unsigned, spring_time> frameTimes;
+
+	std::atomic<bool> frameRecording = {false};
+
+	static constexpr unsigned int MAX_PERF_COUNTER_TIMERS = 8;
+
+	unsigned int perfCounterTimers[MAX_PERF_COUNTER_TIMERS];
+	std::atomic<unsigned int> numPerfCounterTimers = {0};
 };
 
 
@@ -43,6 +43,21 @@
 #endif
 
 
+#include <functional>
+
+#include "SpringSwissMap.hpp"
+#include "SpringHash.h"
+
+// same interface as the emilib maps, faster lookups in larger or hotter
+// tables (see test/engine/System/benchHashMap.cpp before switching one)
+namespace spring {
+	template<typename K, typename V, typename H = spring::synced_hash<K>, typename C = std::equal_to<K>>
+	using swiss_map = spring::SwissMap<K, V, H, C>;
+	template<typename K, typename V, typename H = std::hash<K>, typename C = std::equal_to<K>>
+	using unsynced_swiss_map = spring::SwissMap<K, V, H, C>;
+};
+
+
 namespace spring {
 	// Synced unordered maps must be reconstructed (on reload)
 	// since clear() may keep the container resized which will
@@ -26,6 +26,7 @@ namespace creg {
 		~StaticArrayBaseType() { }
 
 		std::string GetName() const override;
+		bool IsPlainData() const override { return elemType->IsPlainData(); }
 	};
 
 	class DynamicArrayBaseType : public IType
@@ -67,6 +68,7 @@ namespace creg {
 
 		void Serialize(ISerializer* s, void* instance) override;
 		std::string GetName() const override;
+		bool IsPlainData() const override { return (id == crInt || id == crFloat); }
 
 		BasicTypeID id;
 	};
@@ -99,6 +99,18 @@ namespace creg
 			return std::unique_ptr<IType>(new MapType<spring::unsynced_map<TKey, TValue> >());
 		}
 	};
+	template<typename TKey, typename TValue>
+	struct DeduceType<spring::swiss_map<TKey, TValue> > {
+		static std::unique_ptr<IType> Get() {
+			return std::unique_ptr<IType>(new MapType<spring::swiss_map<TKey, TValue> >());
+		}
+	};
+	template<typename TKey, typename TValue>
+	struct DeduceType<spring::unsynced_swiss_map<TKey, TValue> > {
+		static std::unique_ptr<IType> Get() {
+			return std::unique_ptr<IType>(new MapType<spring::unsynced_swiss_map<TKey, TValue> >());
+		}
+	};
 
 	template<typename T>
 	struct PairType : public IType
@@ -129,8 +129,12 @@ bool COutputStreamSerializer::IsWriting()
 
 COutputStreamSerializer::ObjectRef* COutputStreamSerializer::FindObjectRef(void* inst, creg::Class* objClass, bool isEmbedded)
 {
-	std::vector<ObjectRef*>& refs = ptrToId[inst];
-	for (auto& obj: refs) {
+	const auto iter = ptrToId.find(inst);
+
+	if (iter == ptrToId.end())
+		return nullptr;
+
+	for (ObjectRef* obj: iter->second) {
 		if (obj->isThisObject(inst, objClass, isEmbedded))
 			return obj;
 	}
@@ -148,19 +152,24 @@ void COutputStreamSerializer::SerializeObject(Class* c, void* ptr, ObjectRef* ob
 	omg.membersClass = c;
 	omg.size = 0;
 
-	for (uint a = 0; a < c->members.size(); a++)
+	for (const creg::Class::LayoutStep& step: c->GetLayout())
 	{
-		creg::Class::Member* m = &c->members[a];
-		if (m->flags & CM_NoSerialize)
-			continue;
+		creg::Class::Member* m = step.member;
 
 		ObjectMember om;
 		om.member = m;
-		om.memberId = a;
-		void* memberAddr = ((char*)ptr) + m->offset;
+		om.memberId = m - &c->members[0];
+		void* memberAddr = ((char*)ptr) + step.offset;
 		unsigned mstart = stream->tellp();
-		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m->name, m->type->GetName().c_str());
-		m->type->Serialize(this, memberAddr);
+
+		if (step.size != 0) {
+			// run of plain members
+			stream->write((const char*)memberAddr, step.size);
+		} else {
+			LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s::%s type:%s", c->name, m->name, m->type->GetName().c_str());
+			m->type->Serialize(this, memberAddr);
+		}
+
 		unsigned mend = stream->tellp();
 		om.size = mend - mstart;
 		omg.members.push_back(om);
@@ -199,13 +208,11 @@ void COutputStreamSerializer::SerializeObjectInstance(void* inst, creg::Class* o
 		ptrToId[inst].push_back(obj);
 	} else if (obj->isEmbedded) {
 		throw std::string("Reserialization of embedded object (") + objClass->name + ")";
+	} else if (!obj->isPending) {
+		throw std::string("Object pointer was serialized (") + objClass->name + ")";
 	} else {
-		std::vector<ObjectRef*>::iterator it = std::find(pendingObjects.begin(), pendingObjects.end(), obj);
-		if (it == pendingObjects.end()) {
-			throw std::string("Object pointer was serialized (") + objClass->name + ")";
-		} else {
-			pendingObjects.erase(it);
-		}
+		// written here instead, SavePackage skips it
+		obj->isPending = false;
 	}
 	obj->class_ = objClass;
 	obj->isEmbedded = true;
@@ -228,6 +235,7 @@ void COutputStreamSerializer::SerializeObjectPtr(void** ptr, creg::Class* objCla
 			obj = &objects.back();
 			ptrToId[*ptr].push_back(obj);
 			pendingObjects.push_back(obj);
+			obj->isPending = true;
 		}
 		id = obj->id;
 
@@ -288,14 +296,22 @@ void COutputStreamSerializer::SavePackage(std::ostream* s, void* rootObj, Class*
 	obj = &objects.back();
 	ptrToId[rootObj].push_back(obj);
 	pendingObjects.push_back(obj);
+	obj->isPending = true;
 
 	// Save until all the referenced objects have been stored
+	std::vector<ObjectRef*> po;
+
 	while (!pendingObjects.empty())
 	{
-		const std::vector<ObjectRef*> po = pendingObjects;
-		pendingObjects.clear();
+		po.clear();
+		po.swap(pendingObjects);
 
 		for (ObjectRef* obj: po) {
+			// already written as an embedded instance
+			if (!obj->isPending)
+				continue;
+
+			obj->isPending = false;
 			SerializeObject(obj->class_, obj->ptr, obj);
 			//LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Serialized %s size:%i", obj->class_->name.c_str(), sz);
 		}
@@ -409,14 +425,18 @@ void CInputStreamSerializer::SerializeObject(Class* c, void* ptr)
 	if (c->base())
 		SerializeObject(c->base(), ptr);
 
-	for (uint a = 0; a < c->members.size(); a++)
+	for (const creg::Class::LayoutStep& step: c->GetLayout())
 	{
-		creg::Class::Member* m = &c->members[a];
-		if (m->flags & CM_NoSerialize)
+		creg::Class::Member* m = step.member;
+		void* memberAddr = ((char*)ptr) + step.offset;
+
+		if (step.size != 0) {
+			// run of plain members
+			stream->read((char*)memberAddr, step.size);
 			continue;
+		}
 
 		const unsigned oldPos = stream->tellg();
-		void* memberAddr = ((char*)ptr) + m->offset;
 		m->type->Serialize(this, memberAddr);
 		LOG_SL(LOG_SECTION_CREG_SERIALIZER, L_DEBUG, "Deserialized %s::%s type:%s size:%u", c->name, m->name, m->type->GetName().c_str(), unsigned(stream->tellg()) - oldPos);
 	}
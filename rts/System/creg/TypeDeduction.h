@@ -62,12 +62,18 @@ struct DeduceType<SyncedPrimitive<T>, typename std::enable_if<std::is_floating_p
 #endif
 
 // helper
+// instantiated with the pointer type, so every pointed-to class is known before the first save
+template<typename T>
+struct PointerTarget {
+	static inline const bool marked = System::AddPointerTarget(T::StaticClass());
+};
+
 template<typename T>
 class ObjectPointerType : public ObjectPointerBaseType
 {
 	static_assert(std::is_same<typename std::remove_const<T>::type, typename std::remove_const<typename T::MyType>::type>::value, "class isn't creged");
 public:
-	ObjectPointerType() : ObjectPointerBaseType(T::StaticClass(), sizeof(T*)) { }
+	ObjectPointerType() : ObjectPointerBaseType(T::StaticClass(), sizeof(T*)) { (void) PointerTarget<T>::marked; }
 	void Serialize(ISerializer *s, void *instance) override {
 		void **ptr = (void**)instance;
 		if (s->IsWriting()) {
@@ -104,8 +110,13 @@ public:
 	{
 		T* array = (T*) instance;
 
+		if (elemType->IsPlainData()) {
+			s->Serialize(array, N * sizeof(T));
+			return;
+		}
+
 		for (int a = 0; a < N; a++) {
-			DeduceType<T>::Get()->Serialize(s, &array[a]);
+			elemType->Serialize(s, &array[a]);
 		}
 	}
 };
@@ -132,8 +143,13 @@ public:
 	{
 		ArrayT& array = *(ArrayT*) instance;
 
+		if (elemType->IsPlainData()) {
+			s->Serialize(array.data(), array.size() * sizeof(ElemT));
+			return;
+		}
+
 		for (size_t a = 0; a < array.size(); a++) {
-			DeduceType<ElemT>::Get()->Serialize(s, &array[a]);
+			elemType->Serialize(s, &array[a]);
 		}
 	}
 };
@@ -159,23 +175,23 @@ public:
 	void Serialize(ISerializer* s, void* inst) override {
 		VectorT& ct = *(VectorT*) inst;
 
-		if (s->IsWriting()) {
-			int size = (int) ct.size();
-			s->SerializeInt(&size, sizeof(int));
-
-			for (int a = 0; a < size; a++) {
-				DeduceType<ElemT>::Get()->Serialize(s, &ct[a]);
-			}
-		} else {
-			int size;
-			s->SerializeInt(&size, sizeof(int));
+		int size = (int) ct.size();
+		s->SerializeInt(&size, sizeof(int));
 
+		if (!s->IsWriting()) {
 			ct.clear();
 			ct.resize(size);
+		}
 
-			for (int a = 0; a < size; a++) {
-				DeduceType<ElemT>::Get()->Serialize(s, &ct[a]);
-			}
+		if (elemType->IsPlainData()) {
+			if (size > 0)
+				s->Serialize(&ct[0], size * sizeof(ElemT));
+
+			return;
+		}
+
+		for (int a = 0; a < size; a++) {
+			elemType->Serialize(s, &ct[a]);
 		}
 	}
 };
@@ -57,6 +57,11 @@ std::unique_ptr<IType> IType::CreateStringType()
 
 void ObjectInstanceType::Serialize(ISerializer* s, void* inst)
 {
+	if (objectClass->IsPlainData()) {
+		s->Serialize(inst, objectClass->size);
+		return;
+	}
+
 	s->SerializeObjectInstance(inst, objectClass);
 }
 
@@ -19,6 +19,7 @@ namespace creg
 		~ObjectInstanceType() {}
 		void Serialize(ISerializer* s, void* instance) override;
 		std::string GetName() const override;
+		bool IsPlainData() const override { return objectClass->IsPlainData(); }
 
 		Class* objectClass;
 	};
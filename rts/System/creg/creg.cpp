@@ -11,6 +11,7 @@
 
 #include "creg_cond.h"
 #include "System/UnorderedMap.hpp"
+#include "System/UnorderedSet.hpp"
 #include "System/StringUtil.h"
 #include "System/Sync/HsiehHash.h"
 
@@ -41,6 +42,12 @@ static spring::unsynced_map<std::string, Class*>& mapNameToClass()
 	return m;
 }
 
+static spring::unsynced_set<const Class*>& pointerTargets()
+{
+	static spring::unsynced_set<const Class*> s;
+	return s;
+}
+
 static std::vector<Class*>& classes()
 {
 	static std::vector<Class*> v;
@@ -172,6 +179,49 @@ Class::Member* Class::FindMember(const char* name, const bool inherited)
 	return nullptr;
 }
 
+const std::vector<Class::LayoutStep>& Class::GetLayout()
+{
+	// not done in AddMember, classes of embedded members might not be registered yet
+	if (layoutBuilt)
+		return layout;
+
+	for (Member& m: members) {
+		if (m.flags & CM_NoSerialize)
+			continue;
+
+		if (!m.type->IsPlainData()) {
+			layout.push_back({m.offset, 0, &m});
+			continue;
+		}
+
+		if (!layout.empty() && layout.back().size != 0 && (layout.back().offset + layout.back().size) == m.offset) {
+			layout.back().size += m.type->GetSize();
+			continue;
+		}
+
+		layout.push_back({m.offset, unsigned(m.type->GetSize()), &m});
+	}
+
+	layoutBuilt = true;
+	return layout;
+}
+
+bool Class::IsPlainData()
+{
+	if (plainData >= 0)
+		return (plainData != 0);
+
+	// pointers to embedded instances are resolved through their object-id, which a plain block does not have
+	plainData = !hasVTable && (baseClass == nullptr) && !HasSerialize() && !HasPostLoad() && !System::IsPointerTarget(this);
+
+	if (plainData != 0) {
+		const std::vector<LayoutStep>& steps = GetLayout();
+		plainData = (steps.size() == 1 && steps[0].offset == 0 && steps[0].size == unsigned(size));
+	}
+
+	return (plainData != 0);
+}
+
 void Class::SetMemberFlag(const char* name, ClassMemberFlag f)
 {
 	for (Member& m: members) {
@@ -216,6 +266,7 @@ void Class::CalculateChecksum(unsigned int& checksum)
 		checksum = HsiehHash(m.name, strlen(m.name), checksum);
 		checksum = HsiehHash(m.type->GetName().data(), m.type->GetName().size(), checksum);
 		checksum += m.type->GetSize();
+		checksum += m.type->IsPlainData();
 	}
 	if (base())
 		base()->CalculateChecksum(checksum);
@@ -246,6 +297,17 @@ void System::AddClass(Class* c)
 	mapNameToClass()[c->name] = c;
 }
 
+bool System::AddPointerTarget(const Class* c)
+{
+	pointerTargets().insert(c);
+	return true;
+}
+
+bool System::IsPointerTarget(const Class* c)
+{
+	return (pointerTargets().find(c) != pointerTargets().end());
+}
+
 
 // ------------------------------------------------------------------
 // creg::Class: Class description
@@ -53,6 +53,8 @@ namespace creg {
 
 		virtual void Serialize(ISerializer* s, void* instance) = 0;
 		virtual std::string GetName() const = 0;
+		/// true if the GetSize() bytes of an instance are its serialized form (copied as one block)
+		virtual bool IsPlainData() const { return false; }
 		size_t GetSize() const { return size; };
 		size_t size;
 		std::string name;
@@ -82,6 +84,14 @@ namespace creg {
 			int flags; // combination of ClassMemberFlag's
 		};
 
+		/// consecutive plain-data members are merged into one block
+		struct LayoutStep
+		{
+			unsigned int offset;
+			unsigned int size; // bytes of the block, 0 if <member> is serialized through its type
+			Member* member; // first member of the step
+		};
+
 
 		Class(const char* className, ClassFlags cf, Class* base,
 				void (*memberRegistrator)(creg::Class*),
@@ -106,6 +116,11 @@ namespace creg {
 		void SetMemberFlag(const char* name, ClassMemberFlag f);
 		Member* FindMember(const char* name, const bool inherited = true);
 
+		/// serialization steps for the members of this class (not its bases), built on first use
+		const std::vector<LayoutStep>& GetLayout();
+		/// true if embedded instances can be copied as one block of <size> bytes
+		bool IsPlainData();
+
 		void SetFlag(ClassFlags flag);
 
 		inline bool IsAbstract() const { return (flags & CF_Abstract) != 0; }
@@ -141,6 +156,7 @@ namespace creg {
 		bool isCregStruct;
 
 		std::vector<Member> members;
+		std::vector<LayoutStep> layout;
 		const char* name;
 		int size; // size of an instance in bytes
 		int alignment;
@@ -168,6 +184,10 @@ namespace creg {
 		SerializeProc serializeProc;
 		PostLoadProc postLoadProc;
 		GetSizeProc getSizeProc;
+
+	private:
+		bool layoutBuilt = false;
+		int plainData = -1;
 	};
 
 
@@ -184,6 +204,10 @@ namespace creg {
 		static Class* GetClass(const std::string& name);
 
 		static void AddClass(Class* c);
+
+		/// classes some pointer type refers to; their embedded instances keep an object-id
+		static bool AddPointerTarget(const Class* c);
+		static bool IsPointerTarget(const Class* c);
 	};
 }
 
@@ -53,6 +53,7 @@ GLAPI void APIENTRY glBindVertexArray(GLuint id) {}
 GLAPI void APIENTRY glEnableVertexAttribArray(GLuint index) {}
 GLAPI void APIENTRY glDisableVertexAttribArray(GLuint index) {}
 GLAPI void APIENTRY glVertexAttribPointer(GLuint index, GLint size, GLenum type, GLboolean normalized, GLsizei stride, const void* pointer) {}
+GLAPI void APIENTRY glVertexAttribDivisor(GLuint index, GLuint divisor) {}
 GLAPI void APIENTRY glVertexAttribIPointer(GLuint index, GLint size, GLenum type, GLsizei stride, const void* pointer) {}
 
 GLAPI void APIENTRY glGenFramebuffers(GLsizei n, GLuint *framebuffers) {}
@@ -68,6 +69,8 @@ GLAPI GLuint APIENTRY glCreateProgram() { return 0; }
 //glCreateProgram = (PFNGLCREATEPROGRAMPROC) NULL;
 GLAPI void APIENTRY glDeleteProgram(GLuint program) {}
 GLAPI void APIENTRY glProgramParameteri(GLuint program, GLenum pname, GLint value) {}
+GLAPI void APIENTRY glProgramBinary(GLuint program, GLenum binaryFormat, const void* binary, GLsizei length) {}
+GLAPI void APIENTRY glGetProgramBinary(GLuint program, GLsizei bufSize, GLsizei* length, GLenum* binaryFormat, void* binary) {}
 GLAPI void APIENTRY glLinkProgram(GLuint program) {}
 GLAPI void APIENTRY glGetProgramiv(GLuint program, GLenum pname, GLint *params) {}
 GLAPI void APIENTRY glGetProgramInfoLog(GLuint program, GLsizei bufSize, GLsizei *length, GLchar *infoLog) {}
@@ -88,6 +91,11 @@ GLAPI void APIENTRY glDeleteQueries(GLsizei n, const GLuint *ids) {}
 GLAPI void APIENTRY glBeginQuery(GLenum target, GLuint id) {}
 GLAPI void APIENTRY glEndQuery(GLenum target) {}
 
+GLAPI void APIENTRY glBindBufferBase(GLenum target, GLuint index, GLuint buffer) {}
+GLAPI void APIENTRY glTransformFeedbackVaryings(GLuint program, GLsizei count, const GLchar* const* varyings, GLenum bufferMode) {}
+GLAPI void APIENTRY glBeginTransformFeedback(GLenum primitiveMode) {}
+GLAPI void APIENTRY glEndTransformFeedback(void) {}
+
 GLAPI void APIENTRY glQueryCounter(GLuint id, GLenum target) {}
 GLAPI void APIENTRY glGetQueryObjectiv(GLuint id, GLenum pname, GLint* params) {}
 GLAPI void APIENTRY glGetQueryObjectuiv(GLuint id, GLenum pname, GLuint* params) {}
@@ -325,6 +333,7 @@ GLAPI void APIENTRY glCopyTexSubImage2D(GLenum target, GLint level,
 GLAPI void APIENTRY glDrawBuffer(GLenum mode) {}
 GLAPI void APIENTRY glDrawElements(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices) {}
 GLAPI void APIENTRY glDrawElementsInstanced(GLenum mode, GLsizei count, GLenum type, const GLvoid *indices, GLsizei primcount) {}
+GLAPI void APIENTRY glTexBuffer(GLenum target, GLenum internalformat, GLuint buffer) {}
 GLAPI void APIENTRY glEdgeFlag(GLboolean flag) {}
 GLAPI void APIENTRY glEvalCoord1f(GLfloat u) {}
 GLAPI void APIENTRY glEvalCoord2f(GLfloat u, GLfloat v) {}
@@ -428,6 +437,7 @@ GLAPI void APIENTRY glColorPointer(GLint size, GLenum type, GLsizei stride, cons
 GLAPI void APIENTRY glNormalPointer(GLenum type, GLsizei stride, const GLvoid *ptr) {}
 GLAPI void APIENTRY glDrawArrays(GLenum mode, GLint first, GLsizei count) {}
 GLAPI void APIENTRY glDrawArraysInstanced(GLenum mode, GLint first, GLsizei count, GLsizei primcount) {}
+GLAPI void APIENTRY glMultiDrawArrays(GLenum mode, const GLint *first, const GLsizei *count, GLsizei drawcount) {}
 
 GLAPI void APIENTRY glTexEnvi(GLenum target, GLenum pname, GLint param) {}
 
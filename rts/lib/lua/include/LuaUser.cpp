@@ -11,6 +11,7 @@
 #include "Lua/LuaMemPool.h"
 
 #include "System/GlobalRNG.h"
+#include "System/MemoryStats.h"
 #include "System/SpringMath.h"
 
 #if (ENABLE_USERSTATE_LOCKS != 0)
@@ -237,9 +238,11 @@ static constexpr uint64_t MAX_ALLOC_BYTES[] = {
 };
 
 // tracks allocations across all states
-static SLuaAllocState gLuaAllocState = {{0}, {0}, {0}, {0}};
+static SLuaAllocState gLuaAllocState = {{0}, {0}, {0}, {0}, {0}};
 static SLuaAllocError gLuaAllocError = {};
 
+static MemoryStats::Registrar luaStateStats("Lua::States", []() { return MemoryStats::Usage{gLuaAllocState.allocedBytes.load(), 0}; });
+
 void spring_lua_alloc_log_error(const luaContextData* lcd)
 {
 	const CLuaHandle* lho = lcd->owner;
@@ -267,6 +270,7 @@ void* spring_lua_alloc(void* ud, void* ptr, size_t osize, size_t nsize)
 	gLuaAllocState.allocedBytes += nsize;
 	las->allocedBytes -= osize;
 	las->allocedBytes += nsize;
+	las->grownBytes += (nsize > osize)? (nsize - osize): 0;
 
 	if (nsize == 0) {
 		// deallocation; must return NULL
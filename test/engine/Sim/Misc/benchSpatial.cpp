@@ -0,0 +1,185 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "Sim/Misc/GlobalConstants.h"
+#include "Sim/Misc/QuadField.h"
+#include "Sim/Misc/StaticObjectIndex.h"
+#include "System/float3.h"
+#include "tools/Benchmark/Benchmark.h"
+
+#include <vector>
+
+// 16x16 map
+static constexpr int MAP_SQUARES = 1024;
+static constexpr float MAP_SIZE = MAP_SQUARES * SQUARE_SIZE;
+
+static constexpr int NUM_QUERIES = 4096;
+static constexpr int NUM_STRUCTURES = 4000;
+
+
+static std::vector<float3> RandomPositions(bench::Random& rng, int count)
+{
+	std::vector<float3> v;
+	v.reserve(count);
+
+	for (int i = 0; i < count; i++) {
+		v.emplace_back(rng.NextFloat(0.0f, MAP_SIZE), 0.0f, rng.NextFloat(0.0f, MAP_SIZE));
+	}
+
+	return v;
+}
+
+
+static void BenchQuadField(bench::Suite& suite)
+{
+	bench::Random rng(0x5eed);
+
+	quadField.Init(int2(MAP_SQUARES, MAP_SQUARES), CQuadField::BASE_QUAD_SIZE);
+
+	const std::vector<float3> positions = RandomPositions(rng, NUM_QUERIES);
+	std::vector<float3> dirs;
+
+	for (int i = 0; i < NUM_QUERIES; i++) {
+		dirs.push_back(float3(rng.NextFloat(-1.0f, 1.0f), 0.0f, rng.NextFloat(-1.0f, 1.0f)).SafeNormalize());
+	}
+
+	const auto QueryRadius = [&](float radius) {
+		return [&, radius]() {
+			std::uint64_t sum = 0;
+
+			for (const float3& pos: positions) {
+				QuadFieldQuery qfq;
+				quadField.GetQuads(qfq, pos, radius);
+				sum += qfq.quads->size();
+			}
+
+			return sum;
+		};
+	};
+
+	suite.Run("QuadField/GetQuads/r64", NUM_QUERIES, QueryRadius(64.0f));
+	suite.Run("QuadField/GetQuads/r512", NUM_QUERIES, QueryRadius(512.0f));
+
+	suite.Run("QuadField/GetQuadsMT/r512", NUM_QUERIES, [&]() {
+		std::vector<int> quads;
+		std::uint64_t sum = 0;
+
+		for (const float3& pos: positions) {
+			quadField.GetQuadsMT(quads, pos, 512.0f);
+			sum += quads.size();
+		}
+
+		return sum;
+	});
+
+	suite.Run("QuadField/GetQuadsRectangle/1024", NUM_QUERIES, [&]() {
+		std::uint64_t sum = 0;
+
+		for (const float3& pos: positions) {
+			QuadFieldQuery qfq;
+			quadField.GetQuadsRectangle(qfq, pos - float3(512.0f, 0.0f, 512.0f), pos + float3(512.0f, 0.0f, 512.0f));
+			sum += qfq.quads->size();
+		}
+
+		return sum;
+	});
+
+	suite.Run("QuadField/GetQuadsOnRay/2048", NUM_QUERIES, [&]() {
+		std::uint64_t sum = 0;
+
+		for (int i = 0; i < NUM_QUERIES; i++) {
+			QuadFieldQuery qfq;
+			quadField.GetQuadsOnRay(qfq, positions[i], dirs[i], 2048.0f);
+			sum += qfq.quads->size();
+		}
+
+		return sum;
+	});
+
+	quadField.Kill();
+}
+
+
+static void BenchStaticObjectIndex(bench::Suite& suite)
+{
+	bench::Random rng(0x5eed);
+
+	// the index never dereferences its objects, any distinct non-null pointers do
+	std::vector<char> objects(NUM_STRUCTURES);
+
+	const auto ObjectPtr = [&](int i) { return reinterpret_cast<CUnit*>(&objects[i]); };
+	const auto ObjectIdx = [&](CUnit* u) { return std::uint64_t(reinterpret_cast<char*>(u) - objects.data()); };
+
+	const std::vector<float3> structurePositions = RandomPositions(rng, NUM_STRUCTURES);
+	const std::vector<float3> queryPositions = RandomPositions(rng, NUM_QUERIES);
+	std::vector<float> radii;
+
+	for (int i = 0; i < NUM_STRUCTURES; i++) {
+		radii.push_back(rng.NextFloat(16.0f, 96.0f));
+	}
+
+	CStaticObjectIndex index;
+
+	const auto Build = [&]() {
+		index.Kill();
+		index.Init({MAP_SIZE, MAP_SIZE});
+
+		for (int i = 0; i < NUM_STRUCTURES; i++) {
+			index.Update(ObjectPtr(i), structurePositions[i], radii[i], i);
+		}
+	};
+
+	suite.Run("StaticObjectIndex/Build", NUM_STRUCTURES, [&]() {
+		Build();
+		return std::uint64_t(index.GetNumObjects());
+	});
+
+	Build();
+
+	suite.Run("StaticObjectIndex/QueryCircle/r512", NUM_QUERIES, [&]() {
+		std::uint64_t sum = 0;
+
+		for (const float3& pos: queryPositions) {
+			index.QueryCircle(pos, 512.0f, false, [&](CUnit* u) { sum += ObjectIdx(u); });
+		}
+
+		return sum;
+	});
+
+	suite.Run("StaticObjectIndex/QueryRectangle/1024", NUM_QUERIES, [&]() {
+		std::uint64_t sum = 0;
+
+		for (const float3& pos: queryPositions) {
+			index.QueryRectangle(pos - float3(512.0f, 0.0f, 512.0f), pos + float3(512.0f, 0.0f, 512.0f), [&](CUnit* u) { sum += ObjectIdx(u); });
+		}
+
+		return sum;
+	});
+
+	// structures being destroyed and rebuilt elsewhere
+	suite.Run("StaticObjectIndex/RemoveInsert", NUM_STRUCTURES, [&]() {
+		Build();
+
+		for (int i = 0; i < NUM_STRUCTURES; i += 2) {
+			index.Remove(i);
+			index.Update(ObjectPtr(i), structurePositions[NUM_STRUCTURES - 1 - i], radii[i], i);
+		}
+
+		return std::uint64_t(index.GetNumObjects());
+	});
+
+	index.Kill();
+}
+
+
+int main(int argc, char** argv)
+{
+	float3::maxxpos = MAP_SIZE - 1.0f;
+	float3::maxzpos = MAP_SIZE - 1.0f;
+
+	bench::Suite suite("Spatial", argc, argv);
+
+	BenchQuadField(suite);
+	BenchStaticObjectIndex(suite);
+
+	return suite.Finish();
+}
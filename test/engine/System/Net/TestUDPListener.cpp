@@ -1,5 +1,6 @@
 
 #include "System/Net/UDPListener.h"
+#include "System/Net/UDPConnection.h"
 #include "System/Log/ILog.h"
 
 
@@ -89,3 +90,33 @@ TEST_CASE("TryBindSocket")
 	t.TestPort(-1, false);
 }
 
+
+
+TEST_CASE("PacketSackBitmap")
+{
+	netcode::Packet out(41, netcode::Packet::SACK_BITMAP);
+	out.naks.resize(netcode::Packet::SACK_BITMAP_SIZE, 0);
+
+	// chunks 43, 50 and 297 received out of order
+	out.SetSackBit(43 - 42);
+	out.SetSackBit(50 - 42);
+	out.SetSackBit(297 - 42);
+	out.checksum = out.GetChecksum();
+
+	std::vector<std::uint8_t> data;
+	out.Serialize(data);
+
+	CHECK(data.size() == (netcode::Packet::headerSize + netcode::Packet::SACK_BITMAP_SIZE));
+
+	const netcode::Packet in(data.data(), data.size());
+
+	CHECK(in.lastContinuous == 41);
+	CHECK(in.nakType == netcode::Packet::SACK_BITMAP);
+	CHECK(in.checksum == in.GetChecksum());
+	CHECK(in.naks.size() == netcode::Packet::SACK_BITMAP_SIZE);
+	CHECK(in.chunks.empty());
+
+	for (unsigned i = 0; i < netcode::Packet::SACK_BITMAP_SIZE * 8; i++) {
+		CHECK(in.GetSackBit(i) == (i == 1 || i == 8 || i == 255));
+	}
+}
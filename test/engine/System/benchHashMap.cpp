@@ -0,0 +1,126 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#include "System/UnorderedMap.hpp"
+#include "tools/Benchmark/Benchmark.h"
+
+#include <string>
+#include <vector>
+
+static constexpr int NUM_KEYS = 1 << 14;
+static constexpr int NUM_LOOKUPS = 1 << 16;
+
+
+// unit-ids as used by CUnitHandler::builderCAIs
+static std::vector<unsigned int> RandomIds(bench::Random& rng, int count)
+{
+	std::vector<unsigned int> v;
+	v.reserve(count);
+
+	for (int i = 0; i < count; i++) {
+		v.push_back(rng.NextInt(1 << 20));
+	}
+
+	return v;
+}
+
+// rules-param names as used by LuaRulesParams::Params
+static std::vector<std::string> RandomNames(bench::Random& rng, int count)
+{
+	std::vector<std::string> v;
+	v.reserve(count);
+
+	for (int i = 0; i < count; i++) {
+		v.push_back("param_" + std::to_string(rng.NextInt(1 << 20)));
+	}
+
+	return v;
+}
+
+
+template<typename Map, typename Key>
+static void BenchMap(bench::Suite& suite, const std::string& prefix, const std::vector<Key>& keys, const std::vector<Key>& misses)
+{
+	bench::Random rng(0x5eed);
+	std::vector<Key> lookups;
+
+	for (int i = 0; i < NUM_LOOKUPS; i++) {
+		lookups.push_back(keys[rng.NextInt(keys.size())]);
+	}
+
+	suite.Run((prefix + "/Insert").c_str(), keys.size(), [&]() {
+		Map map;
+
+		for (size_t i = 0; i < keys.size(); i++) {
+			map[keys[i]] = i;
+		}
+
+		return std::uint64_t(map.size());
+	});
+
+	Map map;
+
+	for (size_t i = 0; i < keys.size(); i++) {
+		map[keys[i]] = i;
+	}
+
+	suite.Run((prefix + "/FindHit").c_str(), lookups.size(), [&]() {
+		std::uint64_t sum = 0;
+
+		for (const Key& k: lookups) {
+			sum += map.find(k)->second;
+		}
+
+		return sum;
+	});
+
+	suite.Run((prefix + "/FindMiss").c_str(), misses.size(), [&]() {
+		std::uint64_t sum = 0;
+
+		for (const Key& k: misses) {
+			sum += (map.find(k) == map.end());
+		}
+
+		return sum;
+	});
+
+	suite.Run((prefix + "/Iterate").c_str(), map.size(), [&]() {
+		std::uint64_t sum = 0;
+
+		for (const auto& p: map) {
+			sum += p.second;
+		}
+
+		return sum;
+	});
+
+	// units dying and being built, half the table is replaced per sample
+	suite.Run((prefix + "/EraseInsert").c_str(), keys.size(), [&]() {
+		for (size_t i = 0; i < keys.size(); i += 2) {
+			map.erase(keys[i]);
+		}
+		for (size_t i = 0; i < keys.size(); i += 2) {
+			map[keys[i]] = i;
+		}
+
+		return std::uint64_t(map.size());
+	});
+}
+
+
+int main(int argc, char** argv)
+{
+	bench::Suite suite("HashMap", argc, argv);
+	bench::Random rng(0x5eed);
+
+	const std::vector<unsigned int> ids = RandomIds(rng, NUM_KEYS);
+	const std::vector<unsigned int> missIds = RandomIds(rng, NUM_LOOKUPS);
+	const std::vector<std::string> names = RandomNames(rng, NUM_KEYS);
+	const std::vector<std::string> missNames = RandomNames(rng, NUM_LOOKUPS);
+
+	BenchMap<spring::unordered_map<unsigned int, unsigned int>>(suite, "emilib/uint", ids, missIds);
+	BenchMap<spring::swiss_map<unsigned int, unsigned int>>(suite, "swiss/uint", ids, missIds);
+	BenchMap<spring::unordered_map<std::string, unsigned int>>(suite, "emilib/string", names, missNames);
+	BenchMap<spring::swiss_map<std::string, unsigned int>>(suite, "swiss/string", names, missNames);
+
+	return suite.Finish();
+}
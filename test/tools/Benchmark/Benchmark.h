@@ -0,0 +1,127 @@
+/* This file is part of the Spring engine (GPL v2 or later), see LICENSE.html */
+
+#ifndef SPRING_BENCHMARK_H
+#define SPRING_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+/**
+ * Minimal micro-benchmark harness for the bench_* targets.
+ *
+ * Every case is run once to warm up and then NUM_SAMPLES times; the median
+ * and minimum time per operation are reported. Inputs should come from a
+ * Random seeded with a fixed value, and each case returns a checksum over
+ * its results so the work can not be optimized away and runs on different
+ * commits can be checked to have done the same thing.
+ *
+ * Usage: bench_<name> [--json <file>] [--filter <substring>]
+ */
+namespace bench {
+	static constexpr unsigned int NUM_SAMPLES = 9;
+
+	// mt19937's output sequence is fixed by the standard, distributions are not
+	class Random {
+	public:
+		explicit Random(std::uint32_t seed): gen(seed) {}
+
+		float NextFloat() { return ((gen() >> 8) * (1.0f / 16777216.0f)); }
+		float NextFloat(float min, float max) { return (min + NextFloat() * (max - min)); }
+		std::uint32_t NextInt(std::uint32_t max) { return (gen() % max); }
+
+	private:
+		std::mt19937 gen;
+	};
+
+	struct Result {
+		std::string name;
+		std::uint64_t opsPerSample;
+		std::uint64_t checksum;
+
+		double medianNsPerOp;
+		double minNsPerOp;
+	};
+
+	class Suite {
+	public:
+		Suite(const char* name, int argc, char** argv): suiteName(name) {
+			for (int i = 1; i < argc - 1; i++) {
+				if (strcmp(argv[i], "--json") == 0)
+					jsonFile = argv[++i];
+				else if (strcmp(argv[i], "--filter") == 0)
+					filter = argv[++i];
+			}
+		}
+
+		/**
+		 * runs <f> as one sample of <opsPerSample> operations; f returns the
+		 * checksum of its results, which must be the same for every sample
+		 */
+		template<typename F> void Run(const char* name, std::uint64_t opsPerSample, F&& f) {
+			if (!filter.empty() && std::string(name).find(filter) == std::string::npos)
+				return;
+
+			std::vector<double> samples;
+			samples.reserve(NUM_SAMPLES);
+
+			const std::uint64_t checksum = f();
+
+			for (unsigned int n = 0; n < NUM_SAMPLES; n++) {
+				const auto t0 = std::chrono::steady_clock::now();
+
+				if (f() != checksum)
+					fprintf(stderr, "[%s] %s: checksum differs between samples\n", suiteName.c_str(), name);
+
+				const auto t1 = std::chrono::steady_clock::now();
+
+				samples.push_back(std::chrono::duration<double, std::nano>(t1 - t0).count() / opsPerSample);
+			}
+
+			std::sort(samples.begin(), samples.end());
+			results.push_back({name, opsPerSample, checksum, samples[NUM_SAMPLES / 2], samples[0]});
+
+			printf("%-48s %12.1f ns/op (min %12.1f)  checksum %016llx\n", name, results.back().medianNsPerOp, results.back().minNsPerOp, (unsigned long long) checksum);
+		}
+
+		int Finish() const {
+			if (jsonFile.empty())
+				return 0;
+
+			FILE* f = fopen(jsonFile.c_str(), "w");
+
+			if (f == nullptr) {
+				fprintf(stderr, "[%s] could not write \"%s\"\n", suiteName.c_str(), jsonFile.c_str());
+				return 1;
+			}
+
+			fprintf(f, "{\n\t\"suite\": \"%s\",\n\t\"samples\": %u,\n\t\"benchmarks\": [\n", suiteName.c_str(), NUM_SAMPLES);
+
+			for (size_t i = 0; i < results.size(); i++) {
+				const Result& r = results[i];
+
+				fprintf(f, "\t\t{\"name\": \"%s\", \"ops\": %llu, \"median_ns\": %.3f, \"min_ns\": %.3f, \"checksum\": \"%016llx\"}%s\n",
+					r.name.c_str(), (unsigned long long) r.opsPerSample, r.medianNsPerOp, r.minNsPerOp, (unsigned long long) r.checksum,
+					(i + 1 < results.size())? ",": "");
+			}
+
+			fprintf(f, "\t]\n}\n");
+			fclose(f);
+			return 0;
+		}
+
+	private:
+		std::string suiteName;
+		std::string jsonFile;
+		std::string filter;
+
+		std::vector<Result> results;
+	};
+}
+
+#endif
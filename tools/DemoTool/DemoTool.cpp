@@ -2,6 +2,7 @@
 
 #include <string>
 #include <map>
+#include <sstream>
 #include <iostream>
 #include <gflags/gflags.h>
 #include <iomanip> //hex
@@ -9,6 +10,7 @@
 #include "StringSerializer.h"
 
 #include "Net/Protocol/BaseNetProtocol.h"
+#include "System/LoadSave/DemoIndex.h"
 #include "System/LoadSave/DemoReader.h"
 #include "System/Net/RawPacket.h"
 #include "Sim/Units/CommandAI/Command.h"
@@ -32,9 +34,11 @@ no console output (you still could use this.exe > z.tzt though).
 	DEFINE_bool  (teamstats,    false, "Print teamstats");
 	DEFINE_int32 (team,         -1,    "Select team");
 	DEFINE_string(teamsstatcsv, "",    "Write teamstats in a csv file");
+	DEFINE_string(extract,      "",    "Print only messages with these comma-separated ids, from all demo files given; indexed demos are read only where they contain them");
 
 
 void TrafficDump(CDemoReader& reader, bool trafficStats);
+void ExtractMessages(const std::string& filename, const std::vector<bool>& msgTypes);
 void WriteTeamstatHistory(CDemoReader& reader, unsigned team, const std::string& file);
 
 int main (int argc, char* argv[])
@@ -43,6 +47,24 @@ int main (int argc, char* argv[])
 
 	gflags::SetUsageMessage(std::string("Usage: ") + argv[0] + " [options] path_to_demo.sdfz");
 	gflags::ParseCommandLineFlags(&argc, &argv, true);
+	if (!FLAGS_extract.empty()) {
+		std::vector<bool> msgTypes(256, false);
+		std::istringstream ids(FLAGS_extract);
+
+		for (std::string id; std::getline(ids, id, ','); ) {
+			const unsigned msgType = atoi(id.c_str());
+			if (msgType < msgTypes.size())
+				msgTypes[msgType] = true;
+		}
+
+		if (!FLAGS_demofile.empty())
+			ExtractMessages(FLAGS_demofile, msgTypes);
+
+		for (int i = 1; i < argc; ++i)
+			ExtractMessages(argv[i], msgTypes);
+
+		return 0;
+	}
 	if (!FLAGS_demofile.empty()) {
 		filename = FLAGS_demofile;
 	} else if (argc >= 2) {
@@ -191,12 +213,249 @@ void PrintBinary(const unsigned char* const buf, int len)
 	std::cout << std::dec; //reset to decimal
 }
 
+void PrintPacket(const netcode::RawPacket* packet, int& frame)
+{
+	const unsigned char* buffer = packet->data;
+	char buf[16]; // FIXME: cba to look up how to format numbers with iostreams
+	sprintf(buf, "%06d ", frame);
+	const int cmd = (unsigned char)buffer[0];
+	int cmdId = 0;
+	std::cout << buf;
+	switch (cmd)
+	{
+		case NETMSG_AICOMMAND:
+			std::cout << "AICOMMAND: Playernum: " << (unsigned)buffer[3];
+			std::cout << " Length: " << (unsigned)packet->length;
+			std::cout << " AI id: " << (unsigned)buffer[4];
+			std::cout << " UnitId: " << *((short*)(buffer + 5));
+			cmdId = *((int*)(buffer + 7));
+			std::cout << " CommandId: " << GetCommandName(cmdId) << "(" << cmdId << ")";
+			std::cout << " Options: " << (unsigned)buffer[11];
+			std::cout << " Parameters:";
+			for (unsigned short i = 12; i < packet->length; i += sizeof(float)) {
+				std::cout << " " << *((float*)(buffer + i));
+			}
+			std::cout << std::endl;
+			break;
+		case NETMSG_AICOMMANDS: {
+			std::cout << "AICOMMANDS: Playernum: " << (unsigned)buffer[3];
+			std::cout << " Length: " << (unsigned)packet->length;
+			std::cout << " AI id: " << (unsigned)buffer[4];
+			std::cout << " Pair: " << (unsigned)buffer[5];
+			unsigned int sameid = *((unsigned int*)(buffer + 6));
+			std::cout << " SameID: " << sameid;
+			unsigned int sameopt = (unsigned)buffer[10];
+			std::cout << " SameOpt: " << sameopt;
+			unsigned short samesize = *((unsigned short*)(buffer + 11));
+			std::cout << " SameSize: " << samesize;
+			short uidc = *((short*)(buffer + 13));
+			std::cout << " UnitIDCount: " << uidc;
+			for (unsigned int i = 0; i < uidc; ++i) {
+				std::cout << " " << *((short*)(buffer + 15 + i * 2));
+			}
+			short cidc = *((short*)(buffer + 15 + uidc * 2));
+			int startp = 15 + uidc * 2 + 2;
+			std::cout << " CmdIDCount: " << cidc;
+			for (unsigned int i = 0; i < cidc; ++i) {
+				if (sameid == 0) {
+					std::cout << " " << *((unsigned int*)(buffer + startp));
+					startp += 4;
+				}
+				if (sameopt == 0xFF) {
+					std::cout << " " << (unsigned)buffer[startp];
+					startp += 1;
+				}
+				if (sameopt == 0xFFFF) {
+					std::cout << " " << *((unsigned short*)(buffer + startp));
+					startp += 2;
+				}
+			}
+			std::cout << std::endl;
+			break;
+		}
+		case NETMSG_PLAYERNAME:
+			std::cout << "PLAYERNAME: Playernum: " << (unsigned)buffer[2] << " Name: " << buffer+3 << std::endl;
+			break;
+		case NETMSG_SETPLAYERNUM:
+			std::cout << "SETPLAYERNUM: Playernum: " << (unsigned)buffer[1] << std::endl;
+			break;
+		case NETMSG_QUIT:
+			std::cout << "QUIT" << std::endl;
+			break;
+		case NETMSG_STARTPLAYING:
+			std::cout << "STARTPLAYING" << std::endl;
+			break;
+		case NETMSG_STARTPOS:
+			std::cout << "STARTPOS: Playernum: " << (unsigned)buffer[1] << " Team: " << (unsigned)buffer[2] << " Readyness: " << (unsigned)buffer[3] << std::endl;
+			break;
+		case NETMSG_SYSTEMMSG:
+			std::cout << "SYSTEMMSG: Player: " << (unsigned)buffer[3] << " Msg: " << (char*)(buffer+4) << std::endl;
+			break;
+		case NETMSG_CHAT:
+			std::cout << "CHAT: Player: " << (unsigned)buffer[2] << " Msg: " << (char*)(buffer+4) << std::endl;
+			break;
+		case NETMSG_KEYFRAME:
+			std::cout << "KEYFRAME: " << *(int*)(buffer+1) << std::endl;
+			++frame;
+			if (*(int*)(buffer+1) != frame) {
+				std::cout << "keyframe mismatch!" << std::endl;
+			}
+			break;
+		case NETMSG_NEWFRAME:
+			std::cout << "NEWFRAME" << std::endl;
+			++frame;
+			break;
+		case NETMSG_PLAYERINFO:
+			std::cout << "NETMSG_PLAYERINFO: Player:" << (int)buffer[1] << " Ping: " << *(uint16_t*)&buffer[6] << std::endl;
+			break;
+		case NETMSG_LUAMSG:
+			{
+			std::cout << "LUAMSG length:" << packet->length << " Player:" << (unsigned)buffer[3] << " Script: " << *(uint16_t*)&buffer[4] << " Mode: " << (unsigned)buffer[6] << " Msg: ";
+			PrintBinary(&packet->data[7], packet->length - 7);
+			std::cout << std::endl;
+			break;
+			}
+		case NETMSG_TEAM:
+			std::cout << "TEAM Playernum: " << (int)buffer[1] << " Action:";
+			switch (buffer[2]) {
+				case TEAMMSG_GIVEAWAY: std::cout << "GIVEAWAY"; break;
+				case TEAMMSG_RESIGN: std::cout << "RESIGN"; break;
+				case TEAMMSG_TEAM_DIED: std::cout << "TEAM_DIED"; break;
+				case TEAMMSG_JOIN_TEAM: std::cout << "JOIN_TEAM"; break;
+				default: std::cout << (int)buffer[2];
+			}
+			std::cout << " Parameter:" << (int)buffer[3] << std::endl;
+			break;
+		case NETMSG_COMMAND:
+			std::cout << "COMMAND Playernum: " << (int)buffer[3];
+			std::cout << " Size: " << *(unsigned short*)(buffer+1);
+			cmdId = *((int*)(buffer + 4));
+			std::cout << " CommandId: " << GetCommandName(cmdId) << "(" << cmdId << ")";
+			std::cout << " Options: " << (unsigned)buffer[8];
+			std::cout << " Parameters:";
+			for (unsigned short i = 9; i < packet->length; i += sizeof(float)) {
+				std::cout << " " << *((float*)(buffer + i));
+			}
+			std::cout << std::endl;
+			if (*(unsigned short*)(buffer+1) != packet->length)
+				std::cout << "      packet length error: expected: " <<  *(unsigned short*)(buffer+1) << " got: " << packet->length << std::endl;
+			break;
+		case NETMSG_SELECT:
+			std::cout << "NETMGS_SELECT: Playernum: " << (unsigned)buffer[3];
+			std::cout << " Length: " << (unsigned)packet->length;
+			std::cout << " Unit IDs:";
+			for (unsigned short i = 4; i < packet->length; i += 2) {
+				std::cout << " " << *((short*)(buffer + i));
+			}
+			std::cout << std::endl;
+			break;
+		case NETMSG_GAMEOVER:
+			std::cout << "NETMSG_GAMEOVER";
+			std::cout << " Length: " << (unsigned)packet->length;
+			std::cout << " Player: " << (unsigned)buffer[2];
+			std::cout << " Winning ids:";
+			for (unsigned short i = 3; i < packet->length; i += 1) {
+				std::cout << " " << (unsigned) *((char*)(buffer + i));
+			}
+			std::cout << std::endl;
+			break;
+		case NETMSG_MAPDRAW:
+			std::cout << "NETMSG_MAPDRAW Player:" << (int)buffer[2];
+			switch (buffer[3]) {
+				case MAPDRAW_POINT:
+					std::cout << " POINT x:" << *(int16_t*)&buffer[4] << " z:" << *(int16_t*)&buffer[6];
+					if (packet->length > 10) {
+						std::cout << " Msg: " << (char*)buffer+9;
+					}
+					break;
+				case MAPDRAW_LINE:
+					std::cout << " LINE x1:" << *(int16_t*)&buffer[4] << " z1:" << *(int16_t*)&buffer[6] << " x2:" << *(int16_t*)&buffer[8] << " z2:" << *(int16_t*)&buffer[10];
+					break;
+				case MAPDRAW_ERASE:
+					std::cout << " ERASE x:" << *(int16_t*)&buffer[4] << " z:" << *(int16_t*)&buffer[6];
+					break;
+			}
+			std::cout << std::endl;
+			break;
+		case NETMSG_PATH_CHECKSUM:
+			std::cout << "NETMSG_PATH_CHECKSUM" << std::endl;
+			break;
+		case NETMSG_INTERNAL_SPEED:
+			std::cout << "NETMSG_INTERNAL_SPEED" << std::endl;
+			break;
+		case NETMSG_PLAYERLEFT:
+			std::cout << "NETMSG_PLAYERLEFT" << std::endl;
+			break;
+		case NETMSG_GAMEDATA:
+			std::cout << "NETMSG_GAMEDATA" << std::endl;
+			break;
+		case NETMSG_CREATE_NEWPLAYER:
+			// uchar myPlayerNum, uchar spectator, uchar teamNum, std::string playerName
+			std::cout << "NETMSG_CREATE_NEWPLAYER: Playernum: " << (unsigned)buffer[3];
+			std::cout << " Spectator: " << (unsigned)buffer[4];
+			std::cout << " Team: " << (unsigned) buffer[5];
+			std::cout << " PlayerName: " << (char*) (buffer + 6);
+			std::cout << std::endl;
+			break;
+		case NETMSG_GAMEID:
+			std::cout << "NETMSG_GAMEID: ";
+			PrintBinary(&packet->data[1], packet->length - 1);
+			std::cout << std::endl;
+			break;
+		case NETMSG_RANDSEED:
+			std::cout << "NETMSG_RANDSEED: ";
+			PrintBinary(&packet->data[1], packet->length - 1);
+			std::cout << std::endl;
+			break;
+		case NETMSG_SHARE:
+			std::cout << "NETMSG_SHARE: Playernum: " << (unsigned)buffer[1];
+			std::cout << " Team: " << (unsigned)buffer[2];
+			std::cout << " ShareUnits: " << (unsigned)buffer[3];
+			std::cout << " Metal: " << *(float*)(buffer + 4);
+			std::cout << " Energy: " << *(float*)(buffer + 8);
+			std::cout << std::endl;
+			break;
+		case NETMSG_CCOMMAND:
+			std::cout << "NETMSG_CCOMMAND: " << std::endl;
+			break;
+		case NETMSG_PAUSE:
+			std::cout << "NETMSG_PAUSE: Player " << (unsigned)buffer[1] << " paused: " << (unsigned)buffer[2] << std::endl;
+			break;
+		case NETMSG_SYNCRESPONSE:
+			//uchar myPlayerNum; int frameNum; uint checksum;
+			std::cout << "NETMSG_SYNCRESPONSE: Playernum: "<< (unsigned)buffer[1];
+			std::cout << " Framenum: " << *(int*)(buffer+2);
+			std::cout << " Checksum: " << (unsigned)buffer[6];
+			std::cout << std::endl;
+			break;
+		case NETMSG_DIRECT_CONTROL:
+			std::cout << "NETMSG_DIRECT_CONTROL: " << std::endl;
+			break;
+		case NETMSG_SETSHARE:
+			std::cout << "NETMSG_SETSHARE: " << std::endl;
+			break;
+		case NETMSG_CLIENTDATA: {
+			const uint16_t playerNum = (int)buffer[3];
+			const uint16_t totalSize = *(unsigned short*)(buffer+1);
+			std::cout << "NETMSG_CLIENTDATA: Player " << (unsigned)playerNum << " totalSize: " <<totalSize << std::endl;
+			break;
+		}
+		case NETMSG_AI_STATE_CHANGED:
+			std::cout << "NETMSG_AI_STATE_CHANGED: " << std::endl;
+			break;
+		case NETMSG_PLAYERSTAT:
+			std::cout << "NETMSG_PLAYERSTAT: " << std::endl;
+			break;
+		default:
+			std::cout << "MSG: " << cmd << std::endl;
+	}
+}
+
 void TrafficDump(CDemoReader& reader, bool trafficStats)
 {
 	InitCommandNames();
 	std::vector<unsigned> trafficCounter(NETMSG_LAST, 0);
 	int frame = -1;
-	int cmdId = 0;
 	while (!reader.ReachedEnd())
 	{
 		netcode::RawPacket* packet;
@@ -205,243 +464,12 @@ void TrafficDump(CDemoReader& reader, bool trafficStats)
 			continue;
 		assert(packet->data[0]<NETMSG_LAST);
 		trafficCounter[packet->data[0]] += packet->length;
-		const unsigned char* buffer = packet->data;
-		char buf[16]; // FIXME: cba to look up how to format numbers with iostreams
-		sprintf(buf, "%06d ", frame);
-		const int cmd = (unsigned char)buffer[0];
+		const int cmd = (unsigned char)packet->data[0];
 		if (cmd == NETMSG_GAME_FRAME_PROGRESS) { //ignore as its unsynced (TODO: why is this recorded in demo?)
 			delete packet;
 			continue;
 		}
-		std::cout << buf;
-		switch (cmd)
-		{
-			case NETMSG_AICOMMAND:
-				std::cout << "AICOMMAND: Playernum: " << (unsigned)buffer[3];
-				std::cout << " Length: " << (unsigned)packet->length;
-				std::cout << " AI id: " << (unsigned)buffer[4];
-				std::cout << " UnitId: " << *((short*)(buffer + 5));
-				cmdId = *((int*)(buffer + 7));
-				std::cout << " CommandId: " << GetCommandName(cmdId) << "(" << cmdId << ")";
-				std::cout << " Options: " << (unsigned)buffer[11];
-				std::cout << " Parameters:";
-				for (unsigned short i = 12; i < packet->length; i += sizeof(float)) {
-					std::cout << " " << *((float*)(buffer + i));
-				}
-				std::cout << std::endl;
-				break;
-			case NETMSG_AICOMMANDS: {
-				std::cout << "AICOMMANDS: Playernum: " << (unsigned)buffer[3];
-				std::cout << " Length: " << (unsigned)packet->length;
-				std::cout << " AI id: " << (unsigned)buffer[4];
-				std::cout << " Pair: " << (unsigned)buffer[5];
-				unsigned int sameid = *((unsigned int*)(buffer + 6));
-				std::cout << " SameID: " << sameid;
-				unsigned int sameopt = (unsigned)buffer[10];
-				std::cout << " SameOpt: " << sameopt;
-				unsigned short samesize = *((unsigned short*)(buffer + 11));
-				std::cout << " SameSize: " << samesize;
-				short uidc = *((short*)(buffer + 13));
-				std::cout << " UnitIDCount: " << uidc;
-				for (unsigned int i = 0; i < uidc; ++i) {
-					std::cout << " " << *((short*)(buffer + 15 + i * 2));
-				}
-				short cidc = *((short*)(buffer + 15 + uidc * 2));
-				int startp = 15 + uidc * 2 + 2;
-				std::cout << " CmdIDCount: " << cidc;
-				for (unsigned int i = 0; i < cidc; ++i) {
-					if (sameid == 0) {
-						std::cout << " " << *((unsigned int*)(buffer + startp));
-						startp += 4;
-					}
-					if (sameopt == 0xFF) {
-						std::cout << " " << (unsigned)buffer[startp];
-						startp += 1;
-					}
-					if (sameopt == 0xFFFF) {
-						std::cout << " " << *((unsigned short*)(buffer + startp));
-						startp += 2;
-					}
-				}
-				std::cout << std::endl;
-				break;
-			}
-			case NETMSG_PLAYERNAME:
-				std::cout << "PLAYERNAME: Playernum: " << (unsigned)buffer[2] << " Name: " << buffer+3 << std::endl;
-				break;
-			case NETMSG_SETPLAYERNUM:
-				std::cout << "SETPLAYERNUM: Playernum: " << (unsigned)buffer[1] << std::endl;
-				break;
-			case NETMSG_QUIT:
-				std::cout << "QUIT" << std::endl;
-				break;
-			case NETMSG_STARTPLAYING:
-				std::cout << "STARTPLAYING" << std::endl;
-				break;
-			case NETMSG_STARTPOS:
-				std::cout << "STARTPOS: Playernum: " << (unsigned)buffer[1] << " Team: " << (unsigned)buffer[2] << " Readyness: " << (unsigned)buffer[3] << std::endl;
-				break;
-			case NETMSG_SYSTEMMSG:
-				std::cout << "SYSTEMMSG: Player: " << (unsigned)buffer[3] << " Msg: " << (char*)(buffer+4) << std::endl;
-				break;
-			case NETMSG_CHAT:
-				std::cout << "CHAT: Player: " << (unsigned)buffer[2] << " Msg: " << (char*)(buffer+4) << std::endl;
-				break;
-			case NETMSG_KEYFRAME:
-				std::cout << "KEYFRAME: " << *(int*)(buffer+1) << std::endl;
-				++frame;
-				if (*(int*)(buffer+1) != frame) {
-					std::cout << "keyframe mismatch!" << std::endl;
-				}
-				break;
-			case NETMSG_NEWFRAME:
-				std::cout << "NEWFRAME" << std::endl;
-				++frame;
-				break;
-			case NETMSG_PLAYERINFO:
-				std::cout << "NETMSG_PLAYERINFO: Player:" << (int)buffer[1] << " Ping: " << *(uint16_t*)&buffer[6] << std::endl;
-				break;
-			case NETMSG_LUAMSG:
-				{
-				std::cout << "LUAMSG length:" << packet->length << " Player:" << (unsigned)buffer[3] << " Script: " << *(uint16_t*)&buffer[4] << " Mode: " << (unsigned)buffer[6] << " Msg: ";
-				PrintBinary(&packet->data[7], packet->length - 7);
-				std::cout << std::endl;
-				break;
-				}
-			case NETMSG_TEAM:
-				std::cout << "TEAM Playernum: " << (int)buffer[1] << " Action:";
-				switch (buffer[2]) {
-					case TEAMMSG_GIVEAWAY: std::cout << "GIVEAWAY"; break;
-					case TEAMMSG_RESIGN: std::cout << "RESIGN"; break;
-					case TEAMMSG_TEAM_DIED: std::cout << "TEAM_DIED"; break;
-					case TEAMMSG_JOIN_TEAM: std::cout << "JOIN_TEAM"; break;
-					default: std::cout << (int)buffer[2];
-				}
-				std::cout << " Parameter:" << (int)buffer[3] << std::endl;
-				break;
-			case NETMSG_COMMAND:
-				std::cout << "COMMAND Playernum: " << (int)buffer[3];
-				std::cout << " Size: " << *(unsigned short*)(buffer+1);
-				cmdId = *((int*)(buffer + 4));
-				std::cout << " CommandId: " << GetCommandName(cmdId) << "(" << cmdId << ")";
-				std::cout << " Options: " << (unsigned)buffer[8];
-				std::cout << " Parameters:";
-				for (unsigned short i = 9; i < packet->length; i += sizeof(float)) {
-					std::cout << " " << *((float*)(buffer + i));
-				}
-				std::cout << std::endl;
-				if (*(unsigned short*)(buffer+1) != packet->length)
-					std::cout << "      packet length error: expected: " <<  *(unsigned short*)(buffer+1) << " got: " << packet->length << std::endl;
-				break;
-			case NETMSG_SELECT:
-				std::cout << "NETMGS_SELECT: Playernum: " << (unsigned)buffer[3];
-				std::cout << " Length: " << (unsigned)packet->length;
-				std::cout << " Unit IDs:";
-				for (unsigned short i = 4; i < packet->length; i += 2) {
-					std::cout << " " << *((short*)(buffer + i));
-				}
-				std::cout << std::endl;
-				break;
-			case NETMSG_GAMEOVER:
-				std::cout << "NETMSG_GAMEOVER";
-				std::cout << " Length: " << (unsigned)packet->length;
-				std::cout << " Player: " << (unsigned)buffer[2];
-				std::cout << " Winning ids:";
-				for (unsigned short i = 3; i < packet->length; i += 1) {
-					std::cout << " " << (unsigned) *((char*)(buffer + i));
-				}
-				std::cout << std::endl;
-				break;
-			case NETMSG_MAPDRAW:
-				std::cout << "NETMSG_MAPDRAW Player:" << (int)buffer[2];
-				switch (buffer[3]) {
-					case MAPDRAW_POINT:
-						std::cout << " POINT x:" << *(int16_t*)&buffer[4] << " z:" << *(int16_t*)&buffer[6];
-						if (packet->length > 10) {
-							std::cout << " Msg: " << (char*)buffer+9;
-						}
-						break;
-					case MAPDRAW_LINE:
-						std::cout << " LINE x1:" << *(int16_t*)&buffer[4] << " z1:" << *(int16_t*)&buffer[6] << " x2:" << *(int16_t*)&buffer[8] << " z2:" << *(int16_t*)&buffer[10];
-						break;
-					case MAPDRAW_ERASE:
-						std::cout << " ERASE x:" << *(int16_t*)&buffer[4] << " z:" << *(int16_t*)&buffer[6];
-						break;
-				}
-				std::cout << std::endl;
-				break;
-			case NETMSG_PATH_CHECKSUM:
-				std::cout << "NETMSG_PATH_CHECKSUM" << std::endl;
-				break;
-			case NETMSG_INTERNAL_SPEED:
-				std::cout << "NETMSG_INTERNAL_SPEED" << std::endl;
-				break;
-			case NETMSG_PLAYERLEFT:
-				std::cout << "NETMSG_PLAYERLEFT" << std::endl;
-				break;
-			case NETMSG_GAMEDATA:
-				std::cout << "NETMSG_GAMEDATA" << std::endl;
-				break;
-			case NETMSG_CREATE_NEWPLAYER:
-				// uchar myPlayerNum, uchar spectator, uchar teamNum, std::string playerName
-				std::cout << "NETMSG_CREATE_NEWPLAYER: Playernum: " << (unsigned)buffer[3];
-				std::cout << " Spectator: " << (unsigned)buffer[4];
-				std::cout << " Team: " << (unsigned) buffer[5];
-				std::cout << " PlayerName: " << (char*) (buffer + 6);
-				std::cout << std::endl;
-				break;
-			case NETMSG_GAMEID:
-				std::cout << "NETMSG_GAMEID: ";
-				PrintBinary(&packet->data[1], packet->length - 1);
-				std::cout << std::endl;
-				break;
-			case NETMSG_RANDSEED:
-				std::cout << "NETMSG_RANDSEED: ";
-				PrintBinary(&packet->data[1], packet->length - 1);
-				std::cout << std::endl;
-				break;
-			case NETMSG_SHARE:
-				std::cout << "NETMSG_SHARE: Playernum: " << (unsigned)buffer[1];
-				std::cout << " Team: " << (unsigned)buffer[2];
-				std::cout << " ShareUnits: " << (unsigned)buffer[3];
-				std::cout << " Metal: " << *(float*)(buffer + 4);
-				std::cout << " Energy: " << *(float*)(buffer + 8);
-				std::cout << std::endl;
-				break;
-			case NETMSG_CCOMMAND:
-				std::cout << "NETMSG_CCOMMAND: " << std::endl;
-				break;
-			case NETMSG_PAUSE:
-				std::cout << "NETMSG_PAUSE: Player " << (unsigned)buffer[1] << " paused: " << (unsigned)buffer[2] << std::endl;
-				break;
-			case NETMSG_SYNCRESPONSE:
-				//uchar myPlayerNum; int frameNum; uint checksum;
-				std::cout << "NETMSG_SYNCRESPONSE: Playernum: "<< (unsigned)buffer[1];
-				std::cout << " Framenum: " << *(int*)(buffer+2);
-				std::cout << " Checksum: " << (unsigned)buffer[6];
-				std::cout << std::endl;
-				break;
-			case NETMSG_DIRECT_CONTROL:
-				std::cout << "NETMSG_DIRECT_CONTROL: " << std::endl;
-				break;
-			case NETMSG_SETSHARE:
-				std::cout << "NETMSG_SETSHARE: " << std::endl;
-				break;
-			case NETMSG_CLIENTDATA: {
-				const uint16_t playerNum = (int)buffer[3];
-				const uint16_t totalSize = *(unsigned short*)(buffer+1);
-				std::cout << "NETMSG_CLIENTDATA: Player " << (unsigned)playerNum << " totalSize: " <<totalSize << std::endl;
-				break;
-			}
-			case NETMSG_AI_STATE_CHANGED:
-				std::cout << "NETMSG_AI_STATE_CHANGED: " << std::endl;
-				break;
-			case NETMSG_PLAYERSTAT:
-				std::cout << "NETMSG_PLAYERSTAT: " << std::endl;
-				break;
-			default:
-				std::cout << "MSG: " << cmd << std::endl;
-		}
+		PrintPacket(packet, frame);
 		delete packet;
 	}
 
@@ -453,6 +481,73 @@ void TrafficDump(CDemoReader& reader, bool trafficStats)
 	}
 }
 
+void ExtractMessages(const std::string& filename, const std::vector<bool>& msgTypes)
+{
+	InitCommandNames();
+	std::cout << "== " << filename << std::endl;
+
+	CDemoIndex index;
+
+	if (!index.Load(filename)) {
+		// no index, walk all of it
+		CDemoReader reader(filename, 0.0f);
+		int frame = -1;
+		while (!reader.ReachedEnd())
+		{
+			netcode::RawPacket* packet = reader.GetData(3.402823466e+38f);
+			if (packet == NULL)
+				continue;
+			if (msgTypes[packet->data[0]])
+				PrintPacket(packet, frame);
+			else
+				frame += (packet->data[0] == NETMSG_NEWFRAME || packet->data[0] == NETMSG_KEYFRAME);
+			delete packet;
+		}
+		return;
+	}
+
+	const std::vector<DemoIndexBlock>& blocks = index.GetBlocks();
+	std::vector<std::uint8_t> data;
+
+	for (size_t n = 0; n < blocks.size(); ++n)
+	{
+		bool wanted = false;
+		for (unsigned msgType = 0; msgType < msgTypes.size(); ++msgType) {
+			wanted |= (msgTypes[msgType] && blocks[n].HasMsgType(msgType));
+		}
+		if (!wanted)
+			continue;
+		if (!index.ReadBlock(n, data)) {
+			std::cout << "corrupt block " << n << std::endl;
+			return;
+		}
+
+		// the first and last block also contain the script and stats
+		const std::uint32_t begin = std::max(index.GetStreamStart(), blocks[n].dataOffset);
+		const std::uint32_t end = std::min(index.GetStreamEnd(), blocks[n].dataOffset + blocks[n].dataSize);
+
+		int frame = blocks[n].firstFrameNum;
+		for (std::uint32_t pos = begin; (pos + sizeof(DemoStreamChunkHeader)) <= end; )
+		{
+			DemoStreamChunkHeader chunkHeader;
+			memcpy(&chunkHeader, &data[pos - blocks[n].dataOffset], sizeof(chunkHeader));
+			chunkHeader.swab();
+			pos += sizeof(chunkHeader);
+
+			if (chunkHeader.length == 0 || (pos + chunkHeader.length) > end)
+				break;
+
+			const netcode::RawPacket packet(&data[pos - blocks[n].dataOffset], chunkHeader.length);
+			if (msgTypes[packet.data[0]])
+				PrintPacket(&packet, frame);
+			else
+				frame += (packet.data[0] == NETMSG_NEWFRAME || packet.data[0] == NETMSG_KEYFRAME);
+
+			pos += chunkHeader.length;
+		}
+	}
+}
+
 template<typename T>
 void PrintSep(std::ofstream& file, T value)
 {
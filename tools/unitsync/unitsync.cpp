@@ -5,6 +5,7 @@
 
 #include <algorithm>
 #include <cstring>
+#include <map>
 #include <string>
 #include <vector>
 #include <set>
@@ -388,9 +389,12 @@ EXPORT(int) Init(bool isServer, int id)
 		log_filter_section_setMinLevel(LOG_LEVEL_INFO, LOG_SECTION_UNITSYNC);
 #endif
 
-		// reinitialize filesystem to detect new files
-		if (CheckInit(false))
-			FileSystemInitializer::Cleanup();
+		// keep the filesystem from previous calls; a rescan detects new,
+		// modified and removed archives without re-reading ArchiveCache
+		const bool rescanFS = CheckInit(false);
+
+		if (rescanFS)
+			ConfigHandler::Deallocate();
 
 		dataDirLocater.UpdateIsolationModeByEnvVar();
 
@@ -400,7 +404,10 @@ EXPORT(int) Init(bool isServer, int id)
 		ThreadPool::SetThreadCount(ThreadPool::GetMaxThreads());
 		FileSystemInitializer::PreInitializeConfigHandler(configFile);
 		FileSystemInitializer::InitializeLogOutput("unitsync.log");
-		FileSystemInitializer::Initialize();
+
+		if (!rescanFS || !FileSystemInitializer::Rescan())
+			FileSystemInitializer::Initialize();
+
 		// check if VFS is okay (throws if not)
 		CheckForImportantFilesInVFS();
 		ThreadPool::SetThreadCount(0);
@@ -900,21 +907,16 @@ static unsigned short* GetMinimapSM3(std::string mapFileName, int mipLevel)
 	*/
 }
 
-static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
+// decodes a DXT1-compressed minimap mip-level into <colors> (RGB565, mipsize*mipsize)
+static void DecodeMinimapSMF(const std::vector<uint8_t>& buffer, int mipsize, unsigned short* colors)
 {
-	CSMFMapFile in(mapFileName);
-	std::vector<uint8_t> buffer;
-	const int mipsize = in.ReadMinimap(buffer, mipLevel);
-
-	// Do stuff
-	unsigned short* colors = (unsigned short*)((void*)imgbuf);
-	unsigned char* temp = &buffer[0];
+	const unsigned char* temp = &buffer[0];
 
 	const int numblocks = buffer.size() / 8;
 	for (int i = 0; i < numblocks; i++) {
-		unsigned short color0 = (*(unsigned short*)&temp[0]);
-		unsigned short color1 = (*(unsigned short*)&temp[2]);
-		unsigned int bits = (*(unsigned int*)&temp[4]);
+		unsigned short color0 = (*(const unsigned short*)&temp[0]);
+		unsigned short color1 = (*(const unsigned short*)&temp[2]);
+		unsigned int bits = (*(const unsigned int*)&temp[4]);
 
 		for ( int a = 0; a < 4; a++ ) {
 			for ( int b = 0; b < 4; b++ ) {
@@ -955,8 +957,16 @@ static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
 		}
 		temp += 8;
 	}
+}
+
+static unsigned short* GetMinimapSMF(std::string mapFileName, int mipLevel)
+{
+	CSMFMapFile in(mapFileName);
+	std::vector<uint8_t> buffer;
+	const int mipsize = in.ReadMinimap(buffer, mipLevel);
 
-	return colors;
+	DecodeMinimapSMF(buffer, mipsize, imgbuf);
+	return imgbuf;
 }
 
 EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
@@ -986,6 +996,95 @@ EXPORT(unsigned short*) GetMinimap(const char* mapName, int mipLevel)
 }
 
 
+// decoded minimaps by (map archive checksum, mip-level), dropped as a whole once over budget
+static constexpr size_t MINIMAP_CACHE_MAX_BYTES = 64 * 1024 * 1024;
+static std::map<std::pair<unsigned int, int>, std::vector<unsigned short>> minimapCache;
+static size_t minimapCacheBytes = 0;
+
+EXPORT(int) GetMinimaps(const char** mapNames, int numMaps, int mipLevel, unsigned short** data)
+{
+	struct MinimapJob {
+		std::vector<uint8_t> buffer;
+		unsigned int checksum;
+		int mapIndex;
+	};
+
+	int ret = -1;
+
+	try {
+		CheckInit();
+		CheckNull(mapNames);
+		CheckNull(data);
+
+		if (mipLevel < 0 || mipLevel > 8)
+			throw std::out_of_range("Miplevel must be between 0 and 8 (inclusive) in GetMinimaps.");
+
+		const int mipSize = 1024 >> mipLevel;
+		const size_t mipBytes = mipSize * mipSize * sizeof(unsigned short);
+
+		std::vector<MinimapJob> jobs;
+		jobs.reserve(std::max(numMaps, 0));
+
+		ret = 0;
+
+		// maps are read one at a time since ScopedMapLoader swaps the global VFS; only decoding runs in parallel
+		for (int i = 0; i < numMaps; i++) {
+			if (data[i] == nullptr)
+				continue;
+
+			try {
+				CheckNullOrEmpty(mapNames[i]);
+
+				const unsigned int checksum = archiveScanner->GetArchiveSingleChecksum(mapNames[i]);
+				const auto iter = minimapCache.find({checksum, mipLevel});
+
+				if (iter != minimapCache.end()) {
+					std::memcpy(data[i], iter->second.data(), mipBytes);
+					ret++;
+					continue;
+				}
+
+				const std::string mapFile = GetMapFile(mapNames[i]);
+
+				if (FileSystem::GetExtension(mapFile) != "smf")
+					throw content_error("only SMF maps are supported");
+
+				ScopedMapLoader mapLoader(mapNames[i], mapFile);
+				CSMFMapFile in(mapFile);
+
+				jobs.push_back({{}, checksum, i});
+				in.ReadMinimap(jobs.back().buffer, mipLevel);
+			} catch (const std::exception& ex) {
+				LOG_L(L_WARNING, "[%s] skipping map \"%s\": %s", __func__, (mapNames[i] != nullptr)? mapNames[i]: "", ex.what());
+				std::memset(data[i], 0, mipBytes);
+			}
+		}
+
+		ThreadPool::SetThreadCount(ThreadPool::GetMaxThreads());
+		for_mt(0, jobs.size(), [&](const int i) {
+			DecodeMinimapSMF(jobs[i].buffer, mipSize, data[jobs[i].mapIndex]);
+		});
+		ThreadPool::SetThreadCount(0);
+
+		for (const MinimapJob& job: jobs) {
+			if (minimapCacheBytes + mipBytes > MINIMAP_CACHE_MAX_BYTES) {
+				minimapCache.clear();
+				minimapCacheBytes = 0;
+			}
+
+			const unsigned short* colors = data[job.mapIndex];
+
+			minimapCache[{job.checksum, mipLevel}].assign(colors, colors + mipSize * mipSize);
+			minimapCacheBytes += mipBytes;
+		}
+
+		return (ret + int(jobs.size()));
+	}
+	UNITSYNC_CATCH_BLOCKS;
+	return ret;
+}
+
+
 EXPORT(int) GetInfoMapSize(const char* mapName, const char* name, int* width, int* height)
 {
 	try {
@@ -357,6 +357,23 @@ EXPORT(unsigned int) GetMapChecksumFromName(const char* mapName);
  * This would return a 16 bit packed RGB-565 256x256 (= 1024/2^2) bitmap.
  */
 EXPORT(unsigned short*) GetMinimap(const char* fileName, int mipLevel);
+/**
+ * @brief Retrieves the minimap images of several maps at once.
+ * @param mapNames The names of the maps, e.g. "SmallDivide".
+ * @param numMaps The number of entries in mapNames and data.
+ * @param mipLevel Which mip-level of the minimaps to extract, see GetMinimap.
+ * @param data Per map, a caller-allocated buffer of (1024 >> mipLevel)^2
+ * 16 bit packed RGB-565 values to write the minimap to; NULL entries are
+ * skipped.
+ * @return The number of minimaps retrieved; -1 on error.
+ *
+ * The archives are read one after another, the minimaps are decoded in
+ * parallel and kept in memory by map checksum and mip-level, so repeated
+ * requests for the same maps do not touch the archives again.
+ * Buffers of maps that could not be read are zero-filled.
+ * Only SMF maps are supported.
+ */
+EXPORT(int) GetMinimaps(const char** mapNames, int numMaps, int mipLevel, unsigned short** data);
 /**
  * @brief Retrieves dimensions of infomap for a map.
  * @param mapName  The name of the map, e.g. "SmallDivide".